@@ -0,0 +1,509 @@
+/**
+ * @file clustering_benchmark.cpp
+ * @author Ryan Curtin
+ *
+ * Reproducible timings of every Lloyd step type of k-means, of EM for Gaussian
+ * mixture models and of mean shift, over synthetic datasets of different sizes.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+#include <mlpack/methods/kmeans/max_variance_new_cluster.hpp>
+#include <mlpack/methods/kmeans/blocked_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
+#include <mlpack/methods/kmeans/elkan_kmeans.hpp>
+#include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
+#include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
+#include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/mean_shift/mean_shift.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::kmeans;
+using namespace mlpack::gmm;
+using namespace mlpack::meanshift;
+using namespace mlpack::metric;
+
+PROGRAM_INFO("Clustering benchmarks",
+    "This program times k-means with every Lloyd step type, EM for Gaussian "
+    "mixture models and mean shift, for every combination of the given "
+    "methods, datasets, numbers of points, dimensionalities and numbers of "
+    "clusters.  For every combination the setup time (building the Lloyd step, "
+    "including its trees, or estimating the mean shift radius), the number of "
+    "iterations, the time per iteration, the total time, the number of "
+    "distance calculations per iteration and the peak memory usage are "
+    "reported; the times are the minimum over all repetitions.  The k-means "
+    "and GMM rows also report the sum of squared distances from the points to "
+    "their closest centroid (or component mean), so that it can be checked "
+    "that the exact Lloyd step types agree."
+    "\n\n"
+    "The k-means methods are 'naive', 'blocked', 'minibatch', 'elkan', "
+    "'hamerly', 'yinyang', 'pelleg-moore', 'dualtree' and "
+    "'dualtree-covertree'; all of them start from the same centroids (random "
+    "points of the dataset) and iterate like KMeans::Cluster() until the "
+    "centroids move less than 1e-5 or --max_iterations is reached.  'gmm' runs "
+    "--gmm_iterations EM iterations with full covariances, starting from "
+    "components at the same centroids; it does not count distance "
+    "calculations.  'mean_shift' does not depend on the number of clusters, so "
+    "it is run once per dataset, and the number of clusters it finds is "
+    "reported as k; it has no iteration count, and datasets with more than "
+    "--mean_shift_points points are skipped."
+    "\n\n"
+    "The datasets are 'uniform' (uniform in the unit cube) and 'clustered' "
+    "(Gaussian clusters), generated from --seed.  The results are printed as a "
+    "table, and can also be saved as CSV with --output_file, to be compared "
+    "between versions.");
+
+PARAM_STRING("methods", "Comma-separated list of clustering methods to "
+    "benchmark.", "m", "naive,blocked,minibatch,elkan,hamerly,yinyang,"
+    "pelleg-moore,dualtree,dualtree-covertree,gmm,mean_shift");
+PARAM_STRING("distributions", "Comma-separated list of synthetic datasets.",
+    "D", "uniform,clustered");
+PARAM_STRING("points", "Comma-separated list of numbers of points.", "n",
+    "10000,100000");
+PARAM_STRING("dimensions", "Comma-separated list of dimensionalities.", "d",
+    "2,10,50");
+PARAM_STRING("clusters", "Comma-separated list of numbers of clusters.", "k",
+    "5,20,100");
+PARAM_INT("max_iterations", "Maximum number of k-means iterations.", "i", 100);
+PARAM_INT("gmm_iterations", "Number of EM iterations for GMMs.", "g", 10);
+PARAM_INT("mean_shift_points", "Largest dataset that mean shift is run on.",
+    "M", 20000);
+PARAM_INT("repetitions", "Number of times every benchmark is run.", "R", 3);
+PARAM_INT("seed", "Random seed for the datasets and initial centroids.", "s",
+    42);
+PARAM_INT("threads", "Number of threads to use (0 uses all available cores; "
+    "ignored without OpenMP).", "T", 0);
+PARAM_STRING("output_file", "File to save the results in, as CSV (optional).",
+    "o", "");
+
+//! The result of a single benchmark.
+struct BenchmarkResult
+{
+  string method;
+  string distribution;
+  size_t points;
+  size_t dimensions;
+  size_t k;
+  double setupTime;
+  double iterateTime;
+  //! The number of iterations, or 0 if the method doesn't count them.
+  size_t iterations;
+  //! The number of distance calculations, or size_t(-1) if not counted.
+  size_t distanceCalculations;
+  size_t peakMemory;
+  //! The sum of squared distances to the closest centroid, or NaN.
+  double objective;
+};
+
+//! Split a comma-separated list.
+vector<string> SplitList(const string& list)
+{
+  vector<string> items;
+  istringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+    if (item != "")
+      items.push_back(item);
+  return items;
+}
+
+//! Split a comma-separated list of positive integers.
+vector<size_t> SplitSizes(const string& parameter)
+{
+  const vector<string> list = SplitList(CLI::GetParam<string>(parameter));
+  vector<size_t> sizes;
+  for (size_t i = 0; i < list.size(); ++i)
+  {
+    const int size = atoi(list[i].c_str());
+    if (size < 1)
+      Log::Fatal << "Invalid value in --" << parameter << ": '" << list[i]
+          << "'." << endl;
+    sizes.push_back((size_t) size);
+  }
+  return sizes;
+}
+
+//! Return the peak memory usage (resident set size) in kilobytes, or 0.
+size_t PeakMemory()
+{
+  return util::PeakResidentMemory() / 1024;
+}
+
+//! The sum of squared distances from every point to its closest centroid.
+double SumOfSquares(const arma::mat& data, const arma::mat& centroids)
+{
+  double sum = 0.0;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    double best = DBL_MAX;
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+      best = std::min(best, SquaredEuclideanDistance::Evaluate(data.col(i),
+          centroids.col(j)));
+    sum += best;
+  }
+  return sum;
+}
+
+/**
+ * Run k-means with the given Lloyd step type from the given centroids, in the
+ * same way as KMeans::Cluster() does (with MaxVarianceNewCluster), but with the
+ * construction of the Lloyd step and the iterations timed separately.
+ */
+template<template<class, class> class LloydStepType>
+void RunLloydStep(const arma::mat& data,
+                  const arma::mat& initialCentroids,
+                  BenchmarkResult& result)
+{
+  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const size_t clusters = initialCentroids.n_cols;
+
+  EuclideanDistance metric;
+  MaxVarianceNewCluster emptyClusterAction;
+  arma::wall_clock clock;
+
+  clock.tic();
+  LloydStepType<EuclideanDistance, arma::mat> step(data, metric);
+  result.setupTime = std::min(result.setupTime, clock.toc());
+
+  arma::mat centroids(initialCentroids);
+  arma::mat centroidsOther;
+  arma::Col<size_t> counts(clusters);
+  size_t iteration = 0;
+  double cNorm;
+
+  clock.tic();
+  do
+  {
+    if (iteration % 2 == 0)
+      cNorm = step.Iterate(centroids, centroidsOther, counts);
+    else
+      cNorm = step.Iterate(centroidsOther, centroids, counts);
+
+    for (size_t i = 0; i < clusters; ++i)
+    {
+      if (counts[i] == 0)
+      {
+        emptyClusterAction.EmptyCluster(data, i, (iteration % 2 == 0) ?
+            centroidsOther : centroids, counts, metric, iteration);
+      }
+    }
+
+    iteration++;
+    if (isnan(cNorm) || isinf(cNorm))
+      cNorm = 1e-4; // Keep iterating.
+  } while (cNorm > 1e-5 && iteration != maxIterations);
+  result.iterateTime = std::min(result.iterateTime, clock.toc());
+
+  result.iterations = iteration;
+  result.distanceCalculations = step.DistanceCalculations();
+  result.objective = SumOfSquares(data, ((iteration - 1) % 2 == 0) ?
+      centroidsOther : centroids);
+}
+
+//! Run EM for a GMM with full covariances, starting at the given centroids.
+void RunGMM(const arma::mat& data,
+            const arma::mat& initialCentroids,
+            BenchmarkResult& result)
+{
+  const size_t iterations = (size_t) CLI::GetParam<int>("gmm_iterations");
+  const size_t clusters = initialCentroids.n_cols;
+  arma::wall_clock clock;
+
+  // A negative tolerance never stops EM early, so it runs exactly the given
+  // number of iterations.
+  clock.tic();
+  EMFit<> fitter(iterations + 1, -1.0);
+  GMM<> gmm(clusters, data.n_rows, fitter);
+  const arma::mat covariance = (data.n_cols > data.n_rows) ?
+      arma::mat(arma::diagmat(arma::var(data, 0, 1))) :
+      arma::mat(arma::eye<arma::mat>(data.n_rows, data.n_rows));
+  for (size_t i = 0; i < clusters; ++i)
+  {
+    gmm.Component(i).Mean() = initialCentroids.col(i);
+    gmm.Component(i).Covariance(covariance);
+  }
+  gmm.Weights().fill(1.0 / clusters);
+  result.setupTime = std::min(result.setupTime, clock.toc());
+
+  clock.tic();
+  gmm.Estimate(data, 1, true);
+  result.iterateTime = std::min(result.iterateTime, clock.toc());
+
+  arma::mat means(data.n_rows, clusters);
+  for (size_t i = 0; i < clusters; ++i)
+    means.col(i) = gmm.Component(i).Mean();
+
+  result.iterations = iterations;
+  result.objective = SumOfSquares(data, means);
+}
+
+//! Run mean shift with an estimated radius.
+void RunMeanShift(const arma::mat& data, BenchmarkResult& result)
+{
+  arma::wall_clock clock;
+  MeanShift<> meanShift;
+
+  clock.tic();
+  meanShift.Radius(meanShift.EstimateRadius(data));
+  result.setupTime = std::min(result.setupTime, clock.toc());
+
+  arma::Col<size_t> assignments;
+  arma::mat centroids;
+  clock.tic();
+  meanShift.Cluster(data, assignments, centroids);
+  result.iterateTime = std::min(result.iterateTime, clock.toc());
+
+  result.k = centroids.n_cols;
+}
+
+//! Run the given method once.
+void RunMethod(const string& method,
+               const arma::mat& data,
+               const arma::mat& initialCentroids,
+               BenchmarkResult& result)
+{
+  if (method == "naive")
+    RunLloydStep<NaiveKMeans>(data, initialCentroids, result);
+  else if (method == "blocked")
+    RunLloydStep<BlockedKMeans>(data, initialCentroids, result);
+  else if (method == "minibatch")
+    RunLloydStep<MiniBatchKMeans>(data, initialCentroids, result);
+  else if (method == "elkan")
+    RunLloydStep<ElkanKMeans>(data, initialCentroids, result);
+  else if (method == "hamerly")
+    RunLloydStep<HamerlyKMeans>(data, initialCentroids, result);
+  else if (method == "yinyang")
+    RunLloydStep<YinyangKMeans>(data, initialCentroids, result);
+  else if (method == "pelleg-moore")
+    RunLloydStep<PellegMooreKMeans>(data, initialCentroids, result);
+  else if (method == "dualtree")
+    RunLloydStep<DefaultDualTreeKMeans>(data, initialCentroids, result);
+  else if (method == "dualtree-covertree")
+    RunLloydStep<CoverTreeDualTreeKMeans>(data, initialCentroids, result);
+  else if (method == "gmm")
+    RunGMM(data, initialCentroids, result);
+  else if (method == "mean_shift")
+    RunMeanShift(data, result);
+  else
+    Log::Fatal << "Unknown method '" << method << "'!" << endl;
+}
+
+//! Print a single row of the table.
+void PrintResult(const BenchmarkResult& r)
+{
+  const double perIteration = (r.iterations > 0) ?
+      r.iterateTime / r.iterations : r.iterateTime;
+
+  cout << setw(19) << left << r.method << setw(10) << r.distribution << right
+      << setw(9) << r.points << setw(6) << r.dimensions << setw(6) << r.k
+      << fixed << setprecision(4) << setw(10) << r.setupTime << setw(7);
+  if (r.iterations > 0)
+    cout << r.iterations;
+  else
+    cout << "-";
+  cout << setw(11) << perIteration << setw(11) << (r.setupTime +
+      r.iterateTime) << setw(15);
+  if (r.distanceCalculations != size_t(-1))
+    cout << setprecision(0) << ((double) r.distanceCalculations /
+        std::max(r.iterations, (size_t) 1));
+  else
+    cout << "-";
+  cout << setw(10) << setprecision(1) << (r.peakMemory / 1024.0)
+      << setw(15) << setprecision(6) << scientific << r.objective << endl;
+  cout.unsetf(ios::floatfield);
+}
+
+/**
+ * Run the given method on the dataset for every k, and add the results.  The
+ * times are the minimum over all repetitions.
+ */
+void Benchmark(const string& method,
+               const string& distribution,
+               const arma::mat& dataset,
+               const vector<size_t>& ks,
+               vector<BenchmarkResult>& results)
+{
+  const size_t repetitions = (size_t) CLI::GetParam<int>("repetitions");
+
+  // Mean shift doesn't take the number of clusters.
+  const size_t runs = (method == "mean_shift") ? 1 : ks.size();
+  if (method == "mean_shift" && dataset.n_cols >
+      (size_t) CLI::GetParam<int>("mean_shift_points"))
+  {
+    Log::Warn << "Skipping mean_shift for dataset '" << distribution
+        << "' with " << dataset.n_cols << " points." << endl;
+    return;
+  }
+
+  for (size_t i = 0; i < runs; ++i)
+  {
+    BenchmarkResult result;
+    result.method = method;
+    result.distribution = distribution;
+    result.points = dataset.n_cols;
+    result.dimensions = dataset.n_rows;
+    result.k = ks[i];
+    result.setupTime = DBL_MAX;
+    result.iterateTime = DBL_MAX;
+    result.iterations = 0;
+    result.distanceCalculations = size_t(-1);
+    result.peakMemory = 0;
+    result.objective = std::numeric_limits<double>::quiet_NaN();
+
+    if (method != "mean_shift" && ks[i] > dataset.n_cols)
+    {
+      Log::Warn << "Skipping k = " << ks[i] << " for dataset '" << distribution
+          << "' with " << dataset.n_cols << " points." << endl;
+      continue;
+    }
+
+    // Every method starts from the same centroids: distinct random points.
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+    const arma::uvec order = arma::sort_index(
+        arma::randu<arma::vec>(dataset.n_cols));
+    arma::mat initialCentroids(dataset.n_rows, ks[i]);
+    for (size_t j = 0; j < ks[i]; ++j)
+      initialCentroids.col(j) = dataset.col(order[j]);
+
+    for (size_t r = 0; r < repetitions; ++r)
+    {
+      util::ResetPeakResidentMemory();
+      math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+      RunMethod(method, dataset, initialCentroids, result);
+      result.peakMemory = std::max(result.peakMemory, PeakMemory());
+    }
+
+    PrintResult(result);
+    results.push_back(result);
+  }
+}
+
+//! Generate the given synthetic dataset.
+void GenerateDataset(const string& distribution,
+                     const size_t points,
+                     const size_t dimensions,
+                     arma::mat& dataset)
+{
+  // Every dataset is generated from the same seed, so it doesn't depend on the
+  // other datasets that are benchmarked.
+  math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+
+  if (distribution == "uniform")
+  {
+    dataset.randu(dimensions, points);
+  }
+  else if (distribution == "clustered")
+  {
+    // Twenty tight Gaussian clusters with random centers.
+    const size_t numClusters = 20;
+    const arma::mat centers = 10 * arma::randu<arma::mat>(dimensions,
+        numClusters);
+    dataset.randn(dimensions, points);
+    dataset *= 0.1;
+    for (size_t i = 0; i < points; ++i)
+      dataset.col(i) += centers.col(math::RandInt(numClusters));
+  }
+  else
+  {
+    Log::Fatal << "Unknown distribution '" << distribution << "'!" << endl;
+  }
+}
+
+//! Save the results as CSV.
+void SaveResults(const string& filename,
+                 const vector<BenchmarkResult>& results)
+{
+  ofstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open '" << filename << "' for writing!" << endl;
+
+  file << "method,distribution,points,dimensions,k,setup_time,iterate_time,"
+      << "iterations,distance_calculations,peak_memory_kb,objective" << endl;
+  file << setprecision(17);
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    file << r.method << "," << r.distribution << "," << r.points << ","
+        << r.dimensions << "," << r.k << "," << r.setupTime << ","
+        << r.iterateTime << ",";
+    if (r.iterations > 0)
+      file << r.iterations;
+    file << ",";
+    if (r.distanceCalculations != size_t(-1))
+      file << r.distanceCalculations;
+    file << "," << r.peakMemory << ",";
+    if (r.objective == r.objective)
+      file << r.objective;
+    file << endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("max_iterations") < 1)
+    Log::Fatal << "Invalid maximum number of iterations: "
+        << CLI::GetParam<int>("max_iterations") << "." << endl;
+  if (CLI::GetParam<int>("gmm_iterations") < 1)
+    Log::Fatal << "Invalid number of EM iterations: "
+        << CLI::GetParam<int>("gmm_iterations") << "." << endl;
+  if (CLI::GetParam<int>("repetitions") < 1)
+    Log::Fatal << "Invalid number of repetitions: "
+        << CLI::GetParam<int>("repetitions") << "." << endl;
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#endif
+
+  const vector<string> methods = SplitList(CLI::GetParam<string>("methods"));
+  const vector<string> distributions =
+      SplitList(CLI::GetParam<string>("distributions"));
+  const vector<size_t> points = SplitSizes("points");
+  const vector<size_t> dimensions = SplitSizes("dimensions");
+  const vector<size_t> ks = SplitSizes("clusters");
+  if (ks.empty())
+    Log::Fatal << "No numbers of clusters given." << endl;
+
+  cout << setw(19) << left << "method" << setw(10) << "data" << right
+      << setw(9) << "points" << setw(6) << "dims" << setw(6) << "k"
+      << setw(10) << "setup (s)" << setw(7) << "iters" << setw(11)
+      << "iter (s)" << setw(11) << "total (s)" << setw(15) << "dists/iter"
+      << setw(10) << "peak (MB)" << setw(15) << "sum of squares" << endl;
+
+  vector<BenchmarkResult> results;
+  for (size_t i = 0; i < distributions.size(); ++i)
+  {
+    for (size_t n = 0; n < points.size(); ++n)
+    {
+      for (size_t d = 0; d < dimensions.size(); ++d)
+      {
+        arma::mat dataset;
+        GenerateDataset(distributions[i], points[n], dimensions[d], dataset);
+
+        for (size_t m = 0; m < methods.size(); ++m)
+          Benchmark(methods[m], distributions[i], dataset, ks, results);
+      }
+    }
+  }
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  if (outputFile != "")
+    SaveResults(outputFile, results);
+
+  return 0;
+}
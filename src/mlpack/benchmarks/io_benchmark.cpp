@@ -0,0 +1,402 @@
+/**
+ * @file io_benchmark.cpp
+ * @author Ryan Curtin
+ *
+ * Throughput of data::Load() and data::Save() for every file format that they
+ * handle, with and without transposing the matrix.
+ */
+#include <mlpack/core.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace std;
+using namespace mlpack;
+
+PROGRAM_INFO("I/O benchmarks",
+    "This program times data::Save() and data::Load() for every given file "
+    "format and matrix size, with and without transposing the matrix, and "
+    "times data::inplace_transpose() on its own.  For every combination the "
+    "time, the throughput (in MB of the matrix in memory per second), the size "
+    "of the file and the peak memory usage while loading are reported; the "
+    "times are the minimum over all repetitions."
+    "\n\n"
+    "The formats are 'csv', 'raw_ascii', 'arma_ascii', 'arma_binary', "
+    "'raw_binary', 'hdf5' and 'pgm'.  data::Save() writes raw ASCII for .txt "
+    "files and Armadillo binary for .bin files, so the Armadillo ASCII and raw "
+    "binary files are saved with Armadillo itself (in the layout data::Load() "
+    "expects), and their save times are those of Armadillo.  A raw binary file "
+    "has no size, so it is loaded as a single row.  PGM files hold 8-bit "
+    "values, so the matrix is rounded to integers from 0 to 255 for every "
+    "format.  HDF5 is only benchmarked if Armadillo was built with HDF5 "
+    "support."
+    "\n\n"
+    "The sizes are given as 'rows x columns' of the matrix in memory, like "
+    "'100000x10'; the files are written to --directory and deleted "
+    "afterwards.  If --baseline_file is given, the results are compared with "
+    "those of a previous run saved with --output_file, and the program fails "
+    "if a load or a save became slower than the tolerance allows.");
+
+PARAM_STRING("formats", "Comma-separated list of file formats.", "f",
+    "csv,raw_ascii,arma_ascii,arma_binary,raw_binary,hdf5,pgm");
+PARAM_STRING("sizes", "Comma-separated list of matrix sizes, as "
+    "'rowsxcolumns'.", "S", "10x10000,10x1000000,1000x10000");
+PARAM_STRING("directory", "Directory to write the files to.", "D", ".");
+PARAM_INT("repetitions", "Number of times every benchmark is run.", "R", 3);
+PARAM_INT("seed", "Random seed for the matrices.", "s", 42);
+PARAM_STRING("output_file", "File to save the results in, as CSV (optional).",
+    "o", "");
+PARAM_STRING("baseline_file", "File with the results of a previous run, to "
+    "check for regressions (optional).", "b", "");
+PARAM_DOUBLE("tolerance", "Relative slowdown of a load or a save, compared to "
+    "the baseline, that is considered a regression.", "e", 0.25);
+
+//! The result of a single benchmark.
+struct BenchmarkResult
+{
+  string format;
+  size_t rows;
+  size_t cols;
+  bool transpose;
+  //! The save time, or a negative value if nothing was saved.
+  double saveTime;
+  double loadTime;
+  size_t fileSize;
+  size_t peakMemory;
+
+  //! The key that identifies the benchmark in a baseline.
+  string Key() const
+  {
+    ostringstream key;
+    key << format << "," << rows << "," << cols << "," << transpose;
+    return key.str();
+  }
+};
+
+//! Split a comma-separated list.
+vector<string> SplitList(const string& list)
+{
+  vector<string> items;
+  istringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+    if (item != "")
+      items.push_back(item);
+  return items;
+}
+
+//! Return the size of the given file in bytes, or 0.
+size_t FileSize(const string& filename)
+{
+  ifstream file(filename.c_str(), ios::binary | ios::ate);
+  return file.is_open() ? (size_t) file.tellg() : 0;
+}
+
+//! Return the file name extension of the given format.
+string Extension(const string& format)
+{
+  if (format == "csv")
+    return "csv";
+  else if (format == "raw_ascii" || format == "arma_ascii")
+    return "txt";
+  else if (format == "arma_binary" || format == "raw_binary")
+    return "bin";
+  else if (format == "hdf5")
+    return "h5";
+  else if (format == "pgm")
+    return "pgm";
+
+  Log::Fatal << "Unknown format '" << format << "'!" << endl;
+  return "";
+}
+
+/**
+ * Save the matrix in the given format.  The formats that data::Save() can't
+ * write are saved with Armadillo, transposed like data::Save() would.
+ */
+bool SaveMatrix(const string& format,
+                const string& filename,
+                const arma::mat& matrix,
+                const bool transpose)
+{
+  if (format == "arma_ascii" || format == "raw_binary")
+  {
+    const arma::file_type type = (format == "arma_ascii") ? arma::arma_ascii :
+        arma::raw_binary;
+    if (transpose)
+      return arma::mat(trans(matrix)).save(filename, type);
+    else
+      return matrix.save(filename, type);
+  }
+
+  return data::Save(filename, matrix, false, transpose);
+}
+
+/**
+ * Time saving and loading the matrix in the given format, and add the result.
+ */
+void Benchmark(const string& format,
+               const arma::mat& matrix,
+               const bool transpose,
+               vector<BenchmarkResult>& results)
+{
+  const size_t repetitions = (size_t) CLI::GetParam<int>("repetitions");
+  const string filename = CLI::GetParam<string>("directory") +
+      "/mlpack_io_benchmark." + Extension(format);
+
+  BenchmarkResult result;
+  result.format = format;
+  result.rows = matrix.n_rows;
+  result.cols = matrix.n_cols;
+  result.transpose = transpose;
+  result.saveTime = DBL_MAX;
+  result.loadTime = DBL_MAX;
+  result.peakMemory = 0;
+
+  arma::wall_clock clock;
+  for (size_t r = 0; r < repetitions; ++r)
+  {
+    clock.tic();
+    const bool saved = SaveMatrix(format, filename, matrix, transpose);
+    result.saveTime = std::min(result.saveTime, clock.toc());
+    if (!saved)
+    {
+      Log::Warn << "Could not save '" << filename << "'; skipping " << format
+          << "." << endl;
+      remove(filename.c_str());
+      return;
+    }
+    result.fileSize = FileSize(filename);
+
+    arma::mat loaded;
+    util::ResetPeakResidentMemory();
+    clock.tic();
+    const bool success = data::Load(filename, loaded, false, transpose);
+    result.loadTime = std::min(result.loadTime, clock.toc());
+    result.peakMemory = std::max(result.peakMemory,
+        util::PeakResidentMemory() / 1024);
+
+    if (!success)
+    {
+      Log::Warn << "Could not load '" << filename << "'; skipping " << format
+          << "." << endl;
+      remove(filename.c_str());
+      return;
+    }
+    if (loaded.n_elem != matrix.n_elem)
+      Log::Warn << format << ": loaded " << loaded.n_elem << " elements "
+          << "instead of " << matrix.n_elem << "." << endl;
+  }
+  remove(filename.c_str());
+
+  const double megabytes = matrix.n_elem * sizeof(double) / 1e6;
+  cout << setw(12) << left << result.format << right << setw(9)
+      << result.rows << setw(10) << result.cols << setw(6)
+      << (result.transpose ? "yes" : "no") << fixed << setprecision(4)
+      << setw(10) << result.saveTime << setprecision(1) << setw(10)
+      << (megabytes / result.saveTime) << setprecision(4) << setw(10)
+      << result.loadTime << setprecision(1) << setw(10)
+      << (megabytes / result.loadTime) << setw(11)
+      << (result.fileSize / 1e6) << setw(11)
+      << (result.peakMemory / 1024.0) << endl;
+
+  results.push_back(result);
+}
+
+//! Time data::inplace_transpose() on the matrix, and add the result.
+void BenchmarkTranspose(const arma::mat& matrix,
+                        vector<BenchmarkResult>& results)
+{
+  const size_t repetitions = (size_t) CLI::GetParam<int>("repetitions");
+
+  BenchmarkResult result;
+  result.format = "transpose";
+  result.rows = matrix.n_rows;
+  result.cols = matrix.n_cols;
+  result.transpose = true;
+  result.saveTime = -1.0;
+  result.loadTime = DBL_MAX;
+  result.fileSize = 0;
+  result.peakMemory = 0;
+
+  arma::wall_clock clock;
+  for (size_t r = 0; r < repetitions; ++r)
+  {
+    arma::mat copy(matrix);
+    util::ResetPeakResidentMemory();
+    clock.tic();
+    data::inplace_transpose(copy);
+    result.loadTime = std::min(result.loadTime, clock.toc());
+    result.peakMemory = std::max(result.peakMemory,
+        util::PeakResidentMemory() / 1024);
+  }
+
+  const double megabytes = matrix.n_elem * sizeof(double) / 1e6;
+  cout << setw(12) << left << result.format << right << setw(9)
+      << result.rows << setw(10) << result.cols << setw(6) << "yes"
+      << setw(10) << "-" << setw(10) << "-" << fixed << setprecision(4)
+      << setw(10) << result.loadTime << setprecision(1) << setw(10)
+      << (megabytes / result.loadTime) << setw(11) << "-" << setw(11)
+      << (result.peakMemory / 1024.0) << endl;
+
+  results.push_back(result);
+}
+
+//! Save the results as CSV.
+void SaveResults(const string& filename,
+                 const vector<BenchmarkResult>& results)
+{
+  ofstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open '" << filename << "' for writing!" << endl;
+
+  file << "format,rows,cols,transpose,save_time,load_time,file_size,"
+      << "peak_memory_kb" << endl;
+  file << setprecision(17);
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    file << r.Key() << ",";
+    if (r.saveTime >= 0.0)
+      file << r.saveTime;
+    file << "," << r.loadTime << "," << r.fileSize << "," << r.peakMemory
+        << endl;
+  }
+}
+
+//! Compare the results with a baseline, and return the number of regressions.
+size_t CompareResults(const string& filename,
+                      const vector<BenchmarkResult>& results)
+{
+  ifstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open baseline file '" << filename << "'!" << endl;
+
+  // Read the baseline, keyed by the benchmark.  The save time of the transpose
+  // is empty, so the line is split by hand.
+  map<string, pair<double, double> > baseline;
+  string line;
+  getline(file, line); // Skip the header.
+  while (getline(file, line))
+  {
+    vector<string> fields;
+    istringstream stream(line);
+    string field;
+    while (getline(stream, field, ','))
+      fields.push_back(field);
+    if (fields.size() != 8)
+      continue;
+
+    const string key = fields[0] + "," + fields[1] + "," + fields[2] + "," +
+        fields[3];
+    baseline[key] = make_pair((fields[4] == "") ? -1.0 :
+        atof(fields[4].c_str()), atof(fields[5].c_str()));
+  }
+
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  size_t regressions = 0;
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    map<string, pair<double, double> >::const_iterator it =
+        baseline.find(results[i].Key());
+    if (it == baseline.end())
+      continue;
+
+    if (results[i].saveTime >= 0.0 && it->second.first >= 0.0 &&
+        results[i].saveTime > (1.0 + tolerance) * it->second.first)
+    {
+      Log::Warn << results[i].Key() << ": save took " << results[i].saveTime
+          << "s instead of " << it->second.first << "s." << endl;
+      ++regressions;
+    }
+    if (results[i].loadTime > (1.0 + tolerance) * it->second.second)
+    {
+      Log::Warn << results[i].Key() << ": load took " << results[i].loadTime
+          << "s instead of " << it->second.second << "s." << endl;
+      ++regressions;
+    }
+  }
+
+  return regressions;
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("repetitions") < 1)
+    Log::Fatal << "Invalid number of repetitions: "
+        << CLI::GetParam<int>("repetitions") << "." << endl;
+
+  vector<string> formats;
+  const vector<string> formatList = SplitList(CLI::GetParam<string>("formats"));
+  for (size_t i = 0; i < formatList.size(); ++i)
+  {
+    Extension(formatList[i]); // Check that the format is known.
+#ifndef ARMA_USE_HDF5
+    if (formatList[i] == "hdf5")
+    {
+      Log::Warn << "Armadillo was compiled without HDF5 support; skipping "
+          << "hdf5." << endl;
+      continue;
+    }
+#endif
+    formats.push_back(formatList[i]);
+  }
+
+  const vector<string> sizeList = SplitList(CLI::GetParam<string>("sizes"));
+  vector<pair<size_t, size_t> > sizes;
+  for (size_t i = 0; i < sizeList.size(); ++i)
+  {
+    const size_t x = sizeList[i].find('x');
+    const int rows = atoi(sizeList[i].substr(0, x).c_str());
+    const int cols = (x == string::npos) ? 0 :
+        atoi(sizeList[i].substr(x + 1).c_str());
+    if (rows < 1 || cols < 1)
+      Log::Fatal << "Invalid size: '" << sizeList[i] << "'." << endl;
+    sizes.push_back(make_pair((size_t) rows, (size_t) cols));
+  }
+
+  cout << setw(12) << left << "format" << right << setw(9) << "rows"
+      << setw(10) << "cols" << setw(6) << "trans" << setw(10) << "save (s)"
+      << setw(10) << "save MB/s" << setw(10) << "load (s)" << setw(10)
+      << "load MB/s" << setw(11) << "file (MB)" << setw(11) << "peak (MB)"
+      << endl;
+
+  vector<BenchmarkResult> results;
+  for (size_t s = 0; s < sizes.size(); ++s)
+  {
+    // Every matrix is generated from the same seed, and holds integers so that
+    // PGM files can hold it.
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+    const arma::mat matrix = arma::floor(256 * arma::randu<arma::mat>(
+        sizes[s].first, sizes[s].second));
+
+    for (size_t f = 0; f < formats.size(); ++f)
+    {
+      Benchmark(formats[f], matrix, true, results);
+      Benchmark(formats[f], matrix, false, results);
+    }
+    BenchmarkTranspose(matrix, results);
+  }
+
+  if (CLI::GetParam<string>("output_file") != "")
+    SaveResults(CLI::GetParam<string>("output_file"), results);
+
+  if (CLI::GetParam<string>("baseline_file") != "")
+  {
+    const size_t regressions = CompareResults(
+        CLI::GetParam<string>("baseline_file"), results);
+    if (regressions > 0)
+    {
+      Log::Warn << regressions << " regressions compared to the baseline."
+          << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,422 @@
+/**
+ * @file micro_benchmark.cpp
+ * @author Ryan Curtin
+ *
+ * Timings of single calls of the innermost functions: the metrics, the
+ * distances of the bounds, the kernels and the Gaussian density.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/tree/bounds.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <type_traits>
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::bound;
+using namespace mlpack::distribution;
+using namespace mlpack::kernel;
+using namespace mlpack::metric;
+
+PROGRAM_INFO("Micro-benchmarks",
+    "This program times single calls of the innermost functions of the "
+    "library, in nanoseconds per call, for every given dimensionality and "
+    "element type: the L-metrics, the point and bound distances of "
+    "HRectBound and BallBound, the Evaluate() function of every vector kernel "
+    "and GaussianDistribution::Probability()."
+    "\n\n"
+    "Every function is called on pairs of vectors (or bounds) from a pool of "
+    "256 random ones, so that the arguments are not always the same but still "
+    "fit in the cache.  The number of calls is doubled until a run takes at "
+    "least --min_time seconds, and the time per call is the minimum over "
+    "--repetitions runs of that many calls; it includes the loop and the "
+    "lookup of the arguments, which take about a nanosecond.  The distances "
+    "between two bounds and the Gaussian density don't depend on the element "
+    "type of the data, so they are only run for 'double'."
+    "\n\n"
+    "The benchmarks are 'manhattan', 'euclidean', 'squared_euclidean', "
+    "'chebyshev', 'hrect_min_point', 'hrect_max_point', 'hrect_min_bound', "
+    "'hrect_max_bound', 'ball_min_point', 'ball_max_point', 'ball_min_bound', "
+    "'ball_max_bound', 'linear', 'polynomial', 'cosine', 'gaussian', "
+    "'laplacian', 'epanechnikov', 'triangular', 'spherical', "
+    "'hyperbolic_tangent' and 'gaussian_probability'.  The element types are "
+    "'double' and 'float'."
+    "\n\n"
+    "If --baseline_file is given, the results are compared with those of a "
+    "previous run saved with --output_file, and the program fails if a "
+    "function became slower than the tolerance allows.");
+
+PARAM_STRING("benchmarks", "Comma-separated list of the benchmarks to run (or "
+    "'all').", "b", "all");
+PARAM_STRING("dimensions", "Comma-separated list of dimensionalities.", "d",
+    "2,3,8,32,128,1024");
+PARAM_STRING("types", "Comma-separated list of element types.", "t",
+    "double,float");
+PARAM_DOUBLE("min_time", "Minimum time of a run, in seconds.", "m", 0.05);
+PARAM_INT("repetitions", "Number of runs of every benchmark.", "R", 5);
+PARAM_INT("seed", "Random seed for the vectors and bounds.", "s", 42);
+PARAM_STRING("output_file", "File to save the results in, as CSV (optional).",
+    "o", "");
+PARAM_STRING("baseline_file", "File with the results of a previous run, to "
+    "check for regressions (optional).", "B", "");
+PARAM_DOUBLE("tolerance", "Relative slowdown of a function, compared to the "
+    "baseline, that is considered a regression.", "e", 0.25);
+
+//! The result of a single benchmark.
+struct BenchmarkResult
+{
+  string benchmark;
+  string type;
+  size_t dimensions;
+  double nanoseconds;
+
+  //! The key that identifies the benchmark in a baseline.
+  string Key() const
+  {
+    ostringstream key;
+    key << benchmark << "," << type << "," << dimensions;
+    return key.str();
+  }
+};
+
+//! The number of vectors (and bounds) that the arguments are taken from; a
+//! power of two, so the index of an argument is a mask.
+static const size_t poolSize = 256;
+static const size_t poolMask = poolSize - 1;
+
+//! The sum of the results of all calls, so they can't be optimized away.
+volatile double sink;
+
+//! Split a comma-separated list.
+vector<string> SplitList(const string& list)
+{
+  vector<string> items;
+  istringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+    if (item != "")
+      items.push_back(item);
+  return items;
+}
+
+//! Return whether or not the given benchmark should be run.
+bool Selected(const string& benchmark)
+{
+  const string list = "," + CLI::GetParam<string>("benchmarks") + ",";
+  return (list == ",all,") || (list.find("," + benchmark + ",") !=
+      string::npos);
+}
+
+/**
+ * Time the calls of the given function (which takes the index of the call and
+ * returns a double), and add the result.
+ */
+template<typename FunctionType>
+void Benchmark(const string& benchmark,
+               const string& type,
+               const size_t dimensions,
+               FunctionType function,
+               vector<BenchmarkResult>& results)
+{
+  if (!Selected(benchmark))
+    return;
+
+  const double minTime = CLI::GetParam<double>("min_time");
+  const size_t repetitions = (size_t) CLI::GetParam<int>("repetitions");
+  arma::wall_clock clock;
+  double sum = 0.0;
+
+  // Find the number of calls that takes at least the minimum time.
+  size_t calls = 1024;
+  double time;
+  while (true)
+  {
+    clock.tic();
+    for (size_t i = 0; i < calls; ++i)
+      sum += function(i);
+    time = clock.toc();
+
+    if (time >= minTime)
+      break;
+    calls *= 2;
+  }
+
+  double best = time / calls;
+  for (size_t r = 1; r < repetitions; ++r)
+  {
+    clock.tic();
+    for (size_t i = 0; i < calls; ++i)
+      sum += function(i);
+    best = std::min(best, clock.toc() / calls);
+  }
+  sink = sum;
+
+  BenchmarkResult result;
+  result.benchmark = benchmark;
+  result.type = type;
+  result.dimensions = dimensions;
+  result.nanoseconds = 1e9 * best;
+
+  cout << setw(22) << left << result.benchmark << setw(8) << result.type
+      << right << setw(6) << result.dimensions << fixed << setprecision(2)
+      << setw(13) << result.nanoseconds << endl;
+
+  results.push_back(result);
+}
+
+/**
+ * Run the benchmarks of the metrics, the bounds and the kernels with the given
+ * element type.
+ */
+template<typename eT>
+void BenchmarkElementType(const string& type,
+                          const size_t dimensions,
+                          vector<BenchmarkResult>& results)
+{
+  typedef arma::Col<eT> VecType;
+
+  math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+
+  // Every bound is around a few random points near a random corner.
+  vector<VecType> points(poolSize);
+  vector<HRectBound<2> > hrects(poolSize, HRectBound<2>(dimensions));
+  vector<BallBound<VecType> > balls;
+  for (size_t i = 0; i < poolSize; ++i)
+  {
+    points[i] = arma::randu<VecType>(dimensions);
+
+    const arma::Mat<eT> corner = arma::repmat(
+        arma::randu<arma::Mat<eT> >(dimensions, 1), 1, 4);
+    hrects[i] |= arma::Mat<eT>(corner + eT(0.1) *
+        arma::randu<arma::Mat<eT> >(dimensions, 4));
+    balls.push_back(BallBound<VecType>(0.1 * math::Random(),
+        arma::randu<VecType>(dimensions)));
+  }
+
+  // The metrics.
+  Benchmark("manhattan", type, dimensions, [&](const size_t i) {
+      return ManhattanDistance::Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("euclidean", type, dimensions, [&](const size_t i) {
+      return EuclideanDistance::Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("squared_euclidean", type, dimensions, [&](const size_t i) {
+      return SquaredEuclideanDistance::Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("chebyshev", type, dimensions, [&](const size_t i) {
+      return ChebyshevDistance::Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+
+  // The bounds.
+  Benchmark("hrect_min_point", type, dimensions, [&](const size_t i) {
+      return hrects[i & poolMask].MinDistance(points[(i + 1) & poolMask]); },
+      results);
+  Benchmark("hrect_max_point", type, dimensions, [&](const size_t i) {
+      return hrects[i & poolMask].MaxDistance(points[(i + 1) & poolMask]); },
+      results);
+  Benchmark("ball_min_point", type, dimensions, [&](const size_t i) {
+      return balls[i & poolMask].MinDistance(points[(i + 1) & poolMask]); },
+      results);
+  Benchmark("ball_max_point", type, dimensions, [&](const size_t i) {
+      return balls[i & poolMask].MaxDistance(points[(i + 1) & poolMask]); },
+      results);
+
+  if (std::is_same<eT, double>::value)
+  {
+    Benchmark("hrect_min_bound", type, dimensions, [&](const size_t i) {
+        return hrects[i & poolMask].MinDistance(hrects[(i + 1) & poolMask]); },
+        results);
+    Benchmark("hrect_max_bound", type, dimensions, [&](const size_t i) {
+        return hrects[i & poolMask].MaxDistance(hrects[(i + 1) & poolMask]); },
+        results);
+    Benchmark("ball_min_bound", type, dimensions, [&](const size_t i) {
+        return balls[i & poolMask].MinDistance(balls[(i + 1) & poolMask]); },
+        results);
+    Benchmark("ball_max_bound", type, dimensions, [&](const size_t i) {
+        return balls[i & poolMask].MaxDistance(balls[(i + 1) & poolMask]); },
+        results);
+  }
+
+  // The kernels, with bandwidths that make their values nontrivial for points
+  // in the unit cube.
+  const double bandwidth = sqrt((double) dimensions) / 2;
+  PolynomialKernel polynomial(3.0, 1.0);
+  GaussianKernel gaussian(bandwidth);
+  LaplacianKernel laplacian(bandwidth);
+  EpanechnikovKernel epanechnikov(bandwidth);
+  TriangularKernel triangular(bandwidth);
+  SphericalKernel spherical(bandwidth);
+  HyperbolicTangentKernel hyperbolicTangent(1.0 / dimensions, 0.0);
+
+  Benchmark("linear", type, dimensions, [&](const size_t i) {
+      return LinearKernel::Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("polynomial", type, dimensions, [&](const size_t i) {
+      return polynomial.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("cosine", type, dimensions, [&](const size_t i) {
+      return CosineDistance::Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("gaussian", type, dimensions, [&](const size_t i) {
+      return gaussian.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("laplacian", type, dimensions, [&](const size_t i) {
+      return laplacian.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("epanechnikov", type, dimensions, [&](const size_t i) {
+      return epanechnikov.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("triangular", type, dimensions, [&](const size_t i) {
+      return triangular.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("spherical", type, dimensions, [&](const size_t i) {
+      return spherical.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+  Benchmark("hyperbolic_tangent", type, dimensions, [&](const size_t i) {
+      return hyperbolicTangent.Evaluate(points[i & poolMask],
+          points[(i + 1) & poolMask]); }, results);
+}
+
+//! Run the benchmark of the Gaussian density (which only takes doubles).
+void BenchmarkGaussianProbability(const size_t dimensions,
+                                  vector<BenchmarkResult>& results)
+{
+  math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+
+  vector<arma::vec> points(poolSize);
+  for (size_t i = 0; i < poolSize; ++i)
+    points[i] = arma::randu<arma::vec>(dimensions);
+
+  // A random positive definite covariance.
+  const arma::mat a = arma::randu<arma::mat>(dimensions, dimensions);
+  const arma::mat covariance = a * a.t() / dimensions +
+      arma::eye<arma::mat>(dimensions, dimensions);
+  GaussianDistribution distribution(
+      0.5 * arma::ones<arma::vec>(dimensions), covariance);
+
+  Benchmark("gaussian_probability", "double", dimensions, [&](const size_t i) {
+      return distribution.Probability(points[i & poolMask]); }, results);
+}
+
+//! Save the results as CSV.
+void SaveResults(const string& filename,
+                 const vector<BenchmarkResult>& results)
+{
+  ofstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open '" << filename << "' for writing!" << endl;
+
+  file << "benchmark,type,dimensions,nanoseconds" << endl;
+  file << setprecision(17);
+  for (size_t i = 0; i < results.size(); ++i)
+    file << results[i].Key() << "," << results[i].nanoseconds << endl;
+}
+
+//! Compare the results with a baseline, and return the number of regressions.
+size_t CompareResults(const string& filename,
+                      const vector<BenchmarkResult>& results)
+{
+  ifstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open baseline file '" << filename << "'!" << endl;
+
+  // Read the baseline, keyed by the benchmark.
+  map<string, double> baseline;
+  string line;
+  getline(file, line); // Skip the header.
+  while (getline(file, line))
+  {
+    const vector<string> fields = SplitList(line);
+    if (fields.size() != 4)
+      continue;
+
+    const string key = fields[0] + "," + fields[1] + "," + fields[2];
+    baseline[key] = atof(fields[3].c_str());
+  }
+
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  size_t regressions = 0;
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    map<string, double>::const_iterator it = baseline.find(results[i].Key());
+    if (it == baseline.end())
+      continue;
+
+    if (results[i].nanoseconds > (1.0 + tolerance) * it->second)
+    {
+      Log::Warn << results[i].Key() << ": " << results[i].nanoseconds
+          << "ns per call instead of " << it->second << "ns." << endl;
+      ++regressions;
+    }
+  }
+
+  return regressions;
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<double>("min_time") <= 0.0)
+    Log::Fatal << "Invalid minimum time: " << CLI::GetParam<double>("min_time")
+        << ".  Must be greater than 0." << endl;
+  if (CLI::GetParam<int>("repetitions") < 1)
+    Log::Fatal << "Invalid number of repetitions: "
+        << CLI::GetParam<int>("repetitions") << "." << endl;
+
+  const vector<string> types = SplitList(CLI::GetParam<string>("types"));
+  const vector<string> dimensionList =
+      SplitList(CLI::GetParam<string>("dimensions"));
+  vector<size_t> dimensions;
+  for (size_t i = 0; i < dimensionList.size(); ++i)
+  {
+    const int d = atoi(dimensionList[i].c_str());
+    if (d < 1)
+      Log::Fatal << "Invalid dimensionality: '" << dimensionList[i] << "'."
+          << endl;
+    dimensions.push_back((size_t) d);
+  }
+  for (size_t i = 0; i < types.size(); ++i)
+    if (types[i] != "double" && types[i] != "float")
+      Log::Fatal << "Unknown element type '" << types[i] << "'!" << endl;
+
+  cout << setw(22) << left << "benchmark" << setw(8) << "type" << right
+      << setw(6) << "dims" << setw(13) << "ns per call" << endl;
+
+  vector<BenchmarkResult> results;
+  for (size_t d = 0; d < dimensions.size(); ++d)
+  {
+    for (size_t i = 0; i < types.size(); ++i)
+    {
+      if (types[i] == "double")
+      {
+        BenchmarkElementType<double>("double", dimensions[d], results);
+        BenchmarkGaussianProbability(dimensions[d], results);
+      }
+      else
+      {
+        BenchmarkElementType<float>("float", dimensions[d], results);
+      }
+    }
+  }
+
+  if (CLI::GetParam<string>("output_file") != "")
+    SaveResults(CLI::GetParam<string>("output_file"), results);
+
+  if (CLI::GetParam<string>("baseline_file") != "")
+  {
+    const size_t regressions = CompareResults(
+        CLI::GetParam<string>("baseline_file"), results);
+    if (regressions > 0)
+    {
+      Log::Warn << regressions << " regressions compared to the baseline."
+          << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
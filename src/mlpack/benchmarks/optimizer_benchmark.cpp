@@ -0,0 +1,654 @@
+/**
+ * @file optimizer_benchmark.cpp
+ * @author Ryan Curtin
+ *
+ * Reproducible timings of the optimizers and learners on standard problems,
+ * reported as JSON so that they can be compared between releases.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
+#include <mlpack/core/optimizers/aug_lagrangian/aug_lagrangian.hpp>
+#include <mlpack/core/optimizers/aug_lagrangian/aug_lagrangian_test_functions.hpp>
+#include <mlpack/core/optimizers/sdp/lrsdp.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression_function.hpp>
+#include <mlpack/methods/softmax_regression/softmax_regression_function.hpp>
+
+#include <mlpack/methods/ann/activation_functions/logistic_function.hpp>
+#include <mlpack/methods/ann/init_rules/random_init.hpp>
+#include <mlpack/methods/ann/layer/neuron_layer.hpp>
+#include <mlpack/methods/ann/layer/bias_layer.hpp>
+#include <mlpack/methods/ann/layer/binary_classification_layer.hpp>
+#include <mlpack/methods/ann/connections/full_connection.hpp>
+#include <mlpack/methods/ann/trainer/trainer.hpp>
+#include <mlpack/methods/ann/ffnn.hpp>
+#include <mlpack/methods/ann/performance_functions/mse_function.hpp>
+#include <mlpack/methods/ann/optimizer/steepest_descent.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
+using namespace mlpack::ann;
+
+PROGRAM_INFO("Optimizer benchmarks",
+    "This program times the optimizers (SGD, L-BFGS, the augmented Lagrangian "
+    "method and LRSDP) and the neural network trainer on standard problems: "
+    "the optimizer test functions, logistic regression on a synthetic dataset, "
+    "softmax regression and a feedforward network on the MNIST subset of the "
+    "test data, and the Lovasz-theta SDP of the johnson8-4-4 graph."
+    "\n\n"
+    "For every benchmark, the full run (until the optimizer converges) is "
+    "timed, and its number of evaluations and its peak memory usage are "
+    "reported.  The time to accuracy is the time of the shortest run that "
+    "reaches the target objective, searched by doubling the iteration budget "
+    "of the optimizer; the target is the known optimum of the problem if there "
+    "is one, and the objective of the full run otherwise.  An objective is "
+    "considered to reach the target if it is within --relative_tolerance of "
+    "it.  The neural network is trained one epoch at a time, and the target is "
+    "a validation error of at most --ann_target."
+    "\n\n"
+    "The evaluations are the evaluations of the objective and gradient for "
+    "L-BFGS (including the ones of the inner L-BFGS optimizer of the augmented "
+    "Lagrangian method and LRSDP), the gradient evaluations of single "
+    "functions for SGD, and the training samples for the neural network.  "
+    "LRSDP has no iteration budget, so its time to accuracy is the time of the "
+    "full run."
+    "\n\n"
+    "The results are written as JSON to --output_file, or to stdout.  All data "
+    "is generated or shuffled with --seed, which is set again before every "
+    "run.");
+
+PARAM_STRING("benchmarks", "Comma-separated list of the benchmarks to run, as "
+    "'optimizer/problem' (or 'all').", "b", "all");
+PARAM_STRING("output_file", "File to save the JSON results in (if not given, "
+    "they are printed).", "o", "");
+PARAM_STRING("mnist_file", "File containing the MNIST subset of the test "
+    "data.", "m", "mnist_first250_training_4s_and_9s.arm");
+PARAM_STRING("graph_file", "File containing the edges of the graph for the "
+    "Lovasz-theta SDP.", "g", "johnson8-4-4.csv");
+PARAM_INT("points", "Number of points of the synthetic logistic regression "
+    "dataset.", "n", 1000000);
+PARAM_INT("dimensions", "Dimensionality of the synthetic logistic regression "
+    "dataset.", "d", 10);
+PARAM_DOUBLE("relative_tolerance", "Relative tolerance of the target "
+    "objective.", "e", 1e-3);
+PARAM_DOUBLE("ann_target", "Target validation error of the neural network.",
+    "a", 0.05);
+PARAM_INT("ann_epochs", "Maximum number of epochs of the neural network.", "E",
+    100);
+PARAM_INT("seed", "Random seed.", "s", 42);
+PARAM_INT("threads", "Number of threads to use (0 uses all available cores; "
+    "ignored without OpenMP).", "T", 0);
+
+//! The result of a single benchmark.
+struct BenchmarkResult
+{
+  string optimizer;
+  string problem;
+  double target;
+  double objective;
+  double time;
+  size_t evaluations;
+  size_t peakMemory;
+  bool reachedTarget;
+  double timeToTarget;
+  size_t evaluationsToTarget;
+};
+
+//! Return the peak memory usage (resident set size) in kilobytes, or 0.
+size_t PeakMemory()
+{
+  return util::PeakResidentMemory() / 1024;
+}
+
+//! Return whether or not the objective is within the tolerance of the target.
+bool ReachesTarget(const double objective, const double target)
+{
+  const double tolerance = CLI::GetParam<double>("relative_tolerance");
+  return (objective == objective) &&
+      (objective <= target + tolerance * std::max(1.0, fabs(target)));
+}
+
+//! The objective of a decomposable function, summed over all functions.
+template<typename FunctionType>
+double DecomposableObjective(FunctionType& function, const arma::mat& iterate)
+{
+  double objective = 0.0;
+  for (size_t i = 0; i < function.NumFunctions(); ++i)
+    objective += function.Evaluate(iterate, i);
+  return objective;
+}
+
+/**
+ * Run L-BFGS on a function.  The budget is the maximum number of iterations.
+ */
+template<typename FunctionType>
+class LBFGSRun
+{
+ public:
+  LBFGSRun(FunctionType& function) : function(function) { }
+
+  //! L-BFGS can be stopped after any number of iterations.
+  static const bool Budgeted = true;
+  //! The first budget of the search for the time to accuracy.
+  size_t FirstBudget() const { return 1; }
+
+  //! Run the optimizer with the given budget (0 means until convergence).
+  double Run(const size_t budget, size_t& evaluations)
+  {
+    L_BFGS<FunctionType> lbfgs(function);
+    arma::mat iterate = function.GetInitialPoint();
+    const double objective = lbfgs.Optimize(iterate, budget);
+    evaluations = lbfgs.NumEvaluations();
+    return objective;
+  }
+
+ private:
+  FunctionType& function;
+};
+
+/**
+ * Run SGD on a decomposable function.  The budget is the maximum number of
+ * iterations (single function gradients).
+ */
+template<typename FunctionType>
+class SGDRun
+{
+ public:
+  SGDRun(FunctionType& function,
+         const double stepSize,
+         const size_t maxIterations,
+         const double tolerance) :
+      function(function),
+      stepSize(stepSize),
+      maxIterations(maxIterations),
+      tolerance(tolerance)
+  { }
+
+  //! SGD can be stopped after any number of iterations.
+  static const bool Budgeted = true;
+  //! The first budget is a single pass over the functions.
+  size_t FirstBudget() const { return function.NumFunctions(); }
+
+  //! Run the optimizer with the given budget (0 means the default maximum).
+  double Run(const size_t budget, size_t& evaluations)
+  {
+    SGD<FunctionType> sgd(function, stepSize,
+        (budget == 0) ? maxIterations : std::min(budget, maxIterations),
+        tolerance);
+    arma::mat iterate = function.GetInitialPoint();
+    sgd.Optimize(iterate);
+    evaluations = sgd.NumEvaluations();
+
+    // SGD returns the objective summed during the last pass; the objective of
+    // the final iterate is comparable between runs.
+    return DecomposableObjective(function, iterate);
+  }
+
+ private:
+  FunctionType& function;
+  double stepSize;
+  size_t maxIterations;
+  double tolerance;
+};
+
+/**
+ * Run the augmented Lagrangian method on a constrained function.  The budget is
+ * the maximum number of outer iterations.
+ */
+template<typename FunctionType>
+class AugLagrangianRun
+{
+ public:
+  AugLagrangianRun(FunctionType& function) : function(function) { }
+
+  //! The augmented Lagrangian method can be stopped after any iteration.
+  static const bool Budgeted = true;
+  //! The first budget of the search for the time to accuracy.
+  size_t FirstBudget() const { return 1; }
+
+  //! Run the optimizer with the given budget (0 means until convergence).
+  double Run(const size_t budget, size_t& evaluations)
+  {
+    AugLagrangian<FunctionType> aug(function);
+    arma::mat iterate = function.GetInitialPoint();
+    aug.Optimize(iterate, budget);
+    evaluations = aug.LBFGS().NumEvaluations();
+    return function.Evaluate(iterate);
+  }
+
+ private:
+  FunctionType& function;
+};
+
+/**
+ * Run LRSDP on the Lovasz-theta SDP of a graph, set up as in Monteiro and
+ * Burer (2004).  LRSDP has no iteration budget.
+ */
+class LovaszThetaLRSDPRun
+{
+ public:
+  LovaszThetaLRSDPRun(const arma::mat& edges) : edges(edges) { }
+
+  //! LRSDP always runs until convergence.
+  static const bool Budgeted = false;
+  //! There is no budget.
+  size_t FirstBudget() const { return 0; }
+
+  //! Solve the SDP (the budget is ignored).
+  double Run(const size_t /* budget */, size_t& evaluations)
+  {
+    const size_t vertices = max(max(edges)) + 1;
+    const size_t m = edges.n_cols + 1;
+    double r = 0.5 + sqrt(0.25 + 2 * m);
+    if (ceil(r) > vertices)
+      r = vertices;
+
+    arma::mat coordinates(vertices, ceil(r));
+    for (size_t i = 0; i < vertices; ++i)
+      for (size_t j = 0; j < ceil(r); ++j)
+        coordinates(i, j) = sqrt(1.0 / (vertices * m)) +
+            ((i == j) ? sqrt(1.0 / r) : 0.0);
+
+    LRSDP<SDP<arma::mat> > lovasz(edges.n_cols + 1, 0, coordinates);
+
+    // C = -(e e^T); A_0 = I with b_0 = 1; A_ij = e_i e_j^T + e_j e_i^T with
+    // b_ij = 0.
+    lovasz.SDP().C().ones(vertices, vertices);
+    lovasz.SDP().C() *= -1;
+    lovasz.SDP().SparseB().zeros(edges.n_cols + 1);
+    lovasz.SDP().SparseB()[0] = 1;
+    lovasz.SDP().SparseA()[0].eye(vertices, vertices);
+    for (size_t i = 0; i < edges.n_cols; ++i)
+    {
+      lovasz.SDP().SparseA()[i + 1].zeros(vertices, vertices);
+      lovasz.SDP().SparseA()[i + 1](edges(0, i), edges(1, i)) = 1.0;
+      lovasz.SDP().SparseA()[i + 1](edges(1, i), edges(0, i)) = 1.0;
+    }
+
+    lovasz.AugLag().Lambda().ones(edges.n_cols + 1);
+    lovasz.AugLag().Lambda() *= -1;
+    lovasz.AugLag().Lambda()[0] = -double(vertices);
+
+    const double objective = lovasz.Optimize(coordinates);
+    evaluations = lovasz.AugLag().LBFGS().NumEvaluations();
+    return objective;
+  }
+
+ private:
+  const arma::mat& edges;
+};
+
+/**
+ * Time the full run of the given optimizer, and search for the shortest run
+ * that reaches the target by doubling the budget.  If knownTarget is false, the
+ * objective of the full run is the target.
+ */
+template<typename RunType>
+void Benchmark(const string& optimizer,
+               const string& problem,
+               RunType& run,
+               const bool knownTarget,
+               const double target,
+               vector<BenchmarkResult>& results)
+{
+  const size_t seed = (size_t) CLI::GetParam<int>("seed");
+
+  BenchmarkResult result;
+  result.optimizer = optimizer;
+  result.problem = problem;
+
+  Log::Info << "Running " << optimizer << "/" << problem << "..." << endl;
+
+  arma::wall_clock clock;
+  util::ResetPeakResidentMemory();
+  math::RandomSeed(seed);
+  clock.tic();
+  result.objective = run.Run(0, result.evaluations);
+  result.time = clock.toc();
+  result.peakMemory = PeakMemory();
+
+  result.target = knownTarget ? target : result.objective;
+  result.reachedTarget = ReachesTarget(result.objective, result.target);
+  result.timeToTarget = result.time;
+  result.evaluationsToTarget = result.evaluations;
+
+  if (result.reachedTarget && RunType::Budgeted)
+  {
+    for (size_t budget = run.FirstBudget(); ; budget *= 2)
+    {
+      size_t evaluations;
+      math::RandomSeed(seed);
+      clock.tic();
+      const double objective = run.Run(budget, evaluations);
+      const double time = clock.toc();
+
+      if (ReachesTarget(objective, result.target))
+      {
+        result.timeToTarget = std::min(time, result.time);
+        result.evaluationsToTarget = std::min(evaluations, result.evaluations);
+        break;
+      }
+
+      // A budget that does as much work as the full run can't do better.
+      if (evaluations >= result.evaluations)
+        break;
+    }
+  }
+
+  results.push_back(result);
+}
+
+/**
+ * Train a feedforward network with one hidden layer to separate the 4s from
+ * the 9s of the MNIST subset, one epoch at a time, until the validation error
+ * reaches the target.
+ */
+void BenchmarkNetwork(const arma::mat& mnist, vector<BenchmarkResult>& results)
+{
+  const double target = CLI::GetParam<double>("ann_target");
+  const size_t maxEpochs = (size_t) CLI::GetParam<int>("ann_epochs");
+
+  arma::mat dataset(mnist);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) /= norm(dataset.col(i), 2);
+
+  // The first half of the points are 4s, the second half 9s.
+  arma::mat labels = arma::zeros(1, dataset.n_cols);
+  labels.cols(labels.n_cols / 2, labels.n_cols - 1).fill(1);
+
+  BenchmarkResult result;
+  result.optimizer = "ann";
+  result.problem = "mnist";
+  result.target = target;
+  result.reachedTarget = false;
+  result.evaluations = 0;
+
+  Log::Info << "Running ann/mnist..." << endl;
+
+  arma::wall_clock clock;
+  util::ResetPeakResidentMemory();
+  math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  clock.tic();
+
+  RandomInitialization randInit(-0.5, 0.5);
+
+  BiasLayer<> biasLayer(1);
+  NeuronLayer<LogisticFunction> inputLayer(dataset.n_rows);
+  NeuronLayer<LogisticFunction> hiddenLayer0(100);
+  NeuronLayer<LogisticFunction> hiddenLayer1(labels.n_rows);
+  BinaryClassificationLayer outputLayer;
+
+  SteepestDescent<> conOptimizer0(dataset.n_rows, 100);
+  SteepestDescent<> conOptimizer1(1, 100);
+  SteepestDescent<> conOptimizer2(100, labels.n_rows);
+
+  FullConnection<decltype(inputLayer), decltype(hiddenLayer0),
+      decltype(conOptimizer0), decltype(randInit)>
+      layerCon0(inputLayer, hiddenLayer0, conOptimizer0, randInit);
+  FullConnection<decltype(biasLayer), decltype(hiddenLayer0),
+      decltype(conOptimizer1), decltype(randInit)>
+      layerCon1(biasLayer, hiddenLayer0, conOptimizer1, randInit);
+  FullConnection<decltype(hiddenLayer0), decltype(hiddenLayer1),
+      decltype(conOptimizer2), decltype(randInit)>
+      layerCon2(hiddenLayer0, hiddenLayer1, conOptimizer2, randInit);
+
+  auto module0 = std::tie(layerCon0, layerCon1);
+  auto module1 = std::tie(layerCon2);
+  auto modules = std::tie(module0, module1);
+
+  FFNN<decltype(modules), decltype(outputLayer), MeanSquaredErrorFunction>
+      net(modules, outputLayer);
+
+  // Every call of Train() is a single epoch, so the time to the target can be
+  // taken directly.
+  Trainer<decltype(net)> trainer(net, 1, 1, 0.0);
+  for (size_t epoch = 0; epoch < maxEpochs; ++epoch)
+  {
+    trainer.Train(dataset, labels, dataset, labels);
+    result.evaluations += dataset.n_cols;
+    if (trainer.ValidationError() <= target)
+    {
+      result.reachedTarget = true;
+      break;
+    }
+  }
+
+  result.time = clock.toc();
+  result.peakMemory = PeakMemory();
+  result.objective = trainer.ValidationError();
+  result.timeToTarget = result.time;
+  result.evaluationsToTarget = result.evaluations;
+
+  results.push_back(result);
+}
+
+//! Return whether or not the given benchmark should be run.
+bool Selected(const string& benchmark)
+{
+  const string list = "," + CLI::GetParam<string>("benchmarks") + ",";
+  return (list == ",all,") || (list.find("," + benchmark + ",") !=
+      string::npos);
+}
+
+//! Write a double as JSON (NaN and infinity aren't valid JSON).
+void WriteNumber(ostream& stream, const double value)
+{
+  if (value == value && fabs(value) <= DBL_MAX)
+    stream << value;
+  else
+    stream << "null";
+}
+
+//! Write the results as JSON.
+void WriteResults(ostream& stream, const vector<BenchmarkResult>& results)
+{
+  stream << setprecision(10);
+  stream << "{" << endl;
+  stream << "  \"version\": \"" << util::GetVersion() << "\"," << endl;
+  stream << "  \"seed\": " << CLI::GetParam<int>("seed") << "," << endl;
+#ifdef _OPENMP
+  stream << "  \"threads\": " << omp_get_max_threads() << "," << endl;
+#else
+  stream << "  \"threads\": 1," << endl;
+#endif
+  stream << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    stream << ((i == 0) ? "" : ",") << endl;
+    stream << "    {" << endl;
+    stream << "      \"optimizer\": \"" << r.optimizer << "\"," << endl;
+    stream << "      \"problem\": \"" << r.problem << "\"," << endl;
+    stream << "      \"target\": ";
+    WriteNumber(stream, r.target);
+    stream << "," << endl;
+    stream << "      \"objective\": ";
+    WriteNumber(stream, r.objective);
+    stream << "," << endl;
+    stream << "      \"reached_target\": " << (r.reachedTarget ? "true" :
+        "false") << "," << endl;
+    stream << "      \"time\": " << r.time << "," << endl;
+    stream << "      \"evaluations\": " << r.evaluations << "," << endl;
+    if (r.reachedTarget)
+    {
+      stream << "      \"time_to_target\": " << r.timeToTarget << "," << endl;
+      stream << "      \"evaluations_to_target\": " << r.evaluationsToTarget
+          << "," << endl;
+    }
+    else
+    {
+      stream << "      \"time_to_target\": null," << endl;
+      stream << "      \"evaluations_to_target\": null," << endl;
+    }
+    stream << "      \"peak_memory_kb\": " << r.peakMemory << endl;
+    stream << "    }";
+  }
+  stream << endl << "  ]" << endl << "}" << endl;
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("points") < 1 || CLI::GetParam<int>("dimensions") < 1)
+    Log::Fatal << "The logistic regression dataset needs at least 1 point and "
+        << "1 dimension." << endl;
+  if (CLI::GetParam<int>("ann_epochs") < 1)
+    Log::Fatal << "Invalid number of epochs: "
+        << CLI::GetParam<int>("ann_epochs") << "." << endl;
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#endif
+
+  vector<BenchmarkResult> results;
+
+  // The optimizer test functions, with their known optima.
+  if (Selected("sgd/sgd_test_function"))
+  {
+    SGDTestFunction f;
+    SGDRun<SGDTestFunction> run(f, 0.0003, 5000000, 1e-9);
+    Benchmark("sgd", "sgd_test_function", run, true, -1.0, results);
+  }
+  if (Selected("lbfgs/rosenbrock"))
+  {
+    RosenbrockFunction f;
+    LBFGSRun<RosenbrockFunction> run(f);
+    Benchmark("lbfgs", "rosenbrock", run, true, 0.0, results);
+  }
+  if (Selected("lbfgs/wood"))
+  {
+    WoodFunction f;
+    LBFGSRun<WoodFunction> run(f);
+    Benchmark("lbfgs", "wood", run, true, 0.0, results);
+  }
+  if (Selected("lbfgs/generalized_rosenbrock"))
+  {
+    GeneralizedRosenbrockFunction f(100);
+    LBFGSRun<GeneralizedRosenbrockFunction> run(f);
+    Benchmark("lbfgs", "generalized_rosenbrock", run, true, 0.0, results);
+  }
+  if (Selected("lbfgs/rosenbrock_wood"))
+  {
+    RosenbrockWoodFunction f;
+    LBFGSRun<RosenbrockWoodFunction> run(f);
+    Benchmark("lbfgs", "rosenbrock_wood", run, true, 0.0, results);
+  }
+  if (Selected("aug_lagrangian/aug_lagrangian_test_function"))
+  {
+    AugLagrangianTestFunction f;
+    AugLagrangianRun<AugLagrangianTestFunction> run(f);
+    Benchmark("aug_lagrangian", "aug_lagrangian_test_function", run, true,
+        70.0, results);
+  }
+  if (Selected("aug_lagrangian/gockenbach"))
+  {
+    GockenbachFunction f;
+    AugLagrangianRun<GockenbachFunction> run(f);
+    Benchmark("aug_lagrangian", "gockenbach", run, true, 29.633926, results);
+  }
+  if (Selected("lrsdp/lovasz_theta"))
+  {
+    arma::mat edges;
+    if (data::Load(CLI::GetParam<string>("graph_file"), edges, false))
+    {
+      LovaszThetaLRSDPRun run(edges);
+      Benchmark("lrsdp", "lovasz_theta", run, true, -14.0, results);
+    }
+    else
+    {
+      Log::Warn << "Could not load '" << CLI::GetParam<string>("graph_file")
+          << "'; skipping lrsdp/lovasz_theta." << endl;
+    }
+  }
+
+  // Logistic regression on a synthetic dataset, labeled by a random model; the
+  // optimum is not known.
+  if (Selected("sgd/logistic_regression") ||
+      Selected("lbfgs/logistic_regression"))
+  {
+    const size_t points = (size_t) CLI::GetParam<int>("points");
+    const size_t dimensions = (size_t) CLI::GetParam<int>("dimensions");
+
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+    arma::mat predictors = arma::randn<arma::mat>(dimensions, points);
+    const arma::vec model = arma::randn<arma::vec>(dimensions + 1);
+    arma::vec responses(points);
+    for (size_t i = 0; i < points; ++i)
+    {
+      const double p = 1.0 / (1.0 + exp(-model[0] -
+          arma::dot(model.subvec(1, dimensions), predictors.col(i))));
+      responses[i] = (math::Random() < p) ? 1.0 : 0.0;
+    }
+
+    LogisticRegressionFunction f(predictors, responses);
+    if (Selected("sgd/logistic_regression"))
+    {
+      SGDRun<LogisticRegressionFunction> run(f, 0.01, 5 * points, 1e-5);
+      Benchmark("sgd", "logistic_regression", run, false, 0.0, results);
+    }
+    if (Selected("lbfgs/logistic_regression"))
+    {
+      LBFGSRun<LogisticRegressionFunction> run(f);
+      Benchmark("lbfgs", "logistic_regression", run, false, 0.0, results);
+    }
+  }
+
+  // Softmax regression and a neural network on the MNIST subset.
+  if (Selected("lbfgs/softmax_regression") || Selected("ann/mnist"))
+  {
+    arma::mat mnist;
+    if (mnist.load(CLI::GetParam<string>("mnist_file")))
+    {
+      if (Selected("lbfgs/softmax_regression"))
+      {
+        arma::vec labels = arma::zeros<arma::vec>(mnist.n_cols);
+        labels.subvec(mnist.n_cols / 2, mnist.n_cols - 1).fill(1);
+
+        SoftmaxRegressionFunction f(mnist, labels, mnist.n_rows, 2);
+        LBFGSRun<SoftmaxRegressionFunction> run(f);
+        Benchmark("lbfgs", "softmax_regression", run, false, 0.0, results);
+      }
+      if (Selected("ann/mnist"))
+        BenchmarkNetwork(mnist, results);
+    }
+    else
+    {
+      Log::Warn << "Could not load '" << CLI::GetParam<string>("mnist_file")
+          << "'; skipping the MNIST benchmarks." << endl;
+    }
+  }
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  if (outputFile != "")
+  {
+    ofstream output(outputFile.c_str());
+    if (!output.is_open())
+      Log::Fatal << "Could not open '" << outputFile << "' for writing!"
+          << endl;
+    WriteResults(output, results);
+  }
+  else
+  {
+    WriteResults(cout, results);
+  }
+
+  return 0;
+}
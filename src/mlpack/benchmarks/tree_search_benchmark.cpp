@@ -0,0 +1,437 @@
+/**
+ * @file tree_search_benchmark.cpp
+ * @author Ryan Curtin
+ *
+ * Reproducible timings of tree building and k-nearest-neighbor search for
+ * every tree type, over synthetic and real datasets.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::tree;
+using namespace mlpack::metric;
+using namespace mlpack::bound;
+
+PROGRAM_INFO("Tree-based search benchmarks",
+    "This program times the construction of a tree and an all-k-nearest-"
+    "neighbors search with it, for every combination of the given tree types, "
+    "datasets and values of k.  For every combination the number of base "
+    "cases, the tree building time, the search time and the number of queries "
+    "per second are reported; the times are the minimum over all repetitions."
+    "\n\n"
+    "The tree types are 'kd', 'ball', 'cover', 'r', 'r-star' and 'x'.  The "
+    "synthetic datasets are 'uniform' (uniform in the unit cube), 'clustered' "
+    "(Gaussian clusters) and 'high_dim' (uniform in --high_dimensions "
+    "dimensions); a real dataset can be given with --reference_file.  The "
+    "datasets are generated from --seed, so the base case counts of two runs "
+    "are the same."
+    "\n\n"
+    "If --baseline_file is given, the results are compared with those of a "
+    "previous run saved with --output_file, and the program fails if a base "
+    "case count changed or a search became slower than the tolerance allows.");
+
+PARAM_STRING("trees", "Comma-separated list of tree types to benchmark.", "t",
+    "kd,ball,cover,r,r-star,x");
+PARAM_STRING("distributions", "Comma-separated list of synthetic datasets.",
+    "D", "uniform,clustered,high_dim");
+PARAM_STRING("reference_file", "File containing a real dataset to benchmark "
+    "as well (optional).", "r", "");
+PARAM_STRING("k", "Comma-separated list of numbers of neighbors.", "k",
+    "1,5,20");
+PARAM_INT("points", "Number of points of the synthetic datasets.", "n", 20000);
+PARAM_INT("dimensions", "Dimensionality of the uniform and clustered "
+    "datasets.", "d", 3);
+PARAM_INT("high_dimensions", "Dimensionality of the high_dim dataset.", "H",
+    50);
+PARAM_INT("leaf_size", "Leaf size for tree building.", "l", 20);
+PARAM_INT("repetitions", "Number of times every benchmark is run.", "R", 3);
+PARAM_INT("seed", "Random seed for the synthetic datasets.", "s", 42);
+PARAM_FLAG("single_mode", "If true, single-tree search is benchmarked instead "
+    "of dual-tree search.", "S");
+PARAM_INT("threads", "Number of threads to use (0 uses all available cores; "
+    "ignored without OpenMP).", "T", 0);
+PARAM_STRING("output_file", "File to save the results in, as CSV (optional).",
+    "o", "");
+PARAM_STRING("baseline_file", "File with the results of a previous run, to "
+    "check for regressions (optional).", "b", "");
+PARAM_DOUBLE("tolerance", "Relative slowdown of a search, compared to the "
+    "baseline, that is considered a regression.", "e", 0.25);
+
+//! The result of a single benchmark.
+struct BenchmarkResult
+{
+  string tree;
+  string distribution;
+  size_t points;
+  size_t dimensions;
+  size_t k;
+  double buildTime;
+  double searchTime;
+  size_t baseCases;
+
+  //! The key that identifies the benchmark in a baseline.
+  string Key() const
+  {
+    ostringstream key;
+    key << tree << "," << distribution << "," << points << "," << dimensions
+        << "," << k;
+    return key.str();
+  }
+};
+
+//! Split a comma-separated list.
+vector<string> SplitList(const string& list)
+{
+  vector<string> items;
+  istringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+    if (item != "")
+      items.push_back(item);
+  return items;
+}
+
+//! Build a binary space tree.
+template<typename TreeType>
+TreeType* BuildBinarySpaceTree(arma::mat& data, const size_t leafSize)
+{
+  return new TreeType(data, leafSize);
+}
+
+//! Build a cover tree (which has no leaf size).
+template<typename TreeType>
+TreeType* BuildCoverTree(arma::mat& data, const size_t /* leafSize */)
+{
+  return new TreeType(data);
+}
+
+//! Build a rectangle tree, with the same parameters as allknn.
+template<typename TreeType>
+TreeType* BuildRectangleTree(arma::mat& data, const size_t leafSize)
+{
+  return new TreeType(data, leafSize, leafSize * 0.4, 5, 2, 0);
+}
+
+/**
+ * Time the construction of the tree and the search for every k, and add the
+ * results.  The times are the minimum over all repetitions.
+ */
+template<typename TreeType>
+void Benchmark(const string& treeName,
+               const string& distribution,
+               const arma::mat& dataset,
+               const vector<size_t>& ks,
+               TreeType* (*build)(arma::mat&, const size_t),
+               vector<BenchmarkResult>& results)
+{
+  const size_t leafSize = (size_t) CLI::GetParam<int>("leaf_size");
+  const size_t repetitions = (size_t) CLI::GetParam<int>("repetitions");
+  const bool singleMode = CLI::HasParam("single_mode");
+
+  for (size_t i = 0; i < ks.size(); ++i)
+  {
+    BenchmarkResult result;
+    result.tree = treeName;
+    result.distribution = distribution;
+    result.points = dataset.n_cols;
+    result.dimensions = dataset.n_rows;
+    result.k = ks[i];
+    result.buildTime = DBL_MAX;
+    result.searchTime = DBL_MAX;
+    result.baseCases = 0;
+
+    if (ks[i] >= dataset.n_cols)
+    {
+      Log::Warn << "Skipping k = " << ks[i] << " for dataset '" << distribution
+          << "' with " << dataset.n_cols << " points." << endl;
+      continue;
+    }
+
+    for (size_t r = 0; r < repetitions; ++r)
+    {
+      // Some trees rearrange the dataset, so every repetition gets a copy.
+      arma::mat data(dataset);
+      arma::wall_clock clock;
+
+      clock.tic();
+      TreeType* tree = build(data, leafSize);
+      result.buildTime = std::min(result.buildTime, clock.toc());
+
+      NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType> knn(
+          tree, singleMode);
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+
+      clock.tic();
+      knn.Search(ks[i], neighbors, distances);
+      result.searchTime = std::min(result.searchTime, clock.toc());
+      result.baseCases = knn.BaseCases();
+
+      delete tree;
+    }
+
+    cout << setw(8) << left << result.tree << setw(12) << result.distribution
+        << right << setw(9) << result.points << setw(6) << result.dimensions
+        << setw(5) << result.k << fixed << setprecision(4)
+        << setw(11) << result.buildTime << setw(11) << result.searchTime
+        << setprecision(0) << setw(13) << (result.points / result.searchTime)
+        << setw(14) << result.baseCases << endl;
+
+    results.push_back(result);
+  }
+}
+
+//! Run the benchmarks of the given tree type on the given dataset.
+void BenchmarkTree(const string& treeName,
+                   const string& distribution,
+                   const arma::mat& dataset,
+                   const vector<size_t>& ks,
+                   vector<BenchmarkResult>& results)
+{
+  if (treeName == "kd")
+  {
+    typedef BinarySpaceTree<HRectBound<2>,
+        NeighborSearchStat<NearestNeighborSort> > TreeType;
+    Benchmark<TreeType>(treeName, distribution, dataset, ks,
+        &BuildBinarySpaceTree<TreeType>, results);
+  }
+  else if (treeName == "ball")
+  {
+    typedef BinarySpaceTree<BallBound<>,
+        NeighborSearchStat<NearestNeighborSort> > TreeType;
+    Benchmark<TreeType>(treeName, distribution, dataset, ks,
+        &BuildBinarySpaceTree<TreeType>, results);
+  }
+  else if (treeName == "cover")
+  {
+    typedef CoverTree<EuclideanDistance, FirstPointIsRoot,
+        NeighborSearchStat<NearestNeighborSort> > TreeType;
+    Benchmark<TreeType>(treeName, distribution, dataset, ks,
+        &BuildCoverTree<TreeType>, results);
+  }
+  else if (treeName == "r")
+  {
+    typedef RectangleTree<RTreeSplit<RTreeDescentHeuristic,
+        NeighborSearchStat<NearestNeighborSort>, arma::mat>,
+        RTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>,
+        arma::mat> TreeType;
+    Benchmark<TreeType>(treeName, distribution, dataset, ks,
+        &BuildRectangleTree<TreeType>, results);
+  }
+  else if (treeName == "r-star")
+  {
+    typedef RectangleTree<RStarTreeSplit<RStarTreeDescentHeuristic,
+        NeighborSearchStat<NearestNeighborSort>, arma::mat>,
+        RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>,
+        arma::mat> TreeType;
+    Benchmark<TreeType>(treeName, distribution, dataset, ks,
+        &BuildRectangleTree<TreeType>, results);
+  }
+  else if (treeName == "x")
+  {
+    typedef RectangleTree<XTreeSplit<RStarTreeDescentHeuristic,
+        NeighborSearchStat<NearestNeighborSort>, arma::mat>,
+        RStarTreeDescentHeuristic, NeighborSearchStat<NearestNeighborSort>,
+        arma::mat> TreeType;
+    Benchmark<TreeType>(treeName, distribution, dataset, ks,
+        &BuildRectangleTree<TreeType>, results);
+  }
+  else
+  {
+    Log::Fatal << "Unknown tree type '" << treeName << "'!" << endl;
+  }
+}
+
+//! Generate the given synthetic dataset.
+void GenerateDataset(const string& distribution, arma::mat& dataset)
+{
+  const size_t points = (size_t) CLI::GetParam<int>("points");
+  const size_t dimensions = (size_t) CLI::GetParam<int>("dimensions");
+
+  // Every dataset is generated from the same seed, so it doesn't depend on the
+  // other datasets that are benchmarked.
+  math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+
+  if (distribution == "uniform")
+  {
+    dataset.randu(dimensions, points);
+  }
+  else if (distribution == "clustered")
+  {
+    // Twenty tight Gaussian clusters with random centers.
+    const size_t numClusters = 20;
+    const arma::mat centers = 10 * arma::randu<arma::mat>(dimensions,
+        numClusters);
+    dataset.randn(dimensions, points);
+    dataset *= 0.1;
+    for (size_t i = 0; i < points; ++i)
+      dataset.col(i) += centers.col(math::RandInt(numClusters));
+  }
+  else if (distribution == "high_dim")
+  {
+    dataset.randu(CLI::GetParam<int>("high_dimensions"), points);
+  }
+  else
+  {
+    Log::Fatal << "Unknown distribution '" << distribution << "'!" << endl;
+  }
+}
+
+//! Save the results as CSV.
+void SaveResults(const string& filename,
+                 const vector<BenchmarkResult>& results)
+{
+  ofstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open '" << filename << "' for writing!" << endl;
+
+  file << "tree,distribution,points,dimensions,k,build_time,search_time,"
+      << "base_cases" << endl;
+  file << setprecision(17);
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    file << results[i].Key() << "," << results[i].buildTime << ","
+        << results[i].searchTime << "," << results[i].baseCases << endl;
+  }
+}
+
+//! Compare the results with a baseline, and return the number of regressions.
+size_t CompareResults(const string& filename,
+                      const vector<BenchmarkResult>& results)
+{
+  ifstream file(filename.c_str());
+  if (!file.is_open())
+    Log::Fatal << "Could not open baseline file '" << filename << "'!" << endl;
+
+  // Read the baseline, keyed by the benchmark.
+  map<string, pair<double, size_t> > baseline;
+  string line;
+  getline(file, line); // Skip the header.
+  while (getline(file, line))
+  {
+    const vector<string> fields = SplitList(line);
+    if (fields.size() != 8)
+      continue;
+
+    const string key = fields[0] + "," + fields[1] + "," + fields[2] + "," +
+        fields[3] + "," + fields[4];
+    baseline[key] = make_pair(atof(fields[6].c_str()),
+        (size_t) atol(fields[7].c_str()));
+  }
+
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  size_t regressions = 0;
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    map<string, pair<double, size_t> >::const_iterator it =
+        baseline.find(results[i].Key());
+    if (it == baseline.end())
+      continue;
+
+    if (results[i].baseCases != it->second.second)
+    {
+      Log::Warn << results[i].Key() << ": " << results[i].baseCases
+          << " base cases instead of " << it->second.second << "." << endl;
+      ++regressions;
+    }
+    if (results[i].searchTime > (1.0 + tolerance) * it->second.first)
+    {
+      Log::Warn << results[i].Key() << ": search took "
+          << results[i].searchTime << "s instead of " << it->second.first
+          << "s." << endl;
+      ++regressions;
+    }
+  }
+
+  return regressions;
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("points") < 2 || CLI::GetParam<int>("dimensions") < 1
+      || CLI::GetParam<int>("high_dimensions") < 1)
+    Log::Fatal << "The synthetic datasets need at least 2 points and 1 "
+        << "dimension." << endl;
+  if (CLI::GetParam<int>("leaf_size") < 1)
+    Log::Fatal << "Invalid leaf size: " << CLI::GetParam<int>("leaf_size")
+        << ".  Must be greater than 0." << endl;
+  if (CLI::GetParam<int>("repetitions") < 1)
+    Log::Fatal << "Invalid number of repetitions: "
+        << CLI::GetParam<int>("repetitions") << "." << endl;
+  if (CLI::GetParam<int>("threads") < 0)
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#endif
+
+  const vector<string> trees = SplitList(CLI::GetParam<string>("trees"));
+  vector<string> distributions =
+      SplitList(CLI::GetParam<string>("distributions"));
+  const vector<string> kList = SplitList(CLI::GetParam<string>("k"));
+  vector<size_t> ks;
+  for (size_t i = 0; i < kList.size(); ++i)
+  {
+    const int k = atoi(kList[i].c_str());
+    if (k < 1)
+      Log::Fatal << "Invalid k: '" << kList[i] << "'." << endl;
+    ks.push_back((size_t) k);
+  }
+
+  cout << setw(8) << left << "tree" << setw(12) << "data" << right << setw(9)
+      << "points" << setw(6) << "dims" << setw(5) << "k" << setw(11)
+      << "build (s)" << setw(11) << "search (s)" << setw(13) << "queries/s"
+      << setw(14) << "base cases" << endl;
+
+  vector<BenchmarkResult> results;
+  for (size_t d = 0; d < distributions.size(); ++d)
+  {
+    arma::mat dataset;
+    GenerateDataset(distributions[d], dataset);
+    for (size_t t = 0; t < trees.size(); ++t)
+      BenchmarkTree(trees[t], distributions[d], dataset, ks, results);
+  }
+
+  const string referenceFile = CLI::GetParam<string>("reference_file");
+  if (referenceFile != "")
+  {
+    arma::mat dataset;
+    data::Load(referenceFile, dataset, true);
+    for (size_t t = 0; t < trees.size(); ++t)
+      BenchmarkTree(trees[t], "file", dataset, ks, results);
+  }
+
+  if (CLI::GetParam<string>("output_file") != "")
+    SaveResults(CLI::GetParam<string>("output_file"), results);
+
+  if (CLI::GetParam<string>("baseline_file") != "")
+  {
+    const size_t regressions = CompareResults(
+        CLI::GetParam<string>("baseline_file"), results);
+    if (regressions > 0)
+    {
+      Log::Warn << regressions << " regressions compared to the baseline."
+          << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
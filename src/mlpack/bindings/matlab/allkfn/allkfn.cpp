@@ -28,17 +28,10 @@ void mexFunction(int nlhs, mxArray *plhs[],
     mexErrMsgTxt("Two outputs required.");
   }
 
-  size_t numPoints = mxGetN(prhs[0]);
-  size_t numDimensions = mxGetM(prhs[0]);
-
-  // Create the reference matrix.
-  arma::mat referenceData(numDimensions, numPoints);
-  // setting the values.
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    referenceData(i) = mexDataPoints[i];
-  }
+  // Create the reference matrix.  The kd-tree rearranges the points it is
+  // built on, and MATLAB's inputs must not be modified, so this is a copy (made
+  // in one pass).
+  arma::mat referenceData(mxGetPr(prhs[0]), mxGetM(prhs[0]), mxGetN(prhs[0]));
 
   // getting the leafsize
   int lsInt = (int) mxGetScalar(prhs[3]);
@@ -53,7 +46,6 @@ void mexFunction(int nlhs, mxArray *plhs[],
   bool singleMode = (mxGetScalar(prhs[5]) == 1.0);
 
   // the query matrix
-  double * mexQueryPoints = mxGetPr(prhs[2]);
   arma::mat queryData;
   bool hasQueryData = ((mxGetM(prhs[2]) != 0) && (mxGetN(prhs[2]) != 0));
 
@@ -105,15 +97,7 @@ void mexFunction(int nlhs, mxArray *plhs[],
 
   if (hasQueryData)
   {
-    // setting the values.
-    mexDataPoints = mxGetPr(prhs[2]);
-    numPoints = mxGetN(prhs[2]);
-    numDimensions = mxGetM(prhs[2]);
-    queryData = arma::mat(numDimensions, numPoints);
-    for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-    {
-      queryData(i) = mexDataPoints[i];
-    }
+    queryData = arma::mat(mxGetPr(prhs[2]), mxGetM(prhs[2]), mxGetN(prhs[2]));
 
     if (naive && leafSize < queryData.n_cols)
       leafSize = queryData.n_cols;
@@ -135,9 +119,14 @@ void mexFunction(int nlhs, mxArray *plhs[],
   allkfn->Search(k, neighbors, distances);
 
   // We have to map back to the original indices from before the tree
-  // construction.
-  arma::mat distancesOut(distances.n_rows, distances.n_cols);
-  arma::Mat<size_t> neighborsOut(neighbors.n_rows, neighbors.n_cols);
+  // construction.  The results are written straight into MATLAB's output
+  // matrices.
+  plhs[0] = mxCreateDoubleMatrix(distances.n_rows, distances.n_cols, mxREAL);
+  plhs[1] = mxCreateDoubleMatrix(neighbors.n_rows, neighbors.n_cols, mxREAL);
+  arma::mat distancesOut(mxGetPr(plhs[0]), distances.n_rows, distances.n_cols,
+      false, true);
+  arma::mat neighborsOut(mxGetPr(plhs[1]), neighbors.n_rows, neighbors.n_cols,
+      false, true);
 
   // Do the actual remapping.
   if (hasQueryData)
@@ -173,22 +162,6 @@ void mexFunction(int nlhs, mxArray *plhs[],
   if (queryTree)
     delete queryTree;
 
-  // constructing matrix to return to matlab
-  plhs[0] = mxCreateDoubleMatrix(distances.n_rows, distances.n_cols, mxREAL);
-  plhs[1] = mxCreateDoubleMatrix(neighbors.n_rows, neighbors.n_cols, mxREAL);
-
-  // setting the values
-  double * out = mxGetPr(plhs[0]);
-  for (int i = 0, n = distances.n_rows * distances.n_cols; i < n; ++i)
-  {
-    out[i] = distances(i);
-  }
-  out = mxGetPr(plhs[1]);
-  for (int i = 0, n = neighbors.n_rows * neighbors.n_cols; i < n; ++i)
-  {
-    out[i] = neighbors(i);
-  }
-
   // More clean up.
   delete allkfn;
 }
@@ -30,19 +30,6 @@ void mexFunction(int nlhs, mxArray *plhs[],
     mexErrMsgTxt("Two outputs required.");
   }
 
-  // getting the dimensions of the reference matrix
-  size_t numPoints = mxGetN(prhs[0]);
-  size_t numDimensions = mxGetM(prhs[0]);
-
-  // feeding the referenceData matrix
-  arma::mat referenceData(numDimensions, numPoints);
-  // setting the values.
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    referenceData(i) = mexDataPoints[i];
-  }
-
   // getting the leafsize
   int lsInt = (int) mxGetScalar(prhs[3]);
 
@@ -55,14 +42,23 @@ void mexFunction(int nlhs, mxArray *plhs[],
   // single mode?
   bool singleMode = (mxGetScalar(prhs[5]) == 1.0);
 
-  // the query matrix
-  double * mexQueryPoints = mxGetPr(prhs[2]);
-  arma::mat queryData;
-  bool hasQueryData = ((mxGetM(prhs[2]) != 0) && (mxGetN(prhs[2]) != 0));
-
   // cover-tree?
   bool usesCoverTree = (mxGetScalar(prhs[6]) == 1.0);
 
+  // The kd-tree rearranges the points it is built on, and MATLAB's inputs must
+  // not be modified, so it gets one copy of each matrix.  The cover tree does
+  // not rearrange its points, so it uses MATLAB's memory directly.
+  const bool copyData = !usesCoverTree;
+  arma::mat referenceData(mxGetPr(prhs[0]), mxGetM(prhs[0]), mxGetN(prhs[0]),
+      copyData, !copyData);
+
+  // the query matrix
+  bool hasQueryData = ((mxGetM(prhs[2]) != 0) && (mxGetN(prhs[2]) != 0));
+  arma::mat queryData;
+  if (hasQueryData)
+    queryData = arma::mat(mxGetPr(prhs[2]), mxGetM(prhs[2]), mxGetN(prhs[2]),
+        copyData, !copyData);
+
   // Sanity check on k value: must be greater than 0, must be less than the
   // number of reference points.
   if (k > referenceData.n_cols)
@@ -93,11 +89,15 @@ void mexFunction(int nlhs, mxArray *plhs[],
   if (naive)
     leafSize = referenceData.n_cols;
 
-  arma::Mat<size_t> neighbors;
-  arma::mat distances;
+  // The results are written straight into MATLAB's output matrices.
+  const size_t numQueries = hasQueryData ? queryData.n_cols :
+      referenceData.n_cols;
+  plhs[0] = mxCreateDoubleMatrix(k, numQueries, mxREAL);
+  plhs[1] = mxCreateDoubleMatrix(k, numQueries, mxREAL);
+  arma::mat distances(mxGetPr(plhs[0]), k, numQueries, false, true);
+  double* neighbors = mxGetPr(plhs[1]);
 
-  //if (!CLI::HasParam("cover_tree"))
-  if (usesCoverTree)
+  if (!usesCoverTree)
   {
     // Because we may construct it differently, we need a pointer.
     AllkNN* allknn = NULL;
@@ -117,16 +117,6 @@ void mexFunction(int nlhs, mxArray *plhs[],
 
     if (hasQueryData)
     {
-      // setting the values.
-      mexDataPoints = mxGetPr(prhs[2]);
-      numPoints = mxGetN(prhs[2]);
-      numDimensions = mxGetM(prhs[2]);
-      queryData = arma::mat(numDimensions, numPoints);
-      for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-      {
-        queryData(i) = mexDataPoints[i];
-      }
-
       if (naive && leafSize < queryData.n_cols)
         leafSize = queryData.n_cols;
 
@@ -154,9 +144,6 @@ void mexFunction(int nlhs, mxArray *plhs[],
 
     // We have to map back to the original indices from before the tree
     // construction.
-    neighbors.set_size(neighborsOut.n_rows, neighborsOut.n_cols);
-    distances.set_size(distancesOut.n_rows, distancesOut.n_cols);
-
     // Do the actual remapping.
     if ((hasQueryData) && !singleMode)
     {
@@ -168,7 +155,7 @@ void mexFunction(int nlhs, mxArray *plhs[],
         // Map indices of neighbors.
         for (size_t j = 0; j < distancesOut.n_rows; ++j)
         {
-          neighbors(j, oldFromNewQueries[i]) =
+          neighbors[j + k * oldFromNewQueries[i]] =
               oldFromNewRefs[neighborsOut(j, i)];
         }
       }
@@ -194,7 +181,8 @@ void mexFunction(int nlhs, mxArray *plhs[],
         // Map indices of neighbors.
         for (size_t j = 0; j < distancesOut.n_rows; ++j)
         {
-          neighbors(j, oldFromNewRefs[i]) = oldFromNewRefs[neighborsOut(j, i)];
+          neighbors[j + k * oldFromNewRefs[i]] =
+              oldFromNewRefs[neighborsOut(j, i)];
         }
       }
     }
@@ -220,16 +208,6 @@ void mexFunction(int nlhs, mxArray *plhs[],
     // See if we have query data.
     if (hasQueryData)
     {
-      // setting the values.
-      mexDataPoints = mxGetPr(prhs[2]);
-      numPoints = mxGetN(prhs[2]);
-      numDimensions = mxGetM(prhs[2]);
-      queryData = arma::mat(numDimensions, numPoints);
-      for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-      {
-        queryData(i) = mexDataPoints[i];
-      }
-
       // Build query tree.
       if (!singleMode)
       {
@@ -251,29 +229,16 @@ void mexFunction(int nlhs, mxArray *plhs[],
           singleMode);
     }
 
-    allknn->Search(k, neighbors, distances);
+    // The distances go straight into the output; the neighbor indices have to
+    // be converted to doubles.
+    arma::Mat<size_t> neighborsOut;
+    allknn->Search(k, neighborsOut, distances);
+    for (size_t i = 0; i < neighborsOut.n_elem; ++i)
+      neighbors[i] = neighborsOut[i];
 
     delete allknn;
 
     if (queryTree)
       delete queryTree;
   }
-
-  // writing back to matlab
-  // constructing matrix to return to matlab
-  plhs[0] = mxCreateDoubleMatrix(distances.n_rows, distances.n_cols, mxREAL);
-  plhs[1] = mxCreateDoubleMatrix(neighbors.n_rows, neighbors.n_cols, mxREAL);
-
-  // setting the values
-  double * out = mxGetPr(plhs[0]);
-  for (int i = 0, n = distances.n_rows * distances.n_cols; i < n; ++i)
-  {
-    out[i] = distances(i);
-  }
-  out = mxGetPr(plhs[1]);
-  for (int i = 0, n = neighbors.n_rows * neighbors.n_cols; i < n; ++i)
-  {
-    out[i] = neighbors(i);
-  }
-
 }
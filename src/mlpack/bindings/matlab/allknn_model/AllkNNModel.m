@@ -0,0 +1,54 @@
+classdef AllkNNModel < handle
+%All K-Nearest-Neighbors model
+%
+%  Builds the reference tree for all k-nearest-neighbors search once and keeps
+%  it alive, so that repeated searches (for instance, in an interactive query
+%  loop) only pay for the query.  The tree is freed when the object is deleted
+%  or goes out of scope.
+%
+%Parameters:
+% dataPoints - (required) Matrix containing the reference dataset.  Columns are
+%              assumed to represent dimensions, with rows representing separate
+%              points.
+% naive      - (optional) If true, O(n^2) naive mode is used for computation.
+% singleMode - (optional) If true, single-tree search is used (as opposed to
+%              dual-tree search).
+%
+% Examples:
+% model = AllkNNModel(dataPoints);
+% [distances neighbors] = model.search(queryPoints, 5);
+
+  properties (Access = private)
+    handle
+  end
+
+  methods
+    function this = AllkNNModel(dataPoints, varargin)
+      % a parser for the inputs
+      p = inputParser;
+      p.addParamValue('naive', false, @(x) (x == true) || (x == false));
+      p.addParamValue('singleMode', false, @(x) (x == true) || (x == false));
+      p.parse(varargin{:});
+      parsed = p.Results;
+
+      this.handle = mex_allknn_model('new', dataPoints', parsed.naive, ...
+        parsed.singleMode);
+    end
+
+    function [distances neighbors] = search(this, queryPoints, k)
+      [distances neighbors] = mex_allknn_model('search', this.handle, ...
+        queryPoints', k);
+
+      % transposing results
+      distances = distances';
+      neighbors = neighbors' + 1; % matlab indices began at 1, not zero
+    end
+
+    function delete(this)
+      if ~isempty(this.handle)
+        mex_allknn_model('delete', this.handle);
+        this.handle = [];
+      end
+    end
+  end
+end
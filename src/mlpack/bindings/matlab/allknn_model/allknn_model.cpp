@@ -0,0 +1,93 @@
+/**
+ * @file allknn_model.cpp
+ * @author Ryan Curtin
+ *
+ * MEX function for the handle-based MATLAB All-kNN binding.  The reference
+ * tree is built once by the 'new' command and kept alive until 'delete', so
+ * each 'search' only pays for the query.
+ *
+ * Usage from MATLAB (see AllkNNModel.m):
+ *   handle = mex_allknn_model('new', referenceData, naive, singleMode);
+ *   [distances neighbors] = mex_allknn_model('search', handle, queryData, k);
+ *   mex_allknn_model('delete', handle);
+ */
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+#include "../model_handle.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::matlab;
+using namespace mlpack::neighbor;
+
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  const string command = GetCommand(nrhs, prhs);
+
+  if (command == "new")
+  {
+    if (nrhs != 4 || nlhs != 1)
+      mexErrMsgTxt("Usage: handle = mex_allknn_model('new', referenceData, "
+          "naive, singleMode).");
+
+    // The tree rearranges its points, so NeighborSearch keeps its own copy of
+    // the reference set; MATLAB's buffer is only read.
+    const arma::mat referenceData(mxGetPr(prhs[1]), mxGetM(prhs[1]),
+        mxGetN(prhs[1]), false, true);
+    const bool naive = (mxGetScalar(prhs[2]) == 1.0);
+    const bool singleMode = (mxGetScalar(prhs[3]) == 1.0);
+
+    plhs[0] = ModelHandle<AllkNN>::Create(new AllkNN(referenceData, naive,
+        singleMode));
+  }
+  else if (command == "search")
+  {
+    if (nrhs != 4 || nlhs != 2)
+      mexErrMsgTxt("Usage: [distances neighbors] = mex_allknn_model('search', "
+          "handle, queryData, k).");
+
+    AllkNN& allknn = ModelHandle<AllkNN>::Get(prhs[1]);
+    const arma::mat queryData(mxGetPr(prhs[2]), mxGetM(prhs[2]),
+        mxGetN(prhs[2]), false, true);
+
+    const int k = (int) mxGetScalar(prhs[3]);
+    if (k <= 0 || size_t(k) > allknn.ReferenceSet().n_cols)
+    {
+      stringstream os;
+      os << "Invalid k: " << k << "; must be greater than 0 and less than or "
+          << "equal to the number of reference points ("
+          << allknn.ReferenceSet().n_cols << ").";
+      mexErrMsgTxt(os.str().c_str());
+    }
+
+    if (queryData.n_rows != allknn.ReferenceSet().n_rows)
+      mexErrMsgTxt("Query points must have the same dimensionality as the "
+          "reference points.");
+
+    arma::Mat<size_t> neighbors;
+    plhs[0] = mxCreateDoubleMatrix(k, queryData.n_cols, mxREAL);
+    arma::mat distances(mxGetPr(plhs[0]), k, queryData.n_cols, false, true);
+
+    allknn.Search(queryData, k, neighbors, distances);
+
+    plhs[1] = mxCreateDoubleMatrix(k, queryData.n_cols, mxREAL);
+    double* out = mxGetPr(plhs[1]);
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+      out[i] = neighbors[i];
+  }
+  else if (command == "delete")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Usage: mex_allknn_model('delete', handle).");
+
+    ModelHandle<AllkNN>::Destroy(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt(("Unknown command '" + command + "'.").c_str());
+  }
+}
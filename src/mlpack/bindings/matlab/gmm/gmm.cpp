@@ -34,15 +34,10 @@ void mexFunction(int nlhs, mxArray *plhs[],
   else
     math::RandomSeed((size_t) std::time(NULL));
 
-  // loading the data
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  size_t numPoints = mxGetN(prhs[0]);
+  // Use MATLAB's memory for the data directly; EM does not modify it.
   size_t numDimensions = mxGetM(prhs[0]);
-  arma::mat dataPoints(numDimensions, numPoints);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    dataPoints(i) = mexDataPoints[i];
-  }
+  const arma::mat dataPoints(mxGetPr(prhs[0]), numDimensions, mxGetN(prhs[0]),
+      false, true);
 
   int gaussians = (int) mxGetScalar(prhs[1]);
   if (gaussians <= 0)
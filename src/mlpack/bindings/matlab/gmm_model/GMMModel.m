@@ -0,0 +1,59 @@
+classdef GMMModel < handle
+%Gaussian Mixture Model (GMM)
+%
+%  Trains a GMM with the EM algorithm once and keeps it alive, so that it can
+%  be evaluated on new points, or trained further, without being refit.  The
+%  model is freed when the object is deleted or goes out of scope.
+%
+%Parameters:
+% dataPoints - (required) Matrix containing the data on which the model will
+%              be fit.
+% gaussians  - (optional) Number of gaussians in the GMM.  Default value is 1.
+% trials     - (optional) Number of trials of EM; the best fit is kept.
+%              Default value is 1.
+%
+% Examples:
+% model = GMMModel(dataPoints, 'gaussians', 3);
+% probabilities = model.probability(points);
+% labels = model.classify(points);
+
+  properties (Access = private)
+    handle
+  end
+
+  methods
+    function this = GMMModel(dataPoints, varargin)
+      % a parser for the inputs
+      p = inputParser;
+      p.addParamValue('gaussians', 1, @isscalar);
+      p.addParamValue('trials', 1, @isscalar);
+      p.parse(varargin{:});
+      parsed = p.Results;
+
+      this.handle = mex_gmm_model('new', dataPoints', parsed.gaussians, ...
+        parsed.trials);
+    end
+
+    % Continue training the model on the given points.
+    function logLikelihood = estimate(this, dataPoints)
+      logLikelihood = mex_gmm_model('estimate', this.handle, dataPoints');
+    end
+
+    % Probability of each point (row) under the model.
+    function probabilities = probability(this, points)
+      probabilities = mex_gmm_model('probability', this.handle, points')';
+    end
+
+    % Most probable component of each point (row).
+    function labels = classify(this, points)
+      labels = mex_gmm_model('classify', this.handle, points')';
+    end
+
+    function delete(this)
+      if ~isempty(this.handle)
+        mex_gmm_model('delete', this.handle);
+        this.handle = [];
+      end
+    end
+  end
+end
@@ -0,0 +1,110 @@
+/**
+ * @file gmm_model.cpp
+ * @author Ryan Curtin
+ *
+ * MEX function for the handle-based MATLAB GMM binding.  The model is trained
+ * once by the 'new' command and kept alive until 'delete', so it can be
+ * evaluated on new points (or trained further) without being rebuilt.
+ *
+ * Usage from MATLAB (see GMMModel.m):
+ *   handle = mex_gmm_model('new', dataPoints, gaussians, trials);
+ *   logLikelihood = mex_gmm_model('estimate', handle, dataPoints);
+ *   probabilities = mex_gmm_model('probability', handle, points);
+ *   labels = mex_gmm_model('classify', handle, points);
+ *   mex_gmm_model('delete', handle);
+ */
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/gmm/gmm.hpp>
+
+#include "../model_handle.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::gmm;
+using namespace mlpack::matlab;
+
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  const string command = GetCommand(nrhs, prhs);
+
+  if (command == "new")
+  {
+    if (nrhs != 4 || nlhs != 1)
+      mexErrMsgTxt("Usage: handle = mex_gmm_model('new', dataPoints, "
+          "gaussians, trials).");
+
+    const arma::mat dataPoints(mxGetPr(prhs[1]), mxGetM(prhs[1]),
+        mxGetN(prhs[1]), false, true);
+
+    const int gaussians = (int) mxGetScalar(prhs[2]);
+    const int trials = (int) mxGetScalar(prhs[3]);
+    if (gaussians <= 0 || trials <= 0)
+      mexErrMsgTxt("The number of Gaussians and of trials must be greater "
+          "than or equal to 1.");
+
+    GMM<>* gmm = new GMM<>(size_t(gaussians), dataPoints.n_rows);
+    gmm->Estimate(dataPoints, size_t(trials));
+
+    plhs[0] = ModelHandle<GMM<> >::Create(gmm);
+  }
+  else if (command == "estimate")
+  {
+    if (nrhs != 3 || nlhs > 1)
+      mexErrMsgTxt("Usage: logLikelihood = mex_gmm_model('estimate', handle, "
+          "dataPoints).");
+
+    GMM<>& gmm = ModelHandle<GMM<> >::Get(prhs[1]);
+    const arma::mat dataPoints(mxGetPr(prhs[2]), mxGetM(prhs[2]),
+        mxGetN(prhs[2]), false, true);
+    if (dataPoints.n_rows != gmm.Dimensionality())
+      mexErrMsgTxt("Data points must have the same dimensionality as the "
+          "model.");
+
+    // Continue training from the current model.
+    plhs[0] = mxCreateDoubleScalar(gmm.Estimate(dataPoints, 1, true));
+  }
+  else if (command == "probability" || command == "classify")
+  {
+    if (nrhs != 3 || nlhs > 1)
+      mexErrMsgTxt(("Usage: result = mex_gmm_model('" + command + "', handle, "
+          "points).").c_str());
+
+    const GMM<>& gmm = ModelHandle<GMM<> >::Get(prhs[1]);
+    const arma::mat points(mxGetPr(prhs[2]), mxGetM(prhs[2]), mxGetN(prhs[2]),
+        false, true);
+    if (points.n_rows != gmm.Dimensionality())
+      mexErrMsgTxt("Points must have the same dimensionality as the model.");
+
+    plhs[0] = mxCreateDoubleMatrix(1, points.n_cols, mxREAL);
+    double* out = mxGetPr(plhs[0]);
+    if (command == "probability")
+    {
+      arma::vec logProbabilities;
+      gmm.LogProbability(points, logProbabilities);
+      for (size_t i = 0; i < points.n_cols; ++i)
+        out[i] = std::exp(logProbabilities[i]);
+    }
+    else
+    {
+      arma::Col<size_t> labels;
+      gmm.Classify(points, labels);
+      // Convert to MATLAB's index offset.
+      for (size_t i = 0; i < points.n_cols; ++i)
+        out[i] = labels[i] + 1;
+    }
+  }
+  else if (command == "delete")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Usage: mex_gmm_model('delete', handle).");
+
+    ModelHandle<GMM<> >::Destroy(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt(("Unknown command '" + command + "'.").c_str());
+  }
+}
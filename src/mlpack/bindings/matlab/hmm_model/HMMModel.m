@@ -0,0 +1,57 @@
+classdef HMMModel < handle
+%Hidden Markov Model (HMM) with discrete emissions
+%
+%  Keeps an HMM alive across calls, so that it can be trained and queried
+%  repeatedly without being rebuilt.  Observations are symbols 1..symbols and
+%  hidden states are 1..states.  The model is freed when the object is deleted
+%  or goes out of scope.
+%
+%Parameters:
+% states  - (required) Number of hidden states.
+% symbols - (required) Number of observation symbols.
+%
+% Examples:
+% model = HMMModel(4, 10);
+% model.train({sequence1, sequence2});
+% [states logLikelihood] = model.predict(sequence1);
+
+  properties (Access = private)
+    handle
+  end
+
+  methods
+    function this = HMMModel(states, symbols)
+      this.handle = mex_hmm_model('new', states, symbols);
+    end
+
+    % Baum-Welch training on a cell array of sequences, starting from the
+    % current parameters.
+    function train(this, sequences)
+      mex_hmm_model('train', this.handle, sequences);
+    end
+
+    function logLikelihood = loglik(this, sequence)
+      logLikelihood = mex_hmm_model('loglik', this.handle, sequence);
+    end
+
+    % Most probable hidden state sequence (Viterbi).
+    function [states logLikelihood] = predict(this, sequence)
+      [states logLikelihood] = mex_hmm_model('predict', this.handle, sequence);
+    end
+
+    function [sequence states] = generate(this, len, startState)
+      if nargin < 3
+        startState = 1;
+      end
+      [sequence states] = mex_hmm_model('generate', this.handle, len, ...
+        startState);
+    end
+
+    function delete(this)
+      if ~isempty(this.handle)
+        mex_hmm_model('delete', this.handle);
+        this.handle = [];
+      end
+    end
+  end
+end
@@ -0,0 +1,166 @@
+/**
+ * @file hmm_model.cpp
+ * @author Ryan Curtin
+ *
+ * MEX function for the handle-based MATLAB HMM binding, for HMMs with discrete
+ * emissions.  The model is created by the 'new' command and kept alive until
+ * 'delete', so it can be trained and queried over many calls without being
+ * rebuilt.  Observations and states are given with MATLAB's 1-based indices.
+ *
+ * Usage from MATLAB (see HMMModel.m):
+ *   handle = mex_hmm_model('new', states, symbols);
+ *   mex_hmm_model('train', handle, sequences);
+ *   logLikelihood = mex_hmm_model('loglik', handle, sequence);
+ *   [states logLikelihood] = mex_hmm_model('predict', handle, sequence);
+ *   [sequence states] = mex_hmm_model('generate', handle, length, startState);
+ *   mex_hmm_model('delete', handle);
+ */
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/hmm/hmm.hpp>
+
+#include "../model_handle.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::distribution;
+using namespace mlpack::hmm;
+using namespace mlpack::matlab;
+
+typedef HMM<DiscreteDistribution> HMMType;
+
+namespace {
+
+// Convert a MATLAB vector of 1-based symbols into an observation sequence.
+arma::mat GetSequence(const HMMType& hmm, const mxArray* array)
+{
+  if (!mxIsDouble(array) || (mxGetM(array) != 1 && mxGetN(array) != 1))
+    mexErrMsgTxt("Observation sequences must be vectors of doubles.");
+
+  const size_t symbols = hmm.Emission()[0].Probabilities().n_elem;
+  const size_t length = mxGetNumberOfElements(array);
+  const double* values = mxGetPr(array);
+
+  arma::mat sequence(1, length);
+  for (size_t i = 0; i < length; ++i)
+  {
+    if (values[i] < 1 || values[i] > symbols)
+      mexErrMsgTxt("Observation is not a valid symbol of the model.");
+    sequence[i] = values[i] - 1;
+  }
+
+  return sequence;
+}
+
+// Convert a state sequence into a MATLAB row vector of 1-based states.
+mxArray* CreateStates(const arma::Col<size_t>& states)
+{
+  mxArray* array = mxCreateDoubleMatrix(1, states.n_elem, mxREAL);
+  double* values = mxGetPr(array);
+  for (size_t i = 0; i < states.n_elem; ++i)
+    values[i] = states[i] + 1;
+  return array;
+}
+
+}
+
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  const string command = GetCommand(nrhs, prhs);
+
+  if (command == "new")
+  {
+    if (nrhs != 3 || nlhs != 1)
+      mexErrMsgTxt("Usage: handle = mex_hmm_model('new', states, symbols).");
+
+    const int states = (int) mxGetScalar(prhs[1]);
+    const int symbols = (int) mxGetScalar(prhs[2]);
+    if (states <= 0 || symbols <= 0)
+      mexErrMsgTxt("The number of states and of symbols must be greater than "
+          "or equal to 1.");
+
+    plhs[0] = ModelHandle<HMMType>::Create(new HMMType(size_t(states),
+        DiscreteDistribution(size_t(symbols))));
+  }
+  else if (command == "train")
+  {
+    if (nrhs != 3 || nlhs != 0)
+      mexErrMsgTxt("Usage: mex_hmm_model('train', handle, sequences).");
+
+    HMMType& hmm = ModelHandle<HMMType>::Get(prhs[1]);
+    if (!mxIsCell(prhs[2]))
+      mexErrMsgTxt("Training sequences must be given as a cell array.");
+
+    vector<arma::mat> sequences(mxGetNumberOfElements(prhs[2]));
+    for (size_t i = 0; i < sequences.size(); ++i)
+      sequences[i] = GetSequence(hmm, mxGetCell(prhs[2], i));
+
+    // Unlabeled training starts from the current parameters, so repeated calls
+    // keep refining the model.
+    hmm.Train(sequences);
+  }
+  else if (command == "loglik")
+  {
+    if (nrhs != 3 || nlhs > 1)
+      mexErrMsgTxt("Usage: logLikelihood = mex_hmm_model('loglik', handle, "
+          "sequence).");
+
+    const HMMType& hmm = ModelHandle<HMMType>::Get(prhs[1]);
+    plhs[0] = mxCreateDoubleScalar(hmm.LogLikelihood(GetSequence(hmm,
+        prhs[2])));
+  }
+  else if (command == "predict")
+  {
+    if (nrhs != 3 || nlhs > 2)
+      mexErrMsgTxt("Usage: [states logLikelihood] = mex_hmm_model('predict', "
+          "handle, sequence).");
+
+    const HMMType& hmm = ModelHandle<HMMType>::Get(prhs[1]);
+    arma::Col<size_t> states;
+    const double logLikelihood = hmm.Predict(GetSequence(hmm, prhs[2]),
+        states);
+
+    plhs[0] = CreateStates(states);
+    if (nlhs == 2)
+      plhs[1] = mxCreateDoubleScalar(logLikelihood);
+  }
+  else if (command == "generate")
+  {
+    if (nrhs != 4 || nlhs > 2)
+      mexErrMsgTxt("Usage: [sequence states] = mex_hmm_model('generate', "
+          "handle, length, startState).");
+
+    const HMMType& hmm = ModelHandle<HMMType>::Get(prhs[1]);
+    const int length = (int) mxGetScalar(prhs[2]);
+    const int startState = (int) mxGetScalar(prhs[3]);
+    if (length < 0)
+      mexErrMsgTxt("Sequence length must be nonnegative.");
+    if (startState < 1 || size_t(startState) > hmm.Transition().n_rows)
+      mexErrMsgTxt("Invalid start state.");
+
+    arma::mat sequence;
+    arma::Col<size_t> states;
+    hmm.Generate(size_t(length), sequence, states, size_t(startState - 1));
+
+    plhs[0] = mxCreateDoubleMatrix(1, sequence.n_elem, mxREAL);
+    double* values = mxGetPr(plhs[0]);
+    for (size_t i = 0; i < sequence.n_elem; ++i)
+      values[i] = sequence[i] + 1;
+
+    if (nlhs == 2)
+      plhs[1] = CreateStates(states);
+  }
+  else if (command == "delete")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Usage: mex_hmm_model('delete', handle).");
+
+    ModelHandle<HMMType>::Destroy(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt(("Unknown command '" + command + "'.").c_str());
+  }
+}
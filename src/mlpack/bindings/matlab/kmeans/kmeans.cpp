@@ -82,17 +82,9 @@ void mexFunction(int nlhs, mxArray *plhs[],
   }
   */
 
-  // Load our dataset.
-  const size_t numPoints = mxGetN(prhs[0]);
-  const size_t numDimensions = mxGetM(prhs[0]);
-  arma::mat dataset(numDimensions, numPoints);
-
-  // setting the values.
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    dataset(i) = mexDataPoints[i];
-  }
+  // Use MATLAB's memory for the dataset directly; k-means does not modify it.
+  const arma::mat dataset(mxGetPr(prhs[0]), mxGetM(prhs[0]), mxGetN(prhs[0]),
+      false, true);
 
   // Now create the KMeans object.  Because we could be using different types,
   // it gets a little weird...
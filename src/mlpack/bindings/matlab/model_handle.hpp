@@ -0,0 +1,134 @@
+/**
+ * @file model_handle.hpp
+ * @author Ryan Curtin
+ *
+ * Utilities for keeping a C++ model alive across calls to a MEX function.  The
+ * model is owned by a ModelHandle object, and MATLAB only ever sees the address
+ * of that object, stored in a uint64 scalar.  While any handle is alive, the
+ * MEX file is locked so that MATLAB cannot unload it (which would leak the
+ * model and invalidate the handle).
+ */
+#ifndef __MLPACK_BINDINGS_MATLAB_MODEL_HANDLE_HPP
+#define __MLPACK_BINDINGS_MATLAB_MODEL_HANDLE_HPP
+
+#include "mex.h"
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <typeinfo>
+
+namespace mlpack {
+namespace matlab {
+
+/**
+ * Owner of a model of type ModelType which is handed to MATLAB as an opaque
+ * handle.  The handle carries a signature and the name of the model type, so
+ * that stale handles and handles of the wrong type are rejected instead of
+ * being dereferenced.
+ *
+ * @tparam ModelType Type of the model to keep alive.
+ */
+template<typename ModelType>
+class ModelHandle
+{
+ public:
+  /**
+   * Take ownership of the given model and return a MATLAB handle to it.
+   *
+   * @param model Model to take ownership of (allocated with new).
+   */
+  static mxArray* Create(ModelType* model)
+  {
+    mexLock();
+    mxArray* handle = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *((uint64_t*) mxGetData(handle)) = reinterpret_cast<uint64_t>(
+        new ModelHandle(model));
+    return handle;
+  }
+
+  /**
+   * Return the model that the given MATLAB handle refers to.  A MATLAB error is
+   * raised if the handle is invalid or refers to a different type of model.
+   *
+   * @param handle MATLAB handle returned by Create().
+   */
+  static ModelType& Get(const mxArray* handle)
+  {
+    return *FromArray(handle)->model;
+  }
+
+  /**
+   * Destroy the model that the given MATLAB handle refers to.  The handle must
+   * not be used afterwards.
+   *
+   * @param handle MATLAB handle returned by Create().
+   */
+  static void Destroy(const mxArray* handle)
+  {
+    delete FromArray(handle);
+    mexUnlock();
+  }
+
+ private:
+  //! Signature used to recognize valid handles ("mlpkmodl").
+  static const uint64_t ValidSignature = 0x6d6c706b6d6f646cULL;
+
+  //! Create the owner of the given model.
+  ModelHandle(ModelType* model) :
+      signature(ValidSignature),
+      name(typeid(ModelType).name()),
+      model(model)
+  { /* Nothing to do. */ }
+
+  //! Free the model and invalidate the signature.
+  ~ModelHandle()
+  {
+    signature = 0;
+    delete model;
+  }
+
+  //! Unpack and validate a MATLAB handle.
+  static ModelHandle* FromArray(const mxArray* handle)
+  {
+    if (mxGetNumberOfElements(handle) != 1 ||
+        mxGetClassID(handle) != mxUINT64_CLASS || mxIsComplex(handle))
+      mexErrMsgTxt("Model handle must be a real uint64 scalar.");
+
+    ModelHandle* owner = reinterpret_cast<ModelHandle*>(
+        *((uint64_t*) mxGetData(handle)));
+    if (owner == NULL || owner->signature != ValidSignature)
+      mexErrMsgTxt("Invalid model handle (was the model already deleted?).");
+    if (std::strcmp(owner->name, typeid(ModelType).name()) != 0)
+      mexErrMsgTxt("Model handle refers to a different type of model.");
+
+    return owner;
+  }
+
+  //! Signature of a live handle.
+  uint64_t signature;
+  //! Name of the model type.
+  const char* name;
+  //! The model itself.
+  ModelType* model;
+};
+
+/**
+ * Get the command string passed as the first argument of a handle-based MEX
+ * function.
+ */
+inline std::string GetCommand(int nrhs, const mxArray* prhs[])
+{
+  if (nrhs < 1 || !mxIsChar(prhs[0]))
+    mexErrMsgTxt("First input must be a command string.");
+
+  char* command = mxArrayToString(prhs[0]);
+  std::string result(command);
+  mxFree(command);
+  return result;
+}
+
+}; // namespace matlab
+}; // namespace mlpack
+
+#endif
@@ -22,13 +22,9 @@ void mexFunction(int nlhs, mxArray *plhs[],
     mexErrMsgTxt("Output required.");
   }
 
-  // loading the data
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  size_t numPoints = mxGetN(prhs[0]);
-  size_t numDimensions = mxGetM(prhs[0]);
-  arma::mat dataset(numDimensions, numPoints);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-    dataset(i) = mexDataPoints[i];
+  // Use MATLAB's memory for the data directly; it is only read.
+  const arma::mat dataset(mxGetPr(prhs[0]), mxGetM(prhs[0]), mxGetN(prhs[0]),
+      false, true);
 
   // Find out what dimension we want.
   size_t newDimension = dataset.n_rows; // No reduction, by default.
@@ -50,13 +46,26 @@ void mexFunction(int nlhs, mxArray *plhs[],
   // Get the options for running PCA.
   const bool scale = (mxGetScalar(prhs[2]) == 1.0);
 
-  // Perform PCA.
+  // Perform PCA, writing the transformed data straight into MATLAB's output
+  // matrix.
+  plhs[0] = mxCreateDoubleMatrix(dataset.n_rows, dataset.n_cols, mxREAL);
+  arma::mat transformedData(mxGetPr(plhs[0]), dataset.n_rows, dataset.n_cols,
+      false, true);
+  arma::vec eigVal;
+  arma::mat eigVec;
+
   PCA p(scale);
-  p.Apply(dataset, newDimension);
+  p.Apply(dataset, transformedData, eigVal, eigVec);
 
-  // Now returning results to matlab
-  plhs[0] = mxCreateDoubleMatrix(dataset.n_rows, dataset.n_cols, mxREAL);
-  double * values = mxGetPr(plhs[0]);
-  for (int i = 0; i < dataset.n_rows * dataset.n_cols; ++i)
-    values[i] = dataset(i);
+  // Drop the unneeded dimensions by packing the first newDimension rows of
+  // each column to the front of the output, in place.
+  if (newDimension < dataset.n_rows)
+  {
+    double* values = mxGetPr(plhs[0]);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      for (size_t j = 0; j < newDimension; ++j)
+        values[i * newDimension + j] = values[i * dataset.n_rows + j];
+
+    mxSetM(plhs[0], newDimension);
+  }
 }
@@ -0,0 +1,55 @@
+classdef RangeSearchModel < handle
+%Range Search model
+%
+%  Builds the reference tree for range search with a Euclidean distance metric
+%  once and keeps it alive, so that repeated searches (for instance, in an
+%  interactive query loop) only pay for the query.  The tree is freed when the
+%  object is deleted or goes out of scope.  Like range_search, the result is a
+%  struct array with the neighbors and distances of each query point.
+%
+%Parameters:
+% dataPoints - (required) Matrix containing the reference dataset.
+% naive      - (optional) If true, O(n^2) naive mode is used for computation.
+% singleMode - (optional) If true, single-tree search is used (as opposed to
+%              dual-tree search).
+%
+% Examples:
+% model = RangeSearchModel(dataPoints);
+% result = model.search(queryPoints, 5);
+% result = model.search(queryPoints, 5, 'minDistance', 2);
+
+  properties (Access = private)
+    handle
+  end
+
+  methods
+    function this = RangeSearchModel(dataPoints, varargin)
+      % a parser for the inputs
+      p = inputParser;
+      p.addParamValue('naive', false, @(x) (x == true) || (x == false));
+      p.addParamValue('singleMode', false, @(x) (x == true) || (x == false));
+      p.parse(varargin{:});
+      parsed = p.Results;
+
+      this.handle = mex_range_search_model('new', dataPoints', ...
+        parsed.naive, parsed.singleMode);
+    end
+
+    function result = search(this, queryPoints, maxDistance, varargin)
+      p = inputParser;
+      p.addParamValue('minDistance', 0, @isscalar);
+      p.parse(varargin{:});
+      parsed = p.Results;
+
+      result = mex_range_search_model('search', this.handle, queryPoints', ...
+        parsed.minDistance, maxDistance);
+    end
+
+    function delete(this)
+      if ~isempty(this.handle)
+        mex_range_search_model('delete', this.handle);
+        this.handle = [];
+      end
+    end
+  end
+end
@@ -0,0 +1,113 @@
+/**
+ * @file range_search_model.cpp
+ * @author Ryan Curtin
+ *
+ * MEX function for the handle-based MATLAB range search binding.  The
+ * reference tree is built once by the 'new' command and kept alive until
+ * 'delete', so each 'search' only pays for the query.
+ *
+ * Usage from MATLAB (see RangeSearchModel.m):
+ *   handle = mex_range_search_model('new', referenceData, naive, singleMode);
+ *   result = mex_range_search_model('search', handle, queryData, min, max);
+ *   mex_range_search_model('delete', handle);
+ */
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
+
+#include "../model_handle.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::matlab;
+using namespace mlpack::range;
+
+typedef RangeSearch<> RSType;
+
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  const string command = GetCommand(nrhs, prhs);
+
+  if (command == "new")
+  {
+    if (nrhs != 4 || nlhs != 1)
+      mexErrMsgTxt("Usage: handle = mex_range_search_model('new', "
+          "referenceData, naive, singleMode).");
+
+    // The tree rearranges its points, so RangeSearch keeps its own copy of the
+    // reference set; MATLAB's buffer is only read.
+    const arma::mat referenceData(mxGetPr(prhs[1]), mxGetM(prhs[1]),
+        mxGetN(prhs[1]), false, true);
+    const bool naive = (mxGetScalar(prhs[2]) == 1.0);
+    const bool singleMode = (mxGetScalar(prhs[3]) == 1.0);
+
+    plhs[0] = ModelHandle<RSType>::Create(new RSType(referenceData, naive,
+        singleMode));
+  }
+  else if (command == "search")
+  {
+    if (nrhs != 5 || nlhs != 1)
+      mexErrMsgTxt("Usage: result = mex_range_search_model('search', handle, "
+          "queryData, min, max).");
+
+    RSType& rangeSearch = ModelHandle<RSType>::Get(prhs[1]);
+    const arma::mat queryData(mxGetPr(prhs[2]), mxGetM(prhs[2]),
+        mxGetN(prhs[2]), false, true);
+    const double min = mxGetScalar(prhs[3]);
+    const double max = mxGetScalar(prhs[4]);
+
+    if (max <= min)
+    {
+      stringstream ss;
+      ss << "Invalid range: maximum (" << max << ") must be greater than "
+          << "minimum (" << min << ").";
+      mexErrMsgTxt(ss.str().c_str());
+    }
+
+    if (queryData.n_rows != rangeSearch.ReferenceSet().n_rows)
+      mexErrMsgTxt("Query points must have the same dimensionality as the "
+          "reference points.");
+
+    vector<vector<size_t> > neighbors;
+    vector<vector<double> > distances;
+    rangeSearch.Search(queryData, math::Range(min, max), neighbors, distances);
+
+    // Return a struct array with one element per query point, like
+    // range_search.m.
+    mwSize dims[1] = { neighbors.size() };
+    const char* fieldNames[2] = { "neighbors", "distances" };
+    plhs[0] = mxCreateStructArray(1, dims, 2, fieldNames);
+
+    for (size_t i = 0; i < neighbors.size(); ++i)
+    {
+      const size_t numElements = neighbors[i].size();
+      mxArray* neighborsArray = mxCreateDoubleMatrix(1, numElements, mxREAL);
+      mxArray* distancesArray = mxCreateDoubleMatrix(1, numElements, mxREAL);
+      double* neighborValues = mxGetPr(neighborsArray);
+      double* distanceValues = mxGetPr(distancesArray);
+      for (size_t j = 0; j < numElements; ++j)
+      {
+        // Convert to MATLAB's index offset.
+        neighborValues[j] = neighbors[i][j] + 1;
+        distanceValues[j] = distances[i][j];
+      }
+
+      // The struct takes ownership of the arrays.
+      mxSetFieldByNumber(plhs[0], i, 0, neighborsArray);
+      mxSetFieldByNumber(plhs[0], i, 1, distancesArray);
+    }
+  }
+  else if (command == "delete")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Usage: mex_range_search_model('delete', handle).");
+
+    ModelHandle<RSType>::Destroy(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt(("Unknown command '" + command + "'.").c_str());
+  }
+}
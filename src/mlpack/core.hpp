@@ -155,7 +155,11 @@
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/ostream_extra.hpp>
+#include <mlpack/core/util/memory_usage.hpp>
+#include <mlpack/core/util/numa.hpp>
 #include <mlpack/core/data/load.hpp>
+#include <mlpack/core/data/chunked_load.hpp>
+#include <mlpack/core/data/chunked_save.hpp>
 #include <mlpack/core/data/save.hpp>
 #include <mlpack/core/data/normalize_labels.hpp>
 #include <mlpack/core/math/clamp.hpp>
@@ -164,12 +168,14 @@
 #include <mlpack/core/math/range.hpp>
 #include <mlpack/core/math/round.hpp>
 #include <mlpack/core/util/save_restore_utility.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
 #include <mlpack/core/dists/laplace_distribution.hpp>
 
 // Include kernel traits.
 #include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
 #include <mlpack/core/kernels/cosine_distance.hpp>
@@ -26,10 +26,23 @@ op_ccov::direct_ccov(Mat<eT>& out, const Mat<eT>& A, const uword norm_type)
     const uword N = A.n_cols;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
 
-    const Col<eT> acc = sum(A, 1);
+    // Subtract the mean before accumulating, a block of columns at a time;
+    // A * A' - N * mean * mean' loses precision when the mean is large.
+    const Col<eT> mean = sum(A, 1) / eT(N);
+    const uword block_size = 1024;
+
+    out.zeros(A.n_rows, A.n_rows);
+
+    for(uword first = 0; first < N; first += block_size)
+      {
+      const uword last = (std::min)(first + block_size, N) - 1;
+
+      Mat<eT> tmp = A.cols(first, last);
+      tmp.each_col() -= mean;
+
+      out += tmp * trans(tmp);
+      }
 
-    out = A * trans(A);
-    out -= (acc * trans(acc)) / eT(N);
     out /= norm_val;
     }
   }
@@ -0,0 +1,138 @@
+/**
+ * @file chunked_load.hpp
+ * @author Ryan Curtin
+ *
+ * A loader that reads a dataset from file a block of points at a time, so that
+ * datasets larger than memory can be processed incrementally.
+ */
+#ifndef __MLPACK_CORE_DATA_CHUNKED_LOAD_HPP
+#define __MLPACK_CORE_DATA_CHUNKED_LOAD_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <string>
+#include <fstream>
+
+#include "decompressing_stream.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Read a dataset from file in chunks of points, using memory bounded by the
+ * chunk size.  As with data::Load(), each row of the file is a point and each
+ * returned chunk is transposed, so that each column of a chunk is a point;
+ * unlike data::Load(), the whole file is never held in memory.
+ *
+ * The supported types of files are:
+ *
+ *  - CSV (csv_ascii), denoted by .csv, or optionally .txt
+ *  - ASCII (raw_ascii), denoted by .txt
+ *  - Armadillo ASCII (arma_ascii), also denoted by .txt
+ *  - Armadillo binary (arma_binary), denoted by .bin
+ *
+ * Raw binary files carry no dimensionality information and are not supported.
+ * Text files may be compressed with gzip (.gz) or zstd (.zst), if mlpack was
+ * built with zlib or zstd; they are decompressed on a separate thread while
+ * the chunks are parsed.  Reset() and NumPoints() then decompress the file
+ * again from its start.
+ *
+ * @code
+ * data::ChunkedLoader<double> loader("huge.csv", true);
+ *
+ * arma::mat chunk;
+ * while (loader.NextChunk(chunk, 10000))
+ * {
+ *   // Each column of 'chunk' is one point.
+ * }
+ * @endcode
+ *
+ * @tparam eT Element type of the loaded chunks.
+ */
+template<typename eT>
+class ChunkedLoader
+{
+ public:
+  /**
+   * Open the given file and read its header (or its first line, for text
+   * files) to determine the dimensionality of the data.  If the file cannot be
+   * opened or its type is not supported, IsOpen() will return false; if
+   * 'fatal' is true, a std::runtime_error is thrown instead.
+   *
+   * @param filename Name of file to load.
+   * @param fatal If an error should be reported as fatal (default false).
+   */
+  ChunkedLoader(const std::string& filename, const bool fatal = false);
+
+  /**
+   * Read up to maxPoints points into the given matrix, which will be resized
+   * to (Dimensionality() x number of points read).  Returns false (and leaves
+   * the matrix empty) when there are no more points to read or when the file
+   * is malformed.
+   *
+   * @param chunk Matrix to read points into.
+   * @param maxPoints Maximum number of points to read.
+   * @return Whether or not any points were read.
+   */
+  bool NextChunk(arma::Mat<eT>& chunk, const size_t maxPoints);
+
+  //! Go back to the first point of the file.
+  void Reset();
+
+  /**
+   * Return the total number of points in the file.  For Armadillo files this
+   * is given in the header; for other text files, the file is scanned once
+   * (without parsing the values) and the position of the reader is kept.
+   */
+  size_t NumPoints();
+
+  //! Return whether or not the file was opened successfully.
+  bool IsOpen() const { return open; }
+  //! Return the dimensionality of the points in the file.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Return the number of points read since the file was opened or Reset().
+  size_t PointsRead() const { return pointsRead; }
+
+ private:
+  //! Report an error, either as fatal or as a warning.
+  void Error(const std::string& message);
+
+  //! Parse one line of a text file into the given column; returns the number
+  //! of values found on the line.
+  size_t ParseLine(const std::string& line, eT* column);
+
+  //! Name of the file being read.
+  std::string filename;
+  //! Whether errors are fatal.
+  bool fatal;
+
+  //! The uncompressed file.
+  std::ifstream file;
+  //! The decompressed contents of a compressed file.
+  boost::scoped_ptr<DecompressingStreamBuf> decompressed;
+  //! The stream the file is read from (either of the above).
+  std::istream stream;
+  //! Whether or not the file is open and readable.
+  bool open;
+  //! Whether the file is Armadillo binary (otherwise it is text).
+  bool binary;
+
+  //! Position of the first point in the file.
+  std::streampos dataStart;
+  //! The dimensionality of each point.
+  size_t dimensionality;
+  //! The total number of points (only known for Armadillo files).
+  size_t numPoints;
+  //! The number of points read so far.
+  size_t pointsRead;
+  //! The number of lines read so far (for error messages).
+  size_t linesRead;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "chunked_load_impl.hpp"
+
+#endif
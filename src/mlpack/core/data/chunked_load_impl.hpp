@@ -0,0 +1,301 @@
+/**
+ * @file chunked_load_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the ChunkedLoader class.
+ */
+#ifndef __MLPACK_CORE_DATA_CHUNKED_LOAD_IMPL_HPP
+#define __MLPACK_CORE_DATA_CHUNKED_LOAD_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "chunked_load.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+ChunkedLoader<eT>::ChunkedLoader(const std::string& filename,
+                                 const bool fatal) :
+    filename(filename),
+    fatal(fatal),
+    stream(NULL),
+    open(false),
+    binary(false),
+    dataStart(0),
+    dimensionality(0),
+    numPoints(0),
+    pointsRead(0),
+    linesRead(0)
+{
+  // Discriminate by file extension, like data::Load(); the extension of a
+  // compressed file is the one before the compression extension.
+  const bool compressed = (DecompressingReader::FileCompression(filename) !=
+      DecompressingReader::NONE);
+  const std::string uncompressedName =
+      DecompressingReader::UncompressedName(filename);
+  const size_t ext = uncompressedName.rfind('.');
+  if (ext == std::string::npos)
+  {
+    Error("no extension is present");
+    return;
+  }
+
+  std::string extension = uncompressedName.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  if (extension != "csv" && extension != "txt" && extension != "bin")
+  {
+    Error("only CSV, ASCII, and Armadillo binary files can be loaded in "
+        "chunks");
+    return;
+  }
+
+  binary = (extension == "bin");
+  if (compressed)
+  {
+    // Binary files are read by seeking, which would mean decompressing again.
+    if (binary)
+    {
+      Error("compressed Armadillo binary files cannot be loaded in chunks");
+      return;
+    }
+
+    decompressed.reset(new DecompressingStreamBuf(filename));
+    if (!decompressed->IsOpen())
+    {
+      Error("cannot decompress file");
+      return;
+    }
+    stream.rdbuf(decompressed.get());
+  }
+  else
+  {
+    file.open(filename.c_str(), binary ? (std::ios::in | std::ios::binary) :
+        std::ios::in);
+    if (!file.is_open())
+    {
+      Error("cannot open file");
+      return;
+    }
+    stream.rdbuf(file.rdbuf());
+  }
+
+  if (binary)
+  {
+    // Only Armadillo binary files say how many rows and columns there are.
+    std::string header;
+    stream >> header;
+    if (header.substr(0, 12) != "ARMA_MAT_BIN")
+    {
+      Error("raw binary files cannot be loaded in chunks");
+      return;
+    }
+
+    if (header != arma::diskio::gen_bin_header(arma::Mat<eT>()))
+    {
+      Error("element type of file (" + header + ") does not match the element "
+          "type of the matrix");
+      return;
+    }
+
+    stream >> numPoints >> dimensionality;
+    stream.get(); // The newline before the data.
+  }
+  else
+  {
+    // Check for an Armadillo ASCII header.
+    std::string line;
+    std::getline(stream, line);
+    if (line.substr(0, 12) == "ARMA_MAT_TXT")
+    {
+      stream >> numPoints >> dimensionality;
+      std::getline(stream, line); // The rest of the size line.
+    }
+    else
+    {
+      // Find the dimensionality from the first nonempty line, then go back to
+      // the start of the file.
+      stream.clear();
+      stream.seekg(0);
+      while (dimensionality == 0 && std::getline(stream, line))
+        dimensionality = ParseLine(line, NULL);
+
+      stream.clear();
+      stream.seekg(0);
+    }
+  }
+
+  if (!stream.good())
+  {
+    Error("could not read header");
+    return;
+  }
+
+  dataStart = stream.tellg();
+  open = true;
+
+  Log::Info << "Reading '" << filename << "' in chunks; dimensionality is "
+      << dimensionality << "." << std::endl;
+}
+
+template<typename eT>
+bool ChunkedLoader<eT>::NextChunk(arma::Mat<eT>& chunk, const size_t maxPoints)
+{
+  chunk.reset();
+  if (!open || maxPoints == 0)
+    return false;
+
+  if (binary)
+  {
+    const size_t count = std::min(maxPoints, numPoints - pointsRead);
+    if (count == 0)
+      return false;
+
+    // The file matrix is stored column-major with one point per row, so each
+    // dimension of the chunk is a contiguous run in the file.
+    chunk.set_size(dimensionality, count);
+    arma::Col<eT> buffer(count);
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      stream.seekg(dataStart + std::streamoff(sizeof(eT) *
+          (d * numPoints + pointsRead)));
+      stream.read(reinterpret_cast<char*>(buffer.memptr()),
+          std::streamsize(sizeof(eT) * count));
+      if (!stream.good())
+      {
+        chunk.reset();
+        Error("file is truncated");
+        return false;
+      }
+
+      chunk.row(d) = buffer.t();
+    }
+
+    pointsRead += count;
+    return true;
+  }
+
+  // For text files, read one point per nonempty line.  If the file had an
+  // Armadillo header, don't read past the number of points it gives.
+  size_t maxCount = maxPoints;
+  if (numPoints > 0)
+    maxCount = std::min(maxCount, numPoints - pointsRead);
+  if (maxCount == 0)
+    return false;
+
+  chunk.set_size(dimensionality, maxCount);
+  size_t count = 0;
+  std::string line;
+  while (count < maxCount && std::getline(stream, line))
+  {
+    ++linesRead;
+    const size_t values = ParseLine(line, chunk.colptr(count));
+    if (values == 0)
+      continue; // Empty line.
+
+    if (values != dimensionality)
+    {
+      chunk.reset();
+      std::ostringstream oss;
+      oss << "line " << linesRead << " has " << values << " values, but "
+          << dimensionality << " were expected";
+      Error(oss.str());
+      return false;
+    }
+
+    ++count;
+  }
+
+  if (count == 0)
+  {
+    chunk.reset();
+    return false;
+  }
+
+  chunk.resize(dimensionality, count);
+  pointsRead += count;
+  return true;
+}
+
+template<typename eT>
+void ChunkedLoader<eT>::Reset()
+{
+  if (!open)
+    return;
+
+  stream.clear();
+  stream.seekg(dataStart);
+  pointsRead = 0;
+  linesRead = 0;
+}
+
+template<typename eT>
+size_t ChunkedLoader<eT>::NumPoints()
+{
+  if (!open || binary || numPoints > 0)
+    return numPoints;
+
+  // Count the nonempty lines, then go back to where we were.
+  stream.clear();
+  const std::streampos position = stream.tellg();
+  stream.seekg(dataStart);
+
+  size_t count = 0;
+  std::string line;
+  while (std::getline(stream, line))
+    if (line.find_first_not_of(", \t\r") != std::string::npos)
+      ++count;
+
+  stream.clear();
+  stream.seekg(position);
+
+  numPoints = count;
+  return numPoints;
+}
+
+template<typename eT>
+void ChunkedLoader<eT>::Error(const std::string& message)
+{
+  open = false;
+  if (fatal)
+    Log::Fatal << "Cannot read '" << filename << "' in chunks: " << message
+        << "." << std::endl;
+  else
+    Log::Warn << "Cannot read '" << filename << "' in chunks: " << message
+        << "; load failed." << std::endl;
+}
+
+template<typename eT>
+size_t ChunkedLoader<eT>::ParseLine(const std::string& line, eT* column)
+{
+  // Values may be separated by commas, spaces, or tabs.
+  const char* separators = ", \t\r";
+  size_t values = 0;
+  size_t pos = line.find_first_not_of(separators);
+  while (pos != std::string::npos)
+  {
+    const size_t end = line.find_first_of(separators, pos);
+    if (column != NULL && values < dimensionality)
+    {
+      const std::string token = line.substr(pos, (end == std::string::npos) ?
+          std::string::npos : end - pos);
+      column[values] = eT(std::strtod(token.c_str(), NULL));
+    }
+
+    ++values;
+    pos = (end == std::string::npos) ? end :
+        line.find_first_not_of(separators, end);
+  }
+
+  return values;
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * @file chunked_save.hpp
+ * @author Ryan Curtin
+ *
+ * A saver that writes a dataset to file a block of points at a time, so that
+ * results larger than memory can be written incrementally.
+ */
+#ifndef __MLPACK_CORE_DATA_CHUNKED_SAVE_HPP
+#define __MLPACK_CORE_DATA_CHUNKED_SAVE_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <string>
+#include <fstream>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Write a dataset to an Armadillo binary file in chunks of points, using memory
+ * bounded by the chunk size.  Each column of a chunk is a point, and the file
+ * is laid out exactly as data::Save() would write the whole dataset (one point
+ * per row), so it can be read back with data::Load() or a ChunkedLoader.  The
+ * total number of points must be known in advance; the chunks are appended in
+ * order.
+ *
+ * @code
+ * data::ChunkedSaver<double> saver("results.bin", 10, numPoints, true);
+ *
+ * arma::mat chunk;
+ * while (...)
+ *   saver.Append(chunk); // chunk has 10 rows.
+ *
+ * saver.Close();
+ * @endcode
+ *
+ * @tparam eT Element type of the saved chunks.
+ */
+template<typename eT>
+class ChunkedSaver
+{
+ public:
+  /**
+   * Create the given file (which must have the extension .bin), write its
+   * header, and reserve space for all of the points.  If the file cannot be
+   * created, IsOpen() will return false; if 'fatal' is true, a
+   * std::runtime_error is thrown instead.
+   *
+   * @param filename Name of file to save to.
+   * @param dimensionality Dimensionality of each point.
+   * @param numPoints Total number of points that will be saved.
+   * @param fatal If an error should be reported as fatal (default false).
+   */
+  ChunkedSaver(const std::string& filename,
+               const size_t dimensionality,
+               const size_t numPoints,
+               const bool fatal = false);
+
+  /**
+   * Append the points (columns) of the given chunk to the file.  Returns false
+   * if the chunk has the wrong dimensionality, if it holds more points than
+   * are left, or if writing fails.
+   *
+   * @param chunk Points to append.
+   * @return Whether or not the points were written.
+   */
+  bool Append(const arma::Mat<eT>& chunk);
+
+  /**
+   * Flush and close the file.  Returns false (with a warning or error) if
+   * fewer points than announced were written.
+   */
+  bool Close();
+
+  //! Return whether or not the file is open and writable.
+  bool IsOpen() const { return open; }
+  //! Return the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Return the total number of points of the file.
+  size_t NumPoints() const { return numPoints; }
+  //! Return the number of points written so far.
+  size_t PointsWritten() const { return pointsWritten; }
+
+ private:
+  //! Report an error, either as fatal or as a warning.
+  void Error(const std::string& message);
+
+  //! Name of the file being written.
+  std::string filename;
+  //! Whether errors are fatal.
+  bool fatal;
+
+  //! The stream the file is written to.
+  std::ofstream stream;
+  //! Whether or not the file is open and writable.
+  bool open;
+
+  //! Position of the first point in the file.
+  std::streampos dataStart;
+  //! The dimensionality of each point.
+  size_t dimensionality;
+  //! The total number of points.
+  size_t numPoints;
+  //! The number of points written so far.
+  size_t pointsWritten;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "chunked_save_impl.hpp"
+
+#endif
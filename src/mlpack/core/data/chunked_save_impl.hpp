@@ -0,0 +1,156 @@
+/**
+ * @file chunked_save_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the ChunkedSaver class.
+ */
+#ifndef __MLPACK_CORE_DATA_CHUNKED_SAVE_IMPL_HPP
+#define __MLPACK_CORE_DATA_CHUNKED_SAVE_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "chunked_save.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+ChunkedSaver<eT>::ChunkedSaver(const std::string& filename,
+                               const size_t dimensionality,
+                               const size_t numPoints,
+                               const bool fatal) :
+    filename(filename),
+    fatal(fatal),
+    open(false),
+    dataStart(0),
+    dimensionality(dimensionality),
+    numPoints(numPoints),
+    pointsWritten(0)
+{
+  const size_t ext = filename.rfind('.');
+  std::string extension = (ext == std::string::npos) ? "" :
+      filename.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  if (extension != "bin")
+  {
+    Error("only Armadillo binary files (.bin) can be saved in chunks");
+    return;
+  }
+
+  stream.open(filename.c_str(), std::ios::out | std::ios::binary |
+      std::ios::trunc);
+  if (!stream.is_open())
+  {
+    Error("cannot open file");
+    return;
+  }
+
+  // The file holds the transposed dataset (one point per row), as written by
+  // data::Save().
+  stream << arma::diskio::gen_bin_header(arma::Mat<eT>()) << '\n';
+  stream << numPoints << ' ' << dimensionality << '\n';
+  dataStart = stream.tellp();
+
+  // Reserve the space for the points, so that chunks can be written at any
+  // offset.
+  const size_t bytes = sizeof(eT) * dimensionality * numPoints;
+  if (bytes > 0)
+  {
+    stream.seekp(dataStart + std::streamoff(bytes - 1));
+    stream.put('\0');
+  }
+
+  if (!stream.good())
+  {
+    Error("could not write header");
+    return;
+  }
+
+  open = true;
+}
+
+template<typename eT>
+bool ChunkedSaver<eT>::Append(const arma::Mat<eT>& chunk)
+{
+  if (!open)
+    return false;
+
+  if (chunk.n_rows != dimensionality || chunk.n_cols > numPoints -
+      pointsWritten)
+  {
+    std::ostringstream oss;
+    oss << "chunk of size " << chunk.n_rows << "x" << chunk.n_cols << " does "
+        << "not fit (dimensionality " << dimensionality << ", "
+        << (numPoints - pointsWritten) << " points left)";
+    Error(oss.str());
+    return false;
+  }
+
+  // Each dimension of the chunk is a contiguous run in the file.
+  arma::Col<eT> buffer(chunk.n_cols);
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    buffer = chunk.row(d).t();
+    stream.seekp(dataStart + std::streamoff(sizeof(eT) *
+        (d * numPoints + pointsWritten)));
+    stream.write(reinterpret_cast<const char*>(buffer.memptr()),
+        std::streamsize(sizeof(eT) * chunk.n_cols));
+  }
+
+  if (!stream.good())
+  {
+    Error("write failed");
+    return false;
+  }
+
+  pointsWritten += chunk.n_cols;
+  return true;
+}
+
+template<typename eT>
+bool ChunkedSaver<eT>::Close()
+{
+  if (!open)
+    return false;
+
+  stream.close();
+  open = false;
+
+  if (stream.fail())
+  {
+    Error("could not close file");
+    return false;
+  }
+
+  if (pointsWritten != numPoints)
+  {
+    std::ostringstream oss;
+    oss << "only " << pointsWritten << " of " << numPoints << " points were "
+        << "written";
+    Error(oss.str());
+    return false;
+  }
+
+  return true;
+}
+
+template<typename eT>
+void ChunkedSaver<eT>::Error(const std::string& message)
+{
+  open = false;
+  if (fatal)
+    Log::Fatal << "Cannot save '" << filename << "' in chunks: " << message
+        << "." << std::endl;
+  else
+    Log::Warn << "Cannot save '" << filename << "' in chunks: " << message
+        << "; save failed." << std::endl;
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
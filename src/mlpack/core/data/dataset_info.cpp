@@ -0,0 +1,59 @@
+/**
+ * @file dataset_info.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the DatasetInfo class.
+ */
+#include "dataset_info.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+DatasetInfo::DatasetInfo(const size_t dimensionality) :
+    types(dimensionality, numeric),
+    maps(dimensionality),
+    strings(dimensionality)
+{
+  // Nothing to do.
+}
+
+size_t DatasetInfo::MapString(const std::string& string,
+                              const size_t dimension)
+{
+  Log::Assert(dimension < types.size());
+  types[dimension] = categorical;
+
+  const std::pair<std::unordered_map<std::string, size_t>::iterator, bool>
+      result = maps[dimension].insert(std::make_pair(string,
+      strings[dimension].size()));
+  if (result.second)
+    strings[dimension].push_back(string);
+
+  return result.first->second;
+}
+
+const std::string& DatasetInfo::UnmapString(const size_t value,
+                                            const size_t dimension) const
+{
+  Log::Assert(dimension < types.size());
+  Log::Assert(value < strings[dimension].size());
+  return strings[dimension][value];
+}
+
+Datatype DatasetInfo::Type(const size_t dimension) const
+{
+  Log::Assert(dimension < types.size());
+  return types[dimension];
+}
+
+Datatype& DatasetInfo::Type(const size_t dimension)
+{
+  Log::Assert(dimension < types.size());
+  return types[dimension];
+}
+
+size_t DatasetInfo::NumMappings(const size_t dimension) const
+{
+  Log::Assert(dimension < types.size());
+  return strings[dimension].size();
+}
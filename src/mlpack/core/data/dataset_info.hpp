@@ -0,0 +1,100 @@
+/**
+ * @file dataset_info.hpp
+ * @author Ryan Curtin
+ *
+ * The type of each dimension of a dataset (numeric or categorical), and the
+ * dictionary that maps the strings of each categorical dimension to integers.
+ */
+#ifndef __MLPACK_CORE_DATA_DATASET_INFO_HPP
+#define __MLPACK_CORE_DATA_DATASET_INFO_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mlpack {
+namespace data {
+
+//! The type of a dimension of a dataset.
+enum Datatype
+{
+  numeric,
+  categorical
+};
+
+/**
+ * Auxiliary information about a dataset loaded with data::Load(): whether each
+ * dimension is numeric or categorical, and, for each categorical dimension, the
+ * dictionary between its values (strings) and the integers they are encoded as
+ * in the loaded matrix.  The integers of a dimension are 0, 1, 2, ..., in the
+ * order the strings were first seen.
+ *
+ * The same DatasetInfo can be given to data::Load() for several files (for
+ * instance a training set and a test set); the dictionaries are then shared,
+ * so the same string is encoded as the same integer in every file.
+ *
+ * @code
+ * data::DatasetInfo info;
+ * arma::mat dataset;
+ * data::Load("census.csv", dataset, info);
+ *
+ * if (info.Type(3) == data::categorical)
+ *   std::cout << info.UnmapString(dataset(3, 0), 3) << std::endl;
+ * @endcode
+ */
+class DatasetInfo
+{
+ public:
+  /**
+   * Create the information for a dataset of the given dimensionality, with
+   * every dimension numeric.
+   *
+   * @param dimensionality Number of dimensions of the dataset.
+   */
+  DatasetInfo(const size_t dimensionality = 0);
+
+  /**
+   * Return the integer that the given string is encoded as in the given
+   * dimension, adding it to the dictionary if it hasn't been seen yet.  This
+   * makes the dimension categorical.
+   *
+   * @param string String to encode.
+   * @param dimension Dimension the string is a value of.
+   */
+  size_t MapString(const std::string& string, const size_t dimension);
+
+  /**
+   * Return the string that the given integer encodes in the given dimension.
+   * The integer must have been given by MapString().
+   *
+   * @param value Encoded value.
+   * @param dimension Dimension the value is a value of.
+   */
+  const std::string& UnmapString(const size_t value,
+                                 const size_t dimension) const;
+
+  //! Return the type of the given dimension.
+  Datatype Type(const size_t dimension) const;
+  //! Modify the type of the given dimension.
+  Datatype& Type(const size_t dimension);
+
+  //! Return the number of strings in the dictionary of the given dimension.
+  size_t NumMappings(const size_t dimension) const;
+
+  //! Return the dimensionality of the dataset.
+  size_t Dimensionality() const { return types.size(); }
+
+ private:
+  //! The type of each dimension.
+  std::vector<Datatype> types;
+  //! For each dimension, the integer of each string seen.
+  std::vector<std::unordered_map<std::string, size_t> > maps;
+  //! For each dimension, the string of each integer.
+  std::vector<std::vector<std::string> > strings;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
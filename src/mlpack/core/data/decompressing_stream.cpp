@@ -0,0 +1,374 @@
+/**
+ * @file decompressing_stream.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the readers for compressed files.
+ */
+#include "decompressing_stream.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef ZLIB_FOUND
+  #include <zlib.h>
+#endif
+#ifdef ZSTD_FOUND
+  #include <zstd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+//! The size of the compressed input read at once.
+static const size_t inputSize = 1 << 18;
+
+DecompressingReader::DecompressingReader(const std::string& filename,
+                                         const size_t blockSize,
+                                         const size_t maxBlocks) :
+    file(NULL),
+    compression(FileCompression(filename)),
+    open(false),
+    blockSize(std::max(blockSize, (size_t) 1)),
+    maxBlocks(std::max(maxBlocks, (size_t) 1)),
+    finished(false),
+    failed(false),
+    stopping(false)
+{
+  if (!Supported(compression))
+  {
+    Log::Warn << "Cannot decompress '" << filename << "': "
+        << ((compression == NONE) ? "unknown compression" :
+        "support for this compression was not compiled in") << "."
+        << std::endl;
+    return;
+  }
+
+  file = fopen(filename.c_str(), "rb");
+  if (file == NULL)
+  {
+    Log::Warn << "Cannot open file '" << filename << "'." << std::endl;
+    return;
+  }
+
+  open = true;
+  decompressor = std::thread(&DecompressingReader::DecompressLoop, this);
+}
+
+DecompressingReader::~DecompressingReader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  consumed.notify_one();
+
+  if (decompressor.joinable())
+    decompressor.join();
+  if (file != NULL)
+    fclose(file);
+}
+
+bool DecompressingReader::NextBlock(std::string& block)
+{
+  block.clear();
+  if (!open)
+    return false;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (blocks.empty() && !finished)
+    produced.wait(lock);
+  if (blocks.empty())
+    return false;
+
+  block.swap(blocks.front());
+  blocks.pop_front();
+  lock.unlock();
+
+  consumed.notify_one();
+  return true;
+}
+
+bool DecompressingReader::Failed()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return failed;
+}
+
+DecompressingReader::Compression DecompressingReader::FileCompression(
+    const std::string& filename)
+{
+  const size_t ext = filename.rfind('.');
+  if (ext == std::string::npos)
+    return NONE;
+
+  std::string extension = filename.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  if (extension == "gz")
+    return GZIP;
+  else if (extension == "zst")
+    return ZSTD;
+  return NONE;
+}
+
+std::string DecompressingReader::UncompressedName(const std::string& filename)
+{
+  if (FileCompression(filename) == NONE)
+    return filename;
+  return filename.substr(0, filename.rfind('.'));
+}
+
+bool DecompressingReader::Supported(const Compression compression)
+{
+  switch (compression)
+  {
+#ifdef ZLIB_FOUND
+    case GZIP: return true;
+#endif
+#ifdef ZSTD_FOUND
+    case ZSTD: return true;
+#endif
+    default: return false;
+  }
+}
+
+void DecompressingReader::DecompressLoop()
+{
+  const bool success = (compression == GZIP) ? DecompressGzip() :
+      DecompressZstd();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    failed = !success;
+  }
+  produced.notify_one();
+}
+
+bool DecompressingReader::PushBlock(std::string& block)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (blocks.size() >= maxBlocks && !stopping)
+      consumed.wait(lock);
+    if (stopping)
+      return false;
+
+    blocks.push_back(std::string());
+    blocks.back().swap(block);
+  }
+
+  produced.notify_one();
+  block.clear();
+  return true;
+}
+
+bool DecompressingReader::DecompressGzip()
+{
+#ifdef ZLIB_FOUND
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  stream.avail_in = 0;
+  stream.next_in = Z_NULL;
+
+  // 15 + 32: the largest window, with automatic gzip or zlib header detection.
+  if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    return false;
+
+  std::vector<unsigned char> input(inputSize);
+  std::string block(blockSize, '\0');
+  size_t blockFill = 0;
+  bool success = true, needInput = true;
+  while (true)
+  {
+    // More input is only needed once inflate() has room left in the block, or
+    // it may still hold decompressed data.
+    if (stream.avail_in == 0 && needInput)
+    {
+      stream.avail_in = (uInt) fread(&input[0], 1, input.size(), file);
+      stream.next_in = &input[0];
+      if (stream.avail_in == 0)
+      {
+        // The data may only end between two gzip members.
+        success = !ferror(file) && (stream.total_in == 0);
+        break;
+      }
+    }
+
+    stream.avail_out = (uInt) (blockSize - blockFill);
+    stream.next_out = (unsigned char*) &block[blockFill];
+    const int result = inflate(&stream, Z_NO_FLUSH);
+    blockFill = blockSize - stream.avail_out;
+    needInput = (stream.avail_out != 0);
+
+    // A gzip file may consist of several concatenated members.
+    if (result == Z_STREAM_END)
+      inflateReset(&stream);
+    else if (result != Z_OK && result != Z_BUF_ERROR)
+    {
+      success = false;
+      break;
+    }
+
+    if (blockFill == blockSize)
+    {
+      if (!PushBlock(block))
+        break;
+      block.assign(blockSize, '\0');
+      blockFill = 0;
+    }
+  }
+
+  if (success && blockFill > 0)
+  {
+    block.resize(blockFill);
+    PushBlock(block);
+  }
+
+  inflateEnd(&stream);
+  return success;
+#else
+  return false;
+#endif
+}
+
+bool DecompressingReader::DecompressZstd()
+{
+#ifdef ZSTD_FOUND
+  ZSTD_DStream* stream = ZSTD_createDStream();
+  if (stream == NULL)
+    return false;
+  ZSTD_initDStream(stream);
+
+  std::vector<char> input(inputSize);
+  std::string block(blockSize, '\0');
+  ZSTD_inBuffer in = { &input[0], 0, 0 };
+  ZSTD_outBuffer out = { &block[0], blockSize, 0 };
+  size_t lastResult = 0;
+  bool success = true, needInput = true;
+  while (true)
+  {
+    // More input is only needed once the decompressor has room left in the
+    // block, or it may still hold decompressed data.
+    if (in.pos == in.size && needInput)
+    {
+      in.size = fread(&input[0], 1, input.size(), file);
+      in.pos = 0;
+      if (in.size == 0)
+      {
+        // A complete frame leaves nothing to flush.
+        success = !ferror(file) && (lastResult == 0);
+        break;
+      }
+    }
+
+    lastResult = ZSTD_decompressStream(stream, &out, &in);
+    if (ZSTD_isError(lastResult))
+    {
+      success = false;
+      break;
+    }
+    needInput = (out.pos < out.size);
+
+    if (out.pos == out.size)
+    {
+      if (!PushBlock(block))
+        break;
+      block.assign(blockSize, '\0');
+      out.dst = &block[0];
+      out.pos = 0;
+    }
+  }
+
+  if (success && out.pos > 0)
+  {
+    block.resize(out.pos);
+    PushBlock(block);
+  }
+
+  ZSTD_freeDStream(stream);
+  return success;
+#else
+  return false;
+#endif
+}
+
+DecompressingStreamBuf::DecompressingStreamBuf(const std::string& filename) :
+    filename(filename),
+    reader(new DecompressingReader(filename)),
+    blockStart(0)
+{
+  setg(NULL, NULL, NULL);
+}
+
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+
+  blockStart += block.size();
+  if (!reader->NextBlock(block))
+  {
+    block.clear();
+    setg(NULL, NULL, NULL);
+    return traits_type::eof();
+  }
+
+  char* begin = &block[0];
+  setg(begin, begin, begin + block.size());
+  return traits_type::to_int_type(*gptr());
+}
+
+DecompressingStreamBuf::pos_type DecompressingStreamBuf::seekoff(
+    off_type offset,
+    std::ios_base::seekdir direction,
+    std::ios_base::openmode mode)
+{
+  const size_t current = blockStart + (gptr() - eback());
+  if (direction == std::ios_base::cur)
+    return (offset == 0) ? pos_type(current) :
+        seekpos(pos_type(current + offset), mode);
+  else if (direction == std::ios_base::beg)
+    return seekpos(pos_type(offset), mode);
+
+  // The end of the decompressed data isn't known.
+  return pos_type(off_type(-1));
+}
+
+DecompressingStreamBuf::pos_type DecompressingStreamBuf::seekpos(
+    pos_type position,
+    std::ios_base::openmode mode)
+{
+  if (!(mode & std::ios_base::in) || position < 0)
+    return pos_type(off_type(-1));
+
+  // Going back means decompressing again from the start.
+  const size_t target = (size_t) off_type(position);
+  if (target < blockStart)
+  {
+    reader.reset(new DecompressingReader(filename));
+    block.clear();
+    blockStart = 0;
+    setg(NULL, NULL, NULL);
+  }
+
+  // Skip ahead to the block that holds the target.
+  while (target >= blockStart + block.size())
+  {
+    setg(NULL, NULL, NULL);
+    if (underflow() == traits_type::eof())
+    {
+      // Only the very end of the data can be reached this way.
+      if (target != blockStart)
+        return pos_type(off_type(-1));
+      return position;
+    }
+  }
+
+  char* begin = &block[0];
+  setg(begin, begin + (target - blockStart), begin + block.size());
+  return position;
+}
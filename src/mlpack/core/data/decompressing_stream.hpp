@@ -0,0 +1,183 @@
+/**
+ * @file decompressing_stream.hpp
+ * @author Ryan Curtin
+ *
+ * Readers for gzip and zstd compressed files, which decompress on a separate
+ * thread so that decompression is pipelined with parsing.
+ */
+#ifndef __MLPACK_CORE_DATA_DECOMPRESSING_STREAM_HPP
+#define __MLPACK_CORE_DATA_DECOMPRESSING_STREAM_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Reads a compressed file and returns its decompressed contents one block at a
+ * time.  The file is read and decompressed by a separate thread, which stays at
+ * most a few blocks ahead of the caller, so the decompression of the next
+ * blocks overlaps with whatever the caller does with the current one, and the
+ * memory used is bounded.
+ *
+ * The compression is given by the extension of the file: .gz for gzip (zlib is
+ * needed) and .zst for zstd (libzstd is needed).  Support for each is compiled
+ * in if the library was found by CMake.
+ *
+ * @code
+ * DecompressingReader reader("features.csv.gz");
+ * std::string block;
+ * while (reader.NextBlock(block))
+ * {
+ *   // Use the block.
+ * }
+ * @endcode
+ */
+class DecompressingReader
+{
+ public:
+  //! The kinds of compression.
+  enum Compression
+  {
+    NONE,
+    GZIP,
+    ZSTD
+  };
+
+  /**
+   * Open the given compressed file and start decompressing it.  If the file
+   * can't be opened or its compression isn't supported, a warning is printed
+   * and IsOpen() returns false.
+   *
+   * @param filename Name of the compressed file.
+   * @param blockSize Size of the decompressed blocks.
+   * @param maxBlocks Maximum number of blocks decompressed ahead.
+   */
+  DecompressingReader(const std::string& filename,
+                      const size_t blockSize = 1 << 20,
+                      const size_t maxBlocks = 4);
+
+  //! Stop the decompression and close the file.
+  ~DecompressingReader();
+
+  /**
+   * Get the next block of decompressed data, waiting for it if necessary.
+   * Returns false at the end of the data, or if the file is corrupt (then
+   * Failed() returns true).
+   *
+   * @param block String to store the block in.
+   */
+  bool NextBlock(std::string& block);
+
+  //! Return whether or not the file was opened successfully.
+  bool IsOpen() const { return open; }
+  //! Return whether or not the file turned out to be corrupt.
+  bool Failed();
+
+  //! Return the compression of the given file, judging by its extension.
+  static Compression FileCompression(const std::string& filename);
+  //! Return the name of the given file without its compression extension,
+  //! such as "features.csv" for "features.csv.gz".
+  static std::string UncompressedName(const std::string& filename);
+  //! Return whether or not the given compression is supported by this build.
+  static bool Supported(const Compression compression);
+
+ private:
+  //! The loop of the decompressing thread.
+  void DecompressLoop();
+  //! Decompress a gzip file; returns false if it is corrupt.
+  bool DecompressGzip();
+  //! Decompress a zstd file; returns false if it is corrupt.
+  bool DecompressZstd();
+  //! Queue a decompressed block, waiting while the queue is full.  Returns
+  //! false if the reader is being destroyed.
+  bool PushBlock(std::string& block);
+
+  //! The file being read.
+  FILE* file;
+  //! The compression of the file.
+  Compression compression;
+  //! Whether or not the file is open.
+  bool open;
+  //! Size of the decompressed blocks.
+  size_t blockSize;
+  //! Maximum number of queued blocks.
+  size_t maxBlocks;
+
+  //! Protects everything below.
+  std::mutex mutex;
+  //! Signals that a block was queued or that decompression finished.
+  std::condition_variable produced;
+  //! Signals that a block was taken or that the reader is being destroyed.
+  std::condition_variable consumed;
+  //! Decompressed blocks that haven't been read yet.
+  std::deque<std::string> blocks;
+  //! Whether or not the decompressing thread is done.
+  bool finished;
+  //! Whether or not the file is corrupt.
+  bool failed;
+  //! Whether or not the reader is being destroyed.
+  bool stopping;
+
+  //! The decompressing thread.
+  std::thread decompressor;
+};
+
+/**
+ * A std::streambuf over the decompressed contents of a compressed file, so
+ * that a std::istream can read compressed files as if they were uncompressed.
+ * Seeking is supported, but seeking backwards restarts the decompression from
+ * the start of the file, and seeking forwards decompresses everything in
+ * between.
+ */
+class DecompressingStreamBuf : public std::streambuf
+{
+ public:
+  /**
+   * Open the given compressed file (see DecompressingReader).
+   *
+   * @param filename Name of the compressed file.
+   */
+  DecompressingStreamBuf(const std::string& filename);
+
+  //! Return whether or not the file was opened successfully.
+  bool IsOpen() const { return reader->IsOpen(); }
+  //! Return whether or not the file turned out to be corrupt.
+  bool Failed() { return reader->Failed(); }
+
+ protected:
+  //! Get the next block of decompressed data.
+  int_type underflow();
+
+  //! Seek relative to the start or the current position.
+  pos_type seekoff(off_type offset,
+                   std::ios_base::seekdir direction,
+                   std::ios_base::openmode mode);
+
+  //! Seek to the given position.
+  pos_type seekpos(pos_type position, std::ios_base::openmode mode);
+
+ private:
+  //! The name of the file, for restarting.
+  std::string filename;
+  //! The reader of the decompressed data.
+  boost::scoped_ptr<DecompressingReader> reader;
+  //! The current block of decompressed data.
+  std::string block;
+  //! The position of the current block in the decompressed data.
+  size_t blockStart;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
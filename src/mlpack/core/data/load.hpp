@@ -32,6 +32,10 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
  *
+ * CSV and ASCII files may also be compressed with gzip (.csv.gz, .txt.gz) or
+ * zstd (.csv.zst, .txt.zst), if mlpack was built with zlib or zstd; they are
+ * decompressed in memory, on a separate thread, while they are parsed.
+ *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
  * filetype as raw_binary, which can have very confusing effects.
@@ -58,6 +62,81 @@ bool Load(const std::string& filename,
 }; // namespace data
 }; // namespace mlpack
 
+#include "mapped_matrix.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Loads a matrix from an Armadillo binary or raw binary file without copying
+ * it: the file is mapped into memory and the matrix uses the mapping directly
+ * (see MappedMatrix).  The file is not transposed, so it must hold the matrix
+ * in column-major order, as written by data::Save() with 'transpose' set to
+ * false.  This is useful for very large reference sets, which are then only
+ * read from disk as they are used, and which several processes on one host
+ * can share.
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the file can't be mapped.  If 'shared' is true, the mapping is
+ * read-only and shared with every other process that maps the file; otherwise
+ * it is private, and changes to the matrix are not written to the file.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Mapped matrix to load the file into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param shared If true, map the file read-only and shared between processes.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          bool fatal = false,
+          bool shared = false);
+
+}; // namespace data
+}; // namespace mlpack
+
+#include "dataset_info.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Loads a CSV or ASCII file that may contain strings, such as categorical
+ * features or string labels, in a single pass over the file.  Every value that
+ * is not a number is encoded as an integer with the dictionary of its
+ * dimension in 'info', and makes that dimension categorical (see DatasetInfo);
+ * numbers seen in a dimension before it turned out to be categorical are
+ * encoded by their value.  Values of CSV files are separated by commas and may
+ * contain spaces; values of ASCII files are separated by whitespace.  The file
+ * may be compressed, like for the other overloads.
+ *
+ * If 'info' already has the dimensionality of the file, its dictionaries are
+ * kept and extended, so that several files can be encoded the same way;
+ * otherwise it is replaced.
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the matrix does not load successfully.  The parameter
+ * 'transpose' controls whether or not the matrix is transposed after loading.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Matrix to load contents of file into.
+ * @param info Types of the dimensions and dictionaries of the categorical
+ *     dimensions.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If true, transpose the matrix after loading.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::Mat<eT>& matrix,
+          DatasetInfo& info,
+          bool fatal = false,
+          bool transpose = true);
+
+}; // namespace data
+}; // namespace mlpack
+
 // Include implementation.
 #include "load_impl.hpp"
 
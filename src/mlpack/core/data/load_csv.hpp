@@ -0,0 +1,65 @@
+/**
+ * @file load_csv.hpp
+ * @author Ryan Curtin
+ *
+ * A fast, parallel parser for CSV and whitespace-separated ASCII files, used by
+ * data::Load() to read such files directly into the transposed (column-major)
+ * layout that mlpack uses.
+ */
+#ifndef __MLPACK_CORE_DATA_LOAD_CSV_HPP
+#define __MLPACK_CORE_DATA_LOAD_CSV_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <string>
+
+#include "decompressing_stream.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Load a CSV or whitespace-separated ASCII file into the given matrix, so that
+ * each line of the file becomes one column of the matrix.  This gives the same
+ * result as loading the file with Armadillo and transposing it, but the file is
+ * memory-mapped, the lines are located and parsed in parallel (with OpenMP),
+ * and each value is written directly into its final position, so neither a
+ * stream-based parse nor a transpose is needed.
+ *
+ * Values may be separated by commas, spaces, or tabs; empty lines are skipped.
+ * Anything this parser does not understand (a malformed value, or lines of
+ * different lengths) makes it return false without printing anything, so that
+ * the caller can fall back to Armadillo's parser.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Matrix to load contents of file into.
+ * @return Whether or not the file was parsed successfully.
+ */
+template<typename eT>
+bool LoadCSV(const std::string& filename, arma::Mat<eT>& matrix);
+
+/**
+ * Load the decompressed contents of a compressed CSV or whitespace-separated
+ * ASCII file into the given matrix, in the same way.  The start of every line
+ * is found while the reader decompresses the following blocks on its own
+ * thread, and then the lines are parsed in parallel.  The decompressed
+ * contents are kept in 'contents', so that the caller can fall back to
+ * Armadillo's parser without decompressing the file again.
+ *
+ * @param reader Reader of the compressed file.
+ * @param matrix Matrix to load contents of file into.
+ * @param contents String to store the decompressed contents in.
+ * @return Whether or not the file was parsed successfully.
+ */
+template<typename eT>
+bool LoadCSV(DecompressingReader& reader,
+             arma::Mat<eT>& matrix,
+             std::string& contents);
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "load_csv_impl.hpp"
+
+#endif
@@ -0,0 +1,380 @@
+/**
+ * @file load_csv_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the fast CSV/ASCII parser.
+ */
+#ifndef __MLPACK_CORE_DATA_LOAD_CSV_IMPL_HPP
+#define __MLPACK_CORE_DATA_LOAD_CSV_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "load_csv.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#else
+  #include <fstream>
+#endif
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace data {
+namespace csv /** Helpers for the fast CSV parser. */ {
+
+//! Return true if the character separates values on a line.
+inline bool IsSeparator(const char c)
+{
+  return (c == ',' || c == ' ' || c == '\t' || c == '\r');
+}
+
+/**
+ * Parse the value in [begin, end) with strtod().  This handles everything the
+ * fast path does not (very long mantissas, large exponents, 'nan', 'inf').
+ */
+inline bool ParseDoubleSlow(const char* begin, const char* end, double& value)
+{
+  // The mapped file is not null-terminated, so copy the token first.
+  const std::string token(begin, end);
+  char* tokenEnd;
+  value = std::strtod(token.c_str(), &tokenEnd);
+  return (tokenEnd == token.c_str() + token.size());
+}
+
+/**
+ * Parse the value in [begin, end), which contains no separators.  Decimal
+ * values whose mantissa fits in 53 bits and whose exponent is at most 22 in
+ * magnitude are converted exactly with one multiplication or division (this
+ * is Clinger's fast path, and covers nearly all values written by the usual
+ * tools); everything else is given to strtod().
+ */
+inline bool ParseDouble(const char* begin, const char* end, double& value)
+{
+  static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+      1e20, 1e21, 1e22 };
+
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+
+  uint64_t mantissa = 0;
+  int digits = 0; // Significant digits in the mantissa.
+  int exponent = 0;
+  bool anyDigits = false;
+
+  for (; p != end && *p >= '0' && *p <= '9'; ++p)
+  {
+    anyDigits = true;
+    if (mantissa == 0 && *p == '0')
+      continue; // Leading zero.
+    if (digits == 19)
+      return ParseDoubleSlow(begin, end, value);
+
+    mantissa = 10 * mantissa + (*p - '0');
+    ++digits;
+  }
+
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      anyDigits = true;
+      --exponent;
+      if (mantissa == 0 && *p == '0')
+        continue; // Leading zero.
+      if (digits == 19)
+        return ParseDoubleSlow(begin, end, value);
+
+      mantissa = 10 * mantissa + (*p - '0');
+      ++digits;
+    }
+  }
+
+  if (!anyDigits)
+    return ParseDoubleSlow(begin, end, value);
+
+  if (p != end && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    bool negativeExponent = false;
+    if (p != end && (*p == '-' || *p == '+'))
+      negativeExponent = (*p++ == '-');
+
+    if (p == end)
+      return false;
+
+    int explicitExponent = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      if (explicitExponent > 10000)
+        return ParseDoubleSlow(begin, end, value);
+      explicitExponent = 10 * explicitExponent + (*p - '0');
+    }
+
+    exponent += (negativeExponent ? -explicitExponent : explicitExponent);
+  }
+
+  if (p != end)
+    return false; // Trailing garbage.
+
+  if (mantissa > (uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+    return ParseDoubleSlow(begin, end, value);
+
+  value = (double) mantissa;
+  if (exponent < 0)
+    value /= powersOfTen[-exponent];
+  else
+    value *= powersOfTen[exponent];
+  if (negative)
+    value = -value;
+
+  return true;
+}
+
+/**
+ * Parse the values on the line [begin, end).  If column is not NULL, the first
+ * (at most) 'maxValues' values are written into it.  Returns the number of
+ * values on the line, or size_t(-1) if a value could not be parsed.
+ */
+template<typename eT>
+size_t ParseLine(const char* begin,
+                 const char* end,
+                 eT* column,
+                 const size_t maxValues)
+{
+  size_t values = 0;
+  const char* p = begin;
+  while (true)
+  {
+    while (p != end && IsSeparator(*p))
+      ++p;
+    if (p == end)
+      return values;
+
+    const char* tokenEnd = p;
+    while (tokenEnd != end && !IsSeparator(*tokenEnd))
+      ++tokenEnd;
+
+    if (column != NULL && values < maxValues)
+    {
+      double value;
+      if (!ParseDouble(p, tokenEnd, value))
+        return size_t(-1);
+      column[values] = eT(value);
+    }
+
+    ++values;
+    p = tokenEnd;
+  }
+}
+
+/**
+ * Parse the lines of the buffer, which start at the given offsets (followed by
+ * the size of the buffer), into the columns of the matrix; empty lines are
+ * skipped.  Returns false if the lines can't be parsed.
+ */
+template<typename eT>
+bool ParseLines(const char* buffer,
+                const std::vector<size_t>& lineStarts,
+                arma::Mat<eT>& matrix)
+{
+  // Step II: find the dimensionality from the first nonempty line, and the
+  // nonempty lines, which become the columns of the matrix.
+  size_t dimensionality = 0;
+  std::vector<size_t> lines; // Indices into lineStarts.
+  lines.reserve(lineStarts.size() - 1);
+  for (size_t i = 0; i + 1 < lineStarts.size(); ++i)
+  {
+    const char* lineBegin = buffer + lineStarts[i];
+    const char* lineEnd = buffer + lineStarts[i + 1];
+    if (lineEnd != lineBegin && *(lineEnd - 1) == '\n')
+      --lineEnd;
+
+    bool empty = true;
+    for (const char* p = lineBegin; p != lineEnd && empty; ++p)
+      if (!csv::IsSeparator(*p))
+        empty = false;
+
+    if (empty)
+      continue;
+
+    if (dimensionality == 0)
+      dimensionality = csv::ParseLine<eT>(lineBegin, lineEnd, NULL, 0);
+    lines.push_back(i);
+  }
+
+  bool success = (dimensionality > 0);
+
+  // Step III: parse every line directly into its column.
+  if (success)
+  {
+    matrix.set_size(dimensionality, lines.size());
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+      const char* lineBegin = buffer + lineStarts[lines[i]];
+      const char* lineEnd = buffer + lineStarts[lines[i] + 1];
+      if (lineEnd != lineBegin && *(lineEnd - 1) == '\n')
+        --lineEnd;
+
+      if (csv::ParseLine<eT>(lineBegin, lineEnd, matrix.colptr(i),
+          dimensionality) != dimensionality)
+      {
+        #pragma omp critical(load_csv_failure)
+        success = false;
+      }
+    }
+
+    if (!success)
+      matrix.reset();
+  }
+
+  return success;
+}
+
+} // namespace csv
+
+template<typename eT>
+bool LoadCSV(const std::string& filename, arma::Mat<eT>& matrix)
+{
+  // Get the contents of the file into memory; map it, if we can.
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  const size_t size = (size_t) fileStat.st_size;
+  void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    return false;
+
+  // The file is read front to back by each thread.
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  const char* buffer = (const char*) mapped;
+#else
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open())
+    return false;
+
+  std::vector<char> contents((std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+  const size_t size = contents.size();
+  if (size == 0)
+    return false;
+  const char* buffer = &contents[0];
+#endif
+
+  // Step I: find the start of every line.  The file is split into one region
+  // per thread, and each thread finds the lines that start in its region.
+  int numRegions = 1;
+#ifdef _OPENMP
+  numRegions = omp_get_max_threads();
+#endif
+  std::vector<std::vector<size_t> > regionLines(numRegions);
+  const size_t regionSize = (size_t) (size + numRegions - 1) / numRegions;
+
+  #pragma omp parallel for schedule(static)
+  for (int r = 0; r < numRegions; ++r)
+  {
+    const size_t regionBegin = std::min(size, r * regionSize);
+    const size_t regionEnd = std::min(size, regionBegin + regionSize);
+
+    // A line starts at the beginning of the file or after a newline.
+    if (regionBegin == 0 && size > 0)
+      regionLines[r].push_back(0);
+
+    const char* p = buffer + regionBegin;
+    const char* end = buffer + regionEnd;
+    while (p != end)
+    {
+      const char* newline = (const char*) memchr(p, '\n', end - p);
+      if (newline == NULL)
+        break;
+
+      if (newline + 1 != buffer + size)
+        regionLines[r].push_back(newline + 1 - buffer);
+      p = newline + 1;
+    }
+  }
+
+  std::vector<size_t> lineStarts;
+  for (int r = 0; r < numRegions; ++r)
+    lineStarts.insert(lineStarts.end(), regionLines[r].begin(),
+        regionLines[r].end());
+  lineStarts.push_back(size); // Sentinel: the end of the last line.
+
+  const bool success = csv::ParseLines(buffer, lineStarts, matrix);
+
+#ifndef _WIN32
+  munmap(mapped, size);
+#endif
+
+  return success;
+}
+
+template<typename eT>
+bool LoadCSV(DecompressingReader& reader,
+             arma::Mat<eT>& matrix,
+             std::string& contents)
+{
+  // Find the start of every line of each block while the next blocks are
+  // being decompressed.
+  contents.clear();
+  std::vector<size_t> lineStarts;
+  std::string block;
+  while (reader.NextBlock(block))
+  {
+    if (contents.empty())
+      lineStarts.push_back(0);
+
+    const size_t offset = contents.size();
+    contents.append(block);
+
+    const char* p = block.data();
+    const char* end = block.data() + block.size();
+    while (p != end)
+    {
+      const char* newline = (const char*) memchr(p, '\n', end - p);
+      if (newline == NULL)
+        break;
+
+      lineStarts.push_back(offset + (newline + 1 - block.data()));
+      p = newline + 1;
+    }
+  }
+
+  if (reader.Failed() || contents.empty())
+    return false;
+
+  // A newline at the very end doesn't start a line.
+  if (lineStarts.back() == contents.size())
+    lineStarts.pop_back();
+  lineStarts.push_back(contents.size()); // Sentinel: the end of the last line.
+
+  return csv::ParseLines(contents.data(), lineStarts, matrix);
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
@@ -9,8 +9,12 @@
 
 // In case it hasn't already been included.
 #include "load.hpp"
+#include "load_csv.hpp"
 
 #include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
 #include <mlpack/core/util/timers.hpp>
 
 namespace mlpack {
@@ -39,6 +43,100 @@ bool inline inplace_transpose(arma::Mat<eT>& X)
   }
 }
 
+/**
+ * Load a gzip or zstd compressed CSV or ASCII file.  The file is decompressed
+ * on a separate thread, pipelined with finding the lines of the decompressed
+ * data, and is never written to disk.
+ */
+template<typename eT>
+bool LoadCompressed(const std::string& filename,
+                    arma::Mat<eT>& matrix,
+                    bool fatal,
+                    bool transpose)
+{
+  // The type of the data is given by the extension before the compression
+  // extension.
+  const std::string uncompressedName =
+      DecompressingReader::UncompressedName(filename);
+  const size_t ext = uncompressedName.rfind('.');
+  std::string extension = (ext == std::string::npos) ? "" :
+      uncompressedName.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  std::string error;
+  std::string contents;
+  bool success = false;
+  if (extension != "csv" && extension != "txt")
+  {
+    error = "only compressed CSV and ASCII files can be loaded";
+  }
+  else
+  {
+    Log::Info << "Loading '" << filename << "' as compressed "
+        << ((extension == "csv") ? "CSV data" : "ASCII data") << ".  "
+        << std::flush;
+
+    DecompressingReader reader(filename);
+    if (!reader.IsOpen())
+    {
+      error = "cannot decompress file";
+    }
+    else if (transpose && LoadCSV(reader, matrix, contents))
+    {
+      success = true;
+    }
+    else
+    {
+      // Our parser didn't understand the file (or isn't used), so Armadillo
+      // gets to try, on the decompressed contents.
+      if (!transpose)
+      {
+        std::string block;
+        while (reader.NextBlock(block))
+          contents.append(block);
+      }
+
+      if (reader.Failed())
+      {
+        error = "file is corrupt";
+      }
+      else
+      {
+        std::istringstream stream(contents);
+        arma::file_type loadType = arma::csv_ascii;
+        if (contents.compare(0, 12, "ARMA_MAT_TXT") == 0)
+          loadType = arma::arma_ascii;
+        else if (extension == "txt")
+          loadType = arma::diskio::guess_file_type(stream);
+
+        success = matrix.load(stream, loadType);
+        if (success && transpose)
+          inplace_transpose(matrix);
+        else if (!success)
+          error = "file could not be parsed";
+      }
+    }
+  }
+
+  if (!success)
+  {
+    Log::Info << std::endl;
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed: " << error
+          << "." << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed: " << error
+          << "." << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
+      << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
+  return true;
+}
+
 template<typename eT>
 bool Load(const std::string& filename,
           arma::Mat<eT>& matrix,
@@ -47,6 +145,15 @@ bool Load(const std::string& filename,
 {
   Timer::Start("loading_data");
 
+  // Compressed files are decompressed while they are loaded.
+  if (DecompressingReader::FileCompression(filename) !=
+      DecompressingReader::NONE)
+  {
+    const bool success = LoadCompressed(filename, matrix, fatal, transpose);
+    Timer::Stop("loading_data");
+    return success;
+  }
+
   // First we will try to discriminate by file extension.
   size_t ext = filename.rfind('.');
   if (ext == std::string::npos)
@@ -224,6 +331,20 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
+  // CSV and raw ASCII files that will be transposed are parsed directly into
+  // the transposed layout, if possible.  If our parser doesn't understand the
+  // file, Armadillo gets to try.
+  if (transpose && (loadType == arma::csv_ascii || loadType == arma::raw_ascii))
+  {
+    if (LoadCSV(filename, matrix))
+    {
+      Log::Info << "Size is " << matrix.n_cols << " x " << matrix.n_rows
+          << ".\n";
+      Timer::Stop("loading_data");
+      return true;
+    }
+  }
+
   const bool success = matrix.load(stream, loadType);
 
   if (!success)
@@ -253,6 +374,233 @@ bool Load(const std::string& filename,
   return success;
 }
 
+/**
+ * Split a line of a CSV file at its commas, or a line of an ASCII file at its
+ * whitespace (and commas), into the [begin, end) offsets of its values.  The
+ * values of a CSV file are trimmed of whitespace and of surrounding double
+ * quotes, and may be empty.
+ */
+inline void SplitLine(const std::string& line,
+                      const bool commas,
+                      std::vector<std::pair<size_t, size_t> >& tokens)
+{
+  tokens.clear();
+
+  // An empty line has no values.
+  if (line.find_first_not_of(" \t\r,") == std::string::npos)
+    return;
+
+  size_t begin = 0;
+  while (begin <= line.size())
+  {
+    size_t end;
+    if (commas)
+    {
+      end = std::min(line.find(',', begin), line.size());
+    }
+    else
+    {
+      while (begin < line.size() && csv::IsSeparator(line[begin]))
+        ++begin;
+      if (begin == line.size())
+        break;
+
+      end = begin;
+      while (end < line.size() && !csv::IsSeparator(line[end]))
+        ++end;
+    }
+
+    size_t first = begin, last = end;
+    while (first < last && csv::IsSeparator(line[first]))
+      ++first;
+    while (last > first && csv::IsSeparator(line[last - 1]))
+      --last;
+    if (last - first >= 2 && line[first] == '"' && line[last - 1] == '"')
+    {
+      ++first;
+      --last;
+    }
+
+    tokens.push_back(std::make_pair(first, last));
+    begin = end + 1;
+  }
+}
+
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::Mat<eT>& matrix,
+          DatasetInfo& info,
+          bool fatal,
+          bool transpose)
+{
+  Timer::Start("loading_data");
+
+  // The type of a compressed file is given by the extension before the
+  // compression extension.
+  const bool compressed = (DecompressingReader::FileCompression(filename) !=
+      DecompressingReader::NONE);
+  const std::string uncompressedName =
+      DecompressingReader::UncompressedName(filename);
+  const size_t ext = uncompressedName.rfind('.');
+  std::string extension = (ext == std::string::npos) ? "" :
+      uncompressedName.substr(ext + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  std::ifstream file;
+  boost::scoped_ptr<DecompressingStreamBuf> decompressed;
+  std::istream stream(NULL);
+  std::string error;
+  if (extension != "csv" && extension != "txt")
+  {
+    error = "only CSV and ASCII files can have categorical dimensions";
+  }
+  else if (compressed)
+  {
+    decompressed.reset(new DecompressingStreamBuf(filename));
+    if (!decompressed->IsOpen())
+      error = "cannot decompress file";
+    stream.rdbuf(decompressed.get());
+  }
+  else
+  {
+    file.open(filename.c_str(), std::ios::in);
+    if (!file.is_open())
+      error = "cannot open file";
+    stream.rdbuf(file.rdbuf());
+  }
+
+  if (error.empty())
+    Log::Info << "Loading '" << filename << "' as "
+        << ((extension == "csv") ? "CSV" : "ASCII") << " data with "
+        << "categorical dimensions.  " << std::flush;
+
+  // Each line is parsed as it is read, so the file is read only once.  The
+  // values of each line become a column of the matrix; a value that is not a
+  // number is encoded with the dictionary of its dimension, which makes the
+  // dimension categorical.
+  std::vector<eT> values;
+  std::vector<std::pair<size_t, size_t> > tokens;
+  std::string line;
+  size_t dimensionality = 0;
+  size_t lineNumber = 0;
+  while (error.empty() && std::getline(stream, line))
+  {
+    ++lineNumber;
+    SplitLine(line, (extension == "csv"), tokens);
+    if (tokens.empty())
+      continue;
+
+    if (dimensionality == 0)
+    {
+      // The dictionaries of a DatasetInfo of the same dimensionality are kept,
+      // so that several files are encoded the same way.
+      dimensionality = tokens.size();
+      if (info.Dimensionality() != dimensionality)
+        info = DatasetInfo(dimensionality);
+    }
+
+    if (tokens.size() != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "line " << lineNumber << " has " << tokens.size() << " values "
+          << "instead of " << dimensionality;
+      error = oss.str();
+      break;
+    }
+
+    const size_t points = values.size() / dimensionality;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const char* begin = line.data() + tokens[d].first;
+      const char* end = line.data() + tokens[d].second;
+
+      double value;
+      if (info.Type(d) == numeric && begin != end &&
+          csv::ParseDouble(begin, end, value))
+      {
+        values.push_back(eT(value));
+        continue;
+      }
+
+      if (info.Type(d) == numeric && points > 0)
+      {
+        // This dimension turns out to be categorical, so the numbers seen
+        // before are encoded too, by their value.
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<eT>::digits10);
+        for (size_t p = 0; p < points; ++p)
+        {
+          eT& previous = values[p * dimensionality + d];
+          oss.str("");
+          oss << previous;
+          previous = eT(info.MapString(oss.str(), d));
+        }
+      }
+
+      values.push_back(eT(info.MapString(std::string(begin, end), d)));
+    }
+  }
+
+  if (error.empty() && compressed && decompressed->Failed())
+    error = "file is corrupt";
+  if (error.empty() && dimensionality == 0)
+    error = "file contains no data";
+
+  if (!error.empty())
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed: " << error
+          << "." << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed: " << error
+          << "." << std::endl;
+
+    return false;
+  }
+
+  matrix = arma::Mat<eT>(&values[0], dimensionality,
+      values.size() / dimensionality);
+  if (!transpose)
+    inplace_transpose(matrix);
+
+  size_t categoricalDimensions = 0;
+  for (size_t d = 0; d < dimensionality; ++d)
+    if (info.Type(d) == categorical)
+      ++categoricalDimensions;
+
+  Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
+      << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << "; "
+      << categoricalDimensions << " categorical dimension"
+      << ((categoricalDimensions == 1) ? "" : "s") << ".\n";
+
+  Timer::Stop("loading_data");
+  return true;
+}
+
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          bool fatal,
+          bool shared)
+{
+  Timer::Start("loading_data");
+
+  Log::Info << "Mapping '" << filename << "'" << (shared ? " (shared)" : "")
+      << ".  " << std::flush;
+  const bool success = matrix.Map(filename, shared, fatal);
+  if (success)
+    Log::Info << "Size is " << matrix.Matrix().n_rows << " x "
+        << matrix.Matrix().n_cols << ".\n";
+  else
+    Log::Info << std::endl;
+
+  Timer::Stop("loading_data");
+  return success;
+}
+
 }; // namespace data
 }; // namespace mlpack
 
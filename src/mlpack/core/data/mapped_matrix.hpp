@@ -0,0 +1,104 @@
+/**
+ * @file mapped_matrix.hpp
+ * @author Ryan Curtin
+ *
+ * A matrix whose elements are a memory mapping of an Armadillo binary or raw
+ * binary file, so that large datasets can be used without reading them into
+ * memory and can be shared by several processes.
+ */
+#ifndef __MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+#define __MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <string>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A matrix that is backed by a memory mapping of a binary file instead of
+ * memory of its own: the elements are the contents of the file, which are only
+ * read from disk when they are accessed, and the matrix is an Armadillo matrix
+ * that uses that memory directly (it is constructed with copy_aux_mem = false,
+ * so its size can't change).  This is the zero-copy mode of data::Load().
+ *
+ * Because nothing is copied, nothing is transposed either: the file must hold
+ * the matrix in the column-major layout that mlpack uses, which is what
+ * data::Save() writes when 'transpose' is false.  Armadillo binary files
+ * (arma_binary) give the size of the matrix in their header; raw binary files
+ * are loaded as a single column, like Armadillo does.
+ *
+ * If the mapping is shared, it is read-only: every process that maps the file
+ * uses the same pages of the page cache, and writing to the matrix is an
+ * error (a segmentation fault).  Otherwise, the mapping is private, and
+ * writing to an element copies its page for this process only; the file is
+ * never modified.
+ *
+ * @code
+ * data::MappedMatrix<double> references;
+ * data::Load("references.bin", references, true, true);
+ *
+ * AllkNN allknn(references.Matrix());
+ * @endcode
+ *
+ * Copies of a MappedMatrix share the mapping, which is removed when the last
+ * copy is destroyed.
+ *
+ * @tparam eT Type of the elements; this has to match the element type stored
+ *     in the header of an Armadillo binary file.
+ */
+template<typename eT>
+class MappedMatrix
+{
+ public:
+  //! Create an empty matrix that doesn't map anything.
+  MappedMatrix() : matrix(new arma::Mat<eT>()), shared(false) { }
+
+  //! Create a copy that shares the mapping of the given matrix.
+  MappedMatrix(const MappedMatrix& other);
+
+  //! Share the mapping of the given matrix.
+  MappedMatrix& operator=(const MappedMatrix& other);
+
+  /**
+   * Map the given file and make the matrix use its contents.  Any previous
+   * mapping is released (once no other copy uses it).  On failure, the
+   * matrix is empty and a message is printed.
+   *
+   * @param filename Name of the Armadillo binary or raw binary file.
+   * @param shared If true, map the file read-only and shared between
+   *     processes; otherwise the mapping is private (copy-on-write).
+   * @param fatal If an error should be reported as fatal.
+   * @return Whether or not the file was mapped successfully.
+   */
+  bool Map(const std::string& filename, const bool shared, const bool fatal);
+
+  //! Get the matrix.
+  const arma::Mat<eT>& Matrix() const { return *matrix; }
+  //! Modify the matrix (if the mapping isn't shared).
+  arma::Mat<eT>& Matrix() { return *matrix; }
+
+  //! Get whether the mapping is shared (and read-only).
+  bool Shared() const { return shared; }
+
+ private:
+  //! The owner of the mapping, which removes it when it is destroyed.
+  boost::shared_ptr<void> owner;
+
+  //! The matrix that uses the mapped memory.
+  boost::scoped_ptr<arma::Mat<eT> > matrix;
+
+  //! Whether the mapping is shared.
+  bool shared;
+};
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "mapped_matrix_impl.hpp"
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @file mapped_matrix_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the MappedMatrix class.
+ */
+#ifndef __MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+#define __MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "mapped_matrix.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+namespace mapped /** Helpers for memory-mapped matrices. */ {
+
+#ifndef _WIN32
+//! Remove a mapping of the given size when its owner is destroyed.
+class Unmapper
+{
+ public:
+  Unmapper(const size_t size) : size(size) { }
+
+  void operator()(void* mapped) const { munmap(mapped, size); }
+
+ private:
+  size_t size;
+};
+#endif
+
+//! Return the header Armadillo writes for binary files with elements of type
+//! eT, such as "ARMA_MAT_BIN_FN008" for doubles.
+template<typename eT>
+std::string BinaryHeader()
+{
+  char header[32];
+  sprintf(header, "ARMA_MAT_BIN_%s%03d",
+      !std::numeric_limits<eT>::is_integer ? "FN" :
+      (std::numeric_limits<eT>::is_signed ? "IS" : "IU"), (int) sizeof(eT));
+  return header;
+}
+
+} // namespace mapped
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(const MappedMatrix& other) :
+    shared(false)
+{
+  *this = other;
+}
+
+template<typename eT>
+MappedMatrix<eT>& MappedMatrix<eT>::operator=(const MappedMatrix& other)
+{
+  if (this == &other)
+    return *this;
+
+  // Without a mapping, the matrix owns its memory and has to be copied.
+  if (other.owner)
+    matrix.reset(new arma::Mat<eT>(const_cast<eT*>(other.matrix->memptr()),
+        other.matrix->n_rows, other.matrix->n_cols, false, true));
+  else
+    matrix.reset(new arma::Mat<eT>(*other.matrix));
+
+  owner = other.owner;
+  shared = other.shared;
+  return *this;
+}
+
+template<typename eT>
+bool MappedMatrix<eT>::Map(const std::string& filename,
+                           const bool shared,
+                           const bool fatal)
+{
+  // Release the previous mapping, if any.
+  matrix.reset(new arma::Mat<eT>());
+  owner.reset();
+  this->shared = false;
+
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    if (fatal)
+      Log::Fatal << "Cannot open file '" << filename << "'." << std::endl;
+    else
+      Log::Warn << "Cannot open file '" << filename << "'; load failed."
+          << std::endl;
+
+    return false;
+  }
+
+  struct stat fileStat;
+  void* mapped = MAP_FAILED;
+  size_t size = 0;
+  if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+  {
+    size = (size_t) fileStat.st_size;
+    mapped = shared ?
+        mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) :
+        mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+
+  if (mapped == MAP_FAILED)
+  {
+    if (fatal)
+      Log::Fatal << "Cannot map file '" << filename << "'." << std::endl;
+    else
+      Log::Warn << "Cannot map file '" << filename << "'; load failed."
+          << std::endl;
+
+    return false;
+  }
+
+  boost::shared_ptr<void> mapping(mapped, mapped::Unmapper(size));
+  const char* contents = (const char*) mapped;
+
+  // Armadillo binary files start with the element type and the size of the
+  // matrix; anything else is raw binary, which becomes a single column.
+  size_t offset = 0, rows = size / sizeof(eT), cols = 1;
+  const char armaHeader[] = "ARMA_MAT_BIN_";
+  if (size >= sizeof(armaHeader) - 1 &&
+      memcmp(contents, armaHeader, sizeof(armaHeader) - 1) == 0)
+  {
+    const std::string header = mapped::BinaryHeader<eT>();
+    const char* sizeLine = (const char*) memchr(contents, '\n', size);
+    const char* dataStart = (sizeLine == NULL) ? NULL :
+        (const char*) memchr(sizeLine + 1, '\n', size - (sizeLine + 1 -
+        contents));
+
+    if (dataStart == NULL || (size_t) (sizeLine - contents) != header.size() ||
+        memcmp(contents, header.data(), header.size()) != 0)
+    {
+      if (fatal)
+        Log::Fatal << "Cannot map '" << filename << "': the header does not "
+            << "match '" << header << "'." << std::endl;
+      else
+        Log::Warn << "Cannot map '" << filename << "': the header does not "
+            << "match '" << header << "'; load failed." << std::endl;
+
+      return false;
+    }
+
+    const std::string sizeText(sizeLine + 1, dataStart);
+    char* end;
+    rows = strtoul(sizeText.c_str(), &end, 10);
+    cols = strtoul(end, NULL, 10);
+    offset = dataStart + 1 - contents;
+  }
+  else if (size % sizeof(eT) != 0)
+  {
+    Log::Warn << "The size of raw binary file '" << filename << "' is not a "
+        << "multiple of the element size." << std::endl;
+  }
+
+  if (size - offset < rows * cols * sizeof(eT))
+  {
+    if (fatal)
+      Log::Fatal << "Cannot map '" << filename << "': the file is truncated."
+          << std::endl;
+    else
+      Log::Warn << "Cannot map '" << filename << "': the file is truncated; "
+          << "load failed." << std::endl;
+
+    return false;
+  }
+
+  // The header of an Armadillo binary file usually leaves the elements
+  // misaligned.  That is fine on x86, where Armadillo checks the alignment
+  // before using aligned instructions; elsewhere they have to be copied.
+#if !defined(__i386__) && !defined(__x86_64__)
+  if (offset % sizeof(eT) != 0)
+  {
+    Log::Warn << "The elements of '" << filename << "' are not aligned; "
+        << "copying them instead of mapping them." << std::endl;
+    matrix->set_size(rows, cols);
+    memcpy(matrix->memptr(), contents + offset, rows * cols * sizeof(eT));
+    return true;
+  }
+#endif
+
+  matrix.reset(new arma::Mat<eT>((eT*) (contents + offset), rows, cols,
+      false, true));
+  owner = mapping;
+  this->shared = shared;
+  return true;
+#else
+  // There is no mapping; the file is read instead.
+  (void) shared;
+  return Load(filename, *matrix, fatal, false);
+#endif
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
@@ -11,6 +11,8 @@
 // In case it hasn't been included yet.
 #include "normalize_labels.hpp"
 
+#include <unordered_map>
+
 namespace mlpack {
 namespace data {
 
@@ -31,31 +33,25 @@ void NormalizeLabels(const arma::Col<eT>& labelsIn,
 {
   // Loop over the input labels, and develop the mapping.  We'll first naively
   // resize the mapping to the maximum possible size, and then when we fill it,
-  // we'll resize it back down to its actual size.
+  // we'll resize it back down to its actual size.  The labels seen so far are
+  // kept in a hash table, so that each label is found in constant time no
+  // matter how many classes there are.
   mapping.set_size(labelsIn.n_elem);
   labels.set_size(labelsIn.n_elem);
+  std::unordered_map<eT, size_t> labelIndices;
   size_t curLabel = 0;
   for (size_t i = 0; i < labelsIn.n_elem; ++i)
   {
-    bool found = false;
-    for (size_t j = 0; j < curLabel; ++j)
-    {
-      // Is the label already in the list of labels we have seen?
-      if (labelsIn[i] == mapping[j])
-      {
-        labels[i] = j;
-        found = true;
-        break;
-      }
-    }
-
-    // Do we need to add this new label?
-    if (!found)
+    // Add the label if we haven't seen it yet.
+    const std::pair<typename std::unordered_map<eT, size_t>::iterator, bool>
+        result = labelIndices.insert(std::make_pair(labelsIn[i], curLabel));
+    if (result.second)
     {
       mapping[curLabel] = labelsIn[i];
-      labels[i] = curLabel;
       ++curLabel;
     }
+
+    labels[i] = result.first->second;
   }
 
   // Resize mapping back down to necessary size.
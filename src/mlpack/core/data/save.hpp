@@ -11,6 +11,8 @@
 
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <future>
+#include <memory>
 #include <string>
 
 namespace mlpack {
@@ -39,6 +41,12 @@ namespace data /** Functions to load and save matrices. */ {
  * in a column-major format and most datasets are stored on disk as row-major,
  * this parameter should be left at its default value of 'true'.
  *
+ * No transposed copy of the matrix is made for CSV, ASCII, or Armadillo binary
+ * files: text files are formatted in parallel directly from the matrix, and
+ * binary files are written a block of rows at a time.  With 'transpose' set to
+ * false, a binary file holds the column-major matrix exactly as it is in
+ * memory.
+ *
  * @param filename Name of file to save to.
  * @param matrix Matrix to save into file.
  * @param fatal If an error should be reported as fatal (default false).
@@ -51,6 +59,39 @@ bool Save(const std::string& filename,
           bool fatal = false,
           bool transpose = true);
 
+/**
+ * Save a matrix to file in the background, so that the next stage of a
+ * computation can run while the file is written.  This behaves like
+ * data::Save(), except that the "saving_data" timer is not used.  The returned
+ * future holds the result of the save; if 'fatal' is true and the save fails,
+ * the exception is thrown by its get() method.
+ *
+ * The matrix is not copied, so it must not be modified or destroyed until the
+ * save has finished.  To hand the matrix over instead, pass it with
+ * std::move().
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save into file.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If true, transpose the matrix before saving.
+ * @return Future holding whether or not the save succeeded.
+ */
+template<typename eT>
+std::future<bool> SaveAsync(const std::string& filename,
+                            const arma::Mat<eT>& matrix,
+                            bool fatal = false,
+                            bool transpose = true);
+
+/**
+ * Save a matrix to file in the background, taking ownership of the matrix
+ * until the save has finished.  See the other overload for details.
+ */
+template<typename eT>
+std::future<bool> SaveAsync(const std::string& filename,
+                            arma::Mat<eT>&& matrix,
+                            bool fatal = false,
+                            bool transpose = true);
+
 }; // namespace data
 }; // namespace mlpack
 
@@ -0,0 +1,48 @@
+/**
+ * @file save_csv.hpp
+ * @author Ryan Curtin
+ *
+ * A fast, parallel formatter for CSV and whitespace-separated ASCII files, used
+ * by data::Save() to write such files without first transposing the matrix.
+ */
+#ifndef __MLPACK_CORE_DATA_SAVE_CSV_HPP
+#define __MLPACK_CORE_DATA_SAVE_CSV_HPP
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/arma_extend/arma_extend.hpp> // Includes Armadillo.
+#include <string>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Save the given matrix to a CSV or whitespace-separated ASCII file.  If
+ * 'transpose' is true, each column of the matrix becomes one line of the file,
+ * which gives the same file as transposing the matrix and saving it with
+ * Armadillo, but without the transposed copy.  The lines are formatted in
+ * blocks, in parallel (with OpenMP), and the blocks are written to the file in
+ * order.
+ *
+ * Floating-point values are written with enough digits to be read back
+ * exactly.  Nothing is printed on failure, so that the caller can report the
+ * error the way it wants to.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save into file.
+ * @param separator Character to put between the values of a line.
+ * @param transpose If true, write each column of the matrix as a line.
+ * @return Whether or not the file was written successfully.
+ */
+template<typename eT>
+bool SaveCSV(const std::string& filename,
+             const arma::Mat<eT>& matrix,
+             const char separator,
+             const bool transpose);
+
+}; // namespace data
+}; // namespace mlpack
+
+// Include implementation.
+#include "save_csv_impl.hpp"
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * @file save_csv_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the fast CSV/ASCII formatter.
+ */
+#ifndef __MLPACK_CORE_DATA_SAVE_CSV_IMPL_HPP
+#define __MLPACK_CORE_DATA_SAVE_CSV_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "save_csv.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <boost/utility/enable_if.hpp>
+
+namespace mlpack {
+namespace data {
+namespace csv {
+
+//! Append a floating-point value, with enough digits to read it back exactly.
+template<typename eT>
+inline void AppendValue(
+    std::string& buffer,
+    const eT value,
+    const typename boost::enable_if_c<
+        std::numeric_limits<eT>::is_specialized &&
+        !std::numeric_limits<eT>::is_integer>::type* = 0)
+{
+  char text[64];
+  const int length = std::snprintf(text, sizeof(text), "%.*Lg",
+      (int) std::numeric_limits<eT>::max_digits10, (long double) value);
+  buffer.append(text, length);
+}
+
+//! Append an integer value.
+template<typename eT>
+inline void AppendValue(
+    std::string& buffer,
+    const eT value,
+    const typename boost::enable_if_c<
+        std::numeric_limits<eT>::is_integer>::type* = 0)
+{
+  char text[32];
+  const int length = std::numeric_limits<eT>::is_signed ?
+      std::snprintf(text, sizeof(text), "%lld", (long long) value) :
+      std::snprintf(text, sizeof(text), "%llu", (unsigned long long) value);
+  buffer.append(text, length);
+}
+
+//! Append any other value (such as a complex number) with its stream operator.
+template<typename eT>
+inline void AppendValue(
+    std::string& buffer,
+    const eT& value,
+    const typename boost::disable_if_c<
+        std::numeric_limits<eT>::is_specialized>::type* = 0)
+{
+  std::ostringstream oss;
+  oss.precision(std::numeric_limits<typename arma::get_pod_type<eT>::result>::
+      max_digits10);
+  oss << value;
+  buffer += oss.str();
+}
+
+}; // namespace csv
+
+template<typename eT>
+bool SaveCSV(const std::string& filename,
+             const arma::Mat<eT>& matrix,
+             const char separator,
+             const bool transpose)
+{
+  std::FILE* file = std::fopen(filename.c_str(), "wb");
+  if (file == NULL)
+    return false;
+
+  const size_t numLines = transpose ? matrix.n_cols : matrix.n_rows;
+  const size_t lineLength = transpose ? matrix.n_rows : matrix.n_cols;
+
+  // Each block holds roughly the same number of values, so that no thread
+  // waits long for a block with very long lines.
+  const size_t linesPerBlock = std::max((size_t) 1,
+      (size_t) 65536 / std::max(lineLength, (size_t) 1));
+  const size_t numBlocks = (numLines + linesPerBlock - 1) / linesPerBlock;
+
+  // The blocks are formatted in parallel, but written in order; a thread that
+  // is done with its block waits until the blocks before it are written, so
+  // only a few blocks are held in memory at once.
+  bool success = true;
+  #pragma omp parallel for ordered schedule(dynamic, 1)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * linesPerBlock;
+    const size_t end = std::min(numLines, begin + linesPerBlock);
+
+    std::string buffer;
+    for (size_t i = begin; i < end; ++i)
+    {
+      for (size_t j = 0; j < lineLength; ++j)
+      {
+        if (j > 0)
+          buffer += separator;
+        csv::AppendValue(buffer, transpose ? matrix(j, i) : matrix(i, j));
+      }
+      buffer += '\n';
+    }
+
+    #pragma omp ordered
+    {
+      if (success && std::fwrite(buffer.data(), 1, buffer.size(), file) !=
+          buffer.size())
+        success = false;
+    }
+  }
+
+  if (std::fclose(file) != 0)
+    success = false;
+
+  return success;
+}
+
+}; // namespace data
+}; // namespace mlpack
+
+#endif
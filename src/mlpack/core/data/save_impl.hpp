@@ -9,23 +9,59 @@
 
 // In case it hasn't already been included.
 #include "save.hpp"
+#include "save_csv.hpp"
+
+#include <algorithm>
 
 namespace mlpack {
 namespace data {
 
+/**
+ * Write the transpose of the given matrix to the stream in Armadillo's binary
+ * format, without making a transposed copy.  Row d of the matrix is column d
+ * of its transpose, so the rows are written one after another; they are
+ * gathered a block at a time, reading the matrix in column order.
+ */
 template<typename eT>
-bool Save(const std::string& filename,
-          const arma::Mat<eT>& matrix,
-          bool fatal,
-          bool transpose)
+bool SaveTransposedBinary(std::ostream& stream, const arma::Mat<eT>& matrix)
 {
-  Timer::Start("saving_data");
+  stream << arma::diskio::gen_bin_header(arma::Mat<eT>()) << '\n';
+  stream << matrix.n_cols << ' ' << matrix.n_rows << '\n';
 
+  // Hold about a megabyte of the transpose at a time.
+  const size_t blockRows = std::max((size_t) 1, (size_t) (1 << 20) /
+      (sizeof(eT) * std::max((size_t) matrix.n_cols, (size_t) 1)));
+  arma::Mat<eT> block(matrix.n_cols, std::min(blockRows,
+      (size_t) matrix.n_rows));
+
+  for (size_t begin = 0; begin < matrix.n_rows; begin += blockRows)
+  {
+    const size_t rows = std::min(blockRows, matrix.n_rows - begin);
+    for (size_t c = 0; c < matrix.n_cols; ++c)
+      for (size_t r = 0; r < rows; ++r)
+        block(c, r) = matrix(begin + r, c);
+
+    stream.write(reinterpret_cast<const char*>(block.memptr()),
+        std::streamsize(sizeof(eT) * matrix.n_cols * rows));
+  }
+
+  return stream.good();
+}
+
+/**
+ * Save the matrix as data::Save() does, but without touching the timers, so
+ * that it can be called from any thread.
+ */
+template<typename eT>
+bool SaveMatrix(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                bool fatal,
+                bool transpose)
+{
   // First we will try to discriminate by file extension.
   size_t ext = filename.rfind('.');
   if (ext == std::string::npos)
   {
-    Timer::Stop("saving_data");
     if (fatal)
       Log::Fatal << "No extension given with filename '" << filename << "'; "
           << "type unknown.  Save failed." << std::endl;
@@ -41,11 +77,10 @@ bool Save(const std::string& filename,
 
   // Catch errors opening the file.
   std::fstream stream;
-  stream.open(filename.c_str(), std::fstream::out);
+  stream.open(filename.c_str(), std::fstream::out | std::fstream::binary);
 
   if (!stream.is_open())
   {
-    Timer::Stop("saving_data");
     if (fatal)
       Log::Fatal << "Cannot open file '" << filename << "' for writing. "
           << "Save failed." << std::endl;
@@ -87,7 +122,6 @@ bool Save(const std::string& filename,
     saveType = arma::hdf5_binary;
     stringType = "HDF5 data";
 #else
-    Timer::Stop("saving_data");
     if (fatal)
       Log::Fatal << "Attempted to save HDF5 data to '" << filename << "', but "
           << "Armadillo was compiled without HDF5 support.  Save failed."
@@ -110,7 +144,6 @@ bool Save(const std::string& filename,
   // Provide error if we don't know the type.
   if (unknownType)
   {
-    Timer::Stop("saving_data");
     if (fatal)
       Log::Fatal << "Unable to determine format to save to from filename '"
           << filename << "'.  Save failed." << std::endl;
@@ -125,42 +158,90 @@ bool Save(const std::string& filename,
   Log::Info << "Saving " << stringType << " to '" << filename << "'."
       << std::endl;
 
-  // Transpose the matrix.
-  if (transpose)
+  // CSV and raw ASCII files are written by our own parallel formatter, and
+  // transposed binary files are written without a transposed copy.  Anything
+  // else is transposed (if needed) and handed to Armadillo.
+  bool success;
+  if (saveType == arma::csv_ascii || saveType == arma::raw_ascii)
+  {
+    stream.close();
+    success = SaveCSV(filename, matrix, (saveType == arma::csv_ascii) ? ','
+        : ' ', transpose);
+  }
+  else if (saveType == arma::arma_binary && transpose)
+  {
+    success = SaveTransposedBinary(stream, matrix);
+  }
+  else if (transpose)
   {
     arma::Mat<eT> tmp = trans(matrix);
-
-    if (!tmp.quiet_save(stream, saveType))
-    {
-      Timer::Stop("saving_data");
-      if (fatal)
-        Log::Fatal << "Save to '" << filename << "' failed." << std::endl;
-      else
-        Log::Warn << "Save to '" << filename << "' failed." << std::endl;
-
-      return false;
-    }
+    success = tmp.quiet_save(stream, saveType);
   }
   else
   {
-    if (!matrix.quiet_save(stream, saveType))
-    {
-      Timer::Stop("saving_data");
-      if (fatal)
-        Log::Fatal << "Save to '" << filename << "' failed." << std::endl;
-      else
-        Log::Warn << "Save to '" << filename << "' failed." << std::endl;
-
-      return false;
-    }
+    success = matrix.quiet_save(stream, saveType);
   }
 
-  Timer::Stop("saving_data");
+  if (!success)
+  {
+    if (fatal)
+      Log::Fatal << "Save to '" << filename << "' failed." << std::endl;
+    else
+      Log::Warn << "Save to '" << filename << "' failed." << std::endl;
+
+    return false;
+  }
 
   // Finally return success.
   return true;
 }
 
+template<typename eT>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          bool fatal,
+          bool transpose)
+{
+  Timer::Start("saving_data");
+
+  bool success;
+  try
+  {
+    success = SaveMatrix(filename, matrix, fatal, transpose);
+  }
+  catch (...)
+  {
+    Timer::Stop("saving_data");
+    throw;
+  }
+
+  Timer::Stop("saving_data");
+  return success;
+}
+
+template<typename eT>
+std::future<bool> SaveAsync(const std::string& filename,
+                            const arma::Mat<eT>& matrix,
+                            bool fatal,
+                            bool transpose)
+{
+  return std::async(std::launch::async, &SaveMatrix<eT>, filename,
+      std::cref(matrix), fatal, transpose);
+}
+
+template<typename eT>
+std::future<bool> SaveAsync(const std::string& filename,
+                            arma::Mat<eT>&& matrix,
+                            bool fatal,
+                            bool transpose)
+{
+  // The task owns the matrix until it is done with it.
+  std::shared_ptr<arma::Mat<eT> > owned =
+      std::make_shared<arma::Mat<eT> >(std::move(matrix));
+  return std::async(std::launch::async, [filename, owned, fatal, transpose]()
+      { return SaveMatrix(filename, *owned, fatal, transpose); });
+}
+
 }; // namespace data
 }; // namespace mlpack
 
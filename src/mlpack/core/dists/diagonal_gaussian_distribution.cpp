@@ -0,0 +1,184 @@
+/**
+ * @file diagonal_gaussian_distribution.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the DiagonalGaussianDistribution class.
+ */
+#include "diagonal_gaussian_distribution.hpp"
+
+using namespace mlpack;
+using namespace mlpack::distribution;
+
+DiagonalGaussianDistribution::DiagonalGaussianDistribution(
+    const arma::vec& mean,
+    const arma::vec& covariance) :
+    mean(mean)
+{
+  Covariance(covariance);
+}
+
+void DiagonalGaussianDistribution::Covariance(const arma::vec& covariance)
+{
+  this->covariance = covariance;
+  InvertCovariance();
+}
+
+void DiagonalGaussianDistribution::Covariance(arma::vec&& covariance)
+{
+  this->covariance = std::move(covariance);
+  InvertCovariance();
+}
+
+bool DiagonalGaussianDistribution::ClampVariances(const double minVariance)
+{
+  bool changed = false;
+  for (size_t d = 0; d < covariance.n_elem; ++d)
+  {
+    if (covariance[d] < minVariance)
+    {
+      covariance[d] = minVariance;
+      changed = true;
+    }
+  }
+
+  if (changed)
+  {
+    Log::Debug << "DiagonalGaussianDistribution: variances are not positive. "
+        << "Clamping them to " << minVariance << "." << std::endl;
+    InvertCovariance();
+  }
+
+  return changed;
+}
+
+void DiagonalGaussianDistribution::InvertCovariance()
+{
+  invCov = 1.0 / covariance;
+  logDetCov = arma::accu(arma::log(covariance));
+}
+
+double DiagonalGaussianDistribution::LogProbability(
+    const arma::vec& observation) const
+{
+  const arma::vec diff = observation - mean;
+  return -0.5 * observation.n_elem * log2pi - 0.5 * logDetCov -
+      0.5 * arma::dot(diff % diff, invCov);
+}
+
+arma::vec DiagonalGaussianDistribution::Random() const
+{
+  return arma::sqrt(covariance) % arma::randn<arma::vec>(mean.n_elem) + mean;
+}
+
+/**
+ * Estimate the Gaussian distribution directly from the given observations.
+ *
+ * @param observations List of observations.
+ */
+void DiagonalGaussianDistribution::Estimate(const arma::mat& observations)
+{
+  if (observations.n_cols == 0)
+  {
+    // This will end up just being empty, like GaussianDistribution.
+    mean.zeros(0);
+    covariance.zeros(0);
+    InvertCovariance();
+    return;
+  }
+
+  mean = arma::mean(observations, 1);
+  covariance = (observations.n_cols > 1) ?
+      arma::vec(arma::var(observations, 0, 1)) :
+      arma::vec(arma::zeros<arma::vec>(observations.n_rows));
+
+  InvertCovariance();
+  ClampVariances();
+}
+
+/**
+ * Estimate the Gaussian distribution from the given observations, taking into
+ * account the probability of each observation actually being from this
+ * distribution.
+ */
+void DiagonalGaussianDistribution::Estimate(const arma::mat& observations,
+                                            const arma::vec& probabilities)
+{
+  if (observations.n_cols == 0)
+  {
+    mean.zeros(0);
+    covariance.zeros(0);
+    InvertCovariance();
+    return;
+  }
+
+  mean.zeros(observations.n_rows);
+  covariance.zeros(observations.n_rows);
+
+  const double sumProb = arma::accu(probabilities);
+  if (sumProb == 0)
+  {
+    // Nothing in this Gaussian!  At least set the variances so that they're
+    // invertible.
+    covariance.fill(1e-50);
+    InvertCovariance();
+    return;
+  }
+
+  // Find the weighted mean, and then the weighted variances around it.  The
+  // variances are normalized by the sum of the probabilities, like the weighted
+  // covariance of GaussianDistribution.
+  mean = (observations * probabilities) / sumProb;
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    if (probabilities[i] == 0.0)
+      continue;
+
+    const double* point = observations.colptr(i);
+    for (size_t d = 0; d < observations.n_rows; ++d)
+    {
+      const double diff = point[d] - mean[d];
+      covariance[d] += probabilities[i] * diff * diff;
+    }
+  }
+  covariance /= sumProb;
+
+  InvertCovariance();
+  ClampVariances();
+}
+
+/**
+ * Returns a string representation of this object.
+ */
+std::string DiagonalGaussianDistribution::ToString() const
+{
+  std::ostringstream convert;
+  convert << "DiagonalGaussianDistribution [" << this << "]" << std::endl;
+
+  // Secondary ostringstream so things can be indented right.
+  std::ostringstream data;
+  data << "Mean: " << std::endl << mean;
+  data << "Variances: " << std::endl << covariance;
+
+  convert << util::Indent(data.str());
+  return convert.str();
+}
+
+/**
+ * Save to SaveRestoreUtility.
+ */
+void DiagonalGaussianDistribution::Save(util::SaveRestoreUtility& sr) const
+{
+  sr.SaveParameter(Type(), "type");
+  sr.SaveParameter(mean, "mean");
+  sr.SaveParameter(covariance, "covariance");
+}
+
+/**
+ * Load from SaveRestoreUtility.
+ */
+void DiagonalGaussianDistribution::Load(const util::SaveRestoreUtility& sr)
+{
+  sr.LoadParameter(mean, "mean");
+  sr.LoadParameter(covariance, "covariance");
+  InvertCovariance();
+}
@@ -0,0 +1,221 @@
+/**
+ * @file diagonal_gaussian_distribution.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of a Gaussian distribution with a diagonal covariance.
+ */
+#ifndef __MLPACK_CORE_DISTRIBUTIONS_DIAGONAL_GAUSSIAN_DISTRIBUTION_HPP
+#define __MLPACK_CORE_DISTRIBUTIONS_DIAGONAL_GAUSSIAN_DISTRIBUTION_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace distribution {
+
+/**
+ * A multivariate Gaussian distribution with a diagonal covariance, which is
+ * stored as the vector of the variances of each dimension.  This is the same
+ * model as a GaussianDistribution whose covariance is diagonal, but it only
+ * stores d variances instead of d x d covariances, and evaluating the density
+ * of a point takes O(d) time instead of a triangular solve.
+ */
+class DiagonalGaussianDistribution
+{
+ private:
+  //! Mean of the distribution.
+  arma::vec mean;
+  //! Variances of each dimension of the distribution (all positive).
+  arma::vec covariance;
+  //! Cached inverses of the variances.  This, and logDetCov, are recomputed
+  //! whenever the covariance is changed, and never otherwise, like the cached
+  //! factor of GaussianDistribution.
+  arma::vec invCov;
+  //! Cached logdet(cov).
+  double logDetCov;
+
+  //! log(2pi)
+  static const constexpr double log2pi = 1.83787706640934533908193770912475883;
+
+ public:
+  /**
+   * Default constructor, which creates a Gaussian with zero dimension.
+   */
+  DiagonalGaussianDistribution() { /* nothing to do */ }
+
+  /**
+   * Create a Gaussian distribution with zero mean and identity covariance with
+   * the given dimensionality.
+   */
+  DiagonalGaussianDistribution(const size_t dimension) :
+      mean(arma::zeros<arma::vec>(dimension)),
+      covariance(arma::ones<arma::vec>(dimension)),
+      invCov(arma::ones<arma::vec>(dimension)),
+      logDetCov(0)
+  { /* Nothing to do. */ }
+
+  /**
+   * Create a Gaussian distribution with the given mean and variances.
+   *
+   * The variances are expected to be positive.
+   */
+  DiagonalGaussianDistribution(const arma::vec& mean,
+                               const arma::vec& covariance);
+
+  //! Return the dimensionality of this distribution.
+  size_t Dimensionality() const { return mean.n_elem; }
+
+  /**
+   * Return the probability of the given observation.
+   */
+  double Probability(const arma::vec& observation) const
+  {
+    return exp(LogProbability(observation));
+  }
+
+  /**
+   * Return the log probability of the given observation.
+   */
+  double LogProbability(const arma::vec& observation) const;
+
+  /**
+   * Calculates the probability density function for each data point (column)
+   * in the given matrix.
+   *
+   * @param x List of observations.
+   * @param probabilities Output probabilities for each input observation.
+   */
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(x, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Calculates the log probability density function for each data point
+   * (column) in the given matrix, using the cached inverse variances and
+   * log-determinant.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
+  /**
+   * Return a randomly generated observation according to the probability
+   * distribution defined by this object.
+   *
+   * @return Random observation from this Gaussian distribution.
+   */
+  arma::vec Random() const;
+
+  /**
+   * Estimate the Gaussian distribution directly from the given observations.
+   * The variances are normalized with (1 / (n - 1)), like the covariance of
+   * GaussianDistribution::Estimate().
+   *
+   * @param observations List of observations.
+   */
+  void Estimate(const arma::mat& observations);
+
+  /**
+   * Estimate the Gaussian distribution from the given observations, taking into
+   * account the probability of each observation actually being from this
+   * distribution.
+   */
+  void Estimate(const arma::mat& observations,
+                const arma::vec& probabilities);
+
+  /**
+   * Return the mean.
+   */
+  const arma::vec& Mean() const { return mean; }
+
+  /**
+   * Return a modifiable copy of the mean.
+   */
+  arma::vec& Mean() { return mean; }
+
+  /**
+   * Return the variances of each dimension (the diagonal of the covariance).
+   */
+  const arma::vec& Covariance() const { return covariance; }
+
+  /**
+   * Set the variances of each dimension.
+   */
+  void Covariance(const arma::vec& covariance);
+
+  void Covariance(arma::vec&& covariance);
+
+  /**
+   * Make sure every variance is at least the given minimum, so that the
+   * density can be evaluated; this returns whether anything was changed.
+   *
+   * @param minVariance Smallest allowed variance.
+   */
+  bool ClampVariances(const double minVariance = 1e-50);
+
+  //! Return the number of bytes used by this distribution.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(mean) - sizeof(covariance) -
+        sizeof(invCov) + util::MemoryUsage(mean) +
+        util::MemoryUsage(covariance) + util::MemoryUsage(invCov);
+  }
+
+  /**
+   * Returns a string representation of this object.
+   */
+  std::string ToString() const;
+
+  /*
+   * Save to or Load from SaveRestoreUtility
+   */
+  void Save(util::SaveRestoreUtility& n) const;
+  void Load(const util::SaveRestoreUtility& n);
+  static std::string const Type() { return "DiagonalGaussianDistribution"; }
+
+ private:
+  /**
+   * Recompute the cached inverse variances and log-determinant from the
+   * current variances.  This must be called every time they change.
+   */
+  void InvertCovariance();
+};
+
+/**
+ * Calculates the log probability density function for each data point (column)
+ * in the given matrix.
+ *
+ * @param x List of observations.
+ * @param logProbabilities Output log probabilities for each input observation.
+ */
+inline void DiagonalGaussianDistribution::LogProbability(
+    const arma::mat& x,
+    arma::vec& logProbabilities) const
+{
+  const double logNormalizer = -0.5 * x.n_rows * log2pi - 0.5 * logDetCov;
+
+  // The exponent of each point is a weighted sum over its dimensions, so the
+  // points are handled one at a time without any temporary matrix.
+  logProbabilities.set_size(x.n_cols);
+  for (size_t i = 0; i < x.n_cols; ++i)
+  {
+    const double* point = x.colptr(i);
+    double exponent = 0.0;
+    for (size_t d = 0; d < x.n_rows; ++d)
+    {
+      const double diff = point[d] - mean[d];
+      exponent += diff * diff * invCov[d];
+    }
+
+    logProbabilities[i] = logNormalizer - 0.5 * exponent;
+  }
+}
+
+}; // namespace distribution
+}; // namespace mlpack
+
+#endif
@@ -9,6 +9,102 @@
 using namespace mlpack;
 using namespace mlpack::distribution;
 
+/**
+ * Calculate the probability of each observation in the given matrix.
+ */
+void DiscreteDistribution::Probability(
+    const arma::mat& x,
+    arma::vec& observationProbabilities) const
+{
+  observationProbabilities.set_size(x.n_cols);
+  for (size_t i = 0; i < x.n_cols; i++)
+  {
+    // Adding 0.5 helps ensure that we cast the floating point to a size_t
+    // correctly.
+    const size_t obs = size_t(x(0, i) + 0.5);
+    if (obs >= probabilities.n_elem)
+    {
+      Log::Debug << "DiscreteDistribution::Probability(): received observation "
+          << obs << "; observation must be in [0, " << probabilities.n_elem
+          << "] for this distribution." << std::endl;
+    }
+
+    observationProbabilities[i] = probabilities(obs);
+  }
+}
+
+/**
+ * Calculate the log probability of each observation in the given matrix.
+ */
+void DiscreteDistribution::LogProbability(const arma::mat& x,
+                                          arma::vec& logProbabilities) const
+{
+  const arma::vec logTable = arma::log(probabilities);
+
+  logProbabilities.set_size(x.n_cols);
+  for (size_t i = 0; i < x.n_cols; i++)
+  {
+    const size_t obs = size_t(x(0, i) + 0.5);
+    if (obs >= probabilities.n_elem)
+    {
+      Log::Debug << "DiscreteDistribution::LogProbability(): received "
+          << "observation " << obs << "; observation must be in [0, "
+          << probabilities.n_elem << "] for this distribution." << std::endl;
+    }
+
+    logProbabilities[i] = logTable(obs);
+  }
+}
+
+/**
+ * Calculate the log probability of each observation in the given matrix under
+ * each of the given distributions, with a lookup table.
+ */
+void DiscreteDistribution::LogProbability(
+    const std::vector<DiscreteDistribution>& dists,
+    const arma::mat& x,
+    arma::mat& logProbabilities)
+{
+  // Column o of the table holds the log probability of symbol o in every
+  // distribution, so each observation is a copy of one column.
+  size_t symbols = 0;
+  for (size_t s = 0; s < dists.size(); ++s)
+    symbols = std::max(symbols, (size_t) dists[s].Probabilities().n_elem);
+
+  arma::mat logTable(dists.size(), symbols);
+  logTable.fill(-std::numeric_limits<double>::infinity());
+  for (size_t s = 0; s < dists.size(); ++s)
+    for (size_t o = 0; o < dists[s].Probabilities().n_elem; ++o)
+      logTable(s, o) = std::log(dists[s].Probabilities()[o]);
+
+  logProbabilities.set_size(dists.size(), x.n_cols);
+  size_t outOfBounds = 0;
+
+  #pragma omp parallel for schedule(static) reduction(+:outOfBounds)
+  for (size_t i = 0; i < x.n_cols; i++)
+  {
+    const size_t obs = size_t(x(0, i) + 0.5);
+    double* column = logProbabilities.colptr(i);
+    if (obs >= symbols)
+    {
+      std::fill(column, column + dists.size(),
+          -std::numeric_limits<double>::infinity());
+      ++outOfBounds;
+      continue;
+    }
+
+    std::copy(logTable.colptr(obs), logTable.colptr(obs) + dists.size(),
+        column);
+  }
+
+  if (outOfBounds > 0)
+  {
+    Log::Debug << "DiscreteDistribution::LogProbability(): received "
+        << outOfBounds << " observation(s) outside of [0, " << symbols
+        << "]." << std::endl;
+  }
+}
+
 /**
  * Return a randomly generated observation according to the probability
  * distribution defined by this object.
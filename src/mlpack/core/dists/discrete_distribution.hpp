@@ -118,6 +118,46 @@ class DiscreteDistribution
     return log(Probability(observation));
   }
 
+  /**
+   * Calculate the probability of each observation (column) in the given
+   * matrix.  Bounds checking is not performed, as in Probability().
+   *
+   * @param x List of observations.
+   * @param observationProbabilities Output probabilities for each input
+   *     observation.
+   */
+  void Probability(const arma::mat& x,
+                   arma::vec& observationProbabilities) const;
+
+  /**
+   * Calculate the log probability of each observation (column) in the given
+   * matrix.  The logarithm of each possible observation's probability is only
+   * taken once.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
+  /**
+   * Calculate the log probability of each observation (column) in the given
+   * matrix under each of the given distributions, as needed by the HMM class.
+   * A table of the log probability of every symbol in every distribution is
+   * built once, so each observation only costs a lookup of one of its columns.
+   * Observations that are out of the bounds of every distribution get a log
+   * probability of -infinity; observations that are only out of the bounds of
+   * some distributions get -infinity for those.
+   *
+   * @param dists List of distributions (one for each row of the output).
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities of each observation
+   *     (column) under each distribution (row).
+   */
+  static void LogProbability(const std::vector<DiscreteDistribution>& dists,
+                             const arma::mat& x,
+                             arma::mat& logProbabilities);
+
   /**
    * Return a randomly generated observation (one-dimensional vector; one
    * observation) according to the probability distribution defined by this
@@ -40,36 +40,19 @@ void GaussianDistribution::FactorCovariance()
     covLower = arma::chol(covariance, "lower");
   #endif
 
-  // Comment from rcurtin:
-  //
-  // I think the use of the word "interpret" in the Armadillo documentation
-  // about trimatl and trimatu is somewhat misleading. What the function will
-  // actually do, when used in that context, is loop over the upper triangular
-  // part of the matrix and set it all to 0, so this ends up actually just
-  // burning cycles---also because the operator=() evaluates the expression and
-  // strips the knowledge that it's a lower triangular matrix. So then the call
-  // to .i() doesn't actually do anything smarter.
-  //
-  // But perusing fn_inv.hpp more closely, there is a specialization that will
-  // work when called like this: inv(trimatl(covLower)), and will use LAPACK's
-  // ?trtri functions. However, it will still set the upper triangular part to
-  // 0 after the method. That last part is unnecessary, but baked into
-  // Armadillo, so there's not really much that can be done about that without
-  // discussion with the Armadillo maintainer.
-  const arma::mat invCovLower = arma::inv(arma::trimatl(covLower));
-
-  invCov = invCovLower.t() * invCovLower;
-  double sign = 0.;
-  arma::log_det(logDetCov, sign, covLower);
-  logDetCov *= 2;
+  // Only the factor is kept; the inverse is never formed.  Every evaluation
+  // of the density is then a triangular solve against covLower, which is
+  // cheaper and more accurate than multiplying by an explicit inverse.  The
+  // log-determinant of a triangular factor is just the log of its diagonal.
+  logDetCov = 2.0 * arma::accu(arma::log(covLower.diag()));
 }
 
 double GaussianDistribution::LogProbability(const arma::vec& observation) const
 {
   const size_t k = observation.n_elem;
-  const arma::vec diff = mean - observation;
-  const arma::vec v = (diff.t() * invCov * diff);
-  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * v(0);
+  const arma::vec diff = observation - mean;
+  const arma::vec z = arma::solve(arma::trimatl(covLower), diff);
+  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * arma::dot(z, z);
 }
 
 arma::vec GaussianDistribution::Random() const
@@ -97,23 +80,9 @@ void GaussianDistribution::Estimate(const arma::mat& observations)
     return;
   }
 
-  // Calculate the mean.
-  for (size_t i = 0; i < observations.n_cols; i++)
-    mean += observations.col(i);
-
-  // Normalize the mean.
-  mean /= observations.n_cols;
-
-  // Now calculate the covariance.
-  for (size_t i = 0; i < observations.n_cols; i++)
-  {
-    arma::vec obsNoMean = observations.col(i) - mean;
-    covariance += obsNoMean * trans(obsNoMean);
-  }
-
-  // Finish estimating the covariance by normalizing, with the (1 / (n - 1)) so
-  // that it is the unbiased estimator.
-  covariance /= (observations.n_cols - 1);
+  // Calculate the mean and covariance in one pass.  The covariance is
+  // normalized with (1 / (n - 1)) so that it is the unbiased estimator.
+  math::Covariance(observations, mean, covariance);
 
   // Ensure that the covariance is positive definite.
   if (det(covariance) <= 1e-50)
@@ -153,16 +122,7 @@ void GaussianDistribution::Estimate(const arma::mat& observations,
     return;
   }
 
-  double sumProb = 0;
-
-  // First calculate the mean, and save the sum of all the probabilities for
-  // later normalization.
-  for (size_t i = 0; i < observations.n_cols; i++)
-  {
-    mean += probabilities[i] * observations.col(i);
-    sumProb += probabilities[i];
-  }
-
+  const double sumProb = arma::accu(probabilities);
   if (sumProb == 0)
   {
     // Nothing in this Gaussian!  At least set the covariance so that it's
@@ -172,18 +132,9 @@ void GaussianDistribution::Estimate(const arma::mat& observations,
     return;
   }
 
-  // Normalize.
-  mean /= sumProb;
-
-  // Now find the covariance.
-  for (size_t i = 0; i < observations.n_cols; i++)
-  {
-    arma::vec obsNoMean = observations.col(i) - mean;
-    covariance += probabilities[i] * (obsNoMean * trans(obsNoMean));
-  }
-
-  // This is probably biased, but I don't know how to unbias it.
-  covariance /= sumProb;
+  // Find the weighted mean and covariance in one pass.  This is probably
+  // biased, but I don't know how to unbias it.
+  math::Covariance(observations, probabilities, mean, covariance);
 
   // Ensure that the covariance is positive definite.
   if (det(covariance) <= 1e-50)
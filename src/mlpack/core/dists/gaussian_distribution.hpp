@@ -23,10 +23,11 @@ class GaussianDistribution
   arma::vec mean;
   //! Positive definite covariance of the distribution.
   arma::mat covariance;
-  //! Lower triangular factor of cov (e.g. cov = LL^T).
+  //! Cached lower triangular factor of cov (e.g. cov = LL^T).  This, and
+  //! logDetCov, are recomputed whenever the covariance is changed, and never
+  //! otherwise; that keeps every const method free of side effects and safe to
+  //! call from several threads at once.
   arma::mat covLower;
-  //! Cached inverse of covariance.
-  arma::mat invCov;
   //! Cached logdet(cov).
   double logDetCov;
 
@@ -47,7 +48,6 @@ class GaussianDistribution
       mean(arma::zeros<arma::vec>(dimension)),
       covariance(arma::eye<arma::mat>(dimension, dimension)),
       covLower(arma::eye<arma::mat>(dimension, dimension)),
-      invCov(arma::eye<arma::mat>(dimension, dimension)),
       logDetCov(0)
   { /* Nothing to do. */ }
 
@@ -90,6 +90,15 @@ class GaussianDistribution
     probabilities = arma::exp(logProbabilities);
   }
 
+  /**
+   * Calculates the multivariate Gaussian log probability density function for
+   * each data point (column) in the given matrix, using the cached Cholesky
+   * factor and log-determinant of the covariance.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
   void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
 
   /**
@@ -137,6 +146,14 @@ class GaussianDistribution
 
   void Covariance(arma::mat&& covariance);
 
+  //! Return the number of bytes used by this distribution.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(mean) - sizeof(covariance) -
+        sizeof(covLower) + util::MemoryUsage(mean) +
+        util::MemoryUsage(covariance) + util::MemoryUsage(covLower);
+  }
+
   /**
    * Returns a string representation of this object.
    */
@@ -150,6 +167,10 @@ class GaussianDistribution
   static std::string const Type() { return "GaussianDistribution"; }
 
  private:
+  /**
+   * Recompute the cached Cholesky factor and log-determinant from the current
+   * covariance.  This must be called every time the covariance changes.
+   */
   void FactorCovariance();
 
 };
@@ -165,16 +186,14 @@ inline void GaussianDistribution::LogProbability(const arma::mat& x,
                                                  arma::vec& logProbabilities) const
 {
   // Column i of 'diffs' is the difference between x.col(i) and the mean.
-  arma::mat diffs = x - (mean * arma::ones<arma::rowvec>(x.n_cols));
-
-  // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1 *
-  // diffs).  We just don't need any of the other elements.  We can calculate
-  // the right hand part of the equation (instead of the left side) so that
-  // later we are referencing columns, not rows -- that is faster.
-  const arma::mat rhs = -0.5 * invCov * diffs;
-  arma::vec logExponents(diffs.n_cols); // We will now fill this.
-  for (size_t i = 0; i < diffs.n_cols; i++)
-    logExponents(i) = accu(diffs.unsafe_col(i) % rhs.unsafe_col(i));
+  arma::mat diffs = x;
+  diffs.each_col() -= mean;
+
+  // We only want the diagonal elements of (diffs' * cov^-1 * diffs).  With
+  // cov = LL^T, that diagonal is the squared column norms of L^-1 * diffs, so
+  // a single triangular solve against the cached factor is enough.
+  const arma::mat z = arma::solve(arma::trimatl(covLower), diffs);
+  const arma::vec logExponents = -0.5 * arma::trans(arma::sum(z % z, 0));
 
   const size_t k = x.n_rows;
 
@@ -20,6 +20,20 @@ double LaplaceDistribution::LogProbability(const arma::vec& observation) const
   return -log(2. * scale) - arma::norm(observation - mean, 2) / scale;
 }
 
+/**
+ * Calculate the log probability of each observation in the given matrix.
+ */
+void LaplaceDistribution::LogProbability(const arma::mat& x,
+                                         arma::vec& logProbabilities) const
+{
+  // Column i of 'diffs' is the difference between x.col(i) and the mean.
+  arma::mat diffs = x;
+  diffs.each_col() -= mean;
+
+  logProbabilities = -log(2. * scale) -
+      arma::trans(arma::sqrt(arma::sum(diffs % diffs, 0))) / scale;
+}
+
 /**
  * Estimate the Laplace distribution directly from the given observations.
  *
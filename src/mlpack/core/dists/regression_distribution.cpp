@@ -71,8 +71,83 @@ double RegressionDistribution::Probability(const arma::vec& observation) const
   return err.Probability(observation(0)-fitted);
 }
 
+/**
+ * Evaluate the log probability density function of each given observation.
+ */
+void RegressionDistribution::LogProbability(const arma::mat& x,
+                                            arma::vec& logProbabilities) const
+{
+  arma::vec fitted;
+  rf.Predict(x.rows(1, x.n_rows - 1), fitted);
+
+  // The residuals are one-dimensional observations of the error distribution.
+  const arma::mat residuals = x.row(0) - arma::trans(fitted);
+  err.LogProbability(residuals, logProbabilities);
+}
+
 void RegressionDistribution::Predict(const arma::mat& points,
                                      arma::vec& predictions) const
 {
   rf.Predict(points, predictions);
 }
+
+/**
+ * Evaluate the log probability density function of each given observation for
+ * each of the given distributions.
+ */
+void RegressionDistribution::LogProbability(
+    const std::vector<RegressionDistribution>& dists,
+    const arma::mat& x,
+    arma::mat& logProbabilities)
+{
+  arma::mat fitted;
+  Predict(dists, x.rows(1, x.n_rows - 1), fitted);
+
+  logProbabilities.set_size(dists.size(), x.n_cols);
+  arma::vec logPhis;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    // The residuals are one-dimensional observations of the error
+    // distribution.
+    const arma::mat residuals = x.row(0) - fitted.row(i);
+    dists[i].err.LogProbability(residuals, logPhis);
+    logProbabilities.row(i) = arma::trans(logPhis);
+  }
+}
+
+/**
+ * Calculate the conditional mean of each given distribution for each point.
+ */
+void RegressionDistribution::Predict(
+    const std::vector<RegressionDistribution>& dists,
+    const arma::mat& points,
+    arma::mat& predictions)
+{
+  if (dists.size() == 0)
+  {
+    predictions.set_size(0, points.n_cols);
+    return;
+  }
+
+  // Stack the coefficients of all the regressions, one column for each.
+  const size_t offset = dists[0].rf.Intercept() ? 1 : 0;
+  arma::mat coefficients(points.n_rows, dists.size());
+  arma::vec intercepts(dists.size(), arma::fill::zeros);
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    const arma::vec& parameters = dists[i].rf.Parameters();
+    if (dists[i].rf.Intercept() != dists[0].rf.Intercept() ||
+        parameters.n_elem != points.n_rows + offset)
+    {
+      Log::Fatal << "RegressionDistribution::Predict(): all distributions must "
+          << "have the dimensionality of the points." << std::endl;
+    }
+
+    coefficients.col(i) = parameters.subvec(offset, parameters.n_elem - 1);
+    if (offset == 1)
+      intercepts[i] = parameters[0];
+  }
+
+  predictions = arma::trans(coefficients) * points;
+  predictions.each_col() += intercepts;
+}
@@ -91,6 +91,30 @@ class RegressionDistribution
     return log(Probability(observation));
   }
 
+  /**
+   * Evaluate the probability density function of each observation (column) in
+   * the given matrix, with one prediction for all of them.
+   *
+   * @param x List of observations.
+   * @param probabilities Output probabilities for each input observation.
+   */
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(x, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Evaluate the log probability density function of each observation
+   * (column) in the given matrix.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
   /**
    * Calculate y_i for each data point in points.
    *
@@ -99,6 +123,34 @@ class RegressionDistribution
    */
   void Predict(const arma::mat& points, arma::vec& predictions) const;
 
+  /**
+   * Evaluate the log probability density function of each observation
+   * (column) in the given matrix for each of the given distributions.  The
+   * conditional means of all distributions are computed with a single matrix
+   * product, instead of one prediction per distribution.
+   *
+   * @param dists Distributions to evaluate (with the same dimensionality).
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities, with one row for each
+   *     distribution and one column for each observation.
+   */
+  static void LogProbability(const std::vector<RegressionDistribution>& dists,
+                             const arma::mat& x,
+                             arma::mat& logProbabilities);
+
+  /**
+   * Calculate the conditional mean of each of the given distributions for each
+   * data point in points, with a single matrix product.
+   *
+   * @param dists Distributions to evaluate (with the same dimensionality).
+   * @param points The data points to calculate with.
+   * @param predictions Calculated values, with one row for each distribution
+   *     and one column for each point.
+   */
+  static void Predict(const std::vector<RegressionDistribution>& dists,
+                      const arma::mat& points,
+                      arma::mat& predictions);
+
   //! Return the parameters (the b vector).
   const arma::vec& Parameters() const { return rf.Parameters(); }
 
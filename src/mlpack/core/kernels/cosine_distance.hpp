@@ -35,6 +35,17 @@ class CosineDistance
   template<typename VecTypeA, typename VecTypeB>
   static double Evaluate(const VecTypeA& a, const VecTypeB& b);
 
+  /**
+   * Evaluate the cosine distance between every column a_i of a and every column
+   * b_j of b, and store K(a_i, b_j) in k(i, j).  The dot products are
+   * computed with a single matrix product.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param k Matrix to store the kernel evaluations in.
+   */
+  static void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k);
+
   /**
    * Returns a string representation of this object.
    */
@@ -56,6 +67,9 @@ class KernelTraits<CosineDistance>
   
   //! The cosine kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+
+  //! The cosine kernel can be evaluated on whole sets at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 }; // namespace kernel
@@ -27,6 +27,25 @@ double CosineDistance::Evaluate(const VecTypeA& a, const VecTypeB& b)
     return dot(a, b) / denominator;
 }
 
+inline void CosineDistance::Evaluate(const arma::mat& a,
+                                     const arma::mat& b,
+                                     arma::mat& k)
+{
+  k = a.t() * b;
+
+  // Scale by the norms; as above, zero-norm points give a similarity of 0.
+  const arma::rowvec aNorms = arma::sqrt(arma::sum(arma::square(a), 0));
+  const arma::rowvec bNorms = arma::sqrt(arma::sum(arma::square(b), 0));
+  for (size_t j = 0; j < k.n_cols; ++j)
+  {
+    for (size_t i = 0; i < k.n_rows; ++i)
+    {
+      const double denominator = aNorms[i] * bNorms[j];
+      k(i, j) = (denominator == 0.0) ? 0.0 : k(i, j) / denominator;
+    }
+  }
+}
+
 }; // namespace kernel
 }; // namespace mlpack
 
@@ -31,6 +31,18 @@ double EpanechnikovKernel::Evaluate(const double distance) const
   return std::max(0.0, 1 - std::pow(distance, 2.0) * inverseBandwidthSquared);
 }
 
+/**
+ * Evaluate the kernel between every pair of points of the two sets.
+ */
+void EpanechnikovKernel::Evaluate(const arma::mat& a,
+                                  const arma::mat& b,
+                                  arma::mat& k) const
+{
+  SquaredDistances(a, b, k);
+  for (size_t i = 0; i < k.n_elem; ++i)
+    k[i] = std::max(0.0, 1.0 - k[i] * inverseBandwidthSquared);
+}
+
 /**
  * Evaluate gradient of the kernel not for two points 
  * but for a numerical value.
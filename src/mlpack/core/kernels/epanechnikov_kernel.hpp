@@ -8,6 +8,7 @@
 #define __MLPACK_CORE_KERNELS_EPANECHNIKOV_KERNEL_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -51,6 +52,17 @@ class EpanechnikovKernel
    */
   double Evaluate(const double distance) const;
 
+  /**
+   * Evaluate the Epanechnikov kernel between every column a_i of a and every
+   * column b_j of b, and store K(a_i, b_j) in k(i, j).  The distances are
+   * computed with a single matrix product.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param k Matrix to store the kernel evaluations in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k) const;
+
   /**
    * Evaluate the Gradient of Epanechnikov kernel 
    * given that the distance between the two
@@ -103,6 +115,8 @@ class KernelTraits<EpanechnikovKernel>
   static const bool IsNormalized = true;
   //! The Epanechnikov kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Epanechnikov kernel can be evaluated on whole sets at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 }; // namespace kernel
@@ -11,6 +11,7 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -62,6 +63,21 @@ class GaussianKernel
     return exp(gamma * metric::SquaredEuclideanDistance::Evaluate(a, b));
   }
 
+  /**
+   * Evaluate the Gaussian kernel between every column a_i of a and every column
+   * b_j of b, and store K(a_i, b_j) in k(i, j).  The squared distances
+   * are computed with a single matrix product.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param k Matrix to store the kernel evaluations in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k) const
+  {
+    SquaredDistances(a, b, k);
+    k = arma::exp(gamma * k);
+  }
+
   /**
    * Evaluation of the Gaussian kernel given the distance between two points.
    *
@@ -166,6 +182,8 @@ class KernelTraits<GaussianKernel>
   static const bool IsNormalized = true;
   //! The Gaussian kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Gaussian kernel can be evaluated on whole sets at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 }; // namespace kernel
@@ -57,6 +57,20 @@ class HyperbolicTangentKernel
     return tanh(scale * arma::dot(a, b) + offset);
   }
 
+  /**
+   * Evaluate the hyperbolic tangent kernel between every column a_i of a and every column
+   * b_j of b, and store K(a_i, b_j) in k(i, j).  This is a single
+   * matrix product.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param k Matrix to store the kernel evaluations in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k) const
+  {
+    k = arma::tanh(scale * (a.t() * b) + offset);
+  }
+
   //! Get scale factor.
   double Scale() const { return scale; }
   //! Modify scale factor.
@@ -82,6 +96,19 @@ class HyperbolicTangentKernel
   double offset;
 };
 
+//! Kernel traits for the hyperbolic tangent kernel.
+template<>
+class KernelTraits<HyperbolicTangentKernel>
+{
+ public:
+  //! The hyperbolic tangent kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The hyperbolic tangent kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The hyperbolic tangent kernel can be evaluated on whole sets at once.
+  static const bool HasBatchEvaluate = true;
+};
+
 }; // namespace kernel
 }; // namespace mlpack
 
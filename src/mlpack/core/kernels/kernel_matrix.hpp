@@ -0,0 +1,97 @@
+/**
+ * @file kernel_matrix.hpp
+ * @author Ryan Curtin
+ *
+ * Evaluation of a kernel between every pair of points of two sets at once.
+ */
+#ifndef __MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+#define __MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+
+#include <mlpack/core.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "kernel_traits.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Compute the squared Euclidean distance between every column a_i of a and
+ * every column b_j of b, and store it in distances(i, j).  The distances are
+ * expanded as ||a_i||^2 + ||b_j||^2 - 2 a_i^T b_j, so that they are computed
+ * with a single matrix product.  This is used by the batch evaluation of the
+ * kernels that are functions of the distance.
+ *
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param distances Matrix to store the squared distances in.
+ */
+inline void SquaredDistances(const arma::mat& a,
+                             const arma::mat& b,
+                             arma::mat& distances)
+{
+  distances = a.t() * b;
+  distances *= -2.0;
+  distances.each_col() += arma::trans(arma::sum(arma::square(a), 0));
+  distances.each_row() += arma::sum(arma::square(b), 0);
+
+  // Rounding can make the squared distances of (nearly) identical points
+  // slightly negative.
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    if (distances[i] < 0.0)
+      distances[i] = 0.0;
+}
+
+/**
+ * Compute K(a_i, b_j) for every column a_i of a and b_j of b, and store it in
+ * k(i, j).  Kernels with KernelTraits<KernelType>::HasBatchEvaluate set
+ * compute the whole matrix with their Evaluate(a, b, k) function, which
+ * usually reduces to a matrix product.
+ *
+ * @param kernel Instantiated kernel.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param k Matrix to store the kernel evaluations in.
+ */
+template<typename KernelType>
+void KernelMatrix(KernelType& kernel,
+                  const arma::mat& a,
+                  const arma::mat& b,
+                  arma::mat& k,
+                  const typename boost::enable_if_c<
+                      KernelTraits<KernelType>::HasBatchEvaluate>::type* = 0)
+{
+  kernel.Evaluate(a, b, k);
+}
+
+/**
+ * Compute K(a_i, b_j) for every column a_i of a and b_j of b, and store it in
+ * k(i, j).  This is the version for kernels without a batch evaluation: the
+ * kernel is evaluated on every pair of points, with the columns of k computed
+ * in parallel.
+ *
+ * @param kernel Instantiated kernel.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param k Matrix to store the kernel evaluations in.
+ */
+template<typename KernelType>
+void KernelMatrix(KernelType& kernel,
+                  const arma::mat& a,
+                  const arma::mat& b,
+                  arma::mat& k,
+                  const typename boost::disable_if_c<
+                      KernelTraits<KernelType>::HasBatchEvaluate>::type* = 0)
+{
+  k.set_size(a.n_cols, b.n_cols);
+
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < b.n_cols; ++j)
+    for (size_t i = 0; i < a.n_cols; ++i)
+      k(i, j) = kernel.Evaluate(a.unsafe_col(i), b.unsafe_col(j));
+}
+
+}; // namespace kernel
+}; // namespace mlpack
+
+#endif
@@ -31,6 +31,14 @@ class KernelTraits
    * If true, then the kernel include a squared distance, ||x - y||^2 .
    */
   static const bool UsesSquaredDistance = false;
+
+  /**
+   * If true, then the kernel has a function
+   * Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k) that
+   * evaluates the kernel between every pair of points of two sets at once; see
+   * KernelMatrix().
+   */
+  static const bool HasBatchEvaluate = false;
 };
 
 }; // namespace kernel
@@ -8,6 +8,7 @@
 #define __MLPACK_CORE_KERNELS_LAPLACIAN_KERNEL_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -59,6 +60,21 @@ class LaplacianKernel
     return exp(-metric::EuclideanDistance::Evaluate(a, b) / bandwidth);
   }
 
+  /**
+   * Evaluate the Laplacian kernel between every column a_i of a and every column
+   * b_j of b, and store K(a_i, b_j) in k(i, j).  The distances are computed
+   * with a single matrix product.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param k Matrix to store the kernel evaluations in.
+   */
+  void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k) const
+  {
+    SquaredDistances(a, b, k);
+    k = arma::exp(-arma::sqrt(k) / bandwidth);
+  }
+
   /**
    * Evaluation of the Laplacian kernel given the distance between two points.
    *
@@ -114,6 +130,8 @@ class KernelTraits<LaplacianKernel>
   static const bool IsNormalized = true;
   //! The Laplacian kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The Laplacian kernel can be evaluated on whole sets at once.
+  static const bool HasBatchEvaluate = true;
 };
 
 }; // namespace kernel
@@ -50,6 +50,20 @@ class LinearKernel
     return arma::dot(a, b);
   }
 
+  /**
+   * Evaluate the linear kernel between every column a_i of a and every column
+   * b_j of b, and store K(a_i, b_j) in k(i, j).  This is a single matrix
+   * product.
+   *
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param k Matrix to store the kernel evaluations in.
+   */
+  static void Evaluate(const arma::mat& a, const arma::mat& b, arma::mat& k)
+  {
+    k = a.t() * b;
+  }
+
   //! Return a string representation of the kernel.
   std::string ToString() const
   {
@@ -59,6 +73,19 @@ class LinearKernel
   }
 };
 
+//! Kernel traits for the linear kernel.
+template<>
+class KernelTraits<LinearKernel>
+{
+ public:
+  //! The linear kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The linear kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The linear kernel can be evaluated on whole sets at once.
+  static const bool HasBatchEvaluate = true;
+};
+
 }; // namespace kernel
 }; // namespace mlpack
 
@@ -10,6 +10,8 @@
  */
 #include "pspectrum_string_kernel.hpp"
 
+#include <algorithm>
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::kernel;
@@ -32,27 +34,32 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
   Log::Info << "Assembling counts of substrings of length " << p << "."
       << std::endl;
 
-  // Resize for number of datasets.
-  counts.resize(datasets.size());
+  // Every string gets a range of the substring arrays; the strings of all the
+  // datasets are numbered one after another.
+  firstString.resize(datasets.size() + 1);
+  firstString[0] = 0;
+  for (size_t dataset = 0; dataset < datasets.size(); ++dataset)
+    firstString[dataset + 1] = firstString[dataset] + datasets[dataset].size();
+  offsets.resize(firstString[datasets.size()] + 1);
+  offsets[0] = 0;
 
+  std::vector<size_t> ids;
+  string sub;
+  size_t current = 0;
   for (size_t dataset = 0; dataset < datasets.size(); ++dataset)
   {
     const std::vector<std::string>& set = datasets[dataset];
 
-    // Resize for number of strings in dataset.
-    counts[dataset].resize(set.size());
-
     // Inspect each string in the dataset.
-    for (size_t index = 0; index < set.size(); ++index)
+    for (size_t index = 0; index < set.size(); ++index, ++current)
     {
-      // Convenience references.
       const std::string& str = set[index];
-      std::map<std::string, int>& mapping = counts[dataset][index];
 
+      ids.clear();
       size_t start = 0;
       while ((start + p) <= str.length())
       {
-        string sub = str.substr(start, p);
+        sub.assign(str, start, p);
 
         // Convert all characters to lowercase.
         bool invalid = false;
@@ -72,12 +79,59 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
 
         if (!invalid)
         {
-          // Add to the map.
-          ++mapping[sub];
+          // Substrings we haven't seen yet get the next identifier.
+          const size_t id = substringIds.insert(std::make_pair(sub,
+              substringIds.size())).first->second;
+          ids.push_back(id);
         }
       }
+
+      // Turn the identifiers into sorted (identifier, count) pairs.
+      std::sort(ids.begin(), ids.end());
+      for (size_t i = 0; i < ids.size(); ++i)
+      {
+        if (i == 0 || ids[i] != ids[i - 1])
+        {
+          substrings.push_back(ids[i]);
+          counts.push_back(1);
+        }
+        else
+        {
+          ++counts.back();
+        }
+      }
+
+      offsets[current + 1] = substrings.size();
     }
   }
 
-  Log::Info << "Substring extraction complete." << std::endl;
+  Log::Info << "Substring extraction complete; " << substringIds.size()
+      << " distinct substrings." << std::endl;
+}
+
+size_t PSpectrumStringKernel::Count(const size_t dataset,
+                                    const size_t index,
+                                    const std::string& substring) const
+{
+  std::string sub(substring);
+  for (size_t j = 0; j < sub.length(); ++j)
+    sub[j] = tolower(sub[j]);
+
+  std::unordered_map<std::string, size_t>::const_iterator it =
+      substringIds.find(sub);
+  if (it == substringIds.end())
+    return 0;
+
+  // The substrings of each string are sorted by identifier.
+  const size_t s = firstString[dataset] + index;
+  const std::vector<size_t>::const_iterator begin = substrings.begin() +
+      offsets[s];
+  const std::vector<size_t>::const_iterator end = substrings.begin() +
+      offsets[s + 1];
+  const std::vector<size_t>::const_iterator position =
+      std::lower_bound(begin, end, it->second);
+  if (position == end || *position != it->second)
+    return 0;
+
+  return counts[position - substrings.begin()];
 }
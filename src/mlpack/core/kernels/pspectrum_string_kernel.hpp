@@ -11,8 +11,8 @@
 #ifndef __MLPACK_CORE_KERNELS_PSPECTRUM_STRING_KERNEL_HPP
 #define __MLPACK_CORE_KERNELS_PSPECTRUM_STRING_KERNEL_HPP
 
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <mlpack/core.hpp>
@@ -55,6 +55,13 @@ namespace kernel {
  * the data according to the fake data matrix -- resulting in a meaningless
  * tree.  This kernel was originally written for the FastMKS method; so, at the
  * very least, it will work with that.
+ *
+ * At construction time, every distinct substring of length p (ignoring case,
+ * and ignoring substrings that hold other characters than alphanumerics) is
+ * given an integer identifier, and every string is turned into a sparse vector
+ * of substring counts, sorted by identifier.  The sparse vectors of all the
+ * strings are stored one after another in the same arrays, so evaluating the
+ * kernel is a merge of two sorted integer ranges.
  */
 class PSpectrumStringKernel
 {
@@ -83,12 +90,33 @@ class PSpectrumStringKernel
   template<typename VecType>
   double Evaluate(const VecType& a, const VecType& b) const;
 
-  //! Access the lists of substrings.
-  const std::vector<std::vector<std::map<std::string, int> > >& Counts() const
-  { return counts; }
-  //! Modify the lists of substrings.
-  std::vector<std::vector<std::map<std::string, int> > >& Counts()
-  { return counts; }
+  //! Get the number of datasets.
+  size_t Datasets() const { return firstString.size() - 1; }
+  //! Get the number of strings in the given dataset.
+  size_t Strings(const size_t dataset) const
+  { return firstString[dataset + 1] - firstString[dataset]; }
+
+  //! Get the number of distinct substrings of the given string.
+  size_t Substrings(const size_t dataset, const size_t index) const
+  {
+    const size_t s = firstString[dataset] + index;
+    return offsets[s + 1] - offsets[s];
+  }
+
+  /**
+   * Get the number of times the given substring appears in the given string
+   * (ignoring case).
+   *
+   * @param dataset Index of the dataset of the string.
+   * @param index Index of the string in its dataset.
+   * @param substring Substring to count (of length p).
+   */
+  size_t Count(const size_t dataset,
+               const size_t index,
+               const std::string& substring) const;
+
+  //! Get the number of distinct substrings in all the datasets.
+  size_t DistinctSubstrings() const { return substringIds.size(); }
 
   //! Access the value of p.
   size_t P() const { return p; }
@@ -113,9 +141,19 @@ class PSpectrumStringKernel
   //! The datasets.
   const std::vector<std::vector<std::string> >& datasets;
 
-  //! Mappings of the datasets to counts of substrings.  Such a huge structure
-  //! is not wonderful...
-  std::vector<std::vector<std::map<std::string, int> > > counts;
+  //! The identifiers of the distinct substrings.
+  std::unordered_map<std::string, size_t> substringIds;
+
+  //! The identifiers of the substrings of every string, sorted for each string;
+  //! the substrings of string s are [offsets[s], offsets[s + 1]).
+  std::vector<size_t> substrings;
+  //! The number of times each substring in substrings appears in its string.
+  std::vector<size_t> counts;
+  //! The start of the substrings of every string, and their end.
+  std::vector<size_t> offsets;
+  //! The index of the first string of every dataset, in the order of offsets,
+  //! and the total number of strings.
+  std::vector<size_t> firstString;
 
   //! The value of p to use in calculation.
   size_t p;
@@ -31,38 +31,36 @@ template<typename VecType>
 double PSpectrumStringKernel::Evaluate(const VecType& a,
                                        const VecType& b) const
 {
-  // Get the map of substrings for the two strings we are interested in.
-  const std::map<std::string, int>& aMap = counts[a[0]][a[1]];
-  const std::map<std::string, int>& bMap = counts[b[0]][b[1]];
+  // Get the substrings of the two strings we are interested in.
+  const size_t aString = firstString[(size_t) a[0]] + (size_t) a[1];
+  const size_t bString = firstString[(size_t) b[0]] + (size_t) b[1];
 
-  double eval = 0;
-
-  // Loop through the two maps (which, when iterated through, are sorted
-  // alphabetically).
-  std::map<std::string, int>::const_iterator aIt = aMap.begin();
-  std::map<std::string, int>::const_iterator bIt = bMap.begin();
+  size_t aIt = offsets[aString];
+  size_t bIt = offsets[bString];
+  const size_t aEnd = offsets[aString + 1];
+  const size_t bEnd = offsets[bString + 1];
 
-  while ((aIt != aMap.end()) && (bIt != bMap.end()))
+  // Both lists are sorted by substring identifier, so only matching
+  // identifiers contribute.
+  double eval = 0;
+  while ((aIt != aEnd) && (bIt != bEnd))
   {
-    // Compare alphabetically (this is how std::map is ordered).
-    int result = (*aIt).first.compare((*bIt).first);
-
-    if (result == 0) // The same substring.
+    if (substrings[aIt] == substrings[bIt]) // The same substring.
     {
-      eval += ((*aIt).second * (*bIt).second);
+      eval += double(counts[aIt]) * double(counts[bIt]);
 
       // Now increment both.
       ++aIt;
       ++bIt;
     }
-    else if (result > 0)
+    else if (substrings[aIt] > substrings[bIt])
     {
-      // aIt is "ahead" of bIt (alphabetically); so increment bIt to "catch up".
+      // aIt is "ahead" of bIt; so increment bIt to "catch up".
       ++bIt;
     }
     else
     {
-      // bIt is "ahead" of aIt (alphabetically); so increment aIt to "catch up".
+      // bIt is "ahead" of aIt; so increment aIt to "catch up".
       ++aIt;
     }
   }
@@ -0,0 +1,177 @@
+/**
+ * @file random_fourier_features.hpp
+ * @author Ryan Curtin
+ *
+ * An explicit feature map that approximates a shift-invariant kernel with
+ * random Fourier features.
+ */
+#ifndef __MLPACK_CORE_KERNELS_RANDOM_FOURIER_FEATURES_HPP
+#define __MLPACK_CORE_KERNELS_RANDOM_FOURIER_FEATURES_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/laplacian_kernel.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * The spectral distribution of a shift-invariant kernel K(x, y) = k(x - y): by
+ * Bochner's theorem, k is the Fourier transform of a probability distribution
+ * p, so that K(x, y) = E[cos(w^T (x - y))] for w drawn from p.  The
+ * specializations implement
+ *
+ * @code
+ * static void Sample(const KernelType& kernel, const size_t dimensionality,
+ *                    const size_t numFeatures, arma::mat& frequencies);
+ * @endcode
+ *
+ * which draws numFeatures frequencies w from p, one per row of frequencies.
+ * Only the kernels with a specialization can be used with
+ * RandomFourierFeatures.
+ */
+template<typename KernelType>
+class SpectralDistribution;
+
+/**
+ * The spectral distribution of the Gaussian kernel with bandwidth mu is the
+ * normal distribution with covariance I / mu^2.
+ */
+template<>
+class SpectralDistribution<GaussianKernel>
+{
+ public:
+  static void Sample(const GaussianKernel& kernel,
+                     const size_t dimensionality,
+                     const size_t numFeatures,
+                     arma::mat& frequencies)
+  {
+    frequencies = arma::randn<arma::mat>(numFeatures, dimensionality) /
+        kernel.Bandwidth();
+  }
+};
+
+/**
+ * The spectral distribution of the Laplacian kernel with bandwidth mu (of the
+ * Euclidean distance) is the multivariate Cauchy distribution with scale
+ * 1 / mu; a sample is a normal vector divided by mu times the absolute value of
+ * an independent standard normal value.
+ */
+template<>
+class SpectralDistribution<LaplacianKernel>
+{
+ public:
+  static void Sample(const LaplacianKernel& kernel,
+                     const size_t dimensionality,
+                     const size_t numFeatures,
+                     arma::mat& frequencies)
+  {
+    frequencies = arma::randn<arma::mat>(numFeatures, dimensionality);
+    for (size_t i = 0; i < numFeatures; ++i)
+      frequencies.row(i) /= kernel.Bandwidth() * std::abs(math::RandNormal());
+  }
+};
+
+/**
+ * This class maps points into an m-dimensional space where the dot product
+ * approximates a shift-invariant kernel:
+ *
+ * @code
+ * @inproceedings{rahimi2007random,
+ *   title={Random features for large-scale kernel machines},
+ *   author={Rahimi, A. and Recht, B.},
+ *   booktitle={Advances in Neural Information Processing Systems},
+ *   pages={1177--1184},
+ *   year={2007}
+ * }
+ * @endcode
+ *
+ * Feature i of a point x is sqrt(2 / m) cos(w_i^T x + b_i), where the
+ * frequencies w_i are drawn from the spectral distribution of the kernel (see
+ * SpectralDistribution) and the offsets b_i uniformly from [0, 2 pi).  The
+ * dot product of the features of two points is then an unbiased estimate of
+ * the kernel between them, with an error of O(1 / sqrt(m)).
+ *
+ * A linear method trained on the features approximates the kernelized method
+ * at a cost of O(n m) instead of O(n^2) for n points:
+ *
+ * @code
+ * RandomFourierFeatures<GaussianKernel> rff(GaussianKernel(0.5), 1000);
+ * rff.Train(data);
+ * arma::mat features;
+ * rff.Transform(data, features);
+ * regression::LogisticRegression<> lr(features, responses);
+ * @endcode
+ *
+ * @tparam KernelType The kernel to approximate; GaussianKernel and
+ *     LaplacianKernel are supported.
+ */
+template<typename KernelType>
+class RandomFourierFeatures
+{
+ public:
+  /**
+   * Create the feature map.  Train() must be called before Transform().
+   *
+   * @param kernel Kernel to approximate.
+   * @param numFeatures Number of features (m).
+   */
+  RandomFourierFeatures(const KernelType& kernel = KernelType(),
+                        const size_t numFeatures = 100);
+
+  /**
+   * Draw the frequencies and offsets for points of the given dimensionality.
+   *
+   * @param dimensionality Number of dimensions of the points.
+   */
+  void Train(const size_t dimensionality);
+
+  /**
+   * Draw the frequencies and offsets for points like those of the given
+   * dataset (only its number of dimensions is used).
+   *
+   * @param data Dataset (one point per column).
+   */
+  void Train(const arma::mat& data) { Train(data.n_rows); }
+
+  /**
+   * Map the given points into the feature space.  The points are taken in
+   * blocks, which are mapped in parallel.
+   *
+   * @param data Points to map (one point per column).
+   * @param features Matrix to store the m features of every point in (one
+   *     point per column).
+   */
+  void Transform(const arma::mat& data, arma::mat& features) const;
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Get the number of features.
+  size_t NumFeatures() const { return numFeatures; }
+
+  //! Get the frequencies (one per row).
+  const arma::mat& Frequencies() const { return frequencies; }
+  //! Get the offsets.
+  const arma::vec& Offsets() const { return offsets; }
+
+ private:
+  //! The number of points of a block.
+  static const size_t BlockSize = 1024;
+
+  //! The kernel to approximate.
+  KernelType kernel;
+  //! The number of features.
+  size_t numFeatures;
+  //! The frequencies (one per row).
+  arma::mat frequencies;
+  //! The offsets.
+  arma::vec offsets;
+};
+
+}; // namespace kernel
+}; // namespace mlpack
+
+// Include implementation.
+#include "random_fourier_features_impl.hpp"
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file random_fourier_features_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the RandomFourierFeatures class.
+ */
+#ifndef __MLPACK_CORE_KERNELS_RANDOM_FOURIER_FEATURES_IMPL_HPP
+#define __MLPACK_CORE_KERNELS_RANDOM_FOURIER_FEATURES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "random_fourier_features.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+template<typename KernelType>
+RandomFourierFeatures<KernelType>::RandomFourierFeatures(
+    const KernelType& kernel,
+    const size_t numFeatures) :
+    kernel(kernel),
+    numFeatures(numFeatures)
+{
+  // Nothing to do.
+}
+
+template<typename KernelType>
+void RandomFourierFeatures<KernelType>::Train(const size_t dimensionality)
+{
+  SpectralDistribution<KernelType>::Sample(kernel, dimensionality, numFeatures,
+      frequencies);
+  offsets = 2.0 * M_PI * arma::randu<arma::vec>(numFeatures);
+}
+
+template<typename KernelType>
+void RandomFourierFeatures<KernelType>::Transform(const arma::mat& data,
+                                                  arma::mat& features) const
+{
+  if (data.n_rows != frequencies.n_cols)
+  {
+    Log::Fatal << "RandomFourierFeatures::Transform(): the points have "
+        << data.n_rows << " dimensions, but the features were drawn for "
+        << frequencies.n_cols << " dimensions!" << std::endl;
+  }
+
+  features.set_size(numFeatures, data.n_cols);
+  const double scale = std::sqrt(2.0 / numFeatures);
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols) - 1;
+
+    arma::mat projections = frequencies * data.cols(begin, end);
+    projections.each_col() += offsets;
+    features.cols(begin, end) = scale * arma::cos(projections);
+  }
+}
+
+}; // namespace kernel
+}; // namespace mlpack
+
+#endif
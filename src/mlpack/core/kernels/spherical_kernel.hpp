@@ -122,6 +122,8 @@ class KernelTraits<SphericalKernel>
   static const bool IsNormalized = true;
   //! The spherical kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The spherical kernel is evaluated one pair of points at a time.
+  static const bool HasBatchEvaluate = false;
 };
 
 }; // namespace kernel
@@ -103,6 +103,8 @@ class KernelTraits<TriangularKernel>
   static const bool IsNormalized = true;
   //! The triangular kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The triangular kernel is evaluated one pair of points at a time.
+  static const bool HasBatchEvaluate = false;
 };
 
 }; // namespace kernel
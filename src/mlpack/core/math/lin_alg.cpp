@@ -7,6 +7,10 @@
 #include "lin_alg.hpp"
 #include <mlpack/core.hpp>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace math;
 
@@ -39,7 +43,144 @@ void mlpack::math::Center(const arma::mat& x, arma::mat& xCentered)
   // Get the mean of the elements in each row.
   arma::vec rowMean = arma::sum(x, 1) / x.n_cols;
 
-  xCentered = x - arma::repmat(rowMean, 1, x.n_cols);
+  // If x and xCentered are the same matrix, this centers it in place.
+  xCentered = x;
+  xCentered.each_col() -= rowMean;
+}
+
+namespace {
+
+/**
+ * Merge the summary of one set of points (total weight, mean, and sum of
+ * weighted squared deviations from the mean) into the summary of another.
+ */
+void MergeMoments(const double otherWeight,
+                  const arma::vec& otherMean,
+                  const arma::mat& otherDeviations,
+                  double& weight,
+                  arma::vec& mean,
+                  arma::mat& deviations)
+{
+  if (otherWeight == 0.0)
+    return;
+
+  const double totalWeight = weight + otherWeight;
+  const arma::vec delta = otherMean - mean;
+  deviations += otherDeviations +
+      (weight * otherWeight / totalWeight) * (delta * trans(delta));
+  mean += (otherWeight / totalWeight) * delta;
+  weight = totalWeight;
+}
+
+/**
+ * Summarize the (possibly weighted) columns of x, a block at a time.  weights
+ * may be NULL, in which case every column has weight 1.
+ */
+void Moments(const arma::mat& x,
+             const arma::vec* weights,
+             const size_t blockSize,
+             double& weight,
+             arma::vec& mean,
+             arma::mat& deviations)
+{
+  if (blockSize == 0)
+    throw std::invalid_argument("Covariance(): blockSize must be positive");
+
+  weight = 0.0;
+  mean.zeros(x.n_rows);
+  deviations.zeros(x.n_rows, x.n_rows);
+
+  #pragma omp parallel
+  {
+    size_t begin = 0;
+    size_t end = x.n_cols;
+#ifdef _OPENMP
+    const size_t threads = omp_get_num_threads();
+    const size_t thread = omp_get_thread_num();
+    begin = (x.n_cols * thread) / threads;
+    end = (x.n_cols * (thread + 1)) / threads;
+#endif
+
+    double rangeWeight = 0.0;
+    arma::vec rangeMean(x.n_rows, arma::fill::zeros);
+    arma::mat rangeDeviations(x.n_rows, x.n_rows, arma::fill::zeros);
+    for (size_t first = begin; first < end; first += blockSize)
+    {
+      const size_t last = std::min(first + blockSize, end) - 1;
+
+      arma::mat block = x.cols(first, last);
+      double blockWeight;
+      arma::vec blockMean;
+      if (weights != NULL)
+      {
+        const arma::vec blockWeights = weights->subvec(first, last);
+        blockWeight = arma::accu(blockWeights);
+        if (blockWeight == 0.0)
+          continue;
+
+        // Scale each centered point by the square root of its weight, so the
+        // deviations are a single product.
+        blockMean = (block * blockWeights) / blockWeight;
+        block.each_col() -= blockMean;
+        block.each_row() %= trans(arma::sqrt(blockWeights));
+      }
+      else
+      {
+        blockWeight = block.n_cols;
+        blockMean = arma::mean(block, 1);
+        block.each_col() -= blockMean;
+      }
+
+      MergeMoments(blockWeight, blockMean, block * trans(block), rangeWeight,
+          rangeMean, rangeDeviations);
+    }
+
+    #pragma omp critical(covariance_moments)
+    MergeMoments(rangeWeight, rangeMean, rangeDeviations, weight, mean,
+        deviations);
+  }
+}
+
+} // anonymous namespace
+
+/**
+ * Compute the mean and covariance of the columns of x in one pass, a block of
+ * columns at a time.
+ */
+void mlpack::math::Covariance(const arma::mat& x,
+                              arma::vec& mean,
+                              arma::mat& covariance,
+                              const bool unbiased,
+                              const size_t blockSize)
+{
+  double weight;
+  Moments(x, NULL, blockSize, weight, mean, covariance);
+
+  const double normalizer = (unbiased && x.n_cols > 1) ? (x.n_cols - 1) :
+      x.n_cols;
+  if (normalizer > 0)
+    covariance /= normalizer;
+}
+
+/**
+ * Compute the weighted mean and covariance of the columns of x in one pass, a
+ * block of columns at a time.
+ */
+void mlpack::math::Covariance(const arma::mat& x,
+                              const arma::vec& weights,
+                              arma::vec& mean,
+                              arma::mat& covariance,
+                              const size_t blockSize)
+{
+  if (weights.n_elem != x.n_cols)
+    throw std::invalid_argument("Covariance(): the number of weights must be "
+        "the same as the number of points");
+
+  double weight;
+  Moments(x, &weights, blockSize, weight, mean, covariance);
+
+  if (weight > 0)
+    covariance /= weight;
 }
 
 /**
@@ -52,9 +193,9 @@ void mlpack::math::WhitenUsingSVD(const arma::mat& x,
                                   arma::mat& whiteningMatrix)
 {
   arma::mat covX, u, v, invSMatrix, temp1;
-  arma::vec sVector;
+  arma::vec sVector, mean;
 
-  covX = ccov(x);
+  Covariance(x, mean, covX);
 
   svd(u, sVector, v, covX);
 
@@ -75,11 +216,12 @@ void mlpack::math::WhitenUsingEig(const arma::mat& x,
                                   arma::mat& xWhitened,
                                   arma::mat& whiteningMatrix)
 {
-  arma::mat diag, eigenvectors;
-  arma::vec eigenvalues;
+  arma::mat diag, eigenvectors, covX;
+  arma::vec eigenvalues, mean;
 
   // Get eigenvectors of covariance of input matrix.
-  eig_sym(eigenvalues, eigenvectors, ccov(x));
+  Covariance(x, mean, covX);
+  eig_sym(eigenvalues, eigenvectors, covX);
 
   // Generate diagonal matrix using 1 / sqrt(eigenvalues) for each value.
   VectorPower(eigenvalues, -0.5);
@@ -127,9 +269,10 @@ void mlpack::math::Orthogonalize(const arma::mat& x, arma::mat& W)
 {
   // For a matrix A, A^N = V * D^N * V', where VDV' is the
   // eigendecomposition of the matrix A.
-  arma::mat eigenvalues, eigenvectors;
-  arma::vec egval;
-  eig_sym(egval, eigenvectors, ccov(x));
+  arma::mat eigenvalues, eigenvectors, covX;
+  arma::vec egval, mean;
+  Covariance(x, mean, covX);
+  eig_sym(egval, eigenvectors, covX);
   VectorPower(egval, -0.5);
 
   eigenvalues.zeros(egval.n_elem, egval.n_elem);
@@ -31,6 +31,46 @@ void VectorPower(arma::vec& vec, const double power);
  */
 void Center(const arma::mat& x, arma::mat& xCentered);
 
+/**
+ * Compute the mean and covariance of the columns of x in one pass.  The columns
+ * are summarized a block at a time (mean and sum of squared deviations from the
+ * block mean), and the summaries are merged with the pairwise update of Chan,
+ * Golub and LeVeque, which is numerically stable even if the data is far from
+ * the origin.  With OpenMP, each thread summarizes a contiguous range of
+ * columns.  Only block-sized temporaries are needed, so no centered copy of x
+ * is made.
+ *
+ * @param x Input matrix (each column is a point).
+ * @param mean Vector to store the mean in.
+ * @param covariance Matrix to store the covariance in.
+ * @param unbiased If true, normalize by (n - 1) (like ccov()); otherwise
+ *     normalize by n.
+ * @param blockSize Number of columns in each block.
+ */
+void Covariance(const arma::mat& x,
+                arma::vec& mean,
+                arma::mat& covariance,
+                const bool unbiased = true,
+                const size_t blockSize = 1024);
+
+/**
+ * Compute the weighted mean and covariance of the columns of x in one pass, in
+ * the same way as the unweighted Covariance().  The covariance is normalized by
+ * the sum of the weights.  If all the weights are zero, the mean and covariance
+ * are zero.
+ *
+ * @param x Input matrix (each column is a point).
+ * @param weights Nonnegative weight of each column.
+ * @param mean Vector to store the weighted mean in.
+ * @param covariance Matrix to store the weighted covariance in.
+ * @param blockSize Number of columns in each block.
+ */
+void Covariance(const arma::mat& x,
+                const arma::vec& weights,
+                arma::vec& mean,
+                arma::mat& covariance,
+                const size_t blockSize = 1024);
+
 /**
  * Whitens a matrix using the singular value decomposition of the covariance
  * matrix. Whitening means the covariance matrix of the result is the identity
@@ -3,6 +3,7 @@
  *
  * Declarations of global random number generators.
  */
+#include <cstddef>
 #include <random>
 
 namespace mlpack {
@@ -14,6 +15,9 @@ std::mt19937 randGen;
 std::uniform_real_distribution<> randUniformDist(0.0, 1.0);
 // Global normal distribution.
 std::normal_distribution<> randNormalDist(0.0, 1.0);
+// The seed of the random streams; the default seed of std::mt19937 until
+// RandomSeed() is called.
+size_t randSeed = std::mt19937::default_seed;
 
 }; // namespace math
 }; // namespace mlpack
@@ -18,6 +18,8 @@ extern std::mt19937 randGen;
 extern std::uniform_real_distribution<> randUniformDist;
 // Global normal distribution.
 extern std::normal_distribution<> randNormalDist;
+// The last seed given to RandomSeed(), which the random streams derive from.
+extern size_t randSeed;
 
 /**
  * Set the random seed used by the random functions (Random() and RandInt()).
@@ -28,6 +30,7 @@ extern std::normal_distribution<> randNormalDist;
  */
 inline void RandomSeed(const size_t seed)
 {
+  randSeed = seed;
   randGen.seed((uint32_t) seed);
   srand((unsigned int) seed);
 #if ARMA_VERSION_MAJOR > 3 || \
@@ -91,7 +94,59 @@ inline double RandNormal(const double mean, const double variance)
   return variance * randNormalDist(randGen) + mean;
 }
 
+/**
+ * Return a random number generator for the given stream.  The generator only
+ * depends on the stream and on the seed given to RandomSeed(), not on how much
+ * of randGen has been used or on which thread asks for it.  Parallel code can
+ * give each independent unit of work (a block of points, a chain, a tree) its
+ * own stream, so that it gets the same results for any number of threads
+ * without sharing randGen.
+ *
+ * Different streams are seeded from different seed sequences; for independent
+ * sets of streams in the same run, offset the stream numbers (for instance by
+ * a value drawn from randGen).
+ *
+ * @param stream Index of the stream.
+ */
+inline std::mt19937 RandomStream(const size_t stream)
+{
+  std::seed_seq sequence = { (uint32_t) randSeed,
+      (uint32_t) ((uint64_t) randSeed >> 32), (uint32_t) stream,
+      (uint32_t) ((uint64_t) stream >> 32) };
+  return std::mt19937(sequence);
+}
+
+/**
+ * Fill the given matrix with uniform random numbers in [lo, hi).  The matrix
+ * is filled in parallel in blocks of fixed size, each from its own stream
+ * generator seeded from one draw of randGen, so the values are reproducible
+ * after RandomSeed() for any number of threads.
+ *
+ * @param x Matrix to fill (its size is kept).
+ * @param lo Lower bound of the values.
+ * @param hi Upper bound of the values (exclusive).
+ */
+template<typename eT>
+void RandomFill(arma::Mat<eT>& x, const double lo = 0.0, const double hi = 1.0);
+
+/**
+ * Fill the given matrix with normally distributed random numbers, like
+ * RandNormal(mean, variance).  As with RandomFill(), the values are
+ * reproducible for any number of threads.
+ *
+ * @param x Matrix to fill (its size is kept).
+ * @param mean Mean of the distribution.
+ * @param variance Variance of the distribution.
+ */
+template<typename eT>
+void RandNormalFill(arma::Mat<eT>& x,
+                    const double mean = 0.0,
+                    const double variance = 1.0);
+
 }; // namespace math
 }; // namespace mlpack
 
+// Include implementation of the bulk fills.
+#include "random_impl.hpp"
+
 #endif // __MLPACK_CORE_MATH_MATH_LIB_HPP
@@ -0,0 +1,70 @@
+/**
+ * @file random_impl.hpp
+ *
+ * Implementation of the bulk random fills, which fill blocks of a matrix in
+ * parallel from their own random streams.
+ */
+#ifndef __MLPACK_CORE_MATH_RANDOM_IMPL_HPP
+#define __MLPACK_CORE_MATH_RANDOM_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "random.hpp"
+
+namespace mlpack {
+namespace math {
+
+//! The number of elements filled from each stream by the bulk fills.  This
+//! must not depend on the number of threads, or the fills wouldn't be
+//! reproducible.
+static const size_t RandomFillBlockSize = 4096;
+
+/**
+ * Fill x in blocks, each from a generator seeded from the given base seed and
+ * the index of the block, drawing each element from the given distribution.
+ */
+template<typename eT, typename DistributionType>
+void RandomFillBlocks(arma::Mat<eT>& x,
+                      const uint32_t base,
+                      const DistributionType& distribution,
+                      const double scale,
+                      const double shift)
+{
+  const size_t numBlocks = (x.n_elem + RandomFillBlockSize - 1) /
+      RandomFillBlockSize;
+  eT* memory = x.memptr();
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    std::seed_seq sequence = { base, (uint32_t) b,
+        (uint32_t) ((uint64_t) b >> 32) };
+    std::mt19937 generator(sequence);
+    DistributionType blockDistribution(distribution);
+
+    const size_t end = std::min((b + 1) * RandomFillBlockSize,
+        (size_t) x.n_elem);
+    for (size_t i = b * RandomFillBlockSize; i < end; ++i)
+      memory[i] = eT(shift + scale * blockDistribution(generator));
+  }
+}
+
+template<typename eT>
+void RandomFill(arma::Mat<eT>& x, const double lo, const double hi)
+{
+  const uint32_t base = (uint32_t) randGen();
+  RandomFillBlocks(x, base, std::uniform_real_distribution<>(0.0, 1.0),
+      hi - lo, lo);
+}
+
+template<typename eT>
+void RandNormalFill(arma::Mat<eT>& x, const double mean, const double variance)
+{
+  const uint32_t base = (uint32_t) randGen();
+  RandomFillBlocks(x, base, std::normal_distribution<>(0.0, 1.0), variance,
+      mean);
+}
+
+}; // namespace math
+}; // namespace mlpack
+
+#endif
@@ -75,10 +75,6 @@ template<>
 template<typename VecTypeA, typename VecTypeB>
 double LMetric<3, true>::Evaluate(const VecTypeA& a, const VecTypeB& b)
 {
-  double sum = 0;
-  for (size_t i = 0; i < a.n_elem; i++)
-    sum += pow(fabs(a[i] - b[i]), 3.0);
-
   return pow(accu(pow(abs(a - b), 3.0)), 1.0 / 3.0);
 }
 
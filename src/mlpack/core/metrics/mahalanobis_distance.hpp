@@ -27,8 +27,20 @@ namespace metric {
  *
  * Because each evaluation multiplies (x_1 - x_2) by the covariance matrix, it
  * may be much quicker to use an LMetric and simply stretch the actual dataset
- * itself before performing any evaluations.  However, this class is provided
- * for convenience.
+ * itself before performing any evaluations.  Transform() does that: with
+ * Q = L^T L, the L2 distance between L x and L y is the Mahalanobis distance
+ * between x and y, so a search with this metric (for instance in a tree) can
+ * be run with LMetric<2, TakeRoot> on the transformed dataset instead, at O(d)
+ * per distance instead of O(d^2):
+ *
+ * @code
+ * MahalanobisDistance<> distance(q);
+ * arma::mat transformed;
+ * distance.Transform(dataset, transformed);
+ * AllkNN knn(transformed); // Uses the L2 distance.
+ * @endcode
+ *
+ * However, this class is provided for convenience.
  *
  * Similar to the LMetric class, this offers a template parameter TakeRoot
  * which, when set to false, will instead evaluate the distance
@@ -83,6 +95,30 @@ class MahalanobisDistance
   template<typename VecTypeA, typename VecTypeB>
   double Evaluate(const VecTypeA& a, const VecTypeB& b);
 
+  /**
+   * Compute the matrix L such that L^T L = Q, where Q is the symmetric part of
+   * the covariance matrix (the only part the distance depends on).  A
+   * Cholesky decomposition is used if Q is positive definite; otherwise (for
+   * instance if Q is singular) an eigendecomposition is used, and a warning is
+   * given if Q has negative eigenvalues, which L can't represent.
+   *
+   * @param transformation Matrix to store L in.
+   */
+  void Transformation(arma::mat& transformation) const;
+
+  /**
+   * Transform the given dataset by L, so that the L2 distance between two
+   * transformed points (LMetric<2, TakeRoot>) is the distance this metric
+   * gives for the original points.  Q is factored once, and the transformed
+   * dataset can be used for as many searches as needed.  If the covariance
+   * matrix is not set, the dataset is copied.
+   *
+   * @param dataset Dataset to transform.
+   * @param transformed Matrix to store the transformed dataset in.
+   */
+  template<typename MatType>
+  void Transform(const MatType& dataset, arma::mat& transformed) const;
+
   /**
    * Access the covariance matrix.
    *
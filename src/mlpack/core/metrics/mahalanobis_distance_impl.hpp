@@ -20,9 +20,8 @@ template<typename VecTypeA, typename VecTypeB>
 double MahalanobisDistance<false>::Evaluate(const VecTypeA& a,
                                             const VecTypeB& b)
 {
-  arma::vec m = (a - b);
-  arma::mat out = trans(m) * covariance * m; // 1x1
-  return out[0];
+  const arma::vec m = (a - b);
+  return arma::dot(m, covariance * m);
 }
 /**
  * Specialization for rooted case.  This requires one extra evaluation of
@@ -37,9 +36,64 @@ double MahalanobisDistance<true>::Evaluate(const VecTypeA& a,
   if (covariance.n_rows == 0)
     covariance = arma::eye<arma::mat>(a.n_elem, a.n_elem);
 
-  arma::vec m = (a - b);
-  arma::mat out = trans(m) * covariance * m; // 1x1;
-  return sqrt(out[0]);
+  const arma::vec m = (a - b);
+  return sqrt(arma::dot(m, covariance * m));
+}
+
+template<bool TakeRoot>
+void MahalanobisDistance<TakeRoot>::Transformation(arma::mat& transformation)
+    const
+{
+  // Only the symmetric part of the covariance contributes to the distance.
+  const arma::mat q = 0.5 * (covariance + trans(covariance));
+
+  // Q = R^T R, with R upper triangular.
+  if (arma::chol(transformation, q))
+    return;
+
+  // Q = V diag(lambda) V^T, so L = diag(sqrt(lambda)) V^T.
+  arma::vec eigenvalues;
+  arma::mat eigenvectors;
+  if (!arma::eig_sym(eigenvalues, eigenvectors, q))
+  {
+    Log::Fatal << "MahalanobisDistance::Transformation(): eigendecomposition "
+        << "of the covariance matrix failed." << std::endl;
+  }
+
+  const double tolerance = 1e-10 * std::max(1.0, eigenvalues.max());
+  if (eigenvalues.min() < -tolerance)
+  {
+    Log::Warn << "MahalanobisDistance::Transformation(): the covariance "
+        << "matrix is not positive semidefinite; distances between transformed "
+        << "points will differ." << std::endl;
+  }
+
+  for (size_t i = 0; i < eigenvalues.n_elem; ++i)
+    eigenvalues[i] = (eigenvalues[i] > 0.0) ? std::sqrt(eigenvalues[i]) : 0.0;
+  transformation = arma::diagmat(eigenvalues) * trans(eigenvectors);
+}
+
+template<bool TakeRoot>
+template<typename MatType>
+void MahalanobisDistance<TakeRoot>::Transform(const MatType& dataset,
+                                              arma::mat& transformed) const
+{
+  if (covariance.n_rows == 0)
+  {
+    transformed = dataset;
+    return;
+  }
+
+  if (covariance.n_cols != dataset.n_rows)
+  {
+    Log::Fatal << "MahalanobisDistance::Transform(): dataset has "
+        << dataset.n_rows << " dimensions, but covariance matrix is "
+        << covariance.n_rows << "x" << covariance.n_cols << "!" << std::endl;
+  }
+
+  arma::mat transformation;
+  Transformation(transformation);
+  transformed = transformation * dataset;
 }
 
 // Convert object into string.
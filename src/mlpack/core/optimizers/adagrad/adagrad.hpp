@@ -0,0 +1,151 @@
+/**
+ * @file adagrad.hpp
+ * @author Ryan Curtin
+ *
+ * AdaGrad: stochastic gradient descent with per-parameter step sizes that
+ * shrink with the accumulated squared gradient.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_ADAGRAD_ADAGRAD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_ADAGRAD_ADAGRAD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * AdaGrad is a stochastic optimizer which, like SGD, visits the individual
+ * functions \f$ f_i(A) \f$ of a decomposable function one at a time, but
+ * scales the step of each parameter by the inverse square root of the sum of
+ * all squared gradients seen so far for that parameter:
+ *
+ * \f[
+ * G_j = G_{j - 1} + (\nabla f_i(A_j))^2 \\
+ * A_{j + 1} = A_j - \alpha \frac{\nabla f_i(A_j)}{\sqrt{G_j} + \epsilon}
+ * \f]
+ *
+ * Parameters with large or frequent gradients therefore take smaller steps,
+ * and rarely-updated parameters take larger ones.  The functions are visited
+ * and the algorithm terminates exactly as for SGD.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @article{duchi2011adaptive,
+ *   title={Adaptive Subgradient Methods for Online Learning and Stochastic
+ *       Optimization},
+ *   author={Duchi, J. and Hazan, E. and Singer, Y.},
+ *   journal={Journal of Machine Learning Research},
+ *   volume={12},
+ *   pages={2121--2159},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * The DecomposableFunctionType must implement the same functions as for SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * so it can be used as the OptimizerType of any method that accepts SGD.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class AdaGrad
+{
+ public:
+  /**
+   * Construct the AdaGrad optimizer with the given function and parameters.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each iteration.
+   * @param epsilon Value used to avoid division by zero.
+   * @param maxIterations Maximum number of iterations allowed (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled; otherwise, each
+   *     function is visited in linear order.
+   */
+  AdaGrad(DecomposableFunctionType& function,
+          const double stepSize = 0.01,
+          const double epsilon = 1e-8,
+          const size_t maxIterations = 100000,
+          const double tolerance = 1e-5,
+          const bool shuffle = true);
+
+  /**
+   * Optimize the given function using AdaGrad.  The given starting point will
+   * be modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the value used to avoid division by zero.
+  double Epsilon() const { return epsilon; }
+  //! Modify the value used to avoid division by zero.
+  double& Epsilon() { return epsilon; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The value used to avoid division by zero.
+  double epsilon;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "adagrad_impl.hpp"
+
+#endif
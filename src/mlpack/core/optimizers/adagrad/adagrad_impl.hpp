@@ -0,0 +1,138 @@
+/**
+ * @file adagrad_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the AdaGrad optimizer.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_ADAGRAD_ADAGRAD_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_ADAGRAD_ADAGRAD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "adagrad.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+AdaGrad<DecomposableFunctionType>::AdaGrad(DecomposableFunctionType& function,
+                                           const double stepSize,
+                                           const double epsilon,
+                                           const size_t maxIterations,
+                                           const double tolerance,
+                                           const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    epsilon(epsilon),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double AdaGrad<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  // Find the number of functions to use.
+  const size_t numFunctions = function.NumFunctions();
+
+  // This is used only if shuffle is true.
+  arma::vec visitationOrder;
+  if (shuffle)
+    visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
+        numFunctions));
+
+  // To keep track of where we are and how things are going.
+  size_t currentFunction = 0;
+  double overallObjective = 0;
+  double lastObjective = DBL_MAX;
+
+  // Calculate the first objective function.
+  for (size_t i = 0; i < numFunctions; ++i)
+    overallObjective += function.Evaluate(iterate, i);
+
+  // The sum of the squared gradients of each parameter.
+  arma::mat squaredGradients(iterate.n_rows, iterate.n_cols);
+  squaredGradients.zeros();
+
+  // Now iterate!
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 1; i != maxIterations; ++i, ++currentFunction)
+  {
+    // Is this iteration the start of a sequence?
+    if ((currentFunction % numFunctions) == 0)
+    {
+      // Output current objective function.
+      Log::Info << "AdaGrad: iteration " << i << ", objective "
+          << overallObjective << "." << std::endl;
+
+      if (overallObjective != overallObjective)
+      {
+        Log::Warn << "AdaGrad: converged to " << overallObjective << "; "
+            << "terminating with failure.  Try a smaller step size?"
+            << std::endl;
+        return overallObjective;
+      }
+
+      if (std::abs(lastObjective - overallObjective) < tolerance)
+      {
+        Log::Info << "AdaGrad: minimized within tolerance " << tolerance
+            << "; terminating optimization." << std::endl;
+        return overallObjective;
+      }
+
+      // Reset the counter variables.
+      lastObjective = overallObjective;
+      overallObjective = 0;
+      currentFunction = 0;
+
+      if (shuffle) // Determine order of visitation.
+        visitationOrder = arma::shuffle(visitationOrder);
+    }
+
+    // Evaluate the gradient for this iteration.
+    if (shuffle)
+      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
+    else
+      function.Gradient(iterate, currentFunction, gradient);
+
+    // And update the iterate, with a separate step size for each parameter.
+    squaredGradients += gradient % gradient;
+    iterate -= stepSize * gradient / (arma::sqrt(squaredGradients) + epsilon);
+
+    // Now add that to the overall objective function.
+    if (shuffle)
+      overallObjective += function.Evaluate(iterate,
+          visitationOrder[currentFunction]);
+    else
+      overallObjective += function.Evaluate(iterate, currentFunction);
+  }
+
+  Log::Info << "AdaGrad: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+  // Calculate final objective.
+  overallObjective = 0;
+  for (size_t i = 0; i < numFunctions; ++i)
+    overallObjective += function.Evaluate(iterate, i);
+  return overallObjective;
+}
+
+// Convert the object to a string.
+template<typename DecomposableFunctionType>
+std::string AdaGrad<DecomposableFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "AdaGrad [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Epsilon: " << epsilon << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle points: " << (shuffle ? "true" : "false") << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
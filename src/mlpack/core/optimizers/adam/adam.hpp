@@ -0,0 +1,172 @@
+/**
+ * @file adam.hpp
+ * @author Ryan Curtin
+ *
+ * Adam: stochastic gradient descent with adaptive, per-parameter step sizes
+ * from estimates of the first and second moments of the gradient.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_ADAM_ADAM_HPP
+#define __MLPACK_CORE_OPTIMIZERS_ADAM_ADAM_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Adam is a stochastic optimizer which, like SGD, visits the individual
+ * functions \f$ f_i(A) \f$ of a decomposable function one at a time.  Instead
+ * of a constant step, it keeps exponentially decaying averages of the gradient
+ * \f$ m \f$ and of the squared gradient \f$ v \f$, and scales the step of each
+ * parameter separately:
+ *
+ * \f[
+ * m_j = \beta_1 m_{j - 1} + (1 - \beta_1) \nabla f_i(A_j) \\
+ * v_j = \beta_2 v_{j - 1} + (1 - \beta_2) (\nabla f_i(A_j))^2 \\
+ * A_{j + 1} = A_j - \alpha \frac{\hat{m}_j}{\sqrt{\hat{v}_j} + \epsilon}
+ * \f]
+ *
+ * where \f$ \hat{m}_j \f$ and \f$ \hat{v}_j \f$ are the bias-corrected
+ * averages \f$ m_j / (1 - \beta_1^j) \f$ and \f$ v_j / (1 - \beta_2^j) \f$.
+ * The functions are visited and the algorithm terminates exactly as for SGD.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @inproceedings{kingma2015adam,
+ *   title={Adam: A Method for Stochastic Optimization},
+ *   author={Kingma, D.P. and Ba, J.},
+ *   booktitle={Proceedings of the 3rd International Conference on Learning
+ *       Representations (ICLR '15)},
+ *   year={2015}
+ * }
+ * @endcode
+ *
+ * The DecomposableFunctionType must implement the same functions as for SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * so it can be used as the OptimizerType of any method that accepts SGD.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class Adam
+{
+ public:
+  /**
+   * Construct the Adam optimizer with the given function and parameters.  The
+   * defaults for beta1, beta2 and epsilon are the ones suggested in the paper.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each iteration.
+   * @param beta1 Exponential decay rate of the first moment estimates.
+   * @param beta2 Exponential decay rate of the second moment estimates.
+   * @param epsilon Value used to avoid division by zero.
+   * @param maxIterations Maximum number of iterations allowed (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled; otherwise, each
+   *     function is visited in linear order.
+   */
+  Adam(DecomposableFunctionType& function,
+       const double stepSize = 0.001,
+       const double beta1 = 0.9,
+       const double beta2 = 0.999,
+       const double epsilon = 1e-8,
+       const size_t maxIterations = 100000,
+       const double tolerance = 1e-5,
+       const bool shuffle = true);
+
+  /**
+   * Optimize the given function using Adam.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the decay rate of the first moment estimates.
+  double Beta1() const { return beta1; }
+  //! Modify the decay rate of the first moment estimates.
+  double& Beta1() { return beta1; }
+
+  //! Get the decay rate of the second moment estimates.
+  double Beta2() const { return beta2; }
+  //! Modify the decay rate of the second moment estimates.
+  double& Beta2() { return beta2; }
+
+  //! Get the value used to avoid division by zero.
+  double Epsilon() const { return epsilon; }
+  //! Modify the value used to avoid division by zero.
+  double& Epsilon() { return epsilon; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The exponential decay rate of the first moment estimates.
+  double beta1;
+
+  //! The exponential decay rate of the second moment estimates.
+  double beta2;
+
+  //! The value used to avoid division by zero.
+  double epsilon;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "adam_impl.hpp"
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file adam_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the Adam optimizer.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_ADAM_ADAM_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_ADAM_ADAM_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "adam.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+Adam<DecomposableFunctionType>::Adam(DecomposableFunctionType& function,
+                                     const double stepSize,
+                                     const double beta1,
+                                     const double beta2,
+                                     const double epsilon,
+                                     const size_t maxIterations,
+                                     const double tolerance,
+                                     const bool shuffle) :
+    function(function),
+    stepSize(stepSize),
+    beta1(beta1),
+    beta2(beta2),
+    epsilon(epsilon),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double Adam<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  // Find the number of functions to use.
+  const size_t numFunctions = function.NumFunctions();
+
+  // This is used only if shuffle is true.
+  arma::vec visitationOrder;
+  if (shuffle)
+    visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
+        numFunctions));
+
+  // To keep track of where we are and how things are going.
+  size_t currentFunction = 0;
+  double overallObjective = 0;
+  double lastObjective = DBL_MAX;
+
+  // Calculate the first objective function.
+  for (size_t i = 0; i < numFunctions; ++i)
+    overallObjective += function.Evaluate(iterate, i);
+
+  // The moment estimates, and the powers of beta1 and beta2 used for the bias
+  // correction.
+  arma::mat mean(iterate.n_rows, iterate.n_cols);
+  mean.zeros();
+  arma::mat variance(iterate.n_rows, iterate.n_cols);
+  variance.zeros();
+  double beta1Power = 1.0;
+  double beta2Power = 1.0;
+
+  // Now iterate!
+  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 1; i != maxIterations; ++i, ++currentFunction)
+  {
+    // Is this iteration the start of a sequence?
+    if ((currentFunction % numFunctions) == 0)
+    {
+      // Output current objective function.
+      Log::Info << "Adam: iteration " << i << ", objective " << overallObjective
+          << "." << std::endl;
+
+      if (overallObjective != overallObjective)
+      {
+        Log::Warn << "Adam: converged to " << overallObjective << "; "
+            << "terminating with failure.  Try a smaller step size?"
+            << std::endl;
+        return overallObjective;
+      }
+
+      if (std::abs(lastObjective - overallObjective) < tolerance)
+      {
+        Log::Info << "Adam: minimized within tolerance " << tolerance << "; "
+            << "terminating optimization." << std::endl;
+        return overallObjective;
+      }
+
+      // Reset the counter variables.
+      lastObjective = overallObjective;
+      overallObjective = 0;
+      currentFunction = 0;
+
+      if (shuffle) // Determine order of visitation.
+        visitationOrder = arma::shuffle(visitationOrder);
+    }
+
+    // Evaluate the gradient for this iteration.
+    if (shuffle)
+      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
+    else
+      function.Gradient(iterate, currentFunction, gradient);
+
+    // Update the moment estimates.
+    mean = beta1 * mean + (1 - beta1) * gradient;
+    variance = beta2 * variance + (1 - beta2) * (gradient % gradient);
+    beta1Power *= beta1;
+    beta2Power *= beta2;
+
+    // And update the iterate.  The bias correction of the mean is folded into
+    // the step size; the bias correction of the variance is applied before the
+    // square root, so that epsilon keeps its meaning.
+    iterate -= (stepSize / (1 - beta1Power)) * mean /
+        (arma::sqrt(variance / (1 - beta2Power)) + epsilon);
+
+    // Now add that to the overall objective function.
+    if (shuffle)
+      overallObjective += function.Evaluate(iterate,
+          visitationOrder[currentFunction]);
+    else
+      overallObjective += function.Evaluate(iterate, currentFunction);
+  }
+
+  Log::Info << "Adam: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+  // Calculate final objective.
+  overallObjective = 0;
+  for (size_t i = 0; i < numFunctions; ++i)
+    overallObjective += function.Evaluate(iterate, i);
+  return overallObjective;
+}
+
+// Convert the object to a string.
+template<typename DecomposableFunctionType>
+std::string Adam<DecomposableFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "Adam [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Beta1: " << beta1 << std::endl;
+  convert << "  Beta2: " << beta2 << std::endl;
+  convert << "  Epsilon: " << epsilon << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle points: " << (shuffle ? "true" : "false") << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
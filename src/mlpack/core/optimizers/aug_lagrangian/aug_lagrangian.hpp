@@ -36,7 +36,13 @@ namespace optimization {
  * The number of constraints must be greater than or equal to 0, and
  * EvaluateConstraint() should evaluate the constraint at the given index for
  * the given coordinates.  Evaluate() should provide the objective function
- * value for the given coordinates.
+ * value for the given coordinates.  Optionally,
+ *
+ * - void EvaluateConstraints(const arma::mat& coordinates,
+ *        arma::vec& constraints) const;
+ *
+ * can evaluate all the constraints at once (for instance in parallel); the
+ * constraints are evaluated with it once per iteration of the method.
  *
  * @tparam LagrangianFunction Function which can be optimized by this class.
  */
@@ -118,6 +124,23 @@ class AugLagrangian
   //! Modify the penalty parameter.
   double& Sigma() { return augfunc.Sigma(); }
 
+  /**
+   * Get whether every L-BFGS subproblem after the first starts with the
+   * curvature history of the previous one (instead of from scratch).  The
+   * subproblems only differ in the Lagrange multipliers and the penalty
+   * parameter, so this usually saves many L-BFGS iterations.
+   */
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether the L-BFGS subproblems are warm-started.
+  bool& WarmStart() { return warmStart; }
+
+  /**
+   * Return the violation of the constraints at the given coordinates (the sum
+   * of their squares), without evaluating the objective.
+   */
+  double Penalty(const arma::mat& coordinates) const
+  { return augfunc.Penalty(coordinates); }
+
   // convert the obkect into a string
   std::string ToString() const;
 
@@ -135,6 +158,9 @@ class AugLagrangian
 
   //! The L-BFGS optimizer that we will use.
   L_BFGSType& lbfgs;
+
+  //! Whether to warm-start the L-BFGS subproblems.
+  bool warmStart;
 };
 
 }; // namespace optimization
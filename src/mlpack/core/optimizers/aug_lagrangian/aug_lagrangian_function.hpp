@@ -71,6 +71,44 @@ class AugLagrangianFunction
    */
   void Gradient(const arma::mat& coordinates, arma::mat& gradient) const;
 
+  /**
+   * Evaluate the objective function and the gradient of the Augmented
+   * Lagrangian function together.  Each constraint is only evaluated once,
+   * instead of once for the objective and once more for the gradient; L-BFGS
+   * uses this at every line search trial.
+   *
+   * @param coordinates Coordinates to evaluate function at.
+   * @param gradient Matrix to store gradient into.
+   * @return Objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              arma::mat& gradient) const;
+
+  /**
+   * Evaluate every constraint at the given coordinates.  If the
+   * LagrangianFunction implements
+   *
+   *   void EvaluateConstraints(const arma::mat& coordinates,
+   *                            arma::vec& constraints) const;
+   *
+   * (which may compute them in parallel, or share work between them), that is
+   * used; otherwise EvaluateConstraint() is called for each constraint.
+   *
+   * @param coordinates Coordinates to evaluate the constraints at.
+   * @param constraints Vector to store the value of each constraint into.
+   */
+  void EvaluateConstraints(const arma::mat& coordinates,
+                           arma::vec& constraints) const;
+
+  /**
+   * Return the violation of the constraints at the given coordinates: the sum
+   * of their squares.  This is much cheaper than Evaluate(), which also needs
+   * the objective.
+   *
+   * @param coordinates Coordinates to evaluate the constraints at.
+   */
+  double Penalty(const arma::mat& coordinates) const;
+
   /**
    * Get the initial point of the optimization (supplied by the
    * LagrangianFunction).
@@ -105,6 +143,32 @@ class AugLagrangianFunction
   arma::vec lambda;
   //! The penalty parameter.
   double sigma;
+
+  HAS_MEM_FUNC(EvaluateConstraints, HasEvaluateConstraints)
+
+  //! The signature of a function that evaluates all the constraints at once.
+  typedef void (LagrangianFunction::*EvaluateConstraintsType)(
+      const arma::mat&, arma::vec&) const;
+
+  //! Evaluate the constraints with the EvaluateConstraints() of the function.
+  template<typename F>
+  void FunctionEvaluateConstraints(F& f,
+                                   const arma::mat& coordinates,
+                                   arma::vec& constraints,
+                                   typename boost::enable_if<
+                                       HasEvaluateConstraints<F,
+                                       EvaluateConstraintsType> >::type* = 0)
+      const;
+
+  //! Evaluate the constraints one at a time.
+  template<typename F>
+  void FunctionEvaluateConstraints(F& f,
+                                   const arma::mat& coordinates,
+                                   arma::vec& constraints,
+                                   typename boost::disable_if<
+                                       HasEvaluateConstraints<F,
+                                       EvaluateConstraintsType> >::type* = 0)
+      const;
 };
 
 }; // namespace optimization
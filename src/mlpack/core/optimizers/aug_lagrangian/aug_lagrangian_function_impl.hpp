@@ -87,6 +87,77 @@ void AugLagrangianFunction<LagrangianFunction>::Gradient(
   }
 }
 
+// Evaluate the AugLagrangianFunction and its gradient at the given
+// coordinates.
+template<typename LagrangianFunction>
+double AugLagrangianFunction<LagrangianFunction>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  double objective = function.Evaluate(coordinates);
+  gradient.zeros();
+  function.Gradient(coordinates, gradient);
+
+  arma::mat constraintGradient; // Temporary for constraint gradients.
+  for (size_t i = 0; i < function.NumConstraints(); i++)
+  {
+    const double constraint = function.EvaluateConstraint(i, coordinates);
+
+    objective += (-lambda[i] * constraint) +
+        sigma * std::pow(constraint, 2) / 2;
+
+    function.GradientConstraint(i, coordinates, constraintGradient);
+    gradient += (-lambda[i] + sigma * constraint) * constraintGradient;
+  }
+
+  return objective;
+}
+
+// Evaluate all the constraints at the given coordinates.
+template<typename LagrangianFunction>
+void AugLagrangianFunction<LagrangianFunction>::EvaluateConstraints(
+    const arma::mat& coordinates,
+    arma::vec& constraints) const
+{
+  FunctionEvaluateConstraints(function, coordinates, constraints);
+}
+
+// Compute the sum of the squares of the constraints.
+template<typename LagrangianFunction>
+double AugLagrangianFunction<LagrangianFunction>::Penalty(
+    const arma::mat& coordinates) const
+{
+  arma::vec constraints;
+  EvaluateConstraints(coordinates, constraints);
+  return arma::dot(constraints, constraints);
+}
+
+template<typename LagrangianFunction>
+template<typename F>
+void AugLagrangianFunction<LagrangianFunction>::FunctionEvaluateConstraints(
+    F& f,
+    const arma::mat& coordinates,
+    arma::vec& constraints,
+    typename boost::enable_if<HasEvaluateConstraints<F,
+        EvaluateConstraintsType> >::type*) const
+{
+  f.EvaluateConstraints(coordinates, constraints);
+}
+
+template<typename LagrangianFunction>
+template<typename F>
+void AugLagrangianFunction<LagrangianFunction>::FunctionEvaluateConstraints(
+    F& f,
+    const arma::mat& coordinates,
+    arma::vec& constraints,
+    typename boost::disable_if<HasEvaluateConstraints<F,
+        EvaluateConstraintsType> >::type*) const
+{
+  constraints.set_size(f.NumConstraints());
+  for (size_t i = 0; i < f.NumConstraints(); ++i)
+    constraints[i] = f.EvaluateConstraint(i, coordinates);
+}
+
 // Get the initial point.
 template<typename LagrangianFunction>
 const arma::mat& AugLagrangianFunction<LagrangianFunction>::GetInitialPoint()
@@ -20,7 +20,8 @@ AugLagrangian<LagrangianFunction>::AugLagrangian(LagrangianFunction& function) :
     function(function),
     augfunc(function),
     lbfgsInternal(augfunc),
-    lbfgs(lbfgsInternal)
+    lbfgs(lbfgsInternal),
+    warmStart(true)
 {
   lbfgs.MaxIterations() = 1000;
 }
@@ -31,7 +32,8 @@ AugLagrangian<LagrangianFunction>::AugLagrangian(
     L_BFGSType& lbfgs) :
     function(augfunc.Function()),
     augfunc(augfunc),
-    lbfgs(lbfgs)
+    lbfgs(lbfgs),
+    warmStart(true)
 {
   // Nothing to do.  lbfgsInternal isn't used in this case.
 }
@@ -72,14 +74,19 @@ bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
   // Track the last objective to compare for convergence.
   double lastObjective = function.Evaluate(coordinates);
 
-  // Then, calculate the current penalty.
-  double penalty = 0;
-  for (size_t i = 0; i < function.NumConstraints(); i++)
-    penalty += std::pow(function.EvaluateConstraint(i, coordinates), 2);
+  // Then, calculate the current penalty.  All the constraints are evaluated
+  // at once, and that is used for both the penalty and the update of lambda.
+  arma::vec constraints;
+  augfunc.EvaluateConstraints(coordinates, constraints);
+  double penalty = arma::dot(constraints, constraints);
 
   Log::Debug << "Penalty is " << penalty << " (threshold " << penaltyThreshold
       << ")." << std::endl;
 
+  // The warm start setting of the L-BFGS optimizer is restored at the end.
+  const bool lbfgsWarmStart = lbfgs.WarmStart();
+  bool converged = false;
+
   // The odd comparison allows user to pass maxIterations = 0 (i.e. no limit on
   // number of iterations).
   size_t it;
@@ -88,49 +95,39 @@ bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
     Log::Info << "AugLagrangian on iteration " << it
         << ", starting with objective "  << lastObjective << "." << std::endl;
 
+    // Only the first subproblem starts without curvature history.
+    lbfgs.WarmStart() = warmStart && (it > 0);
     if (!lbfgs.Optimize(coordinates))
       Log::Info << "L-BFGS reported an error during optimization."
           << std::endl;
 
     // Check if we are done with the entire optimization (the threshold we are
     // comparing with is arbitrary).
-    if (std::abs(lastObjective - function.Evaluate(coordinates)) < 1e-10 &&
+    const double objective = function.Evaluate(coordinates);
+    if (std::abs(lastObjective - objective) < 1e-10 &&
         augfunc.Sigma() > 500000)
-      return true;
+    {
+      converged = true;
+      break;
+    }
 
-    lastObjective = function.Evaluate(coordinates);
+    lastObjective = objective;
 
     // Assuming that the optimization has converged to a new set of coordinates,
     // we now update either lambda or sigma.  We update sigma if the penalty
     // term is too high, and we update lambda otherwise.
 
     // First, calculate the current penalty.
-    double penalty = 0;
-    for (size_t i = 0; i < function.NumConstraints(); i++)
-    {
-      penalty += std::pow(function.EvaluateConstraint(i, coordinates), 2);
-//      Log::Debug << "Constraint " << i << " is " <<
-//          function.EvaluateConstraint(i, coordinates) << std::endl;
-    }
+    augfunc.EvaluateConstraints(coordinates, constraints);
+    penalty = arma::dot(constraints, constraints);
 
     Log::Info << "Penalty is " << penalty << " (threshold "
         << penaltyThreshold << ")." << std::endl;
 
-    for (size_t i = 0; i < function.NumConstraints(); ++i)
-    {
-//      arma::mat tmpgrad;
-//      function.GradientConstraint(i, coordinates, tmpgrad);
-//      Log::Debug << "Gradient of constraint " << i << " is " << std::endl;
-//      Log::Debug << tmpgrad << std::endl;
-    }
-
     if (penalty < penaltyThreshold) // We update lambda.
     {
-      // We use the update: lambda_{k + 1} = lambda_k - sigma * c(coordinates),
-      // but we have to write a loop to do this for each constraint.
-      for (size_t i = 0; i < function.NumConstraints(); i++)
-        augfunc.Lambda()[i] -= augfunc.Sigma() *
-            function.EvaluateConstraint(i, coordinates);
+      // We use the update: lambda_{k + 1} = lambda_k - sigma * c(coordinates).
+      augfunc.Lambda() -= augfunc.Sigma() * constraints;
 
       // We also update the penalty threshold to be a factor of the current
       // penalty.  TODO: this factor should be a parameter (from CLI).  The
@@ -148,7 +145,8 @@ bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
     }
   }
 
-  return false;
+  lbfgs.WarmStart() = lbfgsWarmStart;
+  return converged;
 }
 
 }; // namespace optimization
@@ -9,6 +9,7 @@
 #define __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 namespace mlpack {
 namespace optimization {
@@ -24,6 +25,35 @@ namespace optimization {
  *  - double Evaluate(const arma::mat& coordinates);
  *  - void Gradient(const arma::mat& coordinates, arma::mat& gradient);
  *  - arma::mat& GetInitialPoint();
+ *
+ * If the function is also decomposable into a sum of NumFunctions() functions
+ * and implements the batch forms
+ *
+ *  - size_t NumFunctions();
+ *  - double Evaluate(const arma::mat& coordinates,
+ *                    const size_t begin,
+ *                    const size_t batchSize) const;
+ *  - void Gradient(const arma::mat& coordinates,
+ *                  const size_t begin,
+ *                  const size_t batchSize,
+ *                  arma::mat& gradient) const;
+ *
+ * which return the sums over the functions begin, ..., begin + batchSize - 1,
+ * then (when OpenMP is available) each objective and gradient evaluation is
+ * split into one contiguous range of functions per thread, and the partial
+ * results are summed.  The batch forms must then be safe to call from several
+ * threads at once.
+ *
+ * Functions whose objective and gradient share most of their computation can
+ * also implement
+ *
+ *  - double EvaluateWithGradient(const arma::mat& coordinates,
+ *                                arma::mat& gradient);
+ *
+ * (optionally const, and optionally with a batch form taking begin and
+ * batchSize before the gradient), which returns the objective and stores the
+ * gradient.  If it is available it is used instead of separate calls to
+ * Evaluate() and Gradient() at every line search trial.
  */
 template<typename FunctionType>
 class L_BFGS
@@ -145,6 +175,26 @@ class L_BFGS
   //! Modify the maximum line search step size.
   double& MaxStep() { return maxStep; }
 
+  /**
+   * Get whether the curvature history (the last NumBasis() steps and gradient
+   * changes) of the previous call to Optimize() is kept for the next one.
+   * This is useful when a sequence of closely related functions is optimized,
+   * like the subproblems of the augmented Lagrangian method: the next
+   * optimization starts with a good approximation of the Hessian.
+   */
+  bool WarmStart() const { return warmStart; }
+  //! Modify whether the curvature history is kept between optimizations.
+  bool& WarmStart() { return warmStart; }
+
+  //! Get the number of curvature pairs stored so far.
+  size_t BasisPairs() const { return basisPairs; }
+
+  //! Get the number of evaluations of the objective and gradient (this is not
+  //! reset by Optimize()).
+  size_t NumEvaluations() const { return numEvaluations; }
+  //! Modify the number of evaluations of the objective and gradient.
+  size_t& NumEvaluations() { return numEvaluations; }
+
   // convert the obkect into a string
   std::string ToString() const;
 
@@ -177,10 +227,116 @@ class L_BFGS
   double minStep;
   //! Maximum step of the line search.
   double maxStep;
+  //! Number of evaluations of the objective and gradient.
+  size_t numEvaluations;
+  //! Whether to keep the curvature history between optimizations.
+  bool warmStart;
+  //! Number of curvature pairs stored (the last numBasis of them are in s and
+  //! y).
+  size_t basisPairs;
 
   //! Best point found so far.
   std::pair<arma::mat, double> minPointIterate;
 
+  //! Buffers for the recursion of SearchDirection(), kept to avoid allocating
+  //! them every iteration.
+  arma::vec rho;
+  arma::vec alpha;
+
+  HAS_MEM_FUNC(Evaluate, HasBatchEvaluate)
+  HAS_MEM_FUNC(Gradient, HasBatchGradient)
+
+  //! The signature of a batch Evaluate() function.
+  typedef double (FunctionType::*BatchEvaluateType)(const arma::mat&,
+      const size_t, const size_t) const;
+  //! The signature of a batch Gradient() function.
+  typedef void (FunctionType::*BatchGradientType)(const arma::mat&,
+      const size_t, const size_t, arma::mat&) const;
+
+  //! Evaluate the objective, split across threads with the batch Evaluate().
+  template<typename F>
+  double FunctionEvaluate(const F& f,
+                          const arma::mat& iterate,
+                          typename boost::enable_if<HasBatchEvaluate<F,
+                              BatchEvaluateType> >::type* = 0);
+
+  //! Evaluate the objective with a single call to Evaluate().
+  template<typename F>
+  double FunctionEvaluate(F& f,
+                          const arma::mat& iterate,
+                          typename boost::disable_if<HasBatchEvaluate<F,
+                              BatchEvaluateType> >::type* = 0);
+
+  //! Compute the gradient, split across threads with the batch Gradient().
+  template<typename F>
+  void FunctionGradient(const F& f,
+                        const arma::mat& iterate,
+                        arma::mat& gradient,
+                        typename boost::enable_if<HasBatchGradient<F,
+                            BatchGradientType> >::type* = 0);
+
+  //! Compute the gradient with a single call to Gradient().
+  template<typename F>
+  void FunctionGradient(F& f,
+                        const arma::mat& iterate,
+                        arma::mat& gradient,
+                        typename boost::disable_if<HasBatchGradient<F,
+                            BatchGradientType> >::type* = 0);
+
+  HAS_MEM_FUNC(EvaluateWithGradient, HasEvaluateWithGradient)
+
+  //! The signature of a const EvaluateWithGradient() function.
+  typedef double (FunctionType::*EvaluateWithGradientType)(const arma::mat&,
+      arma::mat&) const;
+  //! The signature of a non-const EvaluateWithGradient() function.
+  typedef double (FunctionType::*EvaluateWithGradientNonConstType)(
+      const arma::mat&, arma::mat&);
+  //! The signature of a batch EvaluateWithGradient() function.
+  typedef double (FunctionType::*BatchEvaluateWithGradientType)(
+      const arma::mat&, const size_t, const size_t, arma::mat&) const;
+
+  //! Evaluate the objective and gradient, split across threads with the batch
+  //! EvaluateWithGradient().
+  template<typename F>
+  double FunctionEvaluateWithGradient(
+      F& f,
+      const arma::mat& iterate,
+      arma::mat& gradient,
+      typename boost::enable_if_c<HasEvaluateWithGradient<F,
+          BatchEvaluateWithGradientType>::value>::type* = 0);
+
+  //! Evaluate the objective and gradient with one call to
+  //! EvaluateWithGradient().
+  template<typename F>
+  double FunctionEvaluateWithGradient(
+      F& f,
+      const arma::mat& iterate,
+      arma::mat& gradient,
+      typename boost::enable_if_c<!HasEvaluateWithGradient<F,
+          BatchEvaluateWithGradientType>::value &&
+          (HasEvaluateWithGradient<F, EvaluateWithGradientType>::value ||
+          HasEvaluateWithGradient<F, EvaluateWithGradientNonConstType>::value)
+          >::type* = 0);
+
+  //! Evaluate the objective and gradient with separate calls.
+  template<typename F>
+  double FunctionEvaluateWithGradient(
+      F& f,
+      const arma::mat& iterate,
+      arma::mat& gradient,
+      typename boost::enable_if_c<!HasEvaluateWithGradient<F,
+          BatchEvaluateWithGradientType>::value &&
+          !HasEvaluateWithGradient<F, EvaluateWithGradientType>::value &&
+          !HasEvaluateWithGradient<F, EvaluateWithGradientNonConstType>::value
+          >::type* = 0);
+
+  /**
+   * Return the number of contiguous ranges the functions of a decomposable
+   * objective are split into: one per thread, but no more than the number of
+   * functions.
+   */
+  size_t NumRanges(const size_t numFunctions) const;
+
   /**
    * Evaluate the function at the given iterate point and store the result if it
    * is a new minimum.
@@ -189,6 +345,17 @@ class L_BFGS
    */
   double Evaluate(const arma::mat& iterate);
 
+  /**
+   * Evaluate the function and its gradient at the given iterate point, in one
+   * pass if the function supports it, and store the result if it is a new
+   * minimum.
+   *
+   * @param iterate Point to evaluate the function at.
+   * @param gradient Matrix to store the gradient in.
+   * @return The value of the function.
+   */
+  double EvaluateWithGradient(const arma::mat& iterate, arma::mat& gradient);
+
   /**
    * Calculate the scaling factor, gamma, which is used to scale the Hessian
    * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal
@@ -8,6 +8,10 @@
 #ifndef __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_IMPL_HPP
 #define __MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_IMPL_HPP
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace optimization {
 
@@ -47,7 +51,10 @@ L_BFGS<FunctionType>::L_BFGS(FunctionType& function,
     factr(factr),
     maxLineSearchTrials(maxLineSearchTrials),
     minStep(minStep),
-    maxStep(maxStep)
+    maxStep(maxStep),
+    numEvaluations(0),
+    warmStart(false),
+    basisPairs(0)
 {
   // Get the dimensions of the coordinates of the function; GetInitialPoint()
   // might return an arma::vec, but that's okay because then n_cols will simply
@@ -58,6 +65,8 @@ L_BFGS<FunctionType>::L_BFGS(FunctionType& function,
   newIterateTmp.set_size(rows, cols);
   s.set_size(rows, cols, numBasis);
   y.set_size(rows, cols, numBasis);
+  rho.set_size(numBasis);
+  alpha.set_size(numBasis);
 
   // Allocate the pair holding the min iterate information.
   minPointIterate.first.zeros(rows, cols);
@@ -75,7 +84,7 @@ double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
 {
   // Evaluate the function and keep track of the minimum function
   // value encountered during the optimization.
-  double functionValue = function.Evaluate(iterate);
+  double functionValue = FunctionEvaluate(function, iterate);
 
   if (functionValue < minPointIterate.second)
   {
@@ -86,6 +95,199 @@ double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
   return functionValue;
 }
 
+template<typename FunctionType>
+size_t L_BFGS<FunctionType>::NumRanges(const size_t numFunctions) const
+{
+#ifdef _OPENMP
+  return std::max((size_t) 1, std::min((size_t) omp_get_max_threads(),
+      numFunctions));
+#else
+  return 1;
+#endif
+}
+
+/**
+ * Evaluate a decomposable function by splitting its functions into one
+ * contiguous range per thread and summing the objectives of each range.
+ */
+template<typename FunctionType>
+template<typename F>
+double L_BFGS<FunctionType>::FunctionEvaluate(
+    const F& f,
+    const arma::mat& iterate,
+    typename boost::enable_if<HasBatchEvaluate<F, BatchEvaluateType> >::type*)
+{
+  const size_t numFunctions = f.NumFunctions();
+  const size_t numRanges = NumRanges(numFunctions);
+  if (numRanges == 1)
+    return f.Evaluate(iterate);
+
+  double objective = 0.0;
+  #pragma omp parallel for schedule(static) reduction(+:objective)
+  for (size_t r = 0; r < numRanges; ++r)
+  {
+    const size_t begin = (r * numFunctions) / numRanges;
+    const size_t end = ((r + 1) * numFunctions) / numRanges;
+    objective += f.Evaluate(iterate, begin, end - begin);
+  }
+
+  return objective;
+}
+
+template<typename FunctionType>
+template<typename F>
+double L_BFGS<FunctionType>::FunctionEvaluate(
+    F& f,
+    const arma::mat& iterate,
+    typename boost::disable_if<HasBatchEvaluate<F, BatchEvaluateType> >::type*)
+{
+  return f.Evaluate(iterate);
+}
+
+/**
+ * Compute the gradient of a decomposable function by splitting its functions
+ * into one contiguous range per thread and summing the partial gradients.
+ */
+template<typename FunctionType>
+template<typename F>
+void L_BFGS<FunctionType>::FunctionGradient(
+    const F& f,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    typename boost::enable_if<HasBatchGradient<F, BatchGradientType> >::type*)
+{
+  const size_t numFunctions = f.NumFunctions();
+  const size_t numRanges = NumRanges(numFunctions);
+  if (numRanges == 1)
+  {
+    f.Gradient(iterate, gradient);
+    return;
+  }
+
+  gradient.zeros(iterate.n_rows, iterate.n_cols);
+  #pragma omp parallel
+  {
+    arma::mat partialGradient;
+
+    #pragma omp for schedule(static)
+    for (size_t r = 0; r < numRanges; ++r)
+    {
+      const size_t begin = (r * numFunctions) / numRanges;
+      const size_t end = ((r + 1) * numFunctions) / numRanges;
+      f.Gradient(iterate, begin, end - begin, partialGradient);
+
+      #pragma omp critical(lbfgs_gradient_reduce)
+      gradient += partialGradient;
+    }
+  }
+}
+
+template<typename FunctionType>
+template<typename F>
+void L_BFGS<FunctionType>::FunctionGradient(
+    F& f,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    typename boost::disable_if<HasBatchGradient<F, BatchGradientType> >::type*)
+{
+  f.Gradient(iterate, gradient);
+}
+
+/**
+ * Evaluate the function and gradient at the given iterate point and store the
+ * result if it is a new minimum.
+ *
+ * @return The value of the function
+ */
+template<typename FunctionType>
+double L_BFGS<FunctionType>::EvaluateWithGradient(const arma::mat& iterate,
+                                                  arma::mat& gradient)
+{
+  double functionValue = FunctionEvaluateWithGradient(function, iterate,
+      gradient);
+  ++numEvaluations;
+
+  if (functionValue < minPointIterate.second)
+  {
+    minPointIterate.first = iterate;
+    minPointIterate.second = functionValue;
+  }
+
+  return functionValue;
+}
+
+/**
+ * Evaluate the objective and gradient of a decomposable function with a fused
+ * batch form, one contiguous range of functions per thread.
+ */
+template<typename FunctionType>
+template<typename F>
+double L_BFGS<FunctionType>::FunctionEvaluateWithGradient(
+    F& f,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    typename boost::enable_if_c<HasEvaluateWithGradient<F,
+        BatchEvaluateWithGradientType>::value>::type*)
+{
+  const size_t numFunctions = f.NumFunctions();
+  const size_t numRanges = NumRanges(numFunctions);
+  if (numRanges == 1)
+    return f.EvaluateWithGradient(iterate, 0, numFunctions, gradient);
+
+  double objective = 0.0;
+  gradient.zeros(iterate.n_rows, iterate.n_cols);
+  #pragma omp parallel reduction(+:objective)
+  {
+    arma::mat partialGradient;
+
+    #pragma omp for schedule(static)
+    for (size_t r = 0; r < numRanges; ++r)
+    {
+      const size_t begin = (r * numFunctions) / numRanges;
+      const size_t end = ((r + 1) * numFunctions) / numRanges;
+      objective += f.EvaluateWithGradient(iterate, begin, end - begin,
+          partialGradient);
+
+      #pragma omp critical(lbfgs_gradient_reduce)
+      gradient += partialGradient;
+    }
+  }
+
+  return objective;
+}
+
+template<typename FunctionType>
+template<typename F>
+double L_BFGS<FunctionType>::FunctionEvaluateWithGradient(
+    F& f,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    typename boost::enable_if_c<!HasEvaluateWithGradient<F,
+        BatchEvaluateWithGradientType>::value &&
+        (HasEvaluateWithGradient<F, EvaluateWithGradientType>::value ||
+        HasEvaluateWithGradient<F, EvaluateWithGradientNonConstType>::value)
+        >::type*)
+{
+  return f.EvaluateWithGradient(iterate, gradient);
+}
+
+template<typename FunctionType>
+template<typename F>
+double L_BFGS<FunctionType>::FunctionEvaluateWithGradient(
+    F& f,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    typename boost::enable_if_c<!HasEvaluateWithGradient<F,
+        BatchEvaluateWithGradientType>::value &&
+        !HasEvaluateWithGradient<F, EvaluateWithGradientType>::value &&
+        !HasEvaluateWithGradient<F, EvaluateWithGradientNonConstType>::value
+        >::type*)
+{
+  const double objective = FunctionEvaluate(f, iterate);
+  FunctionGradient(f, iterate, gradient);
+  return objective;
+}
+
 /**
  * Calculate the scaling factor gamma which is used to scale the Hessian
  * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal (1989).
@@ -182,8 +384,7 @@ bool L_BFGS<FunctionType>::LineSearch(double& functionValue,
     // point.
     newIterateTmp = iterate;
     newIterateTmp += stepSize * searchDirection;
-    functionValue = Evaluate(newIterateTmp);
-    function.Gradient(newIterateTmp, gradient);
+    functionValue = EvaluateWithGradient(newIterateTmp, gradient);
     numIterations++;
 
     if (functionValue > initialFunctionValue + stepSize *
@@ -258,12 +459,8 @@ void L_BFGS<FunctionType>::SearchDirection(const arma::mat& gradient,
   searchDirection = gradient;
 
   // See "A Recursive Formula to Compute H * g" in "Updating quasi-Newton
-  // matrices with limited storage" (Nocedal, 1980).
-
-  // Temporary variables.
-  arma::vec rho(numBasis);
-  arma::vec alpha(numBasis);
-
+  // matrices with limited storage" (Nocedal, 1980).  The rho and alpha buffers
+  // are members, so nothing is allocated here.
   size_t limit = (numBasis > iterationNum) ? 0 : (iterationNum - numBasis);
   for (size_t i = iterationNum; i != limit; i--)
   {
@@ -308,11 +505,18 @@ void L_BFGS<FunctionType>::UpdateBasisSet(const size_t iterationNum,
                                           const arma::mat& gradient,
                                           const arma::mat& oldGradient)
 {
+  // A pair without positive curvature (when the line search gave up before
+  // the Wolfe conditions held) would make the Hessian approximation
+  // indefinite, so it is not kept.
+  if (arma::dot(iterate - oldIterate, gradient - oldGradient) <= 0.0)
+    return;
+
   // Overwrite a certain position instead of pushing everything in the vector
   // back one position.
   int overwritePos = iterationNum % numBasis;
   s.slice(overwritePos) = iterate - oldIterate;
   y.slice(overwritePos) = gradient - oldGradient;
+  ++basisPairs;
 }
 
 /**
@@ -352,8 +556,17 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   const size_t rows = function.GetInitialPoint().n_rows;
   const size_t cols = function.GetInitialPoint().n_cols;
 
+  // The curvature pairs of the previous optimization are kept if a warm start
+  // was asked for and they still fit.
+  if (!warmStart || s.n_rows != rows || s.n_cols != cols ||
+      s.n_slices != numBasis)
+    basisPairs = 0;
+
   s.set_size(rows, cols, numBasis);
   y.set_size(rows, cols, numBasis);
+  rho.set_size(numBasis);
+  alpha.set_size(numBasis);
+  newIterateTmp.set_size(rows, cols);
   minPointIterate.second = std::numeric_limits<double>::max();
 
   // The old iterate to be saved.
@@ -364,9 +577,6 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   bool optimizeUntilConvergence = (maxIterations == 0);
 
   // The initial function value.
-  double functionValue = Evaluate(iterate);
-  double prevFunctionValue = functionValue;
-
   // The gradient: the current and the old.
   arma::mat gradient;
   arma::mat oldGradient;
@@ -377,15 +587,16 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
   arma::mat searchDirection;
   searchDirection.zeros(iterate.n_rows, iterate.n_cols);
 
-  // The initial gradient value.
-  function.Gradient(iterate, gradient);
+  // The initial function and gradient values.
+  double functionValue = EvaluateWithGradient(iterate, gradient);
+  double prevFunctionValue = functionValue;
 
   // The main optimization loop.
   for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
        ++itNum)
   {
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
-        function.Evaluate(iterate) << ", gradient norm " <<
+        functionValue << ", gradient norm " <<
         arma::norm(gradient, 2) << ", " <<
         ((prevFunctionValue - functionValue) /
          std::max(std::max(fabs(prevFunctionValue), fabs(functionValue)), 1.0)) << "." << std::endl;
@@ -404,11 +615,11 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
     }
 
     // Choose the scaling factor.
-    double scalingFactor = ChooseScalingFactor(itNum, gradient);
+    double scalingFactor = ChooseScalingFactor(basisPairs, gradient);
 
     // Build an approximation to the Hessian and choose the search
     // direction for the current iteration.
-    SearchDirection(gradient, itNum, scalingFactor, searchDirection);
+    SearchDirection(gradient, basisPairs, scalingFactor, searchDirection);
 
     // Save the old iterate and the gradient before stepping.
     oldIterate = iterate;
@@ -444,11 +655,11 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate,
     }
 
     // Overwrite an old basis set.
-    UpdateBasisSet(itNum, iterate, oldIterate, gradient, oldGradient);
+    UpdateBasisSet(basisPairs, iterate, oldIterate, gradient, oldGradient);
 
   } // End of the optimization loop.
 
-  return function.Evaluate(iterate);
+  return FunctionEvaluate(function, iterate);
 }
 
 // Convert the object to a string.
@@ -191,6 +191,39 @@ void GeneralizedRosenbrockFunction::Gradient(const arma::mat& coordinates,
   gradient[i + 1] = 200 * (coordinates[i + 1] - std::pow(coordinates[i], 2));
 }
 
+//! Calculate the summed objective of a batch of the individual functions.
+double GeneralizedRosenbrockFunction::Evaluate(const arma::mat& coordinates,
+                                               const size_t begin,
+                                               const size_t batchSize) const
+{
+  // Function i only depends on coordinates i and i + 1, so the whole batch is
+  // a vectorized expression on two overlapping slices of the coordinates.
+  const arma::vec x = coordinates.col(0).subvec(begin, begin + batchSize - 1);
+  const arma::vec next = coordinates.col(0).subvec(begin + 1,
+      begin + batchSize);
+
+  return 100 * arma::accu(arma::square(arma::square(x) - next)) +
+      arma::accu(arma::square(1 - x));
+}
+
+//! Calculate the summed gradient of a batch of the individual functions.
+void GeneralizedRosenbrockFunction::Gradient(const arma::mat& coordinates,
+                                             const size_t begin,
+                                             const size_t batchSize,
+                                             arma::mat& gradient) const
+{
+  gradient.zeros(n);
+
+  const arma::vec x = coordinates.col(0).subvec(begin, begin + batchSize - 1);
+  const arma::vec next = coordinates.col(0).subvec(begin + 1,
+      begin + batchSize);
+
+  gradient.col(0).subvec(begin, begin + batchSize - 1) = 400 *
+      (arma::pow(x, 3) - x % next) + 2 * (x - 1);
+  gradient.col(0).subvec(begin + 1, begin + batchSize) += 200 *
+      (next - arma::square(x));
+}
+
 const arma::mat& GeneralizedRosenbrockFunction::GetInitialPoint() const
 {
   return initialPoint;
@@ -99,8 +99,8 @@ class WoodFunction
  *
  * This function can also be used for stochastic gradient descent (SGD) as a
  * decomposable function (DecomposableFunctionType), so there are other
- * overloads of Evaluate() and Gradient() implemented, as well as
- * NumFunctions().
+ * overloads of Evaluate() and Gradient() implemented (for single functions
+ * and for batches of functions), as well as NumFunctions().
  *
  * "An analysis of the behavior of a glass of genetic adaptive systems."
  *   K.A. De Jong.  Ph.D. thesis, University of Michigan, 1975.
@@ -124,6 +124,16 @@ class GeneralizedRosenbrockFunction
                 const size_t i,
                 arma::mat& gradient) const;
 
+  // Batch versions, for mini-batch optimizers: the sums over the individual
+  // functions begin, ..., begin + batchSize - 1.
+  double Evaluate(const arma::mat& coordinates,
+                  const size_t begin,
+                  const size_t batchSize) const;
+  void Gradient(const arma::mat& coordinates,
+                const size_t begin,
+                const size_t batchSize,
+                arma::mat& gradient) const;
+
   const arma::mat& GetInitialPoint() const;
 
  private:
@@ -0,0 +1,232 @@
+/**
+ * @file minibatch_sgd.hpp
+ * @author Ryan Curtin
+ *
+ * Mini-batch stochastic gradient descent, with an optional lock-free
+ * multithreaded (Hogwild!) mode.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Mini-batch stochastic gradient descent is a variant of stochastic gradient
+ * descent (see SGD) that takes a step using the average gradient of a batch of
+ * functions, instead of the gradient of a single function:
+ *
+ * \f[
+ * A_{j + 1} = A_j - \frac{\alpha}{b} \sum_{i \in B_j} \nabla f_i(A_j)
+ * \f]
+ *
+ * where \f$ B_j \f$ is the j'th batch and \f$ b \f$ is the batch size.  The
+ * functions are split into contiguous batches of \f$ b \f$ functions (the last
+ * may be smaller); if shuffle is true, the batches are visited in a random
+ * order in each pass.  The algorithm terminates when the summed objective of a
+ * full pass changes by less than the tolerance, or when the maximum number of
+ * batch steps is reached.
+ *
+ * The DecomposableFunctionType must implement the same functions as for SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * If it also implements the batch forms
+ *
+ *   double Evaluate(const arma::mat& coordinates,
+ *                   const size_t begin,
+ *                   const size_t batchSize) const;
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 const size_t batchSize,
+ *                 arma::mat& gradient) const;
+ *
+ * which return the sum of the objectives (and gradients) of functions begin,
+ * ..., begin + batchSize - 1, those are used instead of one call per function;
+ * this allows a function to use matrix-matrix operations on the whole batch.
+ *
+ * If hogwild is true (and OpenMP is available), the batches of each pass are
+ * processed in parallel, and each thread updates the shared iterate without
+ * any locking, as in
+ *
+ * @code
+ * @inproceedings{recht2011hogwild,
+ *   title={Hogwild!: A lock-free approach to parallelizing stochastic gradient
+ *       descent},
+ *   author={Recht, B. and Re, C. and Wright, S. and Niu, F.},
+ *   booktitle={Advances in Neural Information Processing Systems 24},
+ *   pages={693--701},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * Only the nonzero elements of each gradient are written, so when gradients
+ * are sparse (each function touches few parameters) threads rarely conflict.
+ * The Gradient() and Evaluate() functions must then be safe to call from
+ * several threads at once.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class MiniBatchSGD
+{
+ public:
+  /**
+   * Construct the mini-batch SGD optimizer with the given function and
+   * parameters.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param batchSize Number of functions in each batch.
+   * @param stepSize Step size for each batch.
+   * @param maxIterations Maximum number of batch steps allowed (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the batch order is shuffled; otherwise, each batch
+   *     is visited in linear order.
+   * @param hogwild If true, process batches in parallel with lock-free
+   *     updates.
+   */
+  MiniBatchSGD(DecomposableFunctionType& function,
+               const size_t batchSize = 32,
+               const double stepSize = 0.01,
+               const size_t maxIterations = 100000,
+               const double tolerance = 1e-5,
+               const bool shuffle = true,
+               const bool hogwild = false);
+
+  /**
+   * Optimize the given function using mini-batch stochastic gradient descent.
+   * The given starting point will be modified to store the finishing point of
+   * the algorithm, and the final objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of batch steps (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of batch steps (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the batches are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the batches are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  //! Get whether or not lock-free parallel updates are used.
+  bool Hogwild() const { return hogwild; }
+  //! Modify whether or not lock-free parallel updates are used.
+  bool& Hogwild() { return hogwild; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  HAS_MEM_FUNC(Evaluate, HasBatchEvaluate)
+  HAS_MEM_FUNC(Gradient, HasBatchGradient)
+
+  //! The signature of a batch Evaluate() function.
+  typedef double (DecomposableFunctionType::*BatchEvaluateType)(
+      const arma::mat&, const size_t, const size_t) const;
+  //! The signature of a batch Gradient() function.
+  typedef void (DecomposableFunctionType::*BatchGradientType)(
+      const arma::mat&, const size_t, const size_t, arma::mat&) const;
+
+  //! Evaluate the summed objective of a batch with the batch Evaluate().
+  template<typename FunctionType>
+  double EvaluateBatch(const FunctionType& f,
+                       const arma::mat& iterate,
+                       const size_t begin,
+                       const size_t count,
+                       typename boost::enable_if<HasBatchEvaluate<FunctionType,
+                           BatchEvaluateType> >::type* = 0) const;
+
+  //! Evaluate the summed objective of a batch one function at a time.
+  template<typename FunctionType>
+  double EvaluateBatch(const FunctionType& f,
+                       const arma::mat& iterate,
+                       const size_t begin,
+                       const size_t count,
+                       typename boost::disable_if<HasBatchEvaluate<FunctionType,
+                           BatchEvaluateType> >::type* = 0) const;
+
+  //! Compute the summed gradient of a batch with the batch Gradient().
+  template<typename FunctionType>
+  void GradientBatch(const FunctionType& f,
+                     const arma::mat& iterate,
+                     const size_t begin,
+                     const size_t count,
+                     arma::mat& gradient,
+                     arma::mat& scratch,
+                     typename boost::enable_if<HasBatchGradient<FunctionType,
+                         BatchGradientType> >::type* = 0) const;
+
+  //! Compute the summed gradient of a batch one function at a time.
+  template<typename FunctionType>
+  void GradientBatch(const FunctionType& f,
+                     const arma::mat& iterate,
+                     const size_t begin,
+                     const size_t count,
+                     arma::mat& gradient,
+                     arma::mat& scratch,
+                     typename boost::disable_if<HasBatchGradient<FunctionType,
+                         BatchGradientType> >::type* = 0) const;
+
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The number of functions in each batch.
+  size_t batchSize;
+
+  //! The step size for each batch.
+  double stepSize;
+
+  //! The maximum number of allowed batch steps.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the batches are shuffled when iterating.
+  bool shuffle;
+
+  //! Controls whether or not batches are processed in parallel without locks.
+  bool hogwild;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "minibatch_sgd_impl.hpp"
+
+#endif
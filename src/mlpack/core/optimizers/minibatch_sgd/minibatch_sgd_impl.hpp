@@ -0,0 +1,251 @@
+/**
+ * @file minibatch_sgd_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of mini-batch stochastic gradient descent.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_IMPL_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "minibatch_sgd.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+MiniBatchSGD<DecomposableFunctionType>::MiniBatchSGD(
+    DecomposableFunctionType& function,
+    const size_t batchSize,
+    const double stepSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle,
+    const bool hogwild) :
+    function(function),
+    batchSize(batchSize),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle),
+    hogwild(hogwild)
+{ /* Nothing to do. */ }
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double MiniBatchSGD<DecomposableFunctionType>::EvaluateBatch(
+    const FunctionType& f,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t count,
+    typename boost::enable_if<HasBatchEvaluate<FunctionType,
+        BatchEvaluateType> >::type*) const
+{
+  return f.Evaluate(iterate, begin, count);
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double MiniBatchSGD<DecomposableFunctionType>::EvaluateBatch(
+    const FunctionType& f,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t count,
+    typename boost::disable_if<HasBatchEvaluate<FunctionType,
+        BatchEvaluateType> >::type*) const
+{
+  double objective = 0.0;
+  for (size_t i = begin; i < begin + count; ++i)
+    objective += f.Evaluate(iterate, i);
+  return objective;
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+void MiniBatchSGD<DecomposableFunctionType>::GradientBatch(
+    const FunctionType& f,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t count,
+    arma::mat& gradient,
+    arma::mat& /* scratch */,
+    typename boost::enable_if<HasBatchGradient<FunctionType,
+        BatchGradientType> >::type*) const
+{
+  f.Gradient(iterate, begin, count, gradient);
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+void MiniBatchSGD<DecomposableFunctionType>::GradientBatch(
+    const FunctionType& f,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t count,
+    arma::mat& gradient,
+    arma::mat& scratch,
+    typename boost::disable_if<HasBatchGradient<FunctionType,
+        BatchGradientType> >::type*) const
+{
+  f.Gradient(iterate, begin, gradient);
+  for (size_t i = begin + 1; i < begin + count; ++i)
+  {
+    f.Gradient(iterate, i, scratch);
+    gradient += scratch;
+  }
+}
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double MiniBatchSGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
+{
+  if (batchSize == 0)
+  {
+    Log::Fatal << "MiniBatchSGD::Optimize(): batch size must be greater than "
+        << "0!" << std::endl;
+  }
+
+  // Find the number of functions and batches to use.
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBatches = (numFunctions + batchSize - 1) / batchSize;
+
+  // The order in which batches are visited.
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t> >(0,
+      numBatches - 1, numBatches);
+
+  // To keep track of how things are going.
+  double overallObjective = 0;
+  double lastObjective = DBL_MAX;
+
+  // Calculate the first objective function.
+  for (size_t b = 0; b < numBatches; ++b)
+  {
+    const size_t begin = b * batchSize;
+    overallObjective += EvaluateBatch(function, iterate, begin,
+        std::min(batchSize, numFunctions - begin));
+  }
+
+  size_t iteration = 0;
+  while (true)
+  {
+    // Output current objective function.
+    Log::Info << "MiniBatchSGD: iteration " << iteration << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (overallObjective != overallObjective)
+    {
+      Log::Warn << "MiniBatchSGD: converged to " << overallObjective << "; "
+          << "terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "MiniBatchSGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    // The number of batch steps we can take in this pass.
+    size_t passBatches = numBatches;
+    if (maxIterations != 0)
+    {
+      if (iteration >= maxIterations)
+        break;
+      passBatches = std::min(numBatches, maxIterations - iteration);
+    }
+
+    lastObjective = overallObjective;
+    overallObjective = 0;
+
+    if (shuffle) // Determine order of visitation.
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    if (hogwild)
+    {
+      // Each thread takes batches and writes its updates straight into the
+      // shared iterate, without any synchronization.
+      #pragma omp parallel reduction(+:overallObjective)
+      {
+        arma::mat gradient(iterate.n_rows, iterate.n_cols);
+        arma::mat scratch(iterate.n_rows, iterate.n_cols);
+
+        #pragma omp for schedule(dynamic)
+        for (size_t j = 0; j < passBatches; ++j)
+        {
+          const size_t begin = visitationOrder[j] * batchSize;
+          const size_t count = std::min(batchSize, numFunctions - begin);
+
+          GradientBatch(function, iterate, begin, count, gradient, scratch);
+
+          // Only touch the parameters this batch actually changes.
+          const double scale = stepSize / count;
+          for (size_t k = 0; k < gradient.n_elem; ++k)
+            if (gradient[k] != 0.0)
+              iterate[k] -= scale * gradient[k];
+
+          overallObjective += EvaluateBatch(function, iterate, begin, count);
+        }
+      }
+    }
+    else
+    {
+      arma::mat gradient(iterate.n_rows, iterate.n_cols);
+      arma::mat scratch(iterate.n_rows, iterate.n_cols);
+
+      for (size_t j = 0; j < passBatches; ++j)
+      {
+        const size_t begin = visitationOrder[j] * batchSize;
+        const size_t count = std::min(batchSize, numFunctions - begin);
+
+        // Evaluate the gradient for this batch and update the iterate.
+        GradientBatch(function, iterate, begin, count, gradient, scratch);
+        iterate -= (stepSize / count) * gradient;
+
+        // Now add that to the overall objective function.
+        overallObjective += EvaluateBatch(function, iterate, begin, count);
+      }
+    }
+
+    iteration += passBatches;
+    if (passBatches < numBatches)
+      break; // We ran out of iterations in the middle of a pass.
+  }
+
+  Log::Info << "MiniBatchSGD: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+
+  // Calculate final objective.
+  overallObjective = 0;
+  for (size_t b = 0; b < numBatches; ++b)
+  {
+    const size_t begin = b * batchSize;
+    overallObjective += EvaluateBatch(function, iterate, begin,
+        std::min(batchSize, numFunctions - begin));
+  }
+  return overallObjective;
+}
+
+// Convert the object to a string.
+template<typename DecomposableFunctionType>
+std::string MiniBatchSGD<DecomposableFunctionType>::ToString() const
+{
+  std::ostringstream convert;
+  convert << "MiniBatchSGD [" << this << "]" << std::endl;
+  convert << "  Function:" << std::endl;
+  convert << util::Indent(function.ToString(), 2);
+  convert << "  Batch size: " << batchSize << std::endl;
+  convert << "  Step size: " << stepSize << std::endl;
+  convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Shuffle batches: " << (shuffle ? "true" : "false")
+      << std::endl;
+  convert << "  Hogwild: " << (hogwild ? "true" : "false") << std::endl;
+  return convert.str();
+}
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file momentum_sgd.hpp
+ * @author Ryan Curtin
+ *
+ * Stochastic gradient descent with momentum.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_MOMENTUM_SGD_MOMENTUM_SGD_HPP
+#define __MLPACK_CORE_OPTIMIZERS_MOMENTUM_SGD_MOMENTUM_SGD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Momentum SGD is a variant of stochastic gradient descent (see SGD) in which
+ * each step keeps a fraction of the previous step, so that consistent
+ * gradient directions accelerate and oscillating directions damp out:
+ *
+ * \f[
+ * V_{j + 1} = \mu V_j - \alpha \nabla f_i(A_j) \\
+ * A_{j + 1} = A_j + V_{j + 1}
+ * \f]
+ *
+ * where \f$ \alpha \f$ is the step size and \f$ \mu \f$ is the momentum.  With
+ * a momentum of 0 this is exactly SGD.  The functions are visited and the
+ * algorithm terminates exactly as for SGD.
+ *
+ * The DecomposableFunctionType must implement the same functions as for SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * so it can be used as the OptimizerType of any method that accepts SGD.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class MomentumSGD
+{
+ public:
+  /**
+   * Construct the momentum SGD optimizer with the given function and
+   * parameters.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each iteration.
+   * @param momentum Fraction of the previous step kept in each step; should be
+   *     in [0, 1).
+   * @param maxIterations Maximum number of iterations allowed (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled; otherwise, each
+   *     function is visited in linear order.
+   */
+  MomentumSGD(DecomposableFunctionType& function,
+              const double stepSize = 0.01,
+              const double momentum = 0.5,
+              const size_t maxIterations = 100000,
+              const double tolerance = 1e-5,
+              const bool shuffle = true);
+
+  /**
+   * Optimize the given function using stochastic gradient descent with
+   * momentum.  The given starting point will be modified to store the
+   * finishing point of the algorithm, and the final objective value is
+   * returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate);
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the momentum.
+  double Momentum() const { return momentum; }
+  //! Modify the momentum.
+  double& Momentum() { return momentum; }
+
+  //! Get the maximum number of iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  // Convert the object into a string.
+  std::string ToString() const;
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The fraction of the previous step kept in each step.
+  double momentum;
+
+  //! The maximum number of allowed iterations.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+// Include implementation.
+#include "momentum_sgd_impl.hpp"
+
+#endif
@@ -8,6 +8,9 @@
 #define __MLPACK_CORE_OPTIMIZERS_SA_SA_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+#include <random>
 
 #include "exponential_schedule.hpp"
 
@@ -50,6 +53,28 @@ namespace optimization {
  * which returns the next temperature given current temperature and the value
  * of the function being optimized.
  *
+ * If the function can compute the change of the objective caused by changing a
+ * single coordinate faster than the whole objective, it can also implement
+ *
+ *   double EvaluateMove(const arma::mat& coordinates,
+ *                       const size_t index,
+ *                       const double oldValue,
+ *                       const double oldObjective) const;
+ *
+ * which returns the objective at coordinates, given that coordinates[index]
+ * was oldValue before the move, where the objective was oldObjective; every
+ * move is then evaluated with it instead of Evaluate().
+ *
+ * With Chains() greater than one, the optimizer runs parallel tempering: that
+ * many chains run in parallel, at temperatures that grow by a factor of
+ * TemperatureRatio() from one chain to the next, and every ExchangeSweeps()
+ * sweeps the states of neighbouring chains are swapped with the replica
+ * exchange criterion.  Hot chains cross barriers that the cold ones cannot,
+ * and pass their states down.  All the temperatures are cooled with the
+ * schedule, and the best final state of the chains is returned.  In that mode
+ * Evaluate() (and EvaluateMove()) are called from several threads at once, so
+ * they must be safe to call concurrently.
+ *
  * @tparam FunctionType objective function type to be minimized.
  * @tparam CoolingScheduleType type for cooling schedule
  */
@@ -148,6 +173,21 @@ class SA
   //! Modify move size of each parameter.
   arma::mat& MoveSize() { return moveSize; }
 
+  //! Get the number of chains (1 for plain simulated annealing).
+  size_t Chains() const { return chains; }
+  //! Modify the number of chains (1 for plain simulated annealing).
+  size_t& Chains() { return chains; }
+
+  //! Get the number of sweeps between replica exchanges.
+  size_t ExchangeSweeps() const { return exchangeSweeps; }
+  //! Modify the number of sweeps between replica exchanges.
+  size_t& ExchangeSweeps() { return exchangeSweeps; }
+
+  //! Get the ratio between the temperatures of neighbouring chains.
+  double TemperatureRatio() const { return temperatureRatio; }
+  //! Modify the ratio between the temperatures of neighbouring chains.
+  double& TemperatureRatio() { return temperatureRatio; }
+
   //! Return a string representation of this object.
   std::string ToString() const;
  private:
@@ -174,6 +214,46 @@ class SA
   arma::mat maxMove;
   //! Move size of each parameter.
   arma::mat moveSize;
+  //! Number of chains.
+  size_t chains;
+  //! Number of sweeps between replica exchanges.
+  size_t exchangeSweeps;
+  //! Ratio between the temperatures of neighbouring chains.
+  double temperatureRatio;
+
+  HAS_MEM_FUNC(EvaluateMove, HasEvaluateMove)
+
+  //! The signature of an incremental EvaluateMove() function.
+  typedef double (FunctionType::*EvaluateMoveType)(const arma::mat&,
+      const size_t, const double, const double) const;
+
+  //! Evaluate a move with the incremental EvaluateMove() of the function.
+  template<typename F>
+  double EvaluateMove(F& f,
+                      const arma::mat& iterate,
+                      const size_t idx,
+                      const double oldValue,
+                      const double oldEnergy,
+                      typename boost::enable_if<HasEvaluateMove<F,
+                          EvaluateMoveType> >::type* = 0);
+
+  //! Evaluate a move with Evaluate(), when there is no EvaluateMove().
+  template<typename F>
+  double EvaluateMove(F& f,
+                      const arma::mat& iterate,
+                      const size_t idx,
+                      const double oldValue,
+                      const double oldEnergy,
+                      typename boost::disable_if<HasEvaluateMove<F,
+                          EvaluateMoveType> >::type* = 0);
+
+  /**
+   * Optimize with parallel tempering, when there is more than one chain.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double OptimizeChains(arma::mat& iterate);
 
   /**
    * GenerateMove proposes a move on element iterate(idx), and determines if
@@ -185,16 +265,22 @@ class SA
    *
    * @param iterate Current optimization position.
    * @param accept Matrix representing which parameters have had accepted moves.
+   * @param moveSize Move size of each parameter.
+   * @param temperature Current temperature.
    * @param energy Current energy of the system.
    * @param idx Current parameter to modify.
    * @param sweepCounter Current counter representing how many sweeps have been
    *      completed.
+   * @param generator Random number generator of the chain.
    */
   void GenerateMove(arma::mat& iterate,
                     arma::mat& accept,
+                    arma::mat& moveSize,
+                    const double temperature,
                     double& energy,
                     size_t& idx,
-                    size_t& sweepCounter);
+                    size_t& sweepCounter,
+                    std::mt19937& generator);
 
   /**
    * MoveControl() uses a proportional feedback control to determine the size
@@ -213,8 +299,11 @@ class SA
    *
    * @param nMoves Number of moves since last call.
    * @param accept Matrix representing which parameters have had accepted moves.
+   * @param moveSize Move size of each parameter.
    */
-  void MoveControl(const size_t nMoves, arma::mat& accept);
+  void MoveControl(const size_t nMoves,
+                   arma::mat& accept,
+                   arma::mat& moveSize) const;
 };
 
 }; // namespace optimization
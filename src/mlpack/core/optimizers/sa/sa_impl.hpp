@@ -9,6 +9,8 @@
 
 #include <mlpack/core/dists/laplace_distribution.hpp>
 
+#include <vector>
+
 namespace mlpack {
 namespace optimization {
 
@@ -36,7 +38,10 @@ SA<FunctionType, CoolingScheduleType>::SA(
     moveCtrlSweep(moveCtrlSweep),
     tolerance(tolerance),
     maxToleranceSweep(maxToleranceSweep),
-    gain(gain)
+    gain(gain),
+    chains(1),
+    exchangeSweeps(10),
+    temperatureRatio(2.0)
 {
   const size_t rows = function.GetInitialPoint().n_rows;
   const size_t cols = function.GetInitialPoint().n_cols;
@@ -57,10 +62,13 @@ double SA<FunctionType, CoolingScheduleType>::Optimize(arma::mat &iterate)
   const size_t rows = function.GetInitialPoint().n_rows;
   const size_t cols = function.GetInitialPoint().n_cols;
 
+  math::RandomSeed(std::time(NULL));
+  if (chains > 1)
+    return OptimizeChains(iterate);
+
   size_t frozenCount = 0;
   double energy = function.Evaluate(iterate);
   double oldEnergy = energy;
-  math::RandomSeed(std::time(NULL));
 
   size_t idx = 0;
   size_t sweepCounter = 0;
@@ -70,13 +78,15 @@ double SA<FunctionType, CoolingScheduleType>::Optimize(arma::mat &iterate)
 
   // Initial moves to get rid of dependency of initial states.
   for (size_t i = 0; i < initMoves; ++i)
-    GenerateMove(iterate, accept, energy, idx, sweepCounter);
+    GenerateMove(iterate, accept, moveSize, temperature, energy, idx,
+        sweepCounter, math::randGen);
 
   // Iterating and cooling.
   for (size_t i = 0; i != maxIterations; ++i)
   {
     oldEnergy = energy;
-    GenerateMove(iterate, accept, energy, idx, sweepCounter);
+    GenerateMove(iterate, accept, moveSize, temperature, energy, idx,
+        sweepCounter, math::randGen);
     temperature = coolingSchedule.NextTemperature(temperature, energy);
 
     // Determine if the optimization has entered (or continues to be in) a
@@ -101,6 +111,157 @@ double SA<FunctionType, CoolingScheduleType>::Optimize(arma::mat &iterate)
   return energy;
 }
 
+//! Optimize the function (minimize) with parallel tempering.
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+double SA<FunctionType, CoolingScheduleType>::OptimizeChains(
+    arma::mat& iterate)
+{
+  // Chain 0 is the coldest.  The temperature and the move sizes belong to the
+  // position in the ladder; the states travel between positions when they are
+  // exchanged.
+  std::vector<arma::mat> iterates(chains, iterate);
+  std::vector<arma::mat> accepts(chains,
+      arma::zeros<arma::mat>(iterate.n_rows, iterate.n_cols));
+  std::vector<arma::mat> moveSizes(chains, moveSize);
+  std::vector<double> energies(chains, function.Evaluate(iterate));
+  std::vector<double> temperatures(chains);
+  std::vector<size_t> idxs(chains, 0);
+  std::vector<size_t> sweepCounters(chains, 0);
+  std::vector<size_t> frozenCounts(chains, 0);
+  std::vector<std::mt19937> generators(chains);
+  for (size_t c = 0; c < chains; ++c)
+  {
+    temperatures[c] = temperature * std::pow(temperatureRatio, (double) c);
+    generators[c].seed(math::randGen());
+  }
+
+  // Initial moves to get rid of dependency of initial states.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t c = 0; c < chains; ++c)
+    for (size_t i = 0; i < initMoves; ++i)
+      GenerateMove(iterates[c], accepts[c], moveSizes[c], temperatures[c],
+          energies[c], idxs[c], sweepCounters[c], generators[c]);
+
+  const size_t frozenMoves = maxToleranceSweep * moveCtrlSweep *
+      iterate.n_elem;
+  const size_t segmentMoves = std::max(exchangeSweeps, (size_t) 1) *
+      iterate.n_elem;
+
+  size_t iterations = 0;
+  size_t exchanges = 0;
+  bool frozen = false;
+  while (!frozen && (maxIterations == 0 || iterations < maxIterations))
+  {
+    const size_t moves = (maxIterations == 0) ? segmentMoves :
+        std::min(segmentMoves, maxIterations - iterations);
+
+    // The chains are independent between exchanges.
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < chains; ++c)
+    {
+      for (size_t i = 0; i < moves; ++i)
+      {
+        const double oldEnergy = energies[c];
+        GenerateMove(iterates[c], accepts[c], moveSizes[c], temperatures[c],
+            energies[c], idxs[c], sweepCounters[c], generators[c]);
+
+        if (std::abs(energies[c] - oldEnergy) < tolerance)
+          ++frozenCounts[c];
+        else
+          frozenCounts[c] = 0;
+      }
+    }
+
+    // The cooling schedule is shared, so the temperatures are cooled here, by
+    // as many steps as moves were made.
+    for (size_t c = 0; c < chains; ++c)
+      for (size_t i = 0; i < moves; ++i)
+        temperatures[c] = coolingSchedule.NextTemperature(temperatures[c],
+            energies[c]);
+    iterations += moves;
+
+    // Replica exchange between neighbouring chains, alternating between the
+    // even and the odd pairs.  The states of chains c and c + 1 are swapped
+    // with probability
+    //   min{1, exp((1 / T_c - 1 / T_(c + 1)) (E_c - E_(c + 1)))}.
+    for (size_t c = (exchanges % 2); c + 1 < chains; c += 2)
+    {
+      const double delta = (1.0 / temperatures[c] - 1.0 /
+          temperatures[c + 1]) * (energies[c] - energies[c + 1]);
+      if (delta >= 0.0 || math::Random() < std::exp(delta))
+      {
+        iterates[c].swap(iterates[c + 1]);
+        std::swap(energies[c], energies[c + 1]);
+        std::swap(frozenCounts[c], frozenCounts[c + 1]);
+      }
+    }
+    ++exchanges;
+
+    // Terminate when the coldest chain is frozen.
+    if (frozenCounts[0] >= frozenMoves)
+    {
+      Log::Debug << "SA: coldest of " << chains << " chains minimized within "
+          << "tolerance " << tolerance << " for " << maxToleranceSweep
+          << " sweeps after " << iterations << " iterations; terminating "
+          << "optimization." << std::endl;
+      frozen = true;
+    }
+  }
+
+  if (!frozen)
+  {
+    Log::Debug << "SA: maximum iterations (" << maxIterations << ") reached; "
+        << "terminating optimization." << std::endl;
+  }
+
+  size_t best = 0;
+  for (size_t c = 1; c < chains; ++c)
+    if (energies[c] < energies[best])
+      best = c;
+
+  iterate = iterates[best];
+  temperature = temperatures[0];
+  moveSize = moveSizes[0];
+  return energies[best];
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+template<typename F>
+double SA<FunctionType, CoolingScheduleType>::EvaluateMove(
+    F& f,
+    const arma::mat& iterate,
+    const size_t idx,
+    const double oldValue,
+    const double oldEnergy,
+    typename boost::enable_if<HasEvaluateMove<F,
+        EvaluateMoveType> >::type*)
+{
+  return f.EvaluateMove(iterate, idx, oldValue, oldEnergy);
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+template<typename F>
+double SA<FunctionType, CoolingScheduleType>::EvaluateMove(
+    F& f,
+    const arma::mat& iterate,
+    const size_t /* idx */,
+    const double /* oldValue */,
+    const double /* oldEnergy */,
+    typename boost::disable_if<HasEvaluateMove<F,
+        EvaluateMoveType> >::type*)
+{
+  return f.Evaluate(iterate);
+}
+
 /**
  * GenerateMove proposes a move on element iterate(idx), and determines
  * it that move is acceptable or not according to the Metropolis criterion.
@@ -116,10 +277,15 @@ template<
 void SA<FunctionType, CoolingScheduleType>::GenerateMove(
     arma::mat& iterate,
     arma::mat& accept,
+    arma::mat& moveSize,
+    const double temperature,
     double& energy,
     size_t& idx,
-    size_t& sweepCounter)
+    size_t& sweepCounter,
+    std::mt19937& generator)
 {
+  std::uniform_real_distribution<> uniform;
+
   const double prevEnergy = energy;
   const double prevValue = iterate(idx);
 
@@ -128,15 +294,15 @@ void SA<FunctionType, CoolingScheduleType>::GenerateMove(
   // MoveControl() is derived for the Laplace distribution.
 
   // Sample from a Laplace distribution with scale parameter moveSize(idx).
-  const double unif = 2.0 * math::Random() - 1.0;
+  const double unif = 2.0 * uniform(generator) - 1.0;
   const double move = (unif < 0) ? (moveSize(idx) * std::log(1 + unif)) :
       (-moveSize(idx) * std::log(1 - unif));
 
   iterate(idx) += move;
-  energy = function.Evaluate(iterate);
+  energy = EvaluateMove(function, iterate, idx, prevValue, prevEnergy);
   // According to the Metropolis criterion, accept the move with probability
   // min{1, exp(-(E_new - E_old) / T)}.
-  const double xi = math::Random();
+  const double xi = uniform(generator);
   const double delta = energy - prevEnergy;
   const double criterion = std::exp(-delta / temperature);
   if (delta <= 0. || criterion > xi)
@@ -158,7 +324,7 @@ void SA<FunctionType, CoolingScheduleType>::GenerateMove(
 
   if (sweepCounter == moveCtrlSweep) // Do MoveControl().
   {
-    MoveControl(moveCtrlSweep, accept);
+    MoveControl(moveCtrlSweep, accept, moveSize);
     sweepCounter = 0;
   }
 }
@@ -181,8 +347,10 @@ template<
     typename FunctionType,
     typename CoolingScheduleType
 >
-void SA<FunctionType, CoolingScheduleType>::MoveControl(const size_t nMoves,
-                                                        arma::mat& accept)
+void SA<FunctionType, CoolingScheduleType>::MoveControl(
+    const size_t nMoves,
+    arma::mat& accept,
+    arma::mat& moveSize) const
 {
   arma::mat target;
   target.copy_size(accept);
@@ -220,6 +388,12 @@ ToString() const
       << std::endl;
   convert << "  Move control gain: " << gain << std::endl;
   convert << "  Maximum iterations: " << maxIterations << std::endl;
+  convert << "  Chains: " << chains << std::endl;
+  if (chains > 1)
+  {
+    convert << "  Sweeps between exchanges: " << exchangeSweeps << std::endl;
+    convert << "  Temperature ratio: " << temperatureRatio << std::endl;
+  }
   return convert.str();
 }
 
@@ -0,0 +1,218 @@
+/**
+ * @file lrsdp_constraints.hpp
+ * @author Ryan Curtin
+ *
+ * Evaluation of the constraints of an LRSDP, Tr(A_i (R R^T)), without forming
+ * R R^T, for each of the kinds of constraint matrices an SDP can hold.
+ */
+#ifndef __MLPACK_CORE_OPTIMIZERS_SDP_LRSDP_CONSTRAINTS_HPP
+#define __MLPACK_CORE_OPTIMIZERS_SDP_LRSDP_CONSTRAINTS_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The evaluation of Tr(A (R R^T)) and of A R for one kind of constraint matrix,
+ * where R is the n x r coordinates matrix of the LRSDP.  Each specialization
+ * provides
+ *
+ * @code
+ * // Tr(A (R R^T)).
+ * static double Trace(const MatrixType& a, const arma::mat& coordinates);
+ *
+ * // Tr(A (R R^T)), from the transposed coordinates R^T.
+ * static double Trace(const MatrixType& a,
+ *                     const arma::mat& rt,
+ *                     arma::mat& workspace);
+ *
+ * // Add weight * (A R)^T to the transposed gradient, after Trace() was called
+ * // with the same workspace.
+ * static void AddProduct(arma::mat& gradientT,
+ *                        const MatrixType& a,
+ *                        const arma::mat& rt,
+ *                        const arma::mat& workspace,
+ *                        const double weight);
+ * @endcode
+ *
+ * The transposed versions are the ones the augmented Lagrangian uses for every
+ * constraint at once: the columns of R^T (the rows of R) are contiguous, and the
+ * workspace holds what the trace and the product have in common, so it is
+ * computed only once.  The constraint matrices have to be symmetric.
+ *
+ * @tparam MatrixType Type of the constraint matrix: arma::sp_mat, arma::mat,
+ *     or arma::vec for a rank-one constraint a a^T.
+ */
+template<typename MatrixType>
+struct ConstraintTraits;
+
+//! Sparse constraints: O(nnz(A) r).
+template<>
+struct ConstraintTraits<arma::sp_mat>
+{
+  typedef arma::sp_mat MatrixType;
+
+  static double Trace(const arma::sp_mat& a, const arma::mat& coordinates)
+  {
+    // The sum over the nonzeros A_jk of A_jk <R_j, R_k>.
+    double trace = 0;
+    for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+      trace += (*it) * arma::dot(coordinates.row(it.row()),
+          coordinates.row(it.col()));
+    return trace;
+  }
+
+  static double Trace(const arma::sp_mat& a,
+                      const arma::mat& rt,
+                      arma::mat& /* workspace */)
+  {
+    double trace = 0;
+    for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+      trace += (*it) * ColumnDot(rt, it.row(), it.col());
+    return trace;
+  }
+
+  static void AddProduct(arma::mat& gradientT,
+                         const arma::sp_mat& a,
+                         const arma::mat& rt,
+                         const arma::mat& /* workspace */,
+                         const double weight)
+  {
+    for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+      AddColumn(gradientT, it.row(), rt, it.col(), weight * (*it));
+  }
+
+  //! Return the dot product of two columns of the given matrix.
+  static double ColumnDot(const arma::mat& m, const size_t j, const size_t k)
+  {
+    const double* mj = m.colptr(j);
+    const double* mk = m.colptr(k);
+    double product = 0;
+    for (size_t l = 0; l < m.n_rows; ++l)
+      product += mj[l] * mk[l];
+    return product;
+  }
+
+  //! Add weight times column k of m to column j of the output.
+  static void AddColumn(arma::mat& output,
+                        const size_t j,
+                        const arma::mat& m,
+                        const size_t k,
+                        const double weight)
+  {
+    const double* mk = m.colptr(k);
+    double* oj = output.colptr(j);
+    for (size_t l = 0; l < m.n_rows; ++l)
+      oj[l] += weight * mk[l];
+  }
+};
+
+//! Dense constraints: O(n^2 r), but R R^T (which is n x n) is never formed.
+template<>
+struct ConstraintTraits<arma::mat>
+{
+  typedef arma::mat MatrixType;
+
+  static double Trace(const arma::mat& a, const arma::mat& coordinates)
+  {
+    return accu((a * coordinates) % coordinates);
+  }
+
+  static double Trace(const arma::mat& a,
+                      const arma::mat& rt,
+                      arma::mat& workspace)
+  {
+    // The workspace holds R^T A = (A R)^T.
+    workspace = rt * a;
+    return accu(workspace % rt);
+  }
+
+  static void AddProduct(arma::mat& gradientT,
+                         const arma::mat& /* a */,
+                         const arma::mat& /* rt */,
+                         const arma::mat& workspace,
+                         const double weight)
+  {
+    gradientT += weight * workspace;
+  }
+};
+
+//! Rank-one constraints A = a a^T: Tr(A (R R^T)) = || R^T a ||^2, in O(n r).
+template<>
+struct ConstraintTraits<arma::vec>
+{
+  typedef arma::vec MatrixType;
+
+  static double Trace(const arma::vec& a, const arma::mat& coordinates)
+  {
+    const arma::vec ra = trans(coordinates) * a;
+    return dot(ra, ra);
+  }
+
+  static double Trace(const arma::vec& a,
+                      const arma::mat& rt,
+                      arma::mat& workspace)
+  {
+    // The workspace holds R^T a.
+    workspace = rt * a;
+    return accu(workspace % workspace);
+  }
+
+  static void AddProduct(arma::mat& gradientT,
+                         const arma::vec& a,
+                         const arma::mat& /* rt */,
+                         const arma::mat& workspace,
+                         const double weight)
+  {
+    // (a a^T R)^T = (R^T a) a^T.
+    gradientT += (weight * workspace) * trans(a);
+  }
+};
+
+/**
+ * Coordinate-sparse constraints, whose matrices hold one nonzero element of A
+ * (row, column, value) in each column: O(nnz(A) r).  These are stored as
+ * arma::mat too, so they can't be told from dense constraints by their type
+ * alone.
+ */
+struct CoordinateConstraintTraits
+{
+  typedef arma::mat MatrixType;
+
+  static double Trace(const arma::mat& a, const arma::mat& coordinates)
+  {
+    double trace = 0;
+    for (size_t l = 0; l < a.n_cols; ++l)
+      trace += a(2, l) * arma::dot(coordinates.row((size_t) a(0, l)),
+          coordinates.row((size_t) a(1, l)));
+    return trace;
+  }
+
+  static double Trace(const arma::mat& a,
+                      const arma::mat& rt,
+                      arma::mat& /* workspace */)
+  {
+    double trace = 0;
+    for (size_t l = 0; l < a.n_cols; ++l)
+      trace += a(2, l) * ConstraintTraits<arma::sp_mat>::ColumnDot(rt,
+          (size_t) a(0, l), (size_t) a(1, l));
+    return trace;
+  }
+
+  static void AddProduct(arma::mat& gradientT,
+                         const arma::mat& a,
+                         const arma::mat& rt,
+                         const arma::mat& /* workspace */,
+                         const double weight)
+  {
+    for (size_t l = 0; l < a.n_cols; ++l)
+      ConstraintTraits<arma::sp_mat>::AddColumn(gradientT, (size_t) a(0, l),
+          rt, (size_t) a(1, l), weight * a(2, l));
+  }
+};
+
+}; // namespace optimization
+}; // namespace mlpack
+
+#endif
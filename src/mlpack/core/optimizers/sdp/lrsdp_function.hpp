@@ -64,6 +64,15 @@ class LRSDPFunction
    */
   double EvaluateConstraint(const size_t index,
                             const arma::mat& coordinates) const;
+  /**
+   * Evaluate every constraint of the LRSDP at the given coordinates.  The
+   * constraints are split between threads, and the traces are computed from
+   * the transposed coordinates (see ConstraintTraits), so this is much faster
+   * than calling EvaluateConstraint() for each of them.
+   */
+  void EvaluateConstraints(const arma::mat& coordinates,
+                           arma::vec& constraints) const;
+
   /**
    * Evaluate the gradient of a particular constraint of the LRSDP at the given
    * coordinates.
@@ -115,6 +124,18 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Gradient(
     const arma::mat& coordinates,
     arma::mat& gradient) const;
 
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const;
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const;
+
 }; // namespace optimization
 }; // namespace mlpack
 
@@ -10,6 +10,7 @@
 #define __MLPACK_CORE_OPTIMIZERS_SDP_LRSDP_FUNCTION_IMPL_HPP
 
 #include "lrsdp_function.hpp"
+#include "lrsdp_constraints.hpp"
 
 namespace mlpack {
 namespace optimization {
@@ -42,8 +43,8 @@ LRSDPFunction<SDPType>::LRSDPFunction(const size_t numSparseConstraints,
 template <typename SDPType>
 double LRSDPFunction<SDPType>::Evaluate(const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
-  return accu(SDP().C() % rrt);
+  return ConstraintTraits<typename SDPType::objective_matrix_type>::Trace(
+      SDP().C(), coordinates);
 }
 
 template <typename SDPType>
@@ -58,11 +59,68 @@ template <typename SDPType>
 double LRSDPFunction<SDPType>::EvaluateConstraint(const size_t index,
                                                   const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
   if (index < SDP().NumSparseConstraints())
-    return accu(SDP().SparseA()[index] % rrt) - SDP().SparseB()[index];
+    return ConstraintTraits<arma::sp_mat>::Trace(SDP().SparseA()[index],
+        coordinates) - SDP().SparseB()[index];
+
   const size_t index1 = index - SDP().NumSparseConstraints();
-  return accu(SDP().DenseA()[index1] % rrt) - SDP().DenseB()[index1];
+  if (index1 < SDP().NumDenseConstraints())
+    return ConstraintTraits<arma::mat>::Trace(SDP().DenseA()[index1],
+        coordinates) - SDP().DenseB()[index1];
+
+  const size_t index2 = index1 - SDP().NumDenseConstraints();
+  if (index2 < SDP().NumRankOneConstraints())
+    return ConstraintTraits<arma::vec>::Trace(SDP().RankOneA()[index2],
+        coordinates) - SDP().RankOneB()[index2];
+
+  const size_t index3 = index2 - SDP().NumRankOneConstraints();
+  return CoordinateConstraintTraits::Trace(SDP().CoordinateA()[index3],
+      coordinates) - SDP().CoordinateB()[index3];
+}
+
+//! Utility function to evaluate the constraints of one kind, in parallel, from
+//! the transposed coordinates.
+template <typename TraitsType>
+static inline void
+ConstraintValues(const arma::mat& rt,
+                 const std::vector<typename TraitsType::MatrixType>& ais,
+                 const arma::vec& bis,
+                 const size_t offset,
+                 arma::vec& constraints)
+{
+  if (ais.empty())
+    return;
+
+  #pragma omp parallel
+  {
+    arma::mat workspace;
+
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < ais.size(); ++i)
+      constraints[offset + i] = TraitsType::Trace(ais[i], rt, workspace) -
+          bis[i];
+  }
+}
+
+template <typename SDPType>
+void LRSDPFunction<SDPType>::EvaluateConstraints(const arma::mat& coordinates,
+                                                 arma::vec& constraints) const
+{
+  const arma::mat rt = trans(coordinates);
+  constraints.set_size(NumConstraints());
+
+  const size_t denseOffset = SDP().NumSparseConstraints();
+  const size_t rankOneOffset = denseOffset + SDP().NumDenseConstraints();
+  const size_t coordinateOffset = rankOneOffset +
+      SDP().NumRankOneConstraints();
+  ConstraintValues<ConstraintTraits<arma::sp_mat> >(rt, SDP().SparseA(),
+      SDP().SparseB(), 0, constraints);
+  ConstraintValues<ConstraintTraits<arma::mat> >(rt, SDP().DenseA(),
+      SDP().DenseB(), denseOffset, constraints);
+  ConstraintValues<ConstraintTraits<arma::vec> >(rt, SDP().RankOneA(),
+      SDP().RankOneB(), rankOneOffset, constraints);
+  ConstraintValues<CoordinateConstraintTraits>(rt, SDP().CoordinateA(),
+      SDP().CoordinateB(), coordinateOffset, constraints);
 }
 
 template <typename SDPType>
@@ -85,82 +143,138 @@ std::string LRSDPFunction<SDPType>::ToString() const
       << initialPoint.n_cols << std::endl;
   convert << "  Sparse Constraint b_i values: " << SDP().SparseB().t();
   convert << "  Dense Constraint b_i values: " << SDP().DenseB().t();
+  convert << "  Rank-one Constraint b_i values: " << SDP().RankOneB().t();
+  convert << "  Coordinate-sparse Constraint b_i values: "
+      << SDP().CoordinateB().t();
   return convert.str();
 }
 
-//! Utility function for calculating part of the objective when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
+//! Utility function for calculating part of the objective (and, if requested,
+//! of the transposed gradient) when AugLagrangian is used with an
+//! LRSDPFunction.  The constraints are split between threads, and the gradient
+//! is computed transposed; see ConstraintTraits.
+template <typename TraitsType>
 static inline void
-UpdateObjective(double& objective,
-                const arma::mat& rrt,
-                const std::vector<MatrixType>& ais,
-                const arma::vec& bis,
-                const arma::vec& lambda,
-                const size_t lambdaOffset,
-                const double sigma)
-{
-  for (size_t i = 0; i < ais.size(); ++i)
-  {
-    // Take the trace subtracted by the b_i.
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    objective -= (lambda[lambdaOffset + i] * constraint);
-    objective += (sigma / 2.) * constraint * constraint;
-  }
-}
+UpdateConstraints(double& objective,
+                  arma::mat& gradientT,
+                  const bool computeGradient,
+                  const arma::mat& rt,
+                  const std::vector<typename TraitsType::MatrixType>& ais,
+                  const arma::vec& bis,
+                  const arma::vec& lambda,
+                  const size_t lambdaOffset,
+                  const double sigma)
+{
+  if (ais.empty())
+    return;
 
-//! Utility function for calculating part of the gradient when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
-static inline void
-UpdateGradient(arma::mat& s,
-               const arma::mat& rrt,
-               const std::vector<MatrixType>& ais,
-               const arma::vec& bis,
-               const arma::vec& lambda,
-               const size_t lambdaOffset,
-               const double sigma)
-{
-  for (size_t i = 0; i < ais.size(); ++i)
+  #pragma omp parallel
   {
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    const double y = lambda[lambdaOffset + i] - sigma * constraint;
-    s -= y * ais[i];
+    double threadObjective = 0;
+    arma::mat threadGradientT;
+    if (computeGradient)
+      threadGradientT.zeros(rt.n_rows, rt.n_cols);
+    arma::mat workspace;
+
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < ais.size(); ++i)
+    {
+      // Take the trace subtracted by the b_i.
+      const double constraint = TraitsType::Trace(ais[i], rt, workspace) -
+          bis[i];
+      threadObjective -= (lambda[lambdaOffset + i] * constraint);
+      threadObjective += (sigma / 2.) * constraint * constraint;
+
+      // The gradient gets -y_i A_i R, with y_i = lambda_i - sigma * constraint.
+      if (computeGradient)
+      {
+        const double y = lambda[lambdaOffset + i] - sigma * constraint;
+        TraitsType::AddProduct(threadGradientT, ais[i], rt, workspace, -y);
+      }
+    }
+
+    #pragma omp critical(lrsdp_constraints)
+    {
+      objective += threadObjective;
+      if (computeGradient)
+        gradientT += threadGradientT;
+    }
   }
 }
 
 template <typename SDPType>
 static inline double
-EvaluateImpl(const LRSDPFunction<SDPType>& function,
-             const arma::mat& coordinates,
-             const arma::vec& lambda,
-             const double sigma)
+EvaluateWithGradientImpl(const LRSDPFunction<SDPType>& function,
+                         const arma::mat& coordinates,
+                         const arma::vec& lambda,
+                         const double sigma,
+                         arma::mat& gradient,
+                         const bool computeGradient)
 {
   // We can calculate the entire objective in a smart way.
   // L(R, y, s) = Tr(C * (R R^T)) -
   //     sum_{i = 1}^{m} (y_i (Tr(A_i * (R R^T)) - b_i)) +
   //     (sigma / 2) * sum_{i = 1}^{m} (Tr(A_i * (R R^T)) - b_i)^2
-
-  // Let's start with the objective: Tr(C * (R R^T)).
-  // Simple, possibly slow solution-- see below for optimization opportunity
   //
-  // TODO: Note that Tr(C^T * (R R^T)) = Tr( (CR)^T * R ), so
-  // multiplying C*R first, and then taking the trace dot should be more memory
-  // efficient
+  // and the gradient as well:
+  // L'(R, y, s) = 2 * S' * R
+  //   with
+  // S' = C - sum_{i = 1}^{m} y'_i A_i
+  // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i)
   //
-  // Similarly for the constraints, taking A*R first should be more efficient
-  const arma::mat rrt = coordinates * trans(coordinates);
-  double objective = accu(function.SDP().C() % rrt);
+  // R R^T (which is n x n) is never formed: every trace and every product
+  // A_i R is computed from the structure of A_i.
+  const arma::mat rt = trans(coordinates);
+  arma::mat workspace;
+  arma::mat gradientT;
+  if (computeGradient)
+    gradientT.zeros(rt.n_rows, rt.n_cols);
+
+  // Let's start with the objective: Tr(C * (R R^T)).
+  typedef ConstraintTraits<typename SDPType::objective_matrix_type>
+      ObjectiveTraits;
+  double objective = ObjectiveTraits::Trace(function.SDP().C(), rt, workspace);
+  if (computeGradient)
+    ObjectiveTraits::AddProduct(gradientT, function.SDP().C(), rt, workspace,
+        1.0);
 
   // Now each constraint.
-  UpdateObjective(objective, rrt, function.SDP().SparseA(), function.SDP().SparseB(),
+  const size_t denseOffset = function.SDP().NumSparseConstraints();
+  const size_t rankOneOffset = denseOffset +
+      function.SDP().NumDenseConstraints();
+  const size_t coordinateOffset = rankOneOffset +
+      function.SDP().NumRankOneConstraints();
+  UpdateConstraints<ConstraintTraits<arma::sp_mat> >(objective, gradientT,
+      computeGradient, rt, function.SDP().SparseA(), function.SDP().SparseB(),
       lambda, 0, sigma);
-  UpdateObjective(objective, rrt, function.SDP().DenseA(), function.SDP().DenseB(), lambda,
-      function.SDP().NumSparseConstraints(), sigma);
+  UpdateConstraints<ConstraintTraits<arma::mat> >(objective, gradientT,
+      computeGradient, rt, function.SDP().DenseA(), function.SDP().DenseB(),
+      lambda, denseOffset, sigma);
+  UpdateConstraints<ConstraintTraits<arma::vec> >(objective, gradientT,
+      computeGradient, rt, function.SDP().RankOneA(), function.SDP().RankOneB(),
+      lambda, rankOneOffset, sigma);
+  UpdateConstraints<CoordinateConstraintTraits>(objective, gradientT,
+      computeGradient, rt, function.SDP().CoordinateA(),
+      function.SDP().CoordinateB(), lambda, coordinateOffset, sigma);
+
+  if (computeGradient)
+    gradient = 2 * trans(gradientT);
 
   return objective;
 }
 
+template <typename SDPType>
+static inline double
+EvaluateImpl(const LRSDPFunction<SDPType>& function,
+             const arma::mat& coordinates,
+             const arma::vec& lambda,
+             const double sigma)
+{
+  arma::mat gradient;
+  return EvaluateWithGradientImpl(function, coordinates, lambda, sigma,
+      gradient, false);
+}
+
 template <typename SDPType>
 static inline void
 GradientImpl(const LRSDPFunction<SDPType>& function,
@@ -169,22 +283,21 @@ GradientImpl(const LRSDPFunction<SDPType>& function,
              const double sigma,
              arma::mat& gradient)
 {
-  // We can calculate the gradient in a smart way.
-  // L'(R, y, s) = 2 * S' * R
-  //   with
-  // S' = C - sum_{i = 1}^{m} y'_i A_i
-  // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i)
-  const arma::mat rrt = coordinates * trans(coordinates);
-  arma::mat s(function.SDP().C());
-
-  UpdateGradient(
-      s, rrt, function.SDP().SparseA(), function.SDP().SparseB(),
-      lambda, 0, sigma);
-  UpdateGradient(
-      s, rrt, function.SDP().DenseA(), function.SDP().DenseB(),
-      lambda, function.SDP().NumSparseConstraints(), sigma);
+  EvaluateWithGradientImpl(function, coordinates, lambda, sigma, gradient,
+      true);
+}
 
-  gradient = 2 * s * coordinates;
+template <typename SDPType>
+static inline double
+EvaluateWithGradientImpl(const LRSDPFunction<SDPType>& function,
+                         const arma::mat& coordinates,
+                         const arma::vec& lambda,
+                         const double sigma,
+                         arma::mat& gradient)
+{
+  // The objective and the gradient share all the traces; see above.
+  return EvaluateWithGradientImpl(function, coordinates, lambda, sigma,
+      gradient, true);
 }
 
 // Template specializations for function and gradient evaluation.
@@ -220,6 +333,26 @@ inline void AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::Gradient(
   GradientImpl(function, coordinates, lambda, sigma, gradient);
 }
 
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  return EvaluateWithGradientImpl(function, coordinates, lambda, sigma,
+      gradient);
+}
+
+template <>
+inline double
+AugLagrangianFunction<LRSDPFunction<SDP<arma::mat>>>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    arma::mat& gradient) const
+{
+  return EvaluateWithGradientImpl(function, coordinates, lambda, sigma,
+      gradient);
+}
+
 }; // namespace optimization
 }; // namespace mlpack
 
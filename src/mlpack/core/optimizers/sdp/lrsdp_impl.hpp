@@ -24,6 +24,11 @@ LRSDP<SDPType>::LRSDP(const size_t numSparseConstraints,
 template <typename SDPType>
 double LRSDP<SDPType>::Optimize(arma::mat& coordinates)
 {
+  // Constraints may have been added to the SDP since the Lagrange multipliers
+  // were initialized (for instance, rank-one constraints).
+  if (augLag.Lambda().n_elem != function.NumConstraints())
+    augLag.Lambda().zeros(function.NumConstraints());
+
   augLag.Sigma() = 10;
   augLag.Optimize(coordinates, 1000);
 
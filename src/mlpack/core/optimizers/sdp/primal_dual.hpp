@@ -15,6 +15,12 @@ namespace optimization {
 /**
  * Interface to a primal dual interior point solver.
  *
+ * This solver works on the full n x n matrices, so the structured constraints
+ * of the SDP are turned into plain ones: coordinate-sparse constraints into
+ * sparse constraints, which follow the other sparse constraints (and share
+ * their dual variables ySparse), and rank-one constraints into dense
+ * constraints, which follow the other dense constraints (and share yDense).
+ *
  * @tparam SDPType
  */
 template <typename SDPType>
@@ -122,6 +128,10 @@ class PrimalDualSolver
 
   //! Maximum number of iterations to run. Set to 0 for no limit.
   size_t maxIterations;
+
+  //! Turn the coordinate-sparse constraints of the SDP into sparse constraints
+  //! and the rank-one constraints into dense constraints.
+  void UnstructureConstraints();
 };
 
 } // namespace optimization
@@ -33,8 +33,10 @@ template <typename SDPType>
 PrimalDualSolver<SDPType>::PrimalDualSolver(const SDPType& sdp)
   : sdp(sdp),
     initialX(arma::eye<arma::mat>(sdp.N(), sdp.N())),
-    initialYsparse(arma::ones<arma::vec>(sdp.NumSparseConstraints())),
-    initialYdense(arma::ones<arma::vec>(sdp.NumDenseConstraints())),
+    initialYsparse(arma::ones<arma::vec>(sdp.NumSparseConstraints() +
+        sdp.NumCoordinateConstraints())),
+    initialYdense(arma::ones<arma::vec>(sdp.NumDenseConstraints() +
+        sdp.NumRankOneConstraints())),
     initialZ(arma::eye<arma::mat>(sdp.N(), sdp.N())),
     tau(0.99),
     normXzTol(1e-7),
@@ -42,7 +44,7 @@ PrimalDualSolver<SDPType>::PrimalDualSolver(const SDPType& sdp)
     dualInfeasTol(1e-7),
     maxIterations(1000)
 {
-
+  UnstructureConstraints();
 }
 
 template <typename SDPType>
@@ -62,6 +64,8 @@ PrimalDualSolver<SDPType>::PrimalDualSolver(const SDPType& sdp,
     dualInfeasTol(1e-7),
     maxIterations(1000)
 {
+  UnstructureConstraints();
+
   arma::mat tmp;
 
   // Note that the algorithm we implement requires primal iterate X and
@@ -75,15 +79,17 @@ PrimalDualSolver<SDPType>::PrimalDualSolver(const SDPType& sdp,
     Log::Fatal << "PrimalDualSolver::PrimalDualSolver(): "
       << "initialX needs to be symmetric positive definite." << std::endl;
 
-  if (initialYsparse.n_elem != sdp.NumSparseConstraints())
+  if (initialYsparse.n_elem != sdp.NumSparseConstraints() +
+      sdp.NumCoordinateConstraints())
     Log::Fatal << "PrimalDualSolver::PrimalDualSolver(): "
       << "initialYsparse needs to have the same length as the number of sparse "
-      << "constraints." << std::endl;
+      << "and coordinate-sparse constraints." << std::endl;
 
-  if (initialYdense.n_elem != sdp.NumDenseConstraints())
+  if (initialYdense.n_elem != sdp.NumDenseConstraints() +
+      sdp.NumRankOneConstraints())
     Log::Fatal << "PrimalDualSolver::PrimalDualSolver(): "
       << "initialYdense needs to have the same length as the number of dense "
-      << "constraints." << std::endl;
+      << "and rank-one constraints." << std::endl;
 
   if (initialZ.n_rows != sdp.N() || initialZ.n_cols != sdp.N())
     Log::Fatal << "PrimalDualSolver::PrimalDualSolver(): "
@@ -94,6 +100,40 @@ PrimalDualSolver<SDPType>::PrimalDualSolver(const SDPType& sdp,
       << "initialZ needs to be symmetric positive definite." << std::endl;
 }
 
+template <typename SDPType>
+void PrimalDualSolver<SDPType>::UnstructureConstraints()
+{
+  const size_t numSparse = sdp.NumSparseConstraints();
+  const size_t numCoordinate = sdp.NumCoordinateConstraints();
+  if (numCoordinate > 0)
+  {
+    sdp.SparseB().resize(numSparse + numCoordinate);
+    for (size_t i = 0; i < numCoordinate; i++)
+    {
+      sdp.SparseA().push_back(sdp.CoordinateSparseA(i));
+      sdp.SparseB()[numSparse + i] = sdp.CoordinateB()[i];
+    }
+
+    sdp.CoordinateA().clear();
+    sdp.CoordinateB().reset();
+  }
+
+  const size_t numDense = sdp.NumDenseConstraints();
+  const size_t numRankOne = sdp.NumRankOneConstraints();
+  if (numRankOne > 0)
+  {
+    sdp.DenseB().resize(numDense + numRankOne);
+    for (size_t i = 0; i < numRankOne; i++)
+    {
+      sdp.DenseA().push_back(sdp.RankOneA()[i] * trans(sdp.RankOneA()[i]));
+      sdp.DenseB()[numDense + i] = sdp.RankOneB()[i];
+    }
+
+    sdp.RankOneA().clear();
+    sdp.RankOneB().reset();
+  }
+}
+
 /**
  * Compute
  *
@@ -132,17 +172,72 @@ Alpha(const arma::mat& A, const arma::mat& dA, double tau)
  *
  *   AX + XA = H
  *
- * where A, H are symmetric matrices.
+ * where A, H are symmetric matrices, given the eigendecomposition
+ * A = Q diag(lambda) Q^T of A.  As in Lemma 7.2 of [AHO98], the equation
+ * becomes diagonal in the eigenbasis of A:
+ *
+ *   (Q^T X Q)_ij = (Q^T H Q)_ij / (lambda_i + lambda_j).
+ *
+ * The denominators lambda_i + lambda_j are given as a matrix, since the same
+ * decomposition is used for many solves.
+ */
+static inline void
+SolveLyapunov(arma::mat& X,
+              const arma::mat& Q,
+              const arma::mat& denominators,
+              const arma::mat& H)
+{
+  X = Q * ((trans(Q) * H * Q) / denominators) * trans(Q);
+}
+
+/**
+ * Return Tr(A G) for a symmetric constraint matrix A, which is the svec inner
+ * product <svec(A), svec(G)>.  Only the nonzeros of a sparse A are visited.
+ */
+static inline double
+TraceProduct(const arma::sp_mat& A, const arma::mat& G)
+{
+  double trace = 0.;
+  for (arma::sp_mat::const_iterator it = A.begin(); it != A.end(); ++it)
+    trace += (*it) * G(it.row(), it.col());
+  return trace;
+}
+
+static inline double
+TraceProduct(const arma::mat& A, const arma::mat& G)
+{
+  return arma::dot(A, G);
+}
+
+/**
+ * Compute column j of the Schur complement M = A E^(-1) F A^T (2.15), which
+ * belongs to the constraint matrix Aj:
  *
- * TODO(stephentu): Note this method current uses arma's builtin arma::syl
- * method, which is overkill for this situation. See Lemma 7.2 of [AHO98] for
- * how to solve this Lyapunov equation using an eigenvalue decomposition of A.
+ *     M_ij = Tr(A_i G_j),  where  Z G_j + G_j Z = X A_j + A_j X.
  *
+ * Since X and A_j are symmetric, Q^T (X A_j + A_j X) Q = B + B^T with
+ * B = (Q^T X) A_j Q, which costs a sparse product and one dense product for a
+ * sparse A_j.  The entries of the column only need G_j at the nonzeros of the
+ * sparse A_i.
  */
+template<typename MatrixType>
 static inline void
-SolveLyapunov(arma::mat& X, const arma::mat& A, const arma::mat& H)
+SchurComplementColumn(const MatrixType& Aj,
+                      const arma::mat& QtX,
+                      const arma::mat& Q,
+                      const arma::mat& denominators,
+                      const std::vector<arma::sp_mat>& sparseA,
+                      const std::vector<arma::mat>& denseA,
+                      const size_t j,
+                      arma::mat& M)
 {
-  arma::syl(X, A, A, -H);
+  const arma::mat B = (QtX * Aj) * Q;
+  const arma::mat Gj = Q * ((B + trans(B)) / denominators) * trans(Q);
+
+  for (size_t i = 0; i < sparseA.size(); i++)
+    M(i, j) = TraceProduct(sparseA[i], Gj);
+  for (size_t i = 0; i < denseA.size(); i++)
+    M(sparseA.size() + i, j) = TraceProduct(denseA[i], Gj);
 }
 
 /**
@@ -161,13 +256,20 @@ SolveLyapunov(arma::mat& X, const arma::mat& A, const arma::mat& H)
  *     E  = Z sym I
  *     F  = X sym I
  *
+ * The Schur complement M is given by its LU decomposition P^T L U, and E and F
+ * are applied as matrix products (F svec(V) = svec(0.5 (XV + VX))) instead of
+ * being formed.  Q and denominators are the eigendecomposition of Z, for
+ * SolveLyapunov().
  */
 static inline void
 SolveKKTSystem(const arma::sp_mat& Asparse,
                const arma::mat& Adense,
-               const arma::mat& Z,
-               const arma::mat& M,
-               const arma::mat& F,
+               const arma::mat& X,
+               const arma::mat& Q,
+               const arma::mat& denominators,
+               const arma::mat& L,
+               const arma::mat& U,
+               const arma::mat& P,
                const arma::vec& rp,
                const arma::vec& rd,
                const arma::vec& rc,
@@ -176,16 +278,16 @@ SolveKKTSystem(const arma::sp_mat& Asparse,
                arma::vec& dydense,
                arma::vec& dsz)
 {
-  arma::mat Frd_rc_Mat, Einv_Frd_rc_Mat,
-            Einv_Frd_ATdy_rc_Mat, Frd_ATdy_rc_Mat;
-  arma::vec Einv_Frd_rc, Einv_Frd_ATdy_rc, dy;
+  arma::mat Rd, Rc, Einv_Frd_rc_Mat, Dsz, Einv_Frd_ATdy_rc_Mat;
+  arma::vec Einv_Frd_rc, Einv_Frd_ATdy_rc, dy, Ldy;
 
   // Note: Whenever a formula calls for E^(-1) v for some v, we solve Lyapunov
   // equations instead of forming an explicit inverse.
+  math::Smat(rd, Rd);
+  math::Smat(rc, Rc);
 
   // Compute the RHS of (2.12)
-  math::Smat(F * rd - rc, Frd_rc_Mat);
-  SolveLyapunov(Einv_Frd_rc_Mat, Z, 2. * Frd_rc_Mat);
+  SolveLyapunov(Einv_Frd_rc_Mat, Q, denominators, X * Rd + Rd * X - 2. * Rc);
   math::Svec(Einv_Frd_rc_Mat, Einv_Frd_rc);
 
   arma::vec rhs = rp;
@@ -195,8 +297,8 @@ SolveKKTSystem(const arma::sp_mat& Asparse,
   if (Adense.n_rows)
     rhs(arma::span(Asparse.n_rows, numConstraints - 1)) += Adense * Einv_Frd_rc;
 
-  // TODO(stephentu): use a more efficient method (e.g. LU decomposition)
-  if (!arma::solve(dy, M, rhs))
+  if (!arma::solve(Ldy, arma::trimatl(L), P * rhs) ||
+      !arma::solve(dy, arma::trimatu(U), Ldy))
     Log::Fatal << "PrimalDualSolver::SolveKKTSystem(): Could not solve KKT "
         << "system." << std::endl;
 
@@ -205,15 +307,15 @@ SolveKKTSystem(const arma::sp_mat& Asparse,
   if (Adense.n_rows)
     dydense = dy(arma::span(Asparse.n_rows, numConstraints - 1));
 
+  // Compute dz from (2.14)
+  dsz = rd - Asparse.t() * dysparse - Adense.t() * dydense;
+
   // Compute dx from (2.13)
-  math::Smat(F * (rd - Asparse.t() * dysparse - Adense.t() * dydense) - rc,
-      Frd_ATdy_rc_Mat);
-  SolveLyapunov(Einv_Frd_ATdy_rc_Mat, Z, 2. * Frd_ATdy_rc_Mat);
+  math::Smat(dsz, Dsz);
+  SolveLyapunov(Einv_Frd_ATdy_rc_Mat, Q, denominators,
+      X * Dsz + Dsz * X - 2. * Rc);
   math::Svec(Einv_Frd_ATdy_rc_Mat, Einv_Frd_ATdy_rc);
   dsx = -Einv_Frd_ATdy_rc;
-
-  // Compute dz from (2.14)
-  dsz = rd - Asparse.t() * dysparse - Adense.t() * dydense;
 }
 
 namespace private_ {
@@ -274,15 +376,11 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
   math::Svec(X, sx);
   math::Svec(Z, sz);
 
-  arma::vec rp, rd, rc, gk;
+  arma::vec rp, rd, rc, eigvalZ;
 
-  arma::mat Rc, F, Einv_F_AsparseT, Einv_F_AdenseT, Gk,
-            M, DualCheck;
+  arma::mat Rc, Q, denominators, M, L, U, P, DualCheck;
 
   rp.set_size(sdp.NumConstraints());
-
-  Einv_F_AsparseT.set_size(n2bar, sdp.NumSparseConstraints());
-  Einv_F_AdenseT.set_size(n2bar, sdp.NumDenseConstraints());
   M.set_size(sdp.NumConstraints(), sdp.NumConstraints());
 
   double primalObj = 0., alpha, beta;
@@ -305,57 +403,30 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
     // Rd = C - Z - smat A^T y
     rd = sc - sz - Asparse.t() * ysparse - Adense.t() * ydense;
 
-    math::SymKronId(X, F);
-
-    // We compute E^(-1) F A^T by solving Lyapunov equations.
-    // See (2.16).
-    for (size_t i = 0; i < sdp.NumSparseConstraints(); i++)
-    {
-      SolveLyapunov(Gk, Z, X * sdp.SparseA()[i] + sdp.SparseA()[i] * X);
-      math::Svec(Gk, gk);
-      Einv_F_AsparseT.col(i) = gk;
-    }
-
-    for (size_t i = 0; i < sdp.NumDenseConstraints(); i++)
+    // Form the M = A E^(-1) F A^T matrix (2.15), one column per constraint.
+    // Every column takes a few dense products, so the columns are computed in
+    // parallel; the eigendecomposition of Z they share is computed once, and
+    // it also serves the Lyapunov equations of both KKT systems below.
+    if (!arma::eig_sym(eigvalZ, Q, Z))
+      Log::Fatal << "PrimalDualSolver::Optimize(): eigendecomposition of Z "
+          << "failed." << std::endl;
+    denominators = arma::repmat(eigvalZ, 1, n) +
+        arma::repmat(trans(eigvalZ), n, 1);
+    const arma::mat QtX = trans(Q) * X;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t j = 0; j < sdp.NumConstraints(); j++)
     {
-      SolveLyapunov(Gk, Z, X * sdp.DenseA()[i] + sdp.DenseA()[i] * X);
-      math::Svec(Gk, gk);
-      Einv_F_AdenseT.col(i) = gk;
+      if (j < sdp.NumSparseConstraints())
+        SchurComplementColumn(sdp.SparseA()[j], QtX, Q, denominators,
+            sdp.SparseA(), sdp.DenseA(), j, M);
+      else
+        SchurComplementColumn(sdp.DenseA()[j - sdp.NumSparseConstraints()],
+            QtX, Q, denominators, sdp.SparseA(), sdp.DenseA(), j, M);
     }
 
-    // Form the M = A E^(-1) F A^T matrix (2.15)
-    //
-    // Since we split A up into its sparse and dense components,
-    // we have to handle each block separately.
-    if (sdp.NumSparseConstraints())
-    {
-      M.submat(arma::span(0, sdp.NumSparseConstraints() - 1),
-               arma::span(0, sdp.NumSparseConstraints() - 1)) =
-          Asparse * Einv_F_AsparseT;
-      if (sdp.NumDenseConstraints())
-      {
-        M.submat(arma::span(0, sdp.NumSparseConstraints() - 1),
-                 arma::span(sdp.NumSparseConstraints(),
-                            sdp.NumConstraints() - 1)) =
-            Asparse * Einv_F_AdenseT;
-      }
-    }
-    if (sdp.NumDenseConstraints())
-    {
-      if (sdp.NumSparseConstraints())
-      {
-        M.submat(arma::span(sdp.NumSparseConstraints(),
-                            sdp.NumConstraints() - 1),
-                 arma::span(0,
-                            sdp.NumSparseConstraints() - 1)) =
-            Adense * Einv_F_AsparseT;
-      }
-      M.submat(arma::span(sdp.NumSparseConstraints(),
-                          sdp.NumConstraints() - 1),
-               arma::span(sdp.NumSparseConstraints(),
-                          sdp.NumConstraints() - 1)) =
-          Adense * Einv_F_AdenseT;
-    }
+    // M is used for both KKT systems, so it is only factored once.
+    arma::lu(L, U, P, M);
 
     const double sxdotsz = arma::dot(sx, sz);
 
@@ -366,8 +437,8 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
     // This solves step (1) of Section 7, the "predictor" step.
     Rc = -0.5*(X*Z + Z*X);
     math::Svec(Rc, rc);
-    SolveKKTSystem(Asparse, Adense, Z, M, F, rp, rd, rc, dsx, dysparse, dydense,
-        dsz);
+    SolveKKTSystem(Asparse, Adense, X, Q, denominators, L, U, P, rp, rd, rc,
+        dsx, dysparse, dydense, dsz);
     math::Smat(dsx, dX);
     math::Smat(dsz, dZ);
 
@@ -383,8 +454,8 @@ PrimalDualSolver<SDPType>::Optimize(arma::mat& X,
     // Step (3), the "corrector" step.
     Rc = mu*arma::eye<arma::mat>(n, n) - 0.5*(X*Z + Z*X + dX*dZ + dZ*dX);
     math::Svec(Rc, rc);
-    SolveKKTSystem(Asparse, Adense, Z, M, F, rp, rd, rc, dsx, dysparse, dydense,
-        dsz);
+    SolveKKTSystem(Asparse, Adense, X, Q, denominators, L, U, P, rp, rd, rc,
+        dsx, dysparse, dydense, dsz);
     math::Smat(dsx, dX);
     math::Smat(dsz, dZ);
     alpha = Alpha(X, dX, tau);
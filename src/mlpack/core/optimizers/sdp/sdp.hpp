@@ -18,11 +18,25 @@ namespace optimization {
  *     s.t.   dot(Ai, X) = bi, i=1,...,m, X >= 0
  *
  * This representation allows the constraint matrices Ai to be specified as
- * either dense matrices (arma::mat) or sparse matrices (arma::sp_mat).  After
- * initializing the SDP object, you will need to set the constraints yourself,
- * via the SparseA(), SparseB(), DenseA(), DenseB(), and C() functions.  Note
- * that for each matrix you add to either SparseA() or DenseA(), you must add
- * the corresponding b value to the corresponding vector SparseB() or DenseB().
+ * dense matrices (arma::mat), sparse matrices (arma::sp_mat), rank-one matrices
+ * Ai = ai ai^T (given by the vector ai), or coordinate-sparse matrices (given by
+ * a 3 x nnz matrix whose columns hold the row, the column and the value of each
+ * nonzero element).  After initializing the SDP object, you will need to set
+ * the constraints yourself, via the SparseA(), SparseB(), DenseA(), DenseB(),
+ * RankOneA(), RankOneB(), CoordinateA(), CoordinateB(), and C() functions.
+ * Note that for each matrix you add to SparseA(), DenseA(), RankOneA() or
+ * CoordinateA(), you must add the corresponding b value to the corresponding
+ * vector SparseB(), DenseB(), RankOneB() or CoordinateB().  The constraints are
+ * numbered in that order: sparse constraints first, then dense, rank-one and
+ * coordinate-sparse constraints.
+ *
+ * The structured constraints are much cheaper than dense ones for LRSDP: with R
+ * of rank r, Tr(Ai (R R^T)) takes O(nnz(Ai) r) time for a sparse or
+ * coordinate-sparse Ai and O(n r) time for a rank-one Ai, instead of O(n^2 r)
+ * time.  Coordinate-sparse constraints are meant for problems with many
+ * constraints of a few elements each (like MVU or matrix completion): unlike an
+ * n x n arma::sp_mat, which holds n + 1 column pointers, they take O(nnz)
+ * memory.
  *
  * The objective matrix (C) may be stored as either dense or sparse depending on
  * the ObjectiveMatrixType parameter.
@@ -56,10 +70,14 @@ class SDP
    * @param n Number of rows (and columns) in the objective matrix C.
    * @param numSparseConstraints Number of sparse constraints.
    * @param numDenseConstraints Number of dense constraints.
+   * @param numRankOneConstraints Number of rank-one constraints.
+   * @param numCoordinateConstraints Number of coordinate-sparse constraints.
    */
   SDP(const size_t n,
       const size_t numSparseConstraints,
-      const size_t numDenseConstraints);
+      const size_t numDenseConstraints,
+      const size_t numRankOneConstraints = 0,
+      const size_t numCoordinateConstraints = 0);
 
   //! Return number of rows and columns in the objective matrix C.
   size_t N() const { return c.n_rows; }
@@ -73,8 +91,19 @@ class SDP
   //! SDP.
   size_t NumDenseConstraints() const { return denseB.n_elem; }
 
+  //! Return the number of rank-one constraints (constraints with Ai = ai ai^T)
+  //! in the SDP.
+  size_t NumRankOneConstraints() const { return rankOneB.n_elem; }
+
+  //! Return the number of coordinate-sparse constraints in the SDP.
+  size_t NumCoordinateConstraints() const { return coordinateB.n_elem; }
+
   //! Return the total number of constraints in the SDP.
-  size_t NumConstraints() const { return sparseB.n_elem + denseB.n_elem; }
+  size_t NumConstraints() const
+  {
+    return sparseB.n_elem + denseB.n_elem + rankOneB.n_elem +
+        coordinateB.n_elem;
+  }
 
   //! Modify the sparse objective function matrix (sparseC).
   ObjectiveMatrixType& C() { return c; }
@@ -97,6 +126,20 @@ class SDP
   //! constraints).
   std::vector<arma::mat>& DenseA() { return denseA; }
 
+  //! Return the vectors ai of the rank-one constraints, Ai = ai ai^T.
+  const std::vector<arma::vec>& RankOneA() const { return rankOneA; }
+
+  //! Modify the vectors ai of the rank-one constraints, Ai = ai ai^T.
+  std::vector<arma::vec>& RankOneA() { return rankOneA; }
+
+  //! Return the coordinate-sparse constraint matrices; each column of each
+  //! matrix holds the row, the column and the value of a nonzero element.
+  const std::vector<arma::mat>& CoordinateA() const { return coordinateA; }
+
+  //! Modify the coordinate-sparse constraint matrices; each column of each
+  //! matrix holds the row, the column and the value of a nonzero element.
+  std::vector<arma::mat>& CoordinateA() { return coordinateA; }
+
   //! Return the vector of sparse B values.
   const arma::vec& SparseB() const { return sparseB; }
   //! Modify the vector of sparse B values.
@@ -107,6 +150,24 @@ class SDP
   //! Modify the vector of dense B values.
   arma::vec& DenseB() { return denseB; }
 
+  //! Return the vector of rank-one B values.
+  const arma::vec& RankOneB() const { return rankOneB; }
+  //! Modify the vector of rank-one B values.
+  arma::vec& RankOneB() { return rankOneB; }
+
+  //! Return the vector of coordinate-sparse B values.
+  const arma::vec& CoordinateB() const { return coordinateB; }
+  //! Modify the vector of coordinate-sparse B values.
+  arma::vec& CoordinateB() { return coordinateB; }
+
+  /**
+   * Return the given coordinate-sparse constraint matrix as an arma::sp_mat
+   * (for solvers that don't handle coordinate-sparse constraints).
+   *
+   * @param i Index of the constraint among the coordinate-sparse constraints.
+   */
+  arma::sp_mat CoordinateSparseA(const size_t i) const;
+
   /**
    * Check whether or not the constraint matrices are linearly independent.
    *
@@ -127,6 +188,16 @@ class SDP
   std::vector<arma::mat> denseA;
   //! b_i for each dense constraint.
   arma::vec denseB;
+
+  //! a_i for each rank-one constraint, A_i = a_i a_i^T.
+  std::vector<arma::vec> rankOneA;
+  //! b_i for each rank-one constraint.
+  arma::vec rankOneB;
+
+  //! Nonzero elements (row, column, value) of each coordinate-sparse A_i.
+  std::vector<arma::mat> coordinateA;
+  //! b_i for each coordinate-sparse constraint.
+  arma::vec coordinateB;
 };
 
 } // namespace optimization
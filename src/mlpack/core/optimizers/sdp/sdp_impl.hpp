@@ -17,7 +17,11 @@ SDP<ObjectiveMatrixType>::SDP() :
     sparseA(),
     sparseB(),
     denseA(),
-    denseB()
+    denseB(),
+    rankOneA(),
+    rankOneB(),
+    coordinateA(),
+    coordinateB()
 {
 
 }
@@ -25,17 +29,35 @@ SDP<ObjectiveMatrixType>::SDP() :
 template <typename ObjectiveMatrixType>
 SDP<ObjectiveMatrixType>::SDP(const size_t n,
                               const size_t numSparseConstraints,
-                              const size_t numDenseConstraints) :
+                              const size_t numDenseConstraints,
+                              const size_t numRankOneConstraints,
+                              const size_t numCoordinateConstraints) :
     c(n, n),
     sparseA(numSparseConstraints),
     sparseB(numSparseConstraints),
     denseA(numDenseConstraints),
-    denseB(numDenseConstraints)
+    denseB(numDenseConstraints),
+    rankOneA(numRankOneConstraints),
+    rankOneB(numRankOneConstraints),
+    coordinateA(numCoordinateConstraints),
+    coordinateB(numCoordinateConstraints)
 {
   for (size_t i = 0; i < numSparseConstraints; i++)
     sparseA[i].zeros(n, n);
   for (size_t i = 0; i < numDenseConstraints; i++)
     denseA[i].zeros(n, n);
+  for (size_t i = 0; i < numRankOneConstraints; i++)
+    rankOneA[i].zeros(n);
+}
+
+template <typename ObjectiveMatrixType>
+arma::sp_mat SDP<ObjectiveMatrixType>::CoordinateSparseA(const size_t i) const
+{
+  const arma::mat& elements = coordinateA[i];
+  arma::sp_mat a(N(), N());
+  for (size_t j = 0; j < elements.n_cols; j++)
+    a((size_t) elements(0, j), (size_t) elements(1, j)) += elements(2, j);
+  return a;
 }
 
 template <typename ObjectiveMatrixType>
@@ -60,6 +82,18 @@ bool SDP<ObjectiveMatrixType>::HasLinearlyIndependentConstraints() const
     math::Svec(DenseA()[i], sa);
     A.row(NumSparseConstraints() + i) = sa.t();
   }
+  for (size_t i = 0; i < NumRankOneConstraints(); i++)
+  {
+    arma::vec sa;
+    math::Svec(arma::mat(RankOneA()[i] * trans(RankOneA()[i])), sa);
+    A.row(NumSparseConstraints() + NumDenseConstraints() + i) = sa.t();
+  }
+  for (size_t i = 0; i < NumCoordinateConstraints(); i++)
+  {
+    arma::vec sa;
+    math::Svec(arma::mat(CoordinateSparseA(i)), sa);
+    A.row(NumConstraints() - NumCoordinateConstraints() + i) = sa.t();
+  }
 
   const arma::vec s = arma::svd(A);
   return s(s.n_elem - 1) > 1e-5;
@@ -8,6 +8,9 @@
 #define __MLPACK_CORE_OPTIMIZERS_SGD_SGD_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+#include <future>
 
 namespace mlpack {
 namespace optimization {
@@ -64,6 +67,25 @@ namespace optimization {
  * objective function on the first point in the dataset (presumably, the dataset
  * is held internally in the DecomposableFunctionType).
  *
+ * Shuffling the visitation order makes every step read a random point of the
+ * dataset, which is slow when the dataset is much larger than the cache.  Two
+ * alternatives are available.  With a nonzero block size, the functions are
+ * split into contiguous blocks of that size; the order of the blocks is
+ * shuffled, and then the order of the functions within each block, so the
+ * steps of one block only touch a small part of the dataset.  With data
+ * shuffling enabled, the function is asked to permute its data once per epoch
+ * and the functions are then visited in linear order.  For that, the
+ * DecomposableFunctionType must also implement
+ *
+ *   void PrepareShuffle();
+ *   void Shuffle();
+ *
+ * PrepareShuffle() should build a randomly permuted copy of the data without
+ * changing what Evaluate() and Gradient() see, because it is called in a
+ * background thread while the previous epoch runs; Shuffle() should then
+ * replace the data with that copy (for instance, with a swap).  If the
+ * function does not implement them, the functions are shuffled as usual.
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  */
@@ -81,12 +103,19 @@ class SGD
    * @param tolerance Maximum absolute tolerance to terminate algorithm.
    * @param shuffle If true, the function order is shuffled; otherwise, each
    *     function is visited in linear order.
+   * @param blockSize If nonzero and shuffle is true, contiguous blocks of this
+   *     many functions are shuffled, and then the functions within each block.
+   * @param shuffleData If true and shuffle is true, the data of the function
+   *     is permuted once per epoch in a background thread and the functions
+   *     are visited in linear order (see PrepareShuffle() above).
    */
   SGD(DecomposableFunctionType& function,
       const double stepSize = 0.01,
       const size_t maxIterations = 100000,
       const double tolerance = 1e-5,
-      const bool shuffle = true);
+      const bool shuffle = true,
+      const size_t blockSize = 0,
+      const bool shuffleData = false);
 
   /**
    * Optimize the given function using stochastic gradient descent.  The given
@@ -123,10 +152,63 @@ class SGD
   //! Modify whether or not the individual functions are shuffled.
   bool& Shuffle() { return shuffle; }
 
+  //! Get the number of functions in each shuffled block (0 means the functions
+  //! are shuffled individually).
+  size_t BlockSize() const { return blockSize; }
+  //! Modify the number of functions in each shuffled block (0 means the
+  //! functions are shuffled individually).
+  size_t& BlockSize() { return blockSize; }
+
+  //! Get whether or not the data of the function is shuffled each epoch.
+  bool ShuffleData() const { return shuffleData; }
+  //! Modify whether or not the data of the function is shuffled each epoch.
+  bool& ShuffleData() { return shuffleData; }
+
+  //! Get the number of gradient evaluations of individual functions (this is
+  //! not reset by Optimize()).
+  size_t NumEvaluations() const { return numEvaluations; }
+  //! Modify the number of gradient evaluations of individual functions.
+  size_t& NumEvaluations() { return numEvaluations; }
+
   // convert the obkect into a string
   std::string ToString() const;
 
  private:
+  HAS_MEM_FUNC(PrepareShuffle, HasPrepareShuffle)
+  HAS_MEM_FUNC(Shuffle, HasShuffle)
+
+  //! The signature of the PrepareShuffle() and Shuffle() functions.
+  typedef void (DecomposableFunctionType::*ShuffleType)();
+
+  /**
+   * Fill the given vector with a new visitation order of the functions, either
+   * fully shuffled or shuffled by blocks.
+   */
+  void VisitationOrder(const size_t numFunctions,
+                       arma::Col<size_t>& order) const;
+
+  /**
+   * Replace the data of the function with the permuted copy prepared in the
+   * background (or prepare it now, if nothing is pending), and start preparing
+   * the next one.
+   */
+  template<typename FunctionType>
+  void ShuffleFunctions(FunctionType& f,
+                        std::future<void>& pending,
+                        typename boost::enable_if_c<
+                            HasPrepareShuffle<FunctionType, ShuffleType>::value
+                            && HasShuffle<FunctionType, ShuffleType>::value
+                        >::type* = 0) const;
+
+  //! The function can't permute its data; this is never called.
+  template<typename FunctionType>
+  void ShuffleFunctions(FunctionType& f,
+                        std::future<void>& pending,
+                        typename boost::disable_if_c<
+                            HasPrepareShuffle<FunctionType, ShuffleType>::value
+                            && HasShuffle<FunctionType, ShuffleType>::value
+                        >::type* = 0) const;
+
   //! The instantiated function.
   DecomposableFunctionType& function;
 
@@ -142,6 +224,16 @@ class SGD
   //! Controls whether or not the individual functions are shuffled when
   //! iterating.
   bool shuffle;
+
+  //! The number of functions in each shuffled block (0 means the functions are
+  //! shuffled individually).
+  size_t blockSize;
+
+  //! Controls whether or not the data of the function is shuffled each epoch.
+  bool shuffleData;
+
+  //! The number of gradient evaluations of individual functions.
+  size_t numEvaluations;
 };
 
 }; // namespace optimization
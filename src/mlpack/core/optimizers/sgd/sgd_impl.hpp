@@ -19,14 +19,83 @@ SGD<DecomposableFunctionType>::SGD(DecomposableFunctionType& function,
                                    const double stepSize,
                                    const size_t maxIterations,
                                    const double tolerance,
-                                   const bool shuffle) :
+                                   const bool shuffle,
+                                   const size_t blockSize,
+                                   const bool shuffleData) :
     function(function),
     stepSize(stepSize),
     maxIterations(maxIterations),
     tolerance(tolerance),
-    shuffle(shuffle)
+    shuffle(shuffle),
+    blockSize(blockSize),
+    shuffleData(shuffleData),
+    numEvaluations(0)
 { /* Nothing to do. */ }
 
+template<typename DecomposableFunctionType>
+void SGD<DecomposableFunctionType>::VisitationOrder(
+    const size_t numFunctions,
+    arma::Col<size_t>& order) const
+{
+  if (blockSize == 0 || blockSize >= numFunctions)
+  {
+    order = arma::shuffle(arma::linspace<arma::Col<size_t> >(0,
+        numFunctions - 1, numFunctions));
+    return;
+  }
+
+  // Visit the blocks in random order, and the functions of each block in
+  // random order too.
+  const size_t numBlocks = (numFunctions + blockSize - 1) / blockSize;
+  const arma::Col<size_t> blockOrder = arma::shuffle(
+      arma::linspace<arma::Col<size_t> >(0, numBlocks - 1, numBlocks));
+
+  order.set_size(numFunctions);
+  size_t position = 0;
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = blockOrder[b] * blockSize;
+    const size_t count = std::min(blockSize, numFunctions - begin);
+    order.subvec(position, position + count - 1) = arma::shuffle(
+        arma::linspace<arma::Col<size_t> >(begin, begin + count - 1, count));
+    position += count;
+  }
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+void SGD<DecomposableFunctionType>::ShuffleFunctions(
+    FunctionType& f,
+    std::future<void>& pending,
+    typename boost::enable_if_c<
+        HasPrepareShuffle<FunctionType, ShuffleType>::value
+        && HasShuffle<FunctionType, ShuffleType>::value
+    >::type*) const
+{
+  if (pending.valid())
+    pending.get();
+  else
+    f.PrepareShuffle();
+
+  f.Shuffle();
+
+  // The next permutation is prepared while this epoch runs.
+  pending = std::async(std::launch::async, [&f]() { f.PrepareShuffle(); });
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+void SGD<DecomposableFunctionType>::ShuffleFunctions(
+    FunctionType& /* f */,
+    std::future<void>& /* pending */,
+    typename boost::disable_if_c<
+        HasPrepareShuffle<FunctionType, ShuffleType>::value
+        && HasShuffle<FunctionType, ShuffleType>::value
+    >::type*) const
+{
+  // Nothing to do.
+}
+
 //! Optimize the function (minimize).
 template<typename DecomposableFunctionType>
 double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
@@ -34,11 +103,25 @@ double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
   // Find the number of functions to use.
   const size_t numFunctions = function.NumFunctions();
 
-  // This is used only if shuffle is true.
-  arma::vec visitationOrder;
-  if (shuffle)
-    visitationOrder = arma::shuffle(arma::linspace(0, (numFunctions - 1),
-        numFunctions));
+  // If the data of the function is permuted, the functions are visited in
+  // linear order.
+  const bool canShuffleData =
+      HasPrepareShuffle<DecomposableFunctionType, ShuffleType>::value &&
+      HasShuffle<DecomposableFunctionType, ShuffleType>::value;
+  if (shuffle && shuffleData && !canShuffleData)
+  {
+    Log::Warn << "SGD: the function does not implement PrepareShuffle() and "
+        << "Shuffle(); shuffling the visitation order instead." << std::endl;
+  }
+  const bool permuteData = shuffle && shuffleData && canShuffleData;
+  const bool permuteOrder = shuffle && !permuteData;
+
+  // This is used only if permuteOrder is true.
+  arma::Col<size_t> visitationOrder;
+
+  // The permutation of the data being prepared in the background.  If the
+  // optimization returns while it is running, the destructor waits for it.
+  std::future<void> pending;
 
   // To keep track of where we are and how things are going.
   size_t currentFunction = 0;
@@ -79,25 +162,24 @@ double SGD<DecomposableFunctionType>::Optimize(arma::mat& iterate)
       overallObjective = 0;
       currentFunction = 0;
 
-      if (shuffle) // Determine order of visitation.
-        visitationOrder = arma::shuffle(visitationOrder);
+      if (permuteData)
+        ShuffleFunctions(function, pending);
+      else if (permuteOrder) // Determine order of visitation.
+        VisitationOrder(numFunctions, visitationOrder);
     }
 
+    const size_t index = permuteOrder ? visitationOrder[currentFunction] :
+        currentFunction;
+
     // Evaluate the gradient for this iteration.
-    if (shuffle)
-      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
-    else
-      function.Gradient(iterate, currentFunction, gradient);
+    function.Gradient(iterate, index, gradient);
+    ++numEvaluations;
 
     // And update the iterate.
     iterate -= stepSize * gradient;
 
     // Now add that to the overall objective function.
-    if (shuffle)
-      overallObjective += function.Evaluate(iterate,
-          visitationOrder[currentFunction]);
-    else
-      overallObjective += function.Evaluate(iterate, currentFunction);
+    overallObjective += function.Evaluate(iterate, index);
   }
 
   Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
@@ -121,6 +203,9 @@ std::string SGD<DecomposableFunctionType>::ToString() const
   convert << "  Maximum iterations: " << maxIterations << std::endl;
   convert << "  Tolerance: " << tolerance << std::endl;
   convert << "  Shuffle points: " << (shuffle ? "true" : "false") << std::endl;
+  convert << "  Block size: " << blockSize << std::endl;
+  convert << "  Shuffle data: " << (shuffleData ? "true" : "false")
+      << std::endl;
   return convert.str();
 }
 
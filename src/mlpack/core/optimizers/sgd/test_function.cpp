@@ -53,3 +53,30 @@ void SGDTestFunction::Gradient(const arma::mat& coordinates,
       break;
   }
 }
+
+double SGDTestFunction::Evaluate(const arma::mat& coordinates,
+                                 const size_t begin,
+                                 const size_t batchSize) const
+{
+  double objective = 0;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+    objective += Evaluate(coordinates, i);
+
+  return objective;
+}
+
+void SGDTestFunction::Gradient(const arma::mat& coordinates,
+                               const size_t begin,
+                               const size_t batchSize,
+                               arma::mat& gradient) const
+{
+  // Each function only touches its own coordinate, so the gradients of the
+  // batch can be computed into the same vector.
+  arma::mat functionGradient;
+  gradient.zeros(3);
+  for (size_t i = begin; i < begin + batchSize; ++i)
+  {
+    Gradient(coordinates, i, functionGradient);
+    gradient[i] = functionGradient[i];
+  }
+}
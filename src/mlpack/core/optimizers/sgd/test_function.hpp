@@ -36,6 +36,17 @@ class SGDTestFunction
   void Gradient(const arma::mat& coordinates,
                 const size_t i,
                 arma::mat& gradient) const;
+
+  //! Evaluate the sum of a batch of functions.
+  double Evaluate(const arma::mat& coordinates,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  //! Evaluate the summed gradient of a batch of functions.
+  void Gradient(const arma::mat& coordinates,
+                const size_t begin,
+                const size_t batchSize,
+                arma::mat& gradient) const;
 };
 
 }; // namespace test
@@ -181,6 +181,13 @@ class BallBound
    */
   TMetricType Metric() const { return *metric; }
 
+  //! Return the number of bytes used by this bound, including its center.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(center) + util::MemoryUsage(center) +
+        (ownsMetric ? sizeof(TMetricType) : 0);
+  }
+
   /**
    * Returns a string representation of this object.
    */
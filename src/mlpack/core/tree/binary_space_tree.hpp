@@ -11,13 +11,18 @@
 #include "bounds.hpp"
 #include "binary_space_tree/midpoint_split.hpp"
 #include "binary_space_tree/mean_split.hpp"
+#include "binary_space_tree/rp_tree_split.hpp"
 #include "binary_space_tree/binary_space_tree.hpp"
 #include "binary_space_tree/single_tree_traverser.hpp"
 #include "binary_space_tree/single_tree_traverser_impl.hpp"
 #include "binary_space_tree/dual_tree_traverser.hpp"
 #include "binary_space_tree/dual_tree_traverser_impl.hpp"
+#include "binary_space_tree/best_first_single_tree_traverser.hpp"
+#include "binary_space_tree/best_first_single_tree_traverser_impl.hpp"
 #include "binary_space_tree/breadth_first_dual_tree_traverser.hpp"
 #include "binary_space_tree/breadth_first_dual_tree_traverser_impl.hpp"
+#include "binary_space_tree/parallel_dual_tree_traverser.hpp"
+#include "binary_space_tree/parallel_dual_tree_traverser_impl.hpp"
 #include "binary_space_tree/traits.hpp"
 
 #endif
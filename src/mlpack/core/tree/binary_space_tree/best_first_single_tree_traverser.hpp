@@ -0,0 +1,115 @@
+/**
+ * @file best_first_single_tree_traverser.hpp
+ * @author Ryan Curtin
+ *
+ * A nested class of BinarySpaceTree which traverses the tree for a single
+ * query point in best-first order: the node with the best score out of all
+ * nodes that have been scored so far is visited next.  The traversal can be
+ * stopped after a given number of leaves.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+#include <queue>
+
+#include "binary_space_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+    BestFirstSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the best-first traverser with the given rule set.  If
+   * maxLeaves is not 0, the traversal of each query point stops after the base
+   * cases of maxLeaves leaves have been computed.  The results are then
+   * approximate, but because the most promising leaves are visited first, they
+   * are usually close to the exact ones; this bounds the time of every query.
+   *
+   * @param rule Rules to traverse the tree with.
+   * @param maxLeaves Maximum number of leaves to visit per query (0 for no
+   *     limit).
+   */
+  BestFirstSingleTreeTraverser(RuleType& rule, const size_t maxLeaves = 0);
+
+  /**
+   * Traverse the tree with the given point.
+   *
+   * @param queryIndex The index of the point in the query set which is being
+   *     used as the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, BinarySpaceTree& referenceNode);
+
+  //! Get the maximum number of leaves visited per query (0 for no limit).
+  size_t MaxLeaves() const { return maxLeaves; }
+  //! Modify the maximum number of leaves visited per query (0 for no limit).
+  size_t& MaxLeaves() { return maxLeaves; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of leaves whose base cases have been computed.
+  size_t NumVisitedLeaves() const { return numVisitedLeaves; }
+  //! Modify the number of leaves whose base cases have been computed.
+  size_t& NumVisitedLeaves() { return numVisitedLeaves; }
+
+  //! Get the number of traversals that were stopped by the leaf budget.
+  size_t NumTruncated() const { return numTruncated; }
+  //! Modify the number of traversals that were stopped by the leaf budget.
+  size_t& NumTruncated() { return numTruncated; }
+
+ private:
+  //! A node waiting to be visited, with its score.
+  struct NodeAndScore
+  {
+    NodeAndScore(BinarySpaceTree* node, const double score) :
+        node(node), score(score) { }
+
+    BinarySpaceTree* node;
+    double score;
+
+    //! The priority queue has the best (lowest) score on top.
+    bool operator<(const NodeAndScore& other) const
+    {
+      return score > other.score;
+    }
+  };
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The maximum number of leaves to visit per query (0 for no limit).
+  size_t maxLeaves;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+
+  //! The number of leaves whose base cases have been computed.
+  size_t numVisitedLeaves;
+
+  //! The number of traversals that were stopped by the leaf budget.
+  size_t numTruncated;
+
+  //! The queue of nodes to visit, held in the class so that its memory is
+  //! reused between queries.
+  std::priority_queue<NodeAndScore> queue;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "best_first_single_tree_traverser_impl.hpp"
+
+#endif
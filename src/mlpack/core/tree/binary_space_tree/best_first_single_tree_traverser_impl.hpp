@@ -0,0 +1,99 @@
+/**
+ * @file best_first_single_tree_traverser_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the best-first single-tree traverser for the
+ * BinarySpaceTree.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_BEST_FIRST_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "best_first_single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+BestFirstSingleTreeTraverser<RuleType>::BestFirstSingleTreeTraverser(
+    RuleType& rule,
+    const size_t maxLeaves) :
+    rule(rule),
+    maxLeaves(maxLeaves),
+    numPrunes(0),
+    numVisitedLeaves(0),
+    numTruncated(0)
+{ /* Nothing to do. */ }
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+BestFirstSingleTreeTraverser<RuleType>::Traverse(
+    const size_t queryIndex,
+    BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>&
+        referenceNode)
+{
+  // The root is not scored, like in the depth-first traverser.
+  queue.push(NodeAndScore(&referenceNode, 0.0));
+
+  size_t leaves = 0;
+  while (!queue.empty())
+  {
+    BinarySpaceTree* node = queue.top().node;
+    const double score = queue.top().score;
+    queue.pop();
+
+    // The results may have improved since the node was scored.
+    if (rule.Rescore(queryIndex, *node, score) == DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    if (node->IsLeaf())
+    {
+      for (size_t i = node->Begin(); i < node->End(); ++i)
+        rule.BaseCase(queryIndex, i);
+
+      ++numVisitedLeaves;
+      if (maxLeaves != 0 && ++leaves >= maxLeaves)
+      {
+        if (!queue.empty())
+          ++numTruncated;
+        break;
+      }
+    }
+    else
+    {
+      // Queue the children that can't be pruned.
+      const double leftScore = rule.Score(queryIndex, *node->Left());
+      if (leftScore != DBL_MAX)
+        queue.push(NodeAndScore(node->Left(), leftScore));
+      else
+        ++numPrunes;
+
+      const double rightScore = rule.Score(queryIndex, *node->Right());
+      if (rightScore != DBL_MAX)
+        queue.push(NodeAndScore(node->Right(), rightScore));
+      else
+        ++numPrunes;
+    }
+  }
+
+  // Empty the queue (keeping its memory) if the traversal was stopped.
+  while (!queue.empty())
+    queue.pop();
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
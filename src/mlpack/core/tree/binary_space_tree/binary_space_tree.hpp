@@ -9,6 +9,7 @@
 #include <mlpack/core.hpp>
 
 #include "../statistic.hpp"
+#include "../tree_io.hpp"
 #include "midpoint_split.hpp"
 
 namespace mlpack {
@@ -69,6 +70,17 @@ class BinarySpaceTree
   double minimumBoundDistance;
   //! The dataset.
   MatType& dataset;
+  //! Whether or not the children of this node are stored in the contiguous
+  //! node array of a compacted tree (see Compact()).
+  bool compacted;
+  //! The contiguous node array of all descendants (only set in the root of a
+  //! compacted tree).
+  BinarySpaceTree* compactNodes;
+  //! The number of nodes in the contiguous node array.
+  size_t compactNodeCount;
+  //! The contiguous storage of the ranges of all HRectBounds (only set in the
+  //! root of a compacted tree).
+  math::Range* compactBounds;
 
  public:
   //! So other classes can use TreeType::Mat.
@@ -86,6 +98,16 @@ class BinarySpaceTree
   template<typename RuleType>
   class BreadthFirstDualTreeTraverser;
 
+  //! A best-first single-tree traverser with a budget of leaves; see
+  //! best_first_single_tree_traverser.hpp.
+  template<typename RuleType>
+  class BestFirstSingleTreeTraverser;
+
+  //! A task-parallel dual-tree traverser for binary space trees; see
+  //! parallel_dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class ParallelDualTreeTraverser;
+
   /**
    * Construct this as the root node of a binary space tree using the given
    * dataset.  This will modify the ordering of the points in the dataset!
@@ -201,6 +223,21 @@ class BinarySpaceTree
                   BinarySpaceTree* parent = NULL,
                   const size_t maxLeafSize = 20);
 
+  /**
+   * Load a binary space tree that was written with Save() from the given
+   * binary stream.  No splitting or bound computations are done; the nodes are
+   * read as they were saved.  The dataset must be the (rearranged) dataset the
+   * tree was originally built on.  Usually, it is easier to use LoadTree() (see
+   * tree_io.hpp), which stores the dataset in the same file.
+   *
+   * @param data Dataset the tree was built on.
+   * @param stream Binary stream to read the tree from.
+   * @param parent Parent of this node (NULL indicates no parent).
+   */
+  BinarySpaceTree(MatType& data,
+                  std::istream& stream,
+                  BinarySpaceTree* parent = NULL);
+
   /**
    * Create a binary space tree by copying the other tree.  Be careful!  This
    * can take a long time and use a lot of memory.
@@ -216,6 +253,33 @@ class BinarySpaceTree
    */
   ~BinarySpaceTree();
 
+  /**
+   * Relocate all descendants of this (root) node into one contiguous array, in
+   * depth-first order: the left child of every node directly follows it, and
+   * every subtree occupies a consecutive block of the array.  If the bound is
+   * an HRectBound, the ranges of the bounds of all nodes are stored in one
+   * contiguous block in the same order.  Traversals that descend the tree then
+   * touch nearby memory instead of nodes scattered across the heap.
+   *
+   * The structure of the tree and the results of any traversal don't change.
+   * The statistics are rebuilt, so this has to be called before the tree is
+   * used by an algorithm.  Any pointers or references to the descendants of
+   * this node are invalidated.  Calling this on a compacted tree does nothing.
+   */
+  void Compact();
+
+  //! Return whether or not the children of this node are stored contiguously.
+  bool Compacted() const { return compacted; }
+
+  /**
+   * Write this node and all of its descendants to the given binary stream, in
+   * depth-first order, so that it can be loaded later with the stream
+   * constructor.  The dataset is not written.
+   *
+   * @param stream Binary stream to write the tree to.
+   */
+  void Save(std::ostream& stream) const;
+
   /**
    * Find a node in this tree by its begin and count (const).
    *
@@ -406,6 +470,13 @@ class BinarySpaceTree
    */
   size_t TreeDepth() const;
 
+  /**
+   * Return the number of bytes used by the subtree rooted at this node: the
+   * nodes, their bounds, and the storage of a compacted tree.  The dataset is
+   * not counted, because it is not owned by the tree.
+   */
+  size_t MemoryUsage() const;
+
   //! Return the index of the beginning point of this subset.
   size_t Begin() const { return begin; }
   //! Modify the index of the beginning point of this subset.
@@ -448,6 +519,44 @@ class BinarySpaceTree
                  const size_t maxLeafSize,
                  SplitType& splitter);
 
+  /**
+   * Create a copy of the given node, without its children, in the node array
+   * of a compacted tree.
+   *
+   * @param other Node to copy.
+   * @param parent Parent of the new node.
+   */
+  BinarySpaceTree(const BinarySpaceTree& other, BinarySpaceTree* parent);
+
+  /**
+   * Copy the given subtree into the node array of a compacted tree, starting
+   * at the given index, and return the copy of the given node.
+   *
+   * @param node Subtree to copy.
+   * @param parent Parent of the copy.
+   * @param index Next unused index of the node array.
+   */
+  BinarySpaceTree* CompactSubtree(const BinarySpaceTree& node,
+                                  BinarySpaceTree* parent,
+                                  size_t& index);
+
+  //! Return the number of ranges a bound stores; only HRectBound is pooled.
+  template<typename OtherBoundType>
+  static size_t BoundStorageSize(const OtherBoundType& /* bound */)
+  { return 0; }
+  template<int Power, bool TakeRoot>
+  static size_t BoundStorageSize(const bound::HRectBound<Power, TakeRoot>& b)
+  { return b.Dim(); }
+
+  //! Move the ranges of a bound into external storage, if it has any.
+  template<typename OtherBoundType>
+  static void UseBoundStorage(OtherBoundType& /* bound */,
+                              math::Range* /* storage */) { }
+  template<int Power, bool TakeRoot>
+  static void UseBoundStorage(bound::HRectBound<Power, TakeRoot>& b,
+                              math::Range* storage)
+  { b.UseStorage(storage); }
+
  public:
   /**
    * Returns a string representation of this object.
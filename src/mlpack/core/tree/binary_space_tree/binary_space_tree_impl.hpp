@@ -12,6 +12,7 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <mlpack/core/util/string_util.hpp>
+#include <new>
 
 namespace mlpack {
 namespace tree {
@@ -32,11 +33,20 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(data)
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
-  // Do the actual splitting of this node.
+  // Do the actual splitting of this node.  The children of large nodes are
+  // built in parallel tasks.
   SplitType splitter;
-  SplitNode(data, maxLeafSize, splitter);
+  #pragma omp parallel if(UseParallelPartition<MatType>(data.n_cols))
+  {
+    #pragma omp single
+    SplitNode(data, maxLeafSize, splitter);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -57,16 +67,25 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(data)
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  The children of large nodes are built in
+  // parallel tasks.
   SplitType splitter;
-  SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if(UseParallelPartition<MatType>(data.n_cols))
+  {
+    #pragma omp single
+    SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -88,16 +107,25 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(data)
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
-  // Now do the actual splitting.
+  // Now do the actual splitting.  The children of large nodes are built in
+  // parallel tasks.
   SplitType splitter;
-  SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  #pragma omp parallel if(UseParallelPartition<MatType>(data.n_cols))
+  {
+    #pragma omp single
+    SplitNode(data, oldFromNew, maxLeafSize, splitter);
+  }
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -125,7 +153,11 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     begin(begin),
     count(count),
     bound(data.n_rows),
-    dataset(data)
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
   // Perform the actual splitting.
   SplitNode(data, maxLeafSize, splitter);
@@ -152,7 +184,11 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     begin(begin),
     count(count),
     bound(data.n_rows),
-    dataset(data)
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -184,7 +220,11 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     begin(begin),
     count(count),
     bound(data.n_rows),
-    dataset(data)
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -221,7 +261,11 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
     stat(other.stat),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -237,6 +281,73 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
   }
 }
 
+/**
+ * Load a binary space tree from a binary stream written by Save().
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
+    MatType& data,
+    std::istream& stream,
+    BinarySpaceTree* parent) :
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    bound(data.n_rows),
+    dataset(data),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
+{
+  char hasChildren = 0;
+  ReadBinary(stream, begin);
+  ReadBinary(stream, count);
+  ReadBinary(stream, parentDistance);
+  ReadBinary(stream, furthestDescendantDistance);
+  ReadBinary(stream, minimumBoundDistance);
+  LoadBound(stream, bound);
+  ReadBinary(stream, hasChildren);
+
+  // Don't try to read children from a broken stream.
+  if (hasChildren && !stream.fail())
+  {
+    left = new BinarySpaceTree(data, stream, this);
+    right = new BinarySpaceTree(data, stream, this);
+  }
+
+  // Create the statistic depending on if we are a leaf or not.
+  stat = StatisticType(*this);
+}
+
+/**
+ * Write this node and its descendants to a binary stream.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::Save(
+    std::ostream& stream) const
+{
+  const char hasChildren = (left != NULL) ? 1 : 0;
+  WriteBinary(stream, begin);
+  WriteBinary(stream, count);
+  WriteBinary(stream, parentDistance);
+  WriteBinary(stream, furthestDescendantDistance);
+  WriteBinary(stream, minimumBoundDistance);
+  SaveBound(stream, bound);
+  WriteBinary(stream, hasChildren);
+
+  if (hasChildren)
+  {
+    left->Save(stream);
+    right->Save(stream);
+  }
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling their
  * destructors in turn.  This will invalidate any pointers or references to any
@@ -249,10 +360,131 @@ template<typename BoundType,
 BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
   ~BinarySpaceTree()
 {
+  // The children of a compacted tree are destroyed by the root.
+  if (!compacted)
+  {
+    if (left)
+      delete left;
+    if (right)
+      delete right;
+  }
+
+  if (compactNodes)
+  {
+    for (size_t i = 0; i < compactNodeCount; ++i)
+      compactNodes[i].~BinarySpaceTree();
+    ::operator delete(compactNodes);
+  }
+
+  if (compactBounds)
+    delete[] compactBounds;
+}
+
+/**
+ * Relocate all descendants into one contiguous array, in depth-first order.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::Compact()
+{
+  if (parent != NULL)
+  {
+    Log::Fatal << "BinarySpaceTree::Compact(): only the root of a tree can be "
+        << "compacted." << std::endl;
+  }
+
+  if (compacted)
+    return;
+
+  const size_t nodes = TreeSize();
+  const size_t boundSize = BoundStorageSize(bound);
+  if (boundSize > 0)
+  {
+    compactBounds = new math::Range[nodes * boundSize];
+    UseBoundStorage(bound, compactBounds);
+  }
+
   if (left)
+  {
+    // The array is allocated uninitialized, because the nodes are constructed
+    // one by one in depth-first order.
+    compactNodeCount = nodes - 1;
+    compactNodes = static_cast<BinarySpaceTree*>(
+        ::operator new(compactNodeCount * sizeof(BinarySpaceTree)));
+
+    size_t index = 0;
+    BinarySpaceTree* newLeft = CompactSubtree(*left, this, index);
+    BinarySpaceTree* newRight = CompactSubtree(*right, this, index);
+
     delete left;
-  if (right)
     delete right;
+    left = newLeft;
+    right = newRight;
+  }
+
+  compacted = true;
+  stat = StatisticType(*this);
+}
+
+/**
+ * Create a copy of the given node, without its children.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::BinarySpaceTree(
+    const BinarySpaceTree& other,
+    BinarySpaceTree* parent) :
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    begin(other.begin),
+    count(other.count),
+    bound(other.bound),
+    parentDistance(other.parentDistance),
+    furthestDescendantDistance(other.furthestDescendantDistance),
+    minimumBoundDistance(other.minimumBoundDistance),
+    dataset(other.dataset),
+    compacted(true),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    compactBounds(NULL)
+{
+  // Nothing to do; the statistic is built once the children are copied.
+}
+
+/**
+ * Copy the given subtree into the node array, in depth-first order.
+ */
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>*
+BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::CompactSubtree(
+    const BinarySpaceTree& node,
+    BinarySpaceTree* parent,
+    size_t& index)
+{
+  BinarySpaceTree* copy = new (compactNodes + index) BinarySpaceTree(node,
+      parent);
+  if (compactBounds)
+    UseBoundStorage(copy->bound, compactBounds + (index + 1) *
+        BoundStorageSize(bound));
+  ++index;
+
+  if (node.left)
+  {
+    copy->left = CompactSubtree(*node.left, copy, index);
+    copy->right = CompactSubtree(*node.right, copy, index);
+  }
+
+  // The statistic may depend on the statistics of the children.
+  copy->stat = StatisticType(*copy);
+  return copy;
 }
 
 /**
@@ -356,6 +588,26 @@ size_t BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
                       (right ? right->TreeDepth() : 0));
 }
 
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+size_t BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+    MemoryUsage() const
+{
+  // The bound reports its own size, including what it allocates.  The nodes of
+  // a compacted tree are stored in the node array of the root, but they are
+  // counted the same way; only the shared bound storage has to be added.
+  size_t usage = sizeof(BinarySpaceTree) - sizeof(BoundType) +
+      bound.MemoryUsage();
+  if (compactBounds)
+    usage += (compactNodeCount + 1) * BoundStorageSize(bound) *
+        sizeof(math::Range);
+
+  return usage + (left ? left->MemoryUsage() : 0) +
+      (right ? right->MemoryUsage() : 0);
+}
+
 template<typename BoundType,
          typename StatisticType,
          typename MatType,
@@ -549,11 +801,16 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     return;
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
+  // by calling their constructors (which perform this splitting process).  The
+  // children cover disjoint columns of the dataset, so the left child of a
+  // large node is built in a separate task.
+  #pragma omp task if(UseParallelPartition<MatType>(count)) shared(data, \
+      splitter)
   left = new BinarySpaceTree(data, begin, splitCol - begin, splitter, this,
       maxLeafSize);
   right = new BinarySpaceTree(data, splitCol, begin + count - splitCol,
       splitter, this, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
   arma::vec centroid, leftCentroid, rightCentroid;
@@ -607,11 +864,16 @@ void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::SplitNode(
     return;
 
   // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
+  // by calling their constructors (which perform this splitting process).  The
+  // children cover disjoint columns of the dataset, so the left child of a
+  // large node is built in a separate task.
+  #pragma omp task if(UseParallelPartition<MatType>(count)) shared(data, \
+      oldFromNew, splitter)
   left = new BinarySpaceTree(data, begin, splitCol - begin, oldFromNew,
       splitter, this, maxLeafSize);
   right = new BinarySpaceTree(data, splitCol, begin + count - splitCol,
       oldFromNew, splitter, this, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
   arma::vec centroid, leftCentroid, rightCentroid;
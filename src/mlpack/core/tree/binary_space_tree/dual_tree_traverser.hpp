@@ -12,6 +12,8 @@
 
 #include <mlpack/core.hpp>
 
+#include <mlpack/core/util/sfinae_utility.hpp>
+
 #include "binary_space_tree.hpp"
 
 namespace mlpack {
@@ -46,6 +48,12 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
   //! Modify the number of prunes.
   size_t& NumPrunes() { return numPrunes; }
 
+  //! Get the number of prunes that were found by rescoring a node (these are
+  //! included in the number of prunes).
+  size_t NumRescorePrunes() const { return numRescorePrunes; }
+  //! Modify the number of prunes that were found by rescoring a node.
+  size_t& NumRescorePrunes() { return numRescorePrunes; }
+
   //! Get the number of visited combinations.
   size_t NumVisited() const { return numVisited; }
   //! Modify the number of visited combinations.
@@ -68,6 +76,9 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
   //! The number of prunes.
   size_t numPrunes;
 
+  //! The number of prunes that were found by rescoring a node.
+  size_t numRescorePrunes;
+
   //! The number of node combinations that have been visited during traversal.
   size_t numVisited;
 
@@ -80,6 +91,27 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
   //! Traversal information, held in the class so that it isn't continually
   //! being reallocated.
   typename RuleType::TraversalInfoType traversalInfo;
+
+  HAS_MEM_FUNC(BaseCaseBlock, HasBaseCaseBlock)
+
+  //! The signature of a batched BaseCaseBlock() function of the rules.
+  typedef size_t (RuleType::*BaseCaseBlockType)(const size_t, const size_t,
+      const size_t, const size_t);
+
+  //! Perform the base cases of two leaves with a single call to the
+  //! BaseCaseBlock() function of the rules.
+  template<typename R>
+  void LeafBaseCases(BinarySpaceTree& queryNode,
+                     BinarySpaceTree& referenceNode,
+                     typename boost::enable_if<HasBaseCaseBlock<R,
+                         BaseCaseBlockType> >::type* = 0);
+
+  //! Perform the base cases of two leaves one query point at a time.
+  template<typename R>
+  void LeafBaseCases(BinarySpaceTree& queryNode,
+                     BinarySpaceTree& referenceNode,
+                     typename boost::disable_if<HasBaseCaseBlock<R,
+                         BaseCaseBlockType> >::type* = 0);
 };
 
 }; // namespace tree
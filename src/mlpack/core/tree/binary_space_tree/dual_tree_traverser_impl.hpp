@@ -24,6 +24,7 @@ BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
 DualTreeTraverser<RuleType>::DualTreeTraverser(RuleType& rule) :
     rule(rule),
     numPrunes(0),
+    numRescorePrunes(0),
     numVisited(0),
     numScores(0),
     numBaseCases(0)
@@ -49,23 +50,7 @@ DualTreeTraverser<RuleType>::Traverse(
   // If both are leaves, we must evaluate the base case.
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    // Loop through each of the points in each node.
-    for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
-    {
-      // See if we need to investigate this point (this function should be
-      // implemented for the single-tree recursion too).  Restore the traversal
-      // information first.
-      rule.TraversalInfo() = traversalInfo;
-      const double childScore = rule.Score(query, referenceNode);
-
-      if (childScore == DBL_MAX)
-        continue; // We can't improve this particular point.
-
-      for (size_t ref = referenceNode.Begin(); ref < referenceNode.End(); ++ref)
-        rule.BaseCase(query, ref);
-
-      numBaseCases += referenceNode.Count();
-    }
+    LeafBaseCases<RuleType>(queryNode, referenceNode);
   }
   else if (((!queryNode.IsLeaf()) && referenceNode.IsLeaf()) ||
            (queryNode.NumDescendants() > 3 * referenceNode.NumDescendants() &&
@@ -120,7 +105,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(queryNode, *referenceNode.Right());
       }
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -137,7 +125,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(queryNode, *referenceNode.Left());
       }
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else // leftScore is equal to rightScore.
     {
@@ -163,7 +154,10 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(queryNode, *referenceNode.Right());
         }
         else
+        {
           ++numPrunes;
+          ++numRescorePrunes;
+        }
       }
     }
   }
@@ -199,7 +193,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Right());
       }
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -217,7 +214,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Left(), *referenceNode.Left());
       }
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else
     {
@@ -244,7 +244,10 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(*queryNode.Left(), *referenceNode.Right());
         }
         else
+        {
           ++numPrunes;
+          ++numRescorePrunes;
+        }
       }
     }
 
@@ -277,7 +280,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Right());
       }
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -295,7 +301,10 @@ DualTreeTraverser<RuleType>::Traverse(
         Traverse(*queryNode.Right(), *referenceNode.Left());
       }
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else
     {
@@ -322,12 +331,63 @@ DualTreeTraverser<RuleType>::Traverse(
           Traverse(*queryNode.Right(), *referenceNode.Right());
         }
         else
+        {
           ++numPrunes;
+          ++numRescorePrunes;
+        }
       }
     }
   }
 }
 
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+template<typename R>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+DualTreeTraverser<RuleType>::LeafBaseCases(
+    BinarySpaceTree& queryNode,
+    BinarySpaceTree& referenceNode,
+    typename boost::enable_if<HasBaseCaseBlock<R, BaseCaseBlockType> >::type*)
+{
+  // The rules handle the whole block of points at once.
+  numBaseCases += rule.BaseCaseBlock(queryNode.Begin(), queryNode.End(),
+      referenceNode.Begin(), referenceNode.End());
+}
+
+template<typename BoundType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType>
+template<typename RuleType>
+template<typename R>
+void BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
+DualTreeTraverser<RuleType>::LeafBaseCases(
+    BinarySpaceTree& queryNode,
+    BinarySpaceTree& referenceNode,
+    typename boost::disable_if<HasBaseCaseBlock<R, BaseCaseBlockType> >::type*)
+{
+  // Loop through each of the points in each node.
+  for (size_t query = queryNode.Begin(); query < queryNode.End(); ++query)
+  {
+    // See if we need to investigate this point (this function should be
+    // implemented for the single-tree recursion too).  Restore the traversal
+    // information first.
+    rule.TraversalInfo() = traversalInfo;
+    const double childScore = rule.Score(query, referenceNode);
+
+    if (childScore == DBL_MAX)
+      continue; // We can't improve this particular point.
+
+    for (size_t ref = referenceNode.Begin(); ref < referenceNode.End(); ++ref)
+      rule.BaseCase(query, ref);
+
+    numBaseCases += referenceNode.Count();
+  }
+}
+
 }; // namespace tree
 }; // namespace mlpack
 
@@ -178,6 +178,11 @@ size_t MeanSplit<BoundType, MatType>::
                  const size_t splitDimension,
                  const double splitVal)
 {
+  // Large nodes are partitioned with all threads.
+  if (UseParallelPartition<MatType>(count))
+    return ParallelPartition(data, begin, count, splitDimension, splitVal,
+        (std::vector<size_t>*) NULL);
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.  The points less than
   // splitVal should be on the left side of the matrix, and the points greater
@@ -225,6 +230,11 @@ size_t MeanSplit<BoundType, MatType>::
                  const double splitVal,
                  std::vector<size_t>& oldFromNew)
 {
+  // Large nodes are partitioned with all threads.
+  if (UseParallelPartition<MatType>(count))
+    return ParallelPartition(data, begin, count, splitDimension, splitVal,
+        &oldFromNew);
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.  The points less than
   // splitVal should be on the left side of the matrix, and the points greater
@@ -12,6 +12,8 @@
 
 #include <mlpack/core.hpp>
 
+#include "parallel_partition.hpp"
+
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
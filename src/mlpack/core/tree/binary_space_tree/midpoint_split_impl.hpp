@@ -165,6 +165,11 @@ size_t MidpointSplit<BoundType, MatType>::PerformSplit(
     const size_t splitDimension,
     const double splitVal)
 {
+  // Large nodes are partitioned with all threads.
+  if (UseParallelPartition<MatType>(count))
+    return ParallelPartition(data, begin, count, splitDimension, splitVal,
+        (std::vector<size_t>*) NULL);
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.  The points less than
   // splitVal should be on the left side of the matrix, and the points greater
@@ -212,6 +217,11 @@ size_t MidpointSplit<BoundType, MatType>::PerformSplit(
     const double splitVal,
     std::vector<size_t>& oldFromNew)
 {
+  // Large nodes are partitioned with all threads.
+  if (UseParallelPartition<MatType>(count))
+    return ParallelPartition(data, begin, count, splitDimension, splitVal,
+        &oldFromNew);
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.  The points less than
   // splitVal should be on the left side of the matrix, and the points greater
@@ -0,0 +1,133 @@
+/**
+ * @file parallel_partition.hpp
+ * @author Ryan Curtin
+ *
+ * A partition of the points of a node that uses all threads, for the splits of
+ * large nodes of a BinarySpaceTree.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_PARTITION_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_PARTITION_HPP
+
+#include <mlpack/core.hpp>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Nodes with at least this many points are partitioned with all threads, and
+ * their children are built in parallel.  Smaller nodes are split in place by a
+ * single thread.
+ */
+const size_t ParallelSplitSize = 1 << 15;
+
+/**
+ * Return whether or not the points of a node of the given size should be
+ * partitioned with ParallelPartition().  Sparse matrices are always split in
+ * place, because copying their columns is expensive.
+ */
+template<typename MatType>
+inline bool UseParallelPartition(const size_t count)
+{
+#ifdef _OPENMP
+  return (count >= ParallelSplitSize) && !arma::is_SpMat<MatType>::value &&
+      (omp_get_max_threads() > 1);
+#else
+  (void) count;
+  return false;
+#endif
+}
+
+/**
+ * Reorder the points [begin, begin + count) of the dataset such that the
+ * points with a value less than splitVal in dimension splitDimension come
+ * first.  The relative order of the points on each side is kept.  The points
+ * are scattered into a temporary matrix by chunks, whose offsets are given by
+ * a prefix sum over the number of points per chunk that go to the left, so
+ * every task works on its own chunk.  This has to be called inside a parallel
+ * region (like the one of the BinarySpaceTree constructors); otherwise the
+ * tasks are run one after another.
+ *
+ * @param data The dataset used by the binary space tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitDimension The dimension to split the node on.
+ * @param splitVal The split in dimension splitDimension is based on this
+ *    value.
+ * @param oldFromNew Vector of the old positions of the points, which is
+ *    reordered in the same way (or NULL).
+ * @return The index of the first point that goes to the right.
+ */
+template<typename MatType>
+size_t ParallelPartition(MatType& data,
+                         const size_t begin,
+                         const size_t count,
+                         const size_t splitDimension,
+                         const double splitVal,
+                         std::vector<size_t>* oldFromNew)
+{
+#ifdef _OPENMP
+  const size_t numChunks = 4 * omp_get_max_threads();
+#else
+  const size_t numChunks = 1;
+#endif
+  const size_t chunkSize = (count + numChunks - 1) / numChunks;
+
+  // Count the points of every chunk that go to the left.  The tree is built
+  // inside a parallel region, so the chunks are tasks of its threads.
+  std::vector<size_t> leftCounts(numChunks + 1, 0);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    #pragma omp task shared(data, leftCounts)
+    {
+      const size_t end = std::min(begin + (c + 1) * chunkSize, begin + count);
+      for (size_t i = begin + c * chunkSize; i < end; ++i)
+        if (data(splitDimension, i) < splitVal)
+          ++leftCounts[c + 1];
+    }
+  }
+  #pragma omp taskwait
+
+  for (size_t c = 1; c <= numChunks; ++c)
+    leftCounts[c] += leftCounts[c - 1];
+  const size_t numLeft = leftCounts[numChunks];
+
+  // Scatter the points of every chunk to their new positions.
+  MatType partitioned(data.n_rows, count);
+  std::vector<size_t> partitionedIndices((oldFromNew == NULL) ? 0 : count);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    #pragma omp task shared(data, leftCounts, partitioned, partitionedIndices)
+    {
+      const size_t chunkBegin = std::min(c * chunkSize, count);
+      const size_t end = std::min((c + 1) * chunkSize, count);
+      size_t leftPos = leftCounts[c];
+      size_t rightPos = numLeft + (chunkBegin - leftCounts[c]);
+      for (size_t i = chunkBegin; i < end; ++i)
+      {
+        const size_t pos = (data(splitDimension, begin + i) < splitVal) ?
+            leftPos++ : rightPos++;
+        partitioned.col(pos) = data.col(begin + i);
+        if (oldFromNew != NULL)
+          partitionedIndices[pos] = (*oldFromNew)[begin + i];
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  data.cols(begin, begin + count - 1) = partitioned;
+  if (oldFromNew != NULL)
+    std::copy(partitionedIndices.begin(), partitionedIndices.end(),
+        oldFromNew->begin() + begin);
+
+  return begin + numLeft;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file rp_tree_split.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of RPTreeSplit, a class that splits a binary space partitioning
+ * tree node into two parts with a hyperplane along a random direction.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_RP_TREE_SPLIT_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_RP_TREE_SPLIT_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * A binary space partitioning tree node is split into its left and right child
+ * by a hyperplane that is orthogonal to a random direction.  The points are
+ * projected onto the direction, and divided into two parts at the median of
+ * the projections.  A BinarySpaceTree built with this split is a random
+ * projection tree (RP-tree); it adapts to the intrinsic dimension of the data,
+ * so it stays useful for high-dimensional data that lies near a
+ * low-dimensional manifold, where the axis-aligned splits of kd-trees are of
+ * little help.  For more information, see
+ *
+ * @code
+ * @inproceedings{dasgupta2008random,
+ *   title={Random projection trees and low dimensional manifolds},
+ *   author={Dasgupta, Sanjoy and Freund, Yoav},
+ *   booktitle={Proceedings of the 40th Annual ACM Symposium on Theory of
+ *       Computing (STOC '08)},
+ *   pages={537--546},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * The random direction of each node is drawn from a random stream (see
+ * math::RandomStream()) that only depends on the node, so the tree is the same
+ * for any number of threads after math::RandomSeed().  Since the bound of each
+ * node is still computed from its points, any bound type can be used.
+ *
+ * RP-trees are most useful for approximate search; see
+ * NeighborSearch::Defeatist().
+ */
+template<typename BoundType, typename MatType = arma::mat>
+class RPTreeSplit
+{
+ public:
+  /**
+   * Create the split object.  This draws the offset of the random streams of
+   * the nodes from math::randGen.
+   */
+  RPTreeSplit();
+
+  /**
+   * Split the node along a random direction, at the median of the projections
+   * of its points.
+   *
+   * @param bound The bound used for this node.
+   * @param data The dataset used by the binary space tree.
+   * @param begin Index of the starting point in the dataset that belongs to
+   *    this node.
+   * @param count Number of points in this node.
+   * @param splitCol The index at which the dataset is divided into two parts
+   *    after the rearrangement.
+   */
+  bool SplitNode(const BoundType& bound,
+                 MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 size_t& splitCol) const;
+
+  /**
+   * Split the node along a random direction, at the median of the projections
+   * of its points, and return a list of changed indices.
+   *
+   * @param bound The bound used for this node.
+   * @param data The dataset used by the binary space tree.
+   * @param begin Index of the starting point in the dataset that belongs to
+   *    this node.
+   * @param count Number of points in this node.
+   * @param splitCol The index at which the dataset is divided into two parts
+   *    after the rearrangement.
+   * @param oldFromNew Vector which will be filled with the old positions for
+   *    each new point.
+   */
+  bool SplitNode(const BoundType& bound,
+                 MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 size_t& splitCol,
+                 std::vector<size_t>& oldFromNew) const;
+
+ private:
+  //! The offset of the random streams of the nodes.
+  size_t streamOffset;
+
+  /**
+   * Project the points of the node onto a random direction and find the split
+   * value.  Returns false if all the points have the same projection.
+   *
+   * @param data The dataset used by the binary space tree.
+   * @param begin Index of the starting point in the dataset that belongs to
+   *    this node.
+   * @param count Number of points in this node.
+   * @param projections Will be filled with the projections of the points.
+   * @param splitVal Will be set to the split value; the points whose
+   *    projection is less than splitVal go to the left child.
+   */
+  bool Project(const MatType& data,
+               const size_t begin,
+               const size_t count,
+               arma::rowvec& projections,
+               double& splitVal) const;
+
+  /**
+   * Reorder the dataset into two parts such that they lie on either side of
+   * splitCol.
+   *
+   * @param data The dataset used by the binary space tree.
+   * @param begin Index of the starting point in the dataset that belongs to
+   *    this node.
+   * @param count Number of points in this node.
+   * @param projections The projections of the points, which are reordered
+   *    with them.
+   * @param splitVal The split value.
+   * @param oldFromNew Vector of the old positions of the points, which is
+   *    reordered in the same way (or NULL).
+   */
+  static size_t PerformSplit(MatType& data,
+                             const size_t begin,
+                             const size_t count,
+                             arma::rowvec& projections,
+                             const double splitVal,
+                             std::vector<size_t>* oldFromNew);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "rp_tree_split_impl.hpp"
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file rp_tree_split_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of RPTreeSplit, the random projection split of a binary space
+ * partitioning tree.
+ */
+#ifndef __MLPACK_CORE_TREE_BINARY_SPACE_TREE_RP_TREE_SPLIT_IMPL_HPP
+#define __MLPACK_CORE_TREE_BINARY_SPACE_TREE_RP_TREE_SPLIT_IMPL_HPP
+
+#include "rp_tree_split.hpp"
+
+#include <algorithm>
+
+namespace mlpack {
+namespace tree {
+
+template<typename BoundType, typename MatType>
+RPTreeSplit<BoundType, MatType>::RPTreeSplit() :
+    streamOffset((size_t) math::randGen())
+{
+  // Nothing else to do.
+}
+
+template<typename BoundType, typename MatType>
+bool RPTreeSplit<BoundType, MatType>::SplitNode(const BoundType& /* bound */,
+                                                MatType& data,
+                                                const size_t begin,
+                                                const size_t count,
+                                                size_t& splitCol) const
+{
+  arma::rowvec projections;
+  double splitVal;
+  if (!Project(data, begin, count, projections, splitVal))
+    return false; // All these points are the same.  We can't split.
+
+  splitCol = PerformSplit(data, begin, count, projections, splitVal, NULL);
+
+  return true;
+}
+
+template<typename BoundType, typename MatType>
+bool RPTreeSplit<BoundType, MatType>::SplitNode(
+    const BoundType& /* bound */,
+    MatType& data,
+    const size_t begin,
+    const size_t count,
+    size_t& splitCol,
+    std::vector<size_t>& oldFromNew) const
+{
+  arma::rowvec projections;
+  double splitVal;
+  if (!Project(data, begin, count, projections, splitVal))
+    return false; // All these points are the same.  We can't split.
+
+  splitCol = PerformSplit(data, begin, count, projections, splitVal,
+      &oldFromNew);
+
+  return true;
+}
+
+template<typename BoundType, typename MatType>
+bool RPTreeSplit<BoundType, MatType>::Project(const MatType& data,
+                                              const size_t begin,
+                                              const size_t count,
+                                              arma::rowvec& projections,
+                                              double& splitVal) const
+{
+  // Each node is identified by its first point and its size, so it gets its
+  // own stream, no matter which thread builds it.
+  std::mt19937 generator = math::RandomStream(streamOffset + begin +
+      count * data.n_cols);
+  std::normal_distribution<> normal;
+
+  arma::vec direction(data.n_rows);
+  for (size_t d = 0; d < data.n_rows; ++d)
+    direction[d] = normal(generator);
+
+  projections = direction.t() * data.cols(begin, begin + count - 1);
+
+  // Split at the median of the projections.
+  std::vector<double> sorted(projections.begin(), projections.end());
+  std::nth_element(sorted.begin(), sorted.begin() + count / 2, sorted.end());
+  splitVal = sorted[count / 2];
+
+  // If the median is also the minimum, the points below it would be empty, so
+  // split just above the minimum instead.
+  const double minVal = *std::min_element(sorted.begin(), sorted.begin() +
+      count / 2 + 1);
+  if (splitVal == minVal)
+  {
+    splitVal = DBL_MAX;
+    for (size_t i = 0; i < count; ++i)
+      if (projections[i] > minVal && projections[i] < splitVal)
+        splitVal = projections[i];
+
+    if (splitVal == DBL_MAX)
+      return false;
+  }
+
+  return true;
+}
+
+template<typename BoundType, typename MatType>
+size_t RPTreeSplit<BoundType, MatType>::PerformSplit(
+    MatType& data,
+    const size_t begin,
+    const size_t count,
+    arma::rowvec& projections,
+    const double splitVal,
+    std::vector<size_t>* oldFromNew)
+{
+  // The points with a projection less than splitVal go to the left side of the
+  // matrix, and the other points go to the right side.  The projections are
+  // indexed relative to begin.
+  size_t left = 0;
+  size_t right = count - 1;
+
+  while (true)
+  {
+    while (left <= right && projections[left] < splitVal)
+      ++left;
+    while (right > left && projections[right] >= splitVal)
+      --right;
+
+    if (left >= right)
+      break;
+
+    data.swap_cols(begin + left, begin + right);
+    std::swap(projections[left], projections[right]);
+    if (oldFromNew != NULL)
+      std::swap((*oldFromNew)[begin + left], (*oldFromNew)[begin + right]);
+  }
+
+  return begin + left;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -44,12 +44,21 @@ class BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
   //! Modify the number of prunes.
   size_t& NumPrunes() { return numPrunes; }
 
+  //! Get the number of prunes that were found by rescoring a node (these are
+  //! included in the number of prunes).
+  size_t NumRescorePrunes() const { return numRescorePrunes; }
+  //! Modify the number of prunes that were found by rescoring a node.
+  size_t& NumRescorePrunes() { return numRescorePrunes; }
+
  private:
   //! Reference to the rules with which the tree will be traversed.
   RuleType& rule;
 
   //! The number of nodes which have been pruned during traversal.
   size_t numPrunes;
+
+  //! The number of prunes that were found by rescoring a node.
+  size_t numRescorePrunes;
 };
 
 }; // namespace tree
@@ -25,7 +25,8 @@ template<typename RuleType>
 BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>::
 SingleTreeTraverser<RuleType>::SingleTreeTraverser(RuleType& rule) :
     rule(rule),
-    numPrunes(0)
+    numPrunes(0),
+    numRescorePrunes(0)
 { /* Nothing to do. */ }
 
 template<typename BoundType,
@@ -62,7 +63,10 @@ SingleTreeTraverser<RuleType>::Traverse(
       if (rightScore != DBL_MAX)
         Traverse(queryIndex, *referenceNode.Right()); // Recurse to the right.
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else if (rightScore < leftScore)
     {
@@ -75,7 +79,10 @@ SingleTreeTraverser<RuleType>::Traverse(
       if (leftScore != DBL_MAX)
         Traverse(queryIndex, *referenceNode.Left()); // Recurse to the left.
       else
+      {
         ++numPrunes;
+        ++numRescorePrunes;
+      }
     }
     else // leftScore is equal to rightScore.
     {
@@ -95,7 +102,10 @@ SingleTreeTraverser<RuleType>::Traverse(
         if (rightScore != DBL_MAX)
           Traverse(queryIndex, *referenceNode.Right());
         else
+        {
           ++numPrunes;
+          ++numRescorePrunes;
+        }
       }
     }
   }
@@ -51,6 +51,12 @@ class TreeTraits<BinarySpaceTree<BoundType, StatisticType, MatType, SplitType>>
    * This is always a binary tree.
    */
   static const bool BinaryTree = true;
+
+  /**
+   * Points are only held in leaves, each of which is a contiguous range of the
+   * rearranged dataset, and leaf pairs are evaluated with BaseCaseBlock().
+   */
+  static const bool HasContiguousLeaves = true;
 };
 
 } // namespace tree
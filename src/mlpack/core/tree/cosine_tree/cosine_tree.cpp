@@ -22,13 +22,11 @@ CosineTree::CosineTree(const arma::mat& dataset) :
   indices.resize(numColumns);
   l2NormsSquared.zeros(numColumns);
 
-  // Set indices and calculate squared norms of the columns.
+  // Set indices and calculate squared norms of the columns.  The norms are
+  // passed on to the children, so they are only calculated here.
   for(size_t i = 0; i < numColumns; i++)
-  {
     indices[i] = i;
-    double l2Norm = arma::norm(dataset.col(i), 2);
-    l2NormsSquared(i) = l2Norm * l2Norm;
-  }
+  l2NormsSquared = arma::trans(arma::sum(arma::square(dataset), 0));
 
   // Frobenius norm of columns in the node.
   frobNormSquared = arma::accu(l2NormsSquared);
@@ -36,6 +34,7 @@ CosineTree::CosineTree(const arma::mat& dataset) :
   // Calculate centroid of columns in the node.
   CalculateCentroid();
 
+  CalculateDistribution();
   splitPointIndex = ColumnSampleLS();
 }
 
@@ -64,6 +63,7 @@ CosineTree::CosineTree(CosineTree& parentNode,
   // Calculate centroid of columns in the node.
   CalculateCentroid();
 
+  CalculateDistribution();
   splitPointIndex = ColumnSampleLS();
 }
 
@@ -103,27 +103,33 @@ CosineTree::CosineTree(const arma::mat& dataset,
     currentLeft = currentNode->Left();
     currentRight = currentNode->Right();
 
-    // Calculate basis vectors of left and right children.
+    // Calculate basis vectors of left and right children.  The basis of the
+    // nodes in the queue is collected in a matrix once, and extended with the
+    // new basis vectors, so that all the projections are matrix products.
     arma::vec lBasisVector, rBasisVector;
+    arma::mat queueBasis;
+    QueueBasis(treeQueue, queueBasis);
 
-    ModifiedGramSchmidt(treeQueue, currentLeft->Centroid(), lBasisVector);
-    ModifiedGramSchmidt(treeQueue, currentRight->Centroid(), rBasisVector,
-                        &lBasisVector);
+    ModifiedGramSchmidt(queueBasis, currentLeft->Centroid(), lBasisVector);
+    queueBasis.insert_cols(queueBasis.n_cols, lBasisVector);
+    ModifiedGramSchmidt(queueBasis, currentRight->Centroid(), rBasisVector);
+    queueBasis.insert_cols(queueBasis.n_cols, rBasisVector);
 
     // Add basis vectors to their respective nodes.
     currentLeft->BasisVector(lBasisVector);
     currentRight->BasisVector(rBasisVector);
 
     // Calculate Monte Carlo error estimates for child nodes.
-    MonteCarloError(currentLeft, treeQueue, &lBasisVector, &rBasisVector);
-    MonteCarloError(currentRight, treeQueue, &lBasisVector, &rBasisVector);
+    MonteCarloError(currentLeft, queueBasis);
+    MonteCarloError(currentRight, queueBasis);
 
     // Push child nodes into the priority queue.
     treeQueue.push(currentLeft);
     treeQueue.push(currentRight);
 
-    // Calculate Monte Carlo error estimate for the root node.
-    monteCarloError = MonteCarloError(&root, treeQueue);
+    // Calculate Monte Carlo error estimate for the root node.  The basis of the
+    // queue is now exactly queueBasis.
+    monteCarloError = MonteCarloError(&root, queueBasis);
   }
 
   // Construct the subspace basis from the current priority queue.
@@ -143,29 +149,21 @@ void CosineTree::ModifiedGramSchmidt(CosineNodeQueue& treeQueue,
                                      arma::vec& newBasisVector,
                                      arma::vec* addBasisVector)
 {
-  // Set new basis vector to centroid.
-  newBasisVector = centroid;
+  arma::mat queueBasis;
+  QueueBasis(treeQueue, queueBasis, addBasisVector);
 
-  // Variables for iterating throught the priority queue.
-  CosineTree *currentNode;
-  CosineNodeQueue::const_iterator i = treeQueue.begin();
+  ModifiedGramSchmidt(queueBasis, centroid, newBasisVector);
+}
 
+void CosineTree::ModifiedGramSchmidt(const arma::mat& basis,
+                                     const arma::vec& centroid,
+                                     arma::vec& newBasisVector)
+{
   // For every vector in the current basis, remove its projection from the
   // centroid.
-  for(; i != treeQueue.end(); i++)
-  {
-    currentNode = *i;
-
-    double projection = arma::dot(currentNode->BasisVector(), centroid);
-    newBasisVector -= projection * currentNode->BasisVector();
-  }
-
-  // If additional basis vector is passed, take it into account.
-  if(addBasisVector)
-  {
-    double projection = arma::dot(*addBasisVector, centroid);
-    newBasisVector -= *addBasisVector * projection;
-  }
+  newBasisVector = centroid;
+  if (basis.n_cols > 0)
+    newBasisVector -= basis * (arma::trans(basis) * centroid);
 
   // Normalize the modified centroid vector.
   if(arma::norm(newBasisVector, 2))
@@ -176,6 +174,18 @@ double CosineTree::MonteCarloError(CosineTree* node,
                                    CosineNodeQueue& treeQueue,
                                    arma::vec* addBasisVector1,
                                    arma::vec* addBasisVector2)
+{
+  // Both additional basis vectors are taken into account, or none.
+  arma::mat queueBasis;
+  if (addBasisVector1 && addBasisVector2)
+    QueueBasis(treeQueue, queueBasis, addBasisVector1, addBasisVector2);
+  else
+    QueueBasis(treeQueue, queueBasis);
+
+  return MonteCarloError(node, queueBasis);
+}
+
+double CosineTree::MonteCarloError(CosineTree* node, const arma::mat& basis)
 {
   std::vector<size_t> sampledIndices;
   arma::vec probabilities;
@@ -185,55 +195,24 @@ double CosineTree::MonteCarloError(CosineTree* node,
   size_t numSamples = log(node->NumColumns()) + 1;
   node->ColumnSamplesLS(sampledIndices, probabilities, numSamples);
 
-  // Get pointer to the original dataset.
-  arma::mat dataset = node->GetDataset();
+  // Collect the samples, and project all of them onto the current basis at
+  // once.
+  const arma::mat& dataset = node->GetDataset();
+  arma::mat samples(dataset.n_rows, numSamples);
+  for(size_t i = 0; i < numSamples; i++)
+    samples.col(i) = dataset.col(sampledIndices[i]);
 
-  // Initialize weighted projection magnitudes as zeros.
+  // Calculate the weighted projection magnitudes, the Frobenius norms squared
+  // of the projected vectors divided by their probabilities.
   arma::vec weightedMagnitudes;
-  weightedMagnitudes.zeros(numSamples);
-
-  // Set size of projection vector, depending on whether additional basis
-  // vectors are passed.
-  size_t projectionSize;
-  if(addBasisVector1 && addBasisVector2)
-    projectionSize = treeQueue.size() + 2;
+  if (basis.n_cols > 0)
+  {
+    weightedMagnitudes = arma::trans(arma::sum(arma::square(
+        arma::trans(basis) * samples), 0)) / probabilities;
+  }
   else
-    projectionSize = treeQueue.size();
-
-  // For each sample, calculate the weighted projection onto the current basis.
-  for(size_t i = 0; i < numSamples; i++)
   {
-    // Initialize projection as a vector of zeros.
-    arma::vec projection;
-    projection.zeros(projectionSize);
-
-    CosineTree *currentNode;
-    CosineNodeQueue::const_iterator j = treeQueue.begin();
-
-    size_t k = 0;
-    // Compute the projection of the sampled vector onto the existing subspace.
-    for(; j != treeQueue.end(); j++, k++)
-    {
-      currentNode = *j;
-
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                currentNode->BasisVector());
-    }
-    // If two additional vectors are passed, take their projections.
-    if(addBasisVector1 && addBasisVector2)
-    {
-      projection(k++) = arma::dot(dataset.col(sampledIndices[i]),
-                                  *addBasisVector1);
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                *addBasisVector2);
-    }
-
-    // Calculate the Frobenius norm squared of the projected vector.
-    double frobProjection = arma::norm(projection, "frob");
-    double frobProjectionSquared = frobProjection * frobProjection;
-
-    // Calculate the weighted projection magnitude.
-    weightedMagnitudes(i) = frobProjectionSquared / probabilities(i);
+    weightedMagnitudes.zeros(numSamples);
   }
 
   // Compute mean and standard deviation of the weighted samples.
@@ -257,6 +236,25 @@ double CosineTree::MonteCarloError(CosineTree* node,
   return (node->FrobNormSquared() - lowerBound);
 }
 
+void CosineTree::QueueBasis(const CosineNodeQueue& treeQueue,
+                            arma::mat& queueBasis,
+                            const arma::vec* addBasisVector1,
+                            const arma::vec* addBasisVector2) const
+{
+  queueBasis.set_size(dataset.n_rows, treeQueue.size() +
+      (addBasisVector1 ? 1 : 0) + (addBasisVector2 ? 1 : 0));
+
+  size_t k = 0;
+  CosineNodeQueue::const_iterator i = treeQueue.begin();
+  for(; i != treeQueue.end(); i++, k++)
+    queueBasis.col(k) = (*i)->BasisVector();
+
+  if (addBasisVector1)
+    queueBasis.col(k++) = *addBasisVector1;
+  if (addBasisVector2)
+    queueBasis.col(k++) = *addBasisVector2;
+}
+
 void CosineTree::ConstructBasis(CosineNodeQueue& treeQueue)
 {
   // Initialize basis as matrix of zeros.
@@ -315,16 +313,6 @@ void CosineTree::ColumnSamplesLS(std::vector<size_t>& sampledIndices,
                                  arma::vec& probabilities,
                                  size_t numSamples)
 {
-  // Initialize the cumulative distribution vector size.
-  arma::vec cDistribution;
-  cDistribution.zeros(numColumns + 1);
-
-  // Calculate cumulative length-squared distribution for the node.
-  for(size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i+1) = cDistribution(i) + l2NormsSquared(i) / frobNormSquared;
-  }
-
   // Intialize sizes of the 'sampledIndices' and 'probabilities' vectors.
   sampledIndices.resize(numSamples);
   probabilities.zeros(numSamples);
@@ -350,16 +338,6 @@ size_t CosineTree::ColumnSampleLS()
     return 0;
   }
 
-  // Initialize the cumulative distribution vector size.
-  arma::vec cDistribution;
-  cDistribution.zeros(numColumns + 1);
-
-  // Calculate cumulative length-squared distribution for the node.
-  for(size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i+1) = cDistribution(i) + l2NormsSquared(i) / frobNormSquared;
-  }
-
   // Generate a random value for sampling.
   double randValue = arma::randu();
   size_t start = 0, end = numColumns;
@@ -368,6 +346,16 @@ size_t CosineTree::ColumnSampleLS()
   return BinarySearch(cDistribution, randValue, start, end);
 }
 
+void CosineTree::CalculateDistribution()
+{
+  // Calculate cumulative length-squared distribution for the node.
+  cDistribution.zeros(numColumns + 1);
+  for(size_t i = 0; i < numColumns; i++)
+  {
+    cDistribution(i+1) = cDistribution(i) + l2NormsSquared(i) / frobNormSquared;
+  }
+}
+
 size_t CosineTree::BinarySearch(arma::vec& cDistribution,
                                 double value,
                                 size_t start,
@@ -401,6 +389,10 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
   // Initialize cosine vector as a vector of zeros.
   cosines.zeros(numColumns);
 
+  const arma::vec splitPoint = dataset.col(indices[splitPointIndex]);
+
+  // The columns are independent, so large nodes are handled in parallel.
+  #pragma omp parallel for schedule(static) if(numColumns >= ParallelColumns)
   for(size_t i = 0; i < numColumns; i++)
   {
     // If norm is zero, store cosine value as zero. Else, calculate cosine value
@@ -411,8 +403,7 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
     }
     else
     {
-      cosines(i) = arma::norm_dot(dataset.col(indices[splitPointIndex]),
-                                  dataset.col(indices[i]));
+      cosines(i) = arma::norm_dot(splitPoint, dataset.unsafe_col(indices[i]));
     }
   }
 }
@@ -422,10 +413,19 @@ void CosineTree::CalculateCentroid()
   // Initialize centroid as vector of zeros.
   centroid.zeros(dataset.n_rows);
 
-  // Calculate centroid of columns in the node.
-  for(size_t i = 0; i < numColumns; i++)
+  // Calculate centroid of columns in the node.  For large nodes, each thread
+  // sums its own share of the columns.
+  #pragma omp parallel if(numColumns >= ParallelColumns)
   {
-    centroid += dataset.col(indices[i]);
+    arma::vec threadCentroid;
+    threadCentroid.zeros(dataset.n_rows);
+
+    #pragma omp for schedule(static)
+    for(size_t i = 0; i < numColumns; i++)
+      threadCentroid += dataset.unsafe_col(indices[i]);
+
+    #pragma omp critical(cosine_tree_centroid)
+    centroid += threadCentroid;
   }
   centroid /= numColumns;
 }
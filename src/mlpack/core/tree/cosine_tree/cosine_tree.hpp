@@ -82,6 +82,19 @@ class CosineTree
                            arma::vec& newBasisVector,
                            arma::vec* addBasisVector = NULL);
 
+  /**
+   * Calculates the orthonormalization of the passed centroid, with respect to
+   * the given orthonormal basis (one vector per column), with matrix-vector
+   * products.
+   *
+   * @param basis Current orthonormal basis.
+   * @param centroid Centroid of the node being added to the basis.
+   * @param newBasisVector Orthonormalized centroid of the node.
+   */
+  void ModifiedGramSchmidt(const arma::mat& basis,
+                           const arma::vec& centroid,
+                           arma::vec& newBasisVector);
+
   /**
    * Estimates the squared error of the projection of the input node's matrix
    * onto the current vector subspace. A normal distribution is fit using
@@ -99,6 +112,16 @@ class CosineTree
                          arma::vec* addBasisVector1 = NULL,
                          arma::vec* addBasisVector2 = NULL);
 
+  /**
+   * Estimates the squared error of the projection of the input node's matrix
+   * onto the given basis (one vector per column), like the other overload.  The
+   * samples are projected onto the basis with a single matrix product.
+   *
+   * @param node Node for which Monte Carlo estimate is calculated.
+   * @param basis Current orthonormal basis.
+   */
+  double MonteCarloError(CosineTree* node, const arma::mat& basis);
+
   /**
    * Constructs the final basis matrix, after the cosine tree construction.
    *
@@ -115,8 +138,8 @@ class CosineTree
 
   /**
    * Sample 'numSamples' points from the Length-Squared distribution of the
-   * cosine node. The function uses 'l2NormsSquared' to calculate the cumulative
-   * probability distribution of the column vectors. The sampling is based on a
+   * cosine node. The function uses the cumulative probability distribution of
+   * the column vectors, which is calculated once when the node is built. The sampling is based on a
    * randomly generated values in the range [0, 1].
    */
   void ColumnSamplesLS(std::vector<size_t>& sampledIndices,
@@ -124,8 +147,8 @@ class CosineTree
 
   /**
    * Sample a point from the Length-Squared distribution of the cosine node. The
-   * function uses 'l2NormsSquared' to calculate the cumulative probability
-   * distribution of the column vectors. The sampling is based on a randomly
+   * function uses the cumulative probability distribution of the column
+   * vectors, which is calculated once when the node is built. The sampling is based on a randomly
    * generated value in the range [0, 1].
    */
   size_t ColumnSampleLS();
@@ -208,6 +231,25 @@ class CosineTree
   size_t SplitPointIndex() const { return indices[splitPointIndex]; }
 
  private:
+  //! The number of columns above which a node computes its cosines and its
+  //! centroid in parallel.
+  static const size_t ParallelColumns = 4096;
+
+  /**
+   * Collect the basis vectors of the nodes in the priority queue, and the
+   * additional basis vectors (if given), as the columns of a matrix.
+   */
+  void QueueBasis(const CosineNodeQueue& treeQueue,
+                  arma::mat& queueBasis,
+                  const arma::vec* addBasisVector1 = NULL,
+                  const arma::vec* addBasisVector2 = NULL) const;
+
+  /**
+   * Calculate the cumulative Length-Squared distribution of the columns in the
+   * node, which is used by all the samplings of the node.
+   */
+  void CalculateDistribution();
+
   //! Matrix for which cosine tree is constructed.
   const arma::mat& dataset;
   //! Cumulative probability for Monte Carlo error lower bound.
@@ -224,6 +266,8 @@ class CosineTree
   std::vector<size_t> indices;
   //! L2-norm squared of columns in the node.
   arma::vec l2NormsSquared;
+  //! Cumulative Length-Squared distribution of columns in the node.
+  arma::vec cDistribution;
   //! Centroid of columns of input matrix in the node.
   arma::vec centroid;
   //! Orthonormalized basis vector of the node.
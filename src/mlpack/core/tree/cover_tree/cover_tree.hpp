@@ -8,8 +8,10 @@
 #define __MLPACK_CORE_TREE_COVER_TREE_COVER_TREE_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 
 #include "../statistic.hpp"
+#include "../tree_io.hpp"
 #include "first_point_is_root.hpp"
 
 namespace mlpack {
@@ -189,6 +191,23 @@ class CoverTree
             const double furthestDescendantDistance,
             MetricType* metric = NULL);
 
+  /**
+   * Load a cover tree that was written with Save() from the given binary
+   * stream.  No distance computations are done; the nodes are read as they
+   * were saved.  The dataset must be the dataset the tree was originally built
+   * on.  Usually, it is easier to use LoadTree() (see tree_io.hpp), which
+   * stores the dataset in the same file.
+   *
+   * @param dataset Dataset the tree was built on.
+   * @param stream Binary stream to read the tree from.
+   * @param parent Parent of this node (NULL indicates no parent).
+   * @param metric Instantiated metric (optional).
+   */
+  CoverTree(const MatType& dataset,
+            std::istream& stream,
+            CoverTree* parent = NULL,
+            MetricType* metric = NULL);
+
   /**
    * Create a cover tree from another tree.  Be careful!  This may use a lot of
    * memory and take a lot of time.
@@ -214,6 +233,20 @@ class CoverTree
   template<typename RuleType>
   using BreadthFirstDualTreeTraverser = DualTreeTraverser<RuleType>;
 
+  //! A task-parallel dual-tree cover tree traverser; see
+  //! parallel_dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class ParallelDualTreeTraverser;
+
+  /**
+   * Write this node and all of its descendants to the given binary stream, in
+   * depth-first order, so that it can be loaded later with the stream
+   * constructor.  The dataset is not written.
+   *
+   * @param stream Binary stream to write the tree to.
+   */
+  void Save(std::ostream& stream) const;
+
   //! Get a reference to the dataset.
   const MatType& Dataset() const { return dataset; }
 
@@ -341,6 +374,37 @@ class CoverTree
   //! Get the instantiated metric.
   MetricType& Metric() const { return *metric; }
 
+  /**
+   * Relocate all descendants of this (root) node into one contiguous array.
+   * The children of every node are stored next to each other, followed by the
+   * blocks of their subtrees in depth-first order, so that every subtree
+   * (except for its root) occupies a consecutive range of the array.  The
+   * traversals score all the children of a node together, so they read
+   * consecutive nodes instead of nodes scattered across the heap, and the whole
+   * tree is freed with one deallocation.
+   *
+   * The structure of the tree and the results of any traversal don't change.
+   * The statistics are rebuilt, so this has to be called before the tree is
+   * used by an algorithm.  Any pointers or references to the descendants of
+   * this node are invalidated, and nodes must not be added to or removed from
+   * a compacted tree through Children().  Calling this on a compacted tree does
+   * nothing.
+   */
+  void Compact();
+
+  //! Return whether or not the children of this node are stored contiguously.
+  bool Compacted() const { return compacted; }
+
+  //! Return the number of nodes in the subtree rooted at this node.
+  size_t TreeSize() const;
+
+  /**
+   * Return the number of bytes used by the subtree rooted at this node,
+   * including the child lists and a metric that is owned by the tree.  The
+   * dataset is not counted, because it is not owned by the tree.
+   */
+  size_t MemoryUsage() const;
+
  private:
   //! Reference to the matrix which this tree is built on.
   const MatType& dataset;
@@ -378,6 +442,39 @@ class CoverTree
   //! The metric used for this tree.
   MetricType* metric;
 
+  //! Whether or not the children of this node are stored in the contiguous
+  //! node array of a compacted tree (see Compact()).
+  bool compacted;
+
+  //! The contiguous node array of all descendants (only set in the root of a
+  //! compacted tree).
+  CoverTree* compactNodes;
+
+  //! The number of nodes in the contiguous node array.
+  size_t compactNodeCount;
+
+  /**
+   * Create a copy of the given node, without its children, in the node array
+   * of a compacted tree.
+   *
+   * @param other Node to copy.
+   * @param parent Parent of the new node.
+   */
+  CoverTree(const CoverTree& other, CoverTree* parent);
+
+  /**
+   * Copy the given children into the next block of the node array of a
+   * compacted tree, starting at the given index, make them the children of the
+   * given parent, and then copy their subtrees the same way.
+   *
+   * @param oldChildren Children to copy.
+   * @param parent Parent of the copies.
+   * @param index Next unused index of the node array.
+   */
+  void CompactChildren(const std::vector<CoverTree*>& oldChildren,
+                       CoverTree* parent,
+                       size_t& index);
+
   /**
    * Create the children for this node.
    */
@@ -402,6 +499,34 @@ class CoverTree
                         const arma::Col<size_t>& indices,
                         arma::vec& distances,
                         const size_t pointSetSize);
+
+  /**
+   * Compute the distances of ComputeDistances() with the given metric by
+   * calling its Evaluate() function for every point.
+   */
+  template<typename DistanceType, typename DataType>
+  static void DistanceBlock(DistanceType& metric,
+                            const DataType& data,
+                            const size_t pointIndex,
+                            const arma::Col<size_t>& indices,
+                            arma::vec& distances,
+                            const size_t pointSetSize);
+
+  /**
+   * Compute the distances of ComputeDistances() for the Euclidean distance on
+   * a dense dataset.  The points are processed in blocks of four, so that
+   * every element of the point at pointIndex is loaded once per block and the
+   * four sums are independent.
+   */
+  template<bool TakeRoot, typename DataType>
+  static void DistanceBlock(metric::LMetric<2, TakeRoot>& metric,
+                            const DataType& data,
+                            const size_t pointIndex,
+                            const arma::Col<size_t>& indices,
+                            arma::vec& distances,
+                            const size_t pointSetSize,
+                            const typename boost::disable_if_c<
+                                arma::is_SpMat<DataType>::value>::type* = 0);
   /**
    * Split the given indices and distances into a near and a far set, returning
    * the number of points in the near set.  The distances must already be
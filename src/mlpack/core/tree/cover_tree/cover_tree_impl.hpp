@@ -37,6 +37,9 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
     furthestDescendantDistance(0),
     localMetric(metric == NULL),
     metric(metric),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
     distanceComps(0)
 {
   // If we need to create a metric, do that.  We'll just do it on the heap.
@@ -124,6 +127,9 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
     furthestDescendantDistance(0),
     localMetric(false),
     metric(&metric),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
     distanceComps(0)
 {
   // If there is only one point in the dataset, uh, we're done.
@@ -217,6 +223,9 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
     furthestDescendantDistance(0),
     localMetric(false),
     metric(&metric),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
     distanceComps(0)
 {
   // If the size of the near set is 0, this is a leaf.
@@ -261,6 +270,9 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
     furthestDescendantDistance(furthestDescendantDistance),
     localMetric(metric == NULL),
     metric(metric),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
     distanceComps(0)
 {
   // If necessary, create a local metric.
@@ -271,6 +283,52 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
   stat = StatisticType(*this);
 }
 
+// Load a cover tree node (and its descendants) from a binary stream.
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const MatType& dataset,
+    std::istream& stream,
+    CoverTree* parent,
+    MetricType* metric) :
+    dataset(dataset),
+    parent(parent),
+    localMetric(metric == NULL),
+    metric(metric),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    distanceComps(0)
+{
+  // If necessary, create a local metric.
+  if (localMetric)
+    this->metric = new MetricType();
+
+  size_t numChildren = 0;
+  ReadBinary(stream, point);
+  ReadBinary(stream, scale);
+  ReadBinary(stream, base);
+  ReadBinary(stream, numDescendants);
+  ReadBinary(stream, parentDistance);
+  ReadBinary(stream, furthestDescendantDistance);
+  ReadBinary(stream, numChildren);
+
+  // Don't try to read children from a broken stream.
+  if (!stream.fail())
+  {
+    children.reserve(numChildren);
+    for (size_t i = 0; i < numChildren && !stream.fail(); ++i)
+      children.push_back(new CoverTree(dataset, stream, this, this->metric));
+  }
+
+  // Initialize statistic.
+  stat = StatisticType(*this);
+}
+
 template<
     typename MetricType,
     typename RootPointPolicy,
@@ -290,6 +348,9 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
     furthestDescendantDistance(other.furthestDescendantDistance),
     localMetric(false),
     metric(other.metric),
+    compacted(false),
+    compactNodes(NULL),
+    compactNodeCount(0),
     distanceComps(0)
 {
   // Copy each child by hand.
@@ -308,15 +369,170 @@ template<
 >
 CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::~CoverTree()
 {
-  // Delete each child.
-  for (size_t i = 0; i < children.size(); ++i)
-    delete children[i];
+  // The children of a compacted tree are destroyed by the root.
+  if (!compacted)
+  {
+    for (size_t i = 0; i < children.size(); ++i)
+      delete children[i];
+  }
+
+  if (compactNodes)
+  {
+    for (size_t i = 0; i < compactNodeCount; ++i)
+      compactNodes[i].~CoverTree();
+    ::operator delete(compactNodes);
+  }
 
   // Delete the local metric, if necessary.
   if (localMetric)
     delete metric;
 }
 
+/**
+ * Relocate all descendants into one contiguous array, with the children of
+ * every node next to each other.
+ */
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::Compact()
+{
+  if (parent != NULL)
+  {
+    Log::Fatal << "CoverTree::Compact(): only the root of a tree can be "
+        << "compacted." << std::endl;
+  }
+
+  if (compacted)
+    return;
+
+  if (!children.empty())
+  {
+    // The array is allocated uninitialized, because the nodes are constructed
+    // one block of children at a time.
+    compactNodeCount = TreeSize() - 1;
+    compactNodes = static_cast<CoverTree*>(
+        ::operator new(compactNodeCount * sizeof(CoverTree)));
+
+    std::vector<CoverTree*> oldChildren;
+    oldChildren.swap(children);
+
+    size_t index = 0;
+    CompactChildren(oldChildren, this, index);
+
+    for (size_t i = 0; i < oldChildren.size(); ++i)
+      delete oldChildren[i];
+  }
+
+  compacted = true;
+  stat = StatisticType(*this);
+}
+
+//! Return the number of nodes in the subtree rooted at this node.
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+size_t CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    TreeSize() const
+{
+  size_t size = 1;
+  for (size_t i = 0; i < children.size(); ++i)
+    size += children[i]->TreeSize();
+
+  return size;
+}
+
+/**
+ * Create a copy of the given node, without its children.
+ */
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CoverTree(
+    const CoverTree& other,
+    CoverTree* parent) :
+    dataset(other.dataset),
+    point(other.point),
+    scale(other.scale),
+    base(other.base),
+    numDescendants(other.numDescendants),
+    parent(parent),
+    parentDistance(other.parentDistance),
+    furthestDescendantDistance(other.furthestDescendantDistance),
+    localMetric(false),
+    metric(parent->metric),
+    compacted(true),
+    compactNodes(NULL),
+    compactNodeCount(0),
+    distanceComps(0)
+{
+  // Nothing to do; the statistic is built once the children are copied.
+}
+
+/**
+ * Copy the given children, and then their subtrees, into the node array.
+ */
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    CompactChildren(const std::vector<CoverTree*>& oldChildren,
+                    CoverTree* parent,
+                    size_t& index)
+{
+  // The children take the next block of the array, so the traversals, which
+  // score all the children of a node at once, read consecutive nodes.
+  CoverTree* block = compactNodes + index;
+  index += oldChildren.size();
+
+  parent->children.resize(oldChildren.size());
+  for (size_t i = 0; i < oldChildren.size(); ++i)
+    parent->children[i] = new (block + i) CoverTree(*oldChildren[i], parent);
+
+  // Then the blocks of the subtrees follow, in depth-first order.
+  for (size_t i = 0; i < oldChildren.size(); ++i)
+  {
+    CompactChildren(oldChildren[i]->children, block + i, index);
+
+    // The statistic may depend on the statistics of the children.
+    block[i].stat = StatisticType(block[i]);
+  }
+}
+
+// Write this node and its descendants to a binary stream.
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::Save(
+    std::ostream& stream) const
+{
+  WriteBinary(stream, point);
+  WriteBinary(stream, scale);
+  WriteBinary(stream, base);
+  WriteBinary(stream, numDescendants);
+  WriteBinary(stream, parentDistance);
+  WriteBinary(stream, furthestDescendantDistance);
+  WriteBinary(stream, children.size());
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->Save(stream);
+}
+
 //! Return the number of descendant points.
 template<
     typename MetricType,
@@ -331,6 +547,26 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
   return numDescendants;
 }
 
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+size_t CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    MemoryUsage() const
+{
+  size_t usage = sizeof(CoverTree) - sizeof(children) +
+      util::MemoryUsage(children);
+  if (localMetric)
+    usage += sizeof(MetricType);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    usage += children[i]->MemoryUsage();
+
+  return usage;
+}
+
 //! Return the index of a particular descendant point.
 template<
     typename MetricType,
@@ -648,6 +884,18 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CreateChildren(
   // computation later, we'll create an array holding the points in the near
   // set, and then after each run we'll check which of those (if any) were used
   // and we will remove them.  ...if that's faster.  I think it is.
+  //
+  // The near and far sets only shrink while the children are built, so the
+  // index and distance vectors of the first child are big enough for all of
+  // them, and they are reused instead of being allocated for every child.
+  arma::Col<size_t> childIndices;
+  arma::vec childDistances;
+  if (nearSetSize > 0)
+  {
+    childIndices.set_size(nearSetSize + farSetSize);
+    childDistances.set_size(nearSetSize + farSetSize);
+  }
+
   while (nearSetSize > 0)
   {
     size_t newPointIndex = nearSetSize - 1;
@@ -688,12 +936,10 @@ CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::CreateChildren(
       break;
     }
 
-    // Create the near and far set indices and distance vectors.  We don't fill
-    // in the self-point, yet.
-    arma::Col<size_t> childIndices(nearSetSize + farSetSize);
+    // Fill the near and far set indices.  We don't fill in the self-point,
+    // yet.
     childIndices.rows(0, (nearSetSize + farSetSize - 2)) = indices.rows(1,
         nearSetSize + farSetSize - 1);
-    arma::vec childDistances(nearSetSize + farSetSize);
 
     // Build distances for the child.
     ComputeDistances(indices[0], childIndices, childDistances, nearSetSize
@@ -812,14 +1058,100 @@ void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
                      const size_t pointSetSize)
 {
   // For each point, rebuild the distances.  The indices do not need to be
-  // modified.
+  // modified.  The children of a node depend on the points used by the children
+  // built before them, so the construction itself is sequential, but the
+  // distances to the points of a large point set are computed in parallel.
   distanceComps += pointSetSize;
+  DistanceBlock(*metric, dataset, pointIndex, indices, distances,
+      pointSetSize);
+}
+
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+template<typename DistanceType, typename DataType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    DistanceBlock(DistanceType& metric,
+                  const DataType& data,
+                  const size_t pointIndex,
+                  const arma::Col<size_t>& indices,
+                  arma::vec& distances,
+                  const size_t pointSetSize)
+{
+  #pragma omp parallel for if(pointSetSize >= 4096)
   for (size_t i = 0; i < pointSetSize; ++i)
+    distances[i] = metric.Evaluate(data.col(pointIndex), data.col(indices[i]));
+}
+
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+template<bool TakeRoot, typename DataType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    DistanceBlock(metric::LMetric<2, TakeRoot>& /* metric */,
+                  const DataType& data,
+                  const size_t pointIndex,
+                  const arma::Col<size_t>& indices,
+                  arma::vec& distances,
+                  const size_t pointSetSize,
+                  const typename boost::disable_if_c<
+                      arma::is_SpMat<DataType>::value>::type*)
+{
+  typedef typename DataType::elem_type ElemType;
+  const size_t dim = data.n_rows;
+  const ElemType* point = data.colptr(pointIndex);
+  const size_t numBlocks = pointSetSize / 4;
+
+  #pragma omp parallel for if(pointSetSize >= 4096)
+  for (size_t b = 0; b < numBlocks; ++b)
   {
-    distances[i] = metric->Evaluate(dataset.col(pointIndex),
-        dataset.col(indices[i]));
+    const size_t i = 4 * b;
+    const ElemType* a = data.colptr(indices[i]);
+    const ElemType* c = data.colptr(indices[i + 1]);
+    const ElemType* e = data.colptr(indices[i + 2]);
+    const ElemType* g = data.colptr(indices[i + 3]);
+
+    double sumA = 0.0, sumC = 0.0, sumE = 0.0, sumG = 0.0;
+    for (size_t d = 0; d < dim; ++d)
+    {
+      const double p = point[d];
+      const double diffA = a[d] - p;
+      const double diffC = c[d] - p;
+      const double diffE = e[d] - p;
+      const double diffG = g[d] - p;
+      sumA += diffA * diffA;
+      sumC += diffC * diffC;
+      sumE += diffE * diffE;
+      sumG += diffG * diffG;
+    }
+
+    distances[i] = TakeRoot ? sqrt(sumA) : sumA;
+    distances[i + 1] = TakeRoot ? sqrt(sumC) : sumC;
+    distances[i + 2] = TakeRoot ? sqrt(sumE) : sumE;
+    distances[i + 3] = TakeRoot ? sqrt(sumG) : sumG;
+  }
+
+  // Now the points that don't fill a whole block.
+  for (size_t i = 4 * numBlocks; i < pointSetSize; ++i)
+  {
+    const ElemType* a = data.colptr(indices[i]);
+    double sum = 0.0;
+    for (size_t d = 0; d < dim; ++d)
+    {
+      const double diff = a[d] - point[d];
+      sum += diff * diff;
+    }
+
+    distances[i] = TakeRoot ? sqrt(sum) : sum;
   }
 }
+}
 
 template<
     typename MetricType,
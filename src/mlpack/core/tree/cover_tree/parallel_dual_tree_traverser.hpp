@@ -0,0 +1,105 @@
+/**
+ * @file parallel_dual_tree_traverser.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the ParallelDualTreeTraverser for the CoverTree tree type.  This is a
+ * nested class of CoverTree which splits the query tree into independent
+ * subtrees and traverses each of those against the reference tree as its own
+ * OpenMP task, using the regular DualTreeTraverser.
+ */
+#ifndef __MLPACK_CORE_TREE_COVER_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_COVER_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+
+#include "cover_tree.hpp"
+#include "dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A task-parallel dual-tree traverser for cover trees.  The query tree is
+ * descended until nodes with fewer than minTaskSize descendants are found (or
+ * leaves); each of those query subtrees is then traversed against the
+ * reference node as an OpenMP task with its own copy of the rules and its own
+ * DualTreeTraverser, which builds its own reference map.  The children of a
+ * cover tree node hold disjoint sets of descendant points (the point of the
+ * node itself is held by the self-child), so no query point is handled by two
+ * tasks.  When OpenMP is not available, the tasks simply run one after
+ * another.
+ *
+ * RuleType has the same requirements as for the ParallelDualTreeTraverser of
+ * the BinarySpaceTree: it must be copy-constructible with copies that share
+ * the output, it must provide modifiable BaseCases() and Scores() accessors,
+ * and it may only modify state that belongs to the query points and query
+ * nodes being scored.  NeighborSearchRules and FastMKSRules satisfy this.
+ */
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+template<typename RuleType>
+class CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+    ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.
+   *
+   * @param rule Rules to use for the traversal.
+   * @param minTaskSize Query subtrees with fewer than this many descendants
+   *     are not split further and are traversed as a single task.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t minTaskSize = 1000);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of prunes.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(CoverTree& queryNode, CoverTree& referenceNode);
+
+  //! Get the minimum number of descendants of a query node to split it.
+  size_t MinTaskSize() const { return minTaskSize; }
+  //! Modify the minimum number of descendants of a query node to split it.
+  size_t& MinTaskSize() { return minTaskSize; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+ private:
+  /**
+   * Descend the query tree and create a task for each query subtree that is
+   * small enough.
+   *
+   * @param queryNode Query node to split or create a task for.
+   * @param referenceNode Reference node to traverse with.
+   * @param prototype Copy of the rules that each task's rules are copied from.
+   */
+  void SpawnTasks(CoverTree& queryNode,
+                  CoverTree& referenceNode,
+                  const RuleType& prototype);
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! Query subtrees smaller than this are not split further.
+  size_t minTaskSize;
+
+  //! The number of prunes.
+  size_t numPrunes;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif // __MLPACK_CORE_TREE_COVER_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
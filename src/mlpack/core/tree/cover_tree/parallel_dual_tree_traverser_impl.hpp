@@ -0,0 +1,104 @@
+/**
+ * @file parallel_dual_tree_traverser_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the ParallelDualTreeTraverser for CoverTree.  Each
+ * sufficiently small query subtree is traversed against the reference tree in
+ * its own OpenMP task.
+ */
+#ifndef __MLPACK_CORE_TREE_COVER_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_COVER_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+template<typename RuleType>
+CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+ParallelDualTreeTraverser<RuleType>::ParallelDualTreeTraverser(
+    RuleType& rule,
+    const size_t minTaskSize) :
+    rule(rule),
+    minTaskSize(minTaskSize),
+    numPrunes(0)
+{ /* Nothing to do. */ }
+
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+template<typename RuleType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+ParallelDualTreeTraverser<RuleType>::Traverse(CoverTree& queryNode,
+                                              CoverTree& referenceNode)
+{
+  // Every task copies its rules from this prototype, which has its counters
+  // reset so that each task's counts can simply be added to the given rules.
+  RuleType prototype(rule);
+  prototype.BaseCases() = 0;
+  prototype.Scores() = 0;
+
+  #pragma omp parallel
+  {
+    // One thread descends the query tree and creates the tasks; all threads
+    // (including that one, once it is done) then execute them.
+    #pragma omp single
+    SpawnTasks(queryNode, referenceNode, prototype);
+  }
+}
+
+template<
+    typename MetricType,
+    typename RootPointPolicy,
+    typename StatisticType,
+    typename MatType
+>
+template<typename RuleType>
+void CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>::
+ParallelDualTreeTraverser<RuleType>::SpawnTasks(CoverTree& queryNode,
+                                                CoverTree& referenceNode,
+                                                const RuleType& prototype)
+{
+  if (!queryNode.IsLeaf() && queryNode.NumDescendants() >= minTaskSize)
+  {
+    // This query node is too big for one task; split it.  Its own point is
+    // held by the self-child, so nothing is lost.
+    for (size_t i = 0; i < queryNode.NumChildren(); ++i)
+      SpawnTasks(queryNode.Child(i), referenceNode, prototype);
+    return;
+  }
+
+  // Use pointers so that the task captures the nodes and not copies of them.
+  CoverTree* queryPtr = &queryNode;
+  CoverTree* referencePtr = &referenceNode;
+  const RuleType* prototypePtr = &prototype;
+
+  #pragma omp task firstprivate(queryPtr, referencePtr, prototypePtr)
+  {
+    RuleType taskRule(*prototypePtr);
+    DualTreeTraverser<RuleType> traverser(taskRule);
+    traverser.Traverse(*queryPtr, *referencePtr);
+
+    #pragma omp critical(parallel_dual_tree_traverser_counts)
+    {
+      rule.BaseCases() += taskRule.BaseCases();
+      rule.Scores() += taskRule.Scores();
+      numPrunes += traverser.NumPrunes();
+    }
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif // __MLPACK_CORE_TREE_COVER_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
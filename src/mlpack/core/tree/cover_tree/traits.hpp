@@ -52,6 +52,11 @@ class TreeTraits<CoverTree<MetricType, RootPointPolicy, StatisticType, MatType>>
    * The cover tree is not necessarily a binary tree.
    */
   static const bool BinaryTree = false;
+
+  /**
+   * Points are held in every level of the cover tree.
+   */
+  static const bool HasContiguousLeaves = false;
 };
 
 }; // namespace tree
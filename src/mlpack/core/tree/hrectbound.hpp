@@ -72,6 +72,16 @@ class HRectBound
   //! Modify the minimum width of the bound.
   double& MinWidth() { return minWidth; }
 
+  /**
+   * Move the ranges of this bound into the given external storage, which has
+   * to hold at least Dim() ranges and has to outlive this bound.  The bound
+   * doesn't free the storage.  This is used by trees that store the bounds of
+   * all nodes in one contiguous block.
+   *
+   * @param storage Memory to store the ranges in.
+   */
+  void UseStorage(math::Range* storage);
+
   /**
    * Calculates the centroid of the range, placing it into the given vector.
    *
@@ -163,6 +173,15 @@ class HRectBound
    */
   double Diameter() const;
 
+  /**
+   * Return the number of bytes used by this bound, including the ranges if they
+   * are stored by this bound (and not in external storage).
+   */
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) + (ownsBounds ? dim * sizeof(math::Range) : 0);
+  }
+
   /**
    * Returns a string representation of this object.
    */
@@ -182,6 +201,13 @@ class HRectBound
   math::Range* bounds;
   //! Cached minimum width of bound.
   double minWidth;
+  //! Whether or not the bounds array was allocated by this object.
+  bool ownsBounds;
+
+  //! Raise a nonnegative value to the Power'th power.
+  static double PowerOf(const double x);
+  //! Take the Power'th root of a nonnegative value.
+  static double RootOf(const double x);
 };
 
 // A specialization of BoundTraits for this class.
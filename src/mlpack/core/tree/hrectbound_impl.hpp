@@ -24,7 +24,8 @@ template<int Power, bool TakeRoot>
 inline HRectBound<Power, TakeRoot>::HRectBound() :
     dim(0),
     bounds(NULL),
-    minWidth(0)
+    minWidth(0),
+    ownsBounds(true)
 { /* Nothing to do. */ }
 
 /**
@@ -35,7 +36,8 @@ template<int Power, bool TakeRoot>
 inline HRectBound<Power, TakeRoot>::HRectBound(const size_t dimension) :
     dim(dimension),
     bounds(new math::Range[dim]),
-    minWidth(0)
+    minWidth(0),
+    ownsBounds(true)
 { /* Nothing to do. */ }
 
 /***
@@ -45,7 +47,8 @@ template<int Power, bool TakeRoot>
 inline HRectBound<Power, TakeRoot>::HRectBound(const HRectBound& other) :
     dim(other.Dim()),
     bounds(new math::Range[dim]),
-    minWidth(other.MinWidth())
+    minWidth(other.MinWidth()),
+    ownsBounds(true)
 {
   // Copy other bounds over.
   for (size_t i = 0; i < dim; i++)
@@ -62,11 +65,12 @@ inline HRectBound<Power, TakeRoot>& HRectBound<Power, TakeRoot>::operator=(
   if (dim != other.Dim())
   {
     // Reallocation is necessary.
-    if (bounds)
+    if (bounds && ownsBounds)
       delete[] bounds;
 
     dim = other.Dim();
     bounds = new math::Range[dim];
+    ownsBounds = true;
   }
 
   // Now copy each of the bound values.
@@ -84,10 +88,26 @@ inline HRectBound<Power, TakeRoot>& HRectBound<Power, TakeRoot>::operator=(
 template<int Power, bool TakeRoot>
 inline HRectBound<Power, TakeRoot>::~HRectBound()
 {
-  if (bounds)
+  if (bounds && ownsBounds)
     delete[] bounds;
 }
 
+/**
+ * Move the ranges into external storage.
+ */
+template<int Power, bool TakeRoot>
+inline void HRectBound<Power, TakeRoot>::UseStorage(math::Range* storage)
+{
+  for (size_t i = 0; i < dim; i++)
+    storage[i] = bounds[i];
+
+  if (bounds && ownsBounds)
+    delete[] bounds;
+
+  bounds = storage;
+  ownsBounds = false;
+}
+
 /**
  * Resets all dimensions to the empty set.
  */
@@ -130,6 +150,38 @@ inline double HRectBound<Power, TakeRoot>::Volume() const
   return volume;
 }
 
+/**
+ * Raise a nonnegative value to the Power'th power.  The common powers are
+ * multiplications, so that the distance loops don't call pow() and can be
+ * vectorized; the compiler removes the branches since Power is known.
+ */
+template<int Power, bool TakeRoot>
+inline double HRectBound<Power, TakeRoot>::PowerOf(const double x)
+{
+  if (Power == 1)
+    return x;
+  else if (Power == 2)
+    return x * x;
+  else if (Power == 3)
+    return x * x * x;
+  else
+    return std::pow(x, (double) Power);
+}
+
+/**
+ * Take the Power'th root of a nonnegative value.
+ */
+template<int Power, bool TakeRoot>
+inline double HRectBound<Power, TakeRoot>::RootOf(const double x)
+{
+  if (Power == 1)
+    return x;
+  else if (Power == 2)
+    return std::sqrt(x);
+  else
+    return std::pow(x, 1.0 / (double) Power);
+}
+
 /**
  * Calculates minimum bound-to-point squared distance.
  */
@@ -152,7 +204,7 @@ inline double HRectBound<Power, TakeRoot>::MinDistance(
     // Since only one of 'lower' or 'higher' is negative, if we add each's
     // absolute value to itself and then sum those two, our result is the
     // nonnegative half of the equation times two; then we raise to power Power.
-    sum += pow((lower + fabs(lower)) + (higher + fabs(higher)), (double) Power);
+    sum += PowerOf((lower + fabs(lower)) + (higher + fabs(higher)));
   }
 
   // Now take the Power'th root (but make sure our result is squared if it needs
@@ -160,9 +212,9 @@ inline double HRectBound<Power, TakeRoot>::MinDistance(
   // that was introduced earlier.  The compiler should optimize out the if
   // statement entirely.
   if (TakeRoot)
-    return pow(sum, 1.0 / (double) Power) / 2.0;
+    return RootOf(sum) / 2.0;
   else
-    return sum / pow(2.0, Power);
+    return sum / PowerOf(2.0);
 }
 
 /**
@@ -185,7 +237,7 @@ double HRectBound<Power, TakeRoot>::MinDistance(const HRectBound& other) const
     // We invoke the following:
     //   x + fabs(x) = max(x * 2, 0)
     //   (x * 2)^2 / 4 = x^2
-    sum += pow((lower + fabs(lower)) + (higher + fabs(higher)), (double) Power);
+    sum += PowerOf((lower + fabs(lower)) + (higher + fabs(higher)));
 
     // Move bound pointers.
     mbound++;
@@ -194,9 +246,9 @@ double HRectBound<Power, TakeRoot>::MinDistance(const HRectBound& other) const
 
   // The compiler should optimize out this if statement entirely.
   if (TakeRoot)
-    return pow(sum, 1.0 / (double) Power) / 2.0;
+    return RootOf(sum) / 2.0;
   else
-    return sum / pow(2.0, Power);
+    return sum / PowerOf(2.0);
 }
 
 /**
@@ -216,12 +268,12 @@ inline double HRectBound<Power, TakeRoot>::MaxDistance(
   {
     double v = std::max(fabs(point[d] - bounds[d].Lo()),
         fabs(bounds[d].Hi() - point[d]));
-    sum += pow(v, (double) Power);
+    sum += PowerOf(v);
   }
 
   // The compiler should optimize out this if statement entirely.
   if (TakeRoot)
-    return pow(sum, 1.0 / (double) Power);
+    return RootOf(sum);
   else
     return sum;
 }
@@ -242,12 +294,12 @@ inline double HRectBound<Power, TakeRoot>::MaxDistance(const HRectBound& other)
   {
     v = std::max(fabs(other.bounds[d].Hi() - bounds[d].Lo()),
         fabs(bounds[d].Hi() - other.bounds[d].Lo()));
-    sum += pow(v, (double) Power); // v is non-negative.
+    sum += PowerOf(v); // v is non-negative.
   }
 
   // The compiler should optimize out this if statement entirely.
   if (TakeRoot)
-    return pow(sum, 1.0 / (double) Power);
+    return RootOf(sum);
   else
     return sum;
 }
@@ -269,25 +321,19 @@ inline math::Range HRectBound<Power, TakeRoot>::RangeDistance(
   {
     v1 = other.bounds[d].Lo() - bounds[d].Hi();
     v2 = bounds[d].Lo() - other.bounds[d].Hi();
-    // One of v1 or v2 is negative.
-    if (v1 >= v2)
-    {
-      vHi = -v2; // Make it nonnegative.
-      vLo = (v1 > 0) ? v1 : 0; // Force to be 0 if negative.
-    }
-    else
-    {
-      vHi = -v1; // Make it nonnegative.
-      vLo = (v2 > 0) ? v2 : 0; // Force to be 0 if negative.
-    }
-
-    loSum += pow(vLo, (double) Power);
-    hiSum += pow(vHi, (double) Power);
+    // One of v1 or v2 is negative.  The larger one (forced to be 0 if it is
+    // negative) is the minimum distance and the negated smaller one is the
+    // maximum distance; this is written without branches so that the loop
+    // can be vectorized.
+    vHi = -std::min(v1, v2);
+    vLo = std::max(std::max(v1, v2), 0.0);
+
+    loSum += PowerOf(vLo);
+    hiSum += PowerOf(vHi);
   }
 
   if (TakeRoot)
-    return math::Range(pow(loSum, 1.0 / (double) Power),
-                       pow(hiSum, 1.0 / (double) Power));
+    return math::Range(RootOf(loSum), RootOf(hiSum));
   else
     return math::Range(loSum, hiSum);
 }
@@ -311,33 +357,18 @@ inline math::Range HRectBound<Power, TakeRoot>::RangeDistance(
   {
     v1 = bounds[d].Lo() - point[d]; // Negative if point[d] > lo.
     v2 = point[d] - bounds[d].Hi(); // Negative if point[d] < hi.
-    // One of v1 or v2 (or both) is negative.
-    if (v1 >= 0) // point[d] <= bounds_[d].Lo().
-    {
-      vHi = -v2; // v2 will be larger but must be negated.
-      vLo = v1;
-    }
-    else // point[d] is between lo and hi, or greater than hi.
-    {
-      if (v2 >= 0)
-      {
-        vHi = -v1; // v1 will be larger, but must be negated.
-        vLo = v2;
-      }
-      else
-      {
-        vHi = -std::min(v1, v2); // Both are negative, but we need the larger.
-        vLo = 0;
-      }
-    }
-
-    loSum += pow(vLo, (double) Power);
-    hiSum += pow(vHi, (double) Power);
+    // One of v1 or v2 (or both) is negative.  If point[d] is outside of the
+    // range, the nonnegative one is the minimum distance; in any case the
+    // negated smaller one is the maximum distance.
+    vHi = -std::min(v1, v2);
+    vLo = std::max(std::max(v1, v2), 0.0);
+
+    loSum += PowerOf(vLo);
+    hiSum += PowerOf(vHi);
   }
 
   if (TakeRoot)
-    return math::Range(pow(loSum, 1.0 / (double) Power),
-                       pow(hiSum, 1.0 / (double) Power));
+    return math::Range(RootOf(loSum), RootOf(hiSum));
   else
     return math::Range(loSum, hiSum);
 }
@@ -352,8 +383,9 @@ inline HRectBound<Power, TakeRoot>& HRectBound<Power, TakeRoot>::operator|=(
 {
   Log::Assert(data.n_rows == dim);
 
-  arma::vec mins(min(data, 1));
-  arma::vec maxs(max(data, 1));
+  // The extrema have the element type of the data (which may be float).
+  arma::Col<typename MatType::elem_type> mins(min(data, 1));
+  arma::Col<typename MatType::elem_type> maxs(max(data, 1));
 
   minWidth = DBL_MAX;
   for (size_t i = 0; i < dim; i++)
@@ -412,10 +444,10 @@ inline double HRectBound<Power, TakeRoot>::Diameter() const
 {
   double d = 0;
   for (size_t i = 0; i < dim; ++i)
-    d += std::pow(bounds[i].Hi() - bounds[i].Lo(), (double) Power);
+    d += PowerOf(bounds[i].Hi() - bounds[i].Lo());
 
   if (TakeRoot)
-    return std::pow(d, 1.0 / (double) Power);
+    return RootOf(d);
   else
     return d;
 }
@@ -17,11 +17,16 @@
 #include "rectangle_tree/single_tree_traverser_impl.hpp"
 #include "rectangle_tree/dual_tree_traverser.hpp"
 #include "rectangle_tree/dual_tree_traverser_impl.hpp"
+#include "rectangle_tree/parallel_dual_tree_traverser.hpp"
+#include "rectangle_tree/parallel_dual_tree_traverser_impl.hpp"
 #include "rectangle_tree/r_tree_split.hpp"
 #include "rectangle_tree/r_star_tree_split.hpp"
 #include "rectangle_tree/r_tree_descent_heuristic.hpp"
 #include "rectangle_tree/r_star_tree_descent_heuristic.hpp"
 #include "rectangle_tree/traits.hpp"
 #include "rectangle_tree/x_tree_split.hpp"
+#include "rectangle_tree/str_bulk_load.hpp"
+#include "rectangle_tree/hilbert_bulk_load.hpp"
+#include "rectangle_tree/rectangle_tree_snapshots.hpp"
 
 #endif
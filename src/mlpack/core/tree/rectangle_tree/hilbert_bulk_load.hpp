@@ -0,0 +1,93 @@
+/**
+ * @file hilbert_bulk_load.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of the HilbertBulkLoad class, which packs the points of a
+ * rectangle tree into nodes in the order of a Hilbert curve.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * Hilbert packing of Kamel and Faloutsos.  The points are sorted once by their
+ * position on a Hilbert curve through the bounding box of the dataset, and
+ * every node is made of consecutive runs of that order.  Points that are close
+ * on the curve are close in space, so the nodes are compact, and the packing
+ * itself only costs a single sort.
+ *
+ * See STRBulkLoad for the interface of a bulk load policy.
+ */
+class HilbertBulkLoad
+{
+ public:
+  /**
+   * Sort the given points by their Hilbert index.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points to sort.
+   */
+  template<typename MatType>
+  static void Order(const MatType& data, std::vector<size_t>& indices);
+
+  /**
+   * Cut the given points, which are in Hilbert order, into numGroups runs.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points of the tree.
+   * @param begin First element of indices that belongs to the node.
+   * @param count Number of points of the node.
+   * @param numGroups Number of groups to make.
+   * @param groupBegins Vector to store the numGroups + 1 group boundaries in.
+   */
+  template<typename MatType>
+  static void Group(const MatType& /* data */,
+                    std::vector<size_t>& /* indices */,
+                    const size_t begin,
+                    const size_t count,
+                    const size_t numGroups,
+                    std::vector<size_t>& groupBegins)
+  {
+    groupBegins.resize(numGroups + 1);
+    for (size_t i = 0; i <= numGroups; ++i)
+      groupBegins[i] = begin + (i * count) / numGroups;
+  }
+
+  //! The number of bits of every coordinate on the Hilbert curve.
+  static const size_t Bits = 16;
+
+ private:
+  /**
+   * Convert the quantized coordinates of a point to the "transposed" Hilbert
+   * index of Skilling (2004); the bits of the Hilbert index are the bits of
+   * the transposed coordinates, interleaved from the most significant one.
+   */
+  static void Transpose(size_t* coordinates, const size_t dimensionality);
+
+  //! Order point indices by their transposed Hilbert indices.
+  class HilbertComparator
+  {
+   public:
+    HilbertComparator(const std::vector<size_t>& keys,
+                      const size_t dimensionality) :
+        keys(keys), dimensionality(dimensionality) { }
+
+    bool operator()(const size_t a, const size_t b) const;
+
+   private:
+    const std::vector<size_t>& keys;
+    const size_t dimensionality;
+  };
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "hilbert_bulk_load_impl.hpp"
+
+#endif
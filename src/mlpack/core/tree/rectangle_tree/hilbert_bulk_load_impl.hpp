@@ -0,0 +1,116 @@
+/**
+ * @file hilbert_bulk_load_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the Hilbert packing of rectangle trees.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_IMPL_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_BULK_LOAD_IMPL_HPP
+
+#include "hilbert_bulk_load.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void HilbertBulkLoad::Order(const MatType& data, std::vector<size_t>& indices)
+{
+  if (data.n_cols == 0)
+    return;
+
+  const size_t dimensionality = data.n_rows;
+  const arma::vec lo = arma::min(data, 1);
+  const arma::vec hi = arma::max(data, 1);
+  const double maxCoordinate = (double) ((size_t(1) << Bits) - 1);
+
+  // Quantize every point to the grid of the curve and transpose it.
+  std::vector<size_t> keys(dimensionality * data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    size_t* key = &keys[i * dimensionality];
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const double width = hi[d] - lo[d];
+      key[d] = (width > 0) ? (size_t) ((data(d, i) - lo[d]) / width *
+          maxCoordinate) : 0;
+    }
+
+    Transpose(key, dimensionality);
+  }
+
+  std::sort(indices.begin(), indices.end(),
+      HilbertComparator(keys, dimensionality));
+}
+
+inline void HilbertBulkLoad::Transpose(size_t* coordinates,
+                                       const size_t dimensionality)
+{
+  const size_t highBit = size_t(1) << (Bits - 1);
+
+  // Inverse undo.
+  for (size_t q = highBit; q > 1; q >>= 1)
+  {
+    const size_t p = q - 1;
+    for (size_t i = 0; i < dimensionality; ++i)
+    {
+      if (coordinates[i] & q)
+      {
+        coordinates[0] ^= p; // Invert.
+      }
+      else
+      {
+        // Exchange the low bits of coordinates[0] and coordinates[i].
+        const size_t t = (coordinates[0] ^ coordinates[i]) & p;
+        coordinates[0] ^= t;
+        coordinates[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode.
+  for (size_t i = 1; i < dimensionality; ++i)
+    coordinates[i] ^= coordinates[i - 1];
+
+  size_t t = 0;
+  for (size_t q = highBit; q > 1; q >>= 1)
+    if (coordinates[dimensionality - 1] & q)
+      t ^= q - 1;
+
+  for (size_t i = 0; i < dimensionality; ++i)
+    coordinates[i] ^= t;
+}
+
+inline bool HilbertBulkLoad::HilbertComparator::operator()(const size_t a,
+                                                          const size_t b) const
+{
+  const size_t* keyA = &keys[a * dimensionality];
+  const size_t* keyB = &keys[b * dimensionality];
+
+  // The most significant differing bit of the interleaved Hilbert indices is
+  // the highest differing bit of any coordinate; at equal bit positions, the
+  // earlier coordinate is more significant.
+  size_t bestDimension = dimensionality;
+  size_t bestDifference = 0;
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    const size_t difference = keyA[d] ^ keyB[d];
+    // This is true if the highest set bit of difference is above the highest
+    // set bit of bestDifference.
+    if (bestDifference < difference &&
+        bestDifference < (bestDifference ^ difference))
+    {
+      bestDimension = d;
+      bestDifference = difference;
+    }
+  }
+
+  if (bestDimension == dimensionality)
+    return false; // Same Hilbert index.
+
+  return keyA[bestDimension] < keyB[bestDimension];
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * @file parallel_dual_tree_traverser.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the ParallelDualTreeTraverser for rectangle type trees.  This is a
+ * nested class of RectangleTree which splits the query tree into independent
+ * subtrees and traverses each of those against the reference tree as its own
+ * OpenMP task, using the depth-first DualTreeTraverser.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+
+#include "rectangle_tree.hpp"
+#include "dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A task-parallel dual-tree traverser for rectangle type trees.  The query tree
+ * is descended until nodes with fewer than minTaskSize descendants are found
+ * (or leaves); each of those query subtrees is then traversed against the
+ * reference node as an OpenMP task with its own copy of the rules and its own
+ * DualTreeTraverser.  Only the leaves of a rectangle tree hold points, so the
+ * query subtrees hold disjoint sets of points.  When OpenMP is not available,
+ * the tasks simply run one after another.
+ *
+ * RuleType has the same requirements as for the ParallelDualTreeTraverser of
+ * the BinarySpaceTree: it must be copy-constructible with copies that share
+ * the output, it must provide modifiable BaseCases() and Scores() accessors,
+ * and it may only modify state that belongs to the query points and query
+ * nodes being scored.
+ *
+ * The tree must not be modified (with Insert() or Delete()) during the
+ * traversal.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename RuleType>
+class RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+    ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.
+   *
+   * @param rule Rules to use for the traversal.
+   * @param minTaskSize Query subtrees with fewer than this many descendants
+   *     are not split further and are traversed as a single task.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t minTaskSize = 1000);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of prunes.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(RectangleTree& queryNode, RectangleTree& referenceNode);
+
+  //! Get the minimum number of descendants of a query node to split it.
+  size_t MinTaskSize() const { return minTaskSize; }
+  //! Modify the minimum number of descendants of a query node to split it.
+  size_t& MinTaskSize() { return minTaskSize; }
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of visited combinations.
+  size_t NumVisited() const { return numVisited; }
+  //! Modify the number of visited combinations.
+  size_t& NumVisited() { return numVisited; }
+
+  //! Get the number of times a node combination was scored.
+  size_t NumScores() const { return numScores; }
+  //! Modify the number of times a node combination was scored.
+  size_t& NumScores() { return numScores; }
+
+  //! Get the number of times a base case was calculated.
+  size_t NumBaseCases() const { return numBaseCases; }
+  //! Modify the number of times a base case was calculated.
+  size_t& NumBaseCases() { return numBaseCases; }
+
+ private:
+  /**
+   * Descend the query tree and create a task for each query subtree that is
+   * small enough.
+   *
+   * @param queryNode Query node to split or create a task for.
+   * @param referenceNode Reference node to traverse with.
+   * @param prototype Copy of the rules that each task's rules are copied from.
+   */
+  void SpawnTasks(RectangleTree& queryNode,
+                  RectangleTree& referenceNode,
+                  const RuleType& prototype);
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! Query subtrees smaller than this are not split further.
+  size_t minTaskSize;
+
+  //! The number of prunes.
+  size_t numPrunes;
+
+  //! The number of node combinations that have been visited during traversal.
+  size_t numVisited;
+
+  //! The number of times a node combination was scored.
+  size_t numScores;
+
+  //! The number of times a base case was calculated.
+  size_t numBaseCases;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif // __MLPACK_CORE_TREE_RECTANGLE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
@@ -0,0 +1,104 @@
+/**
+ * @file parallel_dual_tree_traverser_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the ParallelDualTreeTraverser for rectangle type trees.
+ * Each sufficiently small query subtree is traversed against the reference
+ * tree in its own OpenMP task.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename RuleType>
+RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+ParallelDualTreeTraverser<RuleType>::ParallelDualTreeTraverser(
+    RuleType& rule,
+    const size_t minTaskSize) :
+    rule(rule),
+    minTaskSize(minTaskSize),
+    numPrunes(0),
+    numVisited(0),
+    numScores(0),
+    numBaseCases(0)
+{ /* Nothing to do. */ }
+
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename RuleType>
+void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+ParallelDualTreeTraverser<RuleType>::Traverse(RectangleTree& queryNode,
+                                              RectangleTree& referenceNode)
+{
+  // Every task copies its rules from this prototype, which has its counters
+  // reset so that each task's counts can simply be added to the given rules.
+  RuleType prototype(rule);
+  prototype.BaseCases() = 0;
+  prototype.Scores() = 0;
+
+  #pragma omp parallel
+  {
+    // One thread descends the query tree and creates the tasks; all threads
+    // (including that one, once it is done) then execute them.
+    #pragma omp single
+    SpawnTasks(queryNode, referenceNode, prototype);
+  }
+}
+
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename RuleType>
+void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+ParallelDualTreeTraverser<RuleType>::SpawnTasks(RectangleTree& queryNode,
+                                                RectangleTree& referenceNode,
+                                                const RuleType& prototype)
+{
+  if (!queryNode.IsLeaf() && queryNode.NumDescendants() >= minTaskSize)
+  {
+    // This query node is too big for one task; split it.  The recursion order
+    // of the query children does not matter.
+    for (size_t i = 0; i < queryNode.NumChildren(); ++i)
+      SpawnTasks(queryNode.Child(i), referenceNode, prototype);
+    return;
+  }
+
+  // Use pointers so that the task captures the nodes and not copies of them.
+  RectangleTree* queryPtr = &queryNode;
+  RectangleTree* referencePtr = &referenceNode;
+  const RuleType* prototypePtr = &prototype;
+
+  #pragma omp task firstprivate(queryPtr, referencePtr, prototypePtr)
+  {
+    RuleType taskRule(*prototypePtr);
+    DualTreeTraverser<RuleType> traverser(taskRule);
+    traverser.Traverse(*queryPtr, *referencePtr);
+
+    #pragma omp critical(parallel_dual_tree_traverser_counts)
+    {
+      rule.BaseCases() += taskRule.BaseCases();
+      rule.Scores() += taskRule.Scores();
+      numPrunes += traverser.NumPrunes();
+      numVisited += traverser.NumVisited();
+      numScores += traverser.NumScores();
+      numBaseCases += traverser.NumBaseCases();
+    }
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif // __MLPACK_CORE_TREE_RECTANGLE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
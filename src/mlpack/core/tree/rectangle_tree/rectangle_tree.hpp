@@ -9,6 +9,7 @@
 #define __MLPACK_CORE_TREE_RECTANGLE_TREE_RECTANGLE_TREE_HPP
 
 #include <mlpack/core.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
 
 #include "../hrectbound.hpp"
 #include "../statistic.hpp"
@@ -109,6 +110,10 @@ class RectangleTree
   //! A dual tree traverser for rectangle type trees.
   template<typename RuleType>
   class DualTreeTraverser;
+  //! A task-parallel dual tree traverser for rectangle type trees; see
+  //! parallel_dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class ParallelDualTreeTraverser;
 
   /**
    * Construct this as the root node of a rectangle type tree using the given
@@ -131,6 +136,33 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk loading
+   * the given dataset, instead of inserting the points one by one.  The points
+   * are packed into nearly full nodes with the given BulkLoadType (such as
+   * STRBulkLoad or HilbertBulkLoad), which takes O(n log n) time and gives
+   * better filled, less overlapping nodes than insertion.  Points can still be
+   * inserted into and deleted from the tree afterwards.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Instantiated bulk load policy.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  template<typename BulkLoadType>
+  RectangleTree(const MatType& data,
+                const BulkLoadType& bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2,
+                typename boost::disable_if<
+                    boost::is_arithmetic<BulkLoadType> >::type* = 0);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -151,6 +183,17 @@ class RectangleTree
    */
   RectangleTree(const RectangleTree& other, const bool deepCopy = true);
 
+  /**
+   * Create a deep copy of the other tree that refers to the given dataset
+   * instead of the dataset of the other tree.  The dataset has to hold the
+   * same points as the dataset of the other tree (it is usually a copy of it),
+   * and it must stay valid as long as the new tree exists.
+   *
+   * @param other The tree to be copied.
+   * @param data Dataset the new tree refers to.
+   */
+  RectangleTree(const RectangleTree& other, const MatType& data);
+
   /**
    * Deletes this node, deallocating the memory for the children and calling
    * their destructors in turn.  This will invalidate any younters or references
@@ -468,6 +511,13 @@ class RectangleTree
    */
   size_t TreeDepth() const;
 
+  /**
+   * Return the number of bytes used by the subtree rooted at this node: the
+   * nodes, their bounds, point lists and local datasets.  The dataset the tree
+   * was built on is not counted, because it is not owned by the tree.
+   */
+  size_t MemoryUsage() const;
+
   //! Return the index of the beginning point of this subset.
   size_t Begin() const { return begin; }
   //! Modify the index of the beginning point of this subset.
@@ -502,6 +552,21 @@ class RectangleTree
     return new RectangleTree(begin, count, bound, stat, maxLeafSize);
   }
 
+  /**
+   * Fill this empty node with the given points, which are grouped into
+   * children with the bulk load policy, and create its statistic.
+   *
+   * @param indices Indices of the points of the tree.
+   * @param first First element of indices that belongs to this node.
+   * @param numPoints Number of points of this node.
+   * @param level Number of levels below this node (0 for a leaf).
+   */
+  template<typename BulkLoadType>
+  void BulkLoadNode(std::vector<size_t>& indices,
+                    const size_t first,
+                    const size_t numPoints,
+                    const size_t level);
+
   /**
    * Splits the current node, recursing up the tree.
    *
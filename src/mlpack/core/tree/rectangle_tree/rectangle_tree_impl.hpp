@@ -53,6 +53,50 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
     root->InsertPoint(i);
 }
 
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename BulkLoadType>
+RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
+    const MatType& data,
+    const BulkLoadType& /* bulkLoad */,
+    const size_t maxLeafSize,
+    const size_t minLeafSize,
+    const size_t maxNumChildren,
+    const size_t minNumChildren,
+    typename boost::disable_if<boost::is_arithmetic<BulkLoadType> >::type*) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    splitHistory(bound.Dim()),
+    parentDistance(0),
+    dataset(data),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    localDataset(new MatType(data.n_rows, static_cast<int> (maxLeafSize) + 1))
+{
+  std::vector<size_t> indices(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    indices[i] = i;
+  BulkLoadType::Order(data, indices);
+
+  // All leaves are at the same depth, which is the smallest one at which full
+  // nodes can hold all points.
+  size_t level = 0;
+  for (size_t capacity = maxLeafSize; capacity < data.n_cols;
+      capacity *= maxNumChildren)
+    ++level;
+
+  BulkLoadNode<BulkLoadType>(indices, 0, data.n_cols, level);
+}
+
 template<typename SplitType,
          typename DescentType,
          typename StatisticType,
@@ -128,6 +172,43 @@ RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
   }
 }
 
+/**
+ * Create a deep copy of a rectangle tree that refers to another dataset.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+RectangleTree<SplitType, DescentType, StatisticType, MatType>::RectangleTree(
+    const RectangleTree& other,
+    const MatType& data) :
+    maxNumChildren(other.MaxNumChildren()),
+    minNumChildren(other.MinNumChildren()),
+    numChildren(other.NumChildren()),
+    children(maxNumChildren + 1),
+    parent(NULL),
+    begin(other.Begin()),
+    count(other.Count()),
+    maxLeafSize(other.MaxLeafSize()),
+    minLeafSize(other.MinLeafSize()),
+    bound(other.bound),
+    stat(other.stat),
+    splitHistory(other.SplitHistory()),
+    parentDistance(other.ParentDistance()),
+    dataset(data),
+    points(other.Points()),
+    localDataset(NULL)
+{
+  for (size_t i = 0; i < numChildren; i++)
+  {
+    children[i] = new RectangleTree(*(other.Children()[i]), data);
+    children[i]->Parent() = this;
+  }
+
+  if (numChildren == 0)
+    localDataset = new MatType(other.LocalDataset());
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling
  * their destructors in turn.  This will invalidate any pointers or references
@@ -177,6 +258,60 @@ void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
   localDataset = NULL;
 }
 
+/**
+ * Fill an empty node with the given points.  The points of a non-leaf node are
+ * split into as few groups as its children can hold, so all nodes are nearly
+ * full.
+ */
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+template<typename BulkLoadType>
+void RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+    BulkLoadNode(std::vector<size_t>& indices,
+                 const size_t first,
+                 const size_t numPoints,
+                 const size_t level)
+{
+  if (level == 0)
+  {
+    // This is a leaf, so it holds the points themselves.
+    for (size_t i = first; i < first + numPoints; ++i)
+    {
+      bound |= dataset.col(indices[i]);
+      localDataset->col(count) = dataset.col(indices[i]);
+      points[count++] = indices[i];
+    }
+  }
+  else
+  {
+    // Find the number of points the subtree of every child can hold.
+    size_t childCapacity = maxLeafSize;
+    for (size_t i = 1; i < level; ++i)
+      childCapacity *= maxNumChildren;
+
+    const size_t numGroups = (numPoints + childCapacity - 1) /
+        childCapacity;
+    std::vector<size_t> groupBegins;
+    BulkLoadType::Group(dataset, indices, first, numPoints, numGroups,
+        groupBegins);
+
+    for (size_t i = 0; i < numGroups; ++i)
+    {
+      RectangleTree* child = new RectangleTree(this);
+      child->template BulkLoadNode<BulkLoadType>(indices, groupBegins[i],
+          groupBegins[i + 1] - groupBegins[i], level - 1);
+
+      bound |= child->Bound();
+      children[numChildren++] = child;
+    }
+  }
+
+  // Now that the node is filled, create its statistic.
+  stat = StatisticType(*this);
+}
+
 /**
  * Recurse through the tree and insert the point at the leaf node chosen
  * by the heuristic.
@@ -422,6 +557,25 @@ size_t RectangleTree<SplitType, DescentType, StatisticType, MatType>::
   return n;
 }
 
+template<typename SplitType,
+         typename DescentType,
+         typename StatisticType,
+         typename MatType>
+size_t RectangleTree<SplitType, DescentType, StatisticType, MatType>::
+    MemoryUsage() const
+{
+  size_t usage = sizeof(RectangleTree) - sizeof(bound) - sizeof(children) -
+      sizeof(points) + bound.MemoryUsage() + util::MemoryUsage(children) +
+      util::MemoryUsage(points);
+  if (localDataset)
+    usage += util::MemoryUsage(*localDataset);
+
+  for (size_t i = 0; i < numChildren; i++)
+    usage += children[i]->MemoryUsage();
+
+  return usage;
+}
+
 template<typename SplitType,
          typename DescentType,
          typename StatisticType,
@@ -0,0 +1,144 @@
+/**
+ * @file rectangle_tree_snapshots.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of the RectangleTreeSnapshots class, which lets searches run on
+ * consistent snapshots of a rectangle tree while a writer keeps inserting and
+ * deleting points.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_RECTANGLE_TREE_SNAPSHOTS_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_RECTANGLE_TREE_SNAPSHOTS_HPP
+
+#include <mlpack/core.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * A dynamic rectangle tree index with one writer and any number of readers.
+ * The writer inserts and deletes points in its own tree, which is never seen
+ * by the readers.  Publish() then makes a copy of the writer's tree and its
+ * dataset (a snapshot), and atomically replaces the current snapshot with it.
+ *
+ * Readers get the current snapshot with Snapshot().  A snapshot never changes,
+ * and it stays alive as long as some reader holds it, so a reader sees the
+ * same tree for its whole search even if the writer publishes new snapshots in
+ * the meantime; an old snapshot is freed when its last reader releases it.
+ *
+ * The searches of mlpack only modify the statistics of query trees, not of
+ * rectangle reference trees, so many readers can search the same snapshot at
+ * the same time, as long as each of them uses its own query set:
+ *
+ * @code
+ * // In a reader thread.
+ * boost::shared_ptr<Snapshots::SnapshotType> snapshot = snapshots.Snapshot();
+ * NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType>
+ *     knn(&snapshot->Tree());
+ * knn.Search(queries, k, neighbors, distances);
+ * @endcode
+ *
+ * Snapshot() and Publish() synchronize with an OpenMP critical section, so the
+ * readers and the writer have to be OpenMP threads (or the program has to be
+ * built without OpenMP and use a single thread).
+ *
+ * @tparam TreeType Type of the RectangleTree.
+ */
+template<typename TreeType>
+class RectangleTreeSnapshots
+{
+ public:
+  //! The type of the dataset.
+  typedef typename TreeType::Mat MatType;
+
+  //! A consistent, immutable copy of the tree and its dataset.
+  class SnapshotType
+  {
+   public:
+    //! Copy the given tree and its dataset.
+    SnapshotType(const TreeType& tree, const MatType& data) :
+        dataset(data), tree(tree, dataset) { }
+
+    //! Get the dataset of the snapshot.
+    const MatType& Dataset() const { return dataset; }
+
+    //! Get the tree of the snapshot, for searches; do not modify it.
+    TreeType& Tree() { return tree; }
+
+   private:
+    //! The copy of the dataset of the writer.
+    MatType dataset;
+    //! The copy of the tree of the writer, built on dataset.
+    TreeType tree;
+  };
+
+  /**
+   * Build the writer's tree on a copy of the given dataset, and publish the
+   * first snapshot.  The other parameters are passed to the RectangleTree
+   * constructor.
+   *
+   * @param data Initial points of the index.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes of a non-leaf node.
+   * @param minNumChildren The minimum number of child nodes of a non-leaf node.
+   */
+  RectangleTreeSnapshots(const MatType& data,
+                         const size_t maxLeafSize = 20,
+                         const size_t minLeafSize = 8,
+                         const size_t maxNumChildren = 5,
+                         const size_t minNumChildren = 2);
+
+  //! Delete the writer's tree (the snapshots are freed by their readers).
+  ~RectangleTreeSnapshots();
+
+  /**
+   * Insert a point into the writer's tree.  It can be seen by the readers
+   * after the next call to Publish().  This may only be called by the writer.
+   *
+   * @param point The point to insert.
+   * @return The index of the point in the dataset.
+   */
+  size_t InsertPoint(const arma::vec& point);
+
+  /**
+   * Delete the point with the given index from the writer's tree.  The point
+   * stays in the dataset, so the indices of the other points do not change.
+   * This may only be called by the writer.
+   *
+   * @param index Index of the point to delete.
+   * @return Whether or not the point was in the tree.
+   */
+  bool DeletePoint(const size_t index);
+
+  /**
+   * Make the current state of the writer's tree visible to the readers.  This
+   * copies the tree and the dataset, so the writer should batch its updates.
+   */
+  void Publish();
+
+  //! Get the current snapshot.  This can be called by any thread.
+  boost::shared_ptr<SnapshotType> Snapshot() const;
+
+  //! Get the dataset of the writer (with the unpublished points).
+  const MatType& Dataset() const { return dataset; }
+
+  //! Get the tree of the writer (with the unpublished changes).
+  const TreeType& Tree() const { return *tree; }
+
+ private:
+  //! The dataset of the writer; points are only appended to it.
+  MatType dataset;
+  //! The tree of the writer.
+  TreeType* tree;
+  //! The most recently published snapshot.
+  boost::shared_ptr<SnapshotType> current;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "rectangle_tree_snapshots_impl.hpp"
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file rectangle_tree_snapshots_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the RectangleTreeSnapshots class.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_RECTANGLE_TREE_SNAPSHOTS_IMPL_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_RECTANGLE_TREE_SNAPSHOTS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "rectangle_tree_snapshots.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+RectangleTreeSnapshots<TreeType>::RectangleTreeSnapshots(
+    const MatType& data,
+    const size_t maxLeafSize,
+    const size_t minLeafSize,
+    const size_t maxNumChildren,
+    const size_t minNumChildren) :
+    dataset(data),
+    tree(new TreeType(dataset, maxLeafSize, minLeafSize, maxNumChildren,
+        minNumChildren))
+{
+  Publish();
+}
+
+template<typename TreeType>
+RectangleTreeSnapshots<TreeType>::~RectangleTreeSnapshots()
+{
+  delete tree;
+}
+
+template<typename TreeType>
+size_t RectangleTreeSnapshots<TreeType>::InsertPoint(const arma::vec& point)
+{
+  // The tree refers to the dataset object, so it sees the new column even if
+  // the memory of the dataset is reallocated.  The snapshots have their own
+  // copies, so this does not affect the readers.
+  dataset.insert_cols(dataset.n_cols, point);
+  tree->InsertPoint(dataset.n_cols - 1);
+
+  return dataset.n_cols - 1;
+}
+
+template<typename TreeType>
+bool RectangleTreeSnapshots<TreeType>::DeletePoint(const size_t index)
+{
+  return tree->DeletePoint(index);
+}
+
+template<typename TreeType>
+void RectangleTreeSnapshots<TreeType>::Publish()
+{
+  // Build the snapshot outside of the critical section, so readers only wait
+  // for the pointer swap.
+  boost::shared_ptr<SnapshotType> snapshot(new SnapshotType(*tree, dataset));
+
+  #pragma omp critical(rectangleTreeSnapshot)
+  current.swap(snapshot);
+
+  // The old snapshot is freed here, unless a reader still holds it.
+}
+
+template<typename TreeType>
+boost::shared_ptr<typename RectangleTreeSnapshots<TreeType>::SnapshotType>
+RectangleTreeSnapshots<TreeType>::Snapshot() const
+{
+  boost::shared_ptr<SnapshotType> snapshot;
+
+  #pragma omp critical(rectangleTreeSnapshot)
+  snapshot = current;
+
+  return snapshot;
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
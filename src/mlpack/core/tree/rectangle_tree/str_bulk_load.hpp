@@ -0,0 +1,97 @@
+/**
+ * @file str_bulk_load.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of the STRBulkLoad class, which packs the points of a rectangle
+ * tree into nodes with Sort-Tile-Recursive (STR) tiling.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The Sort-Tile-Recursive bulk load of Leutenegger, Lopez and Edgington.  The
+ * points of a node are sorted by the first dimension and cut into slabs, the
+ * points of every slab are sorted by the second dimension and cut into slabs,
+ * and so on; the tiles of the last dimension are the children of the node.
+ * This gives nearly square, well-filled nodes.
+ *
+ * A bulk load policy has to provide two functions, which are used by the bulk
+ * load constructor of the RectangleTree:
+ *
+ * - Order(data, indices): called once with the indices of all points, before
+ *   the tree is built.
+ * - Group(data, indices, begin, count, numGroups, groupBegins): rearrange the
+ *   indices [begin, begin + count) into numGroups groups of nearby points of
+ *   at most ceil(count / numGroups) points each, and store the index of the
+ *   first element of every group (and the end of the last one) in groupBegins.
+ */
+class STRBulkLoad
+{
+ public:
+  //! Nothing has to be done before the tree is built.
+  template<typename MatType>
+  static void Order(const MatType& /* data */,
+                    std::vector<size_t>& /* indices */) { }
+
+  /**
+   * Tile the given points into numGroups groups.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points of the tree.
+   * @param begin First element of indices that belongs to the node.
+   * @param count Number of points of the node.
+   * @param numGroups Number of groups to make.
+   * @param groupBegins Vector to store the numGroups + 1 group boundaries in.
+   */
+  template<typename MatType>
+  static void Group(const MatType& data,
+                    std::vector<size_t>& indices,
+                    const size_t begin,
+                    const size_t count,
+                    const size_t numGroups,
+                    std::vector<size_t>& groupBegins);
+
+ private:
+  /**
+   * Sort the points of the groups [firstGroup, lastGroup) by the given
+   * dimension, and tile the slabs of them by the next dimensions.
+   */
+  template<typename MatType>
+  static void Tile(const MatType& data,
+                   std::vector<size_t>& indices,
+                   const std::vector<size_t>& groupBegins,
+                   const size_t firstGroup,
+                   const size_t lastGroup,
+                   const size_t dimension);
+
+  //! Order point indices by their value in one dimension.
+  template<typename MatType>
+  class DimensionComparator
+  {
+   public:
+    DimensionComparator(const MatType& data, const size_t dimension) :
+        data(data), dimension(dimension) { }
+
+    bool operator()(const size_t a, const size_t b) const
+    {
+      return data(dimension, a) < data(dimension, b);
+    }
+
+   private:
+    const MatType& data;
+    const size_t dimension;
+  };
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "str_bulk_load_impl.hpp"
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file str_bulk_load_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the Sort-Tile-Recursive bulk load of rectangle trees.
+ */
+#ifndef __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_IMPL_HPP
+#define __MLPACK_CORE_TREE_RECTANGLE_TREE_STR_BULK_LOAD_IMPL_HPP
+
+#include "str_bulk_load.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void STRBulkLoad::Group(const MatType& data,
+                        std::vector<size_t>& indices,
+                        const size_t begin,
+                        const size_t count,
+                        const size_t numGroups,
+                        std::vector<size_t>& groupBegins)
+{
+  // The group boundaries are fixed first, so that no tile is larger than the
+  // others because of rounding in the slabs.
+  groupBegins.resize(numGroups + 1);
+  for (size_t i = 0; i <= numGroups; ++i)
+    groupBegins[i] = begin + (i * count) / numGroups;
+
+  Tile(data, indices, groupBegins, 0, numGroups, 0);
+}
+
+template<typename MatType>
+void STRBulkLoad::Tile(const MatType& data,
+                       std::vector<size_t>& indices,
+                       const std::vector<size_t>& groupBegins,
+                       const size_t firstGroup,
+                       const size_t lastGroup,
+                       const size_t dimension)
+{
+  const size_t numGroups = lastGroup - firstGroup;
+  if (numGroups <= 1)
+    return;
+
+  std::sort(indices.begin() + groupBegins[firstGroup],
+      indices.begin() + groupBegins[lastGroup],
+      DimensionComparator<MatType>(data, dimension));
+
+  // In the last dimension, the groups are just runs of the sorted points.
+  if (dimension + 1 >= data.n_rows)
+    return;
+
+  // Otherwise, cut the points into numGroups^(1 / remaining dimensions) slabs,
+  // each of which is tiled by the following dimensions.
+  const size_t numSlabs = (size_t) std::ceil(std::pow((double) numGroups,
+      1.0 / (data.n_rows - dimension)));
+  for (size_t i = 0; i < numSlabs; ++i)
+  {
+    const size_t slabBegin = firstGroup + (i * numGroups) / numSlabs;
+    const size_t slabEnd = firstGroup + ((i + 1) * numGroups) / numSlabs;
+    Tile(data, indices, groupBegins, slabBegin, slabEnd, dimension + 1);
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
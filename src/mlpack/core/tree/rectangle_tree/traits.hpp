@@ -51,6 +51,11 @@ class TreeTraits<RectangleTree<SplitType, DescentType, StatisticType, MatType> >
    * This tree is not necessarily a binary tree.
    */
   static const bool BinaryTree = false;
+
+  /**
+   * The points of a leaf are not a contiguous range of the dataset.
+   */
+  static const bool HasContiguousLeaves = false;
 };
 
 }; // namespace tree
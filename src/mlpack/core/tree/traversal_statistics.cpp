@@ -0,0 +1,55 @@
+/**
+ * @file traversal_statistics.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the traversal profile of a program.
+ */
+#include "traversal_statistics.hpp"
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+bool TraversalProfile::enabled = false;
+std::map<std::string, TraversalStatistics> TraversalProfile::statistics;
+
+void TraversalProfile::Add(const std::string& name,
+                           const TraversalStatistics& statistics)
+{
+  #pragma omp critical(traversalProfile)
+  TraversalProfile::statistics[name] += statistics;
+}
+
+std::map<std::string, TraversalStatistics> TraversalProfile::Statistics()
+{
+  std::map<std::string, TraversalStatistics> result;
+  #pragma omp critical(traversalProfile)
+  result = statistics;
+  return result;
+}
+
+void TraversalProfile::Print(std::ostream& stream)
+{
+  const std::map<std::string, TraversalStatistics> result = Statistics();
+  if (result.empty())
+    return;
+
+  stream << "Traversal statistics:" << std::endl;
+  for (std::map<std::string, TraversalStatistics>::const_iterator it =
+       result.begin(); it != result.end(); ++it)
+  {
+    const TraversalStatistics& s = it->second;
+    stream << "  " << it->first << ":" << std::endl;
+    stream << "    traversals: " << s.traversals << std::endl;
+    stream << "    visited nodes: " << s.visited << std::endl;
+    stream << "    scores: " << s.scores << std::endl;
+    stream << "    prunes: " << s.prunes << " (" << s.rescorePrunes
+        << " by rescoring)" << std::endl;
+    stream << "    base cases: " << s.baseCases << std::endl;
+  }
+}
+
+void TraversalProfile::Reset()
+{
+  #pragma omp critical(traversalProfile)
+  statistics.clear();
+}
@@ -0,0 +1,138 @@
+/**
+ * @file traversal_statistics.hpp
+ * @author Ryan Curtin
+ *
+ * Statistics of tree traversals (visited node combinations, prunes, base
+ * cases), collected in the same way from every traverser and rule set, and a
+ * profile of the traversals of a program that is printed with --profile.
+ */
+#ifndef __MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+#define __MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+
+#include <mlpack/core.hpp>
+
+#include <map>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The statistics of one or more tree traversals.  A counter that the traverser
+ * and the rules of a traversal do not keep is zero.
+ */
+struct TraversalStatistics
+{
+  //! Set all counters to zero.
+  TraversalStatistics() :
+      traversals(0),
+      visited(0),
+      scores(0),
+      prunes(0),
+      rescorePrunes(0),
+      baseCases(0)
+  { }
+
+  //! The number of traversals (or of traversers, for parallel traversals).
+  size_t traversals;
+  //! The number of visited nodes (or node combinations).
+  size_t visited;
+  //! The number of times a node (or node combination) was scored.
+  size_t scores;
+  //! The number of pruned nodes (or node combinations).
+  size_t prunes;
+  //! The number of prunes that were found by rescoring a node (these are
+  //! included in the number of prunes).
+  size_t rescorePrunes;
+  //! The number of base cases.
+  size_t baseCases;
+
+  //! Add the counters of other statistics.
+  TraversalStatistics& operator+=(const TraversalStatistics& other)
+  {
+    traversals += other.traversals;
+    visited += other.visited;
+    scores += other.scores;
+    prunes += other.prunes;
+    rescorePrunes += other.rescorePrunes;
+    baseCases += other.baseCases;
+    return *this;
+  }
+};
+
+/**
+ * The traversal statistics of a program, added up per method.  Methods record
+ * the statistics of their traversals with RecordTraversal(), which does
+ * nothing unless profiling is enabled; the --profile option of every program
+ * enables it, and prints the profile at the end of execution.
+ */
+class TraversalProfile
+{
+ public:
+  //! Return whether or not traversals are recorded.
+  static bool Enabled() { return enabled; }
+  //! Enable or disable the recording of traversals.
+  static void Enable(const bool enable = true) { enabled = enable; }
+
+  /**
+   * Add the given statistics to the statistics of the given method.  This can
+   * be called from several threads at once.
+   *
+   * @param name Name of the method.
+   * @param statistics Statistics of one or more traversals.
+   */
+  static void Add(const std::string& name,
+                  const TraversalStatistics& statistics);
+
+  //! Get the statistics of all methods.
+  static std::map<std::string, TraversalStatistics> Statistics();
+
+  //! Print the statistics of all methods to the given stream.
+  static void Print(std::ostream& stream);
+
+  //! Forget the statistics of all methods.
+  static void Reset();
+
+ private:
+  //! Whether or not traversals are recorded.
+  static bool enabled;
+  //! The statistics of every method.
+  static std::map<std::string, TraversalStatistics> statistics;
+};
+
+/**
+ * Collect the statistics of the traversals done with the given traverser and
+ * rules.  The number of base cases and scores are taken from the rules if they
+ * count them, because the rules also count the base cases and scores that are
+ * not done through the traverser; otherwise they are taken from the traverser.
+ *
+ * @param traverser Traverser that did the traversals.
+ * @param rules Rules of the traversals.
+ */
+template<typename TraverserType, typename RuleType>
+TraversalStatistics GetTraversalStatistics(const TraverserType& traverser,
+                                           const RuleType& rules);
+
+/**
+ * Record the statistics of the traversals done with the given traverser and
+ * rules in the TraversalProfile, if profiling is enabled.
+ *
+ * @param name Name of the method.
+ * @param traverser Traverser that did the traversals.
+ * @param rules Rules of the traversals.
+ */
+template<typename TraverserType, typename RuleType>
+inline void RecordTraversal(const char* name,
+                            const TraverserType& traverser,
+                            const RuleType& rules)
+{
+  if (TraversalProfile::Enabled())
+    TraversalProfile::Add(name, GetTraversalStatistics(traverser, rules));
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "traversal_statistics_impl.hpp"
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file traversal_statistics_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Collection of the counters of traversers and rules.
+ */
+#ifndef __MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_IMPL_HPP
+#define __MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "traversal_statistics.hpp"
+
+namespace mlpack {
+namespace tree {
+
+//! Counters of traversers and rules, which may or may not exist.
+namespace statistics {
+
+HAS_MEM_FUNC(NumVisited, HasNumVisited)
+HAS_MEM_FUNC(NumScores, HasNumScores)
+HAS_MEM_FUNC(NumPrunes, HasNumPrunes)
+HAS_MEM_FUNC(NumRescorePrunes, HasNumRescorePrunes)
+HAS_MEM_FUNC(NumBaseCases, HasNumBaseCases)
+HAS_MEM_FUNC(Scores, HasScores)
+HAS_MEM_FUNC(BaseCases, HasBaseCases)
+
+//! The signature of a counter.
+template<typename T>
+struct Counter
+{
+  typedef size_t (T::*Type)() const;
+};
+
+// Every counter returns zero if the class does not keep it.
+#define MLPACK_TRAVERSAL_COUNTER(FUNC)                                         \
+template<typename T>                                                           \
+size_t FUNC(const T& t, typename boost::enable_if<                            \
+    Has##FUNC<T, typename Counter<T>::Type> >::type* = 0)                      \
+{                                                                              \
+  return t.FUNC();                                                             \
+}                                                                              \
+                                                                               \
+template<typename T>                                                           \
+size_t FUNC(const T& /* t */, typename boost::disable_if<                     \
+    Has##FUNC<T, typename Counter<T>::Type> >::type* = 0)                      \
+{                                                                              \
+  return 0;                                                                    \
+}
+
+MLPACK_TRAVERSAL_COUNTER(NumVisited)
+MLPACK_TRAVERSAL_COUNTER(NumScores)
+MLPACK_TRAVERSAL_COUNTER(NumPrunes)
+MLPACK_TRAVERSAL_COUNTER(NumRescorePrunes)
+MLPACK_TRAVERSAL_COUNTER(NumBaseCases)
+
+#undef MLPACK_TRAVERSAL_COUNTER
+
+//! Get the number of scores from the rules, if they count them.
+template<typename TraverserType, typename RuleType>
+size_t Scores(const TraverserType& /* traverser */,
+              const RuleType& rules,
+              typename boost::enable_if<HasScores<RuleType,
+                  typename Counter<RuleType>::Type> >::type* = 0)
+{
+  return rules.Scores();
+}
+
+//! Get the number of scores from the traverser.
+template<typename TraverserType, typename RuleType>
+size_t Scores(const TraverserType& traverser,
+              const RuleType& /* rules */,
+              typename boost::disable_if<HasScores<RuleType,
+                  typename Counter<RuleType>::Type> >::type* = 0)
+{
+  return NumScores(traverser);
+}
+
+//! Get the number of base cases from the rules, if they count them.
+template<typename TraverserType, typename RuleType>
+size_t BaseCases(const TraverserType& /* traverser */,
+                 const RuleType& rules,
+                 typename boost::enable_if<HasBaseCases<RuleType,
+                     typename Counter<RuleType>::Type> >::type* = 0)
+{
+  return rules.BaseCases();
+}
+
+//! Get the number of base cases from the traverser.
+template<typename TraverserType, typename RuleType>
+size_t BaseCases(const TraverserType& traverser,
+                 const RuleType& /* rules */,
+                 typename boost::disable_if<HasBaseCases<RuleType,
+                     typename Counter<RuleType>::Type> >::type* = 0)
+{
+  return NumBaseCases(traverser);
+}
+
+}; // namespace statistics
+
+template<typename TraverserType, typename RuleType>
+TraversalStatistics GetTraversalStatistics(const TraverserType& traverser,
+                                           const RuleType& rules)
+{
+  TraversalStatistics result;
+  result.traversals = 1;
+  result.visited = statistics::NumVisited(traverser);
+  result.scores = statistics::Scores(traverser, rules);
+  result.prunes = statistics::NumPrunes(traverser);
+  result.rescorePrunes = statistics::NumRescorePrunes(traverser);
+  result.baseCases = statistics::BaseCases(traverser, rules);
+  return result;
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
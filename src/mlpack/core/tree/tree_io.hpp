@@ -0,0 +1,113 @@
+/**
+ * @file tree_io.hpp
+ * @author Ryan Curtin
+ *
+ * Functions to save a built tree (along with the dataset it was built on) to a
+ * binary file and load it back, so that a tree only has to be built once.
+ */
+#ifndef __MLPACK_CORE_TREE_TREE_IO_HPP
+#define __MLPACK_CORE_TREE_TREE_IO_HPP
+
+#include <mlpack/core.hpp>
+#include <iostream>
+
+#include "hrectbound.hpp"
+#include "ballbound.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Write the raw bytes of a plain-old-data object to a binary stream.
+ *
+ * @param stream Stream to write to.
+ * @param value Object to write.
+ */
+template<typename T>
+void WriteBinary(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Read the raw bytes of a plain-old-data object from a binary stream.
+ *
+ * @param stream Stream to read from.
+ * @param value Object to read into.
+ */
+template<typename T>
+void ReadBinary(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+//! Write a hyper-rectangle bound to a binary stream.
+template<int Power, bool TakeRoot>
+void SaveBound(std::ostream& stream,
+               const bound::HRectBound<Power, TakeRoot>& bound);
+
+//! Read a hyper-rectangle bound from a binary stream.  The bound must already
+//! have the right dimensionality.
+template<int Power, bool TakeRoot>
+void LoadBound(std::istream& stream, bound::HRectBound<Power, TakeRoot>& bound);
+
+//! Write a ball bound to a binary stream.
+template<typename VecType, typename MetricType>
+void SaveBound(std::ostream& stream,
+               const bound::BallBound<VecType, MetricType>& bound);
+
+//! Read a ball bound from a binary stream.
+template<typename VecType, typename MetricType>
+void LoadBound(std::istream& stream,
+               bound::BallBound<VecType, MetricType>& bound);
+
+/**
+ * Save the given tree, the dataset it was built on, and the mapping from the
+ * tree's point ordering to the original point ordering to the given file.  The
+ * file is a flat binary file: a short header, the dataset as a raw column-major
+ * array, the mapping, and then the tree's nodes in depth-first order (see the
+ * Save() method of the tree type).  Nothing has to be recomputed when the file
+ * is loaded with LoadTree(); nodes and their bounds are read directly.
+ *
+ * The file is written in the byte order and word size of the machine, so it is
+ * meant to be loaded on the same kind of machine it was saved on.  Only dense
+ * datasets are supported.
+ *
+ * @param filename File to save to.
+ * @param tree Root of the tree to save.
+ * @param oldFromNew Mapping from the tree's point indices to the original point
+ *     indices (empty if the tree did not rearrange the dataset).
+ * @return Whether or not the save was successful.
+ */
+template<typename TreeType>
+bool SaveTree(const std::string& filename,
+              const TreeType& tree,
+              const std::vector<size_t>& oldFromNew = std::vector<size_t>());
+
+/**
+ * Load a tree saved with SaveTree().  The dataset stored in the file is loaded
+ * into the given matrix, which the returned tree refers to; so the matrix must
+ * outlive the tree.  The returned tree must be deleted by the caller.  If the
+ * file cannot be read or is not a valid tree file, NULL is returned and a
+ * warning is issued (or, if fatal is true, a fatal error is issued).
+ *
+ * @param filename File to load from.
+ * @param dataset Matrix to store the dataset the tree is built on in.
+ * @param oldFromNew Vector to store the mapping from the tree's point indices
+ *     to the original point indices in.
+ * @param fatal If true, a failure to load is a fatal error.
+ * @return The loaded tree, or NULL on failure.
+ */
+template<typename TreeType>
+TreeType* LoadTree(const std::string& filename,
+                   typename TreeType::Mat& dataset,
+                   std::vector<size_t>& oldFromNew,
+                   const bool fatal = false);
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "tree_io_impl.hpp"
+
+#endif
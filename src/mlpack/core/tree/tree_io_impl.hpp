@@ -0,0 +1,214 @@
+/**
+ * @file tree_io_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of functions to save and load built trees.
+ */
+#ifndef __MLPACK_CORE_TREE_TREE_IO_IMPL_HPP
+#define __MLPACK_CORE_TREE_TREE_IO_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "tree_io.hpp"
+
+#include <fstream>
+#include <cstring>
+
+namespace mlpack {
+namespace tree {
+
+//! Identifies mlpack tree files.
+static const char treeFileMagic[8] = { 'm', 'l', 'p', 'k', 't', 'r', 'e', 'e' };
+//! Version of the tree file format.
+static const size_t treeFileVersion = 1;
+
+template<int Power, bool TakeRoot>
+void SaveBound(std::ostream& stream,
+               const bound::HRectBound<Power, TakeRoot>& bound)
+{
+  WriteBinary(stream, bound.MinWidth());
+  for (size_t i = 0; i < bound.Dim(); ++i)
+  {
+    WriteBinary(stream, bound[i].Lo());
+    WriteBinary(stream, bound[i].Hi());
+  }
+}
+
+template<int Power, bool TakeRoot>
+void LoadBound(std::istream& stream, bound::HRectBound<Power, TakeRoot>& bound)
+{
+  ReadBinary(stream, bound.MinWidth());
+  for (size_t i = 0; i < bound.Dim(); ++i)
+  {
+    ReadBinary(stream, bound[i].Lo());
+    ReadBinary(stream, bound[i].Hi());
+  }
+}
+
+template<typename VecType, typename MetricType>
+void SaveBound(std::ostream& stream,
+               const bound::BallBound<VecType, MetricType>& bound)
+{
+  WriteBinary(stream, bound.Radius());
+  WriteBinary(stream, (size_t) bound.Center().n_elem);
+  for (size_t i = 0; i < bound.Center().n_elem; ++i)
+    WriteBinary(stream, (double) bound.Center()[i]);
+}
+
+template<typename VecType, typename MetricType>
+void LoadBound(std::istream& stream,
+               bound::BallBound<VecType, MetricType>& bound)
+{
+  size_t dimension;
+  ReadBinary(stream, bound.Radius());
+  ReadBinary(stream, dimension);
+  bound.Center().zeros(dimension);
+  for (size_t i = 0; i < dimension; ++i)
+  {
+    double value;
+    ReadBinary(stream, value);
+    bound.Center()[i] = value;
+  }
+}
+
+template<typename TreeType>
+bool SaveTree(const std::string& filename,
+              const TreeType& tree,
+              const std::vector<size_t>& oldFromNew)
+{
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  std::fstream stream(filename.c_str(), std::fstream::out |
+      std::fstream::binary);
+  if (!stream.is_open())
+  {
+    Log::Warn << "Cannot open file '" << filename << "' to save tree to."
+        << std::endl;
+    return false;
+  }
+
+  Timer::Start("saving_tree");
+
+  // Header: magic, version, and the element size (to catch type mismatches).
+  stream.write(treeFileMagic, sizeof(treeFileMagic));
+  WriteBinary(stream, treeFileVersion);
+  WriteBinary(stream, sizeof(ElemType));
+
+  // The dataset.
+  const typename TreeType::Mat& dataset = tree.Dataset();
+  WriteBinary(stream, (size_t) dataset.n_rows);
+  WriteBinary(stream, (size_t) dataset.n_cols);
+  stream.write(reinterpret_cast<const char*>(dataset.memptr()),
+      sizeof(ElemType) * dataset.n_elem);
+
+  // The mapping.
+  WriteBinary(stream, oldFromNew.size());
+  if (oldFromNew.size() > 0)
+    stream.write(reinterpret_cast<const char*>(&oldFromNew[0]),
+        sizeof(size_t) * oldFromNew.size());
+
+  // The tree itself.
+  tree.Save(stream);
+
+  Timer::Stop("saving_tree");
+
+  if (stream.fail())
+  {
+    Log::Warn << "Error while writing tree to '" << filename << "'."
+        << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+template<typename TreeType>
+TreeType* LoadTree(const std::string& filename,
+                   typename TreeType::Mat& dataset,
+                   std::vector<size_t>& oldFromNew,
+                   const bool fatal)
+{
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  std::fstream stream(filename.c_str(), std::fstream::in |
+      std::fstream::binary);
+  if (!stream.is_open())
+  {
+    if (fatal)
+      Log::Fatal << "Cannot open file '" << filename << "' to load tree from."
+          << std::endl;
+    Log::Warn << "Cannot open file '" << filename << "' to load tree from."
+        << std::endl;
+    return NULL;
+  }
+
+  Timer::Start("loading_tree");
+
+  char magic[sizeof(treeFileMagic)];
+  size_t version, elemSize;
+  stream.read(magic, sizeof(magic));
+  ReadBinary(stream, version);
+  ReadBinary(stream, elemSize);
+
+  if (stream.fail() ||
+      (std::memcmp(magic, treeFileMagic, sizeof(treeFileMagic)) != 0) ||
+      (version != treeFileVersion) || (elemSize != sizeof(ElemType)))
+  {
+    Timer::Stop("loading_tree");
+    if (fatal)
+      Log::Fatal << "'" << filename << "' is not a valid tree file for this "
+          << "tree type." << std::endl;
+    Log::Warn << "'" << filename << "' is not a valid tree file for this tree "
+        << "type." << std::endl;
+    return NULL;
+  }
+
+  // The dataset.
+  size_t rows, cols;
+  ReadBinary(stream, rows);
+  ReadBinary(stream, cols);
+  dataset.set_size(rows, cols);
+  stream.read(reinterpret_cast<char*>(dataset.memptr()),
+      sizeof(ElemType) * dataset.n_elem);
+
+  // The mapping.
+  size_t mappingSize;
+  ReadBinary(stream, mappingSize);
+  oldFromNew.resize(mappingSize);
+  if (mappingSize > 0)
+    stream.read(reinterpret_cast<char*>(&oldFromNew[0]),
+        sizeof(size_t) * mappingSize);
+
+  if (stream.fail())
+  {
+    Timer::Stop("loading_tree");
+    if (fatal)
+      Log::Fatal << "Error while reading tree from '" << filename << "'."
+          << std::endl;
+    Log::Warn << "Error while reading tree from '" << filename << "'."
+        << std::endl;
+    return NULL;
+  }
+
+  // The tree itself.
+  TreeType* tree = new TreeType(dataset, stream);
+
+  Timer::Stop("loading_tree");
+
+  if (stream.fail())
+  {
+    delete tree;
+    if (fatal)
+      Log::Fatal << "Error while reading tree from '" << filename << "'."
+          << std::endl;
+    Log::Warn << "Error while reading tree from '" << filename << "'."
+        << std::endl;
+    return NULL;
+  }
+
+  return tree;
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -99,6 +99,14 @@ class TreeTraits
    * This is true if the tree always has only two children.
    */
   static const bool BinaryTree = false;
+
+  /**
+   * This is true if points are only held in leaves, each leaf holds a
+   * contiguous range [Begin(), End()) of the dataset, and the dual-tree
+   * traverser hands every pair of leaves to the rules' BaseCaseBlock() (if the
+   * rules have one) instead of calling BaseCase() on its own.
+   */
+  static const bool HasContiguousLeaves = false;
 };
 
 }; // namespace tree
@@ -0,0 +1,18 @@
+/**
+ * @file vantage_point_tree.hpp
+ * @author Ryan Curtin
+ *
+ * Includes all the necessary files to use the VantagePointTree class.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_HPP
+
+#include <mlpack/core.hpp>
+#include "vantage_point_tree/vantage_point_tree.hpp"
+#include "vantage_point_tree/single_tree_traverser.hpp"
+#include "vantage_point_tree/single_tree_traverser_impl.hpp"
+#include "vantage_point_tree/dual_tree_traverser.hpp"
+#include "vantage_point_tree/dual_tree_traverser_impl.hpp"
+#include "vantage_point_tree/traits.hpp"
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file dual_tree_traverser.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the DualTreeTraverser for the vantage point tree.  This is a
+ * depth-first traverser which recurses into the larger of the two nodes, and
+ * visits reference children in order of their scores.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_DUAL_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+
+#include "vantage_point_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+class VantagePointTree<MetricType, StatisticType, MatType>::DualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the dual-tree traverser with the given rule set.
+   */
+  DualTreeTraverser(RuleType& rule);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of prunes.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(VantagePointTree& queryNode, VantagePointTree& referenceNode);
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of prunes that were found by rescoring a node (these are
+  //! included in the number of prunes).
+  size_t NumRescorePrunes() const { return numRescorePrunes; }
+  //! Modify the number of prunes that were found by rescoring a node.
+  size_t& NumRescorePrunes() { return numRescorePrunes; }
+
+  //! Get the number of visited combinations.
+  size_t NumVisited() const { return numVisited; }
+  //! Modify the number of visited combinations.
+  size_t& NumVisited() { return numVisited; }
+
+  //! Get the number of times a node combination was scored.
+  size_t NumScores() const { return numScores; }
+  //! Modify the number of times a node combination was scored.
+  size_t& NumScores() { return numScores; }
+
+  //! Get the number of times a base case was calculated.
+  size_t NumBaseCases() const { return numBaseCases; }
+  //! Modify the number of times a base case was calculated.
+  size_t& NumBaseCases() { return numBaseCases; }
+
+ private:
+  /**
+   * Recurse into a node combination which has already been scored, and whose
+   * vantage points have already been evaluated.
+   */
+  void Recurse(VantagePointTree& queryNode, VantagePointTree& referenceNode);
+
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! The number of prunes.
+  size_t numPrunes;
+
+  //! The number of prunes that were found by rescoring a node.
+  size_t numRescorePrunes;
+
+  //! The number of node combinations that have been visited during traversal.
+  size_t numVisited;
+
+  //! The number of times a node combination was scored.
+  size_t numScores;
+
+  //! The number of times a base case was calculated.
+  size_t numBaseCases;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "dual_tree_traverser_impl.hpp"
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file dual_tree_traverser_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the dual-tree traverser for the vantage point tree.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+VantagePointTree<MetricType, StatisticType, MatType>::
+DualTreeTraverser<RuleType>::DualTreeTraverser(RuleType& rule) :
+    rule(rule),
+    numPrunes(0),
+    numRescorePrunes(0),
+    numVisited(0),
+    numScores(0),
+    numBaseCases(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+void VantagePointTree<MetricType, StatisticType, MatType>::
+DualTreeTraverser<RuleType>::Traverse(
+    VantagePointTree& queryNode,
+    VantagePointTree& referenceNode)
+{
+  if (queryNode.NumDescendants() == 0 || referenceNode.NumDescendants() == 0)
+    return;
+
+  // Evaluate the vantage points of the roots, and make the traversal info point
+  // at the roots, so that the rules take that evaluation when the roots are
+  // scored.
+  typename RuleType::TraversalInfoType& traversalInfo = rule.TraversalInfo();
+  traversalInfo.LastQueryNode() = &queryNode;
+  traversalInfo.LastReferenceNode() = &referenceNode;
+  traversalInfo.LastScore() = 0.0;
+  traversalInfo.LastBaseCase() = rule.BaseCase(queryNode.Point(0),
+      referenceNode.Point(0));
+  ++numBaseCases;
+
+  ++numScores;
+  if (rule.Score(queryNode, referenceNode) == DBL_MAX)
+  {
+    ++numPrunes;
+    return;
+  }
+
+  Recurse(queryNode, referenceNode);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+void VantagePointTree<MetricType, StatisticType, MatType>::
+DualTreeTraverser<RuleType>::Recurse(
+    VantagePointTree& queryNode,
+    VantagePointTree& referenceNode)
+{
+  ++numVisited;
+
+  // If both are leaves, we must evaluate the base cases, except for the two
+  // vantage points, which have been evaluated already.
+  if (queryNode.IsLeaf() && referenceNode.IsLeaf())
+  {
+    for (size_t query = 0; query < queryNode.NumPoints(); ++query)
+    {
+      for (size_t ref = (query == 0) ? 1 : 0; ref < referenceNode.NumPoints();
+          ++ref)
+      {
+        rule.BaseCase(queryNode.Point(query), referenceNode.Point(ref));
+        ++numBaseCases;
+      }
+    }
+
+    return;
+  }
+
+  // Save the traversal info of this combination; each child combination is
+  // scored with it.
+  typedef typename RuleType::TraversalInfoType TraversalInfoType;
+  const TraversalInfoType traversalInfo = rule.TraversalInfo();
+
+  // Descend the larger of the two nodes.
+  if (referenceNode.IsLeaf() || (!queryNode.IsLeaf() &&
+      queryNode.FurthestDescendantDistance() >=
+      referenceNode.FurthestDescendantDistance()))
+  {
+    // The results for each query child are independent, so there is no need
+    // to order them.
+    for (size_t i = 0; i < 2; ++i)
+    {
+      VantagePointTree& queryChild = queryNode.Child(i);
+
+      rule.TraversalInfo() = traversalInfo;
+      ++numScores;
+      if (rule.Score(queryChild, referenceNode) == DBL_MAX)
+      {
+        ++numPrunes;
+        continue;
+      }
+
+      // The outer child has a new vantage point.
+      if (i == 1)
+      {
+        rule.BaseCase(queryChild.Point(0), referenceNode.Point(0));
+        ++numBaseCases;
+      }
+
+      Recurse(queryChild, referenceNode);
+    }
+  }
+  else
+  {
+    VantagePointTree& innerNode = referenceNode.Child(0);
+    VantagePointTree& outerNode = referenceNode.Child(1);
+
+    // Score both children, and evaluate the new vantage point of the outer
+    // child right away, while the rules still hold it.
+    rule.TraversalInfo() = traversalInfo;
+    ++numScores;
+    double innerScore = rule.Score(queryNode, innerNode);
+    const TraversalInfoType innerInfo = rule.TraversalInfo();
+
+    rule.TraversalInfo() = traversalInfo;
+    ++numScores;
+    double outerScore = rule.Score(queryNode, outerNode);
+    const TraversalInfoType outerInfo = rule.TraversalInfo();
+    if (outerScore != DBL_MAX)
+    {
+      rule.BaseCase(queryNode.Point(0), outerNode.Point(0));
+      ++numBaseCases;
+    }
+
+    // Recurse into the better child first.
+    const bool outerFirst = (outerScore < innerScore);
+    VantagePointTree& first = outerFirst ? outerNode : innerNode;
+    VantagePointTree& second = outerFirst ? innerNode : outerNode;
+    const double firstScore = outerFirst ? outerScore : innerScore;
+    double secondScore = outerFirst ? innerScore : outerScore;
+
+    if (firstScore == DBL_MAX)
+    {
+      // Both children are pruned.
+      numPrunes += 2;
+      return;
+    }
+
+    rule.TraversalInfo() = outerFirst ? outerInfo : innerInfo;
+    Recurse(queryNode, first);
+
+    // Is it still valid to recurse into the other child?
+    if (secondScore != DBL_MAX)
+    {
+      secondScore = rule.Rescore(queryNode, second, secondScore);
+      if (secondScore != DBL_MAX)
+      {
+        rule.TraversalInfo() = outerFirst ? innerInfo : outerInfo;
+        Recurse(queryNode, second);
+        return;
+      }
+
+      ++numRescorePrunes;
+    }
+
+    ++numPrunes;
+  }
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
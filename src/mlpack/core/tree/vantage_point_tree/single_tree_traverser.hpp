@@ -0,0 +1,73 @@
+/**
+ * @file single_tree_traverser.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the SingleTreeTraverser for the vantage point tree.  This is a
+ * depth-first traverser which visits the child with the better score first.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_SINGLE_TREE_TRAVERSER_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/core.hpp>
+
+#include "vantage_point_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+class VantagePointTree<MetricType, StatisticType, MatType>::SingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the single tree traverser with the given rule set.
+   */
+  SingleTreeTraverser(RuleType& rule);
+
+  /**
+   * Traverse the tree with the given point.  The given node is scored first,
+   * so that the rules can reuse the distance to its vantage point in the
+   * self-children of the node.
+   *
+   * @param queryIndex The index of the point in the query set which is being
+   *     used as the query point.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const size_t queryIndex, VantagePointTree& referenceNode);
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of prunes that were found by rescoring a node (these are
+  //! included in the number of prunes).
+  size_t NumRescorePrunes() const { return numRescorePrunes; }
+  //! Modify the number of prunes that were found by rescoring a node.
+  size_t& NumRescorePrunes() { return numRescorePrunes; }
+
+ private:
+  /**
+   * Recurse into a node which has already been scored, and whose vantage point
+   * has already been evaluated with the query point.
+   */
+  void Recurse(const size_t queryIndex, VantagePointTree& referenceNode);
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The number of nodes which have been pruned during traversal.
+  size_t numPrunes;
+
+  //! The number of prunes that were found by rescoring a node.
+  size_t numRescorePrunes;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "single_tree_traverser_impl.hpp"
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file single_tree_traverser_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the single-tree traverser for the vantage point tree.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+VantagePointTree<MetricType, StatisticType, MatType>::
+SingleTreeTraverser<RuleType>::SingleTreeTraverser(RuleType& rule) :
+    rule(rule),
+    numPrunes(0),
+    numRescorePrunes(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+void VantagePointTree<MetricType, StatisticType, MatType>::
+SingleTreeTraverser<RuleType>::Traverse(
+    const size_t queryIndex,
+    VantagePointTree& referenceNode)
+{
+  if (referenceNode.NumDescendants() == 0)
+    return;
+
+  // Score the node first; the base case with the vantage point is free after
+  // that, because the rules calculate it in Score().
+  if (rule.Score(queryIndex, referenceNode) == DBL_MAX)
+  {
+    ++numPrunes;
+    return;
+  }
+
+  rule.BaseCase(queryIndex, referenceNode.Point(0));
+  Recurse(queryIndex, referenceNode);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+template<typename RuleType>
+void VantagePointTree<MetricType, StatisticType, MatType>::
+SingleTreeTraverser<RuleType>::Recurse(
+    const size_t queryIndex,
+    VantagePointTree& referenceNode)
+{
+  // If we are a leaf, run the base case with the rest of the points.
+  if (referenceNode.IsLeaf())
+  {
+    for (size_t i = 1; i < referenceNode.NumPoints(); ++i)
+      rule.BaseCase(queryIndex, referenceNode.Point(i));
+
+    return;
+  }
+
+  VantagePointTree* innerNode = referenceNode.Left();
+  VantagePointTree* outerNode = referenceNode.Right();
+
+  // The inner child shares our vantage point, so its score comes from the
+  // distance we already have.  The outer child has a new vantage point, which
+  // is evaluated right after it is scored.
+  double innerScore = rule.Score(queryIndex, *innerNode);
+  double outerScore = rule.Score(queryIndex, *outerNode);
+  if (outerScore != DBL_MAX)
+    rule.BaseCase(queryIndex, outerNode->Point(0));
+
+  // Recurse into the better child first.
+  VantagePointTree* first = innerNode;
+  VantagePointTree* second = outerNode;
+  double firstScore = innerScore;
+  double secondScore = outerScore;
+  if (outerScore < innerScore)
+  {
+    std::swap(first, second);
+    std::swap(firstScore, secondScore);
+  }
+
+  if (firstScore == DBL_MAX)
+  {
+    // Both children are pruned.
+    numPrunes += 2;
+    return;
+  }
+
+  Recurse(queryIndex, *first);
+
+  // Is it still valid to recurse into the other child?
+  if (secondScore != DBL_MAX)
+  {
+    secondScore = rule.Rescore(queryIndex, *second, secondScore);
+    if (secondScore != DBL_MAX)
+    {
+      Recurse(queryIndex, *second);
+      return;
+    }
+
+    ++numRescorePrunes;
+  }
+
+  ++numPrunes;
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
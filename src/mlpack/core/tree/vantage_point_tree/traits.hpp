@@ -0,0 +1,62 @@
+/**
+ * @file traits.hpp
+ * @author Ryan Curtin
+ *
+ * This file contains the specialization of the TreeTraits class for the
+ * VantagePointTree type of tree.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_TRAITS_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_TRAITS_HPP
+
+#include <mlpack/core/tree/tree_traits.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The specialization of the TreeTraits class for the VantagePointTree tree
+ * type.  It defines characteristics of the vantage point tree, and is used to
+ * help write tree-independent (but still optimized) tree-based algorithms.  See
+ * mlpack/core/tree/tree_traits.hpp for more information.
+ */
+template<typename MetricType, typename StatisticType, typename MatType>
+class TreeTraits<VantagePointTree<MetricType, StatisticType, MatType>>
+{
+ public:
+  /**
+   * The inner child holds the vantage point of its parent, and the balls of the
+   * children may overlap.
+   */
+  static const bool HasOverlappingChildren = true;
+
+  /**
+   * The first point of each node is its vantage point, which is the center of
+   * its ball.
+   */
+  static const bool FirstPointIsCentroid = true;
+
+  /**
+   * The inner child of each node is a self-child.
+   */
+  static const bool HasSelfChildren = true;
+
+  /**
+   * Points are not rearranged when the tree is built.
+   */
+  static const bool RearrangesDataset = false;
+
+  /**
+   * The vantage point tree is a binary tree.
+   */
+  static const bool BinaryTree = true;
+
+  /**
+   * The points of a leaf are not contiguous in the dataset.
+   */
+  static const bool HasContiguousLeaves = false;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,339 @@
+/**
+ * @file vantage_point_tree.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of VantagePointTree, a binary metric tree that can be used in
+ * place of the BinarySpaceTree or the CoverTree with any metric.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_VANTAGE_POINT_TREE_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_VANTAGE_POINT_TREE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "../statistic.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A vantage point tree is a binary metric tree.  Each node is a ball around a
+ * point of the dataset, its vantage point, which holds all of the descendant
+ * points of the node.  The descendants of a node are split by their distance to
+ * the vantage point: the nearer half goes to the inner child, and the further
+ * half goes to the outer child.  Only the metric is used to build and search
+ * the tree, so it works with any metric (edit distances, the Mahalanobis
+ * distance, kernel-induced metrics, ...), and because the splits only depend on
+ * distances, it is well-suited to metrics that are expensive to evaluate.
+ *
+ * The inner child keeps the vantage point of its parent, so it is a
+ * "self-child" (see TreeTraits::HasSelfChildren), and the distances between
+ * the points of the inner child and the vantage point do not have to be
+ * computed again.  The vantage point of the outer child is the point that is
+ * furthest from the vantage point of the parent.  A non-leaf node holds only
+ * its vantage point (Point(0)); a leaf holds its vantage point and up to
+ * maxLeafSize - 1 other points.  The dataset is not modified.
+ *
+ * For more information on vantage point trees, see
+ *
+ * @code
+ * @inproceedings{yianilos1993data,
+ *   author = {Yianilos, P.N.},
+ *   title = {Data structures and algorithms for nearest neighbor search in
+ *       general metric spaces},
+ *   booktitle = {Proceedings of the Fourth Annual ACM-SIAM Symposium on
+ *       Discrete Algorithms},
+ *   series = {SODA '93},
+ *   year = {1993},
+ *   pages = {311--321}
+ * }
+ * @endcode
+ *
+ * @tparam MetricType Metric type to use during tree construction.
+ * @tparam StatisticType Statistic to be used during tree creation.
+ * @tparam MatType Type of matrix to build the tree on (generally mat or
+ *      sp_mat).
+ */
+template<typename MetricType = metric::LMetric<2, true>,
+         typename StatisticType = EmptyStatistic,
+         typename MatType = arma::mat>
+class VantagePointTree
+{
+ public:
+  typedef MatType Mat;
+
+  /**
+   * Create the vantage point tree with the given dataset and maximum leaf size.
+   * The metric is default-constructed.  The dataset will not be modified during
+   * the building procedure.
+   *
+   * @param dataset Reference to the dataset to build a tree on.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  VantagePointTree(const MatType& dataset, const size_t maxLeafSize = 20);
+
+  /**
+   * Create the vantage point tree with the given dataset, instantiated metric,
+   * and maximum leaf size.  The dataset will not be modified during the
+   * building procedure.
+   *
+   * @param dataset Reference to the dataset to build a tree on.
+   * @param metric Instantiated metric to use during tree building.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  VantagePointTree(const MatType& dataset,
+                   MetricType& metric,
+                   const size_t maxLeafSize = 20);
+
+  /**
+   * Create a vantage point tree from another tree.  The copy does not share any
+   * memory with the original tree; if the original tree was given a metric by
+   * the user, the copy uses the same metric.
+   *
+   * @param other Tree to copy from.
+   */
+  VantagePointTree(const VantagePointTree& other);
+
+  /**
+   * Delete this node and its children.
+   */
+  ~VantagePointTree();
+
+  //! A single-tree traverser for vantage point trees; see
+  //! single_tree_traverser.hpp for implementation.
+  template<typename RuleType>
+  class SingleTreeTraverser;
+
+  //! A dual-tree traverser for vantage point trees; see
+  //! dual_tree_traverser.hpp.
+  template<typename RuleType>
+  class DualTreeTraverser;
+
+  template<typename RuleType>
+  using BreadthFirstDualTreeTraverser = DualTreeTraverser<RuleType>;
+
+  //! Get a reference to the dataset.
+  const MatType& Dataset() const { return dataset; }
+
+  //! Return whether or not this node is a leaf.
+  bool IsLeaf() const { return (inner == NULL); }
+
+  //! Get the number of children (0 for a leaf, 2 otherwise).
+  size_t NumChildren() const { return (inner == NULL) ? 0 : 2; }
+
+  //! Get a particular child node; child 0 is the inner (self-)child.
+  const VantagePointTree& Child(const size_t index) const
+  { return (index == 0) ? *inner : *outer; }
+  //! Modify a particular child node.
+  VantagePointTree& Child(const size_t index)
+  { return (index == 0) ? *inner : *outer; }
+
+  //! Get the inner child (NULL for a leaf).
+  VantagePointTree* Left() const { return inner; }
+  //! Get the outer child (NULL for a leaf).
+  VantagePointTree* Right() const { return outer; }
+
+  //! Get the parent node (NULL if this is the root of the tree).
+  VantagePointTree* Parent() const { return parent; }
+
+  //! Get the number of points held in this node.
+  size_t NumPoints() const { return (inner == NULL) ? count : 1; }
+
+  //! Get the index of a particular point held in this node; Point(0) is the
+  //! vantage point.
+  size_t Point(const size_t index = 0) const
+  { return (*indices)[begin + index]; }
+
+  //! Get the number of descendant points.
+  size_t NumDescendants() const { return count; }
+
+  //! Get the index of a particular descendant point; Descendant(0) is the
+  //! vantage point.
+  size_t Descendant(const size_t index) const
+  { return (*indices)[begin + index]; }
+
+  //! Get the statistic for this node.
+  const StatisticType& Stat() const { return stat; }
+  //! Modify the statistic for this node.
+  StatisticType& Stat() { return stat; }
+
+  //! Get the instantiated metric.
+  MetricType& Metric() const { return *metric; }
+
+  //! Get the distance from the vantage point to the vantage point of the
+  //! parent (0 for the inner child and the root).
+  double ParentDistance() const { return parentDistance; }
+
+  //! Get the distance from the vantage point to the furthest descendant.
+  double FurthestDescendantDistance() const
+  { return furthestDescendantDistance; }
+
+  //! Get the distance from the vantage point to the furthest point held in
+  //! this node.
+  double FurthestPointDistance() const
+  { return (inner == NULL) ? furthestDescendantDistance : 0.0; }
+
+  //! Get the minimum distance from the center to any bound edge (this is the
+  //! same as the furthest descendant distance).
+  double MinimumBoundDistance() const { return furthestDescendantDistance; }
+
+  //! Get the centroid of the node (the vantage point) and store it in the given
+  //! vector.
+  void Centroid(arma::vec& centroid) const
+  {
+    centroid = arma::vec(dataset.col(Point(0)));
+  }
+
+  //! Return the minimum distance to another node.
+  double MinDistance(const VantagePointTree* other) const;
+
+  //! Return the minimum distance to another node given that the distance
+  //! between the vantage points has already been calculated.
+  double MinDistance(const VantagePointTree* other,
+                     const double distance) const;
+
+  //! Return the minimum distance to a point.
+  double MinDistance(const arma::vec& point) const;
+
+  //! Return the minimum distance to a point given that the distance between
+  //! the vantage point and the point has already been calculated.
+  double MinDistance(const arma::vec& point, const double distance) const;
+
+  //! Return the maximum distance to another node.
+  double MaxDistance(const VantagePointTree* other) const;
+
+  //! Return the maximum distance to another node given that the distance
+  //! between the vantage points has already been calculated.
+  double MaxDistance(const VantagePointTree* other,
+                     const double distance) const;
+
+  //! Return the maximum distance to a point.
+  double MaxDistance(const arma::vec& point) const;
+
+  //! Return the maximum distance to a point given that the distance between
+  //! the vantage point and the point has already been calculated.
+  double MaxDistance(const arma::vec& point, const double distance) const;
+
+  //! Return the minimum and maximum distance to another node.
+  math::Range RangeDistance(const VantagePointTree* other) const;
+
+  //! Return the minimum and maximum distance to another node given that the
+  //! distance between the vantage points has already been calculated.
+  math::Range RangeDistance(const VantagePointTree* other,
+                            const double distance) const;
+
+  //! Return the minimum and maximum distance to a point.
+  math::Range RangeDistance(const arma::vec& point) const;
+
+  //! Return the minimum and maximum distance to a point given that the
+  //! distance between the vantage point and the point has already been
+  //! calculated.
+  math::Range RangeDistance(const arma::vec& point,
+                            const double distance) const;
+
+  /**
+   * Return the number of bytes used by the subtree rooted at this node,
+   * including the index array and a metric that are owned by the node.  The
+   * dataset is not counted, because it is not owned by the tree.
+   */
+  size_t MemoryUsage() const;
+
+  /**
+   * Returns a string representation of this object.
+   */
+  std::string ToString() const;
+
+ private:
+  /**
+   * Construct a child node, which holds the points indices[begin] to
+   * indices[begin + count - 1], with indices[begin] as its vantage point.  The
+   * distances between the vantage point and the other points must be stored in
+   * the same positions of the distances vector.
+   *
+   * @param parent Parent of this node.
+   * @param begin Position of the first point of this node in the index array.
+   * @param count Number of points of this node.
+   * @param parentDistance Distance between the vantage point and the vantage
+   *     point of the parent.
+   * @param distances Distances to the vantage point; they may be overwritten.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  VantagePointTree(VantagePointTree* parent,
+                   const size_t begin,
+                   const size_t count,
+                   const double parentDistance,
+                   arma::vec& distances,
+                   const size_t maxLeafSize);
+
+  /**
+   * Copy the given node of another tree as a child of the given parent, which
+   * holds the given index array and the metric.
+   */
+  VantagePointTree(const VantagePointTree& other,
+                   VantagePointTree* parent,
+                   arma::Col<size_t>* indices);
+
+  /**
+   * Build the tree from the root: choose the vantage point, compute the
+   * distances to it, and split the points.
+   */
+  void BuildRoot(const size_t maxLeafSize);
+
+  /**
+   * Split the points of this node into the inner and the outer child, if there
+   * are more than maxLeafSize of them, and compute the furthest descendant
+   * distance.
+   */
+  void SplitNode(arma::vec& distances, const size_t maxLeafSize);
+
+  //! Reference to the matrix which this tree is built on.
+  const MatType& dataset;
+
+  //! The indices of the points of the dataset, ordered so that the points of
+  //! every node are contiguous.  This is shared by all nodes of the tree.
+  arma::Col<size_t>* indices;
+
+  //! Position of the vantage point of this node in the index array.
+  size_t begin;
+
+  //! Number of descendant points of this node.
+  size_t count;
+
+  //! The inner child (NULL if this is a leaf).
+  VantagePointTree* inner;
+
+  //! The outer child (NULL if this is a leaf).
+  VantagePointTree* outer;
+
+  //! The parent node (NULL if this is the root of the tree).
+  VantagePointTree* parent;
+
+  //! Distance between the vantage point and the vantage point of the parent.
+  double parentDistance;
+
+  //! Distance between the vantage point and the furthest descendant.
+  double furthestDescendantDistance;
+
+  //! The instantiated statistic.
+  StatisticType stat;
+
+  //! Whether or not we need to destroy the index array in the destructor.
+  bool localIndices;
+
+  //! Whether or not we need to destroy the metric in the destructor.
+  bool localMetric;
+
+  //! The metric used for this tree.
+  MetricType* metric;
+};
+
+}; // namespace tree
+}; // namespace mlpack
+
+// Include implementation.
+#include "vantage_point_tree_impl.hpp"
+
+// Include the rest of the pieces, if necessary.
+#include "../vantage_point_tree.hpp"
+
+#endif
@@ -0,0 +1,394 @@
+/**
+ * @file vantage_point_tree_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the VantagePointTree class.
+ */
+#ifndef __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_VANTAGE_POINT_TREE_IMPL_HPP
+#define __MLPACK_CORE_TREE_VANTAGE_POINT_TREE_VANTAGE_POINT_TREE_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "vantage_point_tree.hpp"
+
+#include <mlpack/core/util/string_util.hpp>
+#include <algorithm>
+#include <string>
+
+namespace mlpack {
+namespace tree {
+
+// Create the tree with a default-constructed metric.
+template<typename MetricType, typename StatisticType, typename MatType>
+VantagePointTree<MetricType, StatisticType, MatType>::VantagePointTree(
+    const MatType& dataset,
+    const size_t maxLeafSize) :
+    dataset(dataset),
+    indices(new arma::Col<size_t>()),
+    begin(0),
+    count(dataset.n_cols),
+    inner(NULL),
+    outer(NULL),
+    parent(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    localIndices(true),
+    localMetric(true),
+    metric(new MetricType())
+{
+  BuildRoot(maxLeafSize);
+
+  // Initialize the statistic, now that the children are built.
+  stat = StatisticType(*this);
+}
+
+// Create the tree with the given metric.
+template<typename MetricType, typename StatisticType, typename MatType>
+VantagePointTree<MetricType, StatisticType, MatType>::VantagePointTree(
+    const MatType& dataset,
+    MetricType& metric,
+    const size_t maxLeafSize) :
+    dataset(dataset),
+    indices(new arma::Col<size_t>()),
+    begin(0),
+    count(dataset.n_cols),
+    inner(NULL),
+    outer(NULL),
+    parent(NULL),
+    parentDistance(0),
+    furthestDescendantDistance(0),
+    localIndices(true),
+    localMetric(false),
+    metric(&metric)
+{
+  BuildRoot(maxLeafSize);
+
+  // Initialize the statistic, now that the children are built.
+  stat = StatisticType(*this);
+}
+
+// Construct a child node.
+template<typename MetricType, typename StatisticType, typename MatType>
+VantagePointTree<MetricType, StatisticType, MatType>::VantagePointTree(
+    VantagePointTree* parent,
+    const size_t begin,
+    const size_t count,
+    const double parentDistance,
+    arma::vec& distances,
+    const size_t maxLeafSize) :
+    dataset(parent->Dataset()),
+    indices(parent->indices),
+    begin(begin),
+    count(count),
+    inner(NULL),
+    outer(NULL),
+    parent(parent),
+    parentDistance(parentDistance),
+    furthestDescendantDistance(0),
+    localIndices(false),
+    localMetric(false),
+    metric(parent->metric)
+{
+  SplitNode(distances, maxLeafSize);
+
+  // Initialize the statistic, now that the children are built.
+  stat = StatisticType(*this);
+}
+
+// Copy constructor.
+template<typename MetricType, typename StatisticType, typename MatType>
+VantagePointTree<MetricType, StatisticType, MatType>::VantagePointTree(
+    const VantagePointTree& other) :
+    dataset(other.dataset),
+    indices(new arma::Col<size_t>(*other.indices)),
+    begin(other.begin),
+    count(other.count),
+    inner(NULL),
+    outer(NULL),
+    parent(other.parent),
+    parentDistance(other.parentDistance),
+    furthestDescendantDistance(other.furthestDescendantDistance),
+    stat(other.stat),
+    localIndices(true),
+    localMetric(other.localMetric),
+    metric(other.localMetric ? new MetricType(*other.metric) : other.metric)
+{
+  // Copy each child, which will use our copy of the index array and metric.
+  if (other.inner != NULL)
+  {
+    inner = new VantagePointTree(*other.inner, this, indices);
+    outer = new VantagePointTree(*other.outer, this, indices);
+  }
+}
+
+// Copy a child node.
+template<typename MetricType, typename StatisticType, typename MatType>
+VantagePointTree<MetricType, StatisticType, MatType>::VantagePointTree(
+    const VantagePointTree& other,
+    VantagePointTree* parent,
+    arma::Col<size_t>* indices) :
+    dataset(other.dataset),
+    indices(indices),
+    begin(other.begin),
+    count(other.count),
+    inner(NULL),
+    outer(NULL),
+    parent(parent),
+    parentDistance(other.parentDistance),
+    furthestDescendantDistance(other.furthestDescendantDistance),
+    stat(other.stat),
+    localIndices(false),
+    localMetric(false),
+    metric(parent->metric)
+{
+  if (other.inner != NULL)
+  {
+    inner = new VantagePointTree(*other.inner, this, indices);
+    outer = new VantagePointTree(*other.outer, this, indices);
+  }
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+VantagePointTree<MetricType, StatisticType, MatType>::~VantagePointTree()
+{
+  delete inner;
+  delete outer;
+
+  // Delete the local metric and index array, if necessary.
+  if (localMetric)
+    delete metric;
+  if (localIndices)
+    delete indices;
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+void VantagePointTree<MetricType, StatisticType, MatType>::BuildRoot(
+    const size_t maxLeafSize)
+{
+  if (count == 0)
+    return;
+
+  *indices = arma::linspace<arma::Col<size_t> >(0, count - 1, count);
+
+  // The first point is the vantage point of the root.
+  arma::vec distances(count);
+  distances[0] = 0.0;
+  for (size_t i = 1; i < count; ++i)
+    distances[i] = metric->Evaluate(dataset.col(0), dataset.col(i));
+
+  SplitNode(distances, maxLeafSize);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+void VantagePointTree<MetricType, StatisticType, MatType>::SplitNode(
+    arma::vec& distances,
+    const size_t maxLeafSize)
+{
+  // The ball around the vantage point must hold every descendant.
+  for (size_t i = begin + 1; i < begin + count; ++i)
+    furthestDescendantDistance = std::max(furthestDescendantDistance,
+        distances[i]);
+
+  if (count <= std::max(maxLeafSize, (size_t) 1))
+    return; // This is a leaf.
+
+  // Split the points other than the vantage point around the median distance.
+  // At least one point goes to the outer child.
+  const size_t numOthers = count - 1;
+  const size_t numInner = numOthers / 2;
+
+  std::vector<std::pair<double, size_t> > order(numOthers);
+  for (size_t i = 0; i < numOthers; ++i)
+    order[i] = std::make_pair(distances[begin + 1 + i],
+        (*indices)[begin + 1 + i]);
+
+  std::nth_element(order.begin(), order.begin() + numInner, order.end());
+
+  // The vantage point of the outer child is the point furthest from our
+  // vantage point; put it first.
+  std::iter_swap(order.begin() + numInner, std::max_element(order.begin() +
+      numInner, order.end()));
+
+  for (size_t i = 0; i < numOthers; ++i)
+  {
+    distances[begin + 1 + i] = order[i].first;
+    (*indices)[begin + 1 + i] = order[i].second;
+  }
+
+  // The inner child has the same vantage point, so the distances can be
+  // reused.
+  inner = new VantagePointTree(this, begin, numInner + 1, 0.0, distances,
+      maxLeafSize);
+
+  // The distances of the outer points must be computed to the new vantage
+  // point.
+  const size_t outerBegin = begin + numInner + 1;
+  const size_t outerCount = numOthers - numInner;
+  const size_t outerPoint = (*indices)[outerBegin];
+  const double outerDistance = distances[outerBegin];
+
+  distances[outerBegin] = 0.0;
+  for (size_t i = outerBegin + 1; i < outerBegin + outerCount; ++i)
+    distances[i] = metric->Evaluate(dataset.col(outerPoint),
+        dataset.col((*indices)[i]));
+
+  outer = new VantagePointTree(this, outerBegin, outerCount, outerDistance,
+      distances, maxLeafSize);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MinDistance(
+    const VantagePointTree* other) const
+{
+  return std::max(metric->Evaluate(dataset.col(Point(0)),
+      other->Dataset().col(other->Point(0))) - furthestDescendantDistance -
+      other->FurthestDescendantDistance(), 0.0);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MinDistance(
+    const VantagePointTree* other,
+    const double distance) const
+{
+  // We already have the distance as evaluated by the metric.
+  return std::max(distance - furthestDescendantDistance -
+      other->FurthestDescendantDistance(), 0.0);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MinDistance(
+    const arma::vec& other) const
+{
+  return std::max(metric->Evaluate(dataset.col(Point(0)), other) -
+      furthestDescendantDistance, 0.0);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MinDistance(
+    const arma::vec& /* other */,
+    const double distance) const
+{
+  return std::max(distance - furthestDescendantDistance, 0.0);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MaxDistance(
+    const VantagePointTree* other) const
+{
+  return metric->Evaluate(dataset.col(Point(0)),
+      other->Dataset().col(other->Point(0))) + furthestDescendantDistance +
+      other->FurthestDescendantDistance();
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MaxDistance(
+    const VantagePointTree* other,
+    const double distance) const
+{
+  // We already have the distance as evaluated by the metric.
+  return distance + furthestDescendantDistance +
+      other->FurthestDescendantDistance();
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MaxDistance(
+    const arma::vec& other) const
+{
+  return metric->Evaluate(dataset.col(Point(0)), other) +
+      furthestDescendantDistance;
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+double VantagePointTree<MetricType, StatisticType, MatType>::MaxDistance(
+    const arma::vec& /* other */,
+    const double distance) const
+{
+  return distance + furthestDescendantDistance;
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+math::Range VantagePointTree<MetricType, StatisticType, MatType>::
+    RangeDistance(const VantagePointTree* other) const
+{
+  const double distance = metric->Evaluate(dataset.col(Point(0)),
+      other->Dataset().col(other->Point(0)));
+
+  return RangeDistance(other, distance);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+math::Range VantagePointTree<MetricType, StatisticType, MatType>::
+    RangeDistance(const VantagePointTree* other, const double distance) const
+{
+  math::Range result;
+  result.Lo() = std::max(distance - furthestDescendantDistance -
+      other->FurthestDescendantDistance(), 0.0);
+  result.Hi() = distance + furthestDescendantDistance +
+      other->FurthestDescendantDistance();
+
+  return result;
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+math::Range VantagePointTree<MetricType, StatisticType, MatType>::
+    RangeDistance(const arma::vec& other) const
+{
+  const double distance = metric->Evaluate(dataset.col(Point(0)), other);
+
+  return RangeDistance(other, distance);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+math::Range VantagePointTree<MetricType, StatisticType, MatType>::
+    RangeDistance(const arma::vec& /* other */, const double distance) const
+{
+  return math::Range(std::max(distance - furthestDescendantDistance, 0.0),
+                     distance + furthestDescendantDistance);
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+size_t VantagePointTree<MetricType, StatisticType, MatType>::MemoryUsage()
+    const
+{
+  size_t usage = sizeof(VantagePointTree);
+  if (localIndices)
+    usage += util::MemoryUsage(*indices);
+  if (localMetric)
+    usage += sizeof(MetricType);
+
+  if (inner != NULL)
+    usage += inner->MemoryUsage() + outer->MemoryUsage();
+
+  return usage;
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+std::string VantagePointTree<MetricType, StatisticType, MatType>::ToString()
+    const
+{
+  std::ostringstream convert;
+  convert << "VantagePointTree [" << this << "]" << std::endl;
+  convert << "  dataset: " << &dataset << std::endl;
+  convert << "  vantage point: " << ((count > 0) ? Point(0) : 0) << std::endl;
+  convert << "  parent distance: " << parentDistance << std::endl;
+  convert << "  furthest descendant distance: " << furthestDescendantDistance;
+  convert << std::endl;
+  convert << "  descendants: " << NumDescendants() << std::endl;
+
+  // How many levels should we print?  This will print the top two tree levels.
+  if (!IsLeaf() && parent == NULL)
+  {
+    convert << "  inner child:" << std::endl;
+    convert << mlpack::util::Indent(inner->ToString(), 2);
+    convert << "  outer child:" << std::endl;
+    convert << mlpack::util::Indent(outer->ToString(), 2);
+  }
+
+  convert << "StatisticType: " << stat << std::endl;
+
+  return convert.str();
+}
+
+}; // namespace tree
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * @file batch_scheduler.hpp
+ * @author Ryan Curtin
+ *
+ * A scheduler that gathers single queries submitted by concurrent callers into
+ * batches, so that online serving can use the batch (dual-tree, blocked)
+ * implementations of the searches and models.
+ */
+#ifndef __MLPACK_CORE_UTIL_BATCH_SCHEDULER_HPP
+#define __MLPACK_CORE_UTIL_BATCH_SCHEDULER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * A scheduler for online queries that arrive one point at a time from any
+ * number of threads.  Answering them one by one can't use the batch code paths
+ * of the methods (dual-tree searches, blocked GMM scoring, and so on), so the
+ * scheduler queues the queries and a worker thread answers them in batches: a
+ * batch is dispatched as soon as maxBatchSize queries are waiting, or when the
+ * oldest waiting query has waited for maxDelay seconds.  While a batch is
+ * answered, the next one fills up, so under load the batches grow by
+ * themselves, and under light load no query waits longer than the deadline
+ * (plus the time to answer its batch).
+ *
+ * @code
+ * AllkNN search(referenceSet);
+ * NeighborBatchHandler<AllkNN> handler(search, 5);
+ * BatchScheduler<NeighborBatchHandler<AllkNN> > scheduler(handler, 128, 0.002);
+ *
+ * // From any thread.
+ * NeighborResult result = scheduler.Query(point);
+ * @endcode
+ *
+ * The handler is only ever called from the worker thread, so it doesn't have
+ * to be thread-safe.  It has to provide the type of the result of one query,
+ * and a method that answers a batch of queries (the columns of the matrix),
+ * storing one result per query in the given vector:
+ *
+ * @code
+ * typedef ... ResultType;
+ * void Query(const arma::mat& queries, std::vector<ResultType>& results);
+ * @endcode
+ *
+ * The queries of a batch all have the same dimensionality; a query whose
+ * dimensionality differs from the previous ones starts a new batch.  If the
+ * handler fails (including with Log::Fatal), or doesn't return one result per
+ * query, every query of the batch gets the exception.
+ *
+ * @tparam HandlerType Type of the object that answers the batches.
+ */
+template<typename HandlerType>
+class BatchScheduler
+{
+ public:
+  //! The result of a single query.
+  typedef typename HandlerType::ResultType ResultType;
+
+  /**
+   * Create the scheduler and start its worker thread.
+   *
+   * @param handler Object that answers the batches.
+   * @param maxBatchSize Maximum number of queries in a batch.
+   * @param maxDelay Maximum time (in seconds) that the oldest query waits for
+   *     the batch to fill up.
+   */
+  BatchScheduler(HandlerType& handler,
+                 const size_t maxBatchSize = 64,
+                 const double maxDelay = 0.002);
+
+  /**
+   * Answer the queries that are still waiting, and stop the worker thread.
+   */
+  ~BatchScheduler();
+
+  /**
+   * Submit a query, and return a future that holds its result once its batch
+   * has been answered.  This can be called from any thread.
+   *
+   * @param query Query point.
+   */
+  std::future<ResultType> Submit(const arma::vec& query);
+
+  /**
+   * Submit a query and wait for its result.  The exception of a failed batch
+   * is thrown again here.
+   *
+   * @param query Query point.
+   */
+  ResultType Query(const arma::vec& query) { return Submit(query).get(); }
+
+  //! Get the maximum number of queries in a batch.
+  size_t MaxBatchSize() const { return maxBatchSize; }
+  //! Get the maximum time (in seconds) that a query waits for its batch.
+  double MaxDelay() const { return maxDelay; }
+
+  //! Get the number of batches answered so far.
+  size_t Batches() const;
+  //! Get the number of queries answered so far.
+  size_t Queries() const;
+
+ private:
+  //! A query that waits for its batch.
+  struct Pending
+  {
+    arma::vec query;
+    std::promise<ResultType> result;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+  //! Gather the batches and answer them until the scheduler is destroyed.
+  void Work();
+
+  //! Answer one batch and hand out its results.
+  void Answer(std::vector<Pending>& batch);
+
+  //! The object that answers the batches.
+  HandlerType& handler;
+  //! The maximum number of queries in a batch.
+  size_t maxBatchSize;
+  //! The maximum time that a query waits for its batch.
+  double maxDelay;
+
+  //! The queries that wait for a batch, oldest first.
+  std::deque<Pending> queue;
+  //! Lock for the queue, the counts, and the stop flag.
+  mutable std::mutex lock;
+  //! Signalled when a query arrives, or when the scheduler stops.
+  std::condition_variable arrived;
+  //! Whether the worker thread should stop once the queue is empty.
+  bool stopping;
+  //! The number of batches answered.
+  size_t batches;
+  //! The number of queries answered.
+  size_t queries;
+  //! The thread that answers the batches.
+  std::thread worker;
+};
+
+//! The result of a single neighbor search query.
+struct NeighborResult
+{
+  //! The indices of the neighbors, nearest first.
+  arma::Col<size_t> neighbors;
+  //! The distances to the neighbors.
+  arma::vec distances;
+};
+
+/**
+ * A handler for BatchScheduler that searches for the k neighbors of the
+ * queries with any search object that provides
+ *
+ * @code
+ * void Search(const arma::mat& querySet, const size_t k,
+ *             arma::Mat<size_t>& neighbors, arma::mat& distances);
+ * @endcode
+ *
+ * such as NeighborSearch (which searches a whole batch with a dual-tree
+ * traversal) and LSHSearch.
+ *
+ * @tparam SearchType Type of the search object.
+ */
+template<typename SearchType>
+class NeighborBatchHandler
+{
+ public:
+  typedef NeighborResult ResultType;
+
+  /**
+   * Create the handler.
+   *
+   * @param search Search object, whose reference set is already set.
+   * @param k Number of neighbors to search for.
+   */
+  NeighborBatchHandler(SearchType& search, const size_t k) :
+      search(search), k(k) { }
+
+  //! Search for the neighbors of a batch of queries.
+  void Query(const arma::mat& queries, std::vector<ResultType>& results)
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    search.Search(queries, k, neighbors, distances);
+
+    results.resize(queries.n_cols);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      results[i].neighbors = neighbors.col(i);
+      results[i].distances = distances.col(i);
+    }
+  }
+
+ private:
+  //! The search object.
+  SearchType& search;
+  //! The number of neighbors to search for.
+  size_t k;
+};
+
+/**
+ * A handler for BatchScheduler that scores the queries with any model that
+ * provides
+ *
+ * @code
+ * void LogProbability(const arma::mat& observations,
+ *                     arma::vec& logProbabilities) const;
+ * @endcode
+ *
+ * such as GMM (which scores a batch in blocks) and the distributions.  The
+ * result of a query is its log-probability.
+ *
+ * @tparam ModelType Type of the model.
+ */
+template<typename ModelType>
+class LogProbabilityBatchHandler
+{
+ public:
+  typedef double ResultType;
+
+  //! Create the handler for the given model.
+  LogProbabilityBatchHandler(const ModelType& model) : model(model) { }
+
+  //! Score a batch of queries.
+  void Query(const arma::mat& queries, std::vector<ResultType>& results)
+  {
+    arma::vec logProbabilities;
+    model.LogProbability(queries, logProbabilities);
+    results.assign(logProbabilities.begin(), logProbabilities.end());
+  }
+
+ private:
+  //! The model.
+  const ModelType& model;
+};
+
+}; // namespace util
+}; // namespace mlpack
+
+// Include implementation.
+#include "batch_scheduler_impl.hpp"
+
+#endif
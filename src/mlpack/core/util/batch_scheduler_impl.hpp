@@ -0,0 +1,158 @@
+/**
+ * @file batch_scheduler_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the BatchScheduler.
+ */
+#ifndef __MLPACK_CORE_UTIL_BATCH_SCHEDULER_IMPL_HPP
+#define __MLPACK_CORE_UTIL_BATCH_SCHEDULER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_scheduler.hpp"
+
+#include <exception>
+#include <stdexcept>
+
+namespace mlpack {
+namespace util {
+
+template<typename HandlerType>
+BatchScheduler<HandlerType>::BatchScheduler(HandlerType& handler,
+                                            const size_t maxBatchSize,
+                                            const double maxDelay) :
+    handler(handler),
+    maxBatchSize(std::max(maxBatchSize, (size_t) 1)),
+    maxDelay(std::max(maxDelay, 0.0)),
+    stopping(false),
+    batches(0),
+    queries(0)
+{
+  worker = std::thread(&BatchScheduler::Work, this);
+}
+
+template<typename HandlerType>
+BatchScheduler<HandlerType>::~BatchScheduler()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+
+  arrived.notify_one();
+  worker.join();
+}
+
+template<typename HandlerType>
+std::future<typename HandlerType::ResultType>
+BatchScheduler<HandlerType>::Submit(const arma::vec& query)
+{
+  Pending pending;
+  pending.query = query;
+  pending.arrival = std::chrono::steady_clock::now();
+  std::future<ResultType> result = pending.result.get_future();
+
+  bool wake;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    queue.push_back(std::move(pending));
+
+    // The worker only has to know about the first query of a batch (which
+    // sets the deadline) and about a full batch.
+    wake = (queue.size() == 1 || queue.size() >= maxBatchSize);
+  }
+
+  if (wake)
+    arrived.notify_one();
+
+  return result;
+}
+
+template<typename HandlerType>
+size_t BatchScheduler<HandlerType>::Batches() const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return batches;
+}
+
+template<typename HandlerType>
+size_t BatchScheduler<HandlerType>::Queries() const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return queries;
+}
+
+template<typename HandlerType>
+void BatchScheduler<HandlerType>::Work()
+{
+  const std::chrono::steady_clock::duration delay =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(maxDelay));
+
+  std::unique_lock<std::mutex> guard(lock);
+  while (true)
+  {
+    while (!stopping && queue.empty())
+      arrived.wait(guard);
+    if (queue.empty())
+      return;
+
+    // Wait until the batch is full or the oldest query is due.  Once the
+    // scheduler stops, the remaining queries are answered right away.
+    const std::chrono::steady_clock::time_point deadline =
+        queue.front().arrival + delay;
+    while (!stopping && queue.size() < maxBatchSize &&
+        std::chrono::steady_clock::now() < deadline)
+      arrived.wait_until(guard, deadline);
+
+    std::vector<Pending> batch;
+    const size_t dimensionality = queue.front().query.n_elem;
+    while (!queue.empty() && batch.size() < maxBatchSize &&
+        queue.front().query.n_elem == dimensionality)
+    {
+      batch.push_back(std::move(queue.front()));
+      queue.pop_front();
+    }
+
+    // New queries can be submitted while the batch is answered.
+    guard.unlock();
+    Answer(batch);
+    guard.lock();
+
+    ++batches;
+    queries += batch.size();
+  }
+}
+
+template<typename HandlerType>
+void BatchScheduler<HandlerType>::Answer(std::vector<Pending>& batch)
+{
+  arma::mat points(batch[0].query.n_elem, batch.size());
+  for (size_t i = 0; i < batch.size(); ++i)
+    points.col(i) = batch[i].query;
+
+  std::vector<ResultType> results;
+  try
+  {
+    handler.Query(points, results);
+    if (results.size() != batch.size())
+    {
+      throw std::runtime_error("BatchScheduler: the handler did not return one "
+          "result per query");
+    }
+  }
+  catch (...)
+  {
+    const std::exception_ptr error = std::current_exception();
+    for (size_t i = 0; i < batch.size(); ++i)
+      batch[i].result.set_exception(error);
+    return;
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i)
+    batch[i].result.set_value(std::move(results[i]));
+}
+
+}; // namespace util
+}; // namespace mlpack
+
+#endif
@@ -8,14 +8,24 @@
 #include <boost/program_options.hpp>
 #include <boost/any.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "cli.hpp"
 #include "log.hpp"
+#include "log_sink.hpp"
+#include "memory_usage.hpp"
+#include "numa.hpp"
+#include "perf_counters.hpp"
+#include "trace.hpp"
 
 #include "option.hpp"
 
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
 using namespace mlpack;
 using namespace mlpack::util;
 
@@ -73,6 +83,53 @@ CLI::~CLI()
       Log::Info << "  " << i << ": ";
       timer.PrintTimer((*it).first);
     }
+
+    ScopedTimers::Print();
+    PerfCounters::Print();
+
+    const size_t peakMemory = PeakResidentMemory();
+    if (peakMemory > 0)
+    {
+      std::ostringstream megabytes;
+      megabytes << std::fixed << std::setprecision(1)
+          << (peakMemory / 1048576.0);
+      Log::Info << "Peak resident memory: " << megabytes.str() << " MB ("
+          << peakMemory << " bytes)." << std::endl;
+    }
+  }
+
+  // Write the queued log output before anything is printed directly.
+  LogSink::Stop();
+
+  if (HasParam("profile") && !HasParam("help") && !HasParam("info"))
+    tree::TraversalProfile::Print(std::cout);
+
+  // Write the trace, with the statistics of the traversals as counters.
+  if (HasParam("profile_output") && !HasParam("help") && !HasParam("info"))
+  {
+    const std::map<std::string, tree::TraversalStatistics> statistics =
+        tree::TraversalProfile::Statistics();
+    std::map<std::string, tree::TraversalStatistics>::const_iterator it;
+    for (it = statistics.begin(); it != statistics.end(); ++it)
+    {
+      std::vector<std::pair<std::string, double> > values;
+      values.push_back(std::make_pair("traversals", it->second.traversals));
+      values.push_back(std::make_pair("visited", it->second.visited));
+      values.push_back(std::make_pair("scores", it->second.scores));
+      values.push_back(std::make_pair("prunes", it->second.prunes));
+      values.push_back(std::make_pair("rescore_prunes",
+          it->second.rescorePrunes));
+      values.push_back(std::make_pair("base_cases", it->second.baseCases));
+      Trace::Counter(it->first, values);
+    }
+
+    const std::string filename = GetParam<std::string>("profile_output");
+    std::ofstream stream(filename.c_str());
+    if (stream.is_open())
+      Trace::Write(stream);
+    else
+      Log::Warn << "Cannot open '" << filename << "' to write the trace."
+          << std::endl;
   }
 
   // Notify the user if we are debugging, but only if we actually parsed the
@@ -224,6 +281,36 @@ void CLI::DefaultMessages()
     Log::Info.ignoreInput = false;
   }
 
+  // Write the log output from a background thread, if requested.
+  if (HasParam("async_log"))
+    LogSink::Start();
+
+  // Count the hardware events in the timers, if requested.
+  if (HasParam("perf_counters") && !PerfCounters::Enable())
+  {
+    Log::Warn << "Hardware performance counters are not available; check "
+        << "/proc/sys/kernel/perf_event_paranoid." << std::endl;
+  }
+
+  // Place the data and the threads of the parallel searches on the NUMA nodes,
+  // if requested.
+  if (HasParam("numa") && !Numa::Enable())
+  {
+    Log::Warn << "Only one NUMA node was found; --numa has no effect."
+        << std::endl;
+  }
+
+  // Record the statistics of the tree traversals, if they will be printed.
+  if (HasParam("profile"))
+    tree::TraversalProfile::Enable();
+
+  // Record the trace of the timers and the traversals, if it will be written.
+  if (HasParam("profile_output"))
+  {
+    Trace::Enable();
+    tree::TraversalProfile::Enable();
+  }
+
   // Notify the user if we are debugging.  This is not done in the constructor
   // because the output streams may not be set up yet.  We also don't want this
   // message twice if the user just asked for help or information.
@@ -742,3 +829,18 @@ PARAM_STRING("info", "Get help on a specific module or option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_FLAG("profile", "Display statistics of the tree traversals (visited "
+    "nodes, prunes and base cases) at the end of execution.", "");
+PARAM_FLAG("async_log", "Buffer the log output of every thread and write it "
+    "from a background thread, so that logging doesn't wait for I/O (only "
+    "complete lines are shown).", "");
+PARAM_STRING("profile_output", "If specified, the runs of the timers (with "
+    "their threads) and the statistics of the tree traversals are written to "
+    "this file as JSON in the Chrome trace event format (see "
+    "chrome://tracing).", "", "");
+PARAM_FLAG("perf_counters", "Count the cycles, instructions, cache misses and "
+    "branch mispredictions of the timers and threads with the hardware "
+    "performance counters, and display them with --verbose (Linux only).", "");
+PARAM_FLAG("numa", "Spread the datasets of the parallel searches over the NUMA "
+    "nodes, pin the threads to the nodes, and give every thread the queries "
+    "stored on its node first (Linux only).", "");
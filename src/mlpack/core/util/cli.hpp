@@ -18,6 +18,7 @@
 #include <boost/program_options.hpp>
 
 #include "timers.hpp"
+#include "scoped_timer.hpp"
 #include "cli_deleter.hpp" // To make sure we can delete the singleton.
 #include "version.hpp"
 
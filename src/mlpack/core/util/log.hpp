@@ -45,6 +45,13 @@ namespace mlpack {
  * mode.  Messages to Log::Info will only be shown when the --verbose flag is
  * given to the program (or rather, the CLI class).
  *
+ * In non-debug mode Log::Debug is a NullOutStream, so the compiler removes the
+ * output entirely (but the expressions given to it are still evaluated).
+ * Messages to a stream that ignores its input are not formatted.  The output
+ * can be written from a background thread with util::LogSink (the --async_log
+ * flag); otherwise it is written as it comes, except inside parallel regions,
+ * where only complete lines are written.
+ *
  * @see PrefixedOutStream, NullOutStream, CLI
  */
 class Log
@@ -0,0 +1,164 @@
+/**
+ * @file log_sink.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the asynchronous log sink.
+ */
+#include "log_sink.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace mlpack::util;
+
+namespace {
+
+//! Whether or not the writer thread is running; read without the lock.
+std::atomic<bool> running(false);
+
+//! A queued text, with its destination.
+typedef std::pair<std::ostream*, std::string> QueuedText;
+
+/**
+ * The state of the sink.  The writer thread is stopped when the program exits,
+ * so that no output is lost if Stop() isn't called.
+ */
+struct SinkState
+{
+  SinkState() : stopping(false), queued(0), written(0) { }
+
+  ~SinkState() { StopWriter(); }
+
+  //! Stop the writer thread, after it has written the queue.
+  void StopWriter()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!writer.joinable())
+        return;
+
+      // From now on, texts are written directly; the writer empties the queue
+      // before it returns.
+      running = false;
+      stopping = true;
+    }
+
+    work.notify_one();
+    writer.join();
+  }
+
+  //! The loop of the writer thread, which writes the queue in batches.
+  void WriterLoop()
+  {
+    std::deque<QueuedText> batch;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      while (!stopping && queue.empty())
+        work.wait(lock);
+      if (queue.empty())
+        break; // Stopping, and everything has been written.
+
+      batch.swap(queue);
+      lock.unlock();
+
+      // Write the texts, and flush every destination once per batch.
+      std::set<std::ostream*> destinations;
+      for (size_t i = 0; i < batch.size(); ++i)
+      {
+        batch[i].first->write(batch[i].second.data(), batch[i].second.size());
+        destinations.insert(batch[i].first);
+      }
+      for (std::set<std::ostream*>::iterator it = destinations.begin();
+           it != destinations.end(); ++it)
+        (*it)->flush();
+
+      lock.lock();
+      written += batch.size();
+      batch.clear();
+      done.notify_all();
+    }
+  }
+
+  //! Protects everything below, and the direct writes.
+  std::mutex mutex;
+  //! Signals the writer that there is work (or that it should stop).
+  std::condition_variable work;
+  //! Signals threads in Flush() that texts have been written.
+  std::condition_variable done;
+
+  //! The writer thread (if it is running).
+  std::thread writer;
+  //! Whether or not the writer should stop once the queue is empty.
+  bool stopping;
+  //! The texts that haven't been written yet.
+  std::deque<QueuedText> queue;
+  //! The number of texts queued since the start.
+  size_t queued;
+  //! The number of queued texts written since the start.
+  size_t written;
+};
+
+SinkState& State()
+{
+  static SinkState state;
+  return state;
+}
+
+} // anonymous namespace
+
+void LogSink::Start()
+{
+  SinkState& state = State();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.writer.joinable())
+    return;
+
+  state.stopping = false;
+  state.writer = std::thread(&SinkState::WriterLoop, &state);
+  running = true;
+}
+
+bool LogSink::Running()
+{
+  return running;
+}
+
+void LogSink::Stop()
+{
+  State().StopWriter();
+}
+
+void LogSink::Write(std::ostream& destination, std::string& text)
+{
+  SinkState& state = State();
+  std::unique_lock<std::mutex> lock(state.mutex);
+  if (running)
+  {
+    state.queue.push_back(QueuedText(&destination, std::string()));
+    state.queue.back().second.swap(text);
+    ++state.queued;
+    lock.unlock();
+    state.work.notify_one();
+  }
+  else
+  {
+    destination.write(text.data(), text.size());
+    destination.flush();
+    text.clear();
+  }
+}
+
+void LogSink::Flush()
+{
+  SinkState& state = State();
+  std::unique_lock<std::mutex> lock(state.mutex);
+  const size_t target = state.queued;
+  while (state.written < target)
+    state.done.wait(lock);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file log_sink.hpp
+ * @author Ryan Curtin
+ *
+ * An asynchronous sink for the output of the log streams.
+ */
+#ifndef __MLPACK_CORE_UTIL_LOG_SINK_HPP
+#define __MLPACK_CORE_UTIL_LOG_SINK_HPP
+
+#include <iostream>
+#include <string>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * The sink that the log streams (PrefixedOutStream) write complete lines to.
+ * By default, lines are written to their destination immediately, under a
+ * lock, so that the lines of different threads don't interleave.
+ *
+ * Once Start() has been called, the log streams instead collect the output of
+ * every thread in a buffer of that thread, and hand whole lines to the sink,
+ * which queues them and writes them from a background thread.  The threads
+ * that log then never wait for I/O, and no output is shown before its line is
+ * complete.  Log::Fatal flushes the sink before it throws.  Output written to
+ * the destinations directly (not through the log) may appear out of order
+ * with the queued lines, unless Flush() is called first.
+ *
+ * @code
+ * util::LogSink::Start();
+ * for (size_t i = 0; i < iterations; ++i)
+ *   Log::Info << "Iteration " << i << "." << std::endl; // Doesn't block.
+ * util::LogSink::Stop(); // Writes everything that's left.
+ * @endcode
+ *
+ * The CLI starts the sink with the --async_log option.
+ */
+class LogSink
+{
+ public:
+  //! Start the background writer; the log streams buffer per thread from now.
+  static void Start();
+
+  //! Write all queued lines and stop the background writer.
+  static void Stop();
+
+  //! Return whether or not the background writer is running.
+  static bool Running();
+
+  /**
+   * Write the given text (which should consist of complete lines) to the given
+   * destination.  If the background writer is running, the text is queued;
+   * otherwise, it is written immediately.  The given string is emptied.
+   *
+   * @param destination Stream to write the text to.
+   * @param text Text to write.
+   */
+  static void Write(std::ostream& destination, std::string& text);
+
+  //! Wait until all lines queued so far have been written.
+  static void Flush();
+};
+
+}; // namespace util
+}; // namespace mlpack
+
+#endif
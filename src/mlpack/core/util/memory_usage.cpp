@@ -0,0 +1,53 @@
+/**
+ * @file memory_usage.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the queries of the peak memory usage of the process.
+ */
+#include "memory_usage.hpp"
+
+#include <fstream>
+#include <string>
+#include <cstdlib>
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+size_t mlpack::util::PeakResidentMemory()
+{
+#ifdef __linux__
+  // VmHWM can be reset (unlike ru_maxrss), so prefer it.
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      return 1024 * (size_t) atol(line.c_str() + 6);
+#endif
+
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+  #ifdef __APPLE__
+    return (size_t) usage.ru_maxrss; // Bytes on OS X.
+  #else
+    return 1024 * (size_t) usage.ru_maxrss; // Kilobytes elsewhere.
+  #endif
+  }
+#endif
+
+  return 0;
+}
+
+void mlpack::util::ResetPeakResidentMemory()
+{
+#ifdef __linux__
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs.is_open())
+    clearRefs << "5" << std::endl;
+#endif
+}
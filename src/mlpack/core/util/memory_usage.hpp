@@ -0,0 +1,115 @@
+/**
+ * @file memory_usage.hpp
+ * @author Ryan Curtin
+ *
+ * Utilities to account for the memory used by matrices, models and trees, and
+ * to query the peak memory usage of the process.
+ */
+#ifndef __MLPACK_CORE_UTIL_MEMORY_USAGE_HPP
+#define __MLPACK_CORE_UTIL_MEMORY_USAGE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * Return the number of bytes used by a dense matrix (or vector), including the
+ * object itself.  Elements are only counted if the matrix owns them: small
+ * matrices store their elements inside the object, and matrices that use
+ * auxiliary memory don't own it.
+ */
+template<typename eT>
+size_t MemoryUsage(const arma::Mat<eT>& matrix)
+{
+  const bool ownsHeapMemory = (matrix.mem_state == 0) &&
+      (matrix.n_elem > arma::arma_config::mat_prealloc);
+  return sizeof(matrix) + (ownsHeapMemory ? matrix.n_elem * sizeof(eT) : 0);
+}
+
+//! Return the number of bytes used by a sparse matrix (CSC storage).
+template<typename eT>
+size_t MemoryUsage(const arma::SpMat<eT>& matrix)
+{
+  return sizeof(matrix) + (matrix.n_nonzero + 1) * (sizeof(eT) +
+      sizeof(arma::uword)) + (matrix.n_cols + 1) * sizeof(arma::uword);
+}
+
+/**
+ * Return the number of bytes used by a vector of elements that don't allocate
+ * memory themselves, including the reserved capacity.
+ */
+template<typename T>
+size_t MemoryUsage(const std::vector<T>& vector)
+{
+  return sizeof(vector) + vector.capacity() * sizeof(T);
+}
+
+//! Return the number of bytes used by a vector of matrices.
+template<typename eT>
+size_t MemoryUsage(const std::vector<arma::Mat<eT> >& vector)
+{
+  size_t usage = sizeof(vector) + (vector.capacity() - vector.size()) *
+      sizeof(arma::Mat<eT>);
+  for (size_t i = 0; i < vector.size(); ++i)
+    usage += MemoryUsage(vector[i]);
+  return usage;
+}
+
+//! Return the number of bytes used by a vector of column vectors.
+template<typename eT>
+size_t MemoryUsage(const std::vector<arma::Col<eT> >& vector)
+{
+  size_t usage = sizeof(vector) + (vector.capacity() - vector.size()) *
+      sizeof(arma::Col<eT>);
+  for (size_t i = 0; i < vector.size(); ++i)
+    usage += MemoryUsage(vector[i]);
+  return usage;
+}
+
+HAS_MEM_FUNC(MemoryUsage, HasMemoryUsage);
+
+/**
+ * Return the number of bytes used by an object.  If the class of the object
+ * has a MemoryUsage() method, that is used; otherwise, the object is assumed
+ * to not allocate any memory, and its size is returned.  This is meant for
+ * the policy classes that models hold (update rules, termination policies),
+ * most of which don't keep any data.
+ */
+template<typename T>
+size_t ObjectMemoryUsage(
+    const T& object,
+    const typename boost::enable_if<HasMemoryUsage<T,
+        size_t(T::*)() const> >::type* = 0)
+{
+  return object.MemoryUsage();
+}
+
+template<typename T>
+size_t ObjectMemoryUsage(
+    const T& object,
+    const typename boost::disable_if<HasMemoryUsage<T,
+        size_t(T::*)() const> >::type* = 0)
+{
+  return sizeof(object);
+}
+
+/**
+ * Return the peak resident memory (the high water mark of the resident set
+ * size) of the process, in bytes, or 0 if it can't be determined on this
+ * platform.
+ */
+size_t PeakResidentMemory();
+
+/**
+ * Reset the peak resident memory of the process, so that PeakResidentMemory()
+ * returns the peak of what follows.  This is only possible on Linux; elsewhere,
+ * the peak of the whole process is reported.
+ */
+void ResetPeakResidentMemory();
+
+}; // namespace util
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * @file numa.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the discovery of the NUMA nodes, the pinning of the
+ * threads and the NUMA-aware scheduler.
+ */
+#include "numa.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+
+using namespace mlpack;
+
+namespace {
+
+/**
+ * The processors of every node that this process may run on, whether the
+ * placement is enabled, and the size of the team that was last pinned.
+ */
+struct Topology
+{
+  Topology() : enabled(false), pinnedThreads(0)
+  {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+      for (size_t node = 0; ; ++node)
+      {
+        std::ostringstream filename;
+        filename << "/sys/devices/system/node/node" << node << "/cpulist";
+        std::ifstream file(filename.str().c_str());
+        if (!file.is_open())
+          break;
+
+        // The list is like "0-7,16-23".
+        std::vector<int> cpus;
+        std::string range;
+        while (std::getline(file, range, ','))
+        {
+          int first, last;
+          const char* text = range.c_str();
+          if (sscanf(text, "%d-%d", &first, &last) != 2)
+          {
+            if (sscanf(text, "%d", &first) != 1)
+              continue;
+            last = first;
+          }
+
+          for (int cpu = first; cpu <= last; ++cpu)
+            if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+              cpus.push_back(cpu);
+        }
+
+        if (!cpus.empty())
+          nodes.push_back(cpus);
+      }
+    }
+#endif
+
+    // Without any information, everything is on one node.
+    if (nodes.empty())
+      nodes.push_back(std::vector<int>());
+  }
+
+  std::vector<std::vector<int> > nodes;
+  std::atomic<bool> enabled;
+  std::mutex lock;
+  size_t pinnedThreads;
+};
+
+Topology& GetTopology()
+{
+  static Topology topology;
+  return topology;
+}
+
+//! Pin the calling thread to the processors of the given node.
+void PinThread(const size_t node)
+{
+#if defined(__linux__)
+  const std::vector<int>& cpus = GetTopology().nodes[node];
+  if (cpus.empty())
+    return;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t i = 0; i < cpus.size(); ++i)
+    CPU_SET(cpus[i], &set);
+  sched_setaffinity(0, sizeof(set), &set);
+#else
+  (void) node;
+#endif
+}
+
+} // anonymous namespace
+
+bool Numa::Enable()
+{
+  GetTopology().enabled = true;
+  return (Nodes() > 1);
+}
+
+void Numa::Disable()
+{
+  GetTopology().enabled = false;
+}
+
+bool Numa::Enabled()
+{
+  return GetTopology().enabled;
+}
+
+size_t Numa::Nodes()
+{
+  return GetTopology().nodes.size();
+}
+
+size_t Numa::UsedNodes(const size_t threads)
+{
+  return std::max(std::min(Nodes(), threads), (size_t) 1);
+}
+
+size_t Numa::ThreadNode(const size_t thread, const size_t threads)
+{
+  return thread * UsedNodes(threads) / std::max(threads, (size_t) 1);
+}
+
+size_t Numa::NodeBegin(const size_t n, const size_t node, const size_t threads)
+{
+  return n * node / UsedNodes(threads);
+}
+
+void Numa::PinThreads()
+{
+  if (!Enabled() || Nodes() == 1)
+    return;
+
+#ifdef _OPENMP
+  Topology& topology = GetTopology();
+  std::lock_guard<std::mutex> guard(topology.lock);
+
+  const size_t threads = (size_t) omp_get_max_threads();
+  if (topology.pinnedThreads == threads)
+    return;
+
+  #pragma omp parallel num_threads(threads)
+  PinThread(ThreadNode(omp_get_thread_num(), omp_get_num_threads()));
+
+  topology.pinnedThreads = threads;
+#endif
+}
+
+NumaScheduler::NumaScheduler(const size_t n, const size_t chunk) :
+    chunk(std::max(chunk, (size_t) 1)),
+    threads(1)
+{
+#ifdef _OPENMP
+  threads = (size_t) omp_get_max_threads();
+#endif
+
+  // Without the placement, the points are not split.
+  nodes = Numa::Enabled() ? Numa::UsedNodes(threads) : 1;
+
+  ends.resize(nodes);
+  next.reset(new std::atomic<size_t>[nodes]);
+  for (size_t node = 0; node < nodes; ++node)
+  {
+    next[node] = (nodes == 1) ? 0 : Numa::NodeBegin(n, node, threads);
+    ends[node] = (nodes == 1) ? n : Numa::NodeBegin(n, node + 1, threads);
+  }
+}
+
+bool NumaScheduler::Next(size_t& begin, size_t& end)
+{
+  size_t home = 0;
+#ifdef _OPENMP
+  if (nodes > 1)
+  {
+    home = Numa::ThreadNode((size_t) omp_get_thread_num(),
+        (size_t) omp_get_num_threads());
+  }
+#endif
+
+  // Take a block of the home node first, and then help the other nodes.
+  for (size_t i = 0; i < nodes; ++i)
+  {
+    const size_t node = (home + i) % nodes;
+    if (next[node] >= ends[node])
+      continue;
+
+    const size_t first = next[node].fetch_add(chunk);
+    if (first < ends[node])
+    {
+      begin = first;
+      end = std::min(first + chunk, ends[node]);
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file numa.hpp
+ * @author Ryan Curtin
+ *
+ * Placement of matrices and OpenMP threads on the NUMA nodes of the machine,
+ * and a scheduler that hands out blocks of points to the threads of the node
+ * that holds them.
+ */
+#ifndef __MLPACK_CORE_UTIL_NUMA_HPP
+#define __MLPACK_CORE_UTIL_NUMA_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+
+/**
+ * NUMA-aware placement for the parallel searches.  Without it, a matrix lives
+ * on the NUMA node of the thread that first wrote it (usually the thread that
+ * loaded it), so on a machine with several sockets every other socket reads it
+ * remotely, and the memory bandwidth of a single node limits the scaling.
+ *
+ * Once enabled (with the --numa option of the command-line programs, or with
+ * Numa::Enable()), the OpenMP threads are pinned to the nodes in contiguous
+ * blocks (thread t of T runs on node t * N / T, with N the number of nodes
+ * that are used), and Distribute() spreads the columns of a matrix over the
+ * nodes in the same blocks, by having the threads of each node write the
+ * columns of that node into new memory.  The tree-based searches distribute the
+ * datasets they own, and hand out blocks of query points with NumaScheduler,
+ * so that every thread first takes the queries that are stored on its node.
+ *
+ * @code
+ * Numa::Enable();
+ * Numa::Distribute(dataset);
+ *
+ * NumaScheduler scheduler(dataset.n_cols, 64);
+ * #pragma omp parallel
+ * {
+ *   size_t begin, end;
+ *   while (scheduler.Next(begin, end))
+ *     for (size_t i = begin; i < end; ++i)
+ *       Process(dataset.col(i));
+ * }
+ * @endcode
+ *
+ * The nodes and their processors are read from /sys/devices/system/node, so
+ * this only has an effect on Linux; elsewhere (or on a machine with a single
+ * node) there is a single node, nothing is pinned, and Distribute() does
+ * nothing.  The placement relies on the first-touch policy of the kernel,
+ * which is the default.
+ */
+class Numa
+{
+ public:
+  /**
+   * Enable the NUMA-aware placement.  Return whether the machine has more than
+   * one node that this process may run on.
+   */
+  static bool Enable();
+
+  //! Disable the NUMA-aware placement.  Pinned threads stay pinned.
+  static void Disable();
+
+  //! Return whether the NUMA-aware placement is enabled.
+  static bool Enabled();
+
+  //! Return the number of NUMA nodes that this process may run on.
+  static size_t Nodes();
+
+  //! Return the number of nodes that a team of the given number of threads is
+  //! spread over.
+  static size_t UsedNodes(const size_t threads);
+
+  //! Return the node that the given thread of a team is placed on.
+  static size_t ThreadNode(const size_t thread, const size_t threads);
+
+  /**
+   * Return the first column (and, with node + 1, the end) of the block of n
+   * columns that is placed on the given node, for a team of the given number
+   * of threads.
+   */
+  static size_t NodeBegin(const size_t n,
+                          const size_t node,
+                          const size_t threads);
+
+  /**
+   * Pin the threads of the OpenMP team to the processors of their nodes, if the
+   * placement is enabled and they aren't pinned yet.  This runs a parallel
+   * region, so it must not be called from inside one.  OpenMP keeps its
+   * threads between parallel regions of the same size, so they stay pinned.
+   */
+  static void PinThreads();
+
+  /**
+   * Spread the columns of the given matrix over the NUMA nodes, in the blocks
+   * given by NodeBegin().  The matrix gets new memory, so pointers to its
+   * elements become invalid; matrices that don't own their memory (such as
+   * mapped files) are left alone.  This does nothing if the placement is not
+   * enabled or there is only one node.
+   *
+   * @param matrix Matrix to spread over the nodes.
+   */
+  template<typename eT>
+  static void Distribute(arma::Mat<eT>& matrix);
+};
+
+/**
+ * A scheduler for the points of a parallel loop that hands out blocks of a
+ * given size, first from the part of the points that is placed on the node of
+ * the calling thread, and then, once that is done, from the parts of the other
+ * nodes.  With a single node, it is a plain dynamic schedule.  Next() may be
+ * called from any thread of the team that the scheduler was made for.
+ */
+class NumaScheduler
+{
+ public:
+  /**
+   * Create the scheduler for the given number of points, for a team of
+   * omp_get_max_threads() threads.
+   *
+   * @param n Number of points.
+   * @param chunk Number of points in each block.
+   */
+  NumaScheduler(const size_t n, const size_t chunk);
+
+  /**
+   * Get the next block of points for the calling thread.  Return false if
+   * there are no points left.
+   *
+   * @param begin First point of the block.
+   * @param end End of the block (one past the last point).
+   */
+  bool Next(size_t& begin, size_t& end);
+
+ private:
+  //! The number of points in each block.
+  size_t chunk;
+  //! The number of threads of the team.
+  size_t threads;
+  //! The number of nodes that the points are split over.
+  size_t nodes;
+  //! The end of the points of each node.
+  std::vector<size_t> ends;
+  //! The next point of each node that hasn't been handed out.
+  std::unique_ptr<std::atomic<size_t>[]> next;
+};
+
+template<typename eT>
+void Numa::Distribute(arma::Mat<eT>& matrix)
+{
+  if (!Enabled() || Nodes() == 1 || matrix.n_cols < 2 || matrix.mem_state != 0)
+    return;
+
+  PinThreads();
+
+  // The threads of every node write the columns of that node, so the pages
+  // are placed there.
+  arma::Mat<eT> placed;
+  placed.set_size(matrix.n_rows, matrix.n_cols);
+
+  #pragma omp parallel
+  {
+    size_t thread = 0;
+    size_t threads = 1;
+#ifdef _OPENMP
+    thread = (size_t) omp_get_thread_num();
+    threads = (size_t) omp_get_num_threads();
+#endif
+
+    // Split the block of the node between its threads.
+    const size_t node = ThreadNode(thread, threads);
+    const size_t nodes = UsedNodes(threads);
+    const size_t firstThread = (node * threads + nodes - 1) / nodes;
+    const size_t nodeThreads = ((node + 1) * threads + nodes - 1) / nodes -
+        firstThread;
+    const size_t nodeBegin = NodeBegin(matrix.n_cols, node, threads);
+    const size_t nodeEnd = NodeBegin(matrix.n_cols, node + 1, threads);
+    const size_t begin = nodeBegin + (nodeEnd - nodeBegin) *
+        (thread - firstThread) / nodeThreads;
+    const size_t end = nodeBegin + (nodeEnd - nodeBegin) *
+        (thread - firstThread + 1) / nodeThreads;
+
+    if (end > begin)
+    {
+      std::memcpy(placed.colptr(begin), matrix.colptr(begin),
+          sizeof(eT) * matrix.n_rows * (end - begin));
+    }
+  }
+
+  matrix.steal_mem(placed);
+}
+
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,340 @@
+/**
+ * @file perf_counters.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the hardware performance counters.
+ */
+#include "perf_counters.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #include <cstring>
+#endif
+
+using namespace mlpack;
+
+PerfCounterValues::PerfCounterValues()
+{
+  for (size_t i = 0; i < EVENTS; ++i)
+  {
+    counts[i] = 0;
+    available[i] = false;
+  }
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(
+    const PerfCounterValues& other)
+{
+  for (size_t i = 0; i < EVENTS; ++i)
+  {
+    counts[i] += other.counts[i];
+    available[i] = available[i] || other.available[i];
+  }
+
+  return *this;
+}
+
+PerfCounterValues& PerfCounterValues::operator-=(
+    const PerfCounterValues& other)
+{
+  for (size_t i = 0; i < EVENTS; ++i)
+  {
+    counts[i] -= other.counts[i];
+    available[i] = available[i] || other.available[i];
+  }
+
+  return *this;
+}
+
+bool PerfCounterValues::Available() const
+{
+  for (size_t i = 0; i < EVENTS; ++i)
+    if (available[i])
+      return true;
+
+  return false;
+}
+
+std::string PerfCounterValues::ToString() const
+{
+  static const char* names[EVENTS] = { "cycles", "instructions",
+      "cache misses", "branch misses" };
+
+  std::ostringstream result;
+  bool first = true;
+  for (size_t i = 0; i < EVENTS; ++i)
+  {
+    if (!available[i])
+      continue;
+
+    if (!first)
+      result << ", ";
+    result << names[i] << ": " << counts[i];
+    first = false;
+
+    // The instructions per cycle tell how well the pipeline is used.
+    if (i == INSTRUCTIONS && available[CYCLES] && counts[CYCLES] > 0)
+    {
+      std::ostringstream ipc;
+      ipc.setf(std::ios::fixed);
+      ipc.precision(2);
+      ipc << (double) counts[INSTRUCTIONS] / counts[CYCLES];
+      result << " (IPC " << ipc.str() << ")";
+    }
+  }
+
+  return result.str();
+}
+
+namespace {
+
+struct ThreadCounters;
+
+/**
+ * Whether counting is enabled, the counters of all running threads, and the
+ * totals of the threads that exited.
+ */
+struct Registry
+{
+  Registry() : enabled(false), threadCount(0) { }
+
+  std::atomic<bool> enabled;
+  std::mutex lock;
+  size_t threadCount;
+  std::vector<ThreadCounters*> threads;
+  std::vector<PerfThreadRecord> exited;
+};
+
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+/**
+ * The group of counters of a single thread.  The first event that can be
+ * opened leads the group, so all events are read with one system call.
+ */
+struct ThreadCounters
+{
+  ThreadCounters() : leader(-1), members(0), opened(false), thread(0)
+  {
+    for (size_t i = 0; i < PerfCounterValues::EVENTS; ++i)
+      position[i] = -1;
+  }
+
+  ~ThreadCounters()
+  {
+    if (leader == -1)
+      return;
+
+    Registry& registry = GetRegistry();
+    {
+      std::lock_guard<std::mutex> guard(registry.lock);
+
+      PerfThreadRecord record;
+      record.thread = thread;
+      record.exited = true;
+      Read(record.values);
+      registry.exited.push_back(record);
+
+      registry.threads.erase(std::remove(registry.threads.begin(),
+          registry.threads.end(), this), registry.threads.end());
+    }
+
+    Close();
+  }
+
+  //! Open the counters, the first time this is called.
+  bool Open()
+  {
+    if (opened)
+      return (leader != -1);
+    opened = true;
+
+#if defined(__linux__)
+    static const uint64_t configs[PerfCounterValues::EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+    for (size_t i = 0; i < PerfCounterValues::EVENTS; ++i)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[i];
+      attr.disabled = (leader == -1) ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+          PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // Count the calling thread on any processor.
+      const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+      if (fd == -1)
+        continue;
+
+      if (leader == -1)
+        leader = fd;
+      fds.push_back(fd);
+      position[i] = members++;
+    }
+
+    if (leader == -1)
+      return false;
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    thread = registry.threadCount++;
+    registry.threads.push_back(this);
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  //! Read the counters.  This may be called from any thread.
+  bool Read(PerfCounterValues& values) const
+  {
+    values = PerfCounterValues();
+    if (leader == -1)
+      return false;
+
+#if defined(__linux__)
+    // The group is read as the number of events, the times the group was
+    // enabled and running, and the counts.
+    uint64_t buffer[3 + PerfCounterValues::EVENTS];
+    const ssize_t bytes = read(leader, buffer, sizeof(buffer));
+    if (bytes < (ssize_t) ((3 + members) * sizeof(uint64_t)))
+      return false;
+
+    // If the processor had to share its counters with other groups, the
+    // counts are extrapolated over the time the group was enabled.
+    const double scale = (buffer[2] > 0 && buffer[2] < buffer[1]) ?
+        (double) buffer[1] / buffer[2] : 1.0;
+    for (size_t i = 0; i < PerfCounterValues::EVENTS; ++i)
+    {
+      if (position[i] == -1)
+        continue;
+
+      values.counts[i] = (uint64_t) (buffer[3 + position[i]] * scale);
+      values.available[i] = true;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  //! Close the counters.
+  void Close()
+  {
+#if defined(__linux__)
+    // The leader is closed last.
+    for (size_t i = fds.size(); i > 0; --i)
+      close(fds[i - 1]);
+#endif
+    fds.clear();
+    leader = -1;
+  }
+
+  int leader;
+  std::vector<int> fds;
+  int position[PerfCounterValues::EVENTS];
+  int members;
+  bool opened;
+  size_t thread;
+};
+
+ThreadCounters& GetThreadCounters()
+{
+  static thread_local ThreadCounters counters;
+  return counters;
+}
+
+bool ThreadOrder(const PerfThreadRecord& a, const PerfThreadRecord& b)
+{
+  return a.thread < b.thread;
+}
+
+} // anonymous namespace
+
+bool PerfCounters::Enable()
+{
+  GetRegistry().enabled = true;
+  return GetThreadCounters().Open();
+}
+
+void PerfCounters::Disable()
+{
+  GetRegistry().enabled = false;
+}
+
+bool PerfCounters::Enabled()
+{
+  return GetRegistry().enabled;
+}
+
+bool PerfCounters::Read(PerfCounterValues& values)
+{
+  if (!GetRegistry().enabled)
+    return false;
+
+  ThreadCounters& counters = GetThreadCounters();
+  if (!counters.Open())
+    return false;
+
+  return counters.Read(values);
+}
+
+void PerfCounters::Report(std::vector<PerfThreadRecord>& records)
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+
+  records = registry.exited;
+  for (size_t i = 0; i < registry.threads.size(); ++i)
+  {
+    PerfThreadRecord record;
+    record.thread = registry.threads[i]->thread;
+    record.exited = false;
+    registry.threads[i]->Read(record.values);
+    records.push_back(record);
+  }
+
+  std::sort(records.begin(), records.end(), ThreadOrder);
+}
+
+void PerfCounters::Print()
+{
+  std::vector<PerfThreadRecord> records;
+  Report(records);
+  if (records.empty())
+    return;
+
+  Log::Info << "Hardware counters:" << std::endl;
+  PerfCounterValues total;
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    Log::Info << "  thread " << records[i].thread << ": "
+        << records[i].values.ToString() << std::endl;
+    total += records[i].values;
+  }
+
+  if (records.size() > 1)
+    Log::Info << "  total: " << total.ToString() << std::endl;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file perf_counters.hpp
+ * @author Ryan Curtin
+ *
+ * Hardware performance counters (cycles, instructions, cache misses and branch
+ * mispredictions) for the timers, using perf_event on Linux.
+ */
+#ifndef __MLPACK_CORE_UTIL_PERF_COUNTERS_HPP
+#define __MLPACK_CORE_UTIL_PERF_COUNTERS_HPP
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace mlpack {
+
+/**
+ * The values of the hardware counters.  An event is only available if the
+ * kernel and the processor could count it; the counts of the other events are
+ * zero.
+ */
+struct PerfCounterValues
+{
+  //! The events that are counted.
+  enum Event
+  {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    EVENTS
+  };
+
+  //! Create values with no available events.
+  PerfCounterValues();
+
+  //! Add the given values; an event is available if it is in either.
+  PerfCounterValues& operator+=(const PerfCounterValues& other);
+  //! Subtract the given values (modulo 2^64, like the counters themselves).
+  PerfCounterValues& operator-=(const PerfCounterValues& other);
+
+  //! Whether any event is available.
+  bool Available() const;
+
+  //! Format the available events, like "cycles: 1200, instructions: 1500
+  //! (IPC 1.25), cache misses: 3, branch misses: 7".
+  std::string ToString() const;
+
+  //! The count of every event.
+  uint64_t counts[EVENTS];
+  //! Whether every event could be counted.
+  bool available[EVENTS];
+};
+
+/**
+ * The total hardware counters of a thread, as given by PerfCounters::Report().
+ */
+struct PerfThreadRecord
+{
+  //! The number of the thread, in the order the threads first read counters.
+  size_t thread;
+  //! Whether the thread has exited.
+  bool exited;
+  //! The events counted on the thread since it first read counters.
+  PerfCounterValues values;
+};
+
+/**
+ * Hardware performance counters, read with the perf_event interface of Linux.
+ * Once counting is enabled, every thread opens its own group of counters the
+ * first time it reads them, and the counters keep running until the thread
+ * exits.  Timer::Start() and Timer::Stop() then also count the events of the
+ * thread that calls them between the two calls, and with --verbose the counts
+ * are printed next to the timers, followed by the totals of every thread.
+ * Only the events of user space are counted.
+ *
+ * Counting is enabled with the --perf_counters option of the command-line
+ * programs, or directly:
+ *
+ * @code
+ * PerfCounters::Enable();
+ * Timer::Start("search");
+ * ...
+ * Timer::Stop("search");
+ * Log::Info << Timer::GetCounters("search").ToString() << std::endl;
+ * @endcode
+ *
+ * On other systems, or if the kernel doesn't allow the counters to be opened
+ * (see /proc/sys/kernel/perf_event_paranoid), no events are available.
+ */
+class PerfCounters
+{
+ public:
+  /**
+   * Enable counting, and open the counters of the calling thread.  Return
+   * whether any event can be counted on the calling thread.
+   */
+  static bool Enable();
+
+  /**
+   * Disable counting.  The counters that are open keep running, but they are
+   * not read anymore.
+   */
+  static void Disable();
+
+  //! Return whether counting is enabled.
+  static bool Enabled();
+
+  /**
+   * Read the events counted on the calling thread since it first read
+   * counters.  Return false if counting is disabled or no event is available.
+   *
+   * @param values Values to store the counts in.
+   */
+  static bool Read(PerfCounterValues& values);
+
+  /**
+   * Get the events counted on every thread that read counters, in the order
+   * the threads first read them.
+   *
+   * @param records Vector to store the totals of every thread in.
+   */
+  static void Report(std::vector<PerfThreadRecord>& records);
+
+  /**
+   * Print the events counted on every thread, and their sum, to Log::Info.
+   */
+  static void Print();
+};
+
+}; // namespace mlpack
+
+#endif
@@ -5,6 +5,9 @@
  *
  * Implementation of PrefixedOutStream methods.
  */
+#include <atomic>
+#include <map>
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <streambuf>
@@ -125,3 +128,43 @@ PrefixedOutStream& PrefixedOutStream::operator<<(
   BaseLogic<std::ios_base& (*)(std::ios_base&)>(pf);
   return *this;
 }
+
+PrefixedOutStream::LineBuffer::~LineBuffer()
+{
+  std::string text = stream.str();
+  if (destination != NULL && text.length() > 0)
+    LogSink::Write(*destination, text);
+}
+
+PrefixedOutStream::LineBuffer& PrefixedOutStream::ThreadLineBuffer()
+{
+  // The line buffers of the calling thread, by the identifiers of the streams.
+  static thread_local std::map<size_t, LineBuffer> buffers;
+
+  LineBuffer& buffer = buffers[id];
+  buffer.destination = &destination;
+  return buffer;
+}
+
+void PrefixedOutStream::WriteLines(LineBuffer& buffer)
+{
+  std::string text = buffer.stream.str();
+  buffer.stream.str("");
+  LogSink::Write(destination, text);
+}
+
+size_t PrefixedOutStream::NextId()
+{
+  static std::atomic<size_t> nextId(0);
+  return nextId++;
+}
+
+void PrefixedOutStream::ThrowFatal(std::string& text)
+{
+  std::string message;
+  message.swap(text);
+  if (message.length() > 0 && message[message.length() - 1] == '\n')
+    message.erase(message.length() - 1);
+
+  throw std::runtime_error(message);
+}
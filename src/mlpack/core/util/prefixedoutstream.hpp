@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <string>
 #include <streambuf>
 
@@ -19,6 +20,11 @@
 
 #include <mlpack/core/util/sfinae_utility.hpp>
 #include <mlpack/core/util/string_util.hpp>
+#include <mlpack/core/util/log_sink.hpp>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace util {
@@ -47,6 +53,12 @@ namespace util {
  *
  * These objects are used for the mlpack::Log levels (DEBUG, INFO, WARN, and
  * FATAL).
+ *
+ * Output to a stream that ignores its input is not formatted at all.  Inside
+ * an OpenMP parallel region, or when the asynchronous LogSink is running, the
+ * output of every thread is collected in a line buffer of that thread, and
+ * only complete lines are written (through the LogSink), so that the lines of
+ * different threads don't interleave.
  */
 class PrefixedOutStream
 {
@@ -58,7 +70,8 @@ class PrefixedOutStream
    * @param prefix The prefix to prepend to each line.
    * @param ignoreInput If true, the stream will not be printed.
    * @param fatal If true, a std::runtime_error exception is thrown after
-   *     printing a newline.
+   *     printing a newline; its message is the text of the printed lines,
+   *     without the prefix.
    */
   PrefixedOutStream(std::ostream& destination,
                     const char* prefix,
@@ -70,7 +83,8 @@ class PrefixedOutStream
       // We want the first call to operator<< to prefix the prefix so we set
       // carriageReturned to true.
       carriageReturned(true),
-      fatal(fatal)
+      fatal(fatal),
+      id(NextId())
     { /* nothing to do */ }
 
   //! Write a bool to the stream.
@@ -164,6 +178,61 @@ class PrefixedOutStream
    */
   inline void PrefixIfNeeded();
 
+  /**
+   * The partial line of a single thread, when the output is buffered per
+   * thread.
+   */
+  struct LineBuffer
+  {
+    LineBuffer() : carriageReturned(true), destination(NULL) { }
+
+    //! Write what is left when the thread exits.
+    ~LineBuffer();
+
+    //! The partial line, with the format of the stream.
+    std::ostringstream stream;
+    //! If true, the next output starts a new line.
+    bool carriageReturned;
+    //! The destination of the line.
+    std::ostream* destination;
+    //! The text of a fatal message so far, without the prefix.
+    std::string fatalText;
+  };
+
+  //! Return whether or not the output has to be buffered per thread.
+  static bool Buffered()
+  {
+#ifdef _OPENMP
+    return LogSink::Running() || omp_in_parallel();
+#else
+    return LogSink::Running();
+#endif
+  }
+
+  //! Return the line buffer of this stream for the calling thread.
+  LineBuffer& ThreadLineBuffer();
+
+  //! Write the complete lines in the given buffer through the LogSink.
+  void WriteLines(LineBuffer& buffer);
+
+  /**
+   * Conducts the logic of BaseLogic() when the output is buffered per thread.
+   *
+   * @tparam T The type of the data to output.
+   * @param val The The data to be output.
+   */
+  template<typename T>
+  void BufferedLogic(const T& val);
+
+  //! Return a new identifier for a stream.
+  static size_t NextId();
+
+  /**
+   * Throw the std::runtime_error of a fatal stream, with the given text (minus
+   * its final newline) as message.  The text is emptied.
+   */
+  static void ThrowFatal(std::string& text);
+
   //! Contains the prefix we must prepend to each line.
   std::string prefix;
 
@@ -174,6 +243,13 @@ class PrefixedOutStream
   //! If true, a std::runtime_error exception will be thrown when a CR is
   //! encountered.
   bool fatal;
+
+  //! The text of a fatal message so far, without the prefix, when the output
+  //! is not buffered.
+  std::string fatalText;
+
+  //! The identifier of the stream, which finds the line buffers of the threads.
+  size_t id;
 };
 
 }; // namespace util
@@ -62,6 +62,20 @@ void PrefixedOutStream::CallBaseLogic(const T& s,
 template<typename T>
 void PrefixedOutStream::BaseLogic(const T& val)
 {
+  // Nothing will be shown, so there is no need to format anything.  The next
+  // output that is shown starts on a new line.
+  if (ignoreInput)
+  {
+    carriageReturned = true;
+    return;
+  }
+
+  if (Buffered())
+  {
+    BufferedLogic<T>(val);
+    return;
+  }
+
   // We will use this to track whether or not we need to terminate at the end of
   // this call (only for streams which terminate after a newline).
   bool newlined = false;
@@ -115,6 +129,9 @@ void PrefixedOutStream::BaseLogic(const T& val)
         newlined = true;
       }
 
+      if (fatal)
+        fatalText += line.substr(pos, nl - pos + 1);
+
       carriageReturned = true; // Regardless of whether or not we display it.
 
       pos = nl + 1;
@@ -125,12 +142,81 @@ void PrefixedOutStream::BaseLogic(const T& val)
       PrefixIfNeeded();
       if (!ignoreInput)
         destination << line.substr(pos);
+
+      if (fatal)
+        fatalText += line.substr(pos);
     }
   }
 
   // If we displayed a newline and we need to throw afterwards, do that.
   if (fatal && newlined)
-    throw std::runtime_error("fatal error; see Log::Fatal output");
+    ThrowFatal(fatalText);
+}
+
+template<typename T>
+void PrefixedOutStream::BufferedLogic(const T& val)
+{
+  LineBuffer& buffer = ThreadLineBuffer();
+
+  std::ostringstream convert;
+  convert << val;
+
+  std::string line;
+  if (convert.fail())
+  {
+    line = "Failed lexical_cast<std::string>(T) for output; output not "
+        "shown.\n";
+  }
+  else
+  {
+    line = convert.str();
+
+    // A stream manipulator changes the format of the line buffer.
+    if (line.length() == 0)
+    {
+      buffer.stream << val;
+      return;
+    }
+  }
+
+  // Add the complete lines to the buffer, and write them.
+  bool newlined = false;
+  size_t nl;
+  size_t pos = 0;
+  while ((nl = line.find('\n', pos)) != std::string::npos)
+  {
+    if (buffer.carriageReturned)
+      buffer.stream << prefix;
+
+    buffer.stream << line.substr(pos, nl - pos) << '\n';
+    buffer.carriageReturned = true;
+    if (fatal)
+      buffer.fatalText += line.substr(pos, nl - pos + 1);
+    newlined = true;
+    pos = nl + 1;
+  }
+
+  if (newlined)
+    WriteLines(buffer);
+
+  // Keep the rest until its line is complete.
+  if (pos != line.length())
+  {
+    if (buffer.carriageReturned)
+      buffer.stream << prefix;
+
+    buffer.stream << line.substr(pos);
+    buffer.carriageReturned = false;
+    if (fatal)
+      buffer.fatalText += line.substr(pos);
+  }
+
+  // The fatal message has to be shown before we throw.
+  if (fatal && newlined)
+  {
+    LogSink::Flush();
+    ThrowFatal(buffer.fatalText);
+  }
 }
 
 // This is an inline function (that is why it is here and not in .cc).
@@ -0,0 +1,109 @@
+/**
+ * @file query_server.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the parsing of the requests of a QueryServer.
+ */
+#include "query_server.hpp"
+
+#include <cstdlib>
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+bool QueryRequest::Read(const std::vector<std::string>& header,
+                        std::istream& input,
+                        std::string& error)
+{
+  if (header.empty())
+  {
+    error = "the number of points of the query is missing";
+    return false;
+  }
+
+  char* end;
+  const long numPoints = strtol(header[0].c_str(), &end, 10);
+  if (*end != '\0' || numPoints <= 0)
+  {
+    error = "invalid number of points '" + header[0] + "'";
+    return false;
+  }
+
+  // Read all the lines of the request before anything else is checked, so that
+  // the input stays in sync with the requests.
+  std::vector<std::string> lines(numPoints);
+  for (long i = 0; i < numPoints; ++i)
+  {
+    if (!std::getline(input, lines[i]))
+    {
+      error = "the input ended in the middle of the query";
+      return false;
+    }
+  }
+
+  options.clear();
+  for (size_t i = 1; i < header.size(); ++i)
+  {
+    const size_t equals = header[i].find('=');
+    if (equals == std::string::npos || equals == 0)
+    {
+      error = "invalid option '" + header[i] + "' (expected name=value)";
+      return false;
+    }
+
+    options[header[i].substr(0, equals)] = header[i].substr(equals + 1);
+  }
+
+  // Every line is one point; the first one gives the dimensionality.
+  std::vector<double> values;
+  size_t dimensionality = 0;
+  for (long i = 0; i < numPoints; ++i)
+  {
+    const char* position = lines[i].c_str();
+    size_t pointValues = 0;
+    while (true)
+    {
+      // Skip the separators.
+      while (*position == ',' || *position == ' ' || *position == '\t' ||
+          *position == '\r')
+        ++position;
+      if (*position == '\0')
+        break;
+
+      const double value = strtod(position, &end);
+      if (end == position)
+      {
+        std::ostringstream message;
+        message << "invalid value in point " << i << ": '" << position << "'";
+        error = message.str();
+        return false;
+      }
+
+      values.push_back(value);
+      ++pointValues;
+      position = end;
+    }
+
+    if (i == 0)
+      dimensionality = pointValues;
+
+    if (pointValues == 0)
+    {
+      std::ostringstream message;
+      message << "point " << i << " has no values";
+      error = message.str();
+      return false;
+    }
+    else if (pointValues != dimensionality)
+    {
+      std::ostringstream message;
+      message << "point " << i << " has " << pointValues << " values, but "
+          << "point 0 has " << dimensionality;
+      error = message.str();
+      return false;
+    }
+  }
+
+  points = arma::mat(&values[0], dimensionality, numPoints);
+  return true;
+}
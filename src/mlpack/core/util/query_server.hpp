@@ -0,0 +1,195 @@
+/**
+ * @file query_server.hpp
+ * @author Ryan Curtin
+ *
+ * A server that answers batches of queries against a model or index that is
+ * built only once, for programs that would otherwise rebuild it every run.
+ */
+#ifndef __MLPACK_CORE_UTIL_QUERY_SERVER_HPP
+#define __MLPACK_CORE_UTIL_QUERY_SERVER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * A batch of query points read by a QueryServer, with the options given on the
+ * request line.  The points are the columns of Points(), like the datasets
+ * loaded by data::Load().
+ */
+class QueryRequest
+{
+ public:
+  /**
+   * Read a request from its header (the tokens of the request line, without
+   * the command) and the lines of points that follow it.  All the lines of the
+   * request are consumed, even if the request is invalid, so the next request
+   * can be read anyway.
+   *
+   * @param header Tokens of the request line after the command: the number of
+   *     points, then options as name=value.
+   * @param input Stream to read the points from.
+   * @param error Set to a description of what is wrong with the request.
+   * @return Whether or not the request is valid.
+   */
+  bool Read(const std::vector<std::string>& header,
+            std::istream& input,
+            std::string& error);
+
+  //! Get the query points.
+  const arma::mat& Points() const { return points; }
+  //! Modify the query points.
+  arma::mat& Points() { return points; }
+
+  //! Return whether or not the given option was given.
+  bool HasOption(const std::string& name) const
+  { return options.count(name) > 0; }
+
+  /**
+   * Get the value of the given option, or the default value if it wasn't
+   * given.  Log::Fatal is used if the value can't be converted (the server
+   * reports that as an error of the request).
+   */
+  template<typename T>
+  T Option(const std::string& name, const T& defaultValue) const;
+
+ private:
+  //! The query points.
+  arma::mat points;
+  //! The options of the request.
+  std::map<std::string, std::string> options;
+};
+
+/**
+ * The results of a request, which consist of any number of matrices.  Like the
+ * query points, every column of a result is one line of the response.
+ */
+class QueryResponse
+{
+ public:
+  QueryResponse() : results(0) { }
+
+  //! Add a matrix to the results.
+  template<typename eT>
+  void Add(const arma::Mat<eT>& result);
+
+  //! Get the number of matrices in the results.
+  size_t Results() const { return results; }
+
+  //! Get the formatted results.
+  std::string Body() const { return body.str(); }
+
+ private:
+  //! The number of matrices added so far.
+  size_t results;
+  //! The formatted matrices.
+  std::ostringstream body;
+};
+
+/**
+ * A server that answers requests read from an input stream (for instance the
+ * standard input, or a named pipe) until the input ends or a "quit" request is
+ * read.  This is used by programs whose model or index takes much longer to
+ * build than to query: with --server, they build it once and then answer query
+ * batches at the cost of the queries alone.
+ *
+ * The protocol is line-based text.  Every request starts with a line holding a
+ * command:
+ *
+ *  - "query <points> [name=value ...]": the next <points> lines hold one query
+ *    point each, as comma-separated (or space-separated) values.  The options
+ *    are specific to the program (for instance k=5).
+ *  - "ping": check that the server is alive.
+ *  - "quit": stop the server.
+ *
+ * Empty lines and lines that start with '#' are ignored between requests.
+ * Every request is answered, in order, with either
+ *
+ *  - "ok <results>", followed for every result matrix by a line
+ *    "<lines> <values>" and that many lines of comma-separated values, or
+ *  - "error <message>".
+ *
+ * The output is flushed after every response.  An invalid request or a
+ * failure of the handler (including Log::Fatal, whose message is reported) is
+ * answered with an error, and the server keeps running.
+ *
+ * The handler has to provide the following method, which answers a single
+ * query request:
+ *
+ * @code
+ * void Query(const QueryRequest& request, QueryResponse& response);
+ * @endcode
+ *
+ * @tparam HandlerType Type of the object that answers the queries.
+ */
+template<typename HandlerType>
+class QueryServer
+{
+ public:
+  /**
+   * Create the server.  Nothing is read until Serve() is called.
+   *
+   * @param handler Object that answers the queries.
+   * @param input Stream to read requests from.
+   * @param output Stream to write responses to.
+   */
+  QueryServer(HandlerType& handler, std::istream& input, std::ostream& output);
+
+  /**
+   * Answer requests until the input ends or a "quit" request is read.
+   *
+   * @return The number of requests answered (including failed ones).
+   */
+  size_t Serve();
+
+ private:
+  /**
+   * Answer the request that starts with the given line.
+   *
+   * @return Whether or not the server should keep running.
+   */
+  bool Answer(const std::string& line);
+
+  //! Write an error response.
+  void Error(const std::string& message);
+
+  //! The object that answers the queries.
+  HandlerType& handler;
+  //! The stream requests are read from.
+  std::istream& input;
+  //! The stream responses are written to.
+  std::ostream& output;
+};
+
+/**
+ * Run a QueryServer with the given handler.  The requests are read from the
+ * given file (which may be a named pipe), or from the standard input if the
+ * name is empty, and the responses are written to the given file, or to the
+ * standard output if that name is empty.  In that case, the log output that
+ * would go to the standard output is written to the standard error while the
+ * server runs.
+ *
+ * @param handler Object that answers the queries.
+ * @param inputFile File to read requests from ("" for the standard input).
+ * @param outputFile File to write responses to ("" for the standard output).
+ * @return The number of requests answered.
+ */
+template<typename HandlerType>
+size_t ServeQueries(HandlerType& handler,
+                    const std::string& inputFile,
+                    const std::string& outputFile);
+
+}; // namespace util
+}; // namespace mlpack
+
+// Include implementation.
+#include "query_server_impl.hpp"
+
+#endif
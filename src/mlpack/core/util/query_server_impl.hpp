@@ -0,0 +1,216 @@
+/**
+ * @file query_server_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the templated parts of the QueryServer.
+ */
+#ifndef __MLPACK_CORE_UTIL_QUERY_SERVER_IMPL_HPP
+#define __MLPACK_CORE_UTIL_QUERY_SERVER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "query_server.hpp"
+
+#include <mlpack/core/util/log.hpp>
+#include <mlpack/core/util/log_sink.hpp>
+#include <mlpack/core/util/timers.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+namespace mlpack {
+namespace util {
+
+template<typename T>
+T QueryRequest::Option(const std::string& name, const T& defaultValue) const
+{
+  std::map<std::string, std::string>::const_iterator it = options.find(name);
+  if (it == options.end())
+    return defaultValue;
+
+  std::istringstream stream(it->second);
+  T value;
+  if (!(stream >> value) || !(stream >> std::ws).eof())
+  {
+    Log::Fatal << "Invalid value '" << it->second << "' for option '" << name
+        << "'." << std::endl;
+  }
+
+  return value;
+}
+
+template<typename eT>
+void QueryResponse::Add(const arma::Mat<eT>& result)
+{
+  body << result.n_cols << " " << result.n_rows << "\n";
+  body << std::setprecision(std::numeric_limits<eT>::digits10 + 2);
+  for (size_t i = 0; i < result.n_cols; ++i)
+  {
+    for (size_t j = 0; j < result.n_rows; ++j)
+      body << ((j == 0) ? "" : ",") << result(j, i);
+    body << "\n";
+  }
+
+  ++results;
+}
+
+template<typename HandlerType>
+QueryServer<HandlerType>::QueryServer(HandlerType& handler,
+                                      std::istream& input,
+                                      std::ostream& output) :
+    handler(handler),
+    input(input),
+    output(output)
+{
+  // Nothing to do.
+}
+
+template<typename HandlerType>
+size_t QueryServer<HandlerType>::Serve()
+{
+  size_t requests = 0;
+  std::string line;
+  while (std::getline(input, line))
+  {
+    // Skip empty lines and comments.
+    const size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#')
+      continue;
+
+    ++requests;
+    if (!Answer(line))
+      break;
+  }
+
+  return requests;
+}
+
+template<typename HandlerType>
+bool QueryServer<HandlerType>::Answer(const std::string& line)
+{
+  std::istringstream lineStream(line);
+  std::string command;
+  lineStream >> command;
+
+  std::vector<std::string> header;
+  std::string token;
+  while (lineStream >> token)
+    header.push_back(token);
+
+  if (command == "quit" || command == "ping")
+  {
+    output << "ok 0" << std::endl;
+    return (command == "ping");
+  }
+  else if (command != "query")
+  {
+    Error("unknown command '" + command + "'");
+    return true;
+  }
+
+  QueryRequest request;
+  std::string error;
+  if (!request.Read(header, input, error))
+  {
+    Error(error);
+    return true;
+  }
+
+  // Failures of the handler are reported to the client.  The exception thrown
+  // by Log::Fatal holds its message.
+  QueryResponse response;
+  bool failed = false;
+  std::string message;
+  Timer::Start("serving_queries");
+  try
+  {
+    handler.Query(request, response);
+  }
+  catch (std::exception& e)
+  {
+    failed = true;
+    message = e.what();
+  }
+  Timer::Stop("serving_queries");
+
+  if (failed)
+  {
+    Error(message);
+    return true;
+  }
+
+  output << "ok " << response.Results() << "\n" << response.Body()
+      << std::flush;
+  return true;
+}
+
+template<typename HandlerType>
+void QueryServer<HandlerType>::Error(const std::string& message)
+{
+  // The response has to fit on one line.
+  std::string singleLine(message);
+  for (size_t i = 0; i < singleLine.size(); ++i)
+    if (singleLine[i] == '\n' || singleLine[i] == '\r')
+      singleLine[i] = ' ';
+
+  output << "error " << singleLine << std::endl;
+}
+
+template<typename HandlerType>
+size_t ServeQueries(HandlerType& handler,
+                    const std::string& inputFile,
+                    const std::string& outputFile)
+{
+  std::ifstream inputStream;
+  if (inputFile != "")
+  {
+    inputStream.open(inputFile.c_str());
+    if (!inputStream.is_open())
+    {
+      Log::Fatal << "Cannot open '" << inputFile << "' to read requests from."
+          << std::endl;
+    }
+  }
+
+  std::ofstream outputStream;
+  if (outputFile != "")
+  {
+    outputStream.open(outputFile.c_str());
+    if (!outputStream.is_open())
+    {
+      Log::Fatal << "Cannot open '" << outputFile << "' to write responses "
+          << "to." << std::endl;
+    }
+  }
+
+  Log::Info << "Serving queries from "
+      << ((inputFile == "") ? "standard input" : "'" + inputFile + "'")
+      << "." << std::endl;
+
+  // If the responses are written to the standard output, everything else that
+  // is written there (the log) goes to the standard error while the server
+  // runs, so that it can't be mistaken for responses.
+  LogSink::Flush();
+  std::ostream standardOutput(std::cout.rdbuf());
+  std::streambuf* outputBuffer = NULL;
+  if (outputFile == "")
+    outputBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+  QueryServer<HandlerType> server(handler,
+      (inputFile == "") ? std::cin : inputStream,
+      (outputFile == "") ? standardOutput : outputStream);
+  const size_t requests = server.Serve();
+
+  LogSink::Flush();
+  if (outputBuffer)
+    std::cout.rdbuf(outputBuffer);
+
+  Log::Info << "Answered " << requests << " requests." << std::endl;
+  return requests;
+}
+
+}; // namespace util
+}; // namespace mlpack
+
+#endif
@@ -4,15 +4,164 @@
  * @author Michael Fox
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  The output file type is XML, or a binary format for
+ *   files ending in ".bin".
  */
 #include <mlpack/core.hpp>
 
+#include <fstream>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::util;
 
-bool SaveRestoreUtility::ReadFile(const std::string& filename)
+namespace {
+
+// The binary format starts with this magic string and a version number.  The
+// file is written in the byte order of the machine, so a second number tells
+// whether the file can be read.
+const char BinaryMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'S', 'R' };
+const uint32_t BinaryVersion = 1;
+const uint32_t BinaryByteOrder = 0x01020304;
+
+// The elements of every matrix start at a multiple of this offset in the file.
+const size_t BinaryAlignment = 8;
+
+void WriteSize(std::ostream& stream, const uint64_t size)
+{
+  stream.write((const char*) &size, sizeof(uint64_t));
+}
+
+void WriteString(std::ostream& stream, const std::string& str)
+{
+  WriteSize(stream, str.size());
+  stream.write(str.data(), str.size());
+}
+
+void ReadBytes(const char*& position,
+               const char* end,
+               void* destination,
+               const size_t size)
+{
+  if ((size_t) (end - position) < size)
+    Log::Fatal << "SaveRestoreUtility::ReadFile(): binary file is truncated!"
+        << std::endl;
+
+  memcpy(destination, position, size);
+  position += size;
+}
+
+uint64_t ReadSize(const char*& position, const char* end)
+{
+  uint64_t size;
+  ReadBytes(position, end, &size, sizeof(uint64_t));
+  return size;
+}
+
+std::string ReadString(const char*& position, const char* end)
 {
+  const uint64_t size = ReadSize(position, end);
+  if ((uint64_t) (end - position) < size)
+    Log::Fatal << "SaveRestoreUtility::ReadFile(): binary file is truncated!"
+        << std::endl;
+
+  std::string str(position, size);
+  position += size;
+  return str;
+}
+
+// Unmap the mapping of a binary file, when the last matrix that uses it is
+// gone.
+#ifndef _WIN32
+class Unmapper
+{
+ public:
+  Unmapper(const size_t size) : size(size) { }
+
+  void operator()(void* mapped) const { munmap(mapped, size); }
+
+ private:
+  size_t size;
+};
+#endif
+
+} // anonymous namespace
+
+bool SaveRestoreUtility::ReadFile(const std::string& filename,
+                                  const bool mapMatrices)
+{
+  // Binary files are recognized by their magic string.
+  char magic[sizeof(BinaryMagic)];
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (file.is_open() && file.read(magic, sizeof(magic)) &&
+      memcmp(magic, BinaryMagic, sizeof(magic)) == 0)
+  {
+    // Get the contents of the file into memory; map it, if asked to.
+    boost::shared_ptr<void> owner;
+    const char* contents = NULL;
+    size_t size = 0;
+#ifndef _WIN32
+    if (mapMatrices)
+    {
+      const int fd = open(filename.c_str(), O_RDONLY);
+      struct stat fileStat;
+      if (fd >= 0 && fstat(fd, &fileStat) == 0)
+      {
+        size = (size_t) fileStat.st_size;
+        void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+          owner = boost::shared_ptr<void>(mapped, Unmapper(size));
+          contents = (const char*) mapped;
+        }
+      }
+      if (fd >= 0)
+        close(fd);
+    }
+#else
+    (void) mapMatrices;
+#endif
+
+    if (contents == NULL)
+    {
+      file.seekg(0, std::ios::end);
+      size = (size_t) file.tellg();
+      file.seekg(0, std::ios::beg);
+
+      boost::shared_ptr<std::string> memory(new std::string(size, '\0'));
+      if (size > 0)
+        file.read(&(*memory)[0], size);
+      if (!file)
+        Log::Fatal << "Could not read file '" << filename << "'!"
+            << std::endl;
+
+      owner = memory;
+      contents = memory->data();
+    }
+
+    const char* position = contents + sizeof(BinaryMagic);
+    const char* end = contents + size;
+    uint32_t version, byteOrder;
+    ReadBytes(position, end, &version, sizeof(uint32_t));
+    ReadBytes(position, end, &byteOrder, sizeof(uint32_t));
+    if (version != BinaryVersion || byteOrder != BinaryByteOrder)
+    {
+      Log::Fatal << "Binary file '" << filename << "' was written by another "
+          << "version of mlpack or on a machine with another byte order!"
+          << std::endl;
+    }
+
+    ReadBinary(position, end, owner);
+    return true;
+  }
+  file.close();
+
   xmlDocPtr xmlDocTree = NULL;
   if (NULL == (xmlDocTree = xmlReadFile(filename.c_str(), NULL, 0)))
   {
@@ -28,6 +177,7 @@ bool SaveRestoreUtility::ReadFile(const std::string& filename)
 void SaveRestoreUtility::ReadFile(xmlNode* n)
 {
   parameters.clear();
+  matrices.clear();
   xmlNodePtr current = NULL;
   for (current = n; current; current = current->next)
   {
@@ -49,6 +199,21 @@ void SaveRestoreUtility::ReadFile(xmlNode* n)
 
 bool SaveRestoreUtility::WriteFile(const std::string& filename)
 {
+  const std::string extension = ".bin";
+  if (filename.size() >= extension.size() && filename.compare(filename.size() -
+      extension.size(), extension.size(), extension) == 0)
+  {
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!file.is_open())
+      return false;
+
+    file.write(BinaryMagic, sizeof(BinaryMagic));
+    file.write((const char*) &BinaryVersion, sizeof(uint32_t));
+    file.write((const char*) &BinaryByteOrder, sizeof(uint32_t));
+    WriteBinary(file);
+    return file.good();
+  }
+
   bool success = false;
   xmlDocPtr xmlDocTree = xmlNewDoc(BAD_CAST "1.0");
   xmlNodePtr root = xmlNewNode(NULL, BAD_CAST "root");
@@ -70,6 +235,12 @@ void SaveRestoreUtility::WriteFile(xmlNode* n)
     xmlNewChild(n, NULL, BAD_CAST(*it).first.c_str(),
         BAD_CAST(*it).second.c_str());
   }
+  for (std::map<std::string, MatrixBlob>::reverse_iterator it =
+       matrices.rbegin(); it != matrices.rend(); ++it)
+  {
+    xmlNewChild(n, NULL, BAD_CAST(*it).first.c_str(),
+        BAD_CAST BlobText(it->second).c_str());
+  }
   xmlNodePtr child;
   for (std::map<std::string, SaveRestoreUtility>::iterator it =
        children.begin(); it != children.end(); ++it)
@@ -79,6 +250,137 @@ void SaveRestoreUtility::WriteFile(xmlNode* n)
   }
 }
 
+void SaveRestoreUtility::WriteBinary(std::ostream& stream) const
+{
+  WriteSize(stream, parameters.size());
+  for (std::map<std::string, std::string>::const_iterator it =
+       parameters.begin(); it != parameters.end(); ++it)
+  {
+    WriteString(stream, it->first);
+    WriteString(stream, it->second);
+  }
+
+  WriteSize(stream, matrices.size());
+  for (std::map<std::string, MatrixBlob>::const_iterator it =
+       matrices.begin(); it != matrices.end(); ++it)
+  {
+    const MatrixBlob& blob = it->second;
+    WriteString(stream, it->first);
+    stream.put(blob.kind);
+    WriteSize(stream, blob.elemSize);
+    WriteSize(stream, blob.rows);
+    WriteSize(stream, blob.cols);
+
+    // Pad, so that the elements are aligned if the file is mapped.
+    const size_t size = blob.elemSize * blob.rows * blob.cols;
+    const size_t padding = (BinaryAlignment - ((size_t) stream.tellp() +
+        sizeof(uint64_t)) % BinaryAlignment) % BinaryAlignment;
+    WriteSize(stream, padding);
+    for (size_t i = 0; i < padding; ++i)
+      stream.put('\0');
+    stream.write(blob.data, size);
+  }
+
+  WriteSize(stream, children.size());
+  for (std::map<std::string, SaveRestoreUtility>::const_iterator it =
+       children.begin(); it != children.end(); ++it)
+  {
+    WriteString(stream, it->first);
+    it->second.WriteBinary(stream);
+  }
+}
+
+void SaveRestoreUtility::ReadBinary(const char*& position,
+                                    const char* end,
+                                    const boost::shared_ptr<void>& owner)
+{
+  parameters.clear();
+  matrices.clear();
+  children.clear();
+
+  const uint64_t numParameters = ReadSize(position, end);
+  for (uint64_t i = 0; i < numParameters; ++i)
+  {
+    const std::string name = ReadString(position, end);
+    parameters[name] = ReadString(position, end);
+  }
+
+  const uint64_t numMatrices = ReadSize(position, end);
+  for (uint64_t i = 0; i < numMatrices; ++i)
+  {
+    const std::string name = ReadString(position, end);
+    MatrixBlob& blob = matrices[name];
+    ReadBytes(position, end, &blob.kind, sizeof(char));
+    blob.elemSize = ReadSize(position, end);
+    blob.rows = ReadSize(position, end);
+    blob.cols = ReadSize(position, end);
+
+    const uint64_t padding = ReadSize(position, end);
+    const uint64_t size = blob.elemSize * blob.rows * blob.cols;
+    if ((uint64_t) (end - position) < padding + size)
+      Log::Fatal << "SaveRestoreUtility::ReadFile(): binary file is truncated!"
+          << std::endl;
+
+    // The elements stay in the contents of the file.
+    position += padding;
+    blob.data = position;
+    blob.owner = owner;
+    position += size;
+  }
+
+  const uint64_t numChildren = ReadSize(position, end);
+  for (uint64_t i = 0; i < numChildren; ++i)
+  {
+    const std::string name = ReadString(position, end);
+    children[name].ReadBinary(position, end, owner);
+  }
+}
+
+std::string SaveRestoreUtility::BlobText(const MatrixBlob& blob)
+{
+  // Matrices are written to XML files with save_csv_ascii(), like they always
+  // were, so files written in either format can be read by old versions.
+  std::ostringstream output;
+  if (blob.kind == 'f')
+  {
+    arma::mat temp(blob.rows, blob.cols);
+    if (blob.elemSize == sizeof(float))
+      CopyBlob<float>(blob, temp);
+    else if (blob.elemSize == sizeof(double))
+      CopyBlob<double>(blob, temp);
+    else
+      Log::Fatal << "SaveRestoreUtility::WriteFile(): matrices of this element "
+          << "type cannot be written to XML files." << std::endl;
+    arma::diskio::save_csv_ascii(temp, output);
+  }
+  else if (blob.kind == 'i')
+  {
+    arma::Mat<arma::sword> temp(blob.rows, blob.cols);
+    switch (blob.elemSize)
+    {
+      case 1: CopyBlob<int8_t>(blob, temp); break;
+      case 2: CopyBlob<int16_t>(blob, temp); break;
+      case 4: CopyBlob<int32_t>(blob, temp); break;
+      default: CopyBlob<int64_t>(blob, temp); break;
+    }
+    arma::diskio::save_csv_ascii(temp, output);
+  }
+  else
+  {
+    arma::Mat<arma::uword> temp(blob.rows, blob.cols);
+    switch (blob.elemSize)
+    {
+      case 1: CopyBlob<uint8_t>(blob, temp); break;
+      case 2: CopyBlob<uint16_t>(blob, temp); break;
+      case 4: CopyBlob<uint32_t>(blob, temp); break;
+      default: CopyBlob<uint64_t>(blob, temp); break;
+    }
+    arma::diskio::save_csv_ascii(temp, output);
+  }
+
+  return output.str();
+}
+
 std::string SaveRestoreUtility::LoadParameter(std::string& str,
                                               const std::string& name) const
 {
@@ -3,7 +3,8 @@
  * @author Neil Slagle
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  The output file type is XML, or a binary format for
+ *   files ending in ".bin".
  *
  * @experimental
  */
@@ -11,6 +12,7 @@
 #define __MLPACK_CORE_UTIL_SAVE_RESTORE_UTILITY_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <limits>
 #include <list>
 #include <map>
 #include <sstream>
@@ -20,6 +22,7 @@
 #include <libxml/tree.h>
 
 #include <boost/tokenizer.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace mlpack {
 namespace util {
@@ -38,6 +41,33 @@ class SaveRestoreUtility
    */
   std::map<std::string, SaveRestoreUtility> children;
 
+  /**
+   * A dense matrix, stored as the raw memory of its elements.  The memory is
+   * owned by the matrix itself, or is part of the contents (or the mapping) of
+   * the binary file it was read from.
+   */
+  struct MatrixBlob
+  {
+    //! The kind of element: 'f' (floating point), 'i' (signed integer) or
+    //! 'u' (unsigned integer).
+    char kind;
+    //! The size of an element, in bytes.
+    size_t elemSize;
+    //! The number of rows.
+    size_t rows;
+    //! The number of columns.
+    size_t cols;
+    //! The owner of the memory of the elements.
+    boost::shared_ptr<void> owner;
+    //! The elements, in column-major order.
+    const char* data;
+  };
+
+  /**
+   * matrices contains a list of names and dense matrices in binary form.
+   */
+  std::map<std::string, MatrixBlob> matrices;
+
   /**
    * RecurseOnNodes performs a depth first search of the XML tree.
    */
@@ -49,12 +79,18 @@ class SaveRestoreUtility
   ~SaveRestoreUtility() { parameters.clear(); }
 
   /**
-   * ReadFile reads an XML tree from a file.
+   * ReadFile reads a model from a file.  Binary files are recognized by their
+   * header; all other files are read as XML.  If mapMatrices is true, the
+   * binary file is mapped into memory instead of being read, so the elements
+   * of a matrix are only read from disk when the matrix is loaded.
    */
-  bool ReadFile(const std::string& filename);
+  bool ReadFile(const std::string& filename, const bool mapMatrices = false);
 
   /**
-   * WriteFile writes the XML tree to a file.
+   * WriteFile writes the model to a file.  If the name of the file ends in
+   * ".bin", the binary format is used: every matrix is stored as a
+   * length-prefixed block of its raw elements.  Otherwise, an XML tree is
+   * written.
    */
   bool WriteFile(const std::string& filename);
 
@@ -162,6 +198,34 @@ class SaveRestoreUtility
    * ReadFile reads an XML tree recursively.
    */
   void ReadFile(xmlNode* n);
+
+  /**
+   * WriteBinary writes this model and its children to a binary file.
+   */
+  void WriteBinary(std::ostream& stream) const;
+
+  /**
+   * ReadBinary reads this model and its children from the contents of a
+   * binary file, which are owned by the given pointer.
+   */
+  void ReadBinary(const char*& position,
+                  const char* end,
+                  const boost::shared_ptr<void>& owner);
+
+  //! Return the kind of the given element type, for a MatrixBlob.
+  template<typename eT>
+  static char ElemKind()
+  {
+    return !std::numeric_limits<eT>::is_integer ? 'f' :
+        (std::numeric_limits<eT>::is_signed ? 'i' : 'u');
+  }
+
+  //! Copy the elements of a matrix blob of the given element type.
+  template<typename BlobType, typename eT>
+  static void CopyBlob(const MatrixBlob& blob, arma::Mat<eT>& matrix);
+
+  //! Convert a matrix blob to the CSV text of the XML format.
+  static std::string BlobText(const MatrixBlob& blob);
 };
 
 } /* namespace util */
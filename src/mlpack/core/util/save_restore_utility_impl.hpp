@@ -3,7 +3,8 @@
  * @author Neil Slagle
  *
  * The SaveRestoreUtility provides helper functions in saving and
- *   restoring models.  The current output file type is XML.
+ *   restoring models.  The output file type is XML, or a binary format for
+ *   files ending in ".bin".
  */
 #ifndef __MLPACK_CORE_UTIL_SAVE_RESTORE_UTILITY_IMPL_HPP
 #define __MLPACK_CORE_UTIL_SAVE_RESTORE_UTILITY_IMPL_HPP
@@ -43,13 +44,60 @@ std::vector<T>& SaveRestoreUtility::LoadParameter(std::vector<T>& v,
   return v;
 }
 
+template<typename BlobType, typename eT>
+void SaveRestoreUtility::CopyBlob(const MatrixBlob& blob, arma::Mat<eT>& matrix)
+{
+  // The elements may not be aligned, so they are copied one by one.
+  for (size_t i = 0; i < matrix.n_elem; ++i)
+  {
+    BlobType value;
+    memcpy(&value, blob.data + i * sizeof(BlobType), sizeof(BlobType));
+    matrix[i] = (eT) value;
+  }
+}
+
 // Load Armadillo matrices specially, in order to preserve precision.  This
-// catches dense objects.
+// catches dense objects, which are stored in binary form unless they were read
+// from an XML file.
 template<typename eT>
 arma::Mat<eT>& SaveRestoreUtility::LoadParameter(
     arma::Mat<eT>& t,
     const std::string& name) const
 {
+  typename std::map<std::string, MatrixBlob>::const_iterator blobIt =
+      matrices.find(name);
+  if (blobIt != matrices.end())
+  {
+    const MatrixBlob& blob = blobIt->second;
+    t.set_size(blob.rows, blob.cols);
+
+    if (blob.kind == ElemKind<eT>() && blob.elemSize == sizeof(eT))
+    {
+      memcpy(t.memptr(), blob.data, sizeof(eT) * t.n_elem);
+      return t;
+    }
+
+    // The matrix was saved with a different element type.
+    const int type = (blob.kind << 8) | (int) blob.elemSize;
+    switch (type)
+    {
+      case ('f' << 8) | 4: CopyBlob<float>(blob, t); break;
+      case ('f' << 8) | 8: CopyBlob<double>(blob, t); break;
+      case ('i' << 8) | 1: CopyBlob<int8_t>(blob, t); break;
+      case ('i' << 8) | 2: CopyBlob<int16_t>(blob, t); break;
+      case ('i' << 8) | 4: CopyBlob<int32_t>(blob, t); break;
+      case ('i' << 8) | 8: CopyBlob<int64_t>(blob, t); break;
+      case ('u' << 8) | 1: CopyBlob<uint8_t>(blob, t); break;
+      case ('u' << 8) | 2: CopyBlob<uint16_t>(blob, t); break;
+      case ('u' << 8) | 4: CopyBlob<uint32_t>(blob, t); break;
+      case ('u' << 8) | 8: CopyBlob<uint64_t>(blob, t); break;
+      default:
+        Log::Fatal << "LoadParameter(): node '" << name << "' has an unknown "
+            << "element type.\n";
+    }
+    return t;
+  }
+
   std::map<std::string, std::string>::const_iterator it = parameters.find(name);
   if (it != parameters.end())
   {
@@ -127,16 +175,21 @@ void SaveRestoreUtility::SaveParameter(
     const arma::Base<eT, T1>& t,
     const std::string& name)
 {
-  // Create a matrix to give to save_csv_ascii().  This may incur a copy,
-  // depending on the compiler's intelligence.  But the disk bandwidth is going
-  // to be the main slowdown anyway...
-  arma::Mat<eT> temp(t.get_ref());
-
-  // Use save_csv_ascii().  This is *slightly* imprecise and it may be better to
-  // store this raw.  But this is readable...
-  std::ostringstream output;
-  arma::diskio::save_csv_ascii(temp, output);
-  parameters[name] = output.str();
+  // Store the raw elements, so that there is no loss of precision and no text
+  // conversion unless an XML file is written.
+  const arma::Mat<eT> temp(t.get_ref());
+  boost::shared_ptr<std::string> memory(new std::string(
+      (const char*) temp.memptr(), sizeof(eT) * temp.n_elem));
+
+  MatrixBlob& blob = matrices[name];
+  blob.kind = ElemKind<eT>();
+  blob.elemSize = sizeof(eT);
+  blob.rows = temp.n_rows;
+  blob.cols = temp.n_cols;
+  blob.data = memory->data();
+  blob.owner = memory;
+
+  parameters.erase(name);
 }
 
 // Print sparse Armadillo matrices specially, in order to preserve precision.
@@ -0,0 +1,265 @@
+/**
+ * @file scoped_timer.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the per-thread accumulation of scoped timers.
+ */
+#include "scoped_timer.hpp"
+#include "log.hpp"
+#include "trace.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+using namespace mlpack;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * A tree of timers.  Node 0 is the root, which is not a timer; the children of
+ * a node are the timers that were started while it was running.
+ */
+struct TimerTree
+{
+  struct Node
+  {
+    size_t timer;
+    size_t parent;
+    size_t firstChild;
+    size_t nextSibling;
+    int64_t nanoseconds;
+    size_t calls;
+  };
+
+  TimerTree() { Clear(); }
+
+  void Clear()
+  {
+    nodes.clear();
+    nodes.push_back(Node());
+    nodes[0].timer = nodes[0].parent = size_t(-1);
+    nodes[0].firstChild = nodes[0].nextSibling = 0;
+    nodes[0].nanoseconds = 0;
+    nodes[0].calls = 0;
+  }
+
+  //! Return the child of the given node for the given timer, adding it if it
+  //! doesn't exist yet.
+  size_t Child(const size_t node, const size_t timer)
+  {
+    size_t last = 0;
+    for (size_t child = nodes[node].firstChild; child != 0;
+        child = nodes[child].nextSibling)
+    {
+      if (nodes[child].timer == timer)
+        return child;
+      last = child;
+    }
+
+    Node child;
+    child.timer = timer;
+    child.parent = node;
+    child.firstChild = child.nextSibling = 0;
+    child.nanoseconds = 0;
+    child.calls = 0;
+    nodes.push_back(child);
+
+    // Keep the children in the order they were first started.
+    if (last == 0)
+      nodes[node].firstChild = nodes.size() - 1;
+    else
+      nodes[last].nextSibling = nodes.size() - 1;
+    return nodes.size() - 1;
+  }
+
+  //! Add the timers below the given node of another tree to the given node.
+  void Merge(const TimerTree& other, const size_t otherNode, const size_t node)
+  {
+    for (size_t child = other.nodes[otherNode].firstChild; child != 0;
+        child = other.nodes[child].nextSibling)
+    {
+      const size_t mergedChild = Child(node, other.nodes[child].timer);
+      nodes[mergedChild].nanoseconds += other.nodes[child].nanoseconds;
+      nodes[mergedChild].calls += other.nodes[child].calls;
+      Merge(other, child, mergedChild);
+    }
+  }
+
+  std::vector<Node> nodes;
+};
+
+struct ThreadTimers;
+
+/**
+ * The names of all timers, the timers of all running threads, and the merged
+ * timers of the threads that exited.
+ */
+struct Registry
+{
+  std::mutex lock;
+  std::vector<std::string> names;
+  std::vector<ThreadTimers*> threads;
+  TimerTree exited;
+};
+
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+/**
+ * The timers of a single thread, and the timers that are running on it.
+ */
+struct ThreadTimers
+{
+  ThreadTimers() : current(0)
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.threads.push_back(this);
+  }
+
+  ~ThreadTimers()
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.exited.Merge(tree, 0, 0);
+    for (size_t i = 0; i < registry.threads.size(); ++i)
+    {
+      if (registry.threads[i] == this)
+      {
+        registry.threads.erase(registry.threads.begin() + i);
+        break;
+      }
+    }
+  }
+
+  TimerTree tree;
+  size_t current;
+  std::vector<Clock::time_point> starts;
+};
+
+ThreadTimers& GetThreadTimers()
+{
+  static thread_local ThreadTimers timers;
+  return timers;
+}
+
+void Flatten(const TimerTree& tree,
+             const std::vector<std::string>& names,
+             const size_t node,
+             const size_t depth,
+             std::vector<ScopedTimerRecord>& records)
+{
+  for (size_t child = tree.nodes[node].firstChild; child != 0;
+      child = tree.nodes[child].nextSibling)
+  {
+    ScopedTimerRecord record;
+    record.name = names[tree.nodes[child].timer];
+    record.depth = depth;
+    record.seconds = tree.nodes[child].nanoseconds * 1e-9;
+    record.calls = tree.nodes[child].calls;
+    records.push_back(record);
+
+    Flatten(tree, names, child, depth + 1, records);
+  }
+}
+
+} // anonymous namespace
+
+size_t ScopedTimers::Intern(const char* name)
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  for (size_t i = 0; i < registry.names.size(); ++i)
+    if (registry.names[i] == name)
+      return i;
+
+  registry.names.push_back(name);
+  return registry.names.size() - 1;
+}
+
+std::string ScopedTimers::Name(const size_t id)
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+  return registry.names[id];
+}
+
+void ScopedTimers::Start(const size_t id)
+{
+  ThreadTimers& timers = GetThreadTimers();
+  timers.current = timers.tree.Child(timers.current, id);
+  timers.starts.push_back(Clock::now());
+}
+
+void ScopedTimers::Stop()
+{
+  const Clock::time_point end = Clock::now();
+  ThreadTimers& timers = GetThreadTimers();
+  if (timers.starts.empty())
+    return;
+
+  TimerTree::Node& node = timers.tree.nodes[timers.current];
+  node.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+      end - timers.starts.back()).count();
+  ++node.calls;
+
+  if (Trace::Enabled())
+    Trace::ScopedSpan(node.timer, timers.starts.back(), end);
+
+  timers.starts.pop_back();
+  timers.current = node.parent;
+}
+
+void ScopedTimers::Report(std::vector<ScopedTimerRecord>& records)
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+
+  TimerTree merged;
+  merged.Merge(registry.exited, 0, 0);
+  for (size_t i = 0; i < registry.threads.size(); ++i)
+    merged.Merge(registry.threads[i]->tree, 0, 0);
+
+  records.clear();
+  Flatten(merged, registry.names, 0, 0, records);
+}
+
+void ScopedTimers::Print()
+{
+  std::vector<ScopedTimerRecord> records;
+  Report(records);
+  if (records.empty())
+    return;
+
+  Log::Info << "Scoped timers:" << std::endl;
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    // Format the line separately, so the flags of Log::Info don't change.
+    std::ostringstream line;
+    line << std::string(2 * (records[i].depth + 1), ' ') << records[i].name
+        << ": " << std::fixed << std::setprecision(6) << records[i].seconds
+        << "s (" << records[i].calls << " calls)";
+    Log::Info << line.str() << std::endl;
+  }
+}
+
+void ScopedTimers::Reset()
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+
+  registry.exited.Clear();
+  for (size_t i = 0; i < registry.threads.size(); ++i)
+  {
+    // Timers that are running keep their place in the tree.
+    if (registry.threads[i]->starts.empty())
+      registry.threads[i]->tree.Clear();
+  }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file scoped_timer.hpp
+ * @author Ryan Curtin
+ *
+ * Scoped timers for fine-grained instrumentation, which can be used from
+ * parallel code.  Every thread accumulates its own timers, and the timers of
+ * all threads are merged for the report.
+ */
+#ifndef __MLPACK_CORE_UTIL_SCOPED_TIMER_HPP
+#define __MLPACK_CORE_UTIL_SCOPED_TIMER_HPP
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace mlpack {
+
+/**
+ * The accumulated value of a scoped timer, as given by ScopedTimers::Report().
+ * Timers are nested: a timer that was started while another timer was running
+ * on the same thread is a child of that timer.
+ */
+struct ScopedTimerRecord
+{
+  //! The name of the timer.
+  std::string name;
+  //! The nesting depth of the timer (0 for timers that are not nested).
+  size_t depth;
+  //! The total time the timer ran, over all threads, in seconds.
+  double seconds;
+  //! The number of times the timer ran, over all threads.
+  size_t calls;
+};
+
+/**
+ * The registry of scoped timers.  Unlike Timer::Start() and Timer::Stop(),
+ * which look up the timer by name in the CLI singleton, a scoped timer is
+ * identified by an integer id that is interned once per call site, and every
+ * thread accumulates the time and the number of calls of its timers without
+ * any locking.  The timers of a thread are merged into the report when the
+ * thread exits.
+ *
+ * The timers should not be used directly; use the MLPACK_SCOPED_TIMER() macro
+ * instead:
+ *
+ * @code
+ * void Traverse(...)
+ * {
+ *   MLPACK_SCOPED_TIMER("traversal");
+ *   ...
+ * }
+ * @endcode
+ *
+ * Timers that are started in the threads of a parallel region are not nested
+ * in the timer that is running on the thread that started the region.  With
+ * --verbose, the report is printed after the program timers.  If the Trace is
+ * enabled, every run of a timer is also recorded as a span.
+ */
+class ScopedTimers
+{
+ public:
+  /**
+   * Return the id of the timer with the given name.  Every call with the same
+   * name returns the same id.
+   *
+   * @param name Name of the timer.
+   */
+  static size_t Intern(const char* name);
+
+  /**
+   * Return the name of the timer with the given id.
+   *
+   * @param id Id of the timer, as given by Intern().
+   */
+  static std::string Name(const size_t id);
+
+  /**
+   * Start the timer with the given id on the calling thread, nested in the
+   * timer that is running on this thread (if any).
+   *
+   * @param id Id of the timer, as given by Intern().
+   */
+  static void Start(const size_t id);
+
+  /**
+   * Stop the innermost timer running on the calling thread.
+   */
+  static void Stop();
+
+  /**
+   * Get the accumulated timers of all threads, in depth-first order.  This
+   * should be called when no timers are running on other threads.
+   *
+   * @param records Vector to store the timers in.
+   */
+  static void Report(std::vector<ScopedTimerRecord>& records);
+
+  /**
+   * Print the accumulated timers of all threads to Log::Info.
+   */
+  static void Print();
+
+  /**
+   * Reset the accumulated timers of all threads.  This should be called when no
+   * timers are running.
+   */
+  static void Reset();
+};
+
+/**
+ * A timer that runs while it is in scope.
+ */
+class ScopedTimer
+{
+ public:
+  //! Start the timer with the given id.
+  ScopedTimer(const size_t id) { ScopedTimers::Start(id); }
+
+  //! Stop the timer.
+  ~ScopedTimer() { ScopedTimers::Stop(); }
+
+ private:
+  // A scoped timer can't be copied.
+  ScopedTimer(const ScopedTimer& other);
+  ScopedTimer& operator=(const ScopedTimer& other);
+};
+
+}; // namespace mlpack
+
+#define MLPACK_SCOPED_TIMER_CONCAT_INNER(a, b) a ## b
+#define MLPACK_SCOPED_TIMER_CONCAT(a, b) MLPACK_SCOPED_TIMER_CONCAT_INNER(a, b)
+
+/**
+ * Time the rest of the enclosing scope with the scoped timer of the given
+ * name.  The name is interned the first time the call site is reached.
+ */
+#define MLPACK_SCOPED_TIMER(name) \
+    static const size_t MLPACK_SCOPED_TIMER_CONCAT(mlpackTimerId, __LINE__) = \
+        ::mlpack::ScopedTimers::Intern(name); \
+    ::mlpack::ScopedTimer MLPACK_SCOPED_TIMER_CONCAT(mlpackTimer, __LINE__)( \
+        MLPACK_SCOPED_TIMER_CONCAT(mlpackTimerId, __LINE__))
+
+#endif
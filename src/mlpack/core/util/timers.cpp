@@ -33,6 +33,8 @@ inline void timersub(const timeval* tvp, const timeval* uvp, timeval* vvp)
  */
 void Timer::Start(const std::string& name)
 {
+  // The timers are kept in a map, so only one thread can use them at a time.
+  #pragma omp critical(timers)
   CLI::GetSingleton().timer.StartTimer(name);
 }
 
@@ -41,6 +43,7 @@ void Timer::Start(const std::string& name)
  */
 void Timer::Stop(const std::string& name)
 {
+  #pragma omp critical(timers)
   CLI::GetSingleton().timer.StopTimer(name);
 }
 
@@ -49,7 +52,21 @@ void Timer::Stop(const std::string& name)
  */
 timeval Timer::Get(const std::string& name)
 {
-  return CLI::GetSingleton().timer.GetTimer(name);
+  timeval value;
+  #pragma omp critical(timers)
+  value = CLI::GetSingleton().timer.GetTimer(name);
+  return value;
+}
+
+/**
+ * Get the hardware counters of the given timer.
+ */
+PerfCounterValues Timer::GetCounters(const std::string& name)
+{
+  PerfCounterValues values;
+  #pragma omp critical(timers)
+  values = CLI::GetSingleton().timer.GetCounters(name);
+  return values;
 }
 
 std::map<std::string, timeval>& Timers::GetAllTimers()
@@ -62,6 +79,14 @@ timeval Timers::GetTimer(const std::string& timerName)
   return timers[timerName];
 }
 
+PerfCounterValues Timers::GetCounters(const std::string& timerName)
+{
+  if (counters.count(timerName) == 0)
+    return PerfCounterValues();
+
+  return counters[timerName];
+}
+
 void Timers::PrintTimer(const std::string& timerName)
 {
   timeval& t = timers[timerName];
@@ -114,6 +139,10 @@ void Timers::PrintTimer(const std::string& timerName)
     Log::Info << ")";
   }
 
+  // Print the hardware events counted while the timer ran.
+  if (counters.count(timerName) == 1 && counters[timerName].Available())
+    Log::Info << " [" << counters[timerName].ToString() << "]";
+
   Log::Info << std::endl;
 }
 
@@ -159,9 +188,11 @@ void Timers::GetTime(timeval* tv)
     tv->tv_sec = ts.tv_sec;
     tv->tv_usec = ts.tv_nsec / 1e3;
   }
-
-  // Fallback for the clock_gettime function.
-  gettimeofday(tv, NULL);
+  else
+  {
+    // Fallback for the clock_gettime function.
+    gettimeofday(tv, NULL);
+  }
 
 #endif  // _POSIX_TIMERS
 #elif defined(_WIN32)
@@ -223,6 +254,14 @@ void Timers::StartTimer(const std::string& timerName)
   }
 
   timers[timerName] = tmp;
+
+  // Remember the hardware counters at the start, if they are enabled.
+  PerfCounterValues start;
+  if (PerfCounters::Read(start))
+    counterStarts[timerName] = start;
+
+  if (Trace::Enabled())
+    traceStarts[timerName] = Trace::Clock::now();
 }
 
 #ifdef _WIN32
@@ -253,4 +292,23 @@ void Timers::StopTimer(const std::string& timerName)
   // Calculate the delta time.
   timersub(&b, &a, &delta);
   timers[timerName] = delta;
+
+  // Add the hardware events counted since the start.
+  PerfCounterValues end;
+  if (counterStarts.count(timerName) == 1 && PerfCounters::Read(end))
+  {
+    end -= counterStarts[timerName];
+    counters[timerName] += end;
+  }
+  counterStarts.erase(timerName);
+
+  // Record the run of the timer in the trace; if the timer was started before
+  // the trace was enabled, the run begins at the start of the trace.
+  if (Trace::Enabled())
+  {
+    const Trace::Clock::time_point end = Trace::Clock::now();
+    Trace::Span(timerName, (traceStarts.count(timerName) == 1) ?
+        traceStarts[timerName] : Trace::Clock::time_point(), end);
+  }
+  traceStarts.erase(timerName);
 }
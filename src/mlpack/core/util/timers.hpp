@@ -11,6 +11,9 @@
 #include <map>
 #include <string>
 
+#include "perf_counters.hpp"
+#include "trace.hpp"
+
 #if defined(__unix__) || defined(__unix)
   #include <time.h>       // clock_gettime()
   #include <sys/time.h>   // timeval, gettimeofday()
@@ -89,6 +92,14 @@ class Timer
    * @param name Name of timer to return value of.
    */
   static timeval Get(const std::string& name);
+
+  /**
+   * Get the hardware events counted while the given timer ran (see
+   * PerfCounters).  No events are available if counting was disabled.
+   *
+   * @param name Name of timer to return the counters of.
+   */
+  static PerfCounterValues GetCounters(const std::string& name);
 };
 
 class Timers
@@ -109,9 +120,17 @@ class Timers
    */
   timeval GetTimer(const std::string& timerName);
 
+  /**
+   * Returns the hardware events counted while the specified timer ran.
+   *
+   * @param timerName The name of the timer in question.
+   */
+  PerfCounterValues GetCounters(const std::string& timerName);
+
   /**
    * Prints the specified timer.  If it took longer than a minute to complete
-   * the timer will be displayed in days, hours, and minutes as well.
+   * the timer will be displayed in days, hours, and minutes as well.  The
+   * hardware events counted while it ran, if any, are printed after it.
    *
    * @param timerName The name of the timer in question.
    */
@@ -121,7 +140,8 @@ class Timers
    * Initializes a timer, available like a normal value specified on
    * the command line.  Timers are of type timeval.  If a timer is started, then
    * stopped, then re-started, then stopped, the final timer value will be the
-   * length of both runs of the timer.
+   * length of both runs of the timer.  If hardware counters are enabled (see
+   * PerfCounters), the events of the calling thread are counted as well.
    *
    * @param timerName The name of the timer in question.
    */
@@ -138,6 +158,14 @@ class Timers
  private:
   std::map<std::string, timeval> timers;
 
+  //! The hardware events counted while the timers ran.
+  std::map<std::string, PerfCounterValues> counters;
+  //! The hardware counters when the running timers were started.
+  std::map<std::string, PerfCounterValues> counterStarts;
+
+  //! The times the running timers were started, for the Trace.
+  std::map<std::string, Trace::Clock::time_point> traceStarts;
+
   void FileTimeToTimeVal(timeval* tv);
   void GetTime(timeval* tv);
 };
@@ -0,0 +1,312 @@
+/**
+ * @file trace.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the per-thread recording of the trace, and of its output
+ * in the Chrome trace event format.
+ */
+#include "trace.hpp"
+#include "scoped_timer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#include <stdint.h>
+
+using namespace mlpack;
+
+namespace {
+
+/**
+ * A recorded span ('X') or set of counters ('C').
+ */
+struct Event
+{
+  char phase;
+  std::string name;
+  //! The id of the scoped timer of the span, or -1 if the name is given.
+  size_t scopedId;
+  size_t thread;
+  //! The begin and the duration, in nanoseconds since the start of the trace.
+  int64_t begin;
+  int64_t duration;
+  std::vector<std::pair<std::string, double> > values;
+};
+
+struct ThreadTrace;
+
+/**
+ * Whether spans are recorded, the start of the trace, the buffers of all
+ * running threads, and the events of the threads that exited.
+ */
+struct Registry
+{
+  Registry() : enabled(false), started(false), threadCount(0) { }
+
+  std::atomic<bool> enabled;
+  bool started;
+  Trace::Clock::time_point start;
+  std::mutex lock;
+  size_t threadCount;
+  std::vector<ThreadTrace*> threads;
+  std::vector<Event> exited;
+};
+
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+/**
+ * The events recorded on a single thread.
+ */
+struct ThreadTrace
+{
+  ThreadTrace()
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    thread = registry.threadCount++;
+    registry.threads.push_back(this);
+  }
+
+  ~ThreadTrace()
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.exited.insert(registry.exited.end(), events.begin(),
+        events.end());
+    registry.threads.erase(std::remove(registry.threads.begin(),
+        registry.threads.end(), this), registry.threads.end());
+  }
+
+  size_t thread;
+  std::vector<Event> events;
+};
+
+ThreadTrace& GetThreadTrace()
+{
+  static thread_local ThreadTrace trace;
+  return trace;
+}
+
+//! Return the given time in nanoseconds since the start of the trace (and 0
+//! for times before it).
+int64_t Since(const Trace::Clock::time_point time)
+{
+  const Registry& registry = GetRegistry();
+  if (time <= registry.start)
+    return 0;
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time - registry.start).count();
+}
+
+//! Record a span on the calling thread.
+void AddSpan(const std::string& name,
+             const size_t scopedId,
+             const Trace::Clock::time_point begin,
+             const Trace::Clock::time_point end)
+{
+  ThreadTrace& trace = GetThreadTrace();
+
+  Event event;
+  event.phase = 'X';
+  event.name = name;
+  event.scopedId = scopedId;
+  event.thread = trace.thread;
+  event.begin = Since(begin);
+  event.duration = std::max(Since(end) - event.begin, (int64_t) 0);
+  trace.events.push_back(event);
+}
+
+//! Write the given string as a JSON string.
+void WriteString(std::ostream& stream, const std::string& value)
+{
+  stream << '"';
+  for (size_t i = 0; i < value.size(); ++i)
+  {
+    const char c = value[i];
+    if (c == '"' || c == '\\')
+    {
+      stream << '\\' << c;
+    }
+    else if ((unsigned char) c < 0x20)
+    {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int) c);
+      stream << escaped;
+    }
+    else
+    {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+
+//! Write a time in nanoseconds as microseconds.
+std::string Microseconds(const int64_t nanoseconds)
+{
+  std::ostringstream result;
+  result << std::fixed << std::setprecision(3) << (nanoseconds / 1000.0);
+  return result.str();
+}
+
+//! Write a number, with all of its digits.
+std::string Number(const double value)
+{
+  std::ostringstream result;
+  result << std::setprecision(17) << value;
+  return result.str();
+}
+
+bool EarlierEvent(const Event& a, const Event& b)
+{
+  if (a.begin != b.begin)
+    return a.begin < b.begin;
+
+  // Enclosing spans come before the spans they contain.
+  return a.duration > b.duration;
+}
+
+} // anonymous namespace
+
+void Trace::Enable()
+{
+  Registry& registry = GetRegistry();
+  {
+    std::lock_guard<std::mutex> guard(registry.lock);
+    if (!registry.started)
+    {
+      registry.start = Clock::now();
+      registry.started = true;
+    }
+  }
+
+  registry.enabled = true;
+}
+
+void Trace::Disable()
+{
+  GetRegistry().enabled = false;
+}
+
+bool Trace::Enabled()
+{
+  return GetRegistry().enabled;
+}
+
+void Trace::Span(const std::string& name,
+                 const Clock::time_point begin,
+                 const Clock::time_point end)
+{
+  if (Enabled())
+    AddSpan(name, size_t(-1), begin, end);
+}
+
+void Trace::ScopedSpan(const size_t id,
+                       const Clock::time_point begin,
+                       const Clock::time_point end)
+{
+  if (Enabled())
+    AddSpan("", id, begin, end);
+}
+
+void Trace::Counter(
+    const std::string& name,
+    const std::vector<std::pair<std::string, double> >& values)
+{
+  if (!Enabled())
+    return;
+
+  ThreadTrace& trace = GetThreadTrace();
+
+  Event event;
+  event.phase = 'C';
+  event.name = name;
+  event.scopedId = size_t(-1);
+  event.thread = trace.thread;
+  event.begin = Since(Clock::now());
+  event.duration = 0;
+  event.values = values;
+  trace.events.push_back(event);
+}
+
+void Trace::Write(std::ostream& stream)
+{
+  std::vector<Event> events;
+  size_t threadCount;
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+
+    events = registry.exited;
+    for (size_t i = 0; i < registry.threads.size(); ++i)
+    {
+      events.insert(events.end(), registry.threads[i]->events.begin(),
+          registry.threads[i]->events.end());
+    }
+    threadCount = registry.threadCount;
+  }
+
+  std::stable_sort(events.begin(), events.end(), EarlierEvent);
+
+  stream << "{\"traceEvents\": [";
+
+  // Name the threads, in the order they first recorded an event.
+  for (size_t t = 0; t < threadCount; ++t)
+  {
+    stream << ((t > 0) ? "," : "") << std::endl;
+    stream << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+        << "\"tid\": " << t << ", \"args\": {\"name\": \"thread " << t
+        << "\"}}";
+  }
+
+  for (size_t i = 0; i < events.size(); ++i)
+  {
+    const Event& event = events[i];
+    stream << ((threadCount > 0 || i > 0) ? "," : "") << std::endl;
+    stream << "{\"name\": ";
+    WriteString(stream, (event.scopedId == size_t(-1)) ? event.name :
+        ScopedTimers::Name(event.scopedId));
+    stream << ", \"ph\": \"" << event.phase << "\", \"ts\": "
+        << Microseconds(event.begin);
+    if (event.phase == 'X')
+      stream << ", \"dur\": " << Microseconds(event.duration);
+    stream << ", \"pid\": 0, \"tid\": " << event.thread;
+
+    if (!event.values.empty())
+    {
+      stream << ", \"args\": {";
+      for (size_t j = 0; j < event.values.size(); ++j)
+      {
+        if (j > 0)
+          stream << ", ";
+        WriteString(stream, event.values[j].first);
+        stream << ": " << Number(event.values[j].second);
+      }
+      stream << "}";
+    }
+
+    stream << "}";
+  }
+
+  stream << std::endl;
+  stream << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+}
+
+void Trace::Reset()
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.lock);
+
+  registry.exited.clear();
+  for (size_t i = 0; i < registry.threads.size(); ++i)
+    registry.threads[i]->events.clear();
+}
@@ -0,0 +1,112 @@
+/**
+ * @file trace.hpp
+ * @author Ryan Curtin
+ *
+ * A trace of the spans of the timers, with their nesting and threads, that can
+ * be written in the Chrome trace event format.
+ */
+#ifndef __MLPACK_CORE_UTIL_TRACE_HPP
+#define __MLPACK_CORE_UTIL_TRACE_HPP
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mlpack {
+
+/**
+ * The trace records every run of a timer as a span on the thread that ran it:
+ * the runs of the named timers (Timer::Start() and Timer::Stop()) and of the
+ * scoped timers (MLPACK_SCOPED_TIMER()).  Unlike the timers themselves, which
+ * only add up the time, the trace keeps when each run began and ended, so it
+ * shows how the runs are nested and where the threads of a parallel region
+ * wait for each other.  Counters (like the statistics of the tree traversals)
+ * can be added as well.
+ *
+ * The trace is written as JSON in the Chrome trace event format, which can be
+ * loaded in chrome://tracing or Perfetto, or parsed by other tools:
+ *
+ * @code
+ * {"traceEvents": [
+ * {"name": "tree_building", "ph": "X", "ts": 12.000, "dur": 5000.000,
+ *  "pid": 0, "tid": 0},
+ * ...
+ * ]}
+ * @endcode
+ *
+ * Every thread records its spans in its own buffer, without locking.  The
+ * --profile_output option of every program enables the trace and writes it to
+ * the given file at the end of execution.  Runs of timers that were started
+ * before the trace was enabled begin at the start of the trace.
+ */
+class Trace
+{
+ public:
+  //! The clock of the spans.
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * Enable the recording of spans.  The first call sets the start of the
+   * trace.
+   */
+  static void Enable();
+
+  //! Disable the recording of spans.
+  static void Disable();
+
+  //! Return whether spans are recorded.
+  static bool Enabled();
+
+  /**
+   * Record a span of the given name on the calling thread.
+   *
+   * @param name Name of the span.
+   * @param begin Time the span began.
+   * @param end Time the span ended.
+   */
+  static void Span(const std::string& name,
+                   const Clock::time_point begin,
+                   const Clock::time_point end);
+
+  /**
+   * Record a span of the scoped timer with the given id on the calling thread.
+   * The name of the timer is only looked up when the trace is written.
+   *
+   * @param id Id of the scoped timer.
+   * @param begin Time the span began.
+   * @param end Time the span ended.
+   */
+  static void ScopedSpan(const size_t id,
+                         const Clock::time_point begin,
+                         const Clock::time_point end);
+
+  /**
+   * Record the current values of the given counters under the given name.
+   *
+   * @param name Name of the counters.
+   * @param values Names and values of the counters.
+   */
+  static void Counter(
+      const std::string& name,
+      const std::vector<std::pair<std::string, double> >& values);
+
+  /**
+   * Write the trace in the Chrome trace event format.  This should be called
+   * when no spans are being recorded on other threads.
+   *
+   * @param stream Stream to write the trace to.
+   */
+  static void Write(std::ostream& stream);
+
+  /**
+   * Forget all recorded spans and counters.  This should be called when no
+   * spans are being recorded on other threads.
+   */
+  static void Reset();
+};
+
+}; // namespace mlpack
+
+#endif
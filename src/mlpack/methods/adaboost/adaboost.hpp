@@ -24,6 +24,7 @@
 #define __MLPACK_METHODS_ADABOOST_ADABOOST_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 #include <mlpack/methods/perceptron/perceptron.hpp>
 #include <mlpack/methods/decision_stump/decision_stump.hpp>
 
@@ -68,23 +69,77 @@ class AdaBoost
   void Classify(const MatType& test, arma::Row<size_t>& predictedLabels);
 
 private:
-  /**
-   *  This function helps in building the Weight Distribution matrix
-   *  which is updated during every iteration. It calculates the
-   *  "difficulty" in classifying a point by adding the weights for all
-   *  instances, using D.
-   *
-   *  @param D The 2 Dimensional weight matrix from which the weights are
-   *            to be calculated.
-   *  @param weights The output weight vector.
-   */
-  void BuildWeightMatrix(const arma::mat& D, arma::rowvec& weights);
+  HAS_MEM_FUNC(SortDimensions, HasSortDimensions)
+
+  //! The signature of a static SortDimensions() function, which weak learners
+  //! (such as DecisionStump) can provide to sort the data once for all rounds.
+  typedef void (*SortDimensionsType)(const MatType&, arma::umat&);
+
+  //! Sort each dimension of the data once, for weak learners which can use it.
+  template<typename W>
+  void SortDimensions(const MatType& data,
+                      arma::umat& sortedIndices,
+                      typename boost::enable_if<HasSortDimensions<W,
+                          SortDimensionsType> >::type* = 0);
+
+  //! Do nothing, for weak learners which cannot use sorted dimensions.
+  template<typename W>
+  void SortDimensions(const MatType& data,
+                      arma::umat& sortedIndices,
+                      typename boost::disable_if<HasSortDimensions<W,
+                          SortDimensionsType> >::type* = 0);
+
+  //! Train a weak learner on the weighted data, reusing the sorted dimensions.
+  template<typename W>
+  W TrainWeakLearner(const W& other,
+                     const MatType& data,
+                     const arma::rowvec& weights,
+                     const arma::Row<size_t>& labels,
+                     const arma::umat& sortedIndices,
+                     typename boost::enable_if<HasSortDimensions<W,
+                         SortDimensionsType> >::type* = 0);
+
+  //! Train a weak learner on the weighted data.
+  template<typename W>
+  W TrainWeakLearner(const W& other,
+                     const MatType& data,
+                     const arma::rowvec& weights,
+                     const arma::Row<size_t>& labels,
+                     const arma::umat& sortedIndices,
+                     typename boost::disable_if<HasSortDimensions<W,
+                         SortDimensionsType> >::type* = 0);
+
+  HAS_MEM_FUNC(Biases, HasBiases)
+
+  //! Number of points whose votes are computed at once when classifying.
+  static const size_t BlockSize = 1024;
+
+  //! Let every weak learner vote with its alpha for its predicted class; the
+  //! scores of linear weak learners (such as Perceptron) are computed at once.
+  template<typename W>
+  void Vote(const MatType& test,
+            arma::mat& votes,
+            typename boost::enable_if<HasBiases<W,
+                const arma::vec& (W::*)() const> >::type* = 0);
+
+  //! Let every weak learner vote with its alpha for its predicted class.
+  template<typename W>
+  void Vote(const MatType& test,
+            arma::mat& votes,
+            typename boost::disable_if<HasBiases<W,
+                const arma::vec& (W::*)() const> >::type* = 0);
 
   size_t numClasses;
 
   std::vector<WeakLearner> wl;
   std::vector<double> alpha;
 
+  //! The weights of all linear weak learners, side by side (built on the first
+  //! call of Classify()).
+  arma::mat stackedWeights;
+  //! The biases of all linear weak learners.
+  arma::vec stackedBiases;
+
   // To check for the bound for the hammingLoss.
   double ztProduct;
 
@@ -46,10 +46,7 @@ AdaBoost<MatType, WeakLearner>::AdaBoost(
   numClasses = (arma::max(labels) - arma::min(labels)) + 1;
   tolerance = tol;
 
-  double rt, crt, alphat = 0.0, zt;
-
-  // crt is for stopping the iterations when rt
-  // stops changing by less than a tolerant value.
+  double rt, crt = 0.0, alphat = 0.0, zt;
 
   // crt is cumulative rt for stopping the iterations when rt
   // stops changing by less than a tolerant value.
@@ -59,65 +56,36 @@ AdaBoost<MatType, WeakLearner>::AdaBoost(
   // To be used for prediction by the Weak Learner for prediction.
   arma::Row<size_t> predictedLabels(labels.n_cols);
 
-  // Use tempData to modify input Data for incorporating weights.
-  MatType tempData(data);
-
-  // This matrix is a helper matrix used to calculate the final hypothesis.
-  arma::mat sumFinalH(predictedLabels.n_cols, numClasses);
-  sumFinalH.fill(0.0);
+  // The weight distribution D of AdaBoost.mh has one weight for each point and
+  // class, but all the weights of a point are scaled by the same factor in
+  // every round, so D(i, k) = weights(i) / numClasses at all times.  Only the
+  // weights of the points (the sums of the rows of D) are stored, and they are
+  // passed directly to the weak learner, which shares the data.
+  arma::rowvec weights(data.n_cols);
+  weights.fill(1.0 / double(data.n_cols));
 
-  // load the initial weights into a 2-D matrix
-  const double initWeight = 1.0 / double(data.n_cols * numClasses);
-  arma::mat D(data.n_cols, numClasses);
-  D.fill(initWeight);
+  // Only the weights change between rounds, so if the weak learner can make
+  // use of it, each dimension of the data is sorted only once.
+  arma::umat sortedIndices;
+  SortDimensions<WeakLearner>(data, sortedIndices);
 
-  // Weights are to be compressed into this rowvector
-  // for focussing on the perceptron weights.
-  arma::rowvec weights(predictedLabels.n_cols);
-
-  // This is the final hypothesis.
-  arma::Row<size_t> finalH(predictedLabels.n_cols);
+  // The sum of the alphas of all rounds, which gives the final hypothesis.
+  double alphaSum = 0.0;
 
   // now start the boosting rounds
   for (int i = 0; i < iterations; i++)
   {
-    // Initialized to zero in every round.
+    // call the other weak learner and train the labels.
+    WeakLearner w = TrainWeakLearner(other, data, weights, labels,
+        sortedIndices);
+    w.Classify(data, predictedLabels);
+
     // rt is used for calculation of alphat, is the weighted error
     // rt = (sum)D(i)y(i)ht(xi)
     rt = 0.0;
-
-    // zt is used for weight normalization.
-    zt = 0.0;
-
-    // Build the weight vectors
-    BuildWeightMatrix(D, weights);
-
-    // call the other weak learner and train the labels.
-    WeakLearner w(other, tempData, weights, labels);
-    w.Classify(tempData, predictedLabels);
-
-    // Now from predictedLabels, build ht, the weak hypothesis
-    // buildClassificationMatrix(ht, predictedLabels);
-
-    // Now, start calculation of alpha(t) using ht
-
-    for (size_t j = 0;j < D.n_rows; j++) // instead of D, ht
-    {
-      if (predictedLabels(j) == labels(j))
-      {
-        // for (int k = 0;k < numClasses; k++)
-        //   rt += D(j,k);
-        rt += arma::accu(D.row(j));
-      }
-
-      else
-      {
-        // for (int k = 0;k < numClasses; k++)
-        //   rt -= D(j,k);
-        rt -= arma::accu(D.row(j));
-      }
-    }
-    // end calculation of rt
+    #pragma omp parallel for reduction(+:rt) schedule(static)
+    for (size_t j = 0; j < weights.n_elem; j++)
+      rt += (predictedLabels(j) == labels(j)) ? weights(j) : -weights(j);
 
     if (i > 0)
     {
@@ -133,65 +101,45 @@ AdaBoost<MatType, WeakLearner>::AdaBoost(
 
     alpha.push_back(alphat);
     wl.push_back(w);
+    alphaSum += alphat;
 
-    // now start modifying weights
-    for (size_t j = 0;j < D.n_rows; j++)
+    // Now update the weights, and calculate zt, the normalization constant, in
+    // the same pass.
+    const double expo = exp(alphat);
+    zt = 0.0;
+    #pragma omp parallel for reduction(+:zt) schedule(static)
+    for (size_t j = 0; j < weights.n_elem; j++)
     {
-      double expo = exp(alphat);
       if (predictedLabels(j) == labels(j))
-      {
-          for (size_t k = 0;k < D.n_cols; k++)
-          {
-            // we calculate zt, the normalization constant
-            zt += D(j,k) / expo; // * exp(-1 * alphat * yt(j,k) * ht(j,k));
-            D(j,k) = D(j,k) / expo;
-
-            // adding to the matrix of FinalHypothesis
-            // sumFinalH(j,k) += (alphat * ht(j,k));
-            if (k == labels(j))
-              sumFinalH(j,k) += (alphat);// * ht(j,k));
-            else
-              sumFinalH(j,k) -= (alphat);
-          }
-      }
+        weights(j) /= expo;
       else
-      {
-        for (size_t k = 0;k < D.n_cols; k++)
-          {
-            // we calculate zt, the normalization constant
-            zt += D(j,k) * expo;
-            D(j,k) = D(j,k) * expo;
-
-            // adding to the matrix of FinalHypothesis
-            if (k == labels(j))
-              sumFinalH(j,k) += (alphat);// * ht(j,k));
-            else
-              sumFinalH(j,k) -= (alphat);
-          }
-      }
+        weights(j) *= expo;
+
+      zt += weights(j);
     }
 
     // normalization of D
-    D = D / zt;
+    weights /= zt;
 
     // Accumulating the value of zt for the Hamming Loss bound.
     ztProduct *= zt;
   }
 
-  // Iterations are over, now build a strong hypothesis
-  // from a weighted combination of these weak hypotheses.
+  // Iterations are over, now build a strong hypothesis from a weighted
+  // combination of these weak hypotheses.  Every round adds alphat to the
+  // entry of the true class of each point, and subtracts it from the others.
+  arma::mat sumFinalH(numClasses, data.n_cols);
+  sumFinalH.fill(-alphaSum);
+  for (size_t i = 0; i < data.n_cols; i++)
+    sumFinalH(labels(i), i) = alphaSum;
 
-  arma::colvec tempSumFinalH;
   arma::uword max_index;
-  arma::mat sfh = sumFinalH.t();
-
-  for (size_t i = 0;i < sfh.n_cols; i++)
+  finalHypothesis.set_size(data.n_cols);
+  for (size_t i = 0; i < sumFinalH.n_cols; i++)
   {
-    tempSumFinalH = sfh.col(i);
-    tempSumFinalH.max(max_index);
-    finalH(i) = max_index;
+    sumFinalH.col(i).max(max_index);
+    finalHypothesis(i) = max_index;
   }
-  finalHypothesis = finalH;
 }
 
 /**
@@ -205,55 +153,160 @@ void AdaBoost<MatType, WeakLearner>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::Row<size_t> tempPredictedLabels(predictedLabels.n_cols);
-  arma::mat cMatrix(numClasses, test.n_cols);
+  // Each weak learner votes for the class it predicts, with its alpha.
+  arma::mat cMatrix;
+  Vote<WeakLearner>(test, cMatrix);
 
-  cMatrix.zeros();
-  predictedLabels.zeros();
+  predictedLabels.set_size(test.n_cols);
 
-  for (size_t i = 0;i < wl.size(); i++)
+  arma::uword max_index;
+  for (size_t i = 0; i < predictedLabels.n_cols; i++)
   {
-    wl[i].Classify(test, tempPredictedLabels);
+    cMatrix.col(i).max(max_index);
+    predictedLabels(i) = max_index;
+  }
+}
 
-    for (size_t j = 0; j < tempPredictedLabels.n_cols; j++)
-      cMatrix(tempPredictedLabels(j), j) += (alpha[i] * tempPredictedLabels(j));
+template <typename MatType, typename WeakLearner>
+template <typename W>
+void AdaBoost<MatType, WeakLearner>::Vote(
+    const MatType& test,
+    arma::mat& votes,
+    typename boost::enable_if<HasBiases<W,
+        const arma::vec& (W::*)() const> >::type*)
+{
+  votes.zeros(numClasses, test.n_cols);
+  if (wl.size() == 0)
+    return;
+
+  // Stack the weights of all rounds, so that the scores of all weak learners
+  // are computed with one matrix product for each block of points.
+  const size_t learnerClasses = wl[0].Weights().n_cols;
+  if (stackedWeights.n_cols != wl.size() * learnerClasses)
+  {
+    stackedWeights.set_size(wl[0].Weights().n_rows,
+        wl.size() * learnerClasses);
+    stackedBiases.set_size(wl.size() * learnerClasses);
+    for (size_t t = 0; t < wl.size(); t++)
+    {
+      stackedWeights.cols(t * learnerClasses, (t + 1) * learnerClasses - 1) =
+          wl[t].Weights();
+      stackedBiases.subvec(t * learnerClasses, (t + 1) * learnerClasses - 1) =
+          wl[t].Biases();
+    }
   }
 
-  arma::colvec cMRow;
-  arma::uword max_index;
+  if (test.n_rows != stackedWeights.n_rows)
+  {
+    Log::Fatal << "AdaBoost::Classify(): test data has " << test.n_rows
+        << " dimensions, but the weak learners were trained on "
+        << stackedWeights.n_rows << " dimensions!" << std::endl;
+  }
 
-  for (size_t i = 0; i < predictedLabels.n_cols; i++)
+  const size_t numBlocks = (test.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel
   {
-    cMRow = cMatrix.col(i);
-    cMRow.max(max_index);
-    predictedLabels(i) = max_index;
+    arma::mat scores;
+
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) test.n_cols);
+
+      scores = arma::trans(stackedWeights) * test.cols(begin, end - 1);
+      scores.each_col() += stackedBiases;
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        const double* pointScores = scores.colptr(i - begin);
+        for (size_t t = 0; t < wl.size(); t++)
+        {
+          // The prediction of a weak learner is its highest scoring class.
+          const double* learnerScores = pointScores + t * learnerClasses;
+          size_t maxIndex = 0;
+          for (size_t c = 1; c < learnerClasses; ++c)
+            if (learnerScores[c] > learnerScores[maxIndex])
+              maxIndex = c;
+
+          votes(maxIndex, i) += alpha[t];
+        }
+      }
+    }
   }
 }
 
-/**
- * This function helps in building the Weight Distribution matrix which is
- * updated during every iteration. It calculates the "difficulty" in classifying
- * a point by adding the weights for all instances, using D.
- *
- * @param D The 2 Dimensional weight matrix from which the weights are
- *      to be calculated.
- * @param weights The output weight vector.
- */
 template <typename MatType, typename WeakLearner>
-void AdaBoost<MatType, WeakLearner>::BuildWeightMatrix(
-    const arma::mat& D,
-    arma::rowvec& weights)
+template <typename W>
+void AdaBoost<MatType, WeakLearner>::Vote(
+    const MatType& test,
+    arma::mat& votes,
+    typename boost::disable_if<HasBiases<W,
+        const arma::vec& (W::*)() const> >::type*)
 {
-  size_t i, j;
-  weights.fill(0.0);
+  votes.zeros(numClasses, test.n_cols);
 
-  for (i = 0; i < D.n_rows; i++)
+  arma::Row<size_t> tempPredictedLabels(test.n_cols);
+  for (size_t i = 0; i < wl.size(); i++)
   {
-    for (j = 0; j < D.n_cols; j++)
-      weights(i) += D(i, j);
+    wl[i].Classify(test, tempPredictedLabels);
+
+    for (size_t j = 0; j < tempPredictedLabels.n_cols; j++)
+      votes(tempPredictedLabels(j), j) += alpha[i];
   }
 }
 
+template <typename MatType, typename WeakLearner>
+template <typename W>
+void AdaBoost<MatType, WeakLearner>::SortDimensions(
+    const MatType& data,
+    arma::umat& sortedIndices,
+    typename boost::enable_if<HasSortDimensions<W,
+        SortDimensionsType> >::type*)
+{
+  W::SortDimensions(data, sortedIndices);
+}
+
+template <typename MatType, typename WeakLearner>
+template <typename W>
+void AdaBoost<MatType, WeakLearner>::SortDimensions(
+    const MatType& /* data */,
+    arma::umat& /* sortedIndices */,
+    typename boost::disable_if<HasSortDimensions<W,
+        SortDimensionsType> >::type*)
+{
+  // Nothing to do.
+}
+
+template <typename MatType, typename WeakLearner>
+template <typename W>
+W AdaBoost<MatType, WeakLearner>::TrainWeakLearner(
+    const W& other,
+    const MatType& data,
+    const arma::rowvec& weights,
+    const arma::Row<size_t>& labels,
+    const arma::umat& sortedIndices,
+    typename boost::enable_if<HasSortDimensions<W,
+        SortDimensionsType> >::type*)
+{
+  return W(other, data, weights, labels, sortedIndices);
+}
+
+template <typename MatType, typename WeakLearner>
+template <typename W>
+W AdaBoost<MatType, WeakLearner>::TrainWeakLearner(
+    const W& other,
+    const MatType& data,
+    const arma::rowvec& weights,
+    const arma::Row<size_t>& labels,
+    const arma::umat& /* sortedIndices */,
+    typename boost::disable_if<HasSortDimensions<W,
+        SortDimensionsType> >::type*)
+{
+  return W(other, data, weights, labels);
+}
+
 } // namespace adaboost
 } // namespace mlpack
 
@@ -20,9 +20,11 @@
 #include <mlpack/methods/amf/update_rules/svd_batch_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_incomplete_incremental_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_complete_incremental_learning.hpp>
+#include <mlpack/methods/amf/update_rules/svd_parallel_incremental_learning.hpp>
 
 #include <mlpack/methods/amf/init_rules/random_init.hpp>
 
+#include <mlpack/methods/amf/termination_policies/sampled_residue_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_tolerance_termination.hpp>
 
@@ -123,6 +125,18 @@ class AMF
   //! Modify the update rule.
   UpdateRuleType& Update() { return update; }
 
+  /**
+   * Return the number of bytes used by the factorizer, including the
+   * intermediate matrices that the update rule and the termination policy keep
+   * between calls (W and H themselves are owned by the caller).
+   */
+  size_t MemoryUsage() const
+  {
+    return util::ObjectMemoryUsage(terminationPolicy) +
+        util::ObjectMemoryUsage(initializationRule) +
+        util::ObjectMemoryUsage(update);
+  }
+
  private:
   //! Termination policy.
   TerminationPolicyType terminationPolicy;
@@ -0,0 +1,126 @@
+/**
+ * @file blocked_amf.hpp
+ * @author Ryan Curtin
+ *
+ * Out-of-core alternating matrix factorization of a matrix stored on disk in
+ * blocks.
+ */
+#ifndef __MLPACK_METHODS_AMF_BLOCKED_AMF_HPP
+#define __MLPACK_METHODS_AMF_BLOCKED_AMF_HPP
+
+#include <mlpack/core.hpp>
+
+#include <mlpack/methods/amf/blocked_matrix.hpp>
+#include <mlpack/methods/amf/update_rules/blocked_als_update.hpp>
+#include <mlpack/methods/amf/update_rules/blocked_sgd_update.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class factorizes a sparse matrix V that is stored on disk in blocks (a
+ * BlockedMatrix) as \f$ V \approx WH \f$, like AMF does for matrices in
+ * memory.  The factors are stored on disk too, in slices that match the blocks
+ * of V, so neither V nor W nor H has to fit in memory: the update rule streams
+ * through the blocks and only keeps the slices of the factors that the current
+ * blocks need.  The error is measured on the nonzero values of V only.
+ *
+ * The update rule performs one pass over the blocks each iteration; it must
+ * implement
+ *
+ * @code
+ * void Update(const BlockedMatrix& V);
+ * @endcode
+ *
+ * which reads and writes the slices of the factors with the LoadW(), SaveW(),
+ * LoadH() and SaveH() methods of V.  BlockedALSUpdate (alternating least
+ * squares) and BlockedSGDUpdate (stratified stochastic gradient descent) are
+ * provided.  After each iteration, the root mean squared error of the factors
+ * on the nonzero values of V is computed with one more pass over the blocks,
+ * and the factorization stops when it changes by less than the given relative
+ * tolerance.
+ *
+ * @code
+ * BlockedMatrix V("ratings.csv", "blocks/ratings_", 16, 16);
+ *
+ * BlockedAMF<BlockedSGDUpdate> amf(BlockedSGDUpdate(0.005, 0.02, 0.02));
+ * const double rmse = amf.Apply(V, 20);
+ * @endcode
+ *
+ * @tparam UpdateRuleType The update rule for the slices of W and H.
+ *
+ * @see BlockedMatrix, AMF
+ */
+template<typename UpdateRuleType = BlockedALSUpdate>
+class BlockedAMF
+{
+ public:
+  /**
+   * Create the BlockedAMF object with the given update rule and termination
+   * parameters.
+   *
+   * @param update Instantiated update rule.
+   * @param maxIterations Maximum number of iterations (0 means no limit).
+   * @param tolerance Minimum relative change of the error, below which the
+   *     factorization terminates.
+   */
+  BlockedAMF(const UpdateRuleType& update = UpdateRuleType(),
+             const size_t maxIterations = 100,
+             const double tolerance = 1e-5);
+
+  /**
+   * Factorize the given blocked matrix with the given rank.  The slices of W
+   * and H are initialized with uniform random values and stored in the files
+   * of V, where they are left when the factorization is done (see
+   * BlockedMatrix::LoadW() and BlockedMatrix::LoadH()).
+   *
+   * @param V Blocked matrix to be factorized.
+   * @param r Rank of the factorization.
+   * @return The root mean squared error on the nonzero values of V.
+   */
+  double Apply(BlockedMatrix& V, const size_t r);
+
+  /**
+   * Compute the root mean squared error of the factors stored in the files of
+   * V on the nonzero values of V, with one pass over the blocks.
+   *
+   * @param V Blocked matrix that was factorized.
+   */
+  static double RMSE(const BlockedMatrix& V);
+
+  //! Get the number of iterations of the last factorization.
+  size_t Iteration() const { return iteration; }
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Access the update rule.
+  const UpdateRuleType& Update() const { return update; }
+  //! Modify the update rule.
+  UpdateRuleType& Update() { return update; }
+
+ private:
+  //! Instantiated update rule.
+  UpdateRuleType update;
+  //! Maximum number of iterations.
+  size_t maxIterations;
+  //! Minimum relative change of the error.
+  double tolerance;
+  //! Number of iterations of the last factorization.
+  size_t iteration;
+}; // class BlockedAMF
+
+}; // namespace amf
+}; // namespace mlpack
+
+// Include implementation.
+#include "blocked_amf_impl.hpp"
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file blocked_amf_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the BlockedAMF class.
+ */
+#ifndef __MLPACK_METHODS_AMF_BLOCKED_AMF_IMPL_HPP
+#define __MLPACK_METHODS_AMF_BLOCKED_AMF_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "blocked_amf.hpp"
+
+namespace mlpack {
+namespace amf {
+
+template<typename UpdateRuleType>
+BlockedAMF<UpdateRuleType>::BlockedAMF(const UpdateRuleType& update,
+                                       const size_t maxIterations,
+                                       const double tolerance) :
+    update(update),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    iteration(0)
+{
+  // Nothing to do.
+}
+
+template<typename UpdateRuleType>
+double BlockedAMF<UpdateRuleType>::Apply(BlockedMatrix& V, const size_t r)
+{
+  // The update rule reads the blocks from disk.
+  V.Flush();
+
+  // Initialize the slices of W and H.
+  arma::mat slice;
+  for (size_t i = 0; i < V.RowBlocks(); ++i)
+  {
+    slice.set_size(V.RowBlockSize(i), r);
+    math::RandomFill(slice);
+    V.SaveW(i, slice);
+  }
+  for (size_t j = 0; j < V.ColBlocks(); ++j)
+  {
+    slice.set_size(r, V.ColBlockSize(j));
+    math::RandomFill(slice);
+    V.SaveH(j, slice);
+  }
+
+  Log::Info << "Initialized the slices of W and H." << std::endl;
+
+  double rmse = RMSE(V);
+  iteration = 0;
+  while (maxIterations == 0 || iteration < maxIterations)
+  {
+    update.Update(V);
+    ++iteration;
+
+    const double oldRMSE = rmse;
+    rmse = RMSE(V);
+    Log::Info << "Iteration " << iteration << "; RMSE " << rmse << "."
+        << std::endl;
+
+    if (std::abs(oldRMSE - rmse) <= tolerance * oldRMSE)
+      break;
+  }
+
+  Log::Info << "BlockedAMF converged to RMSE of " << rmse << " in "
+      << iteration << " iterations." << std::endl;
+
+  return rmse;
+}
+
+template<typename UpdateRuleType>
+double BlockedAMF<UpdateRuleType>::RMSE(const BlockedMatrix& V)
+{
+  if (V.NonZeros() == 0)
+    return 0.0;
+
+  double sum = 0.0;
+  arma::mat w;
+  for (size_t i = 0; i < V.RowBlocks(); ++i)
+  {
+    // Work on the transpose of W, so that its rows are contiguous.
+    V.LoadW(i, w);
+    const arma::mat wt = w.t();
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:sum)
+    for (size_t j = 0; j < V.ColBlocks(); ++j)
+    {
+      arma::mat h;
+      arma::umat locations;
+      arma::vec values;
+      V.LoadH(j, h);
+      V.LoadBlock(i, j, locations, values);
+
+      for (size_t k = 0; k < values.n_elem; ++k)
+      {
+        const double error = values[k] - arma::dot(
+            wt.unsafe_col(locations(0, k)), h.unsafe_col(locations(1, k)));
+        sum += error * error;
+      }
+    }
+  }
+
+  return std::sqrt(sum / V.NonZeros());
+}
+
+}; // namespace amf
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,391 @@
+/**
+ * @file blocked_matrix.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the BlockedMatrix class.
+ */
+#include "blocked_matrix.hpp"
+
+#include <mlpack/core/data/chunked_load.hpp>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace mlpack;
+using namespace mlpack::amf;
+
+BlockedMatrix::BlockedMatrix(const std::string& prefix,
+                             const size_t numRows,
+                             const size_t numCols,
+                             const size_t rowBlocks,
+                             const size_t colBlocks) :
+    prefix(prefix),
+    numRows(numRows),
+    numCols(numCols),
+    rowBlocks(rowBlocks),
+    colBlocks(colBlocks)
+{
+  Create();
+}
+
+BlockedMatrix::BlockedMatrix(const std::string& coordinateFile,
+                             const std::string& prefix,
+                             const size_t rowBlocks,
+                             const size_t colBlocks,
+                             const size_t chunkSize) :
+    prefix(prefix),
+    numRows(0),
+    numCols(0),
+    rowBlocks(rowBlocks),
+    colBlocks(colBlocks)
+{
+  data::ChunkedLoader<double> loader(coordinateFile, true);
+  if (loader.Dimensionality() != 3)
+  {
+    Log::Fatal << "BlockedMatrix::BlockedMatrix(): '" << coordinateFile
+        << "' should hold (row, column, value) triples, not points of "
+        << "dimensionality " << loader.Dimensionality() << "." << std::endl;
+  }
+
+  // The first pass finds the size of the matrix.
+  arma::mat chunk;
+  while (loader.NextChunk(chunk, chunkSize))
+  {
+    numRows = std::max(numRows, (size_t) arma::max(chunk.row(0)) + 1);
+    numCols = std::max(numCols, (size_t) arma::max(chunk.row(1)) + 1);
+  }
+
+  Create();
+
+  loader.Reset();
+  while (loader.NextChunk(chunk, chunkSize))
+    Insert(chunk);
+
+  Flush();
+
+  Log::Info << "Partitioned " << NonZeros() << " values of a " << numRows
+      << " x " << numCols << " matrix into " << rowBlocks << " x " << colBlocks
+      << " blocks." << std::endl;
+}
+
+BlockedMatrix::BlockedMatrix(const std::string& prefix) : prefix(prefix)
+{
+  ReadMetadata();
+  buffers.resize(rowBlocks * colBlocks);
+}
+
+BlockedMatrix::~BlockedMatrix()
+{
+  Flush();
+}
+
+void BlockedMatrix::Create()
+{
+  if (rowBlocks == 0 || colBlocks == 0 || rowBlocks > numRows ||
+      colBlocks > numCols)
+  {
+    Log::Fatal << "BlockedMatrix::BlockedMatrix(): cannot partition a "
+        << numRows << " x " << numCols << " matrix into " << rowBlocks << " x "
+        << colBlocks << " blocks." << std::endl;
+  }
+
+  // The indices in a block are stored with 32 bits.
+  const size_t maxSize = (size_t) std::numeric_limits<uint32_t>::max();
+  if (numRows / rowBlocks >= maxSize || numCols / colBlocks >= maxSize)
+  {
+    Log::Fatal << "BlockedMatrix::BlockedMatrix(): the blocks are too large; "
+        << "use more blocks." << std::endl;
+  }
+
+  blockNonZeros.zeros(rowBlocks, colBlocks);
+  buffers.clear();
+  buffers.resize(rowBlocks * colBlocks);
+
+  // Truncate the block files.
+  for (size_t j = 0; j < colBlocks; ++j)
+  {
+    for (size_t i = 0; i < rowBlocks; ++i)
+    {
+      std::ofstream file(BlockFile(i, j).c_str(),
+          std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!file.is_open())
+      {
+        Log::Fatal << "BlockedMatrix::BlockedMatrix(): cannot create '"
+            << BlockFile(i, j) << "'." << std::endl;
+      }
+    }
+  }
+
+  WriteMetadata();
+}
+
+void BlockedMatrix::Insert(const arma::mat& triples)
+{
+  if (triples.n_rows != 3)
+  {
+    Log::Fatal << "BlockedMatrix::Insert(): the values should be a coordinate "
+        << "list with 3 rows (" << triples.n_rows << " given)." << std::endl;
+  }
+
+  for (size_t k = 0; k < triples.n_cols; ++k)
+  {
+    const size_t row = (size_t) triples(0, k);
+    const size_t col = (size_t) triples(1, k);
+    if (row >= numRows || col >= numCols)
+    {
+      Log::Fatal << "BlockedMatrix::Insert(): location (" << row << ", " << col
+          << ") is outside of the " << numRows << " x " << numCols
+          << " matrix." << std::endl;
+    }
+
+    if (triples(2, k) == 0.0)
+      continue;
+
+    const size_t i = RowBlock(row);
+    const size_t j = ColBlock(col);
+
+    Entry entry;
+    entry.row = (uint32_t) (row - RowBlockBegin(i));
+    entry.col = (uint32_t) (col - ColBlockBegin(j));
+    entry.value = triples(2, k);
+
+    std::vector<Entry>& buffer = buffers[i + j * rowBlocks];
+    buffer.push_back(entry);
+    ++blockNonZeros(i, j);
+    if (buffer.size() >= bufferSize)
+      FlushBlock(i, j);
+  }
+}
+
+void BlockedMatrix::Flush()
+{
+  bool buffered = false;
+  for (size_t j = 0; j < colBlocks; ++j)
+  {
+    for (size_t i = 0; i < rowBlocks; ++i)
+    {
+      if (!buffers[i + j * rowBlocks].empty())
+      {
+        buffered = true;
+        FlushBlock(i, j);
+      }
+    }
+  }
+
+  if (buffered)
+    WriteMetadata();
+}
+
+void BlockedMatrix::FlushBlock(const size_t i, const size_t j)
+{
+  std::vector<Entry>& buffer = buffers[i + j * rowBlocks];
+
+  std::ofstream file(BlockFile(i, j).c_str(),
+      std::ios::out | std::ios::binary | std::ios::app);
+  file.write((const char*) &buffer[0], buffer.size() * sizeof(Entry));
+  if (!file.good())
+  {
+    Log::Fatal << "BlockedMatrix::Flush(): cannot write to '"
+        << BlockFile(i, j) << "'." << std::endl;
+  }
+
+  buffer.clear();
+}
+
+void BlockedMatrix::LoadBlock(const size_t i,
+                              const size_t j,
+                              arma::umat& locations,
+                              arma::vec& values) const
+{
+  Log::Assert(i < rowBlocks && j < colBlocks);
+
+  std::ifstream file(BlockFile(i, j).c_str(),
+      std::ios::in | std::ios::binary | std::ios::ate);
+  if (!file.is_open())
+  {
+    Log::Fatal << "BlockedMatrix::LoadBlock(): cannot open '"
+        << BlockFile(i, j) << "'." << std::endl;
+  }
+
+  // Only the values written so far are in the file.
+  const size_t numValues = (size_t) file.tellg() / sizeof(Entry);
+  if (numValues != blockNonZeros(i, j))
+  {
+    Log::Warn << "BlockedMatrix::LoadBlock(): " << blockNonZeros(i, j)
+        << " values expected in '" << BlockFile(i, j) << "', but "
+        << numValues << " found; call Flush() after Insert()." << std::endl;
+  }
+
+  std::vector<Entry> entries(numValues);
+  file.seekg(0, std::ios::beg);
+  if (numValues > 0)
+    file.read((char*) &entries[0], numValues * sizeof(Entry));
+  if (!file.good())
+  {
+    Log::Fatal << "BlockedMatrix::LoadBlock(): cannot read '"
+        << BlockFile(i, j) << "'." << std::endl;
+  }
+
+  locations.set_size(2, numValues);
+  values.set_size(numValues);
+  for (size_t k = 0; k < numValues; ++k)
+  {
+    locations(0, k) = entries[k].row;
+    locations(1, k) = entries[k].col;
+    values[k] = entries[k].value;
+  }
+}
+
+void BlockedMatrix::LoadW(const size_t i, arma::mat& w) const
+{
+  if (!w.load(WFile(i), arma::arma_binary))
+  {
+    Log::Fatal << "BlockedMatrix::LoadW(): cannot read '" << WFile(i) << "'."
+        << std::endl;
+  }
+}
+
+void BlockedMatrix::SaveW(const size_t i, const arma::mat& w) const
+{
+  Log::Assert(w.n_rows == RowBlockSize(i));
+  if (!w.save(WFile(i), arma::arma_binary))
+  {
+    Log::Fatal << "BlockedMatrix::SaveW(): cannot write '" << WFile(i) << "'."
+        << std::endl;
+  }
+}
+
+void BlockedMatrix::LoadH(const size_t j, arma::mat& h) const
+{
+  if (!h.load(HFile(j), arma::arma_binary))
+  {
+    Log::Fatal << "BlockedMatrix::LoadH(): cannot read '" << HFile(j) << "'."
+        << std::endl;
+  }
+}
+
+void BlockedMatrix::SaveH(const size_t j, const arma::mat& h) const
+{
+  Log::Assert(h.n_cols == ColBlockSize(j));
+  if (!h.save(HFile(j), arma::arma_binary))
+  {
+    Log::Fatal << "BlockedMatrix::SaveH(): cannot write '" << HFile(j) << "'."
+        << std::endl;
+  }
+}
+
+void BlockedMatrix::LoadFactors(arma::mat& w, arma::mat& h) const
+{
+  arma::mat slice;
+  for (size_t i = 0; i < rowBlocks; ++i)
+  {
+    LoadW(i, slice);
+    if (i == 0)
+      w.set_size(numRows, slice.n_cols);
+    w.rows(RowBlockBegin(i), RowBlockBegin(i + 1) - 1) = slice;
+  }
+
+  for (size_t j = 0; j < colBlocks; ++j)
+  {
+    LoadH(j, slice);
+    if (j == 0)
+      h.set_size(slice.n_rows, numCols);
+    h.cols(ColBlockBegin(j), ColBlockBegin(j + 1) - 1) = slice;
+  }
+}
+
+void BlockedMatrix::Remove()
+{
+  for (size_t j = 0; j < colBlocks; ++j)
+  {
+    for (size_t i = 0; i < rowBlocks; ++i)
+    {
+      buffers[i + j * rowBlocks].clear();
+      std::remove(BlockFile(i, j).c_str());
+    }
+  }
+
+  // The factors may not have been computed.
+  for (size_t i = 0; i < rowBlocks; ++i)
+    std::remove(WFile(i).c_str());
+  for (size_t j = 0; j < colBlocks; ++j)
+    std::remove(HFile(j).c_str());
+
+  std::remove(MetadataFile().c_str());
+  blockNonZeros.zeros();
+}
+
+void BlockedMatrix::ReadMetadata()
+{
+  std::ifstream file(MetadataFile().c_str());
+  if (!file.is_open())
+  {
+    Log::Fatal << "BlockedMatrix::BlockedMatrix(): cannot open '"
+        << MetadataFile() << "'." << std::endl;
+  }
+
+  file >> numRows >> numCols >> rowBlocks >> colBlocks;
+  blockNonZeros.set_size(rowBlocks, colBlocks);
+  for (size_t j = 0; j < colBlocks; ++j)
+    for (size_t i = 0; i < rowBlocks; ++i)
+      file >> blockNonZeros(i, j);
+
+  if (file.fail())
+  {
+    Log::Fatal << "BlockedMatrix::BlockedMatrix(): '" << MetadataFile()
+        << "' is malformed." << std::endl;
+  }
+}
+
+void BlockedMatrix::WriteMetadata() const
+{
+  std::ofstream file(MetadataFile().c_str());
+  file << numRows << " " << numCols << " " << rowBlocks << " " << colBlocks
+      << std::endl;
+  for (size_t j = 0; j < colBlocks; ++j)
+    for (size_t i = 0; i < rowBlocks; ++i)
+      file << blockNonZeros(i, j) << std::endl;
+
+  if (!file.good())
+  {
+    Log::Fatal << "BlockedMatrix: cannot write '" << MetadataFile() << "'."
+        << std::endl;
+  }
+}
+
+size_t BlockedMatrix::RowBlock(const size_t row) const
+{
+  return (row * rowBlocks) / numRows;
+}
+
+size_t BlockedMatrix::ColBlock(const size_t col) const
+{
+  return (col * colBlocks) / numCols;
+}
+
+std::string BlockedMatrix::BlockFile(const size_t i, const size_t j) const
+{
+  std::ostringstream name;
+  name << prefix << "block_" << i << "_" << j << ".bin";
+  return name.str();
+}
+
+std::string BlockedMatrix::WFile(const size_t i) const
+{
+  std::ostringstream name;
+  name << prefix << "w_" << i << ".bin";
+  return name.str();
+}
+
+std::string BlockedMatrix::HFile(const size_t j) const
+{
+  std::ostringstream name;
+  name << prefix << "h_" << j << ".bin";
+  return name.str();
+}
+
+std::string BlockedMatrix::MetadataFile() const
+{
+  return prefix + "metadata.txt";
+}
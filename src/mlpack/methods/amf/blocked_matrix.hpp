@@ -0,0 +1,237 @@
+/**
+ * @file blocked_matrix.hpp
+ * @author Ryan Curtin
+ *
+ * A sparse matrix stored on disk in blocks, along with the slices of its
+ * factors, for out-of-core matrix factorization.
+ */
+#ifndef __MLPACK_METHODS_AMF_BLOCKED_MATRIX_HPP
+#define __MLPACK_METHODS_AMF_BLOCKED_MATRIX_HPP
+
+#include <mlpack/core.hpp>
+#include <stdint.h>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * A sparse n x m matrix V that is partitioned into a grid of row and column
+ * blocks, each stored in its own file, so that matrices with far more nonzero
+ * values than fit in memory can be factorized with BlockedAMF.  Block (i, j)
+ * holds the nonzero values of the rows of row block i and the columns of
+ * column block j, as (row, column, value) records with indices relative to the
+ * block.  Row u is in row block floor(u p / n) of p, and column v in column
+ * block floor(v q / m) of q, as in SVDParallelIncrementalLearning, so the rows
+ * (and the columns) are divided as evenly as possible among the blocks.
+ *
+ * The files also hold the slices of the factors W (n x r) and H (r x m) of the
+ * matrix: row block i of W and column block j of H are all that is needed to
+ * work on block (i, j) of V, so a factorization only has to keep a few blocks
+ * and slices in memory at once.
+ *
+ * All files are named by appending to the given prefix (for instance
+ * "/data/ratings/" or "ratings_"), which may contain a directory that must
+ * already exist.  A metadata file records the size and the partition of the
+ * matrix, so a partitioned matrix can be opened again by another program.
+ *
+ * @code
+ * // Partition a coordinate list that doesn't fit in memory.
+ * BlockedMatrix V("interactions.csv", "/data/blocks/", 100, 100);
+ *
+ * BlockedAMF<BlockedALSUpdate> amf;
+ * amf.Apply(V, 50);
+ *
+ * arma::mat w;
+ * V.LoadW(0, w); // The rows of W of the first row block.
+ * @endcode
+ *
+ * @see BlockedAMF
+ */
+class BlockedMatrix
+{
+ public:
+  /**
+   * Create an empty matrix of the given size, with the given number of row and
+   * column blocks.  Existing block files with the same prefix are truncated.
+   * Nonzero values are added with Insert(), and are written to disk when the
+   * buffer of their block fills up or when Flush() is called.
+   *
+   * @param prefix Prefix of the names of the files.
+   * @param numRows Number of rows of the matrix.
+   * @param numCols Number of columns of the matrix.
+   * @param rowBlocks Number of row blocks.
+   * @param colBlocks Number of column blocks.
+   */
+  BlockedMatrix(const std::string& prefix,
+                const size_t numRows,
+                const size_t numCols,
+                const size_t rowBlocks,
+                const size_t colBlocks);
+
+  /**
+   * Partition the coordinate list in the given file, which is read in chunks
+   * with data::ChunkedLoader and never held in memory at once.  Each point of
+   * the file is a (row, column, value) triple, and the size of the matrix is
+   * given by the largest row and column indices, so the file is read twice.
+   *
+   * @param coordinateFile File holding the coordinate list.
+   * @param prefix Prefix of the names of the files.
+   * @param rowBlocks Number of row blocks.
+   * @param colBlocks Number of column blocks.
+   * @param chunkSize Number of triples read at a time.
+   */
+  BlockedMatrix(const std::string& coordinateFile,
+                const std::string& prefix,
+                const size_t rowBlocks,
+                const size_t colBlocks,
+                const size_t chunkSize = 1000000);
+
+  /**
+   * Open a matrix that was partitioned before, from the metadata file with the
+   * given prefix.
+   *
+   * @param prefix Prefix of the names of the files.
+   */
+  BlockedMatrix(const std::string& prefix);
+
+  //! Write the buffered values to disk.
+  ~BlockedMatrix();
+
+  /**
+   * Add the nonzero values of the given coordinate list (a 3-row matrix of
+   * (row, column, value) triples) to the matrix.  Every entry should be given
+   * only once.
+   *
+   * @param triples Coordinate list of nonzero values.
+   */
+  void Insert(const arma::mat& triples);
+
+  //! Write the buffered values and the metadata to disk.
+  void Flush();
+
+  /**
+   * Read block (i, j) of the matrix.  The locations (row and column, relative
+   * to the block) of the nonzero values are stored as the columns of a 2-row
+   * matrix, as for the batch constructor of arma::sp_mat.
+   *
+   * @param i Row block.
+   * @param j Column block.
+   * @param locations Matrix to store the locations of the values in.
+   * @param values Vector to store the values in.
+   */
+  void LoadBlock(const size_t i,
+                 const size_t j,
+                 arma::umat& locations,
+                 arma::vec& values) const;
+
+  //! Read the rows of W of the given row block.
+  void LoadW(const size_t i, arma::mat& w) const;
+  //! Write the rows of W of the given row block.
+  void SaveW(const size_t i, const arma::mat& w) const;
+  //! Read the columns of H of the given column block.
+  void LoadH(const size_t j, arma::mat& h) const;
+  //! Write the columns of H of the given column block.
+  void SaveH(const size_t j, const arma::mat& h) const;
+
+  /**
+   * Assemble the whole factors from their slices on disk.  This is only
+   * possible if they fit in memory.
+   *
+   * @param w Matrix to store W in.
+   * @param h Matrix to store H in.
+   */
+  void LoadFactors(arma::mat& w, arma::mat& h) const;
+
+  //! Delete all the files of the matrix.
+  void Remove();
+
+  //! Get the number of rows of the matrix.
+  size_t NumRows() const { return numRows; }
+  //! Get the number of columns of the matrix.
+  size_t NumCols() const { return numCols; }
+  //! Get the number of row blocks.
+  size_t RowBlocks() const { return rowBlocks; }
+  //! Get the number of column blocks.
+  size_t ColBlocks() const { return colBlocks; }
+  //! Get the number of nonzero values of the matrix.
+  size_t NonZeros() const { return arma::accu(blockNonZeros); }
+  //! Get the number of nonzero values of block (i, j).
+  size_t NonZeros(const size_t i, const size_t j) const
+  { return blockNonZeros(i, j); }
+
+  //! Get the first row of the given row block.
+  size_t RowBlockBegin(const size_t i) const
+  { return (i * numRows + rowBlocks - 1) / rowBlocks; }
+  //! Get the number of rows of the given row block.
+  size_t RowBlockSize(const size_t i) const
+  { return RowBlockBegin(i + 1) - RowBlockBegin(i); }
+  //! Get the first column of the given column block.
+  size_t ColBlockBegin(const size_t j) const
+  { return (j * numCols + colBlocks - 1) / colBlocks; }
+  //! Get the number of columns of the given column block.
+  size_t ColBlockSize(const size_t j) const
+  { return ColBlockBegin(j + 1) - ColBlockBegin(j); }
+
+  //! Get the prefix of the names of the files.
+  const std::string& Prefix() const { return prefix; }
+
+ private:
+  //! A nonzero value, with its indices relative to its block.
+  struct Entry
+  {
+    uint32_t row;
+    uint32_t col;
+    double value;
+  };
+
+  //! Values buffered for each block before they are written.
+  static const size_t bufferSize = 65536;
+
+  //! Prefix of the names of the files.
+  std::string prefix;
+  //! Number of rows of the matrix.
+  size_t numRows;
+  //! Number of columns of the matrix.
+  size_t numCols;
+  //! Number of row blocks.
+  size_t rowBlocks;
+  //! Number of column blocks.
+  size_t colBlocks;
+  //! Number of nonzero values of every block (written or buffered).
+  arma::Mat<size_t> blockNonZeros;
+  //! Buffered values of every block (indexed by i + j * rowBlocks).
+  std::vector<std::vector<Entry> > buffers;
+
+  //! Create the empty block files and the buffers.
+  void Create();
+  //! Append the buffered values of block (i, j) to its file.
+  void FlushBlock(const size_t i, const size_t j);
+  //! Read the metadata file.
+  void ReadMetadata();
+  //! Write the metadata file.
+  void WriteMetadata() const;
+
+  //! Return the row block of the given row.
+  size_t RowBlock(const size_t row) const;
+  //! Return the column block of the given column.
+  size_t ColBlock(const size_t col) const;
+
+  //! Return the name of the file of block (i, j).
+  std::string BlockFile(const size_t i, const size_t j) const;
+  //! Return the name of the file of row block i of W.
+  std::string WFile(const size_t i) const;
+  //! Return the name of the file of column block j of H.
+  std::string HFile(const size_t j) const;
+  //! Return the name of the metadata file.
+  std::string MetadataFile() const;
+
+  //! A copy would write the buffered values twice, so copies aren't allowed.
+  BlockedMatrix(const BlockedMatrix& other);
+  //! A copy would write the buffered values twice, so copies aren't allowed.
+  BlockedMatrix& operator=(const BlockedMatrix& other);
+};
+
+}; // namespace amf
+}; // namespace mlpack
+
+#endif
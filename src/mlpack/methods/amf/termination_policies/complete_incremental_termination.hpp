@@ -99,6 +99,12 @@ class CompleteIncrementalTermination
   //! Modify the wrapped termination policy.
   TerminationPolicy& TPolicy() { return tPolicy; }
 
+  //! Return the number of bytes used by this policy and the wrapped one.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(tPolicy) + util::ObjectMemoryUsage(tPolicy);
+  }
+
  private:
   //! Wrapped termination policy.
   TerminationPolicy tPolicy;
@@ -0,0 +1,176 @@
+/**
+ * @file sampled_residue_termination.hpp
+ * @author Sumedh Ghaisas
+ *
+ * Termination policy used in AMF (Alternating Matrix Factorization).
+ */
+#ifndef _MLPACK_METHODS_AMF_SAMPLED_RESIDUE_TERMINATION_HPP_INCLUDED
+#define _MLPACK_METHODS_AMF_SAMPLED_RESIDUE_TERMINATION_HPP_INCLUDED
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements a residue-based termination policy like
+ * SimpleResidueTermination, but the residue is estimated from a fixed random
+ * sample of the entries of WH, instead of from all of WH.  The sample is chosen
+ * (with replacement) when the policy is initialized, and each time the policy
+ * is evaluated, the residue is the relative change of the sampled entries since
+ * the last evaluation:
+ *
+ * residue = || s - s_old || / || s_old ||
+ *
+ * where s holds the sampled entries of WH.  Each entry is computed on its own
+ * from a row of W and a column of H, so an evaluation costs O(numSamples * r)
+ * time instead of the O(n * m * r) time needed to compute WH.
+ *
+ * The policy can also be evaluated only every evaluationInterval iterations;
+ * on the other iterations, only the iteration limit is checked.  The
+ * factorization terminates when the residue drops below the threshold, or
+ * when the number of iterations goes above the iteration limit.
+ *
+ * @see AMF, SimpleResidueTermination
+ */
+class SampledResidueTermination
+{
+ public:
+  /**
+   * Construct the SampledResidueTermination object with the given minimum
+   * residue, maximum number of iterations (0 indicates no iteration limit),
+   * sample size, and evaluation interval.
+   *
+   * @param minResidue Minimum residue for termination.
+   * @param maxIterations Maximum number of iterations.
+   * @param numSamples Number of entries of WH to sample.
+   * @param evaluationInterval Number of iterations between evaluations.
+   */
+  SampledResidueTermination(const double minResidue = 1e-5,
+                            const size_t maxIterations = 10000,
+                            const size_t numSamples = 1000,
+                            const size_t evaluationInterval = 1)
+      : minResidue(minResidue),
+        maxIterations(maxIterations),
+        numSamples(numSamples),
+        evaluationInterval(evaluationInterval)
+  {
+    if (numSamples == 0)
+      Log::Fatal << "SampledResidueTermination: numSamples must be positive."
+          << std::endl;
+    if (evaluationInterval == 0)
+      Log::Fatal << "SampledResidueTermination: evaluationInterval must be "
+          << "positive." << std::endl;
+  }
+
+  /**
+   * Initializes the termination policy before stating the factorization, and
+   * chooses the entries to sample.
+   *
+   * @param V Input matrix being factorized.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& V)
+  {
+    residue = DBL_MAX;
+    iteration = 1;
+
+    sampleRows.set_size(numSamples);
+    sampleCols.set_size(numSamples);
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      sampleRows[i] = math::RandInt(V.n_rows);
+      sampleCols[i] = math::RandInt(V.n_cols);
+    }
+
+    // Remove history.
+    samplesOld.reset();
+  }
+
+  /**
+   * Check if termination criterion is met.
+   *
+   * @param W Basis matrix of output.
+   * @param H Encoding matrix of output.
+   */
+  bool IsConverged(arma::mat& W, arma::mat& H)
+  {
+    if ((iteration - 1) % evaluationInterval == 0)
+    {
+      arma::vec samples(numSamples);
+      for (size_t i = 0; i < numSamples; ++i)
+        samples[i] = arma::as_scalar(W.row(sampleRows[i]) *
+            H.col(sampleCols[i]));
+
+      if (samplesOld.n_elem == numSamples)
+        residue = arma::norm(samples - samplesOld, 2) /
+            arma::norm(samplesOld, 2);
+
+      samplesOld = std::move(samples);
+      Log::Info << "Iteration " << iteration << "; sampled residue "
+          << residue << ".\n";
+    }
+
+    // Increment iteration count.
+    iteration++;
+
+    // Check if termination criterion is met.
+    return (residue < minResidue ||
+        (maxIterations != 0 && iteration > maxIterations));
+  }
+
+  //! Get current value of residue.
+  const double& Index() const { return residue; }
+
+  //! Get current iteration count.
+  const size_t& Iteration() const { return iteration; }
+
+  //! Access max iteration count.
+  const size_t& MaxIterations() const { return maxIterations; }
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Access minimum residue value.
+  const double& MinResidue() const { return minResidue; }
+  double& MinResidue() { return minResidue; }
+
+  //! Get the number of sampled entries.
+  size_t NumSamples() const { return numSamples; }
+
+  //! Get the number of iterations between evaluations.
+  size_t EvaluationInterval() const { return evaluationInterval; }
+
+  //! Return the number of bytes used by the policy, including the sample.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(sampleRows) - sizeof(sampleCols) -
+        sizeof(samplesOld) + util::MemoryUsage(sampleRows) +
+        util::MemoryUsage(sampleCols) + util::MemoryUsage(samplesOld);
+  }
+
+ private:
+  //! Residue threshold.
+  double minResidue;
+  //! Iteration threshold.
+  size_t maxIterations;
+  //! Number of sampled entries.
+  size_t numSamples;
+  //! Number of iterations between evaluations.
+  size_t evaluationInterval;
+
+  //! Current value of residue.
+  double residue;
+  //! Current iteration count.
+  size_t iteration;
+
+  //! Rows of the sampled entries.
+  arma::Col<size_t> sampleRows;
+  //! Columns of the sampled entries.
+  arma::Col<size_t> sampleCols;
+  //! Sampled entries of WH at the last evaluation.
+  arma::vec samplesOld;
+}; // class SampledResidueTermination
+
+}; // namespace amf
+}; // namespace mlpack
+
+#endif // _MLPACK_METHODS_AMF_SAMPLED_RESIDUE_TERMINATION_HPP_INCLUDED
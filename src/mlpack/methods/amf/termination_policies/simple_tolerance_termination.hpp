@@ -152,6 +152,13 @@ class SimpleToleranceTermination
   const double& Tolerance() const { return tolerance; }
   double& Tolerance() { return tolerance; }
 
+  //! Return the number of bytes used by the policy, including the stored W and H.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(W) - sizeof(H) + util::MemoryUsage(W) +
+        util::MemoryUsage(H);
+  }
+
  private:
   //! tolerance
   double tolerance;
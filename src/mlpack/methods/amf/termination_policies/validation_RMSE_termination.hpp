@@ -24,6 +24,11 @@ namespace amf
  * with reverseStepCount. Secondary termination criterion terminates algorithm
  * when iteration count goes above the threshold.
  *
+ * Each validation prediction is computed on its own from a row of W and a
+ * column of H, so WH is never formed.  The validation RMSE can also be
+ * computed only every evaluationInterval iterations; on the other iterations,
+ * only the iteration limit is checked.
+ *
  * @note The input matrix is modified by this termination policy.
  *
  * @see AMF
@@ -40,17 +45,24 @@ class ValidationRMSETermination
    * @param num_test_points number of validation test points
    * @param maxIterations max iteration count before termination
    * @param reverseStepTolerance max successive RMSE drops allowed
+   * @param evaluationInterval number of iterations between RMSE evaluations
    */
   ValidationRMSETermination(MatType& V,
                             size_t num_test_points,
                             double tolerance = 1e-5,
                             size_t maxIterations = 10000,
-                            size_t reverseStepTolerance = 3)
+                            size_t reverseStepTolerance = 3,
+                            size_t evaluationInterval = 1)
         : tolerance(tolerance),
           maxIterations(maxIterations),
           num_test_points(num_test_points),
-          reverseStepTolerance(reverseStepTolerance)
+          reverseStepTolerance(reverseStepTolerance),
+          evaluationInterval(evaluationInterval)
   {
+    if (evaluationInterval == 0)
+      Log::Fatal << "ValidationRMSETermination: evaluationInterval must be "
+          << "positive." << std::endl;
+
     size_t n = V.n_rows;
     size_t m = V.n_cols;
 
@@ -108,12 +120,10 @@ class ValidationRMSETermination
    */
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
-    arma::mat WH;
+    const bool evaluate = ((iteration - 1) % evaluationInterval == 0);
 
-    WH = W * H;
-
-    // compute validation RMSE
-    if (iteration != 0)
+    // compute validation RMSE, one prediction at a time
+    if (evaluate)
     {
       rmseOld = rmse;
       rmse = 0;
@@ -122,7 +132,7 @@ class ValidationRMSETermination
         size_t t_row = test_points(i, 0);
         size_t t_col = test_points(i, 1);
         double t_val = test_points(i, 2);
-        double temp = (t_val - WH(t_row, t_col));
+        double temp = (t_val - arma::as_scalar(W.row(t_row) * H.col(t_col)));
         temp *= temp;
         rmse += temp;
       }
@@ -133,8 +143,9 @@ class ValidationRMSETermination
     // increment iteration count
     iteration++;
 
-    // if RMSE tolerance is not satisfied
-    if((rmseOld - rmse) / rmseOld < tolerance && iteration > 4)
+    // if RMSE tolerance is not satisfied (if RMSE was not evaluated, only the
+    // iteration limit is checked)
+    if(evaluate && (rmseOld - rmse) / rmseOld < tolerance && iteration > 4)
     {
       // check if this is a first of successive drops
       if(reverseStepCount == 0 && isCopy == false)
@@ -151,7 +162,7 @@ class ValidationRMSETermination
       reverseStepCount++;
     }
     // if tolerance is satisfied
-    else
+    else if(evaluate)
     {
       // initialize successive drop count
       reverseStepCount = 0;
@@ -195,6 +206,17 @@ class ValidationRMSETermination
   const double& Tolerance() const { return tolerance; }
   double& Tolerance() { return tolerance; }
 
+  //! Get number of iterations between RMSE evaluations
+  size_t EvaluationInterval() const { return evaluationInterval; }
+
+  //! Return the number of bytes used by the policy, including the test points.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(test_points) - sizeof(W) - sizeof(H) +
+        util::MemoryUsage(test_points) + util::MemoryUsage(W) +
+        util::MemoryUsage(H);
+  }
+
  private:
   //! tolerance
   double tolerance;
@@ -217,6 +239,8 @@ class ValidationRMSETermination
   size_t reverseStepTolerance;
   //! successive residue drops
   size_t reverseStepCount;
+  //! number of iterations between RMSE evaluations
+  size_t evaluationInterval;
 
   //! indicates whether a copy of information is available which corresponds to
   //! minimum residue point
@@ -0,0 +1,159 @@
+/**
+ * @file blocked_als_update.hpp
+ * @author Ryan Curtin
+ *
+ * Alternating least squares over the blocks of a BlockedMatrix.
+ */
+#ifndef __MLPACK_METHODS_AMF_UPDATE_RULES_BLOCKED_ALS_UPDATE_HPP
+#define __MLPACK_METHODS_AMF_UPDATE_RULES_BLOCKED_ALS_UPDATE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/amf/blocked_matrix.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * Regularized alternating least squares over the nonzero values of a
+ * BlockedMatrix, for use with BlockedAMF.  Every row w_u of W is the solution
+ * of
+ *
+ * \f[ \min_{w_u} \sum_{v : V_{uv} \neq 0} (V_{uv} - w_u h_v)^2 +
+ *     \lambda || w_u ||^2, \f]
+ *
+ * and then every column of H is solved for in the same way.  The zeros of V
+ * are treated as missing values, as is usual for rating matrices.
+ *
+ * The rows of W are solved one row block at a time: the blocks of the row
+ * block are streamed from disk along with the matching slices of H, and the
+ * r x r normal equations of every row are accumulated, in parallel over the
+ * rows.  So the memory needed is that of one block of V, one slice of H, and
+ * RowBlockSize() normal equations; the row and column blocks should be small
+ * enough that these fit in memory.  The columns of H are solved the same way.
+ */
+class BlockedALSUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given regularization parameter.
+   *
+   * @param lambda Regularization parameter (should be positive).
+   */
+  BlockedALSUpdate(const double lambda = 0.01) : lambda(lambda) { }
+
+  /**
+   * Solve for W with H fixed, and then for H with W fixed.  The slices of the
+   * factors are read from and written to the files of the matrix.
+   *
+   * @param V Blocked matrix to be factorized.
+   */
+  void Update(const BlockedMatrix& V)
+  {
+    arma::mat w, h, factors;
+    arma::umat locations;
+    arma::vec values;
+
+    for (size_t i = 0; i < V.RowBlocks(); ++i)
+    {
+      V.LoadW(i, w);
+      Reset(w.n_cols, w.n_rows);
+      for (size_t j = 0; j < V.ColBlocks(); ++j)
+      {
+        V.LoadH(j, h);
+        V.LoadBlock(i, j, locations, values);
+        Accumulate(locations.row(0), locations.row(1), values, h);
+      }
+
+      Solve(factors);
+      V.SaveW(i, factors.t());
+    }
+
+    for (size_t j = 0; j < V.ColBlocks(); ++j)
+    {
+      V.LoadH(j, h);
+      Reset(h.n_rows, h.n_cols);
+      for (size_t i = 0; i < V.RowBlocks(); ++i)
+      {
+        V.LoadW(i, w);
+        V.LoadBlock(i, j, locations, values);
+        Accumulate(locations.row(1), locations.row(0), values, w.t());
+      }
+
+      Solve(factors);
+      V.SaveH(j, factors);
+    }
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+ private:
+  //! Regularization parameter.
+  double lambda;
+
+  //! Normal equations of every row (or column) being solved for.
+  arma::cube grams;
+  //! Right-hand sides of the normal equations, one per column.
+  arma::mat rhs;
+
+  //! Start the normal equations of the given number of rows (or columns).
+  void Reset(const size_t rank, const size_t count)
+  {
+    grams.set_size(rank, rank, count);
+    for (size_t t = 0; t < count; ++t)
+      grams.slice(t) = lambda * arma::eye<arma::mat>(rank, rank);
+    rhs.zeros(rank, count);
+  }
+
+  /**
+   * Add the values of a block to the normal equations.  Value k lies in row
+   * (or column) targets[k] of the factor being solved for, and sources[k] is
+   * the column of 'fixed' that multiplies it.
+   */
+  void Accumulate(const arma::urowvec& targets,
+                  const arma::urowvec& sources,
+                  const arma::vec& values,
+                  const arma::mat& fixed)
+  {
+    // Group the values by target with a counting sort, so that the targets can
+    // be accumulated in parallel.
+    arma::uvec starts(rhs.n_cols + 1, arma::fill::zeros);
+    for (size_t k = 0; k < targets.n_elem; ++k)
+      ++starts[targets[k] + 1];
+    for (size_t t = 1; t < starts.n_elem; ++t)
+      starts[t] += starts[t - 1];
+
+    arma::uvec order(targets.n_elem);
+    arma::uvec position = starts.subvec(0, rhs.n_cols - 1);
+    for (size_t k = 0; k < targets.n_elem; ++k)
+      order[position[targets[k]]++] = k;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t t = 0; t < rhs.n_cols; ++t)
+    {
+      for (size_t k = starts[t]; k < starts[t + 1]; ++k)
+      {
+        const arma::vec factor = fixed.unsafe_col(sources[order[k]]);
+        grams.slice(t) += factor * factor.t();
+        rhs.col(t) += values[order[k]] * factor;
+      }
+    }
+  }
+
+  //! Solve the normal equations; column t of the result is row (or column) t.
+  void Solve(arma::mat& factors)
+  {
+    factors.set_size(rhs.n_rows, rhs.n_cols);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t t = 0; t < rhs.n_cols; ++t)
+      factors.col(t) = arma::solve(grams.slice(t), rhs.col(t));
+  }
+}; // class BlockedALSUpdate
+
+}; // namespace amf
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file blocked_sgd_update.hpp
+ * @author Ryan Curtin
+ *
+ * Stratified stochastic gradient descent over the blocks of a BlockedMatrix.
+ */
+#ifndef __MLPACK_METHODS_AMF_UPDATE_RULES_BLOCKED_SGD_UPDATE_HPP
+#define __MLPACK_METHODS_AMF_UPDATE_RULES_BLOCKED_SGD_UPDATE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/amf/blocked_matrix.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * Stochastic gradient descent over the nonzero values of a BlockedMatrix, for
+ * use with BlockedAMF.  This is the out-of-core counterpart of
+ * SVDParallelIncrementalLearning: every nonzero value of V updates its row of
+ * W and its column of H immediately, with the same step, and the blocks are
+ * visited in strata of blocks that share no row block and no column block, as
+ * in distributed SGD (Gemulla et al., 2011).
+ *
+ * For a p x q grid of blocks with p <= q, an epoch consists of q strata, and
+ * stratum s holds the blocks (i, (i + s) mod q); the roles of the rows and the
+ * columns are swapped if p > q.  The blocks of a stratum are processed in
+ * parallel, each by a thread that reads the block and the slices of W and H it
+ * needs from disk, and writes the slices back when it is done.  So the memory
+ * needed is that of one block of V and one slice of W and of H per thread.
+ */
+class BlockedSGDUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given parameters.
+   *
+   * @param u Step size.
+   * @param kw Regularization constant for W matrix.
+   * @param kh Regularization constant for H matrix.
+   */
+  BlockedSGDUpdate(const double u = 0.001,
+                   const double kw = 0,
+                   const double kh = 0) :
+      u(u), kw(kw), kh(kh)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Perform an epoch of stochastic gradient descent.  The slices of the
+   * factors are read from and written to the files of the matrix.
+   *
+   * @param V Blocked matrix to be factorized.
+   */
+  void Update(const BlockedMatrix& V)
+  {
+    const bool byRows = (V.RowBlocks() <= V.ColBlocks());
+    const size_t strata = std::max(V.RowBlocks(), V.ColBlocks());
+    const size_t width = std::min(V.RowBlocks(), V.ColBlocks());
+
+    for (size_t s = 0; s < strata; ++s)
+    {
+      #pragma omp parallel for schedule(dynamic)
+      for (size_t b = 0; b < width; ++b)
+      {
+        if (byRows)
+          Block(V, b, (b + s) % strata);
+        else
+          Block(V, (b + s) % strata, b);
+      }
+    }
+  }
+
+  //! Get the step size.
+  double StepSize() const { return u; }
+  //! Modify the step size.
+  double& StepSize() { return u; }
+
+  //! Get the regularization constant for W.
+  double KW() const { return kw; }
+  //! Modify the regularization constant for W.
+  double& KW() { return kw; }
+
+  //! Get the regularization constant for H.
+  double KH() const { return kh; }
+  //! Modify the regularization constant for H.
+  double& KH() { return kh; }
+
+ private:
+  //! Step size of the algorithm.
+  double u;
+  //! Regularization parameter for matrix W.
+  double kw;
+  //! Regularization parameter for matrix H.
+  double kh;
+
+  //! Perform the gradient steps of all the values of block (i, j).
+  void Block(const BlockedMatrix& V, const size_t i, const size_t j) const
+  {
+    arma::mat w, h;
+    arma::umat locations;
+    arma::vec values;
+    V.LoadW(i, w);
+    V.LoadH(j, h);
+    V.LoadBlock(i, j, locations, values);
+
+    // Work on the transpose of W, so that its rows are contiguous.
+    arma::mat wt = w.t();
+    for (size_t k = 0; k < values.n_elem; ++k)
+    {
+      double* wCol = wt.colptr(locations(0, k));
+      double* hCol = h.colptr(locations(1, k));
+
+      double error = values[k];
+      for (size_t d = 0; d < wt.n_rows; ++d)
+        error -= wCol[d] * hCol[d];
+
+      for (size_t d = 0; d < wt.n_rows; ++d)
+      {
+        const double wValue = wCol[d];
+        wCol[d] += u * (error * hCol[d] - kw * wValue);
+        hCol[d] += u * (error * wValue - kh * hCol[d]);
+      }
+    }
+
+    V.SaveW(i, wt.t());
+    V.SaveH(j, h);
+  }
+}; // class BlockedSGDUpdate
+
+}; // namespace amf
+}; // namespace mlpack
+
+#endif
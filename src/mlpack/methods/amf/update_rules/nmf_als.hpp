@@ -64,22 +64,18 @@ class NMFALSUpdate
    * @param H Encoding matrix.
    */
   template<typename MatType>
-  inline static void WUpdate(const MatType& V,
-                             arma::mat& W,
-                             const arma::mat& H)
+  inline void WUpdate(const MatType& V,
+                      arma::mat& W,
+                      const arma::mat& H)
   {
     // The call to inv() sometimes fails; so we are using the psuedoinverse.
     // W = (inv(H * H.t()) * H * V.t()).t();
-    W = V * H.t() * pinv(H * H.t());
+    numerator = V * H.t();
+    gram = H * H.t();
+    W = numerator * pinv(gram);
 
-    // Set all negative numbers to machine epsilon.
-    for (size_t i = 0; i < W.n_elem; i++)
-    {
-      if (W(i) < 0.0)
-      {
-        W(i) = 0.0;
-      }
-    }
+    // Set all negative numbers to 0.
+    Clamp(W);
   }
 
   /**
@@ -97,21 +93,40 @@ class NMFALSUpdate
    * @param H Encoding matrix to be updated.
    */
   template<typename MatType>
-  inline static void HUpdate(const MatType& V,
-                             const arma::mat& W,
-                             arma::mat& H)
+  inline void HUpdate(const MatType& V,
+                      const arma::mat& W,
+                      arma::mat& H)
   {
-    H = pinv(W.t() * W) * W.t() * V;
+    numerator = W.t() * V;
+    gram = W.t() * W;
+    H = pinv(gram) * numerator;
 
     // Set all negative numbers to 0.
-    for (size_t i = 0; i < H.n_elem; i++)
-    {
-      if (H(i) < 0.0)
-      {
-        H(i) = 0.0;
-      }
-    }
+    Clamp(H);
   }
+
+  //! Return the number of bytes used by the rule and its temporaries.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(numerator) - sizeof(gram) +
+        util::MemoryUsage(numerator) + util::MemoryUsage(gram);
+  }
+
+ private:
+  //! Set all negative elements of the given matrix to 0.
+  inline static void Clamp(arma::mat& M)
+  {
+    double* m = M.memptr();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < M.n_elem; i++)
+      m[i] = (m[i] < 0.0) ? 0.0 : m[i];
+  }
+
+  //! Workspace for V * H^T or W^T * V.
+  arma::mat numerator;
+  //! Workspace for the rank x rank Gram matrix (H * H^T or W^T * W).
+  arma::mat gram;
 }; // class NMFALSUpdate
 
 } // namespace amf
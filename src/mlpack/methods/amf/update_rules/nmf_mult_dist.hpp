@@ -62,11 +62,24 @@ class NMFMultiplicativeDistanceUpdate
    * @param H Encoding matrix.
    */
   template<typename MatType>
-  inline static void WUpdate(const MatType& V,
-                             arma::mat& W,
-                             const arma::mat& H)
+  inline void WUpdate(const MatType& V,
+                      arma::mat& W,
+                      const arma::mat& H)
   {
-    W = (W % (V * H.t())) / (W * H * H.t());
+    // W * H * H^T is evaluated as W * (H * H^T), so that the n x m product
+    // W * H is never formed.  The workspaces keep their memory between the
+    // iterations.
+    numerator = V * H.t();
+    gram = H * H.t();
+    denominator = W * gram;
+
+    double* w = W.memptr();
+    const double* num = numerator.memptr();
+    const double* den = denominator.memptr();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < W.n_elem; ++i)
+      w[i] = w[i] * num[i] / den[i];
   }
 
   /**
@@ -84,12 +97,38 @@ class NMFMultiplicativeDistanceUpdate
    * @param H Encoding matrix to be updated.
    */
   template<typename MatType>
-  inline static void HUpdate(const MatType& V,
-                             const arma::mat& W,
-                             arma::mat& H)
+  inline void HUpdate(const MatType& V,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    numerator = W.t() * V;
+    gram = W.t() * W;
+    denominator = gram * H;
+
+    double* h = H.memptr();
+    const double* num = numerator.memptr();
+    const double* den = denominator.memptr();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < H.n_elem; ++i)
+      h[i] = h[i] * num[i] / den[i];
+  }
+
+  //! Return the number of bytes used by the rule and its temporaries.
+  size_t MemoryUsage() const
   {
-    H = (H % (W.t() * V)) / (W.t() * W * H);
+    return sizeof(*this) - sizeof(numerator) - sizeof(denominator) -
+        sizeof(gram) + util::MemoryUsage(numerator) +
+        util::MemoryUsage(denominator) + util::MemoryUsage(gram);
   }
+
+ private:
+  //! Workspace for the numerator of the update (V * H^T or W^T * V).
+  arma::mat numerator;
+  //! Workspace for the denominator of the update.
+  arma::mat denominator;
+  //! Workspace for the rank x rank Gram matrix (H * H^T or W^T * W).
+  arma::mat gram;
 };
 
 } // namespace amf
@@ -36,9 +36,10 @@ namespace amf {
  * is non-increasing between subsequent iterations. Both of the update rules
  * for W and H are defined in this file.
  *
- * This set of update rules is not meant to work with sparse matrices.  Using
- * sparse matrices often causes NaNs in the output, so other choices of update
- * rules are better in that situation.
+ * For sparse matrices, the specializations of the update rules evaluate W H
+ * only at the nonzero elements of V, so an iteration takes O(nnz r) time
+ * instead of O(n m r) time.  Still, sparse matrices often cause NaNs in the
+ * output, so other choices of update rules may be better in that situation.
  */
 class NMFMultiplicativeDivergenceUpdate
 {
@@ -72,31 +73,21 @@ class NMFMultiplicativeDivergenceUpdate
    * @param H Encoding matrix.
    */
   template<typename MatType>
-  inline static void WUpdate(const MatType& V,
-                             arma::mat& W,
-                             const arma::mat& H)
+  inline void WUpdate(const MatType& V,
+                      arma::mat& W,
+                      const arma::mat& H)
   {
-    // Simple implementation left in the header file.
-    arma::mat t1;
-    arma::rowvec t2;
+    // The sum over mu is the product of V / (W H) with H^T, and the
+    // denominator is the row sum of H.
+    Ratio(V, W, H);
+    numerator = ratio * H.t();
+    sums = arma::sum(H, 1);
 
-    t1 = W * H;
-    for (size_t i = 0; i < W.n_rows; ++i)
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < W.n_cols; ++j)
     {
-      for (size_t j = 0; j < W.n_cols; ++j)
-      {
-        // Writing this as a single expression does not work as of Armadillo
-        // 3.920.  This should be fixed in a future release, and then the code
-        // below can be fixed.
-        //t2 = H.row(j) % V.row(i) / t1.row(i);
-        t2.set_size(H.n_cols);
-        for (size_t k = 0; k < t2.n_elem; ++k)
-        {
-          t2(k) = H(j, k) * V(i, k) / t1(i, k);
-        }
-
-        W(i, j) = W(i, j) * sum(t2) / sum(H.row(j));
-      }
+      for (size_t i = 0; i < W.n_rows; ++i)
+        W(i, j) = W(i, j) * numerator(i, j) / sums(j);
     }
   }
 
@@ -116,35 +107,154 @@ class NMFMultiplicativeDivergenceUpdate
    * @param H Encoding matrix to updated.
    */
   template<typename MatType>
-  inline static void HUpdate(const MatType& V,
-                            const arma::mat& W,
-                            arma::mat& H)
+  inline void HUpdate(const MatType& V,
+                      const arma::mat& W,
+                      arma::mat& H)
   {
-    // Simple implementation left in the header file.
-    arma::mat t1;
-    arma::colvec t2;
+    // The sum over i is the product of W^T with V / (W H), and the
+    // denominator is the column sum of W.
+    Ratio(V, W, H);
+    numerator = W.t() * ratio;
+    sums = arma::trans(arma::sum(W, 0));
 
-    t1 = W * H;
-    for (size_t i = 0; i < H.n_rows; i++)
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < H.n_cols; ++j)
     {
-      for (size_t j = 0; j < H.n_cols; j++)
-      {
-        // Writing this as a single expression does not work as of Armadillo
-        // 3.920.  This should be fixed in a future release, and then the code
-        // below can be fixed.
-        //t2 = W.col(i) % V.col(j) / t1.col(j);
-        t2.set_size(W.n_rows);
-        for (size_t k = 0; k < t2.n_elem; ++k)
-        {
-          t2(k) = W(k, i) * V(k, j) / t1(k, j);
-        }
-
-        H(i,j) = H(i,j) * sum(t2) / sum(W.col(i));
-      }
+      for (size_t i = 0; i < H.n_rows; ++i)
+        H(i, j) = H(i, j) * numerator(i, j) / sums(i);
     }
   }
+
+  //! Return the number of bytes used by the rule and its temporaries.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(ratio) - sizeof(numerator) - sizeof(sums) -
+        sizeof(vt) + util::MemoryUsage(ratio) + util::MemoryUsage(numerator) +
+        util::MemoryUsage(sums) + util::MemoryUsage(vt);
+  }
+
+ private:
+  /**
+   * Compute the element-wise ratio V / (W H) into the ratio workspace.
+   */
+  template<typename MatType>
+  inline void Ratio(const MatType& V, const arma::mat& W, const arma::mat& H)
+  {
+    ratio = W * H;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < ratio.n_cols; ++j)
+    {
+      for (size_t i = 0; i < ratio.n_rows; ++i)
+        ratio(i, j) = V(i, j) / ratio(i, j);
+    }
+  }
+
+  //! Workspace for the element-wise ratio V / (W H).
+  arma::mat ratio;
+  //! Workspace for the numerator of the update.
+  arma::mat numerator;
+  //! Workspace for the row sums of H or the column sums of W.
+  arma::vec sums;
+
+  //! Transposed copy of a sparse input matrix, so that the elements of a row
+  //! can be visited without a search.
+  arma::sp_mat vt;
 };
 
+/**
+ * Initialize specialization for sparse matrix, which stores the transposed
+ * matrix used by the sparse WUpdate.
+ */
+template<>
+inline void NMFMultiplicativeDivergenceUpdate::Initialize<arma::sp_mat>(
+    const arma::sp_mat& dataset,
+    const size_t /* rank */)
+{
+  vt = dataset.t();
+}
+
+/**
+ * WUpdate function specialization for sparse matrix.  \f$ (W H)_{i\mu} \f$ is
+ * only computed where \f$ V_{i\mu} \f$ is nonzero, since all other terms of
+ * the sum vanish.
+ */
+template<>
+inline void NMFMultiplicativeDivergenceUpdate::WUpdate<arma::sp_mat>(
+    const arma::sp_mat& V,
+    arma::mat& W,
+    const arma::mat& H)
+{
+  const size_t r = W.n_cols;
+
+  numerator.zeros(V.n_rows, r);
+  sums = arma::sum(H, 1);
+
+  // Column i of the transposed matrix holds the elements of row i.  Row i of W
+  // is only used for the elements of row i, so it is updated right after.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < V.n_rows; ++i)
+  {
+    for (arma::sp_mat::const_iterator it = vt.begin_col(i);
+        it != vt.end_col(i); ++it)
+    {
+      const double* h = H.colptr(it.row());
+
+      double wh = 0;
+      for (size_t k = 0; k < r; ++k)
+        wh += W(i, k) * h[k];
+
+      const double ratio = (*it) / wh;
+      for (size_t k = 0; k < r; ++k)
+        numerator(i, k) += ratio * h[k];
+    }
+
+    for (size_t k = 0; k < r; ++k)
+      W(i, k) = W(i, k) * numerator(i, k) / sums(k);
+  }
+}
+
+/**
+ * HUpdate function specialization for sparse matrix.  \f$ (W H)_{i\mu} \f$ is
+ * only computed where \f$ V_{i\mu} \f$ is nonzero, since all other terms of
+ * the sum vanish.
+ */
+template<>
+inline void NMFMultiplicativeDivergenceUpdate::HUpdate<arma::sp_mat>(
+    const arma::sp_mat& V,
+    const arma::mat& W,
+    arma::mat& H)
+{
+  const size_t r = W.n_cols;
+
+  numerator.zeros(r, V.n_cols);
+  sums = arma::trans(arma::sum(W, 0));
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t j = 0; j < V.n_cols; ++j)
+  {
+    double* h = H.colptr(j);
+    double* num = numerator.colptr(j);
+
+    for (arma::sp_mat::const_iterator it = V.begin_col(j);
+        it != V.end_col(j); ++it)
+    {
+      const size_t i = it.row();
+
+      double wh = 0;
+      for (size_t k = 0; k < r; ++k)
+        wh += W(i, k) * h[k];
+
+      const double ratio = (*it) / wh;
+      for (size_t k = 0; k < r; ++k)
+        num[k] += W(i, k) * ratio;
+    }
+
+    for (size_t k = 0; k < r; ++k)
+      h[k] = h[k] * num[k] / sums(k);
+  }
+}
+
 } // namespace amf
 } // namespace mlpack
 
@@ -84,25 +84,26 @@ class SVDBatchLearning
                       arma::mat& W,
                       const arma::mat& H)
   {
-    size_t n = V.n_rows;
-    size_t m = V.n_cols;
+    const size_t n = V.n_rows;
+    const size_t m = V.n_cols;
 
-    size_t r = W.n_cols;
+    const size_t r = W.n_cols;
 
     // initialize the momentum of this iteration.
-    mW = momentum * mW;
+    mW *= momentum;
 
-    // Compute the step.
-    arma::mat deltaW;
+    // Compute the step.  Every row of the step only depends on the same row
+    // of W, so the rows are computed in parallel.
     deltaW.zeros(n, r);
+
+    #pragma omp parallel for schedule(static)
     for (size_t i = 0; i < n; i++)
     {
       for (size_t j = 0; j < m; j++)
       {
         const double val = V(i, j);
         if (val != 0)
-          deltaW.row(i) += (val - arma::dot(W.row(i), H.col(j))) *
-                                            arma::trans(H.col(j));
+          WStep(W, H, i, j, val);
       }
       // Add regularization.
       if (kw != 0)
@@ -129,24 +130,26 @@ class SVDBatchLearning
                       const arma::mat& W,
                       arma::mat& H)
   {
-    size_t n = V.n_rows;
-    size_t m = V.n_cols;
+    const size_t n = V.n_rows;
+    const size_t m = V.n_cols;
 
-    size_t r = W.n_cols;
+    const size_t r = W.n_cols;
 
     // Initialize the momentum of this iteration.
-    mH = momentum * mH;
+    mH *= momentum;
 
-    // Compute the step.
-    arma::mat deltaH;
+    // Compute the step.  Every column of the step only depends on the same
+    // column of H, so the columns are computed in parallel.
     deltaH.zeros(r, m);
+
+    #pragma omp parallel for schedule(static)
     for (size_t j = 0; j < m; j++)
     {
       for (size_t i = 0; i < n; i++)
       {
         const double val = V(i, j);
         if (val != 0)
-          deltaH.col(j) += (val - arma::dot(W.row(i), H.col(j))) * W.row(i).t();
+          HStep(W, H, i, j, val);
       }
       // Add regularization.
       if (kh != 0)
@@ -159,7 +162,51 @@ class SVDBatchLearning
     H += mH;
   }
 
+  //! Return the number of bytes used by the rule, its momentum and temporaries.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(mW) - sizeof(mH) - sizeof(deltaW) -
+        sizeof(deltaH) - sizeof(vt) + util::MemoryUsage(mW) +
+        util::MemoryUsage(mH) + util::MemoryUsage(deltaW) +
+        util::MemoryUsage(deltaH) + util::MemoryUsage(vt);
+  }
+
  private:
+  //! Add the step of the given element of V to row i of deltaW.
+  inline void WStep(const arma::mat& W,
+                    const arma::mat& H,
+                    const size_t i,
+                    const size_t j,
+                    const double val)
+  {
+    const double* h = H.colptr(j);
+
+    double error = val;
+    for (size_t k = 0; k < W.n_cols; k++)
+      error -= W(i, k) * h[k];
+
+    for (size_t k = 0; k < W.n_cols; k++)
+      deltaW(i, k) += error * h[k];
+  }
+
+  //! Add the step of the given element of V to column j of deltaH.
+  inline void HStep(const arma::mat& W,
+                    const arma::mat& H,
+                    const size_t i,
+                    const size_t j,
+                    const double val)
+  {
+    const double* h = H.colptr(j);
+    double* delta = deltaH.colptr(j);
+
+    double error = val;
+    for (size_t k = 0; k < W.n_cols; k++)
+      error -= W(i, k) * h[k];
+
+    for (size_t k = 0; k < W.n_cols; k++)
+      delta[k] += error * W(i, k);
+  }
+
   //! Step size of the algorithm.
   double u;
   //! Regularization parameter for matrix W.
@@ -173,10 +220,31 @@ class SVDBatchLearning
   arma::mat mW;
   //! Momentum matrix for matrix H
   arma::mat mH;
+
+  //! Workspace for the step of matrix W.
+  arma::mat deltaW;
+  //! Workspace for the step of matrix H.
+  arma::mat deltaH;
+
+  //! Transposed copy of a sparse input matrix, so that the elements of a row
+  //! can be visited without a search.
+  arma::sp_mat vt;
 }; // class SVDBatchLearning
 
-//! TODO : Merge this template specialized function for sparse matrix using
-//!        common row_col_iterator
+/**
+ * Initialize specialization for sparse matrix, which additionally stores the
+ * transposed matrix used by the sparse WUpdate.
+ */
+template<>
+inline void SVDBatchLearning::Initialize<arma::sp_mat>(
+    const arma::sp_mat& dataset,
+    const size_t rank)
+{
+  mW.zeros(dataset.n_rows, rank);
+  mH.zeros(rank, dataset.n_cols);
+
+  vt = dataset.t();
+}
 
 /**
  * WUpdate function specialization for sparse matrix
@@ -189,27 +257,30 @@ inline void SVDBatchLearning::WUpdate<arma::sp_mat>(const arma::sp_mat& V,
   const size_t n = V.n_rows;
   const size_t r = W.n_cols;
 
-  mW = momentum * mW;
+  mW *= momentum;
 
-  arma::mat deltaW;
   deltaW.zeros(n, r);
 
-  for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
+  // Column i of the transposed matrix holds the elements of row i, so every
+  // row of the step is computed by a single thread.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < n; i++)
   {
-    const size_t row = it.row();
-    const size_t col = it.col();
-    deltaW.row(it.row()) += (*it - arma::dot(W.row(row), H.col(col))) *
-                                             arma::trans(H.col(col));
+    for (arma::sp_mat::const_iterator it = vt.begin_col(i);
+        it != vt.end_col(i); ++it)
+      WStep(W, H, i, it.row(), *it);
   }
 
   if (kw != 0)
-    for (size_t i = 0; i < n; i++)
-      deltaW -= kw * W;
+    deltaW -= kw * W;
 
   mW += u * deltaW;
   W += mW;
 }
 
+/**
+ * HUpdate function specialization for sparse matrix
+ */
 template<>
 inline void SVDBatchLearning::HUpdate<arma::sp_mat>(const arma::sp_mat& V,
                                                     const arma::mat& W,
@@ -218,22 +289,20 @@ inline void SVDBatchLearning::HUpdate<arma::sp_mat>(const arma::sp_mat& V,
   const size_t m = V.n_cols;
   const size_t r = W.n_cols;
 
-  mH = momentum * mH;
+  mH *= momentum;
 
-  arma::mat deltaH;
   deltaH.zeros(r, m);
 
-  for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t j = 0; j < m; j++)
   {
-    const size_t row = it.row();
-    const size_t col = it.col();
-    deltaH.col(col) += (*it - arma::dot(W.row(row), H.col(col))) *
-        W.row(row).t();
+    for (arma::sp_mat::const_iterator it = V.begin_col(j);
+        it != V.end_col(j); ++it)
+      HStep(W, H, it.row(), j, *it);
   }
 
   if (kh != 0)
-    for (size_t j = 0; j < m; j++)
-      deltaH -= kh * H;
+    deltaH -= kh * H;
 
   mH += u * deltaH;
   H += mH;
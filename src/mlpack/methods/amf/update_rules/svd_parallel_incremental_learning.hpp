@@ -0,0 +1,281 @@
+/**
+ * @file svd_parallel_incremental_learning.hpp
+ * @author Sumedh Ghaisas
+ *
+ * SVD factorizer used in AMF (Alternating Matrix Factorization), which performs
+ * stochastic gradient descent on many threads at once.
+ */
+#ifndef __MLPACK_METHODS_AMF_SVD_PARALLEL_INCREMENTAL_LEARNING_HPP
+#define __MLPACK_METHODS_AMF_SVD_PARALLEL_INCREMENTAL_LEARNING_HPP
+
+#include <mlpack/core.hpp>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class computes SVD using complete incremental learning (stochastic
+ * gradient descent over the nonzero elements of V, see
+ * SVDCompleteIncrementalLearning), distributed over several threads with the
+ * stratification of distributed SGD:
+ *
+ * @code
+ * @inproceedings{gemulla2011large,
+ *   title={Large-scale matrix factorization with distributed stochastic
+ *       gradient descent},
+ *   author={Gemulla, R. and Nijkamp, E. and Haas, P.J. and Sismanis, Y.},
+ *   booktitle={Proceedings of the 17th ACM SIGKDD International Conference on
+ *       Knowledge Discovery and Data Mining},
+ *   pages={69--77},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * The rows and the columns of V are split into p blocks each.  An epoch
+ * consists of p sub-epochs, and in sub-epoch s the thread b processes the
+ * elements of block (b, (b + s) mod p).  The blocks processed at the same time
+ * share no row and no column, so they update disjoint rows of W and columns of
+ * H and no locking is necessary.  Within a block, every nonzero element of V
+ * updates the corresponding row of W and column of H immediately, exactly as
+ * in SVDCompleteIncrementalLearning.  The result doesn't depend on the number
+ * of threads, only on the number of blocks.
+ *
+ * One call of WUpdate() and HUpdate() performs a whole epoch, so this rule is
+ * used with a regular termination policy such as SimpleToleranceTermination:
+ *
+ * @code
+ * AMF<SimpleToleranceTermination<arma::sp_mat>,
+ *     RandomInitialization,
+ *     SVDParallelIncrementalLearning> amf;
+ * @endcode
+ *
+ * @see SVDCompleteIncrementalLearning
+ */
+class SVDParallelIncrementalLearning
+{
+ public:
+  /**
+   * Initialize the SVDParallelIncrementalLearning class with the given
+   * parameters.
+   *
+   * @param u Step value used in batch learning.
+   * @param kw Regularization constant for W matrix.
+   * @param kh Regularization constant for H matrix.
+   * @param blocks Number of row and column blocks (0 means one block for each
+   *     thread).
+   */
+  SVDParallelIncrementalLearning(double u = 0.001,
+                                 double kw = 0,
+                                 double kh = 0,
+                                 const size_t blocks = 0)
+          : u(u), kw(kw), kh(kh), blocks(blocks)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Initialize parameters before factorization.  This function must be called
+   * before a new factorization.  This sorts the nonzero elements of the input
+   * matrix into the blocks.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank rank of factorization
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    strata = blocks;
+    if (strata == 0)
+    {
+      #ifdef _OPENMP
+        strata = omp_get_max_threads();
+      #else
+        strata = 1;
+      #endif
+    }
+
+    n = dataset.n_rows;
+    m = dataset.n_cols;
+
+    // Count the elements of every block first, so that the elements can be
+    // stored in a single allocation.
+    bucketStart.zeros(strata * strata + 1);
+    CountElements(dataset);
+    for (size_t i = 1; i < bucketStart.n_elem; ++i)
+      bucketStart(i) += bucketStart(i - 1);
+
+    rows.set_size(bucketStart(strata * strata));
+    cols.set_size(rows.n_elem);
+    values.set_size(rows.n_elem);
+
+    arma::uvec position = bucketStart.subvec(0, strata * strata - 1);
+    StoreElements(dataset, position);
+  }
+
+  /**
+   * Perform an epoch of stochastic gradient descent.  The function takes in
+   * all the matrices and only changes the value of the W matrix; the new
+   * value of H is stored internally and set by the following HUpdate().
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    h = H;
+
+    for (size_t s = 0; s < strata; ++s)
+    {
+      #pragma omp parallel for schedule(dynamic)
+      for (size_t b = 0; b < strata; ++b)
+      {
+        const size_t bucket = b * strata + (b + s) % strata;
+        for (size_t k = bucketStart(bucket); k < bucketStart(bucket + 1); ++k)
+          Step(W, rows(k), cols(k), values(k));
+      }
+    }
+  }
+
+  /**
+   * Set the encoding matrix H computed by the previous epoch.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& /* W */,
+                      arma::mat& H)
+  {
+    H = h;
+  }
+
+  //! Get the number of row and column blocks (0 means one for each thread).
+  size_t Blocks() const { return blocks; }
+  //! Modify the number of row and column blocks.
+  size_t& Blocks() { return blocks; }
+
+  //! Return the number of bytes used by the rule and its blocked copy of V.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(bucketStart) - sizeof(rows) - sizeof(cols) -
+        sizeof(values) - sizeof(h) + util::MemoryUsage(bucketStart) +
+        util::MemoryUsage(rows) + util::MemoryUsage(cols) +
+        util::MemoryUsage(values) + util::MemoryUsage(h);
+  }
+
+ private:
+  //! Perform the gradient step of the given element on W and h.
+  inline void Step(arma::mat& W,
+                   const size_t row,
+                   const size_t col,
+                   const double val)
+  {
+    double* hCol = h.colptr(col);
+
+    double error = val;
+    for (size_t k = 0; k < W.n_cols; ++k)
+      error -= W(row, k) * hCol[k];
+
+    for (size_t k = 0; k < W.n_cols; ++k)
+    {
+      const double w = W(row, k);
+      W(row, k) += u * (error * hCol[k] - kw * w);
+      hCol[k] += u * (error * w - kh * hCol[k]);
+    }
+  }
+
+  //! Get the block of the given element.
+  size_t Bucket(const size_t row, const size_t col) const
+  {
+    return (row * strata / n) * strata + (col * strata / m);
+  }
+
+  //! Count the nonzero elements of every block of a dense matrix.
+  template<typename MatType>
+  void CountElements(const MatType& V)
+  {
+    for (size_t j = 0; j < V.n_cols; ++j)
+      for (size_t i = 0; i < V.n_rows; ++i)
+        if (V(i, j) != 0)
+          ++bucketStart(Bucket(i, j) + 1);
+  }
+
+  //! Count the nonzero elements of every block of a sparse matrix.
+  void CountElements(const arma::sp_mat& V)
+  {
+    for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
+      ++bucketStart(Bucket(it.row(), it.col()) + 1);
+  }
+
+  //! Store the nonzero elements of a dense matrix in their blocks.
+  template<typename MatType>
+  void StoreElements(const MatType& V, arma::uvec& position)
+  {
+    for (size_t j = 0; j < V.n_cols; ++j)
+      for (size_t i = 0; i < V.n_rows; ++i)
+        if (V(i, j) != 0)
+          Store(i, j, V(i, j), position);
+  }
+
+  //! Store the nonzero elements of a sparse matrix in their blocks.
+  void StoreElements(const arma::sp_mat& V, arma::uvec& position)
+  {
+    for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
+      Store(it.row(), it.col(), *it, position);
+  }
+
+  //! Store a single element at the next position of its block.
+  void Store(const size_t row,
+             const size_t col,
+             const double val,
+             arma::uvec& position)
+  {
+    const size_t k = position(Bucket(row, col))++;
+    rows(k) = row;
+    cols(k) = col;
+    values(k) = val;
+  }
+
+  //! Step size of the algorithm.
+  double u;
+  //! Regularization parameter for matrix W.
+  double kw;
+  //! Regularization parameter for matrix H.
+  double kh;
+  //! The requested number of blocks (0 means one for each thread).
+  size_t blocks;
+
+  //! The number of blocks used for the current factorization.
+  size_t strata;
+  //! The number of rows of the input matrix.
+  size_t n;
+  //! The number of columns of the input matrix.
+  size_t m;
+
+  //! The index of the first element of every block.
+  arma::uvec bucketStart;
+  //! The row of every nonzero element, sorted by block.
+  arma::uvec rows;
+  //! The column of every nonzero element, sorted by block.
+  arma::uvec cols;
+  //! The value of every nonzero element, sorted by block.
+  arma::vec values;
+
+  //! The encoding matrix updated during the epoch.
+  arma::mat h;
+}; // class SVDParallelIncrementalLearning
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
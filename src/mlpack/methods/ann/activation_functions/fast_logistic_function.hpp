@@ -0,0 +1,112 @@
+/**
+ * @file fast_logistic_function.hpp
+ * @author Marcus Edel
+ *
+ * Definition and implementation of a fast approximation of the logistic
+ * function.
+ */
+#ifndef __MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_FAST_LOGISTIC_FUNCTION_HPP
+#define __MLPACK_METHODS_ANN_ACTIVATION_FUNCTIONS_FAST_LOGISTIC_FUNCTION_HPP
+
+#include <mlpack/core.hpp>
+#include "fast_tanh_function.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A fast approximation of the logistic function, which can be used instead of
+ * LogisticFunction as the activation function of a layer. The function is
+ * evaluated through the identity
+ *
+ * @f[
+ * f(x) &=& \frac{1}{2} + \frac{1}{2} tanh(\frac{x}{2})
+ * @f]
+ *
+ * using the branch-free approximation of FastTanhFunction, so the absolute
+ * error is below 5e-5. The derivative and the inverse are computed exactly
+ * from the activation, like in LogisticFunction.
+ */
+class FastLogisticFunction
+{
+  public:
+  /**
+   * Computes the approximation of the logistic function.
+   *
+   * @param x Input data.
+   * @return f(x).
+   */
+  template<typename eT>
+  static eT fn(const eT x)
+  {
+    return eT(0.5) + eT(0.5) * FastTanhFunction::fn(eT(0.5) * x);
+  }
+
+  /**
+   * Computes the approximation of the logistic function.
+   *
+   * @param x Input data.
+   * @param y The resulting output activation.
+   */
+  template<typename InputVecType, typename OutputVecType>
+  static void fn(const InputVecType& x, OutputVecType& y)
+  {
+    typedef typename OutputVecType::elem_type eT;
+
+    y = x;
+    eT* yPtr = y.memptr();
+    for (size_t i = 0; i < y.n_elem; ++i)
+      yPtr[i] = fn(yPtr[i]);
+  }
+
+  /**
+   * Computes the first derivative of the logistic function.
+   *
+   * @param y Input activation.
+   * @return f'(x)
+   */
+  static double deriv(const double y)
+  {
+    return y * (1.0 - y);
+  }
+
+  /**
+   * Computes the first derivatives of the logistic function.
+   *
+   * @param y Input activations.
+   * @param x The resulting derivatives.
+   */
+  template<typename InputVecType, typename OutputVecType>
+  static void deriv(const InputVecType& y, OutputVecType& x)
+  {
+    x = y % (1.0 - y);
+  }
+
+  /**
+   * Computes the inverse of the logistic function.
+   *
+   * @param y Input data.
+   * @return f^{-1}(y)
+   */
+  static double inv(const double y)
+  {
+    return arma::trunc_log(y / (1 - y));
+  }
+
+  /**
+   * Computes the inverse of the logistic function.
+   *
+   * @param y Input data.
+   * @return  x The resulting inverse of the input data.
+   */
+  template<typename InputVecType, typename OutputVecType>
+  static void inv(const InputVecType& y, OutputVecType& x)
+  {
+    x = arma::trunc_log(y / (1 - y));
+  }
+}; // class FastLogisticFunction
+
+}; // namespace ann
+}; // namespace mlpack
+
+#endif
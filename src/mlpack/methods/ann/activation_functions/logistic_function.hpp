@@ -53,8 +53,10 @@ class LogisticFunction
   template<typename InputVecType, typename OutputVecType>
   static void fn(const InputVecType& x, OutputVecType& y)
   {
-    y = x;
-    y.transform( [](double x) { return fn(x); } );
+    // Evaluate the whole input with one vectorized expression instead of the
+    // scalar function; exp() overflows to inf (and underflows to 0) in the
+    // same way the bounds of the scalar function handle it.
+    y = 1.0 / (1.0 + arma::exp(-x));
   }
 
   /**
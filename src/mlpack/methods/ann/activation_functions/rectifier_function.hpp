@@ -60,8 +60,13 @@ class RectifierFunction
   template<typename InputVecType, typename OutputVecType>
   static void fn(const InputVecType& x, OutputVecType& y)
   {
+    typedef typename OutputVecType::elem_type eT;
+
+    // A branch-free loop over the memory, which the compiler can vectorize.
     y = x;
-    y = arma::max(arma::zeros<OutputVecType>(x.n_elem), x);
+    eT* yPtr = y.memptr();
+    for (size_t i = 0; i < y.n_elem; ++i)
+      yPtr[i] = std::max(yPtr[i], eT(0));
   }
 
   /**
@@ -84,8 +89,12 @@ class RectifierFunction
   template<typename InputVecType, typename OutputVecType>
   static void deriv(const InputVecType& y, OutputVecType& x)
   {
+    typedef typename OutputVecType::elem_type eT;
+
     x = y;
-    x.transform( [](double y) { return deriv(y); } );
+    eT* xPtr = x.memptr();
+    for (size_t i = 0; i < x.n_elem; ++i)
+      xPtr[i] = (xPtr[i] > 0) ? eT(1) : eT(0);
   }
 }; // class RectifierFunction
 
@@ -65,7 +65,7 @@ class SoftsignFunction
   static void fn(const InputVecType& x, OutputVecType& y)
   {
     y = x;
-    y.transform( [](double x) { return fn(x); } );
+    y.transform( [](typename OutputVecType::elem_type x) { return fn(x); } );
   }
 
   /**
@@ -115,7 +115,7 @@ class SoftsignFunction
   static void inv(const InputVecType& y, OutputVecType& x)
   {
     x = y;
-    x.transform( [](double y) { return inv(y); } );
+    x.transform( [](typename OutputVecType::elem_type y) { return inv(y); } );
   }
 }; // class SoftsignFunction
 
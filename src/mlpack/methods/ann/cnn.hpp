@@ -15,6 +15,7 @@
 #include <mlpack/methods/ann/network_traits.hpp>
 #include <mlpack/methods/ann/performance_functions/cee_function.hpp>
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/memory_planner.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -80,7 +81,7 @@ class CNN
     {
       // Initialize the gradient storage only once.
       if (!gradients.size())
-        InitLayer(network);
+        InitGradients();
 
       gradientNum = 0;
       LayerBackward(network, error);
@@ -145,6 +146,9 @@ class CNN
     //! Get the error of the network.
     double Error() const { return trainError; }
 
+    //! Get the planner of the temporary buffers of the backward pass.
+    const MemoryPlanner& Planner() const { return planner; }
+
   private:
     /**
      * Helper function to reset the network by zeroing the layer activations.
@@ -373,7 +377,11 @@ class CNN
       if (!ConnectionTraits<typename std::remove_reference<decltype(
           std::get<I>(t))>::type>::IsPoolingConnection)
       {
-        DataType gradient;
+        // The temporary gradient is a view of the arena with the shape of the
+        // gradient storage.
+        DataType gradient = planner.Buffer(arena, gradientNum,
+            gradients[gradientNum].n_rows, gradients[gradientNum].n_cols,
+            gradients[gradientNum].n_slices);
         std::get<I>(t).Gradient(gradient);
 
         gradients[gradientNum++] += gradient;
@@ -476,6 +484,24 @@ class CNN
       Apply<I + 1, Tp...>(t);
     }
 
+    /**
+     * Build the gradient storage, and plan the arena of the temporary
+     * gradients of the backward pass.  The gradient of every connection is
+     * only needed until it is added to the storage, so the lifetimes of the
+     * temporaries don't overlap and they share the same memory.
+     */
+    void InitGradients()
+    {
+      InitLayer(network);
+
+      planner = MemoryPlanner();
+      for (size_t i = 0; i < gradients.size(); i++)
+        planner.Request(gradients[i].n_elem, i, i);
+      planner.Plan();
+
+      arena.zeros(planner.ArenaSize());
+    }
+
     /**
      * Helper function to iterate through all connection modules and to build
      * gradient storage.
@@ -558,6 +584,12 @@ class CNN
     //! The gradient storage we are using to perform the feed backward pass.
     boost::ptr_vector<DataType> gradients;
 
+    //! The planner of the temporary buffers of the backward pass.
+    MemoryPlanner planner;
+
+    //! The arena of the temporary buffers of the backward pass.
+    arma::Col<typename DataType::elem_type> arena;
+
     //! The index of the currently activate gradient.
     size_t gradientNum;
 
@@ -570,10 +602,11 @@ class CNN
 template <
   typename ConnectionTypes,
   typename OutputLayerType,
-  class PerformanceFunction
+  class PerformanceFunction,
+  typename DataType
 >
 class NetworkTraits<
-    CNN<ConnectionTypes, OutputLayerType, PerformanceFunction> >
+    CNN<ConnectionTypes, OutputLayerType, PerformanceFunction, DataType> >
 {
  public:
   static const bool IsFNN = false;
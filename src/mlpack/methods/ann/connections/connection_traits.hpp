@@ -36,6 +36,12 @@ class ConnectionTraits
    * This is true if the connection is a pooling connection.
    */
   static const bool IsPoolingConnection = false;
+
+  /**
+   * This is true if the connection takes sparse input and computes a sparse
+   * gradient.
+   */
+  static const bool IsSparseConnection = false;
 };
 
 }; // namespace ann
@@ -119,11 +119,15 @@ class ConvConnection
    * Ordinary feed forward pass of a neural network. Apply convolution to every
    * neuron in input layer and put the output in the output layer.
    *
+   * If OpenMP is available, the output maps are computed in parallel; every
+   * output map is written by exactly one thread.
+   *
    * @param input The input activation.
    */
   template<typename InputType>
   void FeedForward(const InputType& input)
   {
+    #pragma omp parallel for schedule(dynamic)
     for (size_t outputmap = 0; outputmap < outputLayer.OutputMaps(); outputmap++)
     {
       for (size_t inputmap = 0; inputmap < inputLayer.OutputMaps(); inputmap++)
@@ -150,6 +154,9 @@ class ConvConnection
    * Ordinary feed backward pass of a neural network. Pass the error from output
    * layer to input layer and calculate the delta of kernel weights.
    *
+   * If OpenMP is available, the deltas of the input maps are computed in
+   * parallel; every input map is written by exactly one thread.
+   *
    * @param error The backpropagated error.
    */
   template<typename eT>
@@ -159,6 +166,7 @@ class ConvConnection
                                         inputLayer.InputActivation().n_cols,
                                         inputLayer.InputActivation().n_slices);
 
+    #pragma omp parallel for schedule(dynamic)
     for (size_t outputmap = 0; outputmap < inputLayer.OutputMaps(); outputmap++)
     {
       for (size_t inputmap = 0; inputmap < outputLayer.OutputMaps(); inputmap++)
@@ -184,6 +192,10 @@ class ConvConnection
   /*
    * Calculate the gradient using the output delta and the input activation.
    *
+   * If OpenMP is available, the gradients of the output maps are computed in
+   * parallel. Every kernel belongs to exactly one output map, so the threads
+   * write disjoint slices of the gradient and no reduction is necessary.
+   *
    * @param gradient The calculated gradient.
    */
   template<typename eT>
@@ -192,10 +204,13 @@ class ConvConnection
     gradient = arma::zeros<arma::Cube<eT> >(weights.n_rows, weights.n_cols,
         weights.n_slices);
 
-    for (size_t outputmap = 0, s = 0; outputmap < outputLayer.OutputMaps(); outputmap++)
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t outputmap = 0; outputmap < outputLayer.OutputMaps(); outputmap++)
     {
-      for (size_t inputmap = 0; inputmap < inputLayer.OutputMaps(); inputmap++, s++)
+      for (size_t inputmap = 0; inputmap < inputLayer.OutputMaps(); inputmap++)
       {
+        const size_t s = outputmap * inputLayer.OutputMaps() + inputmap;
+
         arma::Cube<eT> inputSlices = inputLayer.InputActivation().slices(
             inputmap * inputLayer.LayerSlices(), (inputmap + 1) *
             inputLayer.LayerSlices() - 1);
@@ -155,6 +155,7 @@ class ConnectionTraits<
   static const bool IsSelfConnection = false;
   static const bool IsFullselfConnection = true;
   static const bool IsPoolingConnection = false;
+  static const bool IsSparseConnection = false;
 };
 
 }; // namespace ann
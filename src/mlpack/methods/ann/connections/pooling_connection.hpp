@@ -72,20 +72,28 @@ class PoolingConnection
   template<typename eT>
   void FeedForward(const arma::Mat<eT>& input)
   {
-    Pooling(input, outputLayer.InputActivation());
+    PoolingIndices(input.n_rows, input.n_cols, 1);
+    Pooling(input, outputLayer.InputActivation(), indices.slice(0));
   }
 
   /**
    * Ordinary feed forward pass of a neural network, apply pooling to the
-   * neurons (3rd order tensor) in the input layer.
+   * neurons (3rd order tensor) in the input layer. If OpenMP is available,
+   * the slices are pooled in parallel.
    *
    * @param input Input data used for pooling.
    */
   template<typename eT>
   void FeedForward(const arma::Cube<eT>& input)
   {
+    PoolingIndices(input.n_rows, input.n_cols, input.n_slices);
+
+    #pragma omp parallel for schedule(static)
     for (size_t s = 0; s < input.n_slices; s++)
-      Pooling(input.slice(s), outputLayer.InputActivation().slice(s));
+    {
+      Pooling(input.slice(s), outputLayer.InputActivation().slice(s),
+          indices.slice(s));
+    }
   }
 
   /**
@@ -98,12 +106,14 @@ class PoolingConnection
   void FeedBackward(const arma::Mat<eT>& error)
   {
     delta.zeros();
-    Unpooling(inputLayer.InputActivation(), error, inputLayer.Delta());
+    Unpooling(inputLayer.InputActivation(), error, indices.slice(0),
+        inputLayer.Delta());
   }
 
   /**
    * Ordinary feed backward pass of a neural network. Apply unsampling to the
    * error in output layer (3rd order tensor) to pass the error to input layer.
+   * If OpenMP is available, the slices are unpooled in parallel.
    *
    * @param error The backpropagated error.
    */
@@ -111,10 +121,12 @@ class PoolingConnection
   void FeedBackward(const arma::Cube<eT>& error)
   {
     delta.zeros();
+
+    #pragma omp parallel for schedule(static)
     for (size_t s = 0; s < error.n_slices; s++)
     {
       Unpooling(inputLayer.InputActivation().slice(s), error.slice(s),
-          delta.slice(s));
+          indices.slice(s), delta.slice(s));
     }
   }
 
@@ -161,56 +173,58 @@ class PoolingConnection
 
  private:
   /**
-   * Apply pooling to the input and store the results.
+   * Allocate the positions selected by the pooling rule for the given input
+   * size. The slices of a cube can't be resized, so this has to be done before
+   * the feature maps are pooled.
+   *
+   * @param rows Number of rows of every input feature map.
+   * @param cols Number of columns of every input feature map.
+   * @param slices Number of input feature maps.
+   */
+  void PoolingIndices(const size_t rows, const size_t cols, const size_t slices)
+  {
+    const size_t rStep = rows / outputLayer.LayerRows();
+    const size_t cStep = cols / outputLayer.LayerCols();
+    indices.set_size(rows / rStep, cols / cStep, slices);
+  }
+
+  /**
+   * Apply pooling to the input and store the results. The whole feature map is
+   * pooled by the pooling rule in one pass.
    *
    * @param input The input to be apply the pooling rule.
    * @param output The pooled result.
+   * @param poolingIndices The positions selected by the pooling rule.
    */
   template<typename eT>
-  void Pooling(const arma::Mat<eT>& input, arma::Mat<eT>& output)
+  void Pooling(const arma::Mat<eT>& input,
+               arma::Mat<eT>& output,
+               arma::Mat<size_t>& poolingIndices)
   {
     const size_t rStep = input.n_rows / outputLayer.LayerRows();
     const size_t cStep = input.n_cols / outputLayer.LayerCols();
 
-    for (size_t j = 0; j < input.n_cols; j += cStep)
-    {
-      for (size_t i = 0; i < input.n_rows; i += rStep)
-      {
-        output(i / rStep, j / cStep) += pooling.Pooling(
-            input(arma::span(i, i + rStep -1), arma::span(j, j + cStep - 1)));
-      }
-    }
+    pooling.Pooling(input, rStep, cStep, output, poolingIndices);
   }
 
   /**
    * Apply unpooling to the input and store the results.
    *
    * @param input The input to be apply the unpooling rule.
+   * @param error The backpropagated error.
+   * @param poolingIndices The positions selected by the pooling rule.
    * @param output The pooled result.
    */
   template<typename eT>
   void Unpooling(const arma::Mat<eT>& input,
                  const arma::Mat<eT>& error,
+                 const arma::Mat<size_t>& poolingIndices,
                  arma::Mat<eT>& output)
   {
     const size_t rStep = input.n_rows / error.n_rows;
     const size_t cStep = input.n_cols / error.n_cols;
 
-    arma::Mat<eT> unpooledError;
-    for (size_t j = 0; j < input.n_cols; j += cStep)
-    {
-      for (size_t i = 0; i < input.n_rows; i += rStep)
-      {
-        const arma::Mat<eT>& inputArea = input(arma::span(i, i + rStep - 1),
-                                               arma::span(j, j + cStep - 1));
-
-        pooling.Unpooling(inputArea, error(i / rStep, j / cStep),
-            unpooledError);
-
-        output(arma::span(i, i + rStep - 1),
-            arma::span(j, j + cStep - 1)) += unpooledError;
-      }
-    }
+    pooling.Unpooling(error, rStep, cStep, poolingIndices, output);
   }
 
   //! Locally-stored input layer.
@@ -230,6 +244,10 @@ class PoolingConnection
 
   //! Locally-stored passed error in backward propagation.
   DataType delta;
+
+  //! Locally-stored positions selected by the pooling rule in the forward
+  //! pass, one slice per feature map.
+  arma::Cube<size_t> indices;
 }; // PoolingConnection class.
 
 //! Connection traits for the pooling connection.
@@ -248,6 +266,7 @@ class ConnectionTraits<
   static const bool IsSelfConnection = false;
   static const bool IsFullselfConnection = false;
   static const bool IsPoolingConnection = true;
+  static const bool IsSparseConnection = false;
 };
 
 }; // namespace ann
@@ -160,6 +160,7 @@ class ConnectionTraits<
   static const bool IsSelfConnection = true;
   static const bool IsFullselfConnection = false;
   static const bool IsPoolingConnection = false;
+  static const bool IsSparseConnection = false;
 };
 
 }; // namespace ann
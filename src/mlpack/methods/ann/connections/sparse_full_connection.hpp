@@ -0,0 +1,267 @@
+/**
+ * @file sparse_full_connection.hpp
+ * @author Marcus Edel
+ *
+ * Implementation of the sparse full connection class, a full connection which
+ * takes sparse input.
+ */
+#ifndef __MLPACK_METHODS_ANN_CONNECTIONS_SPARSE_FULL_CONNECTION_HPP
+#define __MLPACK_METHODS_ANN_CONNECTIONS_SPARSE_FULL_CONNECTION_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/ann/init_rules/nguyen_widrow_init.hpp>
+#include <mlpack/methods/ann/optimizer/steepest_descent.hpp>
+#include <mlpack/methods/ann/connections/connection_traits.hpp>
+
+#include <vector>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of the sparse full connection class. Like the full
+ * connection, it connects every neuron of the input layer with the output
+ * layer, but the activation of the input layer is a sparse matrix (e.g. the
+ * bag-of-words vectors of a batch of documents), so it can only be used for
+ * the first layer of a network:
+ *
+ * @code
+ * NeuronLayer<IdentityFunction, arma::sp_mat> inputLayer(data.n_rows, 1);
+ * NeuronLayer<LogisticFunction, arma::mat> hiddenLayer(hiddenLayerSize);
+ * SparseFullConnection<decltype(inputLayer), decltype(hiddenLayer)>
+ *     inputConnection(inputLayer, hiddenLayer);
+ * @endcode
+ *
+ * Column j of the weight matrix belongs to feature j. The forward pass adds
+ * the weight column of every nonzero feature of a sample to its activation,
+ * and the gradient is a sparse matrix that is only nonzero in the columns of
+ * the features that are active in the batch, so both take time proportional
+ * to the number of nonzeros instead of the number of features. The error is
+ * not propagated into the input layer.
+ *
+ * The network updates the weights with the sparse gradient, so a
+ * SteepestDescent optimizer without momentum only touches the weights of the
+ * active features; with momentum, every weight is updated.
+ *
+ * @tparam InputLayerType Type of the connected input layer (with sparse
+ * activations).
+ * @tparam OutputLayerType Type of the connected output layer.
+ * @tparam OptimizerType Type of the optimizer used to update the weights.
+ * @tparam WeightInitRule Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the weights (arma::mat).
+ */
+template<
+    typename InputLayerType,
+    typename OutputLayerType,
+    typename OptimizerType = SteepestDescent<>,
+    class WeightInitRule = NguyenWidrowInitialization,
+    typename MatType = arma::mat
+>
+class SparseFullConnection
+{
+ public:
+  /**
+   * Create the SparseFullConnection object using the specified input layer,
+   * output layer, optimizer and weight initialization rule.
+   *
+   * @param InputLayerType The input layer which is connected with the output
+   * layer.
+   * @param OutputLayerType The output layer which is connected with the input
+   * layer.
+   * @param OptimizerType The optimizer used to update the weight matrix.
+   * @param WeightInitRule The weights initialization rule used to initialize
+   * the weights matrix.
+   */
+  SparseFullConnection(InputLayerType& inputLayer,
+                       OutputLayerType& outputLayer,
+                       OptimizerType& optimizer,
+                       WeightInitRule weightInitRule = WeightInitRule()) :
+      inputLayer(inputLayer),
+      outputLayer(outputLayer),
+      optimizer(&optimizer),
+      ownsOptimizer(false)
+  {
+    weightInitRule.Initialize(weights, outputLayer.InputSize(),
+        inputLayer.LayerRows());
+  }
+
+  /**
+   * Create the SparseFullConnection object using the specified input layer,
+   * output layer and weight initialization rule. The optimizer is
+   * default-constructed, which for SteepestDescent means no momentum.
+   *
+   * @param InputLayerType The input layer which is connected with the output
+   * layer.
+   * @param OutputLayerType The output layer which is connected with the input
+   * layer.
+   * @param WeightInitRule The weights initialization rule used to initialize
+   * the weights matrix.
+   */
+  SparseFullConnection(InputLayerType& inputLayer,
+                       OutputLayerType& outputLayer,
+                       WeightInitRule weightInitRule = WeightInitRule()) :
+      inputLayer(inputLayer),
+      outputLayer(outputLayer),
+      optimizer(new OptimizerType()),
+      ownsOptimizer(true)
+  {
+    weightInitRule.Initialize(weights, outputLayer.InputSize(),
+        inputLayer.LayerRows());
+  }
+
+  /**
+   * Delete the sparse full connection object and its optimizer.
+   */
+  ~SparseFullConnection()
+  {
+    if (ownsOptimizer)
+      delete optimizer;
+  }
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f using a sparse matrix as
+   * input. The samples (columns) are processed in parallel.
+   *
+   * @param input Input data used for evaluating the specified activity
+   * function.
+   */
+  template<typename eT>
+  void FeedForward(const arma::SpMat<eT>& input)
+  {
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < input.n_cols; ++i)
+    {
+      for (size_t j = input.col_ptrs[i]; j < input.col_ptrs[i + 1]; ++j)
+      {
+        outputLayer.InputActivation().col(i) += input.values[j] *
+            weights.col(input.row_indices[j]);
+      }
+    }
+  }
+
+  /**
+   * The error isn't propagated into the sparse input layer, so there is
+   * nothing to do here.
+   *
+   * @param error The backpropagated error.
+   */
+  template<typename ErrorType>
+  void FeedBackward(const ErrorType& /* unused */) { }
+
+  /*
+   * Calculate the gradient (sparse matrix) using the output delta (dense
+   * matrix) and the input activation (sparse matrix). Only the columns of the
+   * features that are active in the batch are stored.
+   *
+   * @param gradient The calculated gradient.
+   */
+  template<typename eT>
+  void Gradient(arma::SpMat<eT>& gradient)
+  {
+    // The columns of the transposed input hold the samples in which each
+    // feature is active.
+    const arma::SpMat<eT> inputTrans = inputLayer.InputActivation().t();
+
+    std::vector<size_t> active;
+    for (size_t j = 0; j < inputTrans.n_cols; ++j)
+      if (inputTrans.col_ptrs[j] != inputTrans.col_ptrs[j + 1])
+        active.push_back(j);
+
+    // Build the active columns of the gradient in column-major order.
+    const size_t rows = weights.n_rows;
+    arma::umat locations(2, active.size() * rows);
+    arma::Col<eT> values(active.size() * rows);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t f = 0; f < active.size(); ++f)
+    {
+      const size_t j = active[f];
+      arma::Col<eT> column(values.memptr() + f * rows, rows, false, true);
+      column.zeros();
+      for (size_t k = inputTrans.col_ptrs[j]; k < inputTrans.col_ptrs[j + 1];
+          ++k)
+      {
+        column += inputTrans.values[k] *
+            outputLayer.Delta().col(inputTrans.row_indices[k]);
+      }
+
+      for (size_t r = 0; r < rows; ++r)
+      {
+        locations(0, f * rows + r) = r;
+        locations(1, f * rows + r) = j;
+      }
+    }
+
+    gradient = arma::SpMat<eT>(locations, values, weights.n_rows,
+        weights.n_cols, false);
+  }
+
+  //! Get the weights.
+  MatType& Weights() const { return weights; }
+  //! Modify the weights.
+  MatType& Weights() { return weights; }
+
+  //! Get the input layer.
+  InputLayerType& InputLayer() const { return inputLayer; }
+  //! Modify the input layer.
+  InputLayerType& InputLayer() { return inputLayer; }
+
+  //! Get the output layer.
+  OutputLayerType& OutputLayer() const { return outputLayer; }
+  //! Modify the output layer.
+  OutputLayerType& OutputLayer() { return outputLayer; }
+
+  //! Get the optimzer.
+  OptimizerType& Optimzer() const { return *optimizer; }
+  //! Modify the optimzer.
+  OptimizerType& Optimzer() { return *optimizer; }
+
+  //! Get the detla (always empty).
+  MatType& Delta() const { return delta; }
+  //! Modify the delta (always empty).
+  MatType& Delta() { return delta; }
+
+ private:
+  //! Locally-stored weight object.
+  MatType weights;
+
+  //! Locally-stored connected input layer object.
+  InputLayerType& inputLayer;
+
+  //! Locally-stored connected output layer object.
+  OutputLayerType& outputLayer;
+
+  //! Locally-stored pointer to the optimzer object.
+  OptimizerType* optimizer;
+
+  //! Parameter that indicates if the class owns a optimizer object.
+  bool ownsOptimizer;
+
+  //! Locally-stored empty delta object.
+  MatType delta;
+}; // class SparseFullConnection
+
+//! Connection traits for the sparse full connection.
+template<
+    typename InputLayerType,
+    typename OutputLayerType,
+    typename OptimizerType,
+    class WeightInitRule,
+    typename MatType
+>
+class ConnectionTraits<
+    SparseFullConnection<InputLayerType, OutputLayerType, OptimizerType,
+    WeightInitRule, MatType> >
+{
+ public:
+  static const bool IsSelfConnection = false;
+  static const bool IsFullselfConnection = false;
+  static const bool IsPoolingConnection = false;
+  static const bool IsSparseConnection = true;
+};
+
+}; // namespace ann
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file im2col_convolution.hpp
+ * @author Marcus Edel
+ *
+ * Implementation of the convolution as a matrix product by rearranging the
+ * image patches into columns (im2col).
+ */
+#ifndef __MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define __MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/core.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by copying every filter-sized patch
+ * of the input into a column of a matrix (im2col), so that the convolution can
+ * be evaluated with a single (BLAS) matrix product. The convolution of the
+ * same input with several filters, or of several inputs with the same filter,
+ * is computed with one product, which is where this rule pays off against the
+ * naive convolution. The rule computes the same results as NaiveConvolution
+ * and can be used as ForwardConvolutionRule, BackwardConvolutionRule or
+ * GradientConvolutionRule of the ConvConnection. This class allows
+ * specification of the type of the border type. The convolution can be compute
+ * with the valid border type of the full border type (default).
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Perform a convolution.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Mat<eT>& output)
+  {
+    output.set_size(OutputSize(input.n_rows, filter.n_rows),
+        OutputSize(input.n_cols, filter.n_cols));
+
+    arma::Mat<eT> columns(filter.n_elem, output.n_elem);
+    Im2Col(input, filter.n_rows, filter.n_cols, columns);
+
+    MultiplyFilters(columns, filter.memptr(), filter.n_elem, 1,
+        output.memptr());
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors. Every slice of the input is
+   * convolved with the corresponding slice of the filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output)
+  {
+    output.set_size(OutputSize(input.n_rows, filter.n_rows),
+        OutputSize(input.n_cols, filter.n_cols), input.n_slices);
+
+    const size_t sliceElem = output.n_rows * output.n_cols;
+    arma::Mat<eT> columns(filter.n_rows * filter.n_cols, sliceElem);
+    for (size_t i = 0; i < input.n_slices; i++)
+    {
+      Im2Col(input.slice(i), filter.n_rows, filter.n_cols, columns);
+      MultiplyFilters(columns, filter.slice(i).memptr(), columns.n_rows, 1,
+          output.slice(i).memptr());
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output. The patches of the input are extracted once and all
+   * filters are applied with a single matrix product.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output)
+  {
+    output.set_size(OutputSize(input.n_rows, filter.n_rows),
+        OutputSize(input.n_cols, filter.n_cols), filter.n_slices);
+
+    arma::Mat<eT> columns(filter.n_rows * filter.n_cols,
+        output.n_rows * output.n_cols);
+    Im2Col(input, filter.n_rows, filter.n_cols, columns);
+
+    MultiplyFilters(columns, filter.memptr(), columns.n_rows, filter.n_slices,
+        output.memptr());
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter. The patches of all input slices are extracted into
+   * one matrix and the filter is applied with a single matrix product.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output)
+  {
+    output.set_size(OutputSize(input.n_rows, filter.n_rows),
+        OutputSize(input.n_cols, filter.n_cols), input.n_slices);
+
+    const size_t sliceElem = output.n_rows * output.n_cols;
+    arma::Mat<eT> columns(filter.n_elem, output.n_elem);
+    for (size_t i = 0; i < input.n_slices; i++)
+    {
+      Im2Col(input.slice(i), filter.n_rows, filter.n_cols, columns,
+          i * sliceElem);
+    }
+
+    // The slices of the output are stored consecutively, so the result of the
+    // product has exactly the memory layout of the output cube.
+    MultiplyFilters(columns, filter.memptr(), filter.n_elem, 1,
+        output.memptr());
+  }
+
+  /*
+   * Copy every filterRows x filterCols patch of the input into a column of the
+   * given matrix, starting at the specified column offset. The patches are
+   * ordered like the elements of the output (column-major) and every patch is
+   * stored column-major like the filter, so the convolution output is
+   * trans(columns) * vectorise(filter). In case of the full border mode, the
+   * input is zero-padded first. The columns matrix has to be allocated with
+   * filterRows * filterCols rows.
+   *
+   * @param input Input used to extract the patches.
+   * @param filterRows Number of rows of the filter.
+   * @param filterCols Number of columns of the filter.
+   * @param columns Matrix used to store the patches.
+   * @param offset Index of the first column used to store the patches.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Im2Col(const arma::Mat<eT>& input,
+         const size_t filterRows,
+         const size_t filterCols,
+         arma::Mat<eT>& columns,
+         const size_t offset = 0)
+  {
+    const size_t outputRows = input.n_rows - filterRows + 1;
+    const size_t outputCols = input.n_cols - filterCols + 1;
+
+    for (size_t j = 0; j < outputCols; ++j)
+    {
+      for (size_t i = 0; i < outputRows; ++i)
+      {
+        eT* columnPtr = columns.colptr(offset + j * outputRows + i);
+        for (size_t kj = 0; kj < filterCols; ++kj, columnPtr += filterRows)
+        {
+          const eT* inputPtr = input.colptr(kj + j) + i;
+          std::copy(inputPtr, inputPtr + filterRows, columnPtr);
+        }
+      }
+    }
+  }
+
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Im2Col(const arma::Mat<eT>& input,
+         const size_t filterRows,
+         const size_t filterCols,
+         arma::Mat<eT>& columns,
+         const size_t offset = 0)
+  {
+    // Pad the input to the working output shape.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(
+        input.n_rows + 2 * (filterRows - 1),
+        input.n_cols + 2 * (filterCols - 1));
+    inputPadded.submat(filterRows - 1, filterCols - 1,
+        filterRows - 1 + input.n_rows - 1,
+        filterCols - 1 + input.n_cols - 1) = input;
+
+    Im2ColConvolution<ValidConvolution>::Im2Col(inputPadded, filterRows,
+        filterCols, columns, offset);
+  }
+
+ private:
+  //! Get the size of the output along one dimension.
+  static size_t OutputSize(const size_t inputSize, const size_t filterSize)
+  {
+    return std::is_same<BorderMode, ValidConvolution>::value ?
+        inputSize - filterSize + 1 : inputSize + filterSize - 1;
+  }
+
+  /*
+   * Compute trans(columns) * filters, where filters is a filterElem x
+   * filterNum matrix whose columns are the vectorised filters, and store the
+   * result in the given memory (one output after another).
+   */
+  template<typename eT>
+  static void MultiplyFilters(const arma::Mat<eT>& columns,
+                              const eT* filterPtr,
+                              const size_t filterElem,
+                              const size_t filterNum,
+                              eT* outputPtr)
+  {
+    const arma::Mat<eT> filters(const_cast<eT*>(filterPtr), filterElem,
+        filterNum, false, true);
+    arma::Mat<eT> output(outputPtr, columns.n_cols, filterNum, false, true);
+    output = columns.t() * filters;
+  }
+};  // class Im2ColConvolution
+
+}; // namespace ann
+}; // namespace mlpack
+
+#endif
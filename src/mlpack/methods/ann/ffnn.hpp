@@ -14,6 +14,8 @@
 #include <mlpack/methods/ann/network_traits.hpp>
 #include <mlpack/methods/ann/performance_functions/cee_function.hpp>
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/connections/connection_traits.hpp>
+#include <mlpack/methods/ann/memory_planner.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -54,17 +56,25 @@ class FFNN
      * input and target vector, updating the resulting error into the error
      * vector.
      *
+     * If the layers of the network store their activations in a matrix type,
+     * each column of the input is treated as a separate sample, so a whole
+     * mini-batch is propagated at once and the gradients are summed over the
+     * batch.  The input may be sparse (arma::sp_mat) if the first connections
+     * of the network take sparse input (see SparseFullConnection).
+     *
      * @param input Input data used to evaluate the network.
      * @param target Target data used to calculate the network error.
      * @param error The calulated error of the output layer.
+     * @tparam InputType Type of the input (arma::colvec, arma::mat or
+     *     arma::sp_mat).
      * @tparam VecType Type of data (arma::colvec, arma::mat or arma::sp_mat).
      */
-    template <typename VecType>
-    void FeedForward(const VecType& input,
+    template <typename InputType, typename VecType>
+    void FeedForward(const InputType& input,
                      const VecType& target,
                      VecType& error)
     {
-      seqNum++;
+      seqNum += input.n_cols;
       trainError += Evaluate(input, target, error);
     }
 
@@ -80,7 +90,7 @@ class FFNN
     {
       // Initialize the gradient storage only once.
       if (!gradients.size())
-        InitLayer(network);
+        InitGradients();
 
       gradientNum = 0;
       LayerBackward(network, error);
@@ -107,12 +117,14 @@ class FFNN
      *
      * @param input Input data used to evaluate the network.
      * @param output Output data used to store the output activation
+     * @tparam InputType Type of the input (arma::colvec, arma::mat or
+     *     arma::sp_mat).
      * @tparam VecType Type of data (arma::colvec, arma::mat or arma::sp_mat).
      */
-    template <typename VecType>
-    void Predict(const VecType& input, VecType& output)
+    template <typename InputType, typename VecType>
+    void Predict(const InputType& input, VecType& output)
     {
-      ResetActivations(network);
+      ResetActivations(network, input.n_cols);
 
       std::get<0>(std::get<0>(network)).InputLayer().InputActivation() = input;
 
@@ -124,15 +136,22 @@ class FFNN
      * Evaluate the trained network using the given input and compare the output
      * with the given target vector.
      *
+     * If the input holds several samples (one per column), the returned error
+     * is the sum of the errors of the individual samples.
+     *
      * @param input Input data used to evaluate the trained network.
      * @param target Target data used to calculate the network error.
      * @param error The calulated error of the output layer.
+     * @tparam InputType Type of the input (arma::colvec, arma::mat or
+     *     arma::sp_mat).
      * @tparam VecType Type of data (arma::colvec, arma::mat or arma::sp_mat).
      */
-    template <typename VecType>
-    double Evaluate(const VecType& input, const VecType& target, VecType& error)
+    template <typename InputType, typename VecType>
+    double Evaluate(const InputType& input,
+                    const VecType& target,
+                    VecType& error)
     {
-      ResetActivations(network);
+      ResetActivations(network, input.n_cols);
 
       std::get<0>(std::get<0>(network)).InputLayer().InputActivation() = input;
 
@@ -140,9 +159,51 @@ class FFNN
       return OutputError(network, target, error);
     }
 
+    /**
+     * Add the gradients, the error and the number of inputs that the given
+     * network has accumulated since its last update to the ones of this
+     * network, and reset them in the given network.  Both networks must have
+     * the same structure.  This is used to merge the gradients of copies of a
+     * network that were trained on different parts of a mini-batch, so that a
+     * single call of ApplyGradients() takes the same step as if this network
+     * had seen all the inputs.
+     *
+     * @param other Network of the same structure to take the gradients from.
+     */
+    void MergeGradients(FFNN& other)
+    {
+      if (!other.gradients.size())
+        return;
+
+      if (!gradients.size())
+        InitGradients();
+
+      for (size_t i = 0; i < gradients.size(); i++)
+      {
+        gradients[i] += other.gradients[i];
+        other.gradients[i].zeros();
+
+        sparseGradients[i] += other.sparseGradients[i];
+        other.sparseGradients[i].zeros();
+      }
+
+      trainError += other.trainError;
+      seqNum += other.seqNum;
+      other.trainError = 0;
+      other.seqNum = 0;
+    }
+
     //! Get the error of the network.
     double Error() const { return trainError; }
 
+    //! Get the planner of the temporary buffers of the backward pass.
+    const MemoryPlanner& Planner() const { return planner; }
+
+    //! Get the connection modules of the network.
+    const ConnectionTypes& Network() const { return network; }
+    //! Modify the connection modules of the network.
+    ConnectionTypes& Network() { return network; }
+
   private:
     /**
      * Helper function to reset the network by zeroing the layer activations.
@@ -153,18 +214,22 @@ class FFNN
      */
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I == sizeof...(Tp), void>::type
-    ResetActivations(std::tuple<Tp...>& /* unused */) { }
+    ResetActivations(std::tuple<Tp...>& /* unused */,
+                     const size_t /* unused */) { }
 
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I < sizeof...(Tp), void>::type
-    ResetActivations(std::tuple<Tp...>& t)
+    ResetActivations(std::tuple<Tp...>& t, const size_t batchSize)
     {
-      Reset(std::get<I>(t));
-      ResetActivations<I + 1, Tp...>(t);
+      Reset(std::get<I>(t), batchSize);
+      ResetActivations<I + 1, Tp...>(t, batchSize);
     }
 
     /**
-     * Reset the network by zeroing the layer activations.
+     * Reset the network by zeroing the layer activations, and resize the
+     * activations to hold one column for each of the batchSize samples which
+     * are propagated at once.  The activation of a bias layer is a constant
+     * one for every sample.
      *
      * enable_if (SFINAE) is used to iterate through the network connections.
      * The general case peels off the first type and recurses, as usual with
@@ -172,14 +237,24 @@ class FFNN
      */
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I == sizeof...(Tp), void>::type
-    Reset(std::tuple<Tp...>& /* unused */) { }
+    Reset(std::tuple<Tp...>& /* unused */, const size_t /* unused */) { }
 
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I < sizeof...(Tp), void>::type
-    Reset(std::tuple<Tp...>& t)
+    Reset(std::tuple<Tp...>& t, const size_t batchSize)
     {
-      std::get<I>(t).OutputLayer().InputActivation().zeros();
-      Reset<I + 1, Tp...>(t);
+      std::get<I>(t).OutputLayer().InputActivation().zeros(
+          std::get<I>(t).OutputLayer().InputActivation().n_rows, batchSize);
+
+      if (LayerTraits<typename std::remove_reference<decltype(
+          std::get<I>(t).InputLayer())>::type>::IsBiasLayer &&
+          std::get<I>(t).InputLayer().InputActivation().n_cols != batchSize)
+      {
+        std::get<I>(t).InputLayer().InputActivation().ones(
+            std::get<I>(t).InputLayer().InputActivation().n_rows, batchSize);
+      }
+
+      Reset<I + 1, Tp...>(t, batchSize);
     }
 
     /**
@@ -244,9 +319,24 @@ class FFNN
 
       // Masures the network's performance with the specified performance
       // function.
-      return PerformanceFunction::Error(std::get<0>(
-          std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation(),
-          target);
+      if (target.n_cols == 1)
+      {
+        return PerformanceFunction::Error(std::get<0>(
+            std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation(),
+            target);
+      }
+
+      // For a mini-batch, sum up the performance of the individual samples so
+      // that the error doesn't depend on the batch size.
+      double performance = 0;
+      for (size_t i = 0; i < target.n_cols; i++)
+      {
+        performance += PerformanceFunction::Error(std::get<0>(
+            std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation()
+            .unsafe_col(i), target.unsafe_col(i));
+      }
+
+      return performance;
     }
 
     /*
@@ -317,19 +407,38 @@ class FFNN
     ConnectionBackward(std::tuple<Tp...>& t, VecType& error)
     {
       std::get<I>(t).FeedBackward(error);
+      InputBackward(std::get<I>(t));
+
+      ConnectionBackward<I + 1, VecType, Tp...>(t, error);
+    }
 
+    /**
+     * Calculate the delta of the input layer of the given connection, using
+     * the delta stored in the connection.
+     */
+    template<typename ConnectionType>
+    typename std::enable_if<
+        !ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    InputBackward(ConnectionType& connection)
+    {
       // We calculate the delta only for non bias layer.
       if (!LayerTraits<typename std::remove_reference<decltype(
-          std::get<I>(t).InputLayer())>::type>::IsBiasLayer)
+          connection.InputLayer())>::type>::IsBiasLayer)
       {
-        std::get<I>(t).InputLayer().FeedBackward(
-            std::get<I>(t).InputLayer().InputActivation(),
-            std::get<I>(t).Delta(), std::get<I>(t).InputLayer().Delta());
+        connection.InputLayer().FeedBackward(
+            connection.InputLayer().InputActivation(),
+            connection.Delta(), connection.InputLayer().Delta());
       }
-
-      ConnectionBackward<I + 1, VecType, Tp...>(t, error);
     }
 
+    /**
+     * The sparse input layer of a sparse connection gets no delta.
+     */
+    template<typename ConnectionType>
+    typename std::enable_if<
+        ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    InputBackward(ConnectionType& /* unused */) { }
+
     /**
      * Helper function to iterate through all connection modules and to update
      * the gradient storage.
@@ -366,13 +475,73 @@ class FFNN
     typename std::enable_if<I < sizeof...(Tp), void>::type
     Gradients(std::tuple<Tp...>& t)
     {
-      MatType gradient;
-      std::get<I>(t).Gradient(gradient);
-      gradients[gradientNum++] += gradient;
+      Gradient(std::get<I>(t), gradients[gradientNum]);
+      gradientNum++;
 
       Gradients<I + 1, Tp...>(t);
     }
 
+    /**
+     * Calculate the gradient of the given connection into its buffer in the
+     * arena, and add it to the gradient storage.
+     */
+    template<typename ConnectionType, typename eT>
+    typename std::enable_if<
+        !ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    Gradient(ConnectionType& connection, arma::Mat<eT>& storage)
+    {
+      arma::Mat<eT> gradient = planner.Buffer(arena, gradientNum,
+          storage.n_rows, storage.n_cols);
+      connection.Gradient(gradient);
+      storage += gradient;
+    }
+
+    /**
+     * Calculate the gradient of the given connection, and add it to the
+     * gradient storage.  Sparse gradients can't be views of the arena.
+     */
+    template<typename ConnectionType, typename eT>
+    typename std::enable_if<
+        !ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    Gradient(ConnectionType& connection, arma::SpMat<eT>& storage)
+    {
+      arma::SpMat<eT> gradient;
+      connection.Gradient(gradient);
+      storage += gradient;
+    }
+
+    /**
+     * Calculate the sparse gradient of the given sparse connection, and add it
+     * to its sparse gradient storage.
+     */
+    template<typename ConnectionType, typename StorageType>
+    typename std::enable_if<
+        ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    Gradient(ConnectionType& connection, StorageType& /* unused */)
+    {
+      arma::SpMat<typename MatType::elem_type> gradient;
+      connection.Gradient(gradient);
+      sparseGradients[gradientNum] += gradient;
+    }
+
+    /**
+     * Build the gradient storage, and plan the arena of the temporary
+     * gradients of the backward pass.  The gradient of every connection is
+     * only needed until it is added to the storage, so the lifetimes of the
+     * temporaries don't overlap and they share the same memory.
+     */
+    void InitGradients()
+    {
+      InitLayer(network);
+
+      planner = MemoryPlanner();
+      for (size_t i = 0; i < gradients.size(); i++)
+        planner.Request(gradients[i].n_elem, i, i);
+      planner.Plan();
+
+      arena.zeros(planner.ArenaSize());
+    }
+
     /**
      * Helper function to update the weights using the specified optimizer and
      * the given input.
@@ -408,18 +577,49 @@ class FFNN
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I < sizeof...(Tp), void>::type
     Apply(std::tuple<Tp...>& t)
+    {
+      UpdateWeights(std::get<I>(t));
+      Apply<I + 1, Tp...>(t);
+    }
+
+    /**
+     * Update the weights of the given connection using its gradient from the
+     * gradient store.
+     */
+    template<typename ConnectionType>
+    typename std::enable_if<
+        !ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    UpdateWeights(ConnectionType& connection)
     {
       // Take a mean gradient step over the number of inputs.
       if (seqNum > 1)
         gradients[gradientNum] /= seqNum;
 
-      std::get<I>(t).Optimzer().UpdateWeights(std::get<I>(t).Weights(),
+      connection.Optimzer().UpdateWeights(connection.Weights(),
           gradients[gradientNum], trainError);
 
       // Reset the gradient storage.
       gradients[gradientNum++].zeros();
+    }
 
-      Apply<I + 1, Tp...>(t);
+    /**
+     * Update the weights of the given sparse connection using its sparse
+     * gradient, so that only the weights of the active features are touched.
+     */
+    template<typename ConnectionType>
+    typename std::enable_if<
+        ConnectionTraits<ConnectionType>::IsSparseConnection, void>::type
+    UpdateWeights(ConnectionType& connection)
+    {
+      // Take a mean gradient step over the number of inputs.
+      if (seqNum > 1)
+        sparseGradients[gradientNum] /= seqNum;
+
+      connection.Optimzer().UpdateWeights(connection.Weights(),
+          sparseGradients[gradientNum], trainError);
+
+      // Reset the gradient storage.
+      sparseGradients[gradientNum++].zeros();
     }
 
     /**
@@ -459,8 +659,22 @@ class FFNN
     typename std::enable_if<I < sizeof...(Tp), void>::type
     Layer(std::tuple<Tp...>& t)
     {
-      gradients.push_back(new MatType(std::get<I>(t).Weights().n_rows,
-          std::get<I>(t).Weights().n_cols, arma::fill::zeros));
+      // The gradient of a sparse connection is stored in the sparse gradient
+      // storage; the dense storage only holds an empty placeholder for it.
+      const size_t rows = std::get<I>(t).Weights().n_rows;
+      const size_t cols = std::get<I>(t).Weights().n_cols;
+      if (ConnectionTraits<typename std::remove_reference<decltype(
+          std::get<I>(t))>::type>::IsSparseConnection)
+      {
+        gradients.push_back(new MatType());
+        sparseGradients.push_back(
+            arma::SpMat<typename MatType::elem_type>(rows, cols));
+      }
+      else
+      {
+        gradients.push_back(new MatType(rows, cols, arma::fill::zeros));
+        sparseGradients.push_back(arma::SpMat<typename MatType::elem_type>());
+      }
 
       Layer<I + 1, Tp...>(t);
     }
@@ -477,9 +691,18 @@ class FFNN
     //! The gradient storage we are using to perform the feed backward pass.
     boost::ptr_vector<MatType> gradients;
 
+    //! The gradient storage of the sparse connections.
+    std::vector<arma::SpMat<typename MatType::elem_type> > sparseGradients;
+
     //! The index of the currently activate gradient.
     size_t gradientNum;
 
+    //! The planner of the temporary buffers of the backward pass.
+    MemoryPlanner planner;
+
+    //! The arena of the temporary buffers of the backward pass.
+    arma::Col<typename MatType::elem_type> arena;
+
     //! The number of the current input sequence.
     size_t seqNum;
 }; // class FFNN
@@ -489,10 +712,11 @@ class FFNN
 template <
   typename ConnectionTypes,
   typename OutputLayerType,
-  class PerformanceFunction
+  class PerformanceFunction,
+  typename MatType
 >
 class NetworkTraits<
-    FFNN<ConnectionTypes, OutputLayerType, PerformanceFunction> >
+    FFNN<ConnectionTypes, OutputLayerType, PerformanceFunction, MatType> >
 {
  public:
   static const bool IsFNN = true;
@@ -0,0 +1,500 @@
+/**
+ * @file frozen_ffnn.hpp
+ * @author Marcus Edel
+ *
+ * Definition of the FrozenFFNN class, which implements an inference-only
+ * version of a trained feed forward neural network.
+ */
+#ifndef __MLPACK_METHODS_ANN_FROZEN_FFNN_HPP
+#define __MLPACK_METHODS_ANN_FROZEN_FFNN_HPP
+
+#include <mlpack/core.hpp>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/connections/connection_traits.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An inference-only version of a trained feed forward network. The weights of
+ * all connections are copied once into a single contiguous parameter vector
+ * and the bias connections are folded into one bias vector per layer, so that
+ * the evaluation of a layer is a single matrix product followed by the bias
+ * and the activation function, which are both applied in-place. No error,
+ * delta or gradient storage is allocated and the network isn't connected to
+ * the layers of the original network anymore. Every column of the input is
+ * treated as a separate sample, so whole batches are evaluated at once.
+ *
+ * For serving on CPUs, the weights can be quantized after the construction
+ * with Quantize(): every row of the weights is stored as 8-bit integers with
+ * its own scale, and the inputs of each layer are quantized per sample the
+ * same way, so that the matrix products are computed with 32-bit integer
+ * accumulation. This reduces the memory of the weights by a factor of four (or
+ * two for arma::fmat) at the cost of a small loss of accuracy.
+ *
+ * The network has to be a chain of full connections: every layer module holds
+ * exactly one connection that isn't fed by a bias layer, whose input is the
+ * output of the previous module (or the input layer of the network).
+ *
+ * @code
+ * FFNN<decltype(modules), decltype(outputLayer)> net(modules, outputLayer);
+ * // ... train the network ...
+ *
+ * FrozenFFNN<decltype(modules), decltype(outputLayer)> frozen(net.Network(),
+ *     outputLayer);
+ * frozen.Predict(input, output);
+ * @endcode
+ *
+ * @tparam ConnectionTypes Tuple that contains all connection module which are
+ * used to construct the network.
+ * @tparam OutputLayerType The outputlayer type used to evaluate the network.
+ * @tparam MatType Type of the weights and the activations (arma::mat or
+ * arma::fmat).
+ */
+template <
+  typename ConnectionTypes,
+  typename OutputLayerType,
+  typename MatType = arma::mat
+>
+class FrozenFFNN
+{
+  public:
+    /**
+     * Construct the FrozenFFNN object by copying the weights of the given
+     * (trained) network modules. The network modules are not modified and are
+     * not used after the construction.
+     *
+     * @param network The network modules of the trained network.
+     * @param outputLayer The outputlayer used to evaluate the network.
+     */
+    FrozenFFNN(ConnectionTypes& network, const OutputLayerType& outputLayer)
+        : outputLayer(outputLayer), parameterSize(0), quantized(false)
+    {
+      // Collect the shape of the weights first, so that all parameters can be
+      // stored in a single allocation.
+      PackLayers(network, false);
+      parameters.set_size(parameterSize);
+      PackLayers(network, true);
+    }
+
+    /**
+     * Evaluate the network using the given input. Every column of the input is
+     * a separate sample. The output activation is stored into the output
+     * parameter.
+     *
+     * @param input Input data used to evaluate the network.
+     * @param output Output data used to store the output activation.
+     */
+    void Predict(const MatType& input, MatType& output)
+    {
+      if (quantized)
+      {
+        PredictQuantized(input, output);
+        return;
+      }
+
+      const MatType* layerInput = &input;
+      for (size_t i = 0; i < layerOffset.size(); i++)
+      {
+        const MatType weights(parameters.memptr() + layerOffset[i],
+            layerRows[i], layerCols[i], false, true);
+        const arma::Col<typename MatType::elem_type> bias(
+            parameters.memptr() + layerOffset[i] + weights.n_elem,
+            layerRows[i], false, true);
+
+        // Alternate between the two buffers, so that the memory is reused if
+        // the batch size doesn't change between the calls.
+        MatType& layerOutput = activations[i % 2];
+        if (layerInput->n_rows != weights.n_cols)
+        {
+          Log::Fatal << "FrozenFFNN::Predict(): the input of layer " << i
+              << " has " << layerInput->n_rows << " rows, but "
+              << weights.n_cols << " are expected." << std::endl;
+        }
+
+        layerOutput = weights * (*layerInput);
+        layerOutput.each_col() += bias;
+        layerActivations[i].FeedForward(layerOutput);
+
+        layerInput = &layerOutput;
+      }
+
+      outputLayer.OutputClass(*layerInput, output);
+    }
+
+    /**
+     * Quantize the weights of every layer to 8-bit integers with one scale per
+     * row, for the inference-only path. The floating point weights are
+     * released afterwards; only the biases are kept in full precision. Calling
+     * Quantize() more than once has no effect.
+     */
+    void Quantize()
+    {
+      if (quantized)
+        return;
+
+      size_t weightSize = 0, rowSize = 0;
+      for (size_t i = 0; i < layerOffset.size(); i++)
+      {
+        weightSize += layerRows[i] * layerCols[i];
+        rowSize += layerRows[i];
+      }
+
+      quantizedWeights.resize(weightSize);
+      weightScales.set_size(rowSize);
+      biases.set_size(rowSize);
+
+      for (size_t i = 0, w = 0, r = 0; i < layerOffset.size(); i++)
+      {
+        const MatType weights(parameters.memptr() + layerOffset[i],
+            layerRows[i], layerCols[i], false, true);
+        biases.subvec(r, r + layerRows[i] - 1) = parameters.subvec(
+            layerOffset[i] + weights.n_elem, layerOffset[i] + weights.n_elem +
+            layerRows[i] - 1);
+
+        // The quantized weights are stored row-major, so that every output is
+        // the dot product of two contiguous integer vectors.
+        for (size_t j = 0; j < layerRows[i]; j++, r++)
+        {
+          weightScales[r] = QuantizationScale(weights.row(j));
+          for (size_t k = 0; k < layerCols[i]; k++, w++)
+          {
+            quantizedWeights[w] = QuantizeValue(weights(j, k),
+                weightScales[r]);
+          }
+        }
+      }
+
+      parameters.reset();
+      quantized = true;
+    }
+
+    //! Get whether the weights of the network are quantized.
+    bool Quantized() const { return quantized; }
+
+    //! Get the number of layers of the network.
+    size_t Layers() const { return layerOffset.size(); }
+
+    //! Get the packed parameters of the network (empty once quantized).
+    const arma::Col<typename MatType::elem_type>& Parameters() const
+    { return parameters; }
+
+    //! Get the quantized weights of the network (empty unless quantized).
+    const std::vector<int8_t>& QuantizedWeights() const
+    { return quantizedWeights; }
+
+  private:
+    //! The element type of the weights and the activations.
+    typedef typename MatType::elem_type ElemType;
+
+    /**
+     * Evaluate the network with the quantized weights. The input of every
+     * layer is quantized per sample, the products are accumulated in 32-bit
+     * integers, and the result is scaled back before the bias and the
+     * activation function are applied.
+     *
+     * @param input Input data used to evaluate the network.
+     * @param output Output data used to store the output activation.
+     */
+    void PredictQuantized(const MatType& input, MatType& output)
+    {
+      const MatType* layerInput = &input;
+      for (size_t i = 0, w = 0, r = 0; i < layerOffset.size(); i++)
+      {
+        const size_t rows = layerRows[i];
+        const size_t cols = layerCols[i];
+        if (layerInput->n_rows != cols)
+        {
+          Log::Fatal << "FrozenFFNN::Predict(): the input of layer " << i
+              << " has " << layerInput->n_rows << " rows, but " << cols
+              << " are expected." << std::endl;
+        }
+
+        const size_t samples = layerInput->n_cols;
+        quantizedInput.resize(cols * samples);
+        inputScales.set_size(samples);
+
+        MatType& layerOutput = activations[i % 2];
+        layerOutput.set_size(rows, samples);
+
+        const int8_t* weights = quantizedWeights.data() + w;
+        const ElemType* scales = weightScales.memptr() + r;
+        const ElemType* bias = biases.memptr() + r;
+
+        #pragma omp parallel for schedule(static)
+        for (size_t c = 0; c < samples; c++)
+        {
+          const ElemType* x = layerInput->colptr(c);
+          int8_t* qx = quantizedInput.data() + c * cols;
+
+          inputScales[c] = QuantizationScale(layerInput->col(c));
+          for (size_t k = 0; k < cols; k++)
+            qx[k] = QuantizeValue(x[k], inputScales[c]);
+
+          ElemType* out = layerOutput.colptr(c);
+          for (size_t j = 0; j < rows; j++)
+          {
+            // A plain loop over contiguous int8 data, which the compiler turns
+            // into packed multiply-add instructions.
+            const int8_t* qw = weights + j * cols;
+            int32_t sum = 0;
+            for (size_t k = 0; k < cols; k++)
+              sum += int32_t(qw[k]) * int32_t(qx[k]);
+
+            out[j] = ElemType(sum) * scales[j] * inputScales[c] + bias[j];
+          }
+        }
+
+        layerActivations[i].FeedForward(layerOutput);
+
+        layerInput = &layerOutput;
+        w += rows * cols;
+        r += rows;
+      }
+
+      outputLayer.OutputClass(*layerInput, output);
+    }
+
+    //! Get the scale that maps the given values onto [-127, 127].
+    template<typename VecType>
+    static ElemType QuantizationScale(const VecType& values)
+    {
+      const ElemType maxValue = arma::max(arma::abs(arma::vectorise(values)));
+      return (maxValue > 0) ? maxValue / 127 : ElemType(1);
+    }
+
+    //! Quantize the given value with the given scale.
+    static int8_t QuantizeValue(const ElemType value, const ElemType scale)
+    {
+      const long q = std::lround(value / scale);
+      return int8_t(std::max(-127L, std::min(127L, q)));
+    }
+
+    /**
+     * Abstract wrapper around the activation of a layer, so that the layers of
+     * different types can be stored together.
+     */
+    class ActivationWrapperBase
+    {
+     public:
+      virtual ~ActivationWrapperBase() { }
+
+      //! Apply the activation function of the layer in-place.
+      virtual void FeedForward(MatType& activation) = 0;
+    };
+
+    /**
+     * Wrapper that holds a copy of a layer without its activation and delta
+     * storage and uses it to apply the activation function.
+     */
+    template<typename LayerType>
+    class ActivationWrapper : public ActivationWrapperBase
+    {
+     public:
+      ActivationWrapper(const LayerType& layer) : layer(layer)
+      {
+        this->layer.InputActivation().reset();
+        this->layer.Delta().reset();
+      }
+
+      void FeedForward(MatType& activation)
+      {
+        layer.FeedForward(activation, activation);
+      }
+
+     private:
+      //! Locally-stored copy of the layer.
+      LayerType layer;
+    };
+
+    /**
+     * Iterate through all layer modules, to either collect the shape of the
+     * weights (pack = false) or to copy the weights into the parameter vector
+     * (pack = true).
+     *
+     * enable_if (SFINAE) is used to iterate through the network connection
+     * modules. The general case peels off the first type and recurses, as usual
+     * with variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    PackLayers(std::tuple<Tp...>& /* unused */, const bool /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    PackLayers(std::tuple<Tp...>& t, const bool pack)
+    {
+      // The input of the first module is the input layer of the network, the
+      // input of every other module is the output of the previous module.
+      const void* inputLayer = (I == 0) ? NULL :
+          &std::get<0>(std::get<I == 0 ? 0 : I - 1>(t)).OutputLayer();
+
+      if (!pack)
+      {
+        currentRows = 0;
+        currentCols = 0;
+
+        ConnectionShape(std::get<I>(t), inputLayer);
+        if (currentCols == 0)
+        {
+          Log::Fatal << "FrozenFFNN: layer module " << I << " is not fed by "
+              << "the previous module." << std::endl;
+        }
+
+        layerOffset.push_back(parameterSize);
+        layerRows.push_back(currentRows);
+        layerCols.push_back(currentCols);
+        parameterSize += currentRows * (currentCols + 1);
+
+        typedef typename std::remove_reference<decltype(
+            std::get<0>(std::get<I>(t)).OutputLayer())>::type LayerType;
+        layerActivations.push_back(new ActivationWrapper<LayerType>(
+            std::get<0>(std::get<I>(t)).OutputLayer()));
+      }
+      else
+      {
+        MatType weights(parameters.memptr() + layerOffset[I], layerRows[I],
+            layerCols[I], false, true);
+        MatType bias(parameters.memptr() + layerOffset[I] + weights.n_elem,
+            layerRows[I], 1, false, true);
+
+        bias.zeros();
+        ConnectionPack(std::get<I>(t), weights, bias);
+      }
+
+      PackLayers<I + 1, Tp...>(t, pack);
+    }
+
+    /**
+     * Check the connections of a layer module and store the number of columns
+     * of the weights of the connection that isn't fed by a bias layer.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connections.
+     * The general case peels off the first type and recurses, as usual with
+     * variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    ConnectionShape(std::tuple<Tp...>& /* unused */,
+                    const void* /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    ConnectionShape(std::tuple<Tp...>& t, const void* inputLayer)
+    {
+      typedef typename std::remove_reference<decltype(
+          std::get<I>(t))>::type ConnectionType;
+
+      if (ConnectionTraits<ConnectionType>::IsSelfConnection ||
+          ConnectionTraits<ConnectionType>::IsFullselfConnection ||
+          ConnectionTraits<ConnectionType>::IsPoolingConnection)
+      {
+        Log::Fatal << "FrozenFFNN: only full connections are supported."
+            << std::endl;
+      }
+
+      if (!LayerTraits<typename std::remove_reference<decltype(
+          std::get<I>(t).InputLayer())>::type>::IsBiasLayer)
+      {
+        if (currentCols != 0 || (inputLayer != NULL &&
+            inputLayer != &std::get<I>(t).InputLayer()))
+        {
+          Log::Fatal << "FrozenFFNN: every layer module has to be fed only by "
+              << "the previous module and bias layers." << std::endl;
+        }
+
+        currentRows = std::get<I>(t).Weights().n_rows;
+        currentCols = std::get<I>(t).Weights().n_cols;
+      }
+
+      ConnectionShape<I + 1, Tp...>(t, inputLayer);
+    }
+
+    /**
+     * Copy the weights of the connections of a layer module into the packed
+     * weights and fold the weights of the bias connections into the bias.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connections.
+     * The general case peels off the first type and recurses, as usual with
+     * variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    ConnectionPack(std::tuple<Tp...>& /* unused */,
+                   MatType& /* unused */,
+                   MatType& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    ConnectionPack(std::tuple<Tp...>& t, MatType& weights, MatType& bias)
+    {
+      if (LayerTraits<typename std::remove_reference<decltype(
+          std::get<I>(t).InputLayer())>::type>::IsBiasLayer)
+      {
+        // The activation of a bias layer is constant, so the bias connection
+        // adds the same vector for every sample.
+        bias += std::get<I>(t).Weights() *
+            std::get<I>(t).InputLayer().InputActivation().unsafe_col(0);
+      }
+      else
+      {
+        weights = std::get<I>(t).Weights();
+      }
+
+      ConnectionPack<I + 1, Tp...>(t, weights, bias);
+    }
+
+    //! The outputlayer used to evaluate the network.
+    OutputLayerType outputLayer;
+
+    //! The weights and biases of all layers, stored one layer after another.
+    arma::Col<typename MatType::elem_type> parameters;
+
+    //! The number of parameters.
+    size_t parameterSize;
+
+    //! The offset of the weights of every layer in the parameter vector.
+    std::vector<size_t> layerOffset;
+
+    //! The number of rows of the weights of every layer.
+    std::vector<size_t> layerRows;
+
+    //! The number of columns of the weights of every layer.
+    std::vector<size_t> layerCols;
+
+    //! The activation functions of the layers.
+    boost::ptr_vector<ActivationWrapperBase> layerActivations;
+
+    //! The buffers used to store the activations of the layers.
+    MatType activations[2];
+
+    //! The shape of the weights of the currently inspected layer.
+    size_t currentRows, currentCols;
+
+    //! Indicates whether the weights are quantized.
+    bool quantized;
+
+    //! The quantized weights of all layers, stored row-major one layer after
+    //! another.
+    std::vector<int8_t> quantizedWeights;
+
+    //! The scale of every row of the quantized weights.
+    arma::Col<ElemType> weightScales;
+
+    //! The biases of all layers, once the weights are quantized.
+    arma::Col<ElemType> biases;
+
+    //! The buffer used to store the quantized input of a layer.
+    std::vector<int8_t> quantizedInput;
+
+    //! The scale of every sample of the quantized input of a layer.
+    arma::Col<ElemType> inputScales;
+}; // class FrozenFFNN
+
+}; // namespace ann
+}; // namespace mlpack
+
+#endif
@@ -74,8 +74,7 @@ class KathirvalavakumarSubavathiInitialization
   template<typename eT>
   void Initialize(arma::Mat<eT>& W, const size_t rows, const size_t cols)
   {
-    arma::Row<eT> b = s * arma::sqrt(3 / (rows * dataSum));
-    const double theta = b.min();
+    const double theta = arma::min(s * arma::sqrt(3 / (rows * dataSum)));
 
     RandomInitialization randomInit(-theta, theta);
     randomInit.Initialize(W, rows, cols);
@@ -56,7 +56,8 @@ class BinaryClassificationLayer
   void OutputClass(const DataType& inputActivations, DataType& output)
   {
     output = inputActivations;
-    output.transform( [](double value) { return (value > 0.5 ? 1 : 0); } );
+    output.transform( [](typename DataType::elem_type value) {
+        return (value > 0.5 ? 1 : 0); } );
   }
 }; // class BinaryClassificationLayer
 
@@ -61,18 +61,7 @@ class LSTMLayer
       inputActivations(arma::zeros<VecType>(layerSize * 4)),
       layerSize(layerSize),
       seqLen(seqLen),
-      inGate(arma::zeros<MatType>(layerSize, seqLen)),
-      inGateAct(arma::zeros<MatType>(layerSize, seqLen)),
-      inGateError(arma::zeros<MatType>(layerSize, seqLen)),
-      outGate(arma::zeros<MatType>(layerSize, seqLen)),
-      outGateAct(arma::zeros<MatType>(layerSize, seqLen)),
-      outGateError(arma::zeros<MatType>(layerSize, seqLen)),
-      forgetGate(arma::zeros<MatType>(layerSize, seqLen)),
-      forgetGateAct(arma::zeros<MatType>(layerSize, seqLen)),
-      forgetGateError(arma::zeros<MatType>(layerSize, seqLen)),
-      state(arma::zeros<MatType>(layerSize, seqLen)),
-      stateError(arma::zeros<MatType>(layerSize, seqLen)),
-      cellAct(arma::zeros<MatType>(layerSize, seqLen)),
+      arena(arma::zeros<MatType>(layerSize * ArenaRows, seqLen)),
       offset(0),
       peepholes(peepholes)
   {
@@ -111,67 +100,58 @@ class LSTMLayer
    * Ordinary feed forward pass of a neural network, evaluating the function
    * f(x) by propagating the activity forward through f.
    *
+   * The input activation holds the pre-activations of the input gate, the
+   * forget gate, the cell and the output gate stacked on top of each other, so
+   * all four are computed by a single matrix product of the incoming
+   * connection. The state of every time step is stored in one column of the
+   * preallocated arena, so a time step doesn't allocate any memory.
+   *
    * @param inputActivation Input data used for evaluating the specified
    * activity function.
    * @param outputActivation Datatype to store the resulting output activation.
    */
   void FeedForward(const VecType& inputActivation, VecType& outputActivation)
   {
-    if (inGate.n_cols < seqLen)
-    {
-      inGate = arma::zeros<MatType>(layerSize, seqLen);
-      inGateAct = arma::zeros<MatType>(layerSize, seqLen);
-      inGateError = arma::zeros<MatType>(layerSize, seqLen);
-      outGate = arma::zeros<MatType>(layerSize, seqLen);
-      outGateAct = arma::zeros<MatType>(layerSize, seqLen);
-      outGateError = arma::zeros<MatType>(layerSize, seqLen);
-      forgetGate = arma::zeros<MatType>(layerSize, seqLen);
-      forgetGateAct = arma::zeros<MatType>(layerSize, seqLen);
-      forgetGateError = arma::zeros<MatType>(layerSize, seqLen);
-      state = arma::zeros<MatType>(layerSize, seqLen);
-      stateError = arma::zeros<MatType>(layerSize, seqLen);
-      cellAct = arma::zeros<MatType>(layerSize, seqLen);
-    }
+    if (arena.n_cols < seqLen)
+      arena = arma::zeros<MatType>(layerSize * ArenaRows, seqLen);
 
-    // Split up the inputactivation into the 3 parts (inGate, forgetGate,
-    // outGate).
-    inGate.col(offset) = inputActivation.subvec(0, layerSize - 1);
-    forgetGate.col(offset) = inputActivation.subvec(
-        layerSize, (layerSize * 2) - 1);
-    outGate.col(offset) = inputActivation.subvec(
-        layerSize * 3, (layerSize * 4) - 1);
+    // Store the stacked gate pre-activations (inGate, forgetGate, cell,
+    // outGate) at once.
+    VecType gates = Block(offset, Gates, 4);
+    gates = inputActivation;
 
     if (peepholes && offset > 0)
     {
-      inGate.col(offset) += inGatePeepholeWeights % state.col(offset - 1);
-      forgetGate.col(offset) += forgetGatePeepholeWeights %
-          state.col(offset - 1);
+      const VecType prevState = Block(offset - 1, State);
+      gates.subvec(0, layerSize - 1) += inGatePeepholeWeights % prevState;
+      gates.subvec(layerSize, (layerSize * 2) - 1) +=
+          forgetGatePeepholeWeights % prevState;
     }
 
-    VecType inGateActivation = inGateAct.unsafe_col(offset);
-    GateActivationFunction::fn(inGate.unsafe_col(offset), inGateActivation);
-
-    VecType forgetGateActivation = forgetGateAct.unsafe_col(offset);
-    GateActivationFunction::fn(forgetGate.unsafe_col(offset),
-        forgetGateActivation);
+    // The input gate and the forget gate are next to each other, so both are
+    // activated at once.
+    VecType inForgetGateActivation = Block(offset, InGateAct, 2);
+    GateActivationFunction::fn(Block(offset, Gates, 2),
+        inForgetGateActivation);
 
-    VecType cellActivation = cellAct.unsafe_col(offset);
-    StateActivationFunction::fn(inputActivation.subvec(layerSize * 2,
-        (layerSize * 3) - 1), cellActivation);
+    VecType cellActivation = Block(offset, CellAct);
+    StateActivationFunction::fn(Block(offset, Cell), cellActivation);
 
-    state.col(offset) = inGateAct.col(offset) % cellActivation;
+    VecType state = Block(offset, State);
+    state = Block(offset, InGateAct) % cellActivation;
 
     if (offset > 0)
-      state.col(offset) += forgetGateAct.col(offset) % state.col(offset - 1);
+      state += Block(offset, ForgetGateAct) % Block(offset - 1, State);
 
+    VecType outGate = Block(offset, OutGate);
     if (peepholes)
-      outGate.col(offset) += outGatePeepholeWeights % state.col(offset);
+      outGate += outGatePeepholeWeights % state;
 
-    VecType outGateActivation = outGateAct.unsafe_col(offset);
-    GateActivationFunction::fn(outGate.unsafe_col(offset), outGateActivation);
+    VecType outGateActivation = Block(offset, OutGateAct);
+    GateActivationFunction::fn(outGate, outGateActivation);
 
-    OutputActivationFunction::fn(state.unsafe_col(offset), outputActivation);
-    outputActivation = outGateAct.col(offset) % outputActivation;
+    OutputActivationFunction::fn(state, outputActivation);
+    outputActivation = outGateActivation % outputActivation;
 
     offset = (offset + 1) % seqLen;
   }
@@ -190,101 +170,84 @@ class LSTMLayer
                     const VecType& error,
                     VecType& delta)
   {
-    size_t queryOffset = seqLen - offset - 1;
+    const size_t queryOffset = seqLen - offset - 1;
 
-    VecType outGateDerivative;
-    GateActivationFunction::deriv(outGateAct.unsafe_col(queryOffset),
-        outGateDerivative);
+    const VecType inGateAct = Block(queryOffset, InGateAct);
+    const VecType forgetGateAct = Block(queryOffset, ForgetGateAct);
+    const VecType cellAct = Block(queryOffset, CellAct);
+    const VecType outGateAct = Block(queryOffset, OutGateAct);
+    const VecType state = Block(queryOffset, State);
 
-    VecType stateActivation;
-    StateActivationFunction::fn(state.unsafe_col(queryOffset), stateActivation);
+    VecType inGateError = Block(queryOffset, InGateError);
+    VecType forgetGateError = Block(queryOffset, ForgetGateError);
+    VecType cellError = Block(queryOffset, CellError);
+    VecType outGateError = Block(queryOffset, OutGateError);
+    VecType stateError = Block(queryOffset, StateError);
 
-    outGateError.col(queryOffset) = outGateDerivative % error % stateActivation;
+    GateActivationFunction::deriv(outGateAct, derivative);
+    StateActivationFunction::fn(state, stateActivation);
 
-    VecType stateDerivative;
-    StateActivationFunction::deriv(stateActivation, stateDerivative);
+    outGateError = derivative % error % stateActivation;
 
-    stateError.col(queryOffset) = error % outGateAct.col(queryOffset) %
-        stateDerivative;
+    StateActivationFunction::deriv(stateActivation, derivative);
+    stateError = error % outGateAct % derivative;
 
     if (queryOffset < (seqLen - 1))
     {
-      stateError.col(queryOffset) += stateError.col(queryOffset + 1) %
-          forgetGateAct.col(queryOffset + 1);
+      stateError += Block(queryOffset + 1, StateError) %
+          Block(queryOffset + 1, ForgetGateAct);
 
       if (peepholes)
       {
-        stateError.col(queryOffset) += inGateError.col(queryOffset + 1) %
+        stateError += Block(queryOffset + 1, InGateError) %
             inGatePeepholeWeights;
-        stateError.col(queryOffset) += forgetGateError.col(queryOffset + 1) %
+        stateError += Block(queryOffset + 1, ForgetGateError) %
             forgetGatePeepholeWeights;
       }
     }
 
     if (peepholes)
-    {
-      stateError.col(queryOffset) += outGateError.col(queryOffset) %
-          outGatePeepholeWeights;
-    }
-
-    VecType cellDerivative;
-    StateActivationFunction::deriv(cellAct.col(queryOffset), cellDerivative);
+      stateError += outGateError % outGatePeepholeWeights;
 
-    VecType cellError = inGateAct.col(queryOffset) % cellDerivative %
-        stateError.col(queryOffset);
+    StateActivationFunction::deriv(cellAct, derivative);
+    cellError = inGateAct % derivative % stateError;
 
     if (queryOffset > 0)
     {
-      VecType forgetGateDerivative;
-      GateActivationFunction::deriv(forgetGateAct.col(queryOffset),
-          forgetGateDerivative);
-
-      forgetGateError.col(queryOffset) = forgetGateDerivative %
-          stateError.col(queryOffset) % state.col(queryOffset - 1);
+      GateActivationFunction::deriv(forgetGateAct, derivative);
+      forgetGateError = derivative % stateError %
+          Block(queryOffset - 1, State);
     }
 
-    VecType inGateDerivative;
-    GateActivationFunction::deriv(inGateAct.col(queryOffset), inGateDerivative);
-
-    inGateError.col(queryOffset) = inGateDerivative %
-        stateError.col(queryOffset) % cellAct.col(queryOffset);
+    GateActivationFunction::deriv(inGateAct, derivative);
+    inGateError = derivative % stateError % cellAct;
 
-    if (peepholes)
+    if (peepholes && queryOffset > 0)
     {
-      outGateDerivative += outGateError.col(queryOffset) %
-          state.col(queryOffset);
-      if (queryOffset > 0)
-      {
-        inGatePeepholeDerivatives += inGateError.col(queryOffset) %
-            state.col(queryOffset - 1);
-        forgetGatePeepholeDerivatives += forgetGateError.col(queryOffset) %
-            state.col(queryOffset - 1);
-      }
+      inGatePeepholeDerivatives += inGateError % Block(queryOffset - 1, State);
+      forgetGatePeepholeDerivatives += forgetGateError %
+          Block(queryOffset - 1, State);
     }
 
-    delta = arma::zeros<VecType>(layerSize * 4);
-    delta.subvec(0, layerSize - 1) = inGateError.col(queryOffset);
-    delta.subvec(layerSize, (layerSize * 2) - 1) =
-        forgetGateError.col(queryOffset);
-    delta.subvec(layerSize * 2, (layerSize * 3) - 1) = cellError;
-    delta.subvec(layerSize * 3, (layerSize * 4) - 1) =
-        outGateError.col(queryOffset);
+    // The errors of the gates are stored in the same order as the gates, so
+    // they form the delta.
+    delta = Block(queryOffset, InGateError, 4);
 
     offset = (offset + 1) % seqLen;
 
     if (peepholes && offset == 0)
     {
       inGatePeepholeGradient = (inGatePeepholeWeights.t() *
-          (inGateError.col(queryOffset) % inGatePeepholeDerivatives)) *
-          inGate.col(queryOffset).t();
+          (inGateError % inGatePeepholeDerivatives)) *
+          Block(queryOffset, InGate).t();
 
       forgetGatePeepholeGradient = (forgetGatePeepholeWeights.t() *
-          (forgetGateError.col(queryOffset) % forgetGatePeepholeDerivatives)) *
-          forgetGate.col(queryOffset).t();
+          (forgetGateError % forgetGatePeepholeDerivatives)) *
+          Block(queryOffset, ForgetGate).t();
 
       outGatePeepholeGradient = (outGatePeepholeWeights.t() *
-          (outGateError.col(queryOffset) % outGatePeepholeDerivatives)) *
-          outGate.col(queryOffset).t();
+          (outGateError % outGatePeepholeDerivatives)) *
+          Block(queryOffset, OutGate).t();
 
       inGatePeepholeOptimizer->UpdateWeights(inGatePeepholeWeights,
           inGatePeepholeGradient.t(), 0);
@@ -365,41 +328,53 @@ class LSTMLayer
   //! Locally-stored length of the the input sequence.
   size_t seqLen;
 
-  //! Locally-stored ingate object.
-  MatType inGate;
-
-  //! Locally-stored ingate activation object.
-  MatType inGateAct;
-
-  //! Locally-stored ingate error object.
-  MatType inGateError;
-
-  //! Locally-stored outgate object.
-  MatType outGate;
-
-  //! Locally-stored outgate activation object.
-  MatType outGateAct;
-
-  //! Locally-stored outgate error object.
-  MatType outGateError;
-
-  //! Locally-stored forget object.
-  MatType forgetGate;
-
-  //! Locally-stored forget activation object.
-  MatType forgetGateAct;
+  /**
+   * The blocks of an arena column, in units of layerSize rows. The gate
+   * pre-activations, activations and errors are each stored in the order of
+   * the input activation (inGate, forgetGate, cell, outGate).
+   */
+  enum ArenaBlock
+  {
+    Gates = 0,
+    InGate = 0,
+    ForgetGate = 1,
+    Cell = 2,
+    OutGate = 3,
+    InGateAct = 4,
+    ForgetGateAct = 5,
+    CellAct = 6,
+    OutGateAct = 7,
+    InGateError = 8,
+    ForgetGateError = 9,
+    CellError = 10,
+    OutGateError = 11,
+    State = 12,
+    StateError = 13,
+    ArenaRows = 14
+  };
 
-  //! Locally-stored forget error object.
-  MatType forgetGateError;
+  /**
+   * Get a vector which uses the memory of the given block(s) of the arena
+   * column of the given time step.
+   *
+   * @param step The time step.
+   * @param block The first block.
+   * @param blocks The number of consecutive blocks.
+   */
+  VecType Block(const size_t step, const size_t block, const size_t blocks = 1)
+  {
+    return VecType(arena.colptr(step) + block * layerSize, blocks * layerSize,
+        false, true);
+  }
 
-  //! Locally-stored state object.
-  MatType state;
+  //! Locally-stored state of every time step (one column per time step).
+  MatType arena;
 
-  //! Locally-stored state erro object.
-  MatType stateError;
+  //! Locally-stored scratch space for the derivatives of the activations.
+  VecType derivative;
 
-  //! Locally-stored cell activation object.
-  MatType cellAct;
+  //! Locally-stored scratch space for the activation of the state.
+  VecType stateActivation;
 
   //! Locally-stored sequence offset.
   size_t offset;
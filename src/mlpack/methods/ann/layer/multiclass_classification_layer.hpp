@@ -62,7 +62,8 @@ class MulticlassClassificationLayer
    * @param inputActivations Input data used to calculate the output class.
    * @param output Output class of the input activation.
    */
-  void OutputClass(const VecType& inputActivations, VecType& output)
+  template<typename InputType, typename OutputType>
+  void OutputClass(const InputType& inputActivations, OutputType& output)
   {
     output = inputActivations;
   }
@@ -110,8 +110,9 @@ class NeuronLayer
    * activity function.
    * @param outputActivation Data to store the resulting output activation.
    */
-  void FeedForward(const DataType& inputActivation,
-                   DataType& outputActivation)
+  template<typename InputType, typename OutputType>
+  void FeedForward(const InputType& inputActivation,
+                   OutputType& outputActivation)
   {
     ActivationFunction::fn(inputActivation, outputActivation);
   }
@@ -152,8 +153,9 @@ class NeuronLayer
                     arma::Cube<eT>& delta)
   {
     // Generate a cube from the error matrix.
-    arma::Cube<eT> mappedError = arma::zeros<arma::cube>(inputActivation.n_rows,
-        inputActivation.n_cols, inputActivation.n_slices);
+    arma::Cube<eT> mappedError = arma::zeros<arma::Cube<eT> >(
+        inputActivation.n_rows, inputActivation.n_cols,
+        inputActivation.n_slices);
 
     for (size_t s = 0, j = 0; s < mappedError.n_slices; s+= error.n_cols, j++)
     {
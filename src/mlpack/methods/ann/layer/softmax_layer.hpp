@@ -45,10 +45,18 @@ class SoftmaxLayer
    * activity function.
    * @param outputActivation Data to store the resulting output activation.
    */
-  void FeedForward(const VecType& inputActivation, VecType& outputActivation)
+  template<typename InputType, typename OutputType>
+  void FeedForward(const InputType& inputActivation,
+                   OutputType& outputActivation)
   {
-    outputActivation = arma::trunc_exp(inputActivation);
-    outputActivation /= arma::accu(outputActivation);
+    // Normalize every column separately, so that a mini-batch of samples can
+    // be evaluated at once. The maximum of every column is subtracted first, so
+    // that exp() can't overflow; this doesn't change the result. All steps
+    // work in place on the output, which may also be the input.
+    outputActivation = inputActivation;
+    outputActivation.each_row() -= arma::max(outputActivation, 0);
+    outputActivation = arma::exp(outputActivation);
+    outputActivation.each_row() /= arma::sum(outputActivation, 0);
   }
 
   /**
@@ -0,0 +1,239 @@
+/**
+ * @file memory_planner.hpp
+ * @author Marcus Edel
+ *
+ * Definition of the MemoryPlanner class, which places buffers with known
+ * lifetimes in one shared arena.
+ */
+#ifndef __MLPACK_METHODS_ANN_MEMORY_PLANNER_HPP
+#define __MLPACK_METHODS_ANN_MEMORY_PLANNER_HPP
+
+#include <mlpack/core.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * The MemoryPlanner places the temporary buffers of a pass through a network
+ * in one arena.  Every buffer is requested with its size and its lifetime, the
+ * (inclusive) range of steps of the pass during which it is used; buffers
+ * whose lifetimes don't overlap may share memory.  Plan() then assigns an
+ * offset in the arena to every buffer, taking the buffers by decreasing size
+ * and putting each at the lowest offset where it doesn't collide with a
+ * buffer placed before it that is alive at the same time.
+ *
+ * The arena itself is owned by the network, which allocates it once with
+ * ArenaSize() elements and creates the buffers as views of it:
+ *
+ * @code
+ * MemoryPlanner planner;
+ * const size_t a = planner.Request(100, 0, 1);
+ * const size_t b = planner.Request(50, 2, 3);
+ * planner.Plan();
+ * arma::vec arena(planner.ArenaSize());
+ * arma::mat bufferA = planner.Buffer(arena, a, 10, 10);
+ * @endcode
+ */
+class MemoryPlanner
+{
+ public:
+  /**
+   * Create an empty planner.
+   */
+  MemoryPlanner() : arenaSize(0), totalSize(0), planned(true)
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Request a buffer of the given number of elements, used from step first to
+   * step last (inclusive).
+   *
+   * @param elements The number of elements of the buffer.
+   * @param first The first step that uses the buffer.
+   * @param last The last step that uses the buffer.
+   * @return The index of the buffer.
+   */
+  size_t Request(const size_t elements, const size_t first, const size_t last)
+  {
+    Block block;
+    block.elements = elements;
+    block.first = std::min(first, last);
+    block.last = std::max(first, last);
+    block.offset = 0;
+    blocks.push_back(block);
+
+    totalSize += Aligned(elements);
+    planned = false;
+    return blocks.size() - 1;
+  }
+
+  /**
+   * Assign an offset in the arena to every buffer that was requested.
+   */
+  void Plan()
+  {
+    // Place the largest buffers first.
+    std::vector<size_t> order(blocks.size());
+    for (size_t i = 0; i < order.size(); i++)
+      order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), LargerBlock(blocks));
+
+    arenaSize = 0;
+    std::vector<size_t> placed;
+    std::vector<std::pair<size_t, size_t> > taken;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      Block& block = blocks[order[i]];
+
+      // Collect the ranges of the arena used by the placed buffers that are
+      // alive at the same time, in increasing order.
+      taken.clear();
+      for (size_t j = 0; j < placed.size(); j++)
+      {
+        const Block& other = blocks[placed[j]];
+        if (other.first <= block.last && block.first <= other.last)
+        {
+          taken.push_back(std::make_pair(other.offset,
+              other.offset + Aligned(other.elements)));
+        }
+      }
+      std::sort(taken.begin(), taken.end());
+
+      // Take the first gap that is large enough.
+      size_t offset = 0;
+      for (size_t j = 0; j < taken.size(); j++)
+      {
+        if (taken[j].first >= offset + Aligned(block.elements))
+          break;
+
+        offset = std::max(offset, taken[j].second);
+      }
+
+      block.offset = offset;
+      arenaSize = std::max(arenaSize, offset + Aligned(block.elements));
+      placed.push_back(order[i]);
+    }
+
+    planned = true;
+  }
+
+  /**
+   * Get a matrix view of the given buffer in the given arena.  The view has
+   * fixed size: assigning a result of another size to it is an error.
+   *
+   * @param arena The arena, with at least ArenaSize() elements.
+   * @param index The index of the buffer.
+   * @param rows The number of rows of the view.
+   * @param cols The number of columns of the view.
+   */
+  template<typename eT>
+  arma::Mat<eT> Buffer(arma::Col<eT>& arena,
+                       const size_t index,
+                       const size_t rows,
+                       const size_t cols) const
+  {
+    return arma::Mat<eT>(arena.memptr() + Offset(index), rows, cols, false,
+        true);
+  }
+
+  /**
+   * Get a cube view of the given buffer in the given arena.  The view has
+   * fixed size: assigning a result of another size to it is an error.
+   *
+   * @param arena The arena, with at least ArenaSize() elements.
+   * @param index The index of the buffer.
+   * @param rows The number of rows of the view.
+   * @param cols The number of columns of the view.
+   * @param slices The number of slices of the view.
+   */
+  template<typename eT>
+  arma::Cube<eT> Buffer(arma::Col<eT>& arena,
+                        const size_t index,
+                        const size_t rows,
+                        const size_t cols,
+                        const size_t slices) const
+  {
+    return arma::Cube<eT>(arena.memptr() + Offset(index), rows, cols, slices,
+        false, true);
+  }
+
+  //! Get the offset of the given buffer in the arena.
+  size_t Offset(const size_t index) const
+  {
+    if (!planned)
+      Log::Fatal << "MemoryPlanner::Offset(): Plan() must be called after the "
+          << "last request!" << std::endl;
+
+    return blocks[index].offset;
+  }
+
+  //! Get the number of elements of the arena.
+  size_t ArenaSize() const { return arenaSize; }
+
+  //! Get the number of elements all buffers would take without sharing.
+  size_t TotalSize() const { return totalSize; }
+
+  //! Get the number of buffers that were requested.
+  size_t Buffers() const { return blocks.size(); }
+
+ private:
+  //! The buffers are placed at multiples of this number of elements, so
+  //! that they start on their own cache line.
+  static const size_t Alignment = 8;
+
+  //! A requested buffer.
+  struct Block
+  {
+    //! The number of elements.
+    size_t elements;
+    //! The first step that uses the buffer.
+    size_t first;
+    //! The last step that uses the buffer.
+    size_t last;
+    //! The offset in the arena.
+    size_t offset;
+  };
+
+  //! Order the buffers by decreasing size.
+  class LargerBlock
+  {
+   public:
+    LargerBlock(const std::vector<Block>& blocks) : blocks(blocks) { }
+
+    bool operator()(const size_t a, const size_t b) const
+    {
+      return blocks[a].elements > blocks[b].elements;
+    }
+
+   private:
+    const std::vector<Block>& blocks;
+  };
+
+  //! Round the given number of elements up to the alignment.
+  static size_t Aligned(const size_t elements)
+  {
+    return (elements + Alignment - 1) / Alignment * Alignment;
+  }
+
+  //! The requested buffers.
+  std::vector<Block> blocks;
+
+  //! The number of elements of the arena.
+  size_t arenaSize;
+
+  //! The number of elements of all buffers without sharing.
+  size_t totalSize;
+
+  //! Whether the offsets are up to date.
+  bool planned;
+}; // class MemoryPlanner
+
+}; // namespace ann
+}; // namespace mlpack
+
+#endif
@@ -43,6 +43,73 @@ class MaxPooling
     output = MatType(input.n_rows, input.n_cols);
     output.fill(value / input.n_elem);
   }
+  /*
+   * Pool a whole feature map in one pass over its columns. Every block of
+   * rStep x cStep values (the blocks don't overlap) is reduced to its maximum,
+   * which is added to the corresponding entry of the output, and the linear
+   * index of the maximum in the input is stored for the backward pass.
+   *
+   * @param input Input feature map used to perform the pooling operation.
+   * @param rStep Number of rows of every block.
+   * @param cStep Number of columns of every block.
+   * @param output The pooled output data (added to).
+   * @param indices The indices of the maxima within the input.
+   */
+  template<typename eT>
+  void Pooling(const arma::Mat<eT>& input,
+               const size_t rStep,
+               const size_t cStep,
+               arma::Mat<eT>& output,
+               arma::Mat<size_t>& indices)
+  {
+    const size_t outRows = input.n_rows / rStep;
+    const size_t outCols = input.n_cols / cStep;
+    indices.set_size(outRows, outCols);
+
+    for (size_t oc = 0; oc < outCols; oc++)
+    {
+      // Start with the first value of every block of this column of blocks.
+      size_t* bestIndex = indices.colptr(oc);
+      for (size_t o = 0; o < outRows; o++)
+        bestIndex[o] = oc * cStep * input.n_rows + o * rStep;
+
+      for (size_t j = oc * cStep; j < (oc + 1) * cStep; j++)
+      {
+        const eT* inCol = input.colptr(j);
+        for (size_t o = 0, i = 0; o < outRows; o++)
+        {
+          for (size_t end = i + rStep; i < end; i++)
+            if (inCol[i] > input[bestIndex[o]])
+              bestIndex[o] = j * input.n_rows + i;
+        }
+      }
+
+      eT* outCol = output.colptr(oc);
+      for (size_t o = 0; o < outRows; o++)
+        outCol[o] += input[bestIndex[o]];
+    }
+  }
+
+  /*
+   * Unpool a whole feature map: the error of every block is passed to the
+   * position of its maximum, which was stored by the pooling pass.
+   *
+   * @param error The error of the pooled output.
+   * @param rStep Number of rows of every block.
+   * @param cStep Number of columns of every block.
+   * @param indices The indices of the maxima within the input.
+   * @param output The unpooled output data (added to).
+   */
+  template<typename eT>
+  void Unpooling(const arma::Mat<eT>& error,
+                 const size_t /* rStep */,
+                 const size_t /* cStep */,
+                 const arma::Mat<size_t>& indices,
+                 arma::Mat<eT>& output)
+  {
+    for (size_t k = 0; k < indices.n_elem; k++)
+      output[indices[k]] += error[k];
+  }
 };
 
 }; // namespace ann
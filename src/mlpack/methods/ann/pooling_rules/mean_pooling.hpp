@@ -43,6 +43,72 @@ class MeanPooling
     output = MatType(input.n_rows, input.n_cols);
     output.fill(value / input.n_elem);
   }
+  /*
+   * Pool a whole feature map in one pass over its columns. Every block of
+   * rStep x cStep values (the blocks don't overlap) is reduced to its mean,
+   * which is added to the corresponding entry of the output.
+   *
+   * @param input Input feature map used to perform the pooling operation.
+   * @param rStep Number of rows of every block.
+   * @param cStep Number of columns of every block.
+   * @param output The pooled output data (added to).
+   * @param indices Unused; the mean doesn't depend on the positions.
+   */
+  template<typename eT>
+  void Pooling(const arma::Mat<eT>& input,
+               const size_t rStep,
+               const size_t cStep,
+               arma::Mat<eT>& output,
+               arma::Mat<size_t>& /* indices */)
+  {
+    const size_t outRows = input.n_rows / rStep;
+    const size_t outCols = input.n_cols / cStep;
+    const eT scale = eT(1) / (rStep * cStep);
+
+    for (size_t oc = 0; oc < outCols; oc++)
+    {
+      eT* outCol = output.colptr(oc);
+      for (size_t j = oc * cStep; j < (oc + 1) * cStep; j++)
+      {
+        const eT* inCol = input.colptr(j);
+        for (size_t o = 0, i = 0; o < outRows; o++)
+        {
+          eT sum = 0;
+          for (size_t end = i + rStep; i < end; i++)
+            sum += inCol[i];
+
+          outCol[o] += scale * sum;
+        }
+      }
+    }
+  }
+
+  /*
+   * Unpool a whole feature map: the error of every block is spread evenly
+   * over the block.
+   *
+   * @param error The error of the pooled output.
+   * @param rStep Number of rows of every block.
+   * @param cStep Number of columns of every block.
+   * @param indices Unused; the mean doesn't depend on the positions.
+   * @param output The unpooled output data (added to).
+   */
+  template<typename eT>
+  void Unpooling(const arma::Mat<eT>& error,
+                 const size_t rStep,
+                 const size_t cStep,
+                 const arma::Mat<size_t>& /* indices */,
+                 arma::Mat<eT>& output)
+  {
+    const eT scale = eT(1) / (rStep * cStep);
+    for (size_t j = 0; j < error.n_cols * cStep; j++)
+    {
+      const eT* errorCol = error.colptr(j / cStep);
+      eT* outCol = output.colptr(j);
+      for (size_t i = 0; i < error.n_rows * rStep; i++)
+        outCol[i] += scale * errorCol[i / rStep];
+    }
+  }
 };
 
 }; // namespace ann
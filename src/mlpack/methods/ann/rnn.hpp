@@ -22,6 +22,21 @@ namespace ann /** Artificial Neural Network. */ {
 /**
  * An implementation of a recurrent neural network.
  *
+ * The network is trained with backpropagation through time.  By default, the
+ * activations of every step of the input sequence are stored for the backward
+ * pass, so memory grows linearly with the sequence length.  If a truncation
+ * window is given, the backward pass is run over each window of that many
+ * steps as soon as its forward pass is done, so only the activations of one
+ * window are stored, and the recurrent state (but no gradient) is carried over
+ * to the next window.  The gradients of all the windows are summed until
+ * ApplyGradients() is called.
+ *
+ * If the layers of the network store their activations in a matrix type (and
+ * the self connections and VecTypeDelta are matrix types), each column of the
+ * input is treated as a separate sequence, so several sequences of the same
+ * length are propagated as one batch, and the gradients are summed over the
+ * batch.
+ *
  * @tparam ConnectionTypes Tuple that contains all connection module which will
  * be used to construct the network.
  * @tparam OutputLayerType The outputlayer type used to evaluate the network.
@@ -46,10 +61,14 @@ class RNN
      *
      * @param network The network modules used to construct the network.
      * @param outputLayer The outputlayer used to evaluate the network.
+     * @param bpttWindow Number of steps to backpropagate through at a time
+     *     (0 backpropagates through the whole sequence).
      */
-    RNN(const ConnectionTypes& network, OutputLayerType& outputLayer) :
-        network(network), err(0),  trainError(0), seqNum(0),
-        outputLayer(outputLayer)
+    RNN(const ConnectionTypes& network,
+        OutputLayerType& outputLayer,
+        const size_t bpttWindow = 0) :
+        network(network), err(0),  trainError(0), seqNum(0), batchSize(1),
+        windowStart(0), outputLayer(outputLayer), bpttWindow(bpttWindow)
     {
       // Nothing to do here.
     }
@@ -57,7 +76,13 @@ class RNN
     /**
      * Run a single iteration of the feed forward algorithm, using the given
      * input and target vector, updating the resulting error into the error
-     * vector.
+     * vector.  If a truncation window is set, the backward pass of every full
+     * window except the last one is run here as well.
+     *
+     * Each column of the input is one sequence; with more than one column, the
+     * layers have to store their activations in a matrix type.  The error of
+     * step i of the sequences is stored in columns i * n, ..., (i + 1) * n - 1
+     * of the error matrix, where n is the number of sequences.
      *
      * @param input Input data used for evaluating the network.
      * @param target Target data used to calculate the network error.
@@ -72,29 +97,24 @@ class RNN
     {
       // Initialize the activation storage only once.
       if (!activations.size())
-      {
-        InitLayer(network, input);
-      }
-      else
-      {
-        // Expand the activation storage to handle sequences of
-        // different length.
-        if (activations[0].n_cols < input.n_elem)
-        {
-          for (size_t i = 0; i < activations.size(); i++)
-          {
-            activations[i].insert_cols(activations[i].n_cols,
-                arma::zeros<MatType>(activations[i].n_rows,
-                input.n_elem - activations[i].n_cols));
-          }
-        }
-      }
+        InitLayer(network);
 
+      batchSize = input.n_cols;
       seqLen = input.n_rows / inputSize;
-      seqOutput = outputSize < target.n_elem ? true : false;
-      error = MatType(outputSize, outputSize < target.n_elem ? seqLen : 1);
+      seqOutput = outputSize < target.n_rows ? true : false;
+      error = MatType(outputSize, (seqOutput ? seqLen : 1) * batchSize);
+
+      // Expand the activation storage to hold one window of the sequences.
+      const size_t storedSteps = (bpttWindow == 0) ? seqLen :
+          std::min(bpttWindow, seqLen);
+      for (size_t i = 0; i < activations.size(); i++)
+      {
+        if (activations[i].n_cols < storedSteps * batchSize)
+          activations[i].zeros(activations[i].n_rows, storedSteps * batchSize);
+      }
 
       // Iterate through the input sequence and perform the feed forward pass.
+      windowStart = 0;
       for (seqNum = 0; seqNum < seqLen; seqNum++)
       {
         // Reset the network by zeroing the layer activations.
@@ -102,24 +122,41 @@ class RNN
 
         // Set the current input activation.
         std::get<0>(std::get<0>(
-            network)).InputLayer().InputActivation() = input.submat(
-            seqNum * inputSize, 0, (seqNum + 1) * inputSize - 1, 0);
+            network)).InputLayer().InputActivation() = input.rows(
+            seqNum * inputSize, (seqNum + 1) * inputSize - 1);
 
         // Perform the forward pass and calculate the output error.
         LayerForward(network);
         if (seqOutput)
         {
-          arma::colvec seqError = error.unsafe_col(seqNum);
-          arma::colvec seqTarget = target.subvec(seqNum * outputSize,
-              (seqNum + 1) * outputSize - 1);
-
-          OutputError(network, seqTarget, seqError);
+          OutputError(network, target.rows(seqNum * outputSize,
+              (seqNum + 1) * outputSize - 1), error, seqNum * batchSize);
         }
 
-        // Save the network activation for the backward/forward pass and update
-        // the recurrent connections.
-        if (seqNum < (input.n_rows / inputSize - 1))
+        if (seqNum == seqLen - 1)
+          break;
+
+        if (bpttWindow > 0 && seqNum - windowStart + 1 == bpttWindow)
         {
+          // The window is full: backpropagate through it now, if there is an
+          // error to propagate, and start the next window with the recurrent
+          // state of this step.
+          const size_t step = seqNum;
+          stateNum = 0;
+          StoreRecurrentState(network);
+
+          if (seqOutput)
+            BackwardWindow(error);
+
+          seqNum = step;
+          stateNum = 0;
+          RestoreRecurrentState(network);
+          windowStart = seqNum + 1;
+        }
+        else
+        {
+          // Save the network activation for the backward/forward pass and
+          // update the recurrent connections.
           layerNum = 0;
           SaveActivations(network);
         }
@@ -127,44 +164,20 @@ class RNN
 
       // Calculate the error only once for a non-sequence input.
       if (!seqOutput)
-      {
-        seqNum = 0;
-        arma::colvec seqError = error.unsafe_col(seqNum);
-        OutputError(network, target, seqError);
-      }
+        OutputError(network, target, error, 0);
     }
 
     /**
      * Run a single iteration of the feed backward algorithm, using the given
-     * error of the output layer.
+     * error of the output layer.  If a truncation window is set, only the last
+     * window of the sequence is left to backpropagate through.
      *
      * @param error The calulated error of the output layer.
      */
     void FeedBackward(const MatType& error)
     {
-      // Reset the network deltas by zeroing the storage.
-      for (size_t i = 0; i < delta.size(); i++)
-          delta[i].zeros();
-
-      // Iterate through the input sequence and perform the feed backward pass.
-      for (seqNum = seqLen - 1; seqNum >= 0; seqNum--)
-      {
-        gradientNum = 0;
-        deltaNum = 0;
-
-        // Perform the backward pass and update the gradient storage.
-        arma::colvec seqError = error.unsafe_col(seqOutput ? seqNum : 0);
-        LayerBackward(network, seqError);
-        UpdateGradients(network);
-
-        // Load the network activation for the upcoming backward pass.
-        if (seqNum > 0)
-        {
-          layerNum = 0;
-          LoadActivations(network);
-        }
-        else if (seqNum == 0) break;
-      }
+      seqNum = seqLen - 1;
+      BackwardWindow(error);
     }
 
     /**
@@ -193,9 +206,16 @@ class RNN
     template <typename VecType>
     void Predict(const VecType& input, VecType& output)
     {
+      if (!activations.size())
+        InitLayer(network);
+
+      batchSize = input.n_cols;
       seqLen = input.n_rows / inputSize;
+      if (seqOutput)
+        output.reset();
 
       // Iterate through the input sequence and perform the feed forward pass.
+      // No activations have to be stored for prediction.
       for (seqNum = 0; seqNum < seqLen; seqNum++)
       {
         // Reset the network by zeroing the layer activations.
@@ -203,24 +223,25 @@ class RNN
 
         // Set the current input activation.
         std::get<0>(std::get<0>(
-            network)).InputLayer().InputActivation() = input.submat(
-            seqNum * inputSize, 0, (seqNum + 1) * inputSize - 1, 0);
+            network)).InputLayer().InputActivation() = input.rows(
+            seqNum * inputSize, (seqNum + 1) * inputSize - 1);
 
         // Perform the forward pass and calculate the output error.
         LayerForward(network);
         if (seqOutput)
         {
-          arma::colvec targetCol;
-          OutputPrediction(network, targetCol);
-          output = arma::join_cols(output, targetCol);
+          VecType stepOutput;
+          OutputPrediction(network, stepOutput);
+          output = arma::join_cols(output, stepOutput);
         }
 
-        // Save the network activation for the backward/forward pass and update
-        // the recurrent connections.
-        if (seqNum < (input.n_rows / inputSize - 1))
+        // Update the recurrent connections.
+        if (seqNum < seqLen - 1)
         {
-          layerNum = 0;
-          SaveActivations(network);
+          stateNum = 0;
+          StoreRecurrentState(network);
+          stateNum = 0;
+          RestoreRecurrentState(network);
         }
       }
 
@@ -249,7 +270,62 @@ class RNN
     //! Get the error of the network.
     double Error() const { return trainError; }
 
+    //! Get the truncation window (0 means the whole sequence).
+    size_t BPTTWindow() const { return bpttWindow; }
+    //! Modify the truncation window (0 means the whole sequence).
+    size_t& BPTTWindow() { return bpttWindow; }
+
   private:
+    /**
+     * Run the backward pass from the current step back to the first step of
+     * the current window, and sum up the gradients.  For a non-sequence
+     * output, the error is only injected at the last step of the sequence.
+     *
+     * @param error The calulated error of the output layer.
+     */
+    void BackwardWindow(const MatType& error)
+    {
+      // Reset the network deltas by zeroing the storage; no delta is carried
+      // over from a later window.
+      for (size_t i = 0; i < delta.size(); i++)
+        delta[i].zeros(delta[i].n_rows, batchSize);
+
+      // Iterate backward through the window and perform the feed backward
+      // pass.
+      while (true)
+      {
+        gradientNum = 0;
+        deltaNum = 0;
+
+        // Perform the backward pass and update the gradient storage.
+        MatType stepError;
+        if (seqOutput)
+          stepError = error.cols(seqNum * batchSize,
+              (seqNum + 1) * batchSize - 1);
+        else if (seqNum == seqLen - 1)
+          stepError = error;
+        else
+          stepError.zeros(error.n_rows, batchSize);
+
+        LayerBackward(network, stepError);
+        UpdateGradients(network);
+
+        if (seqNum == windowStart)
+          break;
+
+        // Load the network activation for the upcoming backward pass.
+        layerNum = 0;
+        LoadActivations(network);
+        seqNum--;
+      }
+    }
+
+    //! Get the first storage column of the given step of the current window.
+    size_t Slot(const size_t step) const
+    {
+      return (step - windowStart) * batchSize;
+    }
+
     /**
      * Helper function to reset the network by zeroing the layer activations.
      *
@@ -288,7 +364,7 @@ class RNN
           decltype(std::get<I>(t).InputLayer())>::type, Tp...>(t);
 
       std::get<I>(t).OutputLayer().InputActivation().zeros(
-          std::get<I>(t).OutputLayer().InputSize());
+          std::get<I>(t).OutputLayer().InputSize(), batchSize);
 
       // Reset the recurrent connection only at the beginning of a new sequence.
       if (seqNum == 0 && (ConnectionTraits<typename std::remove_reference<
@@ -297,7 +373,16 @@ class RNN
           std::get<I>(t))>::type>::IsFullselfConnection))
       {
         std::get<I>(t).InputLayer().InputActivation().zeros(
-          std::get<I>(t).InputLayer().InputSize());
+          std::get<I>(t).InputLayer().InputSize(), batchSize);
+      }
+
+      // The activation of a bias layer is a constant one for every sequence.
+      if (LayerTraits<typename std::remove_reference<decltype(
+          std::get<I>(t).InputLayer())>::type>::IsBiasLayer &&
+          std::get<I>(t).InputLayer().InputActivation().n_cols != batchSize)
+      {
+        std::get<I>(t).InputLayer().InputActivation().ones(
+            std::get<I>(t).InputLayer().InputActivation().n_rows, batchSize);
       }
 
       Reset<I + 1, Tp...>(t);
@@ -325,6 +410,11 @@ class RNN
         LayerTraits<LayerType>::IsLSTMLayer == true, void>::type
     Parameter(std::tuple<Tp...>& t)
     {
+      // The LSTM layer keeps its own storage for the whole sequence.
+      if (bpttWindow > 0 && bpttWindow < seqLen)
+        Log::Fatal << "RNN: truncated backpropagation through time is not "
+            << "supported for networks with LSTM layers." << std::endl;
+
       std::get<I>(t).InputLayer().SeqLen() = seqLen;
     }
 
@@ -376,27 +466,46 @@ class RNN
     }
 
     /*
-     * Calculate the output error and update the overall error.
+     * Calculate the output error of the current step, store it in the columns
+     * of the error matrix starting at the given column, and update the overall
+     * error.
      */
-    template<typename VecType, typename... Tp>
+    template<typename TargetType, typename... Tp>
     void OutputError(std::tuple<Tp...>& t,
-                     const VecType& target,
-                     VecType& error)
+                     const TargetType& target,
+                     MatType& error,
+                     const size_t errorCol)
     {
-       // Calculate and store the output error.
-      outputLayer.CalculateError(std::get<0>(
-          std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation(),
-          target, error);
+      auto& activation = std::get<0>(
+          std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation();
+      typedef typename std::remove_reference<decltype(activation)>::type
+          DataType;
+
+      // Calculate and store the output error.
+      const DataType stepTarget = target;
+      DataType stepError;
+      outputLayer.CalculateError(activation, stepTarget, stepError);
+      error.cols(errorCol, errorCol + batchSize - 1) = stepError;
 
       // Save the output activation for the upcoming feed backward pass.
-      activations.back().unsafe_col(seqNum) = std::get<0>(
-          std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation();
+      activations.back().cols(Slot(seqNum), Slot(seqNum) + batchSize - 1) =
+          activation;
 
       // Masures the network's performance with the specified performance
-      // function.
-      err = PerformanceFunction::Error(std::get<0>(
-          std::get<sizeof...(Tp) - 1>(t)).OutputLayer().InputActivation(),
-          target);
+      // function, summed over the sequences of a batch.
+      if (batchSize == 1)
+      {
+        err = PerformanceFunction::Error(activation, stepTarget);
+      }
+      else
+      {
+        err = 0;
+        for (size_t i = 0; i < batchSize; i++)
+        {
+          err += PerformanceFunction::Error(DataType(activation.col(i)),
+              DataType(stepTarget.col(i)));
+        }
+      }
 
       // Update the overall training error.
       trainError += err;
@@ -441,7 +550,8 @@ class RNN
         // Use the first connection from the last connection module to
         // calculate the error.
         std::get<0>(std::get<sizeof...(Tp) - I>(t)).OutputLayer().FeedBackward(
-            activations.back().unsafe_col(seqNum), error,
+            activations.back().cols(Slot(seqNum), Slot(seqNum) + batchSize - 1),
+            error,
             std::get<0>(std::get<sizeof...(Tp) - I>(t)).OutputLayer().Delta());
       }
 
@@ -496,7 +606,7 @@ class RNN
         // Sum up the stored delta for recurrent connections.
         if (recurrentLayer[layer])
         {
-          std::get<I>(t).Delta() += delta[deltaNum].subvec(
+          std::get<I>(t).Delta() += delta[deltaNum].rows(
               0, std::get<I>(t).InputLayer().OutputSize() - 1);
         }
 
@@ -613,16 +723,16 @@ class RNN
      */
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I == sizeof...(Tp), void>::type
-    InitLayer(std::tuple<Tp...>& t, const MatType& input)
+    InitLayer(std::tuple<Tp...>& t)
     {
       recurrentLayer.push_back(false);
       outputSize = std::get<0>(std::get<I - 1>(t)).OutputLayer().OutputSize();
-      activations.push_back(new MatType(outputSize, input.n_elem));
+      activations.push_back(new MatType(outputSize, 0));
     }
 
     template<size_t I = 0, typename... Tp>
     typename std::enable_if<I < sizeof...(Tp), void>::type
-    InitLayer(std::tuple<Tp...>& t, const MatType& input)
+    InitLayer(std::tuple<Tp...>& t)
     {
       if (I == 0)
         inputSize = std::get<0>(std::get<I>(t)).InputLayer().InputSize();
@@ -630,8 +740,8 @@ class RNN
       recurrentLayer.push_back(false);
       Recurrent(std::get<sizeof...(Tp) - I - 1>(t));
 
-      Layer(std::get<I>(t), input, I);
-      InitLayer<I + 1, Tp...>(t, input);
+      Layer(std::get<I>(t));
+      InitLayer<I + 1, Tp...>(t);
     }
 
     template<size_t I = 0, typename... Tp>
@@ -648,7 +758,8 @@ class RNN
             std::get<I>(t))>::type>::IsFullselfConnection)
       {
         recurrentLayer.back() = true;
-        delta.push_back(new VecTypeDelta(std::get<I>(t).Weights().n_rows));
+        delta.push_back(new VecTypeDelta(arma::zeros<VecTypeDelta>(
+            std::get<I>(t).Weights().n_rows, 1)));
       }
       else
       {
@@ -665,23 +776,21 @@ class RNN
      * connections, and one for the general case which peels off the first type
      * and recurses, as usual with variadic function templates.
      */
-    template<size_t I = 0, typename VecType, typename... Tp>
+    template<size_t I = 0, typename... Tp>
     typename std::enable_if<I == sizeof...(Tp), void>::type
-    Layer(std::tuple<Tp...>& /* unusded */,
-          const VecType& /* unused */,
-          const size_t /* unsued */) { }
+    Layer(std::tuple<Tp...>& /* unusded */) { }
 
-    template<size_t I = 0, typename VecType, typename... Tp>
+    template<size_t I = 0, typename... Tp>
     typename std::enable_if<I < sizeof...(Tp), void>::type
-    Layer(std::tuple<Tp...>& t, const VecType& input, const size_t layer)
+    Layer(std::tuple<Tp...>& t)
     {
       activations.push_back(new MatType(
-        std::get<I>(t).InputLayer().OutputSize(), input.n_elem));
+        std::get<I>(t).InputLayer().OutputSize(), 0));
 
       gradients.push_back(new MatType(std::get<I>(t).Weights().n_rows,
           std::get<I>(t).Weights().n_cols, arma::fill::zeros));
 
-      Layer<I + 1, VecType, Tp...>(t, input, layer);
+      Layer<I + 1, Tp...>(t);
     }
 
     /**
@@ -720,7 +829,8 @@ class RNN
     Load(std::tuple<Tp...>& t)
     {
       std::get<I>(t).InputLayer().InputActivation() =
-          activations[layerNum++].unsafe_col(seqNum - 1);
+          activations[layerNum++].cols(Slot(seqNum - 1),
+          Slot(seqNum - 1) + batchSize - 1);
       Load<I + 1, Tp...>(t);
     }
 
@@ -759,7 +869,7 @@ class RNN
     typename std::enable_if<I < sizeof...(Tp), void>::type
     Save(std::tuple<Tp...>& t)
     {
-      activations[layerNum++].unsafe_col(seqNum) =
+      activations[layerNum++].cols(Slot(seqNum), Slot(seqNum) + batchSize - 1) =
           std::get<I>(t).InputLayer().InputActivation();
 
       // Use the activation from the corresponding outputlayer for
@@ -776,6 +886,106 @@ class RNN
       Save<I + 1, Tp...>(t);
     }
 
+    /**
+     * Helper function to iterate through all connection modules and to store
+     * the output activations of the recurrent connections, which are the
+     * recurrent state for the next step.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connection
+     * modules. The general case peels off the first type and recurses, as usual
+     * with variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    StoreRecurrentState(std::tuple<Tp...>& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    StoreRecurrentState(std::tuple<Tp...>& t)
+    {
+      StoreState(std::get<I>(t));
+      StoreRecurrentState<I + 1, Tp...>(t);
+    }
+
+    /**
+     * Store the output activations of the recurrent connections.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connections.
+     * The general case peels off the first type and recurses, as usual with
+     * variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    StoreState(std::tuple<Tp...>& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    StoreState(std::tuple<Tp...>& t)
+    {
+      if (ConnectionTraits<typename std::remove_reference<decltype(
+              std::get<I>(t))>::type>::IsSelfConnection ||
+          ConnectionTraits<typename std::remove_reference<decltype(
+              std::get<I>(t))>::type>::IsFullselfConnection)
+      {
+        if (stateNum == recurrentState.size())
+          recurrentState.push_back(new MatType());
+
+        recurrentState[stateNum++] =
+            std::get<I>(t).OutputLayer().InputActivation();
+      }
+
+      StoreState<I + 1, Tp...>(t);
+    }
+
+    /**
+     * Helper function to iterate through all connection modules and to set the
+     * input activations of the recurrent connections to the stored recurrent
+     * state.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connection
+     * modules. The general case peels off the first type and recurses, as usual
+     * with variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    RestoreRecurrentState(std::tuple<Tp...>& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    RestoreRecurrentState(std::tuple<Tp...>& t)
+    {
+      RestoreState(std::get<I>(t));
+      RestoreRecurrentState<I + 1, Tp...>(t);
+    }
+
+    /**
+     * Set the input activations of the recurrent connections to the stored
+     * recurrent state.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connections.
+     * The general case peels off the first type and recurses, as usual with
+     * variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    RestoreState(std::tuple<Tp...>& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    RestoreState(std::tuple<Tp...>& t)
+    {
+      if (ConnectionTraits<typename std::remove_reference<decltype(
+              std::get<I>(t))>::type>::IsSelfConnection ||
+          ConnectionTraits<typename std::remove_reference<decltype(
+              std::get<I>(t))>::type>::IsFullselfConnection)
+      {
+        std::get<I>(t).InputLayer().InputActivation() =
+            recurrentState[stateNum++];
+      }
+
+      RestoreState<I + 1, Tp...>(t);
+    }
+
     //! The layer we are using to build the network.
     ConnectionTypes network;
 
@@ -803,6 +1013,15 @@ class RNN
     //! The index of the currently activate delta.
     size_t deltaNum;
 
+    //! The index of the currently stored recurrent state.
+    size_t stateNum;
+
+    //! The number of sequences propagated at once.
+    size_t batchSize;
+
+    //! The first step of the current truncation window.
+    size_t windowStart;
+
     //! Locally stored network output size.
     size_t outputSize;
 
@@ -823,15 +1042,24 @@ class RNN
 
     //! The detla storage we are using to perform the feed backward pass.
     boost::ptr_vector<VecTypeDelta> delta;
+
+    //! The recurrent state storage used between truncation windows.
+    boost::ptr_vector<MatType> recurrentState;
+
+    //! Number of steps to backpropagate through at a time (0 for all).
+    size_t bpttWindow;
 }; // class RNN
 
-//! Network traits for the FFNN network.
+//! Network traits for the RNN network.
 template <
   typename ConnectionTypes,
   typename OutputLayerType,
-  class PerformanceFunction
+  class PerformanceFunction,
+  typename MatType,
+  typename VecTypeDelta
 >
-class NetworkTraits<RNN<ConnectionTypes, OutputLayerType, PerformanceFunction> >
+class NetworkTraits<RNN<ConnectionTypes, OutputLayerType, PerformanceFunction,
+    MatType, VecTypeDelta> >
 {
  public:
   static const bool IsFNN = false;
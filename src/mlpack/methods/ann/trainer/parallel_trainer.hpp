@@ -0,0 +1,460 @@
+/**
+ * @file parallel_trainer.hpp
+ * @author Marcus Edel
+ *
+ * Definition and implementation of a data-parallel trainer that trains the
+ * parameters of a feed forward network with several copies of the network.
+ */
+#ifndef __MLPACK_METHODS_ANN_TRAINER_PARALLEL_TRAINER_HPP
+#define __MLPACK_METHODS_ANN_TRAINER_PARALLEL_TRAINER_HPP
+
+#include <mlpack/core.hpp>
+
+#include <mlpack/methods/ann/network_traits.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Data-parallel trainer that trains the parameters of a feed forward network
+ * according to a supervised dataset.
+ *
+ * Since the connections of a network only hold references to their layers, a
+ * network can't be copied; instead, the trainer is given the network to train
+ * and a number of replicas, which are networks with the same structure but
+ * their own layers and connections.  The network and all replicas but the
+ * last one are the workers: each mini-batch is split among the workers, every
+ * worker accumulates the gradients of its part in parallel, and then the
+ * gradients are merged into the trained network, which takes one step with its
+ * own optimizers (e.g. RPROP or SteepestDescent) and copies the new weights to
+ * the other workers.  So the training takes the same steps as the serial
+ * Trainer with the same batch size, and the batch size should be at least the
+ * number of workers.
+ *
+ * The last replica is used to evaluate the validation set.  At the end of each
+ * epoch, the weights are copied to it, and the validation error is computed
+ * while the next epoch is trained.  If the validation error of an epoch is
+ * below the tolerance, the weights of that epoch are copied back to the
+ * network, so the result is the same as if the validation error was computed
+ * before training the next epoch.
+ *
+ * OpenMP tasks are used for the workers and the evaluation; without OpenMP,
+ * everything is done serially.
+ *
+ * @code
+ * NetworkType net(...), replica0(...), replica1(...), replica2(...);
+ * std::vector<NetworkType*> replicas = { &replica0, &replica1, &replica2 };
+ *
+ * // Train with three workers (net, replica0, replica1).
+ * ParallelTrainer<NetworkType, arma::mat, arma::mat> trainer(net, replicas,
+ *     maxEpochs, 64);
+ * trainer.Train(trainData, trainLabels, validationData, validationLabels);
+ * @endcode
+ *
+ * @tparam NetworkType The type of network which should be trained and
+ * evaluated (a feed forward network).
+ * @tparam MatType Type of the error type (arma::mat or arma::sp_mat).
+ * @tparam VecType Type of error type (arma::colvec, arma::mat or arma::sp_mat).
+ */
+template<
+  typename NetworkType,
+  typename MatType = arma::mat,
+  typename VecType = arma::colvec
+>
+class ParallelTrainer
+{
+  static_assert(NetworkTraits<NetworkType>::IsFNN,
+      "ParallelTrainer can only train feed forward networks.");
+
+  public:
+    /**
+     * Construct the ParallelTrainer object, which will be used to train a
+     * neural network according to a supervised dataset by backpropagating the
+     * errors.
+     *
+     * @param net The network that should be trained.
+     * @param replicas Networks with the same structure as net; the last one is
+     * used to evaluate the validation set, and the others train along with
+     * net.
+     * @param maxEpochs The number of maximal trained iterations (0 means no
+     * limit).
+     * @param batchSize The batch size used to train the network.
+     * @param tolerance Train the network until it converges against
+     * the specified threshold.
+     * @param shuffle If true, the order of the training set is shuffled;
+     * otherwise, each data is visited in linear order.
+     */
+    ParallelTrainer(NetworkType& net,
+                    const std::vector<NetworkType*>& replicas,
+                    const size_t maxEpochs = 0,
+                    const size_t batchSize = 1,
+                    const double tolerance = 0.0001,
+                    const bool shuffle = true) :
+        net(net),
+        maxEpochs(maxEpochs),
+        batchSize(batchSize),
+        tolerance(tolerance),
+        shuffle(shuffle)
+    {
+      if (replicas.size() == 0)
+        Log::Fatal << "ParallelTrainer: at least one replica of the network is "
+            << "needed to evaluate the validation set." << std::endl;
+
+      if (batchSize == 0)
+        Log::Fatal << "ParallelTrainer: the batch size must be positive."
+            << std::endl;
+
+      workers.push_back(&net);
+      workers.insert(workers.end(), replicas.begin(), replicas.end() - 1);
+      evaluator = replicas.back();
+
+      errors.resize(workers.size());
+    }
+
+    /**
+     * Train the network on the given datasets until the network converges. If
+     * maxEpochs is greater than zero that many epochs are maximal trained.
+     *
+     * @param trainingData Data used to train the network.
+     * @param trainingLabels Labels used to train the network.
+     * @param validationData Data used to evaluate the network.
+     * @tparam validationLabels Labels used to evaluate the network.
+     */
+    template<typename eT>
+    void Train(arma::Mat<eT>& trainingData,
+               arma::Mat<eT>& trainingLabels,
+               arma::Mat<eT>& validationData,
+               arma::Mat<eT>& validationLabels)
+    {
+      // This generates [0 1 2 3 ... (trainingData.n_cols - 1)]. The sequence
+      // will be used to iterate through the training data.
+      index = arma::linspace<arma::Col<size_t> >(0, trainingData.n_cols - 1,
+          trainingData.n_cols);
+      epoch = 0;
+
+      // Start all workers with the weights of the trained network.
+      for (size_t w = 1; w < workers.size(); w++)
+        CopyWeights(net.Network(), workers[w]->Network());
+
+      #pragma omp parallel
+      {
+        #pragma omp single
+        {
+          bool evaluating = false;
+          while (true)
+          {
+            if (shuffle)
+              index = arma::shuffle(index);
+
+            TrainEpoch(trainingData, trainingLabels);
+
+            // Wait for the evaluation of the previous epoch.
+            #pragma omp taskwait
+
+            if (evaluating && validationError <= tolerance)
+            {
+              // Go back to the weights of the previous epoch.
+              CopyWeights(evaluator->Network(), net.Network());
+              break;
+            }
+
+            CopyWeights(net.Network(), evaluator->Network());
+
+            if (maxEpochs > 0 && ++epoch >= maxEpochs)
+            {
+              Evaluate(validationData, validationLabels);
+              break;
+            }
+
+            // Evaluate this epoch while the next one is trained.
+            #pragma omp task shared(validationData, validationLabels)
+            Evaluate(validationData, validationLabels);
+
+            evaluating = true;
+          }
+        }
+      }
+    }
+
+    //! Get the training error.
+    double TrainingError() const { return trainingError; }
+
+    //! Get the validation error.
+    double ValidationError() const { return validationError; }
+
+    //! Get the number of workers.
+    size_t NumWorkers() const { return workers.size(); }
+
+    //! Get whether or not the individual inputs are shuffled.
+    bool Shuffle() const { return shuffle; }
+    //! Modify whether or not the individual inputs are shuffled.
+    bool& Shuffle() { return shuffle; }
+
+    //! Get the batch size.
+    size_t BatchSize() const { return batchSize; }
+    //! Modify the batch size.
+    size_t& BatchSize() { return batchSize; }
+
+    //! Get the maximum number of iterations (0 indicates no limit).
+    size_t MaxEpochs() const { return maxEpochs; }
+    //! Modify the maximum number of iterations (0 indicates no limit).
+    size_t& MaxEpochs() { return maxEpochs; }
+
+    //! Get the tolerance for termination.
+    double Tolerance() const { return tolerance; }
+    //! Modify the tolerance for termination.
+    double& Tolerance() { return tolerance; }
+
+  private:
+    /**
+     * Train the network on the given dataset for one epoch.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename eT>
+    void TrainEpoch(arma::Mat<eT>& data, arma::Mat<eT>& target)
+    {
+      // Reset the training error.
+      trainingError = 0;
+
+      for (size_t i = 0; i < index.n_elem; i += batchSize)
+      {
+        const size_t end = std::min(i + batchSize, (size_t) index.n_elem);
+        const size_t count = end - i;
+
+        // Split the mini-batch into contiguous parts, one for each worker.
+        #pragma omp taskgroup
+        {
+          for (size_t w = 0; w < workers.size(); w++)
+          {
+            const size_t first = i + w * count / workers.size();
+            const size_t last = i + (w + 1) * count / workers.size();
+            if (first == last)
+              continue;
+
+            #pragma omp task firstprivate(w, first, last) shared(data, target)
+            TrainPart(*workers[w], data, target, first, last, errors[w],
+                std::integral_constant<bool, IsBatchNetwork>());
+          }
+        }
+
+        // Take one step with the gradients of all workers.
+        for (size_t w = 1; w < workers.size(); w++)
+          net.MergeGradients(*workers[w]);
+
+        trainingError += net.Error();
+        net.ApplyGradients();
+
+        for (size_t w = 1; w < workers.size(); w++)
+          CopyWeights(net.Network(), workers[w]->Network());
+      }
+
+      trainingError /= index.n_elem;
+    }
+
+    /**
+     * Accumulate the gradients of the given part of the (shuffled) training
+     * set in the given worker by propagating all columns at once.
+     */
+    template<typename eT>
+    void TrainPart(NetworkType& worker,
+                   arma::Mat<eT>& data,
+                   arma::Mat<eT>& target,
+                   const size_t first,
+                   const size_t last,
+                   VecType& error,
+                   std::true_type /* batch */)
+    {
+      const arma::uvec partIndex = arma::conv_to<arma::uvec>::from(
+          index.subvec(first, last - 1));
+
+      const arma::Mat<eT> partData = data.cols(partIndex);
+      const arma::Mat<eT> partTarget = target.cols(partIndex);
+
+      worker.FeedForward(partData, partTarget, error);
+      worker.FeedBackward(error);
+    }
+
+    /**
+     * Accumulate the gradients of the given part of the (shuffled) training
+     * set in the given worker, one sample at a time.
+     */
+    template<typename eT>
+    void TrainPart(NetworkType& worker,
+                   arma::Mat<eT>& data,
+                   arma::Mat<eT>& target,
+                   const size_t first,
+                   const size_t last,
+                   VecType& error,
+                   std::false_type /* batch */)
+    {
+      for (size_t i = first; i < last; i++)
+      {
+        worker.FeedForward(Element(data, index(i)), Element(target, index(i)),
+            error);
+        worker.FeedBackward(error);
+      }
+    }
+
+    /**
+     * Evaluate the network that holds the weights of the last epoch on the
+     * given dataset.
+     *
+     * @param data Data used to evaluate the network.
+     * @param target Labels used to evaluate the network.
+     */
+    template<typename eT>
+    void Evaluate(arma::Mat<eT>& data, arma::Mat<eT>& target)
+    {
+      validationError = Evaluate(data, target,
+          std::integral_constant<bool, IsBatchNetwork>()) / data.n_cols;
+    }
+
+    /**
+     * Sum up the error of the evaluation network on the given dataset by
+     * propagating batchSize consecutive columns at once.
+     */
+    template<typename eT>
+    double Evaluate(arma::Mat<eT>& data,
+                    arma::Mat<eT>& target,
+                    std::true_type /* batch */)
+    {
+      double error = 0;
+      for (size_t i = 0; i < data.n_cols; i += batchSize)
+      {
+        const size_t count = std::min(batchSize, (size_t) data.n_cols - i);
+
+        // Use the memory of the dataset, the columns are consecutive.
+        const arma::Mat<eT> batchData(data.colptr(i), data.n_rows, count,
+            false, true);
+        const arma::Mat<eT> batchTarget(target.colptr(i), target.n_rows,
+            count, false, true);
+
+        error += evaluator->Evaluate(batchData, batchTarget, evaluationError);
+      }
+
+      return error;
+    }
+
+    /**
+     * Sum up the error of the evaluation network on the given dataset, one
+     * sample at a time.
+     */
+    template<typename eT>
+    double Evaluate(arma::Mat<eT>& data,
+                    arma::Mat<eT>& target,
+                    std::false_type /* batch */)
+    {
+      double error = 0;
+      for (size_t i = 0; i < data.n_cols; i++)
+      {
+        error += evaluator->Evaluate(Element(data, i), Element(target, i),
+            evaluationError);
+      }
+
+      return error;
+    }
+
+    /*
+     * Create a Col object which uses memory from an existing matrix object.
+     * (This approach is currently not alias safe)
+     *
+     * @param data The reference data.
+     * @param sliceNum Provide a Col object of the specified index.
+     */
+    template<typename eT>
+    arma::Col<eT> Element(arma::Mat<eT>& input, const size_t colNum)
+    {
+      return arma::Col<eT>(input.colptr(colNum), input.n_rows, false, true);
+    }
+
+    /**
+     * Helper function to copy the weights of all connection modules of a
+     * network to the connection modules of a network with the same structure.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connection
+     * modules. The general case peels off the first type and recurses, as usual
+     * with variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    CopyWeights(const std::tuple<Tp...>& /* unused */,
+                std::tuple<Tp...>& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    CopyWeights(const std::tuple<Tp...>& from, std::tuple<Tp...>& to)
+    {
+      CopyConnections(std::get<I>(from), std::get<I>(to));
+      CopyWeights<I + 1, Tp...>(from, to);
+    }
+
+    /**
+     * Copy the weights of the connections of a connection module.
+     *
+     * enable_if (SFINAE) is used to iterate through the network connections.
+     * The general case peels off the first type and recurses, as usual with
+     * variadic function templates.
+     */
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I == sizeof...(Tp), void>::type
+    CopyConnections(const std::tuple<Tp...>& /* unused */,
+                    std::tuple<Tp...>& /* unused */) { }
+
+    template<size_t I = 0, typename... Tp>
+    typename std::enable_if<I < sizeof...(Tp), void>::type
+    CopyConnections(const std::tuple<Tp...>& from, std::tuple<Tp...>& to)
+    {
+      std::get<I>(to).Weights() = std::get<I>(from).Weights();
+      CopyConnections<I + 1, Tp...>(from, to);
+    }
+
+    //! Whether whole mini-batches are propagated through the network at once.
+    static const bool IsBatchNetwork = !arma::is_Col<VecType>::value;
+
+    //! The network which should be trained.
+    NetworkType& net;
+
+    //! The networks that train (the first one is net).
+    std::vector<NetworkType*> workers;
+
+    //! The network used to evaluate the validation set.
+    NetworkType* evaluator;
+
+    //! The current network error of each worker.
+    std::vector<VecType> errors;
+
+    //! The current network error of the evaluation.
+    VecType evaluationError;
+
+    //! The current epoch if maxEpochs is set.
+    size_t epoch;
+
+    //! The maximal epochs that should be used.
+    size_t maxEpochs;
+
+    //! The size until a update is performed.
+    size_t batchSize;
+
+    //! The shuffel sequence index used to train the network.
+    arma::Col<size_t> index;
+
+    //! The overall traing error.
+    double trainingError;
+
+    //! The overall validation error.
+    double validationError;
+
+    //! The tolerance for termination.
+    double tolerance;
+
+    //! Controls whether or not the individual inputs are shuffled when
+    //! iterating.
+    bool shuffle;
+}; // class ParallelTrainer
+
+}; // namespace ann
+}; // namespace mlpack
+
+#endif
@@ -21,6 +21,24 @@ namespace ann /** Artificial Neural Network. */ {
  * Trainer that trains the parameters of a neural network according to a
  * supervised dataset.
  *
+ * For a feed forward network, if VecType is a matrix type (e.g. arma::mat)
+ * instead of a column vector type, the trainer propagates batchSize samples at
+ * once through the network, so that each connection performs one
+ * matrix-matrix product per mini-batch instead of one matrix-vector product
+ * per sample.  In this case the layers of the network have to store their
+ * activations in a matrix type as well, e.g.
+ *
+ * @code
+ * NeuronLayer<LogisticFunction, arma::mat> hiddenLayer(hiddenLayerSize);
+ * BiasLayer<IdentityFunction, arma::mat> biasLayer(1);
+ * ...
+ * Trainer<decltype(net), arma::mat, arma::mat> trainer(net, maxEpochs, 32);
+ * @endcode
+ *
+ * The training data of a batch network may also be sparse (arma::sp_mat), if
+ * the first connections of the network take sparse input (see
+ * SparseFullConnection).
+ *
  * @tparam NetworkType The type of network which should be trained and
  * evaluated.
  * @tparam MaType Type of the error type (arma::mat or arma::sp_mat).
@@ -39,8 +57,8 @@ class Trainer
      * network according to a supervised dataset by backpropagating the errors.
      *
      * If batchSize is greater 1 the trainer will take a mean gradient step over
-     * this many samples and will update the parameters only at the end of
-     * each epoch (Default 1).
+     * this many samples (Default 1).  If the network supports it (see above),
+     * the samples of a mini-batch are propagated through the network at once.
      *
      * @param net The network that should be trained.
      * @param maxEpochs The number of maximal trained iterations (0 means no
@@ -114,8 +132,13 @@ class Trainer
     bool& Shuffle() { return shuffle; }
 
     //! Get the batch size.
-    size_t StepSize() const { return batchSize; }
+    size_t BatchSize() const { return batchSize; }
     //! Modify the batch size.
+    size_t& BatchSize() { return batchSize; }
+
+    //! Get the batch size (deprecated, use BatchSize() instead).
+    size_t StepSize() const { return batchSize; }
+    //! Modify the batch size (deprecated, use BatchSize() instead).
     size_t& StepSize() { return batchSize; }
 
     //! Get the maximum number of iterations (0 indicates no limit).
@@ -141,6 +164,82 @@ class Trainer
       // Reset the training error.
       trainingError = 0;
 
+      Train(data, target, std::integral_constant<bool, IsBatchNetwork>());
+
+      trainingError /= index.n_elem;
+    }
+
+    /**
+     * Train the network on the given dataset by propagating batchSize columns
+     * at once.  The columns of a mini-batch are gathered according to the
+     * (shuffled) index, so the network sees the same samples as in the
+     * sample-by-sample case.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename eT>
+    void Train(arma::Mat<eT>& data,
+               arma::Mat<eT>& target,
+               std::true_type /* batch */)
+    {
+      for (size_t i = 0; i < index.n_elem; i += batchSize)
+      {
+        const size_t end = std::min(i + batchSize, (size_t) index.n_elem) - 1;
+        const arma::uvec batchIndex = arma::conv_to<arma::uvec>::from(
+            index.subvec(i, end));
+
+        const arma::Mat<eT> batchData = data.cols(batchIndex);
+        const arma::Mat<eT> batchTarget = target.cols(batchIndex);
+
+        net.FeedForward(batchData, batchTarget, error);
+
+        trainingError += net.Error();
+        net.FeedBackward(error);
+        net.ApplyGradients();
+      }
+    }
+
+    /**
+     * Train the network on the given sparse dataset by propagating batchSize
+     * columns at once.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename eT>
+    void Train(arma::SpMat<eT>& data,
+               arma::Mat<eT>& target,
+               std::true_type /* batch */)
+    {
+      for (size_t i = 0; i < index.n_elem; i += batchSize)
+      {
+        const size_t end = std::min(i + batchSize, (size_t) index.n_elem) - 1;
+        const arma::uvec batchIndex = arma::conv_to<arma::uvec>::from(
+            index.subvec(i, end));
+
+        const arma::SpMat<eT> batchData = Columns(data, batchIndex);
+        const arma::Mat<eT> batchTarget = target.cols(batchIndex);
+
+        net.FeedForward(batchData, batchTarget, error);
+
+        trainingError += net.Error();
+        net.FeedBackward(error);
+        net.ApplyGradients();
+      }
+    }
+
+    /**
+     * Train the network on the given dataset, one sample at a time.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename InputType, typename OutputType>
+    void Train(InputType& data,
+               OutputType& target,
+               std::false_type /* batch */)
+    {
       for (size_t i = 0; i < index.n_elem; i++)
       {
         net.FeedForward(Element(data, index(i)),
@@ -155,8 +254,6 @@ class Trainer
 
       if ((index.n_elem % batchSize) != 0)
         net.ApplyGradients();
-
-      trainingError /= index.n_elem;
     }
 
     /**
@@ -171,13 +268,77 @@ class Trainer
       // Reset the validation error.
       validationError = 0;
 
+      Evaluate(data, target, std::integral_constant<bool, IsBatchNetwork>());
+
+      validationError /= ElementCount(data);
+    }
+
+    /**
+     * Evaluate the network on the given dataset by propagating batchSize
+     * consecutive columns at once.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename eT>
+    void Evaluate(arma::Mat<eT>& data,
+                  arma::Mat<eT>& target,
+                  std::true_type /* batch */)
+    {
+      for (size_t i = 0; i < data.n_cols; i += batchSize)
+      {
+        const size_t count = std::min(batchSize, (size_t) data.n_cols - i);
+
+        // Use the memory of the dataset, the columns are consecutive.
+        const arma::Mat<eT> batchData(data.colptr(i), data.n_rows, count,
+            false, true);
+        const arma::Mat<eT> batchTarget(target.colptr(i), target.n_rows,
+            count, false, true);
+
+        validationError += net.Evaluate(batchData, batchTarget, error);
+      }
+    }
+
+    /**
+     * Evaluate the network on the given sparse dataset by propagating
+     * batchSize consecutive columns at once.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename eT>
+    void Evaluate(arma::SpMat<eT>& data,
+                  arma::Mat<eT>& target,
+                  std::true_type /* batch */)
+    {
+      for (size_t i = 0; i < data.n_cols; i += batchSize)
+      {
+        const size_t count = std::min(batchSize, (size_t) data.n_cols - i);
+
+        const arma::SpMat<eT> batchData = data.cols(i, i + count - 1);
+        const arma::Mat<eT> batchTarget(target.colptr(i), target.n_rows,
+            count, false, true);
+
+        validationError += net.Evaluate(batchData, batchTarget, error);
+      }
+    }
+
+    /**
+     * Evaluate the network on the given dataset, one sample at a time.
+     *
+     * @param data Data used to train the network.
+     * @param target Labels used to train the network.
+     */
+    template<typename InputType, typename OutputType>
+    void Evaluate(InputType& data,
+                  OutputType& target,
+                  std::false_type /* batch */)
+    {
       for (size_t i = 0; i < ElementCount(data); i++)
       {
          validationError += net.Evaluate(Element(data, i),
             Element(target, i), error);
       }
-
-      validationError /= ElementCount(data);
     }
 
     /*
@@ -222,6 +383,51 @@ class Trainer
       return input.slices(sliceNum, sliceNum);
     }
 
+    /*
+     * Provide a single column of a sparse matrix.
+     *
+     * @param data The reference data.
+     * @param colNum Provide a single column of the specified index.
+     */
+    template<typename eT>
+    arma::SpMat<eT> Element(arma::SpMat<eT>& input, const size_t colNum)
+    {
+      return input.col(colNum);
+    }
+
+    /*
+     * Gather the given columns of a sparse matrix.
+     *
+     * @param data The reference data.
+     * @param indices The indices of the columns.
+     */
+    template<typename eT>
+    arma::SpMat<eT> Columns(const arma::SpMat<eT>& data,
+                            const arma::uvec& indices) const
+    {
+      size_t nonzero = 0;
+      for (size_t i = 0; i < indices.n_elem; i++)
+        nonzero += data.col_ptrs[indices[i] + 1] - data.col_ptrs[indices[i]];
+
+      // The nonzeros are taken in column-major order, so they don't have to be
+      // sorted.
+      arma::umat locations(2, nonzero);
+      arma::Col<eT> values(nonzero);
+      for (size_t i = 0, k = 0; i < indices.n_elem; i++)
+      {
+        for (size_t j = data.col_ptrs[indices[i]];
+             j < data.col_ptrs[indices[i] + 1]; j++, k++)
+        {
+          locations(0, k) = data.row_indices[j];
+          locations(1, k) = i;
+          values[k] = data.values[j];
+        }
+      }
+
+      return arma::SpMat<eT>(locations, values, data.n_rows, indices.n_elem,
+          false);
+    }
+
     /*
      * Get the number of elements.
      *
@@ -233,6 +439,17 @@ class Trainer
       return data.n_cols;
     }
 
+    /*
+     * Get the number of elements.
+     *
+     * @param data The reference data.
+     */
+    template<typename eT>
+    size_t ElementCount(const arma::SpMat<eT>& data) const
+    {
+      return data.n_cols;
+    }
+
     /*
      * Get the number of elements.
      *
@@ -244,6 +461,10 @@ class Trainer
       return data.n_slices;
     }
 
+    //! Whether whole mini-batches are propagated through the network at once.
+    static const bool IsBatchNetwork = NetworkTraits<NetworkType>::IsFNN &&
+        !arma::is_Col<VecType>::value;
+
     //! The network which should be trained and evaluated.
     NetworkType& net;
 
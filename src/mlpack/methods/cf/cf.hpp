@@ -13,10 +13,13 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/fastmks/fastmks.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
 #include <set>
+#include <memory>
 #include <map>
 #include <iostream>
 
@@ -154,6 +157,64 @@ class CF
     return rank;
   }
 
+  /**
+   * Sets whether the recommendations are retrieved with max-kernel search
+   * (FastMKS) over the item factors.  The estimated rating of an item is the
+   * inner product of the item's row of W with the averaged H column of the
+   * neighborhood, so the best items can be found with a cover tree over the
+   * rows of W instead of scoring every item.  The tree is built the first time
+   * the mode is enabled.
+   */
+  void MaxKernelSearch(const bool enabled)
+  {
+    this->maxKernelSearch = enabled;
+    if (enabled && !itemSearch)
+      BuildItemSearch();
+  }
+
+  //! Gets whether the recommendations are retrieved with max-kernel search.
+  bool MaxKernelSearch() const
+  {
+    return maxKernelSearch;
+  }
+
+  /**
+   * Sets the number of neighbors of every item in the item-item neighborhood
+   * model (0 disables the model).  The similarity of two items is the cosine
+   * of their rows of W, and the numNeighbors most similar items of every item
+   * are computed once and stored (see ItemNeighbors() and
+   * ItemSimilarities()).  While the model is enabled, GetRecommendations()
+   * scores the unrated items of a user by the sum of their similarities to the
+   * items the user rated, weighted by the ratings, so only the neighbors of the
+   * rated items are visited.
+   */
+  void ItemNeighborhood(const size_t numNeighbors)
+  {
+    this->itemNeighborhood = numNeighbors;
+    if (numNeighbors > 0)
+    {
+      BuildItemNeighborhood();
+    }
+    else
+    {
+      itemNeighbors.reset();
+      itemSimilarities.reset();
+    }
+  }
+
+  //! Gets the number of neighbors of every item (0 if the item-item
+  //! neighborhood model is disabled).
+  size_t ItemNeighborhood() const
+  {
+    return itemNeighborhood;
+  }
+
+  //! Get the most similar items of every item (one column for every item, most
+  //! similar first).
+  const arma::Mat<size_t>& ItemNeighbors() const { return itemNeighbors; }
+  //! Get the similarities of the items in ItemNeighbors().
+  const arma::mat& ItemSimilarities() const { return itemSimilarities; }
+
   //! Sets factorizer for NMF
   void Factorizer(const FactorizerType& f)
   {
@@ -180,6 +241,13 @@ class CF
 
   /**
    * Generates the given number of recommendations for the specified users.
+   * The users are processed in blocks: the ratings of all items are estimated
+   * for a block of users with a single matrix product, and the best items of
+   * every user are selected in parallel.  If MaxKernelSearch() is enabled, the
+   * best items of a block are instead retrieved with one FastMKS search, and
+   * the ratings of the other items are never computed, and if
+   * ItemNeighborhood() is enabled, the items are scored from the precomputed
+   * neighbors of the items every user rated.
    *
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations
@@ -189,6 +257,21 @@ class CF
                           arma::Mat<size_t>& recommendations,
                           arma::Col<size_t>& users);
 
+  /**
+   * Fold new ratings into the model without factorizing the data again.  The
+   * ratings are stored in the cleaned data matrix, which grows if the ratings
+   * contain new users or items.  Then the H column of every user in the list
+   * is recomputed by solving a small regularized least-squares problem against
+   * the fixed item factors (W), and the W row of every new item is computed the
+   * same way against the user factors (H).  The factors of the other users and
+   * items are not changed.  Finally, the neighbor search is rebuilt from the
+   * new factors.
+   *
+   * @param ratings Coordinate list of the new (user, item, rating) triples.
+   * @param regularization Ridge parameter of the least-squares problems.
+   */
+  void AddRatings(const arma::mat& ratings, const double regularization = 1e-3);
+
   //! Converts the User, Item, Value Matrix to User-Item Table
   static void CleanData(const arma::mat& data, arma::sp_mat& cleanedData);
 
@@ -236,21 +319,95 @@ class CF
   //! Cleaned data matrix.
   arma::sp_mat cleanedData;
 
+  //! Item matrix stretched by the Cholesky factor of W^T W, used to search for
+  //! similar users.
+  arma::mat stretchedH;
+  //! Nearest neighbor search over the columns of stretchedH, which is built
+  //! once after the factorization and reused by all queries.
+  std::unique_ptr<neighbor::AllkNN> neighborSearch;
+
+  //! If true, the recommendations are retrieved with max-kernel search.
+  bool maxKernelSearch;
+  //! Transposed user matrix (one column for every item), indexed by
+  //! itemSearch; FastMKS holds a reference to it.
+  arma::mat itemFactors;
+  //! Max-kernel search over the columns of itemFactors.
+  std::unique_ptr<fastmks::FastMKS<kernel::LinearKernel> > itemSearch;
+
+  //! Number of neighbors of every item in the item-item neighborhood model (0
+  //! if it is disabled).
+  size_t itemNeighborhood;
+  //! The most similar items of every item, one column for every item.
+  arma::Mat<size_t> itemNeighbors;
+  //! The similarities of the items in itemNeighbors.
+  arma::mat itemSimilarities;
+
+  /**
+   * Helper function to build the nearest neighbor search, which finds similar
+   * users, from the factorized matrices.
+   */
+  void BuildNeighborSearch();
+
+  /**
+   * Helper function to build the max-kernel search over the items from the
+   * factorized matrices.
+   */
+  void BuildItemSearch();
+
+  /**
+   * Helper function to compute the most similar items of every item from the
+   * factorized matrices.
+   */
+  void BuildItemNeighborhood();
+
+  /**
+   * Helper function to select the best numRecs unrated items of every user
+   * with the item-item neighborhood model, and store them in the
+   * recommendations matrix.
+   *
+   * @param users Users for which recommendations are generated.
+   * @param recommendations Matrix to save recommendations into.
+   */
+  void AggregateRecommendations(const arma::Col<size_t>& users,
+                                arma::Mat<size_t>& recommendations) const;
+
   /**
-   * Helper function to insert a point into the recommendation matrices.
+   * Helper function to retrieve the best numRecs unrated items for a block of
+   * users with max-kernel search, and store them in the recommendations
+   * matrix.
    *
-   * @param queryIndex Index of point whose recommendations we are inserting
-   *     into.
-   * @param pos Position in list to insert into.
-   * @param neighbor Index of item being inserted as a recommendation.
-   * @param value Value of recommendation.
+   * @param averageH Averaged H column of the neighborhood of every user.
+   * @param users Users for which recommendations are generated.
+   * @param begin Index of the first user of the block.
+   * @param recommendations Matrix to save recommendations into.
    */
-  void InsertNeighbor(const size_t queryIndex,
-                      const size_t pos,
-                      const size_t neighbor,
-                      const double value,
-                      arma::Mat<size_t>& recommendations,
-                      arma::mat& values) const;
+  void SearchRecommendations(const arma::mat& averageH,
+                             const arma::Col<size_t>& users,
+                             const size_t begin,
+                             arma::Mat<size_t>& recommendations);
+
+  /**
+   * Helper function to select the best numRecs items that the given user
+   * hasn't rated yet, and store them in the given column of the
+   * recommendations matrix.
+   *
+   * @param averages Estimated ratings of all items for the user.
+   * @param user Index of the user.
+   * @param queryIndex Column of the recommendations matrix to store into.
+   * @param recommendations Matrix to save recommendations into.
+   */
+  void SelectRecommendations(const arma::vec& averages,
+                             const size_t user,
+                             const size_t queryIndex,
+                             arma::Mat<size_t>& recommendations) const;
+
+  //! Returns true if the first (rating, item) candidate is a better
+  //! recommendation than the second.
+  static bool CandidateComparator(const std::pair<double, size_t>& a,
+                                  const std::pair<double, size_t>& b)
+  {
+    return (a.first > b.first) || (a.first == b.first && a.second < b.second);
+  }
 
 }; // class CF
 
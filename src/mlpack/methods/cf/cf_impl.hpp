@@ -55,7 +55,9 @@ CF<FactorizerType>::CF(const arma::mat& data,
                        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
     rank(rank),
-    factorizer(factorizer)
+    factorizer(factorizer),
+    maxKernelSearch(false),
+    itemNeighborhood(0)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -86,6 +88,8 @@ CF<FactorizerType>::CF(const arma::mat& data,
   // Decompose the data matrix (which is in coordinate list form) to user and
   // data matrices.
   ApplyFactorizer(factorizer, data, cleanedData, this->rank, w, h);
+
+  BuildNeighborSearch();
 }
 
 /**
@@ -99,7 +103,9 @@ CF<FactorizerType>::CF(const arma::sp_mat& data,
                        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
     rank(rank),
-    factorizer(factorizer)
+    factorizer(factorizer),
+    maxKernelSearch(false),
+    itemNeighborhood(0)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -128,6 +134,8 @@ CF<FactorizerType>::CF(const arma::sp_mat& data,
   }
 
   factorizer.Apply(cleanedData, this->rank, w, h);
+
+  BuildNeighborSearch();
 }
 
 template<typename FactorizerType>
@@ -150,118 +158,273 @@ void CF<FactorizerType>::GetRecommendations(const size_t numRecs,
                                             arma::Mat<size_t>& recommendations,
                                             arma::Col<size_t>& users)
 {
-  // We want to avoid calculating the full rating matrix, so we will do nearest
-  // neighbor search only on the H matrix, using the observation that if the
-  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
-  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
-  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
-  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
-  // Then we can perform nearest neighbor search.
-  arma::mat l = arma::chol(w.t() * w);
-  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
-
-  // Now, we will use the decomposed w and h matrices to estimate what the user
-  // would have rated items as, and then pick the best items.
+  // Generate recommendations for each query user by finding the maximum numRecs
+  // estimated ratings of the items the user hasn't rated yet.
+  recommendations.set_size(numRecs, users.n_elem);
+  recommendations.fill(cleanedData.n_rows); // Invalid item number.
 
-  // Temporarily store feature vector of queried users.
-  arma::mat query(stretchedH.n_rows, users.n_elem);
+  if (itemNeighborhood > 0)
+  {
+    AggregateRecommendations(users, recommendations);
+    return;
+  }
 
-  // Select feature vectors of queried users.
-  for (size_t i = 0; i < users.n_elem; i++)
-    query.col(i) = stretchedH.col(users(i));
+  // The users are processed in blocks, so that the estimated ratings of a
+  // whole block are computed with one matrix product without holding the
+  // ratings of all users in memory.  A block holds at most 2^24 ratings (128
+  // MB).
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 1024,
+      ((size_t) 1 << 24) / std::max((size_t) 1, (size_t) w.n_rows)));
 
-  // Temporary storage for neighborhood of the queried users.
+  arma::mat query;
   arma::Mat<size_t> neighborhood;
-
-  // Calculate the neighborhood of the queried users.
-  // This should be a templatized option.
-  neighbor::AllkNN a(stretchedH);
   arma::mat resultingDistances; // Temporary storage.
-  a.Search(query, numUsersForSimilarity, neighborhood, resultingDistances);
+  arma::mat averageH;
+  arma::mat averages;
+  for (size_t begin = 0; begin < users.n_elem; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, (size_t) users.n_elem);
 
-  // Generate recommendations for each query user by finding the maximum numRecs
-  // elements in the averages matrix.
-  recommendations.set_size(numRecs, users.n_elem);
-  recommendations.fill(cleanedData.n_rows); // Invalid item number.
-  arma::mat values(numRecs, users.n_elem);
-  values.fill(-DBL_MAX); // The smallest possible value.
-  for (size_t i = 0; i < users.n_elem; i++)
+    // Select feature vectors of queried users, and calculate the neighborhood
+    // of the queried users.
+    query.set_size(stretchedH.n_rows, end - begin);
+    for (size_t i = begin; i < end; i++)
+      query.col(i - begin) = stretchedH.col(users(i));
+
+    neighborSearch->Search(query, numUsersForSimilarity, neighborhood,
+        resultingDistances);
+
+    // The average of the neighborhood ratings W * h_j is W times the average
+    // of the neighborhood columns of H.
+    averageH.zeros(h.n_rows, end - begin);
+    for (size_t i = 0; i < averageH.n_cols; ++i)
+    {
+      for (size_t j = 0; j < neighborhood.n_rows; ++j)
+        averageH.col(i) += h.col(neighborhood(j, i));
+    }
+    averageH /= neighborhood.n_rows;
+
+    if (maxKernelSearch)
+    {
+      SearchRecommendations(averageH, users, begin, recommendations);
+      continue;
+    }
+
+    averages = w * averageH;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = begin; i < end; i++)
+      SelectRecommendations(averages.unsafe_col(i - begin), users(i), i,
+          recommendations);
+  }
+}
+
+// Retrieve the best unrated items of a block of users with FastMKS.
+template<typename FactorizerType>
+void CF<FactorizerType>::SearchRecommendations(
+    const arma::mat& averageH,
+    const arma::Col<size_t>& users,
+    const size_t begin,
+    arma::Mat<size_t>& recommendations)
+{
+  const size_t numRecs = recommendations.n_rows;
+
+  // Search for enough items that the best numRecs unrated items are found even
+  // if the user with the most ratings in the block rated all the best items.
+  size_t maxRated = 0;
+  for (size_t i = 0; i < averageH.n_cols; ++i)
+  {
+    const size_t user = users(begin + i);
+    maxRated = std::max(maxRated, (size_t) (cleanedData.col_ptrs[user + 1] -
+        cleanedData.col_ptrs[user]));
+  }
+
+  const size_t k = std::min(numRecs + maxRated, (size_t) itemFactors.n_cols);
+  if (k == 0)
+    return;
+
+  arma::Mat<size_t> indices;
+  arma::mat kernels;
+  itemSearch->Search(averageH, k, indices, kernels);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < averageH.n_cols; ++i)
   {
-    // First, calculate average of neighborhood values.
-    arma::vec averages;
-    averages.zeros(cleanedData.n_rows);
+    const size_t user = users(begin + i);
 
-    for (size_t j = 0; j < neighborhood.n_rows; ++j)
-      averages += w * h.col(neighborhood(j, i));
-    averages /= neighborhood.n_rows;
+    // The row indices of a column of the sparse matrix are sorted.
+    const arma::uword* ratedBegin = cleanedData.row_indices +
+        cleanedData.col_ptrs[user];
+    const arma::uword* ratedEnd = cleanedData.row_indices +
+        cleanedData.col_ptrs[user + 1];
 
-    // Look through the averages column corresponding to the current user.
-    for (size_t j = 0; j < averages.n_rows; ++j)
+    // The items are ordered by decreasing estimated rating already.
+    size_t found = 0;
+    for (size_t j = 0; j < k && found < numRecs; ++j)
     {
-      // Ensure that the user hasn't already rated the item.
-      if (cleanedData(j, users(i)) != 0.0)
-        continue; // The user already rated the item.
+      if (!std::binary_search(ratedBegin, ratedEnd,
+          (arma::uword) indices(j, i)))
+        recommendations(found++, begin + i) = indices(j, i);
+    }
+
+    if (found < numRecs)
+    {
+      #pragma omp critical
+      Log::Warn << "Could not provide " << numRecs << " recommendations "
+          << "for user " << user << " (not enough un-rated items)!"
+          << std::endl;
+    }
+  }
+}
+
+// Score the unrated items of every user with the item-item neighborhood model.
+template<typename FactorizerType>
+void CF<FactorizerType>::AggregateRecommendations(
+    const arma::Col<size_t>& users,
+    arma::Mat<size_t>& recommendations) const
+{
+  const size_t numRecs = recommendations.n_rows;
+  typedef std::pair<double, size_t> Candidate;
+
+  #pragma omp parallel
+  {
+    // Every thread accumulates the scores of a user into its own dense vector,
+    // and remembers which items it touched so that only these are reset.
+    std::vector<double> scores(cleanedData.n_rows, 0.0);
+    std::vector<bool> excluded(cleanedData.n_rows, false);
+    std::vector<size_t> touched;
+    std::vector<Candidate> candidates;
+
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < users.n_elem; ++i)
+    {
+      const size_t user = users(i);
+      const size_t ratedBegin = cleanedData.col_ptrs[user];
+      const size_t ratedEnd = cleanedData.col_ptrs[user + 1];
+
+      // The rated items are never recommended.
+      for (size_t k = ratedBegin; k < ratedEnd; ++k)
+        excluded[cleanedData.row_indices[k]] = true;
 
-      // Is the estimated value better than the worst candidate?
-      const double value = averages[j];
-      if (value > values(values.n_rows - 1, i))
+      touched.clear();
+      for (size_t k = ratedBegin; k < ratedEnd; ++k)
       {
-        // It should be inserted.  Which position?
-        size_t insertPosition = values.n_rows - 1;
-        while (insertPosition > 0)
+        const size_t item = cleanedData.row_indices[k];
+        const double rating = cleanedData.values[k];
+        for (size_t j = 0; j < itemNeighbors.n_rows; ++j)
         {
-          if (value <= values(insertPosition - 1, i))
-            break; // The current value is the right one.
-          insertPosition--;
+          const size_t neighbor = itemNeighbors(j, item);
+          if (excluded[neighbor])
+            continue;
+
+          if (scores[neighbor] == 0.0)
+            touched.push_back(neighbor);
+          scores[neighbor] += itemSimilarities(j, item) * rating;
         }
+      }
+
+      // An item whose score went back to zero may be touched twice.
+      std::sort(touched.begin(), touched.end());
+      touched.erase(std::unique(touched.begin(), touched.end()),
+          touched.end());
 
-        // Now insert it into the list.
-        InsertNeighbor(i, insertPosition, j, value, recommendations,
-            values);
+      candidates.clear();
+      for (size_t j = 0; j < touched.size(); ++j)
+      {
+        candidates.push_back(Candidate(scores[touched[j]], touched[j]));
+        scores[touched[j]] = 0.0;
       }
-    }
+      for (size_t k = ratedBegin; k < ratedEnd; ++k)
+        excluded[cleanedData.row_indices[k]] = false;
 
-    // If we were not able to come up with enough recommendations, issue a
-    // warning.
-    if (recommendations(values.n_rows - 1, i) == cleanedData.n_rows + 1)
-      Log::Warn << "Could not provide " << values.n_rows << " recommendations "
-          << "for user " << users(i) << " (not enough un-rated items)!"
-          << std::endl;
+      const size_t found = std::min(numRecs, candidates.size());
+      std::partial_sort(candidates.begin(), candidates.begin() + found,
+          candidates.end(), CandidateComparator);
+      for (size_t j = 0; j < found; ++j)
+        recommendations(j, i) = candidates[j].second;
+
+      if (found < numRecs)
+      {
+        #pragma omp critical
+        Log::Warn << "Could not provide " << numRecs << " recommendations "
+            << "for user " << user << " (not enough neighbors of the rated "
+            << "items)!" << std::endl;
+      }
+    }
   }
 }
 
-// Predict the rating for a single user/item combination.
+// Select the best unrated items of a single user.
 template<typename FactorizerType>
-double CF<FactorizerType>::Predict(const size_t user, const size_t item) const
+void CF<FactorizerType>::SelectRecommendations(
+    const arma::vec& averages,
+    const size_t user,
+    const size_t queryIndex,
+    arma::Mat<size_t>& recommendations) const
 {
-  // First, we need to find the nearest neighbors of the given user.
-  // We'll use the same technique as for GetRecommendations().
+  const size_t numRecs = recommendations.n_rows;
+
+  // Keep the best numRecs candidates in a heap with the worst candidate on
+  // top.  Of two equal values, the item with the smaller index is preferred.
+  typedef std::pair<double, size_t> Candidate;
+  std::vector<Candidate> heap;
+  heap.reserve(numRecs);
+
+  // The items the user already rated are visited in the same (increasing)
+  // order as the averages, so no search in the sparse matrix is necessary.
+  arma::sp_mat::const_iterator rated = cleanedData.begin_col(user);
+  const arma::sp_mat::const_iterator ratedEnd = cleanedData.end_col(user);
+  for (size_t j = 0; j < averages.n_elem; ++j)
+  {
+    while (rated != ratedEnd && rated.row() < j)
+      ++rated;
+    if (rated != ratedEnd && rated.row() == j)
+      continue; // The user already rated the item.
 
-  // We want to avoid calculating the full rating matrix, so we will do nearest
-  // neighbor search only on the H matrix, using the observation that if the
-  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
-  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
-  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
-  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
-  // Then we can perform nearest neighbor search.
-  arma::mat l = arma::chol(w.t() * w);
-  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
+    const Candidate candidate(averages[j], j);
+    if (heap.size() < numRecs)
+    {
+      heap.push_back(candidate);
+      std::push_heap(heap.begin(), heap.end(), CandidateComparator);
+    }
+    else if (numRecs > 0 && candidate.first > heap.front().first)
+    {
+      std::pop_heap(heap.begin(), heap.end(), CandidateComparator);
+      heap.back() = candidate;
+      std::push_heap(heap.begin(), heap.end(), CandidateComparator);
+    }
+  }
+
+  // Sorting the heap puts the best candidate first.
+  std::sort_heap(heap.begin(), heap.end(), CandidateComparator);
+  for (size_t i = 0; i < heap.size(); ++i)
+    recommendations(i, queryIndex) = heap[i].second;
 
-  // Now, we will use the decomposed w and h matrices to estimate what the user
-  // would have rated items as, and then pick the best items.
+  // If we were not able to come up with enough recommendations, issue a
+  // warning.
+  if (heap.size() < numRecs)
+  {
+    #pragma omp critical
+    Log::Warn << "Could not provide " << numRecs << " recommendations "
+        << "for user " << user << " (not enough un-rated items)!"
+        << std::endl;
+  }
+}
 
-  // Temporarily store feature vector of queried users.
+// Predict the rating for a single user/item combination.
+template<typename FactorizerType>
+double CF<FactorizerType>::Predict(const size_t user, const size_t item) const
+{
+  // First, we need to find the nearest neighbors of the given user, using the
+  // resident neighbor search (see BuildNeighborSearch()).
   arma::mat query = stretchedH.col(user);
 
   // Temporary storage for neighborhood of the queried users.
   arma::Mat<size_t> neighborhood;
-
-  // Calculate the neighborhood of the queried users.
-  // This should be a templatized option.
-  neighbor::AllkNN a(stretchedH, false, true /* single-tree mode */);
   arma::mat resultingDistances; // Temporary storage.
 
-  a.Search(query, numUsersForSimilarity, neighborhood, resultingDistances);
+  neighborSearch->Search(query, numUsersForSimilarity, neighborhood,
+      resultingDistances);
 
   double rating = 0; // We'll take the average of neighborhood values.
 
@@ -277,10 +440,6 @@ template<typename FactorizerType>
 void CF<FactorizerType>::Predict(const arma::Mat<size_t>& combinations,
                                  arma::vec& predictions) const
 {
-  // First, for nearest neighbor search, stretch the H matrix.
-  arma::mat l = arma::chol(w.t() * w);
-  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
-
   // Now, we must determine those query indices we need to find the nearest
   // neighbors for.  This is easiest if we just sort the combinations matrix.
   arma::Mat<size_t> sortedCombinations(combinations.n_rows,
@@ -298,11 +457,11 @@ void CF<FactorizerType>::Predict(const arma::Mat<size_t>& combinations,
     queries.col(i) = stretchedH.col(users[i]);
 
   // Now calculate the neighborhood of these users.
-  neighbor::AllkNN a(stretchedH);
   arma::mat distances;
   arma::Mat<size_t> neighborhood;
 
-  a.Search(queries, numUsersForSimilarity, neighborhood, distances);
+  neighborSearch->Search(queries, numUsersForSimilarity, neighborhood,
+      distances);
 
   // Now that we have the neighborhoods we need, calculate the predictions.
   predictions.set_size(combinations.n_cols);
@@ -327,6 +486,129 @@ void CF<FactorizerType>::Predict(const arma::Mat<size_t>& combinations,
   }
 }
 
+// Fold new ratings into the factorized model.
+template<typename FactorizerType>
+void CF<FactorizerType>::AddRatings(const arma::mat& ratings,
+                                    const double regularization)
+{
+  if (ratings.n_rows != 3)
+  {
+    Log::Fatal << "CF::AddRatings(): the ratings should be a coordinate list "
+        << "with 3 rows (" << ratings.n_rows << " given)." << std::endl;
+  }
+
+  if (ratings.n_cols == 0)
+    return;
+
+  const size_t oldItems = w.n_rows;
+  const size_t oldUsers = h.n_cols;
+  const size_t numItems = std::max(oldItems,
+      (size_t) arma::max(ratings.row(1)) + 1);
+  const size_t numUsers = std::max(oldUsers,
+      (size_t) arma::max(ratings.row(0)) + 1);
+
+  // Grow the cleaned data matrix if there are new users or items.
+  if (numItems > cleanedData.n_rows || numUsers > cleanedData.n_cols)
+  {
+    arma::umat locations(2, cleanedData.n_nonzero);
+    arma::vec values(cleanedData.n_nonzero);
+    size_t i = 0;
+    for (arma::sp_mat::const_iterator it = cleanedData.begin();
+         it != cleanedData.end(); ++it, ++i)
+    {
+      locations(0, i) = it.row();
+      locations(1, i) = it.col();
+      values(i) = *it;
+    }
+
+    cleanedData = arma::sp_mat(locations, values, numItems, numUsers);
+  }
+
+  // Insert the new ratings; a rating of an already rated item replaces the old
+  // one.
+  for (size_t i = 0; i < ratings.n_cols; ++i)
+  {
+    const size_t user = (size_t) ratings(0, i);
+    const size_t item = (size_t) ratings(1, i);
+    if (ratings(2, i) == 0)
+    {
+      Log::Warn << "User rating of 0 ignored for user " << user << ", item "
+          << item << "." << std::endl;
+      continue;
+    }
+
+    cleanedData(item, user) = ratings(2, i);
+  }
+
+  // The new users and items start with zero factors.
+  w.resize(numItems, w.n_cols);
+  h.resize(h.n_rows, numUsers);
+
+  const arma::Col<size_t> users = arma::unique(
+      arma::conv_to<arma::Col<size_t> >::from(ratings.row(0).t()));
+  const arma::mat ridge = regularization * arma::eye<arma::mat>(w.n_cols,
+      w.n_cols);
+
+  // Solve min ||v - W_I h||^2 + regularization ||h||^2 for every user, where I
+  // are the rated items that already have factors.
+  arma::mat gram;
+  arma::vec rhs;
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    gram = ridge;
+    rhs.zeros(w.n_cols);
+    for (arma::sp_mat::const_iterator it = cleanedData.begin_col(users(i));
+         it != cleanedData.end_col(users(i)); ++it)
+    {
+      if (it.row() >= oldItems)
+        continue;
+
+      const arma::rowvec item = w.row(it.row());
+      gram += item.t() * item;
+      rhs += (*it) * item.t();
+    }
+
+    h.col(users(i)) = arma::solve(gram, rhs);
+  }
+
+  // New items can only be rated by the users of the new ratings, so the normal
+  // equations of the new items are accumulated from the columns of these
+  // users.
+  const size_t newItems = numItems - oldItems;
+  if (newItems > 0)
+  {
+    arma::cube grams(h.n_rows, h.n_rows, newItems);
+    arma::mat rhss(h.n_rows, newItems);
+    for (size_t j = 0; j < newItems; ++j)
+      grams.slice(j) = ridge;
+    rhss.zeros();
+
+    for (size_t i = 0; i < users.n_elem; ++i)
+    {
+      const arma::vec user = h.col(users(i));
+      for (arma::sp_mat::const_iterator it = cleanedData.begin_col(users(i));
+           it != cleanedData.end_col(users(i)); ++it)
+      {
+        if (it.row() < oldItems)
+          continue;
+
+        grams.slice(it.row() - oldItems) += user * user.t();
+        rhss.col(it.row() - oldItems) += (*it) * user;
+      }
+    }
+
+    for (size_t j = 0; j < newItems; ++j)
+      w.row(oldItems + j) = arma::solve(grams.slice(j), rhss.col(j)).t();
+  }
+
+  // The factors changed, so the searches have to be rebuilt.
+  BuildNeighborSearch();
+  if (itemSearch)
+    BuildItemSearch();
+  if (itemNeighborhood > 0)
+    BuildItemNeighborhood();
+}
+
 template<typename FactorizerType>
 void CF<FactorizerType>::CleanData(const arma::mat& data, arma::sp_mat& cleanedData)
 {
@@ -353,37 +635,102 @@ void CF<FactorizerType>::CleanData(const arma::mat& data, arma::sp_mat& cleanedD
   cleanedData = arma::sp_mat(locations, values, maxItemID, maxUserID);
 }
 
-/**
- * Helper function to insert a point into the recommendation matrices.
- *
- * @param queryIndex Index of point whose recommendations we are inserting into.
- * @param pos Position in list to insert into.
- * @param neighbor Index of item being inserted as a recommendation.
- * @param value Value of recommendation.
- */
+// Build the nearest neighbor search over the users.
+template<typename FactorizerType>
+void CF<FactorizerType>::BuildNeighborSearch()
+{
+  // We want to avoid calculating the full rating matrix, so we will do nearest
+  // neighbor search only on the H matrix, using the observation that if the
+  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
+  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
+  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
+  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
+  // Then we can perform nearest neighbor search.
+  arma::mat l = arma::chol(w.t() * w);
+  stretchedH = l * h; // Due to the Armadillo API, l is L^T.
+
+  neighborSearch.reset(new neighbor::AllkNN(stretchedH));
+}
+
+// Build the max-kernel search over the items.
 template<typename FactorizerType>
-void CF<FactorizerType>::InsertNeighbor(const size_t queryIndex,
-                                        const size_t pos,
-                                        const size_t neighbor,
-                                        const double value,
-                                        arma::Mat<size_t>& recommendations,
-                                        arma::mat& values) const
+void CF<FactorizerType>::BuildItemSearch()
 {
-  // We only memmove() if there is actually a need to shift something.
-  if (pos < (recommendations.n_rows - 1))
+  // The estimated rating of item j for a user whose neighborhood has the
+  // averaged column a of H is w.row(j) * a, so the best items are the columns
+  // of W^T with the largest inner product with a.
+  itemFactors = w.t();
+  itemSearch.reset(new fastmks::FastMKS<kernel::LinearKernel>(itemFactors));
+}
+
+// Compute the most similar items of every item.
+template<typename FactorizerType>
+void CF<FactorizerType>::BuildItemNeighborhood()
+{
+  const size_t numItems = w.n_rows;
+  const size_t numNeighbors = std::min(itemNeighborhood,
+      (numItems > 0) ? numItems - 1 : 0);
+
+  // The cosine similarity of two items is the dot product of their normalized
+  // rows of W; items without factors are similar to nothing.
+  arma::mat normalized = w.t();
+  for (size_t i = 0; i < numItems; ++i)
   {
-    const int len = (values.n_rows - 1) - pos;
-    memmove(values.colptr(queryIndex) + (pos + 1),
-        values.colptr(queryIndex) + pos,
-        sizeof(double) * len);
-    memmove(recommendations.colptr(queryIndex) + (pos + 1),
-        recommendations.colptr(queryIndex) + pos,
-        sizeof(size_t) * len);
+    const double norm = arma::norm(normalized.col(i), 2);
+    if (norm > 0.0)
+      normalized.col(i) /= norm;
   }
 
-  // Now put the new information in the right index.
-  values(pos, queryIndex) = value;
-  recommendations(pos, queryIndex) = neighbor;
+  itemNeighbors.set_size(numNeighbors, numItems);
+  itemSimilarities.set_size(numNeighbors, numItems);
+  if (numNeighbors == 0)
+    return;
+
+  // The similarities of a block of items to all items are computed with one
+  // matrix product.  A block holds at most 2^24 similarities (128 MB).
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 1024,
+      ((size_t) 1 << 24) / numItems));
+
+  typedef std::pair<double, size_t> Candidate;
+  arma::mat similarities;
+  for (size_t begin = 0; begin < numItems; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, numItems);
+    similarities = normalized.t() * normalized.cols(begin, end - 1);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = begin; i < end; ++i)
+    {
+      // Keep the most similar items in a heap with the least similar on top.
+      std::vector<Candidate> heap;
+      heap.reserve(numNeighbors);
+      for (size_t j = 0; j < numItems; ++j)
+      {
+        if (j == i)
+          continue;
+
+        const Candidate candidate(similarities(j, i - begin), j);
+        if (heap.size() < numNeighbors)
+        {
+          heap.push_back(candidate);
+          std::push_heap(heap.begin(), heap.end(), CandidateComparator);
+        }
+        else if (candidate.first > heap.front().first)
+        {
+          std::pop_heap(heap.begin(), heap.end(), CandidateComparator);
+          heap.back() = candidate;
+          std::push_heap(heap.begin(), heap.end(), CandidateComparator);
+        }
+      }
+
+      std::sort_heap(heap.begin(), heap.end(), CandidateComparator);
+      for (size_t j = 0; j < numNeighbors; ++j)
+      {
+        itemNeighbors(j, i) = heap[j].second;
+        itemSimilarities(j, i) = heap[j].first;
+      }
+    }
+  }
 }
 
 // Return string of object.
@@ -6,10 +6,12 @@
  */
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/query_server.hpp>
 
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
 #include "cf.hpp"
+#include "randomized_svd.hpp"
 
 using namespace mlpack;
 using namespace mlpack::cf;
@@ -39,7 +41,17 @@ PROGRAM_INFO("Collaborating Filtering", "This program performs collaborative "
     "The following optimization algorithms can be used with --algorithm (-a) "
     "parameter: "
     "\n"
-    "RegSVD -- Regularized SVD using a SGD optimizer ");
+    "RegSVD -- Regularized SVD using a SGD optimizer "
+    "\n"
+    "RandSVD -- Truncated SVD of the sparse ratings with randomized subspace "
+    "iteration "
+    "\n\n"
+    "With --server, the matrix decomposition is done once, and then lists of "
+    "users are read from --server_input (or the standard input) and answered "
+    "until the input ends or a 'quit' request is read.  A request 'query <n> "
+    "[recommendations=<r>]' is followed by n lines holding one user each, and "
+    "is answered with the recommendations for every user (one user per "
+    "line).");
 
 // Parameters for program.
 PARAM_STRING_REQ("input_file", "Input dataset to perform CF on.", "i");
@@ -60,6 +72,65 @@ PARAM_INT("neighborhood", "Size of the neighborhood of similar users to "
 
 PARAM_INT("rank", "Rank of decomposed matrices.", "R", 2);
 
+PARAM_FLAG("max_kernel_search", "Retrieve the recommendations with max-kernel "
+    "search (FastMKS) over the item factors instead of estimating the rating "
+    "of every item.", "K");
+PARAM_INT("item_neighborhood", "If nonzero, precompute this many most similar "
+    "items of every item, and score the items of every query user from the "
+    "neighbors of the items the user rated (item-item neighborhood model).",
+    "I", 0);
+
+PARAM_FLAG("server", "If true, decompose the ratings once and answer lists of "
+    "users read from --server_input.", "");
+PARAM_STRING("server_input", "File or named pipe to read server requests from "
+    "(the standard input is used if not given).", "", "");
+PARAM_STRING("server_output", "File or named pipe to write server responses to "
+    "(the standard output is used if not given).", "", "");
+
+/**
+ * Answer the requests of the server with the recommendations for the given
+ * users.  The number of recommendations can be given per request with the
+ * option recommendations.
+ */
+template<typename CFType>
+class RecommendationHandler
+{
+ public:
+  RecommendationHandler(CFType& cf, const size_t numRecs) :
+      cf(cf), numRecs(numRecs) { }
+
+  void Query(const util::QueryRequest& request, util::QueryResponse& response)
+  {
+    const int recs = request.Option<int>("recommendations", (int) numRecs);
+    if (recs <= 0)
+    {
+      Log::Fatal << "Invalid number of recommendations: " << recs << "."
+          << endl;
+    }
+
+    const arma::mat& points = request.Points();
+    if (points.n_rows != 1)
+      Log::Fatal << "Every line of the request has to hold one user." << endl;
+
+    arma::Col<size_t> users(points.n_cols);
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      if (points[i] < 0 || points[i] != floor(points[i]) ||
+          points[i] >= cf.CleanedData().n_cols)
+        Log::Fatal << "Invalid user: " << points[i] << "." << endl;
+      users[i] = (size_t) points[i];
+    }
+
+    arma::Mat<size_t> recommendations;
+    cf.GetRecommendations((size_t) recs, recommendations, users);
+    response.Add(recommendations);
+  }
+
+ private:
+  CFType& cf;
+  size_t numRecs;
+};
+
 template<typename Factorizer>
 void ComputeRecommendations(Factorizer factorizer,
                             arma::mat& dataset,
@@ -69,6 +140,23 @@ void ComputeRecommendations(Factorizer factorizer,
                             arma::Mat<size_t>& recommendations)
 {
   CF<Factorizer> c(dataset, factorizer, neighbourhood, rank);
+  c.MaxKernelSearch(CLI::HasParam("max_kernel_search"));
+  if (CLI::GetParam<int>("item_neighborhood") < 0)
+  {
+    Log::Fatal << "Invalid item neighborhood size ("
+        << CLI::GetParam<int>("item_neighborhood") << "); must be "
+        << "nonnegative." << endl;
+  }
+  c.ItemNeighborhood((size_t) CLI::GetParam<int>("item_neighborhood"));
+
+  if (CLI::HasParam("server"))
+  {
+    // Answer lists of users with the decomposition until the input ends.
+    RecommendationHandler<CF<Factorizer> > handler(c, numRecs);
+    util::ServeQueries(handler, CLI::GetParam<string>("server_input"),
+        CLI::GetParam<string>("server_output"));
+    return;
+  }
 
   // Reading users.
   const string queryFile = CLI::GetParam<string>("query_file");
@@ -126,7 +214,12 @@ int main(int argc, char** argv)
     CR(SparseSVDCompleteIncrementalFactorizer());
   else if(algo == "RegSVD")
     CR(RegularizedSVD<>());
+  else if(algo == "RandSVD")
+    CR(RandomizedSVD());
 
-  const string outputFile = CLI::GetParam<string>("output_file");
-  data::Save(outputFile, recommendations);
+  if (!CLI::HasParam("server"))
+  {
+    const string outputFile = CLI::GetParam<string>("output_file");
+    data::Save(outputFile, recommendations);
+  }
 }
@@ -0,0 +1,124 @@
+/**
+ * @file randomized_svd.hpp
+ * @author Ryan Curtin
+ *
+ * A truncated SVD factorizer for CF that works on the sparse rating matrix.
+ */
+#ifndef __MLPACK_METHODS_CF_RANDOMIZED_SVD_HPP
+#define __MLPACK_METHODS_CF_RANDOMIZED_SVD_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace cf {
+
+/**
+ * This class computes the truncated SVD of a (sparse or dense) matrix with
+ * randomized subspace iteration:
+ *
+ * @code
+ * @article{halko2011finding,
+ *   title={Finding structure with randomness: Probabilistic algorithms for
+ *       constructing approximate matrix decompositions},
+ *   author={Halko, N. and Martinsson, P.G. and Tropp, J.A.},
+ *   journal={SIAM Review},
+ *   volume={53},
+ *   number={2},
+ *   pages={217--288},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * A random basis of r + Oversampling() directions is multiplied by V and V^T a
+ * few times, so that it spans the leading left singular vectors of V, and the
+ * small projection of V on the basis is decomposed exactly.  V is only used in
+ * products with dense n x (r + Oversampling()) matrices, so the cost is
+ * proportional to the number of nonzero values of V times the rank, and the
+ * dense matrix is never formed.  Unlike SVDWrapper<>, which decomposes the
+ * whole dense matrix and then truncates the decomposition, this is practical
+ * for large rating matrices.  The result is nearly exact when the kept
+ * singular values are well separated from the others; more power iterations
+ * make it more accurate.
+ *
+ * This class can be used as the factorizer of CF, which then passes it the
+ * sparse rating matrix:
+ *
+ * @code
+ * CF<RandomizedSVD> cf(data, RandomizedSVD(), 5, 20);
+ * @endcode
+ */
+class RandomizedSVD
+{
+ public:
+  /**
+   * Create the factorizer with the given parameters.
+   *
+   * @param oversampling Number of extra directions of the random basis.
+   * @param powerIterations Number of multiplications of the basis by V V^T.
+   */
+  RandomizedSVD(const size_t oversampling = 10,
+                const size_t powerIterations = 3) :
+      oversampling(oversampling),
+      powerIterations(powerIterations)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Compute the truncated SVD of the given matrix, V ~= U diag(sigma) Q^T.
+   *
+   * @param V Matrix to decompose (arma::mat or arma::sp_mat).
+   * @param r Rank of the decomposition.
+   * @param U Matrix to store the r left singular vectors in.
+   * @param sigma Vector to store the r largest singular values in, in
+   *     decreasing order.
+   * @param Q Matrix to store the r right singular vectors in.
+   */
+  template<typename MatType>
+  void Apply(const MatType& V,
+             size_t r,
+             arma::mat& U,
+             arma::vec& sigma,
+             arma::mat& Q) const;
+
+  /**
+   * Factorize the given matrix as required by CF, V ~= W * H, with W =
+   * U diag(sigma) and H = Q^T, and return the Frobenius norm of the error
+   * relative to the norm of V (which is computed from the singular values,
+   * without forming W * H).
+   *
+   * @param V Matrix to factorize (arma::mat or arma::sp_mat).
+   * @param r Rank of the factorization.
+   * @param W Matrix to store the scaled left singular vectors in.
+   * @param H Matrix to store the transposed right singular vectors in.
+   */
+  template<typename MatType>
+  double Apply(const MatType& V,
+               const size_t r,
+               arma::mat& W,
+               arma::mat& H) const;
+
+  //! Get the number of extra directions of the random basis.
+  size_t Oversampling() const { return oversampling; }
+  //! Modify the number of extra directions of the random basis.
+  size_t& Oversampling() { return oversampling; }
+
+  //! Get the number of power iterations.
+  size_t PowerIterations() const { return powerIterations; }
+  //! Modify the number of power iterations.
+  size_t& PowerIterations() { return powerIterations; }
+
+ private:
+  //! Number of extra directions of the random basis.
+  size_t oversampling;
+  //! Number of multiplications of the basis by V V^T.
+  size_t powerIterations;
+}; // class RandomizedSVD
+
+}; // namespace cf
+}; // namespace mlpack
+
+// Include implementation.
+#include "randomized_svd_impl.hpp"
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file randomized_svd_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the RandomizedSVD class.
+ */
+#ifndef __MLPACK_METHODS_CF_RANDOMIZED_SVD_IMPL_HPP
+#define __MLPACK_METHODS_CF_RANDOMIZED_SVD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "randomized_svd.hpp"
+
+namespace mlpack {
+namespace cf {
+
+template<typename MatType>
+void RandomizedSVD::Apply(const MatType& V,
+                          size_t r,
+                          arma::mat& U,
+                          arma::vec& sigma,
+                          arma::mat& Q) const
+{
+  const size_t maxRank = std::min((size_t) V.n_rows, (size_t) V.n_cols);
+  if (r > maxRank)
+  {
+    Log::Info << "Rank " << r << ", given for decomposition is invalid."
+        << std::endl;
+    r = maxRank;
+    Log::Info << "Setting decomposition rank to " << r << std::endl;
+  }
+
+  const size_t basisSize = std::min(r + oversampling, maxRank);
+
+  // The transpose is used in every iteration, so it is only computed once.
+  const MatType Vt = V.t();
+
+  // The basis spans the range of V applied to random directions.
+  arma::mat basis, triangular, product;
+  product = V * arma::randn<arma::mat>(V.n_cols, basisSize);
+  arma::qr_econ(basis, triangular, product);
+
+  // Every power iteration multiplies the basis by V V^T; it is
+  // orthonormalized after each product to keep the small singular values.
+  for (size_t i = 0; i < powerIterations; ++i)
+  {
+    product = Vt * basis;
+    arma::qr_econ(basis, triangular, product);
+    product = V * basis;
+    arma::qr_econ(basis, triangular, product);
+  }
+
+  // Decompose the projection of V on the basis, B = basis^T V, exactly; it is
+  // computed as (V^T basis)^T.
+  product = Vt * basis;
+  arma::mat smallU, smallQ;
+  arma::svd_econ(smallU, sigma, smallQ, product.t());
+
+  U = basis * smallU.cols(0, r - 1);
+  sigma = sigma.subvec(0, r - 1);
+  Q = smallQ.cols(0, r - 1);
+}
+
+template<typename MatType>
+double RandomizedSVD::Apply(const MatType& V,
+                            const size_t r,
+                            arma::mat& W,
+                            arma::mat& H) const
+{
+  arma::mat U, Q;
+  arma::vec sigma;
+  Apply(V, r, U, sigma, Q);
+
+  W = U * arma::diagmat(sigma);
+  H = Q.t();
+
+  // Because the factors are orthogonal, ||V - W H||^2 = ||V||^2 -
+  // ||sigma||^2.
+  double norm = 0.0;
+  for (typename MatType::const_iterator it = V.begin(); it != V.end(); ++it)
+    norm += (*it) * (*it);
+  if (norm == 0.0)
+    return 0.0;
+
+  return std::sqrt(std::max(norm - arma::dot(sigma, sigma), 0.0) / norm);
+}
+
+}; // namespace cf
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file dbscan.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of the DBSCAN clustering method, which is built on range
+ * search with a single tree over the dataset.
+ */
+#ifndef __MLPACK_METHODS_DBSCAN_DBSCAN_HPP
+#define __MLPACK_METHODS_DBSCAN_DBSCAN_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
+#include <mlpack/methods/emst/union_find.hpp>
+
+namespace mlpack {
+namespace dbscan /** DBSCAN clustering. */ {
+
+/**
+ * DBSCAN (density-based spatial clustering of applications with noise).  A
+ * point is a core point if at least minPoints points (itself included) lie
+ * within distance epsilon of it.  Core points within epsilon of each other are
+ * in the same cluster; every other point within epsilon of a core point (a
+ * border point) is put in the cluster of the core point with the smallest
+ * index in its neighborhood, and all remaining points are noise.  The
+ * clustering is therefore deterministic.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @inproceedings{ester1996density,
+ *   title={A density-based algorithm for discovering clusters in large spatial
+ *       databases with noise},
+ *   author={Ester, M. and Kriegel, H.-P. and Sander, J. and Xu, X.},
+ *   booktitle={Proceedings of the Second International Conference on
+ *       Knowledge Discovery and Data Mining (KDD '96)},
+ *   pages={226--231},
+ *   year={1996}
+ * }
+ * @endcode
+ *
+ * A single tree is built on the dataset and used for every query.  The core
+ * points are found with a range count, which counts whole tree nodes that lie
+ * within epsilon without computing any distance, so dense regions are cheap.
+ * Then the neighborhoods of the core points only are searched, in batches to
+ * bound the memory used by the results, and core points are merged with a
+ * lock-free union-find structure.  If Parallel() is true (and mlpack was
+ * compiled with OpenMP), the range searches are parallel and the neighborhoods
+ * of each batch are merged in parallel.
+ *
+ * @code
+ * extern arma::mat data; // Dataset to cluster.
+ * arma::Col<size_t> assignments; // Cluster of each point.
+ *
+ * DBSCAN<> dbscan(0.5, 10); // epsilon = 0.5, minPoints = 10.
+ * const size_t clusters = dbscan.Cluster(data, assignments);
+ * @endcode
+ *
+ * @tparam RangeSearchType Type of range search to use; it must provide
+ *      Count() and the compressed (CSR) overload of Search().
+ */
+template<typename RangeSearchType = range::RangeSearch<> >
+class DBSCAN
+{
+ public:
+  /**
+   * Set the parameters of DBSCAN.
+   *
+   * @param epsilon Radius of the neighborhood of each point.
+   * @param minPoints Minimum number of points (including the point itself) in
+   *      the neighborhood of a core point.
+   * @param singleMode If true, single-tree range search is used instead of
+   *      dual-tree range search.
+   * @param batchSize Number of core points whose neighborhoods are searched at
+   *      once.
+   */
+  DBSCAN(const double epsilon,
+         const size_t minPoints,
+         const bool singleMode = false,
+         const size_t batchSize = 10000);
+
+  /**
+   * Cluster the given dataset.  Noise points are assigned SIZE_MAX; the
+   * clusters are numbered 0, 1, 2, ..., in the order of the first core point of
+   * each one.
+   *
+   * @param data Dataset to cluster.
+   * @param assignments Vector to store the cluster of each point in.
+   * @return The number of clusters found.
+   */
+  size_t Cluster(const arma::mat& data, arma::Col<size_t>& assignments);
+
+  /**
+   * Cluster the given dataset, and also compute the centroid of every cluster
+   * (noise points are not part of any centroid).
+   *
+   * @param data Dataset to cluster.
+   * @param assignments Vector to store the cluster of each point in.
+   * @param centroids Matrix to store the centroids in (one per column).
+   * @return The number of clusters found.
+   */
+  size_t Cluster(const arma::mat& data,
+                 arma::Col<size_t>& assignments,
+                 arma::mat& centroids);
+
+  //! Get the radius of the neighborhoods.
+  double Epsilon() const { return epsilon; }
+  //! Modify the radius of the neighborhoods.
+  double& Epsilon() { return epsilon; }
+
+  //! Get the minimum size of the neighborhood of a core point.
+  size_t MinPoints() const { return minPoints; }
+  //! Modify the minimum size of the neighborhood of a core point.
+  size_t& MinPoints() { return minPoints; }
+
+  //! Get whether or not single-tree search is used.
+  bool SingleMode() const { return singleMode; }
+  //! Modify whether or not single-tree search is used.
+  bool& SingleMode() { return singleMode; }
+
+  //! Get the number of core points searched at once.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of core points searched at once.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get whether or not the clustering is parallel.
+  bool Parallel() const { return parallel; }
+  //! Modify whether or not the clustering is parallel.
+  bool& Parallel() { return parallel; }
+
+ private:
+  //! Radius of the neighborhoods.
+  double epsilon;
+  //! Minimum size of the neighborhood of a core point.
+  size_t minPoints;
+  //! Whether or not single-tree search is used.
+  bool singleMode;
+  //! Number of core points searched at once.
+  size_t batchSize;
+  //! Whether or not the clustering is parallel.
+  bool parallel;
+};
+
+}; // namespace dbscan
+}; // namespace mlpack
+
+// Include implementation.
+#include "dbscan_impl.hpp"
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * @file dbscan_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of DBSCAN.
+ */
+#ifndef __MLPACK_METHODS_DBSCAN_DBSCAN_IMPL_HPP
+#define __MLPACK_METHODS_DBSCAN_DBSCAN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "dbscan.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace mlpack {
+namespace dbscan {
+
+template<typename RangeSearchType>
+DBSCAN<RangeSearchType>::DBSCAN(const double epsilon,
+                                const size_t minPoints,
+                                const bool singleMode,
+                                const size_t batchSize) :
+    epsilon(epsilon),
+    minPoints(minPoints),
+    singleMode(singleMode),
+    batchSize(std::max(batchSize, (size_t) 1)),
+    parallel(false)
+{
+  // Nothing to do.
+}
+
+template<typename RangeSearchType>
+size_t DBSCAN<RangeSearchType>::Cluster(const arma::mat& data,
+                                        arma::Col<size_t>& assignments)
+{
+  const size_t n = data.n_cols;
+  const math::Range range(0.0, epsilon);
+
+  // The same reference tree is used for every search.
+  RangeSearchType rangeSearch(data, false, singleMode);
+  rangeSearch.Parallel() = parallel;
+
+  // Find the core points.  The counts don't include the point itself.
+  arma::Col<size_t> counts;
+  rangeSearch.Count(range, counts);
+
+  std::vector<char> isCore(n, 0);
+  std::vector<size_t> corePoints;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (counts[i] + 1 >= minPoints)
+    {
+      isCore[i] = 1;
+      corePoints.push_back(i);
+    }
+  }
+
+  // Merge the neighborhoods of the core points.  For every border point, keep
+  // the smallest core point it is a neighbor of.
+  emst::LockFreeUnionFind components(n);
+  std::unique_ptr<std::atomic<size_t>[]> owners(new std::atomic<size_t>[n]);
+  for (size_t i = 0; i < n; ++i)
+    owners[i].store(SIZE_MAX, std::memory_order_relaxed);
+
+  arma::mat batch;
+  arma::Col<size_t> offsets, neighbors;
+  arma::vec distances;
+  for (size_t start = 0; start < corePoints.size(); start += batchSize)
+  {
+    const size_t batchPoints = std::min(batchSize, corePoints.size() - start);
+    batch.set_size(data.n_rows, batchPoints);
+    for (size_t i = 0; i < batchPoints; ++i)
+      batch.col(i) = data.col(corePoints[start + i]);
+
+    rangeSearch.Search(batch, range, offsets, neighbors, distances);
+
+    #pragma omp parallel for schedule(dynamic, 64) if (parallel)
+    for (size_t i = 0; i < batchPoints; ++i)
+    {
+      const size_t point = corePoints[start + i];
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+      {
+        const size_t neighbor = neighbors[j];
+        if (isCore[neighbor])
+        {
+          // Both core points search their neighborhoods, so the pair only has
+          // to be merged from one side.
+          if (neighbor < point)
+            components.Union(point, neighbor);
+        }
+        else
+        {
+          size_t owner = owners[neighbor].load(std::memory_order_relaxed);
+          while (point < owner && !owners[neighbor].compare_exchange_weak(
+              owner, point, std::memory_order_relaxed)) { }
+        }
+      }
+    }
+  }
+
+  // The root of every component is its smallest point, so numbering the
+  // components in the order of their roots numbers the clusters in the order
+  // of their first core point.
+  assignments.set_size(n);
+  assignments.fill(SIZE_MAX);
+  size_t clusters = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (!isCore[i])
+      continue;
+
+    const size_t root = components.Find(i);
+    if (root == i)
+      assignments[i] = clusters++;
+    else
+      assignments[i] = assignments[root];
+  }
+
+  // Border points join the cluster of their core point.
+  for (size_t i = 0; i < n; ++i)
+  {
+    const size_t owner = owners[i].load(std::memory_order_relaxed);
+    if (!isCore[i] && owner != SIZE_MAX)
+      assignments[i] = assignments[owner];
+  }
+
+  return clusters;
+}
+
+template<typename RangeSearchType>
+size_t DBSCAN<RangeSearchType>::Cluster(const arma::mat& data,
+                                        arma::Col<size_t>& assignments,
+                                        arma::mat& centroids)
+{
+  const size_t clusters = Cluster(data, assignments);
+
+  centroids.zeros(data.n_rows, clusters);
+  arma::Col<size_t> sizes(clusters, arma::fill::zeros);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    if (assignments[i] == SIZE_MAX)
+      continue;
+
+    centroids.col(assignments[i]) += data.col(i);
+    ++sizes[assignments[i]];
+  }
+
+  for (size_t c = 0; c < clusters; ++c)
+    centroids.col(c) /= sizes[c];
+
+  return clusters;
+}
+
+}; // namespace dbscan
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file dbscan_main.cpp
+ * @author Ryan Curtin
+ *
+ * Executable for running DBSCAN clustering.
+ */
+#include <mlpack/core.hpp>
+
+#include "dbscan.hpp"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::dbscan;
+
+PROGRAM_INFO("DBSCAN clustering",
+    "This program performs DBSCAN clustering on the given dataset.  A point is "
+    "a core point if at least --min_size points (itself included) are within "
+    "distance --epsilon of it.  Core points within --epsilon of each other are "
+    "in the same cluster; the other points within --epsilon of a core point "
+    "join the cluster of one of those core points, and all remaining points are"
+    " noise."
+    "\n\n"
+    "The cluster assignments are saved to the file given with --output_file, "
+    "one per point; noise points are assigned the largest value of size_t "
+    "(SIZE_MAX).  The centroids of the clusters may be saved with "
+    "--centroid_file."
+    "\n\n"
+    "For example, the following clusters 'data.csv' with neighborhoods of "
+    "radius 0.5 and at least 10 points:"
+    "\n\n"
+    "$ dbscan --input_file=data.csv --epsilon=0.5 --min_size=10\n"
+    "  --output_file=assignments.csv");
+
+PARAM_STRING_REQ("input_file", "Input dataset to cluster.", "i");
+PARAM_STRING("output_file", "File to save the cluster assignments to.", "o",
+    "");
+PARAM_STRING("centroid_file", "If specified, the centroids of the clusters "
+    "will be saved to this file.", "C", "");
+
+PARAM_DOUBLE("epsilon", "Radius of the neighborhood of each point.", "e", 1.0);
+PARAM_INT("min_size", "Minimum number of points in the neighborhood of a core "
+    "point.", "m", 5);
+PARAM_FLAG("single_mode", "If true, single-tree range search is used (as "
+    "opposed to dual-tree range search).", "S");
+PARAM_INT("threads", "Number of threads to use for clustering (0 uses all "
+    "available cores; ignored without OpenMP).", "t", 0);
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  const string inputFile = CLI::GetParam<string>("input_file");
+  const double epsilon = CLI::GetParam<double>("epsilon");
+  const int minSize = CLI::GetParam<int>("min_size");
+
+  if (epsilon <= 0.0)
+  {
+    Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be greater than "
+        << "0." << endl;
+  }
+  if (minSize < 1)
+  {
+    Log::Fatal << "Invalid minimum size: " << minSize << ".  Must be greater "
+        << "than 0." << endl;
+  }
+
+  if (!CLI::HasParam("output_file") && !CLI::HasParam("centroid_file"))
+  {
+    Log::Warn << "Neither --output_file nor --centroid_file are set; no "
+        << "results will be saved." << endl;
+  }
+
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+  const bool parallel = (omp_get_max_threads() > 1);
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP "
+        << "support." << endl;
+  const bool parallel = false;
+#endif
+
+  arma::mat dataset;
+  data::Load(inputFile, dataset, true); // Fatal upon failure.
+
+  DBSCAN<> dbscan(epsilon, (size_t) minSize, CLI::HasParam("single_mode"));
+  dbscan.Parallel() = parallel;
+
+  arma::Col<size_t> assignments;
+  arma::mat centroids;
+
+  Timer::Start("clustering");
+  const size_t clusters = dbscan.Cluster(dataset, assignments, centroids);
+  Timer::Stop("clustering");
+
+  const size_t noise = arma::accu(assignments == SIZE_MAX);
+  Log::Info << "Found " << clusters << " clusters and " << noise << " noise "
+      << "points." << endl;
+
+  if (CLI::HasParam("output_file"))
+  {
+    arma::Mat<size_t> output = trans(assignments);
+    data::Save(CLI::GetParam<string>("output_file"), output);
+  }
+
+  if (CLI::HasParam("centroid_file"))
+    data::Save(CLI::GetParam<string>("centroid_file"), centroids);
+}
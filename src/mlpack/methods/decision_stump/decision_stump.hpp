@@ -9,6 +9,8 @@
 
 #include <mlpack/core.hpp>
 
+#include <memory>
+
 namespace mlpack {
 namespace decision_stump {
 
@@ -23,6 +25,16 @@ namespace decision_stump {
  * last bin has range up to \infty (split[i + 1] does not exist in that case).
  * Points that are below the first bin will take the label of the first bin.
  *
+ * By default, the split of each dimension is found by sorting it.  In
+ * histogram mode (histogramBins > 0), every dimension is instead quantized
+ * once into at most histogramBins (up to 256) bins of about the same number of
+ * points, stored as bytes, and the class counts of the bins come from one
+ * linear pass over the quantized dimension; the buckets of the split are then
+ * made of whole bins.  Training is O(n d) after the quantization, and stumps
+ * trained with weights from a stump in histogram mode (as in AdaBoost) reuse
+ * its quantized data.  With at most histogramBins distinct values in every
+ * dimension, the bins hold one value each.
+ *
  * @tparam MatType Type of matrix that is being used (sparse or dense).
  */
 template <typename MatType = arma::mat>
@@ -37,11 +49,14 @@ class DecisionStump
    * @param labels Labels of training data.
    * @param classes Number of distinct classes in labels.
    * @param inpBucketSize Minimum size of bucket when splitting.
+   * @param histogramBins If nonzero, the number of bins of histogram mode (at
+   *     most 256).
    */
   DecisionStump(const MatType& data,
                 const arma::Row<size_t>& labels,
                 const size_t classes,
-                size_t inpBucketSize);
+                size_t inpBucketSize,
+                const size_t histogramBins = 0);
 
   /**
    * Classification function. After training, classify test, and put the
@@ -56,7 +71,8 @@ class DecisionStump
   /**
    * Alternate constructor which copies parameters bucketSize and numClass from
    * an already initiated decision stump, other. It appropriately sets the
-   * weight vector.
+   * weight vector.  If other is in histogram mode and was trained on data of
+   * the same size, its quantized data is reused (so it must be the same data).
    *
    * @param other The other initiated Decision Stump object from
    *      which we copy the values.
@@ -70,6 +86,61 @@ class DecisionStump
                 const arma::rowvec& weights,
                 const arma::Row<size_t>& labels);
 
+  /**
+   * Alternate constructor which, like the constructor above, copies parameters
+   * from an already initiated decision stump and trains a weighted stump, but
+   * takes the sorted order of each dimension of the data, as computed by
+   * SortDimensions().  When many stumps are trained on the same data with
+   * different weights (as in boosting), sorting once with SortDimensions() and
+   * using this constructor avoids sorting every dimension for every stump.
+   *
+   * @param other The other initiated Decision Stump object from
+   *      which we copy the values.
+   * @param data The data on which to train this object on.
+   * @param weights Weight vector to use while training.
+   * @param labels The labels of data.
+   * @param sortedIndices Column i holds the indices which stably sort
+   *      dimension i of data.
+   */
+  DecisionStump(const DecisionStump<>& other,
+                const MatType& data,
+                const arma::rowvec& weights,
+                const arma::Row<size_t>& labels,
+                const arma::umat& sortedIndices);
+
+  /**
+   * Compute the indices which stably sort each dimension of the given data, for
+   * use with the constructor above.  The dimensions are sorted in parallel
+   * when OpenMP is available.
+   *
+   * @param data Dataset to sort.
+   * @param sortedIndices Matrix in which column i will hold the indices which
+   *      stably sort dimension i of data.
+   */
+  static void SortDimensions(const MatType& data, arma::umat& sortedIndices);
+
+  /**
+   * Quantize each dimension of the given data into at most the given number of
+   * bins (up to 256), for histogram mode.  The bins hold about the same number
+   * of points, and each bin starts at the smallest value that falls into it, so
+   * a dimension with few distinct values gets one bin for each value.  The
+   * dimensions are quantized in parallel when OpenMP is available.
+   *
+   * @param data Dataset to quantize.
+   * @param histogramBins Maximum number of bins of each dimension.
+   * @param binned Matrix in which column i will hold the bin of every point in
+   *      dimension i.
+   * @param edges Matrix in which column i will hold the smallest value of every
+   *      bin of dimension i; the rows after the last bin hold infinity.
+   */
+  static void BinDimensions(const MatType& data,
+                            const size_t histogramBins,
+                            arma::Mat<unsigned char>& binned,
+                            arma::mat& edges);
+
+  //! Get the number of bins of histogram mode (0 if it is not used).
+  size_t HistogramBins() const { return histogramBins; }
+
   //! Access the splitting attribute.
   int SplitAttribute() const { return splitAttribute; }
   //! Modify the splitting attribute (be careful!).
@@ -101,16 +172,33 @@ class DecisionStump
   //! Stores the labels for each splitting bin.
   arma::Col<size_t> binLabels;
 
+  //! The number of bins of histogram mode (0 if it is not used).
+  size_t histogramBins;
+
+  //! The quantized training data of histogram mode.
+  struct Histogram
+  {
+    //! The bin of every point (rows) in every dimension (columns).
+    arma::Mat<unsigned char> binned;
+    //! The smallest value of every bin (rows) of every dimension (columns).
+    arma::mat edges;
+  };
+
+  //! The quantized training data, shared with the stumps trained from this one.
+  std::shared_ptr<const Histogram> histogram;
+
   /**
    * Sets up attribute as if it were splitting on it and finds entropy when
    * splitting on attribute.
    *
    * @param attribute A row from the training data, which might be a
    *     candidate for the splitting attribute.
+   * @param sortedIndexAtt Indices which stably sort the attribute.
    * @param isWeight Whether we need to run a weighted Decision Stump.
    */
   template <bool isWeight>
   double SetupSplitAttribute(const arma::rowvec& attribute,
+                             const arma::uvec& sortedIndexAtt,
                              const arma::Row<size_t>& labels,
                              const arma::rowvec& weightD);
 
@@ -120,8 +208,11 @@ class DecisionStump
    *
    * @param attribute attribute is the attribute decided by the constructor
    *      on which we now train the decision stump.
+   * @param sortedSplitIndexAtt Indices which stably sort the attribute.
    */
   template <typename rType> void TrainOnAtt(const arma::rowvec& attribute,
+                                            const arma::uvec&
+                                                sortedSplitIndexAtt,
                                             const arma::Row<size_t>& labels);
 
   /**
@@ -139,13 +230,6 @@ class DecisionStump
   template <typename rType> rType CountMostFreq(const arma::Row<rType>&
       subCols);
 
-  /**
-   * Returns 1 if all the values of featureRow are not same.
-   *
-   * @param featureRow The attribute which is checked for identical values.
-   */
-  template <typename rType> int IsDistinct(const arma::Row<rType>& featureRow);
-
   /**
    * Calculate the entropy of the given attribute.
    *
@@ -162,11 +246,42 @@ class DecisionStump
    *
    * @param data Dataset to train on.
    * @param labels Labels for dataset.
+   * @param sortedIndices Sorted order of each dimension of the data, from
+   *     SortDimensions(); if empty, each dimension is sorted as it is tried.
    * @param isWeight Whether we need to run a weighted Decision Stump.
    */
   template <bool isWeight>
   void Train(const MatType& data, const arma::Row<size_t>& labels,
-             const arma::rowvec& weightD);
+             const arma::rowvec& weightD, const arma::umat& sortedIndices);
+
+  /**
+   * Train the decision stump in histogram mode, quantizing the data first
+   * unless the stump it was copied from has done it already.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for dataset.
+   * @param isWeight Whether we need to run a weighted Decision Stump.
+   */
+  template <bool isWeight>
+  void HistogramTrain(const MatType& data, const arma::Row<size_t>& labels,
+                      const arma::rowvec& weightD);
+
+  /**
+   * Group the bins of one quantized dimension into buckets, like
+   * SetupSplitAttribute() groups sorted points, and return the entropy of the
+   * split.  A bucket ends where the majority label of the next bin differs,
+   * once it holds at least bucketSize points.
+   *
+   * @param classCounts Number of points of each class (rows) in each bin.
+   * @param classWeights Weight of the points of each class in each bin (empty
+   *      for an unweighted stump).
+   * @param firstBins If not NULL, filled with the first bin of every bucket.
+   * @param bucketLabels If not NULL, filled with the label of every bucket.
+   */
+  double BucketBins(const arma::Mat<size_t>& classCounts,
+                    const arma::mat& classWeights,
+                    std::vector<size_t>* firstBins,
+                    std::vector<size_t>* bucketLabels) const;
 
 };
 
@@ -11,6 +11,10 @@
 // In case it hasn't been included yet.
 #include "decision_stump.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace decision_stump {
 
@@ -21,19 +25,29 @@ namespace decision_stump {
  * @param labels Labels of data.
  * @param classes Number of distinct classes in labels.
  * @param inpBucketSize Minimum size of bucket when splitting.
+ * @param histogramBins If nonzero, the number of bins of histogram mode.
  */
 template<typename MatType>
 DecisionStump<MatType>::DecisionStump(const MatType& data,
                                       const arma::Row<size_t>& labels,
                                       const size_t classes,
-                                      size_t inpBucketSize)
+                                      size_t inpBucketSize,
+                                      const size_t histogramBins) :
+    histogramBins(histogramBins)
 {
   numClass = classes;
   bucketSize = inpBucketSize;
 
+  if (histogramBins > 256)
+  {
+    Log::Fatal << "DecisionStump: the number of histogram bins ("
+        << histogramBins << ") must be at most 256." << std::endl;
+  }
+
   arma::rowvec weightD;
+  arma::umat sortedIndices;
 
-  Train<false>(data, labels, weightD);
+  Train<false>(data, labels, weightD, sortedIndices);
 }
 
 /**
@@ -41,47 +55,80 @@ DecisionStump<MatType>::DecisionStump(const MatType& data,
  *
  * @param data Dataset to train on.
  * @param labels Labels for dataset.
+ * @param sortedIndices Sorted order of each dimension of the data; may be
+ *     empty.
  * @param isWeight Whether we need to run a weighted Decision Stump.
  */
 template<typename MatType>
 template <bool isWeight>
-void DecisionStump<MatType>::Train(const MatType& data, const arma::Row<size_t>& labels,
-                                    const arma::rowvec& weightD)
+void DecisionStump<MatType>::Train(const MatType& data,
+                                   const arma::Row<size_t>& labels,
+                                   const arma::rowvec& weightD,
+                                   const arma::umat& sortedIndices)
 {
+  if (histogramBins > 0)
+  {
+    HistogramTrain<isWeight>(data, labels, weightD);
+    return;
+  }
+
   // If classLabels are not all identical, proceed with training.
   int bestAtt = 0;
-  double entropy;
   const double rootEntropy = CalculateEntropy<size_t, isWeight>(
       labels.subvec(0, labels.n_elem - 1), 0, weightD);
 
-  double gain, bestGain = 0.0;
+  // Each attribute is a candidate independently of every other, so the
+  // candidates are evaluated in parallel; the best one is chosen afterwards,
+  // in order, so the result does not depend on the number of threads.
+  arma::vec gains(data.n_rows);
+  arma::Col<int> candidates(data.n_rows);
+  candidates.zeros();
+
+  #pragma omp parallel for schedule(dynamic)
   for (size_t i = 0; i < data.n_rows; i++)
   {
-    // Go through each attribute of the data.
-    if (IsDistinct<double>(data.row(i)))
+    const arma::rowvec attribute = data.row(i);
+    const arma::uvec sortedIndexAtt = sortedIndices.is_empty() ?
+        arma::uvec(arma::stable_sort_index(attribute.t())) :
+        arma::uvec(sortedIndices.col(i));
+
+    // Go through each attribute of the data.  An attribute has non-identical
+    // values if its smallest and largest values differ.
+    if (attribute(sortedIndexAtt(0)) !=
+        attribute(sortedIndexAtt(sortedIndexAtt.n_elem - 1)))
     {
       // For each attribute with non-identical values, treat it as a potential
       // splitting attribute and calculate entropy if split on it.
-      entropy = SetupSplitAttribute<isWeight>(data.row(i), labels, weightD);
+      gains(i) = rootEntropy - SetupSplitAttribute<isWeight>(attribute,
+          sortedIndexAtt, labels, weightD);
+      candidates(i) = 1;
+    }
+  }
 
-      gain = rootEntropy - entropy;
-      // Find the attribute with the best entropy so that the gain is
-      // maximized.
+  double bestGain = 0.0;
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    // Find the attribute with the best entropy so that the gain is
+    // maximized.
 
-      // if (entropy < bestEntropy)
-      // Instead of the above rule, we are maximizing gain, which was
-      // what is returned from SetupSplitAttribute.
-      if (gain < bestGain)
-      {
-        bestAtt = i;
-        bestGain = gain;
-      }
+    // if (entropy < bestEntropy)
+    // Instead of the above rule, we are maximizing gain, which was
+    // what is returned from SetupSplitAttribute.
+    if (candidates(i) && gains(i) < bestGain)
+    {
+      bestAtt = i;
+      bestGain = gains(i);
     }
   }
   splitAttribute = bestAtt;
 
   // Once the splitting column/attribute has been decided, train on it.
-  TrainOnAtt<double>(data.row(splitAttribute), labels);
+  const arma::rowvec attribute = data.row(splitAttribute);
+  if (sortedIndices.is_empty())
+    TrainOnAtt<double>(attribute, arma::stable_sort_index(attribute.t()),
+        labels);
+  else
+    TrainOnAtt<double>(attribute, sortedIndices.col(splitAttribute), labels);
 }
 
 /**
@@ -138,11 +185,279 @@ DecisionStump<MatType>::DecisionStump(
 {
   numClass = other.numClass;
   bucketSize = other.bucketSize;
+  histogramBins = other.histogramBins;
+  histogram = other.histogram;
 
   // weightD = weights;
   // tempD = weightD;
 
-  Train<true>(data, labels, weights);
+  arma::umat sortedIndices;
+  Train<true>(data, labels, weights, sortedIndices);
+}
+
+/**
+ * Alternate constructor which copies parameters bucketSize and numClass
+ * from an already initiated decision stump, other, and uses the given sorted
+ * order of each dimension of the data instead of sorting it again.
+ */
+template <typename MatType>
+DecisionStump<MatType>::DecisionStump(const DecisionStump<>& other,
+                                      const MatType& data,
+                                      const arma::rowvec& weights,
+                                      const arma::Row<size_t>& labels,
+                                      const arma::umat& sortedIndices)
+{
+  numClass = other.numClass;
+  bucketSize = other.bucketSize;
+  histogramBins = other.histogramBins;
+  histogram = other.histogram;
+
+  Train<true>(data, labels, weights, sortedIndices);
+}
+
+/**
+ * Compute the indices which stably sort each dimension of the given data.
+ */
+template <typename MatType>
+void DecisionStump<MatType>::SortDimensions(const MatType& data,
+                                            arma::umat& sortedIndices)
+{
+  sortedIndices.set_size(data.n_cols, data.n_rows);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    const arma::rowvec attribute = data.row(i);
+    sortedIndices.col(i) = arma::stable_sort_index(attribute.t());
+  }
+}
+
+/**
+ * Quantize each dimension of the given data into at most histogramBins bins.
+ */
+template <typename MatType>
+void DecisionStump<MatType>::BinDimensions(const MatType& data,
+                                           const size_t histogramBins,
+                                           arma::Mat<unsigned char>& binned,
+                                           arma::mat& edges)
+{
+  const size_t maxBins = std::min(std::max(histogramBins, (size_t) 1),
+      (size_t) 256);
+
+  binned.set_size(data.n_cols, data.n_rows);
+  edges.set_size(maxBins, data.n_rows);
+  edges.fill(arma::datum::inf);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    const arma::rowvec attribute = data.row(i);
+    if (attribute.n_elem == 0)
+      continue;
+
+    // Every distinct value gets its own bin if there are few enough of them;
+    // otherwise the bins start at the quantiles of the dimension.
+    const arma::vec sorted = arma::sort(attribute.t());
+    const arma::vec distinct = arma::unique(sorted);
+    size_t bins = 0;
+    if (distinct.n_elem <= maxBins)
+    {
+      edges.col(i).head(distinct.n_elem) = distinct;
+      bins = distinct.n_elem;
+    }
+    else
+    {
+      for (size_t b = 0; b < maxBins; ++b)
+      {
+        const double edge = sorted[b * sorted.n_elem / maxBins];
+        if (bins == 0 || edge > edges(bins - 1, i))
+          edges(bins++, i) = edge;
+      }
+    }
+
+    const double* first = edges.colptr(i);
+    for (size_t j = 0; j < attribute.n_elem; j++)
+    {
+      binned(j, i) = (unsigned char) (std::upper_bound(first, first + bins,
+          attribute[j]) - first - 1);
+    }
+  }
+}
+
+/**
+ * Train the decision stump in histogram mode.
+ */
+template <typename MatType>
+template <bool isWeight>
+void DecisionStump<MatType>::HistogramTrain(const MatType& data,
+                                            const arma::Row<size_t>& labels,
+                                            const arma::rowvec& weightD)
+{
+  // The data is only quantized once for all the stumps trained from the same
+  // one.
+  if (!histogram || histogram->binned.n_rows != data.n_cols ||
+      histogram->binned.n_cols != data.n_rows)
+  {
+    std::shared_ptr<Histogram> newHistogram(new Histogram());
+    BinDimensions(data, histogramBins, newHistogram->binned,
+        newHistogram->edges);
+    histogram = newHistogram;
+  }
+
+  const arma::Mat<unsigned char>& binned = histogram->binned;
+  const arma::mat& edges = histogram->edges;
+
+  // The class counts (and weights) of the bins of a dimension, in one pass.
+  auto countBins = [&](const size_t i,
+                       arma::Mat<size_t>& classCounts,
+                       arma::mat& classWeights)
+  {
+    size_t bins = 0;
+    while (bins < edges.n_rows && edges(bins, i) != arma::datum::inf)
+      ++bins;
+
+    classCounts.zeros(numClass, bins);
+    if (isWeight)
+      classWeights.zeros(numClass, bins);
+
+    const unsigned char* pointBins = binned.colptr(i);
+    for (size_t j = 0; j < binned.n_rows; j++)
+    {
+      ++classCounts(labels[j], pointBins[j]);
+      if (isWeight)
+        classWeights(labels[j], pointBins[j]) += weightD[j];
+    }
+  };
+
+  const double rootEntropy = CalculateEntropy<size_t, isWeight>(
+      labels.subvec(0, labels.n_elem - 1), 0, weightD);
+
+  // As in Train(), the dimensions are evaluated in parallel and the best one
+  // is chosen in order afterwards.
+  arma::vec gains(data.n_rows);
+  arma::Col<int> candidates(data.n_rows);
+  candidates.zeros();
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    arma::Mat<size_t> classCounts;
+    arma::mat classWeights;
+    countBins(i, classCounts, classWeights);
+
+    // A dimension with a single bin has identical values.
+    if (classCounts.n_cols > 1)
+    {
+      gains(i) = rootEntropy - BucketBins(classCounts, classWeights, NULL,
+          NULL);
+      candidates(i) = 1;
+    }
+  }
+
+  int bestAtt = 0;
+  double bestGain = 0.0;
+  for (size_t i = 0; i < data.n_rows; i++)
+  {
+    if (candidates(i) && gains(i) < bestGain)
+    {
+      bestAtt = i;
+      bestGain = gains(i);
+    }
+  }
+  splitAttribute = bestAtt;
+
+  // Every bucket starts at the smallest value of its first bin.
+  arma::Mat<size_t> classCounts;
+  arma::mat classWeights;
+  countBins(splitAttribute, classCounts, classWeights);
+
+  std::vector<size_t> firstBins, bucketLabels;
+  BucketBins(classCounts, classWeights, &firstBins, &bucketLabels);
+
+  split.set_size(firstBins.size());
+  binLabels.set_size(bucketLabels.size());
+  for (size_t i = 0; i < firstBins.size(); i++)
+  {
+    split(i) = edges(firstBins[i], splitAttribute);
+    binLabels(i) = bucketLabels[i];
+  }
+
+  MergeRanges();
+}
+
+/**
+ * Group the bins of one quantized dimension into buckets and return the
+ * entropy of the split.
+ */
+template <typename MatType>
+double DecisionStump<MatType>::BucketBins(
+    const arma::Mat<size_t>& classCounts,
+    const arma::mat& classWeights,
+    std::vector<size_t>* firstBins,
+    std::vector<size_t>* bucketLabels) const
+{
+  const bool isWeight = !classWeights.is_empty();
+  const size_t bins = classCounts.n_cols;
+  const double points = (double) arma::accu(classCounts);
+
+  // The most frequent class of each bin (the largest one in case of a tie, as
+  // with CountMostFreq()).
+  arma::Col<size_t> majority(bins);
+  for (size_t b = 0; b < bins; b++)
+  {
+    majority(b) = 0;
+    for (size_t c = 1; c < numClass; c++)
+      if (classCounts(c, b) >= classCounts(majority(b), b))
+        majority(b) = c;
+  }
+
+  double entropy = 0.0;
+  arma::Col<size_t> bucketCounts(numClass);
+  arma::vec bucketWeights(numClass);
+  bucketCounts.zeros();
+  bucketWeights.zeros();
+  size_t first = 0;
+
+  for (size_t b = 0; b < bins; b++)
+  {
+    bucketCounts += classCounts.col(b);
+    if (isWeight)
+      bucketWeights += classWeights.col(b);
+
+    const size_t bucketPoints = arma::accu(bucketCounts);
+    if (b < bins - 1 && (majority(b) == majority(b + 1) ||
+        bucketPoints < bucketSize))
+      continue;
+
+    // The entropy of the bucket, as computed by CalculateEntropy().
+    const arma::vec weights = isWeight ? bucketWeights :
+        arma::conv_to<arma::vec>::from(bucketCounts);
+    const double total = arma::accu(weights);
+    double bucketEntropy = 0.0;
+    for (size_t c = 0; c < numClass; c++)
+    {
+      const double p1 = weights(c) / total;
+      bucketEntropy += (p1 == 0) ? 0 : p1 * std::log(p1);
+    }
+    entropy += (bucketPoints / points) * bucketEntropy / std::log(2.0);
+
+    if (firstBins)
+      firstBins->push_back(first);
+    if (bucketLabels)
+    {
+      size_t label = 0;
+      for (size_t c = 1; c < numClass; c++)
+        if (bucketCounts(c) >= bucketCounts(label))
+          label = c;
+      bucketLabels->push_back(label);
+    }
+
+    bucketCounts.zeros();
+    bucketWeights.zeros();
+    first = b + 1;
+  }
+
+  return entropy;
 }
 
 /**
@@ -157,19 +472,15 @@ template <typename MatType>
 template <bool isWeight>
 double DecisionStump<MatType>::SetupSplitAttribute(
     const arma::rowvec& attribute,
+    const arma::uvec& sortedIndexAtt,
     const arma::Row<size_t>& labels,
     const arma::rowvec& weightD)
 {
   size_t i, count, begin, end;
   double entropy = 0.0;
 
-  // Sort the attribute in order to calculate splitting ranges.
-  arma::rowvec sortedAtt = arma::sort(attribute);
-
-  // Store the indices of the sorted attribute to build a vector of sorted
-  // labels.  This sort is stable.
-  arma::uvec sortedIndexAtt = arma::stable_sort_index(attribute.t());
-
+  // The indices of the sorted attribute (from a stable sort) are used to build
+  // a vector of sorted labels.
   arma::Row<size_t> sortedLabels(attribute.n_elem);
   sortedLabels.fill(0);
 
@@ -250,12 +561,15 @@ double DecisionStump<MatType>::SetupSplitAttribute(
 template <typename MatType>
 template <typename rType>
 void DecisionStump<MatType>::TrainOnAtt(const arma::rowvec& attribute,
+                                        const arma::uvec& sortedSplitIndexAtt,
                                         const arma::Row<size_t>& labels)
 {
   size_t i, count, begin, end;
 
-  arma::rowvec sortedSplitAtt = arma::sort(attribute);
-  arma::uvec sortedSplitIndexAtt = arma::stable_sort_index(attribute.t());
+  arma::rowvec sortedSplitAtt(attribute.n_elem);
+  for (i = 0; i < attribute.n_elem; i++)
+    sortedSplitAtt(i) = attribute(sortedSplitIndexAtt(i));
+
   arma::Row<size_t> sortedLabels(attribute.n_elem);
   sortedLabels.fill(0);
   arma::vec tempSplit;
@@ -386,22 +700,6 @@ rType DecisionStump<MatType>::CountMostFreq(const arma::Row<rType>& subCols)
   return mostFreq;
 }
 
-/**
- * Returns 1 if all the values of featureRow are not same.
- *
- * @param featureRow The attribute which is checked for identical values.
- */
-template <typename MatType>
-template <typename rType>
-int DecisionStump<MatType>::IsDistinct(const arma::Row<rType>& featureRow)
-{
-  rType val = featureRow(0);
-  for (size_t i = 1; i < featureRow.n_elem; ++i)
-    if (val != featureRow(i))
-      return 1;
-  return 0;
-}
-
 /**
  * Calculate entropy of attribute.
  *
@@ -7,6 +7,7 @@
 
 #include <mlpack/core.hpp>
 #include "dt_utils.hpp"
+#include "flat_dtree.hpp"
 
 using namespace mlpack;
 using namespace mlpack::det;
@@ -57,6 +58,10 @@ PARAM_INT("min_leaf_size", "The minimum size of a leaf in the unpruned, fully "
     "grown DET.", "N", 5);
 PARAM_INT("max_leaf_size", "The maximum size of a leaf in the unpruned, fully "
     "grown DET.", "M", 10);
+PARAM_FLAG("presort", "Sort the points in every dimension once and grow the "
+    "trees in parallel from the presorted points.  This is much faster for "
+    "large datasets, but needs memory for one index per point and dimension.",
+    "S");
 /*
 PARAM_FLAG("volume_regularization", "This flag gives the used the option to use"
     "a form of regularization similar to the usual alpha-pruning in decision "
@@ -102,9 +107,12 @@ int main(int argc, char *argv[])
   // Obtain the optimal tree.
   Timer::Start("det_training");
   DTree *dtreeOpt = Trainer(trainingData, folds, regularization, maxLeafSize,
-      minLeafSize, unprunedTreeEstimateFile);
+      minLeafSize, unprunedTreeEstimateFile, CLI::HasParam("presort"));
   Timer::Stop("det_training");
 
+  // The densities are computed with a flattened copy of the optimal tree.
+  const FlatDTree flatTree(*dtreeOpt);
+
   // Compute densities for the training points in the optimal tree.
   FILE *fp = NULL;
 
@@ -115,10 +123,13 @@ int main(int argc, char *argv[])
 
     // Compute density estimates for each point in the training set.
     Timer::Start("det_estimation_time");
-    for (size_t i = 0; i < trainingData.n_cols; i++)
-      fprintf(fp, "%lg\n", dtreeOpt->ComputeValue(trainingData.unsafe_col(i)));
+    arma::vec estimates;
+    flatTree.ComputeValues(trainingData, estimates);
     Timer::Stop("det_estimation_time");
 
+    for (size_t i = 0; i < estimates.n_elem; i++)
+      fprintf(fp, "%lg\n", estimates[i]);
+
     fclose(fp);
   }
 
@@ -137,10 +148,13 @@ int main(int argc, char *argv[])
       fp = fopen(CLI::GetParam<string>("test_set_estimates_file").c_str(), "w");
 
       Timer::Start("det_test_set_estimation");
-      for (size_t i = 0; i < testData.n_cols; i++)
-        fprintf(fp, "%lg\n", dtreeOpt->ComputeValue(testData.unsafe_col(i)));
+      arma::vec estimates;
+      flatTree.ComputeValues(testData, estimates);
       Timer::Stop("det_test_set_estimation");
 
+      for (size_t i = 0; i < estimates.n_elem; i++)
+        fprintf(fp, "%lg\n", estimates[i]);
+
       fclose(fp);
     }
   }
@@ -101,7 +101,8 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
                             const bool useVolumeReg,
                             const size_t maxLeafSize,
                             const size_t minLeafSize,
-                            const std::string unprunedTreeOutput)
+                            const std::string unprunedTreeOutput,
+                            const bool presort)
 {
   // Initialize the tree.
   DTree dtree(dataset);
@@ -117,7 +118,7 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
   // Growing the tree
   double oldAlpha = 0.0;
   double alpha = dtree.Grow(newDataset, oldFromNew, useVolumeReg, maxLeafSize,
-      minLeafSize);
+      minLeafSize, presort);
 
   Log::Info << dtree.SubtreeLeaves() << " leaf nodes in the tree using full "
       << "dataset; minimum alpha: " << alpha << "." << std::endl;
@@ -168,38 +169,32 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
   Log::Info << prunedSequence.size() << " trees in the sequence; maximum alpha:"
       << " " << oldAlpha << "." << std::endl;
 
-  arma::mat cvData(dataset);
   size_t testSize = dataset.n_cols / folds;
 
   arma::vec regularizationConstants(prunedSequence.size());
   regularizationConstants.fill(0.0);
 
   Timer::Start("cross_validation");
-  // Go through each fold.
-  #pragma omp parallel for default(none) \
-    shared(testSize,cvData,prunedSequence,regularizationConstants,dataset)
+  // Go through each fold, in parallel.  The dataset is only read by the folds:
+  // the test points of a fold are evaluated in place, and only the training
+  // points of every fold are copied (growing the tree reorders them).  The
+  // folds may take very different times, so they are handed out one by one.
+  #pragma omp parallel for schedule(dynamic) default(none) \
+    shared(testSize,prunedSequence,regularizationConstants,dataset)
   for (size_t fold = 0; fold < folds; fold++)
   {
     // Break up data into train and test sets.
     size_t start = fold * testSize;
-    size_t end = std::min((fold + 1) * testSize, (size_t) cvData.n_cols);
+    size_t end = std::min((fold + 1) * testSize, (size_t) dataset.n_cols);
 
-    arma::mat test = cvData.cols(start, end - 1);
-    arma::mat train(cvData.n_rows, cvData.n_cols - test.n_cols);
+    const size_t testPoints = end - start;
+    arma::mat train(dataset.n_rows, dataset.n_cols - testPoints);
 
-    if (start == 0 && end < cvData.n_cols)
-    {
-      train.cols(0, train.n_cols - 1) = cvData.cols(end, cvData.n_cols - 1);
-    }
-    else if (start > 0 && end == cvData.n_cols)
-    {
-      train.cols(0, train.n_cols - 1) = cvData.cols(0, start - 1);
-    }
-    else
-    {
-      train.cols(0, start - 1) = cvData.cols(0, start - 1);
-      train.cols(start, train.n_cols - 1) = cvData.cols(end, cvData.n_cols - 1);
-    }
+    if (start > 0)
+      train.cols(0, start - 1) = dataset.cols(0, start - 1);
+    if (end < dataset.n_cols)
+      train.cols(start, train.n_cols - 1) = dataset.cols(end,
+          dataset.n_cols - 1);
 
     // Initialize the tree.
     DTree cvDTree(train);
@@ -211,7 +206,7 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
 
     // Grow the tree.
     cvDTree.Grow(train, cvOldFromNew, useVolumeReg, maxLeafSize,
-        minLeafSize);
+        minLeafSize, presort);
 
     // Sequentially prune with all the values of available alphas and adding
     // values for test values.  Don't enter this loop if there are less than two
@@ -223,11 +218,8 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
     {
       // Compute test values for this state of the tree.
       double cvVal = 0.0;
-      for (size_t j = 0; j < test.n_cols; j++)
-      {
-        arma::vec testPoint = test.unsafe_col(j);
-        cvVal += cvDTree.ComputeValue(testPoint);
-      }
+      for (size_t j = start; j < end; j++)
+        cvVal += cvDTree.ComputeValue(dataset.unsafe_col(j));
 
       // Update the cv regularization constant.
       cvRegularizationConstants[i] += 2.0 * cvVal / (double) dataset.n_cols;
@@ -240,11 +232,8 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
 
     // Compute test values for this state of the tree.
     double cvVal = 0.0;
-    for (size_t i = 0; i < test.n_cols; ++i)
-    {
-      arma::vec testPoint = test.unsafe_col(i);
-      cvVal += cvDTree.ComputeValue(testPoint);
-    }
+    for (size_t i = start; i < end; ++i)
+      cvVal += cvDTree.ComputeValue(dataset.unsafe_col(i));
 
     if (prunedSequence.size() > 2)
       cvRegularizationConstants[prunedSequence.size() - 2] += 2.0 * cvVal /
@@ -287,7 +276,7 @@ DTree* mlpack::det::Trainer(arma::mat& dataset,
   // Grow the tree.
   oldAlpha = -DBL_MAX;
   alpha = dtreeOpt->Grow(newDataset, oldFromNew, useVolumeReg, maxLeafSize,
-      minLeafSize);
+      minLeafSize, presort);
 
   // Prune with optimal alpha.
   while ((oldAlpha < optimalAlpha) && (dtreeOpt->SubtreeLeaves() > 1))
@@ -53,13 +53,16 @@ void PrintVariableImportance(const DTree* dtree,
  * @param maxLeafSize Maximum number of points allowed in a leaf.
  * @param minLeafSize Minimum number of points allowed in a leaf.
  * @param unprunedTreeOutput Filename to print unpruned tree to (optional).
+ * @param presort If true, the trees are grown with presorted points (see
+ *     DTree::Grow()).
  */
 DTree* Trainer(arma::mat& dataset,
                const size_t folds,
                const bool useVolumeReg = false,
                const size_t maxLeafSize = 10,
                const size_t minLeafSize = 5,
-               const std::string unprunedTreeOutput = "");
+               const std::string unprunedTreeOutput = "",
+               const bool presort = false);
 
 }; // namespace det
 }; // namespace mlpack
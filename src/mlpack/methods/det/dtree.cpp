@@ -7,6 +7,7 @@
  *
  */
 #include "dtree.hpp"
+#include "flat_dtree.hpp"
 #include <stack>
 
 using namespace mlpack;
@@ -130,7 +131,8 @@ bool DTree::FindSplit(const arma::mat& data,
                       double& splitValue,
                       double& leftError,
                       double& rightError,
-                      const size_t minLeafSize) const
+                      const size_t minLeafSize,
+                      const arma::Mat<size_t>* sortedIndices) const
 {
   // Ensure the dimensionality of the data is the same as the dimensionality of
   // the bounding rectangle.
@@ -165,11 +167,20 @@ bool DTree::FindSplit(const arma::mat& data,
     // Find the log volume of all the other dimensions.
     double volumeWithoutDim = logVolume - std::log(max - min);
 
-    // Get the values for the dimension.
-    arma::rowvec dimVec = data.row(dim).subvec(start, end - 1);
-
-    // Sort the values in ascending order.
-    dimVec = arma::sort(dimVec);
+    // Get the values for the dimension, sorted in ascending order.  If the
+    // sorted order of the points is given, the values are only gathered.
+    arma::rowvec dimVec;
+    if (sortedIndices != NULL)
+    {
+      dimVec.set_size(points);
+      const size_t* indices = sortedIndices->colptr(dim) + start;
+      for (size_t i = 0; i < points; ++i)
+        dimVec[i] = data(dim, indices[i]);
+    }
+    else
+    {
+      dimVec = arma::sort(data.row(dim).subvec(start, end - 1));
+    }
 
     // Find the best split for this dimension.  We need to figure out why
     // there are spikes if this minLeafSize is enforced here...
@@ -265,26 +276,68 @@ size_t DTree::SplitData(arma::mat& data,
   return left;
 }
 
+size_t DTree::SplitSortedIndices(const arma::mat& data,
+                                 arma::Mat<size_t>& sortedIndices,
+                                 std::vector<char>& isLeft,
+                                 const size_t splitDim,
+                                 const double splitValue) const
+{
+  // The points left of the split are a prefix of the sorted points in the
+  // split dimension.
+  size_t* splitIndices = sortedIndices.colptr(splitDim);
+  size_t splitIndex = start;
+  while (splitIndex < end && data(splitDim, splitIndices[splitIndex]) <=
+      splitValue)
+    ++splitIndex;
+
+  for (size_t i = start; i < end; ++i)
+    isLeft[splitIndices[i]] = (i < splitIndex);
+
+  // Partition the sorted points of every other dimension stably, so that both
+  // sides stay sorted.  The left points are compacted in place, and the right
+  // points are collected in a buffer.
+  std::vector<size_t> rightIndices(end - splitIndex);
+  for (size_t dim = 0; dim < sortedIndices.n_cols; ++dim)
+  {
+    if (dim == splitDim)
+      continue;
+
+    size_t* indices = sortedIndices.colptr(dim);
+    size_t leftPos = start;
+    size_t rightPos = 0;
+    for (size_t i = start; i < end; ++i)
+    {
+      if (isLeft[indices[i]])
+        indices[leftPos++] = indices[i];
+      else
+        rightIndices[rightPos++] = indices[i];
+    }
+
+    std::copy(rightIndices.begin(), rightIndices.end(), indices + leftPos);
+  }
+
+  return splitIndex;
+}
+
 // Greedily expand the tree
 double DTree::Grow(arma::mat& data,
                    arma::Col<size_t>& oldFromNew,
                    const bool useVolReg,
                    const size_t maxLeafSize,
-                   const size_t minLeafSize)
+                   const size_t minLeafSize,
+                   const bool presort)
 {
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
 
-  double leftG, rightG;
+  if (presort)
+    return GrowPresorted(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize);
 
-  // Compute points ratio.
-  ratio = (double) (end - start) / (double) oldFromNew.n_elem;
+  double leftG = std::numeric_limits<double>::max();
+  double rightG = std::numeric_limits<double>::max();
 
-  // Compute the log of the volume of the node.
-  logVolume = 0;
-  for (size_t i = 0; i < maxVals.n_elem; ++i)
-    if (maxVals[i] - minVals[i] > 0.0)
-      logVolume += std::log(maxVals[i] - minVals[i]);
+  // Compute points ratio and the volume of the node.
+  InitializeGrowth(oldFromNew.n_elem);
 
   // Check if node is large enough to split.
   if ((size_t) (end - start) > maxLeafSize) {
@@ -299,55 +352,201 @@ double DTree::Grow(arma::mat& data,
       // contiguously (to increase efficiency during the training).
       const size_t splitIndex = SplitData(data, dim, splitValueTmp, oldFromNew);
 
-      // Make max and min vals for the children.
-      arma::vec maxValsL(maxVals);
-      arma::vec maxValsR(maxVals);
-      arma::vec minValsL(minVals);
-      arma::vec minValsR(minVals);
-
-      maxValsL[dim] = splitValueTmp;
-      minValsR[dim] = splitValueTmp;
-
-      // Store split dim and split val in the node.
-      splitValue = splitValueTmp;
-      splitDim = dim;
+      CreateChildren(dim, splitValueTmp, splitIndex, leftError, rightError);
 
       // Recursively grow the children.
-      left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
-      right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
-
       leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize,
           minLeafSize);
       rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
           minLeafSize);
+    }
+  }
+  else
+  {
+    // We can make this a leaf node.
+    assert((size_t) (end - start) >= minLeafSize);
+  }
 
-      // Store values of R(T~) and |T~|.
-      subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
+  return FinishGrowth(data.n_cols, useVolReg, leftG, rightG);
+}
 
-      // Find the log negative error of the subtree leaves.  This is kind of an
-      // odd one because we don't want to represent the error in non-log-space,
-      // but we have to calculate log(E_l + E_r).  So we multiply E_l and E_r by
-      // V_t (remember E_l has an inverse relationship to the volume of the
-      // nodes) and then subtract log(V_t) at the end of the whole expression.
-      // As a result we do leave log-space, but the largest quantity we
-      // represent is on the order of (V_t / V_i) where V_i is the smallest leaf
-      // node below this node, which depends heavily on the depth of the tree.
-      subtreeLeavesLogNegError = std::log(
-          std::exp(logVolume + left->SubtreeLeavesLogNegError()) +
-          std::exp(logVolume + right->SubtreeLeavesLogNegError()))
-          - logVolume;
-    }
-    else
+// Grow the tree with the presorted points, in parallel.
+double DTree::GrowPresorted(arma::mat& data,
+                            arma::Col<size_t>& oldFromNew,
+                            const bool useVolReg,
+                            const size_t maxLeafSize,
+                            const size_t minLeafSize)
+{
+  // Sort the points of the node in every dimension once.  Column d of
+  // sortedIndices holds the indices of the points in ascending order of
+  // dimension d; the points of every node of the tree will be found in rows
+  // [start, end) of every column.
+  arma::Mat<size_t> sortedIndices(data.n_cols, data.n_rows);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t dim = 0; dim < data.n_rows; ++dim)
+  {
+    const arma::uvec order = arma::stable_sort_index(
+        data.row(dim).subvec(start, end - 1));
+    for (size_t i = 0; i < order.n_elem; ++i)
+      sortedIndices(start + i, dim) = start + order[i];
+  }
+
+  // Which side of the split every point goes to; set by the splitting node.
+  std::vector<char> isLeft(data.n_cols);
+
+  double alpha = 0.0;
+
+  #pragma omp parallel
+  {
+    // One thread starts at the root; the subtrees spawn tasks for the others.
+    #pragma omp single
+    alpha = GrowSorted(data, sortedIndices, isLeft, oldFromNew.n_elem,
+        useVolReg, maxLeafSize, minLeafSize);
+  }
+
+  // Now all the points of every node lie contiguously in any column of
+  // sortedIndices, so reorder the data once in the order of the first one.
+  const arma::Col<size_t> order = sortedIndices.unsafe_col(0).subvec(start,
+      end - 1);
+  const arma::mat oldData = data.cols(start, end - 1);
+  const arma::Col<size_t> oldMapping = oldFromNew.subvec(start, end - 1);
+  for (size_t i = 0; i < order.n_elem; ++i)
+  {
+    data.col(start + i) = oldData.col(order[i] - start);
+    oldFromNew[start + i] = oldMapping[order[i] - start];
+  }
+
+  return alpha;
+}
+
+// Recursively grow the tree with the presorted points.
+double DTree::GrowSorted(const arma::mat& data,
+                         arma::Mat<size_t>& sortedIndices,
+                         std::vector<char>& isLeft,
+                         const size_t totalPoints,
+                         const bool useVolReg,
+                         const size_t maxLeafSize,
+                         const size_t minLeafSize)
+{
+  double leftG = std::numeric_limits<double>::max();
+  double rightG = std::numeric_limits<double>::max();
+
+  // Compute points ratio and the volume of the node.
+  InitializeGrowth(totalPoints);
+
+  // Check if node is large enough to split.
+  if ((size_t) (end - start) > maxLeafSize)
+  {
+    // Find the split.  The values don't have to be sorted.
+    size_t dim;
+    double splitValueTmp;
+    double leftError, rightError;
+    if (FindSplit(data, dim, splitValueTmp, leftError, rightError, minLeafSize,
+        &sortedIndices))
     {
-      // No split found so make a leaf out of it.
-      subtreeLeaves = 1;
-      subtreeLeavesLogNegError = logNegError;
+      // Partition the sorted indices of every dimension.
+      const size_t splitIndex = SplitSortedIndices(data, sortedIndices, isLeft,
+          dim, splitValueTmp);
+
+      CreateChildren(dim, splitValueTmp, splitIndex, leftError, rightError);
+
+      // The children only touch their own rows of sortedIndices and their own
+      // points in isLeft, so they can be grown at the same time.  Small
+      // subtrees aren't worth a task.
+      if (end - start >= 4096)
+      {
+        #pragma omp task shared(leftG, data, sortedIndices, isLeft)
+        leftG = left->GrowSorted(data, sortedIndices, isLeft, totalPoints,
+            useVolReg, maxLeafSize, minLeafSize);
+
+        rightG = right->GrowSorted(data, sortedIndices, isLeft, totalPoints,
+            useVolReg, maxLeafSize, minLeafSize);
+
+        #pragma omp taskwait
+      }
+      else
+      {
+        leftG = left->GrowSorted(data, sortedIndices, isLeft, totalPoints,
+            useVolReg, maxLeafSize, minLeafSize);
+        rightG = right->GrowSorted(data, sortedIndices, isLeft, totalPoints,
+            useVolReg, maxLeafSize, minLeafSize);
+      }
     }
   }
   else
   {
     // We can make this a leaf node.
     assert((size_t) (end - start) >= minLeafSize);
+  }
+
+  return FinishGrowth(data.n_cols, useVolReg, leftG, rightG);
+}
+
+// Compute the ratio of the points in the node and the volume of the node.
+void DTree::InitializeGrowth(const size_t totalPoints)
+{
+  // Compute points ratio.
+  ratio = (double) (end - start) / (double) totalPoints;
+
+  // Compute the log of the volume of the node.
+  logVolume = 0;
+  for (size_t i = 0; i < maxVals.n_elem; ++i)
+    if (maxVals[i] - minVals[i] > 0.0)
+      logVolume += std::log(maxVals[i] - minVals[i]);
+}
+
+// Create the children of the node for the given split.
+void DTree::CreateChildren(const size_t dim,
+                           const double splitValueTmp,
+                           const size_t splitIndex,
+                           const double leftError,
+                           const double rightError)
+{
+  // Make max and min vals for the children.
+  arma::vec maxValsL(maxVals);
+  arma::vec maxValsR(maxVals);
+  arma::vec minValsL(minVals);
+  arma::vec minValsR(minVals);
+
+  maxValsL[dim] = splitValueTmp;
+  minValsR[dim] = splitValueTmp;
+
+  // Store split dim and split val in the node.
+  splitValue = splitValueTmp;
+  splitDim = dim;
+
+  left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
+  right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
+}
+
+// Compute the subtree statistics and g_k(t) of a grown node.
+double DTree::FinishGrowth(const size_t totalPoints,
+                           const bool useVolReg,
+                           const double leftG,
+                           const double rightG)
+{
+  if (left != NULL)
+  {
+    // Store values of R(T~) and |T~|.
+    subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
+
+    // Find the log negative error of the subtree leaves.  This is kind of an
+    // odd one because we don't want to represent the error in non-log-space,
+    // but we have to calculate log(E_l + E_r).  So we multiply E_l and E_r by
+    // V_t (remember E_l has an inverse relationship to the volume of the
+    // nodes) and then subtract log(V_t) at the end of the whole expression.
+    // As a result we do leave log-space, but the largest quantity we
+    // represent is on the order of (V_t / V_i) where V_i is the smallest leaf
+    // node below this node, which depends heavily on the depth of the tree.
+    subtreeLeavesLogNegError = std::log(
+        std::exp(logVolume + left->SubtreeLeavesLogNegError()) +
+        std::exp(logVolume + right->SubtreeLeavesLogNegError()))
+        - logVolume;
+  }
+  else
+  {
+    // No split was found or the node is small enough, so this is a leaf.
     subtreeLeaves = 1;
     subtreeLeavesLogNegError = logNegError;
   }
@@ -374,7 +573,7 @@ double DTree::Grow(arma::mat& data,
 
     if (left->SubtreeLeaves() > 1)
     {
-      const double exponent = 2 * std::log((double) data.n_cols) + logVolume +
+      const double exponent = 2 * std::log((double) totalPoints) + logVolume +
           left->AlphaUpper();
 
       // Whether or not this will overflow is highly dependent on the depth of
@@ -384,13 +583,13 @@ double DTree::Grow(arma::mat& data,
 
     if (right->SubtreeLeaves() > 1)
     {
-      const double exponent = 2 * std::log((double) data.n_cols) + logVolume +
+      const double exponent = 2 * std::log((double) totalPoints) + logVolume +
           right->AlphaUpper();
 
       tmpAlphaSum += std::exp(exponent);
     }
 
-    alphaUpper = std::log(tmpAlphaSum) - 2 * std::log((double) data.n_cols)
+    alphaUpper = std::log(tmpAlphaSum) - 2 * std::log((double) totalPoints)
         - logVolume;
 
     double gT;
@@ -570,6 +769,14 @@ double DTree::ComputeValue(const arma::vec& query) const
 }
 
 
+void DTree::ComputeValues(const arma::mat& queries, arma::vec& values) const
+{
+  Log::Assert(queries.n_rows == maxVals.n_elem);
+
+  FlatDTree(*this).ComputeValues(queries, values);
+}
+
+
 void DTree::WriteTree(FILE *fp, const size_t level) const
 {
   if (subtreeLeaves > 1)
@@ -108,17 +108,26 @@ class DTree
    * Greedily expand the tree.  The points in the dataset will be reordered
    * during tree growth.
    *
+   * If presort is true, the points are sorted in every dimension once, and the
+   * sorted lists are partitioned at every split instead of sorting the points
+   * of every node again; the subtrees are then grown in parallel (if OpenMP is
+   * available).  The resulting tree is the same, but the points may be in a
+   * different order within the leaves.  This needs memory for one index per
+   * point and dimension.
+   *
    * @param data Dataset to build tree on.
    * @param oldFromNew Mappings from old points to new points.
    * @param useVolReg If true, volume regularization is used.
    * @param maxLeafSize Maximum size of a leaf.
    * @param minLeafSize Minimum size of a leaf.
+   * @param presort If true, the points are presorted.
    */
   double Grow(arma::mat& data,
               arma::Col<size_t>& oldFromNew,
               const bool useVolReg = false,
               const size_t maxLeafSize = 10,
-              const size_t minLeafSize = 5);
+              const size_t minLeafSize = 5,
+              const bool presort = false);
 
   /**
    * Perform alpha pruning on a tree.  Returns the new value of alpha.
@@ -139,6 +148,17 @@ class DTree
    */
   double ComputeValue(const arma::vec& query) const;
 
+  /**
+   * Compute the density estimates of every point (column) of the given matrix.
+   * The tree is flattened into a FlatDTree first, and the points are evaluated
+   * in parallel (if OpenMP is available); to evaluate the same tree many times,
+   * keep a FlatDTree instead.
+   *
+   * @param queries Points to estimate the densities of.
+   * @param values Vector to store the density estimates in.
+   */
+  void ComputeValues(const arma::mat& queries, arma::vec& values) const;
+
   /**
    * Print the tree in a depth-first manner (this function is called
    * recursively).
@@ -288,14 +308,17 @@ class DTree
   // Utility methods.
 
   /**
-   * Find the dimension to split on.
+   * Find the dimension to split on.  If sortedIndices is given, it holds the
+   * indices of the points sorted in every dimension (see GrowPresorted()), and
+   * the points aren't sorted again.
    */
   bool FindSplit(const arma::mat& data,
                  size_t& splitDim,
                  double& splitValue,
                  double& leftError,
                  double& rightError,
-                 const size_t minLeafSize = 5) const;
+                 const size_t minLeafSize = 5,
+                 const arma::Mat<size_t>* sortedIndices = NULL) const;
 
   /**
    * Split the data, returning the number of points left of the split.
@@ -305,6 +328,59 @@ class DTree
                    const double splitValue,
                    arma::Col<size_t>& oldFromNew) const;
 
+  /**
+   * Partition the presorted indices of every dimension at the split, stably,
+   * and mark the points that go to the left child in isLeft.  Returns the
+   * index of the first point of the right child.
+   */
+  size_t SplitSortedIndices(const arma::mat& data,
+                            arma::Mat<size_t>& sortedIndices,
+                            std::vector<char>& isLeft,
+                            const size_t splitDim,
+                            const double splitValue) const;
+
+  /**
+   * Presort the points, grow the tree with GrowSorted(), and then reorder the
+   * data and the mappings once.
+   */
+  double GrowPresorted(arma::mat& data,
+                       arma::Col<size_t>& oldFromNew,
+                       const bool useVolReg,
+                       const size_t maxLeafSize,
+                       const size_t minLeafSize);
+
+  /**
+   * Recursively grow the tree with the presorted points, without moving the
+   * data.  Large subtrees are grown as OpenMP tasks.
+   */
+  double GrowSorted(const arma::mat& data,
+                    arma::Mat<size_t>& sortedIndices,
+                    std::vector<char>& isLeft,
+                    const size_t totalPoints,
+                    const bool useVolReg,
+                    const size_t maxLeafSize,
+                    const size_t minLeafSize);
+
+  //! Compute the points ratio and the volume of the node before growing it.
+  void InitializeGrowth(const size_t totalPoints);
+
+  //! Create the children of the node for the given split.
+  void CreateChildren(const size_t dim,
+                      const double splitValue,
+                      const size_t splitIndex,
+                      const double leftError,
+                      const double rightError);
+
+  /**
+   * Compute the subtree statistics and the alpha value of a node whose
+   * children (if any) have been grown, and return min(g_k(t_L), g_k(t_R),
+   * g_k(t)).
+   */
+  double FinishGrowth(const size_t totalPoints,
+                      const bool useVolReg,
+                      const double leftG,
+                      const double rightG);
+
 };
 
 }; // namespace det
@@ -0,0 +1,88 @@
+/**
+ * @file flat_dtree.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the flattened density estimation tree.
+ */
+#include "flat_dtree.hpp"
+#include "dtree.hpp"
+
+#include <queue>
+
+using namespace mlpack;
+using namespace det;
+
+FlatDTree::FlatDTree(const DTree& tree) :
+    minVals(tree.MinVals()),
+    maxVals(tree.MaxVals())
+{
+  // Number the nodes in breadth-first order; the children of a node are pushed
+  // together, so they get adjacent indices.  A pruned node is a leaf, even if
+  // its children have not been deleted.
+  std::vector<const DTree*> nodes;
+  std::queue<const DTree*> queue;
+  queue.push(&tree);
+  while (!queue.empty())
+  {
+    const DTree* node = queue.front();
+    queue.pop();
+    nodes.push_back(node);
+
+    if (node->SubtreeLeaves() > 1)
+    {
+      queue.push(node->Left());
+      queue.push(node->Right());
+    }
+  }
+
+  splitDims.zeros(nodes.size());
+  splitValues.set_size(nodes.size());
+  children.zeros(nodes.size());
+
+  // The first child of the next internal node follows the children of the
+  // internal nodes before it.
+  size_t nextChild = 1;
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    const DTree& node = *nodes[i];
+    if (node.SubtreeLeaves() > 1)
+    {
+      splitDims[i] = node.SplitDim();
+      splitValues[i] = node.SplitValue();
+      children[i] = nextChild;
+      nextChild += 2;
+    }
+    else
+    {
+      // This is the same value as DTree::ComputeValue() gives.
+      splitValues[i] = std::exp(std::log(node.Ratio()) - node.LogVolume());
+    }
+  }
+}
+
+double FlatDTree::ComputeValue(const double* query) const
+{
+  // Check if the query is within range.
+  for (size_t d = 0; d < minVals.n_elem; ++d)
+    if ((query[d] < minVals[d]) || (query[d] > maxVals[d]))
+      return 0.0;
+
+  // Descend to the leaf; points on the split value go left, like in
+  // DTree::ComputeValue().
+  size_t node = 0;
+  while (children[node] != 0)
+    node = children[node] + (query[splitDims[node]] > splitValues[node]);
+
+  return splitValues[node];
+}
+
+void FlatDTree::ComputeValues(const arma::mat& queries, arma::vec& values) const
+{
+  Log::Assert(queries.n_rows == minVals.n_elem);
+
+  values.set_size(queries.n_cols);
+
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < queries.n_cols; ++i)
+    values[i] = ComputeValue(queries.colptr(i));
+}
@@ -0,0 +1,99 @@
+/**
+ * @file flat_dtree.hpp
+ * @author Ryan Curtin
+ *
+ * A flattened, array-based copy of a trained density estimation tree, for fast
+ * evaluation of many query points.
+ */
+#ifndef __MLPACK_METHODS_DET_FLAT_DTREE_HPP
+#define __MLPACK_METHODS_DET_FLAT_DTREE_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace det {
+
+// Forward declaration.
+class DTree;
+
+/**
+ * A read-only copy of a trained DTree, stored in flat arrays instead of linked
+ * nodes.  The nodes are numbered in breadth-first order, and the two children
+ * of a node are always adjacent, so every node only needs its split dimension,
+ * its split value, and the index of its left child; the child to descend into
+ * is found with arithmetic instead of a branch.  For a leaf, the child index is
+ * 0 (the root is never a child) and the split value holds the density of the
+ * leaf.
+ *
+ * Only the bounding box of the root is kept, because the leaves of a DTree
+ * partition it: a query is checked against it once instead of at every node.
+ * The density estimates are exactly those of DTree::ComputeValue().
+ *
+ * @code
+ * DTree* tree = Trainer(...);
+ * FlatDTree flatTree(*tree);
+ *
+ * arma::vec densities;
+ * flatTree.ComputeValues(queries, densities);
+ * @endcode
+ *
+ * The FlatDTree does not refer to the DTree it was built from, which may be
+ * destroyed or modified afterwards.
+ */
+class FlatDTree
+{
+ public:
+  /**
+   * Flatten the given trained (and possibly pruned) density estimation tree.
+   *
+   * @param tree Root of the tree to flatten.
+   */
+  FlatDTree(const DTree& tree);
+
+  /**
+   * Compute the density estimate of the given query point; this is the same
+   * as DTree::ComputeValue().
+   *
+   * @param query Point to estimate density of.
+   */
+  double ComputeValue(const arma::vec& query) const
+  {
+    return ComputeValue(query.memptr());
+  }
+
+  /**
+   * Compute the density estimates of every point (column) of the given matrix,
+   * in parallel if OpenMP is available.
+   *
+   * @param queries Points to estimate the densities of.
+   * @param values Vector to store the density estimates in.
+   */
+  void ComputeValues(const arma::mat& queries, arma::vec& values) const;
+
+  //! Return the number of nodes of the tree.
+  size_t NumNodes() const { return splitDims.n_elem; }
+  //! Return the dimensionality of the tree.
+  size_t Dimensionality() const { return minVals.n_elem; }
+
+ private:
+  //! Compute the density estimate of the point with the given coordinates.
+  double ComputeValue(const double* query) const;
+
+  //! The split dimension of each node (0 for leaves).
+  arma::Col<size_t> splitDims;
+  //! The split value of each node, or the density of each leaf.
+  arma::vec splitValues;
+  //! The index of the left child of each node (0 for leaves); the right child
+  //! follows it.
+  arma::Col<size_t> children;
+
+  //! Lower bound of the bounding box of the root.
+  arma::vec minVals;
+  //! Upper bound of the bounding box of the root.
+  arma::vec maxVals;
+};
+
+}; // namespace det
+}; // namespace mlpack
+
+#endif
@@ -63,6 +63,14 @@ namespace emst /** Euclidean Minimum Spanning Trees. */ {
  * More advanced usage of the class can use different types of trees, pass in an
  * already-built tree, or compute the MST using the O(n^2) naive algorithm.
  *
+ * If Parallel() is set, each Boruvka step is run on all available threads: the
+ * tree is split into disjoint query subtrees which are traversed against the
+ * whole tree at the same time, with the candidate edges stored for every point
+ * instead of every component, and the edges are then merged into the
+ * components with a lock-free union-find structure.  The total length of the
+ * resulting spanning tree is the same; if several edges have the same length,
+ * a different (but equally short) tree may be found.
+ *
  * @tparam MetricType The metric to use.  IMPORTANT: this hasn't really been
  * tested with anything other than the L2 metric, so user beware. Note that the
  * tree type needs to compute bounds using the same metric as the type
@@ -92,8 +100,11 @@ class DualTreeBoruvka
   //! Edges.
   std::vector<EdgePair> edges; // We must use vector with non-numerical types.
 
+  //! Indicates whether or not the Boruvka steps are run in parallel.
+  bool parallel;
+
   //! Connections.
-  UnionFind connections;
+  LockFreeUnionFind connections;
 
   //! Permutations of points during tree building.
   std::vector<size_t> oldFromNew;
@@ -169,6 +180,11 @@ class DualTreeBoruvka
    */
   void ComputeMST(arma::mat& results);
 
+  //! Get whether or not the Boruvka steps are run in parallel.
+  bool Parallel() const { return parallel; }
+  //! Modify whether or not the Boruvka steps are run in parallel.
+  bool& Parallel() { return parallel; }
+
   /**
    * Returns a string representation of this object.
    */
@@ -185,6 +201,20 @@ class DualTreeBoruvka
    */
   void AddAllEdges();
 
+  /**
+   * Reduces the candidate edges of the points found in one parallel iteration
+   * to one candidate edge per component, and adds these edges to the list of
+   * neighbors in parallel.
+   */
+  void AddAllPointEdges();
+
+  /**
+   * Splits the tree into disjoint subtrees which can be traversed as query
+   * trees in parallel.  If the points of the tree aren't only held by leaves,
+   * the tree is not split.
+   */
+  void SplitQueryTree(std::vector<TreeType*>& subtrees);
+
   /**
    * Unpermute the edge list and output it to results.
    */
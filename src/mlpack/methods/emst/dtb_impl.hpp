@@ -9,6 +9,8 @@
 
 #include "dtb_rules.hpp"
 
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
 namespace mlpack {
 namespace emst {
 
@@ -48,6 +50,7 @@ DualTreeBoruvka<MetricType, TreeType>::DualTreeBoruvka(
     data((tree::TreeTraits<TreeType>::RearrangesDataset && !naive) ? dataCopy : dataset),
     ownTree(!naive),
     naive(naive),
+    parallel(false),
     connections(dataset.n_cols),
     totalDist(0.0),
     metric(metric)
@@ -83,6 +86,7 @@ DualTreeBoruvka<MetricType, TreeType>::DualTreeBoruvka(
     tree(tree),
     ownTree(false),
     naive(false),
+    parallel(false),
     connections(data.n_cols),
     totalDist(0.0),
     metric(metric)
@@ -113,25 +117,71 @@ void DualTreeBoruvka<MetricType, TreeType>::ComputeMST(arma::mat& results)
 
   totalDist = 0; // Reset distance.
 
+  // In parallel mode, the candidate edges are stored for every point, so that
+  // the rules of different query points don't share any results.
   typedef DTBRules<MetricType, TreeType> RuleType;
   RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
+                 neighborsOutComponent, metric, parallel);
+
+  std::vector<TreeType*> subtrees;
+  if (parallel && !naive)
+    SplitQueryTree(subtrees);
+
   while (edges.size() < (data.n_cols - 1))
   {
     if (naive)
     {
       // Full O(N^2) traversal.
-      for (size_t i = 0; i < data.n_cols; ++i)
-        for (size_t j = 0; j < data.n_cols; ++j)
-          rules.BaseCase(i, j);
+      #pragma omp parallel if(parallel)
+      {
+        RuleType threadRules(rules);
+
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t i = 0; i < data.n_cols; ++i)
+          for (size_t j = 0; j < data.n_cols; ++j)
+            threadRules.BaseCase(i, j);
+      }
+    }
+    else if (parallel)
+    {
+      // Traverse every query subtree against the whole tree, in parallel.
+      size_t baseCases = 0;
+      size_t scores = 0;
+
+      #pragma omp parallel reduction(+:baseCases, scores)
+      {
+        RuleType threadRules(rules);
+        threadRules.BaseCases() = 0;
+        threadRules.Scores() = 0;
+        typename TreeType::template DualTreeTraverser<RuleType>
+            traverser(threadRules);
+
+        #pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < subtrees.size(); ++i)
+        {
+          threadRules.TraversalInfo() = typename RuleType::TraversalInfoType();
+          traverser.Traverse(*subtrees[i], *tree);
+        }
+        tree::RecordTraversal("dtb", traverser, threadRules);
+
+        baseCases += threadRules.BaseCases();
+        scores += threadRules.Scores();
+      }
+
+      rules.BaseCases() += baseCases;
+      rules.Scores() += scores;
     }
     else
     {
       typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
       traverser.Traverse(*tree, *tree);
+      tree::RecordTraversal("dtb", traverser, rules);
     }
 
-    AddAllEdges();
+    if (parallel)
+      AddAllPointEdges();
+    else
+      AddAllEdges();
 
     Cleanup();
 
@@ -190,6 +240,103 @@ void DualTreeBoruvka<MetricType, TreeType>::AddAllEdges()
   }
 } // AddAllEdges
 
+/**
+ * Reduces the candidate edges of all points to one candidate edge per
+ * component, then adds the edges of all components in parallel.
+ */
+template<typename MetricType, typename TreeType>
+void DualTreeBoruvka<MetricType, TreeType>::AddAllPointEdges()
+{
+  // The candidate edge of a component is stored at the index of the component,
+  // which is the smallest point of the component.  That entry initially holds
+  // the candidate edge of the point itself, and only the entries of components
+  // are modified, so the reduction can be done in place.
+  std::vector<size_t> components;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    const size_t component = connections.Find(i);
+    if (component == i)
+    {
+      components.push_back(i);
+    }
+    else if (neighborsDistances[i] < neighborsDistances[component])
+    {
+      neighborsDistances[component] = neighborsDistances[i];
+      neighborsInComponent[component] = neighborsInComponent[i];
+      neighborsOutComponent[component] = neighborsOutComponent[i];
+    }
+  }
+
+  // Unite the components along their candidate edges.  Union() only succeeds
+  // for one of the edges that would close a cycle, so no edge is added twice.
+  std::vector<char> added(components.size(), 0);
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (size_t i = 0; i < components.size(); ++i)
+  {
+    const size_t component = components[i];
+    if (neighborsDistances[component] == DBL_MAX)
+      continue; // There is no other component.
+
+    added[i] = connections.Union(neighborsInComponent[component],
+        neighborsOutComponent[component]);
+  }
+
+  // Add the edges in the order of the components.
+  for (size_t i = 0; i < components.size(); ++i)
+  {
+    if (!added[i])
+      continue;
+
+    const size_t component = components[i];
+    totalDist += neighborsDistances[component];
+    AddEdge(neighborsInComponent[component], neighborsOutComponent[component],
+        neighborsDistances[component]);
+  }
+} // AddAllPointEdges
+
+/**
+ * Split the tree into disjoint subtrees of roughly equal size, which are
+ * traversed as query trees in parallel.
+ */
+template<typename MetricType, typename TreeType>
+void DualTreeBoruvka<MetricType, TreeType>::SplitQueryTree(
+    std::vector<TreeType*>& subtrees)
+{
+  subtrees.assign(1, tree);
+
+  // If nodes other than the leaves hold points, the subtrees would not cover
+  // all the points.
+  if (tree::TreeTraits<TreeType>::HasSelfChildren ||
+      tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+    return;
+
+  // Create a few subtrees for every thread, so that the work is balanced.
+  const size_t minSize = std::max((size_t) 1, tree->NumDescendants() / 256);
+
+  bool split = true;
+  while (split)
+  {
+    split = false;
+    std::vector<TreeType*> children;
+    for (size_t i = 0; i < subtrees.size(); ++i)
+    {
+      if (subtrees[i]->IsLeaf() || subtrees[i]->NumPoints() > 0 ||
+          subtrees[i]->NumDescendants() <= minSize)
+      {
+        children.push_back(subtrees[i]);
+        continue;
+      }
+
+      for (size_t j = 0; j < subtrees[i]->NumChildren(); ++j)
+        children.push_back(&subtrees[i]->Child(j));
+      split = true;
+    }
+
+    subtrees.swap(children);
+  }
+} // SplitQueryTree
+
 /**
  * Unpermute the edge list (if necessary) and output it to results.
  */
@@ -281,8 +428,7 @@ void DualTreeBoruvka<MetricType, TreeType>::CleanupHelper(TreeType* tree)
 template<typename MetricType, typename TreeType>
 void DualTreeBoruvka<MetricType, TreeType>::Cleanup()
 {
-  for (size_t i = 0; i < data.n_cols; i++)
-    neighborsDistances[i] = DBL_MAX;
+  neighborsDistances.fill(DBL_MAX);
 
   if (!naive)
     CleanupHelper(tree);
@@ -297,6 +443,7 @@ std::string DualTreeBoruvka<MetricType, TreeType>::ToString() const
   convert << "  Data: " << data.n_rows << "x" << data.n_cols <<std::endl;
   convert << "  Total Distance: " << totalDist <<std::endl;
   convert << "  Naive: " << naive << std::endl;
+  convert << "  Parallel: " << parallel << std::endl;
   convert << "  Metric: " << std::endl;
   convert << util::Indent(metric.ToString(), 2);
   convert << std::endl;
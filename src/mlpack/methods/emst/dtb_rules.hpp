@@ -18,12 +18,29 @@ template<typename MetricType, typename TreeType>
 class DTBRules
 {
  public:
+  /**
+   * Construct the rules.  Normally the candidate edges are stored per
+   * component, indexed by the component index.  If pointBounds is true, they
+   * are stored per query point instead, indexed by the query index; then the
+   * rules only modify the results of the query points and the statistics of the
+   * query nodes they are given, so that disjoint query subtrees can be
+   * traversed in parallel.
+   *
+   * @param dataSet The dataset.
+   * @param connections The components found so far.
+   * @param neighborsDistances Distances of the candidate edges.
+   * @param neighborsInComponent Inner points of the candidate edges.
+   * @param neighborsOutComponent Outer points of the candidate edges.
+   * @param metric The instantiated metric.
+   * @param pointBounds Whether the candidate edges are stored per query point.
+   */
   DTBRules(const arma::mat& dataSet,
-           UnionFind& connections,
+           LockFreeUnionFind& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
            arma::Col<size_t>& neighborsOutComponent,
-           MetricType& metric);
+           MetricType& metric,
+           const bool pointBounds = false);
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
@@ -125,7 +142,7 @@ class DTBRules
   const arma::mat& dataSet;
 
   //! Stores the tree structure so far
-  UnionFind& connections;
+  LockFreeUnionFind& connections;
 
   //! The distance to the candidate nearest neighbor for each component.
   arma::vec& neighborsDistances;
@@ -141,6 +158,15 @@ class DTBRules
   //! The instantiated metric.
   MetricType& metric;
 
+  //! Whether the candidate edges are stored per query point.
+  bool pointBounds;
+
+  //! Get the index of the candidate edge of the given query point.
+  size_t BoundIndex(const size_t queryIndex) const
+  {
+    return pointBounds ? queryIndex : connections.Find(queryIndex);
+  }
+
   /**
    * Update the bound for the given query node.
    */
@@ -13,11 +13,12 @@ namespace emst {
 template<typename MetricType, typename TreeType>
 DTBRules<MetricType, TreeType>::
 DTBRules(const arma::mat& dataSet,
-         UnionFind& connections,
+         LockFreeUnionFind& connections,
          arma::vec& neighborsDistances,
          arma::Col<size_t>& neighborsInComponent,
          arma::Col<size_t>& neighborsOutComponent,
-         MetricType& metric)
+         MetricType& metric,
+         const bool pointBounds)
 :
   dataSet(dataSet),
   connections(connections),
@@ -25,6 +26,7 @@ DTBRules(const arma::mat& dataSet,
   neighborsInComponent(neighborsInComponent),
   neighborsOutComponent(neighborsOutComponent),
   metric(metric),
+  pointBounds(pointBounds),
   baseCases(0),
   scores(0)
 {
@@ -46,24 +48,27 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
 
   size_t referenceComponentIndex = connections.Find(referenceIndex);
 
+  // The index of the candidate edge to update.
+  const size_t boundIndex = pointBounds ? queryIndex : queryComponentIndex;
+
   if (queryComponentIndex != referenceComponentIndex)
   {
     ++baseCases;
     double distance = metric.Evaluate(dataSet.col(queryIndex),
                                       dataSet.col(referenceIndex));
 
-    if (distance < neighborsDistances[queryComponentIndex])
+    if (distance < neighborsDistances[boundIndex])
     {
       Log::Assert(queryIndex != referenceIndex);
 
-      neighborsDistances[queryComponentIndex] = distance;
-      neighborsInComponent[queryComponentIndex] = queryIndex;
-      neighborsOutComponent[queryComponentIndex] = referenceIndex;
+      neighborsDistances[boundIndex] = distance;
+      neighborsInComponent[boundIndex] = queryIndex;
+      neighborsOutComponent[boundIndex] = referenceIndex;
     }
   }
 
-  if (newUpperBound < neighborsDistances[queryComponentIndex])
-    newUpperBound = neighborsDistances[queryComponentIndex];
+  if (newUpperBound < neighborsDistances[boundIndex])
+    newUpperBound = neighborsDistances[boundIndex];
 
   Log::Assert(newUpperBound >= 0.0);
 
@@ -88,8 +93,8 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
-  return neighborsDistances[queryComponentIndex] < distance
-      ? DBL_MAX : distance;
+  const size_t boundIndex = pointBounds ? queryIndex : queryComponentIndex;
+  return neighborsDistances[boundIndex] < distance ? DBL_MAX : distance;
 }
 
 template<typename MetricType, typename TreeType>
@@ -113,8 +118,8 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
-  return (neighborsDistances[queryComponentIndex] < distance) ? DBL_MAX :
-      distance;
+  const size_t boundIndex = pointBounds ? queryIndex : queryComponentIndex;
+  return (neighborsDistances[boundIndex] < distance) ? DBL_MAX : distance;
 }
 
 template<typename MetricType, typename TreeType>
@@ -124,7 +129,7 @@ double DTBRules<MetricType, TreeType>::Rescore(const size_t queryIndex,
 {
   // We don't need to check component membership again, because it can't
   // change inside a single iteration.
-  return (oldScore > neighborsDistances[connections.Find(queryIndex)])
+  return (oldScore > neighborsDistances[BoundIndex(queryIndex)])
       ? DBL_MAX : oldScore;
 }
 
@@ -193,8 +198,7 @@ inline double DTBRules<MetricType, TreeType>::CalculateBound(
   // Now, find the best and worst point bounds.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const size_t pointComponent = connections.Find(queryNode.Point(i));
-    const double bound = neighborsDistances[pointComponent];
+    const double bound = neighborsDistances[BoundIndex(queryNode.Point(i))];
 
     if (bound > worstPointBound)
       worstPointBound = bound;
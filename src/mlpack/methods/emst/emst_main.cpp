@@ -21,9 +21,14 @@
  */
 
 #include "dtb.hpp"
+#include "single_linkage.hpp"
 
 #include <mlpack/core.hpp>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 PROGRAM_INFO("Fast Euclidean Minimum Spanning Tree", "This program can compute "
     "the Euclidean minimum spanning tree of a set of input points using the "
     "dual-tree Boruvka algorithm."
@@ -31,7 +36,17 @@ PROGRAM_INFO("Fast Euclidean Minimum Spanning Tree", "This program can compute "
     "The output is saved in a three-column matrix, where each row indicates an "
     "edge.  The first column corresponds to the lesser index of the edge; the "
     "second column corresponds to the greater index of the edge; and the third "
-    "column corresponds to the distance between the two points.");
+    "column corresponds to the distance between the two points."
+    "\n\n"
+    "The minimum spanning tree also gives the single-linkage hierarchical "
+    "clustering of the points in O(n log n) time.  If --dendrogram_file is "
+    "given, the dendrogram is saved to it as a four-column matrix with one row "
+    "per merge: the points are clusters 0 to n - 1 and the i'th merge creates "
+    "cluster n + i; each row holds the two clusters merged, the distance "
+    "between them, and the size of the new cluster (this is the layout of the "
+    "linkage matrix of SciPy and MATLAB).  If --assignments_file is given, the "
+    "hierarchy is cut into --clusters clusters, or, if --cut_distance is given "
+    "instead, at that distance, and the cluster of each point is saved to it.");
 
 PARAM_STRING_REQ("input_file", "Data input file.", "i");
 PARAM_STRING("output_file", "Data output file.  Stored as an edge list.", "o",
@@ -40,6 +55,20 @@ PARAM_FLAG("naive", "Compute the MST using O(n^2) naive algorithm.", "n");
 PARAM_INT("leaf_size", "Leaf size in the kd-tree.  One-element leaves give the "
     "empirically best performance, but at the cost of greater memory "
     "requirements.", "l", 1);
+PARAM_FLAG("parallel", "Run the Boruvka steps in parallel on all available "
+    "cores (ignored without OpenMP).", "P");
+PARAM_INT("threads", "Number of threads to use with --parallel (0 uses all "
+    "available cores; ignored without OpenMP).", "t", 0);
+
+PARAM_STRING("dendrogram_file", "If specified, the single-linkage dendrogram "
+    "will be saved to this file.", "D", "");
+PARAM_STRING("assignments_file", "If specified, the single-linkage cluster of "
+    "each point will be saved to this file (see --clusters and "
+    "--cut_distance).", "a", "");
+PARAM_INT("clusters", "Number of single-linkage clusters to save with "
+    "--assignments_file.", "k", 0);
+PARAM_DOUBLE("cut_distance", "Distance to cut the single-linkage hierarchy at "
+    "for --assignments_file (instead of --clusters).", "c", -1.0);
 
 using namespace mlpack;
 using namespace mlpack::emst;
@@ -55,19 +84,62 @@ int main(int argc, char* argv[])
   arma::mat dataPoints;
   data::Load(dataFilename, dataPoints, true);
 
+  // Check the single-linkage options before doing any work.
+  const bool cutByDistance = CLI::HasParam("cut_distance");
+  if (CLI::HasParam("assignments_file"))
+  {
+    if (cutByDistance && CLI::HasParam("clusters"))
+    {
+      Log::Fatal << "Only one of --clusters and --cut_distance may be "
+          << "specified." << endl;
+    }
+    else if (cutByDistance && CLI::GetParam<double>("cut_distance") < 0.0)
+    {
+      Log::Fatal << "Invalid cut distance: "
+          << CLI::GetParam<double>("cut_distance") << ".  Must be greater than "
+          << "or equal to 0." << endl;
+    }
+    else if (!cutByDistance && (CLI::GetParam<int>("clusters") < 1 ||
+        (size_t) CLI::GetParam<int>("clusters") > dataPoints.n_cols))
+    {
+      Log::Fatal << "Invalid number of clusters: "
+          << CLI::GetParam<int>("clusters") << ".  Must be between 1 and the "
+          << "number of points (" << dataPoints.n_cols << ")." << endl;
+    }
+  }
+  else if (CLI::HasParam("clusters") || cutByDistance)
+  {
+    Log::Warn << "--clusters and --cut_distance ignored because "
+        << "--assignments_file is not specified." << endl;
+  }
+
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#else
+  if (CLI::HasParam("parallel"))
+    Log::Warn << "--parallel ignored because mlpack was compiled without "
+        << "OpenMP support." << endl;
+#endif
+
+  const bool parallel = CLI::HasParam("parallel");
+  arma::mat results;
+
   // Do naive computation if necessary.
   if (CLI::GetParam<bool>("naive"))
   {
     Log::Info << "Running naive algorithm." << endl;
 
     DualTreeBoruvka<> naive(dataPoints, true);
+    naive.Parallel() = parallel;
 
-    arma::mat naiveResults;
-    naive.ComputeMST(naiveResults);
-
-    const string outputFilename = CLI::GetParam<string>("output_file");
-
-    data::Save(outputFilename, naiveResults, true);
+    naive.ComputeMST(results);
   }
   else
   {
@@ -92,36 +164,58 @@ int main(int argc, char* argv[])
     Timer::Stop("tree_building");
 
     DualTreeBoruvka<> dtb(&tree, dataPoints, metric);
+    dtb.Parallel() = parallel;
 
     // Run the DTB algorithm.
     Log::Info << "Calculating minimum spanning tree." << endl;
-    arma::mat results;
-    dtb.ComputeMST(results);
+    arma::mat mappedResults;
+    dtb.ComputeMST(mappedResults);
 
     // Unmap the results.
-    arma::mat unmappedResults(results.n_rows, results.n_cols);
-    for (size_t i = 0; i < results.n_cols; ++i)
+    results.set_size(mappedResults.n_rows, mappedResults.n_cols);
+    for (size_t i = 0; i < mappedResults.n_cols; ++i)
     {
-      const size_t indexA = oldFromNew[size_t(results(0, i))];
-      const size_t indexB = oldFromNew[size_t(results(1, i))];
+      const size_t indexA = oldFromNew[size_t(mappedResults(0, i))];
+      const size_t indexB = oldFromNew[size_t(mappedResults(1, i))];
 
       if (indexA < indexB)
       {
-        unmappedResults(0, i) = indexA;
-        unmappedResults(1, i) = indexB;
+        results(0, i) = indexA;
+        results(1, i) = indexB;
       }
       else
       {
-        unmappedResults(0, i) = indexB;
-        unmappedResults(1, i) = indexA;
+        results(0, i) = indexB;
+        results(1, i) = indexA;
       }
 
-      unmappedResults(2, i) = results(2, i);
+      results(2, i) = mappedResults(2, i);
     }
+  }
 
-    // Output the results.
-    const string outputFilename = CLI::GetParam<string>("output_file");
+  // Output the results.
+  const string outputFilename = CLI::GetParam<string>("output_file");
+  data::Save(outputFilename, results, true);
 
-    data::Save(outputFilename, unmappedResults, true);
+  // Derive the single-linkage clustering from the tree, if requested.
+  if (CLI::HasParam("dendrogram_file"))
+  {
+    arma::mat dendrogram;
+    SingleLinkageDendrogram(results, dendrogram);
+    data::Save(CLI::GetParam<string>("dendrogram_file"), dendrogram, true);
+  }
+
+  if (CLI::HasParam("assignments_file"))
+  {
+    arma::Col<size_t> assignments;
+    const size_t clusters = cutByDistance ?
+        SingleLinkageCut(results, CLI::GetParam<double>("cut_distance"),
+            assignments) :
+        SingleLinkageClusters(results, (size_t) CLI::GetParam<int>("clusters"),
+            assignments);
+    Log::Info << "Found " << clusters << " single-linkage clusters." << endl;
+
+    arma::Mat<size_t> output = trans(assignments);
+    data::Save(CLI::GetParam<string>("assignments_file"), output, true);
   }
 }
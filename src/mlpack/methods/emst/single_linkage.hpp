@@ -0,0 +1,160 @@
+/**
+ * @file single_linkage.hpp
+ * @author Ryan Curtin
+ *
+ * Single-linkage hierarchical clustering from a Euclidean minimum spanning
+ * tree, such as the one computed by DualTreeBoruvka.
+ *
+ * Merging the components of a minimum spanning tree in order of increasing edge
+ * length is exactly single-linkage clustering: the single-linkage distance
+ * between two clusters is the length of the shortest edge between them, and
+ * the minimum spanning tree contains that edge.  So once the edges are sorted,
+ * each merge costs only a union-find operation, and the whole hierarchy takes
+ * O(n log n) time.
+ *
+ * The minimum spanning tree is given as returned by
+ * DualTreeBoruvka::ComputeMST(): a 3 x (n - 1) matrix, where each column holds
+ * the two points of an edge and its length.  The edges don't need to be
+ * sorted.
+ */
+#ifndef __MLPACK_METHODS_EMST_SINGLE_LINKAGE_HPP
+#define __MLPACK_METHODS_EMST_SINGLE_LINKAGE_HPP
+
+#include <mlpack/core.hpp>
+#include "union_find.hpp"
+
+namespace mlpack {
+namespace emst {
+
+namespace single_linkage {
+
+//! Return the order of the edges of the minimum spanning tree by increasing
+//! length (edges of the same length keep their order).
+inline arma::uvec SortedEdges(const arma::mat& mst)
+{
+  Log::Assert(mst.n_rows == 3);
+  return arma::stable_sort_index(mst.row(2).t());
+}
+
+//! Merge the given number of shortest edges and label the resulting clusters
+//! in order of their first point; returns the number of clusters.
+inline size_t Label(const arma::mat& mst,
+                    const arma::uvec& order,
+                    const size_t merges,
+                    arma::Col<size_t>& assignments)
+{
+  const size_t numPoints = mst.n_cols + 1;
+  UnionFind components(numPoints);
+  for (size_t i = 0; i < merges; ++i)
+    components.Union((size_t) mst(0, order[i]), (size_t) mst(1, order[i]));
+
+  arma::Col<size_t> labels(numPoints);
+  labels.fill(SIZE_MAX);
+  assignments.set_size(numPoints);
+  size_t clusters = 0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const size_t root = components.Find(i);
+    if (labels[root] == SIZE_MAX)
+      labels[root] = clusters++;
+    assignments[i] = labels[root];
+  }
+
+  return clusters;
+}
+
+}; // namespace single_linkage
+
+/**
+ * Compute the single-linkage dendrogram of the points of the given minimum
+ * spanning tree.  The points are clusters 0 to n - 1, and the i'th merge
+ * creates cluster n + i; column i of the dendrogram holds the two clusters
+ * merged (the smaller first), the distance between them, and the number of
+ * points in the new cluster.  This is the layout of the linkage matrix of
+ * SciPy and MATLAB, transposed.
+ *
+ * @param mst Minimum spanning tree, as returned by DualTreeBoruvka.
+ * @param dendrogram Matrix to store the 4 x (n - 1) dendrogram in.
+ */
+inline void SingleLinkageDendrogram(const arma::mat& mst, arma::mat& dendrogram)
+{
+  const size_t numPoints = mst.n_cols + 1;
+  const arma::uvec order = single_linkage::SortedEdges(mst);
+
+  // The dendrogram cluster and the size of the component of every root.
+  UnionFind components(numPoints);
+  arma::Col<size_t> clusterOf(numPoints), sizes(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    clusterOf[i] = i;
+    sizes[i] = 1;
+  }
+
+  dendrogram.set_size(4, mst.n_cols);
+  for (size_t i = 0; i < mst.n_cols; ++i)
+  {
+    const size_t rootA = components.Find((size_t) mst(0, order[i]));
+    const size_t rootB = components.Find((size_t) mst(1, order[i]));
+    Log::Assert(rootA != rootB);
+
+    dendrogram(0, i) = std::min(clusterOf[rootA], clusterOf[rootB]);
+    dendrogram(1, i) = std::max(clusterOf[rootA], clusterOf[rootB]);
+    dendrogram(2, i) = mst(2, order[i]);
+    dendrogram(3, i) = sizes[rootA] + sizes[rootB];
+
+    components.Union(rootA, rootB);
+    const size_t root = components.Find(rootA);
+    clusterOf[root] = numPoints + i;
+    sizes[root] = (size_t) dendrogram(3, i);
+  }
+}
+
+/**
+ * Cut the single-linkage hierarchy of the points of the given minimum spanning
+ * tree into the given number of clusters.  The clusters are numbered in order
+ * of their first point.
+ *
+ * @param mst Minimum spanning tree, as returned by DualTreeBoruvka.
+ * @param numClusters Number of clusters (between 1 and the number of points).
+ * @param assignments Vector to store the cluster of each point in.
+ * @return The number of clusters.
+ */
+inline size_t SingleLinkageClusters(const arma::mat& mst,
+                                    const size_t numClusters,
+                                    arma::Col<size_t>& assignments)
+{
+  const size_t numPoints = mst.n_cols + 1;
+  Log::Assert(numClusters >= 1 && numClusters <= numPoints);
+
+  return single_linkage::Label(mst, single_linkage::SortedEdges(mst),
+      numPoints - numClusters, assignments);
+}
+
+/**
+ * Cut the single-linkage hierarchy of the points of the given minimum spanning
+ * tree at the given distance: two points are in the same cluster if and only if
+ * they are joined by a chain of points in which consecutive points are at most
+ * maxDistance apart.  The clusters are numbered in order of their first point.
+ *
+ * @param mst Minimum spanning tree, as returned by DualTreeBoruvka.
+ * @param maxDistance Largest distance merged.
+ * @param assignments Vector to store the cluster of each point in.
+ * @return The number of clusters.
+ */
+inline size_t SingleLinkageCut(const arma::mat& mst,
+                               const double maxDistance,
+                               arma::Col<size_t>& assignments)
+{
+  const arma::uvec order = single_linkage::SortedEdges(mst);
+
+  size_t merges = 0;
+  while (merges < order.n_elem && mst(2, order[merges]) <= maxDistance)
+    ++merges;
+
+  return single_linkage::Label(mst, order, merges, assignments);
+}
+
+}; // namespace emst
+}; // namespace mlpack
+
+#endif
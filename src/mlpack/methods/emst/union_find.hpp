@@ -12,6 +12,9 @@
 
 #include <mlpack/core.hpp>
 
+#include <atomic>
+#include <memory>
+
 namespace mlpack {
 namespace emst {
 
@@ -93,6 +96,95 @@ class UnionFind
   }
 }; // class UnionFind
 
+/**
+ * A lock-free union-find data structure, which can be used by many threads at
+ * once.  Find() uses path halving: every step of the search tries to replace
+ * the parent of the current element by its grandparent with a compare-and-swap,
+ * which fails harmlessly if another thread has changed the parent in the
+ * meantime.  Union() links the root with the larger index below the root with
+ * the smaller index with a compare-and-swap, and retries if the root has been
+ * linked by another thread in the meantime.  Linking by index can't create a
+ * cycle, so the roots found by concurrent operations are always consistent.
+ *
+ * The index of a component is the smallest element of the component.
+ */
+class LockFreeUnionFind
+{
+ private:
+  //! The parent of every element; roots are their own parents.
+  std::unique_ptr<std::atomic<size_t>[]> parent;
+  //! The number of elements.
+  size_t size;
+
+ public:
+  //! Construct the object with the given size.
+  LockFreeUnionFind(const size_t size) :
+      parent(new std::atomic<size_t>[size]),
+      size(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  //! Get the number of elements.
+  size_t Size() const { return size; }
+
+  /**
+   * Returns the component containing an element.  This can be called by many
+   * threads at once, also while other threads call Union().
+   *
+   * @param x the component to be found
+   * @return The index of the component containing x
+   */
+  size_t Find(size_t x)
+  {
+    while (true)
+    {
+      size_t p = parent[x].load(std::memory_order_acquire);
+      if (p == x)
+        return x;
+
+      // Path halving: skip the parent, if it isn't the root.
+      const size_t grandparent = parent[p].load(std::memory_order_acquire);
+      if (grandparent != p)
+        parent[x].compare_exchange_weak(p, grandparent,
+            std::memory_order_release, std::memory_order_relaxed);
+
+      x = grandparent;
+    }
+  }
+
+  /**
+   * Union the components containing x and y.  This can be called by many
+   * threads at once.
+   *
+   * @param x one component
+   * @param y the other component
+   * @return false if x and y were already in the same component.
+   */
+  bool Union(const size_t x, const size_t y)
+  {
+    while (true)
+    {
+      size_t xRoot = Find(x);
+      size_t yRoot = Find(y);
+
+      if (xRoot == yRoot)
+        return false;
+
+      // Link the larger root below the smaller one.  This fails if the larger
+      // root was linked in the meantime, in which case we start over.
+      if (xRoot < yRoot)
+        std::swap(xRoot, yRoot);
+
+      size_t expected = xRoot;
+      if (parent[xRoot].compare_exchange_strong(expected, yRoot,
+          std::memory_order_acq_rel, std::memory_order_acquire))
+        return true;
+    }
+  }
+}; // class LockFreeUnionFind
+
 }; // namespace emst
 }; // namespace mlpack
 
@@ -0,0 +1,109 @@
+/**
+ * @file batch_kernel_evaluation.hpp
+ * @author Ryan Curtin
+ *
+ * Evaluation of a kernel between every pair of points of two sets at once, and
+ * of the self-kernel norms of a set.
+ */
+#ifndef __MLPACK_METHODS_FASTMKS_BATCH_KERNEL_EVALUATION_HPP
+#define __MLPACK_METHODS_FASTMKS_BATCH_KERNEL_EVALUATION_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
+#include <mlpack/core/kernels/polynomial_kernel.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+
+namespace mlpack {
+namespace fastmks {
+
+//! Compute the self-kernel norms of a set, one point at a time.
+template<typename KernelType, typename MatType>
+void KernelNorms(KernelType& kernel, const MatType& data, arma::vec& norms)
+{
+  norms.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    norms[i] = sqrt(kernel.Evaluate(data.col(i), data.col(i)));
+}
+
+//! The linear kernel norms are the Euclidean norms.
+template<typename MatType>
+void KernelNorms(kernel::LinearKernel& /* kernel */,
+                 const MatType& data,
+                 arma::vec& norms)
+{
+  norms = arma::sqrt(arma::trans(arma::sum(arma::square(data), 0)));
+}
+
+//! The polynomial kernel norms follow from the Euclidean norms.
+template<typename MatType>
+void KernelNorms(kernel::PolynomialKernel& kernel,
+                 const MatType& data,
+                 arma::vec& norms)
+{
+  norms = arma::sqrt(arma::pow(arma::trans(arma::sum(arma::square(data), 0))
+      + kernel.Offset(), kernel.Degree()));
+}
+
+//! The Gaussian kernel is normalized, so all its norms are 1.
+template<typename MatType>
+void KernelNorms(kernel::GaussianKernel& /* kernel */,
+                 const MatType& data,
+                 arma::vec& norms)
+{
+  norms.ones(data.n_cols);
+}
+
+/**
+ * Evaluate a kernel between all points of two sets, and compute the
+ * self-kernel norms of a set.  The evaluation between two sets is done by
+ * kernel::KernelMatrix(), which uses the batch Evaluate() of kernels that have
+ * one (see kernel::KernelTraits::HasBatchEvaluate) and evaluates every pair of
+ * points otherwise.
+ *
+ * @tparam KernelType Type of kernel to evaluate.
+ */
+template<typename KernelType>
+class BatchKernelEvaluation
+{
+ public:
+  //! Whether or not Evaluate() is computed with matrix products (if it is not,
+  //! callers may prefer their own loops, e.g. for symmetric sets).
+  static const bool MatrixProducts =
+      kernel::KernelTraits<KernelType>::HasBatchEvaluate;
+
+  /**
+   * Compute K(a_i, b_j) for every column a_i of a and b_j of b, and store it in
+   * products(i, j).
+   *
+   * @param kernel Instantiated kernel.
+   * @param a First set of points.
+   * @param b Second set of points.
+   * @param products Matrix to store the kernel evaluations in.
+   */
+  static void Evaluate(KernelType& kernel,
+                       const arma::mat& a,
+                       const arma::mat& b,
+                       arma::mat& products)
+  {
+    kernel::KernelMatrix(kernel, a, b, products);
+  }
+
+  /**
+   * Compute the self-kernel norm sqrt(K(x, x)) of every point of the set.
+   *
+   * @param kernel Instantiated kernel.
+   * @param data Set of points.
+   * @param norms Vector to store the norms in.
+   */
+  template<typename MatType>
+  static void Norms(KernelType& kernel, const MatType& data, arma::vec& norms)
+  {
+    KernelNorms(kernel, data, norms);
+  }
+};
+
+}; // namespace fastmks
+}; // namespace mlpack
+
+#endif
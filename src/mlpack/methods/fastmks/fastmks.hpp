@@ -45,11 +45,15 @@ namespace fastmks /** Fast max-kernel search. */ {
  * @tparam KernelType Type of kernel to run FastMKS with.
  * @tparam TreeType Type of tree to run FastMKS with; it must have metric
  *     IPMetric<KernelType>.
+ * @tparam TraversalType Type of dual-tree traverser to use (for instance,
+ *     TreeType::ParallelDualTreeTraverser).
  */
 template<
     typename KernelType,
     typename TreeType = tree::CoverTree<metric::IPMetric<KernelType>,
-        tree::FirstPointIsRoot, FastMKSStat>
+        tree::FirstPointIsRoot, FastMKSStat>,
+    template<typename RuleType> class TraversalType =
+        TreeType::template DualTreeTraverser
 >
 class FastMKS
 {
@@ -180,6 +184,21 @@ class FastMKS
   //! Modify whether or not single-tree search is used.
   bool& SingleMode() { return singleMode; }
 
+  //! Get the relative approximation error (0 for exact search).
+  double Epsilon() const { return epsilon; }
+  //! Modify the relative approximation error.  Tree search will prune nodes
+  //! that can't improve the k'th best kernel value of a query point by more
+  //! than a factor of (1 + epsilon).  This must be nonnegative.
+  double& Epsilon() { return epsilon; }
+
+  //! Get the maximum number of base cases for each query point (0 means no
+  //! limit).
+  size_t MaxBaseCases() const { return maxBaseCases; }
+  //! Modify the maximum number of base cases for each query point (0 means no
+  //! limit).  In dual-tree search, the limit is only checked once the
+  //! traversal reaches the individual query points, so it may be exceeded.
+  size_t& MaxBaseCases() { return maxBaseCases; }
+
   /**
    * Returns a string representation of this object.
    */
@@ -197,10 +216,22 @@ class FastMKS
   bool singleMode;
   //! If true, naive (brute-force) search is used.
   bool naive;
+  //! The relative approximation error (0 for exact search).
+  double epsilon;
+  //! The maximum number of base cases for each query point (0 for no limit).
+  size_t maxBaseCases;
 
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
 
+  //! The self-kernels sqrt(K(r, r)) of the reference points, which are used by
+  //! every tree search.
+  arma::vec referenceKernels;
+
+  //! The number of query points whose kernel values are evaluated at once in
+  //! naive mode.
+  static const size_t naiveBlockSize = 256;
+
   //! Utility function.  Copied too many times from too many places.
   void InsertNeighbor(arma::Mat<size_t>& indices,
                       arma::mat& products,
@@ -11,6 +11,9 @@
 #include "fastmks.hpp"
 
 #include "fastmks_rules.hpp"
+#include "batch_kernel_evaluation.hpp"
+
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <queue>
@@ -19,70 +22,103 @@ namespace mlpack {
 namespace fastmks {
 
 // No instantiated kernel.
-template<typename KernelType, typename TreeType>
-FastMKS<KernelType, TreeType>::FastMKS(const typename TreeType::Mat& referenceSet,
-                                       const bool singleMode,
-                                       const bool naive) :
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+FastMKS<KernelType, TreeType, TraversalType>::FastMKS(
+    const typename TreeType::Mat& referenceSet,
+    const bool singleMode,
+    const bool naive) :
     referenceSet(referenceSet),
     referenceTree(NULL),
     treeOwner(true),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    epsilon(0.0),
+    maxBaseCases(0)
 {
   Timer::Start("tree_building");
 
   if (!naive)
+  {
     referenceTree = new TreeType(referenceSet);
 
+    // The self-kernels of the reference points are used by every search.
+    BatchKernelEvaluation<KernelType>::Norms(metric.Kernel(), referenceSet,
+        referenceKernels);
+  }
+
   Timer::Stop("tree_building");
 }
 
 // Instantiated kernel.
-template<typename KernelType, typename TreeType>
-FastMKS<KernelType, TreeType>::FastMKS(const typename TreeType::Mat& referenceSet,
-                                       KernelType& kernel,
-                                       const bool singleMode,
-                                       const bool naive) :
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+FastMKS<KernelType, TreeType, TraversalType>::FastMKS(
+    const typename TreeType::Mat& referenceSet,
+    KernelType& kernel,
+    const bool singleMode,
+    const bool naive) :
     referenceSet(referenceSet),
     referenceTree(NULL),
     treeOwner(true),
     singleMode(singleMode),
     naive(naive),
+    epsilon(0.0),
+    maxBaseCases(0),
     metric(kernel)
 {
   Timer::Start("tree_building");
 
   // If necessary, the reference tree should be built.  There is no query tree.
   if (!naive)
+  {
     referenceTree = new TreeType(referenceSet, metric);
 
+    // The self-kernels of the reference points are used by every search.
+    BatchKernelEvaluation<KernelType>::Norms(metric.Kernel(), referenceSet,
+        referenceKernels);
+  }
+
   Timer::Stop("tree_building");
 }
 
 // One dataset, pre-built tree.
-template<typename KernelType, typename TreeType>
-FastMKS<KernelType, TreeType>::FastMKS(TreeType* referenceTree,
-                                       const bool singleMode) :
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+FastMKS<KernelType, TreeType, TraversalType>::FastMKS(
+    TreeType* referenceTree,
+    const bool singleMode) :
     referenceSet(referenceTree->Dataset()),
     referenceTree(referenceTree),
     treeOwner(false),
     singleMode(singleMode),
     naive(false),
+    epsilon(0.0),
+    maxBaseCases(0),
     metric(referenceTree->Metric())
 {
-  // Nothing to do.
+  // The self-kernels of the reference points are used by every search.
+  BatchKernelEvaluation<KernelType>::Norms(metric.Kernel(), referenceSet,
+      referenceKernels);
 }
 
-template<typename KernelType, typename TreeType>
-FastMKS<KernelType, TreeType>::~FastMKS()
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+FastMKS<KernelType, TreeType, TraversalType>::~FastMKS()
 {
   // If we created the trees, we must delete them.
   if (treeOwner && referenceTree)
     delete referenceTree;
 }
 
-template<typename KernelType, typename TreeType>
-void FastMKS<KernelType, TreeType>::Search(
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+void FastMKS<KernelType, TreeType, TraversalType>::Search(
     const typename TreeType::Mat& querySet,
     const size_t k,
     arma::Mat<size_t>& indices,
@@ -100,13 +136,23 @@ void FastMKS<KernelType, TreeType>::Search(
     // Fill kernels.
     kernels.fill(-DBL_MAX);
 
-    // Simple double loop.  Stupid, slow, but a good benchmark.
+    // Simple double loop over blocks of query points.  The kernel values of a
+    // whole block are evaluated at once, which is a matrix product for kernels
+    // like the linear and polynomial kernels.
+    arma::mat blockKernels;
     for (size_t q = 0; q < querySet.n_cols; ++q)
     {
+      if (q % naiveBlockSize == 0)
+      {
+        const size_t blockEnd = (q + naiveBlockSize < querySet.n_cols) ?
+            q + naiveBlockSize : querySet.n_cols;
+        BatchKernelEvaluation<KernelType>::Evaluate(metric.Kernel(),
+            referenceSet, querySet.cols(q, blockEnd - 1), blockKernels);
+      }
+
       for (size_t r = 0; r < referenceSet.n_cols; ++r)
       {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet.col(r));
+        const double eval = blockKernels(r, q % naiveBlockSize);
 
         size_t insertPosition;
         for (insertPosition = 0; insertPosition < indices.n_rows;
@@ -130,15 +176,17 @@ void FastMKS<KernelType, TreeType>::Search(
     // Fill kernels.
     kernels.fill(-DBL_MAX);
 
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
+    // Create rules object (this will store the results).  The self-kernels of
+    // the reference points were computed when the tree was built.
     typedef FastMKSRules<KernelType, TreeType> RuleType;
-    RuleType rules(referenceSet, querySet, indices, kernels, metric.Kernel());
+    RuleType rules(referenceSet, querySet, indices, kernels, metric.Kernel(),
+        referenceKernels, epsilon, maxBaseCases);
 
     typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
 
     for (size_t i = 0; i < querySet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+    tree::RecordTraversal("fastmks", traverser, rules);
 
     Log::Info << rules.BaseCases() << " base cases." << std::endl;
     Log::Info << rules.Scores() << " scores." << std::endl;
@@ -157,11 +205,14 @@ void FastMKS<KernelType, TreeType>::Search(
   Search(&queryTree, k, indices, kernels);
 }
 
-template<typename KernelType, typename TreeType>
-void FastMKS<KernelType, TreeType>::Search(TreeType* queryTree,
-                                           const size_t k,
-                                           arma::Mat<size_t>& indices,
-                                           arma::mat& kernels)
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+void FastMKS<KernelType, TreeType, TraversalType>::Search(
+    TreeType* queryTree,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels)
 {
   // If either naive mode or single mode is specified, this must fail.
   if (naive || singleMode)
@@ -178,11 +229,12 @@ void FastMKS<KernelType, TreeType>::Search(TreeType* queryTree,
   Timer::Start("computing_products");
   typedef FastMKSRules<KernelType, TreeType> RuleType;
   RuleType rules(referenceSet, queryTree->Dataset(), indices, kernels,
-      metric.Kernel());
+      metric.Kernel(), referenceKernels, epsilon, maxBaseCases);
 
-  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+  TraversalType<RuleType> traverser(rules);
 
   traverser.Traverse(*queryTree, *referenceTree);
+  tree::RecordTraversal("fastmks", traverser, rules);
 
   Log::Info << rules.BaseCases() << " base cases." << std::endl;
   Log::Info << rules.Scores() << " scores." << std::endl;
@@ -190,10 +242,13 @@ void FastMKS<KernelType, TreeType>::Search(TreeType* queryTree,
   Timer::Stop("computing_products");
 }
 
-template<typename KernelType, typename TreeType>
-void FastMKS<KernelType, TreeType>::Search(const size_t k,
-                                           arma::Mat<size_t>& indices,
-                                           arma::mat& kernels)
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+void FastMKS<KernelType, TreeType, TraversalType>::Search(
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels)
 {
   // No remapping will be necessary because we are using the cover tree.
   Timer::Start("computing_products");
@@ -204,16 +259,24 @@ void FastMKS<KernelType, TreeType>::Search(const size_t k,
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
+    // Simple double loop over blocks of query points, like above.
+    arma::mat blockKernels;
     for (size_t q = 0; q < referenceSet.n_cols; ++q)
     {
+      if (q % naiveBlockSize == 0)
+      {
+        const size_t blockEnd = (q + naiveBlockSize < referenceSet.n_cols) ?
+            q + naiveBlockSize : referenceSet.n_cols;
+        BatchKernelEvaluation<KernelType>::Evaluate(metric.Kernel(),
+            referenceSet, referenceSet.cols(q, blockEnd - 1), blockKernels);
+      }
+
       for (size_t r = 0; r < referenceSet.n_cols; ++r)
       {
         if (q == r)
           continue; // Don't return the point as its own candidate.
 
-        const double eval = metric.Kernel().Evaluate(referenceSet.col(q),
-                                                     referenceSet.col(r));
+        const double eval = blockKernels(r, q % naiveBlockSize);
 
         size_t insertPosition;
         for (insertPosition = 0; insertPosition < indices.n_rows;
@@ -234,16 +297,17 @@ void FastMKS<KernelType, TreeType>::Search(const size_t k,
   // Single-tree implementation.
   if (singleMode)
   {
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
+    // Create rules object (this will store the results).  The self-kernels of
+    // the reference points were computed when the tree was built.
     typedef FastMKSRules<KernelType, TreeType> RuleType;
     RuleType rules(referenceSet, referenceSet, indices, kernels,
-        metric.Kernel());
+        metric.Kernel(), referenceKernels, epsilon, maxBaseCases);
 
     typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
 
     for (size_t i = 0; i < referenceSet.n_cols; ++i)
       traverser.Traverse(i, *referenceTree);
+    tree::RecordTraversal("fastmks", traverser, rules);
 
     // Save the number of pruned nodes.
     const size_t numPrunes = traverser.NumPrunes();
@@ -271,13 +335,16 @@ void FastMKS<KernelType, TreeType>::Search(const size_t k,
  * @param neighbor Index of reference point which is being inserted.
  * @param distance Distance from query point to reference point.
  */
-template<typename KernelType, typename TreeType>
-void FastMKS<KernelType, TreeType>::InsertNeighbor(arma::Mat<size_t>& indices,
-                                                   arma::mat& products,
-                                                   const size_t queryIndex,
-                                                   const size_t pos,
-                                                   const size_t neighbor,
-                                                   const double distance)
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+void FastMKS<KernelType, TreeType, TraversalType>::InsertNeighbor(
+    arma::Mat<size_t>& indices,
+    arma::mat& products,
+    const size_t queryIndex,
+    const size_t pos,
+    const size_t neighbor,
+    const double distance)
 {
   // We only memmove() if there is actually a need to shift something.
   if (pos < (products.n_rows - 1))
@@ -297,8 +364,10 @@ void FastMKS<KernelType, TreeType>::InsertNeighbor(arma::Mat<size_t>& indices,
 }
 
 // Return string of object.
-template<typename KernelType, typename TreeType>
-std::string FastMKS<KernelType, TreeType>::ToString() const
+template<typename KernelType,
+         typename TreeType,
+         template<typename> class TraversalType>
+std::string FastMKS<KernelType, TreeType, TraversalType>::ToString() const
 {
   std::ostringstream convert;
   convert << "FastMKS [" << this << "]" << std::endl;
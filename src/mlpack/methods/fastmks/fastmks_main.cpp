@@ -60,6 +60,13 @@ PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
 // Cover tree parameter.
 PARAM_DOUBLE("base", "Base to use during cover tree construction.", "b", 2.0);
 
+// Approximation parameters.
+PARAM_DOUBLE("epsilon", "Relative approximation error for tree search; nodes "
+    "that can't improve a result by more than a factor of (1 + epsilon) are "
+    "pruned.", "e", 0.0);
+PARAM_INT("max_base_cases", "Maximum number of kernel evaluations for each "
+    "query point during tree search (0 means no limit).", "B", 0);
+
 // Kernel parameters.
 PARAM_DOUBLE("degree", "Degree of polynomial kernel.", "d", 2.0);
 PARAM_DOUBLE("offset", "Offset of kernel (for polynomial and hyptan kernels).",
@@ -74,6 +81,8 @@ void RunFastMKS(const arma::mat& referenceData,
                 const bool single,
                 const bool naive,
                 const double base,
+                const double epsilon,
+                const size_t maxBaseCases,
                 const size_t k,
                 arma::Mat<size_t>& indices,
                 arma::mat& kernels,
@@ -95,6 +104,8 @@ void RunFastMKS(const arma::mat& referenceData,
 
     // Create FastMKS object.
     FastMKS<KernelType> fastmks(&tree, single);
+    fastmks.Epsilon() = epsilon;
+    fastmks.MaxBaseCases() = maxBaseCases;
 
     // Now search with it.
     fastmks.Search(k, indices, kernels);
@@ -108,6 +119,8 @@ void RunFastMKS(const arma::mat& referenceData,
                 const bool single,
                 const bool naive,
                 const double base,
+                const double epsilon,
+                const size_t maxBaseCases,
                 const size_t k,
                 arma::Mat<size_t>& indices,
                 arma::mat& kernels,
@@ -130,6 +143,8 @@ void RunFastMKS(const arma::mat& referenceData,
 
     // Create FastMKS object.
     FastMKS<KernelType> fastmks(&referenceTree, single);
+    fastmks.Epsilon() = epsilon;
+    fastmks.MaxBaseCases() = maxBaseCases;
 
     // Now search with it.
     fastmks.Search(&queryTree, k, indices, kernels);
@@ -153,6 +168,10 @@ int main(int argc, char** argv)
   // For cover tree construction.
   const double base = CLI::GetParam<double>("base");
 
+  // Approximation parameters.
+  const double epsilon = CLI::GetParam<double>("epsilon");
+  const int maxBaseCases = CLI::GetParam<int>("max_base_cases");
+
   // Kernel parameters.
   const string kernelType = CLI::GetParam<string>("kernel");
   const double degree = CLI::GetParam<double>("degree");
@@ -209,6 +228,17 @@ int main(int argc, char** argv)
     Log::Warn << "--single ignored because --naive is present." << endl;
   }
 
+  // Sanity checks on the approximation parameters.
+  if (epsilon < 0.0)
+    Log::Fatal << "Invalid epsilon: " << epsilon << "; must be nonnegative."
+        << endl;
+  if (maxBaseCases < 0)
+    Log::Fatal << "Invalid --max_base_cases: " << maxBaseCases << "; must be "
+        << "nonnegative." << endl;
+  if (naive && (epsilon > 0.0 || maxBaseCases > 0))
+    Log::Warn << "--epsilon and --max_base_cases ignored because --naive is "
+        << "present." << endl;
+
   // Matrices for output storage.
   arma::Mat<size_t> indices;
   arma::mat kernels;
@@ -219,45 +249,45 @@ int main(int argc, char** argv)
     if (kernelType == "linear")
     {
       LinearKernel lk;
-      RunFastMKS<LinearKernel>(referenceData, single, naive, base, k, indices,
-          kernels, lk);
+      RunFastMKS<LinearKernel>(referenceData, single, naive, base, epsilon,
+          maxBaseCases, k, indices, kernels, lk);
     }
     else if (kernelType == "polynomial")
     {
 
       PolynomialKernel pk(degree, offset);
-      RunFastMKS<PolynomialKernel>(referenceData, single, naive, base, k,
-          indices, kernels, pk);
+      RunFastMKS<PolynomialKernel>(referenceData, single, naive, base, epsilon,
+          maxBaseCases, k, indices, kernels, pk);
     }
     else if (kernelType == "cosine")
     {
       CosineDistance cd;
-      RunFastMKS<CosineDistance>(referenceData, single, naive, base, k, indices,
-          kernels, cd);
+      RunFastMKS<CosineDistance>(referenceData, single, naive, base, epsilon,
+          maxBaseCases, k, indices, kernels, cd);
     }
     else if (kernelType == "gaussian")
     {
       GaussianKernel gk(bandwidth);
-      RunFastMKS<GaussianKernel>(referenceData, single, naive, base, k, indices,
-          kernels, gk);
+      RunFastMKS<GaussianKernel>(referenceData, single, naive, base, epsilon,
+          maxBaseCases, k, indices, kernels, gk);
     }
     else if (kernelType == "epanechnikov")
     {
       EpanechnikovKernel ek(bandwidth);
-      RunFastMKS<EpanechnikovKernel>(referenceData, single, naive, base, k,
-          indices, kernels, ek);
+      RunFastMKS<EpanechnikovKernel>(referenceData, single, naive, base,
+          epsilon, maxBaseCases, k, indices, kernels, ek);
     }
     else if (kernelType == "triangular")
     {
       TriangularKernel tk(bandwidth);
-      RunFastMKS<TriangularKernel>(referenceData, single, naive, base, k,
-          indices, kernels, tk);
+      RunFastMKS<TriangularKernel>(referenceData, single, naive, base, epsilon,
+          maxBaseCases, k, indices, kernels, tk);
     }
     else if (kernelType == "hyptan")
     {
       HyperbolicTangentKernel htk(scale, offset);
-      RunFastMKS<HyperbolicTangentKernel>(referenceData, single, naive, base, k,
-          indices, kernels, htk);
+      RunFastMKS<HyperbolicTangentKernel>(referenceData, single, naive, base,
+          epsilon, maxBaseCases, k, indices, kernels, htk);
     }
   }
   else
@@ -265,44 +295,44 @@ int main(int argc, char** argv)
     if (kernelType == "linear")
     {
       LinearKernel lk;
-      RunFastMKS<LinearKernel>(referenceData, queryData, single, naive, base, k,
-          indices, kernels, lk);
+      RunFastMKS<LinearKernel>(referenceData, queryData, single, naive, base,
+          epsilon, maxBaseCases, k, indices, kernels, lk);
     }
     else if (kernelType == "polynomial")
     {
       PolynomialKernel pk(degree, offset);
       RunFastMKS<PolynomialKernel>(referenceData, queryData, single, naive,
-          base, k, indices, kernels, pk);
+          base, epsilon, maxBaseCases, k, indices, kernels, pk);
     }
     else if (kernelType == "cosine")
     {
       CosineDistance cd;
       RunFastMKS<CosineDistance>(referenceData, queryData, single, naive, base,
-          k, indices, kernels, cd);
+          epsilon, maxBaseCases, k, indices, kernels, cd);
     }
     else if (kernelType == "gaussian")
     {
       GaussianKernel gk(bandwidth);
       RunFastMKS<GaussianKernel>(referenceData, queryData, single, naive, base,
-          k, indices, kernels, gk);
+          epsilon, maxBaseCases, k, indices, kernels, gk);
     }
     else if (kernelType == "epanechnikov")
     {
       EpanechnikovKernel ek(bandwidth);
       RunFastMKS<EpanechnikovKernel>(referenceData, queryData, single, naive,
-          base, k, indices, kernels, ek);
+          base, epsilon, maxBaseCases, k, indices, kernels, ek);
     }
     else if (kernelType == "triangular")
     {
       TriangularKernel tk(bandwidth);
       RunFastMKS<TriangularKernel>(referenceData, queryData, single, naive,
-          base, k, indices, kernels, tk);
+          base, epsilon, maxBaseCases, k, indices, kernels, tk);
     }
     else if (kernelType == "hyptan")
     {
       HyperbolicTangentKernel htk(scale, offset);
       RunFastMKS<HyperbolicTangentKernel>(referenceData, queryData, single,
-          naive, base, k, indices, kernels, htk);
+          naive, base, epsilon, maxBaseCases, k, indices, kernels, htk);
     }
   }
 
@@ -11,6 +11,7 @@
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 
 #include "../neighbor_search/ns_traversal_info.hpp"
+#include "batch_kernel_evaluation.hpp"
 
 namespace mlpack {
 namespace fastmks {
@@ -22,11 +23,32 @@ template<typename KernelType, typename TreeType>
 class FastMKSRules
 {
  public:
+  /**
+   * Construct the rules.  The self-kernel norms of the reference set are given
+   * by the caller, so that they are only computed once for all searches; the
+   * norms of the query set are computed here, unless the query set is the
+   * reference set.
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Set of query points.
+   * @param indices Matrix to store the indices of the results in.
+   * @param products Matrix to store the kernel values of the results in.
+   * @param kernel Instantiated kernel.
+   * @param referenceKernels Self-kernel norms of the reference points.
+   * @param epsilon Relative approximation error; nodes that can't improve the
+   *     current k'th best kernel value by more than a factor of (1 + epsilon)
+   *     are pruned.  0 means exact search.
+   * @param maxBaseCases Maximum number of base cases for each query point (0
+   *     means no limit).
+   */
   FastMKSRules(const typename TreeType::Mat& referenceSet,
                const typename TreeType::Mat& querySet,
                arma::Mat<size_t>& indices,
                arma::mat& products,
-               KernelType& kernel);
+               KernelType& kernel,
+               const arma::vec& referenceKernels,
+               const double epsilon = 0.0,
+               const size_t maxBaseCases = 0);
 
   //! Compute the base case (kernel value) between two points.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
@@ -109,8 +131,8 @@ class FastMKSRules
 
   //! Cached query set self-kernels (|| q || for each q).
   arma::vec queryKernels;
-  //! Cached reference set self-kernels (|| r || for each r).
-  arma::vec referenceKernels;
+  //! Reference set self-kernels (|| r || for each r), owned by FastMKS.
+  const arma::vec& referenceKernels;
 
   //! The instantiated kernel.
   KernelType& kernel;
@@ -131,6 +153,17 @@ class FastMKSRules
                       const size_t neighbor,
                       const double distance);
 
+  //! Return the value a kernel bound has to be larger than to improve the
+  //! given k'th best kernel value, taking the approximation into account.
+  double ApproximateBound(const double bestKernel) const;
+
+  //! Relative approximation error (0 for exact search).
+  double epsilon;
+  //! Maximum number of base cases for each query point (0 for no limit).
+  size_t maxBaseCases;
+  //! The number of base cases of each query point, if maxBaseCases is set.
+  arma::Col<size_t> queryBaseCases;
+
   //! For benchmarking.
   size_t baseCases;
   //! For benchmarking.
@@ -19,28 +19,40 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     const typename TreeType::Mat& querySet,
     arma::Mat<size_t>& indices,
     arma::mat& products,
-    KernelType& kernel) :
+    KernelType& kernel,
+    const arma::vec& referenceKernels,
+    const double epsilon,
+    const size_t maxBaseCases) :
     referenceSet(referenceSet),
     querySet(querySet),
     indices(indices),
     products(products),
+    referenceKernels(referenceKernels),
     kernel(kernel),
     lastQueryIndex(-1),
     lastReferenceIndex(-1),
     lastKernel(0.0),
+    epsilon(epsilon),
+    maxBaseCases(maxBaseCases),
     baseCases(0),
     scores(0)
 {
-  // Precompute each self-kernel.
-  queryKernels.set_size(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; ++i)
-    queryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
-                                           querySet.col(i)));
+  // Precompute each query self-kernel.  If the query set is the reference set,
+  // the cached reference self-kernels are used without a copy.
+  if (&querySet == &referenceSet)
+    queryKernels = arma::vec(const_cast<double*>(referenceKernels.memptr()),
+        referenceKernels.n_elem, false, true);
+  else
+    BatchKernelEvaluation<KernelType>::Norms(kernel, querySet, queryKernels);
 
-  referenceKernels.set_size(referenceSet.n_cols);
-  for (size_t i = 0; i < referenceSet.n_cols; ++i)
-    referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
-                                               referenceSet.col(i)));
+  if (epsilon < 0.0)
+  {
+    Log::Fatal << "FastMKSRules::FastMKSRules(): epsilon must be nonnegative ("
+        << epsilon << " given)." << std::endl;
+  }
+
+  if (maxBaseCases > 0)
+    queryBaseCases.zeros(querySet.n_cols);
 
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
@@ -70,6 +82,8 @@ double FastMKSRules<KernelType, TreeType>::BaseCase(
   }
 
   ++baseCases;
+  if (maxBaseCases > 0)
+    ++queryBaseCases[queryIndex];
   double kernelEval = kernel.Evaluate(querySet.col(queryIndex),
                                       referenceSet.col(referenceIndex));
 
@@ -101,8 +115,13 @@ template<typename KernelType, typename TreeType>
 double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
                                                  TreeType& referenceNode)
 {
+  // Stop once the query point has used up its base cases.
+  if (maxBaseCases > 0 && queryBaseCases[queryIndex] >= maxBaseCases)
+    return DBL_MAX;
+
   // Compare with the current best.
-  const double bestKernel = products(products.n_rows - 1, queryIndex);
+  const double bestKernel = ApproximateBound(products(products.n_rows - 1,
+      queryIndex));
 
   // See if we can perform a parent-child prune.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
@@ -195,9 +214,16 @@ template<typename KernelType, typename TreeType>
 double FastMKSRules<KernelType, TreeType>::Score(TreeType& queryNode,
                                                  TreeType& referenceNode)
 {
+  // A query point that has used up its base cases is not searched any further.
+  // Only nodes holding a single point are pruned, since the other points of a
+  // larger node may still have base cases left.
+  if (maxBaseCases > 0 && queryNode.NumDescendants() == 1 &&
+      queryBaseCases[queryNode.Descendant(0)] >= maxBaseCases)
+    return DBL_MAX;
+
   // Update and get the query node's bound.
   queryNode.Stat().Bound() = CalculateBound(queryNode);
-  const double bestKernel = queryNode.Stat().Bound();
+  const double bestKernel = ApproximateBound(queryNode.Stat().Bound());
 
   // First, see if we can make a parent-child or parent-parent prune.  These
   // four bounds on the maximum kernel value are looser than the bound normally
@@ -385,7 +411,11 @@ double FastMKSRules<KernelType, TreeType>::Rescore(const size_t queryIndex,
                                                    TreeType& /*referenceNode*/,
                                                    const double oldScore) const
 {
-  const double bestKernel = products(products.n_rows - 1, queryIndex);
+  if (maxBaseCases > 0 && queryBaseCases[queryIndex] >= maxBaseCases)
+    return DBL_MAX;
+
+  const double bestKernel = ApproximateBound(products(products.n_rows - 1,
+      queryIndex));
 
   return ((1.0 / oldScore) > bestKernel) ? oldScore : DBL_MAX;
 }
@@ -396,11 +426,28 @@ double FastMKSRules<KernelType, TreeType>::Rescore(TreeType& queryNode,
                                                    const double oldScore) const
 {
   queryNode.Stat().Bound() = CalculateBound(queryNode);
-  const double bestKernel = queryNode.Stat().Bound();
+  const double bestKernel = ApproximateBound(queryNode.Stat().Bound());
 
   return ((1.0 / oldScore) > bestKernel) ? oldScore : DBL_MAX;
 }
 
+/**
+ * Return the value that a bound on the kernel values of a node has to exceed to
+ * be worth recursing into, given the k'th best kernel value (or a bound on it).
+ * For exact search this is the given value; otherwise, the node must be able to
+ * improve on it by a factor of (1 + epsilon).
+ */
+template<typename KernelType, typename TreeType>
+inline double FastMKSRules<KernelType, TreeType>::ApproximateBound(
+    const double bestKernel) const
+{
+  // While there are fewer than k candidates, nothing can be pruned.
+  if (epsilon == 0.0 || bestKernel == -DBL_MAX)
+    return bestKernel;
+
+  return bestKernel + epsilon * std::abs(bestKernel);
+}
+
 /**
  * Calculate the bound for the given query node.  This bound represents the
  * minimum value which a node combination must achieve to guarantee an
@@ -31,6 +31,13 @@ namespace gmm {
  *
  * This method should create 'clusters' clusters, and return the assignment of
  * each point to a cluster.
+ *
+ * The components can either be GaussianDistributions, whose full covariances
+ * are constrained with the CovarianceConstraintPolicy, or
+ * DiagonalGaussianDistributions, which only store the variances of each
+ * dimension.  For the latter, the E-step costs O(d) per point and component,
+ * and the M-step only computes d variances per component; the constraint
+ * policy is not used, since the variances are only kept positive.
  */
 template<typename InitialClusteringType = kmeans::KMeans<>,
          typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
@@ -68,14 +75,15 @@ class EMFit
    * option.
    *
    * @param observations List of observations to train on.
-   * @param means Vector to store trained means in.
-   * @param covariances Vector to store trained covariances in.
+   * @param dists Vector to store trained components in (GaussianDistribution
+   *      or DiagonalGaussianDistribution).
    * @param weights Vector to store a priori weights in.
    * @param useInitialModel If true, the given model is used for the initial
    *      clustering.
    */
+  template<typename DistributionType>
   void Estimate(const arma::mat& observations,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<DistributionType>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -90,15 +98,16 @@ class EMFit
    *
    * @param observations List of observations to train on.
    * @param probabilities Probability of each point being from this model.
-   * @param means Vector to store trained means in.
-   * @param covariances Vector to store trained covariances in.
+   * @param dists Vector to store trained components in (GaussianDistribution
+   *      or DiagonalGaussianDistribution).
    * @param weights Vector to store a priori weights in.
    * @param useInitialModel If true, the given model is used for the initial
    *      clustering.
    */
+  template<typename DistributionType>
   void Estimate(const arma::mat& observations,
                 const arma::vec& probabilities,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<DistributionType>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -122,15 +131,15 @@ class EMFit
   //! Modify the tolerance for the convergence of the EM algorithm.
   double& Tolerance() { return tolerance; }
 
- private:
   /**
    * Run the clusterer, and then turn the cluster assignments into Gaussians.
-   * This is a helper function for both overloads of Estimate().  The vectors
-   * must be already set to the number of clusters.
+   * This is used by both overloads of Estimate() when no initial model is
+   * given; GMM::Estimate() also calls it to draw the initial models of all its
+   * trials before fitting them in parallel.  The vectors must be already set
+   * to the number of clusters.
    *
    * @param observations List of observations.
-   * @param means Vector to store means in.
-   * @param covariances Vector to store covariances in.
+   * @param dists Vector to store the initial Gaussians in.
    * @param weights Vector to store a priori weights in.
    */
   void InitialClustering(const arma::mat& observations,
@@ -138,19 +147,76 @@ class EMFit
                          arma::vec& weights);
 
   /**
-   * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
-   * GMM code.  Intuition suggests that the log-likelihood is not the best way
-   * to determine if the EM algorithm has converged.
+   * Run the clusterer, and then turn the cluster assignments into Gaussians
+   * with diagonal covariances; see the overload above.
    *
-   * @param data Data matrix.
-   * @param means Vector of means.
-   * @param covariances Vector of covariance matrices.
-   * @param weights Vector of a priori weights.
+   * @param observations List of observations.
+   * @param dists Vector to store the initial Gaussians in.
+   * @param weights Vector to store a priori weights in.
+   */
+  void InitialClustering(
+      const arma::mat& observations,
+      std::vector<distribution::DiagonalGaussianDistribution>& dists,
+      arma::vec& weights);
+
+ private:
+
+  /**
+   * Calculate the conditional probability of each observation being from each
+   * Gaussian (the E-step), and return the log-likelihood of the model.  Yes,
+   * the log-likelihood is reimplemented in the GMM code.  Intuition suggests
+   * that the log-likelihood is not the best way to determine if the EM
+   * algorithm has converged.  The observations are split into blocks which are
+   * processed in parallel when OpenMP is available.
+   *
+   * @param observations List of observations.
+   * @param dists Current Gaussians of the model.
+   * @param weights Current a priori weights of the model.
+   * @param condProb Matrix to store conditional probabilities in; it must
+   *     already be of size (number of points) x (number of Gaussians).
+   * @return Log-likelihood of the observations under the model.
+   */
+  template<typename DistributionType>
+  double ExpectationStep(const arma::mat& observations,
+                         const std::vector<DistributionType>& dists,
+                         const arma::vec& weights,
+                         arma::mat& condProb) const;
+
+  /**
+   * Refit the mean and covariance of each Gaussian from the (possibly
+   * weighted) conditional probabilities (the M-step).  Gaussians with no
+   * probability mass are left unchanged.  The Gaussians are refit in parallel
+   * when OpenMP is available.
+   *
+   * @param observations List of observations.
+   * @param condProb Conditional probability of each point being from each
+   *     Gaussian.
+   * @param probRowSums Column sums of condProb.
+   * @param dists Gaussians to refit.
+   */
+  void MaximizationStep(const arma::mat& observations,
+                        const arma::mat& condProb,
+                        const arma::vec& probRowSums,
+                        std::vector<distribution::GaussianDistribution>& dists)
+      const;
+
+  /**
+   * Refit the mean and variances of each diagonal Gaussian from the (possibly
+   * weighted) conditional probabilities; see the overload above.  Only the d
+   * variances of each Gaussian are computed, in a single pass over the
+   * observations.
+   *
+   * @param observations List of observations.
+   * @param condProb Conditional probability of each point being from each
+   *     Gaussian.
+   * @param probRowSums Column sums of condProb.
+   * @param dists Gaussians to refit.
    */
-  double LogLikelihood(const arma::mat& data,
-                       const std::vector<distribution::GaussianDistribution>&
-                           dists,
-                       const arma::vec& weights) const;
+  void MaximizationStep(
+      const arma::mat& observations,
+      const arma::mat& condProb,
+      const arma::vec& probRowSums,
+      std::vector<distribution::DiagonalGaussianDistribution>& dists) const;
 
   //! Maximum iterations of EM algorithm.
   size_t maxIterations;
@@ -11,6 +11,10 @@
 // In case it hasn't been included yet.
 #include "em_fit.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace gmm {
 
@@ -28,9 +32,10 @@ EMFit<InitialClusteringType, CovarianceConstraintPolicy>::EMFit(
 { /* Nothing to do. */ }
 
 template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename DistributionType>
 void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     const arma::mat& observations,
-    std::vector<distribution::GaussianDistribution>& dists,
+    std::vector<DistributionType>& dists,
     arma::vec& weights,
     const bool useInitialModel)
 {
@@ -38,13 +43,15 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  // The E-step of each iteration also gives the log-likelihood of the model it
+  // was computed with, so the likelihood never needs a separate pass.
+  arma::mat condProb(observations.n_cols, dists.size());
+  double l = ExpectationStep(observations, dists, weights, condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
@@ -53,149 +60,70 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
         << "log-likelihood " << l << "." << std::endl;
 
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
-
     // Store the sum of the probability of each state over all the observations.
     arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
-    // Calculate the new value of the means using the updated conditional
+    // Calculate the new means and covariances using the updated conditional
     // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0)
-        dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i)));
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0.0) {
-        arma::mat covariance = (tmp * trans(tmpB)) / probRowSums[i];
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-    }
+    MaximizationStep(observations, condProb, probRowSums, dists);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
     weights = probRowSums / observations.n_cols;
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate the conditional probabilities of choosing a
+    // particular Gaussian given the observations and the new theta value.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = ExpectationStep(observations, dists, weights, condProb);
 
     iteration++;
   }
 }
 
 template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename DistributionType>
 void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     const arma::mat& observations,
     const arma::vec& probabilities,
-    std::vector<distribution::GaussianDistribution>& dists,
+    std::vector<DistributionType>& dists,
     arma::vec& weights,
     const bool useInitialModel)
 {
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  arma::mat condProb(observations.n_cols, dists.size());
+  double l = ExpectationStep(observations, dists, weights, condProb);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condProb(observations.n_cols, dists.size());
+  const double totalProbability = accu(probabilities);
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
+    // Multiply the conditional probability of each point being from each
+    // Gaussian by the probability of the point being from this mixture model.
+    condProb.each_col() %= probabilities;
 
     // This will store the sum of probabilities of each state over all the
     // observations.
-    arma::vec probRowSums(dists.size());
+    arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
 
-    // Calculate the new value of the means using the updated conditional
+    // Calculate the new means and covariances using the weighted conditional
     // probabilities.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      probRowSums[i] = accu(condProb.col(i) % probabilities);
-
-      dists[i].Mean() = (observations * (condProb.col(i) % probabilities)) /
-        probRowSums[i];
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i) % probabilities));
-
-      arma::mat cov = (tmp * trans(tmpB)) / probRowSums[i];
-
-      // Apply covariance constraint.
-      constraint.ApplyConstraint(cov);
-
-      dists[i].Covariance(std::move(cov));
-    }
+    MaximizationStep(observations, condProb, probRowSums, dists);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
-    weights = probRowSums / accu(probabilities);
+    weights = probRowSums / totalProbability;
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new conditional probabilities.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = ExpectationStep(observations, dists, weights, condProb);
 
     iteration++;
   }
@@ -269,33 +197,201 @@ InitialClustering(const arma::mat& observations,
 }
 
 template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+InitialClustering(
     const arma::mat& observations,
-    const std::vector<distribution::GaussianDistribution>& dists,
-    const arma::vec& weights) const
+    std::vector<distribution::DiagonalGaussianDistribution>& dists,
+    arma::vec& weights)
 {
-  double logLikelihood = 0;
+  // Assignments from clustering.
+  arma::Col<size_t> assignments;
+
+  // Run clustering algorithm.
+  clusterer.Cluster(observations, dists.size(), assignments);
+
+  // Only the variances of each dimension are needed, so the points are added
+  // up dimension by dimension.
+  std::vector<arma::vec> means(dists.size());
+  std::vector<arma::vec> variances(dists.size());
+  weights.zeros();
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    means[i].zeros(observations.n_rows);
+    variances[i].zeros(observations.n_rows);
+  }
+
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    means[assignments[i]] += observations.col(i);
+    weights[assignments[i]]++;
+  }
+
+  for (size_t i = 0; i < dists.size(); ++i)
+    means[i] /= (weights[i] > 1) ? weights[i] : 1;
 
-  arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const size_t cluster = assignments[i];
+    variances[cluster] += arma::square(observations.col(i) - means[cluster]);
+  }
 
   for (size_t i = 0; i < dists.size(); ++i)
   {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    variances[i] /= (weights[i] > 1) ? weights[i] : 1;
+
+    std::swap(dists[i].Mean(), means[i]);
+    dists[i].Covariance(std::move(variances[i]));
+    dists[i].ClampVariances();
   }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
+
+  // Finally, normalize weights.
+  weights /= accu(weights);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename DistributionType>
+double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+ExpectationStep(const arma::mat& observations,
+                const std::vector<DistributionType>& dists,
+                const arma::vec& weights,
+                arma::mat& condProb) const
+{
+  // Points are handled in blocks, so that each thread works on a slice of the
+  // observations small enough to stay in cache while every component is
+  // evaluated on it.
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+  const arma::vec logWeights = arma::log(weights);
+
+  double logLikelihood = 0;
+  size_t zeroLikelihoodPoints = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:logLikelihood, zeroLikelihoodPoints)
+  for (size_t b = 0; b < numBlocks; ++b)
   {
-    if (accu(likelihoods.col(j)) == 0)
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
+    const size_t begin = b * blockSize;
+    const size_t count = std::min(blockSize,
+        (size_t) observations.n_cols - begin);
+
+    // An alias of the columns in this block; no data is copied.
+    const arma::mat block(const_cast<double*>(observations.colptr(begin)),
+        observations.n_rows, count, false, true);
+
+    // Column j holds the log of the weighted density of every Gaussian at
+    // point j of the block.
+    arma::mat logProbs(dists.size(), count);
+    arma::vec logPhis;
+    for (size_t i = 0; i < dists.size(); ++i)
+    {
+      dists[i].LogProbability(block, logPhis);
+      logProbs.row(i) = trans(logPhis) + logWeights[i];
+    }
+
+    // Normalize each point in log-space, so that points far from every
+    // Gaussian do not underflow to a probability of zero.
+    for (size_t j = 0; j < count; ++j)
+    {
+      // This column is overwritten with the normalized probabilities.
+      arma::vec prob = logProbs.unsafe_col(j);
+      const double maxLogProb = prob.max();
+      if (maxLogProb == -std::numeric_limits<double>::infinity())
+      {
+        // Avoid dividing by zero; if the probability for everything is 0, we
+        // don't want to make it NaN.
+        prob.zeros();
+        logLikelihood += maxLogProb;
+        ++zeroLikelihoodPoints;
+        continue;
+      }
+
+      prob = arma::exp(prob - maxLogProb);
+      const double probSum = accu(prob);
+      prob /= probSum;
+      logLikelihood += maxLogProb + std::log(probSum);
+    }
+
+    condProb.rows(begin, begin + count - 1) = trans(logProbs);
   }
 
+  if (zeroLikelihoodPoints > 0)
+    Log::Info << "Likelihood of " << zeroLikelihoodPoints << " point(s) is 0!  "
+        << "They are probably outliers." << std::endl;
+
   return logLikelihood;
 }
 
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+MaximizationStep(const arma::mat& observations,
+                 const arma::mat& condProb,
+                 const arma::vec& probRowSums,
+                 std::vector<distribution::GaussianDistribution>& dists) const
+{
+  // Each component only reads the observations and its own column of condProb,
+  // so the components can be refit independently.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probRowSums[i] == 0.0)
+      continue;
+
+    // The weighted covariance is accumulated a block of points at a time, so
+    // only a block-sized temporary is needed.
+    arma::vec mean;
+    arma::mat covariance;
+    math::Covariance(observations, condProb.unsafe_col(i), mean, covariance);
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covariance);
+
+    dists[i].Mean() = mean;
+    dists[i].Covariance(std::move(covariance));
+  }
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+MaximizationStep(
+    const arma::mat& observations,
+    const arma::mat& condProb,
+    const arma::vec& probRowSums,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists) const
+{
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (probRowSums[i] == 0.0)
+      continue;
+
+    // The weighted mean, and then the weighted variances around it, without
+    // any temporary of the size of the observations.
+    const double* probs = condProb.colptr(i);
+    arma::vec mean = (observations * condProb.unsafe_col(i)) / probRowSums[i];
+    arma::vec variances(observations.n_rows, arma::fill::zeros);
+    for (size_t j = 0; j < observations.n_cols; ++j)
+    {
+      if (probs[j] == 0.0)
+        continue;
+
+      const double* point = observations.colptr(j);
+      for (size_t d = 0; d < observations.n_rows; ++d)
+      {
+        const double diff = point[d] - mean[d];
+        variances[d] += probs[j] * diff * diff;
+      }
+    }
+    variances /= probRowSums[i];
+
+    dists[i].Mean() = std::move(mean);
+    dists[i].Covariance(std::move(variances));
+    dists[i].ClampVariances();
+  }
+}
+
 }; // namespace gmm
 }; // namespace mlpack
 
@@ -29,12 +29,12 @@ namespace gmm /** Gaussian Mixture Models. */ {
  *
  * @code
  * void Estimate(const arma::mat& observations,
- *               std::vector<distribution::GaussianDistribution>& dists,
+ *               std::vector<DistributionType>& dists,
  *               arma::vec& weights);
  *
  * void Estimate(const arma::mat& observations,
  *               const arma::vec& probabilities,
- *               std::vector<distribution::GaussianDistribution>& dists,
+ *               std::vector<DistributionType>& dists,
  *               arma::vec& weights);
  * @endcode
  *
@@ -47,6 +47,12 @@ namespace gmm /** Gaussian Mixture Models. */ {
  * For a sample implementation, see the EMFit class; this class uses the EM
  * algorithm to train a GMM, and is the default fitting type.
  *
+ * The DistributionType template class is the type of each component.  It is
+ * GaussianDistribution by default; when the components are known to have
+ * diagonal covariances, DiagonalGaussianDistribution only stores the d
+ * variances of each component, and evaluating a component takes O(d) time
+ * instead of O(d^2).  EMFit can train either.
+ *
  * The GMM, once trained, can be used to generate random points from the
  * distribution and estimate the probability of points being from the
  * distribution.  The parameters of the GMM can be obtained through the
@@ -69,7 +75,8 @@ namespace gmm /** Gaussian Mixture Models. */ {
  * arma::vec observation = g.Random();
  * @endcode
  */
-template<typename FittingType = EMFit<> >
+template<typename FittingType = EMFit<>,
+         typename DistributionType = distribution::GaussianDistribution>
 class GMM
 {
  private:
@@ -79,7 +86,7 @@ class GMM
   size_t dimensionality;
 
   //! Vector of Gaussians
-  std::vector<distribution::GaussianDistribution> dists;
+  std::vector<DistributionType> dists;
 
   //! Legacy member data, not used.
   std::vector<arma::vec> means;
@@ -134,7 +141,7 @@ class GMM
    * @param dists Distributions of the model.
    * @param weights Weights of the model.
    */
-  GMM(const std::vector<distribution::GaussianDistribution> & dists,
+  GMM(const std::vector<DistributionType> & dists,
       const arma::vec& weights) :
       gaussians(dists.size()),
       dimensionality((!dists.empty()) ? dists[0].Mean().n_elem : 0),
@@ -152,7 +159,7 @@ class GMM
    * @param covariances Covariances of the model.
    * @param weights Weights of the model.
    */
-  GMM(const std::vector<distribution::GaussianDistribution> & dists,
+  GMM(const std::vector<DistributionType> & dists,
       const arma::vec& weights,
       FittingType& fitter) :
       gaussians(dists.size()),
@@ -165,7 +172,7 @@ class GMM
    * Copy constructor for GMMs which use different fitting types.
    */
   template<typename OtherFittingType>
-  GMM(const GMM<OtherFittingType>& other);
+  GMM(const GMM<OtherFittingType, DistributionType>& other);
 
   /**
    * Copy constructor for GMMs using the same fitting type.  This also copies
@@ -177,7 +184,7 @@ class GMM
    * Copy operator for GMMs which use different fitting types.
    */
   template<typename OtherFittingType>
-  GMM& operator=(const GMM<OtherFittingType>& other);
+  GMM& operator=(const GMM<OtherFittingType, DistributionType>& other);
 
   /**
    * Copy operator for GMMs which use the same fitting type.  This also copies
@@ -232,14 +239,14 @@ class GMM
    *
    * @param i index of component.
    */
-  const distribution::GaussianDistribution& Component(size_t i) const {
+  const DistributionType& Component(size_t i) const {
       return dists[i]; }
   /**
    * Return a reference to a component distribution.
    *
    * @param i index of component.
    */
-  distribution::GaussianDistribution& Component(size_t i) { return dists[i]; }
+  DistributionType& Component(size_t i) { return dists[i]; }
 
   //! Return a const reference to the a priori weights of each Gaussian.
   const arma::vec& Weights() const { return weights; }
@@ -269,6 +276,19 @@ class GMM
   double Probability(const arma::vec& observation,
                      const size_t component) const;
 
+  /**
+   * Calculate the log probability of each of the given observations (columns)
+   * under this distribution.  The observations are scored in blocks, in
+   * parallel if OpenMP is available; every component is evaluated on a whole
+   * block at once, and the components are combined in log-space, so points far
+   * from every component do not underflow.
+   *
+   * @param observations List of observations.
+   * @param logProbabilities Output log probabilities for each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -290,6 +310,11 @@ class GMM
    * is deterministic after the initial position is given, then 'trials' should
    * be set to 1.
    *
+   * If the fitting type has an InitialClustering() method (like EMFit<>), the
+   * initial models of all trials are found first, one after another, and the
+   * trials are then fit in parallel with OpenMP.  The result then only depends
+   * on the random seed, not on the number of threads.
+   *
    * @tparam FittingType The type of fitting method which should be used
    *     (EMFit<> is suggested).
    * @param observations Observations of the model.
@@ -345,12 +370,21 @@ class GMM
    * double priorWeight = gmm.Weights()[2];
    * @endcode
    *
+   * The observations are scored in blocks, in parallel if OpenMP is
+   * available, like LogProbability().
+   *
    * @param observations List of observations to classify.
    * @param labels Object which will be filled with labels.
    */
   void Classify(const arma::mat& observations,
                 arma::Col<size_t>& labels) const;
 
+  /**
+   * Return the number of bytes used by the model: the Gaussians, the weights,
+   * and the fitting object of the model (if it is stored by the model).
+   */
+  size_t MemoryUsage() const;
+
   /**
    * Returns a string representation of this object.
    */
@@ -362,19 +396,97 @@ class GMM
   static std::string const Type() { return "GMM"; }
 
  private:
+  //! Number of observations scored at once by LogProbability(), Classify(),
+  //! and LogLikelihood().
+  static const size_t blockSize = 1024;
+
   /**
    * This function computes the loglikelihood of the given model.  This function
-   * is used by GMM::Estimate().
+   * is used by GMM::Estimate().  The observations are scored in blocks, in
+   * parallel if OpenMP is available, and combined in log-space.
    *
    * @param dataPoints Observations to calculate the likelihood for.
-   * @param means Means of the given mixture model.
-   * @param covars Covariances of the given mixture model.
+   * @param distsL Components of the given mixture model.
    * @param weights Weights of the given mixture model.
    */
   double LogLikelihood(const arma::mat& dataPoints,
-                       const std::vector<distribution::GaussianDistribution>& distsL,
+                       const std::vector<DistributionType>& distsL,
                        const arma::vec& weights) const;
 
+  /**
+   * Compute the log of the weighted density of every component at each of the
+   * observations in the given block of columns.  Column j of logProbs
+   * corresponds to observation (begin + j).
+   *
+   * @param observations List of observations.
+   * @param distsL Components of the mixture model.
+   * @param logWeights Log of the weights of the mixture model.
+   * @param begin Index of the first observation of the block.
+   * @param count Number of observations in the block.
+   * @param logProbs Matrix to store the log probabilities in (components x
+   *     count).
+   */
+  static void BlockLogProbabilities(const arma::mat& observations,
+                                    const std::vector<DistributionType>& distsL,
+                                    const arma::vec& logWeights,
+                                    const size_t begin,
+                                    const size_t count,
+                                    arma::mat& logProbs);
+
+  //! Return the log of the sum of the exponentials of the given values,
+  //! shifting by the largest one to avoid underflow.
+  static double LogSumExp(const arma::vec& values);
+
+  /**
+   * Perform several trials of the fitting and keep the model with the greatest
+   * log-likelihood.  This is used by both overloads of Estimate() when more
+   * than one trial is requested.
+   *
+   * @param observations Observations of the model.
+   * @param probabilities Probability of each observation being from this
+   *     distribution (empty if all observations are certain).
+   * @param trials Number of trials to perform.
+   * @param useExistingModel If true, the existing model is used as the initial
+   *     model of every trial.
+   * @return The log-likelihood of the best fit.
+   */
+  double EstimateTrials(const arma::mat& observations,
+                        const arma::vec& probabilities,
+                        const size_t trials,
+                        const bool useExistingModel);
+
+  HAS_MEM_FUNC(InitialClustering, HasInitialClustering)
+
+  //! The signature of a fitter's InitialClustering() function.
+  typedef void (FittingType::*InitialClusteringType)(const arma::mat&,
+      std::vector<DistributionType>&, arma::vec&);
+
+  //! Fit each trial model.  The initial models are found serially with the
+  //! fitter's InitialClustering(), and the trials are then fit in parallel.
+  template<typename F>
+  void FitTrials(const arma::mat& observations,
+                 const arma::vec& probabilities,
+                 std::vector<std::vector<DistributionType> >&
+                     trialDists,
+                 std::vector<arma::vec>& trialWeights,
+                 arma::vec& likelihoods,
+                 const bool useExistingModel,
+                 typename boost::enable_if<HasInitialClustering<F,
+                     InitialClusteringType> >::type* = 0);
+
+  //! Fit each trial model, one after another, for fitters that can't give
+  //! their initial models separately.
+  template<typename F>
+  void FitTrials(const arma::mat& observations,
+                 const arma::vec& probabilities,
+                 std::vector<std::vector<DistributionType> >&
+                     trialDists,
+                 std::vector<arma::vec>& trialWeights,
+                 arma::vec& likelihoods,
+                 const bool useExistingModel,
+                 typename boost::disable_if<HasInitialClustering<F,
+                     InitialClusteringType> >::type* = 0);
+
   //! Locally-stored fitting object; in case the user did not pass one.
   FittingType localFitter;
 
@@ -24,11 +24,12 @@ namespace gmm {
  * @param gaussians Number of Gaussians in this GMM.
  * @param dimensionality Dimensionality of each Gaussian.
  */
-template<typename FittingType>
-GMM<FittingType>::GMM(const size_t gaussians, const size_t dimensionality) :
+template<typename FittingType, typename DistributionType>
+GMM<FittingType, DistributionType>::GMM(const size_t gaussians,
+                                        const size_t dimensionality) :
     gaussians(gaussians),
     dimensionality(dimensionality),
-    dists(gaussians, distribution::GaussianDistribution(dimensionality)),
+    dists(gaussians, DistributionType(dimensionality)),
     weights(gaussians),
     localFitter(FittingType()),
     fitter(localFitter)
@@ -47,13 +48,13 @@ GMM<FittingType>::GMM(const size_t gaussians, const size_t dimensionality) :
  * @param dimensionality Dimensionality of each Gaussian.
  * @param fitter Initialized fitting mechanism.
  */
-template<typename FittingType>
-GMM<FittingType>::GMM(const size_t gaussians,
-                      const size_t dimensionality,
-                      FittingType& fitter) :
+template<typename FittingType, typename DistributionType>
+GMM<FittingType, DistributionType>::GMM(const size_t gaussians,
+                                        const size_t dimensionality,
+                                        FittingType& fitter) :
     gaussians(gaussians),
     dimensionality(dimensionality),
-    dists(gaussians, distribution::GaussianDistribution(dimensionality)),
+    dists(gaussians, DistributionType(dimensionality)),
     weights(gaussians),
     fitter(fitter)
 {
@@ -63,9 +64,10 @@ GMM<FittingType>::GMM(const size_t gaussians,
 
 
 // Copy constructor.
-template<typename FittingType>
+template<typename FittingType, typename DistributionType>
 template<typename OtherFittingType>
-GMM<FittingType>::GMM(const GMM<OtherFittingType>& other) :
+GMM<FittingType, DistributionType>::GMM(
+    const GMM<OtherFittingType, DistributionType>& other) :
     gaussians(other.gaussians),
     dimensionality(other.dimensionality),
     dists(other.dists),
@@ -74,8 +76,9 @@ GMM<FittingType>::GMM(const GMM<OtherFittingType>& other) :
     fitter(localFitter) { /* Nothing to do. */ }
 
 // Copy constructor for when the other GMM uses the same fitting type.
-template<typename FittingType>
-GMM<FittingType>::GMM(const GMM<FittingType>& other) :
+template<typename FittingType, typename DistributionType>
+GMM<FittingType, DistributionType>::GMM(
+    const GMM<FittingType, DistributionType>& other) :
     gaussians(other.Gaussians()),
     dimensionality(other.dimensionality),
     dists(other.dists),
@@ -83,10 +86,11 @@ GMM<FittingType>::GMM(const GMM<FittingType>& other) :
     localFitter(other.fitter),
     fitter(localFitter) { /* Nothing to do. */ }
 
-template<typename FittingType>
+template<typename FittingType, typename DistributionType>
 template<typename OtherFittingType>
-GMM<FittingType>& GMM<FittingType>::operator=(
-    const GMM<OtherFittingType>& other)
+GMM<FittingType, DistributionType>&
+GMM<FittingType, DistributionType>::operator=(
+    const GMM<OtherFittingType, DistributionType>& other)
 {
   gaussians = other.gaussians;
   dimensionality = other.dimensionality;
@@ -96,8 +100,10 @@ GMM<FittingType>& GMM<FittingType>::operator=(
   return *this;
 }
 
-template<typename FittingType>
-GMM<FittingType>& GMM<FittingType>::operator=(const GMM<FittingType>& other)
+template<typename FittingType, typename DistributionType>
+GMM<FittingType, DistributionType>&
+GMM<FittingType, DistributionType>::operator=(
+    const GMM<FittingType, DistributionType>& other)
 {
   gaussians = other.gaussians;
   dimensionality = other.dimensionality;
@@ -109,8 +115,8 @@ GMM<FittingType>& GMM<FittingType>::operator=(const GMM<FittingType>& other)
 }
 
 // Load a GMM from file.
-template<typename FittingType>
-void GMM<FittingType>::Load(const std::string& filename)
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::Load(const std::string& filename)
 {
   util::SaveRestoreUtility load;
 
@@ -120,8 +126,8 @@ void GMM<FittingType>::Load(const std::string& filename)
 }
 
 // Save a GMM to a file.
-template<typename FittingType>
-void GMM<FittingType>::Save(const std::string& filename) const
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::Save(const std::string& filename) const
 {
   util::SaveRestoreUtility save;
   Save(save);
@@ -132,8 +138,9 @@ void GMM<FittingType>::Save(const std::string& filename) const
 
 
 // Save a GMM to a SaveRestoreUtility.
-template<typename FittingType>
-void GMM<FittingType>::Save(util::SaveRestoreUtility& sr) const
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::Save(
+    util::SaveRestoreUtility& sr) const
 {
   sr.SaveParameter(Type(), "type");
   sr.SaveParameter(gaussians, "gaussians");
@@ -155,8 +162,9 @@ void GMM<FittingType>::Save(util::SaveRestoreUtility& sr) const
 }
 
 // Load a GMM from SaveRestoreUtility.
-template<typename FittingType>
-void GMM<FittingType>::Load(const util::SaveRestoreUtility& sr)
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::Load(
+    const util::SaveRestoreUtility& sr)
 {
     sr.LoadParameter(gaussians, "gaussians");
     sr.LoadParameter(dimensionality, "dimensionality");
@@ -183,8 +191,9 @@ void GMM<FittingType>::Load(const util::SaveRestoreUtility& sr)
 /**
  * Return the probability of the given observation being from this GMM.
  */
-template<typename FittingType>
-double GMM<FittingType>::Probability(const arma::vec& observation) const
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::Probability(
+    const arma::vec& observation) const
 {
   // Sum the probability for each Gaussian in our mixture (and we have to
   // multiply by the prior for each Gaussian too).
@@ -199,21 +208,51 @@ double GMM<FittingType>::Probability(const arma::vec& observation) const
  * Return the probability of the given observation being from the given
  * component in the mixture.
  */
-template<typename FittingType>
-double GMM<FittingType>::Probability(const arma::vec& observation,
-                                     const size_t component) const
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::Probability(
+    const arma::vec& observation,
+    const size_t component) const
 {
   // We are only considering one Gaussian component -- so we only need to call
   // Probability() once.  We do consider the prior probability!
   return weights[component] * dists[component].Probability(observation);
 }
 
+/**
+ * Return the log probability of each of the given observations under this GMM.
+ */
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::LogProbability(
+    const arma::mat& observations,
+    arma::vec& logProbabilities) const
+{
+  const arma::vec logWeights = arma::log(weights);
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+
+  logProbabilities.set_size(observations.n_cols);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * blockSize;
+    const size_t count = std::min((size_t) blockSize,
+        (size_t) observations.n_cols - begin);
+
+    arma::mat logProbs;
+    BlockLogProbabilities(observations, dists, logWeights, begin, count,
+        logProbs);
+
+    for (size_t j = 0; j < count; ++j)
+      logProbabilities[begin + j] = LogSumExp(logProbs.unsafe_col(j));
+  }
+}
+
 /**
  * Return a randomly generated observation according to the probability
  * distribution defined by this object.
  */
-template<typename FittingType>
-arma::vec GMM<FittingType>::Random() const
+template<typename FittingType, typename DistributionType>
+arma::vec GMM<FittingType, DistributionType>::Random() const
 {
   // Determine which Gaussian it will be coming from.
   double gaussRand = math::Random();
@@ -230,17 +269,17 @@ arma::vec GMM<FittingType>::Random() const
     }
   }
 
-  return trans(chol(dists[gaussian].Covariance())) *
-      arma::randn<arma::vec>(dimensionality) + dists[gaussian].Mean();
+  return dists[gaussian].Random();
 }
 
 /**
  * Fit the GMM to the given observations.
  */
-template<typename FittingType>
-double GMM<FittingType>::Estimate(const arma::mat& observations,
-                                  const size_t trials,
-                                  const bool useExistingModel)
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::Estimate(
+    const arma::mat& observations,
+    const size_t trials,
+    const bool useExistingModel)
 {
   double bestLikelihood; // This will be reported later.
 
@@ -258,56 +297,8 @@ double GMM<FittingType>::Estimate(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
-    {
-      distsOrig = dists;
-      weightsOrig = weights;
-    }
-
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, dists, weights,
+    bestLikelihood = EstimateTrials(observations, arma::vec(), trials,
         useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
-
-    Log::Info << "GMM::Estimate(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
-    {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, distsTrial, weightsTrial, useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
-      Log::Info << "GMM::Estimate(): Log-likelihood of trial " << trial
-          << " is " << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
-    }
   }
 
   // Report final log-likelihood and return it.
@@ -320,11 +311,12 @@ double GMM<FittingType>::Estimate(const arma::mat& observations,
  * Fit the GMM to the given observations, each of which has a certain
  * probability of being from this distribution.
  */
-template<typename FittingType>
-double GMM<FittingType>::Estimate(const arma::mat& observations,
-                                  const arma::vec& probabilities,
-                                  const size_t trials,
-                                  const bool useExistingModel)
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::Estimate(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    const size_t trials,
+    const bool useExistingModel)
 {
   double bestLikelihood; // This will be reported later.
 
@@ -342,57 +334,8 @@ double GMM<FittingType>::Estimate(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
-    {
-      distsOrig = dists;
-      weightsOrig = weights;
-    }
-
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, probabilities, dists, weights,
+    bestLikelihood = EstimateTrials(observations, probabilities, trials,
         useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
-
-    Log::Debug << "GMM::Estimate(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
-    {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, distsTrial, weightsTrial,
-          useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
-      Log::Debug << "GMM::Estimate(): Log-likelihood of trial " << trial
-          << " is " << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
-    }
   }
 
   // Report final log-likelihood and return it.
@@ -405,27 +348,35 @@ double GMM<FittingType>::Estimate(const arma::mat& observations,
  * Classify the given observations as being from an individual component in this
  * GMM.
  */
-template<typename FittingType>
-void GMM<FittingType>::Classify(const arma::mat& observations,
-                                arma::Col<size_t>& labels) const
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::Classify(
+    const arma::mat& observations,
+    arma::Col<size_t>& labels) const
 {
-  // This is not the best way to do this!
+  // Working in log-space means that points far from every component are still
+  // assigned to the closest one.
+  const arma::vec logWeights = arma::log(weights);
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
 
-  // We should not have to fill this with values, because each one should be
-  // overwritten.
   labels.set_size(observations.n_cols);
-  for (size_t i = 0; i < observations.n_cols; ++i)
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t b = 0; b < numBlocks; ++b)
   {
+    const size_t begin = b * blockSize;
+    const size_t count = std::min((size_t) blockSize,
+        (size_t) observations.n_cols - begin);
+
+    arma::mat logProbs;
+    BlockLogProbabilities(observations, dists, logWeights, begin, count,
+        logProbs);
+
     // Find maximum probability component.
-    double probability = 0;
-    for (size_t j = 0; j < gaussians; ++j)
+    for (size_t j = 0; j < count; ++j)
     {
-      double newProb = Probability(observations.unsafe_col(i), j);
-      if (newProb >= probability)
-      {
-        probability = newProb;
-        labels[i] = j;
-      }
+      arma::uword label;
+      logProbs.unsafe_col(j).max(label);
+      labels[begin + j] = label;
     }
   }
 }
@@ -433,33 +384,189 @@ void GMM<FittingType>::Classify(const arma::mat& observations,
 /**
  * Get the log-likelihood of this data's fit to the model.
  */
-template<typename FittingType>
-double GMM<FittingType>::LogLikelihood(
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::LogLikelihood(
     const arma::mat& data,
-    const std::vector<distribution::GaussianDistribution>& distsL,
+    const std::vector<DistributionType>& distsL,
     const arma::vec& weightsL) const
 {
+  const arma::vec logWeights = arma::log(weightsL);
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+
   double loglikelihood = 0;
-  arma::vec phis;
-  arma::mat likelihoods(gaussians, data.n_cols);
 
-  for (size_t i = 0; i < gaussians; i++)
+  #pragma omp parallel for schedule(dynamic) reduction(+:loglikelihood)
+  for (size_t b = 0; b < numBlocks; ++b)
   {
-    distsL[i].Probability(data, phis);
-    likelihoods.row(i) = weightsL(i) * trans(phis);
+    const size_t begin = b * blockSize;
+    const size_t count = std::min((size_t) blockSize,
+        (size_t) data.n_cols - begin);
+
+    arma::mat logProbs;
+    BlockLogProbabilities(data, distsL, logWeights, begin, count, logProbs);
+
+    // Now sum over every point.
+    for (size_t j = 0; j < count; ++j)
+      loglikelihood += LogSumExp(logProbs.unsafe_col(j));
   }
 
-  // Now sum over every point.
-  for (size_t j = 0; j < data.n_cols; j++)
-    loglikelihood += log(accu(likelihoods.col(j)));
   return loglikelihood;
 }
 
+template<typename FittingType, typename DistributionType>
+void GMM<FittingType, DistributionType>::BlockLogProbabilities(
+    const arma::mat& observations,
+    const std::vector<DistributionType>& distsL,
+    const arma::vec& logWeights,
+    const size_t begin,
+    const size_t count,
+    arma::mat& logProbs)
+{
+  // An alias of the columns in this block; no data is copied.
+  const arma::mat block(const_cast<double*>(observations.colptr(begin)),
+      observations.n_rows, count, false, true);
+
+  // Each component is evaluated on the whole block at once, so a Gaussian's
+  // cached factorization is used for a single solve per block.
+  logProbs.set_size(distsL.size(), count);
+  arma::vec logPhis;
+  for (size_t i = 0; i < distsL.size(); ++i)
+  {
+    distsL[i].LogProbability(block, logPhis);
+    logProbs.row(i) = trans(logPhis) + logWeights[i];
+  }
+}
+
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::LogSumExp(const arma::vec& values)
+{
+  const double maxValue = values.max();
+  if (maxValue == -std::numeric_limits<double>::infinity())
+    return maxValue;
+
+  return maxValue + std::log(accu(arma::exp(values - maxValue)));
+}
+
+template<typename FittingType, typename DistributionType>
+double GMM<FittingType, DistributionType>::EstimateTrials(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    const size_t trials,
+    const bool useExistingModel)
+{
+  // Each trial fits its own model; if the existing model is used, every trial
+  // starts from it.
+  std::vector<std::vector<DistributionType> > trialDists(
+      trials, useExistingModel ? dists :
+      std::vector<DistributionType>(gaussians,
+          DistributionType(dimensionality)));
+  std::vector<arma::vec> trialWeights(trials, useExistingModel ? weights :
+      arma::vec(gaussians));
+  arma::vec likelihoods(trials);
+
+  FitTrials<FittingType>(observations, probabilities, trialDists, trialWeights,
+      likelihoods, useExistingModel);
+
+  // Keep the trial with the greatest log-likelihood (the first, on ties).
+  size_t bestTrial = 0;
+  for (size_t trial = 0; trial < trials; ++trial)
+  {
+    Log::Info << "GMM::Estimate(): Log-likelihood of trial " << trial
+        << " is " << likelihoods[trial] << "." << std::endl;
+
+    if (likelihoods[trial] > likelihoods[bestTrial])
+      bestTrial = trial;
+  }
+
+  dists = trialDists[bestTrial];
+  weights = trialWeights[bestTrial];
+  return likelihoods[bestTrial];
+}
+
+template<typename FittingType, typename DistributionType>
+template<typename F>
+void GMM<FittingType, DistributionType>::FitTrials(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<std::vector<DistributionType> >& trialDists,
+    std::vector<arma::vec>& trialWeights,
+    arma::vec& likelihoods,
+    const bool useExistingModel,
+    typename boost::enable_if<HasInitialClustering<F,
+        InitialClusteringType> >::type*)
+{
+  // Find the initial models one after another, since the clusterer uses the
+  // global random number generator.
+  if (!useExistingModel)
+    for (size_t trial = 0; trial < trialDists.size(); ++trial)
+      fitter.InitialClustering(observations, trialDists[trial],
+          trialWeights[trial]);
+
+  // The rest of the fitting is deterministic, so the trials can be fit in
+  // parallel, each with its own copy of the fitter.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t trial = 0; trial < trialDists.size(); ++trial)
+  {
+    F trialFitter(fitter);
+    if (probabilities.n_elem == 0)
+      trialFitter.Estimate(observations, trialDists[trial],
+          trialWeights[trial], true);
+    else
+      trialFitter.Estimate(observations, probabilities, trialDists[trial],
+          trialWeights[trial], true);
+
+    likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+        trialWeights[trial]);
+  }
+}
+
+template<typename FittingType, typename DistributionType>
+template<typename F>
+void GMM<FittingType, DistributionType>::FitTrials(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<std::vector<DistributionType> >& trialDists,
+    std::vector<arma::vec>& trialWeights,
+    arma::vec& likelihoods,
+    const bool useExistingModel,
+    typename boost::disable_if<HasInitialClustering<F,
+        InitialClusteringType> >::type*)
+{
+  for (size_t trial = 0; trial < trialDists.size(); ++trial)
+  {
+    if (probabilities.n_elem == 0)
+      fitter.Estimate(observations, trialDists[trial], trialWeights[trial],
+          useExistingModel);
+    else
+      fitter.Estimate(observations, probabilities, trialDists[trial],
+          trialWeights[trial], useExistingModel);
+
+    likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+        trialWeights[trial]);
+  }
+}
+
+template<typename FittingType, typename DistributionType>
+size_t GMM<FittingType, DistributionType>::MemoryUsage() const
+{
+  // The vector of Gaussians is counted like the other members, but its
+  // elements report their own size.
+  size_t usage = sizeof(*this) - sizeof(means) - sizeof(covariances) -
+      sizeof(weights) - sizeof(localFitter) + (dists.capacity() -
+      dists.size()) * sizeof(DistributionType) +
+      util::MemoryUsage(means) + util::MemoryUsage(covariances) +
+      util::MemoryUsage(weights) + util::ObjectMemoryUsage(localFitter);
+  for (size_t i = 0; i < dists.size(); ++i)
+    usage += dists[i].MemoryUsage();
+
+  return usage;
+}
+
 /**
 * Returns a string representation of this object.
 */
-template<typename FittingType>
-std::string GMM<FittingType>::ToString() const
+template<typename FittingType, typename DistributionType>
+std::string GMM<FittingType, DistributionType>::ToString() const
 {
   std::ostringstream convert;
   std::ostringstream data;
@@ -10,6 +10,11 @@
 #include "no_constraint.hpp"
 
 #include <mlpack/methods/kmeans/refined_start.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel.hpp>
+#include <mlpack/methods/kmeans/elkan_kmeans.hpp>
+#include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/blocked_kmeans.hpp>
+#include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
 
 using namespace mlpack;
 using namespace mlpack::gmm;
@@ -34,13 +39,27 @@ PROGRAM_INFO("Gaussian Mixture Model (GMM) Training",
     "iteration of the EM algorithm which ensure that the covariance matrices "
     "are positive definite.  Specifying the flag can cause faster runtime, "
     "but may also cause non-positive definite covariance matrices, which will "
-    "cause the program to crash.");
+    "cause the program to crash."
+    "\n\n"
+    "The EM algorithm is started from a k-means clustering.  The algorithm "
+    "used for each k-means iteration can be chosen with --kmeans_algorithm, "
+    "and the initial k-means centroids can be chosen with the subsampled "
+    "k-means|| seeding (--kmeans_parallel) or the refined start of Bradley and "
+    "Fayyad (--refined_start).  When several trials are performed, their "
+    "initial clusterings are found first and the trials are then fit in "
+    "parallel if OpenMP is available."
+    "\n\n"
+    "If --diagonal_covariance is specified, each Gaussian only has a variance "
+    "for each dimension instead of a full covariance matrix.  This takes "
+    "much less memory and time in high dimensions and with many Gaussians, "
+    "and never fails because of a non-invertible covariance; "
+    "--no_force_positive is ignored in that case.");
 
 PARAM_STRING_REQ("input_file", "File containing the data on which the model "
     "will be fit.", "i");
 PARAM_INT("gaussians", "Number of Gaussians in the GMM.", "g", 1);
 PARAM_STRING("output_file", "The file to write the trained GMM parameters into "
-    "(as XML).", "o", "gmm.xml");
+    "(as XML, or in binary if the name ends in '.bin').", "o", "gmm.xml");
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 PARAM_INT("trials", "Number of trials to perform in training GMM.", "t", 10);
 
@@ -50,6 +69,8 @@ PARAM_FLAG("no_force_positive", "Do not force the covariance matrices to be "
     "positive definite.", "P");
 PARAM_INT("max_iterations", "Maximum number of iterations of EM algorithm "
     "(passing 0 will run until convergence).", "n", 250);
+PARAM_FLAG("diagonal_covariance", "Fit Gaussians with diagonal covariance "
+    "matrices.", "D");
 
 // Parameters for dataset modification.
 PARAM_DOUBLE("noise", "Variance of zero-mean Gaussian noise to add to data.",
@@ -63,6 +84,23 @@ PARAM_INT("samplings", "If using --refined_start, specify the number of "
 PARAM_DOUBLE("percentage", "If using --refined_start, specify the percentage of"
     " the dataset used for each sampling (should be between 0.0 and 1.0).",
     "p", 0.02);
+PARAM_FLAG("kmeans_parallel", "During the initialization, use the k-means|| "
+    "seeding (Bahmani et al., 2012) to choose initial points for k-means "
+    "clustering.", "K");
+PARAM_STRING("kmeans_algorithm", "Algorithm to use for the k-means iterations "
+    "of the initialization ('naive', 'blocked', 'elkan', 'hamerly', or "
+    "'dualtree').", "a", "naive");
+
+// Given the initial partition policy, figure out the k-means step type and
+// train the GMM.
+template<typename InitialPartitionPolicy>
+double FindLloydStepType(const arma::mat& dataPoints,
+                         const InitialPartitionPolicy& ipp);
+
+// Given the k-means type, figure out the covariance constraint, then train and
+// save the GMM.
+template<typename KMeansType>
+double RunGMM(const arma::mat& dataPoints, const KMeansType& k);
 
 int main(int argc, char* argv[])
 {
@@ -96,13 +134,7 @@ int main(int argc, char* argv[])
     Timer::Stop("noise_addition");
   }
 
-  // Gather parameters for EMFit object.
-  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
-  const double tolerance = CLI::GetParam<double>("tolerance");
-  const bool forcePositive = !CLI::HasParam("no_force_positive");
-
-  // This gets a bit weird because we need different types depending on whether
-  // --refined_start is specified.
+  // Now figure out the k-means types to use for the initialization.
   double likelihood;
   if (CLI::HasParam("refined_start"))
   {
@@ -117,80 +149,122 @@ int main(int argc, char* argv[])
       Log::Fatal << "Percentage for sampling (" << percentage << ") must be "
           << "greater than 0.0 and less than or equal to 1.0!" << std::endl;
 
-    typedef KMeans<metric::SquaredEuclideanDistance, RefinedStart> KMeansType;
+    likelihood = FindLloydStepType(dataPoints, RefinedStart(samplings,
+        percentage));
+  }
+  else if (CLI::HasParam("kmeans_parallel"))
+  {
+    likelihood = FindLloydStepType(dataPoints, KMeansParallel());
+  }
+  else
+  {
+    likelihood = FindLloydStepType(dataPoints, RandomPartition());
+  }
+
+  Log::Info << "Log-likelihood of estimate: " << likelihood << ".\n";
+}
+
+template<typename InitialPartitionPolicy>
+double FindLloydStepType(const arma::mat& dataPoints,
+                         const InitialPartitionPolicy& ipp)
+{
+  const string algorithm = CLI::GetParam<string>("kmeans_algorithm");
+  const metric::EuclideanDistance metric;
+
+  if (algorithm == "naive")
+  {
+    return RunGMM(dataPoints, KMeans<metric::EuclideanDistance,
+        InitialPartitionPolicy>(1000, metric, ipp));
+  }
+  else if (algorithm == "blocked")
+  {
+    return RunGMM(dataPoints, KMeans<metric::EuclideanDistance,
+        InitialPartitionPolicy, MaxVarianceNewCluster, BlockedKMeans>(1000,
+        metric, ipp));
+  }
+  else if (algorithm == "elkan")
+  {
+    return RunGMM(dataPoints, KMeans<metric::EuclideanDistance,
+        InitialPartitionPolicy, MaxVarianceNewCluster, ElkanKMeans>(1000,
+        metric, ipp));
+  }
+  else if (algorithm == "hamerly")
+  {
+    return RunGMM(dataPoints, KMeans<metric::EuclideanDistance,
+        InitialPartitionPolicy, MaxVarianceNewCluster, HamerlyKMeans>(1000,
+        metric, ipp));
+  }
+  else if (algorithm == "dualtree")
+  {
+    return RunGMM(dataPoints, KMeans<metric::EuclideanDistance,
+        InitialPartitionPolicy, MaxVarianceNewCluster, DefaultDualTreeKMeans>(
+        1000, metric, ipp));
+  }
+
+  Log::Fatal << "Unknown k-means algorithm: '" << algorithm << "'.  Supported "
+      << "options are 'naive', 'blocked', 'elkan', 'hamerly', and 'dualtree'."
+      << endl;
+  return 0.0;
+}
 
-    // These are default parameters.
-    KMeansType k(1000, metric::SquaredEuclideanDistance(),
-        RefinedStart(samplings, percentage));
+template<typename KMeansType>
+double RunGMM(const arma::mat& dataPoints, const KMeansType& k)
+{
+  // Gather parameters for EMFit object.
+  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  const size_t gaussians = (size_t) CLI::GetParam<int>("gaussians");
 
-    // Depending on the value of 'forcePositive', we have to use different
-    // types.
-    if (forcePositive)
-    {
-      EMFit<KMeansType> em(maxIterations, tolerance, k);
+  // Depending on the values of 'diagonal_covariance' and 'no_force_positive',
+  // we have to use different types.
+  double likelihood;
+  if (CLI::HasParam("diagonal_covariance"))
+  {
+    EMFit<KMeansType> em(maxIterations, tolerance, k);
 
-      GMM<EMFit<KMeansType> > gmm(size_t(gaussians), dataPoints.n_rows, em);
+    GMM<EMFit<KMeansType>, distribution::DiagonalGaussianDistribution> gmm(
+        gaussians, dataPoints.n_rows, em);
 
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
-      likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
-      Timer::Stop("em");
+    // Compute the parameters of the model using the EM algorithm.
+    Timer::Start("em");
+    likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
+    Timer::Stop("em");
+    Log::Info << "Model uses " << gmm.MemoryUsage() << " bytes." << endl;
 
-      // Save results.
-      gmm.Save(CLI::GetParam<string>("output_file"));
-    }
-    else
-    {
-      EMFit<KMeansType, NoConstraint> em(maxIterations, tolerance, k);
+    // Save results.
+    gmm.Save(CLI::GetParam<string>("output_file"));
+  }
+  else if (!CLI::HasParam("no_force_positive"))
+  {
+    EMFit<KMeansType> em(maxIterations, tolerance, k);
 
-      GMM<EMFit<KMeansType, NoConstraint> > gmm(size_t(gaussians),
-          dataPoints.n_rows, em);
+    GMM<EMFit<KMeansType> > gmm(gaussians, dataPoints.n_rows, em);
 
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
-      likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
-      Timer::Stop("em");
+    // Compute the parameters of the model using the EM algorithm.
+    Timer::Start("em");
+    likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
+    Timer::Stop("em");
+    Log::Info << "Model uses " << gmm.MemoryUsage() << " bytes." << endl;
 
-      // Save results.
-      gmm.Save(CLI::GetParam<string>("output_file"));
-    }
+    // Save results.
+    gmm.Save(CLI::GetParam<string>("output_file"));
   }
   else
   {
-    // Depending on the value of forcePositive, we have to use different types.
-    if (forcePositive)
-    {
-      EMFit<> em(maxIterations, tolerance);
-
-      // Calculate mixture of Gaussians.
-      GMM<> gmm(size_t(gaussians), dataPoints.n_rows, em);
-
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
-      likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
-      Timer::Stop("em");
-
-      // Save results.
-      gmm.Save(CLI::GetParam<string>("output_file"));
-    }
-    else
-    {
-      // Use no constraints on the covariance matrix.
-      EMFit<KMeans<>, NoConstraint> em(maxIterations, tolerance);
-
-      // Calculate mixture of Gaussians.
-      GMM<EMFit<KMeans<>, NoConstraint> > gmm(size_t(gaussians),
-          dataPoints.n_rows, em);
-
-      // Compute the parameters of the model using the EM algorithm.
-      Timer::Start("em");
-      likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
-      Timer::Stop("em");
-
-      // Save results.
-      gmm.Save(CLI::GetParam<string>("output_file"));
-    }
+    EMFit<KMeansType, NoConstraint> em(maxIterations, tolerance, k);
+
+    GMM<EMFit<KMeansType, NoConstraint> > gmm(gaussians, dataPoints.n_rows,
+        em);
+
+    // Compute the parameters of the model using the EM algorithm.
+    Timer::Start("em");
+    likelihood = gmm.Estimate(dataPoints, CLI::GetParam<int>("trials"));
+    Timer::Stop("em");
+    Log::Info << "Model uses " << gmm.MemoryUsage() << " bytes." << endl;
+
+    // Save results.
+    gmm.Save(CLI::GetParam<string>("output_file"));
   }
 
-  Log::Info << "Log-likelihood of estimate: " << likelihood << ".\n";
+  return likelihood;
 }
@@ -0,0 +1,228 @@
+/**
+ * @file online_em_fit.hpp
+ * @author Ryan Curtin
+ *
+ * Utility class to fit a GMM incrementally, from mini-batches of observations,
+ * with the stepwise online EM algorithm.  Used by GMM::Estimate<>().
+ */
+#ifndef __MLPACK_METHODS_GMM_ONLINE_EM_FIT_HPP
+#define __MLPACK_METHODS_GMM_ONLINE_EM_FIT_HPP
+
+#include <mlpack/core.hpp>
+
+// The initial clustering is the same as for batch EM.
+#include "em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * This class fits a GMM to observations with the stepwise online EM algorithm
+ * of Cappé and Moulines (2009), and can be used as the FittingType of the GMM
+ * class.  Instead of iterating over the whole dataset, the observations are
+ * split into mini-batches; the E-step of each mini-batch gives its sufficient
+ * statistics (the sums of the responsibilities, of the responsibility-weighted
+ * points, and of their outer products), which are blended into running
+ * statistics with a step size that decays as (t + 2)^(-decay) after t updates.
+ * The M-step then recovers the weights, means, and covariances from the running
+ * statistics.
+ *
+ * The running statistics are kept in the fitter between calls, so a model can
+ * be updated as new data arrives without keeping any of the old observations:
+ * only O(k d^2) memory is used for k Gaussians in d dimensions.  When the
+ * initial model is used, GMM::Estimate() passes each new batch straight to the
+ * fitter, so the data can be streamed with data::ChunkedLoader:
+ *
+ * @code
+ * OnlineEMFit<> fitter;
+ * GMM<OnlineEMFit<> > gmm(5, dimensionality, fitter);
+ *
+ * data::ChunkedLoader<double> loader("stream.csv", true);
+ * arma::mat chunk;
+ * loader.NextChunk(chunk, 10000);
+ * gmm.Estimate(chunk); // The first chunk gives the initial clustering.
+ * while (loader.NextChunk(chunk, 10000))
+ *   gmm.Estimate(chunk, 1, true); // Every other chunk updates the model.
+ * @endcode
+ *
+ * If the model is changed outside of the fitter, Reset() should be called, so
+ * that the running statistics are taken from the new model.
+ *
+ * The initial clustering is performed like in EMFit, with the given
+ * InitialClusteringType, and the covariances are constrained with the
+ * CovarianceConstraintPolicy after every M-step.
+ */
+template<typename InitialClusteringType = kmeans::KMeans<>,
+         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
+class OnlineEMFit
+{
+ public:
+  /**
+   * Construct the OnlineEMFit object, optionally passing an
+   * InitialClusteringType object (just in case it needs to store state).
+   *
+   * @param batchSize Number of observations in each mini-batch.
+   * @param passes Number of passes over the observations given to Estimate().
+   * @param decay Decay exponent of the step size; it should be in (0.5, 1].
+   *     Smaller values forget old observations faster.
+   * @param clusterer Object which will perform the initial clustering.
+   * @param constraint Object which applies constraints to the covariances.
+   */
+  OnlineEMFit(const size_t batchSize = 1000,
+              const size_t passes = 1,
+              const double decay = 0.6,
+              InitialClusteringType clusterer = InitialClusteringType(),
+              CovarianceConstraintPolicy constraint =
+                  CovarianceConstraintPolicy());
+
+  /**
+   * Update the given Gaussian mixture model (GMM) with the given observations,
+   * using stepwise online EM.  The size of the vectors (indicating the number
+   * of components) must already be set.  If useInitialModel is false, the
+   * running statistics are discarded and the initial model is found with
+   * InitialClustering() on the given observations; otherwise the given model is
+   * updated.
+   *
+   * @param observations List of observations to train on.
+   * @param dists Vector of the Gaussians of the model.
+   * @param weights Vector of the a priori weights of the model.
+   * @param useInitialModel If true, the given model is updated, instead of
+   *      starting from the initial clustering.
+   */
+  void Estimate(const arma::mat& observations,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Update the given Gaussian mixture model (GMM) with the given observations,
+   * each of which has a certain probability of being from the model, using
+   * stepwise online EM.  See the other overload of Estimate() for details.
+   *
+   * @param observations List of observations to train on.
+   * @param probabilities Probability of each point being from this model.
+   * @param dists Vector of the Gaussians of the model.
+   * @param weights Vector of the a priori weights of the model.
+   * @param useInitialModel If true, the given model is updated, instead of
+   *      starting from the initial clustering.
+   */
+  void Estimate(const arma::mat& observations,
+                const arma::vec& probabilities,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Run the clusterer, and then turn the cluster assignments into Gaussians,
+   * exactly like EMFit::InitialClustering().  This also discards the running
+   * statistics.
+   *
+   * @param observations List of observations.
+   * @param dists Vector to store the initial Gaussians in.
+   * @param weights Vector to store a priori weights in.
+   */
+  void InitialClustering(const arma::mat& observations,
+                         std::vector<distribution::GaussianDistribution>& dists,
+                         arma::vec& weights);
+
+  /**
+   * Discard the running statistics, so that the next update starts from the
+   * model it is given.
+   */
+  void Reset();
+
+  //! Get the clusterer.
+  const InitialClusteringType& Clusterer() const { return clusterer; }
+  //! Modify the clusterer.
+  InitialClusteringType& Clusterer() { return clusterer; }
+
+  //! Get the covariance constraint policy class.
+  const CovarianceConstraintPolicy& Constraint() const { return constraint; }
+  //! Modify the covariance constraint policy class.
+  CovarianceConstraintPolicy& Constraint() { return constraint; }
+
+  //! Get the number of observations in each mini-batch.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of observations in each mini-batch.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of passes over the observations.
+  size_t Passes() const { return passes; }
+  //! Modify the number of passes over the observations.
+  size_t& Passes() { return passes; }
+
+  //! Get the decay exponent of the step size.
+  double Decay() const { return decay; }
+  //! Modify the decay exponent of the step size.
+  double& Decay() { return decay; }
+
+  //! Get the number of mini-batch updates since the last reset.
+  size_t Updates() const { return updates; }
+
+ private:
+  /**
+   * Initialize the running statistics from the given model, as if it had been
+   * fit to observations drawn from itself.
+   *
+   * @param dists Gaussians of the model.
+   * @param weights Weights of the model.
+   */
+  void InitializeStatistics(
+      const std::vector<distribution::GaussianDistribution>& dists,
+      const arma::vec& weights);
+
+  /**
+   * Perform one stepwise EM update with the given mini-batch: compute its
+   * responsibilities with the current model, blend its sufficient statistics
+   * into the running statistics, and refit the model.  If probabilities is
+   * not empty, each responsibility is weighted by the probability of the
+   * point.
+   *
+   * @param batch Observations of the mini-batch.
+   * @param probabilities Probability of each observation (or empty).
+   * @param dists Gaussians of the model.
+   * @param weights Weights of the model.
+   */
+  void Update(const arma::mat& batch,
+              const arma::vec& probabilities,
+              std::vector<distribution::GaussianDistribution>& dists,
+              arma::vec& weights);
+
+  //! Run every pass over the observations, in mini-batches.
+  void EstimateBatches(const arma::mat& observations,
+                       const arma::vec& probabilities,
+                       std::vector<distribution::GaussianDistribution>& dists,
+                       arma::vec& weights,
+                       const bool useInitialModel);
+
+  //! Number of observations in each mini-batch.
+  size_t batchSize;
+  //! Number of passes over the observations.
+  size_t passes;
+  //! Decay exponent of the step size.
+  double decay;
+  //! Object which will perform the clustering.
+  InitialClusteringType clusterer;
+  //! Object which applies constraints to the covariance matrix.
+  CovarianceConstraintPolicy constraint;
+
+  //! Number of updates since the last reset.
+  size_t updates;
+  //! Running sums of the responsibilities of each Gaussian (empty when the
+  //! statistics have been reset).
+  arma::vec sumResponsibilities;
+  //! Running responsibility-weighted sums of the points, one column for each
+  //! Gaussian.
+  arma::mat sumPoints;
+  //! Running responsibility-weighted sums of the outer products of the points,
+  //! one slice for each Gaussian.
+  arma::cube sumOuterProducts;
+};
+
+}; // namespace gmm
+}; // namespace mlpack
+
+// Include implementation.
+#include "online_em_fit_impl.hpp"
+
+#endif
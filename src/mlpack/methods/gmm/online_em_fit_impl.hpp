@@ -0,0 +1,232 @@
+/**
+ * @file online_em_fit_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of stepwise online EM for fitting GMMs.
+ */
+#ifndef __MLPACK_METHODS_GMM_ONLINE_EM_FIT_IMPL_HPP
+#define __MLPACK_METHODS_GMM_ONLINE_EM_FIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "online_em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+//! Constructor.
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::OnlineEMFit(
+    const size_t batchSize,
+    const size_t passes,
+    const double decay,
+    InitialClusteringType clusterer,
+    CovarianceConstraintPolicy constraint) :
+    batchSize(batchSize),
+    passes(passes),
+    decay(decay),
+    clusterer(clusterer),
+    constraint(constraint),
+    updates(0)
+{
+  if (batchSize == 0)
+    Log::Fatal << "OnlineEMFit::OnlineEMFit(): batch size must be positive."
+        << std::endl;
+  if (decay <= 0.5 || decay > 1.0)
+    Log::Warn << "OnlineEMFit::OnlineEMFit(): decay should be in (0.5, 1]; "
+        << "the model may not converge." << std::endl;
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
+    const arma::mat& observations,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  EstimateBatches(observations, arma::vec(), dists, weights, useInitialModel);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  if (probabilities.n_elem != observations.n_cols)
+    Log::Fatal << "OnlineEMFit::Estimate(): " << probabilities.n_elem
+        << " probabilities given for " << observations.n_cols
+        << " observations!" << std::endl;
+
+  EstimateBatches(observations, probabilities, dists, weights,
+      useInitialModel);
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+InitialClustering(const arma::mat& observations,
+                  std::vector<distribution::GaussianDistribution>& dists,
+                  arma::vec& weights)
+{
+  // The initial model is found exactly as for batch EM.
+  EMFit<InitialClusteringType, CovarianceConstraintPolicy> em(0, 0.0,
+      clusterer, constraint);
+  em.InitialClustering(observations, dists, weights);
+
+  Reset();
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Reset()
+{
+  updates = 0;
+  sumResponsibilities.reset();
+  sumPoints.reset();
+  sumOuterProducts.reset();
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+InitializeStatistics(
+    const std::vector<distribution::GaussianDistribution>& dists,
+    const arma::vec& weights)
+{
+  // The statistics are averages over the observations, so those of a model are
+  // its weights, the weighted means, and the weighted second moments.
+  const size_t dimensionality = dists.empty() ? 0 : dists[0].Mean().n_elem;
+  sumResponsibilities = weights;
+  sumPoints.set_size(dimensionality, dists.size());
+  sumOuterProducts.set_size(dimensionality, dimensionality, dists.size());
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    const arma::vec& mean = dists[i].Mean();
+    sumPoints.col(i) = weights[i] * mean;
+    sumOuterProducts.slice(i) = weights[i] * (dists[i].Covariance() +
+        mean * mean.t());
+  }
+
+  updates = 0;
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+EstimateBatches(const arma::mat& observations,
+                const arma::vec& probabilities,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel)
+{
+  if (!useInitialModel)
+    InitialClustering(observations, dists, weights);
+
+  // Take the statistics from the model if there are none yet (or if they can't
+  // belong to this model).
+  if ((sumResponsibilities.n_elem != dists.size()) ||
+      (sumPoints.n_rows != observations.n_rows))
+    InitializeStatistics(dists, weights);
+
+  for (size_t pass = 0; pass < passes; ++pass)
+  {
+    for (size_t begin = 0; begin < observations.n_cols; begin += batchSize)
+    {
+      const size_t count = std::min(batchSize,
+          (size_t) observations.n_cols - begin);
+
+      // Aliases of the mini-batch; no data is copied.
+      const arma::mat batch(const_cast<double*>(observations.colptr(begin)),
+          observations.n_rows, count, false, true);
+      const arma::vec batchProbabilities = (probabilities.n_elem == 0) ?
+          arma::vec() : arma::vec(const_cast<double*>(
+          probabilities.memptr() + begin), count, false, true);
+
+      Update(batch, batchProbabilities, dists, weights);
+    }
+
+    Log::Info << "OnlineEMFit::Estimate(): pass " << pass << " done, "
+        << updates << " updates so far." << std::endl;
+  }
+}
+
+template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+void OnlineEMFit<InitialClusteringType, CovarianceConstraintPolicy>::Update(
+    const arma::mat& batch,
+    const arma::vec& probabilities,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  // E-step: the responsibilities of each Gaussian for each point, normalized in
+  // log-space so that points far from every Gaussian do not underflow.
+  arma::mat responsibilities(dists.size(), batch.n_cols);
+  arma::vec logPhis;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    dists[i].LogProbability(batch, logPhis);
+    responsibilities.row(i) = trans(logPhis) + std::log(weights[i]);
+  }
+
+  for (size_t j = 0; j < batch.n_cols; ++j)
+  {
+    arma::vec column = responsibilities.unsafe_col(j);
+    const double maxLogProb = column.max();
+    if (maxLogProb == -std::numeric_limits<double>::infinity())
+    {
+      column.zeros();
+      continue;
+    }
+
+    column = arma::exp(column - maxLogProb);
+    column /= accu(column);
+  }
+
+  double total = batch.n_cols;
+  if (probabilities.n_elem != 0)
+  {
+    responsibilities.each_row() %= trans(probabilities);
+    total = accu(probabilities);
+  }
+
+  // Nothing in this batch belongs to the model.
+  if (total == 0.0)
+    return;
+
+  // Blend the average statistics of the batch into the running statistics.
+  const double step = std::pow((double) updates + 2.0, -decay);
+  ++updates;
+
+  sumResponsibilities = (1.0 - step) * sumResponsibilities +
+      (step / total) * arma::sum(responsibilities, 1);
+  sumPoints = (1.0 - step) * sumPoints +
+      (step / total) * batch * trans(responsibilities);
+
+  // M-step: refit each Gaussian from its running statistics.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    arma::mat weightedBatch = batch;
+    weightedBatch.each_row() %= responsibilities.row(i);
+    sumOuterProducts.slice(i) = (1.0 - step) * sumOuterProducts.slice(i) +
+        (step / total) * weightedBatch * trans(batch);
+
+    // Don't update if there's no probability of the Gaussian having points.
+    if (sumResponsibilities[i] == 0.0)
+      continue;
+
+    arma::vec mean = sumPoints.col(i) / sumResponsibilities[i];
+    arma::mat covariance = sumOuterProducts.slice(i) / sumResponsibilities[i] -
+        mean * trans(mean);
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covariance);
+
+    dists[i].Mean() = std::move(mean);
+    dists[i].Covariance(std::move(covariance));
+  }
+
+  weights = sumResponsibilities / accu(sumResponsibilities);
+}
+
+}; // namespace gmm
+}; // namespace mlpack
+
+#endif
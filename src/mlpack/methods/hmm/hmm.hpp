@@ -10,6 +10,7 @@
 #define __MLPACK_METHODS_HMM_HMM_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 namespace mlpack {
 namespace hmm /** Hidden Markov Models. */ {
@@ -50,6 +51,12 @@ namespace hmm /** Hidden Markov Models. */ {
  * Gaussians (GMM), or any other probability distribution implementing the
  * four Distribution functions.
  *
+ * If the distribution also provides a batch
+ * LogProbability(const arma::mat&, arma::vec&) const (as all the distributions
+ * in mlpack::distribution do), the emission probabilities of a sequence are
+ * computed with one call per state instead of one call per observation and
+ * state.
+ *
  * Usage of the HMM class generally involves either training an HMM or loading
  * an already-known HMM and taking probability measurements of sequences.
  * Example code for supervised training of a Gaussian HMM (that is, where the
@@ -245,13 +252,37 @@ class HMM
    * sequence, using the Viterbi algorithm, returning the log-likelihood of the
    * most likely state sequence.
    *
+   * Optionally, a beam width can be given; at each time step, only the states
+   * whose log-probability is within beamWidth of the best state's are carried
+   * forward, which makes decoding with many states much faster but may miss
+   * the most probable sequence.  By default, no states are pruned.
+   *
    * @param dataSeq Sequence of observations.
    * @param stateSeq Vector in which the most probable state sequence will be
    *    stored.
+   * @param beamWidth Log-probability beam width for pruning states.
    * @return Log-likelihood of most probable state sequence.
    */
   double Predict(const arma::mat& dataSeq,
-                 arma::Col<size_t>& stateSeq) const;
+                 arma::Col<size_t>& stateSeq,
+                 const double beamWidth = DBL_MAX) const;
+
+  /**
+   * Compute the most probable hidden state sequence for each of the given data
+   * sequences, using the Viterbi algorithm.  The sequences are decoded in
+   * parallel when OpenMP is available.
+   *
+   * @param dataSeq Sequences of observations.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    data sequence will be stored.
+   * @param logLikelihoods Vector in which the log-likelihood of the most
+   *    probable state sequence of each data sequence will be stored.
+   * @param beamWidth Log-probability beam width for pruning states.
+   */
+  void Predict(const std::vector<arma::mat>& dataSeq,
+               std::vector<arma::Col<size_t> >& stateSeq,
+               arma::vec& logLikelihoods,
+               const double beamWidth = DBL_MAX) const;
 
   /**
    * Compute the log-likelihood of the given data sequence.
@@ -261,6 +292,18 @@ class HMM
    */
   double LogLikelihood(const arma::mat& dataSeq) const;
 
+  /**
+   * Compute the log-likelihood of each of the given data sequences.  The
+   * sequences are independent, so they are scored in parallel when OpenMP is
+   * available.
+   *
+   * @param dataSeq Data sequences to evaluate the likelihood of.
+   * @param logLikelihoods Vector in which the log-likelihood of each sequence
+   *    will be stored.
+   */
+  void LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                     arma::vec& logLikelihoods) const;
+
   /**
    * HMM filtering. Computes the k-step-ahead expected emission at each time
    * conditioned only on prior observations. That is
@@ -362,6 +405,50 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the emission probability of every observation in the given data
+   * sequence for every state.  The returned matrix has rows equal to the number
+   * of hidden states and columns equal to the number of observations.  Each
+   * column is divided by its largest entry, whose log is stored in logShifts,
+   * so that observations with a tiny density in every state (as is common for
+   * high-dimensional emissions) do not underflow.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionProb Matrix in which the shifted emission probabilities
+   *    will be saved.
+   * @param logShifts Vector in which the log of the shift of each column will
+   *    be saved.
+   */
+  void EmissionProbability(const arma::mat& dataSeq,
+                           arma::mat& emissionProb,
+                           arma::vec& logShifts) const;
+
+  /**
+   * The Forward algorithm, given the shifted emission probabilities computed
+   * by EmissionProbability().  The scaling factors are relative to the shifted
+   * emission probabilities, so the log-likelihood of the sequence is
+   * accu(log(scales)) + accu(logShifts).
+   *
+   * @param emissionProb Shifted emission probabilities.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ScaledForward(const arma::mat& emissionProb,
+                     arma::vec& scales,
+                     arma::mat& forwardProb) const;
+
+  /**
+   * The Backward algorithm, given the shifted emission probabilities computed
+   * by EmissionProbability() and the scaling factors found by ScaledForward().
+   *
+   * @param emissionProb Shifted emission probabilities.
+   * @param scales Vector of scaling factors from ScaledForward().
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void ScaledBackward(const arma::mat& emissionProb,
+                      const arma::vec& scales,
+                      arma::mat& backwardProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
@@ -369,6 +456,55 @@ class HMM
   arma::mat transition;
 
  private:
+  HAS_MEM_FUNC(LogProbability, HasBatchLogProbability)
+
+  //! The signature of a batch LogProbability() function.
+  typedef void (Distribution::*BatchLogProbabilityType)(const arma::mat&,
+      arma::vec&) const;
+
+  HAS_MEM_FUNC(LogProbability, HasStateLogProbability)
+
+  //! The signature of a static LogProbability() function, which computes the
+  //! log-probabilities of a whole sequence for all states at once.
+  typedef void (*StateLogProbabilityType)(const std::vector<Distribution>&,
+      const arma::mat&, arma::mat&);
+
+  //! Compute the emission log-probabilities of a whole sequence for all states
+  //! with one static LogProbability() call.
+  template<typename D>
+  void EmissionLogProbability(const std::vector<D>& dists,
+                              const arma::mat& dataSeq,
+                              arma::mat& logProb,
+                              typename boost::enable_if<HasStateLogProbability<
+                                  D, StateLogProbabilityType> >::type* = 0)
+      const;
+
+  //! Compute the emission log-probabilities of a whole sequence with one batch
+  //! LogProbability() call per state.
+  template<typename D>
+  void EmissionLogProbability(const std::vector<D>& dists,
+                              const arma::mat& dataSeq,
+                              arma::mat& logProb,
+                              typename boost::enable_if_c<
+                                  HasBatchLogProbability<D,
+                                  BatchLogProbabilityType>::value &&
+                                  !HasStateLogProbability<D,
+                                  StateLogProbabilityType>::value>::type* = 0)
+      const;
+
+  //! Compute the emission log-probabilities of a whole sequence one
+  //! observation at a time.
+  template<typename D>
+  void EmissionLogProbability(const std::vector<D>& dists,
+                              const arma::mat& dataSeq,
+                              arma::mat& logProb,
+                              typename boost::enable_if_c<
+                                  !HasBatchLogProbability<D,
+                                  BatchLogProbabilityType>::value &&
+                                  !HasStateLogProbability<D,
+                                  StateLogProbabilityType>::value>::type* = 0)
+      const;
+
   //! Initial state probability vector.
   arma::vec initial;
 
@@ -12,6 +12,10 @@
 // Just in case...
 #include "hmm.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace hmm {
 
@@ -94,10 +98,22 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The observations
+  // never change, so the list of them is only assembled once; each sequence
+  // owns a contiguous range of it, starting at its offset.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  std::vector<size_t> offsets(dataSeq.size());
+  size_t sumTime = 0;
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    offsets[seq] = sumTime;
+    if (dataSeq[seq].n_cols > 0)
+      emissionList.cols(sumTime, sumTime + dataSeq[seq].n_cols - 1) =
+          dataSeq[seq];
+    sumTime += dataSeq[seq].n_cols;
+  }
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
@@ -113,48 +129,67 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
     // Reset log likelihood.
     loglik = 0;
 
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // Each sequence is independent given the current model, so the sequences
+    // are processed in parallel, with each thread accumulating its own
+    // contribution to the new initial and transition estimates.
+    #pragma omp parallel reduction(+:loglik)
     {
+      arma::vec threadInitial(transition.n_rows);
+      threadInitial.zeros();
+      arma::mat threadTransition(transition.n_rows, transition.n_cols);
+      threadTransition.zeros();
+
       arma::mat stateProb;
       arma::mat forward;
       arma::mat backward;
+      arma::mat emissions;
       arma::vec scales;
+      arma::vec logShifts;
 
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; t++)
+      #pragma omp for schedule(dynamic)
+      for (size_t seq = 0; seq < dataSeq.size(); seq++)
       {
-        for (size_t j = 0; j < transition.n_cols; j++)
+        const size_t length = dataSeq[seq].n_cols;
+
+        // Add the log-likelihood of this sequence.  This is the E-step.
+        EmissionProbability(dataSeq[seq], emissions, logShifts);
+        ScaledForward(emissions, scales, forward);
+        ScaledBackward(emissions, scales, backward);
+        stateProb = forward % backward;
+        loglik += accu(log(scales)) + accu(logShifts);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.
+        threadInitial += stateProb.col(0);
+
+        if (length > 1)
         {
-          // Add to estimate of initial probability for state j.
-          newInitial[j] = stateProb(j, 0);
-
-          if (t < dataSeq[seq].n_cols - 1)
-          {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
-          }
-
-          // Add to list of emission observations, for Distribution::Estimate().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          // Estimate of T_ij (probability of transition from state j to state
+          // i), summed over all time steps with one matrix product.  We
+          // postpone multiplication of the old T_ij until later.  The shifts of
+          // the emission probabilities and the scales cancel here.
+          arma::mat next = backward.cols(1, length - 1) %
+              emissions.cols(1, length - 1);
+          next.each_row() /= trans(scales.subvec(1, length - 1));
+          threadTransition += next * trans(forward.cols(0, length - 2));
         }
-        sumTime++;
+
+        // Store the probability of each observation being from each state,
+        // for Distribution::Estimate().
+        for (size_t j = 0; j < transition.n_cols; j++)
+          emissionProb[j].subvec(offsets[seq], offsets[seq] + length - 1) =
+              trans(stateProb.row(j));
+      }
+
+      #pragma omp critical(hmm_train_reduce)
+      {
+        newInitial += threadInitial;
+        newTransition += threadTransition;
       }
     }
 
@@ -286,16 +321,27 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
                                    arma::mat& backwardProb,
                                    arma::vec& scales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  // First run the forward-backward algorithm, computing the emission
+  // probabilities only once for both passes.
+  arma::mat emissionProb;
+  arma::vec logShifts;
+  EmissionProbability(dataSeq, emissionProb, logShifts);
+  ScaledForward(emissionProb, scales, forwardProb);
+  ScaledBackward(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
   stateProb = forwardProb % backwardProb;
 
-  // Finally assemble the log-likelihood and return it.
-  return accu(log(scales));
+  // Assemble the log-likelihood in log-space, so that it does not depend on
+  // the shifted-out magnitudes of the emission probabilities.
+  const double logLikelihood = accu(log(scales)) + accu(logShifts);
+
+  // Finally, return the scaling factors of the unshifted emission
+  // probabilities.
+  scales %= arma::exp(logShifts);
+
+  return logLikelihood;
 }
 
 /**
@@ -369,48 +415,71 @@ void HMM<Distribution>::Generate(const size_t length,
  */
 template<typename Distribution>
 double HMM<Distribution>::Predict(const arma::mat& dataSeq,
-                                  arma::Col<size_t>& stateSeq) const
+                                  arma::Col<size_t>& stateSeq,
+                                  const double beamWidth) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
+  // probable sequence of states to produce the observed data sequence.
   stateSeq.set_size(dataSeq.n_cols);
   arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
+  arma::Mat<size_t> stateSeqBack(transition.n_rows, dataSeq.n_cols);
 
   // Store the logs of the transposed transition matrix.  This is because we
   // will be using the rows of the transition matrix.
   arma::mat logTrans(log(trans(transition)));
 
+  // Compute the emission log-probabilities of the whole sequence at once.
+  arma::mat logEmission;
+  EmissionLogProbability(emission, dataSeq, logEmission);
+
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
   for (size_t state = 0; state < transition.n_rows; state++)
   {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
+    logStateProb(state, 0) = log(initial[state]) + logEmission(state, 0);
     stateSeqBack(state, 0) = state;
   }
 
-  // Store the best first state.
-  arma::uword index;
+  // The states that survived the beam at the previous time step.
+  std::vector<size_t> active;
+  active.reserve(transition.n_rows);
+
   for (size_t t = 1; t < dataSeq.n_cols; t++)
   {
+    // Prune the states of the previous time step that fall outside the beam.
+    const double* prevLogProb = logStateProb.colptr(t - 1);
+    const double threshold = logStateProb.col(t - 1).max() - beamWidth;
+    active.clear();
+    for (size_t i = 0; i < transition.n_rows; i++)
+      if (prevLogProb[i] >= threshold)
+        active.push_back(i);
+
     // Assemble the state probability for this element.
     // Given that we are in state j, we use state with the highest probability
     // of being the previous state.
     for (size_t j = 0; j < transition.n_rows; j++)
     {
-      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
+      const double* logTransJ = logTrans.colptr(j);
+      double best = -std::numeric_limits<double>::infinity();
+      size_t index = active[0];
+      for (size_t a = 0; a < active.size(); a++)
+      {
+        const double prob = prevLogProb[active[a]] + logTransJ[active[a]];
+        if (prob > best)
+        {
+          best = prob;
+          index = active[a];
+        }
+      }
+
+      logStateProb(j, t) = best + logEmission(j, t);
+      stateSeqBack(j, t) = index;
     }
   }
 
   // Backtrack to find the most probable state sequence.
+  arma::uword index;
   logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
   stateSeq[dataSeq.n_cols - 1] = index;
   for (size_t t = 2; t <= dataSeq.n_cols; t++)
@@ -420,19 +489,55 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
 }
 
+/**
+ * Compute the most probable hidden state sequence for each of the given data
+ * sequences.
+ */
+template<typename Distribution>
+void HMM<Distribution>::Predict(const std::vector<arma::mat>& dataSeq,
+                                std::vector<arma::Col<size_t> >& stateSeq,
+                                arma::vec& logLikelihoods,
+                                const double beamWidth) const
+{
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.set_size(dataSeq.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t seq = 0; seq < dataSeq.size(); ++seq)
+    logLikelihoods[seq] = Predict(dataSeq[seq], stateSeq[seq], beamWidth);
+}
+
 /**
  * Compute the log-likelihood of the given data sequence.
  */
 template<typename Distribution>
 double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
 {
+  arma::mat emissionProb;
+  arma::vec logShifts;
   arma::mat forward;
   arma::vec scales;
 
-  Forward(dataSeq, scales, forward);
+  EmissionProbability(dataSeq, emissionProb, logShifts);
+  ScaledForward(emissionProb, scales, forward);
 
-  // The log-likelihood is the log of the scales for each time step.
-  return accu(log(scales));
+  // The log-likelihood is the log of the scales for each time step, plus the
+  // log of the shift of the emission probabilities at each time step.
+  return accu(log(scales)) + accu(logShifts);
+}
+
+/**
+ * Compute the log-likelihood of each of the given data sequences.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                                      arma::vec& logLikelihoods) const
+{
+  logLikelihoods.set_size(dataSeq.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t seq = 0; seq < dataSeq.size(); ++seq)
+    logLikelihoods[seq] = LogLikelihood(dataSeq[seq]);
 }
 
 /**
@@ -484,37 +589,127 @@ template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
                                 arma::vec& scales,
                                 arma::mat& forwardProb) const
+{
+  arma::mat emissionProb;
+  arma::vec logShifts;
+  EmissionProbability(dataSeq, emissionProb, logShifts);
+  ScaledForward(emissionProb, scales, forwardProb);
+
+  // Return the scaling factors of the unshifted emission probabilities.
+  scales %= arma::exp(logShifts);
+}
+
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& scales,
+                                 arma::mat& backwardProb) const
+{
+  arma::mat emissionProb;
+  arma::vec logShifts;
+  EmissionProbability(dataSeq, emissionProb, logShifts);
+  ScaledBackward(emissionProb, scales / arma::exp(logShifts), backwardProb);
+}
+
+/**
+ * Compute the (shifted) emission probabilities of a whole data sequence.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionProbability(const arma::mat& dataSeq,
+                                            arma::mat& emissionProb,
+                                            arma::vec& logShifts) const
+{
+  EmissionLogProbability(emission, dataSeq, emissionProb);
+
+  logShifts.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; t++)
+  {
+    arma::vec prob = emissionProb.unsafe_col(t);
+
+    // If no state can emit this observation, there is nothing to shift by.
+    logShifts[t] = prob.max();
+    if (logShifts[t] == -std::numeric_limits<double>::infinity())
+      logShifts[t] = 0;
+
+    prob = arma::exp(prob - logShifts[t]);
+  }
+}
+
+template<typename Distribution>
+template<typename D>
+void HMM<Distribution>::EmissionLogProbability(
+    const std::vector<D>& dists,
+    const arma::mat& dataSeq,
+    arma::mat& logProb,
+    typename boost::enable_if<HasStateLogProbability<D,
+        StateLogProbabilityType> >::type*) const
+{
+  D::LogProbability(dists, dataSeq, logProb);
+}
+
+template<typename Distribution>
+template<typename D>
+void HMM<Distribution>::EmissionLogProbability(
+    const std::vector<D>& dists,
+    const arma::mat& dataSeq,
+    arma::mat& logProb,
+    typename boost::enable_if_c<HasBatchLogProbability<D,
+        BatchLogProbabilityType>::value && !HasStateLogProbability<D,
+        StateLogProbabilityType>::value>::type*) const
+{
+  logProb.set_size(dists.size(), dataSeq.n_cols);
+  arma::vec logPhis;
+  for (size_t state = 0; state < dists.size(); state++)
+  {
+    dists[state].LogProbability(dataSeq, logPhis);
+    logProb.row(state) = trans(logPhis);
+  }
+}
+
+template<typename Distribution>
+template<typename D>
+void HMM<Distribution>::EmissionLogProbability(
+    const std::vector<D>& dists,
+    const arma::mat& dataSeq,
+    arma::mat& logProb,
+    typename boost::enable_if_c<!HasBatchLogProbability<D,
+        BatchLogProbabilityType>::value && !HasStateLogProbability<D,
+        StateLogProbabilityType>::value>::type*) const
+{
+  logProb.set_size(dists.size(), dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; t++)
+    for (size_t state = 0; state < dists.size(); state++)
+      logProb(state, t) = log(dists[state].Probability(dataSeq.unsafe_col(t)));
+}
+
+template<typename Distribution>
+void HMM<Distribution>::ScaledForward(const arma::mat& emissionProb,
+                                      arma::vec& scales,
+                                      arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.set_size(transition.n_rows, emissionProb.n_cols);
+  scales.set_size(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
   forwardProb.col(0) /= scales[0];
 
-  // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  // Now compute the probabilities for each successive observation.  The
+  // forward probability of state j at time t is the sum over all states of the
+  // probability of the previous state transitioning to the current state and
+  // emitting the given observation.
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -523,34 +718,26 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
 }
 
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+void HMM<Distribution>::ScaledBackward(const arma::mat& emissionProb,
+                                       const arma::vec& scales,
+                                       arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.set_size(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
-
-  // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
-  {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      backwardProb(j, t) /= scales[t + 1];
-    }
-  }
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
+
+  // Now step backwards through all other observations.  The backward
+  // probability of state j at time t is the sum over all states of the
+  // probability of the next state having been a transition from the current
+  // state multiplied by the probability of each of those states emitting the
+  // given observation, normalized by the weights from the forward algorithm.
+  const arma::mat transitionT = trans(transition);
+  for (size_t t = emissionProb.n_cols - 2; t + 1 > 0; t--)
+    backwardProb.col(t) = (transitionT * (backwardProb.col(t + 1) %
+        emissionProb.col(t + 1))) / scales[t + 1];
 }
 
 template<typename Distribution>
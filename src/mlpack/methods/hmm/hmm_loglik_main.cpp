@@ -5,6 +5,7 @@
  * Compute the log-likelihood of a given sequence for a given HMM.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/query_server.hpp>
 
 #include "hmm.hpp"
 #include "hmm_util.hpp"
@@ -14,11 +15,33 @@
 PROGRAM_INFO("Hidden Markov Model (HMM) Sequence Log-Likelihood", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "log-likelihood of a given sequence of observations (--input_file).  The "
-    "computed log-likelihood is given directly to stdout.");
-
-PARAM_STRING_REQ("input_file", "File containing observations,", "i");
+    "computed log-likelihood is given directly to stdout."
+    "\n\n"
+    "If --batch is given, the file given to --input_file should instead contain "
+    "a list of files, each holding one sequence of observations.  The "
+    "sequences are scored in parallel, and the log-likelihood of each sequence "
+    "is given on its own line, in the same order."
+    "\n\n"
+    "With --server, the model is loaded once, and then sequences are read from "
+    "--server_input (or the standard input) and scored until the input ends or "
+    "a 'quit' request is read.  A request 'query <n>' is followed by n lines "
+    "holding one observation each, and is answered with the log-likelihood of "
+    "the sequence.  --input_file is not needed in this mode.");
+
+PARAM_STRING("input_file", "File containing observations (required unless "
+    "--server is given).", "i", "");
 PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
 
+PARAM_FLAG("batch", "If true, input_file is expected to contain a list of "
+    "files to use as input observation sequences.", "b");
+
+PARAM_FLAG("server", "If true, load the model once and score sequences read "
+    "from --server_input.", "");
+PARAM_STRING("server_input", "File or named pipe to read server requests from "
+    "(the standard input is used if not given).", "", "");
+PARAM_STRING("server_output", "File or named pipe to write server responses to "
+    "(the standard output is used if not given).", "", "");
+
 using namespace mlpack;
 using namespace mlpack::hmm;
 using namespace mlpack::distribution;
@@ -27,6 +50,46 @@ using namespace mlpack::gmm;
 using namespace arma;
 using namespace std;
 
+/**
+ * Answer the requests of the server with the log-likelihood of every sequence
+ * under the loaded model.  The points of a request are the observations of a
+ * single sequence.
+ */
+template<typename HMMType>
+class LogLikelihoodHandler
+{
+ public:
+  LogLikelihoodHandler(const HMMType& hmm, const size_t dimensionality) :
+      hmm(hmm), dimensionality(dimensionality) { }
+
+  void Query(const QueryRequest& request, QueryResponse& response)
+  {
+    if (request.Points().n_rows != dimensionality)
+    {
+      Log::Fatal << "Observation dimensionality (" << request.Points().n_rows
+          << ") does not match HMM dimensionality (" << dimensionality << ")!"
+          << endl;
+    }
+
+    mat loglik(1, 1);
+    loglik[0] = hmm.LogLikelihood(request.Points());
+    response.Add(loglik);
+  }
+
+ private:
+  const HMMType& hmm;
+  size_t dimensionality;
+};
+
+//! Score the sequences read by the server with the given model.
+template<typename HMMType>
+void ServeLogLikelihood(const HMMType& hmm, const size_t dimensionality)
+{
+  LogLikelihoodHandler<HMMType> handler(hmm, dimensionality);
+  ServeQueries(handler, CLI::GetParam<string>("server_input"),
+      CLI::GetParam<string>("server_output"));
+}
+
 int main(int argc, char** argv)
 {
   // Parse command line options.
@@ -36,8 +99,45 @@ int main(int argc, char** argv)
   const string inputFile = CLI::GetParam<string>("input_file");
   const string modelFile = CLI::GetParam<string>("model_file");
 
-  mat dataSeq;
-  data::Load(inputFile, dataSeq, true);
+  const bool server = CLI::HasParam("server");
+  if (!server && inputFile == "")
+    Log::Fatal << "--input_file is required unless --server is given." << endl;
+
+  vector<mat> dataSeq;
+  if (server)
+  {
+    // The sequences are read by the server.
+  }
+  else if (CLI::HasParam("batch"))
+  {
+    // The input file contains a list of files to read.
+    Log::Info << "Reading list of sequences from '" << inputFile << "'."
+        << endl;
+
+    fstream f(inputFile.c_str(), ios_base::in);
+
+    if (!f.is_open())
+      Log::Fatal << "Could not open '" << inputFile << "' for reading." << endl;
+
+    // Now read each line in.
+    char lineBuf[1024]; // Max 1024 characters... hopefully that is long enough.
+    f.getline(lineBuf, 1024, '\n');
+    while (!f.eof())
+    {
+      dataSeq.push_back(mat());
+      data::Load(lineBuf, dataSeq.back(), true);
+
+      f.getline(lineBuf, 1024, '\n');
+    }
+
+    f.close();
+  }
+  else
+  {
+    // Only one input file.
+    dataSeq.resize(1);
+    data::Load(inputFile, dataSeq[0], true);
+  }
 
   // Load model, but first we have to determine its type.
   SaveRestoreUtility sr;
@@ -45,22 +145,31 @@ int main(int argc, char** argv)
   string type;
   sr.LoadParameter(type, "hmm_type");
 
-  double loglik = 0;
+  vec loglik;
   if (type == "discrete")
   {
     HMM<DiscreteDistribution> hmm(1, DiscreteDistribution(1));
 
     LoadHMM(hmm, sr);
 
-    // Verify only one row in observations.
-    if (dataSeq.n_cols == 1)
-      dataSeq = trans(dataSeq);
+    if (server)
+    {
+      ServeLogLikelihood(hmm, 1);
+      return 0;
+    }
 
-    if (dataSeq.n_rows > 1)
-      Log::Fatal << "Only one-dimensional discrete observations allowed for "
-          << "discrete HMMs!" << endl;
+    for (size_t i = 0; i < dataSeq.size(); ++i)
+    {
+      // Verify only one row in observations.
+      if (dataSeq[i].n_cols == 1)
+        dataSeq[i] = trans(dataSeq[i]);
 
-    loglik = hmm.LogLikelihood(dataSeq);
+      if (dataSeq[i].n_rows > 1)
+        Log::Fatal << "Only one-dimensional discrete observations allowed for "
+            << "discrete HMMs!" << endl;
+    }
+
+    hmm.LogLikelihood(dataSeq, loglik);
   }
   else if (type == "gaussian")
   {
@@ -68,13 +177,20 @@ int main(int argc, char** argv)
 
     LoadHMM(hmm, sr);
 
+    if (server)
+    {
+      ServeLogLikelihood(hmm, hmm.Emission()[0].Mean().n_elem);
+      return 0;
+    }
+
     // Verify correct dimensionality.
-    if (dataSeq.n_rows != hmm.Emission()[0].Mean().n_elem)
-      Log::Fatal << "Observation dimensionality (" << dataSeq.n_rows << ") "
-          << "does not match HMM Gaussian dimensionality ("
-          << hmm.Emission()[0].Mean().n_elem << ")!" << endl;
+    for (size_t i = 0; i < dataSeq.size(); ++i)
+      if (dataSeq[i].n_rows != hmm.Emission()[0].Mean().n_elem)
+        Log::Fatal << "Observation dimensionality (" << dataSeq[i].n_rows
+            << ") does not match HMM Gaussian dimensionality ("
+            << hmm.Emission()[0].Mean().n_elem << ")!" << endl;
 
-    loglik = hmm.LogLikelihood(dataSeq);
+    hmm.LogLikelihood(dataSeq, loglik);
   }
   else if (type == "gmm")
   {
@@ -82,13 +198,20 @@ int main(int argc, char** argv)
 
     LoadHMM(hmm, sr);
 
+    if (server)
+    {
+      ServeLogLikelihood(hmm, hmm.Emission()[0].Dimensionality());
+      return 0;
+    }
+
     // Verify correct dimensionality.
-    if (dataSeq.n_rows != hmm.Emission()[0].Dimensionality())
-      Log::Fatal << "Observation dimensionality (" << dataSeq.n_rows << ") "
-          << "does not match HMM Gaussian dimensionality ("
-          << hmm.Emission()[0].Dimensionality() << ")!" << endl;
+    for (size_t i = 0; i < dataSeq.size(); ++i)
+      if (dataSeq[i].n_rows != hmm.Emission()[0].Dimensionality())
+        Log::Fatal << "Observation dimensionality (" << dataSeq[i].n_rows
+            << ") does not match HMM Gaussian dimensionality ("
+            << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
-    loglik = hmm.LogLikelihood(dataSeq);
+    hmm.LogLikelihood(dataSeq, loglik);
   }
   else
   {
@@ -96,5 +219,6 @@ int main(int argc, char** argv)
         << "'!" << endl;
   }
 
-  cout << loglik << endl;
+  for (size_t i = 0; i < loglik.n_elem; ++i)
+    cout << loglik[i] << endl;
 }
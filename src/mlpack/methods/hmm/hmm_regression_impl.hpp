@@ -106,15 +106,11 @@ void HMMRegression::Filter(const arma::mat& predictors,
     forwardProb = forwardProb.cols(0, forwardProb.n_cols-ahead-1);
   }
 
-  // Compute expected emissions.
-  filterSeq.resize(responses.n_elem - ahead);
-  filterSeq.zeros();
-  arma::vec nextSeq;
-  for(size_t i = 0; i < emission.size(); i++)
-  {
-    emission[i].Predict(predictors.cols(ahead, predictors.n_cols-1), nextSeq);
-    filterSeq = filterSeq + nextSeq%(forwardProb.row(i).t());
-  }
+  // Compute expected emissions, with the predictions of all states at once.
+  arma::mat predictions;
+  distribution::RegressionDistribution::Predict(emission,
+      predictors.cols(ahead, predictors.n_cols - 1), predictions);
+  filterSeq = arma::trans(arma::sum(predictions % forwardProb, 0));
 }
 
 /**
@@ -128,16 +124,11 @@ void HMMRegression::Smooth(const arma::mat& predictors,
   arma::mat stateProb;
   Estimate(predictors, responses, stateProb);
 
-  // Compute expected emissions.
-  smoothSeq.resize(responses.n_elem);
-  smoothSeq.zeros();
-  arma::vec nextSeq;
-  for(size_t i = 0; i < emission.size(); i++)
-  {
-    emission[i].Predict(predictors, nextSeq);
-    smoothSeq = smoothSeq + nextSeq%(stateProb.row(i).t());
-  }
-
+  // Compute expected emissions, with the predictions of all states at once.
+  arma::mat predictions;
+  distribution::RegressionDistribution::Predict(emission, predictors,
+      predictions);
+  smoothSeq = arma::trans(arma::sum(predictions % stateProb, 0));
 }
 
 /**
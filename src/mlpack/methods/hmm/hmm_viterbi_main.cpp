@@ -16,12 +16,28 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "most probably hidden state sequence of a given sequence of observations "
     "(--input_file), using the Viterbi algorithm.  The computed state sequence "
-    "is saved to the specified output file (--output_file).");
+    "is saved to the specified output file (--output_file)."
+    "\n\n"
+    "If --batch is given, the file given to --input_file should instead contain "
+    "a list of files, each holding one sequence of observations, and the file "
+    "given to --output_file should contain a list of files, one for each input "
+    "sequence, to save the predicted state sequences to.  The sequences are "
+    "decoded in parallel."
+    "\n\n"
+    "For models with many states, a beam width can be given (--beam_width); at "
+    "each time step, only the states whose log-probability is within the beam "
+    "width of the best state are kept.  This is much faster, but may not find "
+    "the most probable state sequence.");
 
 PARAM_STRING_REQ("input_file", "File containing observations,", "i");
 PARAM_STRING_REQ("model_file", "File containing HMM (XML).", "m");
 PARAM_STRING("output_file", "File to save predicted state sequence to.", "o",
     "output.csv");
+PARAM_FLAG("batch", "If true, input_file and output_file are expected to "
+    "contain lists of files for the observation sequences and the predicted "
+    "state sequences.", "b");
+PARAM_DOUBLE("beam_width", "Log-probability beam width for pruning states at "
+    "each time step; 0 means no pruning.", "w", 0.0);
 
 using namespace mlpack;
 using namespace mlpack::hmm;
@@ -40,8 +56,60 @@ int main(int argc, char** argv)
   const string inputFile = CLI::GetParam<string>("input_file");
   const string modelFile = CLI::GetParam<string>("model_file");
 
-  mat dataSeq;
-  data::Load(inputFile, dataSeq, true);
+  const string outputFile = CLI::GetParam<string>("output_file");
+  const bool batch = CLI::HasParam("batch");
+
+  const double beamWidth = CLI::GetParam<double>("beam_width");
+  if (beamWidth < 0.0)
+    Log::Fatal << "Invalid beam width (" << beamWidth << "); must be greater "
+        << "than or equal to 0." << endl;
+
+  vector<mat> dataSeq;
+  vector<string> outputFiles;
+  if (batch)
+  {
+    // The input file contains a list of files to read, and the output file
+    // contains a list of files to write.
+    fstream f(inputFile.c_str(), ios_base::in);
+    if (!f.is_open())
+      Log::Fatal << "Could not open '" << inputFile << "' for reading." << endl;
+
+    char lineBuf[1024]; // Max 1024 characters... hopefully that is long enough.
+    f.getline(lineBuf, 1024, '\n');
+    while (!f.eof())
+    {
+      dataSeq.push_back(mat());
+      data::Load(lineBuf, dataSeq.back(), true);
+
+      f.getline(lineBuf, 1024, '\n');
+    }
+    f.close();
+
+    f.open(outputFile.c_str(), ios_base::in);
+    if (!f.is_open())
+      Log::Fatal << "Could not open '" << outputFile << "' for reading."
+          << endl;
+
+    f.getline(lineBuf, 1024, '\n');
+    while (!f.eof())
+    {
+      outputFiles.push_back(lineBuf);
+      f.getline(lineBuf, 1024, '\n');
+    }
+    f.close();
+
+    if (outputFiles.size() != dataSeq.size())
+      Log::Fatal << "Number of output files (" << outputFiles.size() << ") "
+          << "does not match number of input sequences (" << dataSeq.size()
+          << ")!" << endl;
+  }
+  else
+  {
+    // Only one input file.
+    dataSeq.resize(1);
+    data::Load(inputFile, dataSeq[0], true);
+    outputFiles.push_back(outputFile);
+  }
 
   // Load model, but first we have to determine its type.
   SaveRestoreUtility sr;
@@ -49,22 +117,27 @@ int main(int argc, char** argv)
   string type;
   sr.LoadParameter(type, "hmm_type");
 
-  arma::Col<size_t> sequence;
+  vector<arma::Col<size_t> > sequences;
+  vec logLikelihoods;
+  const double beam = (beamWidth == 0.0) ? DBL_MAX : beamWidth;
   if (type == "discrete")
   {
     HMM<DiscreteDistribution> hmm(1, DiscreteDistribution(1));
 
     LoadHMM(hmm, sr);
 
-    // Verify only one row in observations.
-    if (dataSeq.n_cols == 1)
-      dataSeq = trans(dataSeq);
+    for (size_t i = 0; i < dataSeq.size(); ++i)
+    {
+      // Verify only one row in observations.
+      if (dataSeq[i].n_cols == 1)
+        dataSeq[i] = trans(dataSeq[i]);
 
-    if (dataSeq.n_rows > 1)
-      Log::Fatal << "Only one-dimensional discrete observations allowed for "
-          << "discrete HMMs!" << endl;
+      if (dataSeq[i].n_rows > 1)
+        Log::Fatal << "Only one-dimensional discrete observations allowed for "
+            << "discrete HMMs!" << endl;
+    }
 
-    hmm.Predict(dataSeq, sequence);
+    hmm.Predict(dataSeq, sequences, logLikelihoods, beam);
   }
   else if (type == "gaussian")
   {
@@ -73,12 +146,13 @@ int main(int argc, char** argv)
     LoadHMM(hmm, sr);
 
     // Verify correct dimensionality.
-    if (dataSeq.n_rows != hmm.Emission()[0].Mean().n_elem)
-      Log::Fatal << "Observation dimensionality (" << dataSeq.n_rows << ") "
-          << "does not match HMM Gaussian dimensionality ("
-          << hmm.Emission()[0].Mean().n_elem << ")!" << endl;
+    for (size_t i = 0; i < dataSeq.size(); ++i)
+      if (dataSeq[i].n_rows != hmm.Emission()[0].Mean().n_elem)
+        Log::Fatal << "Observation dimensionality (" << dataSeq[i].n_rows
+            << ") does not match HMM Gaussian dimensionality ("
+            << hmm.Emission()[0].Mean().n_elem << ")!" << endl;
 
-    hmm.Predict(dataSeq, sequence);
+    hmm.Predict(dataSeq, sequences, logLikelihoods, beam);
   }
   else if (type == "gmm")
   {
@@ -87,12 +161,13 @@ int main(int argc, char** argv)
     LoadHMM(hmm, sr);
 
     // Verify correct dimensionality.
-    if (dataSeq.n_rows != hmm.Emission()[0].Dimensionality())
-      Log::Fatal << "Observation dimensionality (" << dataSeq.n_rows << ") "
-          << "does not match HMM Gaussian dimensionality ("
-          << hmm.Emission()[0].Dimensionality() << ")!" << endl;
+    for (size_t i = 0; i < dataSeq.size(); ++i)
+      if (dataSeq[i].n_rows != hmm.Emission()[0].Dimensionality())
+        Log::Fatal << "Observation dimensionality (" << dataSeq[i].n_rows
+            << ") does not match HMM Gaussian dimensionality ("
+            << hmm.Emission()[0].Dimensionality() << ")!" << endl;
 
-    hmm.Predict(dataSeq, sequence);
+    hmm.Predict(dataSeq, sequences, logLikelihoods, beam);
   }
   else
   {
@@ -101,6 +176,6 @@ int main(int argc, char** argv)
   }
 
   // Save output.
-  const string outputFile = CLI::GetParam<string>("output_file");
-  data::Save(outputFile, sequence, true);
+  for (size_t i = 0; i < sequences.size(); ++i)
+    data::Save(outputFiles[i], sequences[i], true);
 }
@@ -0,0 +1,196 @@
+/**
+ * @file kde.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the KDE class, which performs kernel density estimation with trees.
+ */
+#ifndef __MLPACK_METHODS_KDE_KDE_HPP
+#define __MLPACK_METHODS_KDE_KDE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <boost/static_assert.hpp>
+
+namespace mlpack {
+namespace kde /** Kernel density estimation. */ {
+
+/**
+ * The KDE class is a template class for kernel density estimation.  For each
+ * query point q, it computes the average kernel value
+ *
+ * @f[
+ * f(q) = \frac{1}{N} \sum_{r} K(d(q, r))
+ * @f]
+ *
+ * over the N reference points, up to the given relative and absolute error
+ * tolerances: the result for each query point is within relError * f(q) +
+ * absError of the exact value.  Dividing the result by the normalizer of the
+ * kernel (see, e.g., GaussianKernel::Normalizer()) gives the density estimate.
+ *
+ * It is implemented in the style of a generalized tree-independent dual-tree
+ * algorithm; for more details on the pruning rule, see the KDERules class.
+ * The tree type must hold each point in exactly one leaf, so the cover tree is
+ * not supported.
+ *
+ * @tparam MetricType Metric to use for the distances.
+ * @tparam KernelType Kernel to use; it must be a non-increasing function of the
+ *      distance.
+ * @tparam TreeType Type of tree to use.
+ */
+template<typename MetricType = mlpack::metric::EuclideanDistance,
+         typename KernelType = kernel::GaussianKernel,
+         typename TreeType = tree::BinarySpaceTree<bound::HRectBound<2>,
+                                                   tree::EmptyStatistic> >
+class KDE
+{
+ public:
+  /**
+   * Initialize the KDE object with a given reference dataset.  Optionally,
+   * perform the computation in naive mode or single-tree mode.  Additionally,
+   * an instantiated kernel and metric can be given, for cases where they hold
+   * data (such as the bandwidth of the kernel).
+   *
+   * This method will copy the matrix to an internal copy, which is rearranged
+   * during tree-building.  You can avoid this extra copy by pre-constructing
+   * the tree and passing it using a different constructor.
+   *
+   * @param referenceSet Reference dataset.
+   * @param relError Relative error tolerance of the result for each query
+   *      point.
+   * @param absError Absolute error tolerance of the result for each query
+   *      point.
+   * @param naive Whether the computation should be done in O(n^2) naive mode.
+   * @param singleMode Whether single-tree computation should be used (as
+   *      opposed to dual-tree computation).
+   * @param kernel Instantiated kernel.
+   * @param metric Instantiated distance metric.
+   */
+  KDE(const typename TreeType::Mat& referenceSet,
+      const double relError = 0.05,
+      const double absError = 0.0,
+      const bool naive = false,
+      const bool singleMode = false,
+      const KernelType kernel = KernelType(),
+      const MetricType metric = MetricType());
+
+  /**
+   * Initialize the KDE object with the given pre-constructed reference tree.
+   * Optionally, choose to use single-tree mode, which will not build a tree on
+   * query points.  Naive mode is not available as an option for this
+   * constructor.  The tree is not copied and must stay alive as long as this
+   * object.
+   *
+   * @param referenceTree Pre-built tree for reference points.
+   * @param relError Relative error tolerance of the result for each query
+   *      point.
+   * @param absError Absolute error tolerance of the result for each query
+   *      point.
+   * @param singleMode Whether single-tree computation should be used (as
+   *      opposed to dual-tree computation).
+   * @param kernel Instantiated kernel.
+   * @param metric Instantiated distance metric.
+   */
+  KDE(TreeType* referenceTree,
+      const double relError = 0.05,
+      const double absError = 0.0,
+      const bool singleMode = false,
+      const KernelType kernel = KernelType(),
+      const MetricType metric = MetricType());
+
+  /**
+   * Destroy the KDE object.  If trees were created, they will be deleted.
+   */
+  ~KDE();
+
+  /**
+   * Estimate the density at each of the given query points.  If a tree needs to
+   * be built on the query set, it is built on a copy, so estimations[i]
+   * corresponds to the i'th column of querySet.
+   *
+   * @param querySet Set of query points.
+   * @param estimations Vector to store the average kernel values in.
+   */
+  void Evaluate(const typename TreeType::Mat& querySet,
+                arma::vec& estimations);
+
+  /**
+   * Estimate the density at each of the points in the given pre-built query
+   * tree.  estimations[i] corresponds to the i'th column of the dataset of the
+   * query tree (that is, no mapping of indices is done).  This can only be used
+   * in dual-tree mode.
+   *
+   * @param queryTree Tree built on the query points.
+   * @param estimations Vector to store the average kernel values in.
+   */
+  void Evaluate(TreeType* queryTree, arma::vec& estimations);
+
+  /**
+   * Estimate the density at each of the reference points (each point's own
+   * kernel value is included).  If this object built the reference tree,
+   * estimations[i] corresponds to the i'th reference point as given to the
+   * constructor.
+   *
+   * @param estimations Vector to store the average kernel values in.
+   */
+  void Evaluate(arma::vec& estimations);
+
+  //! Get the relative error tolerance.
+  double RelativeError() const { return relError; }
+  //! Modify the relative error tolerance.
+  double& RelativeError() { return relError; }
+  //! Get the absolute error tolerance.
+  double AbsoluteError() const { return absError; }
+  //! Modify the absolute error tolerance.
+  double& AbsoluteError() { return absError; }
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Modify the kernel.
+  KernelType& Kernel() { return kernel; }
+
+  //! Access the reference dataset (possibly rearranged by tree building).
+  const typename TreeType::Mat& ReferenceSet() const { return referenceSet; }
+
+ private:
+  //! Copy of reference matrix; used when a tree is built internally.
+  typename TreeType::Mat referenceCopy;
+  //! Reference set (data should be accessed using this).
+  const typename TreeType::Mat& referenceSet;
+  //! Reference tree.
+  TreeType* referenceTree;
+  //! Mappings to old reference indices (used when this object builds trees).
+  std::vector<size_t> oldFromNewReferences;
+
+  //! If true, this object is responsible for deleting the trees.
+  bool treeOwner;
+
+  //! If true, O(n^2) naive computation is used.
+  bool naive;
+  //! If true, single-tree computation is used.
+  bool singleMode;
+
+  //! Relative error tolerance.
+  double relError;
+  //! Absolute error tolerance.
+  double absError;
+
+  //! Instantiated kernel.
+  KernelType kernel;
+  //! Instantiated distance metric.
+  MetricType metric;
+
+  // The rules count each point of a node once, so the root point of a node may
+  // not also be held by its children.
+  BOOST_STATIC_ASSERT_MSG(!tree::TreeTraits<TreeType>::FirstPointIsCentroid,
+      "KDE does not support trees with FirstPointIsCentroid");
+};
+
+}; // namespace kde
+}; // namespace mlpack
+
+// Include implementation.
+#include "kde_impl.hpp"
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * @file kde_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the KDE class.
+ */
+#ifndef __MLPACK_METHODS_KDE_KDE_IMPL_HPP
+#define __MLPACK_METHODS_KDE_KDE_IMPL_HPP
+
+// Just in case it hasn't been included.
+#include "kde.hpp"
+
+// The rules for traversal.
+#include "kde_rules.hpp"
+
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
+namespace mlpack {
+namespace kde {
+
+//! Call the tree constructor that does mapping.
+template<typename TreeType>
+TreeType* BuildTree(
+    typename TreeType::Mat& dataset,
+    std::vector<size_t>& oldFromNew,
+    typename boost::enable_if_c<
+        tree::TreeTraits<TreeType>::RearrangesDataset == true, TreeType*
+    >::type = 0)
+{
+  return new TreeType(dataset, oldFromNew);
+}
+
+//! Call the tree constructor that does not do mapping.
+template<typename TreeType>
+TreeType* BuildTree(
+    const typename TreeType::Mat& dataset,
+    const std::vector<size_t>& /* oldFromNew */,
+    const typename boost::enable_if_c<
+        tree::TreeTraits<TreeType>::RearrangesDataset == false, TreeType*
+    >::type = 0)
+{
+  return new TreeType(dataset);
+}
+
+//! Make sure the error tolerances are valid.
+inline void CheckErrors(const double relError, const double absError)
+{
+  if (relError < 0.0)
+    throw std::invalid_argument("KDE: relative error tolerance must be "
+        "nonnegative");
+  if (absError < 0.0)
+    throw std::invalid_argument("KDE: absolute error tolerance must be "
+        "nonnegative");
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDE<MetricType, KernelType, TreeType>::KDE(
+    const typename TreeType::Mat& referenceSetIn,
+    const double relError,
+    const double absError,
+    const bool naive,
+    const bool singleMode,
+    const KernelType kernel,
+    const MetricType metric) :
+    referenceSet((tree::TreeTraits<TreeType>::RearrangesDataset && !naive)
+        ? referenceCopy : referenceSetIn),
+    referenceTree(NULL),
+    treeOwner(!naive), // If in naive mode, we are not building any trees.
+    naive(naive),
+    singleMode(!naive && singleMode), // Naive overrides single mode.
+    relError(relError),
+    absError(absError),
+    kernel(kernel),
+    metric(metric)
+{
+  CheckErrors(relError, absError);
+
+  // Build the tree.
+  Timer::Start("kde/tree_building");
+
+  // If in naive mode, then we do not need to build trees.
+  if (!naive)
+  {
+    // Copy the dataset, if it will be modified during tree building.
+    if (tree::TreeTraits<TreeType>::RearrangesDataset)
+      referenceCopy = referenceSetIn;
+
+    // The const_cast is safe; if RearrangesDataset == false, then it'll be
+    // casted back to const anyway, and if not, referenceSet points to
+    // referenceCopy, which isn't const.
+    referenceTree = BuildTree<TreeType>(
+        const_cast<typename TreeType::Mat&>(referenceSet),
+        oldFromNewReferences);
+  }
+
+  Timer::Stop("kde/tree_building");
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDE<MetricType, KernelType, TreeType>::KDE(
+    TreeType* referenceTree,
+    const double relError,
+    const double absError,
+    const bool singleMode,
+    const KernelType kernel,
+    const MetricType metric) :
+    referenceSet(referenceTree->Dataset()),
+    referenceTree(referenceTree),
+    treeOwner(false),
+    naive(false),
+    singleMode(singleMode),
+    relError(relError),
+    absError(absError),
+    kernel(kernel),
+    metric(metric)
+{
+  CheckErrors(relError, absError);
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDE<MetricType, KernelType, TreeType>::~KDE()
+{
+  if (treeOwner && referenceTree)
+    delete referenceTree;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDE<MetricType, KernelType, TreeType>::Evaluate(
+    const typename TreeType::Mat& querySet,
+    arma::vec& estimations)
+{
+  Timer::Start("kde/computing_densities");
+
+  // If we will be building a tree and it will modify the query set, make a copy
+  // of the dataset.
+  typename TreeType::Mat queryCopy;
+  const bool needsCopy = (!naive && !singleMode &&
+      tree::TreeTraits<TreeType>::RearrangesDataset);
+  if (needsCopy)
+    queryCopy = querySet;
+
+  const typename TreeType::Mat& querySetRef = (needsCopy) ? queryCopy :
+      querySet;
+
+  // The sums are accumulated in the order of querySetRef.
+  arma::vec sums(querySet.n_cols);
+  sums.zeros();
+
+  typedef KDERules<MetricType, KernelType, TreeType> RuleType;
+  RuleType rules(referenceSet, querySetRef, sums, relError, absError, metric,
+      kernel);
+
+  std::vector<size_t> oldFromNewQueries;
+  if (naive)
+  {
+    // The naive brute-force solution.
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      for (size_t j = 0; j < referenceSet.n_cols; ++j)
+        rules.BaseCase(i, j);
+  }
+  else if (singleMode)
+  {
+    // Create the traverser.
+    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+
+    // Now have it traverse for each point.
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+    tree::RecordTraversal("kde", traverser, rules);
+  }
+  else // Dual-tree recursion.
+  {
+    // Build the query tree.
+    Timer::Stop("kde/computing_densities");
+    Timer::Start("kde/tree_building");
+    TreeType* queryTree = BuildTree<TreeType>(
+        const_cast<typename TreeType::Mat&>(querySetRef), oldFromNewQueries);
+    Timer::Stop("kde/tree_building");
+    Timer::Start("kde/computing_densities");
+
+    // Create the traverser.
+    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+
+    traverser.Traverse(*queryTree, *referenceTree);
+    tree::RecordTraversal("kde", traverser, rules);
+
+    // Clean up tree memory.
+    delete queryTree;
+  }
+
+  // Map the sums back to the original query indices, if necessary, and turn
+  // them into averages.
+  estimations.set_size(querySet.n_cols);
+  if (needsCopy)
+  {
+    for (size_t i = 0; i < sums.n_elem; ++i)
+      estimations[oldFromNewQueries[i]] = sums[i] / referenceSet.n_cols;
+  }
+  else
+  {
+    estimations = sums / referenceSet.n_cols;
+  }
+
+  Timer::Stop("kde/computing_densities");
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDE<MetricType, KernelType, TreeType>::Evaluate(
+    TreeType* queryTree,
+    arma::vec& estimations)
+{
+  // Make sure we are in dual-tree mode.
+  if (singleMode || naive)
+    throw std::invalid_argument("cannot call KDE::Evaluate() with a query tree "
+        "when naive or singleMode are set to true");
+
+  Timer::Start("kde/computing_densities");
+
+  const typename TreeType::Mat& querySet = queryTree->Dataset();
+  estimations.zeros(querySet.n_cols);
+
+  typedef KDERules<MetricType, KernelType, TreeType> RuleType;
+  RuleType rules(referenceSet, querySet, estimations, relError, absError,
+      metric, kernel);
+
+  // Create the traverser.
+  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+
+  traverser.Traverse(*queryTree, *referenceTree);
+  tree::RecordTraversal("kde", traverser, rules);
+
+  estimations /= referenceSet.n_cols;
+
+  Timer::Stop("kde/computing_densities");
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDE<MetricType, KernelType, TreeType>::Evaluate(arma::vec& estimations)
+{
+  Timer::Start("kde/computing_densities");
+
+  arma::vec sums(referenceSet.n_cols);
+  sums.zeros();
+
+  typedef KDERules<MetricType, KernelType, TreeType> RuleType;
+  RuleType rules(referenceSet, referenceSet, sums, relError, absError, metric,
+      kernel);
+
+  if (naive)
+  {
+    // The naive brute-force solution.
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      for (size_t j = 0; j < referenceSet.n_cols; ++j)
+        rules.BaseCase(i, j);
+  }
+  else if (singleMode)
+  {
+    // Create the traverser.
+    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+
+    // Now have it traverse for each point.
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+    tree::RecordTraversal("kde", traverser, rules);
+  }
+  else
+  {
+    // The reference tree is also the query tree.
+    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+
+    traverser.Traverse(*referenceTree, *referenceTree);
+    tree::RecordTraversal("kde", traverser, rules);
+  }
+
+  // Map the sums back to the original reference indices, if necessary, and
+  // turn them into averages.
+  estimations.set_size(referenceSet.n_cols);
+  if (treeOwner && tree::TreeTraits<TreeType>::RearrangesDataset)
+  {
+    for (size_t i = 0; i < sums.n_elem; ++i)
+      estimations[oldFromNewReferences[i]] = sums[i] / referenceSet.n_cols;
+  }
+  else
+  {
+    estimations = sums / referenceSet.n_cols;
+  }
+
+  Timer::Stop("kde/computing_densities");
+}
+
+}; // namespace kde
+}; // namespace mlpack
+
+#endif
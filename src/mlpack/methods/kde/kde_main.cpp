@@ -0,0 +1,225 @@
+/**
+ * @file kde_main.cpp
+ * @author Ryan Curtin
+ *
+ * Executable for kernel density estimation with trees.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+
+#include "kde.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::kde;
+using namespace mlpack::kernel;
+using namespace mlpack::tree;
+
+// Information about the program itself.
+PROGRAM_INFO("Kernel Density Estimation",
+    "This program performs kernel density estimation with a Gaussian or "
+    "Epanechnikov kernel of the given bandwidth.  For each query point, the "
+    "density estimate is the average kernel value between the query point and "
+    "all of the reference points, divided by the normalizer of the kernel.  If "
+    "no query file is given, the density is estimated at each reference point."
+    "\n\n"
+    "Trees are used to approximate the kernel values between groups of points "
+    "that are far apart; the estimate for each query point is within the given "
+    "relative error (--rel_error) of the exact density, plus the given "
+    "absolute error (--abs_error) of the average kernel value.  If both are 0, "
+    "the results are exact."
+    "\n\n"
+    "For example, the following will estimate the density at each point in "
+    "'queries.csv' with a Gaussian kernel of bandwidth 0.5 and at most 1% "
+    "relative error, and store the results in 'density.csv':"
+    "\n\n"
+    "$ kde --reference_file=data.csv --query_file=queries.csv --bandwidth=0.5\n"
+    "  --rel_error=0.01 --output_file=density.csv");
+
+// Define our input parameters that this program will take.
+PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
+    "r");
+PARAM_STRING_REQ("output_file", "File to save the density estimates to.", "o");
+PARAM_STRING("query_file", "File containing query points (optional).", "q", "");
+
+PARAM_STRING("kernel", "Kernel to use ('gaussian' or 'epanechnikov').", "k",
+    "gaussian");
+PARAM_DOUBLE("bandwidth", "Bandwidth of the kernel.", "b", 1.0);
+PARAM_DOUBLE("rel_error", "Relative error tolerance of each density "
+    "estimate.", "e", 0.05);
+PARAM_DOUBLE("abs_error", "Absolute error tolerance of the average kernel "
+    "value of each query point.", "E", 0.0);
+
+PARAM_INT("leaf_size", "Leaf size for tree building.", "l", 20);
+PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
+PARAM_FLAG("single_mode", "If true, single-tree computation is used (as "
+    "opposed to dual-tree computation).", "s");
+
+/**
+ * Estimate the average kernel value at each query point (or each reference
+ * point, if there are no query points) with the given kernel, and return the
+ * results in the order of the given datasets.
+ */
+template<typename KernelType>
+void Estimate(arma::mat& referenceData,
+              arma::mat& queryData,
+              const KernelType& kernel,
+              const double relError,
+              const double absError,
+              const size_t leafSize,
+              const bool naive,
+              const bool singleMode,
+              arma::vec& estimations)
+{
+  typedef BinarySpaceTree<bound::HRectBound<2>, EmptyStatistic> TreeType;
+  typedef KDE<metric::EuclideanDistance, KernelType, TreeType> KDEType;
+
+  if (naive)
+  {
+    KDEType kde(referenceData, relError, absError, true, false, kernel);
+    if (queryData.n_cols > 0)
+      kde.Evaluate(queryData, estimations);
+    else
+      kde.Evaluate(estimations);
+    return;
+  }
+
+  // Build trees by hand, so we can use the given leaf size and save memory: if
+  // we pass a tree to KDE, it does not copy the matrix.
+  vector<size_t> oldFromNewRefs;
+  Log::Info << "Building reference tree..." << endl;
+  Timer::Start("tree_building");
+  TreeType refTree(referenceData, oldFromNewRefs, leafSize);
+  Timer::Stop("tree_building");
+
+  KDEType kde(&refTree, relError, absError, singleMode, kernel);
+
+  arma::vec estimationsOut;
+  if (queryData.n_cols == 0)
+  {
+    Log::Info << "Estimating densities at reference points..." << endl;
+    kde.Evaluate(estimationsOut);
+
+    // Map back to the original indices.
+    estimations.set_size(estimationsOut.n_elem);
+    for (size_t i = 0; i < estimationsOut.n_elem; ++i)
+      estimations[oldFromNewRefs[i]] = estimationsOut[i];
+  }
+  else if (singleMode)
+  {
+    Log::Info << "Estimating densities..." << endl;
+    kde.Evaluate(queryData, estimations);
+  }
+  else
+  {
+    vector<size_t> oldFromNewQueries;
+    Log::Info << "Building query tree..." << endl;
+    Timer::Start("tree_building");
+    TreeType queryTree(queryData, oldFromNewQueries, leafSize);
+    Timer::Stop("tree_building");
+
+    Log::Info << "Estimating densities..." << endl;
+    kde.Evaluate(&queryTree, estimationsOut);
+
+    // Map back to the original indices.
+    estimations.set_size(estimationsOut.n_elem);
+    for (size_t i = 0; i < estimationsOut.n_elem; ++i)
+      estimations[oldFromNewQueries[i]] = estimationsOut[i];
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  // Give CLI the command line parameters the user passed in.
+  CLI::ParseCommandLine(argc, argv);
+
+  // Get all the parameters.
+  const string referenceFile = CLI::GetParam<string>("reference_file");
+  const string queryFile = CLI::GetParam<string>("query_file");
+  const string outputFile = CLI::GetParam<string>("output_file");
+  const string kernelType = CLI::GetParam<string>("kernel");
+
+  const double bandwidth = CLI::GetParam<double>("bandwidth");
+  const double relError = CLI::GetParam<double>("rel_error");
+  const double absError = CLI::GetParam<double>("abs_error");
+  const int lsInt = CLI::GetParam<int>("leaf_size");
+
+  const bool naive = CLI::HasParam("naive");
+  const bool singleMode = CLI::HasParam("single_mode");
+
+  // Sanity checks on the parameters.
+  if (kernelType != "gaussian" && kernelType != "epanechnikov")
+  {
+    Log::Fatal << "Invalid kernel type: '" << kernelType << "'; must be "
+        << "'gaussian' or 'epanechnikov'." << endl;
+  }
+
+  if (bandwidth <= 0.0)
+  {
+    Log::Fatal << "Invalid bandwidth: " << bandwidth << ".  Must be greater "
+        << "than 0." << endl;
+  }
+
+  if (relError < 0.0 || absError < 0.0)
+  {
+    Log::Fatal << "Invalid error tolerance: --rel_error and --abs_error must "
+        << "be greater than or equal to 0." << endl;
+  }
+
+  if (lsInt < 0)
+  {
+    Log::Fatal << "Invalid leaf size: " << lsInt << ".  Must be greater "
+        "than or equal to 0." << endl;
+  }
+  const size_t leafSize = lsInt;
+
+  // Naive mode overrides single mode.
+  if (singleMode && naive)
+  {
+    Log::Warn << "--single_mode ignored because --naive is present." << endl;
+  }
+
+  arma::mat referenceData;
+  data::Load(referenceFile, referenceData, true);
+  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+
+  arma::mat queryData;
+  if (queryFile != "")
+  {
+    data::Load(queryFile, queryData, true);
+    Log::Info << "Loaded query data from '" << queryFile << "' ("
+        << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
+
+    if (queryData.n_rows != referenceData.n_rows)
+    {
+      Log::Fatal << "Query has invalid dimensions (" << queryData.n_rows
+          << "); should be " << referenceData.n_rows << "!" << endl;
+    }
+  }
+
+  // The normalizer of the kernel depends on the dimensionality.
+  const size_t dimensionality = referenceData.n_rows;
+
+  arma::vec estimations;
+  double normalizer;
+  if (kernelType == "gaussian")
+  {
+    GaussianKernel kernel(bandwidth);
+    Estimate(referenceData, queryData, kernel, relError, absError, leafSize,
+        naive, singleMode, estimations);
+    normalizer = kernel.Normalizer(dimensionality);
+  }
+  else
+  {
+    EpanechnikovKernel kernel(bandwidth);
+    Estimate(referenceData, queryData, kernel, relError, absError, leafSize,
+        naive, singleMode, estimations);
+    normalizer = kernel.Normalizer(dimensionality);
+  }
+
+  // Save the results with one density per line.
+  const arma::rowvec densities = trans(estimations) / normalizer;
+  data::Save(outputFile, densities);
+}
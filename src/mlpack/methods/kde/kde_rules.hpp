@@ -0,0 +1,181 @@
+/**
+ * @file kde_rules.hpp
+ * @author Ryan Curtin
+ *
+ * Rules for kernel density estimation, so that it can be done with arbitrary
+ * tree types.
+ */
+#ifndef __MLPACK_METHODS_KDE_KDE_RULES_HPP
+#define __MLPACK_METHODS_KDE_KDE_RULES_HPP
+
+#include <mlpack/core/tree/traversal_info.hpp>
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * The rules for dual-tree and single-tree kernel density estimation.  For each
+ * query point q, the sum of K(d(q, r)) over all reference points r is
+ * accumulated in the given vector of densities.
+ *
+ * The kernel must be a non-increasing function of the distance (this holds for
+ * the Gaussian, Epanechnikov, triangular, spherical, and Laplacian kernels).
+ * Then, for a combination of nodes at distance in [dmin, dmax], every kernel
+ * value lies in [K(dmax), K(dmin)].  When
+ *
+ * @f[
+ * \frac{K(d_{min}) - K(d_{max})}{2} \le \epsilon_r K(d_{max}) + \epsilon_a,
+ * @f]
+ *
+ * every kernel value between the two nodes is replaced by the midpoint of that
+ * interval, and the combination is pruned.  The error of each kernel value is
+ * then bounded by @f$ \epsilon_r K + \epsilon_a @f$, so the error of the
+ * average kernel value of each query point is bounded by @f$ \epsilon_r @f$
+ * times the average plus @f$ \epsilon_a @f$.  With both tolerances set to 0,
+ * only combinations on which the kernel is constant are pruned, and the
+ * results are exact.
+ *
+ * Every reference point must be held by exactly one leaf, and each node's
+ * points must be its descendants, so trees with
+ * TreeTraits::FirstPointIsCentroid (such as the cover tree) are not supported.
+ */
+template<typename MetricType, typename KernelType, typename TreeType>
+class KDERules
+{
+ public:
+  /**
+   * Construct the KDERules object.  This is usually done from within the KDE
+   * class at evaluation time.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param densities Vector to accumulate the kernel sums of each query point
+   *      in.  It must be of size querySet.n_cols and is not reset.
+   * @param relError Relative error tolerance of each kernel value.
+   * @param absError Absolute error tolerance of each kernel value.
+   * @param metric Instantiated metric.
+   * @param kernel Instantiated kernel.
+   */
+  KDERules(const typename TreeType::Mat& referenceSet,
+           const typename TreeType::Mat& querySet,
+           arma::vec& densities,
+           const double relError,
+           const double absError,
+           MetricType& metric,
+           const KernelType& kernel);
+
+  /**
+   * Compute the base case between the given query point and reference point,
+   * adding the kernel value to the density of the query point.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceIndex Index of reference point.
+   */
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  /**
+   * Get the score for recursion order.  If the kernel values between the query
+   * point and the points of the reference node are close enough to each other,
+   * their approximation is added to the density of the query point and DBL_MAX
+   * is returned (the node is pruned).
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   */
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.  The pruning rule does not
+   * depend on anything found during the traversal, so this returns the old
+   * score.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  /**
+   * Get the score for recursion order.  If the kernel values between the points
+   * of the two nodes are close enough to each other, their approximation is
+   * added to the density of every descendant of the query node and DBL_MAX is
+   * returned (the combination is pruned).
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   */
+  double Score(TreeType& queryNode, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.  The pruning rule does not
+   * depend on anything found during the traversal, so this returns the old
+   * score.
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(TreeType& queryNode,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  //! Get the number of base cases that have been performed.
+  size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases that have been performed.
+  size_t& BaseCases() { return baseCases; }
+
+  //! Get the number of scores that have been performed.
+  size_t Scores() const { return scores; }
+  //! Modify the number of scores that have been performed.
+  size_t& Scores() { return scores; }
+
+  typedef tree::TraversalInfo<TreeType> TraversalInfoType;
+
+  const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+ private:
+  //! The reference set.
+  const typename TreeType::Mat& referenceSet;
+
+  //! The query set.
+  const typename TreeType::Mat& querySet;
+
+  //! The kernel sums of each query point.
+  arma::vec& densities;
+
+  //! The relative error tolerance.
+  double relError;
+  //! The absolute error tolerance.
+  double absError;
+
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The instantiated kernel.
+  const KernelType& kernel;
+
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of scores.
+  size_t scores;
+
+  TraversalInfoType traversalInfo;
+
+  /**
+   * If the kernel can be approximated on the given range of distances, return
+   * the approximate kernel value through the estimate parameter and return
+   * true.
+   */
+  bool Approximate(const math::Range& distances, double& estimate) const;
+};
+
+}; // namespace kde
+}; // namespace mlpack
+
+// Include implementation.
+#include "kde_rules_impl.hpp"
+
+#endif
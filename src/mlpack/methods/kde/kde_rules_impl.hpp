@@ -0,0 +1,142 @@
+/**
+ * @file kde_rules_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of rules for kernel density estimation with generic trees.
+ */
+#ifndef __MLPACK_METHODS_KDE_KDE_RULES_IMPL_HPP
+#define __MLPACK_METHODS_KDE_KDE_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde_rules.hpp"
+
+namespace mlpack {
+namespace kde {
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDERules<MetricType, KernelType, TreeType>::KDERules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    arma::vec& densities,
+    const double relError,
+    const double absError,
+    MetricType& metric,
+    const KernelType& kernel) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    densities(densities),
+    relError(relError),
+    absError(absError),
+    metric(metric),
+    kernel(kernel),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+//! The base case.  Evaluate the kernel between the two points and add it to the
+//! density of the query point.
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline
+double KDERules<MetricType, KernelType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
+{
+  const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
+      referenceSet.unsafe_col(referenceIndex));
+  ++baseCases;
+
+  densities[queryIndex] += kernel.Evaluate(distance);
+
+  return distance;
+}
+
+//! Single-tree scoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  ++scores;
+
+  const math::Range distances =
+      referenceNode.RangeDistance(querySet.unsafe_col(queryIndex));
+
+  double estimate;
+  if (Approximate(distances, estimate))
+  {
+    densities[queryIndex] += referenceNode.NumDescendants() * estimate;
+    return DBL_MAX;
+  }
+
+  // Recurse into closer nodes first; they hold the largest kernel values.
+  return distances.Lo();
+}
+
+//! Single-tree rescoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Rescore(
+    const size_t /* queryIndex */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  // If it wasn't pruned before, it isn't pruned now.
+  return oldScore;
+}
+
+//! Dual-tree scoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  ++scores;
+
+  const math::Range distances = referenceNode.RangeDistance(&queryNode);
+
+  double estimate;
+  if (Approximate(distances, estimate))
+  {
+    // Every query point gets the same contribution from the reference node.
+    const double contribution = referenceNode.NumDescendants() * estimate;
+    for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+      densities[queryNode.Descendant(i)] += contribution;
+    return DBL_MAX;
+  }
+
+  return distances.Lo();
+}
+
+//! Dual-tree rescoring function.
+template<typename MetricType, typename KernelType, typename TreeType>
+double KDERules<MetricType, KernelType, TreeType>::Rescore(
+    TreeType& /* queryNode */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  // If it wasn't pruned before, it isn't pruned now.
+  return oldScore;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+bool KDERules<MetricType, KernelType, TreeType>::Approximate(
+    const math::Range& distances,
+    double& estimate) const
+{
+  // The kernel is non-increasing, so these bound every kernel value.
+  const double maxKernel = kernel.Evaluate(distances.Lo());
+  const double minKernel = kernel.Evaluate(distances.Hi());
+
+  // The midpoint is off by at most half the width of the interval.
+  if (maxKernel - minKernel > 2.0 * (relError * minKernel + absError))
+    return false;
+
+  estimate = (maxKernel + minKernel) / 2.0;
+  return true;
+}
+
+}; // namespace kde
+}; // namespace mlpack
+
+#endif
@@ -101,6 +101,19 @@ class KernelPCA
    */
   void Apply(arma::mat& data, const size_t newDimension);
 
+  /**
+   * Project new points onto the components found by the last call to Apply(),
+   * without refitting: the kernel between the new points and the points kept
+   * from the fit (the training points, or the landmarks of the Nystroem
+   * method) is computed in blocks of points, in parallel, and centered and
+   * projected as the training points were.  The transformed points have the
+   * same dimension as those returned by Apply().
+   *
+   * @param newData Points to project (one point per column).
+   * @param transformedData Matrix to output results into.
+   */
+  void Transform(const arma::mat& newData, arma::mat& transformedData) const;
+
   //! Get the kernel.
   const KernelType& Kernel() const { return kernel; }
   //! Modify the kernel.
@@ -121,6 +134,15 @@ class KernelPCA
   //! run.
   bool centerTransformedData;
 
+  //! The number of points of a block in Transform().
+  static const size_t BlockSize = 256;
+
+  //! The points that new points are compared to with the kernel.
+  arma::mat basis;
+  //! The projection of the kernel values of a new point.
+  arma::mat projection;
+  //! The offset of the projection.
+  arma::vec offset;
 }; // class KernelPCA
 
 }; // namespace kpca
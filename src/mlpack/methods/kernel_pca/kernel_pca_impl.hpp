@@ -12,6 +12,8 @@
 // In case it hasn't already been included.
 #include "kernel_pca.hpp"
 
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
 namespace mlpack {
 namespace kpca {
 
@@ -31,7 +33,8 @@ void KernelPCA<KernelType, KernelRule>::Apply(const arma::mat& data,
                                   const size_t newDimension)
 {
   KernelRule::ApplyKernelMatrix(data, transformedData, eigval,
-                                eigvec, newDimension, kernel);
+                                eigvec, newDimension, kernel, basis,
+                                projection, offset);
 
   // Center the transformed data, if the user asked for it.
   if (centerTransformedData)
@@ -39,6 +42,7 @@ void KernelPCA<KernelType, KernelRule>::Apply(const arma::mat& data,
     arma::colvec transformedDataMean = arma::mean(transformedData, 1);
     transformedData = transformedData - (transformedDataMean *
         arma::ones<arma::rowvec>(transformedData.n_cols));
+    offset -= transformedDataMean;
   }
 }
 
@@ -72,8 +76,55 @@ void KernelPCA<KernelType, KernelRule>::Apply(arma::mat& data,
 
   Apply(data, data, eigVal, coeffs, newDimension);
 
-  if (newDimension < coeffs.n_rows && newDimension > 0)
+  // The kernel rule may have computed only the needed components already.
+  if (newDimension < data.n_rows && newDimension > 0)
+  {
     data.shed_rows(newDimension, data.n_rows - 1);
+    projection.shed_rows(newDimension, projection.n_rows - 1);
+    offset.shed_rows(newDimension, offset.n_rows - 1);
+  }
+}
+
+//! Project new points onto the components of the last fit.
+template <typename KernelType, typename KernelRule>
+void KernelPCA<KernelType, KernelRule>::Transform(
+    const arma::mat& newData,
+    arma::mat& transformedData) const
+{
+  if (basis.n_cols == 0)
+  {
+    Log::Fatal << "KernelPCA::Transform(): Apply() must be called before new "
+        << "points can be projected!" << std::endl;
+  }
+
+  if (newData.n_rows != basis.n_rows)
+  {
+    Log::Fatal << "KernelPCA::Transform(): the points have " << newData.n_rows
+        << " dimensions, but the model was fit on points with "
+        << basis.n_rows << " dimensions!" << std::endl;
+  }
+
+  transformedData.set_size(projection.n_rows, newData.n_cols);
+  const size_t numBlocks = (newData.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize,
+        (size_t) newData.n_cols) - 1;
+
+    // Kernels are evaluated through non-const references, so every block gets
+    // its own copy.
+    KernelType blockKernel(kernel);
+    arma::mat kernelValues;
+    kernel::KernelMatrix(blockKernel, basis, newData.cols(begin, end),
+        kernelValues);
+
+    arma::mat block = projection * kernelValues;
+    block.each_col() += offset;
+    transformedData.cols(begin, end) = block;
+  }
 }
 
 //! Returns a string representation of the object.
@@ -8,6 +8,7 @@
 #include <mlpack/methods/nystroem_method/ordered_selection.hpp>
 #include <mlpack/methods/nystroem_method/random_selection.hpp>
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
+#include <mlpack/methods/nystroem_method/kmeans_plus_plus_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
 
@@ -70,7 +71,9 @@ PROGRAM_INFO("Kernel Principal Components Analysis",
     " a subset of the data as basis to reconstruct the kernel matrix; to specify"
     " the sampling scheme, the --sampling parameter is used, the sampling scheme"
     " for the nystr\u00F6m method can be chosen from the following list: kmeans,"
-    " random, ordered.");
+    " kmeans++, random, ordered.  The 'kmeans++' scheme uses the seeding of "
+    "k-means++ instead of a full k-means clustering, which is much faster for "
+    "large datasets.");
 
 PARAM_STRING_REQ("input_file", "Input dataset to perform KPCA on.", "i");
 PARAM_STRING_REQ("output_file", "File to save modified dataset to.", "o");
@@ -87,7 +90,7 @@ PARAM_FLAG("center", "If set, the transformed data will be centered about the "
 PARAM_FLAG("nystroem_method", "If set, the nystroem method will be used.", "n");
 
 PARAM_STRING("sampling", "Sampling scheme to use for the nystroem method: "
-    "'kmeans', 'random', 'ordered'", "s", "kmeans");
+    "'kmeans', 'kmeans++', 'random', 'ordered'", "s", "kmeans");
 
 PARAM_DOUBLE("kernel_scale", "Scale, for 'hyptan' kernel.", "S", 1.0);
 PARAM_DOUBLE("offset", "Offset, for 'hyptan' and 'polynomial' kernels.", "O",
@@ -115,6 +118,12 @@ void RunKPCA(arma::mat& dataset,
           KMeansSelection<> > >kpca;
       kpca.Apply(dataset, newDim);
     }
+    else if (sampling == "kmeans++")
+    {
+      KernelPCA<KernelType, NystroemKernelRule<KernelType,
+          KMeansPlusPlusSelection> > kpca;
+      kpca.Apply(dataset, newDim);
+    }
     else if (sampling == "random")
     {
       KernelPCA<KernelType, NystroemKernelRule<KernelType,
@@ -131,7 +140,7 @@ void RunKPCA(arma::mat& dataset,
     {
       // Invalid sampling scheme.
       Log::Fatal << "Invalid sampling scheme ('" << sampling << "'); valid "
-        << "choices are 'kmeans', 'random' and 'ordered'" << endl;
+        << "choices are 'kmeans', 'kmeans++', 'random' and 'ordered'" << endl;
     }
   }
   else
@@ -9,6 +9,7 @@
 #define __MLPACK_METHODS_KERNEL_PCA_NAIVE_METHOD_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/methods/fastmks/batch_kernel_evaluation.hpp>
 
 namespace mlpack {
 namespace kpca {
@@ -18,44 +19,64 @@ class NaiveKernelRule
 {
   public:
     /**
-     * Construct the exact kernel matrix.
+     * Construct the exact kernel matrix.  If only a few components are needed
+     * (rank is much smaller than the number of points), only those are
+     * computed, with a truncated eigendecomposition; then transformedData has
+     * rank rows, eigval has rank elements, and eigvec has rank columns.
      *
      * @param data Input data points.
      * @param transformedData Matrix to output results into.
      * @param eigval KPCA eigenvalues will be written to this vector.
      * @param eigvec KPCA eigenvectors will be written to this matrix.
-     * @param rank Rank to be used for matrix approximation.
+     * @param rank Number of components needed.
      * @param kernel Kernel to be used for computation.
      */
     static void ApplyKernelMatrix(const arma::mat& data,
                                   arma::mat& transformedData,
                                   arma::vec& eigval,
                                   arma::mat& eigvec,
-                                  const size_t /* unused */,
+                                  const size_t rank,
                                   KernelType kernel = KernelType())
   {
-    // Construct the kernel matrix.
-    arma::mat kernelMatrix;
-    // Resize the kernel matrix to the right size.
-    kernelMatrix.set_size(data.n_cols, data.n_cols);
+    arma::mat basis, projection;
+    arma::vec offset;
+    ApplyKernelMatrix(data, transformedData, eigval, eigvec, rank, kernel,
+        basis, projection, offset);
+  }
 
-    // Note that we only need to calculate the upper triangular part of the
-    // kernel matrix, since it is symmetric. This helps minimize the number of
-    // kernel evaluations.
-    for (size_t i = 0; i < data.n_cols; ++i)
-    {
-      for (size_t j = i; j < data.n_cols; ++j)
-      {
-        // Evaluate the kernel on these two points.
-        kernelMatrix(i, j) = kernel.Evaluate(data.unsafe_col(i),
-                                             data.unsafe_col(j));
-      }
-    }
+    /**
+     * Construct the exact kernel matrix, as above, and also return the affine
+     * map that projects new points: the transformed point x is
+     * projection * [K(b_1, x), ..., K(b_n, x)]^T + offset, where b_i are the
+     * columns of basis (here, the training points).
+     *
+     * @param data Input data points.
+     * @param transformedData Matrix to output results into.
+     * @param eigval KPCA eigenvalues will be written to this vector.
+     * @param eigvec KPCA eigenvectors will be written to this matrix.
+     * @param rank Number of components needed.
+     * @param kernel Kernel to be used for computation.
+     * @param basis Matrix to store the points new points are compared to in.
+     * @param projection Matrix to store the projection of the kernel values of
+     *     new points in.
+     * @param offset Vector to store the offset of the projection in.
+     */
+    static void ApplyKernelMatrix(const arma::mat& data,
+                                  arma::mat& transformedData,
+                                  arma::vec& eigval,
+                                  arma::mat& eigvec,
+                                  const size_t rank,
+                                  KernelType kernel,
+                                  arma::mat& basis,
+                                  arma::mat& projection,
+                                  arma::vec& offset)
+  {
+    // The data may be the same matrix as the transformed data.
+    basis = data;
 
-    // Copy to the lower triangular part of the matrix.
-    for (size_t i = 1; i < data.n_cols; ++i)
-      for (size_t j = 0; j < i; ++j)
-        kernelMatrix(i, j) = kernelMatrix(j, i);
+    // Construct the kernel matrix.
+    arma::mat kernelMatrix;
+    KernelMatrix(data, kernel, kernelMatrix);
 
     // For PCA the data has to be centered, even if the data is centered. But it
     // is not guaranteed that the data, when mapped to the kernel space, is also
@@ -63,24 +84,127 @@ class NaiveKernelRule
     // center the data. So, we perform a "psuedo-centering" using the kernel
     // matrix.
     arma::rowvec rowMean = arma::sum(kernelMatrix, 0) / kernelMatrix.n_cols;
-    kernelMatrix.each_col() -= arma::sum(kernelMatrix, 1) / kernelMatrix.n_cols;
+    const arma::vec colMean = arma::sum(kernelMatrix, 1) / kernelMatrix.n_cols;
+    const double mean = arma::sum(rowMean) / kernelMatrix.n_cols;
+    kernelMatrix.each_col() -= colMean;
     kernelMatrix.each_row() -= rowMean;
-    kernelMatrix += arma::sum(rowMean) / kernelMatrix.n_cols;
+    kernelMatrix += mean;
 
-    // Eigendecompose the centered kernel matrix.
-    arma::eig_sym(eigval, eigvec, kernelMatrix);
+    if (rank > 0 && 4 * (rank + Oversampling) <= data.n_cols)
+    {
+      TruncatedEigendecomposition(kernelMatrix, rank, eigval, eigvec);
+    }
+    else
+    {
+      // Eigendecompose the centered kernel matrix.
+      arma::eig_sym(eigval, eigvec, kernelMatrix);
 
-    // Swap the eigenvalues since they are ordered backwards (we need largest to
-    // smallest).
-    for (size_t i = 0; i < floor(eigval.n_elem / 2.0); ++i)
-      eigval.swap_rows(i, (eigval.n_elem - 1) - i);
+      // Swap the eigenvalues since they are ordered backwards (we need largest
+      // to smallest).
+      for (size_t i = 0; i < floor(eigval.n_elem / 2.0); ++i)
+        eigval.swap_rows(i, (eigval.n_elem - 1) - i);
 
-    // Flip the coefficients to produce the same effect.
-    eigvec = arma::fliplr(eigvec);
+      // Flip the coefficients to produce the same effect.
+      eigvec = arma::fliplr(eigvec);
+    }
 
     transformedData = eigvec.t() * kernelMatrix;
     transformedData.each_col() /= arma::sqrt(eigval);
+
+    // The kernel values k of a new point are centered in the same way, as
+    // k - colMean - mean(k) + mean, before they are projected; all of that is
+    // folded into the projection and the offset.
+    projection = eigvec.t();
+    projection.each_col() /= arma::sqrt(eigval);
+    const arma::vec projectionSums = arma::sum(projection, 1);
+    offset = mean * projectionSums - projection * colMean;
+    projection.each_col() -= projectionSums / data.n_cols;
   }
+
+  private:
+    //! The number of extra directions used by the truncated eigendecomposition.
+    static const size_t Oversampling = 10;
+    //! The number of subspace iterations of the truncated eigendecomposition.
+    static const size_t PowerIterations = 4;
+    //! The number of columns of the kernel matrix computed at once.
+    static const size_t BlockSize = 64;
+
+    /**
+     * Compute the kernel matrix of the data.  Kernels that can be evaluated
+     * with matrix products (see fastmks::BatchKernelEvaluation) are; for the
+     * others, only the upper triangular part is evaluated, since the matrix is
+     * symmetric, in blocks of columns in parallel.
+     */
+    static void KernelMatrix(const arma::mat& data,
+                             KernelType& kernel,
+                             arma::mat& kernelMatrix)
+    {
+      if (fastmks::BatchKernelEvaluation<KernelType>::MatrixProducts)
+      {
+        fastmks::BatchKernelEvaluation<KernelType>::Evaluate(kernel, data,
+            data, kernelMatrix);
+        return;
+      }
+
+      kernelMatrix.set_size(data.n_cols, data.n_cols);
+      const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+      // The blocks get smaller towards the left, so they are handed out
+      // dynamically.
+      #pragma omp parallel for schedule(dynamic)
+      for (size_t b = 0; b < numBlocks; ++b)
+      {
+        const size_t end = std::min((b + 1) * BlockSize,
+            (size_t) data.n_cols);
+        for (size_t j = b * BlockSize; j < end; ++j)
+        {
+          for (size_t i = 0; i <= j; ++i)
+          {
+            // Evaluate the kernel on these two points.
+            kernelMatrix(i, j) = kernel.Evaluate(data.unsafe_col(i),
+                                                 data.unsafe_col(j));
+          }
+        }
+      }
+
+      // Copy to the lower triangular part of the matrix.
+      for (size_t i = 1; i < data.n_cols; ++i)
+        for (size_t j = 0; j < i; ++j)
+          kernelMatrix(i, j) = kernelMatrix(j, i);
+    }
+
+    /**
+     * Compute the rank largest eigenvalues (from largest to smallest) and the
+     * corresponding eigenvectors of the centered kernel matrix, with randomized
+     * subspace iteration: a few multiplications of a random basis by the
+     * matrix make it span the dominant eigenvectors, and the small projection
+     * of the matrix on that basis is then eigendecomposed.
+     */
+    static void TruncatedEigendecomposition(const arma::mat& kernelMatrix,
+                                            const size_t rank,
+                                            arma::vec& eigval,
+                                            arma::mat& eigvec)
+    {
+      arma::mat basis, r;
+      arma::mat product = kernelMatrix *
+          arma::randn<arma::mat>(kernelMatrix.n_rows, rank + Oversampling);
+      arma::qr_econ(basis, r, product);
+      for (size_t i = 0; i < PowerIterations; ++i)
+      {
+        product = kernelMatrix * basis;
+        arma::qr_econ(basis, r, product);
+      }
+
+      const arma::mat projection = basis.t() * kernelMatrix * basis;
+      arma::vec projectionEigval;
+      arma::mat projectionEigvec;
+      arma::eig_sym(projectionEigval, projectionEigvec,
+          0.5 * (projection + projection.t()));
+
+      // The eigenvalues are in ascending order.
+      eigval = arma::flipud(projectionEigval.tail(rank));
+      eigvec = basis * arma::fliplr(projectionEigvec.tail_cols(rank));
+    }
 };
 
 }; // namespace kpca
@@ -10,7 +10,7 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
-#include <mlpack/methods/nystroem_method/nystroem_method.hpp>
+#include <mlpack/methods/nystroem_method/nystroem_features.hpp>
 
 namespace mlpack {
 namespace kpca {
@@ -39,10 +39,50 @@ class NystroemKernelRule
                                   const size_t rank,
                                   KernelType kernel = KernelType())
     {
-      arma::mat G, v;
-      kernel::NystroemMethod<KernelType, PointSelectionPolicy> nm(data, kernel,
-                                                        rank);
-      nm.Apply(G);
+      arma::mat basis, projection;
+      arma::vec offset;
+      ApplyKernelMatrix(data, transformedData, eigval, eigvec, rank, kernel,
+          basis, projection, offset);
+    }
+
+    /**
+     * Construct the kernel matrix approximation using the nystroem method, as
+     * above, and also return the affine map that projects new points: the
+     * transformed point x is projection * [K(b_1, x), ..., K(b_m, x)]^T +
+     * offset, where b_i are the columns of basis (here, the selected
+     * landmarks).
+     *
+     * @param data Input data points.
+     * @param transformedData Matrix to output results into.
+     * @param eigval KPCA eigenvalues will be written to this vector.
+     * @param eigvec KPCA eigenvectors will be written to this matrix.
+     * @param rank Rank to be used for matrix approximation.
+     * @param kernel Kernel to be used for computation.
+     * @param basis Matrix to store the points new points are compared to in.
+     * @param projection Matrix to store the projection of the kernel values of
+     *     new points in.
+     * @param offset Vector to store the offset of the projection in.
+     */
+    static void ApplyKernelMatrix(const arma::mat& data,
+                                  arma::mat& transformedData,
+                                  arma::vec& eigval,
+                                  arma::mat& eigvec,
+                                  const size_t rank,
+                                  KernelType kernel,
+                                  arma::mat& basis,
+                                  arma::mat& projection,
+                                  arma::vec& offset)
+    {
+      // The rows of G are the Nystroem features of the points, so that
+      // G * G^T approximates the kernel matrix.
+      kernel::NystroemFeatures<KernelType, PointSelectionPolicy> nystroem(
+          kernel, rank);
+      nystroem.Train(data);
+      arma::mat G;
+      nystroem.Transform(data, G);
+      arma::inplace_trans(G);
+
+      basis = nystroem.Landmarks();
       transformedData = G.t() * G;
 
       // Center the reconstructed approximation.
@@ -53,10 +93,12 @@ class NystroemKernelRule
       // also centered. Since we actually never work in the feature space we
       // cannot center the data. So, we perform a "psuedo-centering" using the
       // kernel matrix.
+      const arma::rowvec rowMean = arma::sum(G, 0) / G.n_rows;
       arma::colvec colMean = arma::sum(G, 1) / G.n_rows;
-      G.each_row() -= arma::sum(G, 0) / G.n_rows;
+      const double mean = arma::sum(colMean) / G.n_rows;
+      G.each_row() -= rowMean;
       G.each_col() -= colMean;
-      G += arma::sum(colMean) / G.n_rows;
+      G += mean;
 
       // Eigendecompose the centered kernel matrix.
       arma::eig_sym(eigval, eigvec, transformedData);
@@ -70,6 +112,14 @@ class NystroemKernelRule
       eigvec = arma::fliplr(eigvec);
 
       transformedData = eigvec.t() * G.t();
+
+      // The features g of a new point are centered in the same way, as
+      // g - rowMean^T - sum(g) / n + mean, before they are projected; all of
+      // that is folded into the projection and the offset.
+      const arma::mat& normalization = nystroem.Normalization();
+      projection = eigvec.t() * normalization -
+          arma::sum(eigvec, 0).t() * arma::sum(normalization, 0) / G.n_rows;
+      offset = eigvec.t() * (mean - rowMean.t());
     }
 };
 
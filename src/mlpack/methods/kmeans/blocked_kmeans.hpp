@@ -0,0 +1,78 @@
+/**
+ * @file blocked_kmeans.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * that computes all point-to-centroid distances of a block of points with a
+ * single matrix multiplication.  This is a good choice for high-dimensional
+ * data with many clusters, where the tree-based and bound-based algorithms
+ * cannot prune much.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_HPP
+#define __MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_HPP
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single iteration of Lloyd's algorithm for
+ * k-means that, like NaiveKMeans, compares every point to every centroid, but
+ * does so with dense linear algebra.  The points are split into blocks; for
+ * each block, ||x||^2 + ||c||^2 - 2 x^T c is obtained for every point x and
+ * centroid c with one matrix multiplication (||x||^2 does not change which
+ * centroid is closest, so it is never computed).  The blocks are processed in
+ * parallel with OpenMP, with each thread accumulating its own new centroids
+ * that are summed at the end.
+ *
+ * Because of the expansion above, this class is only valid when MetricType is
+ * the Euclidean distance (or squared Euclidean distance).
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class BlockedKMeans
+{
+ public:
+  /**
+   * Construct the BlockedKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   */
+  BlockedKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Lloyd algorithm, updating the given centroids
+   * into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with new counts.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! The number of points in each block.
+  static const size_t BlockSize = 512;
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "blocked_kmeans_impl.hpp"
+
+#endif
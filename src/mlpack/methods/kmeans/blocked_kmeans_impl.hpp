@@ -0,0 +1,106 @@
+/**
+ * @file blocked_kmeans_impl.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * that computes all point-to-centroid distances of a block of points with a
+ * single matrix multiplication.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "blocked_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+BlockedKMeans<MetricType, MatType>::BlockedKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double BlockedKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+
+  // The squared norms of the centroids, as a column so they can be added to
+  // each column of the distance block.
+  const arma::vec centroidNorms = arma::trans(arma::sum(arma::square(
+      centroids), 0));
+
+  const size_t numBlocks = (dataset.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel
+  {
+    // Each thread accumulates its own centroids and counts.
+    arma::mat threadCentroids;
+    threadCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    arma::Col<size_t> threadCounts;
+    threadCounts.zeros(centroids.n_cols);
+
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) dataset.n_cols);
+
+      // Copy the block into dense contiguous memory (this also takes care of
+      // sparse datasets), then compute ||c||^2 - 2 c^T x for every centroid c
+      // and point x in the block.
+      const arma::mat block(dataset.cols(begin, end - 1));
+      arma::mat distances = centroids.t() * block;
+      distances *= -2.0;
+      distances.each_col() += centroidNorms;
+
+      // Find the closest centroid to each point and update the new centroids.
+      for (size_t i = 0; i < block.n_cols; ++i)
+      {
+        arma::uword closestCluster;
+        distances.col(i).min(closestCluster);
+
+        threadCentroids.col(closestCluster) += block.col(i);
+        threadCounts(closestCluster)++;
+      }
+    }
+
+    #pragma omp critical(blocked_kmeans_reduce)
+    {
+      newCentroids += threadCentroids;
+      counts += threadCounts;
+    }
+  }
+
+  // Now normalize the centroid.
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    if (counts(i) != 0)
+      newCentroids.col(i) /= counts(i);
+    else
+      newCentroids.col(i).fill(DBL_MAX); // Invalid value.
+
+  distanceCalculations += centroids.n_cols * dataset.n_cols;
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
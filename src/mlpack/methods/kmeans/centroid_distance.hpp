@@ -0,0 +1,160 @@
+/**
+ * @file centroid_distance.hpp
+ * @author Ryan Curtin
+ *
+ * Distances between the points of a dataset of any type (dense or sparse,
+ * double or float) and the centroids of k-means clustering.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_CENTROID_DISTANCE_HPP
+#define __MLPACK_METHODS_KMEANS_CENTROID_DISTANCE_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This class computes the distances between the points of a dataset and the
+ * centroids of k-means clustering, which are always held in an arma::mat.  The
+ * dataset can be an arma::mat, an arma::fmat, or a sparse matrix of either
+ * type.  The centroids are converted to the element type of the dataset once
+ * for each set of centroids, so that the points are never converted.  For
+ * sparse datasets and the Euclidean (or squared Euclidean) distance, the
+ * squared norms of the points and the centroids are precomputed, and only the
+ * nonzero values of a point are used:
+ *
+ * \f[
+ * d(x, c)^2 = \| x \|^2 + \| c \|^2 - 2 x^T c.
+ * \f]
+ *
+ * With other metrics, sparse points are made dense before they are passed to
+ * the metric.  Evaluate() can be called from several threads at once.
+ *
+ * @code
+ * CentroidDistance<metric::EuclideanDistance, arma::sp_mat> distance(data,
+ *     metric);
+ * distance.Centroids(centroids);
+ * const double d = distance.Evaluate(point, cluster);
+ * @endcode
+ *
+ * @tparam MetricType Metric to use.
+ * @tparam MatType Type of the dataset.
+ */
+template<typename MetricType, typename MatType>
+class CentroidDistance
+{
+ public:
+  //! The element type of the dataset.
+  typedef typename MatType::elem_type ElemType;
+
+  /**
+   * Prepare to compute distances to the points of the given dataset.  For
+   * sparse datasets, this computes the squared norms of the points.
+   *
+   * @param dataset Dataset of points.
+   * @param metric Instantiated metric.
+   */
+  CentroidDistance(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Set the centroids that distances are computed to.  This must be called
+   * again every time the centroids change.
+   *
+   * @param centroids Centroids (one per column).
+   */
+  void Centroids(const arma::mat& centroids);
+
+  /**
+   * Return the distance between the given point of the dataset and the given
+   * centroid.
+   *
+   * @param point Index of the point.
+   * @param centroid Index of the centroid.
+   */
+  double Evaluate(const size_t point, const size_t centroid) const;
+
+ private:
+  //! Distance from a dense point.
+  template<typename eT>
+  double Evaluate(const arma::Mat<eT>& data,
+                  const size_t point,
+                  const size_t centroid) const;
+
+  //! Distance from a sparse point.
+  template<typename eT>
+  double Evaluate(const arma::SpMat<eT>& data,
+                  const size_t point,
+                  const size_t centroid) const;
+
+  //! Euclidean distance from a sparse point, with the precomputed norms.
+  template<typename eT, bool TakeRoot>
+  double SparseEvaluate(metric::LMetric<2, TakeRoot>& metric,
+                        const arma::SpMat<eT>& data,
+                        const size_t point,
+                        const size_t centroid) const;
+
+  //! Distance from a sparse point with any other metric.
+  template<typename eT, typename OtherMetricType>
+  double SparseEvaluate(OtherMetricType& metric,
+                        const arma::SpMat<eT>& data,
+                        const size_t point,
+                        const size_t centroid) const;
+
+  //! Dense datasets need no norms.
+  template<typename eT>
+  static void SquaredNorms(const arma::Mat<eT>& data, arma::vec& norms);
+
+  //! Compute the squared norm of every point of a sparse dataset.
+  template<typename eT>
+  static void SquaredNorms(const arma::SpMat<eT>& data, arma::vec& norms);
+
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The centroids, converted to the element type of the dataset.
+  arma::Mat<ElemType> centroids;
+  //! The squared norms of the points (sparse datasets only).
+  arma::vec pointNorms;
+  //! The squared norms of the centroids (sparse datasets only).
+  arma::vec centroidNorms;
+};
+
+/**
+ * Add the given point of a dense dataset to the given column of a matrix of
+ * sums (such as the new centroids).
+ *
+ * @param dataset Dataset of points.
+ * @param point Index of the point to add.
+ * @param sums Matrix to add the point to.
+ * @param column Column of sums to add the point to.
+ */
+template<typename eT>
+void AddPoint(const arma::Mat<eT>& dataset,
+              const size_t point,
+              arma::mat& sums,
+              const size_t column);
+
+/**
+ * Add the given point of a sparse dataset to the given column of a matrix of
+ * sums (such as the new centroids); only the nonzero values are visited.
+ *
+ * @param dataset Dataset of points.
+ * @param point Index of the point to add.
+ * @param sums Matrix to add the point to.
+ * @param column Column of sums to add the point to.
+ */
+template<typename eT>
+void AddPoint(const arma::SpMat<eT>& dataset,
+              const size_t point,
+              arma::mat& sums,
+              const size_t column);
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+// Include implementation.
+#include "centroid_distance_impl.hpp"
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file centroid_distance_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the CentroidDistance class and of AddPoint().
+ */
+#ifndef __MLPACK_METHODS_KMEANS_CENTROID_DISTANCE_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_CENTROID_DISTANCE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "centroid_distance.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+CentroidDistance<MetricType, MatType>::CentroidDistance(
+    const MatType& dataset,
+    MetricType& metric) :
+    dataset(dataset),
+    metric(metric)
+{
+  SquaredNorms(dataset, pointNorms);
+}
+
+template<typename MetricType, typename MatType>
+void CentroidDistance<MetricType, MatType>::Centroids(
+    const arma::mat& newCentroids)
+{
+  centroids = arma::conv_to<arma::Mat<ElemType> >::from(newCentroids);
+
+  // The norms are only used for sparse datasets.
+  if (pointNorms.n_elem > 0)
+    centroidNorms = arma::trans(arma::sum(arma::square(newCentroids), 0));
+}
+
+template<typename MetricType, typename MatType>
+inline double CentroidDistance<MetricType, MatType>::Evaluate(
+    const size_t point,
+    const size_t centroid) const
+{
+  return Evaluate(dataset, point, centroid);
+}
+
+template<typename MetricType, typename MatType>
+template<typename eT>
+inline double CentroidDistance<MetricType, MatType>::Evaluate(
+    const arma::Mat<eT>& data,
+    const size_t point,
+    const size_t centroid) const
+{
+  return metric.Evaluate(data.unsafe_col(point),
+                         centroids.unsafe_col(centroid));
+}
+
+template<typename MetricType, typename MatType>
+template<typename eT>
+inline double CentroidDistance<MetricType, MatType>::Evaluate(
+    const arma::SpMat<eT>& data,
+    const size_t point,
+    const size_t centroid) const
+{
+  return SparseEvaluate(metric, data, point, centroid);
+}
+
+template<typename MetricType, typename MatType>
+template<typename eT, bool TakeRoot>
+inline double CentroidDistance<MetricType, MatType>::SparseEvaluate(
+    metric::LMetric<2, TakeRoot>& /* metric */,
+    const arma::SpMat<eT>& data,
+    const size_t point,
+    const size_t centroid) const
+{
+  const eT* c = centroids.colptr(centroid);
+  double dot = 0.0;
+  for (size_t j = data.col_ptrs[point]; j < data.col_ptrs[point + 1]; ++j)
+    dot += double(data.values[j]) * double(c[data.row_indices[j]]);
+
+  // Rounding can make the squared distance of a point from itself slightly
+  // negative.
+  const double squaredDistance = std::max(pointNorms[point] +
+      centroidNorms[centroid] - 2.0 * dot, 0.0);
+
+  return TakeRoot ? std::sqrt(squaredDistance) : squaredDistance;
+}
+
+template<typename MetricType, typename MatType>
+template<typename eT, typename OtherMetricType>
+inline double CentroidDistance<MetricType, MatType>::SparseEvaluate(
+    OtherMetricType& metric,
+    const arma::SpMat<eT>& data,
+    const size_t point,
+    const size_t centroid) const
+{
+  arma::Col<eT> densePoint(data.n_rows, arma::fill::zeros);
+  for (size_t j = data.col_ptrs[point]; j < data.col_ptrs[point + 1]; ++j)
+    densePoint[data.row_indices[j]] = data.values[j];
+
+  return metric.Evaluate(densePoint, centroids.unsafe_col(centroid));
+}
+
+template<typename MetricType, typename MatType>
+template<typename eT>
+void CentroidDistance<MetricType, MatType>::SquaredNorms(
+    const arma::Mat<eT>& /* data */,
+    arma::vec& norms)
+{
+  norms.reset();
+}
+
+template<typename MetricType, typename MatType>
+template<typename eT>
+void CentroidDistance<MetricType, MatType>::SquaredNorms(
+    const arma::SpMat<eT>& data,
+    arma::vec& norms)
+{
+  norms.zeros(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    for (size_t j = data.col_ptrs[i]; j < data.col_ptrs[i + 1]; ++j)
+      norms[i] += double(data.values[j]) * double(data.values[j]);
+}
+
+template<typename eT>
+inline void AddPoint(const arma::Mat<eT>& dataset,
+                     const size_t point,
+                     arma::mat& sums,
+                     const size_t column)
+{
+  const eT* p = dataset.colptr(point);
+  double* s = sums.colptr(column);
+  for (size_t d = 0; d < dataset.n_rows; ++d)
+    s[d] += p[d];
+}
+
+template<typename eT>
+inline void AddPoint(const arma::SpMat<eT>& dataset,
+                     const size_t point,
+                     arma::mat& sums,
+                     const size_t column)
+{
+  double* s = sums.colptr(column);
+  for (size_t j = dataset.col_ptrs[point]; j < dataset.col_ptrs[point + 1];
+       ++j)
+    s[dataset.row_indices[j]] += dataset.values[j];
+}
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+#endif
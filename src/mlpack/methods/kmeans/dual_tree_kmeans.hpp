@@ -25,6 +25,10 @@ namespace kmeans {
  * dataset.  The conditions under which this will perform best are probably
  * limited to the case where k is close to the number of points in the dataset,
  * and the number of iterations of the k-means algorithm will be few.
+ *
+ * The tree is built on a matrix of the type of the tree (arma::mat for the
+ * default trees), so other datasets (such as arma::fmat or sparse datasets)
+ * are copied into a dense matrix of that type first.
  */
 template<
     typename MetricType,
@@ -65,9 +69,9 @@ class DualTreeKMeans
   //! The original dataset reference.
   const MatType& datasetOrig; // Maybe not necessary.
   //! The dataset we are using.
-  const MatType& dataset;
+  const typename TreeType::Mat& dataset;
   //! A copy of the dataset, if necessary.
-  MatType datasetCopy;
+  typename TreeType::Mat datasetCopy;
   //! The metric.
   MetricType metric;
 
@@ -113,6 +117,28 @@ class DualTreeKMeans
 
   void CoalesceTree(TreeType& node, const size_t child = 0);
   void DecoalesceTree(TreeType& node);
+
+  //! Return the dataset itself if the tree can be built on it, or the copy.
+  static const typename TreeType::Mat& TreeDataset(
+      const typename TreeType::Mat& dataset,
+      const typename TreeType::Mat& copy);
+
+  //! Return the copy, because the tree can't be built on a dataset of
+  //! another type.
+  template<typename OtherMatType>
+  static const typename TreeType::Mat& TreeDataset(
+      const OtherMatType& dataset,
+      const typename TreeType::Mat& copy);
+
+  //! Copy a dense dataset, converting its elements.
+  template<typename eT>
+  static void CopyDataset(const arma::Mat<eT>& dataset,
+                          typename TreeType::Mat& copy);
+
+  //! Copy a sparse dataset into a dense matrix.
+  template<typename eT>
+  static void CopyDataset(const arma::SpMat<eT>& dataset,
+                          typename TreeType::Mat& copy);
 };
 
 //! Utility function for hiding children.  This actually does something, and is
@@ -15,6 +15,8 @@
 
 #include "dual_tree_kmeans_rules.hpp"
 
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -49,8 +51,7 @@ DualTreeKMeans<MetricType, MatType, TreeType>::DualTreeKMeans(
     const MatType& dataset,
     MetricType& metric) :
     datasetOrig(dataset),
-    dataset(tree::TreeTraits<TreeType>::RearrangesDataset ? datasetCopy :
-        datasetOrig),
+    dataset(TreeDataset(datasetOrig, datasetCopy)),
     metric(metric),
     distanceCalculations(0),
     iteration(0),
@@ -63,8 +64,8 @@ DualTreeKMeans<MetricType, MatType, TreeType>::DualTreeKMeans(
   Timer::Start("tree_building");
 
   // Copy the dataset, if necessary.
-  if (tree::TreeTraits<TreeType>::RearrangesDataset)
-    datasetCopy = datasetOrig;
+  if (&this->dataset == &datasetCopy)
+    CopyDataset(datasetOrig, datasetCopy);
 
   // Now build the tree.  We don't need any mappings.
   tree = new TreeType(const_cast<typename TreeType::Mat&>(this->dataset));
@@ -159,6 +160,7 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
   // Set the number of pruned centroids in the root to 0.
   tree->Stat().Pruned() = 0;
   traverser.Traverse(*tree, *centroidTree);
+  tree::RecordTraversal("dual_tree_kmeans", traverser, rules);
   distanceCalculations += rules.BaseCases() + rules.Scores();
 
   Timer::Start("tree_mod");
@@ -214,7 +216,9 @@ void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateTree(
     const double adjustedParentLowerBound)
 {
   const bool prunedLastIteration = node.Stat().StaticPruned();
+  const bool subtreePrunedLastIteration = node.Stat().SubtreePruned();
   node.Stat().StaticPruned() = false;
+  node.Stat().SubtreePruned() = false;
 
   // Grab information from the parent, if we can.
   if (node.Parent() != NULL &&
@@ -332,15 +336,48 @@ visited[node.Descendant(i)] << ".\n";
     node.Stat().LowerBound() -= clusterDistances[centroids.n_cols];
   }
 
-  // Recurse into children, and if all the children (and all the points) are
-  // pruned, then we can mark this as statically pruned.
+  // If the whole subtree was pruned last iteration and this node is still
+  // pruned, every point below it still belongs to the owner, so there is no
+  // need to visit the descendants.  Their bounds will be taken from this node
+  // when it is no longer pruned; only the movement of their static bounds
+  // must be remembered, and it is handed down when they are next visited.
   bool allChildrenPruned = true;
-  for (size_t i = 0; i < node.NumChildren(); ++i)
+  bool allChildrenSubtreePruned = true;
+  if (subtreePrunedLastIteration && prunedLastIteration &&
+      node.Stat().StaticPruned())
   {
-    UpdateTree(node.Child(i), centroids, unadjustedUpperBound,
-        adjustedUpperBound, unadjustedLowerBound, adjustedLowerBound);
-    if (!node.Child(i).Stat().StaticPruned())
-      allChildrenPruned = false;
+    node.Stat().PendingUpperBoundMovement() +=
+        clusterDistances[node.Stat().Owner()];
+    node.Stat().PendingLowerBoundMovement() +=
+        clusterDistances[centroids.n_cols];
+  }
+  else
+  {
+    // Recurse into children, and if all the children (and all the points) are
+    // pruned, then we can mark this as statically pruned.
+    for (size_t i = 0; i < node.NumChildren(); ++i)
+    {
+      // Hand down any movement from iterations where the child was skipped.
+      DualTreeKMeansStatistic& childStat = node.Child(i).Stat();
+      childStat.StaticUpperBoundMovement() +=
+          node.Stat().PendingUpperBoundMovement();
+      childStat.StaticLowerBoundMovement() +=
+          node.Stat().PendingLowerBoundMovement();
+      childStat.PendingUpperBoundMovement() +=
+          node.Stat().PendingUpperBoundMovement();
+      childStat.PendingLowerBoundMovement() +=
+          node.Stat().PendingLowerBoundMovement();
+
+      UpdateTree(node.Child(i), centroids, unadjustedUpperBound,
+          adjustedUpperBound, unadjustedLowerBound, adjustedLowerBound);
+      if (!node.Child(i).Stat().StaticPruned())
+        allChildrenPruned = false;
+      if (!node.Child(i).Stat().SubtreePruned())
+        allChildrenSubtreePruned = false;
+    }
+
+    node.Stat().PendingUpperBoundMovement() = 0.0;
+    node.Stat().PendingLowerBoundMovement() = 0.0;
   }
 
   bool allPointsPruned = true;
@@ -462,6 +499,11 @@ visited[node.Descendant(i)] << ".\n";
       node.Stat().StaticLowerBoundMovement() =
           clusterDistances[centroids.n_cols];
     }
+
+    // If this node has an owner and everything below it is pruned too, it can
+    // be skipped next iteration.
+    node.Stat().SubtreePruned() = allChildrenSubtreePruned &&
+        (node.Stat().Owner() < centroids.n_cols);
   }
 }
 
@@ -606,6 +648,11 @@ void DualTreeKMeans<MetricType, MatType, TreeType>::DecoalesceTree(
   node.Parent() = (TreeType*) node.Stat().TrueParent();
   RestoreChildren(node);
 
+  // CoalesceTree() never enters the children of a pruned subtree below the
+  // root (they are all hidden), so there is nothing to restore below them.
+  if (node.Stat().SubtreePruned() && node.Parent() != NULL)
+    return;
+
   for (size_t i = 0; i < node.NumChildren(); ++i)
     DecoalesceTree(node.Child(i));
 }
@@ -667,6 +714,43 @@ void RestoreChildren(TreeType& node,
   }
 }
 
+template<typename MetricType, typename MatType, typename TreeType>
+const typename TreeType::Mat&
+DualTreeKMeans<MetricType, MatType, TreeType>::TreeDataset(
+    const typename TreeType::Mat& dataset,
+    const typename TreeType::Mat& copy)
+{
+  return tree::TreeTraits<TreeType>::RearrangesDataset ? copy : dataset;
+}
+
+template<typename MetricType, typename MatType, typename TreeType>
+template<typename OtherMatType>
+const typename TreeType::Mat&
+DualTreeKMeans<MetricType, MatType, TreeType>::TreeDataset(
+    const OtherMatType& /* dataset */,
+    const typename TreeType::Mat& copy)
+{
+  return copy;
+}
+
+template<typename MetricType, typename MatType, typename TreeType>
+template<typename eT>
+void DualTreeKMeans<MetricType, MatType, TreeType>::CopyDataset(
+    const arma::Mat<eT>& dataset,
+    typename TreeType::Mat& copy)
+{
+  copy = arma::conv_to<typename TreeType::Mat>::from(dataset);
+}
+
+template<typename MetricType, typename MatType, typename TreeType>
+template<typename eT>
+void DualTreeKMeans<MetricType, MatType, TreeType>::CopyDataset(
+    const arma::SpMat<eT>& dataset,
+    typename TreeType::Mat& copy)
+{
+  copy = arma::conv_to<typename TreeType::Mat>::from(arma::Mat<eT>(dataset));
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
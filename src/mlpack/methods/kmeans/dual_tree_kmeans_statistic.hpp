@@ -25,6 +25,9 @@ class DualTreeKMeansStatistic : public
       staticPruned(false),
       staticUpperBoundMovement(0.0),
       staticLowerBoundMovement(0.0),
+      subtreePruned(false),
+      pendingUpperBoundMovement(0.0),
+      pendingLowerBoundMovement(0.0),
       centroid(),
       trueParent(NULL)
   {
@@ -41,6 +44,9 @@ class DualTreeKMeansStatistic : public
       staticPruned(false),
       staticUpperBoundMovement(0.0),
       staticLowerBoundMovement(0.0),
+      subtreePruned(false),
+      pendingUpperBoundMovement(0.0),
+      pendingLowerBoundMovement(0.0),
       trueParent(node.Parent())
   {
     // Empirically calculate the centroid.
@@ -91,6 +97,24 @@ class DualTreeKMeansStatistic : public
   double StaticLowerBoundMovement() const { return staticLowerBoundMovement; }
   double& StaticLowerBoundMovement() { return staticLowerBoundMovement; }
 
+  //! Whether this node and every node below it were statically pruned, with
+  //! an owner, the last time they were visited.
+  bool SubtreePruned() const { return subtreePruned; }
+  //! Modify whether this node and every node below it are statically pruned.
+  bool& SubtreePruned() { return subtreePruned; }
+
+  //! Upper bound movement not yet added to the children, since they were
+  //! skipped while this subtree was pruned.
+  double PendingUpperBoundMovement() const { return pendingUpperBoundMovement; }
+  //! Modify the upper bound movement not yet added to the children.
+  double& PendingUpperBoundMovement() { return pendingUpperBoundMovement; }
+
+  //! Lower bound movement not yet added to the children, since they were
+  //! skipped while this subtree was pruned.
+  double PendingLowerBoundMovement() const { return pendingLowerBoundMovement; }
+  //! Modify the lower bound movement not yet added to the children.
+  double& PendingLowerBoundMovement() { return pendingLowerBoundMovement; }
+
   void* TrueParent() const { return trueParent; }
   void*& TrueParent() { return trueParent; }
 
@@ -107,6 +131,7 @@ class DualTreeKMeansStatistic : public
     o << "  Lower bound: " << lowerBound << ".\n";
     o << "  Pruned: " << pruned << ".\n";
     o << "  Static pruned: " << staticPruned << ".\n";
+    o << "  Subtree pruned: " << subtreePruned << ".\n";
     o << "  Owner: " << owner << ".\n";
     return o.str();
   }
@@ -119,6 +144,9 @@ class DualTreeKMeansStatistic : public
   bool staticPruned;
   double staticUpperBoundMovement;
   double staticLowerBoundMovement;
+  bool subtreePruned;
+  double pendingUpperBoundMovement;
+  double pendingLowerBoundMovement;
   arma::vec centroid;
   void* trueParent;
   std::vector<void*> trueChildren;
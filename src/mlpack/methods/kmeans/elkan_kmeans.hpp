@@ -7,6 +7,8 @@
 #ifndef __MLPACK_METHODS_KMEANS_ELKAN_KMEANS_HPP
 #define __MLPACK_METHODS_KMEANS_ELKAN_KMEANS_HPP
 
+#include "centroid_distance.hpp"
+
 namespace mlpack {
 namespace kmeans {
 
@@ -38,6 +40,8 @@ class ElkanKMeans
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
+  //! Distances between the points and the centroids.
+  CentroidDistance<MetricType, MatType> distance;
 
   //! Holds intra-cluster distances.
   arma::mat clusterDistances;
@@ -18,6 +18,7 @@ ElkanKMeans<MetricType, MatType>::ElkanKMeans(const MatType& dataset,
                                               MetricType& metric) :
     dataset(dataset),
     metric(metric),
+    distance(dataset, metric),
     distanceCalculations(0)
 {
 
@@ -32,6 +33,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // Clear new centroids.
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
+  distance.Centroids(centroids);
 
   // At the beginning of the iteration, we must compute the distances between
   // all centers.  This is O(k^2).
@@ -62,11 +64,10 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   {
     for (size_t j = i + 1; j < centroids.n_cols; ++j)
     {
-      const double distance = metric.Evaluate(centroids.col(i),
-                                              centroids.col(j));
+      const double dist = metric.Evaluate(centroids.col(i), centroids.col(j));
       distanceCalculations++;
-      clusterDistances(i, j) = distance;
-      clusterDistances(j, i) = distance;
+      clusterDistances(i, j) = dist;
+      clusterDistances(j, i) = dist;
     }
   }
 
@@ -82,7 +83,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     {
       // No change needed.  This point must still belong to that cluster.
       counts(assignments[i])++;
-      newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+      AddPoint(dataset, i, newCentroids, assignments[i]);
       continue;
     }
     else
@@ -106,7 +107,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
         if (mustRecalculate[i])
         {
           mustRecalculate[i] = false;
-          dist = metric.Evaluate(dataset.col(i), centroids.col(assignments[i]));
+          dist = distance.Evaluate(i, assignments[i]);
           lowerBounds(assignments[i], i) = dist;
           upperBounds(i) = dist;
           distanceCalculations++;
@@ -128,8 +129,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
             dist > 0.5 * clusterDistances(assignments[i], c))
         {
           // Compute d(x, c).  If d(x, c) < d(x, c(x)) then assign c(x) = c.
-          const double pointDist = metric.Evaluate(dataset.col(i),
-                                                   centroids.col(c));
+          const double pointDist = distance.Evaluate(i, c);
           lowerBounds(c, i) = pointDist;
           distanceCalculations++;
           if (pointDist < dist)
@@ -144,7 +144,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     // At this point, we know the new cluster assignment.
     // Step 4: for each center c, let m(c) be the mean of the points assigned to
     // c.
-    newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+    AddPoint(dataset, i, newCentroids, assignments[i]);
     counts[assignments[i]]++;
   }
 
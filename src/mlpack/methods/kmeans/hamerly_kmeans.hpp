@@ -7,6 +7,8 @@
 #ifndef __MLPACK_METHODS_KMEANS_HAMERLY_KMEANS_HPP
 #define __MLPACK_METHODS_KMEANS_HAMERLY_KMEANS_HPP
 
+#include "centroid_distance.hpp"
+
 namespace mlpack {
 namespace kmeans {
 
@@ -22,7 +24,8 @@ class HamerlyKMeans
 
   /**
    * Run a single iteration of Hamerly's algorithm, updating the given centroids
-   * into the newCentroids matrix.
+   * into the newCentroids matrix.  The points are split between the OpenMP
+   * threads, which each sum the points of every cluster separately.
    *
    * @param centroids Current cluster centroids.
    * @param newCentroids New cluster centroids.
@@ -39,6 +42,8 @@ class HamerlyKMeans
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
+  //! Distances between the points and the centroids.
+  CentroidDistance<MetricType, MatType> distance;
 
   //! Minimum cluster distances from each cluster.
   arma::vec minClusterDistances;
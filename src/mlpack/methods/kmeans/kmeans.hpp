@@ -13,6 +13,7 @@
 #include "random_partition.hpp"
 #include "max_variance_new_cluster.hpp"
 #include "naive_kmeans.hpp"
+#include "lloyd_step_traits.hpp"
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
 
@@ -44,6 +45,13 @@ namespace kmeans /** K-Means clustering. */ {
  * k.Cluster(data, 6, centroids); // 6 clusters.
  * @endcode
  *
+ * The dataset can be dense or sparse, in double or single precision (MatType
+ * can be arma::mat, arma::fmat, arma::sp_mat or arma::sp_fmat); the centroids
+ * are always held in an arma::mat.  The naive, Elkan, Hamerly and dual-tree
+ * Lloyd steps and MaxVarianceNewCluster support all of these types, and use
+ * sparse dot products with precomputed norms for sparse datasets (see
+ * CentroidDistance).
+ *
  * @tparam MetricType The distance metric to use for this KMeans; see
  *     metric::LMetric for an example.
  * @tparam InitialPartitionPolicy Initial partitioning policy; must implement a
@@ -52,7 +60,10 @@ namespace kmeans /** K-Means clustering. */ {
  * @tparam EmptyClusterPolicy Policy for what to do on an empty cluster; must
  *     implement a default constructor and 'void EmptyCluster(const arma::mat&,
  *     arma::Col<size_t&)'.
- * @tparam LloydStepType Implementation of single Lloyd step to use.
+ * @tparam LloydStepType Implementation of single Lloyd step to use.  If it is
+ *     reusable (see LloydStepTraits), it is kept between calls to Cluster()
+ *     with the same dataset object; then, if that dataset is modified in
+ *     place, Reset() must be called before clustering it again.
  *
  * @see RandomPartition, RefinedStart, AllowEmptyClusters,
  *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans
@@ -83,6 +94,22 @@ class KMeans
          const InitialPartitionPolicy partitioner = InitialPartitionPolicy(),
          const EmptyClusterPolicy emptyClusterAction = EmptyClusterPolicy());
 
+  /**
+   * Copy the parameters of the given K-Means object.  The Lloyd step that it
+   * keeps, if any, is not copied.
+   */
+  KMeans(const KMeans& other);
+
+  /**
+   * Copy the parameters of the given K-Means object.  The Lloyd step that it
+   * keeps, if any, is not copied.
+   */
+  KMeans& operator=(const KMeans& other);
+
+  /**
+   * Delete the Lloyd step kept from the last call to Cluster(), if any.
+   */
+  ~KMeans();
 
   /**
    * Perform k-means clustering on the data, returning a list of cluster
@@ -90,7 +117,7 @@ class KMeans
    * initial guess of the cluster assignments; to do this, set initialGuess to
    * true.
    *
-   * @tparam MatType Type of matrix (arma::mat or arma::sp_mat).
+   * @tparam MatType Type of matrix (dense or sparse, double or float).
    * @param data Dataset to cluster.
    * @param clusters Number of clusters to compute.
    * @param assignments Vector to store cluster assignments in.
@@ -108,7 +135,7 @@ class KMeans
    * specified by filling the centroids matrix with the initial centroids and
    * specifying initialGuess = true.
    *
-   * @tparam MatType Type of matrix (arma::mat or arma::sp_mat).
+   * @tparam MatType Type of matrix (dense or sparse, double or float).
    * @param data Dataset to cluster.
    * @param clusters Number of clusters to compute.
    * @param centroids Matrix in which centroids are stored.
@@ -130,7 +157,7 @@ class KMeans
    * supersedes initialCentroidGuess, so if both are set to true, the
    * assignments vector is used.
    *
-   * @tparam MatType Type of matrix (arma::mat or arma::sp_mat).
+   * @tparam MatType Type of matrix (dense or sparse, double or float).
    * @param data Dataset to cluster.
    * @param clusters Number of clusters to compute.
    * @param assignments Vector to store cluster assignments in.
@@ -147,6 +174,12 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Delete the Lloyd step kept from the last call to Cluster(), if any, so
+   * that the next call builds it again.
+   */
+  void Reset();
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
@@ -180,6 +213,15 @@ class KMeans
   InitialPartitionPolicy partitioner;
   //! Instantiated empty cluster policy.
   EmptyClusterPolicy emptyClusterAction;
+
+  //! The Lloyd step kept from the last call to Cluster(), if it is reusable.
+  LloydStepType<MetricType, MatType>* lloydStep;
+  //! The dataset that the kept Lloyd step was built on.
+  const MatType* lloydStepDataset;
+  //! The number of dimensions of that dataset.
+  size_t lloydStepRows;
+  //! The number of points of that dataset.
+  size_t lloydStepCols;
 };
 
 }; // namespace kmeans
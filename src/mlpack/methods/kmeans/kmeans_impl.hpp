@@ -6,6 +6,7 @@
  * Implementation for the K-means method for getting an initial point.
  */
 #include "kmeans.hpp"
+#include "centroid_distance.hpp"
 
 #include <mlpack/core/metrics/lmetric.hpp>
 
@@ -33,11 +34,111 @@ KMeans(const size_t maxIterations,
     maxIterations(maxIterations),
     metric(metric),
     partitioner(partitioner),
-    emptyClusterAction(emptyClusterAction)
+    emptyClusterAction(emptyClusterAction),
+    lloydStep(NULL),
+    lloydStepDataset(NULL),
+    lloydStepRows(0),
+    lloydStepCols(0)
 {
   // Nothing to do.
 }
 
+/**
+ * Copy the parameters of the K-Means object, but not its Lloyd step.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+KMeans(const KMeans& other) :
+    maxIterations(other.maxIterations),
+    metric(other.metric),
+    partitioner(other.partitioner),
+    emptyClusterAction(other.emptyClusterAction),
+    lloydStep(NULL),
+    lloydStepDataset(NULL),
+    lloydStepRows(0),
+    lloydStepCols(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>&
+KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+operator=(const KMeans& other)
+{
+  if (this != &other)
+  {
+    // The kept Lloyd step refers to our metric, which is about to change.
+    Reset();
+
+    maxIterations = other.maxIterations;
+    metric = other.metric;
+    partitioner = other.partitioner;
+    emptyClusterAction = other.emptyClusterAction;
+  }
+
+  return *this;
+}
+
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+~KMeans()
+{
+  Reset();
+}
+
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Reset()
+{
+  delete lloydStep;
+  lloydStep = NULL;
+  lloydStepDataset = NULL;
+  lloydStepRows = 0;
+  lloydStepCols = 0;
+}
+
 /**
  * Perform k-means clustering on the data, returning a list of cluster
  * assignments.  This just forward to the other function, which returns the
@@ -122,7 +223,7 @@ Cluster(const MatType& data,
     centroids.zeros(data.n_rows, clusters);
     for (size_t i = 0; i < data.n_cols; ++i)
     {
-      centroids.col(assignments[i]) += arma::vec(data.col(i));
+      AddPoint(data, i, centroids, assignments[i]);
       counts[assignments[i]]++;
     }
 
@@ -136,7 +237,27 @@ Cluster(const MatType& data,
 
   size_t iteration = 0;
 
-  LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  // A reusable Lloyd step is kept for the next call with the same dataset;
+  // other Lloyd steps are built again for every call.
+  LloydStepType<MetricType, MatType>* step;
+  if (LloydStepTraits<LloydStepType>::Reusable)
+  {
+    if (lloydStep == NULL || lloydStepDataset != &data ||
+        lloydStepRows != data.n_rows || lloydStepCols != data.n_cols)
+    {
+      Reset();
+      lloydStep = new LloydStepType<MetricType, MatType>(data, metric);
+      lloydStepDataset = &data;
+      lloydStepRows = data.n_rows;
+      lloydStepCols = data.n_cols;
+    }
+    step = lloydStep;
+  }
+  else
+  {
+    step = new LloydStepType<MetricType, MatType>(data, metric);
+  }
+
   arma::mat centroidsOther;
   double cNorm;
 
@@ -145,9 +266,9 @@ Cluster(const MatType& data,
     // We have two centroid matrices.  We don't want to copy anything, so,
     // depending on the iteration number, we use a different centroid matrix...
     if (iteration % 2 == 0)
-      cNorm = lloydStep.Iterate(centroids, centroidsOther, counts);
+      cNorm = step->Iterate(centroids, centroidsOther, counts);
     else
-      cNorm = lloydStep.Iterate(centroidsOther, centroids, counts);
+      cNorm = step->Iterate(centroidsOther, centroids, counts);
 
     // If we are not allowing empty clusters, then check that all of our
     // clusters have points.
@@ -189,8 +310,11 @@ Cluster(const MatType& data,
     Log::Info << "KMeans::Cluster(): terminated after limit of " << iteration
         << " iterations." << std::endl;
   }
-  Log::Info << lloydStep.DistanceCalculations() << " distance calculations."
+  Log::Info << step->DistanceCalculations() << " distance calculations."
       << std::endl;
+
+  if (!LloydStepTraits<LloydStepType>::Reusable)
+    delete step;
 }
 
 /**
@@ -229,7 +353,7 @@ Cluster(const MatType& data,
     centroids.zeros(data.n_rows, clusters);
     for (size_t i = 0; i < data.n_cols; ++i)
     {
-      centroids.col(assignments[i]) += arma::vec(data.col(i));
+      AddPoint(data, i, centroids, assignments[i]);
       counts[assignments[i]]++;
     }
 
@@ -242,6 +366,8 @@ Cluster(const MatType& data,
       initialAssignmentGuess || initialCentroidGuess);
 
   // Calculate final assignments.
+  CentroidDistance<MetricType, MatType> distance(data, metric);
+  distance.Centroids(centroids);
   assignments.set_size(data.n_cols);
   for (size_t i = 0; i < data.n_cols; ++i)
   {
@@ -251,11 +377,11 @@ Cluster(const MatType& data,
 
     for (size_t j = 0; j < centroids.n_cols; j++)
     {
-      const double distance = metric.Evaluate(data.col(i), centroids.col(j));
+      const double dist = distance.Evaluate(i, j);
 
-      if (distance < minDistance)
+      if (dist < minDistance)
       {
-        minDistance = distance;
+        minDistance = dist;
         closestCluster = j;
       }
     }
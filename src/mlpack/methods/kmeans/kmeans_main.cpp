@@ -9,8 +9,13 @@
 #include "kmeans.hpp"
 #include "allow_empty_clusters.hpp"
 #include "refined_start.hpp"
+#include "kmeans_plus_plus.hpp"
+#include "kmeans_parallel.hpp"
+#include "blocked_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
+#include "yinyang_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
 
@@ -34,12 +39,28 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     "to be used in each sample, the --percentage parameter is used (it should "
     "be a value between 0.0 and 1.0)."
     "\n\n"
+    "Initial points can also be chosen with the k-means++ seeding (Arthur and "
+    "Vassilvitskii, 2007) with the --kmeans_plus_plus (-K) option, or with the "
+    "k-means|| seeding (Bahmani et al., 2012) with the --kmeans_parallel (-L) "
+    "option.  k-means|| takes only a few passes over the data (specified with "
+    "--rounds), each sampling about --oversampling times the number of "
+    "clusters as candidates; both run in parallel if OpenMP is available."
+    "\n\n"
     "There are several options available for the algorithm used for each Lloyd "
     "iteration, specified with the --algorithm (-a) option.  The standard O(kN)"
     " approach can be used ('naive').  Other options include the Pelleg-Moore "
     "tree-based algorithm ('pelleg-moore'), Elkan's triangle-inequality based "
     "algorithm ('elkan'), and Hamerly's modification to Elkan's algorithm "
-    "('hamerly')."
+    "('hamerly').  The 'yinyang' option is like 'elkan' but keeps one lower "
+    "bound per group of clusters instead of one per cluster, so its memory "
+    "stays bounded for many clusters; it runs in parallel if OpenMP is "
+    "available.  The 'blocked' option is like 'naive' but computes distances "
+    "to all centroids with matrix multiplications on blocks of points, in "
+    "parallel if OpenMP is available; this is often fastest for "
+    "high-dimensional data with many clusters.  The 'minibatch' option runs "
+    "mini-batch k-means (Sculley, 2010), which only looks at a random sample "
+    "of 1000 points in each iteration; it is approximate, but each iteration "
+    "is very cheap on large datasets."
     "\n\n"
     "As of October 2014, the --overclustering option has been removed.  If you "
     "want this support back, let us know -- file a bug at "
@@ -76,8 +97,20 @@ PARAM_INT("samplings", "Number of samplings to perform for refined start (use "
 PARAM_DOUBLE("percentage", "Percentage of dataset to use for each refined start"
     " sampling (use when --refined_start is specified).", "p", 0.02);
 
+// Parameters for k-means++ and k-means|| seeding.
+PARAM_FLAG("kmeans_plus_plus", "Use the k-means++ seeding by Arthur and "
+    "Vassilvitskii to choose initial points.", "K");
+PARAM_FLAG("kmeans_parallel", "Use the k-means|| seeding by Bahmani et al. to "
+    "choose initial points.", "L");
+PARAM_INT("rounds", "Number of sampling rounds for k-means|| (use when "
+    "--kmeans_parallel is specified).", "R", 5);
+PARAM_DOUBLE("oversampling", "Expected number of points sampled in each "
+    "k-means|| round, as a multiple of the number of clusters (use when "
+    "--kmeans_parallel is specified).", "O", 2.0);
+
 PARAM_STRING("algorithm", "Algorithm to use for the Lloyd iteration ('naive', "
-    "'pelleg-moore', 'elkan', 'hamerly', or 'dtnn').", "a", "naive");
+    "'blocked', 'minibatch', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', "
+    "'dualtree', or 'dualtree-covertree').", "a", "naive");
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -122,6 +155,25 @@ int main(int argc, char** argv)
 
     FindEmptyClusterPolicy<RefinedStart>(RefinedStart(samplings, percentage));
   }
+  else if (CLI::HasParam("kmeans_plus_plus"))
+  {
+    FindEmptyClusterPolicy<KMeansPlusPlus>(KMeansPlusPlus());
+  }
+  else if (CLI::HasParam("kmeans_parallel"))
+  {
+    const int rounds = CLI::GetParam<int>("rounds");
+    const double oversampling = CLI::GetParam<double>("oversampling");
+
+    if (rounds < 0)
+      Log::Fatal << "Number of rounds (" << rounds << ") must be greater than "
+          << "or equal to 0!" << endl;
+    if (oversampling <= 0.0)
+      Log::Fatal << "Oversampling factor (" << oversampling << ") must be "
+          << "greater than 0.0!" << endl;
+
+    FindEmptyClusterPolicy<KMeansParallel>(KMeansParallel(rounds,
+        oversampling));
+  }
   else
   {
     FindEmptyClusterPolicy<RandomPartition>(RandomPartition());
@@ -149,6 +201,8 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, ElkanKMeans>(ipp);
   else if (algorithm == "hamerly")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, HamerlyKMeans>(ipp);
+  else if (algorithm == "yinyang")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, YinyangKMeans>(ipp);
   else if (algorithm == "pelleg-moore")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
         PellegMooreKMeans>(ipp);
@@ -160,9 +214,15 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         CoverTreeDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "blocked")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, BlockedKMeans>(ipp);
+  else if (algorithm == "minibatch")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        MiniBatchKMeans>(ipp);
   else
     Log::Fatal << "Unknown algorithm: '" << algorithm << "'.  Supported options"
-        << " are 'naive', 'pelleg-moore', 'elkan', and 'hamerly'." << endl;
+        << " are 'naive', 'blocked', 'minibatch', 'pelleg-moore', 'elkan', "
+        << "'hamerly', 'yinyang', 'dualtree', and 'dualtree-covertree'." << endl;
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -208,6 +268,7 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   // Load our dataset.
   arma::mat dataset;
   data::Load(inputFile, dataset, true); // Fatal upon failure.
+  Numa::Distribute(dataset); // Only with --numa.
 
   arma::mat centroids;
 
@@ -223,6 +284,10 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
     if (CLI::HasParam("refined_start"))
       Log::Warn << "Initial centroids are specified, but will be ignored "
           << "because --refined_start is also specified!" << endl;
+    else if (CLI::HasParam("kmeans_plus_plus") ||
+             CLI::HasParam("kmeans_parallel"))
+      Log::Warn << "Initial centroids are specified, so the seeding strategy "
+          << "will not be used." << endl;
     else
       Log::Info << "Using initial centroid guesses from '" <<
           initialCentroidsFile << "'." << endl;
@@ -0,0 +1,100 @@
+/**
+ * @file kmeans_parallel.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of the scalable k-means|| seeding of Bahmani et al., which
+ * oversamples candidate centroids in a few parallel rounds and then reduces
+ * them with the k-means++ seeding.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_HPP
+
+#include <mlpack/core.hpp>
+#include "kmeans_plus_plus.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means|| approach for choosing initial points for k-means clustering.
+ * Instead of the k passes over the data that the k-means++ seeding takes, this
+ * takes a few rounds; in each round, every point is chosen as a candidate
+ * independently with probability proportional to its squared distance to the
+ * closest candidate so far, so that about (oversampling * k) candidates are
+ * added per round.  The candidates are weighted by the number of points
+ * closest to them and reduced to k centroids with the weighted k-means++
+ * seeding, and the points are assigned to their closest centroid.
+ *
+ * The sampling and the distance updates of each round are done in parallel
+ * with OpenMP.  The points are sampled in blocks of fixed size, each from its
+ * own random stream (see math::RandomStream()), so the result only depends on
+ * the random seed and not on the number of threads.  This is an
+ * implementation of the following paper:
+ *
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, Bahman and Moseley, Benjamin and Vattani, Andrea and
+ *       Kumar, Ravi and Vassilvitskii, Sergei},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ */
+class KMeansParallel
+{
+ public:
+  /**
+   * Create the KMeansParallel object, optionally specifying the number of
+   * sampling rounds and the expected number of candidates chosen per round, as
+   * a multiple of the number of clusters.
+   */
+  KMeansParallel(const size_t rounds = 5,
+                 const double oversampling = 2.0) :
+      rounds(rounds), oversampling(oversampling) { }
+
+  /**
+   * Partition the given dataset into the given number of clusters by choosing
+   * centroids with the k-means|| seeding and assigning each point to the
+   * closest one.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to partition.
+   * @param clusters Number of clusters to split dataset into.
+   * @param assignments Vector to store cluster assignments into.  Values will
+   *     be between 0 and (clusters - 1).
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::Col<size_t>& assignments) const;
+
+  //! Get the number of sampling rounds.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of sampling rounds.
+  size_t& Rounds() { return rounds; }
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! The number of points sampled from each random stream.
+  static const size_t BlockSize = 4096;
+
+ private:
+  //! The number of sampling rounds.
+  size_t rounds;
+  //! The expected number of candidates per round, as a multiple of the number
+  //! of clusters.
+  double oversampling;
+};
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_impl.hpp"
+
+#endif
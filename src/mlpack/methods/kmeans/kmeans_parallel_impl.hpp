@@ -0,0 +1,110 @@
+/**
+ * @file kmeans_parallel_impl.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of the scalable k-means|| seeding of Bahmani et al.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallel::Cluster(const MatType& data,
+                             const size_t clusters,
+                             arma::Col<size_t>& assignments) const
+{
+  // Start with a single random candidate.
+  std::vector<size_t> candidates;
+  candidates.push_back((size_t) math::RandInt(data.n_cols));
+
+  // The squared distance from each point to its closest candidate.
+  arma::vec minDistances(data.n_cols);
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < data.n_cols; ++i)
+    minDistances[i] = metric::SquaredEuclideanDistance::Evaluate(data.col(i),
+        data.col(candidates[0]));
+
+  const double expected = oversampling * clusters;
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+  std::vector<std::vector<size_t> > blockCandidates(numBlocks);
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    const double cost = arma::accu(minDistances);
+    if (cost == 0.0)
+      break; // Every point is already a candidate.
+
+    // Sample every point independently.  The streams of each round are offset
+    // by a draw from the global generator.
+    const size_t base = (size_t) math::randGen();
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      std::mt19937 generator = math::RandomStream(base + b);
+      std::uniform_real_distribution<> uniform(0.0, 1.0);
+
+      blockCandidates[b].clear();
+      const size_t end = std::min((b + 1) * BlockSize, (size_t) data.n_cols);
+      for (size_t i = b * BlockSize; i < end; ++i)
+        if (uniform(generator) * cost < expected * minDistances[i])
+          blockCandidates[b].push_back(i);
+    }
+
+    // Collect the new candidates in order.
+    const size_t oldCandidates = candidates.size();
+    for (size_t b = 0; b < numBlocks; ++b)
+      candidates.insert(candidates.end(), blockCandidates[b].begin(),
+          blockCandidates[b].end());
+
+    // Update the distances to the closest candidate.
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      for (size_t j = oldCandidates; j < candidates.size(); ++j)
+      {
+        const double distance = metric::SquaredEuclideanDistance::Evaluate(
+            data.col(i), data.col(candidates[j]));
+        if (distance < minDistances[i])
+          minDistances[i] = distance;
+      }
+    }
+  }
+
+  arma::mat centroids;
+  if (candidates.size() <= clusters)
+  {
+    // There are too few candidates to reduce, so fall back to the k-means++
+    // seeding on the whole dataset.
+    KMeansPlusPlus::Seed(data, clusters, centroids);
+  }
+  else
+  {
+    // Weight each candidate by the number of points closest to it, and reduce
+    // the candidates to the final centroids.
+    arma::mat candidateMatrix(data.n_rows, candidates.size());
+    for (size_t j = 0; j < candidates.size(); ++j)
+      candidateMatrix.col(j) = arma::vec(data.col(candidates[j]));
+
+    arma::vec distances;
+    KMeansPlusPlus::Assign(data, candidateMatrix, assignments, distances);
+
+    arma::vec weights;
+    weights.zeros(candidates.size());
+    for (size_t i = 0; i < data.n_cols; ++i)
+      ++weights[assignments[i]];
+
+    KMeansPlusPlus::Seed(candidateMatrix, clusters, centroids, weights);
+  }
+
+  arma::vec distances;
+  KMeansPlusPlus::Assign(data, centroids, assignments, distances);
+}
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file kmeans_plus_plus.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of the k-means++ seeding of Arthur and Vassilvitskii,
+ * which chooses initial points that are likely to be spread out.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means++ approach for choosing initial points for k-means clustering.
+ * The first centroid is a random point; each next centroid is a point chosen
+ * with probability proportional to its squared distance to the closest
+ * centroid chosen so far.  The points are then assigned to their closest
+ * centroid.  The distance updates after each new centroid are done in parallel
+ * with OpenMP.  This is an implementation of the following paper:
+ *
+ * @inproceedings{arthur2007k,
+ *   title={k-means++: The advantages of careful seeding},
+ *   author={Arthur, David and Vassilvitskii, Sergei},
+ *   booktitle={Proceedings of the Eighteenth Annual ACM-SIAM Symposium on
+ *       Discrete Algorithms (SODA 2007)},
+ *   pages={1027--1035},
+ *   year={2007}
+ * }
+ */
+class KMeansPlusPlus
+{
+ public:
+  //! Empty constructor, required by the InitialPartitionPolicy policy.
+  KMeansPlusPlus() { }
+
+  /**
+   * Partition the given dataset into the given number of clusters by choosing
+   * centroids with the k-means++ seeding and assigning each point to the
+   * closest one.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to partition.
+   * @param clusters Number of clusters to split dataset into.
+   * @param assignments Vector to store cluster assignments into.  Values will
+   *     be between 0 and (clusters - 1).
+   */
+  template<typename MatType>
+  static void Cluster(const MatType& data,
+                      const size_t clusters,
+                      arma::Col<size_t>& assignments);
+
+  /**
+   * Choose the given number of centroids among the points of the dataset with
+   * the k-means++ seeding.  If weights are given, each point is chosen with
+   * probability proportional to its weight times its squared distance.
+   *
+   * @param data Dataset to choose centroids from.
+   * @param clusters Number of centroids to choose.
+   * @param centroids Matrix to store the chosen centroids into.
+   * @param weights Weights of the points (all 1 if empty).
+   */
+  template<typename MatType>
+  static void Seed(const MatType& data,
+                   const size_t clusters,
+                   arma::mat& centroids,
+                   const arma::vec& weights = arma::vec());
+
+  /**
+   * Assign each point of the dataset to its closest centroid, in parallel.
+   *
+   * @param data Dataset to assign.
+   * @param centroids Centroids to assign points to.
+   * @param assignments Vector to store the index of the closest centroid of
+   *     each point into.
+   * @param distances Vector to store the squared distance between each point
+   *     and its closest centroid into.
+   */
+  template<typename MatType>
+  static void Assign(const MatType& data,
+                     const arma::mat& centroids,
+                     arma::Col<size_t>& assignments,
+                     arma::vec& distances);
+};
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+// Include implementation.
+#include "kmeans_plus_plus_impl.hpp"
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file kmeans_plus_plus_impl.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of the k-means++ seeding of Arthur and Vassilvitskii.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_plus_plus.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansPlusPlus::Cluster(const MatType& data,
+                             const size_t clusters,
+                             arma::Col<size_t>& assignments)
+{
+  arma::mat centroids;
+  Seed(data, clusters, centroids);
+
+  arma::vec distances;
+  Assign(data, centroids, assignments, distances);
+}
+
+template<typename MatType>
+void KMeansPlusPlus::Seed(const MatType& data,
+                          const size_t clusters,
+                          arma::mat& centroids,
+                          const arma::vec& weights)
+{
+  const bool weighted = (weights.n_elem == data.n_cols);
+  centroids.set_size(data.n_rows, clusters);
+
+  // The squared distance from each point to its closest chosen centroid.
+  arma::vec minDistances(data.n_cols);
+  minDistances.fill(DBL_MAX);
+
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    // Choose the next point with probability proportional to its (weighted)
+    // squared distance.  For the first centroid, every distance is DBL_MAX, so
+    // only the weights matter.
+    double total = 0.0;
+    arma::vec probabilities(data.n_cols);
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      const double distance = (c == 0) ? 1.0 : minDistances[i];
+      probabilities[i] = weighted ? weights[i] * distance : distance;
+      total += probabilities[i];
+    }
+
+    size_t index = data.n_cols - 1;
+    if (total > 0.0)
+    {
+      const double target = math::Random() * total;
+      double sum = 0.0;
+      for (size_t i = 0; i < data.n_cols; ++i)
+      {
+        sum += probabilities[i];
+        if (sum > target)
+        {
+          index = i;
+          break;
+        }
+      }
+    }
+    else
+    {
+      // Every point is already a centroid; any choice is as good as another.
+      index = (size_t) math::RandInt(data.n_cols);
+    }
+
+    centroids.col(c) = arma::vec(data.col(index));
+
+    // Update the distances to the closest centroid.
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          data.col(i), centroids.col(c));
+      if (distance < minDistances[i])
+        minDistances[i] = distance;
+    }
+  }
+}
+
+template<typename MatType>
+void KMeansPlusPlus::Assign(const MatType& data,
+                            const arma::mat& centroids,
+                            arma::Col<size_t>& assignments,
+                            arma::vec& distances)
+{
+  assignments.set_size(data.n_cols);
+  distances.set_size(data.n_cols);
+
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    double minDistance = DBL_MAX;
+    size_t closest = 0;
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          data.col(i), centroids.col(c));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closest = c;
+      }
+    }
+
+    assignments[i] = closest;
+    distances[i] = minDistance;
+  }
+}
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+#endif
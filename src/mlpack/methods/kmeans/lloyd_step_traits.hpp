@@ -0,0 +1,37 @@
+/**
+ * @file lloyd_step_traits.hpp
+ * @author Ryan Curtin
+ *
+ * The LloydStepTraits class, which provides information about the Lloyd step
+ * types that KMeans can use.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_LLOYD_STEP_TRAITS_HPP
+#define __MLPACK_METHODS_KMEANS_LLOYD_STEP_TRAITS_HPP
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The LloydStepTraits class provides compile-time information on a Lloyd step
+ * type.  If a Lloyd step can be used again for another clustering of the same
+ * dataset, it should specialize this class and set Reusable to true; KMeans
+ * then keeps it between calls to Cluster() on the same dataset, so that
+ * whatever it builds from the dataset (such as a tree) is only built once.
+ * Steps that hold state from the last clustering (such as bounds on the
+ * distances to the centroids) must not be reusable.
+ */
+template<template<class, class> class LloydStepType>
+class LloydStepTraits
+{
+ public:
+  /**
+   * This is true if the Lloyd step can be used for several clusterings of the
+   * same dataset.
+   */
+  static const bool Reusable = false;
+};
+
+}; // namespace kmeans
+}; // namespace mlpack
+
+#endif
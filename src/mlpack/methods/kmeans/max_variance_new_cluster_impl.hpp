@@ -34,31 +34,34 @@ size_t MaxVarianceNewCluster::EmptyCluster(const MatType& data,
   variances.max(maxVarCluster);
 
   // Now, inside this cluster, find the point which is furthest away.
+  CentroidDistance<MetricType, MatType> distance(data, metric);
+  distance.Centroids(centroids);
   size_t furthestPoint = data.n_cols;
   double maxDistance = -DBL_MAX;
   for (size_t i = 0; i < data.n_cols; ++i)
   {
     if (assignments[i] == maxVarCluster)
     {
-      const double distance = std::pow(metric.Evaluate(data.col(i),
-          centroids.col(maxVarCluster)), 2.0);
+      const double dist = std::pow(distance.Evaluate(i, maxVarCluster), 2.0);
 
-      if (distance > maxDistance)
+      if (dist > maxDistance)
       {
-        maxDistance = distance;
+        maxDistance = dist;
         furthestPoint = i;
       }
     }
   }
 
   // Take that point and add it to the empty cluster.
+  arma::mat point(data.n_rows, 1, arma::fill::zeros);
+  AddPoint(data, furthestPoint, point, 0);
   centroids.col(maxVarCluster) *= (double(clusterCounts[maxVarCluster]) /
       double(clusterCounts[maxVarCluster] - 1));
   centroids.col(maxVarCluster) -= (1.0 / (clusterCounts[maxVarCluster] - 1.0)) *
-      arma::vec(data.col(furthestPoint));
+      point;
   clusterCounts[maxVarCluster]--;
   clusterCounts[emptyCluster]++;
-  centroids.col(emptyCluster) = arma::vec(data.col(furthestPoint));
+  centroids.col(emptyCluster) = point;
   assignments[furthestPoint] = emptyCluster;
 
   // Modify the variances, as necessary.
@@ -85,6 +88,9 @@ void MaxVarianceNewCluster::Precalculate(const MatType& data,
   variances.zeros(centroids.n_cols);
   assignments.set_size(data.n_cols);
 
+  CentroidDistance<MetricType, MatType> distance(data, metric);
+  distance.Centroids(centroids);
+
   // Add the variance of each point's distance away from the cluster.  I think
   // this is the sensible thing to do.
   for (size_t i = 0; i < data.n_cols; ++i)
@@ -95,18 +101,17 @@ void MaxVarianceNewCluster::Precalculate(const MatType& data,
 
     for (size_t j = 0; j < centroids.n_cols; j++)
     {
-      const double distance = metric.Evaluate(data.col(i), centroids.col(j));
+      const double dist = distance.Evaluate(i, j);
 
-      if (distance < minDistance)
+      if (dist < minDistance)
       {
-        minDistance = distance;
+        minDistance = dist;
         closestCluster = j;
       }
     }
 
     assignments[i] = closestCluster;
-    variances[closestCluster] += std::pow(metric.Evaluate(data.col(i),
-        centroids.col(closestCluster)), 2.0);
+    variances[closestCluster] += std::pow(minDistance, 2.0);
   }
 
   // Divide by the number of points in the cluster to produce the variance,
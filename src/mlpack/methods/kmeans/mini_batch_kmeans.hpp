@@ -0,0 +1,106 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of mini-batch k-means (Sculley, 2010), where each Lloyd
+ * step only looks at a small random sample of the dataset.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of the mini-batch k-means step from the following
+ * paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010},
+ *   organization={ACM}
+ * }
+ * @endcode
+ *
+ * Each call to Iterate() samples a batch of points uniformly at random (with
+ * replacement), assigns each to its closest centroid, and then moves each
+ * centroid towards its assigned points with a per-centroid learning rate of
+ * 1 / (number of points ever assigned to that centroid).  Only the sampled
+ * points are touched, so each iteration costs O(batchSize * k) distance
+ * calculations instead of O(N * k), and the extra memory used is independent
+ * of the size of the dataset.  Because the step keeps the per-centroid counts
+ * between iterations, the centroids converge as more batches are seen; the
+ * residual returned by Iterate() shrinks accordingly.
+ *
+ * The counts returned by Iterate() are the total number of points ever
+ * assigned to each centroid, so a cluster is only reported as empty if no
+ * sampled point has ever been assigned to it.
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  //! The default number of points sampled in each iteration.
+  static const size_t DefaultBatchSize = 1000;
+
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points to sample in each iteration.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = DefaultBatchSize);
+
+  /**
+   * Run a single mini-batch iteration, updating the given centroids into the
+   * newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with the total number of
+   *     points assigned to each centroid so far.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of points sampled in each iteration.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points sampled in each iteration.
+  size_t& BatchSize() { return batchSize; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The number of points sampled in each iteration.
+  size_t batchSize;
+  //! The number of points assigned to each centroid in all iterations so far.
+  arma::Col<size_t> totalCounts;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
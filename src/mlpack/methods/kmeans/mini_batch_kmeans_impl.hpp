@@ -0,0 +1,100 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the mini-batch k-means step.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{
+  if (batchSize == 0)
+    Log::Fatal << "MiniBatchKMeans: batch size must be greater than 0!"
+        << std::endl;
+}
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  // The first time through, nothing has been assigned yet.
+  if (totalCounts.n_elem != centroids.n_cols)
+    totalCounts.zeros(centroids.n_cols);
+
+  // Sample the batch and cache the closest centroid of each sampled point, so
+  // that all points are assigned with respect to the same centroids.
+  arma::Col<size_t> batch(batchSize);
+  arma::Col<size_t> assignments(batchSize);
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    batch[i] = (size_t) math::RandInt(dataset.n_cols);
+
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; j++)
+    {
+      const double distance = metric.Evaluate(dataset.col(batch[i]),
+          centroids.col(j));
+
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+
+  distanceCalculations += centroids.n_cols * batchSize;
+
+  // Now take a gradient step for each sampled point, with a per-centroid
+  // learning rate that decays as the centroid accumulates points.
+  newCentroids = centroids;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    const size_t c = assignments[i];
+    totalCounts[c]++;
+
+    const double eta = 1.0 / (double) totalCounts[c];
+    newCentroids.col(c) *= (1.0 - eta);
+    newCentroids.col(c) += eta * arma::vec(dataset.col(batch[i]));
+  }
+
+  counts = totalCounts;
+
+  // Calculate the movement of the centroids in this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
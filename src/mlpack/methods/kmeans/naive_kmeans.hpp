@@ -9,6 +9,8 @@
 #ifndef __MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 #define __MLPACK_METHODS_KMEANS_NAIVE_KMEANS_HPP
 
+#include "centroid_distance.hpp"
+
 namespace mlpack {
 namespace kmeans {
 
@@ -51,6 +53,8 @@ class NaiveKMeans
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
+  //! Distances between the points and the centroids.
+  CentroidDistance<MetricType, MatType> distance;
 
   //! Number of distance calculations.
   size_t distanceCalculations;
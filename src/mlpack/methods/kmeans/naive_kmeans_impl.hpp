@@ -20,6 +20,7 @@ NaiveKMeans<MetricType, MatType>::NaiveKMeans(const MatType& dataset,
                                               MetricType& metric) :
     dataset(dataset),
     metric(metric),
+    distance(dataset, metric),
     distanceCalculations(0)
 { /* Nothing to do. */ }
 
@@ -31,6 +32,7 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
 {
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
+  distance.Centroids(centroids);
 
   // Find the closest centroid to each point and update the new centroids.
   for (size_t i = 0; i < dataset.n_cols; i++)
@@ -41,11 +43,11 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
 
     for (size_t j = 0; j < centroids.n_cols; j++)
     {
-      const double distance = metric.Evaluate(dataset.col(i), centroids.col(j));
+      const double dist = distance.Evaluate(i, j);
 
-      if (distance < minDistance)
+      if (dist < minDistance)
       {
-        minDistance = distance;
+        minDistance = dist;
         closestCluster = j;
       }
     }
@@ -53,7 +55,7 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     Log::Assert(closestCluster != centroids.n_cols);
 
     // We now have the minimum distance centroid index.  Update that centroid.
-    newCentroids.col(closestCluster) += arma::vec(dataset.col(i));
+    AddPoint(dataset, i, newCentroids, closestCluster);
     counts(closestCluster)++;
   }
 
@@ -9,7 +9,9 @@
 #define __MLPACK_METHODS_KMEANS_PELLEG_MOORE_KMEANS_HPP
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include "pelleg_moore_kmeans_statistic.hpp"
+#include "lloyd_step_traits.hpp"
 
 namespace mlpack {
 namespace kmeans {
@@ -19,6 +21,12 @@ namespace kmeans {
  * clustering.  This algorithm builds a kd-tree on the data points and traverses
  * it in order to determine the closest clusters to each point.
  *
+ * The traversal is parallel: the two subtrees of a large node are traversed
+ * by different OpenMP tasks, which each sum the points of every cluster with
+ * the rules of their thread.  The tree only depends on the dataset, so KMeans
+ * keeps this object (and its tree) between calls to Cluster() with the same
+ * dataset (see LloydStepTraits).
+ *
  * For more information on the algorithm, see
  *
  * @code
@@ -69,6 +77,20 @@ class PellegMooreKMeans
       PellegMooreKMeansStatistic, MatType> TreeType;
 
  private:
+  /**
+   * Score the children of the given node and traverse the ones that can't be
+   * pruned, in separate tasks if the node is large enough.  Each thread uses
+   * its own rules and statistics.
+   *
+   * @param node Node whose children are traversed (it was scored already).
+   * @param rules Rules of each thread.
+   * @param statistics Traversal statistics of each thread.
+   */
+  template<typename RulesType>
+  void Traverse(TreeType& node,
+                std::vector<RulesType>& rules,
+                std::vector<tree::TraversalStatistics>& statistics);
+
   //! The original dataset reference.
   const MatType& datasetOrig; // Maybe not necessary.
   //! The dataset we are using.
@@ -85,6 +107,14 @@ class PellegMooreKMeans
   size_t distanceCalculations;
 };
 
+//! The tree of PellegMooreKMeans can be used for several clusterings.
+template<>
+class LloydStepTraits<PellegMooreKMeans>
+{
+ public:
+  static const bool Reusable = true;
+};
+
 } // namespace kmeans
 } // namespace mlpack
 
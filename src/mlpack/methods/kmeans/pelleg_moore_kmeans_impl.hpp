@@ -11,6 +11,12 @@
 #include "pelleg_moore_kmeans.hpp"
 #include "pelleg_moore_kmeans_rules.hpp"
 
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace kmeans {
 
@@ -50,21 +56,54 @@ double PellegMooreKMeans<MetricType, MatType>::Iterate(
     arma::mat& newCentroids,
     arma::Col<size_t>& counts)
 {
-  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
-  counts.zeros(centroids.n_cols);
-
-  // Create rules object.
+  // Each thread gets its own rules, which sum the points of every cluster
+  // into the centroids and counts of that thread.
   typedef PellegMooreKMeansRules<MetricType, TreeType> RulesType;
-  RulesType rules(dataset, centroids, newCentroids, counts, metric);
-
-  // Use single-tree traverser.
-  typename TreeType::template SingleTreeTraverser<RulesType> traverser(rules);
+  const size_t numThreads = omp_get_max_threads();
+  std::vector<arma::mat> threadCentroids(numThreads,
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::Col<size_t> > threadCounts(numThreads,
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+  std::vector<RulesType> rules;
+  rules.reserve(numThreads);
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    rules.push_back(RulesType(dataset, centroids, threadCentroids[t],
+        threadCounts[t], metric));
+  }
+  std::vector<tree::TraversalStatistics> statistics(numThreads);
+
+  // The root is scored like every other node, so that a dataset held in a
+  // single leaf is handled too.  The query index is irrelevant, because we are
+  // checking each node with all clusters.
+  statistics[0].traversals = 1;
+  statistics[0].scores = 1;
+  if (rules[0].Score(0, *tree) != DBL_MAX)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      Traverse(*tree, rules, statistics);
+    }
+  }
+  else
+  {
+    statistics[0].prunes = 1;
+  }
 
-  // Now, do a traversal with a fake query index (since the query index is
-  // irrelevant; we are checking each node with all clusters.
-  traverser.Traverse(0, *tree);
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+  tree::TraversalStatistics total;
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+    distanceCalculations += rules[t].DistanceCalculations();
+    total += statistics[t];
+  }
 
-  distanceCalculations += rules.DistanceCalculations();
+  if (tree::TraversalProfile::Enabled())
+    tree::TraversalProfile::Add("pelleg_moore_kmeans", total);
 
   // Now, calculate how far the clusters moved, after normalizing them.
   double residual = 0.0;
@@ -86,6 +125,47 @@ double PellegMooreKMeans<MetricType, MatType>::Iterate(
   return std::sqrt(residual);
 }
 
+template<typename MetricType, typename MatType>
+template<typename RulesType>
+void PellegMooreKMeans<MetricType, MatType>::Traverse(
+    TreeType& node,
+    std::vector<RulesType>& rules,
+    std::vector<tree::TraversalStatistics>& statistics)
+{
+  // The points of a leaf are assigned when it is scored.
+  if (node.IsLeaf())
+    return;
+
+  const size_t thread = omp_get_thread_num();
+  TreeType* left = node.Left();
+  TreeType* right = node.Right();
+  const bool visitLeft = (rules[thread].Score(0, *left) != DBL_MAX);
+  const bool visitRight = (rules[thread].Score(0, *right) != DBL_MAX);
+
+  ++statistics[thread].visited;
+  statistics[thread].scores += 2;
+  statistics[thread].prunes += (visitLeft ? 0 : 1) + (visitRight ? 0 : 1);
+
+  // Scoring a node only modifies the blacklist of that node, so the subtrees
+  // can be traversed at the same time.  Small subtrees aren't worth a task.
+  if (visitLeft && visitRight && node.NumDescendants() >= 4096)
+  {
+    #pragma omp task firstprivate(left) shared(rules, statistics)
+    Traverse(*left, rules, statistics);
+
+    Traverse(*right, rules, statistics);
+
+    #pragma omp taskwait
+  }
+  else
+  {
+    if (visitLeft)
+      Traverse(*left, rules, statistics);
+    if (visitRight)
+      Traverse(*right, rules, statistics);
+  }
+}
+
 } // namespace kmeans
 } // namespace mlpack
 
@@ -0,0 +1,98 @@
+/**
+ * @file yinyang_kmeans.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of Yinyang k-means, a bound-based algorithm for exact
+ * Lloyd iterations that keeps one lower bound per group of clusters instead
+ * of one per cluster.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+#define __MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * An implementation of a single iteration of Lloyd's algorithm using the
+ * Yinyang bounds of Ding et al. ("Yinyang K-Means: A Drop-In Replacement of the
+ * Classic K-Means with Consistent Speedup", ICML 2015).  Like ElkanKMeans, this
+ * keeps an upper bound on the distance from each point to its cluster, but
+ * instead of a lower bound for every cluster (a k x n matrix), the clusters
+ * are split into at most MaxGroups groups and only one lower bound per group
+ * is kept.  This keeps the memory bounded for large numbers of clusters, while
+ * still pruning whole groups of clusters at once.
+ *
+ * The groups are formed in the first iteration by assigning each centroid to
+ * the closest of a set of evenly spaced seed centroids.  The points are
+ * processed in parallel with OpenMP, with each thread accumulating its own new
+ * centroids that are summed at the end.
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class YinyangKMeans
+{
+ public:
+  /**
+   * Construct the YinyangKMeans object, which must store several sets of
+   * bounds.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   */
+  YinyangKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Yinyang algorithm, updating the given
+   * centroids into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with new counts.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! The number of clusters per group, if that gives no more than MaxGroups.
+  static const size_t GroupSize = 10;
+  //! The maximum number of groups, which bounds the memory used per point.
+  static const size_t MaxGroups = 32;
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The group of each cluster.
+  arma::Col<size_t> clusterGroups;
+  //! The clusters in each group.
+  std::vector<std::vector<size_t> > groups;
+
+  //! Holds the index of the cluster that owns each point.
+  arma::Col<size_t> assignments;
+
+  //! Upper bounds on the distance between each point and its closest cluster.
+  arma::vec upperBounds;
+  //! Lower bounds on the distance between each point and each group of
+  //! clusters (excluding the cluster the point is assigned to).
+  arma::mat lowerBounds;
+
+  //! Track distance calculations.
+  size_t distanceCalculations;
+
+  //! Split the given centroids into groups.
+  void FormGroups(const arma::mat& centroids);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "yinyang_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,233 @@
+/**
+ * @file yinyang_kmeans_impl.hpp
+ * @author Ryan Curtin
+ *
+ * An implementation of Yinyang k-means, a bound-based algorithm for exact
+ * Lloyd iterations that keeps one lower bound per group of clusters instead
+ * of one per cluster.
+ */
+#ifndef __MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+#define __MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "yinyang_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+YinyangKMeans<MetricType, MatType>::YinyangKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+void YinyangKMeans<MetricType, MatType>::FormGroups(const arma::mat& centroids)
+{
+  const size_t numGroups = std::max((size_t) 1, std::min(MaxGroups,
+      (centroids.n_cols + GroupSize - 1) / GroupSize));
+
+  // Assign each centroid to the closest of numGroups evenly spaced seed
+  // centroids.  Each seed is closest to itself, so no group is empty.
+  clusterGroups.set_size(centroids.n_cols);
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    double bestDistance = DBL_MAX;
+    for (size_t g = 0; g < numGroups; ++g)
+    {
+      const size_t seed = g * centroids.n_cols / numGroups;
+      const double distance = metric.Evaluate(centroids.col(c),
+                                              centroids.col(seed));
+      if (distance < bestDistance)
+      {
+        bestDistance = distance;
+        clusterGroups[c] = g;
+      }
+    }
+  }
+  distanceCalculations += centroids.n_cols * numGroups;
+
+  groups.clear();
+  groups.resize(numGroups);
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+    groups[clusterGroups[c]].push_back(c);
+}
+
+// Run a single iteration of the Yinyang algorithm for Lloyd iterations.
+template<typename MetricType, typename MatType>
+double YinyangKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  // If this is the first iteration, we must form the groups and reset all the
+  // bounds.  A lower bound of 0 for every group forces the distances to all
+  // clusters to be computed.
+  if (clusterGroups.n_elem != centroids.n_cols ||
+      assignments.n_elem != dataset.n_cols)
+  {
+    FormGroups(centroids);
+
+    lowerBounds.zeros(groups.size(), dataset.n_cols);
+    upperBounds.set_size(dataset.n_cols);
+    upperBounds.fill(DBL_MAX);
+    assignments.zeros(dataset.n_cols);
+  }
+
+  // Reset new centroids.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+
+  const size_t numGroups = groups.size();
+  size_t calculations = 0;
+
+  #pragma omp parallel reduction(+:calculations)
+  {
+    // Each thread accumulates its own centroids and counts.
+    arma::mat threadCentroids;
+    threadCentroids.zeros(centroids.n_rows, centroids.n_cols);
+    arma::Col<size_t> threadCounts;
+    threadCounts.zeros(centroids.n_cols);
+
+    // The closest and second closest distances in each group that was
+    // searched for the current point.
+    arma::vec groupFirst(numGroups);
+    arma::vec groupSecond(numGroups);
+    std::vector<bool> searched(numGroups);
+
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      const size_t assignment = assignments[i];
+      const double globalLowerBound = arma::min(lowerBounds.col(i));
+
+      // Global filter: the point can't have moved to any other cluster.
+      if (upperBounds(i) > globalLowerBound)
+      {
+        // Tighten the upper bound and test again.
+        upperBounds(i) = metric.Evaluate(dataset.col(i),
+                                         centroids.col(assignment));
+        ++calculations;
+      }
+
+      if (upperBounds(i) <= globalLowerBound)
+      {
+        threadCentroids.col(assignment) += dataset.col(i);
+        ++threadCounts(assignment);
+        continue;
+      }
+
+      // Search every group whose lower bound doesn't rule it out.  At this
+      // point, upperBounds(i) = d(i, c(i)).
+      const double assignedDistance = upperBounds(i);
+      size_t best = assignment;
+      double bestDistance = assignedDistance;
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        searched[g] = (lowerBounds(g, i) < bestDistance);
+        if (!searched[g])
+          continue; // Pruned by the group lower bound.
+
+        groupFirst[g] = DBL_MAX;
+        groupSecond[g] = DBL_MAX;
+        for (size_t j = 0; j < groups[g].size(); ++j)
+        {
+          const size_t c = groups[g][j];
+          if (c == assignment)
+            continue;
+
+          const double distance = metric.Evaluate(dataset.col(i),
+                                                  centroids.col(c));
+          ++calculations;
+
+          if (distance < groupFirst[g])
+          {
+            groupSecond[g] = groupFirst[g];
+            groupFirst[g] = distance;
+            if (distance < bestDistance)
+            {
+              best = c;
+              bestDistance = distance;
+            }
+          }
+          else if (distance < groupSecond[g])
+          {
+            groupSecond[g] = distance;
+          }
+        }
+      }
+
+      // The searched groups now have exact lower bounds over all their
+      // clusters but the assigned one.
+      const size_t bestGroup = clusterGroups[best];
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        if (searched[g])
+          lowerBounds(g, i) = (best != assignment && g == bestGroup) ?
+              groupSecond[g] : groupFirst[g];
+      }
+
+      if (best != assignment)
+      {
+        // The old cluster is now just another cluster in its group.
+        const size_t oldGroup = clusterGroups[assignment];
+        lowerBounds(oldGroup, i) = std::min(lowerBounds(oldGroup, i),
+            assignedDistance);
+
+        assignments[i] = best;
+        upperBounds(i) = bestDistance;
+      }
+
+      threadCentroids.col(best) += dataset.col(i);
+      ++threadCounts(best);
+    }
+
+    #pragma omp critical(yinyang_kmeans_reduce)
+    {
+      newCentroids += threadCentroids;
+      counts += threadCounts;
+    }
+  }
+  distanceCalculations += calculations;
+
+  // Normalize centroids and calculate cluster movement, and the largest
+  // movement in each group.
+  arma::vec centroidMovements(centroids.n_cols);
+  arma::vec groupMovements(numGroups);
+  groupMovements.zeros();
+  double centroidMovement = 0.0;
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    if (counts(c) > 0)
+      newCentroids.col(c) /= counts(c);
+    else
+      newCentroids.col(c).fill(DBL_MAX); // Empty cluster.
+
+    const double movement = metric.Evaluate(centroids.col(c),
+                                            newCentroids.col(c));
+    centroidMovements(c) = movement;
+    centroidMovement += std::pow(movement, 2.0);
+    ++distanceCalculations;
+
+    if (movement > groupMovements(clusterGroups[c]))
+      groupMovements(clusterGroups[c]) = movement;
+  }
+
+  // Now update the bounds.
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    upperBounds(i) += centroidMovements(assignments[i]);
+    lowerBounds.col(i) -= groupMovements;
+  }
+
+  return std::sqrt(centroidMovement);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
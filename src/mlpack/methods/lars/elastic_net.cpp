@@ -0,0 +1,82 @@
+/**
+ * @file elastic_net.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the non-templated functions of the coordinate descent
+ * solver.
+ */
+#include "elastic_net.hpp"
+
+using namespace mlpack;
+using namespace mlpack::regression;
+
+ElasticNet::ElasticNet(const double lambda1,
+                       const double lambda2,
+                       const double tolerance,
+                       const size_t maxIterations) :
+    lambda1(lambda1),
+    lambda2(lambda2),
+    tolerance(tolerance),
+    maxIterations(maxIterations),
+    pathLength(100),
+    minLambdaRatio(1e-3)
+{ /* Nothing left to do. */ }
+
+void ElasticNet::SquaredNorms(const arma::mat& x, arma::vec& sqNorms)
+{
+  sqNorms = trans(arma::sum(arma::square(x)));
+}
+
+void ElasticNet::SquaredNorms(const arma::sp_mat& x, arma::vec& sqNorms)
+{
+  sqNorms.zeros(x.n_cols);
+  for (size_t j = 0; j < x.n_cols; ++j)
+    for (size_t i = x.col_ptrs[j]; i < x.col_ptrs[j + 1]; ++i)
+      sqNorms[j] += x.values[i] * x.values[i];
+}
+
+double ElasticNet::ColumnDot(const arma::mat& x,
+                             const size_t j,
+                             const arma::vec& v)
+{
+  return arma::dot(x.unsafe_col(j), v);
+}
+
+double ElasticNet::ColumnDot(const arma::sp_mat& x,
+                             const size_t j,
+                             const arma::vec& v)
+{
+  // Only the nonzero values of the column are visited.
+  double result = 0.0;
+  for (size_t i = x.col_ptrs[j]; i < x.col_ptrs[j + 1]; ++i)
+    result += x.values[i] * v[x.row_indices[i]];
+  return result;
+}
+
+void ElasticNet::AddColumn(const arma::mat& x,
+                           const size_t j,
+                           const double scale,
+                           arma::vec& v)
+{
+  v += scale * x.unsafe_col(j);
+}
+
+void ElasticNet::AddColumn(const arma::sp_mat& x,
+                           const size_t j,
+                           const double scale,
+                           arma::vec& v)
+{
+  for (size_t i = x.col_ptrs[j]; i < x.col_ptrs[j + 1]; ++i)
+    v[x.row_indices[i]] += scale * x.values[i];
+}
+
+std::string ElasticNet::ToString() const
+{
+  std::ostringstream convert;
+  convert << "ElasticNet [" << this << "]" << std::endl;
+  convert << "  Lambda1: " << lambda1 << std::endl;
+  convert << "  Lambda2: " << lambda2 << std::endl;
+  convert << "  Tolerance: " << tolerance << std::endl;
+  convert << "  Max Iterations: " << maxIterations << std::endl;
+  return convert.str();
+}
@@ -0,0 +1,279 @@
+/**
+ * @file elastic_net.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of the ElasticNet class, which solves the LASSO and the elastic
+ * net by cyclic coordinate descent, for dense or sparse data.
+ */
+#ifndef __MLPACK_METHODS_LARS_ELASTIC_NET_HPP
+#define __MLPACK_METHODS_LARS_ELASTIC_NET_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * A cyclic coordinate descent solver for l1-regularized linear regression
+ * (LASSO) and l1+l2-regularized linear regression (elastic net).  It solves
+ * the same problem as LARS,
+ *
+ * \f[ \min_{\beta} 0.5 || X \beta - y ||_2^2 + \lambda_1 || \beta ||_1 +
+ *     0.5 \lambda_2 || \beta ||_2^2, \f]
+ *
+ * where each row of \f$ X \f$ is a point and each column is a dimension, but
+ * never forms the Gram matrix or solves a linear system: each step minimizes
+ * the objective in one coefficient, which only takes one pass over the
+ * nonzero values of one column of \f$ X \f$.  So it works with arma::sp_mat
+ * data, and scales to problems with very many dimensions that LARS can't
+ * handle.
+ *
+ * The work is restricted to few dimensions at a time:
+ *
+ *  - Before solving, dimensions are discarded with the sequential strong rule:
+ *    a dimension whose correlation with the residual of the previous solution
+ *    is less than \f$ 2 \lambda_1 - \lambda_1^{prev} \f$ is very likely to
+ *    have a zero coefficient.  Once the others converge, the discarded
+ *    dimensions are checked against the optimality conditions, and any
+ *    violation is added back.
+ *  - Between full passes, only the dimensions with nonzero coefficients (the
+ *    active set) are cycled through until they converge.
+ *
+ * RegressPath() solves for a decreasing sequence of \f$ \lambda_1 \f$, each
+ * started from the previous solution (a warm start), which is usually faster
+ * than solving for the last \f$ \lambda_1 \f$ alone.
+ *
+ * For more details, see the following paper:
+ *
+ * @code
+ * @article{friedman2010regularization,
+ *   title={Regularization paths for generalized linear models via coordinate
+ *       descent},
+ *   author={Friedman, J. and Hastie, T. and Tibshirani, R.},
+ *   journal={Journal of Statistical Software},
+ *   volume={33},
+ *   number={1},
+ *   pages={1--22},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * @code
+ * @article{tibshirani2012strong,
+ *   title={Strong rules for discarding predictors in lasso-type problems},
+ *   author={Tibshirani, R. and Bien, J. and Friedman, J. and Hastie, T. and
+ *       Simon, N. and Taylor, J. and Tibshirani, R.J.},
+ *   journal={Journal of the Royal Statistical Society Series B},
+ *   volume={74},
+ *   number={2},
+ *   pages={245--266},
+ *   year={2012}
+ * }
+ * @endcode
+ */
+class ElasticNet
+{
+ public:
+  /**
+   * Set the parameters of the solver.
+   *
+   * @param lambda1 Regularization parameter for l1-norm penalty.
+   * @param lambda2 Regularization parameter for l2-norm penalty.
+   * @param tolerance Coordinate descent stops when no coefficient changes the
+   *     objective by more than this fraction of 0.5 || y ||_2^2 in a pass.
+   * @param maxIterations Maximum number of passes over the coefficients for
+   *     each value of lambda1 (0 means no limit).
+   */
+  ElasticNet(const double lambda1,
+             const double lambda2 = 0.0,
+             const double tolerance = 1e-7,
+             const size_t maxIterations = 10000);
+
+  /**
+   * Solve the problem.  The input matrix (like all MLPACK matrices) should be
+   * column-major -- each column is an observation and each row is a dimension.
+   * Coordinate descent needs to access the dimensions, so this method will
+   * (internally) transpose the matrix.  If this is not necessary (i.e., you
+   * pass in a row-major matrix), pass 'false' for the transposeData parameter.
+   *
+   * @param data Input data: arma::mat or arma::sp_mat.
+   * @param responses A vector of targets.
+   * @param beta Vector to store the solution (the coefficients) in.
+   * @param transposeData Set to false if the data is row-major.
+   */
+  template<typename MatType>
+  void Regress(const MatType& data,
+               const arma::vec& responses,
+               arma::vec& beta,
+               const bool transposeData = true) const;
+
+  /**
+   * Solve many problems with the same data and different responses, in
+   * parallel if mlpack was compiled with OpenMP.  This has the same interface
+   * as the corresponding overload of LARS::Regress(), so it can be used to
+   * code many signals with the same dictionary (as SparseCoding does).
+   *
+   * @param data Input data: arma::mat or arma::sp_mat.
+   * @param responses Matrix of targets, one problem per column.
+   * @param betas Matrix to store the solutions in, one per column.
+   * @param transposeData Set to false if the data is row-major.
+   */
+  template<typename MatType>
+  void Regress(const MatType& data,
+               const arma::mat& responses,
+               arma::mat& betas,
+               const bool transposeData = true) const;
+
+  /**
+   * Compute the regularization path: solve the problem for each of the given
+   * values of lambda1 (the lambda1 given to the constructor is ignored), from
+   * the largest to the smallest, starting each from the previous solution.  If
+   * lambdas is empty, a path of PathLength() values is used, spaced
+   * geometrically from the smallest lambda1 for which the solution is zero
+   * down to MinLambdaRatio() times that value.  The lambdas are sorted in
+   * decreasing order.
+   *
+   * @param data Input data: arma::mat or arma::sp_mat.
+   * @param responses A vector of targets.
+   * @param lambdas Values of lambda1 to solve for (or empty); they are sorted,
+   *     or filled in if empty.
+   * @param betas Matrix to store the solution for each lambda1 in (one per
+   *     column).
+   * @param transposeData Set to false if the data is row-major.
+   */
+  template<typename MatType>
+  void RegressPath(const MatType& data,
+                   const arma::vec& responses,
+                   arma::vec& lambdas,
+                   arma::mat& betas,
+                   const bool transposeData = true) const;
+
+  //! Get the l1 regularization parameter.
+  double Lambda1() const { return lambda1; }
+  //! Modify the l1 regularization parameter.
+  double& Lambda1() { return lambda1; }
+
+  //! Get the l2 regularization parameter.
+  double Lambda2() const { return lambda2; }
+  //! Modify the l2 regularization parameter.
+  double& Lambda2() { return lambda2; }
+
+  //! Get the convergence tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the convergence tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the maximum number of passes for each value of lambda1.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of passes for each value of lambda1.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the number of values of lambda1 in a default path.
+  size_t PathLength() const { return pathLength; }
+  //! Modify the number of values of lambda1 in a default path.
+  size_t& PathLength() { return pathLength; }
+
+  //! Get the ratio of the smallest to the largest lambda1 of a default path.
+  double MinLambdaRatio() const { return minLambdaRatio; }
+  //! Modify the ratio of the smallest to the largest lambda1 of a default path.
+  double& MinLambdaRatio() { return minLambdaRatio; }
+
+  // Returns a string representation of this object.
+  std::string ToString() const;
+
+ private:
+  //! Regularization parameter for l1 penalty.
+  double lambda1;
+  //! Regularization parameter for l2 penalty.
+  double lambda2;
+  //! Convergence tolerance.
+  double tolerance;
+  //! Maximum number of passes for each value of lambda1.
+  size_t maxIterations;
+  //! Number of values of lambda1 in a default path.
+  size_t pathLength;
+  //! Ratio of the smallest to the largest lambda1 of a default path.
+  double minLambdaRatio;
+
+  /**
+   * Solve the problem for one value of lambda1, starting from the given
+   * coefficients and their residual y - X beta, which are updated.
+   *
+   * @param x Row-major data.
+   * @param sqNorms Squared norm of every column of x.
+   * @param lambda Value of lambda1 to solve for.
+   * @param previousLambda Value of lambda1 that the coefficients solve for
+   *     (for the strong rule).
+   * @param threshold Convergence threshold on the change of the objective.
+   * @param beta Coefficients.
+   * @param residual Residual of the coefficients.
+   */
+  template<typename MatType>
+  void Solve(const MatType& x,
+             const arma::vec& sqNorms,
+             const double lambda,
+             const double previousLambda,
+             const double threshold,
+             arma::vec& beta,
+             arma::vec& residual) const;
+
+  /**
+   * Run coordinate descent on the given dimensions until the coefficients
+   * converge, alternating full passes over all the given dimensions with
+   * passes over those with a nonzero coefficient only.
+   */
+  template<typename MatType>
+  void Descend(const MatType& x,
+               const arma::vec& sqNorms,
+               const double lambda,
+               const double threshold,
+               const std::vector<size_t>& dimensions,
+               arma::vec& beta,
+               arma::vec& residual) const;
+
+  /**
+   * Minimize the objective in each of the given dimensions in turn, and
+   * return the largest change of the objective (estimated as the squared
+   * norm of the column times the squared change of the coefficient).
+   */
+  template<typename MatType>
+  double Pass(const MatType& x,
+              const arma::vec& sqNorms,
+              const double lambda,
+              const std::vector<size_t>& dimensions,
+              arma::vec& beta,
+              arma::vec& residual) const;
+
+  //! Compute the squared norm of every column of x.
+  static void SquaredNorms(const arma::mat& x, arma::vec& sqNorms);
+  //! Compute the squared norm of every column of x.
+  static void SquaredNorms(const arma::sp_mat& x, arma::vec& sqNorms);
+
+  //! Return the dot product of column j of x and v.
+  static double ColumnDot(const arma::mat& x,
+                          const size_t j,
+                          const arma::vec& v);
+  //! Return the dot product of column j of x and v.
+  static double ColumnDot(const arma::sp_mat& x,
+                          const size_t j,
+                          const arma::vec& v);
+
+  //! Add scale times column j of x to v.
+  static void AddColumn(const arma::mat& x,
+                        const size_t j,
+                        const double scale,
+                        arma::vec& v);
+  //! Add scale times column j of x to v.
+  static void AddColumn(const arma::sp_mat& x,
+                        const size_t j,
+                        const double scale,
+                        arma::vec& v);
+};
+
+}; // namespace regression
+}; // namespace mlpack
+
+// Include implementation of templated functions.
+#include "elastic_net_impl.hpp"
+
+#endif
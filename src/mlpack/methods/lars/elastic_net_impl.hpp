@@ -0,0 +1,243 @@
+/**
+ * @file elastic_net_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the templated functions of the coordinate descent solver.
+ */
+#ifndef __MLPACK_METHODS_LARS_ELASTIC_NET_IMPL_HPP
+#define __MLPACK_METHODS_LARS_ELASTIC_NET_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "elastic_net.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+void ElasticNet::Regress(const MatType& data,
+                         const arma::vec& responses,
+                         arma::vec& beta,
+                         const bool transposeData) const
+{
+  // Coordinate descent accesses the columns of the row-major data.
+  MatType transposed;
+  if (transposeData)
+    transposed = trans(data);
+  const MatType& x = transposeData ? transposed : data;
+
+  Log::Assert(x.n_rows == responses.n_elem);
+
+  arma::vec sqNorms;
+  SquaredNorms(x, sqNorms);
+
+  beta.zeros(x.n_cols);
+  arma::vec residual = responses;
+
+  // The solution is zero for any lambda1 at least this large, so that is the
+  // previous lambda1 of the strong rule.
+  double lambdaMax = 0.0;
+  for (size_t j = 0; j < x.n_cols; ++j)
+    lambdaMax = std::max(lambdaMax, std::abs(ColumnDot(x, j, residual)));
+
+  if (lambda1 < lambdaMax)
+  {
+    Solve(x, sqNorms, lambda1, lambdaMax, tolerance * arma::dot(responses,
+        responses), beta, residual);
+  }
+}
+
+template<typename MatType>
+void ElasticNet::Regress(const MatType& data,
+                         const arma::mat& responses,
+                         arma::mat& betas,
+                         const bool transposeData) const
+{
+  MatType transposed;
+  if (transposeData)
+    transposed = trans(data);
+  const MatType& x = transposeData ? transposed : data;
+
+  betas.set_size(x.n_cols, responses.n_cols);
+
+  // The problems are independent.
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < responses.n_cols; ++i)
+  {
+    arma::vec beta;
+    Regress(x, arma::vec(responses.col(i)), beta, false);
+    betas.col(i) = beta;
+  }
+}
+
+template<typename MatType>
+void ElasticNet::RegressPath(const MatType& data,
+                             const arma::vec& responses,
+                             arma::vec& lambdas,
+                             arma::mat& betas,
+                             const bool transposeData) const
+{
+  MatType transposed;
+  if (transposeData)
+    transposed = trans(data);
+  const MatType& x = transposeData ? transposed : data;
+
+  Log::Assert(x.n_rows == responses.n_elem);
+
+  arma::vec sqNorms;
+  SquaredNorms(x, sqNorms);
+
+  arma::vec beta(x.n_cols, arma::fill::zeros);
+  arma::vec residual = responses;
+
+  double lambdaMax = 0.0;
+  for (size_t j = 0; j < x.n_cols; ++j)
+    lambdaMax = std::max(lambdaMax, std::abs(ColumnDot(x, j, residual)));
+
+  if (lambdas.n_elem == 0)
+  {
+    // Space the default path geometrically.
+    lambdas.set_size(pathLength);
+    for (size_t k = 0; k < pathLength; ++k)
+    {
+      lambdas[k] = lambdaMax * std::pow(minLambdaRatio, (pathLength > 1) ?
+          double(k) / double(pathLength - 1) : 0.0);
+    }
+  }
+  else
+  {
+    lambdas = arma::sort(lambdas, "descend");
+  }
+
+  const double threshold = tolerance * arma::dot(responses, responses);
+  betas.set_size(x.n_cols, lambdas.n_elem);
+  double previousLambda = lambdaMax;
+  for (size_t k = 0; k < lambdas.n_elem; ++k)
+  {
+    if (lambdas[k] < lambdaMax)
+    {
+      Solve(x, sqNorms, lambdas[k], previousLambda, threshold, beta, residual);
+      previousLambda = lambdas[k];
+    }
+
+    betas.col(k) = beta;
+  }
+}
+
+template<typename MatType>
+void ElasticNet::Solve(const MatType& x,
+                       const arma::vec& sqNorms,
+                       const double lambda,
+                       const double previousLambda,
+                       const double threshold,
+                       arma::vec& beta,
+                       arma::vec& residual) const
+{
+  // Sequential strong rule: keep the dimensions that are already nonzero or
+  // strongly correlated with the residual.
+  const double strongBound = 2 * lambda - previousLambda;
+  std::vector<bool> isStrong(x.n_cols, false);
+  std::vector<size_t> strong;
+  for (size_t j = 0; j < x.n_cols; ++j)
+  {
+    if (beta[j] != 0.0 || std::abs(ColumnDot(x, j, residual)) >= strongBound)
+    {
+      isStrong[j] = true;
+      strong.push_back(j);
+    }
+  }
+
+  while (true)
+  {
+    Descend(x, sqNorms, lambda, threshold, strong, beta, residual);
+
+    // A discarded dimension is optimal at zero if its correlation with the
+    // residual is at most lambda; add back any that isn't.
+    bool violations = false;
+    for (size_t j = 0; j < x.n_cols; ++j)
+    {
+      if (!isStrong[j] && std::abs(ColumnDot(x, j, residual)) > lambda)
+      {
+        isStrong[j] = true;
+        strong.push_back(j);
+        violations = true;
+      }
+    }
+
+    if (!violations)
+      break;
+  }
+}
+
+template<typename MatType>
+void ElasticNet::Descend(const MatType& x,
+                         const arma::vec& sqNorms,
+                         const double lambda,
+                         const double threshold,
+                         const std::vector<size_t>& dimensions,
+                         arma::vec& beta,
+                         arma::vec& residual) const
+{
+  size_t iterations = 0;
+  std::vector<size_t> active;
+  while (maxIterations == 0 || iterations < maxIterations)
+  {
+    ++iterations;
+    if (Pass(x, sqNorms, lambda, dimensions, beta, residual) <= threshold)
+      return;
+
+    // Converge on the active set before the next full pass.
+    active.clear();
+    for (size_t i = 0; i < dimensions.size(); ++i)
+      if (beta[dimensions[i]] != 0.0)
+        active.push_back(dimensions[i]);
+
+    while (maxIterations == 0 || iterations < maxIterations)
+    {
+      ++iterations;
+      if (Pass(x, sqNorms, lambda, active, beta, residual) <= threshold)
+        break;
+    }
+  }
+
+  Log::Warn << "ElasticNet: coordinate descent did not converge in "
+      << maxIterations << " passes." << std::endl;
+}
+
+template<typename MatType>
+double ElasticNet::Pass(const MatType& x,
+                        const arma::vec& sqNorms,
+                        const double lambda,
+                        const std::vector<size_t>& dimensions,
+                        arma::vec& beta,
+                        arma::vec& residual) const
+{
+  double maxChange = 0.0;
+  for (size_t i = 0; i < dimensions.size(); ++i)
+  {
+    const size_t j = dimensions[i];
+    if (sqNorms[j] == 0.0)
+      continue;
+
+    // Minimize in beta[j]: soft-threshold its least-squares value.
+    const double old = beta[j];
+    const double z = ColumnDot(x, j, residual) + sqNorms[j] * old;
+    const double shrunk = std::max(std::abs(z) - lambda, 0.0);
+    const double updated = ((z < 0.0) ? -shrunk : shrunk) /
+        (sqNorms[j] + lambda2);
+
+    if (updated != old)
+    {
+      AddColumn(x, j, old - updated, residual);
+      beta[j] = updated;
+      maxChange = std::max(maxChange,
+          sqNorms[j] * (updated - old) * (updated - old));
+    }
+  }
+
+  return maxChange;
+}
+
+}; // namespace regression
+}; // namespace mlpack
+
+#endif
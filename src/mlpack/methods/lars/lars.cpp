@@ -51,19 +51,86 @@ void LARS::Regress(const arma::mat& matX,
     dataTrans = trans(matX);
 
   // Compute X' * y.
-  arma::vec vecXTy = trans(dataRef) * y;
+  const arma::vec vecXTy = trans(dataRef) * y;
+
+  // Compute the Gram matrix, unless it was given.
+  if (&matGram == &matGramInternal)
+    ComputeGram(dataRef);
+
+  RegressGram(vecXTy, beta);
+
+  Timer::Stop("lars_regression");
+}
+
+void LARS::Regress(const arma::mat& matX,
+                   const arma::mat& responses,
+                   arma::mat& betas,
+                   const bool transposeData)
+{
+  Timer::Start("lars_regression");
+
+  // This matrix may end up holding the transpose -- if necessary.
+  arma::mat dataTrans;
+  // dataRef is row-major.
+  const arma::mat& dataRef = (transposeData ? dataTrans : matX);
+  if (transposeData)
+    dataTrans = trans(matX);
+
+  // The Gram matrix and X' * y for every response are computed once, with
+  // matrix products.
+  if (&matGram == &matGramInternal)
+    ComputeGram(dataRef);
+  const arma::mat matXTy = trans(dataRef) * responses;
+
+  betas.set_size(dataRef.n_cols, responses.n_cols);
+
+  // The problems are independent, so they are solved in parallel; each thread
+  // has its own solver (and so its own workspace), since the solver keeps the
+  // state of the path.  The solutions are written directly into the columns of
+  // betas.
+  #pragma omp parallel
+  {
+    LARS lars(useCholesky, matGram, lambda1, lambda2, tolerance);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < responses.n_cols; ++i)
+    {
+      arma::vec beta(betas.colptr(i), betas.n_rows, false, true);
+      lars.RegressGram(matXTy.unsafe_col(i), beta);
+    }
+  }
+
+  Timer::Stop("lars_regression");
+}
+
+void LARS::RegressGram(const arma::vec& vecXTy, arma::vec& beta)
+{
+  if (matGram.n_rows != vecXTy.n_elem || matGram.n_cols != vecXTy.n_elem)
+  {
+    Log::Fatal << "LARS::RegressGram(): the Gram matrix is " << matGram.n_rows
+        << "x" << matGram.n_cols << ", but X^T y has " << vecXTy.n_elem
+        << " elements!" << std::endl;
+  }
+
+  const size_t numDims = vecXTy.n_elem;
+
+  // Forget the previous problem, if any.
+  betaPath.clear();
+  lambdaPath.clear();
+  activeSet.clear();
+  ignoreSet.clear();
+  matUtriCholFactor.reset();
 
   // Set up active set variables.  In the beginning, the active set has size 0
   // (all dimensions are inactive).
-  isActive.resize(dataRef.n_cols, false);
+  isActive.assign(numDims, false);
 
   // Set up ignores set variables. Initialized empty.
-  isIgnored.resize(dataRef.n_cols, false);
+  isIgnored.assign(numDims, false);
 
-  // Initialize yHat and beta.
-  beta = arma::zeros(dataRef.n_cols);
-  arma::vec yHat = arma::zeros(dataRef.n_rows);
-  arma::vec yHatDirection = arma::vec(dataRef.n_rows);
+  // Initialize beta.  The prediction X * beta is never needed, because all the
+  // correlations can be computed with the Gram matrix.
+  beta = arma::zeros(numDims);
 
   bool lassocond = false;
 
@@ -87,28 +154,16 @@ void LARS::Regress(const arma::mat& matX,
   if (maxCorr < lambda1)
   {
     lambdaPath[0] = lambda1;
-    Timer::Stop("lars_regression");
     return;
   }
 
-  // Compute the Gram matrix.  If this is the elastic net problem, we will add
-  // lambda2 * I_n to the matrix.
-  if (matGram.n_elem == 0)
-  {
-    // In this case, matGram should reference matGramInternal.
-    matGramInternal = trans(dataRef) * dataRef;
-
-    if (elasticNet && !useCholesky)
-      matGramInternal += lambda2 * arma::eye(dataRef.n_cols, dataRef.n_cols);
-  }
-
   // Main loop.
-  while (((activeSet.size() + ignoreSet.size()) < dataRef.n_cols) &&
+  while (((activeSet.size() + ignoreSet.size()) < numDims) &&
          (maxCorr > tolerance))
   {
     // Compute the maximum correlation among inactive dimensions.
     maxCorr = 0;
-    for (size_t i = 0; i < dataRef.n_cols; i++)
+    for (size_t i = 0; i < numDims; i++)
     {
       if ((!isActive[i]) && (!isIgnored[i]) && (fabs(corr(i)) > maxCorr))
       {
@@ -127,7 +182,7 @@ void LARS::Regress(const arma::mat& matX,
         //   newGramCol[i] = dot(matX.col(activeSet[i]), matX.col(changeInd));
         // }
         // This is equivalent to the above 5 lines.
-        arma::vec newGramCol = matGram.elem(changeInd * dataRef.n_cols +
+        arma::vec newGramCol = matGram.elem(changeInd * numDims +
             arma::conv_to<arma::uvec>::from(activeSet));
 
         CholeskyInsert(matGram(changeInd, changeInd), newGramCol);
@@ -217,21 +272,24 @@ void LARS::Regress(const arma::mat& matX,
       }
     }
 
-    // compute "equiangular" direction in output space
-    ComputeYHatDirection(dataRef, betaDirection, yHatDirection);
+    // Compute the correlations of all dimensions with the "equiangular"
+    // direction in output space, X * betaDirection; they are the active
+    // columns of the Gram matrix times betaDirection.
+    const arma::uvec activeIndices = arma::conv_to<arma::uvec>::from(activeSet);
+    const arma::vec dirCorrs = matGram.cols(activeIndices) * betaDirection;
 
     double gamma = maxCorr / normalization;
 
     // If not all variables are active.
-    if ((activeSet.size() + ignoreSet.size()) < dataRef.n_cols)
+    if ((activeSet.size() + ignoreSet.size()) < numDims)
     {
       // Compute correlations with direction.
-      for (size_t ind = 0; ind < dataRef.n_cols; ind++)
+      for (size_t ind = 0; ind < numDims; ind++)
       {
         if (isActive[ind] || isIgnored[ind])
           continue;
 
-        double dirCorr = dot(dataRef.col(ind), yHatDirection);
+        double dirCorr = dirCorrs(ind);
         double val1 = (maxCorr - corr(ind)) / (normalization - dirCorr);
         double val2 = (maxCorr + corr(ind)) / (normalization + dirCorr);
         if ((val1 > 0) && (val1 < gamma))
@@ -266,9 +324,6 @@ void LARS::Regress(const arma::mat& matX,
       }
     }
 
-    // Update the prediction.
-    yHat += gamma * yHatDirection;
-
     // Update the estimator.
     for (size_t i = 0; i < activeSet.size(); i++)
     {
@@ -293,8 +348,14 @@ void LARS::Regress(const arma::mat& matX,
       Deactivate(changeInd);
     }
 
-    corr = vecXTy - trans(dataRef) * yHat;
-    if (elasticNet)
+    // Update the correlations, X' * (y - X * beta) = X' * y - G * beta, where
+    // only the active dimensions of beta are nonzero.  The Gram matrix used
+    // without the Cholesky factorization already includes lambda2 * I.
+    const arma::uvec newActiveIndices =
+        arma::conv_to<arma::uvec>::from(activeSet);
+    corr = vecXTy - matGram.cols(newActiveIndices) *
+        beta.elem(newActiveIndices);
+    if (elasticNet && useCholesky)
       corr -= lambda2 * beta;
 
     double curLambda = 0;
@@ -318,8 +379,6 @@ void LARS::Regress(const arma::mat& matX,
 
   // Unfortunate copy...
   beta = betaPath.back();
-
-  Timer::Stop("lars_regression");
 }
 
 // Private functions.
@@ -341,13 +400,14 @@ void LARS::Ignore(const size_t varInd)
   ignoreSet.push_back(varInd);
 }
 
-void LARS::ComputeYHatDirection(const arma::mat& matX,
-                                const arma::vec& betaDirection,
-                                arma::vec& yHatDirection)
+void LARS::ComputeGram(const arma::mat& dataRef)
 {
-  yHatDirection.fill(0);
-  for (size_t i = 0; i < activeSet.size(); i++)
-    yHatDirection += betaDirection(i) * matX.col(activeSet[i]);
+  // If this is the elastic net problem, we will add lambda2 * I_n to the
+  // matrix (with the Cholesky factorization, lambda2 is added to the factor).
+  matGramInternal = trans(dataRef) * dataRef;
+
+  if (elasticNet && !useCholesky)
+    matGramInternal += lambda2 * arma::eye(dataRef.n_cols, dataRef.n_cols);
 }
 
 void LARS::InterpolateBeta()
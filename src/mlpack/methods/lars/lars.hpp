@@ -101,7 +101,10 @@ class LARS
 
   /**
    * Set the parameters to LARS, and pass in a precalculated Gram matrix.  Both
-   * lambda1 and lambda2 default to 0.
+   * lambda1 and lambda2 default to 0.  For the elastic net without the
+   * Cholesky decomposition, the Gram matrix should include lambda2 * I (with
+   * the Cholesky decomposition, it should not).  The Gram matrix is only
+   * referenced, so it must outlive the LARS object.
    *
    * @param useCholesky Whether or not to use Cholesky decomposition when
    *    solving linear system (as opposed to using the full Gram matrix).
@@ -136,6 +139,36 @@ class LARS
                arma::vec& beta,
                const bool transposeData = true);
 
+  /**
+   * Run LARS on many problems with the same data and different responses (for
+   * instance, to code many signals with the same dictionary).  The Gram matrix
+   * (unless one was given to the constructor) and X' * y for every response
+   * are computed once, with matrix products, and then the problems are solved
+   * in parallel.  After this, the paths (BetaPath(), LambdaPath(),
+   * ActiveSet()) are not meaningful.
+   *
+   * @param data Column-major input data (or row-major input data if rowMajor =
+   *     true).
+   * @param responses Matrix of targets, one problem per column.
+   * @param betas Matrix to store the solutions in, one per column.
+   * @param transposeData Set to false if the data is row-major.
+   */
+  void Regress(const arma::mat& data,
+               const arma::mat& responses,
+               arma::mat& betas,
+               const bool transposeData = true);
+
+  /**
+   * Run LARS with the Gram matrix given to the constructor, given only X' * y:
+   * the data itself isn't needed, since all the correlations can be computed
+   * with the Gram matrix.  This is the cheapest way to solve many problems
+   * with the same data, and the LARS object can be reused for every problem.
+   *
+   * @param vecXTy X' * y, for the row-major data X and the targets y.
+   * @param beta Vector to store the solution (the coefficients) in.
+   */
+  void RegressGram(const arma::vec& vecXTy, arma::vec& beta);
+
   //! Access the set of active dimensions.
   const std::vector<size_t>& ActiveSet() const { return activeSet; }
 
@@ -220,10 +253,11 @@ class LARS
    */
   void Ignore(const size_t varInd);
 
-  // compute "equiangular" direction in output space
-  void ComputeYHatDirection(const arma::mat& matX,
-                            const arma::vec& betaDirection,
-                            arma::vec& yHatDirection);
+  /**
+   * Compute the Gram matrix of the row-major data (plus lambda2 * I for the
+   * elastic net without the Cholesky decomposition) into matGramInternal.
+   */
+  void ComputeGram(const arma::mat& dataRef);
 
   // interpolate to compute last solution vector
   void InterpolateBeta();
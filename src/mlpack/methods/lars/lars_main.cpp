@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 
 #include "lars.hpp"
+#include "elastic_net.hpp"
 
 PROGRAM_INFO("LARS", "An implementation of LARS: Least Angle Regression "
     "(Stagewise/laSso).  This is a stage-wise homotopy-based algorithm for "
@@ -27,7 +28,11 @@ PROGRAM_INFO("LARS", "An implementation of LARS: Least Angle Regression "
     "\n"
     "For efficiency reasons, it is not recommended to use this algorithm with "
     "lambda_1 = 0.  In that case, use the 'linear_regression' program, which "
-    "implements both unregularized linear regression and ridge regression.\n");
+    "implements both unregularized linear regression and ridge regression.\n"
+    "\n"
+    "With --coordinate_descent, the problem is solved by cyclic coordinate "
+    "descent instead of LARS; this never forms the Gram matrix, so it is much "
+    "faster for data with many dimensions.\n");
 
 PARAM_STRING_REQ("input_file", "File containing covariates (X).",
     "i");
@@ -43,6 +48,10 @@ PARAM_DOUBLE("lambda2", "Regularization parameter for l2-norm penalty.", "L",
     0);
 PARAM_FLAG("use_cholesky", "Use Cholesky decomposition during computation "
     "rather than explicitly computing the full Gram matrix.", "c");
+PARAM_FLAG("coordinate_descent", "Solve with cyclic coordinate descent instead "
+    "of LARS.", "C");
+PARAM_DOUBLE("tolerance", "Convergence tolerance of coordinate descent.", "e",
+    1e-7);
 
 using namespace arma;
 using namespace std;
@@ -81,10 +90,22 @@ int main(int argc, char* argv[])
     Log::Fatal << "Number of responses must be equal to number of rows of X!"
         << endl;
 
-  // Do LARS.
-  LARS lars(useCholesky, lambda1, lambda2);
   vec beta;
-  lars.Regress(matX, matY.unsafe_col(0), beta, false /* do not transpose */);
+  if (CLI::HasParam("coordinate_descent"))
+  {
+    if (useCholesky)
+      Log::Warn << "--use_cholesky ignored because --coordinate_descent is "
+          << "present." << endl;
+
+    ElasticNet elasticNet(lambda1, lambda2, CLI::GetParam<double>("tolerance"));
+    elasticNet.Regress(matX, matY.unsafe_col(0), beta, false);
+  }
+  else
+  {
+    // Do LARS.
+    LARS lars(useCholesky, lambda1, lambda2);
+    lars.Regress(matX, matY.unsafe_col(0), beta, false /* do not transpose */);
+  }
 
   const string betaFilename = CLI::GetParam<string>("output_file");
   beta.save(betaFilename, raw_ascii);
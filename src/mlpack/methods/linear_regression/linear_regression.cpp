@@ -16,81 +16,163 @@ LinearRegression::LinearRegression(const arma::mat& predictors,
                                    const bool intercept,
                                    const arma::vec& weights
                                    ) :
+    parameters(arma::zeros<arma::vec>(predictors.n_rows + (intercept ? 1 : 0))),
     lambda(lambda),
-    intercept(intercept)
+    intercept(intercept),
+    points(0)
+{
+  Update(predictors, responses, weights);
+}
+
+LinearRegression::LinearRegression(const size_t dimensionality,
+                                   const double lambda,
+                                   const bool intercept) :
+    parameters(arma::zeros<arma::vec>(dimensionality + (intercept ? 1 : 0))),
+    lambda(lambda),
+    intercept(intercept),
+    points(0)
+{
+  // Nothing to do.
+}
+
+LinearRegression::LinearRegression(const std::string& filename) :
+    lambda(0.0),
+    intercept(true),
+    points(0)
+{
+  arma::mat parameter;
+  data::Load(filename, parameter, true);
+  parameters = parameter.unsafe_col(0);
+}
+
+LinearRegression::LinearRegression(const LinearRegression& linearRegression) :
+    parameters(linearRegression.parameters),
+    lambda(linearRegression.lambda),
+    intercept(linearRegression.intercept),
+    factor(linearRegression.factor),
+    projection(linearRegression.projection),
+    points(linearRegression.points)
+{ /* Nothing to do. */ }
+
+void LinearRegression::Update(const arma::mat& predictors,
+                              const arma::vec& responses,
+                              const arma::vec& weights)
 {
   /*
    * We want to calculate the a_i coefficients of:
    * \sum_{i=0}^n (a_i * x_i^i)
-   * In order to get the intercept value, we will add a row of ones.
+   * In order to get the intercept value, we will add a column of ones to the
+   * design matrix (whose rows are the points).
    */
+  const size_t columns = parameters.n_elem;
+  if (predictors.n_rows + (intercept ? 1 : 0) != columns)
+  {
+    Log::Fatal << "LinearRegression::Update(): predictors have dimensionality "
+        << predictors.n_rows << ", but the model has dimensionality "
+        << (columns - (intercept ? 1 : 0)) << "!" << std::endl;
+  }
+  if (responses.n_elem != predictors.n_cols ||
+      (weights.n_elem > 0 && weights.n_elem != predictors.n_cols))
+  {
+    Log::Fatal << "LinearRegression::Update(): the responses and the weights "
+        << "must have one element per point!" << std::endl;
+  }
 
-  // We store the number of rows and columns of the predictors.
-  // Reminder: Armadillo stores the data transposed from how we think of it,
-  //           that is, columns are actually rows (see: column major order).
-  const size_t nCols = predictors.n_cols;
+  // The points are split into blocks, which every thread factorizes into its
+  // own factor; a block holds a few times as many points as the factor has
+  // rows, so that merging a block costs about as much as reading it.  The
+  // intercept is not penalized.
+  const size_t blockSize = std::max((size_t) 1024, 4 * columns);
+  const size_t numBlocks = (predictors.n_cols + blockSize - 1) / blockSize;
 
-  arma::mat p = predictors;
-  arma::vec r = responses;
-  // Here we add the row of ones to the predictors.
-  // The intercept is not penalized. Add an "all ones" row to design and set
-  // intercept = false to get a penalized intercept
-  if(intercept)
+  #pragma omp parallel
   {
-    p.insert_rows(0, arma::ones<arma::mat>(1,nCols));
+    arma::mat threadFactor;
+    arma::vec threadProjection;
+
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize,
+          (size_t) predictors.n_cols);
+
+      arma::mat design = arma::trans(predictors.cols(begin, end - 1));
+      arma::vec blockResponses = responses.subvec(begin, end - 1);
+      if (intercept)
+        design.insert_cols(0, arma::ones<arma::vec>(end - begin));
+
+      if (weights.n_elem > 0)
+      {
+        const arma::vec sqrtWeights = arma::sqrt(weights.subvec(begin,
+            end - 1));
+        design.each_col() %= sqrtWeights;
+        blockResponses %= sqrtWeights;
+      }
+
+      Merge(threadFactor, threadProjection, design, blockResponses);
+    }
+
+    #pragma omp critical(linear_regression_update)
+    Merge(factor, projection, threadFactor, threadProjection);
   }
 
-   if(weights.n_elem > 0)
+  points += predictors.n_cols;
+  Solve();
+}
+
+void LinearRegression::Merge(arma::mat& factor,
+                             arma::vec& projection,
+                             const arma::mat& rows,
+                             const arma::vec& values)
+{
+  if (rows.n_rows == 0)
+    return;
+
+  // If [R; rows] = Q' R', then the least squares problem of the stacked rows
+  // and values is the least squares problem of R' and Q'^T [Q^T y; values].
+  arma::mat q, r;
+  if (factor.n_rows == 0)
   {
-    p = p * diagmat(sqrt(weights));
-    r =  sqrt(weights) % responses;
+    arma::qr_econ(q, r, rows);
+    projection = arma::trans(q) * values;
   }
-
-  if (lambda != 0.0)
+  else
   {
-    // Add the identity matrix to the predictors (this is equivalent to ridge
-    // regression).  See http://math.stackexchange.com/questions/299481/ for
-    // more information.
-    p.insert_cols(nCols, predictors.n_rows);
-    p.submat(p.n_rows - predictors.n_rows, nCols, p.n_rows - 1, nCols +
-    predictors.n_rows - 1) = sqrt(lambda) * arma::eye<arma::mat>(predictors.n_rows,
-        predictors.n_rows);
+    arma::qr_econ(q, r, arma::join_cols(factor, rows));
+    projection = arma::trans(q) * arma::join_cols(projection, values);
   }
 
-  // We compute the QR decomposition of the predictors.
-  // We transpose the predictors because they are in column major order.
-  arma::mat Q, R;
-  arma::qr(Q, R, arma::trans(p));
+  factor.swap(r);
+}
+
+void LinearRegression::Solve()
+{
+  if (factor.n_rows == 0)
+    return;
 
   // We compute the parameters, B, like so:
   // R * B = Q^T * responses
-  // B = Q^T * responses * R^-1
-  // If lambda > 0, then we must add a bunch of empty responses.
+  // If lambda > 0, then we must add the rows sqrt(lambda) * I (without the
+  // intercept) to R, with empty responses.  See
+  // http://math.stackexchange.com/questions/299481/ for more information.
   if (lambda == 0.0)
   {
-    arma::solve(parameters, R, arma::trans(Q) * r);
+    arma::solve(parameters, factor, projection);
   }
   else
   {
-    // Copy responses into larger vector.
-    r.insert_rows(nCols,p.n_cols - nCols);
-    arma::solve(parameters, R, arma::trans(Q) * r);
+    const size_t offset = (intercept ? 1 : 0);
+    arma::mat penalty = arma::zeros<arma::mat>(factor.n_cols - offset,
+        factor.n_cols);
+    penalty.cols(offset, factor.n_cols - 1) = sqrt(lambda) *
+        arma::eye<arma::mat>(factor.n_cols - offset, factor.n_cols - offset);
+
+    arma::solve(parameters, arma::join_cols(factor, penalty),
+        arma::join_cols(projection, arma::zeros<arma::vec>(penalty.n_rows)));
   }
 }
 
-LinearRegression::LinearRegression(const std::string& filename) :
-    lambda(0.0)
-{
-  arma::mat parameter;
-  data::Load(filename, parameter, true);
-  parameters = parameter.unsafe_col(0);
-}
-
-LinearRegression::LinearRegression(const LinearRegression& linearRegression) :
-    parameters(linearRegression.parameters),
-    lambda(linearRegression.lambda)
-{ /* Nothing to do. */ }
-
 void LinearRegression::Predict(const arma::mat& points, arma::vec& predictions)
     const
 {
@@ -17,6 +17,27 @@ namespace regression /** Regression methods. */ {
  * A simple linear regression algorithm using ordinary least squares.
  * Optionally, this class can perform ridge regression, if the lambda parameter
  * is set to a number greater than zero.
+ *
+ * The model can be trained incrementally: Update() folds a chunk of points into
+ * the triangular factor R of the QR decomposition of all the points seen so far
+ * (and into Q^T y), and then solves for the parameters.  This takes O(d^2)
+ * memory besides the chunk, however many points there are, and gives the same
+ * model as training on all the points at once.  Each chunk is split into blocks
+ * that are factorized in parallel; the factors of the threads are merged by
+ * factorizing them stacked on top of each other.
+ *
+ * @code
+ * LinearRegression lr(dimensionality);
+ * data::ChunkedLoader<double> loader("huge.csv");
+ *
+ * arma::mat chunk;
+ * while (loader.NextChunk(chunk, 100000))
+ * {
+ *   const arma::vec responses = arma::trans(chunk.row(chunk.n_rows - 1));
+ *   chunk.shed_row(chunk.n_rows - 1);
+ *   lr.Update(chunk, responses);
+ * }
+ * @endcode
  */
 class LinearRegression
 {
@@ -37,6 +58,17 @@ class LinearRegression
                    const arma::vec& weights = arma::vec()
                    );
 
+  /**
+   * Create a model that has seen no points yet, to be trained with Update().
+   *
+   * @param dimensionality Dimensionality of the predictors.
+   * @param lambda regularization constant
+   * @param intercept include intercept?
+   */
+  LinearRegression(const size_t dimensionality,
+                   const double lambda = 0,
+                   const bool intercept = true);
+
   /**
    * Initialize the model from a file.
    *
@@ -54,7 +86,19 @@ class LinearRegression
   /**
    * Empty constructor.
    */
-  LinearRegression() { }
+  LinearRegression() : lambda(0.0), intercept(true), points(0) { }
+
+  /**
+   * Add a chunk of points to the training set and update the parameters.  The
+   * current value of Lambda() is used for the solution.
+   *
+   * @param predictors X, chunk of data points.
+   * @param responses y, the measured data for each point in the chunk.
+   * @param weights observation weights (optional).
+   */
+  void Update(const arma::mat& predictors,
+              const arma::vec& responses,
+              const arma::vec& weights = arma::vec());
 
   /**
    * Calculate y_i for each data point in points.
@@ -94,10 +138,29 @@ class LinearRegression
   //! Modify the Tikhonov regularization parameter for ridge regression.
   double& Lambda() { return lambda; }
 
+  //! Return whether the first parameter is the intercept.
+  bool Intercept() const { return intercept; }
+
+  //! Return the number of points the model has been trained on.
+  size_t Points() const { return points; }
+
   // Returns a string representation of this object.
   std::string ToString() const;
 
  private:
+  /**
+   * Replace the given factor R and projected responses Q^T y with those of the
+   * QR decomposition of R stacked on top of the given rows, with the values
+   * stacked on top of the given responses.
+   */
+  static void Merge(arma::mat& factor,
+                    arma::vec& projection,
+                    const arma::mat& rows,
+                    const arma::vec& values);
+
+  //! Solve for the parameters from the factor and the projected responses.
+  void Solve();
+
   /**
    * The calculated B.
    * Initialized and filled by constructor to hold the least squares solution.
@@ -110,6 +173,12 @@ class LinearRegression
   double lambda;
   //! Indicates whether first parameter is intercept.
   bool intercept;
+  //! The triangular factor R of the QR decomposition of the design matrix.
+  arma::mat factor;
+  //! The responses projected onto the factor, Q^T y.
+  arma::vec projection;
+  //! The number of points that the model has been trained on.
+  size_t points;
 };
 
 }; // namespace linear_regression
@@ -23,7 +23,11 @@ PROGRAM_INFO("Simple Linear Regression and Prediction",
     "   y' = X' * b\n\n"
     "and these predicted responses, y', are saved to a file "
     "(--output_predictions).  This type of regression is related to least-angle"
-    " regression, which mlpack implements with the 'lars' executable.");
+    " regression, which mlpack implements with the 'lars' executable."
+    "\n\n"
+    "If --chunk_size is given, the input file (and the responses file) are "
+    "read and the model is trained --chunk_size points at a time, so that the "
+    "training set never has to fit in memory.");
 
 PARAM_STRING("input_file", "File containing X (regressors).", "i", "");
 PARAM_STRING("input_responses", "Optional file containing y (responses). If "
@@ -42,6 +46,8 @@ PARAM_STRING("output_predictions", "If --test_file is specified, this file is "
 
 PARAM_DOUBLE("lambda", "Tikhonov regularization for ridge regression.  If 0, "
     "the method reduces to linear regression.", "l", 0.0);
+PARAM_INT("chunk_size", "If positive, train on chunks of this many points at a "
+    "time, read from the input file as they are needed.", "c", 0);
 
 using namespace mlpack;
 using namespace mlpack::regression;
@@ -98,8 +104,63 @@ int main(int argc, char* argv[])
         << "--test_file." << endl;
   }
 
+  if (CLI::GetParam<int>("chunk_size") < 0)
+  {
+    Log::Fatal << "Invalid chunk size (" << CLI::GetParam<int>("chunk_size")
+        << "); must be positive, or 0 to load the whole input file." << endl;
+  }
+  const size_t chunkSize = (size_t) CLI::GetParam<int>("chunk_size");
+
+  // An input file was given and we need to generate the model from chunks of
+  // it.
+  if (computeModel && chunkSize > 0)
+  {
+    data::ChunkedLoader<double> loader(trainName, true);
+    const bool separateResponses = !responseName.empty();
+    data::ChunkedLoader<double> responseLoader(separateResponses ?
+        responseName : trainName, true);
+    if (separateResponses && responseLoader.Dimensionality() != 1)
+      Log::Fatal << "The responses must have one column.\n";
+
+    const size_t dimensionality = loader.Dimensionality() -
+        (separateResponses ? 0 : 1);
+    lr = LinearRegression(dimensionality, lambda);
+
+    Timer::Start("regression");
+    mat chunk, responseChunk;
+    while (loader.NextChunk(chunk, chunkSize))
+    {
+      if (separateResponses)
+      {
+        if (!responseLoader.NextChunk(responseChunk, chunk.n_cols) ||
+            responseChunk.n_cols != chunk.n_cols)
+        {
+          Log::Fatal << "The responses must have the same number of rows as "
+              << "the training file.\n";
+        }
+      }
+      else
+      {
+        // The last dimension of each chunk holds its responses.
+        responseChunk = chunk.row(chunk.n_rows - 1);
+        chunk.shed_row(chunk.n_rows - 1);
+      }
+
+      lr.Update(chunk, trans(responseChunk));
+    }
+    Timer::Stop("regression");
+
+    if (separateResponses && responseLoader.NextChunk(responseChunk, 1))
+      Log::Fatal << "The responses must have the same number of rows as the "
+          "training file.\n";
+
+    Log::Info << "Trained on " << lr.Points() << " points." << endl;
+
+    // Save the parameters.
+    data::Save(outputFile, lr.Parameters(), true);
+  }
   // An input file was given and we need to generate the model.
-  if (computeModel)
+  else if (computeModel)
   {
     Timer::Start("load_regressors");
     data::Load(trainName, regressors, true);
@@ -131,7 +192,7 @@ int main(int argc, char* argv[])
     }
 
     Timer::Start("regression");
-    lr = LinearRegression(regressors, responses.unsafe_col(0));
+    lr = LinearRegression(regressors, responses.unsafe_col(0), lambda);
     Timer::Stop("regression");
 
     // Save the parameters.
@@ -97,34 +97,41 @@ void LocalCoordinateCoding<DictionaryInitializer>::Encode(
 template<typename DictionaryInitializer>
 void LocalCoordinateCoding<DictionaryInitializer>::OptimizeCode()
 {
-  arma::mat invSqDists = 1.0 / (repmat(trans(sum(square(dictionary))), 1,
-      data.n_cols) + repmat(sum(square(data)), atoms, 1) - 2 * trans(dictionary)
-      * data);
-
   arma::mat dictGram = trans(dictionary) * dictionary;
-  arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
 
-  for (size_t i = 0; i < data.n_cols; i++)
+  // The problem of each point uses the dictionary with its atoms weighted by
+  // invW, D' = D * diagmat(invW); so its Gram matrix is
+  // diagmat(invW) * D^T * D * diagmat(invW) and D'^T x = invW % (D^T x), and
+  // D' never has to be formed.  D^T x is computed for all points at once, and
+  // it also gives the squared distances from each point to the atoms.
+  const arma::mat dictTData = trans(dictionary) * data;
+  const arma::vec atomNorms = trans(sum(square(dictionary), 0));
+  const arma::rowvec pointNorms = sum(square(data), 0);
+
+  // The points are independent, so they are coded in parallel.  Each thread
+  // has its own workspace: the weights, the weighted Gram matrix, and a LARS
+  // object that references that Gram matrix.
+  #pragma omp parallel
   {
-    // report progress
-    if ((i % 100) == 0)
-    {
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-    }
-
-    arma::vec invW = invSqDists.unsafe_col(i);
-    arma::mat dictPrime = dictionary * diagmat(invW);
-
-    arma::mat dictGramTD = diagmat(invW) * dictGram * diagmat(invW);
+    arma::vec invW(atoms);
+    arma::vec vecXTy(atoms);
+    arma::mat dictGramTD(atoms, atoms);
 
     bool useCholesky = false;
     regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
 
-    // Run LARS for this point, by making an alias of the point and passing
-    // that.
-    arma::vec beta = codes.unsafe_col(i);
-    lars.Regress(dictPrime, data.unsafe_col(i), beta, false);
-    beta %= invW; // Remember, beta is an alias of codes.col(i).
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < data.n_cols; i++)
+    {
+      invW = 1.0 / (atomNorms + pointNorms[i] - 2.0 * dictTData.col(i));
+      dictGramTD = dictGram % (invW * trans(invW));
+      vecXTy = invW % dictTData.col(i);
+
+      // Run LARS for this point, writing the result directly into its code.
+      arma::vec beta(codes.colptr(i), atoms, false, true);
+      lars.RegressGram(vecXTy, beta);
+      beta %= invW; // Remember, beta is an alias of codes.col(i).
+    }
   }
 }
 
@@ -18,15 +18,23 @@ namespace regression {
  * The log-likelihood function for the logistic regression objective function.
  * This is used by various mlpack optimizers to train a logistic regression
  * model.
+ *
+ * The predictors can be dense (arma::mat) or sparse (arma::sp_mat); with sparse
+ * predictors, the sigmoid of a point costs only as much as its nonzero
+ * features.  The full objective and gradient are evaluated in parallel over
+ * blocks of points, and every thread holds its own copy of the gradient.
+ *
+ * @tparam MatType Type of the matrix of predictors (arma::mat or arma::sp_mat).
  */
+template<typename MatType = arma::mat>
 class LogisticRegressionFunction
 {
  public:
-  LogisticRegressionFunction(const arma::mat& predictors,
+  LogisticRegressionFunction(const MatType& predictors,
                              const arma::vec& responses,
                              const double lambda = 0);
 
-  LogisticRegressionFunction(const arma::mat& predictors,
+  LogisticRegressionFunction(const MatType& predictors,
                              const arma::vec& responses,
                              const arma::mat& initialPoint,
                              const double lambda = 0);
@@ -42,7 +50,7 @@ class LogisticRegressionFunction
   double& Lambda() { return lambda; }
 
   //! Return the matrix of predictors.
-  const arma::mat& Predictors() const { return predictors; }
+  const MatType& Predictors() const { return predictors; }
   //! Return the vector of responses.
   const arma::vec& Responses() const { return responses; }
 
@@ -75,6 +83,21 @@ class LogisticRegressionFunction
    */
   double Evaluate(const arma::mat& parameters, const size_t i) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function with the given
+   * parameters, summed over the points begin, ..., begin + batchSize - 1.  This
+   * gives the same result as summing Evaluate(parameters, i) over those points,
+   * but computes all of their sigmoids with one matrix-vector product; it is
+   * used by mini-batch optimizers such as MiniBatchSGD.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point to use.
+   * @param batchSize Number of points to use.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
   /**
    * Evaluate the gradient of the logistic regression log-likelihood function
    * with the given parameters.
@@ -98,6 +121,23 @@ class LogisticRegressionFunction
                 const size_t i,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with the given parameters, summed over the points begin, ..., begin +
+   * batchSize - 1.  This gives the same result as summing Gradient(parameters,
+   * i, gradient) over those points, but uses matrix operations on the whole
+   * batch.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point to use.
+   * @param batchSize Number of points to use.
+   * @param gradient Vector to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                const size_t batchSize,
+                arma::mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -105,10 +145,40 @@ class LogisticRegressionFunction
   size_t NumFunctions() const { return predictors.n_cols; }
 
  private:
+  //! Return the sigmoid argument of point i, including the intercept term.
+  double Exponent(const arma::mat& parameters, const size_t i) const;
+
+  //! Return the log-likelihood of the response of point i, given its exponent.
+  double LogLikelihood(const double exponent, const size_t i) const;
+
+  //! Add weight * x_i to the elements 1, ..., d of the given gradient.
+  void AddPoint(arma::mat& gradient, const size_t i, const double weight)
+      const;
+
+  //! Return the dot product of column i of the dense predictors and w.
+  static double Dot(const arma::mat& predictors,
+                    const size_t i,
+                    const double* w);
+  //! Return the dot product of column i of the sparse predictors and w.
+  static double Dot(const arma::sp_mat& predictors,
+                    const size_t i,
+                    const double* w);
+
+  //! Add weight times column i of the dense predictors to g.
+  static void Add(const arma::mat& predictors,
+                  const size_t i,
+                  const double weight,
+                  double* g);
+  //! Add weight times column i of the sparse predictors to g.
+  static void Add(const arma::sp_mat& predictors,
+                  const size_t i,
+                  const double weight,
+                  double* g);
+
   //! The initial point, from which to start the optimization.
   arma::mat initialPoint;
   //! The matrix of data points (predictors).
-  const arma::mat& predictors;
+  const MatType& predictors;
   //! The vector of responses to the input data points.
   const arma::vec& responses;
   //! The regularization parameter for L2-regularization.
@@ -118,4 +188,7 @@ class LogisticRegressionFunction
 }; // namespace regression
 }; // namespace mlpack
 
+// Include implementation.
+#include "logistic_regression_function_impl.hpp"
+
 #endif // __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_HPP
@@ -0,0 +1,294 @@
+/**
+ * @file logistic_regression_function_impl.hpp
+ * @author Sumedh Ghaisas
+ *
+ * Implementation of hte LogisticRegressionFunction class.
+ */
+#ifndef __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
+#define __MLPACK_METHODS_LOGISTIC_REGRESSION_LOGISTIC_REGRESSION_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "logistic_regression_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
+    const MatType& predictors,
+    const arma::vec& responses,
+    const double lambda) :
+    predictors(predictors),
+    responses(responses),
+    lambda(lambda)
+{
+  initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
+
+  // Sanity check.
+  if (responses.n_elem != predictors.n_cols)
+    Log::Fatal << "LogisticRegressionFunction::LogisticRegressionFunction(): "
+        << "predictors matrix has " << predictors.n_cols << " points, but "
+        << "responses vector has " << responses.n_elem << " elements (should be"
+        << " " << predictors.n_cols << ")!" << std::endl;
+}
+
+template<typename MatType>
+LogisticRegressionFunction<MatType>::LogisticRegressionFunction(
+    const MatType& predictors,
+    const arma::vec& responses,
+    const arma::mat& initialPoint,
+    const double lambda) :
+    initialPoint(initialPoint),
+    predictors(predictors),
+    responses(responses),
+    lambda(lambda)
+{
+  //to check if initialPoint is compatible with predictors
+  if (initialPoint.n_rows != (predictors.n_rows + 1) ||
+      initialPoint.n_cols != 1)
+    this->initialPoint = arma::zeros<arma::mat>(predictors.n_rows + 1, 1);
+}
+
+/**
+ * Evaluate the logistic regression objective function given the estimated
+ * parameters.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
+{
+  // The objective function is the log-likelihood function (w is the parameters
+  // vector for the model; y is the responses; x is the predictors; sig() is the
+  // sigmoid function):
+  //   f(w) = sum(y log(sig(w'x)) + (1 - y) log(sig(1 - w'x))).
+  // We want to minimize this function.  L2-regularization is just lambda
+  // multiplied by the squared l2-norm of the parameters then divided by two.
+
+  // For the regularization, we ignore the first term, which is the intercept
+  // term.
+  const double regularization = 0.5 * lambda *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  // Assemble full objective function.  Often the objective function and the
+  // regularization as given are divided by the number of features, but this
+  // doesn't actually affect the optimization result, so we'll just ignore those
+  // terms for computational efficiency.
+  double result = 0.0;
+  #pragma omp parallel for schedule(static) reduction(+:result)
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    result += LogLikelihood(Exponent(parameters, i), i);
+
+  // Invert the result, because it's a minimization.
+  return -result + regularization;
+}
+
+/**
+ * Evaluate the logistic regression objective function, but with only one point.
+ * This is useful for optimizers that use a separable objective function, such
+ * as SGD.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  // Calculate the regularization term.  We must divide by the number of points,
+  // so that sum(Evaluate(parameters, [1:points])) == Evaluate(parameters).
+  const double regularization = lambda * (1.0 / (2.0 * predictors.n_cols)) *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  return -LogLikelihood(Exponent(parameters, i), i) + regularization;
+}
+
+/**
+ * Evaluate the logistic regression objective function on a batch of points.
+ * This is useful for mini-batch optimizers.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  // Each point gets its share of the regularization term, like the
+  // single-point Evaluate().
+  const double regularization = lambda * (batchSize / (2.0 *
+      predictors.n_cols)) * arma::dot(parameters.col(0).subvec(1,
+      parameters.n_elem - 1), parameters.col(0).subvec(1,
+      parameters.n_elem - 1));
+
+  double result = 0.0;
+  for (size_t i = begin; i < begin + batchSize; ++i)
+    result += LogLikelihood(Exponent(parameters, i), i);
+
+  return -result + regularization;
+}
+
+//! Evaluate the gradient of the logistic regression objective function.
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(const arma::mat& parameters,
+                                                   arma::mat& gradient) const
+{
+  // Regularization term.
+  gradient.zeros(parameters.n_elem, 1);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1);
+
+  // Every thread accumulates the gradient of its points, with the sigmoid of
+  // each point computed just before the point is added, while it is still in
+  // the cache.
+  #pragma omp parallel
+  {
+    arma::mat threadGradient;
+    threadGradient.zeros(parameters.n_elem, 1);
+
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < predictors.n_cols; ++i)
+    {
+      const double sigmoid = 1.0 / (1.0 + std::exp(-Exponent(parameters, i)));
+      const double error = responses[i] - sigmoid;
+
+      threadGradient[0] -= error;
+      AddPoint(threadGradient, i, -error);
+    }
+
+    #pragma omp critical(logistic_regression_gradient)
+    gradient += threadGradient;
+  }
+}
+
+/**
+ * Evaluate the individual gradients of the logistic regression objective
+ * function with respect to individual points.  This is useful for optimizers
+ * that use a separable objective function, such as SGD.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(const arma::mat& parameters,
+                                                   const size_t i,
+                                                   arma::mat& gradient) const
+{
+  const double sigmoid = 1.0 / (1.0 + std::exp(-Exponent(parameters, i)));
+  const double error = responses[i] - sigmoid;
+
+  // Calculate the regularization term.
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = -error;
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1) / predictors.n_cols;
+  AddPoint(gradient, i, -error);
+}
+
+/**
+ * Evaluate the gradient of the logistic regression objective function summed
+ * over a batch of points.  This is useful for mini-batch optimizers.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(const arma::mat& parameters,
+                                                   const size_t begin,
+                                                   const size_t batchSize,
+                                                   arma::mat& gradient) const
+{
+  // Each point contributes its share of the regularization term.
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = 0.0;
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1) *
+      (double(batchSize) / predictors.n_cols);
+
+  for (size_t i = begin; i < begin + batchSize; ++i)
+  {
+    const double sigmoid = 1.0 / (1.0 + std::exp(-Exponent(parameters, i)));
+    const double error = responses[i] - sigmoid;
+
+    gradient[0] -= error;
+    AddPoint(gradient, i, -error);
+  }
+}
+
+template<typename MatType>
+inline double LogisticRegressionFunction<MatType>::Exponent(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  // The intercept term is parameters(0, 0) and does not need to be multiplied
+  // by any of the predictors.
+  return parameters(0, 0) + Dot(predictors, i, parameters.memptr() + 1);
+}
+
+template<typename MatType>
+inline double LogisticRegressionFunction<MatType>::LogLikelihood(
+    const double exponent,
+    const size_t i) const
+{
+  const double sigmoid = 1.0 / (1.0 + std::exp(-exponent));
+  if (responses[i] == 1)
+    return log(sigmoid);
+  else
+    return log(1.0 - sigmoid);
+}
+
+template<typename MatType>
+inline void LogisticRegressionFunction<MatType>::AddPoint(
+    arma::mat& gradient,
+    const size_t i,
+    const double weight) const
+{
+  Add(predictors, i, weight, gradient.memptr() + 1);
+}
+
+template<typename MatType>
+inline double LogisticRegressionFunction<MatType>::Dot(
+    const arma::mat& predictors,
+    const size_t i,
+    const double* w)
+{
+  const double* x = predictors.colptr(i);
+  double result = 0.0;
+  for (size_t j = 0; j < predictors.n_rows; ++j)
+    result += x[j] * w[j];
+  return result;
+}
+
+template<typename MatType>
+inline double LogisticRegressionFunction<MatType>::Dot(
+    const arma::sp_mat& predictors,
+    const size_t i,
+    const double* w)
+{
+  double result = 0.0;
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+       it != predictors.end_col(i); ++it)
+    result += (*it) * w[it.row()];
+  return result;
+}
+
+template<typename MatType>
+inline void LogisticRegressionFunction<MatType>::Add(
+    const arma::mat& predictors,
+    const size_t i,
+    const double weight,
+    double* g)
+{
+  const double* x = predictors.colptr(i);
+  for (size_t j = 0; j < predictors.n_rows; ++j)
+    g[j] += weight * x[j];
+}
+
+template<typename MatType>
+inline void LogisticRegressionFunction<MatType>::Add(
+    const arma::sp_mat& predictors,
+    const size_t i,
+    const double weight,
+    double* g)
+{
+  for (arma::sp_mat::const_iterator it = predictors.begin_col(i);
+       it != predictors.end_col(i); ++it)
+    g[it.row()] += weight * (*it);
+}
+
+}; // namespace regression
+}; // namespace mlpack
+
+#endif
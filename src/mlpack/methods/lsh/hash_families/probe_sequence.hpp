@@ -0,0 +1,90 @@
+/**
+ * @file probe_sequence.hpp
+ * @author Parikshit Ram
+ *
+ * Generation of the perturbation sets used by multiprobe LSH, in increasing
+ * order of their score.
+ */
+#ifndef __MLPACK_METHODS_LSH_HASH_FAMILIES_PROBE_SEQUENCE_HPP
+#define __MLPACK_METHODS_LSH_HASH_FAMILIES_PROBE_SEQUENCE_HPP
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Given the scores of a list of possible moves of a hash key (sorted in
+ * increasing order), this class generates the sets of moves in increasing
+ * order of their total score, following Lv et al. (2007), "Multi-probe LSH:
+ * efficient indexing for high-dimensional similarity search".  Each set is a
+ * sorted list of positions in the list of moves, and the successors of a set
+ * are obtained by either shifting its last position by one or appending the
+ * position after its last one.  The hash family decides whether a set is a
+ * valid perturbation of the key.
+ */
+class ProbeSequence
+{
+ public:
+  /**
+   * Prepare to generate the sets of moves with the given scores.
+   *
+   * @param scores Scores of the moves, sorted in increasing order.
+   */
+  ProbeSequence(const std::vector<double>& scores) : scores(scores)
+  {
+    if (!scores.empty())
+      heap.push(ProbeSet(scores[0], std::vector<size_t>(1, 0)));
+  }
+
+  /**
+   * Get the next set of moves.
+   *
+   * @param positions Output positions of the moves of the set.
+   * @return false if there are no more sets.
+   */
+  bool Next(std::vector<size_t>& positions)
+  {
+    if (heap.empty())
+      return false;
+
+    const ProbeSet set = heap.top();
+    heap.pop();
+
+    const size_t last = set.second.back();
+    if (last + 1 < scores.size())
+    {
+      // Shift: replace the last move with the next one.
+      ProbeSet shifted = set;
+      shifted.second.back() = last + 1;
+      shifted.first += scores[last + 1] - scores[last];
+      heap.push(shifted);
+
+      // Expand: add the next move.
+      ProbeSet expanded = set;
+      expanded.second.push_back(last + 1);
+      expanded.first += scores[last + 1];
+      heap.push(expanded);
+    }
+
+    positions = set.second;
+    return true;
+  }
+
+ private:
+  //! A set of moves, with its total score.
+  typedef std::pair<double, std::vector<size_t> > ProbeSet;
+
+  //! The scores of the moves.
+  const std::vector<double>& scores;
+  //! The sets that can be generated next, best first.
+  std::priority_queue<ProbeSet, std::vector<ProbeSet>,
+      std::greater<ProbeSet> > heap;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
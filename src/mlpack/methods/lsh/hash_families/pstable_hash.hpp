@@ -0,0 +1,308 @@
+/**
+ * @file pstable_hash.hpp
+ * @author Parikshit Ram
+ *
+ * The family of LSH functions based on 2-stable distributions, for the
+ * Euclidean distance.
+ */
+#ifndef __MLPACK_METHODS_LSH_HASH_FAMILIES_PSTABLE_HASH_HPP
+#define __MLPACK_METHODS_LSH_HASH_FAMILIES_PSTABLE_HASH_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include "probe_sequence.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The p-stable LSH family of Datar et al. (2004) for the Euclidean distance.
+ * Each of the 'numProj' functions of a table projects a point onto a random
+ * Gaussian direction, adds a random offset in [0, hashWidth), and divides by
+ * the hash width; the key of the point in the table is the floor of these
+ * values.  The key is hashed into a bucket of the second hash table with a
+ * random weight vector:
+ *
+ * bucket = <key, secondHashWeights> % secondHashSize.
+ *
+ * The neighbor candidates are scored with their exact Euclidean distance.
+ *
+ * This class is a hash family for LSHSearch; see there for the interface.
+ */
+class PStableHash
+{
+ public:
+  //! Create an empty hash family; Build() draws the functions.
+  PStableHash() : numProj(0), hashWidth(0.0), secondHashSize(0) { }
+
+  /**
+   * Draw the functions of every table.  If the hash width is 0, it is chosen
+   * as the average distance of 25 random pairs of reference points, which
+   * should be a reasonable upper bound on the nearest-neighbor distance.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numProjIn Number of projections in each hash table.
+   * @param numTables Number of hash tables.
+   * @param hashWidthIn Width of the hash (0 to choose it from the data).
+   * @param secondHashSizeIn Size of the second hash table.
+   */
+  void Build(const arma::mat& referenceSet,
+             const size_t numProjIn,
+             const size_t numTables,
+             const double hashWidthIn,
+             const size_t secondHashSizeIn)
+  {
+    numProj = numProjIn;
+    secondHashSize = secondHashSizeIn;
+    hashWidth = hashWidthIn;
+    if (hashWidth == 0.0) // The user has not provided any value.
+    {
+      // Compute a heuristic hash width from the data.
+      for (size_t i = 0; i < 25; i++)
+      {
+        size_t p1 = (size_t) math::RandInt(referenceSet.n_cols);
+        size_t p2 = (size_t) math::RandInt(referenceSet.n_cols);
+
+        hashWidth += std::sqrt(metric::EuclideanDistance::Evaluate(
+            referenceSet.unsafe_col(p1), referenceSet.unsafe_col(p2)));
+      }
+
+      hashWidth /= 25;
+    }
+
+    Log::Info << "Hash width chosen as: " << hashWidth << std::endl;
+
+    // Obtain the weights for the second hash.
+    secondHashWeights = arma::floor(arma::randu(numProj) *
+                                    (double) secondHashSize);
+
+    // The offsets for all projections in all tables.  Since the 'offsets' are
+    // in [0, hashWidth], we obtain the 'offsets' as randu(numProj, numTables) *
+    // hashWidth.
+    offsets.randu(numProj, numTables);
+    offsets *= hashWidth;
+
+    // For L2 metric, 2-stable distributions are used, and the normal
+    // Z ~ N(0, 1) is a 2-stable distribution.  The projection matrices are
+    // kept side by side, so that points can be projected onto every table with
+    // a single multiplication.
+    projections.clear();
+    stackedProjections.set_size(referenceSet.n_rows, numProj * numTables);
+    for (size_t i = 0; i < numTables; i++)
+    {
+      arma::mat projMat;
+      projMat.randn(referenceSet.n_rows, numProj);
+
+      projections.push_back(projMat);
+      stackedProjections.cols(i * numProj, (i + 1) * numProj - 1) = projMat;
+    }
+  }
+
+  //! Get the dimensionality of the points that can be hashed.
+  size_t Dimensionality() const { return stackedProjections.n_rows; }
+
+  /**
+   * Compute the projections of a contiguous batch of points onto the first
+   * 'numTables' tables, shifted by the offsets and divided by the hash width;
+   * the key of a point is the floor of its projections.
+   *
+   * @param points Set of points.
+   * @param begin Index of the first point of the batch.
+   * @param count Number of points in the batch.
+   * @param numTables Number of tables to project onto.
+   * @param allProjInTables Output matrix of size ((numProj * numTables) x
+   *     count).
+   */
+  void Project(const arma::mat& points,
+               const size_t begin,
+               const size_t count,
+               const size_t numTables,
+               arma::mat& allProjInTables) const
+  {
+    const size_t numRows = numProj * numTables;
+    allProjInTables = stackedProjections.cols(0, numRows - 1).t() *
+        points.cols(begin, begin + count - 1);
+
+    // The offsets of the first 'numTables' tables are stored contiguously, in
+    // the same order as the rows of 'allProjInTables'.
+    const arma::vec offsetVec(offsets.memptr(), numRows);
+    allProjInTables.each_col() += offsetVec;
+    allProjInTables /= hashWidth;
+  }
+
+  /**
+   * Return the bucket of the second hash table of the key with the given
+   * 'numProj' projections.
+   */
+  size_t Bucket(const double* projection) const
+  {
+    double hash = 0.0;
+    for (size_t j = 0; j < numProj; j++)
+      hash += secondHashWeights[j] * std::floor(projection[j]);
+
+    return (size_t) hash % secondHashSize;
+  }
+
+  /**
+   * Compute the 'numProbes' buckets that are most likely to contain neighbors
+   * of a point in one table, apart from its own bucket.  Keys obtained by
+   * moving coordinates of the key by -1 or +1 are generated in increasing
+   * order of the summed squared distances from the projections to the crossed
+   * bucket boundaries.
+   *
+   * @param projection The 'numProj' projections of the point in this table.
+   * @param numProbes Number of buckets to return.
+   * @param buckets Output list of buckets (at most 'numProbes').
+   */
+  void PerturbedBuckets(const double* projection,
+                        const size_t numProbes,
+                        std::vector<size_t>& buckets) const
+  {
+    buckets.clear();
+
+    // The key of the point in this table, and its second hash before the
+    // modulus.
+    arma::vec key(numProj);
+    double baseHash = 0.0;
+    for (size_t j = 0; j < numProj; j++)
+    {
+      key[j] = std::floor(projection[j]);
+      baseHash += secondHashWeights[j] * key[j];
+    }
+
+    // Moving coordinate j of the key by -1 or +1 gives a neighboring bucket;
+    // the score of that move is the squared distance from the projection to
+    // the corresponding bucket boundary.  Sort all 2 * numProj moves by score.
+    std::vector<std::pair<double, size_t> > moves(2 * numProj);
+    for (size_t j = 0; j < numProj; j++)
+    {
+      const double lower = projection[j] - key[j];
+      moves[2 * j] = std::make_pair(lower * lower, 2 * j);
+      moves[2 * j + 1] = std::make_pair((1.0 - lower) * (1.0 - lower),
+          2 * j + 1);
+    }
+    std::sort(moves.begin(), moves.end());
+
+    std::vector<double> scores(moves.size());
+    for (size_t i = 0; i < moves.size(); i++)
+      scores[i] = moves[i].first;
+
+    ProbeSequence sequence(scores);
+    std::vector<size_t> set;
+    while (buckets.size() < numProbes && sequence.Next(set))
+    {
+      // A set that moves the same coordinate both ways is not a valid bucket.
+      std::vector<bool> moved(numProj, false);
+      bool valid = true;
+      double hash = baseHash;
+      for (size_t i = 0; i < set.size(); i++)
+      {
+        const size_t move = moves[set[i]].second;
+        const size_t dim = move / 2;
+        if (moved[dim])
+        {
+          valid = false;
+          break;
+        }
+
+        moved[dim] = true;
+        hash += (move % 2 == 0) ? -secondHashWeights[dim] :
+            secondHashWeights[dim];
+      }
+
+      if (valid)
+        buckets.push_back((size_t) hash % secondHashSize);
+    }
+  }
+
+  /**
+   * Nothing about the reference points needs to be stored, because the
+   * candidates are scored with the reference set itself.
+   */
+  void StorePoints(const arma::mat& /* allProjInTables */,
+                   const size_t /* begin */) { }
+
+  /**
+   * Compute the Euclidean distances between a query and a block of neighbor
+   * candidates.  The differences are gathered into contiguous memory, so that
+   * the distances of the whole block are computed by a single vectorized
+   * expression.
+   *
+   * @param referenceSet Set of reference points.
+   * @param query The query point.
+   * @param queryProjections Projections of the query (unused).
+   * @param numTablesToSearch Number of tables being searched (unused).
+   * @param candidates Indices of the candidates.
+   * @param numCandidates Number of candidates; at most block.n_cols.
+   * @param block Scratch space with referenceSet.n_rows rows.
+   * @param distances Output distances.
+   */
+  void Distances(const arma::mat& referenceSet,
+                 const double* query,
+                 const double* /* queryProjections */,
+                 const size_t /* numTablesToSearch */,
+                 const size_t* candidates,
+                 const size_t numCandidates,
+                 arma::mat& block,
+                 arma::rowvec& distances) const
+  {
+    const size_t dims = referenceSet.n_rows;
+    for (size_t j = 0; j < numCandidates; ++j)
+    {
+      const double* reference = referenceSet.colptr(candidates[j]);
+      double* diff = block.colptr(j);
+      for (size_t d = 0; d < dims; ++d)
+        diff[d] = reference[d] - query[d];
+    }
+
+    distances = arma::sqrt(arma::sum(arma::square(
+        block.cols(0, numCandidates - 1)), 0));
+  }
+
+  //! Get the hash width.
+  double HashWidth() const { return hashWidth; }
+
+  //! Get the projection matrix of each table.
+  const std::vector<arma::mat>& Projections() const { return projections; }
+
+  //! Return the number of bytes used by the functions.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(projections) - sizeof(stackedProjections) -
+        sizeof(offsets) - sizeof(secondHashWeights) +
+        util::MemoryUsage(projections) + util::MemoryUsage(stackedProjections) +
+        util::MemoryUsage(offsets) + util::MemoryUsage(secondHashWeights);
+  }
+
+  //! Returns a string representation of this object.
+  std::string ToString() const
+  {
+    std::ostringstream convert;
+    convert << "PStableHash [" << this << "]" << std::endl;
+    convert << "  Hash Width: " << hashWidth << std::endl;
+    return convert.str();
+  }
+
+ private:
+  //! The number of projections of each table.
+  size_t numProj;
+  //! The hash width.
+  double hashWidth;
+  //! The size of the second hash table.
+  size_t secondHashSize;
+
+  //! The projection matrix of each table; each is dims x numProj.
+  std::vector<arma::mat> projections;
+  //! All the projection matrices side by side; dims x (numProj * numTables).
+  arma::mat stackedProjections;
+  //! The offsets 'b' of each projection of each table; numProj x numTables.
+  arma::mat offsets;
+  //! The weights of the second hash.
+  arma::vec secondHashWeights;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
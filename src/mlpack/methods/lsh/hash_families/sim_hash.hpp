@@ -0,0 +1,271 @@
+/**
+ * @file sim_hash.hpp
+ * @author Parikshit Ram
+ *
+ * The family of sign-random-projection LSH functions (SimHash), for the angle
+ * between points.
+ */
+#ifndef __MLPACK_METHODS_LSH_HASH_FAMILIES_SIM_HASH_HPP
+#define __MLPACK_METHODS_LSH_HASH_FAMILIES_SIM_HASH_HPP
+
+#include <mlpack/core.hpp>
+#include <bitset>
+#include <stdint.h>
+
+#include "probe_sequence.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The sign-random-projection LSH family of Charikar (2002), "Similarity
+ * estimation techniques from rounding algorithms", for the angle between
+ * points (and so for cosine similarity).  Each of the 'numProj' functions of a
+ * table gives one bit: whether the point lies on the positive side of a random
+ * Gaussian hyperplane through the origin.  Two points get different bits with
+ * probability theta / pi, where theta is the angle between them.
+ *
+ * The bits of a point in a table are packed into one 64-bit code (so 'numProj'
+ * can be at most 64), and the codes of every reference point in every table are
+ * kept.  The neighbor candidates are scored by the Hamming distance between
+ * the codes of the query and the codes of the candidate in the tables being
+ * searched, computed with XOR and popcount, and returned as the estimated
+ * angle
+ *
+ * theta = pi * hamming / (numProj * numTablesToSearch),
+ *
+ * so no reference point is touched during the search and the codes take
+ * 'numProj * numTables' bits per point instead of 64 bits per dimension.  The
+ * hash width is not used.
+ *
+ * This class is a hash family for LSHSearch; see there for the interface.
+ */
+class SimHash
+{
+ public:
+  //! Create an empty hash family; Build() draws the functions.
+  SimHash() : numProj(0), numTables(0), secondHashSize(0) { }
+
+  /**
+   * Draw the hyperplanes of every table.
+   *
+   * @param referenceSet Set of reference points.
+   * @param numProjIn Number of bits of each hash table (at most 64).
+   * @param numTablesIn Number of hash tables.
+   * @param hashWidth Ignored.
+   * @param secondHashSizeIn Size of the second hash table.
+   */
+  void Build(const arma::mat& referenceSet,
+             const size_t numProjIn,
+             const size_t numTablesIn,
+             const double /* hashWidth */,
+             const size_t secondHashSizeIn)
+  {
+    if (numProjIn == 0 || numProjIn > 64)
+      Log::Fatal << "SimHash: the number of projections (" << numProjIn
+          << ") must be between 1 and 64." << std::endl;
+
+    numProj = numProjIn;
+    numTables = numTablesIn;
+    secondHashSize = secondHashSizeIn;
+
+    hyperplanes.randn(referenceSet.n_rows, numProj * numTables);
+    codes.clear();
+  }
+
+  //! Get the dimensionality of the points that can be hashed.
+  size_t Dimensionality() const { return hyperplanes.n_rows; }
+
+  /**
+   * Compute the projections of a contiguous batch of points onto the
+   * hyperplanes of the first 'numTables' tables; a bit is set when its
+   * projection is not negative.
+   *
+   * @param points Set of points.
+   * @param begin Index of the first point of the batch.
+   * @param count Number of points in the batch.
+   * @param numTablesToProject Number of tables to project onto.
+   * @param allProjInTables Output matrix of size ((numProj *
+   *     numTablesToProject) x count).
+   */
+  void Project(const arma::mat& points,
+               const size_t begin,
+               const size_t count,
+               const size_t numTablesToProject,
+               arma::mat& allProjInTables) const
+  {
+    allProjInTables = hyperplanes.cols(0, numProj * numTablesToProject - 1).t()
+        * points.cols(begin, begin + count - 1);
+  }
+
+  /**
+   * Return the bucket of the second hash table of the code with the given
+   * 'numProj' projections.
+   */
+  size_t Bucket(const double* projection) const
+  {
+    return BucketOfCode(Code(projection));
+  }
+
+  /**
+   * Compute the 'numProbes' buckets that are most likely to contain neighbors
+   * of a point in one table, apart from its own bucket.  Codes obtained by
+   * flipping bits are generated in increasing order of the summed squared
+   * projections of the flipped bits, so the bits of the hyperplanes closest
+   * to the point are flipped first.
+   *
+   * @param projection The 'numProj' projections of the point in this table.
+   * @param numProbes Number of buckets to return.
+   * @param buckets Output list of buckets (at most 'numProbes').
+   */
+  void PerturbedBuckets(const double* projection,
+                        const size_t numProbes,
+                        std::vector<size_t>& buckets) const
+  {
+    buckets.clear();
+
+    const uint64_t code = Code(projection);
+    std::vector<std::pair<double, size_t> > moves(numProj);
+    for (size_t j = 0; j < numProj; j++)
+      moves[j] = std::make_pair(projection[j] * projection[j], j);
+    std::sort(moves.begin(), moves.end());
+
+    std::vector<double> scores(numProj);
+    for (size_t j = 0; j < numProj; j++)
+      scores[j] = moves[j].first;
+
+    ProbeSequence sequence(scores);
+    std::vector<size_t> set;
+    while (buckets.size() < numProbes && sequence.Next(set))
+    {
+      uint64_t flipped = code;
+      for (size_t i = 0; i < set.size(); i++)
+        flipped ^= (uint64_t(1) << moves[set[i]].second);
+
+      buckets.push_back(BucketOfCode(flipped));
+    }
+  }
+
+  /**
+   * Store the codes of a contiguous batch of reference points, given their
+   * projections onto every table.
+   *
+   * @param allProjInTables Projections of the points, as given by Project()
+   *     for all tables.
+   * @param begin Index of the first point of the batch.
+   */
+  void StorePoints(const arma::mat& allProjInTables, const size_t begin)
+  {
+    codes.resize((begin + allProjInTables.n_cols) * numTables);
+    for (size_t j = 0; j < allProjInTables.n_cols; j++)
+      for (size_t t = 0; t < numTables; t++)
+        codes[(begin + j) * numTables + t] = Code(allProjInTables.colptr(j) +
+            t * numProj);
+  }
+
+  /**
+   * Compute the estimated angles between a query and a block of neighbor
+   * candidates from the Hamming distances between their codes in the tables
+   * being searched.
+   *
+   * @param referenceSet Set of reference points (unused).
+   * @param query The query point (unused).
+   * @param queryProjections Projections of the query onto the tables being
+   *     searched.
+   * @param numTablesToSearch Number of tables being searched.
+   * @param candidates Indices of the candidates.
+   * @param numCandidates Number of candidates.
+   * @param block Scratch space (unused).
+   * @param distances Output estimated angles.
+   */
+  void Distances(const arma::mat& /* referenceSet */,
+                 const double* /* query */,
+                 const double* queryProjections,
+                 const size_t numTablesToSearch,
+                 const size_t* candidates,
+                 const size_t numCandidates,
+                 arma::mat& /* block */,
+                 arma::rowvec& distances) const
+  {
+    uint64_t queryCodes[64];
+    std::vector<uint64_t> moreQueryCodes;
+    uint64_t* queryCode = queryCodes;
+    if (numTablesToSearch > 64)
+    {
+      moreQueryCodes.resize(numTablesToSearch);
+      queryCode = &moreQueryCodes[0];
+    }
+
+    for (size_t t = 0; t < numTablesToSearch; t++)
+      queryCode[t] = Code(queryProjections + t * numProj);
+
+    const double scale = M_PI / double(numProj * numTablesToSearch);
+    distances.set_size(numCandidates);
+    for (size_t j = 0; j < numCandidates; j++)
+    {
+      const uint64_t* referenceCode = &codes[candidates[j] * numTables];
+      size_t hamming = 0;
+      for (size_t t = 0; t < numTablesToSearch; t++)
+        hamming += std::bitset<64>(queryCode[t] ^ referenceCode[t]).count();
+
+      distances[j] = scale * hamming;
+    }
+  }
+
+  //! Get the hyperplanes of all the tables side by side.
+  const arma::mat& Hyperplanes() const { return hyperplanes; }
+
+  //! Return the number of bytes used by the hyperplanes and the codes.
+  size_t MemoryUsage() const
+  {
+    return sizeof(*this) - sizeof(hyperplanes) - sizeof(codes) +
+        util::MemoryUsage(hyperplanes) + util::MemoryUsage(codes);
+  }
+
+  //! Returns a string representation of this object.
+  std::string ToString() const
+  {
+    std::ostringstream convert;
+    convert << "SimHash [" << this << "]" << std::endl;
+    convert << "  Bits per table: " << numProj << std::endl;
+    return convert.str();
+  }
+
+ private:
+  //! Pack the bits of the given 'numProj' projections into a code.
+  uint64_t Code(const double* projection) const
+  {
+    uint64_t code = 0;
+    for (size_t j = 0; j < numProj; j++)
+      if (projection[j] >= 0.0)
+        code |= (uint64_t(1) << j);
+
+    return code;
+  }
+
+  //! Return the bucket of the second hash table of a code; the code is mixed
+  //! first, so that similar codes don't end up in nearby buckets.
+  size_t BucketOfCode(const uint64_t code) const
+  {
+    return (size_t) ((code * 0x9E3779B97F4A7C15ULL) % secondHashSize);
+  }
+
+  //! The number of bits of each table.
+  size_t numProj;
+  //! The number of tables.
+  size_t numTables;
+  //! The size of the second hash table.
+  size_t secondHashSize;
+
+  //! The normals of the hyperplanes of all tables side by side; dims x
+  //! (numProj * numTables).
+  arma::mat hyperplanes;
+  //! The code of every reference point in every table; the codes of point i
+  //! are at [i * numTables, (i + 1) * numTables).
+  std::vector<uint64_t> codes;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -9,12 +9,18 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/util/query_server.hpp>
 
 #include <string>
 #include <fstream>
 #include <iostream>
 
 #include "lsh_search.hpp"
+#include "lsh_tuner.hpp"
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
 
 using namespace std;
 using namespace mlpack;
@@ -41,7 +47,21 @@ PROGRAM_INFO("All K-Approximate-Nearest-Neighbor Search with LSH",
     "\n\n"
     "Because this is approximate-nearest-neighbors search, results may be "
     "different from run to run.  Thus, the --seed option can be specified to "
-    "set the random seed.");
+    "set the random seed."
+    "\n\n"
+    "With --server, the hash tables are built once, and then batches of query "
+    "points are read from --server_input (or the standard input) and answered "
+    "until the input ends or a 'quit' request is read.  A request 'query <n> "
+    "[k=<k>] [tables=<tables>] [probes=<probes>]' is followed by n lines "
+    "holding one query point each; it is answered with the neighbors and then "
+    "the distances of every query point (one point per line)."
+    "\n\n"
+    "With --tune, the parameters --projections, --tables, --hash_width, "
+    "--bucket_size and --num_probes are chosen automatically: the exact "
+    "neighbors of --tune_queries random query points are computed, and the "
+    "fastest configuration that finds at least --target_recall of them and "
+    "whose hash tables fit in --memory_budget is used.  Every configuration "
+    "that was tried can be saved with --tune_file.");
 
 // Define our input parameters that this program will take.
 PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
@@ -61,9 +81,97 @@ PARAM_DOUBLE("hash_width", "The hash width for the first-level hashing in the "
     "hash width for its use.", "H", 0.0);
 PARAM_INT("second_hash_size", "The size of the second level hash table.", "M",
     99901);
-PARAM_INT("bucket_size", "The size of a bucket in the second level hash.", "B",
-    500);
+PARAM_INT("bucket_size", "The maximum size of a bucket in the second level "
+    "hash; 0 means the size of the buckets is not limited.", "B", 500);
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+PARAM_INT("num_probes", "Number of additional buckets to probe in each hash "
+    "table (multiprobe LSH); this allows fewer tables to be used for the same "
+    "recall.", "T", 0);
+PARAM_INT("batch_size", "Number of query points hashed and searched together; "
+    "0 searches all query points as one batch.", "b", 1024);
+PARAM_INT("threads", "Number of threads to use for searching (0 uses all "
+    "available cores; ignored without OpenMP).", "t", 0);
+
+PARAM_FLAG("tune", "If true, choose the LSH parameters that reach the target "
+    "recall fastest on a sample of the queries.", "");
+PARAM_DOUBLE("target_recall", "Fraction of the true neighbors that the tuned "
+    "parameters must find.", "", 0.9);
+PARAM_DOUBLE("memory_budget", "Maximum size of the hash tables in megabytes "
+    "when tuning (0 means no limit).", "", 0.0);
+PARAM_INT("tune_queries", "Number of query points to tune the parameters "
+    "with.", "", 200);
+PARAM_STRING("tune_file", "File to save the projections, tables, hash width, "
+    "bucket size, probes, recall, search time and memory usage of every tuned "
+    "configuration into (one configuration per column).", "", "");
+
+PARAM_FLAG("server", "If true, build the hash tables once and answer batches "
+    "of query points read from --server_input.", "");
+PARAM_STRING("server_input", "File or named pipe to read server requests from "
+    "(the standard input is used if not given).", "", "");
+PARAM_STRING("server_output", "File or named pipe to write server responses to "
+    "(the standard output is used if not given).", "", "");
+
+/**
+ * Answer the query batches of the server with the hash tables.  The number of
+ * neighbors, of tables to search and of additional buckets to probe can be
+ * given per request with the options k, tables and probes.
+ */
+class LSHHandler
+{
+ public:
+  LSHHandler(LSHSearch<>& lsh,
+             const size_t k,
+             const size_t numProbes,
+             const size_t batchSize,
+             const arma::mat& referenceData) :
+      lsh(lsh),
+      k(k),
+      numProbes(numProbes),
+      batchSize(batchSize),
+      referenceData(referenceData)
+  { }
+
+  void Query(const util::QueryRequest& request, util::QueryResponse& response)
+  {
+    const int queryK = request.Option<int>("k", (int) k);
+    if (queryK <= 0 || (size_t) queryK > referenceData.n_cols)
+    {
+      Log::Fatal << "Invalid k: " << queryK << "; must be greater than 0 and "
+          << "less than or equal to the number of reference points ("
+          << referenceData.n_cols << ")." << endl;
+    }
+
+    const int tables = request.Option<int>("tables", 0);
+    const int probes = request.Option<int>("probes", (int) numProbes);
+    if (tables < 0 || probes < 0)
+    {
+      Log::Fatal << "The number of tables and probes must be greater than or "
+          << "equal to 0." << endl;
+    }
+
+    if (request.Points().n_rows != referenceData.n_rows)
+    {
+      Log::Fatal << "Query points have " << request.Points().n_rows
+          << " dimensions, but the reference points have "
+          << referenceData.n_rows << "." << endl;
+    }
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    lsh.Search(request.Points(), (size_t) queryK, neighbors, distances,
+        (size_t) tables, batchSize, (size_t) probes);
+
+    response.Add(neighbors);
+    response.Add(distances);
+  }
+
+ private:
+  LSHSearch<>& lsh;
+  size_t k;
+  size_t numProbes;
+  size_t batchSize;
+  const arma::mat& referenceData;
+};
 
 int main(int argc, char *argv[])
 {
@@ -100,10 +208,40 @@ int main(int argc, char *argv[])
     Log::Fatal << referenceData.n_cols << ")." << endl;
   }
 
+  if (CLI::GetParam<int>("num_probes") < 0)
+  {
+    Log::Fatal << "Invalid number of probes: "
+        << CLI::GetParam<int>("num_probes") << ".  Must be greater than or "
+        << "equal to 0." << endl;
+  }
+  size_t numProbes = (size_t) CLI::GetParam<int>("num_probes");
+
+  if (CLI::GetParam<int>("batch_size") < 0)
+  {
+    Log::Fatal << "Invalid batch size: " << CLI::GetParam<int>("batch_size")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+  const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP "
+        << "support." << endl;
+#endif
+
   // Pick up the LSH-specific parameters.
-  const size_t numProj = CLI::GetParam<int>("projections");
-  const size_t numTables = CLI::GetParam<int>("tables");
-  const double hashWidth = CLI::GetParam<double>("hash_width");
+  size_t numProj = CLI::GetParam<int>("projections");
+  size_t numTables = CLI::GetParam<int>("tables");
+  double hashWidth = CLI::GetParam<double>("hash_width");
 
   arma::Mat<size_t> neighbors;
   arma::mat distances;
@@ -117,6 +255,80 @@ int main(int argc, char *argv[])
               << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
   }
 
+  if (CLI::HasParam("tune"))
+  {
+    const double targetRecall = CLI::GetParam<double>("target_recall");
+    if (targetRecall <= 0.0 || targetRecall > 1.0)
+    {
+      Log::Fatal << "Invalid target recall: " << targetRecall << ".  Must be "
+          << "in (0, 1]." << endl;
+    }
+    if (CLI::GetParam<double>("memory_budget") < 0.0)
+    {
+      Log::Fatal << "Invalid memory budget: "
+          << CLI::GetParam<double>("memory_budget") << ".  Must be greater "
+          << "than or equal to 0." << endl;
+    }
+    if (CLI::GetParam<int>("tune_queries") <= 0)
+    {
+      Log::Fatal << "Invalid number of tuning queries: "
+          << CLI::GetParam<int>("tune_queries") << ".  Must be greater than "
+          << "0." << endl;
+    }
+    const size_t memoryBudget = (size_t) (1024.0 * 1024.0 *
+        CLI::GetParam<double>("memory_budget"));
+
+    // Tune on a random sample of the queries.  Queries taken from the
+    // reference set find themselves, so they search for one more neighbor.
+    const bool monochromatic = (CLI::GetParam<string>("query_file") == "");
+    const arma::mat& queries = monochromatic ? referenceData : queryData;
+    const size_t sampleSize = std::min((size_t)
+        CLI::GetParam<int>("tune_queries"), (size_t) queries.n_cols);
+    const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+        queries.n_cols - 1, queries.n_cols));
+    const arma::mat sample = queries.cols(order.subvec(0, sampleSize - 1));
+    const size_t tuneK = std::min(monochromatic ? k + 1 : k,
+        (size_t) referenceData.n_cols);
+
+    Timer::Start("tuning");
+    LSHTuner<> tuner(referenceData, sample, tuneK, targetRecall, memoryBudget,
+        secondHashSize, batchSize);
+    const LSHConfiguration& best = tuner.Tune();
+    Timer::Stop("tuning");
+
+    Log::Info << "Tried " << tuner.Configurations().size() << " "
+        << "configurations; the best has recall " << best.recall << " and "
+        << "searched " << sampleSize << " queries in " << best.searchTime
+        << "s." << endl;
+
+    if (CLI::GetParam<string>("tune_file") != "")
+    {
+      const std::vector<LSHConfiguration>& configurations =
+          tuner.Configurations();
+      arma::mat results(8, configurations.size());
+      for (size_t i = 0; i < configurations.size(); ++i)
+      {
+        results(0, i) = configurations[i].numProj;
+        results(1, i) = configurations[i].numTables;
+        results(2, i) = configurations[i].hashWidth;
+        results(3, i) = configurations[i].bucketSize;
+        results(4, i) = configurations[i].numProbes;
+        results(5, i) = configurations[i].recall;
+        results(6, i) = configurations[i].searchTime;
+        results(7, i) = configurations[i].memoryUsage;
+      }
+      data::Save(CLI::GetParam<string>("tune_file"), results);
+    }
+
+    numProj = best.numProj;
+    numTables = best.numTables;
+    hashWidth = best.hashWidth;
+    bucketSize = best.bucketSize;
+    numProbes = best.numProbes;
+    Log::Info << "Using " << numProbes << " probes and a bucket size of "
+        << bucketSize << "." << endl;
+  }
+
   if (hashWidth == 0.0)
     Log::Info << "Using LSH with " << numProj << " projections (K) and " <<
         numTables << " tables (L) with default hash width." << endl;
@@ -136,19 +348,31 @@ int main(int argc, char *argv[])
                               secondHashSize, bucketSize);
 
   Timer::Stop("hash_building");
-
-  Log::Info << "Computing " << k << " distance approximate nearest neighbors "
+  Log::Info << "Hash tables use " << allkann->MemoryUsage() << " bytes."
       << endl;
-  allkann->Search(k, neighbors, distances);
 
-  Log::Info << "Neighbors computed." << endl;
+  if (CLI::HasParam("server"))
+  {
+    // Answer query batches with the hash tables until the input ends.
+    LSHHandler handler(*allkann, k, numProbes, batchSize, referenceData);
+    util::ServeQueries(handler, CLI::GetParam<string>("server_input"),
+        CLI::GetParam<string>("server_output"));
+  }
+  else
+  {
+    Log::Info << "Computing " << k << " distance approximate nearest "
+        << "neighbors " << endl;
+    allkann->Search(k, neighbors, distances, 0, batchSize, numProbes);
+
+    Log::Info << "Neighbors computed." << endl;
 
-  // Save output.
-  if (distancesFile != "")
-    data::Save(distancesFile, distances);
+    // Save output.
+    if (distancesFile != "")
+      data::Save(distancesFile, distances);
 
-  if (neighborsFile != "")
-    data::Save(neighborsFile, neighbors);
+    if (neighborsFile != "")
+      data::Save(neighborsFile, neighbors);
+  }
 
   delete allkann;
 }
@@ -24,12 +24,17 @@
 #define __MLPACK_METHODS_NEIGHBOR_SEARCH_LSH_SEARCH_HPP
 
 #include <mlpack/core.hpp>
+#include <limits>
 #include <vector>
 #include <string>
 
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_heap.hpp>
 #include <mlpack/methods/neighbor_search/sort_policies/nearest_neighbor_sort.hpp>
 
+#include "hash_families/pstable_hash.hpp"
+#include "hash_families/sim_hash.hpp"
+
 namespace mlpack {
 namespace neighbor {
 
@@ -38,11 +43,60 @@ namespace neighbor {
  * and uses this hash to compute the distance-approximate nearest-neighbors
  * of the given queries.
  *
+ * The buckets of the second hash table are stored in compressed sparse row
+ * form: the point IDs of all the buckets are stored contiguously, bucket after
+ * bucket, and an offset array gives the start of each bucket.  Points appended
+ * to the reference set can be hashed into the existing tables with Insert(),
+ * without rebuilding them.
+ *
+ * The hash functions are given by the HashType class: PStableHash (the
+ * default) hashes with 2-stable distributions for the Euclidean distance, and
+ * SimHash hashes with signs of random projections for the angle between points
+ * (cosine similarity).  A hash family must implement the following functions:
+ *
+ * @code
+ * // Draw the functions of every table.
+ * void Build(const arma::mat& referenceSet, const size_t numProj,
+ *            const size_t numTables, const double hashWidth,
+ *            const size_t secondHashSize);
+ * // Get the dimensionality of the points that can be hashed.
+ * size_t Dimensionality() const;
+ * // Compute the (numProj * numTables) x count projections of a batch of
+ * // points onto the first numTables tables.
+ * void Project(const arma::mat& points, const size_t begin, const size_t count,
+ *              const size_t numTables, arma::mat& projections) const;
+ * // Return the second hash table bucket of the numProj projections of a
+ * // point in one table.
+ * size_t Bucket(const double* projection) const;
+ * // Return the numProbes next most promising buckets of a point in one table.
+ * void PerturbedBuckets(const double* projection, const size_t numProbes,
+ *                       std::vector<size_t>& buckets) const;
+ * // Store whatever is needed about a batch of reference points, given their
+ * // projections onto all tables.
+ * void StorePoints(const arma::mat& projections, const size_t begin);
+ * // Compute the distances between a query and a block of candidates.
+ * void Distances(const arma::mat& referenceSet, const double* query,
+ *                const double* queryProjections,
+ *                const size_t numTablesToSearch, const size_t* candidates,
+ *                const size_t numCandidates, arma::mat& block,
+ *                arma::rowvec& distances) const;
+ * @endcode
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam IndexType Unsigned integer type used to store the point IDs in the
+ *     buckets; a 32-bit type halves the size of the tables, as long as the
+ *     reference set has fewer than 2^32 points.
+ * @tparam HashType The family of hash functions; see PStableHash and SimHash.
  */
-template<typename SortPolicy = NearestNeighborSort>
+template<typename SortPolicy = NearestNeighborSort,
+         typename IndexType = size_t,
+         typename HashType = PStableHash>
 class LSHSearch
 {
+  static_assert(std::numeric_limits<IndexType>::is_integer &&
+      !std::numeric_limits<IndexType>::is_signed,
+      "LSHSearch: IndexType must be an unsigned integer type.");
+
  public:
   /**
    * This function initializes the LSH class. It builds the hash on the
@@ -55,15 +109,16 @@ class LSHSearch
    *     10-50 might be a decent choice).
    * @param numTables Total number of hash tables (anything between 10-20
    *     should suffice).
-   * @param hashWidth The width of hash for every table. If 0 (the default) is
-   *     provided, then the hash width is automatically obtained by computing
-   *     the average pairwise distance of 25 pairs.  This should be a reasonable
-   *     upper bound on the nearest-neighbor distance in general.
+   * @param hashWidth The width of hash for every table (only used by
+   *     PStableHash). If 0 (the default) is provided, then the hash width is
+   *     automatically obtained by computing the average pairwise distance of
+   *     25 pairs.  This should be a reasonable upper bound on the
+   *     nearest-neighbor distance in general.
    * @param secondHashSize The size of the second hash table. This should be a
    *     large prime number.
-   * @param bucketSize The size of the bucket in the second hash table. This is
-   *     the maximum number of points that can be hashed into single bucket.
-   *     Default values are already provided here.
+   * @param bucketSize The maximum number of points that can be hashed into a
+   *     single bucket of the second hash table; further points are dropped
+   *     from that bucket.  If 0, the size of the buckets is not limited.
    */
   LSHSearch(const arma::mat& referenceSet,
             const arma::mat& querySet,
@@ -83,15 +138,16 @@ class LSHSearch
    *     10-50 might be a decent choice).
    * @param numTables Total number of hash tables (anything between 10-20
    *     should suffice).
-   * @param hashWidth The width of hash for every table. If 0 (the default) is
-   *     provided, then the hash width is automatically obtained by computing
-   *     the average pairwise distance of 25 pairs.  This should be a reasonable
-   *     upper bound on the nearest-neighbor distance in general.
+   * @param hashWidth The width of hash for every table (only used by
+   *     PStableHash). If 0 (the default) is provided, then the hash width is
+   *     automatically obtained by computing the average pairwise distance of
+   *     25 pairs.  This should be a reasonable upper bound on the
+   *     nearest-neighbor distance in general.
    * @param secondHashSize The size of the second hash table. This should be a
    *     large prime number.
-   * @param bucketSize The size of the bucket in the second hash table. This is
-   *     the maximum number of points that can be hashed into single bucket.
-   *     Default values are already provided here.
+   * @param bucketSize The maximum number of points that can be hashed into a
+   *     single bucket of the second hash table; further points are dropped
+   *     from that bucket.  If 0, the size of the buckets is not limited.
    */
   LSHSearch(const arma::mat& referenceSet,
             const size_t numProj,
@@ -117,15 +173,73 @@ class LSHSearch
    *     available without having to build hashing for every table size.
    *     By default, this is set to zero in which case all tables are
    *     considered.
+   * @param batchSize Number of queries that are hashed together with a single
+   *     matrix multiplication before their candidates are probed and scored
+   *     (in parallel, if OpenMP is available).
+   * @param numProbes Number of additional buckets to probe in each table
+   *     (multiprobe LSH).  For each table the buckets next to the bucket of
+   *     the query are visited in order of how close the query is to their
+   *     boundary, so fewer tables are needed for the same recall.  By default
+   *     only the bucket of the query is probed.
    */
   void Search(const size_t k,
               arma::Mat<size_t>& resultingNeighbors,
               arma::mat& distances,
-              const size_t numTablesToSearch = 0);
+              const size_t numTablesToSearch = 0,
+              const size_t batchSize = 1024,
+              const size_t numProbes = 0);
+
+  /**
+   * Compute the nearest neighbors of the points of the given query set, which
+   * doesn't have to be the query set given to the constructor.  This allows
+   * the hash tables to be built once and used for any number of query sets
+   * (for instance by a query server).  The parameters are the same as for the
+   * other overload of Search().
+   *
+   * @param querySet Set of query points.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& resultingNeighbors,
+              arma::mat& distances,
+              const size_t numTablesToSearch = 0,
+              const size_t batchSize = 1024,
+              const size_t numProbes = 0);
+
+  /**
+   * Hash the points that were appended to the reference set (for instance
+   * with insert_cols()) since the hash tables were built or since the last
+   * call to Insert(), using the same projections.  The reference set is held
+   * by reference, so the new points must be appended to the matrix given to
+   * the constructor.  The buckets of the new points are appended to the
+   * existing buckets in one pass over the tables, which is much faster than
+   * building the tables again.  If the bucket size is not limited, the buckets
+   * hold the same points as if all the points had been given to the
+   * constructor.
+   *
+   * @return The number of points that were inserted.
+   */
+  size_t Insert();
+
+  //! Get the number of reference points that are hashed into the tables.
+  size_t NumInsertedPoints() const { return numInsertedPoints; }
+
+  //! Get the number of points in the largest bucket.
+  size_t MaxBucketSize() const { return maxBucketSize; }
+
+  //! Get the hash functions.
+  const HashType& Hash() const { return hash; }
 
   //! Returns a string representation of this object.
   std::string ToString() const;
 
+  /**
+   * Return the number of bytes used by this object: the projections and the
+   * hash tables.  The reference and query sets are not counted, because they
+   * are not owned by this object.
+   */
+  size_t MemoryUsage() const;
+
   //! Return the number of distance evaluations performed.
   size_t DistanceEvaluations() const { return distanceEvaluations; }
   //! Modify the number of distance evaluations performed.
@@ -148,33 +262,89 @@ class LSHSearch
   void BuildHash();
 
   /**
-   * This function takes a query and hashes it into each of the hash tables to
-   * get keys for the query and then the key is hashed to a bucket of the second
-   * hash table and all the points (if any) in those buckets are collected as
-   * the potential neighbor candidates.
+   * Hash the reference points from 'numInsertedPoints' to the end of the
+   * reference set into every table, and append them to their buckets.
+   */
+  void InsertPoints();
+
+  /**
+   * Hash a contiguous batch of queries into each of the first
+   * 'numTablesToSearch' hash tables.  The projections of the whole batch onto
+   * every table are computed at once by the hash family, and each resulting
+   * key is then hashed to a bucket of the second hash table.
+   *
+   * @param querySet Set of query points.
+   * @param begin Index of the first query in the batch.
+   * @param count Number of queries in the batch.
+   * @param numTablesToSearch Number of hash tables to hash into.
+   * @param allProjInTables Output matrix of size ((numProj *
+   *     numTablesToSearch) x count) holding the projections of each query, as
+   *     given by the hash family.
+   * @param hashes Output matrix of size (numTablesToSearch x count); column i
+   *     holds the second hash table bucket of query (begin + i) for each table.
+   */
+  void HashQueries(const arma::mat& querySet,
+                   const size_t begin,
+                   const size_t count,
+                   const size_t numTablesToSearch,
+                   arma::mat& allProjInTables,
+                   arma::Mat<size_t>& hashes) const;
+
+  /**
+   * This function takes the buckets a query was hashed into (one per table)
+   * and collects all the points (if any) in those buckets of the second hash
+   * table as the potential neighbor candidates.  Each candidate is returned
+   * only once.
    *
    * @param queryIndex The index of the query currently being processed.
+   * @param queryHashes The second hash table bucket of the query in each of
+   *     the tables being searched.
+   * @param queryProjections The projections of the query in each of
+   *     the tables being searched; only used if numProbes is nonzero.
+   * @param numTablesToSearch Number of entries in queryHashes.
+   * @param numProbes Number of additional buckets to probe in each table.
    * @param referenceIndices The list of neighbor candidates obtained from
-   *    hashing the query into all the hash tables and eventually into
-   *    multiple buckets of the second hash table.
+   *     the buckets of the second hash table.
+   * @param lastQuery Scratch space of length referenceSet.n_cols;
+   *     lastQuery[j] is the last query for which point j was collected.  This
+   *     avoids clearing a marker for every reference point for each query.
+   * @return The number of candidates written to referenceIndices.
    */
-  void ReturnIndicesFromTable(const size_t queryIndex,
-                              arma::uvec& referenceIndices,
-                              size_t numTablesToSearch);
+  size_t ReturnIndicesFromTable(const size_t queryIndex,
+                                const size_t* queryHashes,
+                                const double* queryProjections,
+                                const size_t numTablesToSearch,
+                                const size_t numProbes,
+                                arma::Col<size_t>& referenceIndices,
+                                arma::Col<size_t>& lastQuery) const;
 
   /**
    * This is a helper function that computes the distance of the query to the
-   * neighbor candidates and appropriately stores the best 'k' candidates
+   * neighbor candidates and appropriately stores the best 'k' candidates.
+   * The candidates are handed to the hash family in small blocks, so that the
+   * distances of a whole block can be computed at once.
    *
+   * @param querySet Set of query points.
    * @param distances Matrix holding output distances.
    * @param neighbors Matrix holding output neighbors.
-   * @param queryIndex The index of the query in question
-   * @param referenceIndex The index of the neighbor candidate in question
+   * @param queryIndex The index of the query in question.
+   * @param queryProjections The projections of the query onto the tables
+   *     being searched.
+   * @param numTablesToSearch Number of tables being searched.
+   * @param referenceIndices The neighbor candidates of the query.
+   * @param numCandidates Number of valid entries in referenceIndices.
+   * @param block Scratch space for the hash family; it should have
+   *     referenceSet.n_rows rows.
    */
-  double BaseCase(arma::mat& distances,
-                  arma::Mat<size_t>& neighbors,
-                  const size_t queryIndex,
-                  const size_t referenceIndex);
+  void BaseCase(const arma::mat& querySet,
+                arma::mat& distances,
+                arma::Mat<size_t>& neighbors,
+                const size_t queryIndex,
+                const double* queryProjections,
+                const size_t numTablesToSearch,
+                const arma::Col<size_t>& referenceIndices,
+                const size_t numCandidates,
+                arma::mat& block) const;
 
   /**
    * This is a helper function that efficiently inserts better neighbor
@@ -195,7 +365,7 @@ class LSHSearch
                       const size_t queryIndex,
                       const size_t pos,
                       const size_t neighbor,
-                      const double distance);
+                      const double distance) const;
 
   //! Reference dataset.
   const arma::mat& referenceSet;
@@ -207,34 +377,32 @@ class LSHSearch
   //! The number of hash tables.
   const size_t numTables;
 
-  //! The std::vector containing the projection matrix of each table.
-  std::vector<arma::mat> projections; // should be [numProj x dims] x numTables
-
-  //! The list of the offsets 'b' for each of the projection for each table.
-  arma::mat offsets; // should be numProj x numTables
-
-  //! The hash width.
-  double hashWidth;
+  //! The hash width given to the constructor.
+  const double hashWidth;
 
   //! The big prime representing the size of the second hash.
   const size_t secondHashSize;
 
-  //! The weights of the second hash.
-  arma::vec secondHashWeights;
+  //! The hash functions of every table.
+  HashType hash;
 
-  //! The bucket size of the second hash.
+  //! The maximum number of points in a bucket of the second hash (0 for no
+  //! limit).
   const size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) x bucketSize.
-  arma::Mat<size_t> secondHashTable;
+  //! The start of each bucket of the second hash in 'bucketContents'; the
+  //! points of bucket i are at [bucketOffsets[i], bucketOffsets[i + 1]).
+  //! Should be secondHashSize + 1.
+  arma::Col<size_t> bucketOffsets;
+
+  //! The point IDs of all the buckets, bucket after bucket.
+  arma::Col<IndexType> bucketContents;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The number of reference points hashed into the tables.
+  size_t numInsertedPoints;
 
-  //! For a particular hash value, points to the row in secondHashTable
-  //! corresponding to this value.  Should be secondHashSize.
-  arma::Col<size_t> bucketRowInHashTable;
+  //! The number of points in the largest bucket.
+  size_t maxBucketSize;
 
   //! The number of distance evaluations.
   size_t distanceEvaluations;
@@ -13,88 +13,59 @@ namespace mlpack {
 namespace neighbor {
 
 // Construct the object.
-template<typename SortPolicy>
-LSHSearch<SortPolicy>::
+template<typename SortPolicy, typename IndexType, typename HashType>
+LSHSearch<SortPolicy, IndexType, HashType>::
 LSHSearch(const arma::mat& referenceSet,
           const arma::mat& querySet,
           const size_t numProj,
           const size_t numTables,
-          const double hashWidthIn,
+          const double hashWidth,
           const size_t secondHashSize,
           const size_t bucketSize) :
   referenceSet(referenceSet),
   querySet(querySet),
   numProj(numProj),
   numTables(numTables),
-  hashWidth(hashWidthIn),
+  hashWidth(hashWidth),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numInsertedPoints(0),
+  maxBucketSize(0),
   distanceEvaluations(0)
 {
-  if (hashWidth == 0.0) // The user has not provided any value.
-  {
-    // Compute a heuristic hash width from the data.
-    for (size_t i = 0; i < 25; i++)
-    {
-      size_t p1 = (size_t) math::RandInt(referenceSet.n_cols);
-      size_t p2 = (size_t) math::RandInt(referenceSet.n_cols);
-
-      hashWidth += std::sqrt(metric::EuclideanDistance::Evaluate(
-          referenceSet.unsafe_col(p1), referenceSet.unsafe_col(p2)));
-    }
-
-    hashWidth /= 25;
-  }
-
-  Log::Info << "Hash width chosen as: " << hashWidth << std::endl;
-
   BuildHash();
 }
 
-template<typename SortPolicy>
-LSHSearch<SortPolicy>::
+template<typename SortPolicy, typename IndexType, typename HashType>
+LSHSearch<SortPolicy, IndexType, HashType>::
 LSHSearch(const arma::mat& referenceSet,
           const size_t numProj,
           const size_t numTables,
-          const double hashWidthIn,
+          const double hashWidth,
           const size_t secondHashSize,
           const size_t bucketSize) :
   referenceSet(referenceSet),
   querySet(referenceSet),
   numProj(numProj),
   numTables(numTables),
-  hashWidth(hashWidthIn),
+  hashWidth(hashWidth),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numInsertedPoints(0),
+  maxBucketSize(0),
   distanceEvaluations(0)
 {
-  if (hashWidth == 0.0) // The user has not provided any value.
-  {
-    // Compute a heuristic hash width from the data.
-    for (size_t i = 0; i < 25; i++)
-    {
-      size_t p1 = (size_t) math::RandInt(referenceSet.n_cols);
-      size_t p2 = (size_t) math::RandInt(referenceSet.n_cols);
-
-      hashWidth += std::sqrt(metric::EuclideanDistance::Evaluate(
-          referenceSet.unsafe_col(p1), referenceSet.unsafe_col(p2)));
-    }
-
-    hashWidth /= 25;
-  }
-
-  Log::Info << "Hash width chosen as: " << hashWidth << std::endl;
-
   BuildHash();
 }
 
-template<typename SortPolicy>
-void LSHSearch<SortPolicy>::InsertNeighbor(arma::mat& distances,
-                                           arma::Mat<size_t>& neighbors,
-                                           const size_t queryIndex,
-                                           const size_t pos,
-                                           const size_t neighbor,
-                                           const double distance)
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::
+InsertNeighbor(arma::mat& distances,
+               arma::Mat<size_t>& neighbors,
+               const size_t queryIndex,
+               const size_t pos,
+               const size_t neighbor,
+               const double distance) const
 {
   // We only memmove() if there is actually a need to shift something.
   if (pos < (distances.n_rows - 1))
@@ -113,106 +84,161 @@ void LSHSearch<SortPolicy>::InsertNeighbor(arma::mat& distances,
   neighbors(pos, queryIndex) = neighbor;
 }
 
-template<typename SortPolicy>
-inline force_inline
-double LSHSearch<SortPolicy>::BaseCase(arma::mat& distances,
-                                       arma::Mat<size_t>& neighbors,
-                                       const size_t queryIndex,
-                                       const size_t referenceIndex)
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::
+BaseCase(const arma::mat& querySet,
+         arma::mat& distances,
+         arma::Mat<size_t>& neighbors,
+         const size_t queryIndex,
+         const double* queryProjections,
+         const size_t numTablesToSearch,
+         const arma::Col<size_t>& referenceIndices,
+         const size_t numCandidates,
+         arma::mat& block) const
 {
-  // If the datasets are the same, then this search is only using one dataset
-  // and we should not return identical points.
-  if ((&querySet == &referenceSet) && (queryIndex == referenceIndex))
-    return 0.0;
-
-  const double distance = metric::EuclideanDistance::Evaluate(
-      querySet.unsafe_col(queryIndex), referenceSet.unsafe_col(referenceIndex));
-
-  // If this distance is better than any of the current candidates, the
-  // SortDistance() function will give us the position to insert it into.
-  arma::vec queryDist = distances.unsafe_col(queryIndex);
-  arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
-  size_t insertPosition = SortPolicy::SortDistance(queryDist, queryIndices,
-      distance);
-
-  // SortDistance() returns (size_t() - 1) if we shouldn't add it.
-  if (insertPosition != (size_t() - 1))
-    InsertNeighbor(distances, neighbors, queryIndex, insertPosition,
-        referenceIndex, distance);
-
-  return distance;
-}
+  const double* query = querySet.colptr(queryIndex);
 
-template<typename SortPolicy>
-void LSHSearch<SortPolicy>::
-ReturnIndicesFromTable(const size_t queryIndex,
-                       arma::uvec& referenceIndices,
-                       size_t numTablesToSearch)
-{
-  // Decide on the number of tables to look into.
-  if (numTablesToSearch == 0) // If no user input is given, search all.
-    numTablesToSearch = numTables;
+  arma::Col<size_t> blockIndices(block.n_cols);
+  arma::rowvec blockDistances;
+  for (size_t start = 0; start < numCandidates; start += block.n_cols)
+  {
+    const size_t end = std::min(start + block.n_cols, numCandidates);
 
-  // Sanity check to make sure that the existing number of tables is not
-  // exceeded.
-  if (numTablesToSearch > numTables)
-    numTablesToSearch = numTables;
+    // Collect this block of candidates.  If the datasets are the same, then
+    // this search is only using one dataset and we should not return
+    // identical points.
+    size_t blockCount = 0;
+    for (size_t j = start; j < end; ++j)
+    {
+      const size_t referenceIndex = referenceIndices[j];
+      if ((&querySet == &referenceSet) && (queryIndex == referenceIndex))
+        continue;
 
-  // Hash the query in each of the 'numTablesToSearch' hash tables using the
-  // 'numProj' projections for each table. This gives us 'numTablesToSearch'
-  // keys for the query where each key is a 'numProj' dimensional integer
-  // vector.
+      blockIndices[blockCount++] = referenceIndex;
+    }
 
-  // Compute the projection of the query in each table.
-  arma::mat allProjInTables(numProj, numTablesToSearch);
-  for (size_t i = 0; i < numTablesToSearch; i++)
-  {
-    allProjInTables.unsafe_col(i) = projections[i].t() *
-        querySet.unsafe_col(queryIndex);
-  }
-  allProjInTables += offsets.cols(0, numTablesToSearch - 1);
-  allProjInTables /= hashWidth;
+    if (blockCount == 0)
+      continue;
+
+    // Compute the distances of the whole block at once.
+    hash.Distances(referenceSet, query, queryProjections, numTablesToSearch,
+        blockIndices.memptr(), blockCount, block, blockDistances);
+
+    // Large candidate lists are heaps, which are sorted at the end of the
+    // search.
+    if (NeighborHeap<SortPolicy>::UseHeap(distances.n_rows))
+    {
+      for (size_t j = 0; j < blockCount; ++j)
+        NeighborHeap<SortPolicy>::Insert(distances, neighbors, queryIndex,
+            blockIndices[j], blockDistances[j]);
+      continue;
+    }
 
-  // Compute the hash value of each key of the query into a bucket of the
-  // 'secondHashTable' using the 'secondHashWeights'.
-  arma::rowvec hashVec = secondHashWeights.t() * arma::floor(allProjInTables);
+    // If a distance is better than any of the current candidates, the
+    // SortDistance() function will give us the position to insert it into.
+    arma::vec queryDist = distances.unsafe_col(queryIndex);
+    arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
+    for (size_t j = 0; j < blockCount; ++j)
+    {
+      const size_t insertPosition = SortPolicy::SortDistance(queryDist,
+          queryIndices, blockDistances[j]);
 
-  for (size_t i = 0; i < hashVec.n_elem; i++)
-    hashVec[i] = (double) ((size_t) hashVec[i] % secondHashSize);
+      // SortDistance() returns (size_t() - 1) if we shouldn't add it.
+      if (insertPosition != (size_t() - 1))
+        InsertNeighbor(distances, neighbors, queryIndex, insertPosition,
+            blockIndices[j], blockDistances[j]);
+    }
+  }
+}
 
-  Log::Assert(hashVec.n_elem == numTablesToSearch);
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::
+HashQueries(const arma::mat& querySet,
+            const size_t begin,
+            const size_t count,
+            const size_t numTablesToSearch,
+            arma::mat& allProjInTables,
+            arma::Mat<size_t>& hashes) const
+{
+  // Hash the queries in each of the 'numTablesToSearch' hash tables using the
+  // 'numProj' projections for each table. This gives us 'numTablesToSearch'
+  // keys for each query, and each key is hashed into a bucket of the second
+  // hash table.
+  hash.Project(querySet, begin, count, numTablesToSearch, allProjInTables);
+
+  hashes.set_size(numTablesToSearch, count);
+  for (size_t j = 0; j < count; j++)
+    for (size_t i = 0; i < numTablesToSearch; i++)
+      hashes(i, j) = hash.Bucket(allProjInTables.colptr(j) + i * numProj);
+}
 
+template<typename SortPolicy, typename IndexType, typename HashType>
+size_t LSHSearch<SortPolicy, IndexType, HashType>::
+ReturnIndicesFromTable(const size_t queryIndex,
+                       const size_t* queryHashes,
+                       const double* queryProjections,
+                       const size_t numTablesToSearch,
+                       const size_t numProbes,
+                       arma::Col<size_t>& referenceIndices,
+                       arma::Col<size_t>& lastQuery) const
+{
   // For all the buckets that the query is hashed into, sequentially
   // collect the indices in those buckets.
-  arma::Col<size_t> refPointsConsidered;
-  refPointsConsidered.zeros(referenceSet.n_cols);
-
-  for (size_t i = 0; i < hashVec.n_elem; i++) // For all tables.
+  size_t numCandidates = 0;
+  std::vector<size_t> buckets;
+  for (size_t i = 0; i < numTablesToSearch; i++) // For all tables.
   {
-    size_t hashInd = (size_t) hashVec[i];
-
-    if (bucketContentSize[hashInd] > 0)
+    // The bucket of the query itself comes first, followed by the
+    // 'numProbes' most promising neighboring buckets.
+    if (numProbes > 0)
+      hash.PerturbedBuckets(queryProjections + i * numProj, numProbes,
+          buckets);
+    buckets.insert(buckets.begin(), queryHashes[i]);
+
+    for (size_t b = 0; b < buckets.size(); b++)
     {
       // Pick the indices in the bucket corresponding to 'hashInd'.
-      size_t tableRow = bucketRowInHashTable[hashInd];
-      assert(tableRow < secondHashSize);
-      assert(tableRow < secondHashTable.n_rows);
-
-      for (size_t j = 0; j < bucketContentSize[hashInd]; j++)
-        refPointsConsidered[secondHashTable(tableRow, j)]++;
+      const size_t hashInd = buckets[b];
+      for (size_t j = bucketOffsets[hashInd]; j < bucketOffsets[hashInd + 1];
+          j++)
+      {
+        const size_t point = bucketContents[j];
+        if (lastQuery[point] != queryIndex)
+        {
+          lastQuery[point] = queryIndex;
+          referenceIndices[numCandidates++] = point;
+        }
+      }
     }
+
+    buckets.clear();
   }
 
-  referenceIndices = arma::find(refPointsConsidered > 0);
+  return numCandidates;
 }
 
-
-template<typename SortPolicy>
-void LSHSearch<SortPolicy>::
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::
 Search(const size_t k,
        arma::Mat<size_t>& resultingNeighbors,
        arma::mat& distances,
-       const size_t numTablesToSearch)
+       const size_t numTablesToSearch,
+       const size_t batchSize,
+       const size_t numProbes)
+{
+  Search(querySet, k, resultingNeighbors, distances, numTablesToSearch,
+      batchSize, numProbes);
+}
+
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::
+Search(const arma::mat& querySet,
+       const size_t k,
+       arma::Mat<size_t>& resultingNeighbors,
+       arma::mat& distances,
+       const size_t numTablesToSearchIn,
+       const size_t batchSize,
+       const size_t numProbes)
 {
   // Set the size of the neighbor and distance matrices.
   resultingNeighbors.set_size(k, querySet.n_cols);
@@ -220,28 +246,67 @@ Search(const size_t k,
   distances.fill(SortPolicy::WorstDistance());
   resultingNeighbors.fill(referenceSet.n_cols);
 
+  // Decide on the number of tables to look into.  If no user input is given,
+  // search all; also make sure that the existing number of tables is not
+  // exceeded.
+  size_t numTablesToSearch = numTablesToSearchIn;
+  if (numTablesToSearch == 0 || numTablesToSearch > numTables)
+    numTablesToSearch = numTables;
+
+  const size_t batch = (batchSize == 0) ? querySet.n_cols : batchSize;
+
+  // No query can have more candidates than this.
+  const size_t maxCandidates = std::min((size_t) referenceSet.n_cols,
+      numTablesToSearch * (numProbes + 1) * maxBucketSize);
+
   size_t avgIndicesReturned = 0;
 
   Timer::Start("computing_neighbors");
 
-  // Go through every query point sequentially.
-  for (size_t i = 0; i < querySet.n_cols; i++)
+  for (size_t begin = 0; begin < querySet.n_cols; begin += batch)
   {
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(i, refIndices, numTablesToSearch);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    for (size_t j = 0; j < refIndices.n_elem; j++)
-      BaseCase(distances, resultingNeighbors, i, (size_t) refIndices[j]);
+    const size_t count = std::min(batch, (size_t) querySet.n_cols - begin);
+
+    // Hash every query of the batch into every hash table and eventually into
+    // the 'secondHashTable'.
+    arma::mat projections;
+    arma::Mat<size_t> hashes;
+    HashQueries(querySet, begin, count, numTablesToSearch, projections,
+        hashes);
+
+    // Now probe the buckets and score the candidates of each query.  Each
+    // query only writes to its own column of the output matrices, so the
+    // queries can be processed in parallel.
+    #pragma omp parallel reduction(+:avgIndicesReturned)
+    {
+      arma::Col<size_t> refIndices(maxCandidates);
+      arma::Col<size_t> lastQuery(referenceSet.n_cols);
+      lastQuery.fill(querySet.n_cols);
+      arma::mat block(referenceSet.n_rows, 64);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < count; i++)
+      {
+        const size_t queryIndex = begin + i;
+        const size_t numCandidates = ReturnIndicesFromTable(queryIndex,
+            hashes.colptr(i), projections.colptr(i), numTablesToSearch,
+            numProbes, refIndices, lastQuery);
+
+        // An informative book-keeping for the number of neighbor candidates
+        // returned on average.
+        avgIndicesReturned += numCandidates;
+
+        // Go through all the candidates and save the best 'k' candidates.
+        BaseCase(querySet, distances, resultingNeighbors, queryIndex,
+            projections.colptr(i), numTablesToSearch, refIndices,
+            numCandidates, block);
+      }
+    }
   }
 
+  if (NeighborHeap<SortPolicy>::UseHeap(k))
+    NeighborHeap<SortPolicy>::Sort(distances, resultingNeighbors);
+
   Timer::Stop("computing_neighbors");
 
   distanceEvaluations += avgIndicesReturned;
@@ -250,151 +315,154 @@ Search(const size_t k,
       std::endl;
 }
 
-template<typename SortPolicy>
-void LSHSearch<SortPolicy>::BuildHash()
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::BuildHash()
 {
   // The first level hash for a single table outputs a 'numProj'-dimensional
-  // integer key for each point in the set -- (key, pointID)
-  // The key creation details are presented below
-  //
-  // The second level hash is performed by hashing the key to
-  // an integer in the range [0, 'secondHashSize').
-  //
-  // This is done by creating a weight vector 'secondHashWeights' of
-  // length 'numProj' with each entry an integer randomly chosen
-  // between [0, 'secondHashSize').
-  //
-  // Then the bucket for any key and its corresponding point is
-  // given by <key, 'secondHashWeights'> % 'secondHashSize'
-  // and the corresponding point ID is put into that bucket.
-
-  // Step I: Prepare the second level hash.
-
-  // Obtain the weights for the second hash.
-  secondHashWeights = arma::floor(arma::randu(numProj) *
-                                  (double) secondHashSize);
-
-  // The 'secondHashTable' is initially an empty matrix of size
-  // ('secondHashSize' x 'bucketSize'). But by only filling the buckets
-  // as points land in them allows us to shrink the size of the
-  // 'secondHashTable' at the end of the hashing.
-
-  // Fill the second hash table n = referenceSet.n_cols.  This is because no
-  // point has index 'n' so the presence of this in the bucket denotes that
-  // there are no more points in this bucket.
-  secondHashTable.set_size(secondHashSize, bucketSize);
-  secondHashTable.fill(referenceSet.n_cols);
-
-  // Keep track of the size of each bucket in the hash.  At the end of hashing
-  // most buckets will be empty.
-  bucketContentSize.zeros(secondHashSize);
-
-  // Instead of putting the points in the row corresponding to the bucket, we
-  // chose the next empty row and keep track of the row in which the bucket
-  // lies. This allows us to stack together and slice out the empty buckets at
-  // the end of the hashing.
-  bucketRowInHashTable.set_size(secondHashSize);
-  bucketRowInHashTable.fill(secondHashSize);
-
-  // Keep track of number of non-empty rows in the 'secondHashTable'.
-  size_t numRowsInTable = 0;
-
-  // Step II: The offsets for all projections in all tables.
-  // Since the 'offsets' are in [0, hashWidth], we obtain the 'offsets'
-  // as randu(numProj, numTables) * hashWidth.
-  offsets.randu(numProj, numTables);
-  offsets *= hashWidth;
-
-  // Step III: Create each hash table in the first level hash one by one and
-  // putting them directly into the 'secondHashTable' for memory efficiency.
+  // key for each point in the set -- (key, pointID).  The second level hash is
+  // performed by hashing the key to an integer in the range
+  // [0, 'secondHashSize'), and the point ID is put into that bucket.  Both
+  // levels are computed by the hash family.
+
+  // Step I: Draw the functions of the first and second level hash.
+  hash.Build(referenceSet, numProj, numTables, hashWidth, secondHashSize);
+
+  // All the buckets start out empty.  The buckets are stored one after
+  // another in 'bucketContents', so empty buckets take no space.
+  bucketOffsets.zeros(secondHashSize + 1);
+  bucketContents.reset();
+  numInsertedPoints = 0;
+  maxBucketSize = 0;
+
+  // Step II: Hash every point into every table.
+  InsertPoints();
+
+  Log::Info << "Final hash table size: " << bucketContents.n_elem << " points "
+      << "in buckets of at most " << maxBucketSize << " points." << std::endl;
+}
+
+template<typename SortPolicy, typename IndexType, typename HashType>
+size_t LSHSearch<SortPolicy, IndexType, HashType>::Insert()
+{
+  if (referenceSet.n_rows != hash.Dimensionality())
+    Log::Fatal << "LSHSearch::Insert(): the reference set has "
+        << referenceSet.n_rows << " dimensions, but the hash tables were built "
+        << "for " << hash.Dimensionality() << " dimensions." << std::endl;
+
+  const size_t oldPoints = numInsertedPoints;
+  InsertPoints();
+  return numInsertedPoints - oldPoints;
+}
+
+template<typename SortPolicy, typename IndexType, typename HashType>
+void LSHSearch<SortPolicy, IndexType, HashType>::InsertPoints()
+{
+  const size_t begin = numInsertedPoints;
+  const size_t count = referenceSet.n_cols - begin;
+  if (count == 0)
+    return;
+
+  if ((size_t) referenceSet.n_cols - 1 > (size_t)
+      std::numeric_limits<IndexType>::max())
+    Log::Fatal << "LSHSearch: the reference set has " << referenceSet.n_cols
+        << " points, which is too many for the index type of the buckets."
+        << std::endl;
+
+  // Find the bucket of every new point in every table.  The points are
+  // projected in batches, to bound the size of the projections.
+  arma::Mat<size_t> hashes(numTables, count);
+  const size_t batch = 4096;
+  for (size_t b = 0; b < count; b += batch)
+  {
+    const size_t batchCount = std::min(batch, count - b);
+    arma::mat batchProjections;
+    arma::Mat<size_t> batchHashes;
+    HashQueries(referenceSet, begin + b, batchCount, numTables,
+        batchProjections, batchHashes);
+    hashes.cols(b, b + batchCount - 1) = batchHashes;
+    hash.StorePoints(batchProjections, begin + b);
+  }
+
+  // Count the new points of each bucket.  The points are taken table by
+  // table, in order, and a point that does not fit in its (full) bucket is
+  // dropped.
+  arma::Col<size_t> newCounts(secondHashSize);
+  newCounts.zeros();
+  size_t dropped = 0;
   for (size_t i = 0; i < numTables; i++)
   {
-    // Step IV: Obtain the 'numProj' projections for each table.
-
-    // For L2 metric, 2-stable distributions are used, and
-    // the normal Z ~ N(0, 1) is a 2-stable distribution.
-    arma::mat projMat;
-    projMat.randn(referenceSet.n_rows, numProj);
-
-    // Save the projection matrix for querying.
-    projections.push_back(projMat);
-
-    // Step V: create the 'numProj'-dimensional key for each point in each
-    // table.
-
-    // The following code performs the task of hashing each point to a
-    // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
-    //
-    // For a single table, let the 'numProj' projections be denoted by 'proj_i'
-    // and the corresponding offset be 'offset_i'.  Then the key of a single
-    // point is obtained as:
-    // key = { floor( (<proj_i, point> + offset_i) / 'hashWidth' ) forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       referenceSet.n_cols);
-    arma::mat hashMat = projMat.t() * referenceSet;
-    hashMat += offsetMat;
-    hashMat /= hashWidth;
-
-    // Step VI: Putting the points in the 'secondHashTable' by hashing the key.
-    // Now we hash every key, point ID to its corresponding bucket.
-    arma::rowvec secondHashVec = secondHashWeights.t()
-      * arma::floor(hashMat);
-
-    // This gives us the bucket for the corresponding point ID.
-    for (size_t j = 0; j < secondHashVec.n_elem; j++)
-      secondHashVec[j] = (double)((size_t) secondHashVec[j] % secondHashSize);
-
-    Log::Assert(secondHashVec.n_elem == referenceSet.n_cols);
-
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVec.n_elem; j++)
+    for (size_t j = 0; j < count; j++)
     {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVec[j];
-      // The point ID is 'j'.
+      const size_t hashInd = hashes(i, j);
+      const size_t size = bucketOffsets[hashInd + 1] - bucketOffsets[hashInd] +
+          newCounts[hashInd];
+      if (bucketSize == 0 || size < bucketSize)
+        newCounts[hashInd]++;
+      else
+        dropped++;
+    }
+  }
 
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      if (bucketContentSize[hashInd] == 0)
-      {
-        // Start a new row for hash.
-        bucketRowInHashTable[hashInd] = numRowsInTable;
-        secondHashTable(numRowsInTable, 0) = j;
+  // Make room for the new points at the end of each bucket.  The buckets only
+  // move towards the end of 'bucketContents', so moving them from the last
+  // one to the first one never overwrites a bucket that hasn't moved yet.
+  arma::Col<size_t> newOffsets(secondHashSize + 1);
+  newOffsets[0] = 0;
+  for (size_t h = 0; h < secondHashSize; h++)
+    newOffsets[h + 1] = newOffsets[h] + (bucketOffsets[h + 1] -
+        bucketOffsets[h]) + newCounts[h];
+
+  bucketContents.resize(newOffsets[secondHashSize]);
+  for (size_t h = secondHashSize; h > 0; h--)
+  {
+    const size_t size = bucketOffsets[h] - bucketOffsets[h - 1];
+    if (size > 0 && newOffsets[h - 1] != bucketOffsets[h - 1])
+      std::memmove(bucketContents.memptr() + newOffsets[h - 1],
+          bucketContents.memptr() + bucketOffsets[h - 1],
+          sizeof(IndexType) * size);
+  }
 
-        numRowsInTable++;
-      }
+  // Now put the new points into their buckets, in the same order as they were
+  // counted.
+  arma::Col<size_t> next(secondHashSize);
+  for (size_t h = 0; h < secondHashSize; h++)
+    next[h] = newOffsets[h + 1] - newCounts[h];
 
-      else
-      {
-        // If bucket is already present in the 'secondHashTable', find the
-        // corresponding row and insert the point ID in this row unless the
-        // bucket is full, in which case, do nothing.
-        if (bucketContentSize[hashInd] < bucketSize)
-          secondHashTable(bucketRowInHashTable[hashInd],
-                          bucketContentSize[hashInd]) = j;
-      }
+  for (size_t i = 0; i < numTables; i++)
+  {
+    for (size_t j = 0; j < count; j++)
+    {
+      const size_t hashInd = hashes(i, j);
+      if (next[hashInd] < newOffsets[hashInd + 1])
+        bucketContents[next[hashInd]++] = (IndexType) (begin + j);
+    }
+  }
 
-      // Increment the count of the points in this bucket.
-      if (bucketContentSize[hashInd] < bucketSize)
-        bucketContentSize[hashInd]++;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
-
-  // Step VII: Condensing the 'secondHashTable'.
-  size_t maxBucketSize = 0;
-  for (size_t i = 0; i < bucketContentSize.n_elem; i++)
-    if (bucketContentSize[i] > maxBucketSize)
-      maxBucketSize = bucketContentSize[i];
-
-  Log::Info << "Final hash table size: (" << numRowsInTable << " x "
-            << maxBucketSize << ")" << std::endl;
-  secondHashTable.resize(numRowsInTable, maxBucketSize);
+  bucketOffsets = std::move(newOffsets);
+  numInsertedPoints = referenceSet.n_cols;
+
+  maxBucketSize = 0;
+  for (size_t h = 0; h < secondHashSize; h++)
+    maxBucketSize = std::max(maxBucketSize, (size_t) (bucketOffsets[h + 1] -
+        bucketOffsets[h]));
+
+  if (dropped > 0)
+    Log::Warn << "LSHSearch: " << dropped << " (point, table) pairs did not "
+        << "fit into their buckets of the second hash (bucket size "
+        << bucketSize << ") and were dropped; use a bucket size of 0 for "
+        << "buckets of any size." << std::endl;
+}
+
+template<typename SortPolicy, typename IndexType, typename HashType>
+size_t LSHSearch<SortPolicy, IndexType, HashType>::MemoryUsage() const
+{
+  return sizeof(*this) - sizeof(hash) - sizeof(bucketOffsets) -
+      sizeof(bucketContents) + util::MemoryUsage(hash) +
+      util::MemoryUsage(bucketOffsets) + util::MemoryUsage(bucketContents);
 }
 
-template<typename SortPolicy>
-std::string LSHSearch<SortPolicy>::ToString() const
+template<typename SortPolicy, typename IndexType, typename HashType>
+std::string LSHSearch<SortPolicy, IndexType, HashType>::ToString() const
 {
   std::ostringstream convert;
   convert << "LSHSearch [" << this << "]" << std::endl;
@@ -405,7 +473,8 @@ std::string LSHSearch<SortPolicy>::ToString() const
         << std::endl;
   convert << "  Number of Projections: " << numProj << std::endl;
   convert << "  Number of Tables: " << numTables << std::endl;
-  convert << "  Hash Width: " << hashWidth << std::endl;
+  convert << "  Hash Functions: " << std::endl;
+  convert << mlpack::util::Indent(hash.ToString(), 2);
   return convert.str();
 }
 
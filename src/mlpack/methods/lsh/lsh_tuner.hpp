@@ -0,0 +1,212 @@
+/**
+ * @file lsh_tuner.hpp
+ * @author Parikshit Ram
+ *
+ * Search for LSH parameters that reach a given recall as fast as possible.
+ */
+#ifndef __MLPACK_METHODS_LSH_LSH_TUNER_HPP
+#define __MLPACK_METHODS_LSH_LSH_TUNER_HPP
+
+#include <mlpack/core.hpp>
+#include <vector>
+
+#include "lsh_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The parameters of an LSHSearch object and of its searches, together with
+ * what they achieved on the queries of an LSHTuner.
+ */
+struct LSHConfiguration
+{
+  //! The number of projections in each hash table.
+  size_t numProj;
+  //! The number of hash tables.
+  size_t numTables;
+  //! The width of the hash.
+  double hashWidth;
+  //! The maximum size of a bucket of the second hash (0 for no limit).
+  size_t bucketSize;
+  //! The number of additional buckets probed in each table.
+  size_t numProbes;
+
+  //! The fraction of the true k nearest neighbors that were found.
+  double recall;
+  //! The time taken to search for the neighbors of all the queries (seconds).
+  double searchTime;
+  //! The number of bytes used by the hash tables.
+  size_t memoryUsage;
+};
+
+/**
+ * This class chooses the parameters of LSHSearch (the number of projections,
+ * the number of tables, the hash width, the bucket size and the number of
+ * additional buckets to probe) for a given dataset.  The exact k nearest
+ * neighbors of a sample of queries are computed once with dual-tree search,
+ * and then the hash tables are built for every combination of the candidate
+ * parameters; the configuration that finds at least the target fraction of
+ * the true neighbors (the recall) with the smallest search time, and whose
+ * tables fit in the memory budget, is returned.
+ *
+ * The candidate hash widths are given as multiples of the average distance of
+ * the queries to their k'th nearest neighbor, which is the scale the hash
+ * width should have.  Probes do not change the tables, so they are tried
+ * without building the tables again.  Because more tables and more probes
+ * give more candidates (and so slower searches), the number of tables and of
+ * probes is not increased further for the other parameters once the target
+ * recall is reached, and the tables are not searched at all if they do not fit
+ * in the budget.
+ *
+ * @code
+ * LSHTuner<> tuner(referenceSet, querySample, 10, 0.9, 1 << 28);
+ * const LSHConfiguration& best = tuner.Tune();
+ * LSHSearch<> lsh(referenceSet, best.numProj, best.numTables, best.hashWidth,
+ *     tuner.SecondHashSize(), best.bucketSize);
+ * @endcode
+ *
+ * @tparam LSHType The LSH class to tune; see LSHSearch.
+ */
+template<typename LSHType = LSHSearch<> >
+class LSHTuner
+{
+ public:
+  /**
+   * Compute the exact neighbors of the given sample of queries and prepare the
+   * default candidate parameters.  The query sample should be small (a few
+   * hundred points), because every configuration searches it.
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Sample of query points.
+   * @param k Number of neighbors to search for.
+   * @param targetRecall Fraction of the true neighbors that must be found.
+   * @param memoryBudget Maximum number of bytes of the hash tables (0 means
+   *     no limit).
+   * @param secondHashSize The size of the second hash table.
+   * @param batchSize Number of queries searched together.
+   */
+  LSHTuner(const arma::mat& referenceSet,
+           const arma::mat& querySet,
+           const size_t k,
+           const double targetRecall,
+           const size_t memoryBudget = 0,
+           const size_t secondHashSize = 99901,
+           const size_t batchSize = 1024);
+
+  /**
+   * Try every combination of the candidate parameters and return the fastest
+   * configuration that reaches the target recall within the memory budget.
+   * If there is none, the configuration with the highest recall within the
+   * budget is returned, and Succeeded() returns false.
+   */
+  const LSHConfiguration& Tune();
+
+  /**
+   * Build the hash tables with the given parameters, and measure the recall
+   * and the search time of each of the given numbers of probes, which should
+   * be increasing; probes after the first to reach the target recall are not
+   * tried.  The results are appended to Configurations().
+   *
+   * @return The number of configurations that were evaluated (0 if the tables
+   *     do not fit in the memory budget).
+   */
+  size_t Evaluate(const size_t numProj,
+                  const size_t numTables,
+                  const double hashWidth,
+                  const size_t bucketSize,
+                  const std::vector<size_t>& numProbes);
+
+  /**
+   * Compute the fraction of the true neighbors of the queries that are among
+   * the given neighbors.
+   */
+  double Recall(const arma::Mat<size_t>& neighbors) const;
+
+  //! Get whether the best configuration reaches the target recall.
+  bool Succeeded() const { return succeeded; }
+  //! Get the best configuration found by the last call to Tune().
+  const LSHConfiguration& Best() const { return best; }
+  //! Get every configuration evaluated so far.
+  const std::vector<LSHConfiguration>& Configurations() const
+  { return configurations; }
+
+  //! Get the exact neighbors of the queries.
+  const arma::Mat<size_t>& TrueNeighbors() const { return trueNeighbors; }
+  //! Get the average distance of the queries to their k'th nearest neighbor.
+  double BaseWidth() const { return baseWidth; }
+  //! Get the size of the second hash table.
+  size_t SecondHashSize() const { return secondHashSize; }
+
+  //! Get the candidate numbers of projections.
+  const std::vector<size_t>& Projections() const { return projections; }
+  //! Modify the candidate numbers of projections.
+  std::vector<size_t>& Projections() { return projections; }
+
+  //! Get the candidate numbers of tables (in increasing order).
+  const std::vector<size_t>& Tables() const { return tables; }
+  //! Modify the candidate numbers of tables (in increasing order).
+  std::vector<size_t>& Tables() { return tables; }
+
+  //! Get the candidate hash widths, as multiples of BaseWidth().
+  const std::vector<double>& WidthScales() const { return widthScales; }
+  //! Modify the candidate hash widths, as multiples of BaseWidth().
+  std::vector<double>& WidthScales() { return widthScales; }
+
+  //! Get the candidate bucket sizes.
+  const std::vector<size_t>& BucketSizes() const { return bucketSizes; }
+  //! Modify the candidate bucket sizes.
+  std::vector<size_t>& BucketSizes() { return bucketSizes; }
+
+  //! Get the candidate numbers of probes (in increasing order).
+  const std::vector<size_t>& Probes() const { return probes; }
+  //! Modify the candidate numbers of probes (in increasing order).
+  std::vector<size_t>& Probes() { return probes; }
+
+ private:
+  //! Reference dataset.
+  const arma::mat& referenceSet;
+  //! Sample of queries.
+  const arma::mat& querySet;
+  //! Number of neighbors to search for.
+  size_t k;
+  //! Fraction of the true neighbors that must be found.
+  double targetRecall;
+  //! Maximum number of bytes of the hash tables (0 for no limit).
+  size_t memoryBudget;
+  //! The size of the second hash table.
+  size_t secondHashSize;
+  //! Number of queries searched together.
+  size_t batchSize;
+
+  //! The exact neighbors of the queries.
+  arma::Mat<size_t> trueNeighbors;
+  //! The average distance of the queries to their k'th nearest neighbor.
+  double baseWidth;
+
+  //! Candidate numbers of projections.
+  std::vector<size_t> projections;
+  //! Candidate numbers of tables.
+  std::vector<size_t> tables;
+  //! Candidate hash widths, as multiples of baseWidth.
+  std::vector<double> widthScales;
+  //! Candidate bucket sizes.
+  std::vector<size_t> bucketSizes;
+  //! Candidate numbers of probes.
+  std::vector<size_t> probes;
+
+  //! Every configuration evaluated so far.
+  std::vector<LSHConfiguration> configurations;
+  //! The best configuration.
+  LSHConfiguration best;
+  //! Whether the best configuration reaches the target recall.
+  bool succeeded;
+}; // class LSHTuner
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+// Include implementation.
+#include "lsh_tuner_impl.hpp"
+
+#endif
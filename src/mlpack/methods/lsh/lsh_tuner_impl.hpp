@@ -0,0 +1,207 @@
+/**
+ * @file lsh_tuner_impl.hpp
+ * @author Parikshit Ram
+ *
+ * Implementation of the LSHTuner class.
+ */
+#ifndef __MLPACK_METHODS_LSH_LSH_TUNER_IMPL_HPP
+#define __MLPACK_METHODS_LSH_LSH_TUNER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "lsh_tuner.hpp"
+
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename LSHType>
+LSHTuner<LSHType>::LSHTuner(const arma::mat& referenceSet,
+                            const arma::mat& querySet,
+                            const size_t k,
+                            const double targetRecall,
+                            const size_t memoryBudget,
+                            const size_t secondHashSize,
+                            const size_t batchSize) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    k(k),
+    targetRecall(targetRecall),
+    memoryBudget(memoryBudget),
+    secondHashSize(secondHashSize),
+    batchSize(batchSize),
+    baseWidth(0.0),
+    succeeded(false)
+{
+  if (k == 0 || k > referenceSet.n_cols)
+  {
+    Log::Fatal << "LSHTuner: invalid k: " << k << "; must be greater than 0 "
+        << "and less than or equal to the number of reference points ("
+        << referenceSet.n_cols << ")." << std::endl;
+  }
+
+  // The exact neighbors, to measure the recall of every configuration.
+  arma::mat distances;
+  NeighborSearch<NearestNeighborSort, metric::EuclideanDistance> knn(
+      referenceSet);
+  knn.Search(querySet, k, trueNeighbors, distances);
+
+  baseWidth = arma::mean(distances.row(k - 1));
+  if (baseWidth == 0.0)
+  {
+    Log::Warn << "LSHTuner: the queries have duplicates of their " << k
+        << " nearest neighbors; using a base hash width of 1." << std::endl;
+    baseWidth = 1.0;
+  }
+
+  Log::Info << "Computed the exact neighbors of " << querySet.n_cols
+      << " queries; the base hash width is " << baseWidth << "." << std::endl;
+
+  // The default candidates.
+  const size_t defaultProjections[] = { 5, 10, 15, 20 };
+  const size_t defaultTables[] = { 5, 10, 20, 30, 50 };
+  const double defaultWidthScales[] = { 1.0, 2.0, 4.0, 8.0 };
+  const size_t defaultBucketSizes[] = { 0, 500 };
+  const size_t defaultProbes[] = { 0, 2, 8, 32 };
+  projections.assign(defaultProjections, defaultProjections + 4);
+  tables.assign(defaultTables, defaultTables + 5);
+  widthScales.assign(defaultWidthScales, defaultWidthScales + 4);
+  bucketSizes.assign(defaultBucketSizes, defaultBucketSizes + 2);
+  probes.assign(defaultProbes, defaultProbes + 4);
+}
+
+template<typename LSHType>
+const LSHConfiguration& LSHTuner<LSHType>::Tune()
+{
+  if (projections.empty() || tables.empty() || widthScales.empty() ||
+      bucketSizes.empty() || probes.empty())
+  {
+    Log::Fatal << "LSHTuner::Tune(): every parameter needs at least one "
+        << "candidate value." << std::endl;
+  }
+
+  for (size_t p = 0; p < projections.size(); ++p)
+  {
+    for (size_t w = 0; w < widthScales.size(); ++w)
+    {
+      for (size_t b = 0; b < bucketSizes.size(); ++b)
+      {
+        // More tables use more memory and give more candidates, so stop when
+        // the tables no longer fit or the target recall is reached.
+        for (size_t t = 0; t < tables.size(); ++t)
+        {
+          if (Evaluate(projections[p], tables[t],
+              widthScales[w] * baseWidth, bucketSizes[b], probes) == 0)
+            break;
+
+          if (configurations.back().recall >= targetRecall)
+            break;
+        }
+      }
+    }
+  }
+
+  if (configurations.empty())
+  {
+    Log::Fatal << "LSHTuner::Tune(): none of the hash tables fit in the "
+        << "memory budget of " << memoryBudget << " bytes." << std::endl;
+  }
+
+  // Take the fastest configuration that reaches the recall, or else the one
+  // with the highest recall.
+  succeeded = false;
+  best = configurations[0];
+  for (size_t i = 0; i < configurations.size(); ++i)
+  {
+    const LSHConfiguration& c = configurations[i];
+    if (c.recall >= targetRecall)
+    {
+      if (!succeeded || c.searchTime < best.searchTime)
+        best = c;
+      succeeded = true;
+    }
+    else if (!succeeded && c.recall > best.recall)
+    {
+      best = c;
+    }
+  }
+
+  if (!succeeded)
+  {
+    Log::Warn << "LSHTuner::Tune(): no configuration reaches the target "
+        << "recall of " << targetRecall << "; the highest recall is "
+        << best.recall << "." << std::endl;
+  }
+
+  return best;
+}
+
+template<typename LSHType>
+size_t LSHTuner<LSHType>::Evaluate(const size_t numProj,
+                                   const size_t numTables,
+                                   const double hashWidth,
+                                   const size_t bucketSize,
+                                   const std::vector<size_t>& numProbes)
+{
+  LSHType lsh(referenceSet, numProj, numTables, hashWidth, secondHashSize,
+      bucketSize);
+
+  const size_t memoryUsage = lsh.MemoryUsage();
+  if (memoryBudget != 0 && memoryUsage > memoryBudget)
+  {
+    Log::Info << "K = " << numProj << ", L = " << numTables << ", H = "
+        << hashWidth << ", B = " << bucketSize << ": " << memoryUsage
+        << " bytes is over the budget." << std::endl;
+    return 0;
+  }
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  arma::wall_clock clock;
+  size_t evaluated = 0;
+  for (size_t i = 0; i < numProbes.size(); ++i)
+  {
+    clock.tic();
+    lsh.Search(querySet, k, neighbors, distances, 0, batchSize, numProbes[i]);
+
+    LSHConfiguration c;
+    c.searchTime = clock.toc();
+    c.numProj = numProj;
+    c.numTables = numTables;
+    c.hashWidth = hashWidth;
+    c.bucketSize = bucketSize;
+    c.numProbes = numProbes[i];
+    c.recall = Recall(neighbors);
+    c.memoryUsage = memoryUsage;
+    configurations.push_back(c);
+    ++evaluated;
+
+    Log::Info << "K = " << numProj << ", L = " << numTables << ", H = "
+        << hashWidth << ", B = " << bucketSize << ", T = " << numProbes[i]
+        << ": recall " << c.recall << ", " << c.searchTime << "s, "
+        << memoryUsage << " bytes." << std::endl;
+
+    if (c.recall >= targetRecall)
+      break;
+  }
+
+  return evaluated;
+}
+
+template<typename LSHType>
+double LSHTuner<LSHType>::Recall(const arma::Mat<size_t>& neighbors) const
+{
+  size_t found = 0;
+  for (size_t q = 0; q < trueNeighbors.n_cols; ++q)
+    for (size_t i = 0; i < neighbors.n_rows; ++i)
+      for (size_t j = 0; j < trueNeighbors.n_rows; ++j)
+        if (neighbors(i, q) == trueNeighbors(j, q))
+          ++found;
+
+  return double(found) / trueNeighbors.n_elem;
+}
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
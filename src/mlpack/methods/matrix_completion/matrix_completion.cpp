@@ -16,7 +16,11 @@ MatrixCompletion::MatrixCompletion(const size_t m,
                                    const arma::vec& values,
                                    const size_t r) :
     m(m), n(n), indices(indices), values(values),
-    sdp(indices.n_cols, 0, arma::randu<arma::mat>(m + n, r))
+    sdp(0, 0, arma::randu<arma::mat>(m + n, r)),
+    approximate(false),
+    lambda(1e-8),
+    maxIterations(500),
+    tolerance(1e-10)
 {
   CheckValues();
   InitSDP();
@@ -28,7 +32,11 @@ MatrixCompletion::MatrixCompletion(const size_t m,
                                    const arma::vec& values,
                                    const arma::mat& initialPoint) :
     m(m), n(n), indices(indices), values(values),
-    sdp(indices.n_cols, 0, initialPoint)
+    sdp(0, 0, initialPoint),
+    approximate(false),
+    lambda(1e-8),
+    maxIterations(500),
+    tolerance(1e-10)
 {
   CheckValues();
   InitSDP();
@@ -39,8 +47,12 @@ MatrixCompletion::MatrixCompletion(const size_t m,
                                    const arma::umat& indices,
                                    const arma::vec& values) :
     m(m), n(n), indices(indices), values(values),
-    sdp(indices.n_cols, 0,
-        arma::randu<arma::mat>(m + n, DefaultRank(m, n, indices.n_cols)))
+    sdp(0, 0,
+        arma::randu<arma::mat>(m + n, DefaultRank(m, n, indices.n_cols))),
+    approximate(false),
+    lambda(1e-8),
+    maxIterations(500),
+    tolerance(1e-10)
 {
   CheckValues();
   InitSDP();
@@ -69,24 +81,150 @@ void MatrixCompletion::CheckValues()
 void MatrixCompletion::InitSDP()
 {
   sdp.SDP().C().eye(m + n, m + n);
-  sdp.SDP().SparseB() = 2. * values;
+  sdp.SDP().CoordinateB() = 2. * values;
   const size_t p = indices.n_cols;
+
+  // Each constraint has two nonzero elements, so they are stored as
+  // coordinate-sparse constraints: p (m + n) x (m + n) sparse matrices would
+  // take O(p (m + n)) memory.
+  sdp.SDP().CoordinateA().resize(p);
   for (size_t i = 0; i < p; i++)
   {
-    sdp.SDP().SparseA()[i].zeros(m + n, m + n);
-    sdp.SDP().SparseA()[i](indices(0, i), m + indices(1, i)) = 1.;
-    sdp.SDP().SparseA()[i](m + indices(1, i), indices(0, i)) = 1.;
+    arma::mat& elements = sdp.SDP().CoordinateA()[i];
+    elements.set_size(3, 2);
+    elements(0, 0) = indices(0, i);
+    elements(1, 0) = m + indices(1, i);
+    elements(2, 0) = 1.;
+    elements(0, 1) = m + indices(1, i);
+    elements(1, 1) = indices(0, i);
+    elements(2, 1) = 1.;
   }
 }
 
 void MatrixCompletion::Recover(arma::mat& recovered)
 {
+  if (approximate)
+  {
+    RecoverALS(recovered);
+    return;
+  }
+
   recovered = sdp.Function().GetInitialPoint();
   sdp.Optimize(recovered);
   recovered = recovered * trans(recovered);
   recovered = recovered(arma::span(0, m - 1), arma::span(m, m + n - 1));
 }
 
+void MatrixCompletion::RecoverALS(arma::mat& recovered)
+{
+  // The initial point of the SDP is [U; V], since X is the upper right block of
+  // [U; V] [U; V]^T.  The factors are kept transposed, so that the row being
+  // solved is contiguous.
+  const arma::mat& initialPoint = sdp.Function().GetInitialPoint();
+  arma::mat ut = trans(initialPoint.rows(0, m - 1));
+  arma::mat vt = trans(initialPoint.rows(m, m + n - 1));
+
+  arma::Col<size_t> rowOffsets, rowOrder, colOffsets, colOrder;
+  SortEntries(0, m, rowOffsets, rowOrder);
+  SortEntries(1, n, colOffsets, colOrder);
+
+  double lastError = DBL_MAX;
+  for (size_t i = 0; i < maxIterations; ++i)
+  {
+    UpdateFactor(vt, 0, rowOffsets, rowOrder, ut);
+    UpdateFactor(ut, 1, colOffsets, colOrder, vt);
+
+    // Squared error on the known entries.
+    double error = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:error)
+    for (size_t j = 0; j < indices.n_cols; ++j)
+    {
+      const double residual = values[j] - arma::dot(ut.col(indices(0, j)),
+          vt.col(indices(1, j)));
+      error += residual * residual;
+    }
+
+    Log::Debug << "Alternating least squares iteration " << i << ": squared "
+        << "error " << error << "." << std::endl;
+
+    if (lastError - error <= tolerance * lastError)
+      break;
+    lastError = error;
+  }
+
+  recovered = trans(ut) * vt;
+}
+
+void MatrixCompletion::SortEntries(const size_t dimension,
+                                   const size_t size,
+                                   arma::Col<size_t>& offsets,
+                                   arma::Col<size_t>& order) const
+{
+  offsets.zeros(size + 1);
+  for (size_t i = 0; i < indices.n_cols; ++i)
+    ++offsets[indices(dimension, i) + 1];
+  for (size_t i = 0; i < size; ++i)
+    offsets[i + 1] += offsets[i];
+
+  arma::Col<size_t> position = offsets;
+  order.set_size(indices.n_cols);
+  for (size_t i = 0; i < indices.n_cols; ++i)
+    order[position[indices(dimension, i)]++] = i;
+}
+
+void MatrixCompletion::UpdateFactor(const arma::mat& other,
+                                    const size_t dimension,
+                                    const arma::Col<size_t>& offsets,
+                                    const arma::Col<size_t>& order,
+                                    arma::mat& factor) const
+{
+  const size_t rank = factor.n_rows;
+  const size_t otherDimension = 1 - dimension;
+
+  // Every row of the factor is the solution of its own (rank x rank) ridge
+  // regression, so the rows are solved in parallel.
+  #pragma omp parallel
+  {
+    arma::mat gram(rank, rank);
+    arma::vec rhs(rank);
+
+    #pragma omp for schedule(dynamic, 64)
+    for (size_t i = 0; i < factor.n_cols; ++i)
+    {
+      if (offsets[i] == offsets[i + 1])
+      {
+        // Nothing is known about this row.
+        factor.col(i).zeros();
+        continue;
+      }
+
+      gram.zeros();
+      rhs.zeros();
+      for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+      {
+        const size_t entry = order[k];
+        const double* x = other.colptr(indices(otherDimension, entry));
+        for (size_t c = 0; c < rank; ++c)
+        {
+          for (size_t r = c; r < rank; ++r)
+            gram(r, c) += x[r] * x[c];
+          rhs[c] += values[entry] * x[c];
+        }
+      }
+
+      // Only the lower triangle was accumulated.
+      for (size_t c = 0; c < rank; ++c)
+      {
+        gram(c, c) += lambda;
+        for (size_t r = c + 1; r < rank; ++r)
+          gram(c, r) = gram(r, c);
+      }
+
+      factor.col(i) = arma::solve(gram, rhs);
+    }
+  }
+}
+
 size_t MatrixCompletion::DefaultRank(const size_t m,
                                      const size_t n,
                                      const size_t p)
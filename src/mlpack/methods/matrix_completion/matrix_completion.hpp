@@ -31,6 +31,19 @@ namespace matrix_completion {
  *   Benjamin Recht. JMLR 11.
  *   http://arxiv.org/pdf/0910.0651v2.pdf
  *
+ * Solving the SDP becomes expensive when there are many known entries, because
+ * every entry is one constraint.  Alternatively, if Approximate() is set, the
+ * matrix is completed with alternating least squares: X is factored as U V^T,
+ * with the rank of the solution, and every row of U (and then of V) is solved
+ * in turn from the known entries of its row (column), in parallel, minimizing
+ *
+ *   sum_ij (M_ij - (U V^T)_ij)^2 + lambda (||U||_F^2 + ||V||_F^2)
+ *
+ * over the known entries.  An iteration costs O(p r^2 + (m + n) r^3) for p
+ * known entries and rank r, so this is the solver to use with a low rank and
+ * many known entries; it finds a local minimum, not the minimum nuclear norm
+ * solution.
+ *
  * An example of how to use this class is shown below:
  *
  * @code
@@ -41,6 +54,11 @@ namespace matrix_completion {
  *
  * MatrixCompletion mc(m, n, indices, values);
  * mc.Recover(recovered);
+ *
+ * // Or, with alternating least squares and rank 10.
+ * MatrixCompletion als(m, n, indices, values, 10);
+ * als.Approximate() = true;
+ * als.Recover(recovered);
  * @endcode
  *
  * @see LRSDP
@@ -100,12 +118,36 @@ class MatrixCompletion
                    const arma::vec& values);
 
   /**
-   * Solve the underlying SDP to fill in the remaining values.
+   * Solve the underlying SDP (or, if Approximate() is set, the alternating
+   * least squares problem) to fill in the remaining values.
    *
    * @param recovered Will contain the completed matrix.
    */
   void Recover(arma::mat& recovered);
 
+  //! Get whether alternating least squares is used instead of the SDP.
+  bool Approximate() const { return approximate; }
+  //! Modify whether alternating least squares is used instead of the SDP.
+  bool& Approximate() { return approximate; }
+
+  //! Get the regularization parameter of alternating least squares.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter of alternating least squares.
+  double& Lambda() { return lambda; }
+
+  //! Get the maximum number of iterations of alternating least squares.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations of alternating least squares.
+  size_t& MaxIterations() { return maxIterations; }
+
+  /**
+   * Get the tolerance of alternating least squares: it stops when the squared
+   * error on the known entries improves by less than this fraction.
+   */
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance of alternating least squares.
+  double& Tolerance() { return tolerance; }
+
   //! Return the underlying SDP.
   const optimization::LRSDP<optimization::SDP<arma::sp_mat>>& Sdp() const { return sdp; }
   //! Modify the underlying SDP.
@@ -124,11 +166,53 @@ class MatrixCompletion
   //! The underlying SDP to be solved.
   optimization::LRSDP<optimization::SDP<arma::sp_mat>> sdp;
 
+  //! Whether to use alternating least squares instead of the SDP.
+  bool approximate;
+  //! Regularization parameter of alternating least squares.
+  double lambda;
+  //! Maximum number of iterations of alternating least squares.
+  size_t maxIterations;
+  //! Tolerance of alternating least squares.
+  double tolerance;
+
   //! Validate the input matrices.
   void CheckValues();
   //! Initialize the SDP.
   void InitSDP();
 
+  /**
+   * Fill in the remaining values with alternating least squares, starting from
+   * the initial point of the SDP.
+   */
+  void RecoverALS(arma::mat& recovered);
+
+  /**
+   * Sort the known entries by the given row of indices (0 for the rows of the
+   * matrix, 1 for its columns), with a counting sort.  The entries of row (or
+   * column) i are then order[offsets[i]] to order[offsets[i + 1] - 1].
+   */
+  void SortEntries(const size_t dimension,
+                   const size_t size,
+                   arma::Col<size_t>& offsets,
+                   arma::Col<size_t>& order) const;
+
+  /**
+   * Solve the rows of one factor (stored transposed, one column per row of the
+   * factor), given the other, from the known entries.
+   *
+   * @param other The other factor, transposed.
+   * @param dimension Index of the row of indices that selects the entries of
+   *     the factor being solved (0 for U, 1 for V).
+   * @param offsets Offsets of the entries of every row of the factor.
+   * @param order Known entries, sorted by row of the factor.
+   * @param factor The factor to solve, transposed.
+   */
+  void UpdateFactor(const arma::mat& other,
+                    const size_t dimension,
+                    const arma::Col<size_t>& offsets,
+                    const arma::Col<size_t>& order,
+                    arma::mat& factor) const;
+
   //! Select a rank of the matrix given that is of size m x n and has p known
   //! elements.
   static size_t DefaultRank(const size_t m, const size_t n, const size_t p);
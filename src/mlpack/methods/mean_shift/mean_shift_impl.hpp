@@ -91,26 +91,34 @@ void MeanShift<UseKernel, KernelType, MatType>::GenSeeds(
     int minFreq,
     MatType& seeds)
 {
+  // Bin the points, so that all points of a bin are collapsed into one seed.
   typedef arma::colvec VecType;
   std::map<VecType, int, less<VecType> > allSeeds;
   for (size_t i = 0; i < data.n_cols; ++i)
   {
     VecType binnedPoint = arma::floor(data.unsafe_col(i) / binSize);
-    if (allSeeds.find(binnedPoint) == allSeeds.end())
-      allSeeds[binnedPoint] = 1;
-    else
-      allSeeds[binnedPoint]++;
+    allSeeds[binnedPoint]++;
   }
-  
-  // Remove seeds with too few points
+
+  // Remove seeds with too few points.  The seeds are counted first, so that
+  // the seed matrix is allocated only once.
+  size_t numSeeds = 0;
   std::map<VecType, int, less<VecType> >::iterator it;
   for (it = allSeeds.begin(); it != allSeeds.end(); ++it)
   {
     if (it->second >= minFreq)
-      seeds.insert_cols(seeds.n_cols, it->first);
+      ++numSeeds;
   }
-  
-  seeds = seeds * binSize;
+
+  seeds.set_size(data.n_rows, numSeeds);
+  size_t seed = 0;
+  for (it = allSeeds.begin(); it != allSeeds.end(); ++it)
+  {
+    if (it->second >= minFreq)
+      seeds.col(seed++) = it->first;
+  }
+
+  seeds *= binSize;
 }
 
 // Calculate new centroid with given kernel.
@@ -191,60 +199,103 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
   
   assignments.set_size(data.n_cols);
   
-  range::RangeSearch<> rangeSearcher(data);
-  math::Range validRadius(0, radius);
-  std::vector<std::vector<size_t> > neighbors;
-  std::vector<std::vector<double> > distances;
+  // Build the reference tree once; it is used by the range searches of all
+  // seeds.  The tree rearranges its own copy of the data, and the neighbors are
+  // taken from that copy, so the indices never have to be mapped back.
+  typedef tree::BinarySpaceTree<bound::HRectBound<2>, range::RangeSearchStat>
+      TreeType;
+  typedef range::RangeSearchRules<metric::EuclideanDistance, TreeType>
+      RuleType;
 
-  // For each seed, perform mean shift algorithm.
-  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  arma::mat referenceData(data);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(referenceData, oldFromNew);
+  const arma::mat& treeData = tree.Dataset();
+
+  const math::Range validRadius(0, radius);
+
+  // Whether the centroid of each seed converged.
+  arma::Col<size_t> converged = arma::zeros<arma::Col<size_t> >(
+      pSeeds->n_cols);
+
+  // The seeds are independent, so they are shifted in parallel.  Every thread
+  // has its own range search results and traversal objects; the tree is only
+  // read.
+  #pragma omp parallel
   {
-    // Initial centroid is the seed itself.
-    allCentroids.col(i) = pSeeds->unsafe_col(i);
-    for (size_t completedIterations = 0; completedIterations < maxIterations;
-         completedIterations++)
+    std::vector<std::vector<size_t> > neighbors(1);
+    std::vector<std::vector<double> > distances(1);
+    arma::mat query(pSeeds->n_rows, 1);
+    metric::EuclideanDistance distanceMetric;
+
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < pSeeds->n_cols; ++i)
     {
-      // Store new centroid in this.
-      arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
-      
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() <= 1)
-        break;
-      
-      // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
-        newCentroid = allCentroids.unsafe_col(i);
-
-      // If the mean shift vector is small enough, it has converged.
-      if (metric::EuclideanDistance::Evaluate(newCentroid, allCentroids.unsafe_col(i)) <
-          1e-3 * radius)
+      // Initial centroid is the seed itself.
+      allCentroids.col(i) = pSeeds->unsafe_col(i);
+      for (size_t completedIterations = 0; completedIterations < maxIterations;
+           completedIterations++)
       {
-        // Determine if the new centroid is duplicate with old ones.
-        bool isDuplicated = false;
-        for (size_t k = 0; k < centroids.n_cols; ++k)
+        // Store new centroid in this.
+        arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+
+        // Find the points in the radius of the centroid.
+        query.col(0) = allCentroids.unsafe_col(i);
+        neighbors[0].clear();
+        distances[0].clear();
+        range::ListResults results(neighbors, distances);
+        RuleType rules(treeData, query, validRadius, results,
+            distanceMetric);
+        typename TreeType::template SingleTreeTraverser<RuleType>
+            traverser(rules);
+        traverser.Traverse(0, tree);
+
+        if (neighbors[0].size() <= 1)
+          break;
+
+        // Calculate new centroid.
+        if (!CalculateCentroid(treeData, neighbors[0], distances[0],
+            newCentroid))
+          newCentroid = allCentroids.unsafe_col(i);
+
+        // If the mean shift vector is small enough, it has converged.
+        if (metric::EuclideanDistance::Evaluate(newCentroid,
+            allCentroids.unsafe_col(i)) < 1e-3 * radius)
         {
-          const double distance = metric::EuclideanDistance::Evaluate(
-              allCentroids.unsafe_col(i), centroids.unsafe_col(k));
-          if (distance < radius)
-          {
-            isDuplicated = true;
-            break;
-          }
+          converged[i] = 1;
+          break;
         }
 
-        if (!isDuplicated)
-          centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
-        
-        // Get out of the loop.
-        break;
+        // Update the centroid.
+        allCentroids.col(i) = newCentroid;
       }
+    }
+  }
+
+  // Collect the converged centroids in the order of the seeds, and remove the
+  // duplicate ones.
+  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  {
+    if (!converged[i])
+      continue;
 
-      // Update the centroid.
-      allCentroids.col(i) = newCentroid;
+    // Determine if the new centroid is duplicate with old ones.
+    bool isDuplicated = false;
+    for (size_t k = 0; k < centroids.n_cols; ++k)
+    {
+      const double distance = metric::EuclideanDistance::Evaluate(
+          allCentroids.unsafe_col(i), centroids.unsafe_col(k));
+      if (distance < radius)
+      {
+        isDuplicated = true;
+        break;
+      }
     }
+
+    if (!isDuplicated)
+      centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
   }
-  
+
   // Assign centroids to each point
   neighbor::AllkNN neighborSearcher(centroids);
   arma::mat neighborDistances;
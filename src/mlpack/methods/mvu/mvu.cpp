@@ -15,6 +15,7 @@
 
 using namespace mlpack;
 using namespace mlpack::mvu;
+using namespace mlpack::neighbor;
 using namespace mlpack::optimization;
 
 MVU::MVU(const arma::mat& data) : data(data)
@@ -32,23 +33,20 @@ void MVU::Unfold(const size_t newDim,
   // Following Nick's idea.
   outputData.randu(data.n_cols, newDim);
 
-  // The number of constraints is the number of nearest neighbors plus one.
-  LRSDP<arma::sp_mat> mvuSolver(numNeighbors * data.n_cols + 1, outputData);
+  // There is one coordinate-sparse constraint for each nearest neighbor of each
+  // point, and one rank-one constraint to center the output.
+  const size_t n = data.n_cols;
+  LRSDP<SDP<arma::sp_mat>> mvuSolver(0, 0, outputData);
 
   // Set up the objective.  Because we are maximizing the trace of (R R^T),
   // we'll instead state it as min(-I_n * (R R^T)), meaning C() is -I_n.
-  mvuSolver.C().eye(data.n_cols, data.n_cols);
-  mvuSolver.C() *= -1;
+  mvuSolver.SDP().C().eye(n, n);
+  mvuSolver.SDP().C() *= -1;
 
-  // Now set up each of the constraints.
-  // The first constraint is trace(ones * R * R^T) = 0.
-  mvuSolver.B()[0] = 0;
-  mvuSolver.A()[0].ones(data.n_cols, data.n_cols);
-
-  // All of our other constraints will be sparse except the first.  So set that
-  // vector of modes accordingly.
-  mvuSolver.AModes().ones();
-  mvuSolver.AModes()[0] = 0;
+  // The centering constraint is trace(ones * R * R^T) = 0, and ones = 1 1^T is
+  // rank-one, so it costs O(n r) instead of O(n^2 r) to evaluate.
+  mvuSolver.SDP().RankOneA().push_back(arma::ones<arma::vec>(n));
+  mvuSolver.SDP().RankOneB().zeros(1);
 
   // Now all of the other constraints.  We first have to run AllkNN to get the
   // list of nearest neighbors.
@@ -58,18 +56,22 @@ void MVU::Unfold(const size_t newDim,
   AllkNN allknn(data);
   allknn.Search(numNeighbors, neighbors, distances);
 
-  // Add each of the other constraints.  They are sparse constraints:
-  //   Tr(A_ij K) = d_ij;
+  // Add each of the other constraints.  They are coordinate-sparse
+  // constraints:
+  //   Tr(A_ij K) = d_ij^2;
   //   A_ij = zeros except for 1 at (i, i), (j, j); -1 at (i, j), (j, i).
+  // Each of them has four nonzeros, so it costs O(r) time and O(1) memory.
+  mvuSolver.SDP().CoordinateA().resize(numNeighbors * n);
+  mvuSolver.SDP().CoordinateB().set_size(numNeighbors * n);
   for (size_t i = 0; i < neighbors.n_cols; ++i)
   {
     for (size_t j = 0; j < numNeighbors; ++j)
     {
       // This is the index of the constraint.
-      const size_t index = (i * numNeighbors) + j + 1;
-
-      arma::mat& aRef = mvuSolver.A()[index];
+      const size_t index = (i * numNeighbors) + j;
+      const size_t neighbor = neighbors(j, i);
 
+      arma::mat& aRef = mvuSolver.SDP().CoordinateA()[index];
       aRef.set_size(3, 4);
 
       // A_ij(i, i) = 1.
@@ -79,21 +81,21 @@ void MVU::Unfold(const size_t newDim,
 
       // A_ij(i, j) = -1.
       aRef(0, 1) = i;
-      aRef(1, 1) = neighbors(j, i);
+      aRef(1, 1) = neighbor;
       aRef(2, 1) = -1;
 
       // A_ij(j, i) = -1.
-      aRef(0, 2) = neighbors(j, i);
+      aRef(0, 2) = neighbor;
       aRef(1, 2) = i;
       aRef(2, 2) = -1;
 
       // A_ij(j, j) = 1.
-      aRef(0, 3) = neighbors(j, i);
-      aRef(1, 3) = neighbors(j, i);
+      aRef(0, 3) = neighbor;
+      aRef(1, 3) = neighbor;
       aRef(2, 3) = 1;
 
-      // The constraint b_ij is the distance between these two points.
-      mvuSolver.B()[index] = distances(j, i);
+      // The constraint b_ij is the squared distance between these two points.
+      mvuSolver.SDP().CoordinateB()[index] = distances(j, i) * distances(j, i);
     }
   }
 
@@ -28,6 +28,11 @@ namespace naive_bayes /** The Naive Bayes Classifier. */ {
  * For classifying a data point (x_1, x_2, ..., x_n), it computes the following:
  * arg max_y(P(Y = y)*P(X_1 = x_1 | Y = y) * ... * P(X_n = x_n | Y = y))
  *
+ * The classifier can be trained incrementally: Train() folds a new batch of
+ * points into the statistics of those it has already seen, which gives the same
+ * model as training on all the points at once.  Each batch is split into blocks
+ * of points that are summarized in parallel, and the summaries are merged.
+ *
  * Example use:
  *
  * @code
@@ -51,7 +56,45 @@ class NaiveBayesClassifier
   //! Class probabilities.
   arma::vec probabilities;
 
+  //! Number of training points of each class.
+  arma::vec counts;
+
+  /**
+   * Compute the counts, means, and sums of squared deviations from the means of
+   * each class, for the points of the given range.
+   */
+  static void BlockStatistics(const MatType& data,
+                              const arma::Col<size_t>& labels,
+                              const size_t classes,
+                              const size_t begin,
+                              const size_t end,
+                              const bool incrementalVariance,
+                              arma::vec& blockCounts,
+                              MatType& blockMeans,
+                              MatType& blockDeviations);
+
+  /**
+   * Merge the statistics of a block of points into the statistics of another
+   * (disjoint) set of points.
+   */
+  static void MergeStatistics(const arma::vec& blockCounts,
+                              const MatType& blockMeans,
+                              const MatType& blockDeviations,
+                              arma::vec& totalCounts,
+                              MatType& totalMeans,
+                              MatType& totalDeviations);
+
  public:
+  /**
+   * Initialize an untrained classifier for the given number of features and
+   * classes.  Points can then be given to Train(), batch by batch.
+   *
+   * @param dimensionality Number of features of the points.
+   * @param classes Number of classes in this classifier.
+   */
+  NaiveBayesClassifier(const size_t dimensionality = 0,
+                       const size_t classes = 0);
+
   /**
    * Initializes the classifier as per the input and then trains it by
    * calculating the sample mean and variances.  The input data is expected to
@@ -77,6 +120,20 @@ class NaiveBayesClassifier
                        const size_t classes,
                        const bool incrementalVariance = false);
 
+  /**
+   * Train the classifier on a batch of points, in addition to the points it
+   * has already been trained on.  The labels have to be less than the number of
+   * classes.
+   *
+   * @param data Training data points.
+   * @param labels Labels corresponding to training data points.
+   * @param incrementalVariance If true, an incremental algorithm is used to
+   *     calculate the variance of each block of points.
+   */
+  void Train(const MatType& data,
+             const arma::Col<size_t>& labels,
+             const bool incrementalVariance = false);
+
   /**
    * Given a bunch of data points, this function evaluates the class of each of
    * those data points, and puts it in the vector 'results'.
@@ -93,6 +150,16 @@ class NaiveBayesClassifier
    */
   void Classify(const MatType& data, arma::Col<size_t>& results);
 
+  /**
+   * Compute the joint log-probability log P(X = x, Y = y) of each of the given
+   * points with each class.
+   *
+   * @param data List of data points.
+   * @param logLikelihoods Matrix with the log-probabilities of each point (one
+   *     column) with each class (one row).
+   */
+  void LogLikelihoods(const MatType& data, arma::mat& logLikelihoods) const;
+
   //! Get the sample means for each class.
   const MatType& Means() const { return means; }
   //! Modify the sample means for each class.
@@ -107,6 +174,9 @@ class NaiveBayesClassifier
   const arma::vec& Probabilities() const { return probabilities; }
   //! Modify the prior probabilities for each class.
   arma::vec& Probabilities() { return probabilities; }
+
+  //! Get the number of training points of each class.
+  const arma::vec& Counts() const { return counts; }
 };
 
 }; // namespace naive_bayes
@@ -13,91 +13,214 @@
 
 #include <mlpack/core.hpp>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 // In case it hasn't been included already.
 #include "naive_bayes_classifier.hpp"
 
 namespace mlpack {
 namespace naive_bayes {
 
+template<typename MatType>
+NaiveBayesClassifier<MatType>::NaiveBayesClassifier(
+    const size_t dimensionality,
+    const size_t classes)
+{
+  probabilities.zeros(classes);
+  counts.zeros(classes);
+  means.zeros(dimensionality, classes);
+  variances.zeros(dimensionality, classes);
+}
+
 template<typename MatType>
 NaiveBayesClassifier<MatType>::NaiveBayesClassifier(
     const MatType& data,
     const arma::Col<size_t>& labels,
     const size_t classes,
     const bool incrementalVariance)
+{
+  probabilities.zeros(classes);
+  counts.zeros(classes);
+  means.zeros(data.n_rows, classes);
+  variances.zeros(data.n_rows, classes);
+
+  Train(data, labels, incrementalVariance);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Train(const MatType& data,
+                                          const arma::Col<size_t>& labels,
+                                          const bool incrementalVariance)
 {
   const size_t dimensionality = data.n_rows;
+  const size_t classes = means.n_cols;
 
-  // Update the variables according to the number of features and classes
-  // present in the data.
-  probabilities.zeros(classes);
-  means.zeros(dimensionality, classes);
-  variances.zeros(dimensionality, classes);
+  if (data.n_rows != means.n_rows)
+  {
+    Log::Fatal << "NaiveBayesClassifier::Train(): data has dimensionality "
+        << data.n_rows << ", but the classifier has dimensionality "
+        << means.n_rows << "!" << std::endl;
+  }
+  if (labels.n_elem != data.n_cols)
+  {
+    Log::Fatal << "NaiveBayesClassifier::Train(): " << labels.n_elem
+        << " labels given for " << data.n_cols << " points!" << std::endl;
+  }
+  if (data.n_cols == 0)
+    return;
+  if (labels.max() >= classes)
+  {
+    Log::Fatal << "NaiveBayesClassifier::Train(): label " << labels.max()
+        << " is not less than the number of classes (" << classes << ")!"
+        << std::endl;
+  }
 
   Log::Info << "Training Naive Bayes classifier on " << data.n_cols
       << " examples with " << dimensionality << " features each." << std::endl;
 
-  // Calculate the class probabilities as well as the sample mean and variance
-  // for each of the features with respect to each of the labels.
+  // Every thread summarizes a contiguous block of the points: the number of
+  // points, the mean, and the sum of squared deviations from the mean of each
+  // class.  The summaries of the blocks are merged as they are finished.
+  arma::vec batchCounts;
+  batchCounts.zeros(classes);
+  MatType batchMeans, batchDeviations;
+  batchMeans.zeros(dimensionality, classes);
+  batchDeviations.zeros(dimensionality, classes);
+
+  #pragma omp parallel
+  {
+    size_t begin = 0;
+    size_t end = data.n_cols;
+#ifdef _OPENMP
+    const size_t threads = omp_get_num_threads();
+    const size_t thread = omp_get_thread_num();
+    begin = (data.n_cols * thread) / threads;
+    end = (data.n_cols * (thread + 1)) / threads;
+#endif
+
+    arma::vec blockCounts;
+    MatType blockMeans, blockDeviations;
+    BlockStatistics(data, labels, classes, begin, end, incrementalVariance,
+        blockCounts, blockMeans, blockDeviations);
+
+    #pragma omp critical(nbc_train)
+    MergeStatistics(blockCounts, blockMeans, blockDeviations, batchCounts,
+        batchMeans, batchDeviations);
+  }
+
+  // Now merge the batch into the points seen before, whose sums of squared
+  // deviations are recovered from the variances.
+  MatType deviations(dimensionality, classes);
+  for (size_t i = 0; i < classes; ++i)
+  {
+    if (counts[i] > 1)
+      deviations.col(i) = variances.col(i) * (counts[i] - 1);
+    else
+      deviations.col(i).zeros();
+  }
+  MergeStatistics(batchCounts, batchMeans, batchDeviations, counts, means,
+      deviations);
+
+  // Normalize variances.
+  variances = deviations;
+  for (size_t i = 0; i < classes; ++i)
+    if (counts[i] > 1)
+      variances.col(i) /= (counts[i] - 1);
+
+  // Ensure that the variances are invertible.
+  for (size_t i = 0; i < variances.n_elem; ++i)
+    if (variances[i] == 0.0)
+      variances[i] = 1e-50;
+
+  probabilities = counts / arma::accu(counts);
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::BlockStatistics(
+    const MatType& data,
+    const arma::Col<size_t>& labels,
+    const size_t classes,
+    const size_t begin,
+    const size_t end,
+    const bool incrementalVariance,
+    arma::vec& blockCounts,
+    MatType& blockMeans,
+    MatType& blockDeviations)
+{
+  blockCounts.zeros(classes);
+  blockMeans.zeros(data.n_rows, classes);
+  blockDeviations.zeros(data.n_rows, classes);
+
   if (incrementalVariance)
   {
     // Use incremental algorithm.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    for (size_t j = begin; j < end; ++j)
     {
       const size_t label = labels[j];
-      ++probabilities[label];
-
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
-    }
+      ++blockCounts[label];
 
-    for (size_t i = 0; i < classes; ++i)
-    {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
+      arma::vec delta = data.col(j) - blockMeans.col(label);
+      blockMeans.col(label) += delta / blockCounts[label];
+      blockDeviations.col(label) += delta % (data.col(j) -
+          blockMeans.col(label));
     }
   }
   else
   {
     // Don't use incremental algorithm.  This is a two-pass algorithm.  It is
     // possible to calculate the means and variances using a faster one-pass
-    // algorithm but there are some precision and stability issues.  If this is
-    // too slow, it's an option to use the faster algorithm by default and then
-    // have this (and the incremental algorithm) be other options.
+    // algorithm but there are some precision and stability issues.
 
     // Calculate the means.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    for (size_t j = begin; j < end; ++j)
     {
       const size_t label = labels[j];
-      ++probabilities[label];
-      means.col(label) += data.col(j);
+      ++blockCounts[label];
+      blockMeans.col(label) += data.col(j);
     }
 
     // Normalize means.
     for (size_t i = 0; i < classes; ++i)
-      if (probabilities[i] != 0.0)
-        means.col(i) /= probabilities[i];
+      if (blockCounts[i] != 0.0)
+        blockMeans.col(i) /= blockCounts[i];
 
-    // Calculate variances.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    // Calculate squared deviations.
+    for (size_t j = begin; j < end; ++j)
     {
       const size_t label = labels[j];
-      variances.col(label) += square(data.col(j) - means.col(label));
+      blockDeviations.col(label) += square(data.col(j) -
+          blockMeans.col(label));
     }
-
-    // Normalize variances.
-    for (size_t i = 0; i < classes; ++i)
-      if (probabilities[i] > 1)
-        variances.col(i) /= (probabilities[i] - 1);
   }
+}
 
-  // Ensure that the variances are invertible.
-  for (size_t i = 0; i < variances.n_elem; ++i)
-    if (variances[i] == 0.0)
-      variances[i] = 1e-50;
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::MergeStatistics(
+    const arma::vec& blockCounts,
+    const MatType& blockMeans,
+    const MatType& blockDeviations,
+    arma::vec& totalCounts,
+    MatType& totalMeans,
+    MatType& totalDeviations)
+{
+  // The pairwise update of Chan, Golub and LeVeque: the deviations of the union
+  // are those of both sets plus a correction for the difference of the means.
+  for (size_t i = 0; i < blockCounts.n_elem; ++i)
+  {
+    if (blockCounts[i] == 0.0)
+      continue;
 
-  probabilities /= data.n_cols;
+    const double n = totalCounts[i];
+    const double m = blockCounts[i];
+    const arma::vec delta = blockMeans.col(i) - totalMeans.col(i);
+
+    totalMeans.col(i) += (m / (n + m)) * delta;
+    totalDeviations.col(i) += blockDeviations.col(i) + (n * m / (n + m)) *
+        square(delta);
+    totalCounts[i] = n + m;
+  }
 }
 
 template<typename MatType>
@@ -108,46 +231,62 @@ void NaiveBayesClassifier<MatType>::Classify(const MatType& data,
   // training data.
   Log::Assert(data.n_rows == means.n_rows);
 
-  arma::vec probs = arma::log(probabilities);
-  arma::mat invVar = 1.0 / variances;
-
-  arma::mat testProbs = arma::repmat(probs.t(), data.n_cols, 1);
-
   results.set_size(data.n_cols); // No need to fill with anything yet.
 
   Log::Info << "Running Naive Bayes classifier on " << data.n_cols
       << " data points with " << data.n_rows << " features each." << std::endl;
 
-  // Calculate the joint probability for each of the data points for each of the
-  // means.n_cols.
-
-  // Loop over every class.
-  for (size_t i = 0; i < means.n_cols; i++)
-  {
-    // This is an adaptation of gmm::phi() for the case where the covariance is
-    // a diagonal matrix.
-    arma::mat diffs = data - arma::repmat(means.col(i), 1, data.n_cols);
-    arma::mat rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
-    arma::vec exponents(diffs.n_cols);
-    for (size_t j = 0; j < diffs.n_cols; ++j)
-      exponents(j) = std::exp(arma::accu(diffs.col(j) % rhs.unsafe_col(j)));
-
-    testProbs.col(i) += log(pow(2 * M_PI, (double) data.n_rows / -2.0) *
-        pow(det(arma::diagmat(invVar.col(i))), -0.5) * exponents);
-  }
+  arma::mat logLikelihoods;
+  LogLikelihoods(data, logLikelihoods);
 
-  // Now calculate the label.
+  // Now calculate the label: the class with maximum probability for each point.
   for (size_t i = 0; i < data.n_cols; ++i)
   {
-    // Find the index of the class with maximum probability for this point.
     arma::uword maxIndex = 0;
-    arma::vec pointProbs = testProbs.row(i).t();
-    pointProbs.max(maxIndex);
-
+    logLikelihoods.unsafe_col(i).max(maxIndex);
     results[i] = maxIndex;
   }
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::LogLikelihoods(
+    const MatType& data,
+    arma::mat& logLikelihoods) const
+{
+  Log::Assert(data.n_rows == means.n_rows);
+
+  // This is an adaptation of gmm::phi() for the case where the covariance is a
+  // diagonal matrix, in the log domain so that distant points don't underflow:
+  // log P(y) - (1 / 2) (d log(2 pi) + sum_k log(var_yk)) -
+  // (1 / 2) sum_k (x_k - mu_yk)^2 / var_yk.  Everything except the last term
+  // depends only on the class.
+  const arma::mat invVar = 1.0 / variances;
+  const arma::vec constants = arma::log(probabilities) - 0.5 *
+      (data.n_rows * std::log(2 * M_PI) + arma::trans(arma::sum(
+      arma::log(variances), 0)));
+
+  // The last term is a weighted sum of the squared differences, for every
+  // class; the points are handled a chunk at a time, to not copy all of them.
+  // The squared differences aren't expanded (into x^2 - 2 mu x + mu^2, which
+  // would turn every class into one matrix product) because that loses all
+  // precision for the features with (nearly) zero variance.
+  const size_t chunkSize = 1024;
+  arma::mat result(means.n_cols, data.n_cols);
+  MatType diffs;
+  for (size_t begin = 0; begin < data.n_cols; begin += chunkSize)
+  {
+    const size_t end = std::min(begin + chunkSize, (size_t) data.n_cols);
+    for (size_t i = 0; i < means.n_cols; ++i)
+    {
+      diffs = data.cols(begin, end - 1);
+      diffs.each_col() -= means.col(i);
+      result.submat(i, begin, i, end - 1) = -0.5 *
+          arma::trans(invVar.col(i)) * arma::square(diffs);
+    }
+  }
 
-  return;
+  result.each_col() += constants;
+  logLikelihoods.swap(result);
 }
 
 }; // namespace naive_bayes
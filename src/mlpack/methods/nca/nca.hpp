@@ -77,6 +77,13 @@ class NCA
   //! Get the labels reference.
   const arma::Col<size_t>& Labels() const { return labels; }
 
+  //! Get the error function.
+  const SoftmaxErrorFunction<MetricType>& ErrorFunction() const
+  { return errorFunction; }
+  //! Modify the error function (for instance, to truncate its sums to the
+  //! nearest neighbors of each point).
+  SoftmaxErrorFunction<MetricType>& ErrorFunction() { return errorFunction; }
+
   //! Get the optimizer.
   const OptimizerType<SoftmaxErrorFunction<MetricType> >& Optimizer() const
   { return optimizer; }
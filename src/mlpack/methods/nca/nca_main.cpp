@@ -90,6 +90,13 @@ PARAM_INT("max_line_search_trials", "Maximum number of line search trials for "
 PARAM_DOUBLE("min_step", "Minimum step of line search for L-BFGS.", "m", 1e-20);
 PARAM_DOUBLE("max_step", "Maximum step of line search for L-BFGS.", "M", 1e20);
 
+PARAM_INT("neighbors", "If nonzero, only consider this many nearest neighbors "
+    "of each point (in the space of the current distance) in the objective, "
+    "which is much faster for large datasets.", "k", 0);
+PARAM_INT("refresh_interval", "How often the nearest neighbors are recomputed "
+    "when --neighbors is given: after this many passes over the dataset for "
+    "SGD, or this many iterations for L-BFGS.", "r", 10);
+
 PARAM_INT("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 
@@ -170,6 +177,16 @@ int main(int argc, char* argv[])
   const double minStep = CLI::GetParam<double>("min_step");
   const double maxStep = CLI::GetParam<double>("max_step");
 
+  if (CLI::GetParam<int>("neighbors") < 0)
+    Log::Fatal << "Invalid number of neighbors " << CLI::GetParam<int>(
+        "neighbors") << "; must be greater than or equal to 0." << endl;
+  if (CLI::GetParam<int>("refresh_interval") <= 0)
+    Log::Fatal << "Invalid refresh interval " << CLI::GetParam<int>(
+        "refresh_interval") << "; must be greater than 0." << endl;
+  const size_t neighbors = (size_t) CLI::GetParam<int>("neighbors");
+  const size_t refreshInterval = (size_t) CLI::GetParam<int>(
+      "refresh_interval");
+
   // Load data.
   arma::mat data;
   data::Load(inputFile, data, true);
@@ -223,6 +240,8 @@ int main(int argc, char* argv[])
   if (optimizerType == "sgd")
   {
     NCA<LMetric<2> > nca(data, labels);
+    nca.ErrorFunction().Neighbors() = neighbors;
+    nca.ErrorFunction().RefreshInterval() = refreshInterval;
     nca.Optimizer().StepSize() = stepSize;
     nca.Optimizer().MaxIterations() = maxIterations;
     nca.Optimizer().Tolerance() = tolerance;
@@ -233,6 +252,8 @@ int main(int argc, char* argv[])
   else if (optimizerType == "lbfgs")
   {
     NCA<LMetric<2>, L_BFGS> nca(data, labels);
+    nca.ErrorFunction().Neighbors() = neighbors;
+    nca.ErrorFunction().RefreshInterval() = refreshInterval;
     nca.Optimizer().NumBasis() = numBasis;
     nca.Optimizer().MaxIterations() = maxIterations;
     nca.Optimizer().ArmijoConstant() = armijoConstant;
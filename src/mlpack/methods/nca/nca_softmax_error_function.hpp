@@ -9,6 +9,7 @@
 #define __MLPACK_METHODS_NCA_NCA_SOFTMAX_ERROR_FUNCTION_HPP
 
 #include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 namespace mlpack {
 namespace nca {
@@ -32,6 +33,15 @@ namespace nca {
  * optimizers use, overloads of Evaluate() and Gradient() are given which only
  * operate on one point in the dataset.  This is useful for optimizers like
  * stochastic gradient descent (see mlpack::optimization::SGD).
+ *
+ * Each p_i sums over every other point, so the non-separable functions take
+ * O(n^2) time and the separable ones O(n).  Since exp(-d) vanishes quickly, the
+ * sums can be truncated to the k nearest neighbors of each point in the
+ * stretched space, A x; this is what happens when a number of neighbors is
+ * given.  The neighbors are found with a tree (mlpack::neighbor::AllkNN, so
+ * they are the nearest in the Euclidean sense) and refreshed after the given
+ * number of non-separable evaluations at new coordinates, or after the given
+ * number of passes of separable evaluations over the dataset.
  */
 template<typename MetricType = metric::SquaredEuclideanDistance>
 class SoftmaxErrorFunction
@@ -46,10 +56,15 @@ class SoftmaxErrorFunction
    * @param dataset Matrix containing the dataset.
    * @param labels Vector of class labels for each point in the dataset.
    * @param kernel Instantiated kernel (optional).
+   * @param neighbors Number of nearest neighbors each p_i sums over (0 means
+   *     all the other points).
+   * @param refreshInterval How often the nearest neighbors are recomputed.
    */
   SoftmaxErrorFunction(const arma::mat& dataset,
                        const arma::Col<size_t>& labels,
-                       MetricType metric = MetricType());
+                       MetricType metric = MetricType(),
+                       const size_t neighbors = 0,
+                       const size_t refreshInterval = 10);
 
   /**
    * Evaluate the softmax function for the given covariance matrix.  This is the
@@ -108,6 +123,16 @@ class SoftmaxErrorFunction
    */
   size_t NumFunctions() const { return dataset.n_cols; }
 
+  //! Get the number of neighbors each p_i sums over (0 means all points).
+  size_t Neighbors() const { return neighbors; }
+  //! Modify the number of neighbors each p_i sums over (0 means all points).
+  size_t& Neighbors() { return neighbors; }
+
+  //! Get how often the nearest neighbors are recomputed.
+  size_t RefreshInterval() const { return refreshInterval; }
+  //! Modify how often the nearest neighbors are recomputed.
+  size_t& RefreshInterval() { return refreshInterval; }
+
   // convert the obkect into a string
   std::string ToString() const;
 
@@ -133,6 +158,58 @@ class SoftmaxErrorFunction
   //! False if nothing has ever been precalculated (only at construction time).
   bool precalculated;
 
+  //! The number of neighbors each p_i sums over (0 means all points).
+  size_t neighbors;
+  //! How often the nearest neighbors are recomputed.
+  size_t refreshInterval;
+  //! Nearest neighbors of each point in the stretched space (one per column).
+  arma::umat neighborhoods;
+  //! Evaluations since the nearest neighbors were last computed.
+  size_t evaluations;
+  //! Coordinates the whole stretched dataset was last computed with.
+  arma::mat stretchedCoordinates;
+
+  //! Return whether or not the sums are truncated to the nearest neighbors.
+  bool Truncated() const
+  { return (neighbors > 0) && (neighbors + 1 < dataset.n_cols); }
+
+  /**
+   * Count an evaluation and return whether or not the nearest neighbors have
+   * to be recomputed: if they were never computed, if the number of neighbors
+   * changed, or if the given number of evaluations has been reached since they
+   * were last computed.
+   */
+  bool NeighborsDue(const size_t interval);
+
+  //! Compute the nearest neighbors of each point in the stretched dataset.
+  void ComputeNeighbors(const arma::mat& stretched);
+
+  //! Compute stretchedDataset, unless it was computed for these coordinates.
+  void Stretch(const arma::mat& coordinates);
+
+  /**
+   * Compute exp(-D(A x_i, A x_k)) for every point k that p_i sums over (all
+   * the other points, or the nearest neighbors of point i), from the stretched
+   * dataset, which must be up to date.  This is safe to call in parallel.
+   *
+   * @param i Index of the point.
+   * @param candidates Indices of the points p_i sums over.
+   * @param evals exp(-D(A x_i, A x_k)) for each of those points.
+   */
+  void Evaluations(const size_t i,
+                   arma::uvec& candidates,
+                   arma::vec& evals) const;
+
+  /**
+   * Compute the same as Evaluations() for the separable Evaluate() and
+   * Gradient().  When the sums are truncated, only point i and its neighbors
+   * are stretched, instead of the whole dataset.
+   */
+  void SeparableEvaluations(const arma::mat& coordinates,
+                            const size_t i,
+                            arma::uvec& candidates,
+                            arma::vec& evals);
+
   /**
    * Precalculate the denominators and numerators that will make up the p_ij,
    * but only if the coordinates matrix is different than the last coordinates
@@ -141,8 +218,8 @@ class SoftmaxErrorFunction
    *
    * This will update last_coordinates_ and stretched_dataset_, and also
    * calculate the p_i and denominators_ which are used in the calculation of
-   * p_i or p_ij.  The calculation will be O((n * (n + 1)) / 2), which is not
-   * great.
+   * p_i or p_ij.  The calculation will be O(n^2), which is not great, unless
+   * the sums are truncated to the nearest neighbors; it is run in parallel.
    *
    * @param coordinates Coordinates matrix to use for precalculation.
    */
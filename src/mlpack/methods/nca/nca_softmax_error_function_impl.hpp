@@ -18,11 +18,16 @@ template<typename MetricType>
 SoftmaxErrorFunction<MetricType>::SoftmaxErrorFunction(
     const arma::mat& dataset,
     const arma::Col<size_t>& labels,
-    MetricType metric) :
+    MetricType metric,
+    const size_t neighbors,
+    const size_t refreshInterval) :
     dataset(dataset),
     labels(labels),
     metric(metric),
-    precalculated(false)
+    precalculated(false),
+    neighbors(neighbors),
+    refreshInterval(refreshInterval),
+    evaluations(0)
 { /* nothing to do */ }
 
 //! The non-separable implementation, which uses Precalculate() to save time.
@@ -42,28 +47,21 @@ double SoftmaxErrorFunction<MetricType>::Evaluate(const arma::mat& coordinates,
                                                   const size_t i)
 {
   // Unfortunately each evaluation will take O(N) time because it requires a
-  // scan over all points in the dataset.  Our objective is to compute p_i.
+  // scan over all points in the dataset (unless the sums are truncated).  Our
+  // objective is to compute p_i.
+  arma::uvec candidates;
+  arma::vec evals;
+  SeparableEvaluations(coordinates, i, candidates, evals);
+
   double denominator = 0;
   double numerator = 0;
-
-  // It's quicker to do this now than one point at a time later.
-  stretchedDataset = coordinates * dataset;
-
-  for (size_t k = 0; k < dataset.n_cols; ++k)
+  for (size_t k = 0; k < candidates.n_elem; ++k)
   {
-    // Don't consider the case where the points are the same.
-    if (k == i)
-      continue;
+    // If they are in the same class, add to the numerator.
+    if (labels[i] == labels[candidates[k]])
+      numerator += evals[k];
 
-    // We want to evaluate exp(-D(A x_i, A x_k)).
-    double eval = std::exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                            stretchedDataset.unsafe_col(k)));
-
-    // If they are in the same
-    if (labels[i] == labels[k])
-      numerator += eval;
-
-    denominator += eval;
+    denominator += evals[k];
   }
 
   // Now the result is just a simple division, but we have to be sure that the
@@ -89,39 +87,59 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   // Now, we handle the summation over i:
   //   sum_i (p_i sum_k (p_ik x_ik x_ik^T) -
   //       sum_{j in class of i} (p_ij x_ij x_ij^T)
-  // We can algebraically manipulate the whole thing to produce a more
-  // memory-friendly way to calculate this.  Looping over each i and k (again
-  // O((n * (n + 1)) / 2) as with the last step, we can add the following to the
-  // sum:
+  // which is sum_i sum_k w_ik x_ik x_ik^T, where w_ik = (p_i - 1) p_ik if the
+  // class of i is the same as the class of k, and p_i p_ik otherwise.  Instead
+  // of adding the outer products one at a time, expand x_ik x_ik^T: with
+  // s_i = sum_k w_ik, t_k = sum_i w_ik and z_i = sum_k w_ik x_k, the sum is
   //
-  //   if class of i is the same as the class of k, add
-  //     (((p_i - (1 / p_i)) p_ik) + ((p_k - (1 / p_k)) p_ki)) x_ik x_ik^T
-  //   otherwise, add
-  //     (p_i p_ik + p_k p_ki) x_ik x_ik^T
-  arma::mat sum;
-  sum.zeros(stretchedDataset.n_rows, stretchedDataset.n_rows);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  //   X diag(s + t) X^T - X Z^T - Z X^T,
+  //
+  // so only O(n) vectors have to be computed, and the rest is made of matrix
+  // products.  The sum doesn't change if the points are translated, so they
+  // are centered first, to avoid cancellation.
+  const size_t n = dataset.n_cols;
+  arma::mat centered = dataset;
+  centered.each_col() -= arma::mean(dataset, 1);
+
+  arma::vec weightSums(n);
+  arma::mat z(dataset.n_rows, n);
+  arma::vec columnSums;
+  columnSums.zeros(n);
+
+  #pragma omp parallel
   {
-    for (size_t k = (i + 1); k < stretchedDataset.n_cols; k++)
+    arma::vec localColumnSums;
+    localColumnSums.zeros(n);
+    arma::uvec candidates;
+    arma::vec evals;
+
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < n; ++i)
     {
-      // Calculate p_ik and p_ki first.
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(k)));
-      double p_ik = 0, p_ki = 0;
-      p_ik = eval / denominators(i);
-      p_ki = eval / denominators(k);
-
-      // Subtract x_i from x_k.  We are not using stretched points here.
-      arma::vec x_ik = dataset.col(i) - dataset.col(k);
-      arma::mat secondTerm = (x_ik * trans(x_ik));
-
-      if (labels[i] == labels[k])
-        sum += ((p[i] - 1) * p_ik + (p[k] - 1) * p_ki) * secondTerm;
-      else
-        sum += (p[i] * p_ik + p[k] * p_ki) * secondTerm;
+      Evaluations(i, candidates, evals);
+
+      // Turn exp(-D(A x_i, A x_k)) into w_ik.
+      for (size_t k = 0; k < candidates.n_elem; ++k)
+      {
+        const double p_ik = evals[k] / denominators[i];
+        evals[k] = (labels[i] == labels[candidates[k]]) ? (p[i] - 1) * p_ik :
+            p[i] * p_ik;
+        localColumnSums[candidates[k]] += evals[k];
+      }
+
+      weightSums[i] = arma::accu(evals);
+      z.col(i) = centered.cols(candidates) * evals;
     }
+
+    #pragma omp critical(nca_gradient)
+    columnSums += localColumnSums;
   }
 
+  const arma::mat cross = centered * trans(z);
+  arma::mat weighted = centered;
+  weighted.each_row() %= trans(weightSums + columnSums);
+  arma::mat sum = weighted * trans(centered) - cross - trans(cross);
+
   // Assemble the final gradient.
   gradient = -2 * coordinates * sum;
 }
@@ -132,50 +150,20 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
                                                 const size_t i,
                                                 arma::mat& gradient)
 {
-  // We will need to calculate p_i before this evaluation is done, so these two
-  // variables will hold the information necessary for that.
+  arma::uvec candidates;
+  arma::vec evals;
+  SeparableEvaluations(coordinates, i, candidates, evals);
+
+  // We will need to calculate p_i before this evaluation is done.
   double numerator = 0;
   double denominator = 0;
-
-  // The gradient involves two matrix terms which are eventually combined into
-  // one.
-  arma::mat firstTerm;
-  arma::mat secondTerm;
-
-  firstTerm.zeros(coordinates.n_rows, coordinates.n_cols);
-  secondTerm.zeros(coordinates.n_rows, coordinates.n_cols);
-
-  // Compute the stretched dataset.
-  stretchedDataset = coordinates * dataset;
-
-  for (size_t k = 0; k < dataset.n_cols; ++k)
+  for (size_t k = 0; k < candidates.n_elem; ++k)
   {
-    // Don't consider the case where the points are the same.
-    if (i == k)
-      continue;
-
-    // Calculate the numerator of p_ik.
-    double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                       stretchedDataset.unsafe_col(k)));
-
-    // If the points are in the same class, we must add to the second term of
-    // the gradient as well as the numerator of p_i.  We will divide by the
-    // denominator of p_ik later.  For x_ik we are not using stretched points.
-    arma::vec x_ik = dataset.col(i) - dataset.col(k);
-    if (labels[i] == labels[k])
-    {
-      numerator += eval;
-      secondTerm += eval * x_ik * trans(x_ik);
-    }
-
-    // We always have to add to the denominator of p_i and the first term of the
-    // gradient computation.  We will divide by the denominator of p_ik later.
-    denominator += eval;
-    firstTerm += eval * x_ik * trans(x_ik);
+    if (labels[i] == labels[candidates[k]])
+      numerator += evals[k];
+    denominator += evals[k];
   }
 
-  // Calculate p_i.
-  double p = 0;
   if (denominator == 0)
   {
     Log::Warn << "Denominator of p_" << i << " is 0!" << std::endl;
@@ -184,16 +172,26 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
     gradient.zeros(coordinates.n_rows, coordinates.n_rows);
     return;
   }
-  else
+
+  // The gradient is
+  //   p_i sum_k (p_ik x_ik x_ik^T) - sum_{k in class of i} (p_ik x_ik x_ik^T),
+  // so with the weights p_ik (p_i - 1) or p_ik p_i, it is one matrix product
+  // of the differences x_ik (we are not using stretched points here).
+  const double p = numerator / denominator;
+  for (size_t k = 0; k < candidates.n_elem; ++k)
   {
-    p = numerator / denominator;
-    firstTerm /= denominator;
-    secondTerm /= denominator;
+    evals[k] /= denominator;
+    evals[k] *= (labels[i] == labels[candidates[k]]) ? (p - 1) : p;
   }
 
-  // Now multiply the first term by p_i, and add the two together and multiply
-  // all by 2 * A.  We negate it though, because our optimizer is a minimizer.
-  gradient = -2 * coordinates * (p * firstTerm - secondTerm);
+  arma::mat differences = dataset.cols(candidates);
+  differences.each_col() -= dataset.col(i);
+  arma::mat weighted = differences;
+  weighted.each_row() %= trans(evals);
+
+  // Multiply all by 2 * A.  We negate it though, because our optimizer is a
+  // minimizer.
+  gradient = -2 * coordinates * (weighted * trans(differences));
 }
 
 template<typename MetricType>
@@ -206,44 +204,51 @@ template<typename MetricType>
 void SoftmaxErrorFunction<MetricType>::Precalculate(
     const arma::mat& coordinates)
 {
+  // The separable functions may have stretched the dataset with other
+  // coordinates in the meantime.
+  Stretch(coordinates);
+
   // Ensure it is the right size.
   lastCoordinates.set_size(coordinates.n_rows, coordinates.n_cols);
 
   // Make sure the calculation is necessary.
   if ((accu(coordinates == lastCoordinates) == coordinates.n_elem) &&
-      precalculated)
+      precalculated && (!Truncated() || (neighborhoods.n_rows == neighbors)))
     return; // No need to calculate; we already have this stuff saved.
 
-  // Coordinates are different; save the new ones, and stretch the dataset.
+  // Coordinates are different; save the new ones.
   lastCoordinates = coordinates;
-  stretchedDataset = coordinates * dataset;
+  if (Truncated() && NeighborsDue(refreshInterval))
+    ComputeNeighbors(stretchedDataset);
 
   // For each point i, we must evaluate the softmax function:
   //   p_ij = exp( -K(x_i, x_j) ) / ( sum_{k != i} ( exp( -K(x_i, x_k) )))
   //   p_i = sum_{j in class of i} p_ij
   // We will do this by keeping track of the denominators for each i as well as
-  // the numerators (the sum for all j in class of i).  This will be on the
-  // order of O((n * (n + 1)) / 2), which really isn't all that great.
-  p.zeros(stretchedDataset.n_cols);
-  denominators.zeros(stretchedDataset.n_cols);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  // the numerators (the sum for all j in class of i).  Each point is handled
+  // on its own, so that the points can be split between threads; when the sums
+  // are not truncated, this is O(n^2), which really isn't all that great.
+  const size_t n = stretchedDataset.n_cols;
+  p.set_size(n);
+  denominators.set_size(n);
+
+  #pragma omp parallel
   {
-    for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
+    arma::uvec candidates;
+    arma::vec evals;
+
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < n; ++i)
     {
-      // Evaluate exp(-d(x_i, x_j)).
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(j)));
+      Evaluations(i, candidates, evals);
 
-      // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
-      denominators[i] += eval;
-      denominators[j] += eval;
+      double numerator = 0;
+      for (size_t k = 0; k < candidates.n_elem; ++k)
+        if (labels[i] == labels[candidates[k]])
+          numerator += evals[k];
 
-      // If i and j are the same class, add to numerator of both.
-      if (labels[i] == labels[j])
-      {
-        p[i] += eval;
-        p[j] += eval;
-      }
+      p[i] = numerator;
+      denominators[i] = arma::accu(evals);
     }
   }
 
@@ -267,6 +272,104 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   precalculated = true;
 }
 
+template<typename MetricType>
+bool SoftmaxErrorFunction<MetricType>::NeighborsDue(const size_t interval)
+{
+  if ((neighborhoods.n_rows != neighbors) ||
+      (neighborhoods.n_cols != dataset.n_cols))
+    return true;
+
+  return (++evaluations >= interval);
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::ComputeNeighbors(
+    const arma::mat& stretched)
+{
+  // The points themselves are not returned as their own neighbors.
+  neighbor::AllkNN neighborSearch(stretched);
+  arma::Mat<size_t> neighborIndices;
+  arma::mat distances;
+  neighborSearch.Search(neighbors, neighborIndices, distances);
+
+  neighborhoods = arma::conv_to<arma::umat>::from(neighborIndices);
+  evaluations = 0;
+
+  // The precalculated p_i were summed over the old neighbors.
+  precalculated = false;
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::Stretch(const arma::mat& coordinates)
+{
+  if ((stretchedCoordinates.n_rows == coordinates.n_rows) &&
+      (stretchedCoordinates.n_cols == coordinates.n_cols) &&
+      (accu(coordinates == stretchedCoordinates) == coordinates.n_elem))
+    return;
+
+  stretchedCoordinates = coordinates;
+  stretchedDataset = coordinates * dataset;
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::Evaluations(const size_t i,
+                                                   arma::uvec& candidates,
+                                                   arma::vec& evals) const
+{
+  if (Truncated())
+  {
+    candidates = neighborhoods.col(i);
+  }
+  else
+  {
+    // Don't consider the case where the points are the same.
+    candidates.set_size(dataset.n_cols - 1);
+    for (size_t k = 0; k < candidates.n_elem; ++k)
+      candidates[k] = (k < i) ? k : k + 1;
+  }
+
+  // We want to evaluate exp(-D(A x_i, A x_k)).
+  evals.set_size(candidates.n_elem);
+  for (size_t k = 0; k < candidates.n_elem; ++k)
+    evals[k] = std::exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
+        stretchedDataset.unsafe_col(candidates[k])));
+}
+
+template<typename MetricType>
+void SoftmaxErrorFunction<MetricType>::SeparableEvaluations(
+    const arma::mat& coordinates,
+    const size_t i,
+    arma::uvec& candidates,
+    arma::vec& evals)
+{
+  if (!Truncated())
+  {
+    // It's quicker to stretch the whole dataset once than one point at a time
+    // later, and it is kept until the coordinates change.
+    Stretch(coordinates);
+    Evaluations(i, candidates, evals);
+    return;
+  }
+
+  // The neighbors are refreshed after the given number of passes over the
+  // dataset.
+  if (NeighborsDue(refreshInterval * dataset.n_cols))
+  {
+    const arma::mat stretched = coordinates * dataset;
+    ComputeNeighbors(stretched);
+  }
+
+  // Only point i and its neighbors have to be stretched.
+  candidates = neighborhoods.col(i);
+  const arma::vec stretchedPoint = coordinates * dataset.col(i);
+  const arma::mat stretchedNeighbors = coordinates * dataset.cols(candidates);
+
+  evals.set_size(candidates.n_elem);
+  for (size_t k = 0; k < candidates.n_elem; ++k)
+    evals[k] = std::exp(-metric.Evaluate(stretchedPoint,
+        stretchedNeighbors.unsafe_col(k)));
+}
+
 template<typename MetricType>
 std::string SoftmaxErrorFunction<MetricType>::ToString() const{
   std::ostringstream convert;
@@ -276,6 +379,7 @@ std::string SoftmaxErrorFunction<MetricType>::ToString() const{
   convert << "  Labels: " << labels.n_elem << std::endl;
   //convert << "Metric: " << metric << std::endl;
   convert << "  Precalculated: " << precalculated << std::endl;
+  convert << "  Neighbors: " << neighbors << std::endl;
   return convert.str();
 }
 
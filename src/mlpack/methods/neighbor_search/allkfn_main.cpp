@@ -11,7 +11,12 @@
 #include <fstream>
 #include <iostream>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 #include "neighbor_search.hpp"
+#include "stream_search.hpp"
 #include "unmap.hpp"
 
 using namespace std;
@@ -54,6 +59,17 @@ PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
 PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
     "(experimental, may be slow.).", "T");
+PARAM_DOUBLE("epsilon", "If greater than 0, perform approximate search: each "
+    "returned distance is at least the true k'th-neighbor distance divided by "
+    "(1 + epsilon), which allows much more pruning on high-dimensional data.",
+    "e", 0.0);
+PARAM_INT("block_size", "If positive, stream the query points from "
+    "--query_file in blocks of this many points against the resident reference "
+    "tree, writing the results of each block to the output files as soon as it "
+    "is done; the output files must then be Armadillo binary files (.bin).",
+    "b", 0);
+PARAM_INT("threads", "Number of threads to use for single-tree search (0 "
+    "uses all available cores; ignored without OpenMP).", "t", 0);
 
 int main(int argc, char *argv[])
 {
@@ -89,7 +105,9 @@ int main(int argc, char *argv[])
     Log::Fatal << referenceData.n_cols << ")." << endl;
   }
 
-  if (CLI::GetParam<string>("query_file") != "")
+  // In streaming mode, the query set is only read block by block.
+  const int blockSize = CLI::GetParam<int>("block_size");
+  if (CLI::GetParam<string>("query_file") != "" && blockSize <= 0)
   {
     string queryFile = CLI::GetParam<string>("query_file");
     data::Load(queryFile, queryData, true);
@@ -103,12 +121,62 @@ int main(int argc, char *argv[])
   }
   size_t leafSize = lsInt;
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP "
+        << "support." << endl;
+#endif
+
   // Naive mode overrides single mode.
   if (singleMode && naive)
   {
     Log::Warn << "--single_mode ignored because --naive is present." << endl;
   }
 
+  // Sanity check on epsilon.
+  const double epsilon = CLI::GetParam<double>("epsilon");
+  if (epsilon < 0)
+  {
+    Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be greater than "
+        << "or equal to 0." << endl;
+  }
+  if (epsilon > 0 && naive)
+    Log::Warn << "--epsilon ignored because --naive is present." << endl;
+
+  // In streaming mode, the reference tree is built once, and the query set is
+  // read and searched in blocks.
+  if (blockSize != 0)
+  {
+    if (blockSize < 0)
+    {
+      Log::Fatal << "Invalid block size: " << blockSize << ".  Must be greater "
+          << "than or equal to 0." << endl;
+    }
+    if (CLI::GetParam<string>("query_file") == "")
+      Log::Fatal << "--block_size requires --query_file." << endl;
+    if (CLI::HasParam("r_tree"))
+      Log::Warn << "--r_tree ignored because --block_size is given." << endl;
+
+    Log::Info << "Building reference tree..." << endl;
+    AllkFN allkfn(referenceData, naive, singleMode);
+    allkfn.Epsilon() = epsilon;
+
+    Log::Info << "Computing " << k << " furthest neighbors in blocks of "
+        << blockSize << " query points..." << endl;
+    StreamSearch(allkfn, CLI::GetParam<string>("query_file"), k,
+        (size_t) blockSize, neighborsFile, distancesFile);
+    return 0;
+  }
+
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
@@ -139,9 +207,7 @@ int main(int argc, char *argv[])
     std::vector<size_t> oldFromNewQueries;
 
     AllkFN allkfn(&refTree, singleMode);
-
-    arma::mat distancesOut(distances.n_rows, distances.n_cols);
-    arma::Mat<size_t> neighborsOut(neighbors.n_rows, neighbors.n_cols);
+    allkfn.Epsilon() = epsilon;
 
     if (CLI::HasParam("query_file"))
     {
@@ -156,18 +222,18 @@ int main(int argc, char *argv[])
         Log::Info << "Tree built." << endl;
 
         Log::Info << "Computing " << k << " furthest neighbors..." << endl;
-        allkfn.Search(&queryTree, k, neighborsOut, distancesOut);
+        allkfn.Search(&queryTree, k, neighbors, distances);
       }
       else
       {
         Log::Info << "Computing " << k << " furthest neighbors..." << endl;
-        allkfn.Search(queryData, k, neighborsOut, distancesOut);
+        allkfn.Search(queryData, k, neighbors, distances);
       }
     }
     else
     {
       Log::Info << "Computing " << k << " furthest neighbors..." << endl;
-      allkfn.Search(k, neighborsOut, distancesOut);
+      allkfn.Search(k, neighbors, distances);
     }
 
     Log::Info << "Neighbors computed." << endl;
@@ -178,13 +244,11 @@ int main(int argc, char *argv[])
 
     // Map the points back to their original locations.
     if ((CLI::GetParam<string>("query_file") != "") && !singleMode)
-      Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewQueries, neighbors,
-          distances);
+      Unmap(neighbors, distances, oldFromNewRefs, oldFromNewQueries);
     else if ((CLI::GetParam<string>("query_file") != "") && singleMode)
-      Unmap(neighborsOut, distancesOut, oldFromNewRefs, neighbors, distances);
+      Unmap(neighbors, distances, oldFromNewRefs);
     else
-      Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs, neighbors,
-          distances);
+      Unmap(neighbors, distances, oldFromNewRefs, oldFromNewRefs);
   }
   else
   {
@@ -210,6 +274,7 @@ int main(int argc, char *argv[])
     typedef NeighborSearch<FurthestNeighborSort, metric::LMetric<2, true>,
         TreeType> AllkFNType;
     AllkFNType allkfn(&refTree, singleMode);
+    allkfn.Epsilon() = epsilon;
 
     if (CLI::GetParam<string>("query_file") != "")
     {
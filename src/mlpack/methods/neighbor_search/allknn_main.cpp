@@ -7,12 +7,21 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/tree_io.hpp>
+#include <mlpack/core/util/query_server.hpp>
 
 #include <string>
 #include <fstream>
 #include <iostream>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 #include "neighbor_search.hpp"
+#include "quantized_allknn.hpp"
+#include "search_advisor.hpp"
+#include "stream_search.hpp"
 #include "unmap.hpp"
 
 using namespace std;
@@ -39,7 +48,21 @@ PROGRAM_INFO("All K-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "With --server, the reference tree is built once, and then batches of "
+    "query points are read from --server_input (or the standard input) and "
+    "answered until the input ends or a 'quit' request is read.  A request "
+    "'query <n> [k=<k>]' is followed by n lines holding one query point each; "
+    "it is answered with the neighbors and then the distances of every query "
+    "point (one point per line).  Only kd-tree search (optionally with "
+    "--single_mode or --naive) is supported in this mode, and the output files "
+    "are not written."
+    "\n\n"
+    "With --auto, the tree type (kd-tree or cover tree, or naive search), the "
+    "leaf size and single-tree or dual-tree search are chosen automatically, "
+    "from the estimated intrinsic dimension of the data and the number of base "
+    "cases and node scores of quick pilot searches on a subsample.");
 
 // Define our input parameters that this program will take.
 PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
@@ -59,9 +82,93 @@ PARAM_FLAG("cover_tree", "If true, use cover trees to perform the search "
     "(experimental, may be slow).", "c");
 PARAM_FLAG("r_tree", "If true, use an R-Tree to perform the search "
     "(experimental, may be slow.).", "T");
+PARAM_FLAG("auto", "If true, choose the tree type, the leaf size and single-"
+    "tree or dual-tree search with pilot searches on a subsample; this "
+    "overrides --leaf_size, --naive, --single_mode, --cover_tree and "
+    "--r_tree.", "A");
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
 PARAM_INT("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+PARAM_INT("block_size", "If positive, stream the query points from "
+    "--query_file in blocks of this many points against the resident reference "
+    "tree, writing the results of each block to the output files as soon as it "
+    "is done; the output files must then be Armadillo binary files (.bin).",
+    "b", 0);
+PARAM_FLAG("symmetric", "If true and no query set is given, dual-tree kd-tree "
+    "search evaluates each pair of points only once and updates the neighbors "
+    "of both points, which nearly halves the number of base cases.", "y");
+PARAM_DOUBLE("epsilon", "If greater than 0, perform approximate search: each "
+    "returned distance is at most (1 + epsilon) times the true k'th-neighbor "
+    "distance, which allows much more pruning on high-dimensional data.", "e",
+    0.0);
+PARAM_STRING("reference_tree_file", "If specified and the file exists, load "
+    "the reference tree (and the reference dataset) from this file instead of "
+    "building it; if the file does not exist, the reference tree is built and "
+    "saved to this file.", "f", "");
+PARAM_FLAG("float", "If true, the search is done with a kd-tree on a single "
+    "precision copy of the data, which halves its memory footprint.", "F");
+PARAM_FLAG("quantized", "If true, the search scans an 8-bit quantized copy of "
+    "the reference set and re-ranks the candidates exactly.", "Q");
+PARAM_INT("threads", "Number of threads to use for single-tree search (0 "
+    "uses all available cores; ignored without OpenMP).", "t", 0);
+
+PARAM_FLAG("server", "If true, build the reference tree once and answer "
+    "batches of query points read from --server_input.", "");
+PARAM_STRING("server_input", "File or named pipe to read server requests from "
+    "(the standard input is used if not given).", "", "");
+PARAM_STRING("server_output", "File or named pipe to write server responses to "
+    "(the standard output is used if not given).", "", "");
+
+/**
+ * Answer the query batches of the server with a search object that holds the
+ * reference tree.  The number of neighbors can be given per request with the
+ * option k.
+ */
+template<typename SearchType>
+class SearchHandler
+{
+ public:
+  SearchHandler(SearchType& search,
+                const size_t k,
+                const size_t dimensionality,
+                const size_t numReferences) :
+      search(search),
+      k(k),
+      dimensionality(dimensionality),
+      numReferences(numReferences)
+  { }
+
+  void Query(const util::QueryRequest& request, util::QueryResponse& response)
+  {
+    const int queryK = request.Option<int>("k", (int) k);
+    if (queryK <= 0 || (size_t) queryK > numReferences)
+    {
+      Log::Fatal << "Invalid k: " << queryK << "; must be greater than 0 and "
+          << "less than or equal to the number of reference points ("
+          << numReferences << ")." << endl;
+    }
+
+    if (request.Points().n_rows != dimensionality)
+    {
+      Log::Fatal << "Query points have " << request.Points().n_rows
+          << " dimensions, but the reference points have " << dimensionality
+          << "." << endl;
+    }
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    search.Search(request.Points(), (size_t) queryK, neighbors, distances);
+
+    response.Add(neighbors);
+    response.Add(distances);
+  }
+
+ private:
+  SearchType& search;
+  size_t k;
+  size_t dimensionality;
+  size_t numReferences;
+};
 
 int main(int argc, char *argv[])
 {
@@ -91,13 +198,17 @@ int main(int argc, char *argv[])
   arma::mat referenceData;
   arma::mat queryData; // So it doesn't go out of scope.
   data::Load(referenceFile, referenceData, true);
+  Numa::Distribute(referenceData); // Only with --numa.
 
   Log::Info << "Loaded reference data from '" << referenceFile << "' ("
       << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
 
-  if (queryFile != "")
+  // In streaming mode, the query set is only read block by block.
+  const int blockSize = CLI::GetParam<int>("block_size");
+  if (queryFile != "" && blockSize <= 0)
   {
     data::Load(queryFile, queryData, true);
+    Numa::Distribute(queryData);
     Log::Info << "Loaded query data from '" << queryFile << "' ("
       << queryData.n_rows << " x " << queryData.n_cols << ")." << endl;
   }
@@ -119,18 +230,123 @@ int main(int argc, char *argv[])
   }
   size_t leafSize = lsInt;
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP "
+        << "support." << endl;
+#endif
+
   // Naive mode overrides single mode.
   if (singleMode && naive)
   {
     Log::Warn << "--single_mode ignored because --naive is present." << endl;
   }
 
+  // Sanity check on epsilon.
+  const double epsilon = CLI::GetParam<double>("epsilon");
+  if (epsilon < 0)
+  {
+    Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be greater than "
+        << "or equal to 0." << endl;
+  }
+  if (epsilon > 0 && naive)
+    Log::Warn << "--epsilon ignored because --naive is present." << endl;
+  if (CLI::HasParam("symmetric") && (queryFile != "" || naive || singleMode ||
+      CLI::HasParam("cover_tree") || CLI::HasParam("r_tree")))
+  {
+    Log::Warn << "--symmetric ignored; it is only used for dual-tree kd-tree "
+        << "search without a query set." << endl;
+  }
+  if (epsilon > 0 && CLI::HasParam("quantized"))
+    Log::Warn << "--epsilon ignored because --quantized is present." << endl;
+
    // cover_tree overrides r_tree.
   if (CLI::HasParam("cover_tree") && CLI::HasParam("r_tree"))
   {
     Log::Warn << "--cover_tree overrides --r_tree." << endl;
   }
 
+  // A saved tree cannot be used with a random basis, since the basis is
+  // different every run.
+  const string referenceTreeFile = CLI::GetParam<string>("reference_tree_file");
+  const bool loadTree = (referenceTreeFile != "") &&
+      ifstream(referenceTreeFile.c_str()).good();
+  if (referenceTreeFile != "" && randomBasis)
+  {
+    Log::Fatal << "--reference_tree_file cannot be used with --random_basis."
+        << endl;
+  }
+  if (referenceTreeFile != "" && (naive || CLI::HasParam("r_tree")))
+  {
+    Log::Warn << "--reference_tree_file ignored because it is only supported "
+        << "for kd-trees and cover trees." << endl;
+  }
+
+  // In server mode, the reference tree is built once, and every batch of query
+  // points is searched with it.
+  if (CLI::HasParam("server"))
+  {
+    if (randomBasis || CLI::HasParam("quantized") || CLI::HasParam("float") ||
+        CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") ||
+        referenceTreeFile != "" || queryFile != "")
+    {
+      Log::Warn << "--server only supports kd-tree search; --random_basis, "
+          << "--quantized, --float, --cover_tree, --r_tree, "
+          << "--reference_tree_file and --query_file are ignored." << endl;
+    }
+
+    Log::Info << "Building reference tree..." << endl;
+    AllkNN allknn(referenceData, naive, singleMode);
+    allknn.Epsilon() = epsilon;
+    allknn.AutoMode() = true; // Small batches are searched single-tree.
+    SearchHandler<AllkNN> handler(allknn, k, referenceData.n_rows,
+        referenceData.n_cols);
+    util::ServeQueries(handler, CLI::GetParam<string>("server_input"),
+        CLI::GetParam<string>("server_output"));
+    return 0;
+  }
+
+  // In streaming mode, the reference tree is built once, and the query set is
+  // read and searched in blocks.
+  if (blockSize != 0)
+  {
+    if (blockSize < 0)
+    {
+      Log::Fatal << "Invalid block size: " << blockSize << ".  Must be greater "
+          << "than or equal to 0." << endl;
+    }
+    if (queryFile == "")
+      Log::Fatal << "--block_size requires --query_file." << endl;
+    if (randomBasis || CLI::HasParam("quantized") || CLI::HasParam("float") ||
+        CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") ||
+        referenceTreeFile != "")
+    {
+      Log::Warn << "--block_size only supports kd-tree search; --random_basis, "
+          << "--quantized, --float, --cover_tree, --r_tree and "
+          << "--reference_tree_file are ignored." << endl;
+    }
+
+    Log::Info << "Building reference tree..." << endl;
+    AllkNN allknn(referenceData, naive, singleMode);
+    allknn.Epsilon() = epsilon;
+    allknn.AutoMode() = true; // Small batches are searched single-tree.
+
+    Log::Info << "Computing " << k << " nearest neighbors in blocks of "
+        << blockSize << " query points..." << endl;
+    StreamSearch(allknn, queryFile, k, (size_t) blockSize, neighborsFile,
+        distancesFile);
+    return 0;
+  }
+
   // See if we want to project onto a random basis.
   if (randomBasis)
   {
@@ -168,21 +384,143 @@ int main(int argc, char *argv[])
     }
   }
 
+  // Choose the search with pilot searches on a subsample.
+  bool coverTree = CLI::HasParam("cover_tree");
+  bool rTree = CLI::HasParam("r_tree");
+  if (CLI::HasParam("auto"))
+  {
+    if (CLI::HasParam("quantized") || CLI::HasParam("float") || loadTree)
+    {
+      Log::Warn << "--auto ignored because --quantized, --float or an "
+          << "existing --reference_tree_file is given." << endl;
+    }
+    else
+    {
+      if (naive || singleMode || coverTree || rTree)
+      {
+        Log::Warn << "--auto overrides --leaf_size, --naive, --single_mode, "
+            << "--cover_tree and --r_tree." << endl;
+      }
+
+      Log::Info << "Running pilot searches..." << endl;
+      Timer::Start("search_advising");
+      SearchAdvisor advisor(k, epsilon);
+      if (queryFile != "")
+        advisor.Advise(referenceData, queryData);
+      else
+        advisor.Advise(referenceData);
+      Timer::Stop("search_advising");
+
+      naive = (advisor.Tree() == SearchAdvisor::NAIVE);
+      coverTree = (advisor.Tree() == SearchAdvisor::COVER_TREE);
+      rTree = false;
+      singleMode = advisor.SingleMode();
+      if (advisor.Tree() == SearchAdvisor::KD_TREE)
+        leafSize = advisor.LeafSize();
+
+      if (naive)
+        Log::Info << "Using naive search." << endl;
+      else if (coverTree)
+        Log::Info << "Using " << (singleMode ? "single" : "dual") << "-tree "
+            << "search with cover trees." << endl;
+      else
+        Log::Info << "Using " << (singleMode ? "single" : "dual") << "-tree "
+            << "search with kd-trees of leaf size " << leafSize << "." << endl;
+    }
+  }
+
+  if (CLI::HasParam("quantized") && (naive || singleMode ||
+      CLI::HasParam("cover_tree") || CLI::HasParam("r_tree") ||
+      CLI::HasParam("float")))
+  {
+    Log::Warn << "--quantized overrides the other search options." << endl;
+  }
+  else if (CLI::HasParam("float") && (naive || CLI::HasParam("cover_tree") ||
+      CLI::HasParam("r_tree") || referenceTreeFile != ""))
+  {
+    Log::Warn << "--float is only supported for kd-trees without a saved "
+        << "reference tree; the other search options are ignored." << endl;
+  }
+
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
-  if (naive)
+  if (CLI::HasParam("quantized"))
   {
-    AllkNN allknn(referenceData, false, naive);
+    Log::Info << "Quantizing reference set..." << endl;
+    QuantizedAllkNN allknn(referenceData);
+    Log::Info << "Maximum quantization error: " << allknn.MaxError() << "."
+        << endl;
 
+    Log::Info << "Computing " << k << " nearest neighbors..." << endl;
     if (CLI::GetParam<string>("query_file") != "")
       allknn.Search(queryData, k, neighbors, distances);
     else
       allknn.Search(k, neighbors, distances);
+    Log::Info << allknn.ExactDistances() << " exact distances computed."
+        << endl;
   }
-  else if (!CLI::HasParam("cover_tree"))
+  else if (CLI::HasParam("float"))
   {
-    if (!CLI::HasParam("r_tree"))
+    // The trees, bounds and rules take their element type from the matrix, so
+    // the whole search is done in single precision.
+    typedef BinarySpaceTree<bound::HRectBound<2>,
+        NeighborSearchStat<NearestNeighborSort>, arma::fmat> TreeType;
+
+    arma::fmat referenceFloat = arma::conv_to<arma::fmat>::from(referenceData);
+    referenceData.reset();
+
+    std::vector<size_t> oldFromNewRefs;
+    Log::Info << "Building reference tree..." << endl;
+    Timer::Start("tree_building");
+    TreeType refTree(referenceFloat, oldFromNewRefs, leafSize);
+    Timer::Stop("tree_building");
+    Log::Info << "Reference tree uses " << refTree.MemoryUsage() << " bytes."
+        << endl;
+
+    FloatAllkNN allknn(&refTree, singleMode);
+    allknn.Epsilon() = epsilon;
+    allknn.Symmetric() = CLI::HasParam("symmetric");
+
+    std::vector<size_t> oldFromNewQueries;
+
+    Log::Info << "Computing " << k << " nearest neighbors..." << endl;
+    if (CLI::GetParam<string>("query_file") != "")
+    {
+      arma::fmat queryFloat = arma::conv_to<arma::fmat>::from(queryData);
+      queryData.reset();
+
+      if (!singleMode)
+      {
+        TreeType queryTree(queryFloat, oldFromNewQueries, leafSize);
+        allknn.Search(&queryTree, k, neighbors, distances);
+        Unmap(neighbors, distances, oldFromNewRefs, oldFromNewQueries);
+      }
+      else
+      {
+        allknn.Search(queryFloat, k, neighbors, distances);
+        Unmap(neighbors, distances, oldFromNewRefs);
+      }
+    }
+    else
+    {
+      allknn.Search(k, neighbors, distances);
+      Unmap(neighbors, distances, oldFromNewRefs, oldFromNewRefs);
+    }
+    Log::Info << "Neighbors computed." << endl;
+  }
+  else if (naive)
+  {
+    AllkNN allknn(referenceData, true);
+
+    if (CLI::GetParam<string>("query_file") != "")
+      allknn.Search(queryData, k, neighbors, distances);
+    else
+      allknn.Search(k, neighbors, distances);
+  }
+  else if (!coverTree)
+  {
+    if (!rTree)
     {
       // We're using the kd-tree.
       // Mappings for when we build the tree.
@@ -194,17 +532,45 @@ int main(int argc, char *argv[])
 
       // Build trees by hand, so we can save memory: if we pass a tree to
       // NeighborSearch, it does not copy the matrix.
-      Log::Info << "Building reference tree..." << endl;
-      Timer::Start("tree_building");
-      TreeType refTree(referenceData, oldFromNewRefs, leafSize);
-      Timer::Stop("tree_building");
+      TreeType* refTree;
+      if (loadTree)
+      {
+        Log::Info << "Loading reference tree from '" << referenceTreeFile
+            << "'..." << endl;
+        const size_t dimensionality = referenceData.n_rows;
+        const size_t points = referenceData.n_cols;
+        refTree = LoadTree<TreeType>(referenceTreeFile, referenceData,
+            oldFromNewRefs, true);
+        if (referenceData.n_rows != dimensionality ||
+            referenceData.n_cols != points)
+        {
+          Log::Fatal << "Reference tree in '" << referenceTreeFile << "' was "
+              << "not built on a dataset of the same size as '"
+              << referenceFile << "'!" << endl;
+        }
+      }
+      else
+      {
+        Log::Info << "Building reference tree..." << endl;
+        Timer::Start("tree_building");
+        refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+        Timer::Stop("tree_building");
+        Log::Info << "Reference tree uses " << refTree->MemoryUsage()
+            << " bytes." << endl;
 
-      AllkNN allknn(&refTree, singleMode);
+        if (referenceTreeFile != "")
+        {
+          Log::Info << "Saving reference tree to '" << referenceTreeFile
+              << "'..." << endl;
+          SaveTree(referenceTreeFile, *refTree, oldFromNewRefs);
+        }
+      }
 
-      std::vector<size_t> oldFromNewQueries;
+      AllkNN allknn(refTree, singleMode);
+      allknn.Epsilon() = epsilon;
+      allknn.Symmetric() = CLI::HasParam("symmetric");
 
-      arma::mat distancesOut;
-      arma::Mat<size_t> neighborsOut;
+      std::vector<size_t> oldFromNewQueries;
 
       if (CLI::GetParam<string>("query_file") != "")
       {
@@ -219,18 +585,18 @@ int main(int argc, char *argv[])
           Log::Info << "Tree built." << endl;
 
           Log::Info << "Computing " << k << " nearest neighbors..." << endl;
-          allknn.Search(&queryTree, k, neighborsOut, distancesOut);
+          allknn.Search(&queryTree, k, neighbors, distances);
         }
         else
         {
           Log::Info << "Computing " << k << " nearest neighbors..." << endl;
-          allknn.Search(queryData, k, neighborsOut, distancesOut);
+          allknn.Search(queryData, k, neighbors, distances);
         }
       }
       else
       {
         Log::Info << "Computing " << k << " nearest neighbors..." << endl;
-        allknn.Search(k, neighborsOut, distancesOut);
+        allknn.Search(k, neighbors, distances);
       }
 
       Log::Info << "Neighbors computed." << endl;
@@ -241,13 +607,13 @@ int main(int argc, char *argv[])
 
       // Map the results back to the correct places.
       if ((CLI::GetParam<string>("query_file") != "") && !singleMode)
-        Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewQueries,
-            neighbors, distances);
+        Unmap(neighbors, distances, oldFromNewRefs, oldFromNewQueries);
       else if ((CLI::GetParam<string>("query_file") != "") && singleMode)
-        Unmap(neighborsOut, distancesOut, oldFromNewRefs, neighbors, distances);
+        Unmap(neighbors, distances, oldFromNewRefs);
       else
-        Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs,
-            neighbors, distances);
+        Unmap(neighbors, distances, oldFromNewRefs, oldFromNewRefs);
+
+      delete refTree;
     }
     else
     {
@@ -268,10 +634,13 @@ int main(int argc, char *argv[])
       TreeType refTree(referenceData, leafSize, leafSize * 0.4, 5, 2, 0);
       Timer::Stop("tree_building");
       Log::Info << "Tree built." << endl;
+      Log::Info << "Reference tree uses " << refTree.MemoryUsage() << " bytes."
+          << endl;
 
       typedef NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
           TreeType> AllkNNType;
       AllkNNType allknn(&refTree, singleMode);
+      allknn.Epsilon() = epsilon;
 
       if (CLI::GetParam<string>("query_file") != "")
       {
@@ -310,15 +679,45 @@ int main(int argc, char *argv[])
     typedef CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
         NeighborSearchStat<NearestNeighborSort>> TreeType;
 
-    // Build our reference tree.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("tree_building");
-    TreeType refTree(referenceData, 1.3);
-    Timer::Stop("tree_building");
+    // Build our reference tree, or load it.  Cover trees do not rearrange the
+    // dataset, so there is no mapping to keep track of.
+    TreeType* refTree;
+    if (loadTree)
+    {
+      Log::Info << "Loading reference tree from '" << referenceTreeFile
+          << "'..." << endl;
+      const size_t dimensionality = referenceData.n_rows;
+      const size_t points = referenceData.n_cols;
+      std::vector<size_t> oldFromNewRefs;
+      refTree = LoadTree<TreeType>(referenceTreeFile, referenceData,
+          oldFromNewRefs, true);
+      if (referenceData.n_rows != dimensionality ||
+          referenceData.n_cols != points)
+      {
+        Log::Fatal << "Reference tree in '" << referenceTreeFile << "' was "
+            << "not built on a dataset of the same size as '"
+            << referenceFile << "'!" << endl;
+      }
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("tree_building");
+      refTree = new TreeType(referenceData, 1.3);
+      Timer::Stop("tree_building");
+
+      if (referenceTreeFile != "")
+      {
+        Log::Info << "Saving reference tree to '" << referenceTreeFile
+            << "'..." << endl;
+        SaveTree(referenceTreeFile, *refTree);
+      }
+    }
 
     typedef NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>,
         TreeType> AllkNNType;
-    AllkNNType allknn(&refTree, singleMode);
+    AllkNNType allknn(refTree, singleMode);
+    allknn.Epsilon() = epsilon;
 
     // See if we have query data.
     if (CLI::HasParam("query_file"))
@@ -347,9 +746,12 @@ int main(int argc, char *argv[])
     }
 
     Log::Info << "Neighbors computed." << endl;
+
+    delete refTree;
   }
 
-  // Save put.
-  data::Save(distancesFile, distances);
+  // Save output; the two files are written at the same time.
+  std::future<bool> distancesSaved = data::SaveAsync(distancesFile, distances);
   data::Save(neighborsFile, neighbors);
+  distancesSaved.get();
 }
@@ -0,0 +1,235 @@
+/**
+ * @file allknn_mpi_main.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the distributed AllkNN executable, which partitions the
+ * reference set across MPI ranks.
+ */
+#include <mlpack/core.hpp>
+#include <mpi.h>
+
+#include "distributed_search.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+// Information about the program itself.
+PROGRAM_INFO("Distributed All K-Nearest-Neighbors",
+    "This program finds the k nearest neighbors of a set of query points in a "
+    "reference set that is partitioned across the ranks of an MPI job, so that "
+    "the reference set does not have to fit in the memory of a single node.  "
+    "It must be started with mpirun (or equivalent)."
+    "\n\n"
+    "Each rank reads its own contiguous part of the reference file and builds a "
+    "kd-tree on it.  The first rank reads the query points in blocks of "
+    "--block_size points; each query point is sent to the rank whose part of "
+    "the reference set is closest to it, and then to every other rank that "
+    "could still hold one of its k nearest neighbors.  If no query file is "
+    "given, the reference set is used as the query set, and a point is not its "
+    "own neighbor."
+    "\n\n"
+    "The neighbors are given as indices into the whole reference file, and the "
+    "output files have the same format as the output of allknn.  For example:"
+    "\n\n"
+    "$ mpirun -n 8 allknn_mpi --k=5 --reference_file=input.csv\n"
+    "  --distances_file=distances.csv --neighbors_file=neighbors.csv");
+
+// Define our input parameters that this program will take.
+PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
+    "r");
+PARAM_STRING_REQ("distances_file", "File to output distances into.", "d");
+PARAM_STRING_REQ("neighbors_file", "File to output neighbors into.", "n");
+
+PARAM_INT_REQ("k", "Number of nearest neighbors to find.", "k");
+
+PARAM_STRING("query_file", "File containing query points (optional).", "q", "");
+
+PARAM_INT("leaf_size", "Leaf size for tree building.", "l", 20);
+PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
+    "dual-tree search) on each rank.", "s");
+PARAM_INT("block_size", "Number of query points sent out at a time.", "b",
+    10000);
+
+/**
+ * Read the given part of a data file, without holding the rest of the file in
+ * memory.
+ */
+void LoadPartition(const string& filename,
+                   const size_t first,
+                   const size_t count,
+                   arma::mat& partition)
+{
+  data::ChunkedLoader<double> loader(filename, true);
+  partition.set_size(loader.Dimensionality(), count);
+
+  arma::mat chunk;
+  size_t read = 0;
+  while (read < first + count && loader.NextChunk(chunk, 10000))
+  {
+    // Copy the overlap of the chunk with the partition.
+    const size_t begin = std::max(read, first);
+    const size_t end = std::min(read + chunk.n_cols, first + count);
+    if (begin < end)
+      partition.cols(begin - first, end - first - 1) =
+          chunk.cols(begin - read, end - read - 1);
+
+    read += chunk.n_cols;
+  }
+
+  if (read < first + count)
+    Log::Fatal << "Could not read points " << first << " to "
+        << (first + count - 1) << " of '" << filename << "'." << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // Give CLI the command line parameters the user passed in.
+  CLI::ParseCommandLine(argc, argv);
+
+  // Only the first rank talks, unless something goes wrong.
+  if (rank != 0)
+  {
+    Log::Info.ignoreInput = true;
+    Log::Warn.ignoreInput = true;
+  }
+
+  // Get all the parameters.
+  const string referenceFile = CLI::GetParam<string>("reference_file");
+  const string distancesFile = CLI::GetParam<string>("distances_file");
+  const string neighborsFile = CLI::GetParam<string>("neighbors_file");
+  const string queryFile = CLI::GetParam<string>("query_file");
+
+  const int lsInt = CLI::GetParam<int>("leaf_size");
+  const int kInt = CLI::GetParam<int>("k");
+  const int blockInt = CLI::GetParam<int>("block_size");
+  const bool singleMode = CLI::HasParam("single_mode");
+
+  // Sanity checks on the parameters.
+  if (kInt < 1)
+  {
+    Log::Fatal << "Invalid k: " << kInt << "; must be greater than 0."
+        << endl;
+  }
+
+  if (lsInt < 0)
+  {
+    Log::Fatal << "Invalid leaf size: " << lsInt << ".  Must be greater "
+        "than or equal to 0." << endl;
+  }
+
+  if (blockInt < 1)
+  {
+    Log::Fatal << "Invalid block size: " << blockInt << ".  Must be greater "
+        "than 0." << endl;
+  }
+
+  const size_t k = kInt;
+  const size_t blockSize = blockInt;
+  const bool monochromatic = (queryFile == "");
+
+  // Split the reference set into contiguous parts of (nearly) equal size.
+  const size_t numPoints =
+      data::ChunkedLoader<double>(referenceFile, true).NumPoints();
+  if (numPoints < (size_t) size)
+  {
+    Log::Fatal << "The reference set (" << numPoints << " points) must have "
+        << "at least as many points as there are ranks (" << size << ")."
+        << endl;
+  }
+
+  const size_t base = numPoints / size;
+  const size_t extra = numPoints % size;
+  const size_t first = rank * base + std::min((size_t) rank, extra);
+  const size_t count = base + (((size_t) rank < extra) ? 1 : 0);
+
+  arma::mat referenceData;
+  Timer::Start("loading_data");
+  LoadPartition(referenceFile, first, count, referenceData);
+  Timer::Stop("loading_data");
+
+  Log::Info << "Each rank holds about " << base << " of the " << numPoints
+      << " reference points." << endl;
+
+  DistributedNeighborSearch<> search(referenceData, first, lsInt, singleMode);
+
+  // In the monochromatic case, each point finds itself, so search for one more
+  // neighbor and remove it afterwards.
+  const size_t searchK = monochromatic ? k + 1 : k;
+  if (searchK > numPoints)
+  {
+    Log::Fatal << "Invalid k: " << k << "; must be less than "
+        << (monochromatic ? "" : "or equal to ") << "the number of reference "
+        << "points (" << numPoints << ")." << endl;
+  }
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  if (rank == 0)
+  {
+    const string inputFile = monochromatic ? referenceFile : queryFile;
+    data::ChunkedLoader<double> loader(inputFile, true);
+    if (loader.Dimensionality() != referenceData.n_rows)
+    {
+      Log::Fatal << "Query has invalid dimensions (" << loader.Dimensionality()
+          << "); should be " << referenceData.n_rows << "!" << endl;
+    }
+
+    neighbors.set_size(k, loader.NumPoints());
+    distances.set_size(k, loader.NumPoints());
+
+    arma::mat block;
+    arma::Mat<size_t> blockNeighbors;
+    arma::mat blockDistances;
+    size_t offset = 0;
+    Timer::Start("computing_neighbors");
+    while (loader.NextChunk(block, blockSize))
+    {
+      search.Search(block, searchK, blockNeighbors, blockDistances);
+
+      for (size_t i = 0; i < block.n_cols; ++i)
+      {
+        // Skip the query point itself, or the last neighbor if the point
+        // itself was not found (because of duplicates).
+        size_t j = 0;
+        for (size_t l = 0; l < searchK && j < k; ++l)
+        {
+          if (monochromatic && blockNeighbors(l, i) == offset + i)
+            continue;
+
+          neighbors(j, offset + i) = blockNeighbors(l, i);
+          distances(j, offset + i) = blockDistances(l, i);
+          ++j;
+        }
+      }
+
+      offset += block.n_cols;
+      Log::Info << "Searched " << offset << " query points." << endl;
+    }
+
+    // Let the other ranks know we are done.
+    search.Search(arma::mat(), searchK, blockNeighbors, blockDistances);
+    Timer::Stop("computing_neighbors");
+
+    Log::Info << search.ForwardedQueries() << " queries were sent to more than "
+        << "one rank." << endl;
+
+    data::Save(distancesFile, distances);
+    data::Save(neighborsFile, neighbors);
+  }
+  else
+  {
+    // Answer queries until the first rank is done.
+    arma::mat block;
+    while (search.Search(block, searchK, neighbors, distances) > 0);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
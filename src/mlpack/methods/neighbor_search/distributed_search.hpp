@@ -0,0 +1,164 @@
+/**
+ * @file distributed_search.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the DistributedNeighborSearch class, which searches for neighbors in
+ * a reference set that is partitioned across the ranks of an MPI communicator.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_SEARCH_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_SEARCH_HPP
+
+#include <mlpack/core.hpp>
+#include <mpi.h>
+
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Neighbor search on a reference set that is too large for a single node.  Each
+ * rank of the communicator holds one contiguous partition of the reference set
+ * and builds a kd-tree on it.  The bounding boxes of the root nodes are shared
+ * with all ranks at construction time.
+ *
+ * Queries are given to the root rank (rank 0) in blocks.  Each query point is
+ * first sent to the rank whose root bound is best for it (the one with the
+ * smallest minimum distance, for nearest neighbor search), which gives a
+ * k-th best distance for the query.  Then the query is sent to every other rank
+ * whose root bound could still hold a better neighbor than that, and the
+ * partial results are merged with the SortPolicy.  Usually, most queries only
+ * visit one or two ranks.
+ *
+ * Every method is collective: all ranks must call it, in the same order.  Only
+ * the query set given on the root rank is used, and only the root rank receives
+ * results.
+ *
+ * @tparam SortPolicy Sort policy (NearestNeighborSort or FurthestNeighborSort).
+ */
+template<typename SortPolicy = NearestNeighborSort>
+class DistributedNeighborSearch
+{
+ public:
+  //! The type of tree built on each partition.
+  typedef tree::BinarySpaceTree<bound::HRectBound<2>,
+      NeighborSearchStat<SortPolicy> > TreeType;
+  //! The local search type.
+  typedef NeighborSearch<SortPolicy, metric::EuclideanDistance, TreeType>
+      SearchType;
+
+  /**
+   * Build the local tree on this rank's partition of the reference set, and
+   * share the root bounds and partition sizes with all ranks.  The partition
+   * is rearranged during tree building (it is not copied) and must stay alive
+   * as long as this object.
+   *
+   * @param localReferenceSet This rank's partition of the reference set.
+   * @param firstIndex Index of the first point of the partition in the whole
+   *      reference set.
+   * @param leafSize Leaf size of the local tree.
+   * @param singleMode If true, single-tree search is used on each rank.
+   * @param comm Communicator to use.
+   */
+  DistributedNeighborSearch(arma::mat& localReferenceSet,
+                            const size_t firstIndex,
+                            const size_t leafSize = 20,
+                            const bool singleMode = false,
+                            MPI_Comm comm = MPI_COMM_WORLD);
+
+  /**
+   * Delete the local tree.
+   */
+  ~DistributedNeighborSearch();
+
+  /**
+   * Search for the k neighbors of each point in the given query set, which is
+   * only read on the root rank.  On the root rank, the neighbors (as indices
+   * into the whole reference set) and distances are stored in the given
+   * matrices; on other ranks they are not modified.  When the root rank passes
+   * an empty query set, every rank returns 0, so the other ranks can loop
+   * until that happens.
+   *
+   * @param querySet Set of query points (only used on the root rank).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix to store the neighbors in (root rank only).
+   * @param distances Matrix to store the distances in (root rank only).
+   * @return Number of query points searched (on every rank).
+   */
+  size_t Search(const arma::mat& querySet,
+                const size_t k,
+                arma::Mat<size_t>& neighbors,
+                arma::mat& distances);
+
+  //! Get the rank of this process.
+  int Rank() const { return rank; }
+  //! Get the number of ranks.
+  int Size() const { return size; }
+  //! Get the total number of reference points over all ranks.
+  size_t NumReferencePoints() const { return totalPoints; }
+
+  //! Get the number of queries sent to a rank besides their first rank.
+  size_t ForwardedQueries() const { return forwardedQueries; }
+
+ private:
+  //! The communicator.
+  MPI_Comm comm;
+  //! The rank of this process.
+  int rank;
+  //! The number of ranks.
+  int size;
+
+  //! This rank's partition of the reference set (rearranged).
+  arma::mat& localReferenceSet;
+  //! Index of the first local point in the whole reference set.
+  size_t firstIndex;
+  //! Mappings from the local tree order to the original local order.
+  std::vector<size_t> oldFromNew;
+  //! The local tree.
+  TreeType* tree;
+  //! The local search object.
+  SearchType* search;
+
+  //! Root bounds of each rank (all ranks hold all of them).
+  std::vector<bound::HRectBound<2> > rootBounds;
+  //! Number of reference points held by each rank.
+  std::vector<size_t> partitionSizes;
+  //! Total number of reference points.
+  size_t totalPoints;
+
+  //! Number of queries sent to a rank besides their first rank.
+  size_t forwardedQueries;
+
+  /**
+   * Send the given lists of query points to each rank, search them there, and
+   * merge the results into neighbors and distances on the root rank.
+   *
+   * @param querySet Query points (root rank only).
+   * @param routes The indices of the query points to send to each rank (root
+   *      rank only).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Results to merge into (root rank only).
+   * @param distances Results to merge into (root rank only).
+   */
+  void SearchRoutes(const arma::mat& querySet,
+                    const std::vector<std::vector<size_t> >& routes,
+                    const size_t k,
+                    arma::Mat<size_t>& neighbors,
+                    arma::mat& distances);
+
+  //! Insert a candidate into the results of a query point, if it is better
+  //! than any of the current ones.
+  void AddCandidate(const size_t queryIndex,
+                    const size_t neighbor,
+                    const double distance,
+                    arma::Mat<size_t>& neighbors,
+                    arma::mat& distances) const;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+// Include implementation.
+#include "distributed_search_impl.hpp"
+
+#endif
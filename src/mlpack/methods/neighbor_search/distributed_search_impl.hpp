@@ -0,0 +1,324 @@
+/**
+ * @file distributed_search_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the DistributedNeighborSearch class.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_SEARCH_IMPL_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "distributed_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+//! The best possible distance between a point and any point in the bound, for
+//! nearest neighbor search.
+template<typename VecType>
+inline double BestBoundDistance(const NearestNeighborSort& /* policy */,
+                                const bound::HRectBound<2>& bound,
+                                const VecType& point)
+{
+  return bound.MinDistance(point);
+}
+
+//! The best possible distance between a point and any point in the bound, for
+//! furthest neighbor search.
+template<typename VecType>
+inline double BestBoundDistance(const FurthestNeighborSort& /* policy */,
+                                const bound::HRectBound<2>& bound,
+                                const VecType& point)
+{
+  return bound.MaxDistance(point);
+}
+
+template<typename SortPolicy>
+DistributedNeighborSearch<SortPolicy>::DistributedNeighborSearch(
+    arma::mat& localReferenceSet,
+    const size_t firstIndex,
+    const size_t leafSize,
+    const bool singleMode,
+    MPI_Comm comm) :
+    comm(comm),
+    localReferenceSet(localReferenceSet),
+    firstIndex(firstIndex),
+    tree(NULL),
+    search(NULL),
+    totalPoints(0),
+    forwardedQueries(0)
+{
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  if (localReferenceSet.n_cols == 0)
+    Log::Fatal << "DistributedNeighborSearch: rank " << rank << " holds no "
+        << "reference points." << std::endl;
+
+  Timer::Start("tree_building");
+  tree = new TreeType(localReferenceSet, oldFromNew, leafSize);
+  Timer::Stop("tree_building");
+
+  search = new SearchType(tree, singleMode);
+
+  // Share the partition sizes.
+  const size_t dimensionality = localReferenceSet.n_rows;
+  unsigned long long localSize = localReferenceSet.n_cols;
+  std::vector<unsigned long long> sizes(size);
+  MPI_Allgather(&localSize, 1, MPI_UNSIGNED_LONG_LONG, &sizes[0], 1,
+      MPI_UNSIGNED_LONG_LONG, comm);
+
+  partitionSizes.resize(size);
+  for (int r = 0; r < size; ++r)
+  {
+    partitionSizes[r] = sizes[r];
+    totalPoints += sizes[r];
+  }
+
+  // Share the root bounds, as the lower and upper bounds of each dimension.
+  arma::vec localBound(2 * dimensionality);
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    localBound[2 * d] = tree->Bound()[d].Lo();
+    localBound[2 * d + 1] = tree->Bound()[d].Hi();
+  }
+
+  arma::mat bounds(2 * dimensionality, size);
+  MPI_Allgather(localBound.memptr(), 2 * dimensionality, MPI_DOUBLE,
+      bounds.memptr(), 2 * dimensionality, MPI_DOUBLE, comm);
+
+  rootBounds.resize(size, bound::HRectBound<2>(dimensionality));
+  for (int r = 0; r < size; ++r)
+    for (size_t d = 0; d < dimensionality; ++d)
+      rootBounds[r][d] = math::Range(bounds(2 * d, r), bounds(2 * d + 1, r));
+}
+
+template<typename SortPolicy>
+DistributedNeighborSearch<SortPolicy>::~DistributedNeighborSearch()
+{
+  delete search;
+  delete tree;
+}
+
+template<typename SortPolicy>
+size_t DistributedNeighborSearch<SortPolicy>::Search(
+    const arma::mat& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  // Let every rank know how many queries there are.
+  unsigned long long numQueries = (rank == 0) ? querySet.n_cols : 0;
+  MPI_Bcast(&numQueries, 1, MPI_UNSIGNED_LONG_LONG, 0, comm);
+  if (numQueries == 0)
+    return 0;
+
+  if (k > totalPoints)
+    Log::Fatal << "DistributedNeighborSearch::Search(): k (" << k << ") is "
+        << "greater than the number of reference points (" << totalPoints
+        << ")." << std::endl;
+
+  std::vector<std::vector<size_t> > routes(size);
+  std::vector<int> firstRank;
+  if (rank == 0)
+  {
+    if (querySet.n_rows != localReferenceSet.n_rows)
+      Log::Fatal << "DistributedNeighborSearch::Search(): query set has "
+          << "dimensionality " << querySet.n_rows << ", but the reference set "
+          << "has dimensionality " << localReferenceSet.n_rows << "."
+          << std::endl;
+
+    neighbors.set_size(k, querySet.n_cols);
+    neighbors.fill(size_t() - 1);
+    distances.set_size(k, querySet.n_cols);
+    distances.fill(SortPolicy::WorstDistance());
+
+    // First send each query to the rank whose root bound is best for it.
+    firstRank.resize(querySet.n_cols);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+    {
+      double bestDistance = SortPolicy::WorstDistance();
+      firstRank[i] = 0;
+      for (int r = 0; r < size; ++r)
+      {
+        const double distance = BestBoundDistance(SortPolicy(), rootBounds[r],
+            querySet.unsafe_col(i));
+        if (SortPolicy::IsBetter(distance, bestDistance))
+        {
+          bestDistance = distance;
+          firstRank[i] = r;
+        }
+      }
+
+      routes[firstRank[i]].push_back(i);
+    }
+  }
+
+  SearchRoutes(querySet, routes, k, neighbors, distances);
+
+  if (rank == 0)
+  {
+    // Now send each query to every other rank that could hold a better
+    // neighbor than the current k'th best.
+    for (int r = 0; r < size; ++r)
+      routes[r].clear();
+
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+    {
+      for (int r = 0; r < size; ++r)
+      {
+        if (r == firstRank[i])
+          continue;
+
+        const double distance = BestBoundDistance(SortPolicy(), rootBounds[r],
+            querySet.unsafe_col(i));
+        if (neighbors(k - 1, i) == (size_t() - 1) ||
+            SortPolicy::IsBetter(distance, distances(k - 1, i)))
+        {
+          routes[r].push_back(i);
+          ++forwardedQueries;
+        }
+      }
+    }
+  }
+
+  SearchRoutes(querySet, routes, k, neighbors, distances);
+
+  return numQueries;
+}
+
+template<typename SortPolicy>
+void DistributedNeighborSearch<SortPolicy>::SearchRoutes(
+    const arma::mat& querySet,
+    const std::vector<std::vector<size_t> >& routes,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  const size_t dimensionality = localReferenceSet.n_rows;
+
+  // Each rank returns at most k results per query, or fewer if it holds fewer
+  // points.
+  std::vector<size_t> rankK(size);
+  for (int r = 0; r < size; ++r)
+    rankK[r] = std::min(k, partitionSizes[r]);
+
+  // Tell each rank how many queries it gets, then send them.
+  std::vector<unsigned long long> counts(size, 0);
+  std::vector<int> queryCounts(size, 0), queryOffsets(size, 0);
+  arma::mat sendQueries;
+  if (rank == 0)
+  {
+    size_t total = 0;
+    for (int r = 0; r < size; ++r)
+    {
+      counts[r] = routes[r].size();
+      queryCounts[r] = routes[r].size() * dimensionality;
+      queryOffsets[r] = total * dimensionality;
+      total += routes[r].size();
+    }
+
+    sendQueries.set_size(dimensionality, total);
+    size_t col = 0;
+    for (int r = 0; r < size; ++r)
+      for (size_t i = 0; i < routes[r].size(); ++i)
+        sendQueries.col(col++) = querySet.col(routes[r][i]);
+  }
+
+  unsigned long long localCount;
+  MPI_Scatter(&counts[0], 1, MPI_UNSIGNED_LONG_LONG, &localCount, 1,
+      MPI_UNSIGNED_LONG_LONG, 0, comm);
+
+  arma::mat localQueries(dimensionality, localCount);
+  MPI_Scatterv(sendQueries.memptr(), &queryCounts[0], &queryOffsets[0],
+      MPI_DOUBLE, localQueries.memptr(), localQueries.n_elem, MPI_DOUBLE, 0,
+      comm);
+
+  // Search the local partition, and turn the neighbors into indices into the
+  // whole reference set.
+  const size_t localK = rankK[rank];
+  arma::mat localDistances(localK, localCount);
+  std::vector<unsigned long long> localNeighbors(localK * localCount);
+  if (localCount > 0)
+  {
+    arma::Mat<size_t> neighborsOut;
+    search->Search(localQueries, localK, neighborsOut, localDistances);
+    for (size_t i = 0; i < neighborsOut.n_elem; ++i)
+      localNeighbors[i] = firstIndex + oldFromNew[neighborsOut[i]];
+  }
+
+  // Collect the results on the root rank.
+  std::vector<int> resultCounts(size, 0), resultOffsets(size, 0);
+  size_t totalResults = 0;
+  if (rank == 0)
+  {
+    for (int r = 0; r < size; ++r)
+    {
+      resultCounts[r] = routes[r].size() * rankK[r];
+      resultOffsets[r] = totalResults;
+      totalResults += resultCounts[r];
+    }
+  }
+
+  arma::vec allDistances(totalResults);
+  std::vector<unsigned long long> allNeighbors(std::max(totalResults,
+      (size_t) 1));
+  MPI_Gatherv(localDistances.memptr(), localDistances.n_elem, MPI_DOUBLE,
+      allDistances.memptr(), &resultCounts[0], &resultOffsets[0], MPI_DOUBLE,
+      0, comm);
+  MPI_Gatherv(localNeighbors.empty() ? NULL : &localNeighbors[0],
+      localNeighbors.size(), MPI_UNSIGNED_LONG_LONG, &allNeighbors[0],
+      &resultCounts[0], &resultOffsets[0], MPI_UNSIGNED_LONG_LONG, 0, comm);
+
+  if (rank != 0)
+    return;
+
+  // Merge the partial results.
+  for (int r = 0; r < size; ++r)
+  {
+    for (size_t i = 0; i < routes[r].size(); ++i)
+    {
+      for (size_t j = 0; j < rankK[r]; ++j)
+      {
+        const size_t index = resultOffsets[r] + i * rankK[r] + j;
+        AddCandidate(routes[r][i], allNeighbors[index], allDistances[index],
+            neighbors, distances);
+      }
+    }
+  }
+}
+
+template<typename SortPolicy>
+void DistributedNeighborSearch<SortPolicy>::AddCandidate(
+    const size_t queryIndex,
+    const size_t neighbor,
+    const double distance,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances) const
+{
+  // If this distance is better than any of the current candidates, the
+  // SortDistance() function will give us the position to insert it into.
+  arma::vec queryDist = distances.unsafe_col(queryIndex);
+  arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
+  const size_t pos = SortPolicy::SortDistance(queryDist, queryIndices,
+      distance);
+
+  // SortDistance() returns (size_t() - 1) if we shouldn't add it.
+  if (pos == (size_t() - 1))
+    return;
+
+  // Shift the worse candidates down.
+  for (size_t i = distances.n_rows - 1; i > pos; --i)
+  {
+    distances(i, queryIndex) = distances(i - 1, queryIndex);
+    neighbors(i, queryIndex) = neighbors(i - 1, queryIndex);
+  }
+
+  distances(pos, queryIndex) = distance;
+  neighbors(pos, queryIndex) = neighbor;
+}
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file neighbor_heap.hpp
+ * @author Ryan Curtin
+ *
+ * Bounded heaps of the k best candidates of query points, stored in the
+ * columns of the neighbor and distance matrices of a search.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_HEAP_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_HEAP_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The candidate list of every query point is a column of the neighbor and
+ * distance matrices.  For small k, the columns are kept sorted during the
+ * search, so that inserting a candidate shifts the worse ones with memmove().
+ * For large k that is O(k) per insertion, so the columns are kept as bounded
+ * heaps instead: the worst candidate is at row 0, an insertion replaces it in
+ * O(log k), and Sort() orders all columns once at the end of the search.
+ *
+ * The order of the candidates is given by the SortPolicy, so the same heap is
+ * used for nearest and furthest neighbor search.
+ *
+ * @tparam SortPolicy The sort policy of the search.
+ */
+template<typename SortPolicy>
+class NeighborHeap
+{
+ public:
+  //! Candidate lists of at least this many neighbors are stored as heaps.
+  static const size_t MinHeapSize = 64;
+
+  //! Return whether or not the candidate lists of k neighbors are heaps.
+  static bool UseHeap(const size_t k) { return k >= MinHeapSize; }
+
+  //! Return the worst distance of the candidate list of the given query point.
+  static double WorstDistance(const arma::mat& distances,
+                              const size_t queryIndex)
+  {
+    return distances(0, queryIndex);
+  }
+
+  /**
+   * Insert a candidate into the heap of the given query point, if it is not
+   * worse than the worst candidate (which is then removed).  A candidate that
+   * is as good as the worst one is inserted, like SortPolicy::SortDistance()
+   * does for the sorted lists.
+   *
+   * @param distances Matrix of candidate distances.
+   * @param neighbors Matrix of candidate indices.
+   * @param queryIndex Index of the query point (column).
+   * @param neighbor Index of the new candidate.
+   * @param distance Distance of the new candidate.
+   * @return Whether or not the candidate was inserted.
+   */
+  static bool Insert(arma::mat& distances,
+                     arma::Mat<size_t>& neighbors,
+                     const size_t queryIndex,
+                     const size_t neighbor,
+                     const double distance)
+  {
+    double* dist = distances.colptr(queryIndex);
+    if (SortPolicy::IsBetter(dist[0], distance))
+      return false;
+
+    SiftDown(dist, neighbors.colptr(queryIndex), distances.n_rows, distance,
+        neighbor);
+    return true;
+  }
+
+  /**
+   * Sort the heaps of all query points, so that the best candidate of every
+   * query point is at row 0, like the sorted lists.
+   *
+   * @param distances Matrix of candidate distances.
+   * @param neighbors Matrix of candidate indices.
+   */
+  static void Sort(arma::mat& distances, arma::Mat<size_t>& neighbors)
+  {
+    if (distances.n_rows < 2)
+      return;
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < distances.n_cols; ++i)
+    {
+      double* dist = distances.colptr(i);
+      size_t* ind = neighbors.colptr(i);
+
+      // Move the worst remaining candidate behind the shrinking heap.
+      for (size_t end = distances.n_rows - 1; end > 0; --end)
+      {
+        const double worstDistance = dist[0];
+        const size_t worstNeighbor = ind[0];
+        SiftDown(dist, ind, end, dist[end], ind[end]);
+        dist[end] = worstDistance;
+        ind[end] = worstNeighbor;
+      }
+    }
+  }
+
+ private:
+  /**
+   * Replace the root of the heap of the given size with the given candidate
+   * and restore the heap property: no candidate is worse than its parent.
+   */
+  static void SiftDown(double* dist,
+                       size_t* ind,
+                       const size_t size,
+                       const double distance,
+                       const size_t neighbor)
+  {
+    size_t pos = 0;
+    while (2 * pos + 1 < size)
+    {
+      // Pick the worse of the two children.
+      size_t child = 2 * pos + 1;
+      if (child + 1 < size && SortPolicy::IsBetter(dist[child],
+          dist[child + 1]))
+        ++child;
+
+      if (!SortPolicy::IsBetter(distance, dist[child]))
+        break;
+
+      dist[pos] = dist[child];
+      ind[pos] = ind[child];
+      pos = child;
+    }
+
+    dist[pos] = distance;
+    ind[pos] = neighbor;
+  }
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
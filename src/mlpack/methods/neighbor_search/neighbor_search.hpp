@@ -76,6 +76,31 @@ class NeighborSearch
                  const bool singleMode = false,
                  const MetricType metric = MetricType());
 
+  /**
+   * Initialize the NeighborSearch object by building the reference tree
+   * directly on the given reference dataset, without making a copy of it.
+   * This halves the peak memory usage of construction for large datasets, but
+   * if the tree type rearranges the dataset (as BinarySpaceTree does), the
+   * given matrix will be reordered!  The mapping from the new point indices
+   * to the original point indices is stored in oldFromNew, so the original
+   * ordering can be recovered by the caller if necessary.  The results
+   * returned by Search() are still in terms of the original point indices.
+   *
+   * The given matrix must remain valid for the lifetime of this object.
+   * Naive mode is not available as an option for this constructor.
+   *
+   * @param referenceSet Set of reference points.  This may be modified!
+   * @param oldFromNew Vector which will be filled with the original index of
+   *      each point in the (possibly reordered) reference set.
+   * @param singleMode If true, single-tree search will be used (as opposed to
+   *      dual-tree search).
+   * @param metric An optional instance of the MetricType class.
+   */
+  NeighborSearch(typename TreeType::Mat& referenceSet,
+                 std::vector<size_t>& oldFromNew,
+                 const bool singleMode = false,
+                 const MetricType metric = MetricType());
+
   /**
    * Initialize the NeighborSearch object with the given pre-constructed
    * reference tree (this is the tree built on the points that will be
@@ -119,8 +144,10 @@ class NeighborSearch
    *
    * If querySet contains only a few query points, the extra cost of building a
    * tree on the points for dual-tree search may not be warranted, and it may be
-   * worthwhile to set singleMode = false (either in the constructor or with
-   * SingleMode()).
+   * worthwhile to set singleMode = true (either in the constructor or with
+   * SingleMode()), or to let the search choose with AutoMode().  To search the
+   * same query set several times (for instance with different k), build the
+   * query tree once and use the overload of Search() that takes it.
    *
    * @param querySet Set of query points (can be just one point).
    * @param k Number of neighbors to search for.
@@ -151,6 +178,35 @@ class NeighborSearch
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Given a pre-built query tree and the mapping of its (rearranged) points to
+   * the original query points, search for the nearest neighbors of each query
+   * point; the columns of the results are in the order of the original query
+   * set, like with the overload of Search() that takes the query set.  The
+   * tree can be kept and searched again, so the query tree is built only once
+   * for any number of searches of the same query set.
+   *
+   * @code
+   * arma::mat queryCopy(querySet);
+   * std::vector<size_t> oldFromNewQueries;
+   * KDTree queryTree(queryCopy, oldFromNewQueries);
+   * for (size_t k = 1; k <= 10; ++k)
+   *   allknn.Search(&queryTree, oldFromNewQueries, k, neighbors, distances);
+   * @endcode
+   *
+   * @param queryTree Tree built on query points.
+   * @param oldFromNewQueries Original index of each point of the query tree.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *      point.
+   */
+  void Search(TreeType* queryTree,
+              const std::vector<size_t>& oldFromNewQueries,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
   /**
    * Search for the nearest neighbors of every point in the reference set.  This
    * is basically equivalent to calling any other overload of Search() with the
@@ -187,6 +243,65 @@ class NeighborSearch
   //! Modify whether or not search is done in single-tree mode.
   bool& SingleMode() { return singleMode; }
 
+  //! Get whether the traversal of query sets is chosen automatically.
+  bool AutoMode() const { return autoMode; }
+  //! Modify whether the traversal of query sets is chosen automatically.  If
+  //! true, Search() with a query set uses single-tree search when the query set
+  //! has fewer than AutoRatio() times as many points as the reference set, and
+  //! dual-tree search otherwise, because building a query tree does not pay off
+  //! for small batches of queries.  It is ignored in naive and single-tree
+  //! mode, and by the other overloads of Search().
+  bool& AutoMode() { return autoMode; }
+
+  //! Get the query set size (relative to the reference set) below which the
+  //! automatic mode uses single-tree search.
+  double AutoRatio() const { return autoRatio; }
+  //! Modify the query set size (relative to the reference set) below which the
+  //! automatic mode uses single-tree search.
+  double& AutoRatio() { return autoRatio; }
+
+  //! Get the relative error allowed in the results (0 for exact search).
+  double Epsilon() const { return epsilon; }
+  //! Modify the relative error allowed in the results.  With epsilon > 0, the
+  //! search prunes more aggressively and each returned distance is within a
+  //! factor of (1 + epsilon) of the true k'th-neighbor distance.  Naive search
+  //! is always exact.
+  double& Epsilon() { return epsilon; }
+
+  //! Get whether monochromatic dual-tree searches are done symmetrically.
+  bool Symmetric() const { return symmetric; }
+  //! Modify whether monochromatic dual-tree searches (Search() without a query
+  //! set) are done symmetrically: each pair of points is then only evaluated
+  //! once, and both candidate lists are updated, which nearly halves the base
+  //! cases.  The results do not change.  This is only used for trees whose
+  //! base cases are all done in leaf blocks (like kd-trees); it is ignored
+  //! otherwise.
+  bool& Symmetric() { return symmetric; }
+
+  //! Get whether single-tree searches are defeatist.
+  bool Defeatist() const { return defeatist; }
+  //! Modify whether single-tree searches are defeatist.  A defeatist search
+  //! descends to the most promising leaf first, and once k candidates have
+  //! been found, it only visits the reference nodes that are within the spill
+  //! distance of the query point (see Spill()), instead of every node that may
+  //! still hold a better neighbor.  The results are approximate, but the search
+  //! does not degrade to a scan of the whole tree in high dimensions.  This is
+  //! best used with trees that adapt to the data, like random projection trees
+  //! (see tree::RPTreeSplit).  It is ignored by naive and dual-tree search.
+  bool& Defeatist() { return defeatist; }
+
+  //! Get the spill distance of defeatist search.
+  double Spill() const { return spill; }
+  //! Modify the spill distance of defeatist search.  Reference nodes within
+  //! this distance of the query point are visited too, which has the same
+  //! effect as the overlapping buffers of a spill tree, without storing any
+  //! point twice.  0 (the default) visits only the nodes that contain the
+  //! query point.
+  double& Spill() { return spill; }
+
+  //! Access the reference dataset (possibly rearranged by tree building).
+  const typename TreeType::Mat& ReferenceSet() const { return referenceSet; }
+
  private:
   //! Copy of reference dataset (if we need it, because tree building modifies
   //! it).
@@ -211,11 +326,44 @@ class NeighborSearch
   //! Instantiation of metric.
   MetricType metric;
 
+  //! If true, the traversal of query sets is chosen automatically.
+  bool autoMode;
+  //! The relative query set size below which single-tree search is used.
+  double autoRatio;
+
+  //! Relative error allowed in the results (0 for exact search).
+  double epsilon;
+  //! If true, monochromatic dual-tree searches are done symmetrically.
+  bool symmetric;
+  //! If true, single-tree searches are defeatist.
+  bool defeatist;
+  //! The spill distance of defeatist search.
+  double spill;
+
   //! The total number of base cases.
   size_t baseCases;
   //! The total number of scores (applicable for non-naive search).
   size_t scores;
 
+  /**
+   * Perform single-tree search for every point in the given query set.  If
+   * OpenMP is available, the query points are split across threads; each
+   * thread holds its own NeighborSearchRules and traverser, and since each
+   * query point's column of the results matrices is only ever touched by the
+   * thread that handles that point, no locking is necessary.
+   *
+   * @param querySet Set of query points.
+   * @param neighbors Matrix storing lists of neighbors for each query point
+   *      (must already be initialized).
+   * @param distances Matrix storing distances of neighbors for each query
+   *      point (must already be initialized).
+   * @param sameSet Whether or not the query set is the reference set.
+   */
+  void SingleTreeSearch(const typename TreeType::Mat& querySet,
+                        arma::Mat<size_t>& neighbors,
+                        arma::mat& distances,
+                        const bool sameSet);
+
 }; // class NeighborSearch
 
 }; // namespace neighbor
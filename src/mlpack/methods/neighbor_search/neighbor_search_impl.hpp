@@ -11,6 +11,9 @@
 #include <mlpack/core.hpp>
 
 #include "neighbor_search_rules.hpp"
+#include "unmap.hpp"
+
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace neighbor {
@@ -56,6 +59,12 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
     naive(naive),
     singleMode(!naive && singleMode), // No single mode if naive.
     metric(metric),
+    autoMode(false),
+    autoRatio(0.1),
+    epsilon(0.0),
+    symmetric(false),
+    defeatist(false),
+    spill(0.0),
     baseCases(0),
     scores(0)
 {
@@ -74,12 +83,62 @@ NeighborSearch(const typename TreeType::Mat& referenceSetIn,
     referenceTree = BuildTree<TreeType>(
         const_cast<typename TreeType::Mat&>(referenceSet),
         oldFromNewReferences);
+
+    // The copy belongs to this object, so it can be spread over the NUMA
+    // nodes (if requested) now that the tree has rearranged it.
+    if (tree::TreeTraits<TreeType>::RearrangesDataset)
+      Numa::Distribute(referenceCopy);
   }
 
   // Stop the timer we started above.
   Timer::Stop("tree_building");
 }
 
+// Construct the object, building the tree in-place on the given dataset.
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         template<typename> class TraversalType>
+NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::
+NeighborSearch(typename TreeType::Mat& referenceSetIn,
+               std::vector<size_t>& oldFromNew,
+               const bool singleMode,
+               const MetricType metric) :
+    referenceSet(referenceSetIn),
+    referenceTree(NULL),
+    treeOwner(true),
+    naive(false),
+    singleMode(singleMode),
+    metric(metric),
+    autoMode(false),
+    autoRatio(0.1),
+    epsilon(0.0),
+    symmetric(false),
+    defeatist(false),
+    spill(0.0),
+    baseCases(0),
+    scores(0)
+{
+  // Build the tree directly on the given dataset; nothing is copied.
+  Timer::Start("tree_building");
+
+  referenceTree = BuildTree<TreeType>(referenceSetIn, oldFromNewReferences);
+
+  Timer::Stop("tree_building");
+
+  // If the tree does not rearrange the dataset, the mapping is the identity.
+  if (!tree::TreeTraits<TreeType>::RearrangesDataset)
+  {
+    oldFromNew.resize(referenceSetIn.n_cols);
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      oldFromNew[i] = i;
+  }
+  else
+  {
+    oldFromNew = oldFromNewReferences;
+  }
+}
+
 // Construct the object.
 template<typename SortPolicy,
          typename MetricType,
@@ -95,6 +154,12 @@ NeighborSearch(TreeType* referenceTree,
     naive(false),
     singleMode(singleMode),
     metric(metric),
+    autoMode(false),
+    autoRatio(0.1),
+    epsilon(0.0),
+    symmetric(false),
+    defeatist(false),
+    spill(0.0),
     baseCases(0),
     scores(0)
 {
@@ -132,33 +197,23 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   // This will hold mappings for query points, if necessary.
   std::vector<size_t> oldFromNewQueries;
 
-  // If we have built the trees ourselves, then we will have to map all the
-  // indices back to their original indices when this computation is finished.
-  // To avoid an extra copy, we will store the neighbors and distances in a
-  // separate matrix.
-  arma::Mat<size_t>* neighborPtr = &neighbors;
-  arma::mat* distancePtr = &distances;
-
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<TreeType>::RearrangesDataset)
-  {
-    if (!singleMode && !naive)
-      distancePtr = new arma::mat; // Query indices need to be mapped.
-
-    if (treeOwner)
-      neighborPtr = new arma::Mat<size_t>; // All indices need mapping.
-  }
+  // Set the size of the neighbor and distance matrices.  The results are
+  // computed in place; if the trees rearrange the points, they are mapped back
+  // to the original indices in place when the computation is finished.
+  neighbors.set_size(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
+  distances.set_size(k, querySet.n_cols);
+  distances.fill(SortPolicy::WorstDistance());
 
-  // Set the size of the neighbor and distance matrices.
-  neighborPtr->set_size(k, querySet.n_cols);
-  neighborPtr->fill(size_t() - 1);
-  distancePtr->set_size(k, querySet.n_cols);
-  distancePtr->fill(SortPolicy::WorstDistance());
+  // A tree on a small query set costs more than it saves, so in automatic mode
+  // small query sets are searched in single-tree mode.
+  const bool single = singleMode || (autoMode && !naive &&
+      querySet.n_cols < autoRatio * referenceSet.n_cols);
 
   // If we will be building a tree and it will modify the query set, make a copy
   // of the dataset.
   typename TreeType::Mat queryCopy;
-  const bool needsCopy = (!naive && !singleMode &&
+  const bool needsCopy = (!naive && !single &&
       tree::TreeTraits<TreeType>::RearrangesDataset);
   if (needsCopy)
     queryCopy = querySet;
@@ -168,7 +223,8 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
 
   // Create the helper object for the tree traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, querySetRef, *neighborPtr, *distancePtr, metric);
+  RuleType rules(referenceSet, querySetRef, neighbors, distances, metric,
+      false, epsilon);
 
   if (naive)
   {
@@ -179,20 +235,9 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
 
     baseCases += querySet.n_cols * referenceSet.n_cols;
   }
-  else if (singleMode)
+  else if (single)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    scores += rules.Scores();
-    baseCases += rules.BaseCases();
-
-    Log::Info << rules.Scores() << " node combinations were scored.\n";
-    Log::Info << rules.BaseCases() << " base cases were calculated.\n";
+    SingleTreeSearch(querySetRef, neighbors, distances, false);
   }
   else // Dual-tree recursion.
   {
@@ -208,6 +253,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     TraversalType<RuleType> traverser(rules);
 
     traverser.Traverse(*queryTree, *referenceTree);
+    tree::RecordTraversal("neighbor_search", traverser, rules);
 
     scores += rules.Scores();
     baseCases += rules.BaseCases();
@@ -218,65 +264,22 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     delete queryTree;
   }
 
+  // Candidate lists that were kept as heaps are sorted once at the end.
+  if (NeighborHeap<SortPolicy>::UseHeap(k))
+    NeighborHeap<SortPolicy>::Sort(distances, neighbors);
+
   Timer::Stop("computing_neighbors");
 
   // Map points back to original indices, if necessary.
   if (tree::TreeTraits<TreeType>::RearrangesDataset)
   {
-    if (!singleMode && !naive && treeOwner)
-    {
-      // We must map both query and reference indices.
-      neighbors.set_size(k, querySet.n_cols);
-      distances.set_size(k, querySet.n_cols);
-
-      for (size_t i = 0; i < distances.n_cols; i++)
-      {
-        // Map distances (copy a column).
-        distances.col(oldFromNewQueries[i]) = distancePtr->col(i);
-
-        // Map indices of neighbors.
-        for (size_t j = 0; j < distances.n_rows; j++)
-        {
-          neighbors(j, oldFromNewQueries[i]) =
-              oldFromNewReferences[(*neighborPtr)(j, i)];
-        }
-      }
-
-      // Finished with temporary matrices.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (!singleMode && !naive)
-    {
-      // We must map query indices only.
-      neighbors.set_size(k, querySet.n_cols);
-      distances.set_size(k, querySet.n_cols);
-
-      for (size_t i = 0; i < distances.n_cols; ++i)
-      {
-        // Map distances (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances.col(queryMapping) = distancePtr->col(i);
-        neighbors.col(queryMapping) = neighborPtr->col(i);
-      }
-
-      // Finished with temporary matrices.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (treeOwner)
-    {
-      // We must map reference indices only.
-      neighbors.set_size(k, querySet.n_cols);
-
-      // Map indices of neighbors.
-      for (size_t i = 0; i < neighbors.n_cols; i++)
-        for (size_t j = 0; j < neighbors.n_rows; j++)
-          neighbors(j, i) = oldFromNewReferences[(*neighborPtr)(j, i)];
+    // The query tree rearranged the query points.
+    if (!single && !naive)
+      UnmapQueries(neighbors, distances, oldFromNewQueries);
 
-      // Finished with temporary matrix.
-      delete neighborPtr;
-    }
+    // We built the reference tree, so the reference indices must be mapped.
+    if (treeOwner)
+      Unmap(neighbors, distances, oldFromNewReferences);
   }
 } // Search()
 
@@ -300,44 +303,59 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     throw std::invalid_argument("cannot call NeighborSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
-  // We won't need to map query indices, but will we need to map distances?
-  arma::Mat<size_t>* neighborPtr = &neighbors;
-
-  if (treeOwner && tree::TreeTraits<TreeType>::RearrangesDataset)
-    neighborPtr = new arma::Mat<size_t>;
-
-  neighborPtr->set_size(k, querySet.n_cols);
-  neighborPtr->fill(size_t() - 1);
+  // We won't need to map query indices, but we may need to map reference
+  // indices, which is done in place at the end.
+  neighbors.set_size(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
   distances.set_size(k, querySet.n_cols);
   distances.fill(SortPolicy::WorstDistance());
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, querySet, *neighborPtr, distances, metric);
+  RuleType rules(referenceSet, querySet, neighbors, distances, metric,
+      false, epsilon);
 
   // Create the traverser.
   TraversalType<RuleType> traverser(rules);
   traverser.Traverse(*queryTree, *referenceTree);
+  tree::RecordTraversal("neighbor_search", traverser, rules);
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
 
+  // Candidate lists that were kept as heaps are sorted once at the end.
+  if (NeighborHeap<SortPolicy>::UseHeap(k))
+    NeighborHeap<SortPolicy>::Sort(distances, neighbors);
+
   Timer::Stop("computing_neighbors");
 
-  // Do we need to map indices?
+  // Do we need to map indices?  We must map reference indices only.
   if (treeOwner && tree::TreeTraits<TreeType>::RearrangesDataset)
-  {
-    // We must map reference indices only.
-    neighbors.set_size(k, querySet.n_cols);
-
-    // Map indices of neighbors.
-    for (size_t i = 0; i < neighbors.n_cols; i++)
-      for (size_t j = 0; j < neighbors.n_rows; j++)
-        neighbors(j, i) = oldFromNewReferences[(*neighborPtr)(j, i)];
+    Unmap(neighbors, distances, oldFromNewReferences);
+}
 
-    // Finished with temporary matrix.
-    delete neighborPtr;
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         template<typename> class TraversalType>
+void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
+    TreeType* queryTree,
+    const std::vector<size_t>& oldFromNewQueries,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (oldFromNewQueries.size() != queryTree->Dataset().n_cols)
+  {
+    Log::Fatal << "NeighborSearch::Search(): the query mapping has "
+        << oldFromNewQueries.size() << " entries, but the query tree has "
+        << queryTree->Dataset().n_cols << " points." << std::endl;
   }
+
+  // The reference indices are mapped by the other overload; only the columns
+  // are left.
+  Search(queryTree, k, neighbors, distances);
+  UnmapQueries(neighbors, distances, oldFromNewQueries);
 }
 
 template<typename SortPolicy,
@@ -351,26 +369,20 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
 {
   Timer::Start("computing_neighbors");
 
-  arma::Mat<size_t>* neighborPtr = &neighbors;
-  arma::mat* distancePtr = &distances;
-
-  if (tree::TreeTraits<TreeType>::RearrangesDataset && treeOwner)
-  {
-    // We will always need to rearrange in this case.
-    distancePtr = new arma::mat;
-    neighborPtr = new arma::Mat<size_t>;
-  }
-
-  // Initialize results.
-  neighborPtr->set_size(k, referenceSet.n_cols);
-  neighborPtr->fill(size_t() - 1);
-  distancePtr->set_size(k, referenceSet.n_cols);
-  distancePtr->fill(SortPolicy::WorstDistance());
+  // Initialize results.  If we built the tree, they are mapped back to the
+  // original indices in place at the end.
+  neighbors.set_size(k, referenceSet.n_cols);
+  neighbors.fill(size_t() - 1);
+  distances.set_size(k, referenceSet.n_cols);
+  distances.fill(SortPolicy::WorstDistance());
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, referenceSet, *neighborPtr, *distancePtr,
-      metric, true /* don't return the same point as nearest neighbor */);
+  // Symmetric evaluation is only possible if all base cases of the dual-tree
+  // traversal are done in leaf blocks.
+  RuleType rules(referenceSet, referenceSet, neighbors, distances,
+      metric, true /* don't return the same point as nearest neighbor */,
+      epsilon, symmetric && tree::TreeTraits<TreeType>::HasContiguousLeaves);
 
   if (naive)
   {
@@ -383,18 +395,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    scores += rules.Scores();
-    baseCases += rules.BaseCases();
-
-    Log::Info << rules.Scores() << " node combinations were scored.\n";
-    Log::Info << rules.BaseCases() << " base cases were calculated.\n";
+    SingleTreeSearch(referenceSet, neighbors, distances, true);
   }
   else
   {
@@ -402,6 +403,7 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     TraversalType<RuleType> traverser(rules);
 
     traverser.Traverse(*referenceTree, *referenceTree);
+    tree::RecordTraversal("neighbor_search", traverser, rules);
 
     scores += rules.Scores();
     baseCases += rules.BaseCases();
@@ -410,29 +412,79 @@ void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::Search(
     Log::Info << rules.BaseCases() << " base cases were calculated.\n";
   }
 
+  // Candidate lists that were kept as heaps are sorted once at the end.
+  if (NeighborHeap<SortPolicy>::UseHeap(k))
+    NeighborHeap<SortPolicy>::Sort(distances, neighbors);
+
   Timer::Stop("computing_neighbors");
 
-  // Do we need to map the reference indices?
+  // Do we need to map the reference indices?  The queries are the references
+  // here, so both the columns and the entries are mapped.
   if (treeOwner && tree::TreeTraits<TreeType>::RearrangesDataset)
+    Unmap(neighbors, distances, oldFromNewReferences, oldFromNewReferences);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename TreeType,
+         template<typename> class TraversalType>
+void NeighborSearch<SortPolicy, MetricType, TreeType, TraversalType>::
+SingleTreeSearch(const typename TreeType::Mat& querySet,
+                 arma::Mat<size_t>& neighbors,
+                 arma::mat& distances,
+                 const bool sameSet)
+{
+  typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
+
+  // Trees whose first point is the centroid and which have self-children cache
+  // the last base case in the reference node statistics during Score(), so
+  // concurrent traversals of the same reference tree would race on that cache.
+  const bool parallel = !(tree::TreeTraits<TreeType>::FirstPointIsCentroid &&
+      tree::TreeTraits<TreeType>::HasSelfChildren);
+
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+
+  // With the NUMA-aware placement, the threads are pinned to their nodes and
+  // take the queries stored on their node first.
+  const bool numa = Numa::Enabled() && parallel;
+  if (numa)
+    Numa::PinThreads();
+  NumaScheduler scheduler(querySet.n_cols, 16);
+
+  #pragma omp parallel if(parallel) reduction(+:totalScores,totalBaseCases)
   {
-    neighbors.set_size(k, referenceSet.n_cols);
-    distances.set_size(k, referenceSet.n_cols);
+    // Each thread gets its own rules and traverser.
+    RuleType rules(referenceSet, querySet, neighbors, distances, metric,
+        sameSet, epsilon, false, defeatist, spill);
+    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
 
-    for (size_t i = 0; i < distances.n_cols; ++i)
+    // Now have it traverse for each point.  Queries can take very different
+    // amounts of time, so schedule dynamically.
+    if (numa)
     {
-      // Map distances (copy a column).
-      const size_t refMapping = oldFromNewReferences[i];
-      distances.col(refMapping) = distancePtr->col(i);
-
-      // Map each neighbor's index.
-      for (size_t j = 0; j < distances.n_rows; ++j)
-        neighbors(j, refMapping) = oldFromNewReferences[(*neighborPtr)(j, i)];
+      size_t begin, end;
+      while (scheduler.Next(begin, end))
+        for (size_t i = begin; i < end; ++i)
+          traverser.Traverse(i, *referenceTree);
+    }
+    else
+    {
+      #pragma omp for schedule(dynamic, 16)
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
     }
+    tree::RecordTraversal("neighbor_search", traverser, rules);
 
-    // Finished with temporary matrices.
-    delete neighborPtr;
-    delete distancePtr;
+    totalScores += rules.Scores();
+    totalBaseCases += rules.BaseCases();
   }
+
+  scores += totalScores;
+  baseCases += totalBaseCases;
+
+  Log::Info << totalScores << " node combinations were scored.\n";
+  Log::Info << totalBaseCases << " base cases were calculated.\n";
 }
 
 // Return a String of the Object.
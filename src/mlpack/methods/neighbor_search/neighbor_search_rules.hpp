@@ -8,6 +8,9 @@
 #ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 #define __MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <set>
+#include "neighbor_heap.hpp"
 #include "ns_traversal_info.hpp"
 
 namespace mlpack {
@@ -22,7 +25,11 @@ class NeighborSearchRules
                       arma::Mat<size_t>& neighbors,
                       arma::mat& distances,
                       MetricType& metric,
-                      const bool sameSet = false);
+                      const bool sameSet = false,
+                      const double epsilon = 0.0,
+                      const bool symmetric = false,
+                      const bool defeatist = false,
+                      const double spill = 0.0);
   /**
    * Get the distance from the query point to the reference point.
    * This will update the "neighbor" matrix with the new point if appropriate
@@ -33,6 +40,33 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Perform the base cases between every query point in [queryBegin, queryEnd)
+   * and every reference point in [referenceBegin, referenceEnd), as if
+   * BaseCase() was called for every pair in turn.  The traversers call this
+   * for pairs of leaves.  For the Euclidean distance, the block of distances
+   * is bounded first with a single matrix product, and only the pairs that
+   * may be inserted into the neighbor lists are evaluated exactly, so the
+   * results are identical to those of BaseCase().
+   *
+   * In symmetric mode (a monochromatic search), each evaluated distance is
+   * inserted into the candidate lists of both points, pairs within one leaf
+   * are only evaluated once, and a block is skipped entirely if its mirror
+   * image has already been evaluated.  This halves the base cases without
+   * changing the results; it requires that all base cases go through
+   * BaseCaseBlock() (see TreeTraits::HasContiguousLeaves).
+   *
+   * @param queryBegin Index of first query point.
+   * @param queryEnd Index one past the last query point.
+   * @param referenceBegin Index of first reference point.
+   * @param referenceEnd Index one past the last reference point.
+   * @return The number of base cases that were performed.
+   */
+  size_t BaseCaseBlock(const size_t queryBegin,
+                   const size_t queryEnd,
+                   const size_t referenceBegin,
+                   const size_t referenceEnd);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -120,6 +154,29 @@ class NeighborSearchRules
   //! Denotes whether or not the reference and query sets are the same.
   bool sameSet;
 
+  //! Relative error allowed in the results; the pruning bounds are relaxed by
+  //! a factor of (1 + epsilon).  0 means exact search.
+  double epsilon;
+
+  //! If true, BaseCaseBlock() evaluates each unordered pair of points only
+  //! once (only used when sameSet is true).
+  bool symmetric;
+
+  //! If true, single-tree search is defeatist: once the candidate list of a
+  //! query point is full, only nodes within the spill distance are visited.
+  bool defeatist;
+
+  //! The spill distance of defeatist search.
+  double spill;
+
+  //! In symmetric mode, the (query begin, reference begin) pairs of the leaf
+  //! blocks that have been evaluated.
+  std::set<std::pair<size_t, size_t> > evaluatedBlocks;
+
+  //! Whether or not the candidate lists are heaps (see NeighborHeap); if not,
+  //! they are kept sorted.
+  bool heap;
+
   //! The last query point BaseCase() was called with.
   size_t lastQueryIndex;
   //! The last reference point BaseCase() was called with.
@@ -136,6 +193,74 @@ class NeighborSearchRules
   //! traversal before each call to Score().
   TraversalInfoType traversalInfo;
 
+  //! The element type of the datasets (the block is computed in it).
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  //! The inner products of the last block of base cases.
+  arma::Mat<ElemType> blockProducts;
+  //! The squared norms of the query points of the last block of base cases.
+  arma::Row<ElemType> blockQueryNorms;
+  //! The squared norms of the reference points of the last block of base
+  //! cases.
+  arma::Row<ElemType> blockReferenceNorms;
+
+  /**
+   * Perform a block of base cases with any metric, by calling BaseCase() for
+   * every pair.
+   */
+  template<typename OtherMetricType>
+  size_t EvaluateBlock(const OtherMetricType& /* metric */,
+                        const size_t queryBegin,
+                        const size_t queryEnd,
+                        const size_t referenceBegin,
+                        const size_t referenceEnd);
+
+  /**
+   * Perform a block of base cases with the Euclidean distance.  The squared
+   * distances are computed with the expansion ||q||^2 + ||r||^2 - 2 q^T r,
+   * and a pair is only evaluated exactly if the distance may be inserted
+   * into the neighbor list given the rounding error of the expansion.
+   */
+  template<bool TakeRoot>
+  size_t EvaluateBlock(const metric::LMetric<2, TakeRoot>& /* metric */,
+                        const size_t queryBegin,
+                        const size_t queryEnd,
+                        const size_t referenceBegin,
+                        const size_t referenceEnd);
+
+  //! Return the worst distance in the candidate list of the given query point.
+  double WorstDistance(const size_t queryIndex) const
+  {
+    return heap ? NeighborHeap<SortPolicy>::WorstDistance(distances,
+        queryIndex) : distances(distances.n_rows - 1, queryIndex);
+  }
+
+  /**
+   * Insert the given reference point into the candidate list of the given
+   * query point, if it is good enough.
+   */
+  void AddCandidate(const size_t queryIndex,
+                    const size_t referenceIndex,
+                    const double distance);
+
+  /**
+   * Evaluate the distance between two distinct points and insert each point
+   * into the candidate list of the other (symmetric mode only).
+   */
+  void SymmetricBaseCase(const size_t first, const size_t second);
+
+  /**
+   * Return whether a reference node with the given score must be skipped by
+   * defeatist search for the given query point.
+   */
+  bool DefeatistPrune(const size_t queryIndex, const double distance) const
+  {
+    return defeatist &&
+        (WorstDistance(queryIndex) != SortPolicy::WorstDistance()) &&
+        SortPolicy::IsBetter(SortPolicy::CombineWorst(
+        SortPolicy::BestDistance(), spill), distance);
+  }
+
   /**
    * Recalculate the bound for a given query node.
    */
@@ -20,13 +20,22 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances,
     MetricType& metric,
-    const bool sameSet) :
+    const bool sameSet,
+    const double epsilon,
+    const bool symmetric,
+    const bool defeatist,
+    const double spill) :
     referenceSet(referenceSet),
     querySet(querySet),
     neighbors(neighbors),
     distances(distances),
     metric(metric),
     sameSet(sameSet),
+    epsilon(epsilon),
+    symmetric(sameSet && symmetric),
+    defeatist(defeatist),
+    spill(spill),
+    heap(NeighborHeap<SortPolicy>::UseHeap(neighbors.n_rows)),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
@@ -57,16 +66,7 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
                                     referenceSet.col(referenceIndex));
   ++baseCases;
 
-  // If this distance is better than any of the current candidates, the
-  // SortDistance() function will give us the position to insert it into.
-  arma::vec queryDist = distances.unsafe_col(queryIndex);
-  arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
-  const size_t insertPosition = SortPolicy::SortDistance(queryDist,
-      queryIndices, distance);
-
-  // SortDistance() returns (size_t() - 1) if we shouldn't add it.
-  if (insertPosition != (size_t() - 1))
-    InsertNeighbor(queryIndex, insertPosition, referenceIndex, distance);
+  AddCandidate(queryIndex, referenceIndex, distance);
 
   // Cache this information for the next time BaseCase() is called.
   lastQueryIndex = queryIndex;
@@ -76,6 +76,179 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline force_inline
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::AddCandidate(
+    const size_t queryIndex,
+    const size_t referenceIndex,
+    const double distance)
+{
+  if (heap)
+  {
+    NeighborHeap<SortPolicy>::Insert(distances, neighbors, queryIndex,
+        referenceIndex, distance);
+  }
+  else
+  {
+    // If this distance is better than any of the current candidates, the
+    // SortDistance() function will give us the position to insert it into.
+    arma::vec queryDist = distances.unsafe_col(queryIndex);
+    arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
+    const size_t insertPosition = SortPolicy::SortDistance(queryDist,
+        queryIndices, distance);
+
+    // SortDistance() returns (size_t() - 1) if we shouldn't add it.
+    if (insertPosition != (size_t() - 1))
+      InsertNeighbor(queryIndex, insertPosition, referenceIndex, distance);
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+inline force_inline
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::SymmetricBaseCase(
+    const size_t first,
+    const size_t second)
+{
+  const double distance = metric.Evaluate(querySet.col(first),
+      querySet.col(second));
+  ++baseCases;
+
+  AddCandidate(first, second, distance);
+  AddCandidate(second, first, distance);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::BaseCaseBlock(
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  if (symmetric)
+  {
+    // Empty leaves may share their Begin() with another leaf, so they must
+    // not be recorded.
+    if (queryBegin == queryEnd || referenceBegin == referenceEnd)
+      return 0;
+
+    // If the mirrored block has been evaluated, every pair of this block has
+    // already been inserted into the candidate lists of both points.
+    if (evaluatedBlocks.count(std::make_pair(referenceBegin, queryBegin)))
+      return 0;
+
+    evaluatedBlocks.insert(std::make_pair(queryBegin, referenceBegin));
+  }
+
+  return EvaluateBlock(metric, queryBegin, queryEnd, referenceBegin,
+      referenceEnd);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename OtherMetricType>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::EvaluateBlock(
+    const OtherMetricType& /* metric */,
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  if (symmetric)
+  {
+    // Within a single leaf, only evaluate each unordered pair once.
+    const bool sameBlock = (queryBegin == referenceBegin);
+    size_t numPairs = 0;
+    for (size_t query = queryBegin; query < queryEnd; ++query)
+    {
+      for (size_t ref = (sameBlock ? query + 1 : referenceBegin);
+          ref < referenceEnd; ++ref)
+      {
+        SymmetricBaseCase(query, ref);
+        ++numPairs;
+      }
+    }
+
+    return numPairs;
+  }
+
+  for (size_t query = queryBegin; query < queryEnd; ++query)
+    for (size_t ref = referenceBegin; ref < referenceEnd; ++ref)
+      BaseCase(query, ref);
+
+  return (queryEnd - queryBegin) * (referenceEnd - referenceBegin);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool TakeRoot>
+size_t NeighborSearchRules<SortPolicy, MetricType, TreeType>::EvaluateBlock(
+    const metric::LMetric<2, TakeRoot>& /* metric */,
+    const size_t queryBegin,
+    const size_t queryEnd,
+    const size_t referenceBegin,
+    const size_t referenceEnd)
+{
+  const size_t numPairs = (queryEnd - queryBegin) *
+      (referenceEnd - referenceBegin);
+  if (numPairs == 0)
+    return 0;
+
+  blockProducts = trans(querySet.cols(queryBegin, queryEnd - 1)) *
+      referenceSet.cols(referenceBegin, referenceEnd - 1);
+  blockQueryNorms = sum(square(querySet.cols(queryBegin, queryEnd - 1)), 0);
+  blockReferenceNorms = sum(square(referenceSet.cols(referenceBegin,
+      referenceEnd - 1)), 0);
+
+  // The rounding error of each term of the expansion is bounded by a small
+  // multiple of the dimensionality times the squared norms, in the precision
+  // of the data (BaseCase() computes in that precision too).
+  const double roundingSlack = 4.0 * (querySet.n_rows + 2) *
+      std::numeric_limits<ElemType>::epsilon();
+
+  // In symmetric mode, the pairs within a single leaf are only evaluated once.
+  const bool sameBlock = symmetric && (queryBegin == referenceBegin);
+  const size_t blockPairs = sameBlock ? numPairs -
+      (queryEnd - queryBegin) * (queryEnd - queryBegin + 1) / 2 : numPairs;
+
+  size_t exactBaseCases = 0;
+  for (size_t query = queryBegin; query < queryEnd; ++query)
+  {
+    const size_t i = query - queryBegin;
+    for (size_t ref = (sameBlock ? query + 1 : referenceBegin);
+        ref < referenceEnd; ++ref)
+    {
+      const size_t j = ref - referenceBegin;
+      const double magnitude = blockQueryNorms[i] + blockReferenceNorms[j];
+      const double squared = magnitude - 2 * blockProducts(i, j);
+      const double slack = roundingSlack * magnitude;
+
+      double lo = std::max(squared - slack, 0.0);
+      double hi = std::max(squared + slack, 0.0);
+      if (TakeRoot)
+      {
+        lo = sqrt(lo);
+        hi = sqrt(hi);
+      }
+
+      // If even the best possible distance would not be inserted, skip the
+      // pair.  In symmetric mode, the pair could go into either list.
+      const double bestPossible = SortPolicy::IsBetter(lo, hi) ? lo : hi;
+      if (SortPolicy::IsBetter(WorstDistance(query), bestPossible) &&
+          (!symmetric || SortPolicy::IsBetter(WorstDistance(ref),
+          bestPossible)))
+        continue;
+
+      if (symmetric)
+        SymmetricBaseCase(query, ref);
+      else
+        BaseCase(query, ref);
+      ++exactBaseCases;
+    }
+  }
+
+  // The skipped pairs count as base cases too.
+  baseCases += blockPairs - exactBaseCases;
+  return blockPairs;
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -111,8 +284,13 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
         &referenceNode);
   }
 
-  // Compare against the best k'th distance for this query point so far.
-  const double bestDistance = distances(distances.n_rows - 1, queryIndex);
+  // Compare against the best k'th distance for this query point so far,
+  // relaxed if approximate search was requested.
+  const double bestDistance = SortPolicy::Relax(WorstDistance(queryIndex),
+      epsilon);
+
+  if (DefeatistPrune(queryIndex, distance))
+    return DBL_MAX;
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? distance : DBL_MAX;
 }
@@ -127,8 +305,13 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   if (oldScore == DBL_MAX)
     return oldScore;
 
+  // The candidate list may have been filled since the node was scored.
+  if (DefeatistPrune(queryIndex, oldScore))
+    return DBL_MAX;
+
   // Just check the score again against the distances.
-  const double bestDistance = distances(distances.n_rows - 1, queryIndex);
+  const double bestDistance = SortPolicy::Relax(WorstDistance(queryIndex),
+      epsilon);
 
   return (SortPolicy::IsBetter(oldScore, bestDistance)) ? oldScore : DBL_MAX;
 }
@@ -140,8 +323,10 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
 {
   ++scores; // Count number of Score() calls.
 
-  // Update our bound.
-  const double bestDistance = CalculateBound(queryNode);
+  // Update our bound.  The cached bounds stay exact; only the bound used for
+  // pruning is relaxed for approximate search.
+  const double bestDistance = SortPolicy::Relax(CalculateBound(queryNode),
+      epsilon);
 
   // Use the traversal info to see if a parent-child or parent-parent prune is
   // possible.  This is a looser bound than we could make, but it might be
@@ -304,7 +489,8 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
     return oldScore;
 
   // Update our bound.
-  const double bestDistance = CalculateBound(queryNode);
+  const double bestDistance = SortPolicy::Relax(CalculateBound(queryNode),
+      epsilon);
 
   return (SortPolicy::IsBetter(oldScore, bestDistance)) ? oldScore : DBL_MAX;
 }
@@ -348,7 +534,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = distances(distances.n_rows - 1, queryNode.Point(i));
+    const double distance = WorstDistance(queryNode.Point(i));
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestDistance))
@@ -0,0 +1,142 @@
+/**
+ * @file quantized_allknn.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the exact k-nearest-neighbor search on a quantized
+ * reference set.
+ */
+#include "quantized_allknn.hpp"
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+QuantizedAllkNN::QuantizedAllkNN(const arma::mat& referenceSet) :
+    referenceSet(referenceSet),
+    codes(referenceSet.n_rows, referenceSet.n_cols),
+    offsets(referenceSet.n_rows),
+    scales(referenceSet.n_rows),
+    maxError(0.0),
+    exactDistances(0)
+{
+  if (referenceSet.n_cols == 0)
+  {
+    offsets.zeros();
+    scales.zeros();
+    return;
+  }
+
+  offsets = arma::min(referenceSet, 1);
+  scales = (arma::max(referenceSet, 1) - offsets) / 255.0;
+
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    for (size_t d = 0; d < referenceSet.n_rows; ++d)
+    {
+      const double level = (scales[d] > 0.0) ?
+          (referenceSet(d, i) - offsets[d]) / scales[d] : 0.0;
+      codes(d, i) = (unsigned char) std::min(std::floor(level + 0.5), 255.0);
+    }
+  }
+
+  // Every element is within half a level of its quantized value.  Leave some
+  // room for the rounding of the quantized distances.
+  maxError = 0.5 * arma::norm(scales, 2) * (1.0 + 1e-10) + 1e-300;
+}
+
+void QuantizedAllkNN::Search(const arma::mat& querySet,
+                             const size_t k,
+                             arma::Mat<size_t>& neighbors,
+                             arma::mat& distances)
+{
+  SearchQueries(querySet, false, k, neighbors, distances);
+}
+
+void QuantizedAllkNN::Search(const size_t k,
+                             arma::Mat<size_t>& neighbors,
+                             arma::mat& distances)
+{
+  SearchQueries(referenceSet, true, k, neighbors, distances);
+}
+
+void QuantizedAllkNN::SearchQueries(const arma::mat& querySet,
+                                    const bool sameSet,
+                                    const size_t k,
+                                    arma::Mat<size_t>& neighbors,
+                                    arma::mat& distances)
+{
+  const size_t numReferences = referenceSet.n_cols - (sameSet ? 1 : 0);
+  if (k > numReferences)
+  {
+    Log::Fatal << "QuantizedAllkNN::Search(): cannot find " << k
+        << " neighbors among " << numReferences << " reference points!"
+        << std::endl;
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  exactDistances = 0;
+  if (k == 0)
+    return;
+
+  const size_t dim = referenceSet.n_rows;
+  size_t totalExactDistances = 0;
+
+  #pragma omp parallel reduction(+:totalExactDistances)
+  {
+    // Each thread gets its own buffers.
+    std::vector<double> approximate(referenceSet.n_cols);
+    std::vector<double> sorted(referenceSet.n_cols);
+    std::vector<std::pair<double, size_t> > candidates;
+
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      const double* query = querySet.colptr(q);
+
+      // Scan the quantized points.
+      for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      {
+        const unsigned char* code = codes.colptr(i);
+        double sum = 0.0;
+        for (size_t d = 0; d < dim; ++d)
+        {
+          const double diff = query[d] - (offsets[d] + scales[d] * code[d]);
+          sum += diff * diff;
+        }
+        approximate[i] = sqrt(sum);
+      }
+
+      if (sameSet)
+        approximate[q] = DBL_MAX;
+
+      // Find the k'th smallest quantized distance.
+      std::copy(approximate.begin(), approximate.end(), sorted.begin());
+      std::nth_element(sorted.begin(), sorted.begin() + (k - 1), sorted.end());
+      const double threshold = sorted[k - 1] + 2 * maxError;
+
+      // Re-rank the candidates that may be among the k nearest neighbors.
+      candidates.clear();
+      for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      {
+        if (approximate[i] <= threshold)
+        {
+          candidates.push_back(std::make_pair(metric::EuclideanDistance::
+              Evaluate(querySet.col(q), referenceSet.col(i)), i));
+        }
+      }
+      totalExactDistances += candidates.size();
+
+      std::partial_sort(candidates.begin(), candidates.begin() + k,
+          candidates.end());
+      for (size_t j = 0; j < k; ++j)
+      {
+        distances(j, q) = candidates[j].first;
+        neighbors(j, q) = candidates[j].second;
+      }
+    }
+  }
+
+  exactDistances = totalExactDistances;
+}
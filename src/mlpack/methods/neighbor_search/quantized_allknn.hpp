@@ -0,0 +1,115 @@
+/**
+ * @file quantized_allknn.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of QuantizedAllkNN, an exact k-nearest-neighbor search that scans
+ * an 8-bit quantized copy of the reference set and re-ranks the candidates
+ * with the full-precision points.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_QUANTIZED_ALLKNN_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_QUANTIZED_ALLKNN_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * An exact Euclidean k-nearest-neighbor search on a quantized reference set.
+ * Every dimension of the reference set is quantized to 256 evenly spaced
+ * levels between its minimum and maximum, so the scanned codes take one byte
+ * per element instead of eight.
+ *
+ * The quantization error of every point is bounded by the half-diagonal e of a
+ * quantization cell, so the true distance of a point is within e of its
+ * distance to the quantized point.  For every query point, the distances to
+ * all quantized points are computed; if a is the k'th smallest of them, no
+ * point whose quantized distance is above a + 2e can be one of the k nearest
+ * neighbors.  Only the remaining candidates are re-ranked with their exact
+ * distances to the full-precision points, so the results are the same as
+ * those of an exact search.
+ *
+ * @code
+ * QuantizedAllkNN knn(referenceSet);
+ * knn.Search(querySet, k, neighbors, distances);
+ * @endcode
+ */
+class QuantizedAllkNN
+{
+ public:
+  /**
+   * Quantize the given reference set.  The reference set is not copied; it is
+   * only read to re-rank the candidates, so it has to stay valid as long as
+   * this object is used.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  QuantizedAllkNN(const arma::mat& referenceSet);
+
+  /**
+   * Find the k nearest neighbors in the reference set of every point of the
+   * query set.  The neighbors of every point are sorted by distance.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to find.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances of the neighbors in.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Find the k nearest neighbors of every point of the reference set, not
+   * counting the point itself.
+   *
+   * @param k Number of neighbors to find.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances of the neighbors in.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the quantized reference set.
+  const arma::Mat<unsigned char>& Codes() const { return codes; }
+  //! Get the value of the lowest level of every dimension.
+  const arma::vec& Offsets() const { return offsets; }
+  //! Get the distance between two levels of every dimension.
+  const arma::vec& Scales() const { return scales; }
+  //! Get the bound on the distance between a point and its quantized point.
+  double MaxError() const { return maxError; }
+
+  //! Get the number of exact distances computed in the last search.
+  size_t ExactDistances() const { return exactDistances; }
+
+ private:
+  /**
+   * Search the neighbors of the given query points.  If sameSet is true, the
+   * query points are the reference points, and no point is its own neighbor.
+   */
+  void SearchQueries(const arma::mat& querySet,
+                     const bool sameSet,
+                     const size_t k,
+                     arma::Mat<size_t>& neighbors,
+                     arma::mat& distances);
+
+  //! The full-precision reference set.
+  const arma::mat& referenceSet;
+  //! The quantized reference set.
+  arma::Mat<unsigned char> codes;
+  //! The value of the lowest level of every dimension.
+  arma::vec offsets;
+  //! The distance between two levels of every dimension.
+  arma::vec scales;
+  //! The half-diagonal of a quantization cell.
+  double maxError;
+  //! The number of exact distances computed in the last search.
+  size_t exactDistances;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,266 @@
+/**
+ * @file search_advisor.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of SearchAdvisor, which chooses how to run a
+ * k-nearest-neighbor search.
+ */
+#include "search_advisor.hpp"
+
+#include <mlpack/core/tree/cover_tree.hpp>
+#include <limits>
+
+#include "neighbor_search.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+SearchAdvisor::SearchAdvisor(const size_t k,
+                             const double epsilon,
+                             const size_t sampleSize) :
+    k(k),
+    epsilon(epsilon),
+    sampleSize(sampleSize),
+    intrinsicDimension(0.0)
+{
+  const size_t defaultLeafSizes[] = { 5, 10, 20, 40, 80 };
+  leafSizes.assign(defaultLeafSizes, defaultLeafSizes + 5);
+
+  best.tree = NAIVE;
+  best.leafSize = 0;
+  best.singleMode = false;
+  best.baseCases = 0;
+  best.scores = 0;
+  best.time = 0.0;
+  best.estimatedCost = 0.0;
+}
+
+void SearchAdvisor::Advise(const arma::mat& referenceSet)
+{
+  Advise(referenceSet, referenceSet, true);
+}
+
+void SearchAdvisor::Advise(const arma::mat& referenceSet,
+                           const arma::mat& querySet)
+{
+  Advise(referenceSet, querySet, false);
+}
+
+double SearchAdvisor::EstimateDimension(const arma::mat& distances)
+{
+  // The estimate of each point is (K - 1) / sum_j log(T_K / T_j), where T_j is
+  // the distance to the j'th neighbor; the inverses of the estimates are
+  // averaged.
+  double inverseSum = 0.0;
+  size_t count = 0;
+  for (size_t i = 0; (distances.n_rows > 1) && (i < distances.n_cols); ++i)
+  {
+    if (distances(0, i) <= 0.0)
+      continue; // Duplicate points have no estimate.
+
+    const double last = distances(distances.n_rows - 1, i);
+    double sum = 0.0;
+    for (size_t j = 0; j < distances.n_rows - 1; ++j)
+      sum += std::log(last / distances(j, i));
+
+    inverseSum += sum / (distances.n_rows - 1);
+    ++count;
+  }
+
+  // If the neighbors of every point are at the same distance, the points are
+  // as spread out as they can be.
+  if (count == 0 || inverseSum <= 0.0)
+    return std::numeric_limits<double>::infinity();
+
+  return count / inverseSum;
+}
+
+void SearchAdvisor::Advise(const arma::mat& referenceSet,
+                           const arma::mat& querySet,
+                           const bool monochromatic)
+{
+  candidates.clear();
+
+  // The cost of naive search is known.
+  best.tree = NAIVE;
+  best.leafSize = 0;
+  best.singleMode = false;
+  best.baseCases = querySet.n_cols * referenceSet.n_cols;
+  best.scores = 0;
+  best.time = 0.0;
+  best.estimatedCost = double(querySet.n_cols) * referenceSet.n_cols;
+  candidates.push_back(best);
+
+  // Draw the subsamples.
+  const size_t referenceCount = std::min(sampleSize,
+      (size_t) referenceSet.n_cols);
+  if (referenceCount < 2)
+  {
+    intrinsicDimension = 0.0;
+    return;
+  }
+
+  arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+      referenceSet.n_cols - 1, referenceSet.n_cols));
+  const arma::mat referenceSample = referenceSet.cols(
+      order.subvec(0, referenceCount - 1));
+
+  arma::mat querySample;
+  size_t queryCount = referenceCount;
+  if (!monochromatic)
+  {
+    queryCount = std::min(sampleSize, (size_t) querySet.n_cols);
+    if (queryCount == 0)
+      return;
+
+    order = arma::shuffle(arma::linspace<arma::uvec>(0, querySet.n_cols - 1,
+        querySet.n_cols));
+    querySample = querySet.cols(order.subvec(0, queryCount - 1));
+  }
+
+  const size_t pilotK = std::min(k, monochromatic ? referenceCount - 1 :
+      referenceCount);
+
+  // Estimate the intrinsic dimension from the nearest neighbors of the
+  // reference subsample.
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    AllkNN knn(referenceSample);
+    knn.Search(std::min((size_t) 10, referenceCount - 1), neighbors,
+        distances);
+    intrinsicDimension = EstimateDimension(distances);
+  }
+  Log::Info << "Estimated intrinsic dimension: " << intrinsicDimension << "."
+      << std::endl;
+
+  // The counts of the pilot searches are scaled to the whole query set, and
+  // to the whole reference set with the growth of the cost of a query.
+  const double exponent = 1.0 - 1.0 / std::max(intrinsicDimension, 1.0);
+  const double scale = (double(querySet.n_cols) / queryCount) *
+      std::pow(double(referenceSet.n_cols) / referenceCount, exponent);
+
+  for (size_t i = 0; i < leafSizes.size(); ++i)
+  {
+    candidates.push_back(PilotKDTree(referenceSample, querySample,
+        monochromatic, pilotK, leafSizes[i], false));
+    candidates.push_back(PilotKDTree(referenceSample, querySample,
+        monochromatic, pilotK, leafSizes[i], true));
+  }
+  candidates.push_back(PilotCoverTree(referenceSample, querySample,
+      monochromatic, pilotK, false));
+  candidates.push_back(PilotCoverTree(referenceSample, querySample,
+      monochromatic, pilotK, true));
+
+  for (size_t i = 1; i < candidates.size(); ++i)
+  {
+    Candidate& c = candidates[i];
+    c.estimatedCost = (c.baseCases + c.scores) * scale;
+
+    Log::Info << ((c.tree == KD_TREE) ? "kd-tree" : "cover tree");
+    if (c.tree == KD_TREE)
+      Log::Info << " (leaf size " << c.leafSize << ")";
+    Log::Info << ", " << (c.singleMode ? "single-tree" : "dual-tree") << ": "
+        << c.baseCases << " base cases, " << c.scores << " scores, "
+        << c.time << "s; estimated cost " << c.estimatedCost << "."
+        << std::endl;
+
+    if (c.estimatedCost < best.estimatedCost)
+      best = c;
+  }
+}
+
+SearchAdvisor::Candidate SearchAdvisor::PilotKDTree(
+    const arma::mat& referenceSample,
+    const arma::mat& querySample,
+    const bool monochromatic,
+    const size_t pilotK,
+    const size_t leafSize,
+    const bool singleMode) const
+{
+  typedef tree::BinarySpaceTree<bound::HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  arma::wall_clock clock;
+  clock.tic();
+
+  // The trees rearrange the points, so they are built on copies.
+  arma::mat references(referenceSample);
+  std::vector<size_t> oldFromNewReferences;
+  TreeType referenceTree(references, oldFromNewReferences, leafSize);
+
+  AllkNN knn(&referenceTree, singleMode);
+  knn.Epsilon() = epsilon;
+  if (monochromatic)
+  {
+    knn.Search(pilotK, neighbors, distances);
+  }
+  else if (singleMode)
+  {
+    knn.Search(querySample, pilotK, neighbors, distances);
+  }
+  else
+  {
+    arma::mat queries(querySample);
+    std::vector<size_t> oldFromNewQueries;
+    TreeType queryTree(queries, oldFromNewQueries, leafSize);
+    knn.Search(&queryTree, pilotK, neighbors, distances);
+  }
+
+  Candidate c;
+  c.tree = KD_TREE;
+  c.leafSize = leafSize;
+  c.singleMode = singleMode;
+  c.baseCases = knn.BaseCases();
+  c.scores = knn.Scores();
+  c.time = clock.toc();
+  c.estimatedCost = 0.0;
+  return c;
+}
+
+SearchAdvisor::Candidate SearchAdvisor::PilotCoverTree(
+    const arma::mat& referenceSample,
+    const arma::mat& querySample,
+    const bool monochromatic,
+    const size_t pilotK,
+    const bool singleMode) const
+{
+  typedef tree::CoverTree<metric::LMetric<2, true>, tree::FirstPointIsRoot,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  arma::wall_clock clock;
+  clock.tic();
+
+  TreeType referenceTree(referenceSample, 1.3);
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType> knn(
+      &referenceTree, singleMode);
+  knn.Epsilon() = epsilon;
+  if (monochromatic)
+  {
+    knn.Search(pilotK, neighbors, distances);
+  }
+  else if (singleMode)
+  {
+    knn.Search(querySample, pilotK, neighbors, distances);
+  }
+  else
+  {
+    TreeType queryTree(querySample, 1.3);
+    knn.Search(&queryTree, pilotK, neighbors, distances);
+  }
+
+  Candidate c;
+  c.tree = COVER_TREE;
+  c.leafSize = 0;
+  c.singleMode = singleMode;
+  c.baseCases = knn.BaseCases();
+  c.scores = knn.Scores();
+  c.time = clock.toc();
+  c.estimatedCost = 0.0;
+  return c;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file search_advisor.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of SearchAdvisor, which chooses the tree type, the leaf size and
+ * the traversal of a k-nearest-neighbor search with pilot searches on a
+ * subsample of the data.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_SEARCH_ADVISOR_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_SEARCH_ADVISOR_HPP
+
+#include <mlpack/core.hpp>
+#include <vector>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Choose how to run an exact k-nearest-neighbor search: with a kd-tree (and
+ * which leaf size), with a cover tree, or naively, and with single-tree or
+ * dual-tree traversal.  Which is fastest depends mostly on the intrinsic
+ * dimension of the data, so it is hard to guess beforehand.
+ *
+ * The intrinsic dimension d is estimated with the maximum likelihood estimator
+ * of Levina and Bickel on the nearest neighbors of a random subsample of the
+ * reference set.  Then every candidate search is run on the subsample (and on
+ * a subsample of the query set, if there is one), and the number of base
+ * cases plus the number of node scores, which each cost about one distance
+ * computation, is recorded.  The cost of a search per query point grows
+ * roughly as N^(1 - 1 / d) with the number of reference points N, so this is
+ * used to extrapolate the counts of the pilot searches to the whole dataset;
+ * the cost of naive search is known exactly.  The candidate with the lowest
+ * estimated cost is chosen.
+ *
+ * @code
+ * SearchAdvisor advisor(k);
+ * advisor.Advise(referenceSet, querySet);
+ * if (advisor.Tree() == SearchAdvisor::KD_TREE)
+ *   ... // Use advisor.LeafSize() and advisor.SingleMode().
+ * @endcode
+ */
+class SearchAdvisor
+{
+ public:
+  //! The kinds of search.
+  enum SearchTree
+  {
+    KD_TREE,
+    COVER_TREE,
+    NAIVE
+  };
+
+  //! A pilot search and its cost.
+  struct Candidate
+  {
+    //! The kind of search.
+    SearchTree tree;
+    //! The leaf size (only for kd-trees).
+    size_t leafSize;
+    //! Whether single-tree traversal is used.
+    bool singleMode;
+    //! The number of base cases of the pilot search.
+    size_t baseCases;
+    //! The number of node scores of the pilot search.
+    size_t scores;
+    //! The time taken by the pilot search, with tree building (seconds).
+    double time;
+    //! The estimated number of distance computations on the whole dataset.
+    double estimatedCost;
+  };
+
+  /**
+   * Create the advisor.
+   *
+   * @param k Number of neighbors that will be searched for.
+   * @param epsilon Relative error allowed in the results of the search.
+   * @param sampleSize Number of points of the subsamples of the pilot
+   *     searches.
+   */
+  SearchAdvisor(const size_t k,
+                const double epsilon = 0.0,
+                const size_t sampleSize = 2000);
+
+  /**
+   * Choose the search for the k nearest neighbors of every point of the
+   * reference set (not counting the point itself).
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Advise(const arma::mat& referenceSet);
+
+  /**
+   * Choose the search for the k nearest neighbors of every point of the query
+   * set.
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Set of query points.
+   */
+  void Advise(const arma::mat& referenceSet, const arma::mat& querySet);
+
+  //! Get the chosen kind of search.
+  SearchTree Tree() const { return best.tree; }
+  //! Get the chosen leaf size (only meaningful for kd-trees).
+  size_t LeafSize() const { return best.leafSize; }
+  //! Get whether single-tree traversal was chosen.
+  bool SingleMode() const { return best.singleMode; }
+
+  //! Get the estimated intrinsic dimension of the reference set.
+  double IntrinsicDimension() const { return intrinsicDimension; }
+  //! Get every candidate of the last call to Advise().
+  const std::vector<Candidate>& Candidates() const { return candidates; }
+
+  //! Get the candidate leaf sizes of kd-trees.
+  const std::vector<size_t>& LeafSizes() const { return leafSizes; }
+  //! Modify the candidate leaf sizes of kd-trees.
+  std::vector<size_t>& LeafSizes() { return leafSizes; }
+
+  //! Get the number of points of the subsamples.
+  size_t SampleSize() const { return sampleSize; }
+  //! Modify the number of points of the subsamples.
+  size_t& SampleSize() { return sampleSize; }
+
+  /**
+   * Estimate the intrinsic dimension of the given points with the maximum
+   * likelihood estimator of Levina and Bickel, averaged over the points as
+   * suggested by MacKay and Ghahramani, from the distances of every point to
+   * its nearest neighbors.
+   *
+   * @param distances The sorted distances of every point (one column per
+   *     point) to its nearest neighbors, not counting the point itself.
+   */
+  static double EstimateDimension(const arma::mat& distances);
+
+ private:
+  //! Run the pilot searches and choose the best candidate.
+  void Advise(const arma::mat& referenceSet,
+              const arma::mat& querySet,
+              const bool monochromatic);
+
+  //! Run a pilot search with a kd-tree and return its candidate.
+  Candidate PilotKDTree(const arma::mat& referenceSample,
+                        const arma::mat& querySample,
+                        const bool monochromatic,
+                        const size_t pilotK,
+                        const size_t leafSize,
+                        const bool singleMode) const;
+
+  //! Run a pilot search with a cover tree and return its candidate.
+  Candidate PilotCoverTree(const arma::mat& referenceSample,
+                           const arma::mat& querySample,
+                           const bool monochromatic,
+                           const size_t pilotK,
+                           const bool singleMode) const;
+
+  //! Number of neighbors that will be searched for.
+  size_t k;
+  //! Relative error allowed in the results of the search.
+  double epsilon;
+  //! Number of points of the subsamples.
+  size_t sampleSize;
+  //! Candidate leaf sizes of kd-trees.
+  std::vector<size_t> leafSizes;
+
+  //! The estimated intrinsic dimension of the reference set.
+  double intrinsicDimension;
+  //! Every candidate of the last call to Advise().
+  std::vector<Candidate> candidates;
+  //! The chosen candidate.
+  Candidate best;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -145,6 +145,19 @@ class FurthestNeighborSort
    */
   static inline double CombineWorst(const double a, const double b)
   { return std::max(a - b, 0.0); }
+
+  /**
+   * Relax the given pruning bound for (1 + epsilon)-approximate search: a
+   * node is then only visited if it could hold a neighbor further than
+   * bound * (1 + epsilon), so every returned distance is at least the true one
+   * divided by (1 + epsilon).
+   */
+  static inline double Relax(const double value, const double epsilon)
+  {
+    if (value >= DBL_MAX / (1 + epsilon))
+      return DBL_MAX;
+    return value * (1 + epsilon);
+  }
 };
 
 }; // namespace neighbor
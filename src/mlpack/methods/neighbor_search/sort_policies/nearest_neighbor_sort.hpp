@@ -150,6 +150,19 @@ class NearestNeighborSort
       return DBL_MAX;
     return a + b;
   }
+
+  /**
+   * Relax the given pruning bound for (1 + epsilon)-approximate search: a
+   * node is then only visited if it could hold a neighbor closer than
+   * bound / (1 + epsilon), so every returned distance is at most (1 + epsilon)
+   * times the true one.
+   */
+  static inline double Relax(const double value, const double epsilon)
+  {
+    if (value == DBL_MAX)
+      return DBL_MAX;
+    return value / (1 + epsilon);
+  }
 };
 
 }; // namespace neighbor
@@ -0,0 +1,316 @@
+/**
+ * @file sparse_neighbor_search.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the k-nearest-neighbor search on sparse data with an
+ * inverted index.
+ */
+#include "sparse_neighbor_search.hpp"
+
+#include <functional>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+//! Return the k'th largest score of the given points.
+static double KthLargest(const std::vector<double>& scores,
+                         const std::vector<size_t>& points,
+                         const size_t k,
+                         std::vector<double>& sorted)
+{
+  sorted.resize(points.size());
+  for (size_t i = 0; i < points.size(); ++i)
+    sorted[i] = scores[points[i]];
+
+  std::nth_element(sorted.begin(), sorted.begin() + (k - 1), sorted.end(),
+      std::greater<double>());
+  return sorted[k - 1];
+}
+
+SparseNeighborSearch::SparseNeighborSearch(const arma::sp_mat& referenceSetIn,
+                                           const Similarity similarity) :
+    referenceSet(referenceSetIn),
+    similarity(similarity),
+    prune(true),
+    nonNegative(true),
+    postings(0)
+{
+  if (similarity == COSINE)
+  {
+    // Scale every point to unit norm.
+    arma::umat locations(2, referenceSet.n_nonzero);
+    arma::vec values(referenceSet.n_nonzero);
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+    {
+      double norm = 0.0;
+      for (size_t j = referenceSet.col_ptrs[i];
+           j < referenceSet.col_ptrs[i + 1]; ++j)
+        norm += referenceSet.values[j] * referenceSet.values[j];
+      norm = std::sqrt(norm);
+
+      for (size_t j = referenceSet.col_ptrs[i];
+           j < referenceSet.col_ptrs[i + 1]; ++j)
+      {
+        locations(0, j) = referenceSet.row_indices[j];
+        locations(1, j) = i;
+        values[j] = referenceSet.values[j] / norm;
+      }
+    }
+
+    referenceSet = arma::sp_mat(locations, values, referenceSet.n_rows,
+        referenceSet.n_cols);
+  }
+
+  for (size_t j = 0; j < referenceSet.n_nonzero; ++j)
+    if (referenceSet.values[j] < 0.0)
+      nonNegative = false;
+
+  // The columns of the transpose are the postings of every dimension, sorted
+  // by point.
+  const arma::sp_mat transposed = referenceSet.t();
+  postingOffsets.set_size(transposed.n_cols + 1);
+  for (size_t d = 0; d <= transposed.n_cols; ++d)
+    postingOffsets[d] = transposed.col_ptrs[d];
+
+  postingPoints.set_size(transposed.n_nonzero);
+  postingValues.set_size(transposed.n_nonzero);
+  for (size_t j = 0; j < transposed.n_nonzero; ++j)
+  {
+    postingPoints[j] = transposed.row_indices[j];
+    postingValues[j] = transposed.values[j];
+  }
+
+  maxValues.zeros(transposed.n_cols);
+  for (size_t d = 0; d < transposed.n_cols; ++d)
+    for (size_t j = postingOffsets[d]; j < postingOffsets[d + 1]; ++j)
+      maxValues[d] = std::max(maxValues[d], std::abs(postingValues[j]));
+}
+
+void SparseNeighborSearch::Search(const arma::sp_mat& querySet,
+                                  const size_t k,
+                                  arma::Mat<size_t>& neighbors,
+                                  arma::mat& distances)
+{
+  SearchQueries(querySet, false, k, neighbors, distances);
+}
+
+void SparseNeighborSearch::Search(const size_t k,
+                                  arma::Mat<size_t>& neighbors,
+                                  arma::mat& distances)
+{
+  SearchQueries(referenceSet, true, k, neighbors, distances);
+}
+
+void SparseNeighborSearch::SearchQueries(const arma::sp_mat& querySet,
+                                         const bool sameSet,
+                                         const size_t k,
+                                         arma::Mat<size_t>& neighbors,
+                                         arma::mat& distances)
+{
+  const size_t numReferences = referenceSet.n_cols - (sameSet ? 1 : 0);
+  if (k > numReferences)
+  {
+    Log::Fatal << "SparseNeighborSearch::Search(): cannot find " << k
+        << " neighbors among " << numReferences << " reference points!"
+        << std::endl;
+  }
+
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    Log::Fatal << "SparseNeighborSearch::Search(): query points have "
+        << querySet.n_rows << " dimensions, but the reference points have "
+        << referenceSet.n_rows << "!" << std::endl;
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  postings = 0;
+  if (k == 0)
+    return;
+
+  size_t totalPostings = 0;
+
+  #pragma omp parallel reduction(+:totalPostings)
+  {
+    // Each thread gets its own accumulators.
+    std::vector<double> scores(referenceSet.n_cols, 0.0);
+    std::vector<char> touched(referenceSet.n_cols, 0);
+    std::vector<size_t> points, candidates;
+    std::vector<std::pair<double, size_t> > terms, ranked;
+    std::vector<double> sorted;
+
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      // Collect the terms of the query with the upper bounds of their
+      // contributions.
+      terms.clear();
+      double queryNorm = 0.0;
+      double remaining = 0.0;
+      bool pruneQuery = prune && nonNegative;
+      for (size_t j = querySet.col_ptrs[q]; j < querySet.col_ptrs[q + 1]; ++j)
+      {
+        const double value = querySet.values[j];
+        const size_t d = querySet.row_indices[j];
+        queryNorm += value * value;
+        if (value < 0.0)
+          pruneQuery = false;
+
+        if (postingOffsets[d] != postingOffsets[d + 1])
+        {
+          terms.push_back(std::make_pair(std::abs(value) * maxValues[d], j));
+          remaining += terms.back().first;
+        }
+      }
+      queryNorm = std::sqrt(queryNorm);
+      std::sort(terms.begin(), terms.end(),
+          std::greater<std::pair<double, size_t> >());
+
+      // Accumulate the postings of the terms, until no point that was not
+      // touched yet can be among the k best.
+      points.clear();
+      double maxScore = 0.0;
+      double threshold = 0.0;
+      size_t t = 0;
+      for (; t < terms.size(); ++t)
+      {
+        if (pruneQuery && points.size() >= k && remaining <= maxScore)
+        {
+          threshold = KthLargest(scores, points, k, sorted);
+          if (remaining <= threshold)
+            break;
+        }
+
+        const size_t j = terms[t].second;
+        const size_t d = querySet.row_indices[j];
+        const double value = querySet.values[j];
+        for (size_t p = postingOffsets[d]; p < postingOffsets[d + 1]; ++p)
+        {
+          const size_t point = postingPoints[p];
+          if (sameSet && point == q)
+            continue;
+
+          if (!touched[point])
+          {
+            touched[point] = 1;
+            scores[point] = 0.0;
+            points.push_back(point);
+          }
+
+          scores[point] += value * postingValues[p];
+          maxScore = std::max(maxScore, scores[point]);
+        }
+
+        totalPostings += postingOffsets[d + 1] - postingOffsets[d];
+        remaining -= terms[t].first;
+      }
+
+      // The remaining terms only update the candidates that can still reach
+      // the threshold.
+      const bool pruned = (t < terms.size());
+      if (pruned)
+      {
+        candidates.clear();
+        for (size_t i = 0; i < points.size(); ++i)
+          if (scores[points[i]] + remaining >= threshold)
+            candidates.push_back(points[i]);
+        std::sort(candidates.begin(), candidates.end());
+      }
+
+      for (; t < terms.size(); ++t)
+      {
+        const size_t j = terms[t].second;
+        const size_t d = querySet.row_indices[j];
+        const double value = querySet.values[j];
+        const size_t begin = postingOffsets[d];
+        const size_t end = postingOffsets[d + 1];
+
+        if (8 * candidates.size() < end - begin)
+        {
+          // Look every candidate up in the postings.
+          const size_t* first = postingPoints.memptr() + begin;
+          const size_t* last = postingPoints.memptr() + end;
+          for (size_t c = 0; c < candidates.size(); ++c)
+          {
+            first = std::lower_bound(first, last, candidates[c]);
+            if (first == last)
+              break;
+            if (*first == candidates[c])
+              scores[candidates[c]] += value *
+                  postingValues[first - postingPoints.memptr()];
+          }
+          totalPostings += candidates.size();
+        }
+        else
+        {
+          // Merge the candidates with the postings.
+          size_t c = 0;
+          for (size_t p = begin; p < end && c < candidates.size(); ++p)
+          {
+            while (c < candidates.size() && candidates[c] < postingPoints[p])
+              ++c;
+            if (c < candidates.size() && candidates[c] == postingPoints[p])
+              scores[candidates[c]] += value * postingValues[p];
+          }
+          totalPostings += end - begin;
+        }
+
+        remaining -= terms[t].first;
+        threshold = KthLargest(scores, candidates, k, sorted);
+        size_t kept = 0;
+        for (size_t c = 0; c < candidates.size(); ++c)
+          if (scores[candidates[c]] + remaining >= threshold)
+            candidates[kept++] = candidates[c];
+        candidates.resize(kept);
+      }
+
+      // Rank the points by decreasing similarity (and increasing index).
+      const std::vector<size_t>& result = pruned ? candidates : points;
+      ranked.resize(result.size());
+      for (size_t i = 0; i < result.size(); ++i)
+        ranked[i] = std::make_pair(-scores[result[i]], result[i]);
+      std::sort(ranked.begin(), ranked.end());
+
+      // The points that were not touched have similarity zero; they come
+      // after the positive similarities, and before the negative ones.
+      size_t filled = 0;
+      size_t r = 0;
+      for (; r < ranked.size() && filled < k && ranked[r].first < 0.0; ++r)
+      {
+        neighbors(filled, q) = ranked[r].second;
+        distances(filled++, q) = -ranked[r].first;
+      }
+      for (size_t i = 0; i < referenceSet.n_cols && filled < k; ++i)
+      {
+        if ((!sameSet || i != q) && (!touched[i] || scores[i] == 0.0))
+        {
+          neighbors(filled, q) = i;
+          distances(filled++, q) = 0.0;
+        }
+      }
+      for (; r < ranked.size() && filled < k; ++r)
+      {
+        if (ranked[r].first == 0.0)
+          continue;
+
+        neighbors(filled, q) = ranked[r].second;
+        distances(filled++, q) = -ranked[r].first;
+      }
+
+      // Convert the similarities to distances.
+      for (size_t i = 0; i < k; ++i)
+      {
+        if (similarity == INNER_PRODUCT)
+          distances(i, q) = -distances(i, q);
+        else
+          distances(i, q) = (queryNorm > 0.0) ?
+              1.0 - distances(i, q) / queryNorm : 1.0;
+      }
+
+      for (size_t i = 0; i < points.size(); ++i)
+        touched[points[i]] = 0;
+    }
+  }
+
+  postings = totalPostings;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file sparse_neighbor_search.hpp
+ * @author Ryan Curtin
+ *
+ * Definition of SparseNeighborSearch, an exact k-nearest-neighbor search on
+ * sparse data by cosine similarity or inner product, with an inverted index.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_SPARSE_NEIGHBOR_SEARCH_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_SPARSE_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/core.hpp>
+#include <vector>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * An exact k-nearest-neighbor search for sparse high-dimensional data, such as
+ * text vectors, where the bounds of space trees cannot prune anything.  The
+ * reference set is stored as an inverted index: for every dimension (term),
+ * the list of the reference points that are nonzero in it, with their values
+ * (the postings).  The similarity of a query point to the reference points is
+ * accumulated term by term over the postings of the nonzero dimensions of the
+ * query, so only the reference points that share a term with the query are
+ * ever touched.
+ *
+ * If the values are nonnegative (as for tf-idf vectors), the search is pruned
+ * as in MaxScore:
+ *
+ * @code
+ * @article{turtle1995query,
+ *   title={Query evaluation: strategies and optimizations},
+ *   author={Turtle, H. and Flood, J.},
+ *   journal={Information Processing and Management},
+ *   volume={31},
+ *   number={6},
+ *   pages={831--850},
+ *   year={1995}
+ * }
+ * @endcode
+ *
+ * The terms of the query are processed by decreasing upper bound of their
+ * contribution (the query value times the largest value of the postings).
+ * Once the sum of the bounds of the remaining terms is not above the k'th
+ * largest partial similarity, no point that was not touched yet can be one of
+ * the k nearest neighbors; the remaining terms only update the candidates
+ * whose partial similarity plus that sum can still reach the k'th largest, and
+ * they are looked up in the postings by binary search when there are few of
+ * them.  The results are the same as those of an exhaustive search (up to the
+ * order of ties).
+ *
+ * The results have the same format as those of AllkNN: column i of the
+ * neighbors and distances matrices holds the k nearest neighbors of query
+ * point i, nearest first.  With cosine similarity the distances are 1 minus
+ * the cosine similarity; with the inner product they are the negated inner
+ * products.
+ *
+ * @code
+ * SparseNeighborSearch knn(documents);
+ * knn.Search(queries, k, neighbors, distances);
+ * @endcode
+ */
+class SparseNeighborSearch
+{
+ public:
+  //! The similarities that can be searched with.
+  enum Similarity
+  {
+    COSINE,
+    INNER_PRODUCT
+  };
+
+  /**
+   * Build the inverted index of the given reference set (one point per
+   * column).  The reference set is copied, so it doesn't have to stay valid.
+   *
+   * @param referenceSet Set of reference points.
+   * @param similarity Similarity of the points.
+   */
+  SparseNeighborSearch(const arma::sp_mat& referenceSet,
+                       const Similarity similarity = COSINE);
+
+  /**
+   * Find the k most similar reference points of every query point.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to find.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances of the neighbors in.
+   */
+  void Search(const arma::sp_mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Find the k most similar reference points of every reference point, not
+   * counting the point itself.
+   *
+   * @param k Number of neighbors to find.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances of the neighbors in.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the similarity of the points.
+  Similarity SimilarityType() const { return similarity; }
+
+  //! Get whether the search is pruned (when the values are nonnegative).
+  bool Prune() const { return prune; }
+  //! Modify whether the search is pruned (when the values are nonnegative).
+  bool& Prune() { return prune; }
+
+  //! Get the start of the postings of every dimension in PostingPoints().
+  const arma::Col<size_t>& PostingOffsets() const { return postingOffsets; }
+  //! Get the reference points of the postings, dimension after dimension.
+  const arma::Col<size_t>& PostingPoints() const { return postingPoints; }
+  //! Get the values of the postings, dimension after dimension.
+  const arma::vec& PostingValues() const { return postingValues; }
+
+  //! Get the number of postings read in the last search.
+  size_t Postings() const { return postings; }
+
+ private:
+  /**
+   * Search the neighbors of the given query points.  If sameSet is true, the
+   * query points are the reference points, and no point is its own neighbor.
+   */
+  void SearchQueries(const arma::sp_mat& querySet,
+                     const bool sameSet,
+                     const size_t k,
+                     arma::Mat<size_t>& neighbors,
+                     arma::mat& distances);
+
+  //! The reference set (with unit columns, for cosine similarity).
+  arma::sp_mat referenceSet;
+  //! The similarity of the points.
+  Similarity similarity;
+  //! Whether the search is pruned.
+  bool prune;
+  //! Whether every value of the reference set is nonnegative.
+  bool nonNegative;
+
+  //! The start of the postings of every dimension; the postings of dimension
+  //! d are at [postingOffsets[d], postingOffsets[d + 1]).
+  arma::Col<size_t> postingOffsets;
+  //! The reference points of the postings, in increasing order for every
+  //! dimension.
+  arma::Col<size_t> postingPoints;
+  //! The values of the postings.
+  arma::vec postingValues;
+  //! The largest absolute value of the postings of every dimension.
+  arma::vec maxValues;
+
+  //! The number of postings read in the last search.
+  size_t postings;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file stream_search.hpp
+ * @author Ryan Curtin
+ *
+ * Search for the neighbors of a query set that is read from disk in blocks,
+ * writing the results of each block to disk as soon as it is done.
+ */
+#ifndef __MLPACK_METHODS_NEIGHBOR_SEARCH_STREAM_SEARCH_HPP
+#define __MLPACK_METHODS_NEIGHBOR_SEARCH_STREAM_SEARCH_HPP
+
+#include <mlpack/core.hpp>
+#include <thread>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Search for the k neighbors of every point in the given query file, blockSize
+ * points at a time, with a search object that holds the (resident) reference
+ * tree.  The neighbors and distances of each block are appended to the given
+ * Armadillo binary (.bin) files while the next block is searched, so memory
+ * for the output is bounded by two blocks and writing overlaps with the
+ * search.  The output files have the same layout as the ones written by
+ * data::Save() for the whole result matrices.
+ *
+ * @param search Search object (NeighborSearch or equivalent) to search with.
+ * @param queryFile File holding the query points.
+ * @param k Number of neighbors to search for.
+ * @param blockSize Number of query points per block.
+ * @param neighborsFile File to write the neighbors to (.bin).
+ * @param distancesFile File to write the distances to (.bin).
+ * @return The number of query points that were searched.
+ */
+template<typename SearchType>
+size_t StreamSearch(SearchType& search,
+                    const std::string& queryFile,
+                    const size_t k,
+                    const size_t blockSize,
+                    const std::string& neighborsFile,
+                    const std::string& distancesFile)
+{
+  data::ChunkedLoader<double> loader(queryFile, true);
+  const size_t numQueries = loader.NumPoints();
+
+  // Errors while writing are reported from this thread, not the writer
+  // thread, so the savers are not fatal.
+  data::ChunkedSaver<size_t> neighborsSaver(neighborsFile, k, numQueries);
+  data::ChunkedSaver<double> distancesSaver(distancesFile, k, numQueries);
+  if (!neighborsSaver.IsOpen() || !distancesSaver.IsOpen())
+    Log::Fatal << "Cannot write streaming search results." << std::endl;
+
+  // While one block is written by the writer thread, the next one is
+  // searched.
+  arma::mat queryBlock;
+  arma::Mat<size_t> neighbors, writeNeighbors;
+  arma::mat distances, writeDistances;
+  std::thread writer;
+  bool written = true;
+
+  while (loader.NextChunk(queryBlock, blockSize))
+  {
+    search.Search(queryBlock, k, neighbors, distances);
+
+    if (writer.joinable())
+      writer.join();
+    if (!written)
+      Log::Fatal << "Cannot write streaming search results." << std::endl;
+
+    neighbors.swap(writeNeighbors);
+    distances.swap(writeDistances);
+    writer = std::thread([&neighborsSaver, &distancesSaver, &writeNeighbors,
+        &writeDistances, &written]()
+    {
+      written = neighborsSaver.Append(writeNeighbors) &&
+          distancesSaver.Append(writeDistances);
+    });
+
+    Log::Info << loader.PointsRead() << " of " << numQueries << " query "
+        << "points searched." << std::endl;
+  }
+
+  if (writer.joinable())
+    writer.join();
+
+  if (!written || !neighborsSaver.Close() || !distancesSaver.Close())
+    Log::Fatal << "Cannot write streaming search results." << std::endl;
+
+  return loader.PointsRead();
+}
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -32,6 +32,26 @@ typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance> AllkNN;
  */
 typedef NeighborSearch<FurthestNeighborSort, metric::EuclideanDistance> AllkFN;
 
+/**
+ * The FloatAllkNN class is the all-k-nearest-neighbors method on single
+ * precision data.  The tree, its bounds and the distance computations all use
+ * floats; only the returned distances are doubles.
+ */
+typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+    tree::BinarySpaceTree<bound::HRectBound<2>,
+        NeighborSearchStat<NearestNeighborSort>, arma::fmat> > FloatAllkNN;
+
+/**
+ * The RPTreeAllkNN class is the all-k-nearest-neighbors method with random
+ * projection trees (see tree::RPTreeSplit).  The search is exact, unless it is
+ * made defeatist (see NeighborSearch::Defeatist()), which is how RP-trees are
+ * usually used for high-dimensional data.
+ */
+typedef NeighborSearch<NearestNeighborSort, metric::EuclideanDistance,
+    tree::BinarySpaceTree<bound::HRectBound<2>,
+        NeighborSearchStat<NearestNeighborSort>, arma::mat,
+        tree::RPTreeSplit<bound::HRectBound<2>, arma::mat> > > RPTreeAllkNN;
+
 }; // namespace neighbor
 }; // namespace mlpack
 
@@ -60,5 +60,57 @@ void Unmap(const arma::Mat<size_t>& neighbors,
     neighborsOut[j] = referenceMap[neighbors[j]];
 }
 
+// In-place version for the dual-tree setting.
+void Unmap(arma::Mat<size_t>& neighbors,
+           arma::mat& distances,
+           const std::vector<size_t>& referenceMap,
+           const std::vector<size_t>& queryMap,
+           const bool squareRoot)
+{
+  UnmapQueries(neighbors, distances, queryMap);
+  Unmap(neighbors, distances, referenceMap, squareRoot);
+}
+
+// In-place version for the single-tree setting.
+void Unmap(arma::Mat<size_t>& neighbors,
+           arma::mat& distances,
+           const std::vector<size_t>& referenceMap,
+           const bool squareRoot)
+{
+  if (squareRoot)
+    distances = sqrt(distances);
+
+  // Map neighbors back to original indices.
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < neighbors.n_elem; ++j)
+    neighbors[j] = referenceMap[neighbors[j]];
+}
+
+void UnmapQueries(arma::Mat<size_t>& neighbors,
+                  arma::mat& distances,
+                  const std::vector<size_t>& queryMap)
+{
+  Log::Assert(queryMap.size() == neighbors.n_cols);
+  Log::Assert(queryMap.size() == distances.n_cols);
+
+  // Column i belongs at queryMap[i].  Starting from column i, swapping it with
+  // column queryMap[j] for each j along the cycle puts every column of the
+  // cycle in place, and column i receives the last one.
+  std::vector<bool> placed(queryMap.size(), false);
+  for (size_t i = 0; i < queryMap.size(); ++i)
+  {
+    if (placed[i])
+      continue;
+
+    placed[i] = true;
+    for (size_t j = queryMap[i]; j != i; j = queryMap[j])
+    {
+      neighbors.swap_cols(i, j);
+      distances.swap_cols(i, j);
+      placed[j] = true;
+    }
+  }
+}
+
 }; // namespace neighbor
 }; // namespace mlpack
@@ -55,6 +55,58 @@ void Unmap(const arma::Mat<size_t>& neighbors,
            arma::mat& distancesOut,
            const bool squareRoot = false);
 
+/**
+ * Unmap the results of a dual-tree search in place: the columns of neighbors
+ * and distances are moved to their original query positions and the entries of
+ * neighbors are mapped to the original reference indices, without allocating
+ * any new matrices.  The results are the same as those of the copying version
+ * of Unmap().
+ *
+ * @param neighbors Matrix of neighbors resulting from neighbor search; it is
+ *     overwritten with the unmapped neighbors.
+ * @param distances Matrix of distances resulting from neighbor search; it is
+ *     overwritten with the unmapped distances.
+ * @param referenceMap Mapping of reference set to old points.
+ * @param queryMap Mapping of query set to old points.
+ * @param squareRoot If true, take the square root of the distances.
+ */
+void Unmap(arma::Mat<size_t>& neighbors,
+           arma::mat& distances,
+           const std::vector<size_t>& referenceMap,
+           const std::vector<size_t>& queryMap,
+           const bool squareRoot = false);
+
+/**
+ * Unmap the results of a single-tree search in place: the entries of neighbors
+ * are mapped to the original reference indices, without allocating any new
+ * matrices.
+ *
+ * @param neighbors Matrix of neighbors resulting from neighbor search; it is
+ *     overwritten with the unmapped neighbors.
+ * @param distances Matrix of distances resulting from neighbor search.
+ * @param referenceMap Mapping of reference set to old points.
+ * @param squareRoot If true, take the square root of the distances.
+ */
+void Unmap(arma::Mat<size_t>& neighbors,
+           arma::mat& distances,
+           const std::vector<size_t>& referenceMap,
+           const bool squareRoot = false);
+
+/**
+ * Move the columns of neighbors and distances to their original query
+ * positions in place, leaving the neighbor indices themselves alone; this is
+ * for searches where only the query set was rearranged.  Each cycle of the
+ * permutation is followed with column swaps, so no copy of the results is
+ * made.
+ *
+ * @param neighbors Matrix of neighbors resulting from neighbor search.
+ * @param distances Matrix of distances resulting from neighbor search.
+ * @param queryMap Mapping of query set to old points.
+ */
+void UnmapQueries(arma::Mat<size_t>& neighbors,
+                  arma::mat& distances,
+                  const std::vector<size_t>& queryMap);
+
 }; // namespace neighbor
 }; // namespace mlpack
 
@@ -0,0 +1,203 @@
+/**
+ * @file nn_descent.hpp
+ * @author Ryan Curtin
+ *
+ * Defines the NNDescent class, which builds an approximate k-nearest-neighbor
+ * graph of a dataset with the NN-descent algorithm.
+ */
+#ifndef __MLPACK_METHODS_NN_DESCENT_NN_DESCENT_HPP
+#define __MLPACK_METHODS_NN_DESCENT_NN_DESCENT_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The NNDescent class builds an approximate k-nearest-neighbor graph of a
+ * dataset: for each point, an approximation of its k nearest other points.
+ * It does not use a tree; it starts from a random graph (or a given initial
+ * graph) and repeatedly improves it with the observation that a neighbor of a
+ * neighbor is likely to be a neighbor.  In each iteration, every point
+ * compares the pairs of its neighbors and reverse neighbors (the points that
+ * have it as a neighbor), and the closer pairs are inserted into the neighbor
+ * lists of each other.  Only pairs involving at least one neighbor that is new
+ * since the last iteration are compared, and only a fraction (the sample
+ * rate) of the new neighbors is used in each iteration.  The algorithm stops
+ * when fewer than tolerance * k * n neighbor list entries change in an
+ * iteration, or after the maximum number of iterations.
+ *
+ * The results are in the same format as the results of NeighborSearch: column
+ * i of the neighbors and distances matrices holds the indices of and the
+ * distances to the k neighbors of point i, sorted from nearest to furthest.
+ * A point is never its own neighbor.
+ *
+ * The iterations are run in parallel with OpenMP.  All random choices are made
+ * with generators that only depend on the point and the iteration (see
+ * math::RandomStream()), so the graph is the same after math::RandomSeed() for
+ * any number of threads.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @inproceedings{dong2011efficient,
+ *   title={Efficient k-nearest neighbor graph construction for generic
+ *       similarity measures},
+ *   author={Dong, W. and Moses, C. and Li, K.},
+ *   booktitle={Proceedings of the 20th International Conference on World Wide
+ *       Web (WWW '11)},
+ *   pages={577--586},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * @tparam MetricType The metric to use.
+ * @tparam MatType The type of the dataset.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat>
+class NNDescent
+{
+ public:
+  /**
+   * Initialize the NNDescent object with the given dataset.  The dataset is
+   * not copied, so it must remain valid while the object is used.
+   *
+   * @param dataset Dataset to build the graph of.
+   * @param maxIterations Maximum number of iterations.
+   * @param sampleRate Fraction of the k neighbors of each point to sample as
+   *      new neighbors in each iteration (between 0 and 1).
+   * @param tolerance The algorithm stops when fewer than tolerance * k * n
+   *      neighbor list entries change in an iteration.
+   * @param metric An optional instance of the metric.
+   */
+  NNDescent(const MatType& dataset,
+            const size_t maxIterations = 30,
+            const double sampleRate = 1.0,
+            const double tolerance = 0.001,
+            const MetricType metric = MetricType());
+
+  /**
+   * Build the approximate k-nearest-neighbor graph from a random initial
+   * graph.
+   *
+   * @param k Number of neighbors of each point.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances to the neighbors in.
+   */
+  void Build(const size_t k,
+             arma::Mat<size_t>& neighbors,
+             arma::mat& distances);
+
+  /**
+   * Build the approximate k-nearest-neighbor graph, starting from the given
+   * initial neighbors; for instance, the results of LSHSearch or RASearch on
+   * the dataset.  Column i of initialNeighbors holds candidate neighbors of
+   * point i; invalid indices and the point itself are ignored, and points with
+   * fewer than k valid candidates get random ones.  The initial neighbors may
+   * have any number of rows.
+   *
+   * @param initialNeighbors Initial candidate neighbors of each point.
+   * @param k Number of neighbors of each point.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances to the neighbors in.
+   */
+  void Build(const arma::Mat<size_t>& initialNeighbors,
+             const size_t k,
+             arma::Mat<size_t>& neighbors,
+             arma::mat& distances);
+
+  //! Get the dataset.
+  const MatType& Dataset() const { return dataset; }
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the sample rate.
+  double SampleRate() const { return sampleRate; }
+  //! Modify the sample rate.
+  double& SampleRate() { return sampleRate; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get the number of iterations of the last call to Build().
+  size_t Iterations() const { return iterations; }
+
+ private:
+  //! A candidate neighbor found during the local join of an iteration.
+  struct Update
+  {
+    //! The point whose neighbor list the candidate is for.
+    size_t point;
+    //! The candidate neighbor.
+    size_t neighbor;
+    //! The distance between the point and the candidate.
+    double distance;
+  };
+
+  //! The number of points of the local join of a parallel task.
+  static const size_t BlockSize = 1024;
+
+  /**
+   * Run NN-descent, given the initial neighbors (which may be NULL).
+   */
+  void BuildGraph(const arma::Mat<size_t>* initialNeighbors,
+                  const size_t k,
+                  arma::Mat<size_t>& neighbors,
+                  arma::mat& distances);
+
+  /**
+   * Insert a candidate into the neighbor list of a point, which is a bounded
+   * heap with the furthest neighbor at row 0 (see NeighborHeap), if it is
+   * closer than the furthest neighbor and not in the list yet.  The new
+   * neighbor is flagged as new.
+   *
+   * @return Whether or not the candidate was inserted.
+   */
+  static bool Insert(arma::Mat<size_t>& neighbors,
+                     arma::mat& distances,
+                     arma::Mat<unsigned char>& isNew,
+                     const size_t point,
+                     const size_t neighbor,
+                     const double distance);
+
+  /**
+   * Move a random sample of at most the given number of elements to the front
+   * of the given list, and shrink the list to the sample.
+   */
+  static void Sample(std::vector<size_t>& list,
+                     const size_t count,
+                     std::mt19937& generator);
+
+  //! The dataset.
+  const MatType& dataset;
+  //! The maximum number of iterations.
+  size_t maxIterations;
+  //! The fraction of the neighbors sampled in each iteration.
+  double sampleRate;
+  //! The fraction of changed neighbor list entries to stop at.
+  double tolerance;
+  //! The instantiated metric.
+  MetricType metric;
+  //! The number of iterations of the last call to Build().
+  size_t iterations;
+};
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+// Include implementation.
+#include "nn_descent_impl.hpp"
+
+#endif
@@ -0,0 +1,337 @@
+/**
+ * @file nn_descent_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the NNDescent class.
+ */
+#ifndef __MLPACK_METHODS_NN_DESCENT_NN_DESCENT_IMPL_HPP
+#define __MLPACK_METHODS_NN_DESCENT_NN_DESCENT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "nn_descent.hpp"
+
+#include <mlpack/methods/neighbor_search/neighbor_heap.hpp>
+#include <mlpack/methods/neighbor_search/sort_policies/nearest_neighbor_sort.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename MetricType, typename MatType>
+NNDescent<MetricType, MatType>::NNDescent(const MatType& dataset,
+                                          const size_t maxIterations,
+                                          const double sampleRate,
+                                          const double tolerance,
+                                          const MetricType metric) :
+    dataset(dataset),
+    maxIterations(maxIterations),
+    sampleRate(sampleRate),
+    tolerance(tolerance),
+    metric(metric),
+    iterations(0)
+{
+  if (sampleRate <= 0.0 || sampleRate > 1.0)
+    Log::Fatal << "NNDescent: sample rate must be in (0, 1] (" << sampleRate
+        << " given)." << std::endl;
+  if (tolerance < 0.0)
+    Log::Fatal << "NNDescent: tolerance must be non-negative (" << tolerance
+        << " given)." << std::endl;
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Build(const size_t k,
+                                           arma::Mat<size_t>& neighbors,
+                                           arma::mat& distances)
+{
+  BuildGraph(NULL, k, neighbors, distances);
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Build(
+    const arma::Mat<size_t>& initialNeighbors,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  BuildGraph(&initialNeighbors, k, neighbors, distances);
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::BuildGraph(
+    const arma::Mat<size_t>* initialNeighbors,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  const size_t n = dataset.n_cols;
+  if (k == 0 || k >= n)
+    Log::Fatal << "NNDescent::Build(): k must be between 1 and the number of "
+        << "points minus 1 (" << k << " given, " << n << " points)."
+        << std::endl;
+
+  Timer::Start("nn_descent");
+
+  neighbors.set_size(k, n);
+  neighbors.fill(SIZE_MAX);
+  distances.set_size(k, n);
+  distances.fill(DBL_MAX);
+  arma::Mat<unsigned char> isNew(k, n);
+  isNew.zeros();
+
+  // The streams of the whole graph construction are offset by a draw from the
+  // global generator; each point and iteration has its own stream after that.
+  const size_t streamOffset = (size_t) math::randGen();
+
+  // Fill the neighbor lists with the initial candidates, and then with random
+  // points.
+  #pragma omp parallel for schedule(static)
+  for (size_t v = 0; v < n; ++v)
+  {
+    if (initialNeighbors != NULL && v < initialNeighbors->n_cols)
+    {
+      for (size_t i = 0; i < initialNeighbors->n_rows; ++i)
+      {
+        const size_t u = (*initialNeighbors)(i, v);
+        if (u < n && u != v)
+          Insert(neighbors, distances, isNew, v, u,
+              metric.Evaluate(dataset.col(v), dataset.col(u)));
+      }
+    }
+
+    size_t filled = 0;
+    for (size_t i = 0; i < k; ++i)
+      if (neighbors(i, v) != SIZE_MAX)
+        ++filled;
+
+    std::mt19937 generator = math::RandomStream(streamOffset + v);
+    std::uniform_int_distribution<size_t> randomPoint(0, n - 1);
+    while (filled < k)
+    {
+      const size_t u = randomPoint(generator);
+      if (u != v && Insert(neighbors, distances, isNew, v, u,
+          metric.Evaluate(dataset.col(v), dataset.col(u))))
+        ++filled;
+    }
+  }
+
+  const size_t sampleCount = (size_t) std::ceil(sampleRate * k);
+  const size_t numBlocks = (n + BlockSize - 1) / BlockSize;
+  std::vector<std::vector<size_t> > newLists(n), oldLists(n);
+  std::vector<std::vector<size_t> > newReverse(n), oldReverse(n);
+  std::vector<std::vector<Update> > blockUpdates(numBlocks);
+  std::vector<size_t> updateOffsets(n + 1);
+  std::vector<const Update*> sortedUpdates;
+
+  iterations = 0;
+  for (size_t it = 1; it <= maxIterations; ++it)
+  {
+    iterations = it;
+
+    // Collect the old neighbors and a sample of the new neighbors of each
+    // point; the sampled new neighbors become old.
+    #pragma omp parallel for schedule(static)
+    for (size_t v = 0; v < n; ++v)
+    {
+      newLists[v].clear();
+      oldLists[v].clear();
+      for (size_t i = 0; i < k; ++i)
+      {
+        if (isNew(i, v))
+          newLists[v].push_back(i);
+        else
+          oldLists[v].push_back(neighbors(i, v));
+      }
+
+      std::mt19937 generator = math::RandomStream(streamOffset +
+          2 * it * n + v);
+      Sample(newLists[v], sampleCount, generator);
+      for (size_t i = 0; i < newLists[v].size(); ++i)
+      {
+        isNew(newLists[v][i], v) = 0;
+        newLists[v][i] = neighbors(newLists[v][i], v);
+      }
+    }
+
+    // Build the reverse lists.
+    for (size_t v = 0; v < n; ++v)
+    {
+      newReverse[v].clear();
+      oldReverse[v].clear();
+    }
+    for (size_t v = 0; v < n; ++v)
+    {
+      for (size_t i = 0; i < newLists[v].size(); ++i)
+        newReverse[newLists[v][i]].push_back(v);
+      for (size_t i = 0; i < oldLists[v].size(); ++i)
+        oldReverse[oldLists[v][i]].push_back(v);
+    }
+
+    // Add a sample of the reverse neighbors to the lists.
+    #pragma omp parallel for schedule(static)
+    for (size_t v = 0; v < n; ++v)
+    {
+      std::mt19937 generator = math::RandomStream(streamOffset +
+          (2 * it + 1) * n + v);
+      Sample(newReverse[v], sampleCount, generator);
+      Sample(oldReverse[v], sampleCount, generator);
+
+      newLists[v].insert(newLists[v].end(), newReverse[v].begin(),
+          newReverse[v].end());
+      std::sort(newLists[v].begin(), newLists[v].end());
+      newLists[v].erase(std::unique(newLists[v].begin(), newLists[v].end()),
+          newLists[v].end());
+
+      oldLists[v].insert(oldLists[v].end(), oldReverse[v].begin(),
+          oldReverse[v].end());
+      std::sort(oldLists[v].begin(), oldLists[v].end());
+      oldLists[v].erase(std::unique(oldLists[v].begin(), oldLists[v].end()),
+          oldLists[v].end());
+    }
+
+    // The local join: compare the new neighbors of each point with each other
+    // and with the old neighbors.  The neighbor lists are not modified here,
+    // so the candidates are only collected, and a candidate that is not closer
+    // than the current furthest neighbor is dropped right away.
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      std::vector<Update>& updates = blockUpdates[b];
+      updates.clear();
+
+      const size_t end = std::min((b + 1) * BlockSize, n);
+      for (size_t v = b * BlockSize; v < end; ++v)
+      {
+        const std::vector<size_t>& newList = newLists[v];
+        const std::vector<size_t>& oldList = oldLists[v];
+        for (size_t i = 0; i < newList.size(); ++i)
+        {
+          const size_t u1 = newList[i];
+          for (size_t j = i + 1; j < newList.size() + oldList.size(); ++j)
+          {
+            const size_t u2 = (j < newList.size()) ? newList[j] :
+                oldList[j - newList.size()];
+            if (u1 == u2)
+              continue;
+
+            const double distance = metric.Evaluate(dataset.col(u1),
+                dataset.col(u2));
+            if (distance < distances(0, u1))
+            {
+              Update update = { u1, u2, distance };
+              updates.push_back(update);
+            }
+            if (distance < distances(0, u2))
+            {
+              Update update = { u2, u1, distance };
+              updates.push_back(update);
+            }
+          }
+        }
+      }
+    }
+
+    // Group the candidates by point (keeping the order of the blocks), so that
+    // the neighbor list of each point is only updated by one thread.
+    std::fill(updateOffsets.begin(), updateOffsets.end(), 0);
+    for (size_t b = 0; b < numBlocks; ++b)
+      for (size_t i = 0; i < blockUpdates[b].size(); ++i)
+        ++updateOffsets[blockUpdates[b][i].point + 1];
+    for (size_t v = 0; v < n; ++v)
+      updateOffsets[v + 1] += updateOffsets[v];
+
+    sortedUpdates.resize(updateOffsets[n]);
+    for (size_t b = 0; b < numBlocks; ++b)
+      for (size_t i = 0; i < blockUpdates[b].size(); ++i)
+        sortedUpdates[updateOffsets[blockUpdates[b][i].point]++] =
+            &blockUpdates[b][i];
+    // The offsets were moved to the end of each group.
+    for (size_t v = n; v > 0; --v)
+      updateOffsets[v] = updateOffsets[v - 1];
+    updateOffsets[0] = 0;
+
+    size_t changes = 0;
+    #pragma omp parallel for schedule(dynamic, BlockSize) reduction(+:changes)
+    for (size_t v = 0; v < n; ++v)
+    {
+      for (size_t i = updateOffsets[v]; i < updateOffsets[v + 1]; ++i)
+        if (Insert(neighbors, distances, isNew, v, sortedUpdates[i]->neighbor,
+            sortedUpdates[i]->distance))
+          ++changes;
+    }
+
+    Log::Info << "NN-descent iteration " << it << ": " << changes
+        << " neighbor list updates." << std::endl;
+
+    if (changes <= tolerance * k * n)
+      break;
+  }
+
+  // Sort the neighbor lists.
+  NeighborHeap<NearestNeighborSort>::Sort(distances, neighbors);
+
+  Timer::Stop("nn_descent");
+}
+
+template<typename MetricType, typename MatType>
+bool NNDescent<MetricType, MatType>::Insert(arma::Mat<size_t>& neighbors,
+                                            arma::mat& distances,
+                                            arma::Mat<unsigned char>& isNew,
+                                            const size_t point,
+                                            const size_t neighbor,
+                                            const double distance)
+{
+  double* dist = distances.colptr(point);
+  if (distance >= dist[0])
+    return false;
+
+  size_t* ind = neighbors.colptr(point);
+  const size_t size = distances.n_rows;
+  for (size_t i = 0; i < size; ++i)
+    if (ind[i] == neighbor)
+      return false;
+
+  // Replace the furthest neighbor and sift the new one down, like
+  // NeighborHeap::Insert(), but keep the flags with the neighbors.
+  unsigned char* flags = isNew.colptr(point);
+  size_t pos = 0;
+  while (2 * pos + 1 < size)
+  {
+    size_t child = 2 * pos + 1;
+    if (child + 1 < size && dist[child] < dist[child + 1])
+      ++child;
+
+    if (!(distance < dist[child]))
+      break;
+
+    dist[pos] = dist[child];
+    ind[pos] = ind[child];
+    flags[pos] = flags[child];
+    pos = child;
+  }
+
+  dist[pos] = distance;
+  ind[pos] = neighbor;
+  flags[pos] = 1;
+  return true;
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Sample(std::vector<size_t>& list,
+                                            const size_t count,
+                                            std::mt19937& generator)
+{
+  if (list.size() <= count)
+    return;
+
+  // A partial Fisher-Yates shuffle.
+  for (size_t i = 0; i < count; ++i)
+  {
+    std::uniform_int_distribution<size_t> position(i, list.size() - 1);
+    std::swap(list[i], list[position(generator)]);
+  }
+  list.resize(count);
+}
+
+}; // namespace neighbor
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file nn_descent_main.cpp
+ * @author Ryan Curtin
+ *
+ * Executable for building approximate k-nearest-neighbor graphs with
+ * NN-descent.
+ */
+#include <mlpack/core.hpp>
+
+#include <string>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+#include "nn_descent.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+// Information about the program itself.
+PROGRAM_INFO("Approximate k-Nearest-Neighbor Graph Construction (NN-descent)",
+    "This program builds an approximate k-nearest-neighbor graph of the given "
+    "reference dataset with the NN-descent algorithm: for each point, it finds "
+    "an approximation of the k nearest other points.  Starting from a random "
+    "graph, each iteration compares the neighbors of the neighbors of every "
+    "point, until few neighbor lists change (--tolerance) or the maximum "
+    "number of iterations is reached.  The output has the same format as the "
+    "output of allknn: column i of the neighbors and distances files holds the "
+    "k neighbors of point i, sorted from nearest to furthest."
+    "\n\n"
+    "The initial graph can instead be read from --initial_neighbors_file; for "
+    "instance, the --neighbors_file output of lsh or allkrann on the same "
+    "dataset (with no query file).  Invalid indices and the points themselves "
+    "are ignored, and missing neighbors are chosen at random."
+    "\n\n"
+    "For example, the following will build the 10-nearest-neighbor graph of "
+    "the points in 'data.csv' and store the neighbors in 'neighbors.csv' and "
+    "the distances in 'distances.csv':"
+    "\n\n"
+    "$ nn_descent --k=10 --reference_file=data.csv --distances_file=\n"
+    "  distances.csv --neighbors_file=neighbors.csv");
+
+// Define our input parameters that this program will take.
+PARAM_STRING_REQ("reference_file", "File containing the reference dataset.",
+    "r");
+PARAM_STRING("distances_file", "File to output distances into.", "d", "");
+PARAM_STRING("neighbors_file", "File to output neighbors into.", "n", "");
+PARAM_STRING("initial_neighbors_file", "File containing the initial neighbors "
+    "of each point (optional).", "i", "");
+
+PARAM_INT_REQ("k", "Number of nearest neighbors to find.", "k");
+
+PARAM_INT("max_iterations", "Maximum number of iterations.", "m", 30);
+PARAM_DOUBLE("sample_rate", "Fraction of the neighbors of each point that are "
+    "sampled in each iteration (between 0 and 1).", "S", 1.0);
+PARAM_DOUBLE("tolerance", "Stop when fewer than this fraction of all neighbor "
+    "list entries change in an iteration.", "e", 0.001);
+
+PARAM_INT("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+PARAM_INT("threads", "Number of threads to use (0 uses all available cores; "
+    "ignored without OpenMP).", "t", 0);
+
+int main(int argc, char *argv[])
+{
+  // Give CLI the command line parameters the user passed in.
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  // Get all the parameters.
+  const string referenceFile = CLI::GetParam<string>("reference_file");
+  const string distancesFile = CLI::GetParam<string>("distances_file");
+  const string neighborsFile = CLI::GetParam<string>("neighbors_file");
+  const string initialNeighborsFile =
+      CLI::GetParam<string>("initial_neighbors_file");
+
+  const int k = CLI::GetParam<int>("k");
+  const int maxIterations = CLI::GetParam<int>("max_iterations");
+  const double sampleRate = CLI::GetParam<double>("sample_rate");
+  const double tolerance = CLI::GetParam<double>("tolerance");
+
+  if (distancesFile == "" && neighborsFile == "")
+    Log::Warn << "Neither --distances_file nor --neighbors_file is specified; "
+        << "no output will be saved." << endl;
+
+  // Sanity checks on the parameters.
+  if (maxIterations < 0)
+  {
+    Log::Fatal << "Invalid number of maximum iterations: " << maxIterations
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+  if (sampleRate <= 0.0 || sampleRate > 1.0)
+  {
+    Log::Fatal << "Invalid sample rate: " << sampleRate << ".  Must be greater "
+        << "than 0 and less than or equal to 1." << endl;
+  }
+  if (tolerance < 0.0)
+  {
+    Log::Fatal << "Invalid tolerance: " << tolerance << ".  Must be greater "
+        << "than or equal to 0." << endl;
+  }
+
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP "
+        << "support." << endl;
+#endif
+
+  arma::mat referenceData;
+  data::Load(referenceFile, referenceData, true);
+
+  Log::Info << "Loaded reference data from '" << referenceFile << "' ("
+      << referenceData.n_rows << " x " << referenceData.n_cols << ")." << endl;
+
+  // Sanity check on k value: it must be greater than 0, and less than the
+  // number of points, since a point is not its own neighbor.
+  if (k <= 0 || (size_t) k >= referenceData.n_cols)
+  {
+    Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
+        << "than the number of reference points (" << referenceData.n_cols
+        << ")." << endl;
+  }
+
+  NNDescent<> nnDescent(referenceData, (size_t) maxIterations, sampleRate,
+      tolerance);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  if (initialNeighborsFile != "")
+  {
+    arma::Mat<size_t> initialNeighbors;
+    data::Load(initialNeighborsFile, initialNeighbors, true);
+    if (initialNeighbors.n_cols != referenceData.n_cols)
+    {
+      Log::Fatal << "The initial neighbors have " << initialNeighbors.n_cols
+          << " columns, but there are " << referenceData.n_cols
+          << " reference points." << endl;
+    }
+
+    Log::Info << "Building the " << k << "-nearest-neighbor graph from the "
+        << "initial neighbors in '" << initialNeighborsFile << "'..." << endl;
+    nnDescent.Build(initialNeighbors, (size_t) k, neighbors, distances);
+  }
+  else
+  {
+    Log::Info << "Building the " << k << "-nearest-neighbor graph..." << endl;
+    nnDescent.Build((size_t) k, neighbors, distances);
+  }
+  Log::Info << "Finished after " << nnDescent.Iterations() << " iterations."
+      << endl;
+
+  // Save output.
+  if (distancesFile != "")
+    data::Save(distancesFile, distances);
+  if (neighborsFile != "")
+    data::Save(neighborsFile, neighbors);
+}
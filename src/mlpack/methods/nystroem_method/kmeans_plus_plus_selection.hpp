@@ -0,0 +1,89 @@
+/**
+ * @file kmeans_plus_plus_selection.hpp
+ * @author Ryan Curtin
+ *
+ * Select points with k-means++ seeding for use in the Nystroem method of
+ * kernel matrix approximation.
+ */
+#ifndef __MLPACK_METHODS_NYSTROEM_METHOD_KMEANS_PLUS_PLUS_SELECTION_HPP
+#define __MLPACK_METHODS_NYSTROEM_METHOD_KMEANS_PLUS_PLUS_SELECTION_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Select points of the dataset with the seeding of k-means++ (Arthur and
+ * Vassilvitskii, 2007): every point is chosen with probability proportional to
+ * its squared distance to the closest point chosen so far.  The points are
+ * spread over the dataset like the centroids of KMeansSelection, but this only
+ * takes m passes over the dataset instead of a full k-means clustering, so it
+ * scales to much larger datasets.
+ */
+class KMeansPlusPlusSelection
+{
+ public:
+  /**
+   * Select the specified number of points in the dataset.
+   *
+   * @param data Dataset to sample from.
+   * @param m Number of points to select.
+   * @return Indices of selected points from the dataset.
+   */
+  const static arma::Col<size_t> Select(const arma::mat& data, const size_t m)
+  {
+    arma::Col<size_t> selectedPoints(m);
+    if (m == 0)
+      return selectedPoints;
+
+    // The first point is chosen uniformly; then, the squared distance of every
+    // point to the closest selected point is updated after each selection.
+    selectedPoints(0) = math::RandInt(0, data.n_cols);
+    arma::vec distances(data.n_cols);
+    distances.fill(DBL_MAX);
+
+    for (size_t i = 1; i < m; ++i)
+    {
+      const arma::vec point = data.col(selectedPoints(i - 1));
+
+      #pragma omp parallel for schedule(static)
+      for (size_t j = 0; j < data.n_cols; ++j)
+      {
+        const double distance = metric::SquaredEuclideanDistance::Evaluate(
+            data.unsafe_col(j), point);
+        if (distance < distances[j])
+          distances[j] = distance;
+      }
+
+      // If all points are already selected (or are duplicates of selected
+      // points), any point will do.
+      const double total = arma::accu(distances);
+      if (total == 0.0)
+      {
+        selectedPoints(i) = math::RandInt(0, data.n_cols);
+        continue;
+      }
+
+      const double threshold = math::Random() * total;
+      double cumulative = 0.0;
+      size_t index = 0;
+      for ( ; index < data.n_cols - 1; ++index)
+      {
+        cumulative += distances[index];
+        if (cumulative > threshold)
+          break;
+      }
+
+      selectedPoints(i) = index;
+    }
+
+    return selectedPoints;
+  }
+};
+
+}; // namespace kernel
+}; // namespace mlpack
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file nystroem_features.hpp
+ * @author Ryan Curtin
+ *
+ * An explicit feature map that approximates a kernel with the Nystroem method.
+ */
+#ifndef __MLPACK_METHODS_NYSTROEM_METHOD_NYSTROEM_FEATURES_HPP
+#define __MLPACK_METHODS_NYSTROEM_METHOD_NYSTROEM_FEATURES_HPP
+
+#include <mlpack/core.hpp>
+#include "kmeans_selection.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * This class maps points into an m-dimensional space where the dot product
+ * approximates a kernel, with the Nystroem method.  m landmark points are
+ * selected from the training set; the features of a point x are
+ *
+ *   W^{-1/2} [K(x, l_1), ..., K(x, l_m)]^T,
+ *
+ * where W is the kernel matrix of the landmarks l_i.  The dot product of the
+ * features of two points x and y is then K_x^T W^{-1} K_y, the Nystroem
+ * approximation of K(x, y); NystroemMethod computes the same approximation
+ * of the kernel matrix of the training set, but cannot map new points.
+ *
+ * Unlike RandomFourierFeatures, any kernel can be used, and the landmarks
+ * adapt to the data, so fewer features are usually needed for the same
+ * accuracy.  A linear method trained on the features approximates the
+ * kernelized method:
+ *
+ * @code
+ * NystroemFeatures<GaussianKernel> nystroem(GaussianKernel(0.5), 500);
+ * nystroem.Train(data);
+ * arma::mat features;
+ * nystroem.Transform(data, features);
+ * regression::LinearRegression lr(features, responses);
+ * @endcode
+ *
+ * @tparam KernelType The kernel to approximate.
+ * @tparam PointSelectionPolicy The policy to select the landmarks with.
+ */
+template<
+  typename KernelType,
+  typename PointSelectionPolicy = KMeansSelection<>
+>
+class NystroemFeatures
+{
+ public:
+  /**
+   * Create the feature map.  Train() must be called before Transform().
+   *
+   * @param kernel Kernel to approximate.
+   * @param numFeatures Number of landmarks (and features).
+   */
+  NystroemFeatures(const KernelType& kernel = KernelType(),
+                   const size_t numFeatures = 100);
+
+  /**
+   * Select the landmarks from the given dataset and compute the normalization
+   * of the features.
+   *
+   * @param data Dataset (one point per column).
+   */
+  void Train(const arma::mat& data);
+
+  /**
+   * Map the given points into the feature space.  The points are taken in
+   * blocks, which are evaluated against all landmarks while they are in cache,
+   * in parallel.
+   *
+   * @param data Points to map (one point per column).
+   * @param features Matrix to store the features of every point in (one point
+   *     per column).
+   */
+  void Transform(const arma::mat& data, arma::mat& features) const;
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Get the number of features.
+  size_t NumFeatures() const { return numFeatures; }
+
+  //! Get the landmarks.
+  const arma::mat& Landmarks() const { return landmarks; }
+  //! Get the normalization (W^{-1/2}).
+  const arma::mat& Normalization() const { return normalization; }
+
+ private:
+  //! The number of points of a block.
+  static const size_t BlockSize = 256;
+
+  //! Copy the selected landmarks (when the policy selects points of the data).
+  void SetLandmarks(const arma::mat& data,
+                    const arma::Col<size_t>& selectedPoints);
+  //! Take the selected landmarks (when the policy computes new points).
+  void SetLandmarks(const arma::mat& data, const arma::mat* selectedData);
+
+  //! The kernel to approximate.
+  KernelType kernel;
+  //! The number of features.
+  size_t numFeatures;
+  //! The landmarks (one per column).
+  arma::mat landmarks;
+  //! The inverse square root of the kernel matrix of the landmarks.
+  arma::mat normalization;
+};
+
+}; // namespace kernel
+}; // namespace mlpack
+
+// Include implementation.
+#include "nystroem_features_impl.hpp"
+
+#endif
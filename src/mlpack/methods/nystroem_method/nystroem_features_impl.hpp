@@ -0,0 +1,113 @@
+/**
+ * @file nystroem_features_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the NystroemFeatures class.
+ */
+#ifndef __MLPACK_METHODS_NYSTROEM_METHOD_NYSTROEM_FEATURES_IMPL_HPP
+#define __MLPACK_METHODS_NYSTROEM_METHOD_NYSTROEM_FEATURES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "nystroem_features.hpp"
+
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+template<typename KernelType, typename PointSelectionPolicy>
+NystroemFeatures<KernelType, PointSelectionPolicy>::NystroemFeatures(
+    const KernelType& kernel,
+    const size_t numFeatures) :
+    kernel(kernel),
+    numFeatures(numFeatures)
+{
+  // Nothing to do.
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemFeatures<KernelType, PointSelectionPolicy>::SetLandmarks(
+    const arma::mat& data,
+    const arma::Col<size_t>& selectedPoints)
+{
+  landmarks.set_size(data.n_rows, selectedPoints.n_elem);
+  for (size_t i = 0; i < selectedPoints.n_elem; ++i)
+    landmarks.col(i) = data.col(selectedPoints(i));
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemFeatures<KernelType, PointSelectionPolicy>::SetLandmarks(
+    const arma::mat& /* data */,
+    const arma::mat* selectedData)
+{
+  landmarks = *selectedData;
+
+  // Clean the memory.
+  delete selectedData;
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemFeatures<KernelType, PointSelectionPolicy>::Train(
+    const arma::mat& data)
+{
+  if (numFeatures > data.n_cols)
+  {
+    Log::Fatal << "NystroemFeatures::Train(): cannot select " << numFeatures
+        << " landmarks from " << data.n_cols << " points!" << std::endl;
+  }
+
+  SetLandmarks(data, PointSelectionPolicy::Select(data, numFeatures));
+
+  arma::mat miniKernel;
+  KernelMatrix(kernel, landmarks, landmarks, miniKernel);
+
+  // The kernel matrix of the landmarks is symmetric positive semidefinite;
+  // the directions of (numerically) zero eigenvalues, such as those of
+  // duplicate landmarks, are dropped, as in a pseudo-inverse.
+  arma::vec eigenvalues;
+  arma::mat eigenvectors;
+  arma::eig_sym(eigenvalues, eigenvectors, miniKernel);
+
+  const double tolerance = 1e-10 * std::max(arma::max(eigenvalues), 0.0);
+  arma::vec scales(eigenvalues.n_elem);
+  for (size_t i = 0; i < eigenvalues.n_elem; ++i)
+    scales[i] = (eigenvalues[i] > tolerance) ?
+        1.0 / std::sqrt(eigenvalues[i]) : 0.0;
+
+  normalization = eigenvectors * arma::diagmat(scales) * eigenvectors.t();
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemFeatures<KernelType, PointSelectionPolicy>::Transform(
+    const arma::mat& data,
+    arma::mat& features) const
+{
+  if (data.n_rows != landmarks.n_rows)
+  {
+    Log::Fatal << "NystroemFeatures::Transform(): the points have "
+        << data.n_rows << " dimensions, but the landmarks have "
+        << landmarks.n_rows << " dimensions!" << std::endl;
+  }
+
+  features.set_size(landmarks.n_cols, data.n_cols);
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols) - 1;
+
+    // Kernels are evaluated through non-const references, so every block gets
+    // its own copy.
+    KernelType blockKernel(kernel);
+    arma::mat semiKernel;
+    KernelMatrix(blockKernel, landmarks, data.cols(begin, end), semiKernel);
+    features.cols(begin, end) = normalization * semiKernel;
+  }
+}
+
+}; // namespace kernel
+}; // namespace mlpack
+
+#endif
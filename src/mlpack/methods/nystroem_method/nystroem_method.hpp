@@ -64,6 +64,21 @@ class NystroemMethod
                        arma::mat& semiKernel);
 
  private:
+  //! The number of points of a block of the semi-kernel matrix.
+  static const size_t BlockSize = 256;
+
+  /**
+   * Construct the mini-kernel and semi-kernel matrices, given the selected
+   * points.
+   *
+   * @param selectedData Selected points.
+   * @param miniKernel to store the constructed mini-kernel matrix in.
+   * @param semiKernel to store the constructed semi-kernel matrix in.
+   */
+  void KernelMatrix(const arma::mat& selectedData,
+                    arma::mat& miniKernel,
+                    arma::mat& semiKernel);
+
   //! The reference dataset.
   const arma::mat& data;
   //! The locally stored kernel, if it is necessary.
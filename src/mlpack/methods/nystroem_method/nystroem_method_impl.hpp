@@ -11,6 +11,8 @@
 // In case it hasn't been included yet.
 #include "nystroem_method.hpp"
 
+#include <mlpack/methods/fastmks/batch_kernel_evaluation.hpp>
+
 namespace mlpack {
 namespace kernel {
 
@@ -30,18 +32,8 @@ void NystroemMethod<KernelType, PointSelectionPolicy>::GetKernelMatrix(
     arma::mat& miniKernel,
     arma::mat& semiKernel)
 {
-  // Assemble mini-kernel matrix.
-  for (size_t i = 0; i < rank; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      miniKernel(i, j) = kernel.Evaluate(selectedData->col(i),
-                                         selectedData->col(j));
+  KernelMatrix(*selectedData, miniKernel, semiKernel);
 
-  // Construct semi-kernel matrix with interactions between selected data and
-  // all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      semiKernel(i, j) = kernel.Evaluate(data.col(i),
-                                         selectedData->col(j));
   // Clean the memory.
   delete selectedData;
 }
@@ -52,25 +44,65 @@ void NystroemMethod<KernelType, PointSelectionPolicy>::GetKernelMatrix(
     arma::mat& miniKernel,
     arma::mat& semiKernel)
 {
-  // Assemble mini-kernel matrix.
+  // Copy the selected points, so they are contiguous during the evaluations.
+  arma::mat selectedData(data.n_rows, rank);
   for (size_t i = 0; i < rank; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      miniKernel(i, j) = kernel.Evaluate(data.col(selectedPoints(i)),
-                                         data.col(selectedPoints(j)));
+    selectedData.col(i) = data.col(selectedPoints(i));
+
+  KernelMatrix(selectedData, miniKernel, semiKernel);
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemMethod<KernelType, PointSelectionPolicy>::KernelMatrix(
+    const arma::mat& selectedData,
+    arma::mat& miniKernel,
+    arma::mat& semiKernel)
+{
+  typedef fastmks::BatchKernelEvaluation<KernelType> BatchEvaluation;
+
+  // Kernels that reduce to matrix products are evaluated with them.
+  if (BatchEvaluation::MatrixProducts)
+  {
+    BatchEvaluation::Evaluate(kernel, selectedData, selectedData, miniKernel);
+    BatchEvaluation::Evaluate(kernel, data, selectedData, semiKernel);
+    return;
+  }
+
+  // Assemble mini-kernel matrix; it is symmetric, so only the upper triangular
+  // part is evaluated.
+  miniKernel.set_size(rank, rank);
+  for (size_t j = 0; j < rank; ++j)
+  {
+    for (size_t i = 0; i <= j; ++i)
+    {
+      miniKernel(i, j) = kernel.Evaluate(selectedData.unsafe_col(i),
+                                         selectedData.unsafe_col(j));
+      miniKernel(j, i) = miniKernel(i, j);
+    }
+  }
 
   // Construct semi-kernel matrix with interactions between selected points and
-  // all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
+  // all points.  The points are taken in blocks, which are evaluated against
+  // all selected points while they are in cache, in parallel.
+  semiKernel.set_size(data.n_cols, rank);
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols);
     for (size_t j = 0; j < rank; ++j)
-      semiKernel(i, j) = kernel.Evaluate(data.col(i),
-                                         data.col(selectedPoints(j)));
+      for (size_t i = begin; i < end; ++i)
+        semiKernel(i, j) = kernel.Evaluate(data.unsafe_col(i),
+                                           selectedData.unsafe_col(j));
+  }
 }
 
 template<typename KernelType, typename PointSelectionPolicy>
 void NystroemMethod<KernelType, PointSelectionPolicy>::Apply(arma::mat& output)
 {
-  arma::mat miniKernel(rank, rank);
-  arma::mat semiKernel(data.n_cols, rank);
+  arma::mat miniKernel, semiKernel;
 
   GetKernelMatrix(PointSelectionPolicy::Select(data, rank), miniKernel,
                   semiKernel);
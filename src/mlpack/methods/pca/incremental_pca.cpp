@@ -0,0 +1,127 @@
+/**
+ * @file incremental_pca.cpp
+ * @author Ryan Curtin
+ *
+ * Implementation of principal components analysis of a dataset that is given
+ * chunk by chunk.
+ */
+#include "incremental_pca.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::pca;
+
+IncrementalPCA::IncrementalPCA(const size_t rank) :
+    rank(rank),
+    points(0),
+    totalSquaredDeviation(0.0)
+{
+  if (rank == 0)
+    Log::Fatal << "IncrementalPCA::IncrementalPCA(): rank cannot be zero!"
+        << endl;
+}
+
+void IncrementalPCA::Update(const arma::mat& chunk)
+{
+  if (chunk.n_cols == 0)
+    return;
+
+  if (points > 0 && chunk.n_rows != mean.n_elem)
+  {
+    Log::Fatal << "IncrementalPCA::Update(): chunk has dimensionality "
+        << chunk.n_rows << ", but the previous points have dimensionality "
+        << mean.n_elem << "!" << endl;
+  }
+
+  const arma::vec chunkMean = arma::mean(chunk, 1);
+  arma::mat centeredChunk = chunk;
+  centeredChunk.each_col() -= chunkMean;
+  const double chunkSquaredDeviation = arma::accu(arma::square(centeredChunk));
+
+  // The centered data seen so far has the same scatter matrix as
+  // [ U * S, centered chunk, sqrt(n * m / (n + m)) * (chunk mean - mean) ],
+  // where U * S is the current (truncated) decomposition; its decomposition is
+  // the updated one.
+  arma::mat scatter;
+  if (points == 0)
+  {
+    scatter.swap(centeredChunk);
+    mean = chunkMean;
+    totalSquaredDeviation = chunkSquaredDeviation;
+  }
+  else
+  {
+    const double n = (double) points;
+    const double m = (double) chunk.n_cols;
+    const arma::vec meanDifference = chunkMean - mean;
+
+    arma::mat weightedComponents = components;
+    weightedComponents.each_row() %= arma::trans(singularValues);
+
+    scatter = arma::join_rows(arma::join_rows(weightedComponents,
+        centeredChunk), sqrt(n * m / (n + m)) * meanDifference);
+
+    mean += (m / (n + m)) * meanDifference;
+    totalSquaredDeviation += chunkSquaredDeviation + (n * m / (n + m)) *
+        arma::dot(meanDifference, meanDifference);
+  }
+  points += chunk.n_cols;
+
+  arma::mat u, v;
+  arma::vec s;
+  arma::svd_econ(u, s, v, scatter, 'l');
+
+  const size_t kept = std::min(rank, (size_t) s.n_elem);
+  components = u.cols(0, kept - 1);
+  singularValues = s.subvec(0, kept - 1);
+}
+
+void IncrementalPCA::Transform(const arma::mat& data,
+                               arma::mat& transformedData) const
+{
+  if (points == 0)
+    Log::Fatal << "IncrementalPCA::Transform(): no points have been seen yet!"
+        << endl;
+
+  // The points are centered a chunk at a time, to not copy all of them.
+  const size_t chunkSize = 1024;
+  arma::mat result(components.n_cols, data.n_cols);
+  arma::mat chunk;
+  for (size_t begin = 0; begin < data.n_cols; begin += chunkSize)
+  {
+    const size_t end = std::min(begin + chunkSize, (size_t) data.n_cols);
+    chunk = data.cols(begin, end - 1);
+    chunk.each_col() -= mean;
+    result.cols(begin, end - 1) = arma::trans(components) * chunk;
+  }
+
+  transformedData.swap(result);
+}
+
+arma::vec IncrementalPCA::Eigenvalues() const
+{
+  if (points < 2)
+    return arma::zeros<arma::vec>(singularValues.n_elem);
+
+  // The covariance matrix is the scatter matrix divided by (N - 1).
+  return arma::square(singularValues) / (points - 1);
+}
+
+double IncrementalPCA::VarianceRetained() const
+{
+  if (totalSquaredDeviation == 0.0)
+    return 1.0;
+
+  return arma::accu(arma::square(singularValues)) / totalSquaredDeviation;
+}
+
+// Return a string of this object.
+std::string IncrementalPCA::ToString() const
+{
+  std::ostringstream convert;
+  convert << "Incremental Principal Component Analysis  [" << this << "]"
+      << std::endl;
+  convert << "  Rank: " << rank << std::endl;
+  convert << "  Points: " << points << std::endl;
+  return convert.str();
+}
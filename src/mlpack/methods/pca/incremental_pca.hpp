@@ -0,0 +1,117 @@
+/**
+ * @file incremental_pca.hpp
+ * @author Ryan Curtin
+ *
+ * Principal components analysis of a dataset that is given chunk by chunk.
+ */
+#ifndef __MLPACK_METHODS_PCA_INCREMENTAL_PCA_HPP
+#define __MLPACK_METHODS_PCA_INCREMENTAL_PCA_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace pca {
+
+/**
+ * This class computes the leading principal components of a dataset that is
+ * given chunk by chunk, so that the whole dataset never has to be in memory (or
+ * centered) at once.  After each chunk, the mean and the leading singular
+ * vectors and values of the centered data seen so far are updated with the
+ * incremental SVD of the following paper:
+ *
+ * @code
+ * @article{ross2008incremental,
+ *   title={Incremental learning for robust visual tracking},
+ *   author={Ross, D.A. and Lim, J. and Lin, R.-S. and Yang, M.-H.},
+ *   journal={International Journal of Computer Vision},
+ *   volume={77},
+ *   number={1--3},
+ *   pages={125--141},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * Only the given number of components is kept, so each update costs
+ * O(d * (rank + m)^2) for a chunk of m points of dimensionality d, and the
+ * memory used is O(d * (rank + m)).  The result is exact if the data has at
+ * most rank dimensions of variance, and a close approximation otherwise; chunks
+ * should have at least rank points.
+ *
+ * @code
+ * IncrementalPCA pca(50);
+ * for (size_t i = 0; i < numChunks; ++i)
+ * {
+ *   data::Load(chunkFiles[i], chunk);
+ *   pca.Update(chunk);
+ * }
+ *
+ * pca.Transform(data, transformedData);
+ * @endcode
+ */
+class IncrementalPCA
+{
+ public:
+  /**
+   * Create the IncrementalPCA object, which has seen no points yet.
+   *
+   * @param rank Number of principal components to keep.
+   */
+  IncrementalPCA(const size_t rank);
+
+  /**
+   * Update the principal components with a chunk of points.
+   *
+   * @param chunk Points to add (one column per point).
+   */
+  void Update(const arma::mat& chunk);
+
+  /**
+   * Project points onto the principal components.  It is safe to pass the same
+   * matrix reference for both data and transformedData.
+   *
+   * @param data Points to project.
+   * @param transformedData Matrix to store the projections in.
+   */
+  void Transform(const arma::mat& data, arma::mat& transformedData) const;
+
+  //! Get the eigenvalues of the covariance matrix (the variances of the
+  //! principal components), from largest to smallest.
+  arma::vec Eigenvalues() const;
+
+  //! Get the amount of the variance of the data that is retained by the
+  //! principal components (between 0 and 1).
+  double VarianceRetained() const;
+
+  //! Get the number of principal components to keep.
+  size_t Rank() const { return rank; }
+  //! Get the number of points seen so far.
+  size_t Points() const { return points; }
+  //! Get the mean of the points seen so far.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the principal components (eigenvectors), one per column.
+  const arma::mat& Components() const { return components; }
+  //! Get the singular values of the centered data.
+  const arma::vec& SingularValues() const { return singularValues; }
+
+  // Returns a string representation of this object.
+  std::string ToString() const;
+
+ private:
+  //! The number of principal components to keep.
+  size_t rank;
+  //! The number of points seen so far.
+  size_t points;
+  //! The mean of the points seen so far.
+  arma::vec mean;
+  //! The leading left singular vectors of the centered data.
+  arma::mat components;
+  //! The leading singular values of the centered data.
+  arma::vec singularValues;
+  //! The sum of the squared distances of the points to the mean.
+  double totalSquaredDeviation;
+};
+
+}; // namespace pca
+}; // namespace mlpack
+
+#endif
@@ -12,8 +12,9 @@ using namespace std;
 using namespace mlpack;
 using namespace mlpack::pca;
 
-PCA::PCA(const bool scaleData) :
-    scaleData(scaleData)
+PCA::PCA(const bool scaleData, const bool randomized) :
+    scaleData(scaleData),
+    randomized(randomized)
 { }
 
 /**
@@ -31,47 +32,82 @@ void PCA::Apply(const arma::mat& data,
 {
   Timer::Start("pca");
 
-  // This matrix will store the right singular values; we do not need them.
-  arma::mat v;
+  if (data.n_rows < data.n_cols)
+  {
+    // There are more points than dimensions, so decompose the covariance
+    // matrix, which is computed in one blocked pass over the data without a
+    // centered copy.
+    arma::vec mean;
+    arma::mat covariance;
+    math::Covariance(data, mean, covariance);
 
-  // Center the data into a temporary matrix.
-  arma::mat centeredData;
-  math::Center(data, centeredData);
+    // Scaling the data is when we reduce the variance of each dimension to 1;
+    // then we decompose the correlation matrix instead.  If there are any
+    // zero variances, make the standard deviations very small.
+    arma::vec stdDev(data.n_rows, arma::fill::ones);
+    if (scaleData)
+    {
+      stdDev = arma::sqrt(covariance.diag());
+      for (size_t i = 0; i < stdDev.n_elem; ++i)
+        if (stdDev[i] == 0)
+          stdDev[i] = 1e-50;
 
-  if (scaleData)
-  {
-    // Scaling the data is when we reduce the variance of each dimension to 1.
-    // We do this by dividing each dimension by its standard deviation.
-    arma::vec stdDev = arma::stddev(centeredData, 0, 1 /* for each dimension */);
+      covariance /= stdDev * arma::trans(stdDev);
+    }
 
-    // If there are any zeroes, make them very small.
-    for (size_t i = 0; i < stdDev.n_elem; ++i)
-      if (stdDev[i] == 0)
-        stdDev[i] = 1e-50;
+    arma::eig_sym(eigVal, coeff, covariance);
 
-    centeredData /= arma::repmat(stdDev, 1, centeredData.n_cols);
-  }
+    // The eigenvalues are in ascending order; we want them in descending order
+    // (like the singular values).  Tiny negative eigenvalues are round-off.
+    eigVal = arma::flipud(eigVal);
+    coeff = arma::fliplr(coeff);
+    for (size_t i = 0; i < eigVal.n_elem; ++i)
+      if (eigVal[i] < 0)
+        eigVal[i] = 0;
 
-  // Do singular value decomposition.  Use the economical singular value
-  // decomposition if the columns are much larger than the rows.
-  if (data.n_rows < data.n_cols)
-  {
-    // Do economical singular value decomposition and compute only the left
-    // singular vectors.
-    arma::svd_econ(coeff, eigVal, v, centeredData, 'l');
+    // Project the samples to the principals; the centering and the scaling
+    // are folded into the projection matrix.
+    arma::mat projection = arma::trans(coeff);
+    projection.each_row() /= arma::trans(stdDev);
+    const arma::vec offset = projection * mean;
+    transformedData = projection * data;
+    transformedData.each_col() -= offset;
   }
   else
   {
+    // This matrix will store the right singular values; we do not need them.
+    arma::mat v;
+
+    // Center the data into a temporary matrix.
+    arma::mat centeredData;
+    math::Center(data, centeredData);
+
+    if (scaleData)
+    {
+      // Scaling the data is when we reduce the variance of each dimension to
+      // 1.  We do this by dividing each dimension by its standard deviation.
+      arma::vec stdDev = arma::stddev(centeredData, 0, 1 /* for each dimension */);
+
+      // If there are any zeroes, make them very small.
+      for (size_t i = 0; i < stdDev.n_elem; ++i)
+        if (stdDev[i] == 0)
+          stdDev[i] = 1e-50;
+
+      centeredData.each_col() /= stdDev;
+    }
+
+    // Do singular value decomposition; this is more accurate than decomposing
+    // the covariance matrix when there are few points.
     arma::svd(coeff, eigVal, v, centeredData);
-  }
 
-  // Now we must square the singular values to get the eigenvalues.
-  // In addition we must divide by the number of points, because the covariance
-  // matrix is X * X' / (N - 1).
-  eigVal %= eigVal / (data.n_cols - 1);
+    // Now we must square the singular values to get the eigenvalues.
+    // In addition we must divide by the number of points, because the
+    // covariance matrix is X * X' / (N - 1).
+    eigVal %= eigVal / (data.n_cols - 1);
 
-  // Project the samples to the principals.
-  transformedData = arma::trans(coeff) * centeredData;
+    // Project the samples to the principals.
+    transformedData = arma::trans(coeff) * centeredData;
+  }
 
   Timer::Stop("pca");
 }
@@ -113,6 +149,10 @@ double PCA::Apply(arma::mat& data, const size_t newDimension) const
         << "be greater than the existing dimensionality of the data ("
         << data.n_rows << ")!" << endl;
 
+  // Only the needed components are computed by the randomized method.
+  if (randomized && newDimension < data.n_rows)
+    return RandomizedApply(data, newDimension);
+
   arma::mat coeffs;
   arma::vec eigVal;
 
@@ -172,6 +212,292 @@ double PCA::Apply(arma::mat& data, const double varRetained) const
   return varSum;
 }
 
+/**
+ * Reduce the dimensionality of the data with randomized subspace iteration (see
+ * Halko, Martinsson and Tropp, "Finding structure with randomness", 2011).  The
+ * basis is multiplied by the (unnormalized) covariance matrix A * A^T a few
+ * times, so that it spans the leading eigenvectors, and the projection of the
+ * covariance on it is then eigendecomposed.  A * A^T * basis is computed chunk
+ * by chunk, so the memory needed besides the data is proportional to the
+ * dimensionality times the new dimension.
+ */
+double PCA::RandomizedApply(arma::mat& data, const size_t newDimension) const
+{
+  Timer::Start("pca");
+
+  const arma::vec mean = arma::mean(data, 1);
+  arma::vec stdDev;
+  if (scaleData)
+  {
+    stdDev = arma::stddev(data, 0, 1 /* for each dimension */);
+
+    // If there are any zeroes, make them very small.
+    for (size_t i = 0; i < stdDev.n_elem; ++i)
+      if (stdDev[i] == 0)
+        stdDev[i] = 1e-50;
+  }
+
+  const size_t basisSize = std::min(newDimension + Oversampling,
+      (size_t) data.n_rows);
+  arma::mat basis, r, product;
+  arma::mat start = arma::randn<arma::mat>(data.n_rows, basisSize);
+  arma::qr_econ(basis, r, start);
+  for (size_t i = 0; i < PowerIterations; ++i)
+  {
+    CovarianceProduct(data, mean, stdDev, basis, product);
+    arma::qr_econ(basis, r, product);
+  }
+
+  // Eigendecompose the projection of the covariance onto the basis.
+  CovarianceProduct(data, mean, stdDev, basis, product);
+  const arma::mat projection = basis.t() * product;
+  arma::vec values;
+  arma::mat vectors;
+  arma::eig_sym(values, vectors, 0.5 * (projection + projection.t()));
+
+  // The eigenvalues are in ascending order.
+  const arma::vec eigVal = arma::flipud(values.tail(newDimension)) /
+      (data.n_cols - 1);
+  const arma::mat coeffs = basis *
+      arma::fliplr(vectors.tail_cols(newDimension));
+
+  // Project the samples to the principal components, and compute the total
+  // variance on the way.
+  arma::mat transformedData(newDimension, data.n_cols);
+  double totalVariance = 0.0;
+  arma::mat chunk;
+  for (size_t begin = 0; begin < data.n_cols; begin += ChunkSize)
+  {
+    const size_t end = std::min(begin + ChunkSize, (size_t) data.n_cols);
+    CenteredChunk(data, mean, stdDev, begin, end, chunk);
+
+    transformedData.cols(begin, end - 1) = arma::trans(coeffs) * chunk;
+    totalVariance += arma::accu(arma::square(chunk));
+  }
+  totalVariance /= (data.n_cols - 1);
+
+  data.swap(transformedData);
+
+  Timer::Stop("pca");
+
+  return arma::accu(eigVal) / totalVariance;
+}
+
+void PCA::CenteredChunk(const arma::mat& data,
+                        const arma::vec& mean,
+                        const arma::vec& stdDev,
+                        const size_t begin,
+                        const size_t end,
+                        arma::mat& chunk) const
+{
+  chunk = data.cols(begin, end - 1);
+  chunk.each_col() -= mean;
+  if (scaleData)
+    chunk.each_col() /= stdDev;
+}
+
+void PCA::CovarianceProduct(const arma::mat& data,
+                            const arma::vec& mean,
+                            const arma::vec& stdDev,
+                            const arma::mat& basis,
+                            arma::mat& product) const
+{
+  product.zeros(basis.n_rows, basis.n_cols);
+  const size_t numChunks = (data.n_cols + ChunkSize - 1) / ChunkSize;
+
+  #pragma omp parallel
+  {
+    // Each thread accumulates its own product.
+    arma::mat threadProduct;
+    threadProduct.zeros(basis.n_rows, basis.n_cols);
+    arma::mat chunk;
+
+    #pragma omp for schedule(static)
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+      const size_t begin = c * ChunkSize;
+      const size_t end = std::min(begin + ChunkSize, (size_t) data.n_cols);
+      CenteredChunk(data, mean, stdDev, begin, end, chunk);
+
+      threadProduct += chunk * (arma::trans(chunk) * basis);
+    }
+
+    #pragma omp critical(pca_covariance_product)
+    product += threadProduct;
+  }
+}
+
+/**
+ * Reduce the dimensionality of sparse data with randomized subspace iteration,
+ * as in RandomizedApply(); the mean is never subtracted from the data itself.
+ * With A = S^-1 (X - mean * 1^T), A^T * B = X^T * S^-1 B - 1 * (mean^T S^-1 B),
+ * and A * Y = S^-1 (X * Y - mean * (1^T Y)), so every product with A is a
+ * product with the sparse X and a rank-one correction.
+ */
+double PCA::Apply(const arma::sp_mat& data,
+                  arma::mat& transformedData,
+                  arma::vec& eigVal,
+                  arma::mat& eigvec,
+                  const size_t newDimension) const
+{
+  // Parameter validation.
+  if (newDimension == 0)
+    Log::Fatal << "PCA::Apply(): newDimension (" << newDimension << ") cannot "
+        << "be zero!" << endl;
+  if (newDimension > data.n_rows)
+    Log::Fatal << "PCA::Apply(): newDimension (" << newDimension << ") cannot "
+        << "be greater than the existing dimensionality of the data ("
+        << data.n_rows << ")!" << endl;
+  if (data.n_cols < 2)
+    Log::Fatal << "PCA::Apply(): at least two points are needed!" << endl;
+
+  Timer::Start("pca");
+
+  // The mean and the variance of every dimension come from the nonzero values
+  // alone.
+  const size_t n = data.n_cols;
+  arma::vec mean(data.n_rows, arma::fill::zeros);
+  arma::vec variance(data.n_rows, arma::fill::zeros);
+  for (size_t j = 0; j < data.n_nonzero; ++j)
+  {
+    mean[data.row_indices[j]] += data.values[j];
+    variance[data.row_indices[j]] += data.values[j] * data.values[j];
+  }
+  mean /= n;
+  variance = (variance - n * arma::square(mean)) / (n - 1);
+  for (size_t i = 0; i < variance.n_elem; ++i)
+    if (variance[i] < 0)
+      variance[i] = 0; // Round-off.
+
+  arma::vec stdDev(data.n_rows, arma::fill::ones);
+  if (scaleData)
+  {
+    // If there are any zeroes, make them very small.
+    stdDev = arma::sqrt(variance);
+    for (size_t i = 0; i < stdDev.n_elem; ++i)
+      if (stdDev[i] == 0)
+        stdDev[i] = 1e-50;
+  }
+  const double totalVariance = arma::accu(variance / arma::square(stdDev));
+
+  const arma::sp_mat dataTrans = data.t();
+
+  const size_t basisSize = std::min(newDimension + Oversampling,
+      (size_t) data.n_rows);
+  arma::mat basis, r, product;
+  arma::mat start = arma::randn<arma::mat>(data.n_rows, basisSize);
+  arma::qr_econ(basis, r, start);
+  for (size_t i = 0; i < PowerIterations; ++i)
+  {
+    SparseCovarianceProduct(data, dataTrans, mean, stdDev, basis, product);
+    arma::qr_econ(basis, r, product);
+  }
+
+  // Eigendecompose the projection of the covariance onto the basis.
+  SparseCovarianceProduct(data, dataTrans, mean, stdDev, basis, product);
+  const arma::mat projection = basis.t() * product;
+  arma::vec values;
+  arma::mat vectors;
+  arma::eig_sym(values, vectors, 0.5 * (projection + projection.t()));
+
+  // The eigenvalues are in ascending order.
+  eigVal = arma::flipud(values.tail(newDimension)) / (n - 1);
+  eigvec = basis * arma::fliplr(vectors.tail_cols(newDimension));
+
+  // Project the samples to the principal components; the centering and the
+  // scaling are folded into the projection.
+  arma::mat projectionTrans = arma::trans(eigvec);
+  projectionTrans.each_row() /= arma::trans(stdDev);
+  const arma::vec offset = projectionTrans * mean;
+
+  transformedData.set_size(newDimension, n);
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < n; ++i)
+  {
+    double* point = transformedData.colptr(i);
+    for (size_t k = 0; k < newDimension; ++k)
+      point[k] = -offset[k];
+
+    for (size_t j = data.col_ptrs[i]; j < data.col_ptrs[i + 1]; ++j)
+    {
+      const double value = data.values[j];
+      const double* direction = projectionTrans.colptr(data.row_indices[j]);
+      for (size_t k = 0; k < newDimension; ++k)
+        point[k] += value * direction[k];
+    }
+  }
+
+  Timer::Stop("pca");
+
+  return arma::accu(eigVal) / totalVariance;
+}
+
+double PCA::Apply(const arma::sp_mat& data,
+                  arma::mat& transformedData,
+                  const size_t newDimension) const
+{
+  arma::vec eigVal;
+  arma::mat eigvec;
+  return Apply(data, transformedData, eigVal, eigvec, newDimension);
+}
+
+void PCA::SparseCovarianceProduct(const arma::sp_mat& data,
+                                  const arma::sp_mat& dataTrans,
+                                  const arma::vec& mean,
+                                  const arma::vec& stdDev,
+                                  const arma::mat& basis,
+                                  arma::mat& product) const
+{
+  const size_t k = basis.n_cols;
+
+  // Y^T = (S^-1 B)^T (X - mean * 1^T), one point at a time.
+  arma::mat scaledTrans = arma::trans(basis);
+  scaledTrans.each_row() /= arma::trans(stdDev);
+  const arma::vec shift = scaledTrans * mean;
+
+  arma::mat y(k, data.n_cols);
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    double* point = y.colptr(i);
+    for (size_t c = 0; c < k; ++c)
+      point[c] = -shift[c];
+
+    for (size_t j = data.col_ptrs[i]; j < data.col_ptrs[i + 1]; ++j)
+    {
+      const double value = data.values[j];
+      const double* row = scaledTrans.colptr(data.row_indices[j]);
+      for (size_t c = 0; c < k; ++c)
+        point[c] += value * row[c];
+    }
+  }
+  const arma::vec ySum = arma::sum(y, 1);
+
+  // Row d of the product is S^-1 (sum_i x_di y_i - mean_d sum_i y_i), one
+  // dimension at a time, with the points of the dimension from the transpose.
+  arma::mat productTrans(k, data.n_rows);
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t d = 0; d < data.n_rows; ++d)
+  {
+    double* row = productTrans.colptr(d);
+    for (size_t c = 0; c < k; ++c)
+      row[c] = -mean[d] * ySum[c];
+
+    for (size_t j = dataTrans.col_ptrs[d]; j < dataTrans.col_ptrs[d + 1]; ++j)
+    {
+      const double value = dataTrans.values[j];
+      const double* point = y.colptr(dataTrans.row_indices[j]);
+      for (size_t c = 0; c < k; ++c)
+        row[c] += value * point[c];
+    }
+
+    for (size_t c = 0; c < k; ++c)
+      row[c] /= stdDev[d];
+  }
+
+  product = arma::trans(productTrans);
+}
+
 // return a string of this object.
 std::string PCA::ToString() const
 {
@@ -179,5 +505,7 @@ std::string PCA::ToString() const
   convert << "Principal Component Analysis  [" << this << "]" << std::endl;
   if (scaleData)
     convert << "  Scaling Data: TRUE" << std::endl;
+  if (randomized)
+    convert << "  Randomized: TRUE" << std::endl;
   return convert.str();
 }
@@ -27,9 +27,18 @@ class PCA
    * Create the PCA object, specifying if the data should be scaled in each
    * dimension by standard deviation when PCA is performed.
    *
+   * If randomized is true, dimensionality reduction to a given dimension (see
+   * Apply(data, newDimension)) only computes the needed principal components,
+   * with randomized subspace iteration, and never makes a centered copy of the
+   * data.  This is much faster when the new dimension is much smaller than the
+   * dimensionality of the data, and it is nearly exact when the eigenvalues of
+   * the kept components are well separated from the others.
+   *
    * @param scaleData Whether or not to scale the data.
+   * @param randomized Whether or not to use randomized dimensionality
+   *     reduction.
    */
-  PCA(const bool scaleData = false);
+  PCA(const bool scaleData = false, const bool randomized = false);
 
   /**
    * Apply Principal Component Analysis to the provided data set.  It is safe to
@@ -93,6 +102,42 @@ class PCA
    */
   double Apply(arma::mat& data, const double varRetained) const;
 
+  /**
+   * Use PCA for dimensionality reduction on the given sparse dataset, keeping
+   * the newDimension largest principal components.  The components are found
+   * with randomized subspace iteration (as with randomized dimensionality
+   * reduction on dense data), and the data is centered implicitly: the mean is
+   * subtracted with rank-one corrections of the products with the sparse
+   * matrix, so the dense centered data is never formed.  The memory needed
+   * besides the data (and a transposed copy of it) is proportional to the
+   * number of points plus the dimensionality, times the new dimension.
+   *
+   * @param data Sparse data matrix.
+   * @param transformedData Matrix to store the (dense) results of PCA in.
+   * @param eigVal Vector to put the newDimension largest eigenvalues into.
+   * @param eigvec Matrix to put the corresponding eigenvectors (loadings) into.
+   * @param newDimension New dimension of the data.
+   * @return Amount of the variance of the data retained (between 0 and 1).
+   */
+  double Apply(const arma::sp_mat& data,
+               arma::mat& transformedData,
+               arma::vec& eigVal,
+               arma::mat& eigvec,
+               const size_t newDimension) const;
+
+  /**
+   * Use PCA for dimensionality reduction on the given sparse dataset, keeping
+   * the newDimension largest principal components; see above.
+   *
+   * @param data Sparse data matrix.
+   * @param transformedData Matrix to store the (dense) results of PCA in.
+   * @param newDimension New dimension of the data.
+   * @return Amount of the variance of the data retained (between 0 and 1).
+   */
+  double Apply(const arma::sp_mat& data,
+               arma::mat& transformedData,
+               const size_t newDimension) const;
+
   //! Get whether or not this PCA object will scale (by standard deviation) the
   //! data when PCA is performed.
   bool ScaleData() const { return scaleData; }
@@ -100,6 +145,13 @@ class PCA
   //! the data when PCA is performed.
   bool& ScaleData() { return scaleData; }
 
+  //! Get whether or not dimensionality reduction to a given dimension is
+  //! randomized.
+  bool Randomized() const { return randomized; }
+  //! Modify whether or not dimensionality reduction to a given dimension is
+  //! randomized.
+  bool& Randomized() { return randomized; }
+
   // Returns a string representation of this object.
   std::string ToString() const;
 
@@ -107,6 +159,65 @@ class PCA
   //! Whether or not the data will be scaled by standard deviation when PCA is
   //! performed.
   bool scaleData;
+  //! Whether or not dimensionality reduction to a given dimension is
+  //! randomized.
+  bool randomized;
+
+  //! The number of extra directions used by randomized subspace iteration.
+  static const size_t Oversampling = 10;
+  //! The number of iterations of randomized subspace iteration.
+  static const size_t PowerIterations = 3;
+  //! The number of points that are centered (and scaled) at once.
+  static const size_t ChunkSize = 512;
+
+  /**
+   * Reduce the dimensionality of the data with randomized subspace iteration on
+   * the covariance matrix, which is never formed explicitly.
+   *
+   * @param data Data matrix, to be replaced with the transformed data.
+   * @param newDimension New dimension of the data.
+   * @return Amount of the variance of the data retained (between 0 and 1).
+   */
+  double RandomizedApply(arma::mat& data, const size_t newDimension) const;
+
+  /**
+   * Copy the given points of the data, centered and scaled (if necessary).
+   *
+   * @param data Data matrix.
+   * @param mean Mean of the data.
+   * @param stdDev Standard deviation of each dimension (if scaling).
+   * @param begin Index of the first point.
+   * @param end Index after the last point.
+   * @param chunk Matrix to store the centered points in.
+   */
+  void CenteredChunk(const arma::mat& data,
+                     const arma::vec& mean,
+                     const arma::vec& stdDev,
+                     const size_t begin,
+                     const size_t end,
+                     arma::mat& chunk) const;
+
+  /**
+   * Compute A * A^T * basis, where A is the centered (and scaled) data, chunk
+   * by chunk.
+   */
+  void CovarianceProduct(const arma::mat& data,
+                         const arma::vec& mean,
+                         const arma::vec& stdDev,
+                         const arma::mat& basis,
+                         arma::mat& product) const;
+
+  /**
+   * Compute A * A^T * basis, where A is the sparse data, centered (and scaled)
+   * implicitly.  The data is used column by column (points) and through its
+   * transpose row by row (dimensions), both in parallel.
+   */
+  void SparseCovarianceProduct(const arma::sp_mat& data,
+                               const arma::sp_mat& dataTrans,
+                               const arma::vec& mean,
+                               const arma::vec& stdDev,
+                               const arma::mat& basis,
+                               arma::mat& product) const;
 
 }; // class PCA
 
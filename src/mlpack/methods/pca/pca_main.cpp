@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 
 #include "pca.hpp"
+#include "incremental_pca.hpp"
 
 using namespace mlpack;
 using namespace mlpack::pca;
@@ -17,7 +18,17 @@ PROGRAM_INFO("Principal Components Analysis", "This program performs principal "
     "components analysis on the given dataset.  It will transform the data "
     "onto its principal components, optionally performing dimensionality "
     "reduction by ignoring the principal components with the smallest "
-    "eigenvalues.");
+    "eigenvalues."
+    "\n\n"
+    "The --decomposition_method (-c) option selects how the principal "
+    "components are computed: 'exact' computes all of them with a singular "
+    "value decomposition; 'randomized' computes only the --new_dimensionality "
+    "leading components with randomized subspace iteration, which is much "
+    "faster when few components are kept; 'incremental' updates the leading "
+    "components with chunks of --chunk_size points at a time, so that the "
+    "data is never centered as a whole.  The 'randomized' and 'incremental' "
+    "methods need --new_dimensionality, and 'incremental' doesn't support "
+    "--scale.");
 
 // Parameters for program.
 PARAM_STRING_REQ("input_file", "Input dataset to perform PCA on.", "i");
@@ -30,6 +41,11 @@ PARAM_DOUBLE("var_to_retain", "Amount of variance to retain; should be between "
 PARAM_FLAG("scale", "If set, the data will be scaled before running PCA, such "
     "that the variance of each feature is 1.", "s");
 
+PARAM_STRING("decomposition_method", "Method used to compute the principal "
+    "components: 'exact', 'randomized', or 'incremental'.", "c", "exact");
+PARAM_INT("chunk_size", "Number of points per chunk for the 'incremental' "
+    "decomposition method.", "C", 1000);
+
 int main(int argc, char** argv)
 {
   // Parse commandline.
@@ -56,12 +72,50 @@ int main(int argc, char** argv)
 
   // Get the options for running PCA.
   const size_t scale = CLI::HasParam("scale");
+  const string method = CLI::GetParam<string>("decomposition_method");
+  if (method != "exact" && method != "randomized" && method != "incremental")
+  {
+    Log::Fatal << "Invalid decomposition method '" << method << "'; valid "
+        << "choices are 'exact', 'randomized', and 'incremental'." << endl;
+  }
+
+  if (method != "exact" && (CLI::GetParam<int>("new_dimensionality") == 0 ||
+      CLI::GetParam<double>("var_to_retain") != 0))
+  {
+    Log::Fatal << "The '" << method << "' decomposition method needs the new "
+        << "dimensionality (-d), and doesn't support -V." << endl;
+  }
 
   // Perform PCA.
-  PCA p(scale);
+  PCA p(scale, method == "randomized");
   Log::Info << "Performing PCA on dataset..." << endl;
   double varRetained;
-  if (CLI::GetParam<double>("var_to_retain") != 0)
+  if (method == "incremental")
+  {
+    if (scale)
+      Log::Fatal << "The 'incremental' decomposition method doesn't support "
+          << "--scale." << endl;
+
+    if (CLI::GetParam<int>("chunk_size") <= 0)
+    {
+      Log::Fatal << "Invalid chunk size (" << CLI::GetParam<int>("chunk_size")
+          << "); must be positive." << endl;
+    }
+    const size_t chunkSize = (size_t) CLI::GetParam<int>("chunk_size");
+
+    Timer::Start("pca");
+    IncrementalPCA ipca(newDimension);
+    for (size_t begin = 0; begin < dataset.n_cols; begin += chunkSize)
+    {
+      const size_t end = std::min(begin + chunkSize, (size_t) dataset.n_cols);
+      ipca.Update(dataset.cols(begin, end - 1));
+    }
+    ipca.Transform(dataset, dataset);
+    Timer::Stop("pca");
+
+    varRetained = ipca.VarianceRetained();
+  }
+  else if (CLI::GetParam<double>("var_to_retain") != 0)
   {
     if (CLI::GetParam<int>("new_dimensionality") != 0)
       Log::Warn << "New dimensionality (-d) ignored because -V was specified."
@@ -21,11 +21,22 @@ class RandomInitialization
  public:
   RandomInitialization() { }
 
-  inline static void Initialize(arma::mat& W,
-                                const size_t row,
-                                const size_t col)
+  /**
+   * Initialize the weights (one column for each class) and the biases randomly
+   * in [0, 1].
+   *
+   * @param weights Weights to initialize, numFeatures x numClasses.
+   * @param biases Biases to initialize, one for each class.
+   * @param numFeatures Dimensionality of the data.
+   * @param numClasses Number of classes.
+   */
+  inline static void Initialize(arma::mat& weights,
+                                arma::vec& biases,
+                                const size_t numFeatures,
+                                const size_t numClasses)
   {
-    W = arma::randu<arma::mat>(row, col);
+    weights.randu(numFeatures, numClasses);
+    biases.randu(numClasses);
   }
 }; // class RandomInitialization
 
@@ -20,14 +20,21 @@ class ZeroInitialization
  public:
   ZeroInitialization() { }
 
-  inline static void Initialize(arma::mat& W,
-                                const size_t row,
-                                const size_t col)
+  /**
+   * Initialize the weights (one column for each class) and the biases to zero.
+   *
+   * @param weights Weights to initialize, numFeatures x numClasses.
+   * @param biases Biases to initialize, one for each class.
+   * @param numFeatures Dimensionality of the data.
+   * @param numClasses Number of classes.
+   */
+  inline static void Initialize(arma::mat& weights,
+                                arma::vec& biases,
+                                const size_t numFeatures,
+                                const size_t numClasses)
   {
-    arma::mat tempWeights(row, col);
-    tempWeights.fill(0.0);
-
-    W = tempWeights;
+    weights.zeros(numFeatures, numClasses);
+    biases.zeros(numClasses);
   }
 }; // class ZeroInitialization
 
@@ -26,29 +26,57 @@ class SimpleWeightUpdate
 {
  public:
   /**
-   * This function is called to update the weightVectors matrix.
-   *  It decreases the weights of the incorrectly classified class while
-   * increasing the weight of the correct class it should have been classified to.
+   * This function is called to update the weights and biases of the classes.
+   * It decreases the weights of the incorrectly classified class while
+   * increasing the weight of the correct class it should have been classified
+   * to.  Only the nonzero values of the point are visited, so when MatType is
+   * arma::sp_mat an update costs O(nnz) instead of O(dimensionality).
    *
-   * @param trainData The training dataset.
-   * @param weightVectors Matrix of weight vectors.
-   * @param rowIndex Index of the row which has been incorrectly predicted.
-   * @param labelIndex Index of the vector in trainData.
-   * @param vectorIndex Index of the class which should have been predicted.
-   * @param D Cost of mispredicting the labelIndex instance.
+   * @param data The training dataset.
+   * @param index Index of the incorrectly classified point in data.
+   * @param weights Weights of the classes, one column for each class.
+   * @param biases Biases of the classes.
+   * @param incorrectClass Index of the class which was predicted.
+   * @param correctClass Index of the class which should have been predicted.
+   * @param instanceWeight Cost of mispredicting the point.
    */
-  void UpdateWeights(const arma::mat& trainData,
-                     arma::mat& weightVectors,
-                     const size_t labelIndex,
-                     const size_t vectorIndex,
-                     const size_t rowIndex,
-                     const arma::rowvec& D)
+  template<typename MatType>
+  void UpdateWeights(const MatType& data,
+                     const size_t index,
+                     arma::mat& weights,
+                     arma::vec& biases,
+                     const size_t incorrectClass,
+                     const size_t correctClass,
+                     const double instanceWeight = 1.0)
   {
-    weightVectors.row(rowIndex) = weightVectors.row(rowIndex) -
-                                  D(labelIndex) * trainData.col(labelIndex).t();
+    AddPoint(data, index, -instanceWeight, weights.colptr(incorrectClass));
+    biases[incorrectClass] -= instanceWeight;
 
-    weightVectors.row(vectorIndex) = weightVectors.row(vectorIndex) +
-                                     D(labelIndex) * trainData.col(labelIndex).t();
+    AddPoint(data, index, instanceWeight, weights.colptr(correctClass));
+    biases[correctClass] += instanceWeight;
+  }
+
+ private:
+  //! Add weight times the given dense point to w.
+  static void AddPoint(const arma::mat& data,
+                       const size_t index,
+                       const double weight,
+                       double* w)
+  {
+    const double* x = data.colptr(index);
+    for (size_t i = 0; i < data.n_rows; ++i)
+      w[i] += weight * x[i];
+  }
+
+  //! Add weight times the nonzero values of the given sparse point to w.
+  static void AddPoint(const arma::sp_mat& data,
+                       const size_t index,
+                       const double weight,
+                       double* w)
+  {
+    for (arma::sp_mat::const_iterator it = data.begin_col(index);
+         it != data.end_col(index); ++it)
+      w[it.row()] += weight * (*it);
   }
 };
 
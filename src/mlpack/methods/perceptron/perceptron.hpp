@@ -21,9 +21,19 @@ namespace perceptron {
  * network).  It converges if the supplied training dataset is linearly
  * separable.
  *
+ * The model holds one weight vector and one bias for every class, and a point
+ * is assigned to the class with the highest score.  Optionally, the averaged
+ * perceptron is trained: the weights are the average of the weights after
+ * every point of the training, which generalizes better and usually needs far
+ * fewer passes over the data.
+ *
+ * The data may be dense (arma::mat) or sparse (arma::sp_mat); for sparse data,
+ * training and classification only visit the nonzero values.
+ *
  * @tparam LearnPolicy Options of SimpleWeightUpdate and GradientDescent.
  * @tparam WeightInitializationPolicy Option of ZeroInitialization and
  *      RandomInitialization.
+ * @tparam MatType Type of the data, arma::mat or arma::sp_mat.
  */
 template<typename LearnPolicy = SimpleWeightUpdate,
          typename WeightInitializationPolicy = ZeroInitialization,
@@ -32,26 +42,32 @@ class Perceptron
 {
  public:
   /**
-   * Constructor - constructs the perceptron by building the weightVectors
-   * matrix, which is later used in Classification.  It adds a bias input vector
-   * of 1 to the input data to take care of the bias weights.
+   * Constructor - constructs the perceptron by training the weights and biases
+   * of every class on the given data.
    *
    * @param data Input, training data.
    * @param labels Labels of dataset.
    * @param iterations Maximum number of iterations for the perceptron learning
    *     algorithm.
+   * @param average Whether or not to train the averaged perceptron.
    */
-  Perceptron(const MatType& data, const arma::Row<size_t>& labels, int iterations);
+  Perceptron(const MatType& data,
+             const arma::Row<size_t>& labels,
+             const size_t iterations,
+             const bool average = false);
 
   /**
-   * Classification function. After training, use the weightVectors matrix to
-   * classify test, and put the predicted classes in predictedLabels.
+   * Classification function. After training, use the weights and biases to
+   * classify test, and put the predicted classes in predictedLabels.  The
+   * scores of a block of points are computed at once (with one matrix
+   * multiplication for dense data), and the blocks are classified in
+   * parallel.
    *
    * @param test Testing data or data to classify.
    * @param predictedLabels Vector to store the predicted classes after
    *     classifying test.
    */
-  void Classify(const MatType& test, arma::Row<size_t>& predictedLabels);
+  void Classify(const MatType& test, arma::Row<size_t>& predictedLabels) const;
 
   /**
    *  Alternate constructor which copies parameters from an already initiated
@@ -63,27 +79,65 @@ class Perceptron
    *  @param D Weight vector to use while training. For boosting purposes.
    *  @param labels The labels of data.
    */
-  Perceptron(const Perceptron<>& other, MatType& data, const arma::rowvec& D, const arma::Row<size_t>& labels);
+  Perceptron(const Perceptron& other,
+             const MatType& data,
+             const arma::rowvec& D,
+             const arma::Row<size_t>& labels);
+
+  //! Get the weights of the classes (one column for each class).
+  const arma::mat& Weights() const { return weights; }
+  //! Get the biases of the classes.
+  const arma::vec& Biases() const { return biases; }
+
+  //! Get whether or not the averaged perceptron is trained.
+  bool Average() const { return average; }
 
 private:
+  //! Number of points whose scores are computed at once when classifying.
+  static const size_t BlockSize = 1024;
+
   //! To store the number of iterations
   size_t iter;
 
-  //! Stores the class labels for the input data.
-  arma::Row<size_t> classLabels;
+  //! Whether or not to train the averaged perceptron.
+  bool average;
 
-  //! Stores the weight vectors for each of the input class labels.
-  arma::mat weightVectors;
+  //! Stores the weight vectors of the classes, one in each column.
+  arma::mat weights;
 
-  //! Stores the training data to be used later on in UpdateWeights.
-  arma::mat trainData;
+  //! Stores the biases of the classes.
+  arma::vec biases;
 
   /**
-   *  Training Function. It trains on trainData using the cost matrix D
+   *  Training Function. It trains on data using the cost matrix D
    *
+   *  @param data Training data.
+   *  @param labels Labels of the training data.
    *  @param D Cost matrix. Stores the cost of mispredicting instances
    */
-  void Train(const arma::rowvec& D);
+  void Train(const MatType& data,
+             const arma::Row<size_t>& labels,
+             const arma::rowvec& D);
+
+  //! Compute the scores of every class for the given dense point.
+  void Score(const arma::mat& data, const size_t i, arma::vec& scores) const;
+  //! Compute the scores of every class for the given sparse point.
+  void Score(const arma::sp_mat& data, const size_t i, arma::vec& scores)
+      const;
+
+  //! Compute the scores of the dense points in [begin, end), one per column.
+  void Scores(const arma::mat& data,
+              const size_t begin,
+              const size_t end,
+              arma::mat& scores) const;
+  //! Compute the scores of the sparse points in [begin, end), one per column.
+  void Scores(const arma::sp_mat& data,
+              const size_t begin,
+              const size_t end,
+              arma::mat& scores) const;
+
+  //! Return the index of the highest of the given scores.
+  static size_t MaxIndex(const double* scores, const size_t n);
 };
 
 } // namespace perceptron
@@ -13,15 +13,14 @@ namespace mlpack {
 namespace perceptron {
 
 /**
- * Constructor - constructs the perceptron. Or rather, builds the weightVectors
- * matrix, which is later used in Classification.
- * It adds a bias input vector of 1 to the input data to take care of the bias
- * weights.
+ * Constructor - constructs the perceptron. Or rather, trains the weights and
+ * biases of the classes, which are later used in Classification.
  *
  * @param data Input, training data.
  * @param labels Labels of dataset.
  * @param iterations Maximum number of iterations for the perceptron learning
  *      algorithm.
+ * @param average Whether or not to train the averaged perceptron.
  */
 template<
     typename LearnPolicy,
@@ -31,30 +30,23 @@ template<
 Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
     const MatType& data,
     const arma::Row<size_t>& labels,
-    int iterations)
+    const size_t iterations,
+    const bool average) :
+    iter(iterations),
+    average(average)
 {
   WeightInitializationPolicy WIP;
-  WIP.Initialize(weightVectors, arma::max(labels) + 1, data.n_rows + 1);
+  WIP.Initialize(weights, biases, data.n_rows, arma::max(labels) + 1);
 
-  // Start training.
-  classLabels = labels;
-
-  trainData = data;
-  // Insert a row of ones at the top of the training data set.
-  MatType zOnes(1, data.n_cols);
-  zOnes.fill(1);
-  trainData.insert_rows(0, zOnes);
-
-  iter = iterations;
   arma::rowvec D(data.n_cols);
   D.fill(1.0);// giving equal weight to all the points.
 
-  Train(D);
+  Train(data, labels, D);
 }
 
 
 /**
- * Classification function. After training, use the weightVectors matrix to
+ * Classification function. After training, use the weights and biases to
  * classify test, and put the predicted classes in predictedLabels.
  *
  * @param test testing data or data to classify.
@@ -64,20 +56,33 @@ Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
 template <typename LearnPolicy, typename WeightInitializationPolicy, typename MatType>
 void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Classify(
     const MatType& test,
-    arma::Row<size_t>& predictedLabels)
+    arma::Row<size_t>& predictedLabels) const
 {
-  arma::mat tempLabelMat;
-  arma::uword maxIndexRow, maxIndexCol;
+  if (test.n_rows != weights.n_rows)
+  {
+    Log::Fatal << "Perceptron::Classify(): test data has " << test.n_rows
+        << " dimensions, but the perceptron was trained on " << weights.n_rows
+        << " dimensions!" << std::endl;
+  }
+
+  predictedLabels.set_size(test.n_cols);
+  const size_t numBlocks = (test.n_cols + BlockSize - 1) / BlockSize;
 
-  for (size_t i = 0; i < test.n_cols; i++)
+  #pragma omp parallel
   {
-    tempLabelMat = weightVectors.submat(0, 1, weightVectors.n_rows - 1,
-                                        weightVectors.n_cols - 1) *
-                                        test.col(i) + weightVectors.col(0);
-    tempLabelMat.max(maxIndexRow, maxIndexCol);
-    predictedLabels(0, i) = maxIndexRow;
+    arma::mat scores;
+
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) test.n_cols);
+
+      Scores(test, begin, end, scores);
+      for (size_t i = begin; i < end; ++i)
+        predictedLabels[i] = MaxIndex(scores.colptr(i - begin), scores.n_rows);
+    }
   }
-  // predictedLabels.print("These are the labels predicted by the perceptron");
 }
 
 /**
@@ -92,27 +97,24 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Classify(
  */
 template <typename LearnPolicy, typename WeightInitializationPolicy, typename MatType>
 Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Perceptron(
-  const Perceptron<>& other, MatType& data, const arma::rowvec& D, const arma::Row<size_t>& labels)
+    const Perceptron& other,
+    const MatType& data,
+    const arma::rowvec& D,
+    const arma::Row<size_t>& labels) :
+    iter(other.iter),
+    average(other.average)
 {
-
-  classLabels = labels;
-  trainData = data;
-  iter = other.iter;
-
-  // Insert a row of ones at the top of the training data set.
-  MatType zOnes(1, data.n_cols);
-  zOnes.fill(1);
-  trainData.insert_rows(0, zOnes);
-
   WeightInitializationPolicy WIP;
-  WIP.Initialize(weightVectors, arma::max(labels) + 1, data.n_rows + 1);
+  WIP.Initialize(weights, biases, data.n_rows, arma::max(labels) + 1);
 
-  Train(D);
+  Train(data, labels, D);
 }
 
 /**
- *  Training Function. It trains on trainData using the cost matrix D
+ *  Training Function. It trains on data using the cost matrix D
  *
+ *  @param data Training data.
+ *  @param labels Labels of the training data.
  *  @param D Cost matrix. Stores the cost of mispredicting instances
  */
 template<
@@ -121,13 +123,26 @@ template<
     typename MatType
 >
 void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
-     const arma::rowvec& D)
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const arma::rowvec& D)
 {
   size_t j, i = 0;
   bool converged = false;
   size_t tempLabel;
-  arma::uword maxIndexRow, maxIndexCol;
-  arma::mat tempLabelMat;
+  arma::vec scores(weights.n_cols);
+
+  // For the averaged perceptron, the averaged weights are computed at the end
+  // from the sum of the updates, each weighted by the number of points seen
+  // before it; so that an update costs the same as without averaging.
+  arma::mat accumulatedWeights;
+  arma::vec accumulatedBiases;
+  if (average)
+  {
+    accumulatedWeights.zeros(weights.n_rows, weights.n_cols);
+    accumulatedBiases.zeros(biases.n_elem);
+  }
+  size_t count = 1;
 
   LearnPolicy LP;
 
@@ -139,27 +154,134 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
     converged = true;
 
     // Now this inner loop is for going through the dataset in each iteration.
-    for (j = 0; j < trainData.n_cols; j++)
+    for (j = 0; j < data.n_cols; j++, count++)
     {
-      // Multiply for each variable and check whether the current weight vector
-      // correctly classifies this.
-      tempLabelMat = weightVectors * trainData.col(j);
-
-      tempLabelMat.max(maxIndexRow, maxIndexCol);
+      // Compute the score of every class and check whether the current weights
+      // correctly classify this point.
+      Score(data, j, scores);
+      const size_t maxIndexRow = MaxIndex(scores.memptr(), scores.n_elem);
 
       // Check whether prediction is correct.
-      if (maxIndexRow != classLabels(0, j))
+      if (maxIndexRow != labels[j])
       {
         // Due to incorrect prediction, convergence set to false.
         converged = false;
-        tempLabel = classLabels(0, j);
+        tempLabel = labels[j];
         // Send maxIndexRow for knowing which weight to update, send j to know
         // the value of the vector to update it with.  Send tempLabel to know
         // the correct class.
-        LP.UpdateWeights(trainData, weightVectors, j, tempLabel, maxIndexRow, D);
+        LP.UpdateWeights(data, j, weights, biases, maxIndexRow, tempLabel,
+            D[j]);
+        if (average)
+          LP.UpdateWeights(data, j, accumulatedWeights, accumulatedBiases,
+              maxIndexRow, tempLabel, count * D[j]);
       }
     }
   }
+
+  if (average)
+  {
+    weights -= accumulatedWeights / count;
+    biases -= accumulatedBiases / count;
+  }
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Score(
+    const arma::mat& data,
+    const size_t i,
+    arma::vec& scores) const
+{
+  const double* x = data.colptr(i);
+  for (size_t c = 0; c < weights.n_cols; ++c)
+  {
+    const double* w = weights.colptr(c);
+    double score = biases[c];
+    for (size_t k = 0; k < data.n_rows; ++k)
+      score += w[k] * x[k];
+    scores[c] = score;
+  }
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Score(
+    const arma::sp_mat& data,
+    const size_t i,
+    arma::vec& scores) const
+{
+  for (size_t c = 0; c < weights.n_cols; ++c)
+    scores[c] = biases[c];
+
+  for (arma::sp_mat::const_iterator it = data.begin_col(i);
+       it != data.end_col(i); ++it)
+  {
+    const double* w = weights.memptr() + it.row();
+    for (size_t c = 0; c < weights.n_cols; ++c)
+      scores[c] += (*it) * w[c * weights.n_rows];
+  }
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Scores(
+    const arma::mat& data,
+    const size_t begin,
+    const size_t end,
+    arma::mat& scores) const
+{
+  // An alias of the columns of the block, to avoid copying them.
+  const arma::mat block(const_cast<double*>(data.colptr(begin)), data.n_rows,
+      end - begin, false, true);
+
+  scores = arma::trans(weights) * block;
+  scores.each_col() += biases;
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Scores(
+    const arma::sp_mat& data,
+    const size_t begin,
+    const size_t end,
+    arma::mat& scores) const
+{
+  scores.set_size(weights.n_cols, end - begin);
+  for (size_t i = begin; i < end; ++i)
+  {
+    // Write the scores of the point directly into its column.
+    arma::vec column(scores.colptr(i - begin), scores.n_rows, false, true);
+    Score(data, i, column);
+  }
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+size_t Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::MaxIndex(
+    const double* scores,
+    const size_t n)
+{
+  size_t maxIndex = 0;
+  for (size_t c = 1; c < n; ++c)
+    if (scores[c] > scores[maxIndex])
+      maxIndex = c;
+  return maxIndex;
 }
 
 }; // namespace perceptron
@@ -37,6 +37,11 @@ PROGRAM_INFO("Perceptron",
     "A test file is given through the --test_file (-T) parameter.  The "
     "predicted labels for the test set will be stored in the file specified by "
     "the --output_file (-o) parameter."
+    "\n"
+    "If --average (-a) is given, the averaged perceptron is trained instead: "
+    "the weights are averaged over the whole training, which usually gives a "
+    "better classifier in fewer iterations on data that is not linearly "
+    "separable."
     );
 
 // Necessary parameters
@@ -50,6 +55,7 @@ PARAM_STRING("output", "The file in which the predicted labels for the test set"
     " will be written.", "o", "output.csv");
 PARAM_INT("iterations","The maximum number of iterations the perceptron is "
   "to be run", "i", 1000);
+PARAM_FLAG("average", "Train the averaged perceptron.", "a");
 
 int main(int argc, char** argv)
 {
@@ -102,10 +108,11 @@ int main(int argc, char** argv)
   }
 
   int iterations = CLI::GetParam<int>("iterations");
+  const bool average = CLI::HasParam("average");
 
   // Create and train the classifier.
   Timer::Start("Training");
-  Perceptron<> p(trainingData, labels.t(), iterations);
+  Perceptron<> p(trainingData, labels.t(), iterations, average);
   Timer::Stop("Training");
 
   // Time the running of the Perceptron Classifier.
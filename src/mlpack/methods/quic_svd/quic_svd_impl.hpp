@@ -25,14 +25,23 @@ QUIC_SVD::QUIC_SVD(const arma::mat& dataset,
 {
   // Since columns are sample in the implementation, the matrix is transposed if
   // necessary for maximum speedup.
-  CosineTree* ctree;
+  // The tree holds a reference to its dataset, so the transposed matrix has to
+  // outlive it.
   if (dataset.n_cols > dataset.n_rows)
-    ctree = new CosineTree(dataset, epsilon, delta);
+  {
+    CosineTree ctree(dataset, epsilon, delta);
+
+    // Get subspace basis by creating the cosine tree.
+    ctree.GetFinalBasis(basis);
+  }
   else
-    ctree = new CosineTree(dataset.t(), epsilon, delta);
+  {
+    const arma::mat transposedDataset = arma::trans(dataset);
+    CosineTree ctree(transposedDataset, epsilon, delta);
 
-  // Get subspace basis by creating the cosine tree.
-  ctree->GetFinalBasis(basis);
+    // Get subspace basis by creating the cosine tree.
+    ctree.GetFinalBasis(basis);
+  }
 
   // Use the ExtractSVD algorithm mentioned in the paper to extract the SVD of
   // the original dataset in the obtained subspace.
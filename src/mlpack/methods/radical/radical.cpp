@@ -7,6 +7,10 @@
 
 #include "radical.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace std;
 using namespace arma;
 using namespace mlpack;
@@ -38,7 +42,8 @@ void Radical::CopyAndPerturb(mat& xNew, const mat& x) const
 
 double Radical::Vasicek(vec& z) const
 {
-  z = sort(z);
+  // Sort in place, so that no memory is allocated.
+  std::sort(z.begin(), z.end());
 
   // Apparently slower.
   /*
@@ -61,28 +66,45 @@ double Radical::Vasicek(vec& z) const
 
 double Radical::DoRadical2D(const mat& matX)
 {
-  CopyAndPerturb(perturbed, matX);
+  perturbed.resize(1);
+  CopyAndPerturb(perturbed[0], matX);
+
+  return BestAngle(perturbed[0], true);
+}
 
-  mat::fixed<2, 2> matJacobi;
+
+double Radical::BestAngle(const mat& perturbedX, const bool parallel) const
+{
+  const size_t n = perturbedX.n_rows;
+  const double* x1 = perturbedX.colptr(0);
+  const double* x2 = perturbedX.colptr(1);
 
   vec values(angles);
 
-  for (size_t i = 0; i < angles; i++)
+  #pragma omp parallel if(parallel)
   {
-    const double theta = (i / (double) angles) * M_PI / 2.0;
-    const double cosTheta = cos(theta);
-    const double sinTheta = sin(theta);
+    // The rotated dimensions are sorted in place, so these buffers are all the
+    // memory the search needs.
+    vec candidateY1(n);
+    vec candidateY2(n);
 
-    matJacobi(0, 0) = cosTheta;
-    matJacobi(1, 0) = -sinTheta;
-    matJacobi(0, 1) = sinTheta;
-    matJacobi(1, 1) = cosTheta;
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < angles; i++)
+    {
+      const double theta = (i / (double) angles) * M_PI / 2.0;
+      const double cosTheta = cos(theta);
+      const double sinTheta = sin(theta);
 
-    candidate = perturbed * matJacobi;
-    vec candidateY1 = candidate.unsafe_col(0);
-    vec candidateY2 = candidate.unsafe_col(1);
+      // This is perturbedX times the Jacobi rotation matrix
+      //   [ cos(theta)  sin(theta); -sin(theta)  cos(theta) ].
+      for (size_t k = 0; k < n; k++)
+      {
+        candidateY1[k] = cosTheta * x1[k] - sinTheta * x2[k];
+        candidateY2[k] = sinTheta * x1[k] + cosTheta * x2[k];
+      }
 
-    values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+      values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+    }
   }
 
   uword indOpt;
@@ -91,6 +113,29 @@ double Radical::DoRadical2D(const mat& matX)
 }
 
 
+void Radical::Rotate(mat& matrix,
+                     const size_t i,
+                     const size_t j,
+                     const double theta)
+{
+  const double cosTheta = cos(theta);
+  const double sinTheta = sin(theta);
+
+  // Only columns i and j change when the matrix is multiplied by the Jacobi
+  // rotation J, where J(i, i) = J(j, j) = cos(theta), J(j, i) = -sin(theta)
+  // and J(i, j) = sin(theta).
+  double* columnI = matrix.colptr(i);
+  double* columnJ = matrix.colptr(j);
+  for (size_t k = 0; k < matrix.n_rows; k++)
+  {
+    const double valueI = columnI[k];
+    const double valueJ = columnJ[k];
+    columnI[k] = cosTheta * valueI - sinTheta * valueJ;
+    columnJ[k] = sinTheta * valueI + cosTheta * valueJ;
+  }
+}
+
+
 void Radical::DoRadical(const mat& matXT, mat& matY, mat& matW)
 {
   // matX is nPoints by nDims (although less intuitive than columns being
@@ -125,42 +170,69 @@ void Radical::DoRadical(const mat& matXT, mat& matY, mat& matW)
   Timer::Start("radical_do_radical");
   matW = matWhitening;
 
+  // Each sweep visits all the pairs of dimensions in rounds of disjoint pairs
+  // (the circle method for round-robin tournaments, with a dummy dimension if
+  // the number of dimensions is odd).  The pairs of a round touch different
+  // columns of matY, so they can be rotated at the same time.  They are
+  // handled in batches of one pair per thread; the perturbations are drawn
+  // before each batch, in order, so the results don't depend on the number of
+  // threads.
+  size_t batchSize = 1;
+  #ifdef _OPENMP
+    batchSize = omp_get_max_threads();
+  #endif
+
+  const size_t players = nDims + (nDims % 2);
   mat matYSubspace(nPoints, 2);
-
-  mat matJ = eye(nDims, nDims);
+  arma::Mat<size_t> pairs(2, players / 2);
+  vec thetas(players / 2);
 
   for (size_t sweepNum = 0; sweepNum < sweeps; sweepNum++)
   {
     Log::Info << "RADICAL: sweep " << sweepNum << "." << std::endl;
 
-    for (size_t i = 0; i < nDims - 1; i++)
+    for (size_t round = 0; round + 1 < players; round++)
     {
-      for (size_t j = i + 1; j < nDims; j++)
+      // Collect the pairs of this round.
+      size_t numPairs = 0;
+      for (size_t k = 0; k < players / 2; k++)
       {
-        Log::Debug << "RADICAL 2D on dimensions " << i << " and " << j << "."
-            << std::endl;
-
-        matYSubspace.col(0) = matY.col(i);
-        matYSubspace.col(1) = matY.col(j);
-
-        const double thetaOpt = DoRadical2D(matYSubspace);
-
-        const double cosThetaOpt = cos(thetaOpt);
-        const double sinThetaOpt = sin(thetaOpt);
-
-        // Set elements of transformation matrix.
-        matJ(i, i) = cosThetaOpt;
-        matJ(j, i) = -sinThetaOpt;
-        matJ(i, j) = sinThetaOpt;
-        matJ(j, j) = cosThetaOpt;
-
-        matY *= matJ;
+        const size_t a = (k == 0) ? players - 1 :
+            (round + k) % (players - 1);
+        const size_t b = (round + players - 1 - k) % (players - 1);
+        if (a >= nDims || b >= nDims)
+          continue; // The dummy dimension.
+
+        pairs(0, numPairs) = std::min(a, b);
+        pairs(1, numPairs) = std::max(a, b);
+        ++numPairs;
+      }
 
-        // Unset elements of transformation matrix, so matJ = eye() again.
-        matJ(i, i) = 1;
-        matJ(j, i) = 0;
-        matJ(i, j) = 0;
-        matJ(j, j) = 1;
+      for (size_t begin = 0; begin < numPairs; begin += batchSize)
+      {
+        const size_t end = std::min(begin + batchSize, numPairs);
+
+        perturbed.resize(end - begin);
+        for (size_t p = begin; p < end; p++)
+        {
+          Log::Debug << "RADICAL 2D on dimensions " << pairs(0, p) << " and "
+              << pairs(1, p) << "." << std::endl;
+
+          matYSubspace.col(0) = matY.col(pairs(0, p));
+          matYSubspace.col(1) = matY.col(pairs(1, p));
+          CopyAndPerturb(perturbed[p - begin], matYSubspace);
+        }
+
+        // If there is only one pair, its angles are searched in parallel.
+        const bool parallelAngles = (end - begin == 1);
+
+        #pragma omp parallel for schedule(dynamic) if(!parallelAngles)
+        for (size_t p = begin; p < end; p++)
+        {
+          thetas[p] = BestAngle(perturbed[p - begin], parallelAngles);
+          Rotate(matY, pairs(0, p), pairs(1, p), thetas[p]);
+          Rotate(matW, pairs(0, p), pairs(1, p), thetas[p]);
+        }
       }
     }
   }
@@ -178,9 +250,10 @@ void mlpack::radical::WhitenFeatureMajorMatrix(const mat& matX,
                                                mat& matXWhitened,
                                                mat& matWhitening)
 {
-  mat matU, matV;
-  vec s;
-  svd(matU, s, matV, cov(matX));
+  mat matU, matV, covariance;
+  vec s, mean;
+  math::Covariance(trans(matX), mean, covariance);
+  svd(matU, s, matV, covariance);
   matWhitening = matU * diagmat(1 / sqrt(s)) * trans(matV);
   matXWhitened = matX * matWhitening;
 }
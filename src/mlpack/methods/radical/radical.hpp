@@ -65,6 +65,11 @@ class Radical
    * @param matY Estimated independent components - a matrix where each column
    *    is a point and each row is an estimated independent component.
    * @param matW Estimated unmixing matrix, where matY = matW * matX.
+   *
+   * Each sweep visits every pair of dimensions once, in rounds of disjoint
+   * pairs (a round-robin schedule), so that the pairs of a round are rotated in
+   * parallel.  When a round has fewer pairs than threads, the angles of each
+   * pair are searched in parallel instead.
    */
   void DoRadical(const arma::mat& matX, arma::mat& matY, arma::mat& matW);
 
@@ -73,6 +78,7 @@ class Radical
    * (Learned-Miller and Fisher, 2003).
    *
    * @param x Empirical sample (one-dimensional) over which to estimate entropy.
+   *     It is sorted in place.
    */
   double Vasicek(arma::vec& x) const;
 
@@ -127,10 +133,28 @@ class Radical
   //! Value of m to use for Vasicek's m-spacing estimator of entropy.
   size_t m;
 
-  //! Internal matrix, held as member variable to prevent memory reallocations.
-  arma::mat perturbed;
-  //! Internal matrix, held as member variable to prevent memory reallocations.
-  arma::mat candidate;
+  //! Internal matrices (the perturbed replicates of the pairs of dimensions
+  //! being rotated), held as member variable to prevent memory reallocations.
+  std::vector<arma::mat> perturbed;
+
+  /**
+   * Search the grid of angles for the rotation of the given perturbed
+   * two-dimensional data which minimizes the sum of the Vasicek entropies of
+   * its dimensions.  The rotated and sorted data are held in buffers which are
+   * reused for all the angles (one pair of buffers per thread).
+   *
+   * @param perturbedX Perturbed replicates of the data (two columns).
+   * @param parallel Whether or not to split the angles between threads.
+   * @return The best angle.
+   */
+  double BestAngle(const arma::mat& perturbedX, const bool parallel) const;
+
+  //! Rotate columns i and j of the given matrix by the given angle (as the
+  //! Jacobi rotation of DoRadical2D()).
+  static void Rotate(arma::mat& matrix,
+                     const size_t i,
+                     const size_t j,
+                     const double theta);
 };
 
 void WhitenFeatureMajorMatrix(const arma::mat& matX,
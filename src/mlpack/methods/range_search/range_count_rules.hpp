@@ -0,0 +1,182 @@
+/**
+ * @file range_count_rules.hpp
+ * @author Ryan Curtin
+ *
+ * Rules for counting the points within a set of radii of every query point,
+ * so that it can be done with arbitrary tree types.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_RANGE_COUNT_RULES_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_RANGE_COUNT_RULES_HPP
+
+#include "../neighbor_search/ns_traversal_info.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * The rules for counting, for every query point, the reference points within
+ * each of a sorted set of radii, with arbitrary tree types.  This is what is
+ * needed for two-point correlation functions, or for density-based outlier
+ * scores, and it is much faster than enumerating the points with
+ * RangeSearchRules: nothing is stored for the individual points, and a pair of
+ * nodes is pruned as soon as all of its point pairs are known to fall between
+ * the same two consecutive radii.  The whole reference node is then credited
+ * to every query point at once.  This also means that all of the radii are
+ * handled in a single traversal.
+ *
+ * During the traversal, entry (j, i) of the counts holds the number of
+ * reference points whose distance to query point i is in (radii[j - 1],
+ * radii[j]]; Finalize() turns these into cumulative counts, so that entry
+ * (j, i) is the number of reference points within radii[j] of query point i.
+ */
+template<typename MetricType, typename TreeType>
+class RangeCountRules
+{
+ public:
+  /**
+   * Construct the RangeCountRules object.  This is usually done from within
+   * the RangeSearch class at search time.  The counts are set to zero.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param radii Radii to count the points within, sorted in increasing order
+   *      and non-negative.
+   * @param counts Matrix to store the counts in (one row for every radius and
+   *      one column for every query point).
+   * @param metric Instantiated metric.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same; this only matters to Finalize(), which then removes the query
+   *      point from its own range.
+   */
+  RangeCountRules(const typename TreeType::Mat& referenceSet,
+                  const typename TreeType::Mat& querySet,
+                  const arma::vec& radii,
+                  arma::Mat<size_t>& counts,
+                  MetricType& metric,
+                  const bool sameSet = false);
+
+  /**
+   * Compute the base case between the given query point and reference point.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceIndex Index of reference point.
+   */
+  double BaseCase(const size_t queryIndex, const size_t referenceIndex);
+
+  /**
+   * Get the score for recursion order.  DBL_MAX indicates that the node should
+   * not be recursed into, because all of its points fall between the same two
+   * radii (and have been counted).
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   */
+  double Score(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.  Nothing changes the pruning
+   * bounds, so this returns the old score.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceNode Candidate node to be recursed into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  /**
+   * Get the score for recursion order.  DBL_MAX indicates that the node
+   * combination should not be recursed into, because all of its point pairs
+   * fall between the same two radii (and have been counted).
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   */
+  double Score(TreeType& queryNode, TreeType& referenceNode);
+
+  /**
+   * Re-evaluate the score for recursion order.  Nothing changes the pruning
+   * bounds, so this returns the old score.
+   *
+   * @param queryNode Candidate query node to recurse into.
+   * @param referenceNode Candidate reference node to recurse into.
+   * @param oldScore Old score produced by Score() (or Rescore()).
+   */
+  double Rescore(TreeType& queryNode,
+                 TreeType& referenceNode,
+                 const double oldScore) const;
+
+  /**
+   * Turn the counts of the points between consecutive radii into the counts
+   * of the points within each radius, and remove the query points themselves
+   * if the sets are the same.  This must be called once on the counts after
+   * the traversal.
+   *
+   * @param counts Counts filled by the traversal.
+   * @param sameSet Whether the query and reference set are the same.
+   */
+  static void Finalize(arma::Mat<size_t>& counts, const bool sameSet);
+
+  //! Get the number of base cases that have been performed.
+  size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases that have been performed.
+  size_t& BaseCases() { return baseCases; }
+
+  //! Get the number of scores that have been performed.
+  size_t Scores() const { return scores; }
+  //! Modify the number of scores that have been performed.
+  size_t& Scores() { return scores; }
+
+  typedef neighbor::NeighborSearchTraversalInfo<TreeType> TraversalInfoType;
+
+  const TraversalInfoType& TraversalInfo() const { return traversalInfo; }
+  TraversalInfoType& TraversalInfo() { return traversalInfo; }
+
+ private:
+  //! The reference set.
+  const typename TreeType::Mat& referenceSet;
+
+  //! The query set.
+  const typename TreeType::Mat& querySet;
+
+  //! The radii to count the points within.
+  const arma::vec& radii;
+
+  //! The counts of every radius and query point.
+  arma::Mat<size_t>& counts;
+
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The last query index.
+  size_t lastQueryIndex;
+  //! The last reference index.
+  size_t lastReferenceIndex;
+
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of scores.
+  size_t scores;
+
+  //! Return the index of the smallest radius that is not less than the given
+  //! distance (radii.n_elem if there is none).
+  size_t Bin(const double distance) const;
+
+  //! Add all the points in the given node to the given bin of the given query
+  //! point.  If the base case has already been calculated, we make sure to not
+  //! count that point twice.
+  void AddCount(const size_t queryIndex,
+                const size_t bin,
+                TreeType& referenceNode);
+
+  TraversalInfoType traversalInfo;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+// Include implementation.
+#include "range_count_rules_impl.hpp"
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file range_count_rules_impl.hpp
+ * @author Ryan Curtin
+ *
+ * Implementation of the rules for counting the points within a set of radii
+ * with generic trees.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_RANGE_COUNT_RULES_IMPL_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_RANGE_COUNT_RULES_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "range_count_rules.hpp"
+
+namespace mlpack {
+namespace range {
+
+template<typename MetricType, typename TreeType>
+RangeCountRules<MetricType, TreeType>::RangeCountRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    const arma::vec& radii,
+    arma::Mat<size_t>& counts,
+    MetricType& metric,
+    const bool /* sameSet */) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    radii(radii),
+    counts(counts),
+    metric(metric),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  if (radii.n_elem == 0)
+    Log::Fatal << "RangeCountRules: at least one radius must be given."
+        << std::endl;
+  if (radii[0] < 0.0)
+    Log::Fatal << "RangeCountRules: radii must be non-negative." << std::endl;
+  for (size_t i = 1; i < radii.n_elem; ++i)
+    if (radii[i] < radii[i - 1])
+      Log::Fatal << "RangeCountRules: radii must be sorted in increasing order."
+          << std::endl;
+
+  counts.zeros(radii.n_elem, querySet.n_cols);
+}
+
+//! The base case.  Evaluate the distance between the two points and count the
+//! reference point in its bin.
+template<typename MetricType, typename TreeType>
+inline force_inline
+double RangeCountRules<MetricType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceIndex)
+{
+  // If we have just performed this base case, don't do it again.
+  if ((lastQueryIndex == queryIndex) && (lastReferenceIndex == referenceIndex))
+    return 0.0; // No value to return... this shouldn't do anything bad.
+
+  // A point is counted in its own range here, so that whole nodes can be
+  // credited without checking whether they hold the query point; Finalize()
+  // removes it again.
+  const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
+      referenceSet.unsafe_col(referenceIndex));
+  ++baseCases;
+
+  // Update last indices, so we don't accidentally perform a base case twice.
+  lastQueryIndex = queryIndex;
+  lastReferenceIndex = referenceIndex;
+
+  const size_t bin = Bin(distance);
+  if (bin < radii.n_elem)
+    ++counts(bin, queryIndex);
+
+  return distance;
+}
+
+//! Single-tree scoring function.
+template<typename MetricType, typename TreeType>
+double RangeCountRules<MetricType, TreeType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  ++scores;
+
+  // We must get the minimum and maximum distances and store them in this
+  // object.
+  math::Range distances;
+
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+  {
+    // In this situation, we calculate the base case.  So we should check to be
+    // sure we haven't already done that.
+    double baseCase;
+    if (tree::TreeTraits<TreeType>::HasSelfChildren &&
+        (referenceNode.Parent() != NULL) &&
+        (referenceNode.Point(0) == referenceNode.Parent()->Point(0)))
+    {
+      // If the tree has self-children and this is a self-child, the base case
+      // was already calculated.
+      baseCase = referenceNode.Parent()->Stat().LastDistance();
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceNode.Point(0);
+    }
+    else
+    {
+      // We must calculate the base case by hand.
+      baseCase = BaseCase(queryIndex, referenceNode.Point(0));
+    }
+
+    // This may be possibly loose for non-ball bound trees.
+    distances.Lo() = baseCase - referenceNode.FurthestDescendantDistance();
+    distances.Hi() = baseCase + referenceNode.FurthestDescendantDistance();
+
+    // Update last distance calculation.
+    referenceNode.Stat().LastDistance() = baseCase;
+  }
+  else
+  {
+    distances = referenceNode.RangeDistance(querySet.unsafe_col(queryIndex));
+  }
+
+  // If the node is further than the largest radius, prune it.
+  const size_t bin = Bin(distances.Lo());
+  if (bin == radii.n_elem)
+    return DBL_MAX;
+
+  // If all of the points of the node fall in the same bin, count them all.
+  if (Bin(distances.Hi()) == bin)
+  {
+    AddCount(queryIndex, bin, referenceNode);
+    return DBL_MAX; // We don't need to go any deeper.
+  }
+
+  // Otherwise the score doesn't matter.  Recursion order is irrelevant.
+  return 0.0;
+}
+
+//! Single-tree rescoring function.
+template<typename MetricType, typename TreeType>
+double RangeCountRules<MetricType, TreeType>::Rescore(
+    const size_t /* queryIndex */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  // If it wasn't pruned before, it isn't pruned now.
+  return oldScore;
+}
+
+//! Dual-tree scoring function.
+template<typename MetricType, typename TreeType>
+double RangeCountRules<MetricType, TreeType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
+{
+  ++scores;
+
+  math::Range distances;
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+  {
+    // It is possible that the base case has already been calculated.
+    double baseCase = 0.0;
+    if ((traversalInfo.LastQueryNode() != NULL) &&
+        (traversalInfo.LastReferenceNode() != NULL) &&
+        (traversalInfo.LastQueryNode()->Point(0) == queryNode.Point(0)) &&
+        (traversalInfo.LastReferenceNode()->Point(0) == referenceNode.Point(0)))
+    {
+      baseCase = traversalInfo.LastBaseCase();
+
+      // Make sure that if BaseCase() is called, we don't count it twice.
+      lastQueryIndex = queryNode.Point(0);
+      lastReferenceIndex = referenceNode.Point(0);
+    }
+    else
+    {
+      // We must calculate the base case.
+      baseCase = BaseCase(queryNode.Point(0), referenceNode.Point(0));
+    }
+
+    distances.Lo() = baseCase - queryNode.FurthestDescendantDistance()
+        - referenceNode.FurthestDescendantDistance();
+    distances.Hi() = baseCase + queryNode.FurthestDescendantDistance()
+        + referenceNode.FurthestDescendantDistance();
+
+    // Update the last distances performed for the query and reference node.
+    traversalInfo.LastBaseCase() = baseCase;
+  }
+  else
+  {
+    // Just perform the calculation.
+    distances = referenceNode.RangeDistance(&queryNode);
+  }
+
+  // If the nodes are further apart than the largest radius, prune them.
+  const size_t bin = Bin(distances.Lo());
+  if (bin == radii.n_elem)
+    return DBL_MAX;
+
+  // If all of the point pairs fall in the same bin, the whole reference node is
+  // counted for every point in the query node.
+  if (Bin(distances.Hi()) == bin)
+  {
+    for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
+      AddCount(queryNode.Descendant(i), bin, referenceNode);
+    return DBL_MAX; // We don't need to go any deeper.
+  }
+
+  // Otherwise the score doesn't matter.  Recursion order is irrelevant.
+  traversalInfo.LastQueryNode() = &queryNode;
+  traversalInfo.LastReferenceNode() = &referenceNode;
+  return 0.0;
+}
+
+//! Dual-tree rescoring function.
+template<typename MetricType, typename TreeType>
+double RangeCountRules<MetricType, TreeType>::Rescore(
+    TreeType& /* queryNode */,
+    TreeType& /* referenceNode */,
+    const double oldScore) const
+{
+  // If it wasn't pruned before, it isn't pruned now.
+  return oldScore;
+}
+
+template<typename MetricType, typename TreeType>
+void RangeCountRules<MetricType, TreeType>::Finalize(arma::Mat<size_t>& counts,
+                                                     const bool sameSet)
+{
+  // The distance of a point to itself is in the first bin.
+  if (sameSet)
+    counts.row(0) -= 1;
+
+  for (size_t j = 1; j < counts.n_rows; ++j)
+    counts.row(j) += counts.row(j - 1);
+}
+
+template<typename MetricType, typename TreeType>
+inline size_t RangeCountRules<MetricType, TreeType>::Bin(
+    const double distance) const
+{
+  return std::lower_bound(radii.begin(), radii.end(), distance) -
+      radii.begin();
+}
+
+//! Add all the points in the given node to the given bin of the given query
+//! point.
+template<typename MetricType, typename TreeType>
+void RangeCountRules<MetricType, TreeType>::AddCount(
+    const size_t queryIndex,
+    const size_t bin,
+    TreeType& referenceNode)
+{
+  // Some types of trees calculate the base case evaluation before Score() is
+  // called, so if the base case has already been calculated, then we must avoid
+  // counting that point again.
+  size_t baseCaseMod = 0;
+  if (tree::TreeTraits<TreeType>::FirstPointIsCentroid &&
+      (queryIndex == lastQueryIndex) &&
+      (referenceNode.Point(0) == lastReferenceIndex))
+  {
+    baseCaseMod = 1;
+  }
+
+  counts(bin, queryIndex) += referenceNode.NumDescendants() - baseCaseMod;
+}
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
@@ -21,6 +21,16 @@ namespace range /** Range-search routines. */ {
  * is implemented in the style of a generalized tree-independent dual-tree
  * algorithm; for more details on the actual algorithm, see the RangeSearchRules
  * class.
+ *
+ * If Parallel() is set to true (and mlpack was compiled with OpenMP), the
+ * searches and counts are done by several threads: in single-tree mode the
+ * query points are divided between the threads, and in dual-tree mode the
+ * query tree is divided into many disjoint subtrees, which the threads take
+ * one at a time.  Every thread uses its own copy of the rules.  The results
+ * are the same, except that the order of the results of a query point may
+ * differ.  Single-tree search with trees whose first point is the centroid
+ * (such as the cover tree), and dual-tree search with trees whose internal
+ * nodes hold points, are not parallelized.
  */
 template<typename MetricType = mlpack::metric::EuclideanDistance,
          typename TreeType = tree::BinarySpaceTree<bound::HRectBound<2>,
@@ -190,9 +200,131 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, returning the results in a compressed (CSR) layout.  The
+   * results of all query points are stored consecutively without any
+   * allocation per query point, which is much cheaper than the std::vector
+   * output when the ranges contain many points.
+   *
+   * That is:
+   *
+   * - offsets has querySet.n_cols + 1 elements, and offsets[i] is the index of
+   *   the first result of query point i (offsets[querySet.n_cols] is the total
+   *   number of results).
+   *
+   * - neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1] are the indices of
+   *   all the points in the reference set which have distances inside the given
+   *   range to query point i.
+   *
+   * - distances holds the distances corresponding to the indices in neighbors.
+   *
+   * - The results of a query point are not sorted in any particular order.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param offsets Vector to store the offset of the results of every query
+   *      point in.
+   * @param neighbors Vector to store the neighbors of all query points in.
+   * @param distances Vector to store the distances of all query points in.
+   */
+  void Search(const typename TreeType::Mat& querySet,
+              const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set (which was passed to the constructor), returning the results in a
+   * compressed (CSR) layout; see the overload above.  A point is not returned
+   * in its own results.
+   *
+   * @param range Range of distances in which to search.
+   * @param offsets Vector to store the offset of the results of every point in.
+   * @param neighbors Vector to store the neighbors of all points in.
+   * @param distances Vector to store the distances of all points in.
+   */
+  void Search(const math::Range& range,
+              arma::Col<size_t>& offsets,
+              arma::Col<size_t>& neighbors,
+              arma::vec& distances);
+
+  /**
+   * Count the reference points in the given range for each point in the query
+   * set, without storing the points.  Reference nodes that lie entirely inside
+   * the range are counted without computing any distance.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param counts Vector to store the number of points in the range of every
+   *      query point in.
+   */
+  void Count(const typename TreeType::Mat& querySet,
+             const math::Range& range,
+             arma::Col<size_t>& counts);
+
+  /**
+   * Count the points in the given range for each point in the reference set
+   * (which was passed to the constructor).  A point is not counted in its own
+   * range.
+   *
+   * @param range Range of distances in which to search.
+   * @param counts Vector to store the number of points in the range of every
+   *      point in.
+   */
+  void Count(const math::Range& range, arma::Col<size_t>& counts);
+
+  /**
+   * Count the reference points within each of the given radii of each point in
+   * the query set, in a single traversal.  Entry (j, i) of counts is the number
+   * of reference points within distance radii[j] (inclusive) of query point i.
+   * Node pairs whose point pairs all fall between the same two consecutive
+   * radii are counted as a whole, so this is much faster than counting each
+   * radius with the Count() overloads above (see RangeCountRules).
+   *
+   * @param querySet Set of query points to search with.
+   * @param radii Non-negative radii, sorted in increasing order.
+   * @param counts Matrix to store the number of points within every radius of
+   *      every query point in.
+   */
+  void Count(const typename TreeType::Mat& querySet,
+             const arma::vec& radii,
+             arma::Mat<size_t>& counts);
+
+  /**
+   * Count the points within each of the given radii of each point in the
+   * reference set (which was passed to the constructor), in a single
+   * traversal; see the overload above.  A point is not counted in its own
+   * range.
+   *
+   * @param radii Non-negative radii, sorted in increasing order.
+   * @param counts Matrix to store the number of points within every radius of
+   *      every point in.
+   */
+  void Count(const arma::vec& radii, arma::Mat<size_t>& counts);
+
+  /**
+   * Count the pairs of distinct points of the reference set that are within
+   * each of the given radii of each other, which is the quantity needed to
+   * estimate the two-point correlation function.
+   *
+   * @param radii Non-negative radii, sorted in increasing order.
+   * @param pairs Vector to store the number of pairs within every radius in.
+   */
+  void PairCounts(const arma::vec& radii, arma::Col<size_t>& pairs);
+
   // Returns a string representation of this object.
   std::string ToString() const;
 
+  //! Get whether or not the search is done by several threads.
+  bool Parallel() const { return parallel; }
+  //! Modify whether or not the search is done by several threads.
+  bool& Parallel() { return parallel; }
+
+  //! Access the reference dataset (possibly rearranged by tree building).
+  const typename TreeType::Mat& ReferenceSet() const { return referenceSet; }
+
  private:
   //! Copy of reference matrix; used when a tree is built internally.
   typename TreeType::Mat referenceCopy;
@@ -210,9 +342,41 @@ class RangeSearch
   bool naive;
   //! If true, single-tree computation is used.
   bool singleMode;
+  //! If true, the search is done by several threads.
+  bool parallel;
 
   //! Instantiated distance metric.
   MetricType metric;
+
+  /**
+   * Perform the search with the given rules (RangeSearchRules with a result
+   * policy, or RangeCountRules), either for the given query set or, if
+   * querySet is NULL, for the reference set itself.  The range and the results
+   * are handed to the constructor of the rules.  The results are stored with
+   * the indices of the trees; if a query tree that rearranges the points is
+   * built, its mapping is stored in oldFromNewQueries.
+   */
+  template<typename RuleType, typename RangeType, typename ResultType>
+  void SearchResults(const typename TreeType::Mat* querySet,
+                     const RangeType& range,
+                     ResultType& results,
+                     std::vector<size_t>& oldFromNewQueries);
+
+  /**
+   * Traverse the reference tree with each of the given number of query points,
+   * with the given rules.  If parallel search is enabled, the query points are
+   * divided between the threads.
+   */
+  template<typename RuleType>
+  void SingleTreeSearch(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Traverse the given query tree with the reference tree, with the given
+   * rules.  If parallel search is enabled, disjoint subtrees of the query tree
+   * are traversed by different threads.
+   */
+  template<typename RuleType>
+  void DualTreeSearch(RuleType& rules, TreeType& queryTree);
 };
 
 }; // namespace range
@@ -12,6 +12,9 @@
 
 // The rules for traversal.
 #include "range_search_rules.hpp"
+#include "range_count_rules.hpp"
+
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace range {
@@ -51,6 +54,7 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     treeOwner(!naive), // If in naive mode, we are not building any trees.
     naive(naive),
     singleMode(!naive && singleMode), // Naive overrides single mode.
+    parallel(false),
     metric(metric)
 {
   // Build the tree.
@@ -69,6 +73,11 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     referenceTree = BuildTree<TreeType>(
         const_cast<typename TreeType::Mat&>(referenceSet),
         oldFromNewReferences);
+
+    // The copy belongs to this object, so it can be spread over the NUMA
+    // nodes (if requested) now that the tree has rearranged it.
+    if (tree::TreeTraits<TreeType>::RearrangesDataset)
+      Numa::Distribute(referenceCopy);
   }
 
   Timer::Stop("range_search/tree_building");
@@ -84,6 +93,7 @@ RangeSearch<MetricType, TreeType>::RangeSearch(
     treeOwner(false),
     naive(false),
     singleMode(singleMode),
+    parallel(false),
     metric(metric)
 {
   // Nothing else to initialize.
@@ -148,8 +158,8 @@ void RangeSearch<MetricType, TreeType>::Search(
 
   // Create the helper object for the traversal.
   typedef RangeSearchRules<MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, querySetRef, range, *neighborPtr, *distancePtr,
-      metric);
+  ListResults results(*neighborPtr, *distancePtr);
+  RuleType rules(referenceSet, querySetRef, range, results, metric);
 
   if (naive)
   {
@@ -160,12 +170,8 @@ void RangeSearch<MetricType, TreeType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Traverse the reference tree for each point.
+    SingleTreeSearch(rules, querySet.n_cols);
   }
   else // Dual-tree recursion.
   {
@@ -177,10 +183,8 @@ void RangeSearch<MetricType, TreeType>::Search(
     Timer::Stop("range_search/tree_building");
     Timer::Start("range_search/computing_neighbors");
 
-    // Create the traverser.
-    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*queryTree, *referenceTree);
+    // Traverse the query tree with the reference tree.
+    DualTreeSearch(rules, *queryTree);
 
     // Clean up tree memory.
     delete queryTree;
@@ -286,13 +290,11 @@ void RangeSearch<MetricType, TreeType>::Search(
 
   // Create the helper object for the traversal.
   typedef RangeSearchRules<MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, queryTree->Dataset(), range, *neighborPtr,
-      distances, metric);
+  ListResults results(*neighborPtr, distances);
+  RuleType rules(referenceSet, queryTree->Dataset(), range, results, metric);
 
-  // Create the traverser.
-  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
-
-  traverser.Traverse(*queryTree, *referenceTree);
+  // Traverse the query tree with the reference tree.
+  DualTreeSearch(rules, *queryTree);
 
   Timer::Stop("range_search/computing_neighbors");
 
@@ -342,8 +344,9 @@ void RangeSearch<MetricType, TreeType>::Search(
 
   // Create the helper object for the traversal.
   typedef RangeSearchRules<MetricType, TreeType> RuleType;
-  RuleType rules(referenceSet, referenceSet, range, *neighborPtr, *distancePtr,
-      metric, true /* don't return the query point in the results */);
+  ListResults results(*neighborPtr, *distancePtr);
+  RuleType rules(referenceSet, referenceSet, range, results, metric,
+      true /* don't return the query point in the results */);
 
   if (naive)
   {
@@ -354,19 +357,13 @@ void RangeSearch<MetricType, TreeType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Traverse the reference tree for each point.
+    SingleTreeSearch(rules, referenceSet.n_cols);
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
-    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
+    // Traverse the reference tree with itself.
+    DualTreeSearch(rules, *referenceTree);
   }
 
   Timer::Stop("range_search/computing_neighbors");
@@ -399,6 +396,339 @@ void RangeSearch<MetricType, TreeType>::Search(
   }
 }
 
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Search(
+    const typename TreeType::Mat& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  typedef RangeSearchRules<MetricType, TreeType, FlatResults> RuleType;
+
+  FlatResults results;
+  std::vector<size_t> oldFromNewQueries;
+  SearchResults<RuleType>(&querySet, range, results, oldFromNewQueries);
+
+  // The query indices have to be mapped if we built a query tree that
+  // rearranges the points, and the reference indices if we built the reference
+  // tree.
+  const bool mapReferences = treeOwner &&
+      tree::TreeTraits<TreeType>::RearrangesDataset;
+  results.Finalize(querySet.n_cols,
+      oldFromNewQueries.empty() ? NULL : &oldFromNewQueries,
+      mapReferences ? &oldFromNewReferences : NULL, offsets, neighbors,
+      distances);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Search(
+    const math::Range& range,
+    arma::Col<size_t>& offsets,
+    arma::Col<size_t>& neighbors,
+    arma::vec& distances)
+{
+  typedef RangeSearchRules<MetricType, TreeType, FlatResults> RuleType;
+
+  FlatResults results;
+  std::vector<size_t> oldFromNewQueries; // Unused.
+  SearchResults<RuleType>(NULL, range, results, oldFromNewQueries);
+
+  const std::vector<size_t>* mapping = (treeOwner &&
+      tree::TreeTraits<TreeType>::RearrangesDataset) ? &oldFromNewReferences :
+      NULL;
+  results.Finalize(referenceSet.n_cols, mapping, mapping, offsets, neighbors,
+      distances);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Count(
+    const typename TreeType::Mat& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  typedef RangeSearchRules<MetricType, TreeType, CountResults> RuleType;
+
+  arma::Col<size_t> treeCounts;
+  CountResults results(treeCounts, querySet.n_cols);
+  std::vector<size_t> oldFromNewQueries;
+  SearchResults<RuleType>(&querySet, range, results, oldFromNewQueries);
+
+  // Only the query indices have to be mapped.
+  if (oldFromNewQueries.empty())
+  {
+    counts = treeCounts;
+    return;
+  }
+
+  counts.set_size(querySet.n_cols);
+  for (size_t i = 0; i < treeCounts.n_elem; ++i)
+    counts[oldFromNewQueries[i]] = treeCounts[i];
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Count(const math::Range& range,
+                                              arma::Col<size_t>& counts)
+{
+  typedef RangeSearchRules<MetricType, TreeType, CountResults> RuleType;
+
+  arma::Col<size_t> treeCounts;
+  CountResults results(treeCounts, referenceSet.n_cols);
+  std::vector<size_t> oldFromNewQueries; // Unused.
+  SearchResults<RuleType>(NULL, range, results, oldFromNewQueries);
+
+  if (!treeOwner || !tree::TreeTraits<TreeType>::RearrangesDataset)
+  {
+    counts = treeCounts;
+    return;
+  }
+
+  counts.set_size(referenceSet.n_cols);
+  for (size_t i = 0; i < treeCounts.n_elem; ++i)
+    counts[oldFromNewReferences[i]] = treeCounts[i];
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Count(
+    const typename TreeType::Mat& querySet,
+    const arma::vec& radii,
+    arma::Mat<size_t>& counts)
+{
+  typedef RangeCountRules<MetricType, TreeType> RuleType;
+
+  arma::Mat<size_t> treeCounts;
+  std::vector<size_t> oldFromNewQueries;
+  SearchResults<RuleType>(&querySet, radii, treeCounts, oldFromNewQueries);
+  RuleType::Finalize(treeCounts, false);
+
+  // Only the query indices have to be mapped.
+  if (oldFromNewQueries.empty())
+  {
+    counts = std::move(treeCounts);
+    return;
+  }
+
+  counts.set_size(treeCounts.n_rows, treeCounts.n_cols);
+  for (size_t i = 0; i < treeCounts.n_cols; ++i)
+    counts.col(oldFromNewQueries[i]) = treeCounts.col(i);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::Count(const arma::vec& radii,
+                                              arma::Mat<size_t>& counts)
+{
+  typedef RangeCountRules<MetricType, TreeType> RuleType;
+
+  arma::Mat<size_t> treeCounts;
+  std::vector<size_t> oldFromNewQueries; // Unused.
+  SearchResults<RuleType>(NULL, radii, treeCounts, oldFromNewQueries);
+  RuleType::Finalize(treeCounts, true);
+
+  if (!treeOwner || !tree::TreeTraits<TreeType>::RearrangesDataset)
+  {
+    counts = std::move(treeCounts);
+    return;
+  }
+
+  counts.set_size(treeCounts.n_rows, treeCounts.n_cols);
+  for (size_t i = 0; i < treeCounts.n_cols; ++i)
+    counts.col(oldFromNewReferences[i]) = treeCounts.col(i);
+}
+
+template<typename MetricType, typename TreeType>
+void RangeSearch<MetricType, TreeType>::PairCounts(const arma::vec& radii,
+                                                   arma::Col<size_t>& pairs)
+{
+  arma::Mat<size_t> counts;
+  Count(radii, counts);
+
+  // Every pair was counted once for each of its two points.
+  pairs = arma::sum(counts, 1) / 2;
+}
+
+template<typename MetricType, typename TreeType>
+template<typename RuleType, typename RangeType, typename ResultType>
+void RangeSearch<MetricType, TreeType>::SearchResults(
+    const typename TreeType::Mat* querySet,
+    const RangeType& range,
+    ResultType& results,
+    std::vector<size_t>& oldFromNewQueries)
+{
+  Timer::Start("range_search/computing_neighbors");
+
+  // If no query set is given, the reference set is searched with itself.
+  const bool sameSet = (querySet == NULL);
+  const typename TreeType::Mat& queries = sameSet ? referenceSet : *querySet;
+
+  // If we will be building a tree and it will modify the query set, make a copy
+  // of the dataset.
+  typename TreeType::Mat queryCopy;
+  const bool needsCopy = (!sameSet && !naive && !singleMode &&
+      tree::TreeTraits<TreeType>::RearrangesDataset);
+  if (needsCopy)
+    queryCopy = queries;
+
+  const typename TreeType::Mat& querySetRef = (needsCopy) ? queryCopy :
+      queries;
+
+  // Create the helper object for the traversal.
+  RuleType rules(referenceSet, querySetRef, range, results, metric, sameSet);
+
+  if (naive)
+  {
+    // The naive brute-force solution.
+    for (size_t i = 0; i < queries.n_cols; ++i)
+      for (size_t j = 0; j < referenceSet.n_cols; ++j)
+        rules.BaseCase(i, j);
+  }
+  else if (singleMode)
+  {
+    // Traverse the reference tree for each point.
+    SingleTreeSearch(rules, queries.n_cols);
+  }
+  else if (sameSet)
+  {
+    // Dual-tree recursion of the reference tree with itself.
+    DualTreeSearch(rules, *referenceTree);
+  }
+  else // Dual-tree recursion.
+  {
+    // Build the query tree.
+    Timer::Stop("range_search/computing_neighbors");
+    Timer::Start("range_search/tree_building");
+    TreeType* queryTree = BuildTree<TreeType>(
+        const_cast<typename TreeType::Mat&>(querySetRef), oldFromNewQueries);
+    Timer::Stop("range_search/tree_building");
+    Timer::Start("range_search/computing_neighbors");
+
+    // Traverse the query tree with the reference tree.
+    DualTreeSearch(rules, *queryTree);
+
+    // Clean up tree memory.
+    delete queryTree;
+  }
+
+  Timer::Stop("range_search/computing_neighbors");
+}
+
+template<typename MetricType, typename TreeType>
+template<typename RuleType>
+void RangeSearch<MetricType, TreeType>::SingleTreeSearch(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  // Trees whose first point is the centroid keep the last distance computed in
+  // the statistics of the reference nodes during single-tree traversals, so
+  // concurrent traversals of the reference tree would race on them.
+  if (!parallel || tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+  {
+    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+    tree::RecordTraversal("range_search", traverser, rules);
+    return;
+  }
+
+  // With the NUMA-aware placement, the threads are pinned to their nodes and
+  // take the queries stored on their node first.
+  const bool numa = Numa::Enabled();
+  if (numa)
+    Numa::PinThreads();
+  NumaScheduler scheduler(numQueries, 64);
+
+  #pragma omp parallel
+  {
+    // Each thread gets its own rules and traverser.  The result policies store
+    // the results of different query points independently (FlatResults keeps
+    // a buffer for each thread), so the threads never write to the same
+    // results.
+    RuleType threadRules(rules);
+    typename TreeType::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    if (numa)
+    {
+      size_t begin, end;
+      while (scheduler.Next(begin, end))
+        for (size_t i = begin; i < end; ++i)
+          traverser.Traverse(i, *referenceTree);
+    }
+    else
+    {
+      #pragma omp for schedule(dynamic, 64)
+      for (size_t i = 0; i < numQueries; ++i)
+        traverser.Traverse(i, *referenceTree);
+    }
+    tree::RecordTraversal("range_search", traverser, threadRules);
+  }
+}
+
+template<typename MetricType, typename TreeType>
+template<typename RuleType>
+void RangeSearch<MetricType, TreeType>::DualTreeSearch(RuleType& rules,
+                                                       TreeType& queryTree)
+{
+  // For parallel search, the query tree is split into disjoint subtrees, each
+  // of which is traversed with the whole reference tree by whichever thread is
+  // free.  This is only possible if the points are only held by the leaves;
+  // otherwise the query tree is traversed as a whole.
+  std::vector<TreeType*> subtrees(1, &queryTree);
+  if (parallel && !tree::TreeTraits<TreeType>::HasSelfChildren &&
+      !tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+  {
+    // Many more subtrees than threads are made, so that the threads stay busy
+    // even if some subtrees are much more expensive than others.
+    const size_t minSize = std::max((size_t) 1,
+        queryTree.NumDescendants() / 256);
+
+    bool split = true;
+    while (split)
+    {
+      split = false;
+      std::vector<TreeType*> children;
+      for (size_t i = 0; i < subtrees.size(); ++i)
+      {
+        if (subtrees[i]->IsLeaf() || subtrees[i]->NumPoints() > 0 ||
+            subtrees[i]->NumDescendants() <= minSize)
+        {
+          children.push_back(subtrees[i]);
+          continue;
+        }
+
+        for (size_t j = 0; j < subtrees[i]->NumChildren(); ++j)
+          children.push_back(&subtrees[i]->Child(j));
+        split = true;
+      }
+
+      subtrees.swap(children);
+    }
+  }
+
+  if (subtrees.size() == 1)
+  {
+    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    tree::RecordTraversal("range_search", traverser, rules);
+    return;
+  }
+
+  #pragma omp parallel
+  {
+    // Each thread gets its own rules and traverser; see SingleTreeSearch().
+    RuleType threadRules(rules);
+    typename TreeType::template DualTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < subtrees.size(); ++i)
+    {
+      threadRules.TraversalInfo() = typename RuleType::TraversalInfoType();
+      traverser.Traverse(*subtrees[i], *referenceTree);
+    }
+    tree::RecordTraversal("range_search", traverser, threadRules);
+  }
+}
+
 template<typename MetricType, typename TreeType>
 std::string RangeSearch<MetricType, TreeType>::ToString() const
 {
@@ -408,6 +738,8 @@ std::string RangeSearch<MetricType, TreeType>::ToString() const
     convert << "  Tree Owner: TRUE" << std::endl;
   if (naive)
     convert << "  Naive: TRUE" << std::endl;
+  if (parallel)
+    convert << "  Parallel: TRUE" << std::endl;
   convert << "  Metric: " << std::endl <<
       mlpack::util::Indent(metric.ToString(),2);
   return convert.str();
@@ -9,9 +9,14 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/tree_io.hpp>
 
 #include "range_search.hpp"
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::range;
@@ -62,8 +67,14 @@ PARAM_INT("leaf_size", "Leaf size for tree building.", "l", 20);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "s");
+PARAM_STRING("reference_tree_file", "If specified and the file exists, load "
+    "the reference tree (and the reference dataset) from this file instead of "
+    "building it; if the file does not exist, the reference tree is built and "
+    "saved to this file.", "f", "");
 PARAM_FLAG("cover_tree", "If true, use a cover tree for range searching "
     "(instead of a kd-tree).", "c");
+PARAM_INT("threads", "Number of threads to use for searching (0 uses all "
+    "available cores; ignored without OpenMP).", "t", 0);
 
 typedef RangeSearch<> RSType;
 typedef CoverTree<metric::EuclideanDistance, tree::FirstPointIsRoot,
@@ -94,6 +105,7 @@ int main(int argc, char *argv[])
   arma::mat queryData; // So it doesn't go out of scope.
   if (!data::Load(referenceFile, referenceData))
     Log::Fatal << "Reference file " << referenceFile << "not found." << endl;
+  Numa::Distribute(referenceData); // Only with --numa.
 
   Log::Info << "Loaded reference data from '" << referenceFile << "'." << endl;
 
@@ -113,6 +125,23 @@ int main(int argc, char *argv[])
   }
   const size_t leafSize = lsInt;
 
+  // Sanity check on the number of threads.
+  if (CLI::GetParam<int>("threads") < 0)
+  {
+    Log::Fatal << "Invalid number of threads: " << CLI::GetParam<int>("threads")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+#ifdef _OPENMP
+  if (CLI::GetParam<int>("threads") > 0)
+    omp_set_num_threads(CLI::GetParam<int>("threads"));
+  const bool parallel = (omp_get_max_threads() > 1);
+#else
+  if (CLI::GetParam<int>("threads") > 1)
+    Log::Warn << "--threads ignored because mlpack was compiled without OpenMP "
+        << "support." << endl;
+  const bool parallel = false;
+#endif
+
   // Naive mode overrides single mode.
   if (singleMode && naive)
   {
@@ -125,6 +154,16 @@ int main(int argc, char *argv[])
     coverTree = false;
   }
 
+  // Check if a saved reference tree should be used.
+  const string referenceTreeFile = CLI::GetParam<string>("reference_tree_file");
+  const bool loadTree = (referenceTreeFile != "") &&
+      ifstream(referenceTreeFile.c_str()).good();
+  if (referenceTreeFile != "" && (naive || coverTree))
+  {
+    Log::Warn << "--reference_tree_file ignored because it is only supported "
+        << "for kd-trees." << endl;
+  }
+
   vector<vector<size_t> > neighbors;
   vector<vector<double> > distances;
 
@@ -144,6 +183,7 @@ int main(int argc, char *argv[])
     // This is significantly simpler than kd-tree construction because the data
     // matrix is not modified.
     RSCoverType rangeSearch(referenceData, singleMode);
+    rangeSearch.Parallel() = parallel;
 
     if (CLI::GetParam<string>("query_file") == "")
     {
@@ -155,6 +195,7 @@ int main(int argc, char *argv[])
       // Two datasets.
       const string queryFile = CLI::GetParam<string>("query_file");
       data::Load(queryFile, queryData, true);
+      Numa::Distribute(queryData);
 
       // Query tree is automatically built if needed.
       rangeSearch.Search(queryData, r, neighbors, distances);
@@ -164,24 +205,53 @@ int main(int argc, char *argv[])
   {
     typedef BinarySpaceTree<bound::HRectBound<2>, RangeSearchStat> TreeType;
 
-    // Track mappings.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("tree_building");
+    // Track mappings.  If a saved tree is available, load it instead of
+    // building it.
     vector<size_t> oldFromNewRefs;
     vector<size_t> oldFromNewQueries; // Not used yet.
-    TreeType refTree(referenceData, oldFromNewRefs, leafSize);
-    Timer::Stop("tree_building");
+    TreeType* refTree;
+    if (loadTree)
+    {
+      Log::Info << "Loading reference tree from '" << referenceTreeFile
+          << "'..." << endl;
+      const size_t dimensionality = referenceData.n_rows;
+      const size_t points = referenceData.n_cols;
+      refTree = LoadTree<TreeType>(referenceTreeFile, referenceData,
+          oldFromNewRefs, true);
+      if (referenceData.n_rows != dimensionality || referenceData.n_cols != points)
+      {
+        Log::Fatal << "Reference tree in '" << referenceTreeFile << "' was "
+            << "not built on a dataset of the same size as '"
+            << referenceFile << "'!" << endl;
+      }
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("tree_building");
+      refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+      Timer::Stop("tree_building");
+
+      if (referenceTreeFile != "")
+      {
+        Log::Info << "Saving reference tree to '" << referenceTreeFile
+            << "'..." << endl;
+        SaveTree(referenceTreeFile, *refTree, oldFromNewRefs);
+      }
+    }
 
     // Collect the results in these vectors before remapping.
     vector<vector<double> > distancesOut;
     vector<vector<size_t> > neighborsOut;
 
-    RSType rangeSearch(&refTree, singleMode);
+    RSType rangeSearch(refTree, singleMode);
+    rangeSearch.Parallel() = parallel;
 
     if (CLI::GetParam<string>("query_file") != "")
     {
       const string queryFile = CLI::GetParam<string>("query_file");
       data::Load(queryFile, queryData, true);
+      Numa::Distribute(queryData);
 
       Log::Info << "Loaded query data from '" << queryFile << "'." << endl;
 
@@ -256,6 +326,8 @@ int main(int argc, char *argv[])
         }
       }
     }
+
+    delete refTree;
   }
 
   // Save output.  We have to do this by hand.
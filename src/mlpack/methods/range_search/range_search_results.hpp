@@ -0,0 +1,250 @@
+/**
+ * @file range_search_results.hpp
+ * @author Ryan Curtin
+ *
+ * Result policies for range search, which define how the points found by the
+ * RangeSearchRules are stored.
+ */
+#ifndef __MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RESULTS_HPP
+#define __MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RESULTS_HPP
+
+#include <mlpack/core.hpp>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace range {
+
+/**
+ * Store the results of a range search as one vector of neighbors and one
+ * vector of distances for every query point.  This is the format returned by
+ * the std::vector overloads of RangeSearch::Search().
+ *
+ * A result policy has to provide the following:
+ *
+ * - NeedsDistances: if false, the distances of the points of a reference node
+ *   that lies completely inside the range are not computed.
+ * - Reserve(queryIndex, count): called before at most count results of the
+ *   given query point are added.
+ * - Add(queryIndex, referenceIndex, distance): add a single result.
+ *
+ * For parallel search, several threads add results at the same time, but never
+ * for the same query point.
+ */
+class ListResults
+{
+ public:
+  //! The distances of all results are stored.
+  static const bool NeedsDistances = true;
+
+  /**
+   * Store the results in the given vectors, which have to have one entry for
+   * every query point.
+   *
+   * @param neighbors Vector to store resulting neighbors in.
+   * @param distances Vector to store resulting distances in.
+   */
+  ListResults(std::vector<std::vector<size_t> >& neighbors,
+              std::vector<std::vector<double> >& distances) :
+      neighbors(neighbors),
+      distances(distances)
+  { /* Nothing to do. */ }
+
+  //! Reserve space for count more results of the given query point.
+  void Reserve(const size_t queryIndex, const size_t count)
+  {
+    neighbors[queryIndex].reserve(neighbors[queryIndex].size() + count);
+    distances[queryIndex].reserve(distances[queryIndex].size() + count);
+  }
+
+  //! Add a result for the given query point.
+  void Add(const size_t queryIndex,
+           const size_t referenceIndex,
+           const double distance)
+  {
+    neighbors[queryIndex].push_back(referenceIndex);
+    distances[queryIndex].push_back(distance);
+  }
+
+ private:
+  //! The vector the resultant neighbor indices should be stored in.
+  std::vector<std::vector<size_t> >& neighbors;
+  //! The vector the resultant neighbor distances should be stored in.
+  std::vector<std::vector<double> >& distances;
+};
+
+/**
+ * Store the results of a range search in a compressed (CSR) layout: the
+ * neighbors and distances of all query points are stored consecutively in one
+ * vector each, and the results of query point i are the elements
+ * [offsets[i], offsets[i + 1]) of these vectors.
+ *
+ * During the search, the results are appended to a single staging buffer as
+ * (query, reference, distance) triples in the order they are found, so there
+ * is no allocation per query point.  Every OpenMP thread has its own staging
+ * buffer, so that a parallel search needs no synchronization.  Finalize() then
+ * sorts the triples of all buffers by query point with a counting sort, which
+ * also applies the index mappings of trees that rearrange the datasets.
+ */
+class FlatResults
+{
+ public:
+  //! The distances of all results are stored.
+  static const bool NeedsDistances = true;
+
+  //! Create a staging buffer for each thread that a search may use.
+  FlatResults() :
+#ifdef _OPENMP
+      buffers(omp_get_max_threads())
+#else
+      buffers(1)
+#endif
+  { /* Nothing to do. */ }
+
+  //! Reserve space for count more results.
+  void Reserve(const size_t /* queryIndex */, const size_t count)
+  {
+    std::vector<Result>& results = Buffer();
+    if (results.size() + count > results.capacity())
+      results.reserve(std::max(2 * results.capacity(), results.size() + count));
+  }
+
+  //! Add a result for the given query point.
+  void Add(const size_t queryIndex,
+           const size_t referenceIndex,
+           const double distance)
+  {
+    Buffer().push_back(Result(queryIndex, referenceIndex, distance));
+  }
+
+  /**
+   * Sort the staged results into the CSR layout.  If a mapping is given, the
+   * indices are mapped to the original indices with it.
+   *
+   * @param numQueries Number of query points.
+   * @param queryMapping Mapping of the query indices (or NULL).
+   * @param referenceMapping Mapping of the reference indices (or NULL).
+   * @param offsets Vector of numQueries + 1 offsets of the results of every
+   *      query point.
+   * @param neighbors Vector to store the neighbors of all query points in.
+   * @param distances Vector to store the distances of all query points in.
+   */
+  void Finalize(const size_t numQueries,
+                const std::vector<size_t>* queryMapping,
+                const std::vector<size_t>* referenceMapping,
+                arma::Col<size_t>& offsets,
+                arma::Col<size_t>& neighbors,
+                arma::vec& distances) const
+  {
+    offsets.zeros(numQueries + 1);
+    for (size_t b = 0; b < buffers.size(); ++b)
+    {
+      const std::vector<Result>& results = buffers[b].results;
+      for (size_t i = 0; i < results.size(); ++i)
+        ++offsets[Map(queryMapping, results[i].query) + 1];
+    }
+    for (size_t i = 1; i < offsets.n_elem; ++i)
+      offsets[i] += offsets[i - 1];
+
+    neighbors.set_size(offsets[numQueries]);
+    distances.set_size(offsets[numQueries]);
+
+    std::vector<size_t> position(offsets.memptr(),
+        offsets.memptr() + numQueries);
+    for (size_t b = 0; b < buffers.size(); ++b)
+    {
+      const std::vector<Result>& results = buffers[b].results;
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+        const size_t k = position[Map(queryMapping, results[i].query)]++;
+        neighbors[k] = Map(referenceMapping, results[i].reference);
+        distances[k] = results[i].distance;
+      }
+    }
+  }
+
+ private:
+  //! A single staged result.
+  struct Result
+  {
+    Result(const size_t query, const size_t reference, const double distance) :
+        query(query), reference(reference), distance(distance) { }
+
+    size_t query;
+    size_t reference;
+    double distance;
+  };
+
+  //! Map the given index, if a mapping is given.
+  static size_t Map(const std::vector<size_t>* mapping, const size_t index)
+  {
+    return (mapping == NULL) ? index : (*mapping)[index];
+  }
+
+  //! The staging buffer of a thread, padded so that the buffers of different
+  //! threads are not on the same cache line.
+  struct ThreadBuffer
+  {
+    std::vector<Result> results;
+    char padding[64];
+  };
+
+  //! Get the staging buffer of the calling thread.
+  std::vector<Result>& Buffer()
+  {
+#ifdef _OPENMP
+    return buffers[omp_get_thread_num()].results;
+#else
+    return buffers[0].results;
+#endif
+  }
+
+  //! The staged results of every thread, in the order they were found.
+  std::vector<ThreadBuffer> buffers;
+};
+
+/**
+ * Count the results of a range search for every query point without storing
+ * them.  Reference nodes that lie completely inside the range are counted
+ * without computing any distance.
+ */
+class CountResults
+{
+ public:
+  //! The distances aren't needed to count the results.
+  static const bool NeedsDistances = false;
+
+  /**
+   * Count the results into the given vector, which is set to zero.
+   *
+   * @param counts Vector to store the number of results of every query point.
+   * @param numQueries Number of query points.
+   */
+  CountResults(arma::Col<size_t>& counts, const size_t numQueries) :
+      counts(counts)
+  {
+    counts.zeros(numQueries);
+  }
+
+  //! Nothing to reserve.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Count a result of the given query point.
+  void Add(const size_t queryIndex,
+           const size_t /* referenceIndex */,
+           const double /* distance */)
+  {
+    ++counts[queryIndex];
+  }
+
+ private:
+  //! The number of results of every query point.
+  arma::Col<size_t>& counts;
+};
+
+}; // namespace range
+}; // namespace mlpack
+
+#endif
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <iostream>
 
+#include <mlpack/core/tree/tree_io.hpp>
 #include "ra_search.hpp"
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 
@@ -69,6 +70,11 @@ PARAM_FLAG("naive", "If true, sampling will be done without using a tree.",
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
            "dual-tree search.", "s");
 
+PARAM_STRING("reference_tree_file", "If specified and the file exists, load "
+    "the reference tree (and the reference dataset) from this file instead of "
+    "building it; if the file does not exist, the reference tree is built and "
+    "saved to this file.", "f", "");
+
 PARAM_FLAG("sample_at_leaves", "The flag to trigger sampling at leaves.", "L");
 PARAM_FLAG("first_leaf_exact", "The flag to trigger sampling only after "
            "exactly exploring the first leaf.", "X");
@@ -143,6 +149,14 @@ int main(int argc, char *argv[])
   if (singleMode && naive)
     Log::Warn << "--single_mode ignored because --naive is present." << endl;
 
+  // Check if a saved reference tree should be used.
+  const string referenceTreeFile = CLI::GetParam<string>("reference_tree_file");
+  const bool loadTree = (referenceTreeFile != "") &&
+      ifstream(referenceTreeFile.c_str()).good();
+  if (referenceTreeFile != "" && naive)
+    Log::Warn << "--reference_tree_file ignored because --naive is present."
+        << endl;
+
   // The actual output after the remapping.
   arma::Mat<size_t> neighbors;
   arma::mat distances;
@@ -173,16 +187,43 @@ int main(int argc, char *argv[])
     std::vector<size_t> oldFromNewQueries;
 
     // Build trees by hand, so we can save memory: if we pass a tree to
-    // NeighborSearch, it does not copy the matrix.
-    Log::Info << "Building reference tree..." << endl;
-    Timer::Start("tree_building");
+    // NeighborSearch, it does not copy the matrix.  If a saved tree is
+    // available, load it instead.
     typedef BinarySpaceTree<bound::HRectBound<2, false>,
         RAQueryStat<NearestNeighborSort> > TreeType;
-    TreeType refTree(referenceData, oldFromNewRefs, leafSize);
-    Timer::Stop("tree_building");
+    TreeType* refTree;
+    if (loadTree)
+    {
+      Log::Info << "Loading reference tree from '" << referenceTreeFile
+          << "'..." << endl;
+      const size_t dimensionality = referenceData.n_rows;
+      const size_t points = referenceData.n_cols;
+      refTree = LoadTree<TreeType>(referenceTreeFile, referenceData,
+          oldFromNewRefs, true);
+      if (referenceData.n_rows != dimensionality || referenceData.n_cols != points)
+      {
+        Log::Fatal << "Reference tree in '" << referenceTreeFile << "' was "
+            << "not built on a dataset of the same size as '"
+            << referenceFile << "'!" << endl;
+      }
+    }
+    else
+    {
+      Log::Info << "Building reference tree..." << endl;
+      Timer::Start("tree_building");
+      refTree = new TreeType(referenceData, oldFromNewRefs, leafSize);
+      Timer::Stop("tree_building");
+
+      if (referenceTreeFile != "")
+      {
+        Log::Info << "Saving reference tree to '" << referenceTreeFile
+            << "'..." << endl;
+        SaveTree(referenceTreeFile, *refTree, oldFromNewRefs);
+      }
+    }
 
     // Because we may construct it differently, we need a pointer.
-    AllkRANN allkrann(&refTree, singleMode, tau, alpha, sampleAtLeaves,
+    AllkRANN allkrann(refTree, singleMode, tau, alpha, sampleAtLeaves,
         firstLeafExact, singleSampleLimit);
 
     if (CLI::HasParam("query_file") && !singleMode)
@@ -225,6 +266,7 @@ int main(int argc, char *argv[])
     else
       Unmap(neighborsOut, distancesOut, oldFromNewRefs, oldFromNewRefs,
           neighbors, distances);
+    delete refTree;
   }
 
   // Save output.
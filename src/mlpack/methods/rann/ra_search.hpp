@@ -316,6 +316,23 @@ class RASearch
   //! Permutations of reference points during tree building.
   std::vector<size_t> oldFromNewReferences;
 
+  /**
+   * Perform the single-tree traversal for all query points in parallel, with
+   * a copy of the given rules for every thread.  Returns the number of distance
+   * computations.
+   */
+  template<typename RuleType>
+  size_t SingleTreeSearch(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Perform the dual-tree traversal of the given query tree, in parallel over
+   * disjoint subtrees of the query tree if the tree type allows it, with a copy
+   * of the given rules for every thread.  Returns the number of distance
+   * computations.
+   */
+  template<typename RuleType>
+  size_t DualTreeSearch(RuleType& rules, TreeType& queryTree);
+
 }; // class RASearch
 
 }; // namespace neighbor
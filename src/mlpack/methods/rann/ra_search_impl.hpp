@@ -12,6 +12,8 @@
 
 #include "ra_search_rules.hpp"
 
+#include <mlpack/core/tree/traversal_statistics.hpp>
+
 namespace mlpack {
 namespace neighbor {
 
@@ -202,18 +204,13 @@ Search(const typename TreeType::Mat& querySet,
     {
       Log::Info << "Performing single-tree traversal..." << std::endl;
 
-      // Create the traverser.
-      typename TreeType::template SingleTreeTraverser<RuleType>
-        traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySetRef.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point, in parallel.
+      const size_t numDistComputations = SingleTreeSearch(rules,
+          querySetRef.n_cols);
 
       Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
-          << (rules.NumDistComputations() / querySet.n_cols) << "."
-          << std::endl;
+          << (numDistComputations / querySet.n_cols) << "." << std::endl;
     }
   }
   else // Dual-tree recursion.
@@ -228,16 +225,14 @@ Search(const typename TreeType::Mat& querySet,
     Timer::Stop("tree_building");
     Timer::Start("computing_neighbors");
 
-    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
-
     Log::Info << "Query statistic pre-search: "
         << queryTree->Stat().NumSamplesMade() << std::endl;
 
-    traverser.Traverse(*queryTree, *referenceTree);
+    const size_t numDistComputations = DualTreeSearch(rules, *queryTree);
 
     Log::Info << "Dual-tree traversal complete." << std::endl;
     Log::Info << "Average number of distance calculations per query point: "
-        << (rules.NumDistComputations() / querySet.n_cols) << "." << std::endl;
+        << (numDistComputations / querySet.n_cols) << "." << std::endl;
 
     delete queryTree;
   }
@@ -339,8 +334,7 @@ void RASearch<SortPolicy, MetricType, TreeType>::Search(
                  singleSampleLimit, false);
 
   // Create the traverser.
-  typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeSearch(rules, *queryTree);
 
   Timer::Stop("computing_neighbors");
 
@@ -407,19 +401,12 @@ void RASearch<SortPolicy, MetricType, TreeType>::Search(
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename TreeType::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    // Traverse for each point, in parallel.
+    SingleTreeSearch(rules, referenceSet.n_cols);
   }
   else
   {
-    // Create the traverser.
-    typename TreeType::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
+    DualTreeSearch(rules, *referenceTree);
   }
 
   Timer::Stop("computing_neighbors");
@@ -459,6 +446,120 @@ void RASearch<SortPolicy, MetricType, TreeType>::ResetQueryTree(
 }
 
 // Returns a string representation of the object.
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename RuleType>
+size_t RASearch<SortPolicy, MetricType, TreeType>::SingleTreeSearch(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  // Trees whose first point is the centroid and which have self-children may
+  // cache results in the reference node statistics, so concurrent traversals of
+  // the same reference tree could race on that cache.
+  const bool parallel = !(tree::TreeTraits<TreeType>::FirstPointIsCentroid &&
+      tree::TreeTraits<TreeType>::HasSelfChildren);
+
+  // The queries are processed in blocks of a fixed size, and the samples of
+  // every block are drawn with its own seed, so the results only depend on the
+  // global seed and not on the number of threads.
+  const size_t blockSize = 64;
+  const size_t numBlocks = (numQueries + blockSize - 1) / blockSize;
+  const size_t seed = (size_t) math::randGen();
+
+  size_t numDistComputations = rules.NumDistComputations();
+
+  #pragma omp parallel if(parallel) reduction(+:numDistComputations)
+  {
+    // Each thread gets its own rules and traverser.
+    RuleType threadRules(rules);
+    typename TreeType::template SingleTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    #pragma omp for schedule(dynamic)
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+      threadRules.Seed(seed + block);
+
+      const size_t end = std::min(numQueries, (block + 1) * blockSize);
+      for (size_t i = block * blockSize; i < end; ++i)
+        traverser.Traverse(i, *referenceTree);
+    }
+    tree::RecordTraversal("ra_search", traverser, threadRules);
+
+    numDistComputations += threadRules.NumDistComputations() -
+        rules.NumDistComputations();
+  }
+
+  return numDistComputations;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename RuleType>
+size_t RASearch<SortPolicy, MetricType, TreeType>::DualTreeSearch(
+    RuleType& rules,
+    TreeType& queryTree)
+{
+  // The query tree is split into disjoint subtrees, which are traversed with
+  // the whole reference tree in parallel.  This is only possible if the points
+  // are only held by the leaves; otherwise the query tree is traversed as a
+  // whole.  The split doesn't depend on the number of threads.
+  std::vector<TreeType*> subtrees(1, &queryTree);
+  if (!tree::TreeTraits<TreeType>::HasSelfChildren &&
+      !tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+  {
+    const size_t minSize = std::max((size_t) 1,
+        queryTree.NumDescendants() / 64);
+
+    bool split = true;
+    while (split)
+    {
+      split = false;
+      std::vector<TreeType*> children;
+      for (size_t i = 0; i < subtrees.size(); ++i)
+      {
+        if (subtrees[i]->IsLeaf() || subtrees[i]->NumPoints() > 0 ||
+            subtrees[i]->NumDescendants() <= minSize)
+        {
+          children.push_back(subtrees[i]);
+          continue;
+        }
+
+        for (size_t j = 0; j < subtrees[i]->NumChildren(); ++j)
+          children.push_back(&subtrees[i]->Child(j));
+        split = true;
+      }
+
+      subtrees.swap(children);
+    }
+  }
+
+  // Every subtree draws its samples with its own seed.
+  const size_t seed = (size_t) math::randGen();
+
+  size_t numDistComputations = rules.NumDistComputations();
+
+  #pragma omp parallel reduction(+:numDistComputations)
+  {
+    // Each thread gets its own rules and traverser.
+    RuleType threadRules(rules);
+    typename TreeType::template DualTreeTraverser<RuleType>
+        traverser(threadRules);
+
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < subtrees.size(); ++i)
+    {
+      threadRules.Seed(seed + i);
+      threadRules.TraversalInfo() = typename RuleType::TraversalInfoType();
+      traverser.Traverse(*subtrees[i], *referenceTree);
+    }
+    tree::RecordTraversal("ra_search", traverser, threadRules);
+
+    numDistComputations += threadRules.NumDistComputations() -
+        rules.NumDistComputations();
+  }
+
+  return numDistComputations;
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 std::string RASearch<SortPolicy, MetricType, TreeType>::ToString() const
 {
@@ -177,7 +177,19 @@ class RASearchRules
                  const double oldScore);
 
 
-  size_t NumDistComputations() { return numDistComputations; }
+  /**
+   * Seed the random number generator used for sampling.  RASearch seeds every
+   * block of queries separately, so that the results don't depend on the
+   * number of threads.
+   *
+   * @param seed Seed for the generator.
+   */
+  void Seed(const size_t seed) { randGen.seed((uint32_t) seed); }
+
+  size_t NumDistComputations() const { return numDistComputations; }
+  //! Get the number of base cases (the same as the number of distance
+  //! computations).
+  size_t BaseCases() const { return numDistComputations; }
   size_t NumEffectiveSamples()
   {
     if (numSamplesMade.n_elem == 0)
@@ -233,6 +245,15 @@ class RASearchRules
 
   TraversalInfoType traversalInfo;
 
+  //! The random number generator used for sampling.
+  mutable std::mt19937 randGen;
+
+  //! The indices of the current samples (reused between the calls).
+  arma::uvec sampleIndices;
+
+  //! The distances to the current samples (reused between the calls).
+  arma::vec sampleDistances;
+
   /**
    * Insert a point into the neighbors and distances matrices; this is a helper
    * function.
@@ -288,6 +309,20 @@ class RASearchRules
                              const size_t rangeUpperBound,
                              arma::uvec& distinctSamples) const;
 
+  /**
+   * Draw the given number of samples (with replacement) from the descendants of
+   * the reference node and evaluate the base cases of the distinct samples for
+   * the given query point.  The distances are computed in one pass before they
+   * are merged into the neighbor list.
+   *
+   * @param queryIndex Index of the query point.
+   * @param referenceNode Reference node to sample from.
+   * @param numSamples Number of random samples.
+   */
+  void SampleNode(const size_t queryIndex,
+                  TreeType& referenceNode,
+                  const size_t numSamples);
+
   /**
    * Perform actual scoring for single-tree case.
    */
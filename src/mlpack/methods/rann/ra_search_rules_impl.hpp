@@ -60,6 +60,10 @@ RASearchRules(const arma::mat& referenceSet,
   numSamplesReqd = MinimumSamplesReqd(n, k, tau, alpha);
   Timer::Stop("computing_number_of_samples_reqd");
 
+  // The samples are drawn from the rules' own generator, which is seeded from
+  // the global generator; see Seed().
+  randGen.seed((uint32_t) math::randGen());
+
   // Initialize some statistics to be collected during the search.
   numSamplesMade = arma::zeros<arma::Col<size_t> >(querySet.n_cols);
   numDistComputations = 0;
@@ -89,15 +93,84 @@ ObtainDistinctSamples(const size_t numSamples,
                       const size_t rangeUpperBound,
                       arma::uvec& distinctSamples) const
 {
+  std::uniform_int_distribution<size_t> dist(0, rangeUpperBound - 1);
+
+  // If only few samples are drawn from a large range, sorting the samples is
+  // cheaper than marking them in a vector of the size of the range.
+  if (8 * numSamples < rangeUpperBound)
+  {
+    distinctSamples.set_size(numSamples);
+    for (size_t i = 0; i < numSamples; i++)
+      distinctSamples[i] = (arma::uword) dist(randGen);
+
+    std::sort(distinctSamples.begin(), distinctSamples.end());
+    const size_t numDistinct = std::unique(distinctSamples.begin(),
+        distinctSamples.end()) - distinctSamples.begin();
+    distinctSamples.resize(numDistinct);
+    return;
+  }
+
   // Keep track of the points that are sampled.
   arma::Col<size_t> sampledPoints;
   sampledPoints.zeros(rangeUpperBound);
 
   for (size_t i = 0; i < numSamples; i++)
-    sampledPoints[(size_t) math::RandInt(rangeUpperBound)]++;
+    sampledPoints[dist(randGen)]++;
 
   distinctSamples = arma::find(sampledPoints > 0);
-  return;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::
+SampleNode(const size_t queryIndex,
+           TreeType& referenceNode,
+           const size_t numSamples)
+{
+  ObtainDistinctSamples(numSamples, referenceNode.NumDescendants(),
+      sampleIndices);
+
+  // First compute the distances to all samples in one tight loop; the
+  // descendants of a node are mostly stored together, so the sorted samples
+  // are read in increasing memory order.
+  sampleDistances.set_size(sampleIndices.n_elem);
+  size_t numEvaluated = 0;
+  for (size_t i = 0; i < sampleIndices.n_elem; ++i)
+  {
+    const size_t referenceIndex = referenceNode.Descendant(sampleIndices[i]);
+    sampleIndices[i] = referenceIndex;
+
+    // A point is not its own neighbor, and does not count as a sample.
+    if (sameSet && (queryIndex == referenceIndex))
+    {
+      sampleDistances[i] = SortPolicy::WorstDistance();
+      continue;
+    }
+
+    sampleDistances[i] = metric.Evaluate(querySet.unsafe_col(queryIndex),
+        referenceSet.unsafe_col(referenceIndex));
+    ++numEvaluated;
+  }
+
+  // Then merge the candidates into the neighbor list; most of them are
+  // rejected by the comparison with the current k-th best distance.
+  for (size_t i = 0; i < sampleIndices.n_elem; ++i)
+  {
+    if (!SortPolicy::IsBetter(sampleDistances[i],
+        distances(distances.n_rows - 1, queryIndex)))
+      continue;
+
+    arma::vec queryDist = distances.unsafe_col(queryIndex);
+    arma::Col<size_t> queryIndices = neighbors.unsafe_col(queryIndex);
+    const size_t insertPosition = SortPolicy::SortDistance(queryDist,
+        queryIndices, sampleDistances[i]);
+
+    if (insertPosition != (size_t() - 1))
+      InsertNeighbor(queryIndex, insertPosition, sampleIndices[i],
+          sampleDistances[i]);
+  }
+
+  numSamplesMade[queryIndex] += numEvaluated;
+  numDistComputations += numEvaluated;
 }
 
 
@@ -358,13 +431,9 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
         {
           // Then samplesReqd <= singleSampleLimit.
           // Hence, approximate the node by sampling enough number of points.
-          arma::uvec distinctSamples;
-          ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-                                distinctSamples);
-          for (size_t i = 0; i < distinctSamples.n_elem; i++)
-            // The counting of the samples are done in the 'BaseCase' function
-            // so no book-keeping is required here.
-            BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
+          // The counting of the samples is done in SampleNode(), so no
+          // book-keeping is required here.
+          SampleNode(queryIndex, referenceNode, samplesReqd);
 
           // Node approximated, so we can prune it.
           return DBL_MAX;
@@ -374,14 +443,9 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           if (sampleAtLeaves) // If allowed to sample at leaves.
           {
             // Approximate node by sampling enough number of points.
-            arma::uvec distinctSamples;
-            ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-                                  distinctSamples);
-            for (size_t i = 0; i < distinctSamples.n_elem; i++)
-              // The counting of the samples are done in the 'BaseCase' function
-              // so no book-keeping is required here.
-              BaseCase(queryIndex,
-                  referenceNode.Descendant(distinctSamples[i]));
+            // The counting of the samples is done in SampleNode(), so no
+            // book-keeping is required here.
+            SampleNode(queryIndex, referenceNode, samplesReqd);
 
             // (Leaf) node approximated, so we can prune it.
             return DBL_MAX;
@@ -462,13 +526,9 @@ Rescore(const size_t queryIndex,
       {
         // Then, samplesReqd <= singleSampleLimit.  Hence, approximate the node
         // by sampling enough number of points.
-        arma::uvec distinctSamples;
-        ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-            distinctSamples);
-        for (size_t i = 0; i < distinctSamples.n_elem; i++)
-          // The counting of the samples are done in the 'BaseCase' function so
-          // no book-keeping is required here.
-          BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
+        // The counting of the samples is done in SampleNode(), so no
+        // book-keeping is required here.
+        SampleNode(queryIndex, referenceNode, samplesReqd);
 
         // Node approximated, so we can prune it.
         return DBL_MAX;
@@ -478,13 +538,9 @@ Rescore(const size_t queryIndex,
         if (sampleAtLeaves)
         {
           // Approximate node by sampling enough points.
-          arma::uvec distinctSamples;
-          ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-                                distinctSamples);
-          for (size_t i = 0; i < distinctSamples.n_elem; i++)
-            // The counting of the samples are done in the 'BaseCase' function
-            // so no book-keeping is required here.
-            BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
+          // The counting of the samples is done in SampleNode(), so no
+          // book-keeping is required here.
+          SampleNode(queryIndex, referenceNode, samplesReqd);
 
           // (Leaf) node approximated, so we can prune it.
           return DBL_MAX;
@@ -665,14 +721,9 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
           {
             const size_t queryIndex = queryNode.Descendant(i);
-            arma::uvec distinctSamples;
-            ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-                                  distinctSamples);
-            for (size_t j = 0; j < distinctSamples.n_elem; j++)
-              // The counting of the samples are done in the 'BaseCase' function
-              // so no book-keeping is required here.
-              BaseCase(queryIndex,
-                  referenceNode.Descendant(distinctSamples[j]));
+            // The counting of the samples is done in SampleNode(), so no
+            // book-keeping is required here.
+            SampleNode(queryIndex, referenceNode, samplesReqd);
           }
 
           // Update the number of samples made for the queryNode and also update
@@ -695,14 +746,9 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
             for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
             {
               const size_t queryIndex = queryNode.Descendant(i);
-              arma::uvec distinctSamples;
-              ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-                                    distinctSamples);
-              for (size_t j = 0; j < distinctSamples.n_elem; j++)
-                // The counting of the samples are done in the 'BaseCase'
-                // function so no book-keeping is required here.
-                BaseCase(queryIndex,
-                    referenceNode.Descendant(distinctSamples[j]));
+              // The counting of the samples is done in SampleNode(), so no
+              // book-keeping is required here.
+              SampleNode(queryIndex, referenceNode, samplesReqd);
             }
 
             // Update the number of samples made for the queryNode and also
@@ -870,13 +916,9 @@ Rescore(TreeType& queryNode,
         for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
         {
           const size_t queryIndex = queryNode.Descendant(i);
-          arma::uvec distinctSamples;
-          ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-              distinctSamples);
-          for (size_t j = 0; j < distinctSamples.n_elem; j++)
-            // The counting of the samples are done in the 'BaseCase'
-            // function so no book-keeping is required here.
-            BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[j]));
+          // The counting of the samples is done in SampleNode(), so no
+          // book-keeping is required here.
+          SampleNode(queryIndex, referenceNode, samplesReqd);
         }
 
         // Update the number of samples made for the query node and also update
@@ -899,14 +941,9 @@ Rescore(TreeType& queryNode,
           for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
           {
             const size_t queryIndex = queryNode.Descendant(i);
-            arma::uvec distinctSamples;
-            ObtainDistinctSamples(samplesReqd, referenceNode.NumDescendants(),
-                                  distinctSamples);
-            for (size_t j = 0; j < distinctSamples.n_elem; j++)
-              // The counting of the samples are done in BaseCase() so no
-              // book-keeping is required here.
-              BaseCase(queryIndex,
-                  referenceNode.Descendant(distinctSamples[j]));
+            // The counting of the samples is done in SampleNode(), so no
+            // book-keeping is required here.
+            SampleNode(queryIndex, referenceNode, samplesReqd);
           }
 
           // Update the number of samples made for the query node and also
@@ -10,6 +10,48 @@
 namespace mlpack {
 namespace svd {
 
+namespace {
+
+//! Dot product of two factor columns of the given rank.
+inline double FactorDot(const double* u, const double* v, const size_t rank)
+{
+  double result = 0.0;
+  for (size_t k = 0; k < rank; ++k)
+    result += u[k] * v[k];
+  return result;
+}
+
+//! Squared norm of a factor column of the given rank.
+inline double FactorSquaredNorm(const double* u, const size_t rank)
+{
+  return FactorDot(u, u, rank);
+}
+
+/**
+ * Group the ratings by the value of the given row of the data (the user or the
+ * item), with a counting sort: the ratings of group g are
+ * order[start[g]], ..., order[start[g + 1] - 1], in increasing order.
+ */
+void GroupRatings(const arma::mat& data,
+                  const size_t row,
+                  const size_t numGroups,
+                  std::vector<size_t>& start,
+                  std::vector<size_t>& order)
+{
+  start.assign(numGroups + 1, 0);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    ++start[(size_t) data(row, i) + 1];
+  for (size_t g = 0; g < numGroups; ++g)
+    start[g + 1] += start[g];
+
+  std::vector<size_t> next(start.begin(), start.end() - 1);
+  order.resize(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    order[next[(size_t) data(row, i)]++] = i;
+}
+
+} // anonymous namespace
+
 RegularizedSVDFunction::RegularizedSVDFunction(const arma::mat& data,
                                                const size_t rank,
                                                const double lambda) :
@@ -21,6 +63,11 @@ RegularizedSVDFunction::RegularizedSVDFunction(const arma::mat& data,
   numUsers = max(data.row(0)) + 1;
   numItems = max(data.row(1)) + 1;
 
+  // Group the ratings by user and by item, so that the full gradient of each
+  // factor column can be computed by one thread from contiguous lists.
+  GroupRatings(data, 0, numUsers, userStart, userRatings);
+  GroupRatings(data, 1, numItems, itemStart, itemRatings);
+
   // Initialize the parameters.
   initialPoint.randu(rank, numUsers + numItems);
 }
@@ -36,26 +83,9 @@ double RegularizedSVDFunction::Evaluate(const arma::mat& parameters) const
 
   double cost = 0.0;
 
-  for(size_t i = 0; i < data.n_cols; i++)
-  {
-    // Indices for accessing the the correct parameter columns.
-    const size_t user = data(0, i);
-    const size_t item = data(1, i) + numUsers;
-
-    // Calculate the squared error in the prediction.
-    const double rating = data(2, i);
-    double ratingError = rating - arma::dot(parameters.col(user),
-                                            parameters.col(item));
-    double ratingErrorSquared = ratingError * ratingError;
-
-    // Calculate the regularization penalty corresponding to the parameters.
-    double userVecNorm = arma::norm(parameters.col(user), 2);
-    double itemVecNorm = arma::norm(parameters.col(item), 2);
-    double regularizationError = lambda * (userVecNorm * userVecNorm +
-                                           itemVecNorm * itemVecNorm);
-
-    cost += (ratingErrorSquared + regularizationError);
-  }
+  #pragma omp parallel for reduction(+:cost)
+  for (size_t i = 0; i < data.n_cols; i++)
+    cost += Evaluate(parameters, i);
 
   return cost;
 }
@@ -64,22 +94,17 @@ double RegularizedSVDFunction::Evaluate(const arma::mat& parameters,
                                         const size_t i) const
 {
   // Indices for accessing the the correct parameter columns.
-  const size_t user = data(0, i);
-  const size_t item = data(1, i) + numUsers;
+  const double* user = parameters.colptr((size_t) data(0, i));
+  const double* item = parameters.colptr((size_t) data(1, i) + numUsers);
 
   // Calculate the squared error in the prediction.
-  const double rating = data(2, i);
-  double ratingError = rating - arma::dot(parameters.col(user),
-                                          parameters.col(item));
-  double ratingErrorSquared = ratingError * ratingError;
+  const double ratingError = data(2, i) - FactorDot(user, item, rank);
 
   // Calculate the regularization penalty corresponding to the parameters.
-  double userVecNorm = arma::norm(parameters.col(user), 2);
-  double itemVecNorm = arma::norm(parameters.col(item), 2);
-  double regularizationError = lambda * (userVecNorm * userVecNorm +
-                                         itemVecNorm * itemVecNorm);
+  const double regularizationError = lambda *
+      (FactorSquaredNorm(user, rank) + FactorSquaredNorm(item, rank));
 
-  return (ratingErrorSquared + regularizationError);
+  return (ratingError * ratingError + regularizationError);
 }
 
 void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
@@ -93,26 +118,100 @@ void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
   //           rating(i, j) - u(i).t() * v(j)
   // The full gradient is calculated by summing the contributions over all the
   // training examples.
+  //
+  // First the errors of all the examples are computed; then the gradient of
+  // each user column is summed over the ratings of that user, and the same for
+  // each item column, so that no two threads write to the same column.
+
+  gradient.zeros(rank, numUsers + numItems);
+
+  arma::vec ratingErrors(data.n_cols);
+  #pragma omp parallel for
+  for (size_t i = 0; i < data.n_cols; i++)
+  {
+    ratingErrors[i] = data(2, i) - FactorDot(
+        parameters.colptr((size_t) data(0, i)),
+        parameters.colptr((size_t) data(1, i) + numUsers), rank);
+  }
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t u = 0; u < numUsers; u++)
+  {
+    const double* user = parameters.colptr(u);
+    double* g = gradient.colptr(u);
+    for (size_t r = userStart[u]; r < userStart[u + 1]; ++r)
+    {
+      const size_t i = userRatings[r];
+      const double* item = parameters.colptr((size_t) data(1, i) + numUsers);
+      for (size_t k = 0; k < rank; ++k)
+        g[k] += 2 * (lambda * user[k] - ratingErrors[i] * item[k]);
+    }
+  }
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t v = 0; v < numItems; v++)
+  {
+    const double* item = parameters.colptr(v + numUsers);
+    double* g = gradient.colptr(v + numUsers);
+    for (size_t r = itemStart[v]; r < itemStart[v + 1]; ++r)
+    {
+      const size_t i = itemRatings[r];
+      const double* user = parameters.colptr((size_t) data(0, i));
+      for (size_t k = 0; k < rank; ++k)
+        g[k] += 2 * (lambda * item[k] - ratingErrors[i] * user[k]);
+    }
+  }
+}
+
+double RegularizedSVDFunction::Evaluate(const arma::mat& parameters,
+                                        const size_t begin,
+                                        const size_t batchSize) const
+{
+  // Gather the user and item vectors of the batch.
+  arma::mat users(rank, batchSize);
+  arma::mat items(rank, batchSize);
+  for (size_t i = 0; i < batchSize; i++)
+  {
+    users.col(i) = parameters.col((size_t) data(0, begin + i));
+    items.col(i) = parameters.col((size_t) data(1, begin + i) + numUsers);
+  }
+
+  // The prediction errors of the whole batch, and the regularization penalty
+  // of every vector each rating contributes to.
+  const arma::rowvec ratingErrors = data.row(2).cols(begin,
+      begin + batchSize - 1) - arma::sum(users % items, 0);
 
+  return arma::accu(arma::square(ratingErrors)) + lambda *
+      (arma::accu(arma::square(users)) + arma::accu(arma::square(items)));
+}
+
+void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
+                                      const size_t begin,
+                                      const size_t batchSize,
+                                      arma::mat& gradient) const
+{
+  // See Gradient(parameters, gradient) for the form of the gradient; here the
+  // sum is only over the examples in the batch.
   gradient.zeros(rank, numUsers + numItems);
 
-  for(size_t i = 0; i < data.n_cols; i++)
+  for (size_t i = begin; i < begin + batchSize; i++)
   {
     // Indices for accessing the the correct parameter columns.
     const size_t user = data(0, i);
     const size_t item = data(1, i) + numUsers;
+    const double* u = parameters.colptr(user);
+    const double* v = parameters.colptr(item);
+    double* gu = gradient.colptr(user);
+    double* gv = gradient.colptr(item);
 
     // Prediction error for the example.
-    const double rating = data(2, i);
-    double ratingError = rating - arma::dot(parameters.col(user),
-                                            parameters.col(item));
+    const double ratingError = data(2, i) - FactorDot(u, v, rank);
 
-    // Gradient is non-zero only for the parameter columns corresponding to the
-    // example.
-    gradient.col(user) += 2 * (lambda * parameters.col(user) -
-                               ratingError * parameters.col(item));
-    gradient.col(item) += 2 * (lambda * parameters.col(item) -
-                               ratingError * parameters.col(user));
+    for (size_t k = 0; k < rank; ++k)
+    {
+      gu[k] += 2 * (lambda * u[k] - ratingError * v[k]);
+      gv[k] += 2 * (lambda * v[k] - ratingError * u[k]);
+    }
   }
 }
 
@@ -137,7 +236,10 @@ double SGD<mlpack::svd::RegularizedSVDFunction>::Optimize(arma::mat& parameters)
   for(size_t i = 0; i < numFunctions; i++)
     overallObjective += function.Evaluate(parameters, i);
 
-  const arma::mat data = function.Dataset();
+  const arma::mat& data = function.Dataset();
+  const size_t numUsers = function.NumUsers();
+  const size_t rank = function.Rank();
+  const double lambda = function.Lambda();
 
   // Now iterate!
   for(size_t i = 1; i != maxIterations; i++, currentFunction++)
@@ -150,25 +252,25 @@ double SGD<mlpack::svd::RegularizedSVDFunction>::Optimize(arma::mat& parameters)
       currentFunction = 0;
     }
 
-    const size_t numUsers = function.NumUsers();
-
-    // Indices for accessing the the correct parameter columns.
-    const size_t user = data(0, currentFunction);
-    const size_t item = data(1, currentFunction) + numUsers;
+    // Pointers to the correct parameter columns.
+    double* user = parameters.colptr((size_t) data(0, currentFunction));
+    double* item = parameters.colptr((size_t) data(1, currentFunction) +
+        numUsers);
 
     // Prediction error for the example.
-    const double rating = data(2, currentFunction);
-    double ratingError = rating - arma::dot(parameters.col(user),
-                                            parameters.col(item));
-
-    double lambda = function.Lambda();
+    double ratingError = data(2, currentFunction);
+    for (size_t k = 0; k < rank; ++k)
+      ratingError -= user[k] * item[k];
 
     // Gradient is non-zero only for the parameter columns corresponding to the
     // example.
-    parameters.col(user) -= stepSize * (lambda * parameters.col(user) -
-                                        ratingError * parameters.col(item));
-    parameters.col(item) -= stepSize * (lambda * parameters.col(item) -
-                                        ratingError * parameters.col(user));
+    for (size_t k = 0; k < rank; ++k)
+    {
+      const double u = user[k];
+      const double v = item[k];
+      user[k] -= stepSize * (lambda * u - ratingError * v);
+      item[k] -= stepSize * (lambda * v - ratingError * u);
+    }
 
     // Now add that to the overall objective function.
     overallObjective += function.Evaluate(parameters, currentFunction);
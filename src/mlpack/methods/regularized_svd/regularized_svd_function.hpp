@@ -48,9 +48,25 @@ class RegularizedSVDFunction
   double Evaluate(const arma::mat& parameters,
                   const size_t i) const;
 
+  /**
+   * Evaluates the cost function summed over the training examples begin, ...,
+   * begin + batchSize - 1.  The user and item vectors of the batch are gathered
+   * into matrices so the errors of the whole batch are computed at once.
+   * Useful for mini-batch optimizers.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param begin Index of the first training example to be used.
+   * @param batchSize Number of training examples to be used.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
   /**
    * Evaluates the full gradient of the cost function over all the training
-   * examples.
+   * examples.  The gradient of each user and item column is summed over the
+   * ratings of that user or item (grouped at construction time), so with
+   * OpenMP the columns are computed in parallel without any locking.
    *
    * @param parameters Parameters(user/item matrices) of the decomposition.
    * @param gradient Calculated gradient for the parameters.
@@ -58,6 +74,21 @@ class RegularizedSVDFunction
   void Gradient(const arma::mat& parameters,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluates the gradient of the cost function summed over the training
+   * examples begin, ..., begin + batchSize - 1.  Only the columns of the users
+   * and items in the batch are nonzero.  Useful for mini-batch optimizers.
+   *
+   * @param parameters Parameters(user/item matrices) of the decomposition.
+   * @param begin Index of the first training example to be used.
+   * @param batchSize Number of training examples to be used.
+   * @param gradient Calculated gradient for the parameters.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                const size_t batchSize,
+                arma::mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -92,6 +123,17 @@ class RegularizedSVDFunction
   size_t numUsers;
   //! Number of items in the given dataset.
   size_t numItems;
+
+  //! The ratings of user u are userRatings[userStart[u]], ...,
+  //! userRatings[userStart[u + 1] - 1].
+  std::vector<size_t> userStart;
+  //! Indices of the ratings, grouped by user.
+  std::vector<size_t> userRatings;
+  //! The ratings of item v are itemRatings[itemStart[v]], ...,
+  //! itemRatings[itemStart[v + 1] - 1].
+  std::vector<size_t> itemStart;
+  //! Indices of the ratings, grouped by item.
+  std::vector<size_t> itemRatings;
 };
 
 }; // namespace svd
@@ -16,6 +16,7 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(const arma::mat& data,
                                                      const double lambda,
                                                      const bool fitIntercept) :
     data(data),
+    labels(arma::conv_to<arma::uvec>::from(labels)),
     inputSize(inputSize),
     numClasses(numClasses),
     lambda(lambda),
@@ -23,9 +24,6 @@ SoftmaxRegressionFunction::SoftmaxRegressionFunction(const arma::mat& data,
 {
   // Intialize the parameters to suitable values.
   initialPoint = InitializeWeights();
-
-  // Calculate the label matrix.
-  GetGroundTruthMatrix(labels, groundTruth);
 }
 
 /**
@@ -89,26 +87,21 @@ void SoftmaxRegressionFunction::GetGroundTruthMatrix(const arma::vec& labels,
 void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
     const arma::mat& parameters, arma::mat& probabilities) const
 {
-  arma::mat hypothesis;
-
-  if (fitIntercept)
-  {
-    // In order to add the intercept term, we should compute following matrix:
-    //     [1; data] = arma::join_cols(ones(1, data.n_cols), data)
-    //     hypothesis = arma::exp(parameters * [1; data]).
-    //
-    // Since the cost of join maybe high due to the copy of original data,
-    // split the hypothesis computation to two components.
-    hypothesis = arma::exp(arma::repmat(parameters.col(0), 1, data.n_cols) +
-        parameters.cols(1, parameters.n_cols - 1) * data);
-  }
-  else
-  {
-    hypothesis = arma::exp(parameters * data);
-  }
+  GetProbabilitiesMatrix(parameters, 0, data.n_cols, probabilities);
+}
 
-  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
-                                            numClasses, 1);
+/**
+ * Evaluate the probabilities matrix of a batch of points.
+ */
+void SoftmaxRegressionFunction::GetProbabilitiesMatrix(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& probabilities) const
+{
+  Scores(parameters, begin, batchSize, probabilities);
+  for (size_t j = 0; j < batchSize; ++j)
+    Softmax(probabilities.colptr(j), probabilities.n_rows);
 }
 
 /**
@@ -125,62 +118,171 @@ double SoftmaxRegressionFunction::Evaluate(const arma::mat& parameters) const
   // 'm' is the number of training examples.
   // The cost also takes into account the regularization to control the
   // parameter weights.
+  return -LogLikelihood(parameters, NULL) + WeightDecay(parameters);
+}
+
+/**
+ * Calculates and stores the gradient values given a set of parameters.
+ */
+void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
+                                         arma::mat& gradient) const
+{
+  LogLikelihood(parameters, &gradient);
+}
+
+/**
+ * Evaluates the objective function and the gradient given the parameters,
+ * reusing the probabilities for both.
+ */
+double SoftmaxRegressionFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  return -LogLikelihood(parameters, &gradient) + WeightDecay(parameters);
+}
 
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities);
+double SoftmaxRegressionFunction::LogSumExp(const double* scores,
+                                            const size_t n)
+{
+  double maxScore = scores[0];
+  for (size_t i = 1; i < n; ++i)
+    maxScore = std::max(maxScore, scores[i]);
+
+  double sum = 0.0;
+  for (size_t i = 0; i < n; ++i)
+    sum += std::exp(scores[i] - maxScore);
+
+  return maxScore + std::log(sum);
+}
 
-  // Calculate the log likelihood and regularization terms.
-  double logLikelihood, weightDecay, cost;
+double SoftmaxRegressionFunction::Softmax(double* scores, const size_t n)
+{
+  double maxScore = scores[0];
+  for (size_t i = 1; i < n; ++i)
+    maxScore = std::max(maxScore, scores[i]);
 
-  logLikelihood = arma::accu(groundTruth % arma::log(probabilities)) /
-      data.n_cols;
-  weightDecay = 0.5 * lambda * arma::accu(parameters % parameters);
+  // The largest term is exp(0) = 1, so the sum can't underflow to zero.
+  double sum = 0.0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    scores[i] = std::exp(scores[i] - maxScore);
+    sum += scores[i];
+  }
 
-  // The cost is the sum of the negative log likelihood and the regularization
-  // terms.
-  cost = -logLikelihood + weightDecay;
+  const double inverseSum = 1.0 / sum;
+  for (size_t i = 0; i < n; ++i)
+    scores[i] *= inverseSum;
 
-  return cost;
+  return maxScore + std::log(sum);
 }
 
 /**
- * Calculates and stores the gradient values given a set of parameters.
+ * Evaluate the scores of a batch of points.  If fitIntercept flag is true, it
+ * should consider the parameters.cols(0) intercept term.
  */
-void SoftmaxRegressionFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+void SoftmaxRegressionFunction::Scores(const arma::mat& parameters,
+                                       const size_t begin,
+                                       const size_t batchSize,
+                                       arma::mat& scores) const
 {
-  // Calculate the class probabilities for each training example. The
-  // probabilities for each of the classes are given by:
-  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
-  // The sum is calculated over all the classes.
-  // x_i is the input vector for a particular training example.
-  // theta_j is the parameter vector associated with a particular class.
-  arma::mat probabilities;
-  GetProbabilitiesMatrix(parameters, probabilities);
-
-  // Calculate the parameter gradients.
-  gradient.set_size(parameters.n_rows, parameters.n_cols);
+  // An alias of the columns of the batch, to avoid copying them.
+  const arma::mat batch(const_cast<double*>(data.colptr(begin)), data.n_rows,
+      batchSize, false, true);
+
   if (fitIntercept)
   {
-    // Treating the intercept term parameters.col(0) seperately to avoid
-    // the cost of building matrix [1; data].
-    arma::mat inner = probabilities - groundTruth;
-    gradient.col(0) =
-        inner * arma::ones<arma::mat>(data.n_cols, 1) / data.n_cols +
-        lambda * parameters.col(0);
-    gradient.cols(1, parameters.n_cols - 1) =
-        inner * data.t() / data.n_cols +
-        lambda * parameters.cols(1, parameters.n_cols - 1);
+    // In order to add the intercept term, we should compute following matrix:
+    //     [1; data] = arma::join_cols(ones(1, data.n_cols), data)
+    //     scores = parameters * [1; data].
+    //
+    // Since the cost of join maybe high due to the copy of original data,
+    // split the computation to two components.
+    scores = parameters.cols(1, parameters.n_cols - 1) * batch;
+    scores.each_col() += parameters.col(0);
   }
   else
   {
-    gradient = (probabilities - groundTruth) * data.t() / data.n_cols +
-        lambda * parameters;
+    scores = parameters * batch;
   }
 }
+
+/**
+ * Calculates the log likelihood of the training examples, and their gradient if
+ * it is wanted.
+ */
+double SoftmaxRegressionFunction::LogLikelihood(const arma::mat& parameters,
+                                                arma::mat* gradient) const
+{
+  if (gradient)
+    gradient->zeros(parameters.n_rows, parameters.n_cols);
+
+  // The log probability of the label of a point is its score minus the
+  // log-sum-exp of all its scores.  For the gradient, the scores are turned
+  // into probabilities in place, and the ground truth is subtracted from them.
+  // Each thread sums the gradient of its blocks separately.
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+  double logLikelihood = 0.0;
+  #pragma omp parallel reduction(+:logLikelihood)
+  {
+    arma::mat scores;
+    arma::mat threadGradient;
+    if (gradient)
+      threadGradient.zeros(parameters.n_rows, parameters.n_cols);
+
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t blockBegin = b * BlockSize;
+      const size_t blockSize = std::min((size_t) BlockSize,
+          (size_t) data.n_cols - blockBegin);
+      Scores(parameters, blockBegin, blockSize, scores);
+
+      for (size_t j = 0; j < blockSize; ++j)
+      {
+        double* column = scores.colptr(j);
+        const size_t label = labels[blockBegin + j];
+        const double labelScore = column[label];
+        if (gradient)
+        {
+          logLikelihood += labelScore - Softmax(column, scores.n_rows);
+          column[label] -= 1.0;
+        }
+        else
+        {
+          logLikelihood += labelScore - LogSumExp(column, scores.n_rows);
+        }
+      }
+
+      if (gradient)
+      {
+        const arma::mat block(const_cast<double*>(data.colptr(blockBegin)),
+            data.n_rows, blockSize, false, true);
+        if (fitIntercept)
+        {
+          // Treating the intercept term parameters.col(0) seperately to avoid
+          // the cost of building matrix [1; data].
+          threadGradient.col(0) += arma::sum(scores, 1);
+          threadGradient.cols(1, parameters.n_cols - 1) += scores * block.t();
+        }
+        else
+        {
+          threadGradient += scores * block.t();
+        }
+      }
+    }
+
+    if (gradient)
+    {
+      #pragma omp critical(softmax_regression_gradient)
+      *gradient += threadGradient;
+    }
+  }
+
+  if (gradient)
+  {
+    *gradient /= data.n_cols;
+    *gradient += lambda * parameters;
+  }
+
+  return logLikelihood / data.n_cols;
+}
@@ -13,6 +13,19 @@
 namespace mlpack {
 namespace regression {
 
+/**
+ * The objective function of softmax regression: the negative log-likelihood of
+ * the labels, plus L2-regularization.  The objective is only computed over the
+ * whole dataset, so stochastic optimizers such as SGD or Adam treat it as a
+ * single function and take full-batch steps.
+ *
+ * The probabilities are computed with a stable log-sum-exp, which subtracts the
+ * largest score of each point before exponentiating, in place.  The points are
+ * evaluated a block at a time (the blocks are split across threads if OpenMP is
+ * available), so the memory used by the objective and its gradient is
+ * O(numClasses) per point of a block rather than per training example.  The
+ * regularization term is computed once per evaluation.
+ */
 class SoftmaxRegressionFunction
 {
  public:
@@ -49,7 +62,9 @@ class SoftmaxRegressionFunction
    * Evaluate the probabilities matrix with the passed parameters.
    * probabilities(i, j) =
    *     exp(\theta_i * data_j) / sum_k(exp(\theta_k * data_j)).
-   * It represents the probability of data_j belongs to class i.
+   * It represents the probability of data_j belongs to class i.  The largest
+   * score of each point is subtracted before exponentiating, so this doesn't
+   * overflow.
    *
    * @param parameters Current values of the model parameters.
    * @param probabilities Pointer to arma::mat which stores the probabilities.
@@ -57,6 +72,21 @@ class SoftmaxRegressionFunction
   void GetProbabilitiesMatrix(const arma::mat& parameters,
                               arma::mat& probabilities) const;
 
+  /**
+   * Evaluate the probabilities matrix with the passed parameters, for the
+   * points begin, ..., begin + batchSize - 1 only.  Column j of probabilities
+   * corresponds to data_{begin + j}.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point to use.
+   * @param batchSize Number of points to use.
+   * @param probabilities Pointer to arma::mat which stores the probabilities.
+   */
+  void GetProbabilitiesMatrix(const arma::mat& parameters,
+                              const size_t begin,
+                              const size_t batchSize,
+                              arma::mat& probabilities) const;
+
   /**
    * Evaluates the objective function of the softmax regression model using the
    * given parameters. The cost function has terms for the log likelihood error
@@ -79,6 +109,35 @@ class SoftmaxRegressionFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and stores its gradient in one pass, so
+   * the probabilities matrix is only computed once.  Optimizers such as
+   * L-BFGS use this instead of separate calls to Evaluate() and Gradient().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * The objective is only computed over the whole dataset, so for stochastic
+   * optimizers such as SGD or Adam the function is treated as a single
+   * function; those optimizers then take full-batch steps.
+   */
+  size_t NumFunctions() const { return 1; }
+
+  //! Evaluate the objective; i is ignored since there is only one function.
+  double Evaluate(const arma::mat& parameters, const size_t /* i */) const
+  { return Evaluate(parameters); }
+
+  //! Evaluate the gradient; i is ignored since there is only one function.
+  void Gradient(const arma::mat& parameters,
+                const size_t /* i */,
+                arma::mat& gradient) const
+  { Gradient(parameters, gradient); }
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -100,11 +159,33 @@ class SoftmaxRegressionFunction
   //! Gets the intercept flag.
   bool FitIntercept() const { return fitIntercept; }
 
+  /**
+   * Return log(sum_i exp(scores[i])), computed without overflow or underflow
+   * by subtracting the largest score first.
+   *
+   * @param scores Scores to sum the exponentials of.
+   * @param n Number of scores.
+   */
+  static double LogSumExp(const double* scores, const size_t n);
+
+  /**
+   * Replace the given scores with their softmax, exp(scores[i]) /
+   * sum_k exp(scores[k]), in place and without overflow or underflow.
+   *
+   * @param scores Scores to turn into probabilities.
+   * @param n Number of scores.
+   * @return The log-sum-exp of the scores, as LogSumExp() returns it.
+   */
+  static double Softmax(double* scores, const size_t n);
+
  private:
+  //! Number of training examples whose scores are held at once.
+  static const size_t BlockSize = 1024;
+
   //! Training data matrix.
   const arma::mat& data;
-  //! Label matrix for the provided data.
-  arma::sp_mat groundTruth;
+  //! Labels of the training examples.
+  arma::uvec labels;
   //! Initial parameter point.
   arma::mat initialPoint;
   //! Size of input feature vector.
@@ -115,6 +196,27 @@ class SoftmaxRegressionFunction
   double lambda;
   //! Intercept term flag.
   bool fitIntercept;
+
+  /**
+   * Compute the scores parameters * [1; data_j] of the training examples
+   * begin, ..., begin + batchSize - 1.
+   */
+  void Scores(const arma::mat& parameters,
+              const size_t begin,
+              const size_t batchSize,
+              arma::mat& scores) const;
+
+  /**
+   * Return the log-likelihood term of the objective, and compute the gradient
+   * of the whole objective (including the regularization term) if it is
+   * given.  The training examples are handled a block at a time, and the
+   * blocks are split across threads.
+   */
+  double LogLikelihood(const arma::mat& parameters, arma::mat* gradient) const;
+
+  //! Return the regularization term of the objective.
+  double WeightDecay(const arma::mat& parameters) const
+  { return 0.5 * lambda * arma::accu(parameters % parameters); }
 };
 
 }; // namespace regression
@@ -46,7 +46,8 @@ SoftmaxRegression<OptimizerType>::SoftmaxRegression(
     parameters(optimizer.Function().GetInitialPoint()),
     inputSize(optimizer.Function().InputSize()),
     numClasses(optimizer.Function().NumClasses()),
-    lambda(optimizer.Function().Lambda())
+    lambda(optimizer.Function().Lambda()),
+    fitIntercept(optimizer.Function().FitIntercept())
 {
   // Train the model.
   Timer::Start("softmax_regression_optimization");
@@ -61,48 +62,33 @@ template<template<typename> class OptimizerType>
 void SoftmaxRegression<OptimizerType>::Predict(const arma::mat& testData,
                                                arma::vec& predictions)
 {
-  // Calculate the probabilities for each test input.
-  arma::mat hypothesis, probabilities;
+  // Calculate the class scores for each test input.  The softmax is monotonic,
+  // so the most probable class of a point is the one with the highest score,
+  // and no exponentials (which could overflow) are needed.
+  arma::mat scores;
   if (fitIntercept)
   {
     // In order to add the intercept term, we should compute following matrix:
     //     [1; data] = arma::join_cols(ones(1, data.n_cols), data)
-    //     hypothesis = arma::exp(parameters * [1; data]).
+    //     scores = parameters * [1; data].
     //
     // Since the cost of join maybe high due to the copy of original data,
-    // split the hypothesis computation to two components.
-    hypothesis = arma::exp(
-        arma::repmat(parameters.col(0), 1, testData.n_cols) +
-        parameters.cols(1, parameters.n_cols - 1) * testData);
+    // split the computation to two components.
+    scores = parameters.cols(1, parameters.n_cols - 1) * testData;
+    scores.each_col() += parameters.col(0);
   }
   else
   {
-    hypothesis = arma::exp(parameters * testData);
+    scores = parameters * testData;
   }
 
-  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
-                                            numClasses, 1);
-
-  // Prepare necessary data.
-  predictions.zeros(testData.n_cols);
-  double maxProbability = 0;
-
-  // For each test input.
-  for(size_t i = 0; i < testData.n_cols; i++)
+  // For each test input, predict the class with the highest score.
+  predictions.set_size(testData.n_cols);
+  for (size_t i = 0; i < testData.n_cols; i++)
   {
-    // For each class.
-    for(size_t j = 0; j < numClasses; j++)
-    {
-      // If a higher class probability is encountered, change prediction.
-      if(probabilities(j, i) > maxProbability)
-      {
-        maxProbability = probabilities(j, i);
-        predictions(i) = j;
-      }
-    }
-
-    // Set maximum probability to zero for the next input.
-    maxProbability = 0;
+    arma::uword maxIndex = 0;
+    scores.unsafe_col(i).max(maxIndex);
+    predictions(i) = maxIndex;
   }
 }
 
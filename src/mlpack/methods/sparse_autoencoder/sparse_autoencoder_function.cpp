@@ -77,73 +77,38 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   // 'm' is the number of training examples.
   // The cost also takes into account the regularization and KL divergence terms
   // to control the parameter weights and sparsity of the model respectively.
-
-  // Compute the limits for the parameters w1, w2, b1 and b2.
-  const size_t l1 = hiddenSize;
-  const size_t l2 = visibleSize;
-  const size_t l3 = 2 * hiddenSize;
-
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
-  // w1 <- parameters.submat(0, 0, l1-1, l2-1)
-  // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
-  // b1 <- parameters.submat(0, l2, l1-1, l2)
-  // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
-
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
-
-  arma::mat rhoCap, diff;
-
-  // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
-
-  double wL2SquaredNorm;
-
-  // Calculate squared L2-norms of w1 and w2.
-  wL2SquaredNorm = arma::accu(parameters.submat(0, 0, l3 - 1, l2 - 1) %
-      parameters.submat(0, 0, l3 - 1, l2 - 1));
-
-  double sumOfSquaresError, weightDecay, klDivergence, cost;
-
-  // Calculate the reconstruction error, the regularization cost and the KL
-  // divergence cost terms. 'sumOfSquaresError' is the average squared l2-norm
-  // of the reconstructed data difference. 'weightDecay' is the squared l2-norm
-  // of the weights w1 and w2. 'klDivergence' is the cost of the hidden layer
-  // activations not being low. It is given by the following formula:
-  // KL = sum_over_hSize(rho*log(rho/rhoCaq) + (1-rho)*log((1-rho)/(1-rhoCap)))
-  sumOfSquaresError = 0.5 * arma::accu(diff % diff) / data.n_cols;
-  weightDecay = 0.5 * lambda * wL2SquaredNorm;
-  klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) + (1 - rho) *
-      arma::log((1 - rho) / (1 - rhoCap)));
-
-  // The cost is the sum of the terms calculated above.
-  cost = sumOfSquaresError + weightDecay + klDivergence;
-
-  return cost;
+  return Objective(parameters, NULL);
 }
 
 /** Calculates and stores the gradient values given a set of parameters.
   */
 void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
                                          arma::mat& gradient) const
+{
+  Objective(parameters, &gradient);
+}
+
+/** Evaluates the objective function and calculates the gradient values given a
+  * set of parameters, with a single feedforward pass.
+  */
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  return Objective(parameters, &gradient);
+}
+
+/** Evaluates the objective function, and the gradient if it is given, with a
+  * single pass over the data, in parallel blocks of points.
+  */
+double SparseAutoencoderFunction::Objective(const arma::mat& parameters,
+                                            arma::mat* gradient) const
 {
   // Performs a feedforward pass of the neural network, and computes the
-  // activations of the output layer as in the Evaluate() method. It uses the
-  // Backpropagation algorithm to calculate the delta values at each layer,
-  // except for the input layer. The delta values are then used with input layer
-  // and hidden layer activations to get the parameter gradients.
+  // activations of the output layer. It uses the Backpropagation algorithm to
+  // calculate the delta values at each layer, except for the input layer. The
+  // delta values are then used with input layer and hidden layer activations
+  // to get the parameter gradients.
 
   // Compute the limits for the parameters w1, w2, b1 and b2.
   const size_t l1 = hiddenSize;
@@ -157,49 +122,145 @@ void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
   // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
   // b1 <- parameters.submat(0, l2, l1-1, l2)
   // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
-
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
-
-  arma::mat rhoCap, diff;
-
-  // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
-
-  arma::mat klDivGrad, delOut, delHid;
+  const arma::mat w1 = parameters.submat(0, 0, l1 - 1, l2 - 1);
+  const arma::mat w2t = parameters.submat(l1, 0, l3 - 1, l2 - 1);
+  const arma::vec b1 = parameters.submat(0, l2, l1 - 1, l2);
+  const arma::vec b2 = arma::trans(parameters.submat(l3, 0, l3, l2 - 1));
 
   // The delta vector for the output layer is given by diff * f'(z), where z is
   // the preactivation and f is the activation function. The derivative of the
   // sigmoid function turns out to be f(z) * (1 - f(z)). For every other layer
   // in the neural network which comes before the output layer, the delta values
   // are given del_n = w_n' * del_(n+1) * f'(z_n). Since our cost function also
-  // includes the KL divergence term, we adjust for that in the formula below.
-  klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) / (1 - rhoCap));
-  delOut = diff % outputLayer % (1 - outputLayer);
-  delHid = (parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut +
-      arma::repmat(klDivGrad, 1, data.n_cols)) % hiddenLayer %
-      (1 - hiddenLayer);
-
-  gradient.zeros(2 * hiddenSize + 1, visibleSize + 1);
-
-  // Compute the gradient values using the activations and the delta values. The
-  // formula also accounts for the regularization terms in the objective.
-  // function.
-  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.t() / data.n_cols +
-      lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
-  gradient.submat(l1, 0, l3 - 1, l2 - 1) =
-      (delOut * hiddenLayer.t() / data.n_cols +
-      lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1).t()).t();
-  gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
-  gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
+  // includes the KL divergence term, the hidden deltas also have a term
+  // klDivGrad % f'(z_n), where klDivGrad depends on the average activations of
+  // the whole dataset.  That term is accumulated separately (as f'(z_n) * data'
+  // and the sum of f'(z_n)) and scaled by klDivGrad at the end, so one pass
+  // over the data is enough.
+  double sumOfSquares = 0.0;
+  arma::vec hiddenSum = arma::zeros<arma::vec>(l1);
+  arma::mat w1Gradient, w2tGradient, sparsityGradient;
+  arma::vec b1Gradient, b2Gradient, sparsitySum;
+  if (gradient)
+  {
+    w1Gradient.zeros(l1, l2);
+    w2tGradient.zeros(l1, l2);
+    sparsityGradient.zeros(l1, l2);
+    b1Gradient.zeros(l1);
+    b2Gradient.zeros(l2);
+    sparsitySum.zeros(l1);
+  }
+
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+  #pragma omp parallel
+  {
+    double threadSumOfSquares = 0.0;
+    arma::vec threadHiddenSum = arma::zeros<arma::vec>(l1);
+    arma::mat threadW1Gradient, threadW2tGradient, threadSparsityGradient;
+    arma::vec threadB1Gradient, threadB2Gradient, threadSparsitySum;
+    if (gradient)
+    {
+      threadW1Gradient.zeros(l1, l2);
+      threadW2tGradient.zeros(l1, l2);
+      threadSparsityGradient.zeros(l1, l2);
+      threadB1Gradient.zeros(l1);
+      threadB2Gradient.zeros(l2);
+      threadSparsitySum.zeros(l1);
+    }
+
+    arma::mat hiddenLayer, outputLayer, diff, delOut, hiddenDerivative, delHid;
+
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+    {
+      const size_t begin = b * BlockSize;
+      const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols);
+
+      // An alias of the columns of the block, to avoid copying them.
+      const arma::mat block(const_cast<double*>(data.colptr(begin)),
+          data.n_rows, end - begin, false, true);
+
+      // Compute activations of the hidden and output layers.
+      hiddenLayer = w1 * block;
+      hiddenLayer.each_col() += b1;
+      Sigmoid(hiddenLayer, hiddenLayer);
+
+      outputLayer = arma::trans(w2t) * hiddenLayer;
+      outputLayer.each_col() += b2;
+      Sigmoid(outputLayer, outputLayer);
+
+      // Difference between the reconstructed data and the original data.
+      diff = outputLayer - block;
+      threadSumOfSquares += arma::accu(diff % diff);
+      threadHiddenSum += arma::sum(hiddenLayer, 1);
+
+      if (!gradient)
+        continue;
+
+      delOut = diff % outputLayer % (1 - outputLayer);
+      hiddenDerivative = hiddenLayer % (1 - hiddenLayer);
+      delHid = (w2t * delOut) % hiddenDerivative;
+
+      threadW1Gradient += delHid * block.t();
+      threadW2tGradient += hiddenLayer * delOut.t();
+      threadSparsityGradient += hiddenDerivative * block.t();
+      threadB1Gradient += arma::sum(delHid, 1);
+      threadB2Gradient += arma::sum(delOut, 1);
+      threadSparsitySum += arma::sum(hiddenDerivative, 1);
+    }
+
+    #pragma omp critical(sparse_autoencoder_objective)
+    {
+      sumOfSquares += threadSumOfSquares;
+      hiddenSum += threadHiddenSum;
+      if (gradient)
+      {
+        w1Gradient += threadW1Gradient;
+        w2tGradient += threadW2tGradient;
+        sparsityGradient += threadSparsityGradient;
+        b1Gradient += threadB1Gradient;
+        b2Gradient += threadB2Gradient;
+        sparsitySum += threadSparsitySum;
+      }
+    }
+  }
+
+  // Average activations of the hidden layer.
+  const arma::vec rhoCap = hiddenSum / data.n_cols;
+
+  // Calculate the reconstruction error, the regularization cost and the KL
+  // divergence cost terms. 'sumOfSquaresError' is the average squared l2-norm
+  // of the reconstructed data difference. 'weightDecay' is the squared l2-norm
+  // of the weights w1 and w2. 'klDivergence' is the cost of the hidden layer
+  // activations not being low. It is given by the following formula:
+  // KL = sum_over_hSize(rho*log(rho/rhoCaq) + (1-rho)*log((1-rho)/(1-rhoCap)))
+  const double wL2SquaredNorm = arma::accu(w1 % w1) + arma::accu(w2t % w2t);
+  const double sumOfSquaresError = 0.5 * sumOfSquares / data.n_cols;
+  const double weightDecay = 0.5 * lambda * wL2SquaredNorm;
+  const double klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) +
+      (1 - rho) * arma::log((1 - rho) / (1 - rhoCap)));
+
+  if (gradient)
+  {
+    const arma::vec klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) /
+        (1 - rhoCap));
+
+    // Compute the gradient values using the activations and the delta values.
+    // The formula also accounts for the regularization terms in the objective.
+    // function.
+    sparsityGradient.each_col() %= klDivGrad;
+    gradient->zeros(2 * hiddenSize + 1, visibleSize + 1);
+    gradient->submat(0, 0, l1 - 1, l2 - 1) = (w1Gradient + sparsityGradient) /
+        data.n_cols + lambda * w1;
+    gradient->submat(l1, 0, l3 - 1, l2 - 1) = w2tGradient / data.n_cols +
+        lambda * w2t;
+    gradient->submat(0, l2, l1 - 1, l2) = (b1Gradient + klDivGrad %
+        sparsitySum) / data.n_cols;
+    gradient->submat(l3, 0, l3, l2 - 1) = arma::trans(b2Gradient) /
+        data.n_cols;
+  }
+
+  // The cost is the sum of the terms calculated above.
+  return sumOfSquaresError + weightDecay + klDivergence;
 }
@@ -17,6 +17,11 @@ namespace nn {
  * This is a class for the sparse autoencoder objective function. It can be used
  * to create learning models like self-taught learning, stacked autoencoders,
  * conditional random fields (CRFs), and so forth.
+ *
+ * The objective and its gradient are computed with one pass over the data, a
+ * block of points at a time, in parallel.  Only the activations of a block are
+ * held at once, so the memory used besides the data is O(hiddenSize *
+ * visibleSize) per thread, however many points there are.
  */
 class SparseAutoencoderFunction
 {
@@ -65,6 +70,35 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the objective function and stores its gradient, sharing a single
+   * feedforward pass between the two.  Optimizers such as L-BFGS use this
+   * instead of separate calls to Evaluate() and Gradient().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param gradient Matrix where gradient values will be stored.
+   * @return The objective function.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
+  /**
+   * The objective is only computed over the whole dataset, so for stochastic
+   * optimizers such as SGD or Adam the function is treated as a single
+   * function; those optimizers then take full-batch steps.
+   */
+  size_t NumFunctions() const { return 1; }
+
+  //! Evaluate the objective; i is ignored since there is only one function.
+  double Evaluate(const arma::mat& parameters, const size_t /* i */) const
+  { return Evaluate(parameters); }
+
+  //! Evaluate the gradient; i is ignored since there is only one function.
+  void Gradient(const arma::mat& parameters,
+                const size_t /* i */,
+                arma::mat& gradient) const
+  { Gradient(parameters, gradient); }
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -140,6 +174,17 @@ class SparseAutoencoderFunction
   }
 
  private:
+  //! Number of points whose activations are computed at once.
+  static const size_t BlockSize = 256;
+
+  /**
+   * Evaluate the objective function, and its gradient if it is given, with one
+   * pass over the data.  The data is split into blocks of points, which are
+   * processed in parallel; every thread accumulates the terms of its blocks,
+   * and those are reduced at the end.
+   */
+  double Objective(const arma::mat& parameters, arma::mat* gradient) const;
+
   //! The matrix of data points.
   const arma::mat& data;
   //! Intial parameter vector.
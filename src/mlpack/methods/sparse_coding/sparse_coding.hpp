@@ -47,6 +47,14 @@ namespace sparse_coding {
  * using LARS, an algorithm that can solve the LASSO or the Elastic Net (papers
  * below).
  *
+ * If BlockCoordinate() is set, the dictionary learning step instead updates
+ * one atom at a time with the others fixed, as in online dictionary learning
+ * (Mairal et al., below).  This only needs the sufficient statistics Z Z^T
+ * and X Z^T, which are accumulated over the points in parallel, and no
+ * atoms-by-atoms linear systems.  EncodeOnline() uses the same update to learn
+ * the dictionary from random mini-batches of points, so that large datasets
+ * need no full passes.
+ *
  * Here are those papers:
  *
  * @code
@@ -63,6 +71,17 @@ namespace sparse_coding {
  * @endcode
  *
  * @code
+ * @article{mairal2010online,
+ *   title={Online learning for matrix factorization and sparse coding},
+ *   author={Mairal, J. and Bach, F. and Ponce, J. and Sapiro, G.},
+ *   journal={Journal of Machine Learning Research},
+ *   volume={11},
+ *   pages={19--60},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * @code
  * @article{efron2004least,
  *   title={Least angle regression},
  *   author={Efron, B. and Hastie, T. and Johnstone, I. and Tibshirani, R.},
@@ -132,6 +151,20 @@ class SparseCoding
               const double objTolerance = 0.01,
               const double newtonTolerance = 1e-6);
 
+  /**
+   * Learn the dictionary from random mini-batches of points, without coding
+   * the whole dataset: each iteration codes one mini-batch with the current
+   * dictionary, adds its sufficient statistics to those of the previous
+   * mini-batches, and updates every atom once by block coordinate descent.
+   * The points are visited in a random order, reshuffled after each pass.
+   * Codes() isn't updated; call OptimizeCode() afterwards if the codes of the
+   * whole dataset are needed.
+   *
+   * @param batchSize Number of points in each mini-batch.
+   * @param maxIterations Number of mini-batches to learn from.
+   */
+  void EncodeOnline(const size_t batchSize, const size_t maxIterations);
+
   /**
    * Sparse code each point via LARS.
    */
@@ -153,6 +186,16 @@ class SparseCoding
                             const double newtonTolerance = 1e-6,
                             const size_t maxIterations = 50);
 
+  /**
+   * Learn the dictionary via block coordinate descent: each atom in turn is
+   * set to its optimal value with the other atoms fixed, and projected onto
+   * the unit ball.  Atoms not used by the current codes are re-initialized
+   * randomly.
+   *
+   * @param passes Number of passes over the atoms.
+   */
+  void OptimizeDictionaryBlockCoordinate(const size_t passes = 1);
+
   /**
    * Project each atom of the dictionary back onto the unit ball, if necessary.
    */
@@ -176,6 +219,11 @@ class SparseCoding
   //! Modify the sparse codes.
   arma::mat& Codes() { return codes; }
 
+  //! Get whether or not Encode() uses block coordinate dictionary steps.
+  bool BlockCoordinate() const { return blockCoordinate; }
+  //! Modify whether or not Encode() uses block coordinate dictionary steps.
+  bool& BlockCoordinate() { return blockCoordinate; }
+
   // Returns a string representation of this object.
   std::string ToString() const;
 
@@ -197,6 +245,34 @@ class SparseCoding
 
   //! l2 regularization term.
   double lambda2;
+
+  //! Whether or not Encode() uses block coordinate dictionary steps.
+  bool blockCoordinate;
+
+  //! Sparse code the given points with the current dictionary via LARS.
+  void CodePoints(const arma::mat& points, arma::mat& pointCodes) const;
+
+  /**
+   * Add the sufficient statistics of the given points and their codes, Z Z^T
+   * and X Z^T, to codesZT and dataZT.  The points are split among the
+   * threads, each of which accumulates its own statistics over the nonzero
+   * codes only.
+   */
+  void AccumulateStatistics(const arma::mat& points,
+                            const arma::mat& pointCodes,
+                            arma::mat& codesZT,
+                            arma::mat& dataZT) const;
+
+  /**
+   * Update each atom in turn, given the sufficient statistics.  Atoms with no
+   * statistics (never used) are left as they are.
+   */
+  void UpdateAtoms(const arma::mat& codesZT,
+                   const arma::mat& dataZT,
+                   const size_t passes);
+
+  //! Re-initialize the given atom from random points.
+  void ReinitializeAtom(const size_t atom);
 };
 
 }; // namespace sparse_coding
@@ -23,7 +23,8 @@ SparseCoding<DictionaryInitializer>::SparseCoding(const arma::mat& data,
     data(data),
     codes(atoms, data.n_cols),
     lambda1(lambda1),
-    lambda2(lambda2)
+    lambda2(lambda2),
+    blockCoordinate(false)
 {
   // Initialize the dictionary.
   DictionaryInitializer::Initialize(data, atoms, dictionary);
@@ -60,7 +61,10 @@ void SparseCoding<DictionaryInitializer>::Encode(const size_t maxIterations,
 
     // First step: optimize the dictionary.
     Log::Info << "Performing dictionary step... " << std::endl;
-    OptimizeDictionary(adjacencies, newtonTolerance);
+    if (blockCoordinate)
+      OptimizeDictionaryBlockCoordinate();
+    else
+      OptimizeDictionary(adjacencies, newtonTolerance);
     Log::Info << "  Objective value: " << Objective() << "." << std::endl;
 
     // Second step: perform the coding.
@@ -91,28 +95,70 @@ void SparseCoding<DictionaryInitializer>::Encode(const size_t maxIterations,
   Timer::Stop("sparse_coding");
 }
 
+template<typename DictionaryInitializer>
+void SparseCoding<DictionaryInitializer>::EncodeOnline(
+    const size_t batchSize,
+    const size_t maxIterations)
+{
+  Timer::Start("sparse_coding");
+
+  const size_t size = std::min(std::max(batchSize, (size_t) 1),
+      (size_t) data.n_cols);
+
+  // The statistics of all the mini-batches seen so far.
+  arma::mat codesZT(atoms, atoms, arma::fill::zeros);
+  arma::mat dataZT(data.n_rows, atoms, arma::fill::zeros);
+
+  arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+      data.n_cols - 1, data.n_cols));
+  size_t position = 0;
+
+  arma::mat batch(data.n_rows, size);
+  arma::mat batchCodes;
+  for (size_t t = 0; t < maxIterations; ++t)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (position == data.n_cols)
+      {
+        order = arma::shuffle(order);
+        position = 0;
+      }
+
+      batch.col(i) = data.col(order[position++]);
+    }
+
+    CodePoints(batch, batchCodes);
+    AccumulateStatistics(batch, batchCodes, codesZT, dataZT);
+    UpdateAtoms(codesZT, dataZT, 1);
+
+    Log::Debug << "Mini-batch " << t << ": sparsity level " << 100.0 *
+        ((double) arma::accu(batchCodes != 0)) / ((double) batchCodes.n_elem)
+        << "%." << std::endl;
+  }
+
+  Timer::Stop("sparse_coding");
+}
+
 template<typename DictionaryInitializer>
 void SparseCoding<DictionaryInitializer>::OptimizeCode()
+{
+  CodePoints(data, codes);
+}
+
+template<typename DictionaryInitializer>
+void SparseCoding<DictionaryInitializer>::CodePoints(
+    const arma::mat& points,
+    arma::mat& pointCodes) const
 {
   // When using the Cholesky version of LARS, this is correct even if
   // lambda2 > 0.
   arma::mat matGram = trans(dictionary) * dictionary;
 
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    // Report progress.
-    if ((i % 100) == 0)
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-
-    bool useCholesky = true;
-    regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
-
-    // Create an alias of the code (using the same memory), and then LARS will
-    // place the result directly into that; then we will not need to have an
-    // extra copy.
-    arma::vec code = codes.unsafe_col(i);
-    lars.Regress(dictionary, data.unsafe_col(i), code, false);
-  }
+  // All the points are coded at once with the same Gram matrix, in parallel.
+  bool useCholesky = true;
+  regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
+  lars.Regress(dictionary, points, pointCodes, false);
 }
 
 // Dictionary step for optimization.
@@ -279,11 +325,7 @@ double SparseCoding<DictionaryInitializer>::OptimizeDictionary(
       if (inactiveAtoms[currentInactiveIndex] == i)
       {
         // This atom is inactive.  Reinitialize it randomly.
-        dictionary.col(i) = (data.col(math::RandInt(data.n_cols)) +
-                             data.col(math::RandInt(data.n_cols)) +
-                             data.col(math::RandInt(data.n_cols)));
-
-        dictionary.col(i) /= arma::norm(dictionary.col(i), 2);
+        ReinitializeAtom(i);
 
         // Increment inactive index counter.
         ++currentInactiveIndex;
@@ -299,6 +341,106 @@ double SparseCoding<DictionaryInitializer>::OptimizeDictionary(
   return normGradient;
 }
 
+template<typename DictionaryInitializer>
+void SparseCoding<DictionaryInitializer>::OptimizeDictionaryBlockCoordinate(
+    const size_t passes)
+{
+  arma::mat codesZT(atoms, atoms, arma::fill::zeros);
+  arma::mat dataZT(data.n_rows, atoms, arma::fill::zeros);
+  AccumulateStatistics(data, codes, codesZT, dataZT);
+
+  UpdateAtoms(codesZT, dataZT, passes);
+
+  // Handle the case of inactive atoms (atoms not used in the given coding).
+  size_t nInactiveAtoms = 0;
+  for (size_t j = 0; j < atoms; ++j)
+  {
+    if (codesZT(j, j) == 0.0)
+    {
+      ReinitializeAtom(j);
+      ++nInactiveAtoms;
+    }
+  }
+
+  if (nInactiveAtoms > 0)
+  {
+    Log::Warn << "There are " << nInactiveAtoms
+        << " inactive atoms. They will be re-initialized randomly.\n";
+  }
+}
+
+template<typename DictionaryInitializer>
+void SparseCoding<DictionaryInitializer>::AccumulateStatistics(
+    const arma::mat& points,
+    const arma::mat& pointCodes,
+    arma::mat& codesZT,
+    arma::mat& dataZT) const
+{
+  #pragma omp parallel
+  {
+    arma::mat localCodesZT(atoms, atoms, arma::fill::zeros);
+    arma::mat localDataZT(points.n_rows, atoms, arma::fill::zeros);
+    std::vector<size_t> nonzero;
+
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      // The codes are sparse, so only their nonzero entries contribute.
+      nonzero.clear();
+      for (size_t j = 0; j < atoms; ++j)
+        if (pointCodes(j, i) != 0.0)
+          nonzero.push_back(j);
+
+      for (size_t a = 0; a < nonzero.size(); ++a)
+      {
+        const double code = pointCodes(nonzero[a], i);
+        for (size_t b = 0; b < nonzero.size(); ++b)
+          localCodesZT(nonzero[b], nonzero[a]) += code *
+              pointCodes(nonzero[b], i);
+        localDataZT.col(nonzero[a]) += code * points.col(i);
+      }
+    }
+
+    #pragma omp critical
+    {
+      codesZT += localCodesZT;
+      dataZT += localDataZT;
+    }
+  }
+}
+
+template<typename DictionaryInitializer>
+void SparseCoding<DictionaryInitializer>::UpdateAtoms(
+    const arma::mat& codesZT,
+    const arma::mat& dataZT,
+    const size_t passes)
+{
+  for (size_t pass = 0; pass < passes; ++pass)
+  {
+    for (size_t j = 0; j < atoms; ++j)
+    {
+      if (codesZT(j, j) == 0.0)
+        continue;
+
+      // The minimizer in atom j, with the other atoms fixed, projected onto
+      // the unit ball.
+      const arma::vec atom = dictionary.col(j) + (dataZT.col(j) -
+          dictionary * codesZT.col(j)) / codesZT(j, j);
+      dictionary.col(j) = atom / std::max(arma::norm(atom, 2), 1.0);
+    }
+  }
+}
+
+template<typename DictionaryInitializer>
+void SparseCoding<DictionaryInitializer>::ReinitializeAtom(const size_t atom)
+{
+  dictionary.col(atom) = (data.col(math::RandInt(data.n_cols)) +
+                          data.col(math::RandInt(data.n_cols)) +
+                          data.col(math::RandInt(data.n_cols)));
+
+  dictionary.col(atom) /= arma::norm(dictionary.col(atom), 2);
+}
+
 // Project each atom of the dictionary back into the unit ball (if necessary).
 template<typename DictionaryInitializer>
 void SparseCoding<DictionaryInitializer>::ProjectDictionary()
@@ -34,7 +34,13 @@ PROGRAM_INFO("Sparse Coding", "An implementation of Sparse Coding with "
     "\n\n"
     "The maximum number of iterations may be specified with the -n option. "
     "Optionally, the input data matrix X can be normalized before coding with "
-    "the -N option.");
+    "the -N option."
+    "\n\n"
+    "With --block_coordinate, the dictionary step updates one atom at a time "
+    "instead of using Newton's method, which is much cheaper for large "
+    "dictionaries.  With --batch_size, the dictionary is instead learned online"
+    " from -n random mini-batches of that many points (-n must then be given), "
+    "and the whole dataset is only coded once at the end.");
 
 PARAM_STRING_REQ("input_file", "Filename of the input data.", "i");
 PARAM_INT_REQ("atoms", "Number of atoms in the dictionary.", "k");
@@ -64,6 +70,10 @@ PARAM_DOUBLE("objective_tolerance", "Tolerance for convergence of the objective"
     " function.", "o", 0.01);
 PARAM_DOUBLE("newton_tolerance", "Tolerance for convergence of Newton method.",
     "w", 1e-6);
+PARAM_FLAG("block_coordinate", "Update the dictionary one atom at a time "
+    "instead of with Newton's method.", "B");
+PARAM_INT("batch_size", "If specified, learn the dictionary online from "
+    "mini-batches of this many points.", "b", 0);
 
 using namespace arma;
 using namespace std;
@@ -71,6 +81,26 @@ using namespace mlpack;
 using namespace mlpack::math;
 using namespace mlpack::sparse_coding;
 
+// Run sparse coding with the options given on the command line.
+template<typename SparseCodingType>
+void RunSparseCoding(SparseCodingType& sc,
+                     const size_t maxIterations,
+                     const double objTolerance,
+                     const double newtonTolerance)
+{
+  if (CLI::GetParam<int>("batch_size") > 0)
+  {
+    // Learn the dictionary online, then code every point once.
+    sc.EncodeOnline((size_t) CLI::GetParam<int>("batch_size"), maxIterations);
+    sc.OptimizeCode();
+  }
+  else
+  {
+    sc.BlockCoordinate() = CLI::HasParam("block_coordinate");
+    sc.Encode(maxIterations, objTolerance, newtonTolerance);
+  }
+}
+
 int main(int argc, char* argv[])
 {
   CLI::ParseCommandLine(argc, argv);
@@ -97,6 +127,17 @@ int main(int argc, char* argv[])
   const double objTolerance = CLI::GetParam<double>("objective_tolerance");
   const double newtonTolerance = CLI::GetParam<double>("newton_tolerance");
 
+  if (CLI::GetParam<int>("batch_size") < 0)
+  {
+    Log::Fatal << "Invalid batch size: " << CLI::GetParam<int>("batch_size")
+        << ".  Must be greater than or equal to 0." << endl;
+  }
+  if (CLI::GetParam<int>("batch_size") > 0 && maxIterations == 0)
+  {
+    Log::Fatal << "--max_iterations must be specified with --batch_size."
+        << endl;
+  }
+
   mat matX;
   data::Load(inputFile, matX, true);
 
@@ -135,7 +176,7 @@ int main(int argc, char* argv[])
     }
 
     // Run sparse coding.
-    sc.Encode(maxIterations, objTolerance, newtonTolerance);
+    RunSparseCoding(sc, maxIterations, objTolerance, newtonTolerance);
 
     // Save the results.
     Log::Info << "Saving dictionary matrix to '" << dictionaryFile << "'.\n";
@@ -149,7 +190,7 @@ int main(int argc, char* argv[])
     SparseCoding<> sc(matX, atoms, lambda1, lambda2);
 
     // Run sparse coding.
-    sc.Encode(maxIterations, objTolerance, newtonTolerance);
+    RunSparseCoding(sc, maxIterations, objTolerance, newtonTolerance);
 
     // Save the results.
     Log::Info << "Saving dictionary matrix to '" << dictionaryFile << "'.\n";
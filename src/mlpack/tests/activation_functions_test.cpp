@@ -11,12 +11,15 @@
 #include <mlpack/methods/ann/activation_functions/softsign_function.hpp>
 #include <mlpack/methods/ann/activation_functions/tanh_function.hpp>
 #include <mlpack/methods/ann/activation_functions/rectifier_function.hpp>
+#include <mlpack/methods/ann/activation_functions/fast_tanh_function.hpp>
+#include <mlpack/methods/ann/activation_functions/fast_logistic_function.hpp>
 
 #include <mlpack/methods/ann/ffnn.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
 #include <mlpack/methods/ann/layer/neuron_layer.hpp>
 #include <mlpack/methods/ann/layer/bias_layer.hpp>
 #include <mlpack/methods/ann/layer/multiclass_classification_layer.hpp>
+#include <mlpack/methods/ann/layer/softmax_layer.hpp>
 #include <mlpack/methods/ann/connections/full_connection.hpp>
 #include <mlpack/methods/ann/connections/self_connection.hpp>
 #include <mlpack/methods/ann/optimizer/irpropp.hpp>
@@ -198,6 +201,70 @@ BOOST_AUTO_TEST_CASE(RectifierFunctionTest)
       desiredDerivatives);
 }
 
+/*
+ * Implementation of the approximation test, which checks that the fast
+ * approximation stays within the given absolute error of the exact function.
+ *
+ * @param input Input data used for evaluating the activation functions.
+ * @param tolerance Maximum absolute error of the approximation.
+ *
+ * @tparam FastActivationFunction Approximation used for the check.
+ * @tparam ActivationFunction Exact activation function used as reference.
+ */
+template<class FastActivationFunction, class ActivationFunction>
+void CheckApproximationCorrect(const arma::colvec input, const double tolerance)
+{
+  // Test the approximation using a single value as input.
+  for (size_t i = 0; i < input.n_elem; i++)
+  {
+    BOOST_REQUIRE_SMALL(FastActivationFunction::fn(input.at(i)) -
+        ActivationFunction::fn(input.at(i)), tolerance);
+  }
+
+  // Test the approximation using the entire vector as input.
+  arma::colvec activations, desiredActivations;
+  FastActivationFunction::fn(input, activations);
+  ActivationFunction::fn(input, desiredActivations);
+  for (size_t i = 0; i < input.n_elem; i++)
+  {
+    BOOST_REQUIRE_SMALL(activations.at(i) - desiredActivations.at(i),
+        tolerance);
+  }
+}
+
+/**
+ * Test the fast approximation of the tanh function against the exact function.
+ */
+BOOST_AUTO_TEST_CASE(FastTanhFunctionTest)
+{
+  const arma::colvec input = arma::linspace<arma::colvec>(-10, 10, 2001);
+  CheckApproximationCorrect<FastTanhFunction, TanhFunction>(input, 1e-4);
+  CheckApproximationCorrect<FastTanhFunction, TanhFunction>(activationData,
+      1e-4);
+
+  const arma::colvec desiredActivations("-0.96402758 0.9966824 0.99975321 -1 \
+                                         0.76159416 -0.76159416 0.96402758 0");
+
+  const arma::colvec desiredDerivatives("0.07065082 0.00662419 0.00049352 0 \
+                                         0.41997434 0.41997434 0.07065082 1");
+
+  CheckDerivativeCorrect<FastTanhFunction>(desiredActivations,
+      desiredDerivatives);
+}
+
+/**
+ * Test the fast approximation of the logistic function against the exact
+ * function.
+ */
+BOOST_AUTO_TEST_CASE(FastLogisticFunctionTest)
+{
+  const arma::colvec input = arma::linspace<arma::colvec>(-20, 20, 2001);
+  CheckApproximationCorrect<FastLogisticFunction, LogisticFunction>(input,
+      5e-5);
+  CheckApproximationCorrect<FastLogisticFunction, LogisticFunction>(
+      activationData, 5e-5);
+}
+
 /*
  * Implementation of the numerical gradient checking.
  *
@@ -356,6 +423,37 @@ void CheckGradientNumericallyCorrect(const arma::colvec input,
  * g(\theta) \approx \frac{J(\theta + eps) - J(\theta - eps)}{2 * eps}
  * @f]
  */
+/**
+ * Make sure the softmax layer normalizes every column of a batch, without
+ * overflowing for large inputs, and that it can work in place.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxLayerTest)
+{
+  arma::mat input("1 1000 -3;"
+                  "2 1001 -3;"
+                  "3 1002 -3");
+
+  SoftmaxLayer<> layer(3);
+  arma::mat output;
+  layer.FeedForward(input, output);
+
+  const double norm = 1 + std::exp(1.0) + std::exp(2.0);
+  for (size_t j = 0; j < 2; j++)
+  {
+    BOOST_REQUIRE_CLOSE(output(0, j), 1 / norm, 1e-5);
+    BOOST_REQUIRE_CLOSE(output(1, j), std::exp(1.0) / norm, 1e-5);
+    BOOST_REQUIRE_CLOSE(output(2, j), std::exp(2.0) / norm, 1e-5);
+  }
+
+  for (size_t i = 0; i < 3; i++)
+    BOOST_REQUIRE_CLOSE(output(i, 2), 1.0 / 3.0, 1e-5);
+
+  // In place.
+  layer.FeedForward(input, input);
+  for (size_t i = 0; i < input.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(input(i), output(i), 1e-5);
+}
+
 BOOST_AUTO_TEST_CASE(GradientNumericallyCorrect)
 {
   // Initialize dataset.
@@ -744,4 +744,51 @@ BOOST_AUTO_TEST_CASE(ClassifyTest_IRIS)
   BOOST_REQUIRE(lError <= 0.30);
 }
 
+/**
+ *  With a single boosting round, the strong classifier must predict the same
+ *  labels as its weak learner, both with the batched votes of Perceptron weak
+ *  learners and the per-learner votes of DecisionStump weak learners.
+ */
+BOOST_AUTO_TEST_CASE(SingleRoundClassifyTest)
+{
+  arma::mat inputData;
+
+  if (!data::Load("iris.txt", inputData))
+    BOOST_FAIL("Cannot load test dataset iris.txt!");
+
+  arma::Mat<size_t> labels;
+
+  if (!data::Load("iris_labels.txt",labels))
+    BOOST_FAIL("Cannot load labels for iris iris_labels.txt");
+
+  // The first weak learner is trained with equal weights.
+  arma::rowvec weights(inputData.n_cols);
+  weights.fill(1.0 / inputData.n_cols);
+
+  perceptron::Perceptron<> p(inputData, labels.row(0), 400);
+  perceptron::Perceptron<> p1(p, inputData, weights, labels.row(0));
+  AdaBoost<> a(inputData, labels.row(0), 1, 1e-10, p);
+
+  arma::Row<size_t> weakPredictions, predictedLabels;
+  p1.Classify(inputData, weakPredictions);
+  a.Classify(inputData, predictedLabels);
+
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, inputData.n_cols);
+  for (size_t i = 0; i < predictedLabels.n_elem; i++)
+    BOOST_REQUIRE_EQUAL(predictedLabels(i), weakPredictions(i));
+
+  decision_stump::DecisionStump<> ds(inputData, labels.row(0), 3, 6);
+  decision_stump::DecisionStump<> ds1(ds, inputData, weights, labels.row(0));
+  AdaBoost<arma::mat, mlpack::decision_stump::DecisionStump<> > b(inputData,
+      labels.row(0), 1, 1e-10, ds);
+
+  weakPredictions.set_size(inputData.n_cols);
+  ds1.Classify(inputData, weakPredictions);
+  b.Classify(inputData, predictedLabels);
+
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, inputData.n_cols);
+  for (size_t i = 0; i < predictedLabels.n_elem; i++)
+    BOOST_REQUIRE_EQUAL(predictedLabels(i), weakPredictions(i));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
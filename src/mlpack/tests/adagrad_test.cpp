@@ -0,0 +1,94 @@
+/**
+ * @file adagrad_test.cpp
+ * @author Ryan Curtin
+ *
+ * Test file for the AdaGrad optimizer.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/adagrad/adagrad.hpp>
+#include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
+using namespace mlpack::distribution;
+
+BOOST_AUTO_TEST_SUITE(AdaGradTest);
+
+BOOST_AUTO_TEST_CASE(SimpleAdaGradTestFunction)
+{
+  SGDTestFunction f;
+  AdaGrad<SGDTestFunction> s(f, 0.01, 1e-8, 5000000, 1e-9, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+/**
+ * The first step of AdaGrad moves each parameter by the step size in the
+ * direction opposite its gradient (up to epsilon), whatever the gradient's
+ * magnitude.
+ */
+BOOST_AUTO_TEST_CASE(AdaGradFirstStepTest)
+{
+  GeneralizedRosenbrockFunction f(10);
+  AdaGrad<GeneralizedRosenbrockFunction> s(f, 0.1, 1e-8, 2, 1e-9, false);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  arma::mat gradient;
+  f.Gradient(coordinates, 0, gradient);
+  s.Optimize(coordinates);
+
+  for (size_t i = 0; i < coordinates.n_elem; ++i)
+  {
+    const double initial = f.GetInitialPoint()[i];
+    if (gradient[i] == 0.0)
+      BOOST_REQUIRE_CLOSE(coordinates[i], initial, 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(coordinates[i], initial - 0.1 *
+          (gradient[i] > 0 ? 1.0 : -1.0), 1e-5);
+  }
+}
+
+/**
+ * Train logistic regression through its OptimizerType template parameter.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionAdaGradTest)
+{
+  // Generate a two-Gaussian dataset.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::vec responses(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegression<AdaGrad> lr(data, responses, 0.5);
+
+  // Ensure that the error is close to zero.
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,104 @@
+/**
+ * @file adam_test.cpp
+ * @author Ryan Curtin
+ *
+ * Test file for the Adam optimizer.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+#include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
+using namespace mlpack::distribution;
+
+BOOST_AUTO_TEST_SUITE(AdamTest);
+
+BOOST_AUTO_TEST_CASE(SimpleAdamTestFunction)
+{
+  SGDTestFunction f;
+  Adam<SGDTestFunction> s(f, 0.01, 0.9, 0.999, 1e-8, 5000000, 1e-9, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+/**
+ * Create a two-Gaussian dataset with the given means, labelling the points of
+ * the first Gaussian 0 and those of the second 1.
+ */
+void CreateGaussianDataset(const arma::vec& mean1,
+                           const arma::vec& mean2,
+                           arma::mat& data,
+                           arma::vec& labels)
+{
+  GaussianDistribution g1(mean1, arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(mean2, arma::eye<arma::mat>(3, 3));
+
+  data.set_size(3, 1000);
+  labels.set_size(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    labels[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    labels[i] = 1;
+  }
+}
+
+/**
+ * Train logistic regression through its OptimizerType template parameter.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionAdamTest)
+{
+  arma::mat data;
+  arma::vec responses;
+  CreateGaussianDataset(arma::vec("1.0 1.0 1.0"), arma::vec("9.0 9.0 9.0"),
+      data, responses);
+
+  LogisticRegression<Adam> lr(data, responses, 0.5);
+
+  // Ensure that the error is close to zero.
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+/**
+ * Softmax regression is not decomposable, so Adam takes full-batch steps; it
+ * should still separate two Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionAdamTest)
+{
+  arma::mat data;
+  arma::vec labels;
+  // There is no intercept term, so the Gaussians must be separable by a plane
+  // through the origin.
+  CreateGaussianDataset(arma::vec("1.0 9.0 1.0"), arma::vec("4.0 3.0 4.0"),
+      data, labels);
+
+  SoftmaxRegressionFunction srf(data, labels, 3, 2, 0.0001);
+  Adam<SoftmaxRegressionFunction> adam(srf, 0.01, 0.9, 0.999, 1e-8, 5000,
+      1e-10);
+  SoftmaxRegression<Adam> sr(adam);
+
+  const double acc = sr.ComputeAccuracy(data, labels);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
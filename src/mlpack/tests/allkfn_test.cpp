@@ -569,4 +569,37 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
   }
 }
 
+/**
+ * Make sure that approximate furthest neighbor search with epsilon > 0 returns,
+ * for every rank, a distance that is within a factor of (1 + epsilon) of the
+ * exact one.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateEpsilonTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 1000);
+  const double epsilon = 0.3;
+
+  AllkFN naive(dataset, true);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    AllkFN allkfn(dataset, false, (mode == 1));
+    allkfn.Epsilon() = epsilon;
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    allkfn.Search(5, neighbors, distances);
+
+    for (size_t i = 0; i < distances.n_elem; ++i)
+    {
+      BOOST_REQUIRE_LE(distances[i], naiveDistances[i] + 1e-10);
+      BOOST_REQUIRE_GE(distances[i] * (1 + epsilon), naiveDistances[i] -
+          1e-10);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
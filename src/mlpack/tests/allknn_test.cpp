@@ -4,10 +4,16 @@
  * Test file for AllkNN class.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/batch_scheduler.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/quantized_allknn.hpp>
+#include <mlpack/methods/neighbor_search/search_advisor.hpp>
+#include <mlpack/methods/neighbor_search/sparse_neighbor_search.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/vantage_point_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -95,6 +101,47 @@ BOOST_AUTO_TEST_CASE(DualTreeUnmapTest)
     BOOST_REQUIRE_EQUAL(neighborsOut[i], correctNeighbors[i]);
     BOOST_REQUIRE_CLOSE(distancesOut[i], sqrt(correctDistances[i]), 1e-5);
   }
+
+  // The in-place unmapping must give the same results.
+  arma::Mat<size_t> neighborsInPlace(neighbors);
+  arma::mat distancesInPlace(distances);
+  Unmap(neighborsInPlace, distancesInPlace, refMap, queryMap, true);
+
+  for (size_t i = 0; i < correctNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsInPlace[i], correctNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distancesInPlace[i], sqrt(correctDistances[i]), 1e-5);
+  }
+}
+
+/**
+ * Make sure the in-place query unmapping follows every cycle of a random
+ * permutation correctly.
+ */
+BOOST_AUTO_TEST_CASE(InPlaceUnmapQueriesTest)
+{
+  const size_t queries = 1000;
+  arma::Col<size_t> permutation = arma::shuffle(
+      arma::linspace<arma::Col<size_t> >(0, queries - 1, queries));
+  std::vector<size_t> queryMap(permutation.begin(), permutation.end());
+
+  arma::Mat<size_t> neighbors(3, queries);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    neighbors[i] = i;
+  arma::mat distances(3, queries, arma::fill::randu);
+
+  arma::Mat<size_t> neighborsInPlace(neighbors);
+  arma::mat distancesInPlace(distances);
+  UnmapQueries(neighborsInPlace, distancesInPlace, queryMap);
+
+  for (size_t i = 0; i < queries; ++i)
+  {
+    for (size_t j = 0; j < 3; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighborsInPlace(j, queryMap[i]), neighbors(j, i));
+      BOOST_REQUIRE_EQUAL(distancesInPlace(j, queryMap[i]), distances(j, i));
+    }
+  }
 }
 
 /**
@@ -158,6 +205,15 @@ BOOST_AUTO_TEST_CASE(SingleTreeUnmapTest)
     BOOST_REQUIRE_EQUAL(neighborsOut[i], correctNeighbors[i]);
     BOOST_REQUIRE_CLOSE(distancesOut[i], sqrt(correctDistances[i]), 1e-5);
   }
+
+  // The in-place unmapping must give the same results.
+  Unmap(neighbors, distances, refMap, true);
+
+  for (size_t i = 0; i < correctNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], correctNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], sqrt(correctDistances[i]), 1e-5);
+  }
 }
 
 /**
@@ -573,6 +629,99 @@ BOOST_AUTO_TEST_CASE(SingleTreeVsNaive)
   }
 }
 
+/**
+ * Make sure that building the reference tree in-place on the caller's matrix
+ * (without a copy) gives the same results as naive search, and that the
+ * returned mapping describes how the matrix was reordered.
+ */
+BOOST_AUTO_TEST_CASE(InPlaceConstructionTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 1000);
+  arma::mat original(dataset);
+
+  std::vector<size_t> oldFromNew;
+  AllkNN allknn(dataset, oldFromNew);
+  AllkNN naive(original, true);
+
+  // The tree should have been built on the caller's matrix.
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), original.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    for (size_t d = 0; d < dataset.n_rows; ++d)
+      BOOST_REQUIRE_CLOSE(dataset(d, i), original(d, oldFromNew[i]), 1e-5);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(10, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Test the task-parallel dual-tree traverser against the naive method, with a
+ * dataset large enough that the query tree is split into several tasks.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 4000);
+
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, TreeType,
+      TreeType::ParallelDualTreeTraverser> allknn(dataset);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(10, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(10, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
+/**
+ * Test bichromatic single-tree search (which is parallelized across query
+ * points when OpenMP is available) against the naive method, with more query
+ * points than one thread would be handed at a time.
+ */
+BOOST_AUTO_TEST_CASE(SingleTreeBichromaticVsNaive)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 800);
+  arma::mat queryData = arma::randu<arma::mat>(5, 500);
+
+  AllkNN allknn(referenceData, false, true);
+  AllkNN naive(referenceData, true);
+
+  arma::Mat<size_t> neighborsTree;
+  arma::mat distancesTree;
+  allknn.Search(queryData, 10, neighborsTree, distancesTree);
+
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(queryData, 10, neighborsNaive, distancesNaive);
+
+  BOOST_REQUIRE_EQUAL(neighborsTree.n_cols, queryData.n_cols);
+  for (size_t i = 0; i < neighborsTree.n_elem; i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+    BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+  }
+}
+
 /**
  * Test the cover tree single-tree nearest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -645,6 +794,108 @@ BOOST_AUTO_TEST_CASE(DualCoverTreeTest)
   }
 }
 
+/**
+ * Test the task-parallel cover tree dual-tree traverser against the naive
+ * method, with a dataset large enough that the query tree is split into
+ * several tasks.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualCoverTreeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 4000);
+
+  typedef CoverTree<LMetric<2, true>, FirstPointIsRoot,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  TreeType referenceTree(dataset);
+
+  NeighborSearch<NearestNeighborSort, LMetric<2, true>, TreeType,
+      TreeType::ParallelDualTreeTraverser> coverTreeSearch(&referenceTree);
+  AllkNN naive(dataset, true);
+
+  arma::Mat<size_t> coverNeighbors;
+  arma::mat coverDistances;
+  coverTreeSearch.Search(5, coverNeighbors, coverDistances);
+
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  for (size_t i = 0; i < coverNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(coverNeighbors(i), naiveNeighbors(i));
+    BOOST_REQUIRE_CLOSE(coverDistances(i), naiveDistances(i), 1e-5);
+  }
+}
+
+/**
+ * Test the vantage point tree single-tree nearest-neighbors method against the
+ * naive method.
+ */
+BOOST_AUTO_TEST_CASE(SingleVantagePointTreeTest)
+{
+  arma::mat data;
+  data.randu(10, 1000);
+
+  typedef VantagePointTree<LMetric<2, true>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  TreeType tree(data);
+
+  NeighborSearch<NearestNeighborSort, LMetric<2, true>, TreeType>
+      vpTreeSearch(&tree, true);
+
+  AllkNN naive(data, true);
+
+  arma::Mat<size_t> vpTreeNeighbors;
+  arma::mat vpTreeDistances;
+  vpTreeSearch.Search(15, vpTreeNeighbors, vpTreeDistances);
+
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(15, naiveNeighbors, naiveDistances);
+
+  for (size_t i = 0; i < vpTreeNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(vpTreeNeighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(vpTreeDistances[i], naiveDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Test the vantage point tree dual-tree nearest neighbors method against the
+ * kd-tree, with a few different leaf sizes.
+ */
+BOOST_AUTO_TEST_CASE(DualVantagePointTreeTest)
+{
+  arma::mat dataset;
+  data::Load("test_data_3_1000.csv", dataset);
+
+  AllkNN tree(dataset);
+
+  arma::Mat<size_t> kdNeighbors;
+  arma::mat kdDistances;
+  tree.Search(dataset, 5, kdNeighbors, kdDistances);
+
+  typedef VantagePointTree<LMetric<2, true>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+
+  for (size_t leafSize = 1; leafSize <= 40; leafSize *= 5)
+  {
+    TreeType referenceTree(dataset, leafSize);
+
+    NeighborSearch<NearestNeighborSort, LMetric<2, true>, TreeType>
+        vpTreeSearch(&referenceTree);
+
+    arma::Mat<size_t> vpNeighbors;
+    arma::mat vpDistances;
+    vpTreeSearch.Search(&referenceTree, 5, vpNeighbors, vpDistances);
+
+    for (size_t i = 0; i < vpNeighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(vpNeighbors(i), kdNeighbors(i));
+      BOOST_REQUIRE_CLOSE(vpDistances(i), kdDistances(i), 1e-5);
+    }
+  }
+}
+
 /**
  * Test the ball tree single-tree nearest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -756,6 +1007,356 @@ BOOST_AUTO_TEST_CASE(SparseAllkNNKDTreeTest)
   }
 }
 
+/**
+ * Make sure that the heaps used for large k give the exact sorted neighbor
+ * lists, for the dual-tree, single-tree and naive searches.
+ */
+BOOST_AUTO_TEST_CASE(LargeKHeapTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 300);
+  arma::mat querySet = arma::randu<arma::mat>(3, 50);
+  const size_t k = 2 * NeighborHeap<NearestNeighborSort>::MinHeapSize;
+
+  // Compute the true neighbors by sorting all distances.
+  arma::Mat<size_t> trueNeighbors(k, querySet.n_cols);
+  arma::mat trueDistances(k, querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    arma::vec allDistances(dataset.n_cols);
+    for (size_t j = 0; j < dataset.n_cols; ++j)
+      allDistances[j] = EuclideanDistance::Evaluate(querySet.col(i),
+          dataset.col(j));
+
+    const arma::uvec order = arma::sort_index(allDistances);
+    for (size_t j = 0; j < k; ++j)
+    {
+      trueNeighbors(j, i) = order[j];
+      trueDistances(j, i) = allDistances[order[j]];
+    }
+  }
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    AllkNN allknn(dataset, mode == 0, mode == 1);
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    allknn.Search(querySet, k, neighbors, distances);
+
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors[i], trueNeighbors[i]);
+      BOOST_REQUIRE_CLOSE(distances[i], trueDistances[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that the blocked base cases of NeighborSearchRules give exactly
+ * the same neighbor lists as one BaseCase() call for every pair, even with
+ * duplicate points.
+ */
+template<typename SortPolicy, typename MetricType>
+void CheckBaseCaseBlock()
+{
+  typedef BinarySpaceTree<HRectBound<2>, NeighborSearchStat<SortPolicy> >
+      TreeType;
+  typedef NeighborSearchRules<SortPolicy, MetricType, TreeType> RuleType;
+
+  arma::mat querySet = arma::randu<arma::mat>(6, 60);
+  arma::mat referenceSet = arma::randu<arma::mat>(6, 100);
+  referenceSet.cols(50, 59) = referenceSet.cols(0, 9);
+  querySet.cols(0, 4) = referenceSet.cols(20, 24);
+
+  arma::Mat<size_t> pairNeighbors(5, querySet.n_cols);
+  arma::mat pairDistances(5, querySet.n_cols);
+  pairNeighbors.fill(size_t() - 1);
+  pairDistances.fill(SortPolicy::WorstDistance());
+  arma::Mat<size_t> blockNeighbors(pairNeighbors);
+  arma::mat blockDistances(pairDistances);
+
+  MetricType metric;
+  RuleType pairRules(referenceSet, querySet, pairNeighbors, pairDistances,
+      metric);
+  RuleType blockRules(referenceSet, querySet, blockNeighbors, blockDistances,
+      metric);
+
+  // Go through the points in blocks of uneven size.
+  for (size_t r = 0; r < referenceSet.n_cols; r += 13)
+  {
+    const size_t rEnd = std::min(r + 13, (size_t) referenceSet.n_cols);
+    for (size_t q = 0; q < querySet.n_cols; q += 7)
+    {
+      const size_t qEnd = std::min(q + 7, (size_t) querySet.n_cols);
+      for (size_t query = q; query < qEnd; ++query)
+        for (size_t ref = r; ref < rEnd; ++ref)
+          pairRules.BaseCase(query, ref);
+
+      BOOST_REQUIRE_EQUAL(blockRules.BaseCaseBlock(q, qEnd, r, rEnd),
+          (qEnd - q) * (rEnd - r));
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(blockRules.BaseCases(), pairRules.BaseCases());
+  for (size_t i = 0; i < pairNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(blockNeighbors[i], pairNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(blockDistances[i] + 1.0, pairDistances[i] + 1.0,
+        1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BaseCaseBlockTest)
+{
+  CheckBaseCaseBlock<NearestNeighborSort, EuclideanDistance>();
+  CheckBaseCaseBlock<NearestNeighborSort, SquaredEuclideanDistance>();
+  CheckBaseCaseBlock<FurthestNeighborSort, EuclideanDistance>();
+  CheckBaseCaseBlock<NearestNeighborSort, ManhattanDistance>();
+}
+
+/**
+ * Make sure that the best-first single-tree traverser gives the same results as
+ * the depth-first traverser, and that with a budget of leaves it visits at most
+ * that many leaves per query and still returns correct distances.
+ */
+BOOST_AUTO_TEST_CASE(BestFirstSingleTreeTraverserTest)
+{
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 2000);
+  arma::mat querySet = arma::randu<arma::mat>(4, 100);
+  TreeType tree(referenceSet, 10);
+
+  arma::Mat<size_t> depthNeighbors(5, querySet.n_cols);
+  arma::mat depthDistances(5, querySet.n_cols);
+  depthNeighbors.fill(size_t() - 1);
+  depthDistances.fill(NearestNeighborSort::WorstDistance());
+  arma::Mat<size_t> bestNeighbors(depthNeighbors);
+  arma::mat bestDistances(depthDistances);
+  arma::Mat<size_t> budgetNeighbors(depthNeighbors);
+  arma::mat budgetDistances(depthDistances);
+
+  EuclideanDistance metric;
+  RuleType depthRules(referenceSet, querySet, depthNeighbors, depthDistances,
+      metric);
+  RuleType bestRules(referenceSet, querySet, bestNeighbors, bestDistances,
+      metric);
+  RuleType budgetRules(referenceSet, querySet, budgetNeighbors,
+      budgetDistances, metric);
+
+  TreeType::SingleTreeTraverser<RuleType> depthTraverser(depthRules);
+  TreeType::BestFirstSingleTreeTraverser<RuleType> bestTraverser(bestRules);
+  TreeType::BestFirstSingleTreeTraverser<RuleType> budgetTraverser(
+      budgetRules, 2);
+
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    depthTraverser.Traverse(i, tree);
+    bestTraverser.Traverse(i, tree);
+    budgetTraverser.Traverse(i, tree);
+  }
+
+  // Without a budget, the results are exact.
+  BOOST_REQUIRE_EQUAL(bestTraverser.NumTruncated(), 0);
+  for (size_t i = 0; i < depthNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(bestNeighbors[i], depthNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(bestDistances[i], depthDistances[i], 1e-10);
+  }
+
+  // With a budget, at most two leaves are visited per query, and the neighbors
+  // found (if the leaves held enough points) are real neighbors.
+  BOOST_REQUIRE_LE(budgetTraverser.NumVisitedLeaves(), 2 * querySet.n_cols);
+  BOOST_REQUIRE_LT(budgetRules.BaseCases(), depthRules.BaseCases());
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    for (size_t j = 0; j < budgetNeighbors.n_rows; ++j)
+    {
+      if (budgetNeighbors(j, i) == size_t() - 1)
+        continue;
+
+      BOOST_REQUIRE_CLOSE(budgetDistances(j, i), metric.Evaluate(
+          querySet.col(i), referenceSet.col(budgetNeighbors(j, i))), 1e-10);
+      BOOST_REQUIRE_GE(budgetDistances(j, i), depthDistances(j, i));
+    }
+  }
+}
+
+/**
+ * Make sure that the search on a single precision kd-tree finds the same
+ * distances as the naive search on doubles, and that the search on a quantized
+ * reference set gives exactly the same results as the naive search while
+ * re-ranking only a part of the reference set.
+ */
+BOOST_AUTO_TEST_CASE(FloatAndQuantizedAllkNNTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 1500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 200);
+
+  AllkNN naive(referenceSet, true);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+
+  // Single precision, dual-tree and single-tree.
+  arma::fmat referenceFloat = arma::conv_to<arma::fmat>::from(referenceSet);
+  arma::fmat queryFloat = arma::conv_to<arma::fmat>::from(querySet);
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    FloatAllkNN allknn(referenceFloat, false, (mode == 1));
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    allknn.Search(queryFloat, 5, neighbors, distances);
+
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-3);
+  }
+
+  // Quantized reference set, with a query set and without.
+  QuantizedAllkNN quantized(referenceSet);
+  BOOST_REQUIRE_EQUAL(quantized.Codes().n_rows, referenceSet.n_rows);
+  BOOST_REQUIRE_EQUAL(quantized.Codes().n_cols, referenceSet.n_cols);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  quantized.Search(querySet, 5, neighbors, distances);
+  BOOST_REQUIRE_LT(quantized.ExactDistances(),
+      referenceSet.n_cols * querySet.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-10);
+  }
+
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  quantized.Search(5, neighbors, distances);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-10);
+  }
+}
+
+/**
+ * Make sure that the traversal profile records nothing unless it is enabled,
+ * and that it then records the same counts as AllkNN itself.
+ */
+BOOST_AUTO_TEST_CASE(TraversalProfileTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+
+  TraversalProfile::Reset();
+  AllkNN unprofiled(dataset);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  unprofiled.Search(5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(TraversalProfile::Statistics().size(), 0);
+
+  TraversalProfile::Enable();
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    TraversalProfile::Reset();
+    AllkNN allknn(dataset, false, (mode == 1));
+    allknn.Search(5, neighbors, distances);
+
+    std::map<std::string, TraversalStatistics> statistics =
+        TraversalProfile::Statistics();
+    BOOST_REQUIRE_EQUAL(statistics.size(), 1);
+    const TraversalStatistics& s = statistics["neighbor_search"];
+    BOOST_REQUIRE_GE(s.traversals, 1);
+    BOOST_REQUIRE_EQUAL(s.baseCases, allknn.BaseCases());
+    BOOST_REQUIRE_EQUAL(s.scores, allknn.Scores());
+    BOOST_REQUIRE_GT(s.prunes, 0);
+    BOOST_REQUIRE_LE(s.rescorePrunes, s.prunes);
+    if (mode == 0)
+      BOOST_REQUIRE_GT(s.visited, 0);
+  }
+
+  TraversalProfile::Enable(false);
+  TraversalProfile::Reset();
+}
+
+/**
+ * Make sure that approximate search with epsilon > 0 returns, for every rank,
+ * a distance that is within a factor of (1 + epsilon) of the exact one, in both
+ * single-tree and dual-tree mode and for kd-trees and cover trees.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateEpsilonTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(20, 1500);
+  const double epsilon = 0.5;
+
+  AllkNN naive(dataset, true);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  typedef CoverTree<LMetric<2, true>, FirstPointIsRoot,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  typedef NeighborSearch<NearestNeighborSort, LMetric<2, true>, TreeType>
+      CoverTreeAllkNN;
+
+  for (size_t mode = 0; mode < 4; ++mode)
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    if (mode < 2)
+    {
+      AllkNN allknn(dataset, false, (mode == 1));
+      allknn.Epsilon() = epsilon;
+      allknn.Search(5, neighbors, distances);
+    }
+    else
+    {
+      TreeType tree(dataset);
+      CoverTreeAllkNN allknn(&tree, (mode == 3));
+      allknn.Epsilon() = epsilon;
+      allknn.Search(5, neighbors, distances);
+    }
+
+    for (size_t i = 0; i < distances.n_elem; ++i)
+    {
+      BOOST_REQUIRE_GE(distances[i], naiveDistances[i] - 1e-10);
+      BOOST_REQUIRE_LE(distances[i], (1 + epsilon) * naiveDistances[i] +
+          1e-10);
+    }
+  }
+}
+
+/**
+ * Make sure that symmetric monochromatic search gives the same results as the
+ * regular dual-tree search while performing fewer base cases.
+ */
+BOOST_AUTO_TEST_CASE(SymmetricMonochromaticTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 3000);
+
+  for (size_t k = 5; k <= 25; k += 20)
+  {
+    AllkNN allknn(dataset);
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    allknn.Search(k, neighbors, distances);
+
+    AllkNN symmetricAllknn(dataset);
+    symmetricAllknn.Symmetric() = true;
+    arma::Mat<size_t> symmetricNeighbors;
+    arma::mat symmetricDistances;
+    symmetricAllknn.Search(k, symmetricNeighbors, symmetricDistances);
+
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(symmetricNeighbors[i], neighbors[i]);
+      BOOST_REQUIRE_CLOSE(symmetricDistances[i], distances[i], 1e-5);
+    }
+
+    BOOST_REQUIRE_LT(symmetricAllknn.BaseCases(), allknn.BaseCases());
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SparseAllkNNCoverTreeTest)
 {
@@ -795,4 +1396,347 @@ BOOST_AUTO_TEST_CASE(SparseAllkNNCoverTreeTest)
 }
 */
 
+/**
+ * Test that exact search with random projection trees gives the same results as
+ * naive search, in both single-tree and dual-tree mode.
+ */
+BOOST_AUTO_TEST_CASE(RPTreeVsNaive)
+{
+  arma::mat dataset = arma::randu<arma::mat>(20, 1000);
+
+  AllkNN naive(dataset, true);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    RPTreeAllkNN rpTree(dataset, false, (mode == 1));
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    rpTree.Search(5, neighbors, distances);
+
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+      BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that defeatist search returns real (but possibly worse) neighbors
+ * with fewer base cases than exact search, and that it is exact when the spill
+ * distance is large enough.
+ */
+BOOST_AUTO_TEST_CASE(DefeatistSearchTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(32, 2000);
+  EuclideanDistance metric;
+
+  RPTreeAllkNN exact(dataset, false, true);
+  arma::Mat<size_t> exactNeighbors;
+  arma::mat exactDistances;
+  exact.Search(3, exactNeighbors, exactDistances);
+
+  RPTreeAllkNN defeatist(dataset, false, true);
+  defeatist.Defeatist() = true;
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  defeatist.Search(3, neighbors, distances);
+
+  BOOST_REQUIRE_LT(defeatist.BaseCases(), exact.BaseCases());
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+      BOOST_REQUIRE_CLOSE(distances(j, i), metric.Evaluate(dataset.col(i),
+          dataset.col(neighbors(j, i))), 1e-5);
+      BOOST_REQUIRE_GE(distances(j, i), exactDistances(j, i) * (1 - 1e-10));
+    }
+  }
+
+  // With an unbounded spill distance, nothing is skipped.
+  defeatist.Spill() = DBL_MAX;
+  defeatist.Search(3, neighbors, distances);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], exactNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], exactDistances[i], 1e-5);
+  }
+}
+
+/**
+ * The intrinsic dimension of points on a plane in a higher-dimensional space
+ * must be estimated as about 2.
+ */
+BOOST_AUTO_TEST_CASE(IntrinsicDimensionTest)
+{
+  const arma::mat basis = arma::randn<arma::mat>(10, 2);
+  const arma::mat data = basis * arma::randu<arma::mat>(2, 2000);
+
+  AllkNN knn(data);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(10, neighbors, distances);
+
+  const double dimension = SearchAdvisor::EstimateDimension(distances);
+  BOOST_REQUIRE_GT(dimension, 1.5);
+  BOOST_REQUIRE_LT(dimension, 2.5);
+}
+
+/**
+ * On low-dimensional data the advisor must choose a tree, and it must report
+ * every candidate it tried.
+ */
+BOOST_AUTO_TEST_CASE(SearchAdvisorTest)
+{
+  const arma::mat data = arma::randu<arma::mat>(3, 5000);
+  const arma::mat queries = arma::randu<arma::mat>(3, 500);
+
+  SearchAdvisor advisor(5, 0.0, 1000);
+  advisor.LeafSizes() = std::vector<size_t>(1, 10);
+  advisor.LeafSizes().push_back(40);
+
+  advisor.Advise(data);
+  BOOST_REQUIRE_NE(advisor.Tree(), SearchAdvisor::NAIVE);
+  BOOST_REQUIRE_GT(advisor.IntrinsicDimension(), 2.0);
+  BOOST_REQUIRE_LT(advisor.IntrinsicDimension(), 4.0);
+
+  // Naive search, two leaf sizes and a cover tree, with both traversals.
+  BOOST_REQUIRE_EQUAL(advisor.Candidates().size(), 7);
+  BOOST_REQUIRE_CLOSE(advisor.Candidates()[0].estimatedCost, 5000.0 * 5000.0,
+      1e-10);
+  // The chosen candidate has the lowest estimated cost.
+  double lowest = advisor.Candidates()[0].estimatedCost;
+  for (size_t i = 1; i < advisor.Candidates().size(); ++i)
+  {
+    BOOST_REQUIRE_GT(advisor.Candidates()[i].baseCases, 0);
+    lowest = std::min(lowest, advisor.Candidates()[i].estimatedCost);
+  }
+  for (size_t i = 0; i < advisor.Candidates().size(); ++i)
+  {
+    const SearchAdvisor::Candidate& c = advisor.Candidates()[i];
+    if (c.estimatedCost == lowest)
+    {
+      BOOST_REQUIRE_EQUAL(advisor.Tree(), c.tree);
+      BOOST_REQUIRE_EQUAL(advisor.SingleMode(), c.singleMode);
+      break;
+    }
+  }
+
+  advisor.Advise(data, queries);
+  BOOST_REQUIRE_NE(advisor.Tree(), SearchAdvisor::NAIVE);
+  BOOST_REQUIRE_CLOSE(advisor.Candidates()[0].estimatedCost, 500.0 * 5000.0,
+      1e-10);
+  if (advisor.Tree() == SearchAdvisor::KD_TREE)
+    BOOST_REQUIRE(advisor.LeafSize() == 10 || advisor.LeafSize() == 40);
+}
+
+/**
+ * Compute the sorted distances of the k nearest neighbors of every query point
+ * with the given similarity by brute force.
+ */
+arma::mat SparseDistances(const arma::sp_mat& references,
+                          const arma::sp_mat& queries,
+                          const size_t k,
+                          const bool cosine,
+                          const bool sameSet)
+{
+  const arma::mat denseReferences(references);
+  const arma::mat denseQueries(queries);
+  arma::mat similarities = denseQueries.t() * denseReferences;
+  if (cosine)
+  {
+    for (size_t q = 0; q < similarities.n_rows; ++q)
+      for (size_t r = 0; r < similarities.n_cols; ++r)
+        similarities(q, r) /= arma::norm(denseQueries.col(q)) *
+            arma::norm(denseReferences.col(r));
+  }
+
+  arma::mat distances(k, queries.n_cols);
+  for (size_t q = 0; q < queries.n_cols; ++q)
+  {
+    arma::rowvec row = cosine ? arma::rowvec(1.0 - similarities.row(q)) :
+        arma::rowvec(-similarities.row(q));
+    if (sameSet)
+      row[q] = DBL_MAX;
+    row = arma::sort(row);
+    distances.col(q) = row.subvec(0, k - 1).t();
+  }
+
+  return distances;
+}
+
+/**
+ * Make sure the pruned search over the inverted index finds the same
+ * neighbors as a brute-force search, with fewer postings than the exhaustive
+ * search.
+ */
+BOOST_AUTO_TEST_CASE(SparseNeighborSearchCosineTest)
+{
+  arma::sp_mat references, queries;
+  references.sprandu(500, 400, 0.05);
+  queries.sprandu(500, 50, 0.05);
+
+  SparseNeighborSearch knn(references);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(queries, 10, neighbors, distances);
+  const size_t prunedPostings = knn.Postings();
+
+  const arma::mat exact = SparseDistances(references, queries, 10, true,
+      false);
+  for (size_t q = 0; q < queries.n_cols; ++q)
+  {
+    for (size_t i = 0; i < 10; ++i)
+    {
+      BOOST_REQUIRE_SMALL(distances(i, q) - exact(i, q), 1e-10);
+
+      const arma::vec query(queries.col(q));
+      const arma::vec reference(references.col(neighbors(i, q)));
+      const double norms = arma::norm(query) * arma::norm(reference);
+      const double cosine = (norms > 0.0) ?
+          arma::dot(query, reference) / norms : 0.0;
+      BOOST_REQUIRE_SMALL(distances(i, q) - (1.0 - cosine), 1e-10);
+    }
+  }
+
+  // The exhaustive search gives the same distances.
+  knn.Prune() = false;
+  arma::Mat<size_t> exhaustiveNeighbors;
+  arma::mat exhaustiveDistances;
+  knn.Search(queries, 10, exhaustiveNeighbors, exhaustiveDistances);
+  BOOST_REQUIRE_SMALL(arma::abs(exhaustiveDistances - distances).max(),
+      1e-10);
+  BOOST_REQUIRE_LE(prunedPostings, knn.Postings());
+
+  // Without a query set, no point is its own neighbor.
+  knn.Prune() = true;
+  knn.Search(10, neighbors, distances);
+  const arma::mat exactSelf = SparseDistances(references, references, 10,
+      true, true);
+  for (size_t q = 0; q < references.n_cols; ++q)
+  {
+    for (size_t i = 0; i < 10; ++i)
+    {
+      BOOST_REQUIRE_NE(neighbors(i, q), q);
+      BOOST_REQUIRE_SMALL(distances(i, q) - exactSelf(i, q), 1e-10);
+    }
+  }
+}
+
+/**
+ * With the inner product of points with negative values, the points that
+ * share no dimension with the query (similarity 0) must be ranked between the
+ * positive and the negative similarities.
+ */
+BOOST_AUTO_TEST_CASE(SparseNeighborSearchInnerProductTest)
+{
+  arma::sp_mat references, queries;
+  references.sprandn(200, 100, 0.03);
+  queries.sprandn(200, 20, 0.03);
+
+  SparseNeighborSearch knn(references, SparseNeighborSearch::INNER_PRODUCT);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(queries, 90, neighbors, distances);
+
+  const arma::mat exact = SparseDistances(references, queries, 90, false,
+      false);
+  BOOST_REQUIRE_SMALL(arma::abs(distances - exact).max(), 1e-10);
+
+  for (size_t q = 0; q < queries.n_cols; ++q)
+  {
+    for (size_t i = 0; i < 90; ++i)
+    {
+      BOOST_REQUIRE_SMALL(distances(i, q) + arma::dot(arma::vec(
+          queries.col(q)), arma::vec(references.col(neighbors(i, q)))),
+          1e-10);
+    }
+  }
+}
+
+/**
+ * Make sure that single queries answered in batches by the batch scheduler
+ * get the same neighbors as a search of the whole query set.
+ */
+BOOST_AUTO_TEST_CASE(BatchSchedulerSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 50);
+
+  AllkNN allknn(referenceData);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  allknn.Search(queryData, 4, neighbors, distances);
+
+  typedef util::NeighborBatchHandler<AllkNN> HandlerType;
+  HandlerType handler(allknn, 4);
+  util::BatchScheduler<HandlerType> scheduler(handler, 8, 0.01);
+
+  std::vector<std::future<util::NeighborResult> > results;
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+    results.push_back(scheduler.Submit(queryData.col(i)));
+
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+  {
+    const util::NeighborResult result = results[i].get();
+    for (size_t j = 0; j < 4; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(result.neighbors[j], neighbors(j, i));
+      BOOST_REQUIRE_CLOSE(result.distances[j], distances(j, i), 1e-5);
+    }
+  }
+
+  BOOST_REQUIRE_LT(scheduler.Batches(), queryData.n_cols);
+}
+
+/**
+ * Make sure that the automatic choice of traversal and the reuse of a query
+ * tree (with its mapping) give the same results as a plain dual-tree search.
+ */
+BOOST_AUTO_TEST_CASE(AutoModeAndQueryTreeReuseTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat smallQueries = arma::randu<arma::mat>(3, 20);
+  arma::mat largeQueries = arma::randu<arma::mat>(3, 200);
+
+  AllkNN dualTree(referenceData);
+  AllkNN automatic(referenceData);
+  automatic.AutoMode() = true;
+
+  arma::Mat<size_t> neighbors, autoNeighbors;
+  arma::mat distances, autoDistances;
+  for (size_t q = 0; q < 2; ++q)
+  {
+    const arma::mat& queries = (q == 0) ? smallQueries : largeQueries;
+    dualTree.Search(queries, 3, neighbors, distances);
+    automatic.Search(queries, 3, autoNeighbors, autoDistances);
+
+    BOOST_REQUIRE_EQUAL(arma::accu(autoNeighbors != neighbors), 0);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(autoDistances[i], distances[i], 1e-5);
+  }
+
+  // Search the large query set with one query tree, for several k.
+  arma::mat queryCopy(largeQueries);
+  std::vector<size_t> oldFromNewQueries;
+  typedef BinarySpaceTree<HRectBound<2>,
+      NeighborSearchStat<NearestNeighborSort> > TreeType;
+  TreeType queryTree(queryCopy, oldFromNewQueries);
+  for (size_t k = 1; k <= 4; ++k)
+  {
+    dualTree.Search(largeQueries, k, neighbors, distances);
+    dualTree.Search(&queryTree, oldFromNewQueries, k, autoNeighbors,
+        autoDistances);
+
+    BOOST_REQUIRE_EQUAL(arma::accu(autoNeighbors != neighbors), 0);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(autoDistances[i], distances[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -528,4 +528,38 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
 }
 */
 
+/**
+ * Make sure that the single-tree and dual-tree searches return the same results
+ * when the random seed is the same, even though the queries are processed in
+ * parallel.
+ */
+BOOST_AUTO_TEST_CASE(ReproducibleSearchTest)
+{
+  arma::mat refData;
+  arma::mat queryData;
+
+  data::Load("rann_test_r_3_900.csv", refData, true);
+  data::Load("rann_test_q_3_100.csv", queryData, true);
+
+  for (size_t singleMode = 0; singleMode < 2; ++singleMode)
+  {
+    arma::Mat<size_t> neighbors[2];
+    arma::mat distances[2];
+    for (size_t run = 0; run < 2; ++run)
+    {
+      math::RandomSeed(1234);
+      RASearch<> rann(refData, false, singleMode == 1, 5.0, 0.95, true, false,
+          5);
+      rann.Search(queryData, 3, neighbors[run], distances[run]);
+    }
+
+    BOOST_REQUIRE_EQUAL(neighbors[0].n_elem, neighbors[1].n_elem);
+    for (size_t i = 0; i < neighbors[0].n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors[0][i], neighbors[1][i]);
+      BOOST_REQUIRE_EQUAL(distances[0][i], distances[1][i]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
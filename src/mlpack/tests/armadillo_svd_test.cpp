@@ -1,5 +1,6 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/cf/svd_wrapper.hpp>
+#include <mlpack/methods/cf/randomized_svd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -48,5 +49,67 @@ BOOST_AUTO_TEST_CASE(ArmadilloSVDLowRankFactorizationTest)
   BOOST_REQUIRE_LT(result, 0.01);
 }
 
+/**
+ * Make sure the randomized SVD of a sparse low-rank matrix is exact.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedSVDLowRankTest)
+{
+  sp_mat W_t, H_t;
+  W_t.sprandu(200, 4, 0.3);
+  H_t.sprandu(4, 150, 0.3);
+  // Make sure the rank is 4.
+  for (size_t i = 0; i < 4; ++i)
+  {
+    W_t(i, i) = 10.0;
+    H_t(i, i) = 10.0;
+  }
+
+  const sp_mat test = W_t * H_t;
+
+  RandomizedSVD svd;
+  mat U, Q;
+  vec sigma;
+  svd.Apply(test, 4, U, sigma, Q);
+
+  mat denseU, denseQ;
+  vec denseSigma;
+  arma::svd(denseU, denseSigma, denseQ, mat(test));
+
+  BOOST_REQUIRE_EQUAL(sigma.n_elem, 4);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_CLOSE(sigma[i], denseSigma[i], 1e-6);
+
+  mat W, H;
+  const double result = svd.Apply(test, 4, W, H);
+  BOOST_REQUIRE_SMALL(result, 1e-6);
+  BOOST_REQUIRE_SMALL(norm(mat(test) - W * H, "fro") / norm(mat(test), "fro"),
+      1e-6);
+}
+
+/**
+ * Make sure the error of the randomized SVD of a sparse matrix is close to the
+ * error of the exact truncated SVD.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedSVDSparseTest)
+{
+  sp_mat test;
+  test.sprandu(200, 150, 0.1);
+
+  RandomizedSVD svd;
+  mat W, H;
+  const double result = svd.Apply(test, 5, W, H);
+
+  SVDWrapper<> denseSVD;
+  mat denseW, denseH;
+  const double denseResult = denseSVD.Apply(mat(test), 5, denseW, denseH);
+
+  BOOST_REQUIRE_EQUAL(W.n_rows, 200);
+  BOOST_REQUIRE_EQUAL(W.n_cols, 5);
+  BOOST_REQUIRE_EQUAL(H.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(H.n_cols, 150);
+  BOOST_REQUIRE_CLOSE(result, norm(mat(test) - W * H, "fro") /
+      norm(mat(test), "fro"), 1e-5);
+  BOOST_REQUIRE_LE(result, 1.02 * denseResult);
+}
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -39,6 +39,34 @@ BOOST_AUTO_TEST_CASE(AugLagrangianTestFunctionTest)
   BOOST_REQUIRE_CLOSE(coords[1], 4.0, 1e-5);
 }
 
+/**
+ * The Augmented Lagrangian optimizer should find the same solution whether or
+ * not the L-BFGS subproblems are warm-started, and the constraints should then
+ * be satisfied.
+ */
+BOOST_AUTO_TEST_CASE(AugLagrangianWarmStartTest)
+{
+  AugLagrangianTestFunction f;
+  AugLagrangian<AugLagrangianTestFunction> warm(f);
+  AugLagrangian<AugLagrangianTestFunction> cold(f);
+  cold.WarmStart() = false;
+  BOOST_REQUIRE(warm.WarmStart());
+  BOOST_REQUIRE(!cold.WarmStart());
+
+  arma::vec warmCoords = f.GetInitialPoint();
+  arma::vec coldCoords = f.GetInitialPoint();
+  if (!warm.Optimize(warmCoords, 0) || !cold.Optimize(coldCoords, 0))
+    BOOST_FAIL("Optimization reported failure.");
+
+  // The warm start setting of L-BFGS is restored.
+  BOOST_REQUIRE(!warm.LBFGS().WarmStart());
+
+  BOOST_REQUIRE_CLOSE(warmCoords[0], coldCoords[0], 1e-4);
+  BOOST_REQUIRE_CLOSE(warmCoords[1], coldCoords[1], 1e-4);
+  BOOST_REQUIRE_CLOSE(f.Evaluate(warmCoords), 70.0, 1e-5);
+  BOOST_REQUIRE_SMALL(warm.Penalty(warmCoords), 1e-8);
+}
+
 /**
  * Tests the Augmented Lagrangian optimizer using the Gockenbach function.
  */
@@ -61,5 +89,26 @@ BOOST_AUTO_TEST_CASE(GockenbachFunctionTest)
   BOOST_REQUIRE_CLOSE(coords[2], 0.015099932, 1e-3);
 }
 
+/**
+ * The fused EvaluateWithGradient() of the augmented Lagrangian must agree with
+ * separate calls to Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(AugLagrangianFunctionEvaluateWithGradient)
+{
+  GockenbachFunction f;
+  arma::vec lambda("1.5 -0.5");
+  AugLagrangianFunction<GockenbachFunction> alf(f, lambda, 5.0);
+
+  arma::mat coordinates("2.0; -1.5; 0.5");
+  arma::mat gradient(3, 1), fusedGradient(3, 1);
+  alf.Gradient(coordinates, gradient);
+  const double objective = alf.EvaluateWithGradient(coordinates,
+      fusedGradient);
+
+  BOOST_REQUIRE_CLOSE(objective, alf.Evaluate(coordinates), 1e-5);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -0,0 +1,258 @@
+/**
+ * @file blocked_amf_test.cpp
+ * @author Ryan Curtin
+ *
+ * Tests for the out-of-core factorization of blocked matrices.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/amf/amf.hpp>
+#include <mlpack/methods/amf/blocked_amf.hpp>
+#include <mlpack/methods/amf/update_rules/svd_parallel_incremental_learning.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::amf;
+
+BOOST_AUTO_TEST_SUITE(BlockedAMFTest);
+
+/**
+ * Return the coordinate list of the given sparse matrix, in the order of its
+ * iterator.
+ */
+arma::mat CoordinateList(const arma::sp_mat& data)
+{
+  arma::mat triples(3, data.n_nonzero);
+  size_t k = 0;
+  for (arma::sp_mat::const_iterator it = data.begin(); it != data.end();
+       ++it, ++k)
+  {
+    triples(0, k) = it.row();
+    triples(1, k) = it.col();
+    triples(2, k) = *it;
+  }
+
+  return triples;
+}
+
+/**
+ * Assemble the matrix from its blocks.
+ */
+arma::mat Assemble(const BlockedMatrix& blocked)
+{
+  arma::mat result(blocked.NumRows(), blocked.NumCols(), arma::fill::zeros);
+  arma::umat locations;
+  arma::vec values;
+  for (size_t i = 0; i < blocked.RowBlocks(); ++i)
+  {
+    for (size_t j = 0; j < blocked.ColBlocks(); ++j)
+    {
+      blocked.LoadBlock(i, j, locations, values);
+      BOOST_REQUIRE_EQUAL(values.n_elem, blocked.NonZeros(i, j));
+      for (size_t k = 0; k < values.n_elem; ++k)
+      {
+        BOOST_REQUIRE_LT(locations(0, k), blocked.RowBlockSize(i));
+        BOOST_REQUIRE_LT(locations(1, k), blocked.ColBlockSize(j));
+        result(blocked.RowBlockBegin(i) + locations(0, k),
+            blocked.ColBlockBegin(j) + locations(1, k)) = values[k];
+      }
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Make sure the blocks hold the values of the matrix, for a matrix built with
+ * Insert(), opened again from its metadata, and partitioned from a file.
+ */
+BOOST_AUTO_TEST_CASE(BlockedMatrixTest)
+{
+  arma::sp_mat data;
+  data.sprandu(100, 80, 0.1);
+  const arma::mat triples = CoordinateList(data);
+  const arma::mat dense(data);
+
+  {
+    BlockedMatrix blocked("blocked_amf_test_", 100, 80, 3, 4);
+    blocked.Insert(triples.cols(0, triples.n_cols / 2));
+    blocked.Insert(triples.cols(triples.n_cols / 2 + 1, triples.n_cols - 1));
+    blocked.Flush();
+
+    BOOST_REQUIRE_EQUAL(blocked.NonZeros(), data.n_nonzero);
+    BOOST_REQUIRE_EQUAL(blocked.RowBlockBegin(3), 100);
+    BOOST_REQUIRE_EQUAL(blocked.ColBlockBegin(4), 80);
+    BOOST_REQUIRE_SMALL(arma::abs(Assemble(blocked) - dense).max(), 1e-15);
+  }
+
+  BlockedMatrix reopened("blocked_amf_test_");
+  BOOST_REQUIRE_EQUAL(reopened.NumRows(), 100);
+  BOOST_REQUIRE_EQUAL(reopened.NumCols(), 80);
+  BOOST_REQUIRE_EQUAL(reopened.RowBlocks(), 3);
+  BOOST_REQUIRE_EQUAL(reopened.ColBlocks(), 4);
+  BOOST_REQUIRE_EQUAL(reopened.NonZeros(), data.n_nonzero);
+  BOOST_REQUIRE_SMALL(arma::abs(Assemble(reopened) - dense).max(), 1e-15);
+  reopened.Remove();
+
+  // Make sure the last row and column are there, so the size is the same.
+  arma::mat fileTriples = triples;
+  fileTriples.insert_cols(0, arma::vec("99 79 1.0"));
+  arma::mat fileDense = dense;
+  fileDense(99, 79) = 1.0;
+  data::Save("blocked_amf_test.bin", fileTriples);
+
+  BlockedMatrix partitioned("blocked_amf_test.bin", "blocked_amf_test_", 2, 5,
+      100);
+  BOOST_REQUIRE_EQUAL(partitioned.NumRows(), 100);
+  BOOST_REQUIRE_EQUAL(partitioned.NumCols(), 80);
+  BOOST_REQUIRE_SMALL(arma::abs(Assemble(partitioned) - fileDense).max(),
+      1e-15);
+  partitioned.Remove();
+  remove("blocked_amf_test.bin");
+}
+
+/**
+ * Make sure an epoch of blocked SGD is the same as an epoch of
+ * SVDParallelIncrementalLearning with the same blocks.
+ */
+BOOST_AUTO_TEST_CASE(BlockedSGDEpochTest)
+{
+  arma::sp_mat data;
+  data.sprandu(90, 60, 0.2);
+
+  BlockedMatrix blocked("blocked_amf_test_", 90, 60, 3, 3);
+  blocked.Insert(CoordinateList(data));
+  blocked.Flush();
+
+  arma::mat w = arma::randu(90, 4);
+  arma::mat h = arma::randu(4, 60);
+  for (size_t i = 0; i < 3; ++i)
+    blocked.SaveW(i, w.rows(blocked.RowBlockBegin(i),
+        blocked.RowBlockBegin(i + 1) - 1));
+  for (size_t j = 0; j < 3; ++j)
+    blocked.SaveH(j, h.cols(blocked.ColBlockBegin(j),
+        blocked.ColBlockBegin(j + 1) - 1));
+
+  BlockedSGDUpdate update(0.01, 0.02, 0.03);
+  update.Update(blocked);
+
+  SVDParallelIncrementalLearning parallel(0.01, 0.02, 0.03, 3);
+  parallel.Initialize(data, 4);
+  parallel.WUpdate(data, w, h);
+  parallel.HUpdate(data, w, h);
+
+  arma::mat blockedW, blockedH;
+  blocked.LoadFactors(blockedW, blockedH);
+  BOOST_REQUIRE_SMALL(arma::abs(blockedW - w).max(), 1e-12);
+  BOOST_REQUIRE_SMALL(arma::abs(blockedH - h).max(), 1e-12);
+
+  blocked.Remove();
+}
+
+/**
+ * Make sure an iteration of blocked ALS solves the regularized least-squares
+ * problem of every row of W and then of every column of H.
+ */
+BOOST_AUTO_TEST_CASE(BlockedALSIterationTest)
+{
+  arma::sp_mat data;
+  data.sprandu(50, 40, 0.3);
+
+  BlockedMatrix blocked("blocked_amf_test_", 50, 40, 2, 3);
+  blocked.Insert(CoordinateList(data));
+  blocked.Flush();
+
+  arma::mat w = arma::randu(50, 3);
+  arma::mat h = arma::randu(3, 40);
+  for (size_t i = 0; i < 2; ++i)
+    blocked.SaveW(i, w.rows(blocked.RowBlockBegin(i),
+        blocked.RowBlockBegin(i + 1) - 1));
+  for (size_t j = 0; j < 3; ++j)
+    blocked.SaveH(j, h.cols(blocked.ColBlockBegin(j),
+        blocked.ColBlockBegin(j + 1) - 1));
+
+  BlockedALSUpdate update(0.1);
+  update.Update(blocked);
+
+  // Solve the same problems naively.
+  const arma::mat ridge = 0.1 * arma::eye<arma::mat>(3, 3);
+  for (size_t u = 0; u < 50; ++u)
+  {
+    arma::mat gram = ridge;
+    arma::vec rhs(3, arma::fill::zeros);
+    for (size_t v = 0; v < 40; ++v)
+    {
+      if (data(u, v) != 0.0)
+      {
+        gram += h.col(v) * h.col(v).t();
+        rhs += data(u, v) * h.col(v);
+      }
+    }
+    w.row(u) = arma::solve(gram, rhs).t();
+  }
+
+  for (size_t v = 0; v < 40; ++v)
+  {
+    arma::mat gram = ridge;
+    arma::vec rhs(3, arma::fill::zeros);
+    for (size_t u = 0; u < 50; ++u)
+    {
+      if (data(u, v) != 0.0)
+      {
+        gram += w.row(u).t() * w.row(u);
+        rhs += data(u, v) * w.row(u).t();
+      }
+    }
+    h.col(v) = arma::solve(gram, rhs);
+  }
+
+  arma::mat blockedW, blockedH;
+  blocked.LoadFactors(blockedW, blockedH);
+  BOOST_REQUIRE_SMALL(arma::abs(blockedW - w).max(), 1e-8);
+  BOOST_REQUIRE_SMALL(arma::abs(blockedH - h).max(), 1e-8);
+
+  blocked.Remove();
+}
+
+/**
+ * Make sure blocked ALS recovers a low-rank matrix from some of its values,
+ * and that the returned error is the error of the stored factors.
+ */
+BOOST_AUTO_TEST_CASE(BlockedALSConvergenceTest)
+{
+  const arma::mat low = arma::randu(120, 3) * arma::randu(3, 90);
+  arma::sp_mat mask;
+  mask.sprandu(120, 90, 0.5);
+
+  arma::sp_mat data(120, 90);
+  for (arma::sp_mat::const_iterator it = mask.begin(); it != mask.end(); ++it)
+    data(it.row(), it.col()) = low(it.row(), it.col());
+
+  BlockedMatrix blocked("blocked_amf_test_", 120, 90, 3, 2);
+  blocked.Insert(CoordinateList(data));
+
+  BlockedAMF<BlockedALSUpdate> amf(BlockedALSUpdate(1e-6), 200, 1e-10);
+  const double rmse = amf.Apply(blocked, 3);
+  BOOST_REQUIRE_LT(rmse, 1e-3);
+  BOOST_REQUIRE_GT(amf.Iteration(), 0);
+
+  arma::mat w, h;
+  blocked.LoadFactors(w, h);
+  BOOST_REQUIRE_EQUAL(w.n_rows, 120);
+  BOOST_REQUIRE_EQUAL(w.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(h.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(h.n_cols, 90);
+
+  double sum = 0.0;
+  for (arma::sp_mat::const_iterator it = data.begin(); it != data.end(); ++it)
+    sum += std::pow(*it - arma::dot(w.row(it.row()), h.col(it.col())), 2.0);
+  BOOST_REQUIRE_CLOSE(rmse, std::sqrt(sum / data.n_nonzero), 1e-5);
+
+  // The factors also predict the values that weren't given.
+  BOOST_REQUIRE_LT(arma::abs(w * h - low).max(), 0.1);
+
+  blocked.Remove();
+}
+
+BOOST_AUTO_TEST_SUITE_END();
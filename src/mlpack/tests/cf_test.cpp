@@ -318,4 +318,293 @@ BOOST_AUTO_TEST_CASE(CFBatchPredictTest)
   }
 }
 
+/**
+ * Make sure that the recommendations are the unrated items with the highest
+ * predicted ratings, in decreasing order.
+ */
+BOOST_AUTO_TEST_CASE(CFRecommendationsOrderTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLens100k.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF<>::CleanData(dataset, cleanedData);
+
+  CF<> c(cleanedData);
+
+  arma::Col<size_t> users(10);
+  for (size_t i = 0; i < users.n_elem; ++i)
+    users(i) = 7 * i;
+
+  arma::Mat<size_t> recommendations;
+  const size_t numRecs = 10;
+  c.GetRecommendations(numRecs, recommendations, users);
+
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    const size_t user = users(i);
+
+    // The recommendations are unrated and sorted by predicted rating.
+    for (size_t j = 0; j < numRecs; ++j)
+    {
+      BOOST_REQUIRE_EQUAL((double) c.CleanedData()(recommendations(j, i),
+          user), 0.0);
+      if (j > 0)
+      {
+        BOOST_REQUIRE_LE(c.Predict(user, recommendations(j, i)),
+            c.Predict(user, recommendations(j - 1, i)) + 1e-10);
+      }
+    }
+
+    // No unrated item has a higher predicted rating than the worst
+    // recommendation.
+    const double worst = c.Predict(user, recommendations(numRecs - 1, i));
+    for (size_t item = 0; item < c.CleanedData().n_rows; item += 13)
+    {
+      if ((double) c.CleanedData()(item, user) != 0.0)
+        continue;
+
+      bool recommended = false;
+      for (size_t j = 0; j < numRecs; ++j)
+        recommended |= (recommendations(j, i) == item);
+
+      if (!recommended)
+        BOOST_REQUIRE_LE(c.Predict(user, item), worst + 1e-10);
+    }
+  }
+}
+
+/**
+ * Make sure that the recommendations retrieved with max-kernel search are the
+ * same as the ones found by estimating the ratings of all items.
+ */
+BOOST_AUTO_TEST_CASE(CFMaxKernelSearchTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLens100k.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF<>::CleanData(dataset, cleanedData);
+
+  CF<> c(cleanedData);
+
+  arma::Col<size_t> users(10);
+  for (size_t i = 0; i < users.n_elem; ++i)
+    users(i) = 11 * i;
+
+  const size_t numRecs = 10;
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations, users);
+
+  c.MaxKernelSearch(true);
+  BOOST_REQUIRE_EQUAL(c.MaxKernelSearch(), true);
+
+  arma::Mat<size_t> searchRecommendations;
+  c.GetRecommendations(numRecs, searchRecommendations, users);
+
+  BOOST_REQUIRE_EQUAL(searchRecommendations.n_rows, numRecs);
+  BOOST_REQUIRE_EQUAL(searchRecommendations.n_cols, users.n_elem);
+
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    for (size_t j = 0; j < numRecs; ++j)
+    {
+      // Equal estimated ratings may be ordered differently.
+      if (searchRecommendations(j, i) != recommendations(j, i))
+      {
+        BOOST_REQUIRE_CLOSE(c.Predict(users(i), searchRecommendations(j, i)),
+            c.Predict(users(i), recommendations(j, i)), 1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that the ratings of a new user are folded into the model, and that
+ * the folded-in factors fit the ratings at least as well as the factors of a
+ * user with the same ratings.
+ */
+BOOST_AUTO_TEST_CASE(CFAddRatingsTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLens100k.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF<>::CleanData(dataset, cleanedData);
+
+  CF<> c(cleanedData);
+
+  const size_t oldUsers = c.H().n_cols;
+  const size_t oldItems = c.W().n_rows;
+
+  // The new user copies the ratings of user 0 and rates one new item.
+  const size_t user = oldUsers;
+  const size_t item = oldItems;
+  const arma::sp_mat userRatings = c.CleanedData().col(0);
+
+  arma::mat ratings(3, userRatings.n_nonzero + 1);
+  size_t i = 0;
+  for (arma::sp_mat::const_iterator it = userRatings.begin();
+       it != userRatings.end(); ++it, ++i)
+  {
+    ratings(0, i) = user;
+    ratings(1, i) = it.row();
+    ratings(2, i) = *it;
+  }
+  ratings(0, i) = user;
+  ratings(1, i) = item;
+  ratings(2, i) = 4.0;
+
+  const arma::vec oldFactors = c.H().col(0);
+  c.AddRatings(ratings, 1e-8);
+
+  BOOST_REQUIRE_EQUAL(c.H().n_cols, oldUsers + 1);
+  BOOST_REQUIRE_EQUAL(c.W().n_rows, oldItems + 1);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_cols, oldUsers + 1);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_rows, oldItems + 1);
+  BOOST_REQUIRE_CLOSE((double) c.CleanedData()(item, user), 4.0, 1e-5);
+
+  // Compare the residuals over the items rated by user 0.
+  double foldInResidual = 0.0;
+  double oldResidual = 0.0;
+  for (arma::sp_mat::const_iterator it = userRatings.begin();
+       it != userRatings.end(); ++it)
+  {
+    const double foldIn = arma::as_scalar(c.W().row(it.row()) *
+        c.H().col(user));
+    const double old = arma::as_scalar(c.W().row(it.row()) * oldFactors);
+    foldInResidual += std::pow(*it - foldIn, 2.0);
+    oldResidual += std::pow(*it - old, 2.0);
+  }
+  BOOST_REQUIRE_LE(foldInResidual, oldResidual + 1e-5);
+
+  // The new item is fitted to its single rating.
+  BOOST_REQUIRE_CLOSE(arma::as_scalar(c.W().row(item) * c.H().col(user)), 4.0,
+      1e-2);
+
+  // The new user can get recommendations of unrated items.
+  arma::Col<size_t> users(1);
+  users(0) = user;
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(5, recommendations, users);
+  for (size_t j = 0; j < recommendations.n_rows; ++j)
+  {
+    BOOST_REQUIRE_EQUAL((double) c.CleanedData()(recommendations(j, 0), user),
+        0.0);
+  }
+}
+
+/**
+ * Make sure that the item-item neighborhood model holds the most similar items
+ * of every item, and that its recommendations are the best scored unrated
+ * items.
+ */
+BOOST_AUTO_TEST_CASE(CFItemNeighborhoodTest)
+{
+  arma::mat dataset;
+  data::Load("GroupLens100k.csv", dataset);
+
+  arma::sp_mat cleanedData;
+  CF<>::CleanData(dataset, cleanedData);
+
+  CF<> c(cleanedData);
+
+  const size_t numNeighbors = 20;
+  c.ItemNeighborhood(numNeighbors);
+  BOOST_REQUIRE_EQUAL(c.ItemNeighborhood(), numNeighbors);
+
+  const size_t numItems = c.W().n_rows;
+  BOOST_REQUIRE_EQUAL(c.ItemNeighbors().n_rows, numNeighbors);
+  BOOST_REQUIRE_EQUAL(c.ItemNeighbors().n_cols, numItems);
+  BOOST_REQUIRE_EQUAL(c.ItemSimilarities().n_rows, numNeighbors);
+  BOOST_REQUIRE_EQUAL(c.ItemSimilarities().n_cols, numItems);
+
+  // Cosine similarities of all items, computed naively.
+  arma::mat similarities(numItems, numItems);
+  for (size_t i = 0; i < numItems; ++i)
+  {
+    for (size_t j = 0; j < numItems; ++j)
+    {
+      const double norms = arma::norm(c.W().row(i), 2) *
+          arma::norm(c.W().row(j), 2);
+      similarities(i, j) = (norms == 0.0) ? 0.0 :
+          arma::dot(c.W().row(i), c.W().row(j)) / norms;
+    }
+  }
+
+  for (size_t i = 0; i < numItems; i += 37)
+  {
+    std::vector<bool> isNeighbor(numItems, false);
+    for (size_t j = 0; j < numNeighbors; ++j)
+    {
+      const size_t neighbor = c.ItemNeighbors()(j, i);
+      BOOST_REQUIRE_NE(neighbor, i);
+      BOOST_REQUIRE_SMALL(c.ItemSimilarities()(j, i) -
+          similarities(neighbor, i), 1e-10);
+      if (j > 0)
+        BOOST_REQUIRE_LE(c.ItemSimilarities()(j, i),
+            c.ItemSimilarities()(j - 1, i));
+      isNeighbor[neighbor] = true;
+    }
+
+    const double worst = c.ItemSimilarities()(numNeighbors - 1, i);
+    for (size_t j = 0; j < numItems; ++j)
+      if (j != i && !isNeighbor[j])
+        BOOST_REQUIRE_LE(similarities(j, i), worst + 1e-10);
+  }
+
+  arma::Col<size_t> users(10);
+  for (size_t i = 0; i < users.n_elem; ++i)
+    users(i) = 11 * i;
+
+  const size_t numRecs = 10;
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations, users);
+
+  BOOST_REQUIRE_EQUAL(recommendations.n_rows, numRecs);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, users.n_elem);
+
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    // Score the unrated items naively from the neighbors of the rated items.
+    arma::vec scores(numItems, arma::fill::zeros);
+    std::vector<bool> scored(numItems, false);
+    for (arma::sp_mat::const_iterator it = c.CleanedData().begin_col(users(i));
+         it != c.CleanedData().end_col(users(i)); ++it)
+    {
+      for (size_t j = 0; j < numNeighbors; ++j)
+      {
+        const size_t neighbor = c.ItemNeighbors()(j, it.row());
+        scores[neighbor] += c.ItemSimilarities()(j, it.row()) * (*it);
+        scored[neighbor] = true;
+      }
+    }
+
+    std::vector<bool> recommended(numItems, false);
+    for (size_t j = 0; j < numRecs; ++j)
+    {
+      const size_t item = recommendations(j, i);
+      BOOST_REQUIRE_LT(item, numItems);
+      BOOST_REQUIRE_EQUAL((double) c.CleanedData()(item, users(i)), 0.0);
+      BOOST_REQUIRE(scored[item]);
+      if (j > 0)
+        BOOST_REQUIRE_LE(scores[item],
+            scores[recommendations(j - 1, i)] + 1e-10);
+      recommended[item] = true;
+    }
+
+    const double worst = scores[recommendations(numRecs - 1, i)];
+    for (size_t j = 0; j < numItems; ++j)
+    {
+      if (scored[j] && !recommended[j] &&
+          c.CleanedData()(j, users(i)) == 0.0)
+        BOOST_REQUIRE_LE(scores[j], worst + 1e-10);
+    }
+  }
+
+  // Disabling the model goes back to the user-based recommendations.
+  c.ItemNeighborhood(0);
+  BOOST_REQUIRE_EQUAL(c.ItemNeighbors().n_elem, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
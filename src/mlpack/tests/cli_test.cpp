@@ -17,6 +17,8 @@
 #endif
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/batch_scheduler.hpp>
+#include <mlpack/core/util/query_server.hpp>
 
 #define DEFAULT_INT 42
 
@@ -221,6 +223,46 @@ BOOST_AUTO_TEST_CASE(TestPrefixedOutStreamModifiers)
       "I have a precise number which is 000156");
 }
 
+/**
+ * Test that with the asynchronous log sink only complete lines are written, and
+ * that the lines of different threads don't interleave.
+ */
+BOOST_AUTO_TEST_CASE(TestPrefixedOutStreamAsync)
+{
+  std::stringstream ss;
+  PrefixedOutStream pss(ss, BASH_GREEN "[INFO ] " BASH_CLEAR);
+
+  LogSink::Start();
+
+  pss << "I have a precise number which is ";
+  LogSink::Flush();
+  BOOST_REQUIRE_EQUAL(ss.str(), "");
+
+  pss << std::setw(6) << std::setfill('0') << (int) 156 << std::endl;
+  LogSink::Flush();
+  BOOST_REQUIRE_EQUAL(ss.str(),
+      BASH_GREEN "[INFO ] " BASH_CLEAR
+      "I have a precise number which is 000156\n");
+
+  ss.str("");
+  #pragma omp parallel for
+  for (size_t i = 0; i < 1000; ++i)
+    pss << "line " << i << " is complete" << std::endl;
+  LogSink::Stop();
+
+  std::istringstream lines(ss.str());
+  std::string line;
+  size_t count = 0;
+  while (std::getline(lines, line))
+  {
+    BOOST_REQUIRE_EQUAL(line.find(BASH_GREEN "[INFO ] " BASH_CLEAR "line "),
+        0);
+    BOOST_REQUIRE_NE(line.find(" is complete"), std::string::npos);
+    ++count;
+  }
+  BOOST_REQUIRE_EQUAL(count, 1000);
+}
+
 /**
  * We should be able to start and then stop a timer multiple times and it should
  * save the value.
@@ -269,4 +311,367 @@ BOOST_AUTO_TEST_CASE(MultiRunTimerTest)
   BOOST_REQUIRE_GE(Timer::Get("test_timer").tv_usec, 40000);
 }
 
+/**
+ * Scoped timers are nested, count their calls, and add up the calls of all
+ * threads.
+ */
+BOOST_AUTO_TEST_CASE(ScopedTimerTest)
+{
+  ScopedTimers::Reset();
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    MLPACK_SCOPED_TIMER("outer");
+    {
+      MLPACK_SCOPED_TIMER("inner");
+      #ifdef _WIN32
+      Sleep(5);
+      #else
+      usleep(5000);
+      #endif
+    }
+  }
+
+  #pragma omp parallel for
+  for (int i = 0; i < 100; ++i)
+  {
+    MLPACK_SCOPED_TIMER("parallel");
+  }
+
+  std::vector<ScopedTimerRecord> records;
+  ScopedTimers::Report(records);
+  BOOST_REQUIRE_EQUAL(records.size(), 3);
+
+  BOOST_REQUIRE_EQUAL(records[0].name, "outer");
+  BOOST_REQUIRE_EQUAL(records[0].depth, 0);
+  BOOST_REQUIRE_EQUAL(records[0].calls, 3);
+  BOOST_REQUIRE_EQUAL(records[1].name, "inner");
+  BOOST_REQUIRE_EQUAL(records[1].depth, 1);
+  BOOST_REQUIRE_EQUAL(records[1].calls, 3);
+  BOOST_REQUIRE_GE(records[1].seconds, 0.015);
+  BOOST_REQUIRE_GE(records[0].seconds, records[1].seconds);
+
+  BOOST_REQUIRE_EQUAL(records[2].name, "parallel");
+  BOOST_REQUIRE_EQUAL(records[2].depth, 0);
+  BOOST_REQUIRE_EQUAL(records[2].calls, 100);
+
+  ScopedTimers::Reset();
+  ScopedTimers::Report(records);
+  BOOST_REQUIRE_EQUAL(records.size(), 0);
+}
+
+/**
+ * The hardware counters are added up like the timers, and are only available
+ * while counting is enabled.  If the kernel doesn't allow the counters to be
+ * opened (as in many containers), only the arithmetic is checked.
+ */
+BOOST_AUTO_TEST_CASE(PerfCounterTest)
+{
+  PerfCounterValues a, b;
+  BOOST_REQUIRE(!a.Available());
+  a.counts[PerfCounterValues::CYCLES] = 100;
+  a.available[PerfCounterValues::CYCLES] = true;
+  b.counts[PerfCounterValues::CYCLES] = 30;
+  a -= b;
+  BOOST_REQUIRE(a.Available());
+  BOOST_REQUIRE_EQUAL(a.counts[PerfCounterValues::CYCLES], 70);
+  BOOST_REQUIRE_EQUAL(a.ToString(), "cycles: 70");
+
+  // Without counting, the timers have no counters.
+  PerfCounters::Disable();
+  Timer::Start("uncounted_timer");
+  Timer::Stop("uncounted_timer");
+  BOOST_REQUIRE(!Timer::GetCounters("uncounted_timer").Available());
+
+  if (!PerfCounters::Enable())
+  {
+    PerfCounters::Disable();
+    return;
+  }
+
+  volatile double sum = 0.0;
+  Timer::Start("counted_timer");
+  for (size_t i = 0; i < 100000; ++i)
+    sum += std::sqrt((double) i);
+  Timer::Stop("counted_timer");
+
+  const PerfCounterValues values = Timer::GetCounters("counted_timer");
+  BOOST_REQUIRE(values.Available());
+  if (values.available[PerfCounterValues::INSTRUCTIONS])
+    BOOST_REQUIRE_GE(values.counts[PerfCounterValues::INSTRUCTIONS], 100000);
+
+  // The calling thread counted at least the events of the timer.
+  std::vector<PerfThreadRecord> records;
+  PerfCounters::Report(records);
+  BOOST_REQUIRE_GE(records.size(), 1);
+
+  PerfCounterValues total;
+  for (size_t i = 0; i < records.size(); ++i)
+    total += records[i].values;
+  for (size_t i = 0; i < PerfCounterValues::EVENTS; ++i)
+    if (values.available[i])
+      BOOST_REQUIRE_GE(total.counts[i], values.counts[i]);
+
+  PerfCounters::Disable();
+}
+
+/**
+ * The trace records the runs of the timers with their threads, and writes them
+ * in the Chrome trace event format.
+ */
+BOOST_AUTO_TEST_CASE(TraceTest)
+{
+  Trace::Reset();
+  Trace::Enable();
+
+  Timer::Start("traced_timer");
+  {
+    MLPACK_SCOPED_TIMER("traced \"scope\"");
+    #ifdef _WIN32
+    Sleep(5);
+    #else
+    usleep(5000);
+    #endif
+  }
+  Timer::Stop("traced_timer");
+
+  #pragma omp parallel for
+  for (int i = 0; i < 8; ++i)
+  {
+    MLPACK_SCOPED_TIMER("traced_parallel");
+  }
+
+  std::vector<std::pair<std::string, double> > values;
+  values.push_back(std::make_pair("visited", 12.0));
+  Trace::Counter("traced_counter", values);
+
+  Trace::Disable();
+  std::ostringstream stream;
+  Trace::Write(stream);
+  const std::string trace = stream.str();
+
+  BOOST_REQUIRE_EQUAL(trace.find("{\"traceEvents\": ["), 0);
+  BOOST_REQUIRE_NE(trace.find("\"displayTimeUnit\": \"ms\"}"),
+      std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("{\"name\": \"traced_timer\", \"ph\": \"X\""),
+      std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("{\"name\": \"traced \\\"scope\\\"\", "
+      "\"ph\": \"X\""), std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("\"ph\": \"C\""), std::string::npos);
+  BOOST_REQUIRE_NE(trace.find("\"args\": {\"visited\": 12}"),
+      std::string::npos);
+
+  // Every run of the parallel timer is a span.
+  size_t spans = 0;
+  for (size_t i = trace.find("\"traced_parallel\""); i != std::string::npos;
+      i = trace.find("\"traced_parallel\"", i + 1))
+    ++spans;
+  BOOST_REQUIRE_EQUAL(spans, 8);
+
+  // The enclosing timer comes before the scope it contains.
+  BOOST_REQUIRE_LT(trace.find("\"traced_timer\""), trace.find("traced \\"));
+
+  // Nothing is recorded while the trace is disabled.
+  Trace::Reset();
+  Timer::Start("traced_timer");
+  Timer::Stop("traced_timer");
+  std::ostringstream empty;
+  Trace::Write(empty);
+  BOOST_REQUIRE_EQUAL(empty.str().find("traced_timer"), std::string::npos);
+}
+
+//! A handler for the query server that scales the query points.
+class ScaleHandler
+{
+ public:
+  void Query(const QueryRequest& request, QueryResponse& response)
+  {
+    const double scale = request.Option<double>("scale", 1.0);
+    if (scale == 0.0)
+      Log::Fatal << "Invalid scale." << std::endl;
+
+    response.Add(arma::mat(scale * request.Points()));
+  }
+};
+
+/**
+ * Make sure the query server answers every request in order, reports invalid
+ * requests and failures of the handler as errors without stopping, and stops
+ * at a quit request.
+ */
+BOOST_AUTO_TEST_CASE(QueryServerTest)
+{
+  std::istringstream input(
+      "ping\n"
+      "# A comment, and an empty line.\n"
+      "\n"
+      "query 2 scale=2\n"
+      "1,2\n"
+      "3 4\n"
+      "query 2\n"
+      "1,2\n"
+      "3\n"
+      "query 1 scale=0\n"
+      "5\n"
+      "unknown\n"
+      "query 1\n"
+      "7,8,9\n"
+      "quit\n"
+      "query 1\n"
+      "1\n");
+  std::ostringstream output;
+
+  ScaleHandler handler;
+  QueryServer<ScaleHandler> server(handler, input, output);
+  BOOST_REQUIRE_EQUAL(server.Serve(), 7);
+
+  std::istringstream responses(output.str());
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(responses, line))
+    lines.push_back(line);
+
+  BOOST_REQUIRE_EQUAL(lines.size(), 12);
+  BOOST_REQUIRE_EQUAL(lines[0], "ok 0");
+  BOOST_REQUIRE_EQUAL(lines[1], "ok 1");
+  BOOST_REQUIRE_EQUAL(lines[2], "2 2");
+  BOOST_REQUIRE_EQUAL(lines[3], "2,4");
+  BOOST_REQUIRE_EQUAL(lines[4], "6,8");
+  BOOST_REQUIRE_EQUAL(lines[5].substr(0, 6), "error ");
+  BOOST_REQUIRE_EQUAL(lines[6], "error Invalid scale.");
+  BOOST_REQUIRE_EQUAL(lines[7], "error unknown command 'unknown'");
+  BOOST_REQUIRE_EQUAL(lines[8], "ok 1");
+  BOOST_REQUIRE_EQUAL(lines[9], "1 3");
+  BOOST_REQUIRE_EQUAL(lines[10], "7,8,9");
+  BOOST_REQUIRE_EQUAL(lines[11], "ok 0");
+}
+
+/**
+ * Make sure that spreading a matrix over the NUMA nodes keeps its contents, and
+ * that the NUMA-aware scheduler hands out every point exactly once, with and
+ * without the placement (on machines with one node, both are trivial).
+ */
+BOOST_AUTO_TEST_CASE(NumaTest)
+{
+  BOOST_REQUIRE_GE(Numa::Nodes(), 1);
+  for (size_t threads = 1; threads < 9; ++threads)
+  {
+    BOOST_REQUIRE_EQUAL(Numa::NodeBegin(1000, 0, threads), 0);
+    BOOST_REQUIRE_EQUAL(Numa::NodeBegin(1000, Numa::UsedNodes(threads),
+        threads), 1000);
+    BOOST_REQUIRE_LT(Numa::ThreadNode(threads - 1, threads),
+        Numa::UsedNodes(threads));
+  }
+
+  for (size_t enabled = 0; enabled < 2; ++enabled)
+  {
+    if (enabled)
+      Numa::Enable();
+
+    arma::mat matrix(5, 1001, arma::fill::randu);
+    const arma::mat original(matrix);
+    Numa::Distribute(matrix);
+    BOOST_REQUIRE_EQUAL(arma::accu(matrix != original), 0);
+
+    arma::Col<size_t> counts(1001);
+    counts.zeros();
+    size_t outside = 0;
+    NumaScheduler scheduler(counts.n_elem, 7);
+    #pragma omp parallel reduction(+:outside)
+    {
+      size_t begin, end;
+      while (scheduler.Next(begin, end))
+      {
+        if (end > counts.n_elem)
+          ++outside;
+        for (size_t i = begin; i < std::min(end, (size_t) counts.n_elem); ++i)
+        {
+          #pragma omp atomic
+          ++counts[i];
+        }
+      }
+    }
+    BOOST_REQUIRE_EQUAL(outside, 0);
+    BOOST_REQUIRE_EQUAL(arma::accu(counts != 1), 0);
+  }
+
+  Numa::Disable();
+}
+
+/**
+ * A handler for the batch scheduler that sums the coordinates of every query,
+ * and fails on queries whose first coordinate is negative.
+ */
+class SumHandler
+{
+ public:
+  typedef double ResultType;
+
+  SumHandler() : largestBatch(0) { }
+
+  void Query(const arma::mat& queries, std::vector<double>& results)
+  {
+    largestBatch = std::max(largestBatch, (size_t) queries.n_cols);
+    if (arma::any(queries.row(0) < 0.0))
+      Log::Fatal << "Negative query." << std::endl;
+
+    const arma::rowvec sums = arma::sum(queries, 0);
+    results.assign(sums.begin(), sums.end());
+  }
+
+  size_t largestBatch;
+};
+
+/**
+ * Make sure that the batch scheduler answers every query submitted by
+ * concurrent threads with its own result, gathers them into batches no larger
+ * than the limit, and hands the failure of a batch to its queries.
+ */
+BOOST_AUTO_TEST_CASE(BatchSchedulerTest)
+{
+  SumHandler handler;
+  {
+    BatchScheduler<SumHandler> scheduler(handler, 16, 0.01);
+
+    std::vector<std::thread> threads;
+    std::vector<size_t> wrong(8, 0);
+    for (size_t t = 0; t < 8; ++t)
+    {
+      threads.push_back(std::thread([&scheduler, &wrong, t]()
+      {
+        for (size_t i = 0; i < 50; ++i)
+        {
+          arma::vec query(3);
+          query.fill((double) (100 * t + i));
+          if (scheduler.Query(query) != 3.0 * (100 * t + i))
+            ++wrong[t];
+        }
+      }));
+    }
+
+    for (size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+
+    for (size_t t = 0; t < wrong.size(); ++t)
+      BOOST_REQUIRE_EQUAL(wrong[t], 0);
+    BOOST_REQUIRE_EQUAL(scheduler.Queries(), 400);
+    BOOST_REQUIRE_LT(scheduler.Batches(), 400);
+    BOOST_REQUIRE_LE(handler.largestBatch, 16);
+
+    // A failed batch throws in every caller, and the scheduler keeps going.
+    arma::vec negative("-1 2");
+    std::future<double> failed = scheduler.Submit(negative);
+    BOOST_REQUIRE_THROW(failed.get(), std::exception);
+    BOOST_REQUIRE_CLOSE(scheduler.Query(arma::vec("1 2")), 3.0, 1e-5);
+  }
+
+  // Queries still waiting when the scheduler is destroyed are answered.
+  std::future<double> late;
+  {
+    BatchScheduler<SumHandler> scheduler(handler, 16, 60.0);
+    late = scheduler.Submit(arma::vec("4 5"));
+  }
+  BOOST_REQUIRE_CLOSE(late.get(), 9.0, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -148,6 +149,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<ValidConvolution> >(input, filter,
       output);
+
+  // Perform the convolution as a matrix product (im2col).
+  Convolution2DMethodTest<Im2ColConvolution<ValidConvolution> >(input, filter,
+      output);
 }
 
 /**
@@ -185,6 +190,10 @@ BOOST_AUTO_TEST_CASE(FullConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<FullConvolution> >(input, filter,
       output);
+
+  // Perform the convolution as a matrix product (im2col).
+  Convolution2DMethodTest<Im2ColConvolution<FullConvolution> >(input, filter,
+      output);
 }
 
 /**
@@ -230,6 +239,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<ValidConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product (im2col).
+  Convolution3DMethodTest<Im2ColConvolution<ValidConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -279,6 +292,10 @@ BOOST_AUTO_TEST_CASE(FullConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<FullConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product (im2col).
+  Convolution3DMethodTest<Im2ColConvolution<FullConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -321,6 +338,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolutionBatchTest)
   // speeded up the computation.
   ConvolutionMethodBatchTest<SVDConvolution<ValidConvolution> >(input,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product (im2col).
+  ConvolutionMethodBatchTest<Im2ColConvolution<ValidConvolution> >(input,
+      filterCube, outputCube);
 }
 
 /**
@@ -367,6 +388,46 @@ BOOST_AUTO_TEST_CASE(FullConvolutionBatchTest)
   // speeded up the computation.
   ConvolutionMethodBatchTest<SVDConvolution<FullConvolution> >(input,
       filterCube, outputCube);
+
+  // Perform the convolution as a matrix product (im2col).
+  ConvolutionMethodBatchTest<Im2ColConvolution<FullConvolution> >(input,
+      filterCube, outputCube);
+}
+
+/**
+ * Make sure the im2col convolution of a 3rd order tensor with a dense matrix
+ * filter (as used by the ConvConnection) matches the naive convolution.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionCubeTest)
+{
+  arma::cube input = arma::randu<arma::cube>(7, 6, 3);
+  arma::mat filter = arma::randu<arma::mat>(3, 2);
+
+  arma::cube naiveOutput, im2colOutput;
+  NaiveConvolution<ValidConvolution>::Convolution(input, filter, naiveOutput);
+  Im2ColConvolution<ValidConvolution>::Convolution(input, filter,
+      im2colOutput);
+
+  BOOST_REQUIRE_EQUAL(naiveOutput.n_rows, im2colOutput.n_rows);
+  BOOST_REQUIRE_EQUAL(naiveOutput.n_cols, im2colOutput.n_cols);
+  BOOST_REQUIRE_EQUAL(naiveOutput.n_slices, im2colOutput.n_slices);
+  for (size_t i = 0; i < naiveOutput.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(naiveOutput[i], im2colOutput[i], 1e-5);
+
+  NaiveConvolution<FullConvolution>::Convolution(input, filter, naiveOutput);
+  Im2ColConvolution<FullConvolution>::Convolution(input, filter,
+      im2colOutput);
+
+  BOOST_REQUIRE_EQUAL(naiveOutput.n_rows, im2colOutput.n_rows);
+  BOOST_REQUIRE_EQUAL(naiveOutput.n_cols, im2colOutput.n_cols);
+  BOOST_REQUIRE_EQUAL(naiveOutput.n_slices, im2colOutput.n_slices);
+  for (size_t i = 0; i < naiveOutput.n_elem; i++)
+  {
+    if (std::abs(naiveOutput[i]) < 1e-10)
+      BOOST_REQUIRE_SMALL(im2colOutput[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(naiveOutput[i], im2colOutput[i], 1e-5);
+  }
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -177,4 +177,31 @@ BOOST_AUTO_TEST_CASE(CosineTreeModifiedGramSchmidt)
   }
 }
 
+/**
+ * Checks CosineTree::MonteCarloError() with a given basis: if the basis spans
+ * the whole space, the estimated error is zero, and if it is empty, the error
+ * is the squared Frobenius norm of the node.
+ */
+BOOST_AUTO_TEST_CASE(CosineTreeMonteCarloErrorBasis)
+{
+  const size_t numRows = 10;
+  const size_t numCols = 200;
+
+  arma::mat data = arma::randu(numRows, numCols);
+  CosineTree dummyTree(data, 1, 0.1);
+  CosineTree node(data);
+
+  // An orthonormal basis of the whole space.
+  arma::mat q, r;
+  arma::qr_econ(q, r, arma::randu<arma::mat>(numRows, numRows));
+
+  const double fullError = dummyTree.MonteCarloError(&node, q);
+  BOOST_REQUIRE_SMALL(fullError / node.FrobNormSquared(), 1e-5);
+  BOOST_REQUIRE_SMALL(node.L2Error() / node.FrobNormSquared(), 1e-5);
+
+  const arma::mat empty(numRows, 0);
+  const double emptyError = dummyTree.MonteCarloError(&node, empty);
+  BOOST_REQUIRE_CLOSE(emptyError, node.FrobNormSquared(), 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
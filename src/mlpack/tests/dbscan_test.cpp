@@ -0,0 +1,158 @@
+/**
+ * @file dbscan_test.cpp
+ * @author Ryan Curtin
+ *
+ * Tests for DBSCAN.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/dbscan/dbscan.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::dbscan;
+
+BOOST_AUTO_TEST_SUITE(DBSCANTest);
+
+/**
+ * Naive DBSCAN, with the same rules for border points and for the numbering of
+ * the clusters.
+ */
+size_t NaiveDBSCAN(const arma::mat& data,
+                   const double epsilon,
+                   const size_t minPoints,
+                   arma::Col<size_t>& assignments)
+{
+  const size_t n = data.n_cols;
+  arma::Mat<size_t> neighbors(n, n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      neighbors(i, j) = (arma::norm(data.col(i) - data.col(j), 2) <= epsilon);
+
+  std::vector<bool> isCore(n);
+  for (size_t i = 0; i < n; ++i)
+    isCore[i] = (arma::accu(neighbors.col(i)) >= minPoints);
+
+  // Grow every cluster from its smallest core point.
+  assignments.set_size(n);
+  assignments.fill(SIZE_MAX);
+  size_t clusters = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (!isCore[i] || assignments[i] != SIZE_MAX)
+      continue;
+
+    std::vector<size_t> stack(1, i);
+    assignments[i] = clusters;
+    while (!stack.empty())
+    {
+      const size_t point = stack.back();
+      stack.pop_back();
+      for (size_t j = 0; j < n; ++j)
+      {
+        if (isCore[j] && neighbors(point, j) && assignments[j] == SIZE_MAX)
+        {
+          assignments[j] = clusters;
+          stack.push_back(j);
+        }
+      }
+    }
+    ++clusters;
+  }
+
+  // Border points take the cluster of their smallest core neighbor.
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (isCore[i])
+      continue;
+
+    for (size_t j = 0; j < n; ++j)
+    {
+      if (isCore[j] && neighbors(i, j))
+      {
+        assignments[i] = assignments[j];
+        break;
+      }
+    }
+  }
+
+  return clusters;
+}
+
+/**
+ * Three well-separated blobs and one outlier.
+ */
+BOOST_AUTO_TEST_CASE(SeparatedClustersTest)
+{
+  arma::mat data(2, 301);
+  data.cols(0, 99) = 0.3 * arma::randn<arma::mat>(2, 100);
+  data.cols(100, 199) = 0.3 * arma::randn<arma::mat>(2, 100);
+  data.cols(200, 299) = 0.3 * arma::randn<arma::mat>(2, 100);
+  data.cols(100, 199).each_col() += arma::vec("20.0 0.0");
+  data.cols(200, 299).each_col() += arma::vec("0.0 20.0");
+  data.col(300) = arma::vec("-20.0 -20.0");
+
+  DBSCAN<> dbscan(2.0, 5);
+  arma::Col<size_t> assignments;
+  arma::mat centroids;
+  const size_t clusters = dbscan.Cluster(data, assignments, centroids);
+
+  BOOST_REQUIRE_EQUAL(clusters, 3);
+  for (size_t c = 0; c < 3; ++c)
+    for (size_t i = 100 * c; i < 100 * (c + 1); ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], c);
+  BOOST_REQUIRE_EQUAL(assignments[300], SIZE_MAX);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 3);
+  BOOST_REQUIRE_SMALL(centroids(0, 0), 0.5);
+  BOOST_REQUIRE_CLOSE(centroids(0, 1), 20.0, 3.0);
+  BOOST_REQUIRE_CLOSE(centroids(1, 2), 20.0, 3.0);
+}
+
+/**
+ * Make sure DBSCAN gives the same clustering as the naive algorithm, with
+ * single-tree and dual-tree search, with small batches, and in parallel.
+ */
+BOOST_AUTO_TEST_CASE(NaiveComparisonTest)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 500);
+
+  for (size_t minPoints = 1; minPoints <= 10; minPoints += 3)
+  {
+    arma::Col<size_t> naiveAssignments;
+    const size_t naiveClusters = NaiveDBSCAN(data, 0.05, minPoints,
+        naiveAssignments);
+
+    for (size_t mode = 0; mode < 4; ++mode)
+    {
+      DBSCAN<> dbscan(0.05, minPoints, (mode % 2 == 1), (mode < 2) ? 10000 : 7);
+      dbscan.Parallel() = (mode >= 2);
+
+      arma::Col<size_t> assignments;
+      const size_t clusters = dbscan.Cluster(data, assignments);
+
+      BOOST_REQUIRE_EQUAL(clusters, naiveClusters);
+      for (size_t i = 0; i < data.n_cols; ++i)
+        BOOST_REQUIRE_EQUAL(assignments[i], naiveAssignments[i]);
+    }
+  }
+}
+
+/**
+ * If no point has enough neighbors, everything is noise.
+ */
+BOOST_AUTO_TEST_CASE(AllNoiseTest)
+{
+  arma::mat data("0.0 1.0 2.0 3.0 4.0");
+
+  DBSCAN<> dbscan(0.5, 2);
+  arma::Col<size_t> assignments;
+  arma::mat centroids;
+  BOOST_REQUIRE_EQUAL(dbscan.Cluster(data, assignments, centroids), 0);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 0);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], SIZE_MAX);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -307,4 +307,128 @@ BOOST_AUTO_TEST_CASE(DimensionSelectionTest)
   }
 }
 
+/**
+ * Make sure that a weighted stump trained with dimensions sorted in advance by
+ * SortDimensions() is identical to one which sorts each dimension itself.
+ */
+BOOST_AUTO_TEST_CASE(PresortedWeightedStumpTest)
+{
+  const size_t numClasses = 3;
+  const size_t inpBucketSize = 4;
+
+  arma::mat trainingData;
+  trainingData.randu(5, 200);
+  arma::Row<size_t> labelsIn(200);
+  for (size_t i = 0; i < 200; ++i)
+    labelsIn(i) = (trainingData(3, i) < 0.3) ? 0 :
+        ((trainingData(3, i) < 0.6) ? 1 : 2);
+
+  // Some repeated values, so that the stability of the sort matters.
+  trainingData.row(1) = arma::floor(10 * trainingData.row(1));
+
+  arma::rowvec weights;
+  weights.randu(200);
+
+  DecisionStump<> other(trainingData, labelsIn, numClasses, inpBucketSize);
+
+  arma::umat sortedIndices;
+  DecisionStump<>::SortDimensions(trainingData, sortedIndices);
+  BOOST_REQUIRE_EQUAL(sortedIndices.n_rows, 200);
+  BOOST_REQUIRE_EQUAL(sortedIndices.n_cols, 5);
+
+  DecisionStump<> ds(other, trainingData, weights, labelsIn);
+  DecisionStump<> presorted(other, trainingData, weights, labelsIn,
+      sortedIndices);
+
+  BOOST_REQUIRE_EQUAL(ds.SplitAttribute(), presorted.SplitAttribute());
+  BOOST_REQUIRE_EQUAL(ds.Split().n_elem, presorted.Split().n_elem);
+  for (size_t i = 0; i < ds.Split().n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(ds.Split()[i], presorted.Split()[i]);
+    BOOST_REQUIRE_EQUAL(ds.BinLabels()[i], presorted.BinLabels()[i]);
+  }
+}
+
+/**
+ * Make sure that BinDimensions() gives every distinct value its own bin when
+ * there are few of them, and otherwise at most the given number of bins, each
+ * starting at the smallest value that falls into it.
+ */
+BOOST_AUTO_TEST_CASE(BinDimensionsTest)
+{
+  mat data;
+  data.randu(2, 1000);
+  data.row(0) = floor(10 * data.row(0));
+
+  Mat<unsigned char> binned;
+  mat edges;
+  DecisionStump<>::BinDimensions(data, 32, binned, edges);
+  BOOST_REQUIRE_EQUAL(binned.n_rows, 1000);
+  BOOST_REQUIRE_EQUAL(binned.n_cols, 2);
+  BOOST_REQUIRE_EQUAL(edges.n_rows, 32);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    size_t bins = 0;
+    while (bins < edges.n_rows && edges(bins, i) != datum::inf)
+      ++bins;
+    BOOST_REQUIRE_EQUAL(bins, (i == 0) ? 10 : 32);
+
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      const size_t bin = binned(j, i);
+      BOOST_REQUIRE_LT(bin, bins);
+      BOOST_REQUIRE_LE(edges(bin, i), data(i, j));
+      if (bin + 1 < bins)
+        BOOST_REQUIRE_LT(data(i, j), edges(bin + 1, i));
+      if (i == 0)
+        BOOST_REQUIRE_EQUAL(edges(bin, i), data(i, j));
+    }
+  }
+}
+
+/**
+ * Make sure that a stump in histogram mode splits on the right dimension of
+ * well-separated data and classifies it correctly, and that weighted stumps
+ * trained from it (with or without sorted dimensions) do the same.
+ */
+BOOST_AUTO_TEST_CASE(HistogramStumpTest)
+{
+  const size_t numClasses = 3;
+
+  mat trainingData;
+  trainingData.randu(4, 600);
+  Row<size_t> labelsIn(600);
+  for (size_t i = 0; i < 600; ++i)
+    labelsIn(i) = (trainingData(2, i) < 0.3) ? 0 :
+        ((trainingData(2, i) < 0.6) ? 1 : 2);
+
+  DecisionStump<> ds(trainingData, labelsIn, numClasses, 4, 64);
+  BOOST_REQUIRE_EQUAL(ds.HistogramBins(), 64);
+  BOOST_REQUIRE_EQUAL(ds.SplitAttribute(), 2);
+
+  // Only the points in the bins around the class boundaries may be wrong.
+  Row<size_t> predictedLabels(trainingData.n_cols);
+  ds.Classify(trainingData, predictedLabels);
+  BOOST_REQUIRE_LT(accu(predictedLabels != labelsIn), 40);
+
+  rowvec weights(600);
+  weights.fill(1.0 / 600);
+  arma::umat sortedIndices;
+  DecisionStump<>::SortDimensions(trainingData, sortedIndices);
+
+  DecisionStump<> weighted(ds, trainingData, weights, labelsIn);
+  DecisionStump<> presorted(ds, trainingData, weights, labelsIn,
+      sortedIndices);
+  BOOST_REQUIRE_EQUAL(weighted.SplitAttribute(), 2);
+  BOOST_REQUIRE_EQUAL(weighted.Split().n_elem, ds.Split().n_elem);
+  BOOST_REQUIRE_EQUAL(presorted.Split().n_elem, ds.Split().n_elem);
+  for (size_t i = 0; i < ds.Split().n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(weighted.Split()[i], ds.Split()[i]);
+    BOOST_REQUIRE_EQUAL(presorted.Split()[i], ds.Split()[i]);
+    BOOST_REQUIRE_EQUAL(weighted.BinLabels()[i], ds.BinLabels()[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
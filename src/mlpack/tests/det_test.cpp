@@ -6,6 +6,7 @@
  * using this class.
  */
 #include <mlpack/core.hpp>
+#include <stack>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -18,6 +19,7 @@
 
 #include <mlpack/methods/det/dtree.hpp>
 #include <mlpack/methods/det/dt_utils.hpp>
+#include <mlpack/methods/det/flat_dtree.hpp>
 
 #ifndef _WIN32
   #undef protected
@@ -310,6 +312,134 @@ BOOST_AUTO_TEST_CASE(TestVariableImportance)
   BOOST_REQUIRE_CLOSE((double) (rootError - (lError + rError)), imps[2], 1e-10);
 }
 
+/**
+ * Make sure growing the tree from presorted points gives the same tree as the
+ * regular growth, with enough points that subtrees are grown as tasks.
+ */
+BOOST_AUTO_TEST_CASE(TestPresortedGrow)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 10000);
+  arma::mat presortedData(data);
+
+  arma::Col<size_t> oldFromNew(data.n_cols);
+  for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    oldFromNew[i] = i;
+  arma::Col<size_t> presortedOldFromNew(oldFromNew);
+
+  DTree tree(data);
+  const double alpha = tree.Grow(data, oldFromNew, false, 10, 5);
+
+  DTree presortedTree(presortedData);
+  const double presortedAlpha = presortedTree.Grow(presortedData,
+      presortedOldFromNew, false, 10, 5, true);
+
+  BOOST_REQUIRE_CLOSE(alpha, presortedAlpha, 1e-10);
+
+  // Compare the nodes of both trees.
+  std::stack<std::pair<DTree*, DTree*> > nodes;
+  nodes.push(std::make_pair(&tree, &presortedTree));
+  while (!nodes.empty())
+  {
+    DTree* node = nodes.top().first;
+    DTree* presortedNode = nodes.top().second;
+    nodes.pop();
+
+    BOOST_REQUIRE_EQUAL(node->Start(), presortedNode->Start());
+    BOOST_REQUIRE_EQUAL(node->End(), presortedNode->End());
+    BOOST_REQUIRE_EQUAL(node->SubtreeLeaves(), presortedNode->SubtreeLeaves());
+    BOOST_REQUIRE_EQUAL(node->Left() == NULL, presortedNode->Left() == NULL);
+    if (node->Left() == NULL)
+    {
+      // The points of the leaf must lie in the leaf.
+      for (size_t i = presortedNode->Start(); i < presortedNode->End(); ++i)
+      {
+        arma::vec point = presortedData.unsafe_col(i);
+        BOOST_REQUIRE(presortedNode->WithinRange(point));
+      }
+      continue;
+    }
+
+    BOOST_REQUIRE_EQUAL(node->SplitDim(), presortedNode->SplitDim());
+    BOOST_REQUIRE_CLOSE(node->SplitValue(), presortedNode->SplitValue(), 1e-10);
+    nodes.push(std::make_pair(node->Left(), presortedNode->Left()));
+    nodes.push(std::make_pair(node->Right(), presortedNode->Right()));
+  }
+
+  // The density estimates are the same, and the mappings still refer to all
+  // the original points.
+  for (size_t i = 0; i < presortedData.n_cols; ++i)
+  {
+    arma::vec point = presortedData.unsafe_col(i);
+    BOOST_REQUIRE_CLOSE(presortedTree.ComputeValue(point),
+        tree.ComputeValue(point), 1e-10);
+  }
+
+  arma::Col<size_t> sortedMapping = arma::sort(presortedOldFromNew);
+  for (size_t i = 0; i < sortedMapping.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(sortedMapping[i], i);
+}
+
+/**
+ * Make sure the cross-validated training gives the same tree with and without
+ * presorting, and that it doesn't modify the dataset.
+ */
+BOOST_AUTO_TEST_CASE(TestTrainerFolds)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 1000);
+  arma::mat originalData(data);
+
+  DTree* tree = Trainer(data, 5, false, 10, 5);
+  BOOST_REQUIRE_EQUAL(arma::accu(data != originalData), (arma::uword) 0);
+
+  DTree* presortedTree = Trainer(data, 5, false, 10, 5, "", true);
+
+  BOOST_REQUIRE_EQUAL(tree->SubtreeLeaves(), presortedTree->SubtreeLeaves());
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    arma::vec point = data.unsafe_col(i);
+    BOOST_REQUIRE_CLOSE(tree->ComputeValue(point),
+        presortedTree->ComputeValue(point), 1e-10);
+  }
+
+  delete tree;
+  delete presortedTree;
+}
+
+/**
+ * The flattened tree (and the batch evaluation of the tree) must give exactly
+ * the estimates of ComputeValue() of a pruned tree, for points inside and
+ * outside of its bounding box.
+ */
+BOOST_AUTO_TEST_CASE(TestFlatDTree)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 1000);
+  DTree* tree = Trainer(data, 5, false, 10, 5);
+
+  // Some of the queries are outside of the bounding box of the data.
+  arma::mat queries = 1.2 * arma::randu<arma::mat>(3, 3000) - 0.1;
+  queries.cols(0, 999) = data;
+
+  FlatDTree flatTree(*tree);
+  BOOST_REQUIRE_EQUAL(flatTree.NumNodes(), 2 * tree->SubtreeLeaves() - 1);
+
+  arma::vec values, flatValues;
+  tree->ComputeValues(queries, values);
+  flatTree.ComputeValues(queries, flatValues);
+
+  BOOST_REQUIRE_EQUAL(values.n_elem, queries.n_cols);
+  BOOST_REQUIRE_EQUAL(flatValues.n_elem, queries.n_cols);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    arma::vec query = queries.unsafe_col(i);
+    const double value = tree->ComputeValue(query);
+    BOOST_REQUIRE_EQUAL(values[i], value);
+    BOOST_REQUIRE_EQUAL(flatValues[i], value);
+    BOOST_REQUIRE_EQUAL(flatTree.ComputeValue(query), value);
+  }
+
+  delete tree;
+}
+
 /**
  * These are not yet implemented.
  *
@@ -45,6 +45,63 @@ BOOST_AUTO_TEST_CASE(DiscreteDistributionProbabilityTest)
   BOOST_REQUIRE_CLOSE(d.Probability("4"), 0.2, 1e-5);
 }
 
+/**
+ * The batch Probability() and LogProbability() should give what the
+ * one-observation versions give.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteDistributionBatchProbabilityTest)
+{
+  DiscreteDistribution d(arma::vec("0.2 0.4 0.1 0.1 0.2"));
+
+  const arma::mat observations("0 4 1 1 3 2 0");
+  arma::vec probabilities, logProbabilities;
+  d.Probability(observations, probabilities);
+  d.LogProbability(observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_elem, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const arma::vec observation = observations.col(i);
+    BOOST_REQUIRE_CLOSE(probabilities[i], d.Probability(observation), 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], d.LogProbability(observation),
+        1e-5);
+  }
+}
+
+/**
+ * The log probabilities of a sequence under several distributions, computed
+ * with the lookup table, must be those of each distribution, even when the
+ * distributions have different numbers of observations.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteDistributionStateLogProbabilityTest)
+{
+  std::vector<DiscreteDistribution> dists;
+  dists.push_back(DiscreteDistribution(arma::vec("0.2 0.4 0.1 0.1 0.2")));
+  dists.push_back(DiscreteDistribution(arma::vec("0.5 0.3 0.2")));
+  dists.push_back(DiscreteDistribution(arma::vec("0.1 0.1 0.1 0.1 0.6")));
+
+  const arma::mat observations("0 4 1 1 3 2 0 7");
+  arma::mat logProbabilities;
+  DiscreteDistribution::LogProbability(dists, observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_cols, observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const size_t obs = (size_t) observations[i];
+    for (size_t s = 0; s < dists.size(); ++s)
+    {
+      if (obs < dists[s].Probabilities().n_elem)
+        BOOST_REQUIRE_CLOSE(logProbabilities(s, i),
+            std::log(dists[s].Probabilities()[obs]), 1e-5);
+      else
+        BOOST_REQUIRE_EQUAL(logProbabilities(s, i),
+            -std::numeric_limits<double>::infinity());
+    }
+  }
+}
+
 /**
  * Make sure we get random observations correct.
  */
@@ -307,6 +364,55 @@ BOOST_AUTO_TEST_CASE(GaussianMultipointMultivariateProbabilityTest)
   BOOST_REQUIRE_CLOSE(phis(5), -14.900192463287908, 1e-5);
 }
 
+/**
+ * Make sure the cached factorization is refreshed when the covariance or the
+ * model is changed after construction.
+ */
+BOOST_AUTO_TEST_CASE(GaussianDistributionCovarianceUpdateTest)
+{
+  arma::vec mean = "5 6 3 3 2";
+  arma::mat cov("6 1 1 1 2;"
+                "1 7 1 0 0;"
+                "1 1 4 1 1;"
+                "1 0 1 7 0;"
+                "2 0 1 0 6");
+
+  arma::mat points = "0 3 2 2 3 4;"
+                     "1 2 2 1 0 0;"
+                     "2 3 0 5 5 6;"
+                     "3 7 8 0 1 1;"
+                     "4 8 1 1 0 0;";
+
+  // Start with the identity covariance, then change it.
+  GaussianDistribution g(5);
+  g.Mean() = mean;
+  g.Covariance(cov);
+
+  GaussianDistribution h(mean, cov);
+
+  arma::vec gPhis, hPhis;
+  g.LogProbability(points, gPhis);
+  h.LogProbability(points, hPhis);
+
+  BOOST_REQUIRE_EQUAL(gPhis.n_elem, 6);
+  for (size_t i = 0; i < 6; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gPhis(i), hPhis(i), 1e-5);
+    BOOST_REQUIRE_CLOSE(g.LogProbability(points.col(i)), hPhis(i), 1e-5);
+  }
+
+  // Estimating a new model must also refresh the cached factorization.
+  arma::mat data;
+  data.randn(5, 500);
+  g.Estimate(data);
+  h = GaussianDistribution(g.Mean(), g.Covariance());
+
+  g.LogProbability(points, gPhis);
+  h.LogProbability(points, hPhis);
+  for (size_t i = 0; i < 6; ++i)
+    BOOST_REQUIRE_CLOSE(gPhis(i), hPhis(i), 1e-5);
+}
+
 /**
  * Make sure random observations follow the probability distribution correctly.
  */
@@ -373,4 +479,71 @@ BOOST_AUTO_TEST_CASE(GaussianDistributionEstimateTest)
       BOOST_REQUIRE_SMALL(d.Covariance()(i, j) - actualCov(i, j), 1e-5);
 }
 
+/**
+ * A DiagonalGaussianDistribution should give the same densities and estimates
+ * as a GaussianDistribution with a diagonal covariance.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionTest)
+{
+  arma::vec mean("5 6 3 3 2");
+  arma::vec variances("6 7 4 7 0.5");
+
+  DiagonalGaussianDistribution d(mean, variances);
+  GaussianDistribution g(mean, arma::diagmat(variances));
+
+  arma::mat points = 3 * arma::randn<arma::mat>(5, 100);
+  points.each_col() += mean;
+
+  arma::vec logProbs, gLogProbs;
+  d.LogProbability(points, logProbs);
+  g.LogProbability(points, gLogProbs);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logProbs[i], gLogProbs[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.LogProbability(points.col(i)), gLogProbs[i], 1e-5);
+  }
+
+  // The weighted estimates of the means and variances are the same too.
+  arma::vec probabilities = arma::randu<arma::vec>(points.n_cols);
+  d.Estimate(points, probabilities);
+  g.Estimate(points, probabilities);
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(d.Mean()[i], g.Mean()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.Covariance()[i], g.Covariance()(i, i), 1e-5);
+  }
+
+  d.Estimate(points);
+  g.Estimate(points);
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(d.Mean()[i], g.Mean()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.Covariance()[i], g.Covariance()(i, i), 1e-5);
+  }
+}
+
+/**
+ * The batch Probability() and LogProbability() of the Laplace distribution
+ * should give what the one-observation versions give.
+ */
+BOOST_AUTO_TEST_CASE(LaplaceDistributionBatchProbabilityTest)
+{
+  LaplaceDistribution l(arma::vec("1.0 -2.0 0.5"), 1.5);
+
+  const arma::mat observations = arma::randn<arma::mat>(3, 50);
+  arma::vec probabilities, logProbabilities;
+  l.Probability(observations, probabilities);
+  l.LogProbability(observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_elem, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const arma::vec observation = observations.col(i);
+    BOOST_REQUIRE_CLOSE(probabilities[i], l.Probability(observation), 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], l.LogProbability(observation),
+        1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
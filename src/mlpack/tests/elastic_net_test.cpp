@@ -0,0 +1,157 @@
+/**
+ * @file elastic_net_test.cpp
+ * @author Ryan Curtin
+ *
+ * Tests for the coordinate descent LASSO and elastic net solver.
+ */
+#include <mlpack/methods/lars/elastic_net.hpp>
+#include <mlpack/methods/lars/lars.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(ElasticNetTest);
+
+/**
+ * Check the optimality conditions of the solution of the elastic net for the
+ * column-major data X.
+ */
+void CheckOptimality(const arma::mat& X,
+                     const arma::vec& y,
+                     const arma::vec& beta,
+                     const double lambda1,
+                     const double lambda2)
+{
+  const arma::vec correlations = X * (y - trans(X) * beta) - lambda2 * beta;
+  for (size_t j = 0; j < beta.n_elem; ++j)
+  {
+    if (beta[j] == 0.0)
+      BOOST_REQUIRE_SMALL(std::max(std::abs(correlations[j]) - lambda1, 0.0),
+          1e-5);
+    else if (beta[j] > 0.0)
+      BOOST_REQUIRE_SMALL(correlations[j] - lambda1, 1e-5);
+    else
+      BOOST_REQUIRE_SMALL(correlations[j] + lambda1, 1e-5);
+  }
+}
+
+/**
+ * Make sure coordinate descent finds the same solutions as LARS, for the LASSO
+ * and the elastic net.
+ */
+BOOST_AUTO_TEST_CASE(LARSComparisonTest)
+{
+  for (size_t trial = 0; trial < 20; ++trial)
+  {
+    arma::mat X = arma::randn(20, 100);
+    arma::vec y = trans(X) * arma::randn(20) + 0.1 * arma::randn(100);
+
+    const arma::vec sortedCorr = arma::sort(arma::abs(X * y));
+    const double lambda1 = sortedCorr[10];
+    const double lambda2 = (trial % 2 == 0) ? 0.0 : lambda1 / 2;
+
+    ElasticNet elasticNet(lambda1, lambda2, 1e-20);
+    arma::vec beta;
+    elasticNet.Regress(X, y, beta);
+
+    LARS lars(true, lambda1, lambda2);
+    arma::vec larsBeta;
+    lars.Regress(X, y, larsBeta);
+
+    BOOST_REQUIRE_EQUAL(beta.n_elem, X.n_rows);
+    for (size_t j = 0; j < X.n_rows; ++j)
+      BOOST_REQUIRE_SMALL(beta[j] - larsBeta[j], 1e-6);
+
+    CheckOptimality(X, y, beta, lambda1, lambda2);
+  }
+}
+
+/**
+ * Make sure sparse data gives the same solution as the same dense data.
+ */
+BOOST_AUTO_TEST_CASE(SparseDataTest)
+{
+  arma::sp_mat X;
+  X.sprandu(200, 300, 0.05);
+  const arma::mat denseX(X);
+  const arma::vec y = arma::randn(300);
+
+  ElasticNet elasticNet(0.5, 0.1, 1e-20);
+  arma::vec sparseBeta, denseBeta;
+  elasticNet.Regress(X, y, sparseBeta);
+  elasticNet.Regress(denseX, y, denseBeta);
+
+  BOOST_REQUIRE_EQUAL(sparseBeta.n_elem, 200);
+  for (size_t j = 0; j < sparseBeta.n_elem; ++j)
+    BOOST_REQUIRE_SMALL(sparseBeta[j] - denseBeta[j], 1e-8);
+
+  CheckOptimality(denseX, y, sparseBeta, 0.5, 0.1);
+}
+
+/**
+ * Make sure every solution of the regularization path is optimal, and that a
+ * large enough lambda1 gives a zero solution.
+ */
+BOOST_AUTO_TEST_CASE(RegularizationPathTest)
+{
+  arma::mat X = arma::randn(50, 80);
+  arma::vec y = arma::randn(80);
+
+  ElasticNet elasticNet(0.0, 0.2, 1e-20);
+  elasticNet.PathLength() = 20;
+  arma::vec lambdas;
+  arma::mat betas;
+  elasticNet.RegressPath(X, y, lambdas, betas);
+
+  BOOST_REQUIRE_EQUAL(lambdas.n_elem, 20);
+  BOOST_REQUIRE_EQUAL(betas.n_rows, 50);
+  BOOST_REQUIRE_EQUAL(betas.n_cols, 20);
+
+  // The first lambda1 is the smallest with a zero solution.
+  BOOST_REQUIRE_CLOSE(lambdas[0], arma::max(arma::abs(X * y)), 1e-8);
+  BOOST_REQUIRE_EQUAL(arma::accu(betas.col(0) != 0.0), 0);
+
+  for (size_t k = 0; k < lambdas.n_elem; ++k)
+  {
+    if (k > 0)
+      BOOST_REQUIRE_LT(lambdas[k], lambdas[k - 1]);
+    CheckOptimality(X, y, betas.col(k), lambdas[k], 0.2);
+  }
+
+  // The end of the path is the same as solving directly.
+  elasticNet.Lambda1() = lambdas[19];
+  arma::vec beta;
+  elasticNet.Regress(X, y, beta);
+  for (size_t j = 0; j < beta.n_elem; ++j)
+    BOOST_REQUIRE_SMALL(beta[j] - betas(j, 19), 1e-6);
+}
+
+/**
+ * Make sure solving many problems at once gives the same solutions as solving
+ * each one on its own.
+ */
+BOOST_AUTO_TEST_CASE(BatchRegressTest)
+{
+  arma::mat X = arma::randn(10, 100);
+  arma::mat responses = arma::randn(100, 30);
+
+  ElasticNet elasticNet(5.0, 1.0, 1e-20);
+  arma::mat betas;
+  elasticNet.Regress(X, responses, betas);
+
+  BOOST_REQUIRE_EQUAL(betas.n_rows, X.n_rows);
+  BOOST_REQUIRE_EQUAL(betas.n_cols, responses.n_cols);
+
+  for (size_t i = 0; i < responses.n_cols; ++i)
+  {
+    arma::vec beta;
+    elasticNet.Regress(X, arma::vec(responses.col(i)), beta);
+    for (size_t j = 0; j < X.n_rows; ++j)
+      BOOST_REQUIRE_SMALL(betas(j, i) - beta[j], 1e-12);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
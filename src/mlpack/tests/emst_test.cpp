@@ -5,6 +5,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/emst/dtb.hpp>
+#include <mlpack/methods/emst/single_linkage.hpp>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -216,6 +217,37 @@ BOOST_AUTO_TEST_CASE(DualTreeVsNaive)
   }
 }
 
+/**
+ * Compare the parallel Boruvka steps with the naive algorithm, with enough
+ * points that the tree is split into many query subtrees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+  arma::mat inputData = arma::randu<arma::mat>(3, 3000);
+
+  DualTreeBoruvka<> dtb(inputData);
+  dtb.Parallel() = true;
+
+  arma::mat parallelResults;
+  dtb.ComputeMST(parallelResults);
+
+  DualTreeBoruvka<> naive(inputData, true);
+
+  arma::mat naiveResults;
+  naive.ComputeMST(naiveResults);
+
+  BOOST_REQUIRE_EQUAL(parallelResults.n_cols, naiveResults.n_cols);
+  BOOST_REQUIRE_EQUAL(parallelResults.n_rows, naiveResults.n_rows);
+
+  // The distances of random points are distinct, so the trees are identical.
+  for (size_t i = 0; i < parallelResults.n_cols; i++)
+  {
+    BOOST_REQUIRE_EQUAL(parallelResults(0, i), naiveResults(0, i));
+    BOOST_REQUIRE_EQUAL(parallelResults(1, i), naiveResults(1, i));
+    BOOST_REQUIRE_CLOSE(parallelResults(2, i), naiveResults(2, i), 1e-5);
+  }
+}
+
 /**
  * Make sure the cover tree works fine.
  */
@@ -277,4 +309,101 @@ BOOST_AUTO_TEST_CASE(BallTreeTest)
 
 }
 
+/**
+ * Make sure that cutting the single-linkage hierarchy at a distance groups
+ * exactly the points that are joined by chains of short distances.
+ */
+BOOST_AUTO_TEST_CASE(SingleLinkageCutTest)
+{
+  arma::mat inputData = arma::randu<arma::mat>(2, 200);
+
+  DualTreeBoruvka<> dtb(inputData);
+  arma::mat mst;
+  dtb.ComputeMST(mst);
+
+  const double cutDistance = 0.05;
+  arma::Col<size_t> assignments;
+  const size_t clusters = SingleLinkageCut(mst, cutDistance, assignments);
+
+  // Find the connected components of the graph of short distances.
+  arma::Col<size_t> components(inputData.n_cols);
+  components.fill(SIZE_MAX);
+  size_t naiveClusters = 0;
+  for (size_t i = 0; i < inputData.n_cols; ++i)
+  {
+    if (components[i] != SIZE_MAX)
+      continue;
+
+    std::vector<size_t> stack(1, i);
+    components[i] = naiveClusters;
+    while (!stack.empty())
+    {
+      const size_t point = stack.back();
+      stack.pop_back();
+      for (size_t j = 0; j < inputData.n_cols; ++j)
+      {
+        if (components[j] == SIZE_MAX && arma::norm(inputData.col(point) -
+            inputData.col(j), 2) <= cutDistance)
+        {
+          components[j] = naiveClusters;
+          stack.push_back(j);
+        }
+      }
+    }
+    ++naiveClusters;
+  }
+
+  // Both number the clusters in order of their first point.
+  BOOST_REQUIRE_EQUAL(clusters, naiveClusters);
+  for (size_t i = 0; i < inputData.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], components[i]);
+
+  // Cutting into the same number of clusters gives the same clusters.
+  arma::Col<size_t> kAssignments;
+  BOOST_REQUIRE_EQUAL(SingleLinkageClusters(mst, clusters, kAssignments),
+      clusters);
+  for (size_t i = 0; i < inputData.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(kAssignments[i], assignments[i]);
+}
+
+/**
+ * Check the dendrogram on a small one-dimensional dataset.
+ */
+BOOST_AUTO_TEST_CASE(SingleLinkageDendrogramTest)
+{
+  // Points 2 and 3 are closest, then 0 joins them, then 1 and 4 merge, and
+  // then the two groups merge.
+  arma::mat inputData("0.0 10.0 1.5 1.0 11.2");
+
+  DualTreeBoruvka<> dtb(inputData, true);
+  arma::mat mst;
+  dtb.ComputeMST(mst);
+
+  arma::mat dendrogram;
+  SingleLinkageDendrogram(mst, dendrogram);
+
+  BOOST_REQUIRE_EQUAL(dendrogram.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(dendrogram.n_cols, 4);
+
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 0), 2);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 0), 3);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 0), 0.5, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 0), 2);
+
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 1), 0);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 1), 5);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 1), 1.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 1), 3);
+
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 2), 1);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 2), 4);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 2), 1.2, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 2), 2);
+
+  BOOST_REQUIRE_EQUAL(dendrogram(0, 3), 6);
+  BOOST_REQUIRE_EQUAL(dendrogram(1, 3), 7);
+  BOOST_REQUIRE_CLOSE(dendrogram(2, 3), 8.5, 1e-5);
+  BOOST_REQUIRE_EQUAL(dendrogram(3, 3), 5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -8,6 +8,7 @@
 #include <mlpack/methods/fastmks/fastmks.hpp>
 #include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -208,4 +209,188 @@ BOOST_AUTO_TEST_CASE(SparsePolynomialFastMKSTest)
 
 }
 
+/**
+ * Make sure the batched kernel evaluations and self-kernel norms are the same
+ * as the evaluations of the single points.
+ */
+BOOST_AUTO_TEST_CASE(BatchKernelEvaluationTest)
+{
+  arma::mat a = arma::randu<arma::mat>(4, 30);
+  arma::mat b = arma::randu<arma::mat>(4, 20);
+
+  LinearKernel lk;
+  PolynomialKernel pk(3.0, 0.5);
+  GaussianKernel gk(0.8);
+
+  arma::mat linear, polynomial, gaussian;
+  BatchKernelEvaluation<LinearKernel>::Evaluate(lk, a, b, linear);
+  BatchKernelEvaluation<PolynomialKernel>::Evaluate(pk, a, b, polynomial);
+  BatchKernelEvaluation<GaussianKernel>::Evaluate(gk, a, b, gaussian);
+
+  BOOST_REQUIRE_EQUAL(polynomial.n_rows, a.n_cols);
+  BOOST_REQUIRE_EQUAL(polynomial.n_cols, b.n_cols);
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(linear(i, j), lk.Evaluate(a.col(i), b.col(j)), 1e-5);
+      BOOST_REQUIRE_CLOSE(polynomial(i, j), pk.Evaluate(a.col(i), b.col(j)),
+          1e-5);
+      BOOST_REQUIRE_CLOSE(gaussian(i, j), gk.Evaluate(a.col(i), b.col(j)),
+          1e-5);
+    }
+  }
+
+  arma::vec norms;
+  BatchKernelEvaluation<PolynomialKernel>::Norms(pk, a, norms);
+  BOOST_REQUIRE_EQUAL(norms.n_elem, a.n_cols);
+  for (size_t i = 0; i < a.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(norms[i], sqrt(pk.Evaluate(a.col(i), a.col(i))), 1e-5);
+}
+
+/**
+ * Run several searches with different query sets on one FastMKS object, which
+ * reuses the reference self-kernels, and compare with naive search.
+ */
+BOOST_AUTO_TEST_CASE(RepeatedSearchVsNaive)
+{
+  arma::mat data = arma::randn<arma::mat>(5, 1000);
+  PolynomialKernel pk(2.0, 1.0);
+
+  FastMKS<PolynomialKernel> naive(data, pk, false, true);
+  FastMKS<PolynomialKernel> single(data, pk, true);
+  FastMKS<PolynomialKernel> dual(data, pk);
+
+  for (size_t trial = 0; trial < 3; ++trial)
+  {
+    // More than one block of the naive search.
+    arma::mat queries = arma::randn<arma::mat>(5, 300);
+
+    arma::Mat<size_t> naiveIndices, singleIndices, dualIndices;
+    arma::mat naiveProducts, singleProducts, dualProducts;
+    naive.Search(queries, 5, naiveIndices, naiveProducts);
+    single.Search(queries, 5, singleIndices, singleProducts);
+    dual.Search(queries, 5, dualIndices, dualProducts);
+
+    for (size_t q = 0; q < naiveIndices.n_cols; ++q)
+    {
+      for (size_t r = 0; r < naiveIndices.n_rows; ++r)
+      {
+        BOOST_REQUIRE_CLOSE(singleProducts(r, q), naiveProducts(r, q), 1e-5);
+        BOOST_REQUIRE_CLOSE(dualProducts(r, q), naiveProducts(r, q), 1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Compare the task-parallel dual-tree traverser with naive search, on a
+ * dataset large enough that the query tree is split into several tasks.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+  arma::mat data = arma::randn<arma::mat>(5, 4000);
+  LinearKernel lk;
+
+  FastMKS<LinearKernel> naive(data, lk, false, true);
+
+  typedef CoverTree<IPMetric<LinearKernel>, FirstPointIsRoot, FastMKSStat>
+      TreeType;
+  FastMKS<LinearKernel, TreeType, TreeType::ParallelDualTreeTraverser>
+      parallel(data, lk);
+
+  arma::Mat<size_t> naiveIndices, parallelIndices;
+  arma::mat naiveProducts, parallelProducts;
+  naive.Search(10, naiveIndices, naiveProducts);
+  parallel.Search(10, parallelIndices, parallelProducts);
+
+  for (size_t q = 0; q < naiveIndices.n_cols; ++q)
+  {
+    for (size_t r = 0; r < naiveIndices.n_rows; ++r)
+    {
+      BOOST_REQUIRE_EQUAL(parallelIndices(r, q), naiveIndices(r, q));
+      BOOST_REQUIRE_CLOSE(parallelProducts(r, q), naiveProducts(r, q), 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure approximate search returns, for every rank, a kernel value within a
+ * factor of (1 + epsilon) of the exact one, in single-tree and dual-tree mode.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateVsNaive)
+{
+  // With nonnegative data, every linear kernel value is nonnegative.
+  arma::mat data = arma::randu<arma::mat>(5, 1000);
+  LinearKernel lk;
+  const double epsilon = 0.2;
+
+  FastMKS<LinearKernel> naive(data, lk, false, true);
+  FastMKS<LinearKernel> single(data, lk, true);
+  FastMKS<LinearKernel> dual(data, lk);
+  single.Epsilon() = epsilon;
+  dual.Epsilon() = epsilon;
+
+  arma::Mat<size_t> naiveIndices, singleIndices, dualIndices;
+  arma::mat naiveProducts, singleProducts, dualProducts;
+  naive.Search(10, naiveIndices, naiveProducts);
+  single.Search(10, singleIndices, singleProducts);
+  dual.Search(10, dualIndices, dualProducts);
+
+  for (size_t q = 0; q < naiveIndices.n_cols; ++q)
+  {
+    for (size_t r = 0; r < naiveIndices.n_rows; ++r)
+    {
+      BOOST_REQUIRE_GE((1 + epsilon) * singleProducts(r, q) + 1e-10,
+          naiveProducts(r, q));
+      BOOST_REQUIRE_GE((1 + epsilon) * dualProducts(r, q) + 1e-10,
+          naiveProducts(r, q));
+
+      // The results must still be real kernel values.
+      BOOST_REQUIRE_CLOSE(singleProducts(r, q), arma::dot(data.col(q),
+          data.col(singleIndices(r, q))), 1e-5);
+      BOOST_REQUIRE_CLOSE(dualProducts(r, q), arma::dot(data.col(q),
+          data.col(dualIndices(r, q))), 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure a limit on the number of base cases gives valid results, and that a
+ * limit that is never reached gives exact results.
+ */
+BOOST_AUTO_TEST_CASE(MaxBaseCasesTest)
+{
+  arma::mat data = arma::randn<arma::mat>(5, 1000);
+  LinearKernel lk;
+
+  FastMKS<LinearKernel> naive(data, lk, false, true);
+  FastMKS<LinearKernel> limited(data, lk, true);
+  FastMKS<LinearKernel> unlimited(data, lk, true);
+  limited.MaxBaseCases() = 50;
+  unlimited.MaxBaseCases() = 1000000;
+
+  arma::Mat<size_t> naiveIndices, limitedIndices, unlimitedIndices;
+  arma::mat naiveProducts, limitedProducts, unlimitedProducts;
+  naive.Search(5, naiveIndices, naiveProducts);
+  limited.Search(5, limitedIndices, limitedProducts);
+  unlimited.Search(5, unlimitedIndices, unlimitedProducts);
+
+  for (size_t q = 0; q < naiveIndices.n_cols; ++q)
+  {
+    for (size_t r = 0; r < naiveIndices.n_rows; ++r)
+    {
+      BOOST_REQUIRE_EQUAL(unlimitedIndices(r, q), naiveIndices(r, q));
+      BOOST_REQUIRE_CLOSE(unlimitedProducts(r, q), naiveProducts(r, q), 1e-5);
+
+      // Found results are real kernel values and can't beat the exact ones.
+      if (limitedProducts(r, q) == -DBL_MAX)
+        continue;
+      BOOST_REQUIRE_LE(limitedProducts(r, q), naiveProducts(r, q) + 1e-10);
+      BOOST_REQUIRE_CLOSE(limitedProducts(r, q), arma::dot(data.col(q),
+          data.col(limitedIndices(r, q))), 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
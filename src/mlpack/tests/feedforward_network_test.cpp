@@ -8,18 +8,24 @@
 
 #include <mlpack/methods/ann/activation_functions/logistic_function.hpp>
 #include <mlpack/methods/ann/activation_functions/tanh_function.hpp>
+#include <mlpack/methods/ann/activation_functions/identity_function.hpp>
 
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
 
 #include <mlpack/methods/ann/layer/neuron_layer.hpp>
 #include <mlpack/methods/ann/layer/bias_layer.hpp>
 #include <mlpack/methods/ann/layer/binary_classification_layer.hpp>
+#include <mlpack/methods/ann/layer/multiclass_classification_layer.hpp>
 
 #include <mlpack/methods/ann/connections/full_connection.hpp>
+#include <mlpack/methods/ann/connections/sparse_full_connection.hpp>
 
 #include <mlpack/methods/ann/trainer/trainer.hpp>
+#include <mlpack/methods/ann/trainer/parallel_trainer.hpp>
 
 #include <mlpack/methods/ann/ffnn.hpp>
+#include <mlpack/methods/ann/frozen_ffnn.hpp>
+#include <mlpack/methods/ann/memory_planner.hpp>
 
 #include <mlpack/methods/ann/performance_functions/mse_function.hpp>
 #include <mlpack/methods/ann/performance_functions/sse_function.hpp>
@@ -376,4 +382,501 @@ BOOST_AUTO_TEST_CASE(NetworkDecreasingErrorTest)
       (dataset, labels, dataset, labels, 100, 50, randInitB);
 }
 
+/**
+ * Train a network with the specified layer data type and trainer error type and
+ * return the final validation error.
+ */
+template<typename DataType, typename VecType>
+double TrainBatchNetwork(arma::mat& data,
+                         arma::mat& labels,
+                         const size_t batchSize,
+                         const size_t epochs)
+{
+  math::RandomSeed(42);
+  RandomInitialization randInit(-0.5, 0.5);
+
+  BiasLayer<IdentityFunction, DataType> biasLayer0(1);
+
+  NeuronLayer<LogisticFunction, DataType> inputLayer(data.n_rows);
+  NeuronLayer<LogisticFunction, DataType> hiddenLayer0(8);
+  NeuronLayer<LogisticFunction, DataType> hiddenLayer1(labels.n_rows);
+
+  BinaryClassificationLayer outputLayer;
+
+  SteepestDescent<> conOptimizer0(data.n_rows, 8);
+  SteepestDescent<> conOptimizer1(1, 8);
+  SteepestDescent<> conOptimizer2(8, labels.n_rows);
+
+  FullConnection<
+    decltype(inputLayer),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer0),
+    decltype(randInit)>
+    layerCon0(inputLayer, hiddenLayer0, conOptimizer0, randInit);
+
+  FullConnection<
+    decltype(biasLayer0),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer1),
+    decltype(randInit)>
+    layerCon1(biasLayer0, hiddenLayer0, conOptimizer1, randInit);
+
+  FullConnection<
+      decltype(hiddenLayer0),
+      decltype(hiddenLayer1),
+      decltype(conOptimizer2),
+      decltype(randInit)>
+      layerCon2(hiddenLayer0, hiddenLayer1, conOptimizer2, randInit);
+
+  auto module0 = std::tie(layerCon0, layerCon1);
+  auto module1 = std::tie(layerCon2);
+  auto modules = std::tie(module0, module1);
+
+  FFNN<decltype(modules), decltype(outputLayer), MeanSquaredErrorFunction>
+      net(modules, outputLayer);
+
+  Trainer<decltype(net), arma::mat, VecType> trainer(net, epochs, batchSize,
+      0, false);
+  trainer.Train(data, labels, data, labels);
+
+  return trainer.ValidationError();
+}
+
+/**
+ * Make sure that propagating whole mini-batches through the network takes the
+ * same steps as accumulating the gradients sample by sample.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchNetworkTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 60);
+  arma::mat labels = arma::zeros<arma::mat>(1, 60);
+  for (size_t i = 0; i < data.n_cols; i++)
+    labels(0, i) = (data(0, i) + data(1, i) > 1) ? 1 : 0;
+
+  const double sequentialError = TrainBatchNetwork<arma::colvec, arma::colvec>(
+      data, labels, 12, 3);
+  const double batchError = TrainBatchNetwork<arma::mat, arma::mat>(data,
+      labels, 12, 3);
+
+  BOOST_REQUIRE_CLOSE(sequentialError, batchError, 1e-5);
+}
+
+/**
+ * Train a network with the given element type, starting from the given
+ * weights, and return the final validation error.
+ */
+template<typename eT>
+double TrainPrecisionNetwork(const arma::mat& trainData,
+                             const arma::mat& trainLabels,
+                             const arma::mat& weights0,
+                             const arma::mat& weights1,
+                             const arma::mat& weights2)
+{
+  typedef arma::Mat<eT> MatType;
+  typedef arma::Col<eT> VecType;
+
+  MatType data = arma::conv_to<MatType>::from(trainData);
+  MatType labels = arma::conv_to<MatType>::from(trainLabels);
+
+  BiasLayer<IdentityFunction, VecType> biasLayer0(1);
+
+  NeuronLayer<LogisticFunction, VecType> inputLayer(data.n_rows);
+  NeuronLayer<LogisticFunction, VecType> hiddenLayer0(weights0.n_rows);
+  NeuronLayer<LogisticFunction, VecType> hiddenLayer1(labels.n_rows);
+
+  BinaryClassificationLayer outputLayer;
+
+  SteepestDescent<MatType> conOptimizer0(data.n_rows, weights0.n_rows);
+  SteepestDescent<MatType> conOptimizer1(1, weights0.n_rows);
+  SteepestDescent<MatType> conOptimizer2(weights0.n_rows, labels.n_rows);
+
+  FullConnection<
+    decltype(inputLayer),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer0),
+    RandomInitialization,
+    MatType>
+    layerCon0(inputLayer, hiddenLayer0, conOptimizer0);
+
+  FullConnection<
+    decltype(biasLayer0),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer1),
+    RandomInitialization,
+    MatType>
+    layerCon1(biasLayer0, hiddenLayer0, conOptimizer1);
+
+  FullConnection<
+      decltype(hiddenLayer0),
+      decltype(hiddenLayer1),
+      decltype(conOptimizer2),
+      RandomInitialization,
+      MatType>
+      layerCon2(hiddenLayer0, hiddenLayer1, conOptimizer2);
+
+  layerCon0.Weights() = arma::conv_to<MatType>::from(weights0);
+  layerCon1.Weights() = arma::conv_to<MatType>::from(weights1);
+  layerCon2.Weights() = arma::conv_to<MatType>::from(weights2);
+
+  auto module0 = std::tie(layerCon0, layerCon1);
+  auto module1 = std::tie(layerCon2);
+  auto modules = std::tie(module0, module1);
+
+  FFNN<decltype(modules), decltype(outputLayer), MeanSquaredErrorFunction,
+      MatType> net(modules, outputLayer);
+
+  Trainer<decltype(net), MatType, VecType> trainer(net, 5, 1, 0, false);
+  trainer.Train(data, labels, data, labels);
+
+  return trainer.ValidationError();
+}
+
+/**
+ * Make sure that a network can be trained in single precision, and that it
+ * ends up close to the same network trained in double precision.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionNetworkTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 50);
+  arma::mat labels = arma::zeros<arma::mat>(1, 50);
+  for (size_t i = 0; i < data.n_cols; i++)
+    labels(0, i) = (data(0, i) > data(2, i)) ? 1 : 0;
+
+  arma::mat weights0 = arma::randu<arma::mat>(6, 3) - 0.5;
+  arma::mat weights1 = arma::randu<arma::mat>(6, 1) - 0.5;
+  arma::mat weights2 = arma::randu<arma::mat>(1, 6) - 0.5;
+
+  const double doubleError = TrainPrecisionNetwork<double>(data, labels,
+      weights0, weights1, weights2);
+  const double floatError = TrainPrecisionNetwork<float>(data, labels,
+      weights0, weights1, weights2);
+
+  BOOST_REQUIRE_CLOSE(doubleError, floatError, 0.1);
+}
+
+/**
+ * Make sure that the inference-only network computes the same output
+ * activations as the trained network it is constructed from, for a whole batch
+ * at once.
+ */
+BOOST_AUTO_TEST_CASE(FrozenNetworkTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 40);
+  arma::mat labels = arma::zeros<arma::mat>(2, 40);
+  for (size_t i = 0; i < data.n_cols; i++)
+    labels((data(0, i) > data(1, i)) ? 0 : 1, i) = 1;
+
+  BiasLayer<> biasLayer0(1);
+  BiasLayer<> biasLayer1(1);
+
+  NeuronLayer<LogisticFunction> inputLayer(data.n_rows);
+  NeuronLayer<TanhFunction> hiddenLayer0(5);
+  NeuronLayer<LogisticFunction> hiddenLayer1(labels.n_rows);
+
+  MulticlassClassificationLayer<> outputLayer;
+
+  SteepestDescent<> conOptimizer0(data.n_rows, 5);
+  SteepestDescent<> conOptimizer1(1, 5);
+  SteepestDescent<> conOptimizer2(5, labels.n_rows);
+  SteepestDescent<> conOptimizer3(1, labels.n_rows);
+
+  FullConnection<
+    decltype(inputLayer),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer0),
+    RandomInitialization>
+    layerCon0(inputLayer, hiddenLayer0, conOptimizer0);
+
+  FullConnection<
+    decltype(biasLayer0),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer1),
+    RandomInitialization>
+    layerCon1(biasLayer0, hiddenLayer0, conOptimizer1);
+
+  FullConnection<
+    decltype(hiddenLayer0),
+    decltype(hiddenLayer1),
+    decltype(conOptimizer2),
+    RandomInitialization>
+    layerCon2(hiddenLayer0, hiddenLayer1, conOptimizer2);
+
+  FullConnection<
+    decltype(biasLayer1),
+    decltype(hiddenLayer1),
+    decltype(conOptimizer3),
+    RandomInitialization>
+    layerCon3(biasLayer1, hiddenLayer1, conOptimizer3);
+
+  auto module0 = std::tie(layerCon0, layerCon1);
+  auto module1 = std::tie(layerCon3, layerCon2);
+  auto modules = std::tie(module0, module1);
+
+  FFNN<decltype(modules), decltype(outputLayer), MeanSquaredErrorFunction>
+      net(modules, outputLayer);
+
+  Trainer<decltype(net)> trainer(net, 5, 1, 0, false);
+  trainer.Train(data, labels, data, labels);
+
+  FrozenFFNN<decltype(modules), decltype(outputLayer)> frozen(net.Network(),
+      outputLayer);
+  BOOST_REQUIRE_EQUAL(frozen.Layers(), 2);
+  BOOST_REQUIRE_EQUAL(frozen.Parameters().n_elem, 5 * 5 + 2 * 6);
+
+  arma::mat frozenOutput;
+  frozen.Predict(data, frozenOutput);
+  BOOST_REQUIRE_EQUAL(frozenOutput.n_rows, labels.n_rows);
+  BOOST_REQUIRE_EQUAL(frozenOutput.n_cols, data.n_cols);
+
+  for (size_t i = 0; i < data.n_cols; i++)
+  {
+    arma::colvec input = data.col(i);
+    arma::colvec output;
+    net.Predict(input, output);
+
+    for (size_t j = 0; j < output.n_elem; j++)
+      BOOST_REQUIRE_CLOSE(frozenOutput(j, i), output(j), 1e-5);
+  }
+
+  // The quantized network has to give nearly the same outputs.
+  frozen.Quantize();
+  BOOST_REQUIRE(frozen.Quantized());
+  BOOST_REQUIRE_EQUAL(frozen.QuantizedWeights().size(), 5 * 4 + 2 * 5);
+  BOOST_REQUIRE_EQUAL(frozen.Parameters().n_elem, 0);
+
+  arma::mat quantizedOutput;
+  frozen.Predict(data, quantizedOutput);
+  BOOST_REQUIRE_EQUAL(quantizedOutput.n_rows, labels.n_rows);
+  BOOST_REQUIRE_EQUAL(quantizedOutput.n_cols, data.n_cols);
+
+  for (size_t i = 0; i < quantizedOutput.n_elem; i++)
+    BOOST_REQUIRE_SMALL(quantizedOutput(i) - frozenOutput(i), 0.02);
+}
+
+/**
+ * A small network with its own layers and connections, so that several copies
+ * can be trained by the ParallelTrainer.
+ */
+class ReplicaNetwork
+{
+ public:
+  typedef NeuronLayer<LogisticFunction, arma::mat> LayerType;
+  typedef BiasLayer<IdentityFunction, arma::mat> BiasType;
+  typedef FullConnection<LayerType, LayerType, SteepestDescent<>,
+      RandomInitialization> ConnectionType;
+  typedef FullConnection<BiasType, LayerType, SteepestDescent<>,
+      RandomInitialization> BiasConnectionType;
+  typedef std::tuple<ConnectionType&, BiasConnectionType&> Module0Type;
+  typedef std::tuple<ConnectionType&> Module1Type;
+  typedef std::tuple<Module0Type&, Module1Type&> ModulesType;
+  typedef FFNN<ModulesType, BinaryClassificationLayer,
+      MeanSquaredErrorFunction> NetworkType;
+
+  ReplicaNetwork(const size_t inputs, const size_t hidden,
+                 const size_t outputs) :
+      biasLayer(1),
+      inputLayer(inputs),
+      hiddenLayer0(hidden),
+      hiddenLayer1(outputs),
+      layerCon0(inputLayer, hiddenLayer0, RandomInitialization(-0.5, 0.5)),
+      layerCon1(biasLayer, hiddenLayer0, RandomInitialization(-0.5, 0.5)),
+      layerCon2(hiddenLayer0, hiddenLayer1, RandomInitialization(-0.5, 0.5)),
+      module0(layerCon0, layerCon1),
+      module1(layerCon2),
+      modules(module0, module1),
+      net(modules, outputLayer)
+  { }
+
+  BiasType biasLayer;
+  LayerType inputLayer;
+  LayerType hiddenLayer0;
+  LayerType hiddenLayer1;
+  BinaryClassificationLayer outputLayer;
+  ConnectionType layerCon0;
+  BiasConnectionType layerCon1;
+  ConnectionType layerCon2;
+  Module0Type module0;
+  Module1Type module1;
+  ModulesType modules;
+  NetworkType net;
+};
+
+/**
+ * Make sure that the data-parallel trainer takes the same steps as the serial
+ * trainer with the same batch size.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainerTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 60);
+  arma::mat labels = arma::zeros<arma::mat>(1, 60);
+  for (size_t i = 0; i < data.n_cols; i++)
+    labels(0, i) = (data(0, i) + data(1, i) > 1) ? 1 : 0;
+
+  math::RandomSeed(42);
+  ReplicaNetwork serial(3, 8, 1);
+  Trainer<ReplicaNetwork::NetworkType, arma::mat, arma::mat> trainer(
+      serial.net, 5, 12, 0, false);
+  trainer.Train(data, labels, data, labels);
+
+  // The replicas start with other weights, which are overwritten.
+  math::RandomSeed(42);
+  ReplicaNetwork parallel(3, 8, 1);
+  ReplicaNetwork replica0(3, 8, 1), replica1(3, 8, 1), replica2(3, 8, 1);
+  std::vector<ReplicaNetwork::NetworkType*> replicas;
+  replicas.push_back(&replica0.net);
+  replicas.push_back(&replica1.net);
+  replicas.push_back(&replica2.net);
+
+  ParallelTrainer<ReplicaNetwork::NetworkType, arma::mat, arma::mat>
+      parallelTrainer(parallel.net, replicas, 5, 12, 0, false);
+  BOOST_REQUIRE_EQUAL(parallelTrainer.NumWorkers(), 3);
+  parallelTrainer.Train(data, labels, data, labels);
+
+  BOOST_REQUIRE_CLOSE(trainer.ValidationError(),
+      parallelTrainer.ValidationError(), 1e-5);
+
+  for (size_t i = 0; i < serial.layerCon0.Weights().n_elem; i++)
+  {
+    BOOST_REQUIRE_SMALL(serial.layerCon0.Weights()[i] -
+        parallel.layerCon0.Weights()[i], 1e-8);
+  }
+}
+
+/**
+ * Buffers whose lifetimes don't overlap should share memory in the arena, and
+ * buffers that are alive at the same time should not.
+ */
+BOOST_AUTO_TEST_CASE(MemoryPlannerTest)
+{
+  MemoryPlanner planner;
+  const size_t a = planner.Request(100, 0, 1);
+  const size_t b = planner.Request(60, 1, 2);
+  const size_t c = planner.Request(80, 2, 3);
+  const size_t d = planner.Request(30, 3, 3);
+  planner.Plan();
+
+  BOOST_REQUIRE_EQUAL(planner.Buffers(), 4);
+  BOOST_REQUIRE_EQUAL(planner.TotalSize(), 104 + 64 + 80 + 32);
+
+  // a and c are never alive at the same time, so c reuses the memory of a; b
+  // is alive with both, and d with c.
+  BOOST_REQUIRE_EQUAL(planner.Offset(a), 0);
+  BOOST_REQUIRE_EQUAL(planner.Offset(c), 0);
+  BOOST_REQUIRE_EQUAL(planner.Offset(b), 104);
+  BOOST_REQUIRE_EQUAL(planner.Offset(d), 80);
+  BOOST_REQUIRE_EQUAL(planner.ArenaSize(), 168);
+
+  // The views of buffers that share memory alias each other.
+  arma::vec arena(planner.ArenaSize());
+  arma::mat bufferA = planner.Buffer(arena, a, 10, 10);
+  arma::mat bufferC = planner.Buffer(arena, c, 8, 10);
+  bufferA.fill(1.0);
+  BOOST_REQUIRE_EQUAL(bufferC(7, 9), 1.0);
+  bufferC.zeros();
+  BOOST_REQUIRE_EQUAL(arena[79], 0.0);
+  BOOST_REQUIRE_EQUAL(arena[80], 1.0);
+}
+
+/**
+ * Train a network whose first layer is connected with the given connection
+ * type, starting from the given weights, and return the final weights of the
+ * first layer.
+ */
+template<
+    template<typename, typename, typename, class, typename>
+        class ConnectionType,
+    typename InputType
+>
+arma::mat TrainSparseInputNetwork(InputType& data,
+                                  arma::mat& labels,
+                                  const arma::mat& weights0,
+                                  const arma::mat& weights1,
+                                  const arma::mat& weights2)
+{
+  BiasLayer<IdentityFunction, arma::mat> biasLayer0(1);
+
+  NeuronLayer<LogisticFunction, InputType> inputLayer(data.n_rows, 1);
+  NeuronLayer<LogisticFunction, arma::mat> hiddenLayer0(weights0.n_rows);
+  NeuronLayer<LogisticFunction, arma::mat> hiddenLayer1(labels.n_rows);
+
+  BinaryClassificationLayer outputLayer;
+
+  SteepestDescent<> conOptimizer0(0.5);
+  SteepestDescent<> conOptimizer1(1, weights0.n_rows);
+  SteepestDescent<> conOptimizer2(weights0.n_rows, labels.n_rows);
+
+  ConnectionType<
+    decltype(inputLayer),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer0),
+    RandomInitialization,
+    arma::mat>
+    layerCon0(inputLayer, hiddenLayer0, conOptimizer0);
+
+  FullConnection<
+    decltype(biasLayer0),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer1),
+    RandomInitialization>
+    layerCon1(biasLayer0, hiddenLayer0, conOptimizer1);
+
+  FullConnection<
+      decltype(hiddenLayer0),
+      decltype(hiddenLayer1),
+      decltype(conOptimizer2),
+      RandomInitialization>
+      layerCon2(hiddenLayer0, hiddenLayer1, conOptimizer2);
+
+  layerCon0.Weights() = weights0;
+  layerCon1.Weights() = weights1;
+  layerCon2.Weights() = weights2;
+
+  auto module0 = std::tie(layerCon0, layerCon1);
+  auto module1 = std::tie(layerCon2);
+  auto modules = std::tie(module0, module1);
+
+  FFNN<decltype(modules), decltype(outputLayer), MeanSquaredErrorFunction>
+      net(modules, outputLayer);
+
+  Trainer<decltype(net), arma::mat, arma::mat> trainer(net, 3, 10, 0, false);
+  trainer.Train(data, labels, data, labels);
+
+  return layerCon0.Weights();
+}
+
+/**
+ * Make sure that a network with a sparse first layer takes the same steps as
+ * the same network with a dense first layer, and that the weights of features
+ * which are never active are not touched.
+ */
+BOOST_AUTO_TEST_CASE(SparseInputNetworkTest)
+{
+  // A bag-of-words like dataset; the first feature is never active.
+  arma::sp_mat sparseData = arma::sprandu<arma::sp_mat>(200, 80, 0.03);
+  sparseData.row(0).zeros();
+  arma::mat data(sparseData);
+
+  arma::mat labels = arma::zeros<arma::mat>(1, 80);
+  for (size_t i = 0; i < data.n_cols; i++)
+  {
+    labels(0, i) = (arma::accu(data.submat(0, i, 99, i)) >
+        arma::accu(data.submat(100, i, 199, i))) ? 1 : 0;
+  }
+
+  arma::mat weights0 = arma::randu<arma::mat>(6, 200) - 0.5;
+  arma::mat weights1 = arma::randu<arma::mat>(6, 1) - 0.5;
+  arma::mat weights2 = arma::randu<arma::mat>(1, 6) - 0.5;
+
+  const arma::mat denseWeights = TrainSparseInputNetwork<FullConnection>(data,
+      labels, weights0, weights1, weights2);
+  const arma::mat sparseWeights = TrainSparseInputNetwork<
+      SparseFullConnection>(sparseData, labels, weights0, weights1, weights2);
+
+  for (size_t i = 0; i < denseWeights.n_elem; i++)
+    BOOST_REQUIRE_SMALL(sparseWeights[i] - denseWeights[i], 1e-8);
+
+  for (size_t i = 0; i < weights0.n_rows; i++)
+    BOOST_REQUIRE_EQUAL(sparseWeights(i, 0), weights0(i, 0));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -8,6 +8,7 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/online_em_fit.hpp>
 
 #include <mlpack/methods/gmm/no_constraint.hpp>
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
@@ -122,6 +123,36 @@ BOOST_AUTO_TEST_CASE(GMMTrainEMOneGaussian)
   }
 }
 
+/**
+ * Train a single Gaussian on enough points that the E-step and M-step are
+ * split into several blocks (the last one partial), with one point so far away
+ * that its density underflows to zero.  The responsibilities are normalized in
+ * log-space, so that point must still be assigned to the Gaussian, and the
+ * model must be exactly the sample mean and covariance.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrainEMOneGaussianManyBlocks)
+{
+  arma::mat data;
+  data.randn(3 /* dimension */, 2500);
+  data.col(1234) = arma::vec("60 -60 60");
+
+  GMM<> gmm(1, 3);
+  gmm.Estimate(data, 1);
+
+  const arma::vec actualMean = arma::mean(data, 1);
+  const arma::mat actualCovar = ccov(data, 1 /* biased estimator */);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gmm.Component(0).Mean()[i], actualMean(i), 1e-5);
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_REQUIRE_CLOSE(gmm.Component(0).Covariance()(i, j),
+          actualCovar(i, j), 1e-5);
+  }
+
+  BOOST_REQUIRE_CLOSE(gmm.Weights()[0], 1.0, 1e-5);
+}
+
 /**
  * Test a training model on multiple Gaussians in higher dimensionality than
  * two.  We will hold the dataset size constant at 10k points.  The EM algorithm
@@ -481,6 +512,42 @@ BOOST_AUTO_TEST_CASE(GMMClassifyTest)
   BOOST_REQUIRE_EQUAL(classes[12], 2);
 }
 
+/**
+ * Scoring many observations at once (in several blocks, the last one partial)
+ * should give the same results as scoring each observation alone.
+ */
+BOOST_AUTO_TEST_CASE(GMMBlockedScoringTest)
+{
+  GMM<> gmm(3, 2);
+  gmm.Component(0) = distribution::GaussianDistribution("0 0", "1 0; 0 1");
+  gmm.Component(1) = distribution::GaussianDistribution("1 3", "3 2; 2 3");
+  gmm.Component(2) = distribution::GaussianDistribution("-2 -2",
+      "2.2 1.4; 1.4 5.1");
+  gmm.Weights() = "0.6 0.25 0.15";
+
+  arma::mat observations = 4 * arma::randn<arma::mat>(2, 2500);
+
+  arma::vec logProbabilities;
+  arma::Col<size_t> classes;
+  gmm.LogProbability(observations, logProbabilities);
+  gmm.Classify(observations, classes);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, 2500);
+  BOOST_REQUIRE_EQUAL(classes.n_elem, 2500);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logProbabilities[i],
+        std::log(gmm.Probability(observations.col(i))), 1e-5);
+
+    size_t label = 0;
+    for (size_t j = 1; j < 3; ++j)
+      if (gmm.Probability(observations.col(i), j) >
+          gmm.Probability(observations.col(i), label))
+        label = j;
+    BOOST_REQUIRE_EQUAL(classes[i], label);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(GMMLoadSaveTest)
 {
   // Create a GMM, save it, and load it.
@@ -764,4 +831,148 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
 }
 
 
+/**
+ * Make sure that several trials give the same model for the same random seed,
+ * even though they are fit in parallel.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrialsReproducibleTest)
+{
+  arma::mat data(3, 600);
+  data.randn();
+  data.cols(200, 399) += 8.0;
+  data.cols(400, 599) -= 8.0;
+
+  GMM<> gmm(3, 3);
+  math::RandomSeed(12);
+  const double likelihood = gmm.Estimate(data, 6);
+
+  GMM<> gmm2(3, 3);
+  math::RandomSeed(12);
+  const double likelihood2 = gmm2.Estimate(data, 6);
+
+  BOOST_REQUIRE_CLOSE(likelihood, likelihood2, 1e-10);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[i], gmm2.Weights()[i], 1e-10);
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Mean()[j],
+          gmm2.Component(i).Mean()[j], 1e-10);
+  }
+}
+
+/**
+ * A GMM of DiagonalGaussianDistributions should find the same model as a GMM
+ * whose full covariances are constrained to be diagonal.
+ */
+BOOST_AUTO_TEST_CASE(GMMTrainEMDiagonalGaussians)
+{
+  const size_t dims = 6;
+  const size_t gaussians = 3;
+
+  // Three well-separated Gaussians with diagonal covariances.
+  arma::mat data(dims, 900);
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    arma::vec stddevs = 0.5 + arma::randu<arma::vec>(dims);
+    arma::mat points = arma::randn<arma::mat>(dims, 300);
+    points.each_col() %= stddevs;
+    points += 20.0 * i;
+    data.cols(300 * i, 300 * i + 299) = points;
+  }
+
+  GMM<EMFit<>, distribution::DiagonalGaussianDistribution> gmm(gaussians,
+      dims);
+  math::RandomSeed(7);
+  const double likelihood = gmm.Estimate(data, 1);
+
+  GMM<EMFit<kmeans::KMeans<>, DiagonalConstraint> > fullGmm(gaussians, dims);
+  math::RandomSeed(7);
+  const double fullLikelihood = fullGmm.Estimate(data, 1);
+
+  BOOST_REQUIRE_CLOSE(likelihood, fullLikelihood, 1e-3);
+
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    // Match the components by their means, since the weights are all equal.
+    size_t match = 0;
+    for (size_t j = 1; j < gaussians; ++j)
+      if (std::abs(fullGmm.Component(j).Mean()[0] -
+          gmm.Component(i).Mean()[0]) < std::abs(
+          fullGmm.Component(match).Mean()[0] - gmm.Component(i).Mean()[0]))
+        match = j;
+
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[i], fullGmm.Weights()[match], 1e-3);
+    for (size_t d = 0; d < dims; ++d)
+    {
+      BOOST_REQUIRE_SMALL(gmm.Component(i).Mean()[d] -
+          fullGmm.Component(match).Mean()[d], 1e-5);
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Covariance()[d],
+          fullGmm.Component(match).Covariance()(d, d), 1e-3);
+    }
+  }
+
+  // The diagonal model gives the same densities, and is much smaller.
+  arma::vec logProbs, fullLogProbs;
+  gmm.LogProbability(data, logProbs);
+  fullGmm.LogProbability(data, fullLogProbs);
+  for (size_t i = 0; i < data.n_cols; i += 10)
+    BOOST_REQUIRE_CLOSE(logProbs[i], fullLogProbs[i], 1e-3);
+
+  BOOST_REQUIRE_LT(gmm.MemoryUsage(), fullGmm.MemoryUsage());
+}
+
+/**
+ * Streaming well-separated Gaussians from file through the online EM fitter,
+ * one chunk at a time, should find the same model as batch EM.
+ */
+BOOST_AUTO_TEST_CASE(GMMOnlineEMStreamTest)
+{
+  // Three well-separated Gaussians, shuffled so that every chunk holds points
+  // of each of them.
+  arma::mat data(3, 6000);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    arma::mat points = arma::randn<arma::mat>(3, 2000);
+    points.row(i) *= 2.0;
+    points += 15.0 * i;
+    data.cols(2000 * i, 2000 * i + 1999) = points;
+  }
+  data = data.cols(arma::shuffle(arma::linspace<arma::uvec>(0, 5999, 6000)));
+  data::Save("test-gmm-online.csv", data);
+
+  GMM<> batchGmm(3, 3);
+  batchGmm.Estimate(data, 1);
+
+  OnlineEMFit<> fitter(1000);
+  GMM<OnlineEMFit<> > gmm(3, 3, fitter);
+
+  data::ChunkedLoader<double> loader("test-gmm-online.csv", true);
+  arma::mat chunk;
+  BOOST_REQUIRE(loader.NextChunk(chunk, 1000));
+  gmm.Estimate(chunk);
+  while (loader.NextChunk(chunk, 1000))
+    gmm.Estimate(chunk, 1, true);
+
+  BOOST_REQUIRE_EQUAL(fitter.Updates(), 6);
+
+  // Match each Gaussian to the batch Gaussian with the closest mean.
+  for (size_t i = 0; i < 3; ++i)
+  {
+    size_t match = 0;
+    for (size_t j = 1; j < 3; ++j)
+      if (arma::norm(batchGmm.Component(j).Mean() - gmm.Component(i).Mean()) <
+          arma::norm(batchGmm.Component(match).Mean() -
+          gmm.Component(i).Mean()))
+        match = j;
+
+    BOOST_REQUIRE_SMALL(gmm.Weights()[i] - batchGmm.Weights()[match], 0.03);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(i).Mean() -
+        batchGmm.Component(match).Mean()), 0.3);
+    BOOST_REQUIRE_SMALL(arma::norm(gmm.Component(i).Covariance() -
+        batchGmm.Component(match).Covariance()), 1.0);
+  }
+
+  remove("test-gmm-online.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
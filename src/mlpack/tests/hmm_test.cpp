@@ -5,6 +5,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_regression.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -517,6 +518,137 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLogLikelihoodTest)
       -24.51556128368, 1e-5);
 }
 
+/**
+ * Make sure that scoring a batch of sequences gives the same log-likelihoods as
+ * scoring each sequence on its own.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteHMMBatchLogLikelihoodTest)
+{
+  arma::vec initial("0.5 0.2 0.3");
+  arma::mat transition("0.5 0.0 0.1;"
+                       "0.2 0.6 0.2;"
+                       "0.3 0.4 0.7");
+  std::vector<DiscreteDistribution> emission(3);
+  emission[0].Probabilities() = "0.75 0.25 0.00 0.00";
+  emission[1].Probabilities() = "0.00 0.25 0.25 0.50";
+  emission[2].Probabilities() = "0.10 0.40 0.40 0.10";
+
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> sequences;
+  sequences.push_back(arma::mat("0 1 2 3"));
+  sequences.push_back(arma::mat("1 2 0 0"));
+  sequences.push_back(arma::mat("3 3 3 3"));
+  sequences.push_back(arma::mat("0 2 2 1 2 3 0 0 1 3 1 0 0 3 1 2 2"));
+
+  arma::vec logLikelihoods;
+  hmm.LogLikelihood(sequences, logLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_elem, 4);
+  BOOST_REQUIRE_CLOSE(logLikelihoods[0], -4.9887223949, 1e-5);
+  BOOST_REQUIRE_CLOSE(logLikelihoods[1], -6.0288487077, 1e-5);
+  BOOST_REQUIRE_CLOSE(logLikelihoods[2], -5.5544000018, 1e-5);
+  BOOST_REQUIRE_CLOSE(logLikelihoods[3], -24.51556128368, 1e-5);
+}
+
+/**
+ * The emission densities of observations far from every Gaussian underflow to
+ * zero, but the log-likelihood of the sequence must still be finite and
+ * correct.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMUnderflowLogLikelihoodTest)
+{
+  GaussianDistribution g("0.0 0.0", "1.0 0.0; 0.0 1.0");
+  std::vector<GaussianDistribution> emission(2, g);
+
+  arma::vec initial("0.5 0.5");
+  arma::mat transition("0.5 0.5; 0.5 0.5");
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  // exp(-0.5 * 2 * 50^2) is far below the smallest double.
+  arma::mat observations(2, 10);
+  observations.fill(50.0);
+  observations.row(1) *= -1;
+
+  double logLikelihood = 0.0;
+  for (size_t i = 0; i < observations.n_cols; ++i)
+    logLikelihood += g.LogProbability(observations.unsafe_col(i));
+
+  BOOST_REQUIRE_CLOSE(hmm.LogLikelihood(observations), logLikelihood, 1e-5);
+
+  // The state probabilities must be unaffected.
+  arma::mat stateProb;
+  hmm.Estimate(observations, stateProb);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(stateProb(0, i), 0.5, 1e-5);
+    BOOST_REQUIRE_CLOSE(stateProb(1, i), 0.5, 1e-5);
+  }
+}
+
+/**
+ * Make sure that beam-pruned Viterbi decoding matches full decoding when the
+ * beam is wide, never finds a better sequence than full decoding when it is
+ * narrow, and that batch decoding matches decoding each sequence alone.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteHMMBeamViterbiTest)
+{
+  // A random HMM with ten states and six emissions.
+  const size_t states = 10;
+  arma::mat transition;
+  transition.randu(states, states);
+  for (size_t i = 0; i < states; ++i)
+    transition.col(i) /= accu(transition.col(i));
+
+  std::vector<DiscreteDistribution> emission(states);
+  for (size_t i = 0; i < states; ++i)
+  {
+    arma::vec probabilities;
+    probabilities.randu(6);
+    emission[i].Probabilities() = probabilities / accu(probabilities);
+  }
+
+  arma::vec initial = arma::ones<arma::vec>(states) / (double) states;
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> sequences(5);
+  std::vector<arma::Col<size_t> > fullStates(5);
+  arma::vec fullLogLikelihoods(5);
+  for (size_t i = 0; i < 5; ++i)
+  {
+    arma::Col<size_t> generatedStates;
+    hmm.Generate(100, sequences[i], generatedStates);
+    fullLogLikelihoods[i] = hmm.Predict(sequences[i], fullStates[i]);
+
+    // A beam wider than any difference in log-probability prunes nothing.
+    arma::Col<size_t> beamStates;
+    const double beamLogLikelihood = hmm.Predict(sequences[i], beamStates,
+        1e5);
+    BOOST_REQUIRE_CLOSE(beamLogLikelihood, fullLogLikelihoods[i], 1e-5);
+    for (size_t t = 0; t < 100; ++t)
+      BOOST_REQUIRE_EQUAL(beamStates[t], fullStates[i][t]);
+
+    // A narrow beam can only do as well as full decoding.
+    const double narrowLogLikelihood = hmm.Predict(sequences[i], beamStates,
+        0.5);
+    BOOST_REQUIRE_EQUAL(beamStates.n_elem, 100);
+    BOOST_REQUIRE_LE(narrowLogLikelihood, fullLogLikelihoods[i] + 1e-10);
+  }
+
+  std::vector<arma::Col<size_t> > batchStates;
+  arma::vec batchLogLikelihoods;
+  hmm.Predict(sequences, batchStates, batchLogLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(batchStates.size(), 5);
+  BOOST_REQUIRE_EQUAL(batchLogLikelihoods.n_elem, 5);
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(batchLogLikelihoods[i], fullLogLikelihoods[i], 1e-5);
+    for (size_t t = 0; t < 100; ++t)
+      BOOST_REQUIRE_EQUAL(batchStates[i][t], fullStates[i][t]);
+  }
+}
+
 /**
  * A simple test to make sure HMMs with Gaussian output distributions work.
  */
@@ -1142,5 +1274,68 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLoadSaveTest)
   }
 }
 
-BOOST_AUTO_TEST_SUITE_END();
+/**
+ * Make sure that the emissions of all states of an HMM regression, computed at
+ * once, are the same as the emissions of each state and observation.
+ */
+BOOST_AUTO_TEST_CASE(HMMRegressionBatchEmissionTest)
+{
+  // Two regressions with different slopes on two predictors.
+  arma::mat predictors = arma::randu<arma::mat>(2, 200);
+  arma::vec responses0 = arma::trans(2.0 * predictors.row(0) -
+      predictors.row(1) + 0.5) + 0.1 * arma::randn<arma::vec>(200);
+  arma::vec responses1 = arma::trans(-1.0 * predictors.row(0) +
+      3.0 * predictors.row(1)) + 0.2 * arma::randn<arma::vec>(200);
+
+  std::vector<RegressionDistribution> emissions;
+  emissions.push_back(RegressionDistribution(predictors, responses0));
+  emissions.push_back(RegressionDistribution(predictors, responses1));
+
+  arma::mat observations(3, 50);
+  observations.row(0) = arma::randu<arma::rowvec>(50) * 3.0;
+  observations.rows(1, 2) = arma::randu<arma::mat>(2, 50);
+
+  arma::mat logProbabilities, predictions;
+  RegressionDistribution::LogProbability(emissions, observations,
+      logProbabilities);
+  RegressionDistribution::Predict(emissions, observations.rows(1, 2),
+      predictions);
+
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_cols, 50);
+  for (size_t i = 0; i < emissions.size(); ++i)
+  {
+    arma::vec statePredictions;
+    emissions[i].Predict(observations.rows(1, 2), statePredictions);
+
+    for (size_t t = 0; t < observations.n_cols; ++t)
+    {
+      BOOST_REQUIRE_CLOSE(logProbabilities(i, t),
+          log(emissions[i].Probability(observations.unsafe_col(t))), 1e-5);
+      BOOST_REQUIRE_CLOSE(predictions(i, t), statePredictions[t], 1e-5);
+    }
+  }
+
+  // The smoothed responses are the predictions of each state, weighted by the
+  // state probabilities.
+  arma::vec initial("0.5 0.5");
+  arma::mat transition("0.9 0.2; 0.1 0.8");
+  HMMRegression hmmr(initial, transition, emissions);
+
+  arma::mat stateProb;
+  arma::vec smoothSeq;
+  hmmr.Estimate(observations.rows(1, 2), arma::trans(observations.row(0)),
+      stateProb);
+  hmmr.Smooth(observations.rows(1, 2), arma::trans(observations.row(0)),
+      smoothSeq);
+
+  BOOST_REQUIRE_EQUAL(smoothSeq.n_elem, 50);
+  for (size_t t = 0; t < observations.n_cols; ++t)
+  {
+    const double expected = stateProb(0, t) * predictions(0, t) +
+        stateProb(1, t) * predictions(1, t);
+    BOOST_REQUIRE_CLOSE(smoothSeq[t], expected, 1e-5);
+  }
+}
 
+BOOST_AUTO_TEST_SUITE_END();
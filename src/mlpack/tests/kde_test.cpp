@@ -0,0 +1,187 @@
+/**
+ * @file kde_test.cpp
+ * @author Ryan Curtin
+ *
+ * Test file for the KDE class.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/methods/kde/kde.hpp>
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::kde;
+using namespace mlpack::kernel;
+using namespace mlpack::metric;
+using namespace mlpack::tree;
+using namespace mlpack::bound;
+
+BOOST_AUTO_TEST_SUITE(KDETest);
+
+/**
+ * Compute the average kernel values by brute force.
+ */
+template<typename KernelType>
+void BruteForceKDE(const arma::mat& referenceSet,
+                   const arma::mat& querySet,
+                   const KernelType& kernel,
+                   arma::vec& estimations)
+{
+  estimations.zeros(querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+      estimations[i] += kernel.Evaluate(EuclideanDistance::Evaluate(
+          querySet.col(i), referenceSet.col(j)));
+  estimations /= referenceSet.n_cols;
+}
+
+/**
+ * Make sure each estimate is within the error tolerances of the exact value.
+ */
+void CheckEstimations(const arma::vec& estimations,
+                      const arma::vec& exact,
+                      const double relError,
+                      const double absError)
+{
+  BOOST_REQUIRE_EQUAL(estimations.n_elem, exact.n_elem);
+  for (size_t i = 0; i < exact.n_elem; ++i)
+    BOOST_REQUIRE_LE(std::abs(estimations[i] - exact[i]),
+        relError * exact[i] + absError + 1e-12);
+}
+
+/**
+ * Check naive mode on a tiny hand-computed example.
+ */
+BOOST_AUTO_TEST_CASE(NaiveKDETest)
+{
+  arma::mat reference("0 1 3");
+  arma::mat query("0 2");
+
+  KDE<> kde(reference, 0.0, 0.0, true);
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+
+  // The Gaussian kernel with bandwidth 1 is exp(-d^2 / 2).
+  BOOST_REQUIRE_EQUAL(estimations.n_elem, 2);
+  BOOST_REQUIRE_CLOSE(estimations[0],
+      (1.0 + exp(-0.5) + exp(-4.5)) / 3.0, 1e-8);
+  BOOST_REQUIRE_CLOSE(estimations[1],
+      (exp(-2.0) + exp(-0.5) + exp(-0.5)) / 3.0, 1e-8);
+}
+
+/**
+ * With no error tolerance and the Epanechnikov kernel, only combinations that
+ * are entirely outside the support of the kernel are pruned, so single-tree and
+ * dual-tree estimates must match the exact results.
+ */
+BOOST_AUTO_TEST_CASE(ExactEpanechnikovTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 1000);
+  arma::mat query = arma::randu<arma::mat>(3, 300);
+  EpanechnikovKernel kernel(0.2);
+
+  arma::vec exact;
+  BruteForceKDE(reference, query, kernel, exact);
+
+  typedef KDE<EuclideanDistance, EpanechnikovKernel> KDEType;
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    KDEType kde(reference, 0.0, 0.0, false, (mode == 1), kernel);
+    arma::vec estimations;
+    kde.Evaluate(query, estimations);
+
+    CheckEstimations(estimations, exact, 0.0, 0.0);
+  }
+}
+
+/**
+ * Make sure that single-tree, dual-tree, and monochromatic estimates with the
+ * Gaussian kernel are within the given relative error of the exact results.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateGaussianTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(3, 2000);
+  arma::mat query = arma::randu<arma::mat>(3, 500);
+  GaussianKernel kernel(0.1);
+  const double relError = 0.05;
+
+  arma::vec exact, exactMono;
+  BruteForceKDE(reference, query, kernel, exact);
+  BruteForceKDE(reference, reference, kernel, exactMono);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    KDE<> kde(reference, relError, 0.0, false, (mode == 1), kernel);
+
+    arma::vec estimations;
+    kde.Evaluate(query, estimations);
+    CheckEstimations(estimations, exact, relError, 0.0);
+
+    kde.Evaluate(estimations);
+    CheckEstimations(estimations, exactMono, relError, 0.0);
+  }
+}
+
+/**
+ * Make sure that the absolute error tolerance is respected.
+ */
+BOOST_AUTO_TEST_CASE(AbsoluteErrorTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(2, 1000);
+  arma::mat query = arma::randu<arma::mat>(2, 300);
+  GaussianKernel kernel(0.05);
+  const double absError = 0.01;
+
+  arma::vec exact;
+  BruteForceKDE(reference, query, kernel, exact);
+
+  KDE<> kde(reference, 0.0, absError, false, false, kernel);
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+  CheckEstimations(estimations, exact, 0.0, absError);
+}
+
+/**
+ * Run KDE with pre-built ball trees, to make sure other tree types work, and
+ * that results for a given query tree are in the order of the tree's dataset.
+ */
+BOOST_AUTO_TEST_CASE(BallTreeKDETest)
+{
+  typedef BinarySpaceTree<BallBound<arma::vec, LMetric<2, true> >,
+      EmptyStatistic> TreeType;
+
+  arma::mat reference = arma::randu<arma::mat>(4, 1000);
+  arma::mat query = arma::randu<arma::mat>(4, 400);
+  GaussianKernel kernel(0.3);
+  const double relError = 0.02;
+
+  std::vector<size_t> oldFromNewReferences, oldFromNewQueries;
+  TreeType referenceTree(reference, oldFromNewReferences, 10);
+  TreeType queryTree(query, oldFromNewQueries, 10);
+
+  // The datasets have been rearranged by tree building.
+  arma::vec exact;
+  BruteForceKDE(reference, query, kernel, exact);
+
+  KDE<EuclideanDistance, GaussianKernel, TreeType> kde(&referenceTree,
+      relError, 0.0, false, kernel);
+  arma::vec estimations;
+  kde.Evaluate(&queryTree, estimations);
+
+  CheckEstimations(estimations, exact, relError, 0.0);
+}
+
+/**
+ * Negative error tolerances must be rejected.
+ */
+BOOST_AUTO_TEST_CASE(InvalidErrorTest)
+{
+  arma::mat reference = arma::randu<arma::mat>(2, 10);
+
+  BOOST_REQUIRE_THROW(KDE<>(reference, -0.1, 0.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(KDE<>(reference, 0.1, -1.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/nystroem_method/ordered_selection.hpp>
 #include <mlpack/methods/kernel_pca/kernel_pca.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -145,4 +146,94 @@ BOOST_AUTO_TEST_CASE(CircleTransformationTestNystroem)
   BOOST_REQUIRE_EQUAL(ranges[1].Contains(ranges[2]), false);
 }
 
+/**
+ * When only a few components are needed, the naive method computes them with a
+ * truncated eigendecomposition; make sure they are the same as the leading
+ * components of the full eigendecomposition.
+ */
+BOOST_AUTO_TEST_CASE(TruncatedEigendecompositionTest)
+{
+  // Three clusters of different sizes, so that the leading eigenvalues are
+  // well separated.
+  arma::mat dataset;
+  dataset.randn(3, 300);
+  dataset *= 0.3;
+  dataset.submat(0, 0, 0, 149) += 3.0;
+  dataset.submat(1, 150, 1, 249) += 3.0;
+
+  KernelPCA<GaussianKernel> p(GaussianKernel(1.5));
+  arma::mat transformedData, eigvec;
+  arma::vec eigval;
+  p.Apply(dataset, transformedData, eigval, eigvec);
+
+  arma::mat truncatedData, truncatedEigvec;
+  arma::vec truncatedEigval;
+  p.Apply(dataset, truncatedData, truncatedEigval, truncatedEigvec, 2);
+
+  BOOST_REQUIRE_EQUAL(truncatedEigval.n_elem, 2);
+  BOOST_REQUIRE_EQUAL(truncatedEigvec.n_rows, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(truncatedEigvec.n_cols, 2);
+  BOOST_REQUIRE_EQUAL(truncatedData.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(truncatedData.n_cols, dataset.n_cols);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(truncatedEigval[i], eigval[i], 1e-3);
+
+    // The components are only defined up to their sign.
+    const double scale = arma::max(arma::abs(transformedData.row(i)));
+    for (size_t j = 0; j < dataset.n_cols; ++j)
+      BOOST_REQUIRE_SMALL(fabs(truncatedData(i, j)) -
+          fabs(transformedData(i, j)), 1e-5 * scale);
+  }
+}
+
+/**
+ * Projecting the training points with Transform() should give the same result
+ * as Apply(), for both kernel rules and with centering; new points should be
+ * projected the same way on their own as in a batch.
+ */
+template<typename KernelPCAType>
+void CheckTransform(KernelPCAType& p, const arma::mat& dataset,
+                    const size_t newDimension)
+{
+  arma::mat transformedData(dataset);
+  p.Apply(transformedData, newDimension);
+
+  arma::mat projected;
+  p.Transform(dataset, projected);
+  BOOST_REQUIRE_EQUAL(projected.n_rows, transformedData.n_rows);
+  BOOST_REQUIRE_EQUAL(projected.n_cols, transformedData.n_cols);
+
+  const double scale = arma::max(arma::max(arma::abs(transformedData)));
+  for (size_t i = 0; i < projected.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(projected[i] - transformedData[i], 1e-6 * scale);
+
+  arma::mat newData;
+  newData.randn(dataset.n_rows, 600);
+  p.Transform(newData, projected);
+  arma::mat single;
+  p.Transform(newData.col(590), single);
+  for (size_t i = 0; i < single.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(single[i] - projected(i, 590), 1e-6 * scale);
+}
+
+BOOST_AUTO_TEST_CASE(TransformTest)
+{
+  arma::mat dataset;
+  dataset.randn(3, 200);
+  dataset.submat(0, 0, 0, 99) += 3.0;
+
+  // Full and truncated eigendecompositions.
+  KernelPCA<GaussianKernel> p(GaussianKernel(1.5));
+  CheckTransform(p, dataset, 3);
+  CheckTransform(p, dataset, 50);
+  KernelPCA<GaussianKernel> centered(GaussianKernel(1.5), true);
+  CheckTransform(centered, dataset, 3);
+
+  KernelPCA<GaussianKernel, NystroemKernelRule<GaussianKernel,
+      OrderedSelection> > nystroem(GaussianKernel(1.5));
+  CheckTransform(nystroem, dataset, 20);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -14,7 +14,10 @@
 #include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
+#include <mlpack/core/kernels/random_fourier_features.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -203,6 +206,45 @@ BOOST_AUTO_TEST_CASE(md_full_covariance)
   BOOST_REQUIRE_CLOSE(md.Evaluate(b, a), 15.7, 1e-5);
 }
 
+/**
+ * The L2 distance between points transformed by Transform() should be the
+ * Mahalanobis distance between the original points, for a positive definite
+ * and for a singular covariance matrix.
+ */
+BOOST_AUTO_TEST_CASE(md_transform)
+{
+  const arma::mat a = arma::randu<arma::mat>(3, 5);
+  arma::mat dataset = arma::randu<arma::mat>(5, 40);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    // The first covariance has full rank, the second one has rank 3.
+    arma::mat cov = trans(a) * a;
+    if (trial == 0)
+      cov += arma::eye<arma::mat>(5, 5);
+    MahalanobisDistance<true> md(cov);
+
+    arma::mat transformation;
+    md.Transformation(transformation);
+    const arma::mat product = trans(transformation) * transformation;
+    for (size_t i = 0; i < cov.n_elem; ++i)
+      BOOST_REQUIRE_SMALL(product[i] - cov[i], 1e-8);
+
+    arma::mat transformed;
+    md.Transform(dataset, transformed);
+    BOOST_REQUIRE_EQUAL(transformed.n_cols, dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      for (size_t j = i + 1; j < dataset.n_cols; ++j)
+      {
+        BOOST_REQUIRE_CLOSE(md.Evaluate(dataset.col(i), dataset.col(j)),
+            (LMetric<2, true>::Evaluate(transformed.col(i),
+            transformed.col(j))), 1e-5);
+      }
+    }
+  }
+}
+
 /**
  * Simple test case for the cosine distance.
  */
@@ -402,135 +444,135 @@ BOOST_AUTO_TEST_CASE(PSpectrumSubstringExtractionTest)
   PSpectrumStringKernel p(datasets, 3);
 
   // Ensure the sizes are correct.
-  BOOST_REQUIRE_EQUAL(p.Counts().size(), 2);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0].size(), 4);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1].size(), 7);
+  BOOST_REQUIRE_EQUAL(p.Datasets(), 2);
+  BOOST_REQUIRE_EQUAL(p.Strings(0), 4);
+  BOOST_REQUIRE_EQUAL(p.Strings(1), 7);
 
   // herpgle: her, erp, rpg, pgl, gle
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][0].size(), 5);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][0]["her"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][0]["erp"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][0]["rpg"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][0]["pgl"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][0]["gle"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(0, 0), 5);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 0, "her"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 0, "erp"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 0, "rpg"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 0, "pgl"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 0, "gle"), 1);
 
   // herpagkle: her, erp, rpa, pag, agk, gkl, kle
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1].size(), 7);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["her"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["erp"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["rpa"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["pag"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["agk"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["gkl"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][1]["kle"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(0, 1), 7);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "her"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "erp"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "rpa"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "pag"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "agk"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "gkl"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 1, "kle"), 1);
 
   // klunktor: klu, lun, unk, nkt, kto, tor
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2].size(), 6);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2]["klu"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2]["lun"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2]["unk"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2]["nkt"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2]["kto"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][2]["tor"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(0, 2), 6);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 2, "klu"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 2, "lun"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 2, "unk"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 2, "nkt"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 2, "kto"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 2, "tor"), 1);
 
   // flibbynopple: fli lib ibb bby byn yno nop opp ppl ple
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3].size(), 10);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["fli"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["lib"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["ibb"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["bby"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["byn"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["yno"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["nop"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["opp"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["ppl"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[0][3]["ple"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(0, 3), 10);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "fli"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "lib"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "ibb"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "bby"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "byn"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "yno"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "nop"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "opp"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "ppl"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(0, 3, "ple"), 1);
 
   // floggy3245: flo log ogg ggy gy3 y32 324 245
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0].size(), 8);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["flo"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["log"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["ogg"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["ggy"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["gy3"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["y32"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["324"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][0]["245"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 0), 8);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "flo"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "log"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "ogg"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "ggy"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "gy3"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "y32"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "324"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 0, "245"), 1);
 
   // flippydopflip: fli lip ipp ppy pyd ydo dop opf pfl fli lip
   // fli(2) lip(2) ipp ppy pyd ydo dop opf pfl
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1].size(), 9);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["fli"], 2);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["lip"], 2);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["ipp"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["ppy"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["pyd"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["ydo"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["dop"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["opf"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][1]["pfl"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 1), 9);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "fli"), 2);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "lip"), 2);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "ipp"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "ppy"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "pyd"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "ydo"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "dop"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "opf"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 1, "pfl"), 1);
 
   // stupid fricking cat: stu tup upi pid fri ric ick cki kin ing cat
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2].size(), 11);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["stu"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["tup"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["upi"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["pid"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["fri"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["ric"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["ick"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["cki"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["kin"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["ing"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][2]["cat"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 2), 11);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "stu"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "tup"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "upi"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "pid"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "fri"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "ric"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "ick"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "cki"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "kin"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "ing"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 2, "cat"), 1);
 
   // food time isn't until later: foo ood tim ime isn unt nti til lat ate ter
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3].size(), 11);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["foo"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["ood"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["tim"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["ime"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["isn"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["unt"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["nti"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["til"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["lat"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["ate"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][3]["ter"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 3), 11);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "foo"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "ood"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "tim"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "ime"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "isn"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "unt"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "nti"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "til"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "lat"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "ate"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 3, "ter"), 1);
 
   // leave me alone until 6:00: lea eav ave alo lon one unt nti til
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4].size(), 9);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["lea"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["eav"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["ave"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["alo"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["lon"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["one"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["unt"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["nti"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][4]["til"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 4), 9);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "lea"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "eav"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "ave"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "alo"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "lon"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "one"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "unt"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "nti"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 4, "til"), 1);
 
   // only after that do you get any food.:
   // onl nly aft fte ter tha hat you get any foo ood
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5].size(), 12);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["onl"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["nly"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["aft"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["fte"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["ter"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["tha"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["hat"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["you"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["get"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["any"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["foo"], 1);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][5]["ood"], 1);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 5), 12);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "onl"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "nly"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "aft"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "fte"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "ter"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "tha"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "hat"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "you"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "get"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "any"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "foo"), 1);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 5, "ood"), 1);
 
   // obloblobloblobloblobloblob: obl(8) blo(8) lob(8)
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][6].size(), 3);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][6]["obl"], 8);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][6]["blo"], 8);
-  BOOST_REQUIRE_EQUAL(p.Counts()[1][6]["lob"], 8);
+  BOOST_REQUIRE_EQUAL(p.Substrings(1, 6), 3);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 6, "obl"), 8);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 6, "blo"), 8);
+  BOOST_REQUIRE_EQUAL(p.Count(1, 6, "lob"), 8);
 }
 
 BOOST_AUTO_TEST_CASE(PSpectrumStringEvaluateTest)
@@ -590,4 +632,159 @@ BOOST_AUTO_TEST_CASE(PSpectrumStringEvaluateTest)
   BOOST_REQUIRE_CLOSE(p.Evaluate(b, a), 11.0, 1e-5);
 }
 
+/**
+ * Make sure the kernel between random DNA strings of two datasets matches the
+ * number of pairs of equal substrings a direct comparison finds.
+ */
+BOOST_AUTO_TEST_CASE(PSpectrumStringDNATest)
+{
+  const char bases[] = { 'a', 'C', 'g', 'T' };
+  std::vector<std::vector<std::string> > datasets(2);
+  for (size_t d = 0; d < 2; ++d)
+  {
+    for (size_t i = 0; i < 10; ++i)
+    {
+      std::string str(math::RandInt(5, 60), 'a');
+      for (size_t j = 0; j < str.length(); ++j)
+        str[j] = bases[math::RandInt(4)];
+      datasets[d].push_back(str);
+    }
+  }
+
+  const size_t p = 4;
+  PSpectrumStringKernel kernel(datasets, p);
+  BOOST_REQUIRE_LE(kernel.DistinctSubstrings(), 256);
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    for (size_t j = 0; j < 10; ++j)
+    {
+      // The kernel ignores case.
+      std::string a(datasets[0][i]), b(datasets[1][j]);
+      std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+      std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+      size_t matches = 0;
+      for (size_t k = 0; k + p <= a.length(); ++k)
+        for (size_t l = 0; l + p <= b.length(); ++l)
+          if (a.compare(k, p, b, l, p) == 0)
+            ++matches;
+
+      arma::vec aIndex(2), bIndex(2);
+      aIndex[0] = 0;
+      aIndex[1] = i;
+      bIndex[0] = 1;
+      bIndex[1] = j;
+      BOOST_REQUIRE_CLOSE(kernel.Evaluate(aIndex, bIndex) + 1.0,
+          double(matches) + 1.0, 1e-5);
+      BOOST_REQUIRE_CLOSE(kernel.Evaluate(bIndex, aIndex) + 1.0,
+          double(matches) + 1.0, 1e-5);
+    }
+  }
+}
+
+/**
+ * Check the kernel matrix computed by KernelMatrix() against the pairwise
+ * evaluations of the kernel.
+ */
+template<typename KernelType>
+void CheckKernelMatrix(KernelType& kernel,
+                       const arma::mat& a,
+                       const arma::mat& b)
+{
+  arma::mat k;
+  KernelMatrix(kernel, a, b, k);
+
+  BOOST_REQUIRE_EQUAL(k.n_rows, a.n_cols);
+  BOOST_REQUIRE_EQUAL(k.n_cols, b.n_cols);
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+    {
+      // Offset by 1 so that values near 0 can be compared.
+      BOOST_REQUIRE_CLOSE(k(i, j) + 1.0,
+          kernel.Evaluate(a.unsafe_col(i), b.unsafe_col(j)) + 1.0, 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure the batch evaluation of each kernel gives the same results as the
+ * evaluation of single pairs of points, and that kernels without a batch
+ * evaluation fall back to the pairwise evaluation.
+ */
+BOOST_AUTO_TEST_CASE(KernelMatrixTest)
+{
+  arma::mat a = arma::randu<arma::mat>(5, 40);
+  arma::mat b = arma::randu<arma::mat>(5, 25);
+  // Include a duplicate point and a zero point.
+  b.col(3) = a.col(7);
+  b.col(4).zeros();
+
+  GaussianKernel gk(0.7);
+  CheckKernelMatrix(gk, a, b);
+  PolynomialKernel pk(3.0, 0.5);
+  CheckKernelMatrix(pk, a, b);
+  LinearKernel lk;
+  CheckKernelMatrix(lk, a, b);
+  LaplacianKernel lpk(0.9);
+  CheckKernelMatrix(lpk, a, b);
+  EpanechnikovKernel ek(1.2);
+  CheckKernelMatrix(ek, a, b);
+  HyperbolicTangentKernel hk(0.6, -0.2);
+  CheckKernelMatrix(hk, a, b);
+  CosineDistance cd;
+  CheckKernelMatrix(cd, a, b);
+
+  // These use the pairwise fallback.
+  BOOST_REQUIRE(!KernelTraits<TriangularKernel>::HasBatchEvaluate);
+  TriangularKernel tk(1.5);
+  CheckKernelMatrix(tk, a, b);
+  SphericalKernel sk(1.0);
+  CheckKernelMatrix(sk, a, b);
+}
+
+/**
+ * The dot products of random Fourier features should approximate the Gaussian
+ * and Laplacian kernels, and the mapped points should be computed the same way
+ * in every block.
+ */
+template<typename KernelType>
+void CheckRandomFourierFeatures(const KernelType& kernel)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 40);
+
+  RandomFourierFeatures<KernelType> rff(kernel, 20000);
+  rff.Train(data);
+  BOOST_REQUIRE_EQUAL(rff.Frequencies().n_rows, 20000);
+  BOOST_REQUIRE_EQUAL(rff.Frequencies().n_cols, 3);
+
+  arma::mat features;
+  rff.Transform(data, features);
+  BOOST_REQUIRE_EQUAL(features.n_rows, 20000);
+  BOOST_REQUIRE_EQUAL(features.n_cols, 40);
+
+  // The error of every entry is O(1 / sqrt(m)).
+  KernelType k(kernel);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    for (size_t j = 0; j < data.n_cols; ++j)
+      BOOST_REQUIRE_SMALL(arma::dot(features.col(i), features.col(j)) -
+          k.Evaluate(data.col(i), data.col(j)), 0.05);
+
+  // Points mapped in several blocks get the same features as on their own.
+  RandomFourierFeatures<KernelType> small(kernel, 50);
+  small.Train(data);
+  arma::mat many = arma::randu<arma::mat>(3, 1100);
+  small.Transform(many, features);
+  arma::mat single;
+  small.Transform(many.col(1099), single);
+  for (size_t i = 0; i < 50; ++i)
+    BOOST_REQUIRE_SMALL(single[i] - features(i, 1099), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(RandomFourierFeaturesTest)
+{
+  CheckRandomFourierFeatures(GaussianKernel(0.5));
+  CheckRandomFourierFeatures(LaplacianKernel(0.8));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -7,8 +7,13 @@
 #include <mlpack/methods/kmeans/kmeans.hpp>
 #include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
 #include <mlpack/methods/kmeans/refined_start.hpp>
+#include <mlpack/methods/kmeans/kmeans_plus_plus.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
+#include <mlpack/methods/kmeans/blocked_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
 
@@ -444,6 +449,71 @@ BOOST_AUTO_TEST_CASE(RefinedStartTest)
   BOOST_REQUIRE_LT(distortion, 14000.0);
 }
 
+/**
+ * Check that the given assignments recover four well-separated Gaussians of 500
+ * points each.
+ */
+void CheckSeparatedAssignments(const arma::Col<size_t>& assignments)
+{
+  for (size_t g = 0; g < 4; ++g)
+  {
+    for (size_t i = 500 * g; i < 500 * (g + 1); ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], assignments[500 * g]);
+
+    for (size_t h = 0; h < g; ++h)
+      BOOST_REQUIRE_NE(assignments[500 * g], assignments[500 * h]);
+  }
+}
+
+/**
+ * The k-means++ seeding should put one centroid in each of several
+ * well-separated Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(KMeansPlusPlusTest)
+{
+  arma::mat means(" 0 20  0 20;"
+                  " 0  0 20 20");
+  arma::mat data(2, 2000);
+  data.randn();
+  for (size_t i = 0; i < data.n_cols; ++i)
+    data.col(i) += means.col(i / 500);
+
+  arma::Col<size_t> assignments;
+  KMeansPlusPlus::Cluster(data, 4, assignments);
+
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, 2000);
+  CheckSeparatedAssignments(assignments);
+}
+
+/**
+ * The k-means|| seeding should also put one centroid in each of several
+ * well-separated Gaussians, and give the same result for the same seed.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelTest)
+{
+  arma::mat means(" 0 20  0 20;"
+                  " 0  0 20 20");
+  arma::mat data(2, 2000);
+  data.randn();
+  for (size_t i = 0; i < data.n_cols; ++i)
+    data.col(i) += means.col(i / 500);
+
+  KMeansParallel kmp;
+  arma::Col<size_t> assignments;
+  math::RandomSeed(10);
+  kmp.Cluster(data, 4, assignments);
+
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, 2000);
+  CheckSeparatedAssignments(assignments);
+
+  arma::Col<size_t> otherAssignments;
+  math::RandomSeed(10);
+  kmp.Cluster(data, 4, otherAssignments);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], otherAssignments[i]);
+}
+
 #ifdef ARMA_HAS_SPMAT
 // Can't do this test on Armadillo 3.4; var(SpBase) is not implemented.
 #if !((ARMA_VERSION_MAJOR == 3) && (ARMA_VERSION_MINOR == 4))
@@ -564,6 +634,117 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+BOOST_AUTO_TEST_CASE(BlockedTest)
+{
+  const size_t trials = 5;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    // Use enough points that there are several blocks, the last one partial.
+    arma::mat dataset(10, 1300);
+    dataset.randu();
+
+    const size_t k = 5 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    // Make sure the blocked algorithm and the naive method return the same
+    // clusters.
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Col<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        BlockedKMeans> blocked;
+    arma::Col<size_t> blockedAssignments;
+    arma::mat blockedCentroids(centroids);
+    blocked.Cluster(dataset, k, blockedAssignments, blockedCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], blockedAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], blockedCentroids[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure the Yinyang algorithm returns the same results as the naive
+ * algorithm, with enough clusters that there are several groups.
+ */
+BOOST_AUTO_TEST_CASE(YinyangTest)
+{
+  const size_t trials = 5;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 1000);
+    dataset.randu();
+
+    const size_t k = 15 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    // Make sure the Yinyang algorithm and the naive method return the same
+    // clusters.
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Col<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        YinyangKMeans> yinyang;
+    arma::Col<size_t> yinyangAssignments;
+    arma::mat yinyangCentroids(centroids);
+    yinyang.Cluster(dataset, k, yinyangAssignments, yinyangCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], yinyangAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], yinyangCentroids[i], 1e-5);
+  }
+}
+
+/**
+ * Mini-batch k-means should recover the centers of well-separated clusters,
+ * using far fewer distance calculations than full passes would.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchTest)
+{
+  arma::mat means(2, 3);
+  means << 0.0 << 10.0 << -10.0 << arma::endr
+        << 0.0 << 10.0 << 10.0 << arma::endr;
+
+  arma::mat dataset(2, 30000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = means.col(i % 3) + arma::randn<arma::vec>(2);
+
+  // Start from one point of each cluster.
+  arma::mat centroids(dataset.cols(0, 2));
+
+  KMeans<metric::EuclideanDistance, RandomPartition, AllowEmptyClusters,
+      MiniBatchKMeans> km(100);
+  km.Cluster(dataset, 3, centroids, true);
+
+  for (size_t c = 0; c < 3; ++c)
+    BOOST_REQUIRE_SMALL(arma::norm(centroids.col(c) - means.col(c), 2), 0.2);
+
+  // Check the iteration itself: a batch only touches batchSize points.
+  metric::EuclideanDistance distance;
+  MiniBatchKMeans<metric::EuclideanDistance, arma::mat> step(dataset, distance,
+      100);
+  arma::mat newCentroids;
+  arma::Col<size_t> counts;
+  step.Iterate(centroids, newCentroids, counts);
+
+  BOOST_REQUIRE_EQUAL(step.DistanceCalculations(), 3 * 100 + 3);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), 100);
+}
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
@@ -598,6 +779,52 @@ BOOST_AUTO_TEST_CASE(PellegMooreTest)
   }
 }
 
+/**
+ * Make sure one Pelleg-Moore KMeans object, which keeps its tree between
+ * clusterings of the same dataset, returns the same clusters as the naive
+ * method for several clusterings, and that a copy of it does too.  The dataset
+ * is large enough for the traversal to be split into tasks.
+ */
+BOOST_AUTO_TEST_CASE(PellegMooreReuseTest)
+{
+  arma::mat dataset(3, 20000);
+  dataset.randu();
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      PellegMooreKMeans> pellegMoore;
+
+  for (size_t t = 0; t < 4; ++t)
+  {
+    const size_t k = 4 * (t + 1);
+    arma::mat centroids(3, k);
+    centroids.randu();
+
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Col<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    arma::Col<size_t> pmAssignments;
+    arma::mat pmCentroids(centroids);
+    if (t % 2 == 0)
+    {
+      pellegMoore.Cluster(dataset, k, pmAssignments, pmCentroids, false, true);
+    }
+    else
+    {
+      KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+          PellegMooreKMeans> copy(pellegMoore);
+      copy.Cluster(dataset, k, pmAssignments, pmCentroids, false, true);
+    }
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], pmAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], pmCentroids[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(DTNNTest)
 {
   const size_t trials = 5;
@@ -662,4 +889,139 @@ BOOST_AUTO_TEST_CASE(DTNNCoverTreeTest)
   }
 }
 
+/**
+ * Run the dual-tree k-means algorithm for many iterations on clustered data,
+ * where most of the dataset tree is pruned in late iterations and whole
+ * subtrees are skipped by UpdateTree() and DecoalesceTree().  There are more
+ * centroids than clusters, so the centroids keep moving a little for many
+ * iterations.  Stopping after any number of iterations must give the same
+ * assignments and centroids as the naive method.
+ */
+template<template<class, class> class LloydStepType>
+void CheckManyIterations()
+{
+  arma::mat means(4, 10);
+  means.randu();
+  means *= 40.0;
+
+  arma::mat dataset(4, 5000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = means.col(i % 10) + arma::randn<arma::vec>(4);
+
+  // Start from distinct points; some clusters get two centroids.
+  const size_t k = 15;
+  arma::mat centroids(4, k);
+  for (size_t i = 0; i < k; ++i)
+    centroids.col(i) = dataset.col(333 * i);
+
+  const size_t iterations[] = { 1, 3, 10, 30, 1000 };
+  for (size_t t = 0; t < 5; ++t)
+  {
+    KMeans<> km(iterations[t]);
+    arma::Col<size_t> assignments;
+    arma::mat naiveCentroids(centroids);
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        LloydStepType> dtnn(iterations[t]);
+    arma::Col<size_t> dtnnAssignments;
+    arma::mat dtnnCentroids(centroids);
+    dtnn.Cluster(dataset, k, dtnnAssignments, dtnnCentroids, false, true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], dtnnAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], dtnnCentroids[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DTNNManyIterationsTest)
+{
+  CheckManyIterations<DefaultDualTreeKMeans>();
+  CheckManyIterations<CoverTreeDualTreeKMeans>();
+}
+
+/**
+ * Cluster the given dataset with the given Lloyd step, starting from the given
+ * centroids, and make sure every point is assigned to its true cluster.
+ */
+template<template<class, class> class LloydStepType, typename MatType>
+void CheckClusters(const MatType& data,
+                   const arma::mat& initialCentroids,
+                   const arma::Col<size_t>& labels)
+{
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      LloydStepType, MatType> km;
+  arma::Col<size_t> assignments;
+  arma::mat centroids(initialCentroids);
+  km.Cluster(data, centroids.n_cols, assignments, centroids, false, true);
+
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, labels.n_elem);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], labels[i]);
+}
+
+/**
+ * Make sure the step types work on single-precision datasets.
+ */
+BOOST_AUTO_TEST_CASE(FloatKMeansTest)
+{
+  arma::mat means(10, 4);
+  means.randu();
+  means *= 50.0;
+
+  arma::mat dataset(10, 2000);
+  arma::Col<size_t> labels(2000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = i % 4;
+    dataset.col(i) = means.col(i % 4) + arma::randn<arma::vec>(10);
+  }
+  const arma::fmat floatDataset = arma::conv_to<arma::fmat>::from(dataset);
+
+  CheckClusters<NaiveKMeans>(floatDataset, means, labels);
+  CheckClusters<ElkanKMeans>(floatDataset, means, labels);
+  CheckClusters<HamerlyKMeans>(floatDataset, means, labels);
+  CheckClusters<DefaultDualTreeKMeans>(floatDataset, means, labels);
+}
+
+#ifdef ARMA_HAS_SPMAT
+
+/**
+ * Make sure the step types work on sparse datasets, in double and single
+ * precision.  The points of each cluster only have nonzero values in their own
+ * block of dimensions, like documents on different topics.
+ */
+BOOST_AUTO_TEST_CASE(SparseStepTypesTest)
+{
+  arma::sp_mat dataset(400, 1000);
+  arma::Col<size_t> labels(1000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = i % 4;
+    for (size_t d = 100 * labels[i]; d < 100 * (labels[i] + 1); ++d)
+      if (math::Random() < 0.2)
+        dataset(d, i) = 1.0 + math::Random();
+  }
+
+  // Start from the true means.
+  arma::mat means(400, 4, arma::fill::zeros);
+  const arma::mat denseDataset(dataset);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    means.col(labels[i]) += denseDataset.col(i) / 250.0;
+
+  CheckClusters<NaiveKMeans>(dataset, means, labels);
+  CheckClusters<ElkanKMeans>(dataset, means, labels);
+  CheckClusters<HamerlyKMeans>(dataset, means, labels);
+  CheckClusters<DefaultDualTreeKMeans>(dataset, means, labels);
+
+  const arma::sp_fmat floatDataset(arma::conv_to<arma::fmat>::from(
+      denseDataset));
+  CheckClusters<NaiveKMeans>(floatDataset, means, labels);
+  CheckClusters<HamerlyKMeans>(floatDataset, means, labels);
+}
+
+#endif // ARMA_HAS_SPMAT
+
 BOOST_AUTO_TEST_SUITE_END();
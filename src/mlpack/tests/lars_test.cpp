@@ -155,4 +155,48 @@ BOOST_AUTO_TEST_CASE(NoCholeskySingularityTest)
   }
 }
 
+// Make sure that solving many problems at once, and reusing one LARS object
+// with a precomputed Gram matrix, gives the same solutions as solving each
+// problem on its own.
+BOOST_AUTO_TEST_CASE(LARSBatchRegressTest)
+{
+  arma::mat X = arma::randn(10, 100);
+  arma::mat responses = arma::randn(100, 30);
+  const double lambda1 = 5.0;
+  const double lambda2 = 1.0;
+
+  LARS batchLars(true, lambda1, lambda2);
+  arma::mat betas;
+  batchLars.Regress(X, responses, betas);
+
+  BOOST_REQUIRE_EQUAL(betas.n_rows, X.n_rows);
+  BOOST_REQUIRE_EQUAL(betas.n_cols, responses.n_cols);
+
+  const arma::mat gram = X * trans(X);
+  LARS gramLars(true, gram, lambda1, lambda2);
+  for (size_t i = 0; i < responses.n_cols; ++i)
+  {
+    const arma::vec y = responses.col(i);
+
+    LARS lars(true, lambda1, lambda2);
+    arma::vec beta;
+    lars.Regress(X, y, beta);
+
+    const arma::vec xTy = X * y;
+    arma::vec gramBeta;
+    gramLars.RegressGram(xTy, gramBeta);
+
+    for (size_t j = 0; j < X.n_rows; ++j)
+    {
+      BOOST_REQUIRE_SMALL(betas(j, i) - beta(j), 1e-10);
+      BOOST_REQUIRE_SMALL(gramBeta(j) - beta(j), 1e-10);
+    }
+
+    // The batch solutions are also correct.
+    const arma::vec errCorr = (X * trans(X) + lambda2 *
+        arma::eye(X.n_rows, X.n_rows)) * betas.col(i) - X * y;
+    LARSVerifyCorrectness(betas.col(i), errCorr, lambda1);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -284,4 +284,78 @@ BOOST_AUTO_TEST_CASE(TestSymKronId)
   }
 }
 
+// Test Covariance() against a direct two-pass computation, with a block size
+// that does not divide the number of points.
+BOOST_AUTO_TEST_CASE(TestCovariance)
+{
+  arma::mat x = arma::randu<arma::mat>(4, 1000);
+
+  arma::vec mean;
+  arma::mat cov;
+  Covariance(x, mean, cov, true, 37);
+
+  arma::mat centered = x;
+  centered.each_col() -= arma::mean(x, 1);
+  const arma::mat trueCov = centered * trans(centered) / (x.n_cols - 1);
+
+  for (size_t i = 0; i < mean.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(mean[i], arma::mean(x.row(i)), 1e-8);
+  for (size_t i = 0; i < cov.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(cov[i], trueCov[i], 1e-6);
+
+  // The biased estimate is normalized by n.
+  Covariance(x, mean, cov, false, 37);
+  for (size_t i = 0; i < cov.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(cov[i], trueCov[i] * (x.n_cols - 1) / x.n_cols, 1e-6);
+}
+
+// Test the weighted Covariance() against a direct two-pass computation.
+BOOST_AUTO_TEST_CASE(TestWeightedCovariance)
+{
+  arma::mat x = arma::randu<arma::mat>(3, 500);
+  arma::vec weights = arma::randu<arma::vec>(500);
+  weights.subvec(100, 199).zeros(); // A block with no weight.
+
+  arma::vec mean;
+  arma::mat cov;
+  Covariance(x, weights, mean, cov, 50);
+
+  const arma::vec trueMean = x * weights / arma::accu(weights);
+  arma::mat trueCov(3, 3);
+  trueCov.zeros();
+  for (size_t i = 0; i < x.n_cols; i++)
+    trueCov += weights[i] * (x.col(i) - trueMean) * trans(x.col(i) - trueMean);
+  trueCov /= arma::accu(weights);
+
+  for (size_t i = 0; i < mean.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(mean[i], trueMean[i], 1e-8);
+  for (size_t i = 0; i < cov.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(cov[i], trueCov[i], 1e-6);
+
+  // The number of weights must match the number of points.
+  BOOST_REQUIRE_THROW(Covariance(x, arma::vec(10), mean, cov),
+      std::invalid_argument);
+}
+
+// Make sure Covariance() and ccov() are accurate when the data is far from the
+// origin.
+BOOST_AUTO_TEST_CASE(TestCovarianceLargeOffset)
+{
+  arma::mat x = arma::randu<arma::mat>(2, 2000);
+  arma::vec mean;
+  arma::mat trueCov;
+  Covariance(x, mean, trueCov);
+
+  x += 1e8;
+  arma::mat cov;
+  Covariance(x, mean, cov);
+  const arma::mat armaCov = ccov(x);
+
+  for (size_t i = 0; i < cov.n_elem; i++)
+  {
+    BOOST_REQUIRE_SMALL(cov[i] - trueCov[i], 1e-5);
+    BOOST_REQUIRE_SMALL(armaCov[i] - trueCov[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -173,4 +173,39 @@ BOOST_AUTO_TEST_CASE(RidgeRegressionTestCase)
     BOOST_REQUIRE_SMALL(predictions(i) - responses(i), .05);
 }
 
+/**
+ * Training on chunks of the dataset with Update() should give the same model
+ * as training on all of it at once, with and without weights and lambda.
+ */
+BOOST_AUTO_TEST_CASE(LinearRegressionUpdateTest)
+{
+  arma::mat predictors;
+  predictors.randu(5, 3000);
+  arma::vec responses = arma::trans(arma::randu<arma::rowvec>(5) * predictors)
+      + 0.1 * arma::randn<arma::vec>(3000);
+  arma::vec weights;
+  weights.randu(3000);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    const double lambda = (trial == 0) ? 0.0 : 0.5;
+    LinearRegression lr(predictors, responses, lambda, true, weights);
+
+    // Uneven chunks, including one with fewer points than dimensions.
+    LinearRegression lrChunks(5, lambda);
+    const size_t splits[5] = { 0, 3, 1200, 1203, 3000 };
+    for (size_t c = 0; c < 4; ++c)
+    {
+      lrChunks.Update(predictors.cols(splits[c], splits[c + 1] - 1),
+          responses.subvec(splits[c], splits[c + 1] - 1),
+          weights.subvec(splits[c], splits[c + 1] - 1));
+    }
+
+    BOOST_REQUIRE_EQUAL(lrChunks.Points(), 3000);
+    BOOST_REQUIRE_EQUAL(lrChunks.Parameters().n_elem, 6);
+    for (size_t i = 0; i < 6; ++i)
+      BOOST_REQUIRE_CLOSE(lrChunks.Parameters()[i], lr.Parameters()[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
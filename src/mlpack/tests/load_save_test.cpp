@@ -11,6 +11,10 @@
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
+#ifdef ZLIB_FOUND
+  #include <zlib.h>
+#endif
+
 using namespace mlpack;
 
 BOOST_AUTO_TEST_SUITE(LoadSaveTest);
@@ -600,4 +604,514 @@ BOOST_AUTO_TEST_CASE(NormalizeLabelTest)
     BOOST_REQUIRE_EQUAL(randLabels[i], revertedLabels[i]);
 }
 
+/**
+ * Label normalization with very many classes; the labels are numbered in the
+ * order they are first seen.
+ */
+BOOST_AUTO_TEST_CASE(NormalizeLabelManyClassesTest)
+{
+  arma::Col<size_t> labels(200000);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = (7919 * (i % 100000)) % 100003;
+
+  arma::Col<size_t> newLabels, mappings;
+  data::NormalizeLabels(labels, newLabels, mappings);
+
+  BOOST_REQUIRE_EQUAL(mappings.n_elem, 100000);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(newLabels[i], i % 100000);
+    BOOST_REQUIRE_EQUAL(mappings[newLabels[i]], labels[i]);
+  }
+}
+
+/**
+ * Make sure strings in a CSV file are encoded per dimension, that a dimension
+ * becomes categorical even after numbers, and that a DatasetInfo can be
+ * reused to encode another file the same way.
+ */
+BOOST_AUTO_TEST_CASE(LoadCategoricalCSVTest)
+{
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+  f << "1.5, red, 3, \"New York\"" << std::endl;
+  f << "2.5, blue, 4, Boston" << std::endl;
+  f << std::endl;
+  f << "-1, red, small, New York" << std::endl;
+  f.close();
+
+  data::DatasetInfo info;
+  arma::mat test;
+  BOOST_REQUIRE(data::Load("test_file.csv", test, info) == true);
+
+  BOOST_REQUIRE_EQUAL(test.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(test.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(info.Dimensionality(), 4);
+
+  BOOST_REQUIRE(info.Type(0) == data::numeric);
+  BOOST_REQUIRE_CLOSE(test(0, 0), 1.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(test(0, 1), 2.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(test(0, 2), -1.0, 1e-5);
+
+  BOOST_REQUIRE(info.Type(1) == data::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 2);
+  BOOST_REQUIRE_EQUAL(test(1, 0), 0.0);
+  BOOST_REQUIRE_EQUAL(test(1, 1), 1.0);
+  BOOST_REQUIRE_EQUAL(test(1, 2), 0.0);
+  BOOST_REQUIRE_EQUAL(info.UnmapString(1, 1), "blue");
+
+  // The numbers before "small" are encoded too.
+  BOOST_REQUIRE(info.Type(2) == data::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(2), 3);
+  BOOST_REQUIRE_EQUAL(info.UnmapString(size_t(test(2, 0)), 2), "3");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(size_t(test(2, 1)), 2), "4");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(size_t(test(2, 2)), 2), "small");
+
+  // Quotes are removed, and spaces are kept.
+  BOOST_REQUIRE_EQUAL(info.NumMappings(3), 2);
+  BOOST_REQUIRE_EQUAL(test(3, 0), test(3, 2));
+  BOOST_REQUIRE_EQUAL(info.UnmapString(size_t(test(3, 0)), 3), "New York");
+
+  // A second file shares the dictionaries.
+  f.open("test_file.csv", std::fstream::out);
+  f << "0, green, small, Boston" << std::endl;
+  f << "0, red, large, Boston" << std::endl;
+  f.close();
+
+  arma::mat test2;
+  BOOST_REQUIRE(data::Load("test_file.csv", test2, info, false, false)
+      == true);
+  BOOST_REQUIRE_EQUAL(test2.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(test2.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(test2(0, 1), 2.0);
+  BOOST_REQUIRE_EQUAL(test2(1, 1), 0.0);
+  BOOST_REQUIRE_EQUAL(test2(0, 2), test(2, 2));
+  BOOST_REQUIRE_EQUAL(test2(0, 3), test(3, 1));
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 3);
+
+  // Lines of different lengths can't be loaded.
+  f.open("test_file.csv", std::fstream::out);
+  f << "1, a" << std::endl;
+  f << "2" << std::endl;
+  f.close();
+
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.csv", test, info) == false);
+  Log::Warn.ignoreInput = false;
+
+  remove("test_file.csv");
+}
+
+/**
+ * Read the given file with a ChunkedLoader and make sure the concatenated
+ * chunks are the same as the matrix.
+ */
+void CheckChunkedLoad(const std::string& filename, const arma::mat& matrix)
+{
+  data::ChunkedLoader<double> loader(filename);
+  BOOST_REQUIRE(loader.IsOpen());
+  BOOST_REQUIRE_EQUAL(loader.Dimensionality(), matrix.n_rows);
+
+  // Read it twice, to make sure Reset() works.
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    arma::mat chunk;
+    size_t col = 0;
+    while (loader.NextChunk(chunk, 100))
+    {
+      BOOST_REQUIRE_EQUAL(chunk.n_rows, matrix.n_rows);
+      BOOST_REQUIRE_LE(chunk.n_cols, 100);
+      BOOST_REQUIRE_LE(col + chunk.n_cols, matrix.n_cols);
+
+      for (size_t i = 0; i < chunk.n_cols; ++i, ++col)
+        for (size_t d = 0; d < chunk.n_rows; ++d)
+          BOOST_REQUIRE_CLOSE(chunk(d, i), matrix(d, col), 1e-5);
+    }
+
+    BOOST_REQUIRE_EQUAL(col, matrix.n_cols);
+    BOOST_REQUIRE_EQUAL(loader.PointsRead(), matrix.n_cols);
+    loader.Reset();
+  }
+}
+
+/**
+ * Make sure that CSV, raw ASCII, Armadillo ASCII, and Armadillo binary files
+ * can be loaded in chunks.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadTest)
+{
+  arma::mat test = arma::randu<arma::mat>(4, 1003);
+
+  BOOST_REQUIRE(data::Save("test_file.csv", test) == true);
+  arma::mat csv;
+  BOOST_REQUIRE(data::Load("test_file.csv", csv) == true);
+  CheckChunkedLoad("test_file.csv", csv);
+  remove("test_file.csv");
+
+  BOOST_REQUIRE(data::Save("test_file.txt", test) == true);
+  arma::mat txt;
+  BOOST_REQUIRE(data::Load("test_file.txt", txt) == true);
+  CheckChunkedLoad("test_file.txt", txt);
+  remove("test_file.txt");
+
+  arma::mat testTrans = trans(test);
+  BOOST_REQUIRE(testTrans.save("test_file.txt", arma::arma_ascii));
+  arma::mat armaTxt;
+  BOOST_REQUIRE(data::Load("test_file.txt", armaTxt) == true);
+  CheckChunkedLoad("test_file.txt", armaTxt);
+  remove("test_file.txt");
+
+  BOOST_REQUIRE(data::Save("test_file.bin", test) == true);
+  CheckChunkedLoad("test_file.bin", test);
+  remove("test_file.bin");
+}
+
+/**
+ * Make sure that a matrix written in chunks with a ChunkedSaver can be read
+ * back with data::Load(), and that ChunkedLoader::NumPoints() counts the points
+ * in a file.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedSaveTest)
+{
+  arma::mat test = arma::randu<arma::mat>(5, 1003);
+
+  {
+    data::ChunkedSaver<double> saver("test_file.bin", test.n_rows,
+        test.n_cols);
+    BOOST_REQUIRE(saver.IsOpen());
+
+    for (size_t i = 0; i < test.n_cols; i += 100)
+    {
+      const size_t end = std::min(i + 100, (size_t) test.n_cols) - 1;
+      BOOST_REQUIRE(saver.Append(test.cols(i, end)));
+    }
+
+    BOOST_REQUIRE_EQUAL(saver.PointsWritten(), test.n_cols);
+    BOOST_REQUIRE(saver.Close());
+  }
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.bin", loaded) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+  for (size_t i = 0; i < test.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(loaded[i], test[i], 1e-5);
+
+  data::ChunkedLoader<double> binLoader("test_file.bin");
+  BOOST_REQUIRE_EQUAL(binLoader.NumPoints(), test.n_cols);
+  remove("test_file.bin");
+
+  // Writing too many points must fail.
+  data::ChunkedSaver<double> small("test_file.bin", 5, 10);
+  BOOST_REQUIRE(!small.Append(test.cols(0, 10)));
+  remove("test_file.bin");
+
+  BOOST_REQUIRE(data::Save("test_file.csv", test) == true);
+  data::ChunkedLoader<double> csvLoader("test_file.csv");
+  BOOST_REQUIRE_EQUAL(csvLoader.NumPoints(), test.n_cols);
+
+  // NumPoints() must not disturb reading.
+  arma::mat chunk;
+  BOOST_REQUIRE(csvLoader.NextChunk(chunk, 10));
+  BOOST_REQUIRE_EQUAL(csvLoader.NumPoints(), test.n_cols);
+  BOOST_REQUIRE(csvLoader.NextChunk(chunk, 10));
+  BOOST_REQUIRE_CLOSE(chunk(0, 0), test(0, 10), 1e-5);
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure malformed or unsupported files are rejected.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedLoadFailureTest)
+{
+  data::ChunkedLoader<double> noExtension("noextension");
+  BOOST_REQUIRE(!noExtension.IsOpen());
+
+  data::ChunkedLoader<double> missing("nonexistentfile_______________.csv");
+  BOOST_REQUIRE(!missing.IsOpen());
+
+  // The second line has the wrong number of values.
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+  f << "1, 2, 3, 4" << std::endl;
+  f << "5, 6, 7" << std::endl;
+  f.close();
+
+  data::ChunkedLoader<double> ragged("test_file.csv");
+  BOOST_REQUIRE(ragged.IsOpen());
+  BOOST_REQUIRE_EQUAL(ragged.Dimensionality(), 4);
+
+  arma::mat chunk;
+  BOOST_REQUIRE(!ragged.NextChunk(chunk, 10));
+  BOOST_REQUIRE_EQUAL(chunk.n_elem, 0);
+
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure the fast CSV parser gives the same results as Armadillo, for both
+ * CSV and whitespace-separated files.
+ */
+BOOST_AUTO_TEST_CASE(FastCSVParserTest)
+{
+  arma::mat test = arma::randn<arma::mat>(7, 5000);
+  test.col(3).fill(0.0);
+  test(2, 10) = 1e-30;
+  test(3, 11) = -2.5e200;
+
+  const char* files[] = { "test_file.csv", "test_file.txt" };
+  for (size_t f = 0; f < 2; ++f)
+  {
+    BOOST_REQUIRE(data::Save(files[f], test) == true);
+
+    arma::mat armaLoaded;
+    BOOST_REQUIRE(armaLoaded.load(files[f]));
+    armaLoaded = trans(armaLoaded);
+
+    arma::mat fastLoaded;
+    BOOST_REQUIRE(data::LoadCSV(files[f], fastLoaded) == true);
+
+    BOOST_REQUIRE_EQUAL(fastLoaded.n_rows, armaLoaded.n_rows);
+    BOOST_REQUIRE_EQUAL(fastLoaded.n_cols, armaLoaded.n_cols);
+    for (size_t i = 0; i < armaLoaded.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(fastLoaded[i], armaLoaded[i]);
+
+    remove(files[f]);
+  }
+}
+
+/**
+ * The fast CSV parser should refuse files it does not understand, and
+ * data::Load() should then still load them with Armadillo.
+ */
+BOOST_AUTO_TEST_CASE(FastCSVParserFallbackTest)
+{
+  std::fstream f;
+  f.open("test_file.csv", std::fstream::out);
+  f << "1, 2, 3, 4" << std::endl;
+  f << std::endl;
+  f << "5, 6, 7" << std::endl;
+  f.close();
+
+  arma::mat test;
+  BOOST_REQUIRE(data::LoadCSV("test_file.csv", test) == false);
+  BOOST_REQUIRE(data::Load("test_file.csv", test) == true);
+
+  // Empty lines are skipped, and '\r' is ignored.
+  f.open("test_file.csv", std::fstream::out);
+  f << "1,2\r" << std::endl;
+  f << std::endl;
+  f << "3,4\r" << std::endl;
+  f.close();
+
+  BOOST_REQUIRE(data::LoadCSV("test_file.csv", test) == true);
+  BOOST_REQUIRE_EQUAL(test.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(test.n_cols, 2);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_CLOSE(test[i], (double) (i + 1), 1e-5);
+
+  remove("test_file.csv");
+}
+
+/**
+ * Files written by data::Save() without a transposed copy should be read back
+ * exactly by Armadillo, whether or not they are transposed.
+ */
+BOOST_AUTO_TEST_CASE(SaveWithoutTransposeCopyTest)
+{
+  arma::mat test = arma::randn<arma::mat>(6, 3000);
+  test(2, 10) = 1e-300;
+  test(3, 11) = -2.5e200;
+  test(4, 12) = 1.0 / 3.0;
+
+  const char* files[] = { "test_file.csv", "test_file.txt", "test_file.bin" };
+  for (size_t f = 0; f < 3; ++f)
+  {
+    for (size_t t = 0; t < 2; ++t)
+    {
+      const bool transpose = (t == 0);
+      BOOST_REQUIRE(data::Save(files[f], test, false, transpose) == true);
+
+      arma::mat loaded;
+      BOOST_REQUIRE(loaded.load(files[f]));
+      if (transpose)
+        loaded = trans(loaded);
+
+      BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+      BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+      for (size_t i = 0; i < test.n_elem; ++i)
+        BOOST_REQUIRE_EQUAL(loaded[i], test[i]);
+    }
+
+    remove(files[f]);
+  }
+
+  // Integer matrices are written as integers.
+  arma::Mat<size_t> labels(4, 1000);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = i * 1000003;
+
+  BOOST_REQUIRE(data::Save("test_file.csv", labels) == true);
+
+  arma::Mat<size_t> loadedLabels;
+  BOOST_REQUIRE(data::Load("test_file.csv", loadedLabels) == true);
+  BOOST_REQUIRE_EQUAL(loadedLabels.n_rows, labels.n_rows);
+  BOOST_REQUIRE_EQUAL(loadedLabels.n_cols, labels.n_cols);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loadedLabels[i], labels[i]);
+
+  remove("test_file.csv");
+}
+
+/**
+ * Make sure data::SaveAsync() writes the same file as data::Save(), whether it
+ * borrows the matrix or takes it over, and that it reports failure.
+ */
+BOOST_AUTO_TEST_CASE(SaveAsyncTest)
+{
+  arma::mat test = arma::randu<arma::mat>(5, 200);
+
+  std::future<bool> borrowed = data::SaveAsync("test_file.csv", test);
+  arma::mat copy(test);
+  std::future<bool> owned = data::SaveAsync("test_file.bin", std::move(copy));
+
+  BOOST_REQUIRE(borrowed.get() == true);
+  BOOST_REQUIRE(owned.get() == true);
+
+  const char* files[] = { "test_file.csv", "test_file.bin" };
+  for (size_t f = 0; f < 2; ++f)
+  {
+    arma::mat loaded;
+    BOOST_REQUIRE(data::Load(files[f], loaded) == true);
+    BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+    BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+    for (size_t i = 0; i < test.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(loaded[i], test[i]);
+
+    remove(files[f]);
+  }
+
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::SaveAsync("noextension", test).get() == false);
+  Log::Warn.ignoreInput = false;
+}
+
+/**
+ * Make sure an Armadillo binary file can be mapped instead of loaded, and that
+ * copies of the mapped matrix share the mapping.
+ */
+BOOST_AUTO_TEST_CASE(LoadMappedArmaBinaryTest)
+{
+  arma::mat test = arma::randu<arma::mat>(5, 100);
+  BOOST_REQUIRE(data::Save("test_file.bin", test, true, false) == true);
+
+  data::MappedMatrix<double> mapped;
+  BOOST_REQUIRE(data::Load("test_file.bin", mapped, false, true) == true);
+  BOOST_REQUIRE(mapped.Shared());
+
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_rows, 5);
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, 100);
+  for (size_t i = 0; i < test.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(mapped.Matrix()[i], test[i]);
+
+  data::MappedMatrix<double> copy(mapped);
+  BOOST_REQUIRE_EQUAL(copy.Matrix().memptr(), mapped.Matrix().memptr());
+
+  // A private mapping can be modified without changing the file.
+  data::MappedMatrix<double> privateMapped;
+  BOOST_REQUIRE(data::Load("test_file.bin", privateMapped) == true);
+  BOOST_REQUIRE(!privateMapped.Shared());
+  privateMapped.Matrix()[0] = -1.0;
+  BOOST_REQUIRE_EQUAL(mapped.Matrix()[0], test[0]);
+
+  // The element type must match the header.
+  data::MappedMatrix<float> wrongType;
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.bin", wrongType) == false);
+  Log::Warn.ignoreInput = false;
+  BOOST_REQUIRE_EQUAL(wrongType.Matrix().n_elem, 0);
+
+  remove("test_file.bin");
+}
+
+#ifdef ZLIB_FOUND
+/**
+ * Make sure a gzip compressed CSV file is loaded the same as the uncompressed
+ * file, by data::Load(), by a ChunkedLoader, and block by block.
+ */
+BOOST_AUTO_TEST_CASE(LoadGzipCSVTest)
+{
+  arma::mat test = arma::randu<arma::mat>(4, 1003);
+  BOOST_REQUIRE(data::Save("test_file.csv", test) == true);
+
+  std::ifstream in("test_file.csv");
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  in.close();
+  const std::string contents = buffer.str();
+
+  // Write the file as two gzip members, which is allowed.
+  gzFile gz = gzopen("test_file.csv.gz", "wb");
+  BOOST_REQUIRE(gz != NULL);
+  const size_t half = contents.size() / 2;
+  BOOST_REQUIRE_EQUAL(gzwrite(gz, contents.data(), half), (int) half);
+  gzclose(gz);
+  gz = gzopen("test_file.csv.gz", "ab");
+  BOOST_REQUIRE(gz != NULL);
+  BOOST_REQUIRE_EQUAL(gzwrite(gz, contents.data() + half,
+      contents.size() - half), (int) (contents.size() - half));
+  gzclose(gz);
+
+  // Small blocks, so that the queue fills up.
+  data::DecompressingReader reader("test_file.csv.gz", 1000, 2);
+  BOOST_REQUIRE(reader.IsOpen());
+  std::string block, decompressed;
+  while (reader.NextBlock(block))
+  {
+    BOOST_REQUIRE_LE(block.size(), 1000);
+    decompressed.append(block);
+  }
+  BOOST_REQUIRE(!reader.Failed());
+  BOOST_REQUIRE(decompressed == contents);
+
+  arma::mat csv, gzipped, untransposed;
+  BOOST_REQUIRE(data::Load("test_file.csv", csv) == true);
+  BOOST_REQUIRE(data::Load("test_file.csv.gz", gzipped) == true);
+  BOOST_REQUIRE(data::Load("test_file.csv.gz", untransposed, false, false)
+      == true);
+
+  BOOST_REQUIRE_EQUAL(gzipped.n_rows, csv.n_rows);
+  BOOST_REQUIRE_EQUAL(gzipped.n_cols, csv.n_cols);
+  BOOST_REQUIRE_EQUAL(untransposed.n_rows, csv.n_cols);
+  BOOST_REQUIRE_EQUAL(untransposed.n_cols, csv.n_rows);
+  for (size_t i = 0; i < csv.n_rows; ++i)
+  {
+    for (size_t j = 0; j < csv.n_cols; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(gzipped(i, j), csv(i, j));
+      BOOST_REQUIRE_EQUAL(untransposed(j, i), csv(i, j));
+    }
+  }
+
+  CheckChunkedLoad("test_file.csv.gz", csv);
+
+  // A truncated file is corrupt.
+  std::ifstream gzIn("test_file.csv.gz", std::ios::binary);
+  std::stringstream gzBuffer;
+  gzBuffer << gzIn.rdbuf();
+  gzIn.close();
+  std::ofstream gzOut("test_file.csv.gz", std::ios::binary);
+  gzOut << gzBuffer.str().substr(0, gzBuffer.str().size() / 2);
+  gzOut.close();
+
+  arma::mat truncated;
+  Log::Warn.ignoreInput = true;
+  BOOST_REQUIRE(data::Load("test_file.csv.gz", truncated) == false);
+  Log::Warn.ignoreInput = false;
+
+  remove("test_file.csv");
+  remove("test_file.csv.gz");
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
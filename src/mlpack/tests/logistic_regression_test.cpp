@@ -29,7 +29,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluate)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
 
   // These were hand-calculated using Octave.
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("1 1 1")), 7.0562141665, 1e-5);
@@ -57,7 +58,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRandomEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
 
   // Run a bunch of trials.
   for (size_t i = 0; i < trials; ++i)
@@ -99,9 +101,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -133,7 +135,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionGradient)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
   arma::vec gradient;
 
   // If the model is at the optimum, then the gradient should be zero.
@@ -182,7 +185,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSeparableEvaluate)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
 
   // These were hand-calculated using Octave.
   BOOST_REQUIRE_CLOSE(lrf.Evaluate(arma::vec("1 1 1"), 0), 4.85873516e-2, 1e-5);
@@ -231,9 +235,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableEvaluate)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   // Check that the number of functions is correct.
   BOOST_REQUIRE_EQUAL(lrfNoReg.NumFunctions(), points);
@@ -273,7 +277,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSeparableGradient)
   arma::vec responses("1 1 0");
 
   // Create a LogisticRegressionFunction.
-  LogisticRegressionFunction lrf(data, responses, 0.0 /* no regularization */);
+  LogisticRegressionFunction<> lrf(data, responses,
+      0.0 /* no regularization */);
   arma::vec gradient;
 
   // If the model is at the optimum, then the gradient should be zero.
@@ -354,9 +359,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationGradient)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -416,9 +421,9 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableGradient)
   for (size_t i = 0; i < points; ++i)
     responses[i] = math::RandInt(0, 2);
 
-  LogisticRegressionFunction lrfNoReg(data, responses, 0.0);
-  LogisticRegressionFunction lrfSmallReg(data, responses, 0.5);
-  LogisticRegressionFunction lrfBigReg(data, responses, 20.0);
+  LogisticRegressionFunction<> lrfNoReg(data, responses, 0.0);
+  LogisticRegressionFunction<> lrfSmallReg(data, responses, 0.5);
+  LogisticRegressionFunction<> lrfBigReg(data, responses, 20.0);
 
   for (size_t i = 0; i < trials; ++i)
   {
@@ -465,6 +470,123 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableGradient)
   }
 }
 
+/**
+ * Test that the batch Evaluate() and Gradient() overloads give the sum of the
+ * separable Evaluate() and Gradient() functions over the batch.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionBatchEvaluateGradient)
+{
+  const size_t points = 1000;
+  const size_t dimension = 10;
+  const size_t batchSize = 64;
+
+  // Create a random dataset.
+  arma::mat data;
+  data.randu(dimension, points);
+  // Create random responses.
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  arma::vec parameters(dimension + 1);
+  parameters.randu();
+
+  for (size_t begin = 0; begin < points; begin += batchSize)
+  {
+    const size_t size = std::min(batchSize, points - begin);
+
+    double objective = 0.0;
+    arma::vec gradient(dimension + 1);
+    gradient.zeros();
+    arma::vec pointGradient;
+    for (size_t i = begin; i < begin + size; ++i)
+    {
+      objective += lrf.Evaluate(parameters, i);
+      lrf.Gradient(parameters, i, pointGradient);
+      gradient += pointGradient;
+    }
+
+    arma::vec batchGradient;
+    lrf.Gradient(parameters, begin, size, batchGradient);
+
+    BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, begin, size), objective,
+        1e-5);
+    BOOST_REQUIRE_EQUAL(batchGradient.n_elem, parameters.n_elem);
+    for (size_t j = 0; j < parameters.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(batchGradient[j], gradient[j], 1e-5);
+  }
+}
+
+/**
+ * The objective and gradients on sparse predictors should be the same as on
+ * the same predictors stored densely, and so should the trained model.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionSparsePredictors)
+{
+  const size_t points = 500;
+  const size_t dimension = 50;
+
+  // Create a random sparse dataset whose responses depend on a few features.
+  arma::sp_mat sparseData;
+  sparseData.sprandu(dimension, points, 0.1);
+  const arma::mat data(sparseData);
+  arma::vec responses(points);
+  for (size_t i = 0; i < points; ++i)
+    responses[i] = (data(0, i) + data(1, i) - data(2, i) > 0.05) ? 1 : 0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  LogisticRegressionFunction<arma::sp_mat> sparseLrf(sparseData, responses,
+      0.5);
+
+  arma::vec parameters(dimension + 1);
+  parameters.randn();
+
+  BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters), lrf.Evaluate(parameters),
+      1e-8);
+  BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters, 7),
+      lrf.Evaluate(parameters, 7), 1e-8);
+  BOOST_REQUIRE_CLOSE(sparseLrf.Evaluate(parameters, 100, 50),
+      lrf.Evaluate(parameters, 100, 50), 1e-8);
+
+  arma::mat gradient, sparseGradient;
+  lrf.Gradient(parameters, gradient);
+  sparseLrf.Gradient(parameters, sparseGradient);
+  BOOST_REQUIRE_EQUAL(sparseGradient.n_elem, parameters.n_elem);
+  for (size_t j = 0; j < parameters.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(sparseGradient[j], gradient[j], 1e-8);
+
+  lrf.Gradient(parameters, 7, gradient);
+  sparseLrf.Gradient(parameters, 7, sparseGradient);
+  for (size_t j = 0; j < parameters.n_elem; ++j)
+  {
+    if (std::abs(gradient[j]) < 1e-12)
+      BOOST_REQUIRE_SMALL(sparseGradient[j], 1e-12);
+    else
+      BOOST_REQUIRE_CLOSE(sparseGradient[j], gradient[j], 1e-8);
+  }
+
+  lrf.Gradient(parameters, 100, 50, gradient);
+  sparseLrf.Gradient(parameters, 100, 50, sparseGradient);
+  for (size_t j = 0; j < parameters.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(sparseGradient[j], gradient[j], 1e-8);
+
+  // Train on both, and predict with the sparse model on the dense data too.
+  LogisticRegression<> lr(data, responses, 0.5);
+  LogisticRegression<L_BFGS, arma::sp_mat> sparseLr(sparseData, responses,
+      0.5);
+  for (size_t j = 0; j < parameters.n_elem; ++j)
+    BOOST_REQUIRE_CLOSE(sparseLr.Parameters()[j], lr.Parameters()[j], 1e-3);
+
+  arma::vec predictions, sparsePredictions;
+  lr.Predict(data, predictions);
+  sparseLr.Predict(sparseData, sparsePredictions);
+  BOOST_REQUIRE_EQUAL(sparsePredictions.n_elem, points);
+  for (size_t i = 0; i < points; ++i)
+    BOOST_REQUIRE_EQUAL(sparsePredictions[i], predictions[i]);
+}
+
 // Test training of logistic regression on a simple dataset.
 BOOST_AUTO_TEST_CASE(LogisticRegressionLBFGSSimpleTest)
 {
@@ -497,8 +619,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDSimpleTest)
 
   // Create a logistic regression object using a custom SGD object with a much
   // smaller tolerance.
-  LogisticRegressionFunction lrf(data, responses, 0.001);
-  SGD<LogisticRegressionFunction> sgd(lrf, 0.005, 500000, 1e-10);
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  SGD<LogisticRegressionFunction<> > sgd(lrf, 0.005, 500000, 1e-10);
   LogisticRegression<SGD> lr(sgd);
 
   // Test sigmoid function.
@@ -546,8 +668,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSGDRegularizationSimpleTest)
 
   // Create a logistic regression object using custom SGD with a much smaller
   // tolerance.
-  LogisticRegressionFunction lrf(data, responses, 0.001);
-  SGD<LogisticRegressionFunction> sgd(lrf, 0.005, 500000, 1e-10);
+  LogisticRegressionFunction<> lrf(data, responses, 0.001);
+  SGD<LogisticRegressionFunction<> > sgd(lrf, 0.005, 500000, 1e-10);
   LogisticRegression<SGD> lr(sgd);
 
   // Test sigmoid function.
@@ -666,8 +788,8 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   arma::vec responses("1 1 0");
 
   // Create an optimizer and function.
-  LogisticRegressionFunction lrf(data, responses, 0.0005);
-  L_BFGS<LogisticRegressionFunction> lbfgsOpt(lrf);
+  LogisticRegressionFunction<> lrf(data, responses, 0.0005);
+  L_BFGS<LogisticRegressionFunction<> > lbfgsOpt(lrf);
   lbfgsOpt.MinGradientNorm() = 1e-50;
   LogisticRegression<L_BFGS> lr(lbfgsOpt);
 
@@ -681,7 +803,7 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionInstantiatedOptimizer)
   BOOST_REQUIRE_SMALL(sigmoids[2], 0.1);
 
   // Now do the same with SGD.
-  SGD<LogisticRegressionFunction> sgdOpt(lrf);
+  SGD<LogisticRegressionFunction<> > sgdOpt(lrf);
   sgdOpt.StepSize() = 0.15;
   sgdOpt.Tolerance() = 1e-75;
   LogisticRegression<SGD> lr2(sgdOpt);
@@ -118,6 +118,76 @@ BOOST_AUTO_TEST_CASE(Johnson844LovaszThetaSDP)
   }
 }
 
+/**
+ * johnson8-4-4.co Lovasz-Theta LRSDP again, but with the edge constraints given
+ * as coordinate-sparse constraints, and with a rank-one constraint e^T X e = 14
+ * (which holds at the optimum) added.
+ */
+BOOST_AUTO_TEST_CASE(Johnson844LovaszThetaStructuredSDP)
+{
+  // Load the edges.
+  arma::mat edges;
+  data::Load("johnson8-4-4.csv", edges, true);
+
+  const size_t vertices = max(max(edges)) + 1;
+
+  // The LRSDP itself and the initial point.
+  arma::mat coordinates;
+
+  CreateLovaszThetaInitialPoint(edges, coordinates);
+
+  LRSDP<SDP<arma::mat>> lovasz(1, 0, coordinates);
+
+  // C = -(e e^T) = -ones().
+  lovasz.SDP().C().ones(vertices, vertices);
+  lovasz.SDP().C() *= -1;
+
+  // A_0 = I_n, b_0 = 1.
+  lovasz.SDP().SparseA()[0].eye(vertices, vertices);
+  lovasz.SDP().SparseB().ones(1);
+
+  // e^T X e = 14.
+  lovasz.SDP().RankOneA().push_back(arma::ones<arma::vec>(vertices));
+  lovasz.SDP().RankOneB() = "14.0";
+
+  // A_ij only has ones at (i, j) and (j, i), and b_ij = 0.
+  for (size_t i = 0; i < edges.n_cols; ++i)
+  {
+    arma::mat elements(3, 2);
+    elements(0, 0) = edges(0, i);
+    elements(1, 0) = edges(1, i);
+    elements(0, 1) = edges(1, i);
+    elements(1, 1) = edges(0, i);
+    elements.row(2).ones();
+    lovasz.SDP().CoordinateA().push_back(elements);
+  }
+  lovasz.SDP().CoordinateB().zeros(edges.n_cols);
+
+  // Set the Lagrange multipliers right; they are ordered sparse, rank-one,
+  // coordinate-sparse.
+  lovasz.AugLag().Lambda().ones(edges.n_cols + 2);
+  lovasz.AugLag().Lambda() *= -1;
+  lovasz.AugLag().Lambda()[0] = -double(vertices);
+  lovasz.AugLag().Lambda()[1] = 0.0;
+
+  double finalValue = lovasz.Optimize(coordinates);
+
+  // Final value taken from Monteiro + Burer 2004.
+  BOOST_REQUIRE_CLOSE(finalValue, -14.0, 1e-5);
+
+  // Now ensure that all the constraints are satisfied.
+  arma::mat rrt = coordinates * trans(coordinates);
+  BOOST_REQUIRE_CLOSE(trace(rrt), 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(accu(rrt), 14.0, 1e-5);
+
+  // All those edge constraints...
+  for (size_t i = 0; i < edges.n_cols; ++i)
+  {
+    BOOST_REQUIRE_SMALL(rrt(edges(0, i), edges(1, i)), 1e-5);
+    BOOST_REQUIRE_SMALL(rrt(edges(1, i), edges(0, i)), 1e-5);
+  }
+}
+
 /**
  * Create an unweighted graph laplacian from the edges.
  */
@@ -271,6 +341,120 @@ BOOST_AUTO_TEST_CASE(GaussianMatrixSensingSDP)
   BOOST_REQUIRE_SMALL(err, 1e-3);
 }
 
+/**
+ * The augmented Lagrangian of an LRSDP with sparse, dense, rank-one and
+ * coordinate-sparse constraints should match what is computed from R R^T
+ * directly.
+ */
+BOOST_AUTO_TEST_CASE(StructuredConstraintsAugLagrangian)
+{
+  const size_t n = 20;
+  arma::mat coordinates;
+  coordinates.randu(n, 3);
+
+  LRSDPFunction<SDP<arma::sp_mat>> function(10, 2, coordinates);
+  function.SDP().C().eye(n, n);
+  function.SDP().C()(3, 5) = 0.5;
+  function.SDP().C()(5, 3) = 0.5;
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    const size_t j = (3 * i + 1) % n;
+    function.SDP().SparseA()[i](i, i) = 1.;
+    function.SDP().SparseA()[i](j, j) = 1.;
+    function.SDP().SparseA()[i](i, j) = -1.;
+    function.SDP().SparseA()[i](j, i) = -1.;
+    function.SDP().SparseB()[i] = 0.1 * i;
+  }
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat a;
+    a.randu(n, n);
+    function.SDP().DenseA()[i] = a + trans(a);
+    function.SDP().DenseB()[i] = 1.0 + i;
+  }
+  function.SDP().RankOneA().push_back(arma::ones<arma::vec>(n));
+  function.SDP().RankOneA().push_back(arma::randu<arma::vec>(n));
+  function.SDP().RankOneB() = "0.0 2.0";
+  for (size_t i = 0; i < 3; ++i)
+  {
+    // Entries (i, i + 5) and (i + 5, i), and a repeated diagonal entry.
+    arma::mat elements(3, 4);
+    elements.col(0) = arma::vec("0 5 1") + i * arma::vec("1 1 0");
+    elements.col(1) = arma::vec("5 0 1") + i * arma::vec("1 1 0");
+    elements.col(2) = arma::vec("2 2 0.5") + i * arma::vec("1 1 0");
+    elements.col(3) = arma::vec("2 2 0.25") + i * arma::vec("1 1 0");
+    function.SDP().CoordinateA().push_back(elements);
+  }
+  function.SDP().CoordinateB() = "0.5 1.0 1.5";
+  BOOST_REQUIRE_EQUAL(function.NumConstraints(), 17);
+
+  // Every constraint matrix, as a dense matrix.
+  std::vector<arma::mat> ais;
+  arma::vec bis(17);
+  for (size_t i = 0; i < 10; ++i)
+  {
+    ais.push_back(arma::mat(function.SDP().SparseA()[i]));
+    bis[i] = function.SDP().SparseB()[i];
+  }
+  for (size_t i = 0; i < 2; ++i)
+  {
+    ais.push_back(function.SDP().DenseA()[i]);
+    bis[10 + i] = function.SDP().DenseB()[i];
+  }
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const arma::vec& a = function.SDP().RankOneA()[i];
+    ais.push_back(a * trans(a));
+    bis[12 + i] = function.SDP().RankOneB()[i];
+  }
+  for (size_t i = 0; i < 3; ++i)
+  {
+    ais.push_back(arma::mat(function.SDP().CoordinateSparseA(i)));
+    bis[14 + i] = function.SDP().CoordinateB()[i];
+  }
+
+  arma::vec lambda;
+  lambda.randu(17);
+  const double sigma = 3.0;
+  AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>> augLag(function,
+      lambda, sigma);
+
+  const arma::mat rrt = coordinates * trans(coordinates);
+  const arma::mat c(function.SDP().C());
+  double objective = accu(c % rrt);
+  arma::mat s = c;
+  arma::vec constraints;
+  function.EvaluateConstraints(coordinates, constraints);
+  BOOST_REQUIRE_EQUAL(constraints.n_elem, 17);
+  double penalty = 0.0;
+  for (size_t i = 0; i < 17; ++i)
+  {
+    const double constraint = accu(ais[i] % rrt) - bis[i];
+    BOOST_REQUIRE_CLOSE(function.EvaluateConstraint(i, coordinates) + 1.0,
+        constraint + 1.0, 1e-6);
+    BOOST_REQUIRE_CLOSE(constraints[i] + 1.0, constraint + 1.0, 1e-6);
+    penalty += constraint * constraint;
+
+    objective += -lambda[i] * constraint + (sigma / 2.) * constraint *
+        constraint;
+    s -= (lambda[i] - sigma * constraint) * ais[i];
+  }
+  const arma::mat gradient = 2 * s * coordinates;
+
+  BOOST_REQUIRE_CLOSE(augLag.Evaluate(coordinates), objective, 1e-6);
+  BOOST_REQUIRE_CLOSE(augLag.Penalty(coordinates), penalty, 1e-6);
+
+  arma::mat augLagGradient;
+  const double augLagObjective = augLag.EvaluateWithGradient(coordinates,
+      augLagGradient);
+  BOOST_REQUIRE_CLOSE(augLagObjective, objective, 1e-6);
+  BOOST_REQUIRE_EQUAL(augLagGradient.n_rows, n);
+  BOOST_REQUIRE_EQUAL(augLagGradient.n_cols, 3);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(augLagGradient[i] + 1.0, gradient[i] + 1.0, 1e-6);
+}
+
 /**
  * keller4.co test case for Lovasz-Theta LRSDP.
  * This is commented out because it takes a long time to run.
@@ -9,6 +9,7 @@
 #include "old_boost_test_definitions.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/lsh_tuner.hpp>
 
 using namespace std;
 using namespace mlpack;
@@ -61,16 +62,13 @@ BOOST_AUTO_TEST_CASE(LSHSearchTest)
   LSHSearch<> lsh_test(rdata, qdata, 3, 2, hashWidth, 11, 3);
 //   LSHSearch<> lsh_test(rdata, qdata, 3, 2, 0.0, 11, 3);
 
-  // Given this, the 'LSHSearch::bucketRowInHashTable' should be:
-  // COR.SOL.: [2 11 4 7 6 3 11 0 5 1 8]
+  // Given this, the 'LSHSearch::bucketOffsets' should be:
+  // COR.SOL.: [0 2 2 3 4 7 8 8 11 14 17 18]
   //
-  // The 'LSHSearch::bucketContentSize' should be:
-  // COR.SOL.: [2 0 1 1 3 1 0 3 3 3 1]
-  //
-  // The final hash table 'LSHSearch::secondHashTable' should be
-  // of size (3 x 9) with the following content:
+  // The final hash table 'LSHSearch::bucketContents' should hold the
+  // following buckets, one after another:
   // COR.SOL.:
-  // [0 2 4; 1 7 8; 3 9 10; 5 10 10; 6 10 10; 0 5 6; 1 2 8; 3 10 10; 4 10 10]
+  // [3 9 | | 6 | 3 | 1 2 8 | 5 | | 0 2 4 | 0 5 6 | 1 7 8 | 4]
 
   arma::Mat<size_t> neighbors;
   arma::mat distances;
@@ -108,4 +106,296 @@ BOOST_AUTO_TEST_CASE(LSHSearchTest)
   }
 }
 
+/**
+ * The batch size only changes how queries are grouped for hashing, so the
+ * results must not depend on it.
+ */
+BOOST_AUTO_TEST_CASE(LSHBatchSizeTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(5, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(5, 200);
+
+  LSHSearch<> lsh(rdata, qdata, 5, 8, 0.5, 99901, 100);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(3, neighbors, distances, 0, 0);
+  const size_t evaluations = lsh.DistanceEvaluations();
+
+  const size_t batchSizes[] = { 1, 7, 64, 1024 };
+  for (size_t b = 0; b < 4; ++b)
+  {
+    arma::Mat<size_t> batchNeighbors;
+    arma::mat batchDistances;
+    lsh.DistanceEvaluations() = 0;
+    lsh.Search(3, batchNeighbors, batchDistances, 0, batchSizes[b]);
+
+    BOOST_REQUIRE_EQUAL(lsh.DistanceEvaluations(), evaluations);
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(batchNeighbors[i], neighbors[i]);
+      BOOST_REQUIRE_CLOSE(batchDistances[i], distances[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * With a very large hash width every point lands in the same bucket, so LSH
+ * must return the exact nearest neighbors (and not the query point itself
+ * when searching a single set).
+ */
+BOOST_AUTO_TEST_CASE(LSHWideHashExactTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(3, 300);
+
+  LSHSearch<> lsh(rdata, 2, 2, 1e10, 99901, 300);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(1, neighbors, distances, 0, 50);
+
+  for (size_t i = 0; i < rdata.n_cols; ++i)
+  {
+    size_t best = rdata.n_cols;
+    double bestDistance = DBL_MAX;
+    for (size_t j = 0; j < rdata.n_cols; ++j)
+    {
+      if (i == j)
+        continue;
+      const double d = metric::EuclideanDistance::Evaluate(rdata.col(i),
+          rdata.col(j));
+      if (d < bestDistance)
+      {
+        bestDistance = d;
+        best = j;
+      }
+    }
+
+    BOOST_REQUIRE_EQUAL(neighbors(0, i), best);
+    BOOST_REQUIRE_CLOSE(distances(0, i), bestDistance, 1e-5);
+  }
+}
+
+/**
+ * Multiprobe LSH visits a superset of the buckets of plain LSH, so it must
+ * consider at least as many candidates and find neighbors that are at least
+ * as good.
+ */
+BOOST_AUTO_TEST_CASE(LSHMultiprobeTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 2000);
+  arma::mat qdata = arma::randu<arma::mat>(4, 100);
+
+  LSHSearch<> lsh(rdata, qdata, 6, 3, 0.3, 99901, 500);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(5, neighbors, distances);
+  const size_t evaluations = lsh.DistanceEvaluations();
+
+  arma::Mat<size_t> probeNeighbors;
+  arma::mat probeDistances;
+  lsh.DistanceEvaluations() = 0;
+  lsh.Search(5, probeNeighbors, probeDistances, 0, 1024, 10);
+
+  BOOST_REQUIRE_GT(lsh.DistanceEvaluations(), evaluations);
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    BOOST_REQUIRE_LE(probeDistances[i], distances[i]);
+}
+
+/**
+ * Hashing points with Insert() after the tables are built must give the same
+ * tables as hashing all the points at once, whatever type holds the point IDs.
+ */
+BOOST_AUTO_TEST_CASE(LSHInsertTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 3000);
+  arma::mat qdata = arma::randu<arma::mat>(4, 100);
+
+  math::RandomSeed(42);
+  LSHSearch<> lsh(rdata, qdata, 4, 5, 0.4, 99901, 0);
+  BOOST_REQUIRE_EQUAL(lsh.NumInsertedPoints(), 3000);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(5, neighbors, distances);
+
+  // Build the tables on the first half of the points, then insert the rest in
+  // two steps.
+  arma::mat growingData = rdata.cols(0, 1499);
+  math::RandomSeed(42);
+  LSHSearch<NearestNeighborSort, unsigned int> growingLSH(growingData, qdata,
+      4, 5, 0.4, 99901, 0);
+  BOOST_REQUIRE_EQUAL(growingLSH.NumInsertedPoints(), 1500);
+  BOOST_REQUIRE_EQUAL(growingLSH.Insert(), 0);
+
+  growingData.insert_cols(1500, rdata.cols(1500, 2199));
+  BOOST_REQUIRE_EQUAL(growingLSH.Insert(), 700);
+  growingData.insert_cols(2200, rdata.cols(2200, 2999));
+  BOOST_REQUIRE_EQUAL(growingLSH.Insert(), 800);
+  BOOST_REQUIRE_EQUAL(growingLSH.NumInsertedPoints(), 3000);
+  BOOST_REQUIRE_EQUAL(growingLSH.MaxBucketSize(), lsh.MaxBucketSize());
+
+  arma::Mat<size_t> growingNeighbors;
+  arma::mat growingDistances;
+  growingLSH.Search(5, growingNeighbors, growingDistances);
+
+  BOOST_REQUIRE_EQUAL(growingLSH.DistanceEvaluations(),
+      lsh.DistanceEvaluations());
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(growingNeighbors[i], neighbors[i]);
+    BOOST_REQUIRE_CLOSE(growingDistances[i], distances[i], 1e-5);
+  }
+}
+
+/**
+ * With a limited bucket size no bucket may hold more points than the limit,
+ * also after inserting more points.
+ */
+BOOST_AUTO_TEST_CASE(LSHBucketSizeTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(2, 500);
+
+  Log::Warn.ignoreInput = true;
+  LSHSearch<> lsh(rdata, 2, 2, 1e10, 99901, 100);
+  BOOST_REQUIRE_EQUAL(lsh.MaxBucketSize(), 100);
+
+  rdata.insert_cols(500, arma::randu<arma::mat>(2, 500));
+  BOOST_REQUIRE_EQUAL(lsh.Insert(), 500);
+  BOOST_REQUIRE_EQUAL(lsh.MaxBucketSize(), 100);
+  Log::Warn.ignoreInput = false;
+
+  // Without a limit, every point is in the single bucket of each table, and
+  // both tables share that bucket.
+  LSHSearch<> unlimited(rdata, 2, 2, 1e10, 99901, 0);
+  BOOST_REQUIRE_LE(unlimited.MaxBucketSize(), 2000);
+  BOOST_REQUIRE_GE(unlimited.MaxBucketSize(), 1000);
+}
+
+/**
+ * With the SimHash family, the distances are the angles estimated from the
+ * Hamming distances between the codes of the points, so they can be checked
+ * against codes computed directly from the hyperplanes.
+ */
+BOOST_AUTO_TEST_CASE(LSHSimHashTest)
+{
+  arma::mat rdata = arma::randn<arma::mat>(10, 1000);
+  arma::mat qdata = rdata.cols(0, 99) + 1e-8 * arma::randn<arma::mat>(10, 100);
+
+  const size_t numProj = 8;
+  const size_t numTables = 4;
+  LSHSearch<NearestNeighborSort, size_t, SimHash> lsh(rdata, qdata, numProj,
+      numTables);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(3, neighbors, distances);
+
+  // The codes of all points, as signs of the projections.
+  const arma::mat& hyperplanes = lsh.Hash().Hyperplanes();
+  const arma::umat referenceBits = (hyperplanes.t() * rdata >= 0.0);
+  const arma::umat queryBits = (hyperplanes.t() * qdata >= 0.0);
+
+  for (size_t i = 0; i < qdata.n_cols; ++i)
+  {
+    // Each query is a copy of a reference point (up to noise far below the
+    // precision of the hyperplanes), so that point is at angle 0.
+    BOOST_REQUIRE_SMALL(distances(0, i), 1e-10);
+
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      if (neighbors(j, i) == rdata.n_cols)
+        continue;
+
+      if (j > 0)
+        BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+
+      const size_t hamming = arma::accu(queryBits.col(i) !=
+          referenceBits.col(neighbors(j, i)));
+      BOOST_REQUIRE_CLOSE(distances(j, i) + 1.0, M_PI * hamming /
+          (numProj * numTables) + 1.0, 1e-8);
+    }
+  }
+
+  // Probing more buckets can only find better candidates.
+  arma::Mat<size_t> probeNeighbors;
+  arma::mat probeDistances;
+  lsh.Search(3, probeNeighbors, probeDistances, 0, 1024, 5);
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    BOOST_REQUIRE_LE(probeDistances[i], distances[i]);
+}
+
+/**
+ * The tuner must return the fastest configuration that reaches the target
+ * recall, and its recall must be what the tables with its parameters achieve.
+ */
+BOOST_AUTO_TEST_CASE(LSHTunerTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(3, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(3, 50);
+
+  LSHTuner<> tuner(rdata, qdata, 3, 0.9);
+  BOOST_REQUIRE_CLOSE(tuner.Recall(tuner.TrueNeighbors()), 1.0, 1e-10);
+  BOOST_REQUIRE_GT(tuner.BaseWidth(), 0.0);
+
+  tuner.Projections() = std::vector<size_t>(1, 4);
+  tuner.Tables().assign(2, 2);
+  tuner.Tables()[1] = 8;
+  // A very wide hash puts every point into the same bucket, which always
+  // reaches the recall.
+  tuner.WidthScales().assign(2, 1.0);
+  tuner.WidthScales()[1] = 1e10;
+  tuner.BucketSizes() = std::vector<size_t>(1, 0);
+
+  const LSHConfiguration& best = tuner.Tune();
+  BOOST_REQUIRE(tuner.Succeeded());
+  BOOST_REQUIRE_GE(best.recall, 0.9);
+  BOOST_REQUIRE_GT(best.memoryUsage, 0);
+
+  for (size_t i = 0; i < tuner.Configurations().size(); ++i)
+  {
+    const LSHConfiguration& c = tuner.Configurations()[i];
+    if (c.recall >= 0.9)
+      BOOST_REQUIRE_LE(best.searchTime, c.searchTime);
+  }
+
+  // The wide hash gives the exact neighbors with the fewest tables and no
+  // probes.
+  const LSHConfiguration& wide = tuner.Configurations().back();
+  BOOST_REQUIRE_EQUAL(wide.numTables, 2);
+  BOOST_REQUIRE_EQUAL(wide.numProbes, 0);
+  BOOST_REQUIRE_CLOSE(wide.recall, 1.0, 1e-10);
+
+  LSHSearch<> lsh(rdata, best.numProj, best.numTables, best.hashWidth,
+      tuner.SecondHashSize(), best.bucketSize);
+  BOOST_REQUIRE_EQUAL(lsh.MemoryUsage(), best.memoryUsage);
+}
+
+/**
+ * Tables that do not fit in the memory budget must not be used.
+ */
+BOOST_AUTO_TEST_CASE(LSHTunerMemoryBudgetTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(3, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(3, 20);
+
+  // The budget of the smallest tables (no points are dropped from the buckets,
+  // so no other tables with as many tables are larger).
+  LSHSearch<> small(rdata, 5, 5, 0.5, 99901, 0);
+  const size_t budget = small.MemoryUsage() + 1000;
+
+  LSHTuner<> tuner(rdata, qdata, 3, 1.0, budget);
+  tuner.Projections() = std::vector<size_t>(1, 5);
+  tuner.WidthScales() = std::vector<double>(1, 1.0);
+  tuner.Tune();
+
+  BOOST_REQUIRE_GT(tuner.Configurations().size(), 0);
+  for (size_t i = 0; i < tuner.Configurations().size(); ++i)
+  {
+    BOOST_REQUIRE_LE(tuner.Configurations()[i].memoryUsage, budget);
+    BOOST_REQUIRE_EQUAL(tuner.Configurations()[i].numTables, 5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -84,4 +84,42 @@ BOOST_AUTO_TEST_CASE(LSTMPeepholeForwardTest)
   BOOST_REQUIRE_CLOSE(output(0), std::tanh(state3 / 2) / 2, 1e-3);
 }
 
+/**
+ * Make sure that the state storage is reallocated correctly if the sequence
+ * length of the layer grows after construction.
+ */
+BOOST_AUTO_TEST_CASE(LSTMSequenceLengthTest)
+{
+  LSTMLayer<> layerA(2, 4, true);
+  LSTMLayer<> layerB(2, 1, true);
+  layerB.SeqLen() = 4;
+
+  layerB.InGatePeepholeWeights() = layerA.InGatePeepholeWeights();
+  layerB.ForgetGatePeepholeWeights() = layerA.ForgetGatePeepholeWeights();
+  layerB.OutGatePeepholeWeights() = layerA.OutGatePeepholeWeights();
+
+  arma::mat input = arma::randu<arma::mat>(8, 4);
+  arma::colvec outputA, outputB;
+  for (size_t i = 0; i < input.n_cols; i++)
+  {
+    layerA.FeedForward(input.unsafe_col(i), outputA);
+    layerB.FeedForward(input.unsafe_col(i), outputB);
+
+    for (size_t j = 0; j < outputA.n_elem; j++)
+      BOOST_REQUIRE_CLOSE(outputA(j), outputB(j), 1e-5);
+  }
+
+  arma::colvec error = arma::ones<arma::colvec>(2);
+  arma::colvec deltaA, deltaB;
+  for (size_t i = 0; i < input.n_cols; i++)
+  {
+    layerA.FeedBackward(input.unsafe_col(i), error, deltaA);
+    layerB.FeedBackward(input.unsafe_col(i), error, deltaB);
+
+    BOOST_REQUIRE_EQUAL(deltaA.n_elem, 8);
+    for (size_t j = 0; j < deltaA.n_elem; j++)
+      BOOST_REQUIRE_CLOSE(deltaA(j), deltaB(j), 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
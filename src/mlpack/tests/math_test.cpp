@@ -578,4 +578,56 @@ BOOST_AUTO_TEST_CASE(RangeContainsRange)
   BOOST_REQUIRE_EQUAL(b.Contains(a), true);
 }
 
+/**
+ * Make sure that the random streams depend only on the seed and the stream
+ * index.
+ */
+BOOST_AUTO_TEST_CASE(RandomStreamReproducibleTest)
+{
+  math::RandomSeed(42);
+  std::mt19937 a = math::RandomStream(3);
+  math::Random(); // Using randGen must not change the streams.
+  std::mt19937 b = math::RandomStream(3);
+  std::mt19937 c = math::RandomStream(4);
+
+  bool differs = false;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    const uint32_t x = a();
+    BOOST_REQUIRE_EQUAL(x, b());
+    if (x != c())
+      differs = true;
+  }
+  BOOST_REQUIRE(differs);
+}
+
+/**
+ * Make sure that the bulk fills are reproducible and stay in bounds.
+ */
+BOOST_AUTO_TEST_CASE(RandomFillTest)
+{
+  arma::mat a(10, 1000), b(10, 1000);
+
+  math::RandomSeed(7);
+  math::RandomFill(a, -2.0, 3.0);
+  math::RandomSeed(7);
+  math::RandomFill(b, -2.0, 3.0);
+
+  BOOST_REQUIRE_GE(a.min(), -2.0);
+  BOOST_REQUIRE_LT(a.max(), 3.0);
+  for (size_t i = 0; i < a.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(a[i], b[i]);
+
+  BOOST_REQUIRE_CLOSE(arma::mean(arma::vectorise(a)), 0.5, 5.0);
+
+  math::RandomSeed(7);
+  math::RandNormalFill(a, 1.0, 1.0);
+  math::RandomSeed(7);
+  math::RandNormalFill(b, 1.0, 1.0);
+  for (size_t i = 0; i < a.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(a[i], b[i]);
+
+  BOOST_REQUIRE_CLOSE(arma::mean(arma::vectorise(a)), 1.0, 5.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -59,4 +59,55 @@ BOOST_AUTO_TEST_CASE(UniformMatrixCompletionSDP)
   }
 }
 
+/**
+ * Alternating least squares, with the rank of the matrix, should recover a
+ * random low rank matrix from about half of its entries.
+ */
+BOOST_AUTO_TEST_CASE(UniformMatrixCompletionALS)
+{
+  const size_t m = 40;
+  const size_t n = 30;
+  const size_t rank = 2;
+  const arma::mat Xorig = arma::randu<arma::mat>(m, rank) *
+      arma::randu<arma::mat>(rank, n);
+
+  // Every entry is known with probability 0.5; every row and column gets at
+  // least a few.
+  std::vector<size_t> rows, cols;
+  for (size_t j = 0; j < n; ++j)
+  {
+    for (size_t i = 0; i < m; ++i)
+    {
+      if ((i + j) % 8 == 0 || math::Random() < 0.5)
+      {
+        rows.push_back(i);
+        cols.push_back(j);
+      }
+    }
+  }
+
+  arma::umat indices(2, rows.size());
+  arma::vec values(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    indices(0, i) = rows[i];
+    indices(1, i) = cols[i];
+    values(i) = Xorig(rows[i], cols[i]);
+  }
+
+  MatrixCompletion mc(m, n, indices, values, rank);
+  mc.Approximate() = true;
+  BOOST_REQUIRE(mc.Approximate());
+
+  arma::mat recovered;
+  mc.Recover(recovered);
+
+  BOOST_REQUIRE_EQUAL(recovered.n_rows, m);
+  BOOST_REQUIRE_EQUAL(recovered.n_cols, n);
+  const double err =
+    arma::norm(Xorig - recovered, "fro") /
+    arma::norm(Xorig, "fro");
+  BOOST_REQUIRE_SMALL(err, 1e-4);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
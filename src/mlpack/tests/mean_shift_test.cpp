@@ -85,4 +85,40 @@ BOOST_AUTO_TEST_CASE(MeanShiftSimpleTest) {
   
 }
 
+/**
+ * Make sure that larger, well separated clusters are found with and without
+ * seed binning, and that every centroid is close to the mean of its cluster.
+ */
+BOOST_AUTO_TEST_CASE(MeanShiftLargeClustersTest)
+{
+  math::RandomSeed(std::time(NULL));
+
+  arma::mat means("0.0 20.0 -20.0;"
+                  "0.0 10.0  10.0");
+  arma::mat data(2, 1500);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    data.col(i) = means.col(i / 500) + 0.5 * arma::randn<arma::vec>(2);
+
+  for (size_t useSeeds = 0; useSeeds < 2; ++useSeeds)
+  {
+    MeanShift<> meanShift(2.0);
+
+    arma::Col<size_t> assignments;
+    arma::mat centroids;
+    meanShift.Cluster(data, assignments, centroids, useSeeds == 1);
+
+    BOOST_REQUIRE_EQUAL(centroids.n_cols, 3);
+
+    for (size_t c = 0; c < 3; ++c)
+    {
+      const size_t cluster = assignments(500 * c);
+      for (size_t i = 500 * c; i < 500 * (c + 1); ++i)
+        BOOST_REQUIRE_EQUAL(assignments(i), cluster);
+
+      BOOST_REQUIRE_SMALL(arma::norm(centroids.col(cluster) - means.col(c), 2),
+          0.3);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
\ No newline at end of file
@@ -0,0 +1,149 @@
+/**
+ * @file minibatch_sgd_test.cpp
+ * @author Ryan Curtin
+ *
+ * Test file for mini-batch SGD, including Hogwild! mode.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression_function.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace std;
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(MiniBatchSGDTest);
+
+/**
+ * With a batch size of 1, mini-batch SGD is plain SGD; with a batch size of 3
+ * it is gradient descent on the whole function.  Both should find the minimum.
+ */
+BOOST_AUTO_TEST_CASE(SimpleMiniBatchSGDTestFunction)
+{
+  SGDTestFunction f;
+
+  for (size_t batchSize = 1; batchSize <= 3; batchSize += 2)
+  {
+    // The average gradient is used, so scale the step size with the batch.
+    MiniBatchSGD<SGDTestFunction> s(f, batchSize, 0.0003 * batchSize, 5000000,
+        1e-9, true);
+
+    arma::mat coordinates = f.GetInitialPoint();
+    double result = s.Optimize(coordinates);
+
+    BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+    BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+    BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+    BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+  }
+}
+
+/**
+ * Create a simple two-class Gaussian dataset for logistic regression.
+ */
+void CreateLogisticDataset(arma::mat& data, arma::vec& responses)
+{
+  data.set_size(3, 1000);
+  responses.set_size(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = arma::randn<arma::vec>(3) + arma::vec("1.0 1.0 1.0");
+    responses[i] = 0.0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = arma::randn<arma::vec>(3) + arma::vec("5.0 5.0 5.0");
+    responses[i] = 1.0;
+  }
+}
+
+/**
+ * Return the training accuracy of the given logistic regression parameters.
+ */
+double LogisticAccuracy(const arma::mat& data,
+                        const arma::vec& responses,
+                        const arma::mat& parameters)
+{
+  size_t correct = 0;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    const double sigmoid = 1.0 / (1.0 + std::exp(-parameters[0] -
+        arma::dot(data.col(i), parameters.rows(1, parameters.n_rows - 1))));
+    if ((sigmoid > 0.5) == (responses[i] == 1.0))
+      ++correct;
+  }
+
+  return double(correct) / data.n_cols;
+}
+
+/**
+ * Train logistic regression with mini-batch SGD, both serially and with
+ * Hogwild! updates.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchSGDLogisticRegressionTest)
+{
+  arma::mat data;
+  arma::vec responses;
+  CreateLogisticDataset(data, responses);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  for (size_t h = 0; h < 2; ++h)
+  {
+    MiniBatchSGD<LogisticRegressionFunction<> > s(lrf, 10, 0.01, 50000, 1e-5,
+        true, (h == 1));
+
+    arma::mat parameters = lrf.GetInitialPoint();
+    const double initialObjective = lrf.Evaluate(parameters);
+    const double result = s.Optimize(parameters);
+
+    BOOST_REQUIRE_LT(result, initialObjective);
+    BOOST_REQUIRE_CLOSE(result, lrf.Evaluate(parameters), 1e-5);
+    BOOST_REQUIRE_GT(LogisticAccuracy(data, responses, parameters), 0.95);
+  }
+}
+
+/**
+ * A limited number of batch steps should stop the optimization in the middle
+ * of a pass.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchSGDMaxIterationsTest)
+{
+  arma::mat data;
+  arma::vec responses;
+  CreateLogisticDataset(data, responses);
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  MiniBatchSGD<LogisticRegressionFunction<> > s(lrf, 32, 0.01, 1, 1e-5, false);
+  arma::mat parameters = lrf.GetInitialPoint();
+  s.MaxIterations() = 3;
+  s.Optimize(parameters);
+
+  // Three batch steps of the first 96 points, in order.
+  arma::mat expected = lrf.GetInitialPoint();
+  arma::mat gradient;
+  for (size_t b = 0; b < 3; ++b)
+  {
+    arma::mat batchGradient(expected.n_rows, expected.n_cols);
+    batchGradient.zeros();
+    for (size_t i = 32 * b; i < 32 * (b + 1); ++i)
+    {
+      lrf.Gradient(expected, i, gradient);
+      batchGradient += gradient;
+    }
+    expected -= (0.01 / 32) * batchGradient;
+  }
+
+  for (size_t i = 0; i < expected.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(parameters[i], expected[i], 1e-5);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
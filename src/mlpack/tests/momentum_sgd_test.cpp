@@ -0,0 +1,88 @@
+/**
+ * @file momentum_sgd_test.cpp
+ * @author Ryan Curtin
+ *
+ * Test file for SGD with momentum.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/optimizers/momentum_sgd/momentum_sgd.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace arma;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
+using namespace mlpack::distribution;
+
+BOOST_AUTO_TEST_SUITE(MomentumSGDTest);
+
+BOOST_AUTO_TEST_CASE(SimpleMomentumSGDTestFunction)
+{
+  SGDTestFunction f;
+  MomentumSGD<SGDTestFunction> s(f, 0.0003, 0.9, 5000000, 1e-9, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+/**
+ * With no momentum and no shuffling, momentum SGD must take exactly the steps
+ * of SGD.
+ */
+BOOST_AUTO_TEST_CASE(ZeroMomentumIsSGD)
+{
+  SGDTestFunction f;
+  MomentumSGD<SGDTestFunction> m(f, 0.0003, 0.0, 1000, 1e-9, false);
+  SGD<SGDTestFunction> s(f, 0.0003, 1000, 1e-9, false);
+
+  arma::mat momentumCoordinates = f.GetInitialPoint();
+  arma::mat sgdCoordinates = f.GetInitialPoint();
+  const double momentumResult = m.Optimize(momentumCoordinates);
+  const double sgdResult = s.Optimize(sgdCoordinates);
+
+  BOOST_REQUIRE_CLOSE(momentumResult, sgdResult, 1e-10);
+  for (size_t i = 0; i < sgdCoordinates.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(momentumCoordinates[i], sgdCoordinates[i], 1e-10);
+}
+
+/**
+ * Train logistic regression through its OptimizerType template parameter.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionMomentumSGDTest)
+{
+  // Generate a two-Gaussian dataset.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::vec responses(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegression<MomentumSGD> lr(data, responses, 0.5);
+
+  // Ensure that the error is close to zero.
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -122,4 +122,66 @@ BOOST_AUTO_TEST_CASE(NaiveBayesClassifierIncrementalTest)
     BOOST_REQUIRE_EQUAL(testRes(i), calcVec(i));
 }
 
+/**
+ * Training on a dataset batch by batch should give the same model as training
+ * on all of it at once, and the log-likelihoods should be those of the diagonal
+ * Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesClassifierBatchTrainingTest)
+{
+  arma::mat trainData;
+  data::Load("trainSet.csv", trainData, true);
+
+  arma::Col<size_t> labels(trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    labels[i] = trainData(trainData.n_rows - 1, i);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  NaiveBayesClassifier<> nbc(trainData, labels, 2);
+
+  // Train another classifier on three uneven batches.
+  NaiveBayesClassifier<> batchNbc(trainData.n_rows, 2);
+  const size_t splits[4] = { 0, 5, 17, trainData.n_cols };
+  for (size_t b = 0; b < 3; ++b)
+  {
+    const arma::Col<size_t> batchLabels =
+        labels.subvec(splits[b], splits[b + 1] - 1);
+    batchNbc.Train(trainData.cols(splits[b], splits[b + 1] - 1), batchLabels,
+        (b == 1));
+  }
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(batchNbc.Means()[i], nbc.Means()[i], 1e-8);
+    BOOST_REQUIRE_CLOSE(batchNbc.Variances()[i], nbc.Variances()[i], 1e-8);
+  }
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(batchNbc.Probabilities()[i], nbc.Probabilities()[i],
+        1e-8);
+    BOOST_REQUIRE_EQUAL(batchNbc.Counts()[i], nbc.Counts()[i]);
+  }
+
+  arma::mat logLikelihoods;
+  nbc.LogLikelihoods(trainData, logLikelihoods);
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_cols, trainData.n_cols);
+
+  for (size_t j = 0; j < trainData.n_cols; ++j)
+  {
+    for (size_t i = 0; i < 2; ++i)
+    {
+      double logLikelihood = std::log(nbc.Probabilities()[i]);
+      for (size_t k = 0; k < trainData.n_rows; ++k)
+      {
+        const double var = nbc.Variances()(k, i);
+        const double diff = trainData(k, j) - nbc.Means()(k, i);
+        logLikelihood -= 0.5 * (std::log(2 * M_PI * var) + diff * diff / var);
+      }
+
+      BOOST_REQUIRE_CLOSE(logLikelihoods(i, j), logLikelihood, 1e-8);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
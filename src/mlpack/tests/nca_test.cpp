@@ -244,6 +244,73 @@ BOOST_AUTO_TEST_CASE(SoftmaxSeparableGradient)
   BOOST_REQUIRE_CLOSE(gradient(1, 1), -2.0 * -0.1435886, 0.01);
 }
 
+/**
+ * When the sums are truncated to the nearest neighbors, the separable objective
+ * should only consider the nearest neighbors of each point, and the
+ * non-separable objective and gradient should be the sums of the separable
+ * ones (with and without truncation).
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxTruncatedNeighbors)
+{
+  arma::mat data;
+  data.randu(3, 40);
+  arma::Col<size_t> labels(40);
+  for (size_t i = 0; i < 40; ++i)
+    labels[i] = ((data(0, i) > 0.5) ? 1 : 0);
+
+  const arma::mat coordinates = "1.5 0.2 0.0; 0.0 1.0 -0.3; 0.1 0.0 0.8";
+  const arma::mat stretched = coordinates * data;
+
+  for (size_t neighbors = 0; neighbors <= 10; neighbors += 10)
+  {
+    SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels,
+        SquaredEuclideanDistance(), neighbors);
+
+    double objective = 0;
+    arma::mat gradient = arma::zeros<arma::mat>(3, 3);
+    for (size_t i = 0; i < 40; ++i)
+    {
+      // Compute p_i by brute force over the nearest neighbors.
+      arma::vec distances(40);
+      for (size_t k = 0; k < 40; ++k)
+        distances[k] = SquaredEuclideanDistance::Evaluate(stretched.col(i),
+            stretched.col(k));
+      const arma::uvec order = arma::sort_index(distances);
+      const size_t considered = ((neighbors == 0) ? 39 : neighbors);
+
+      double numerator = 0;
+      double denominator = 0;
+      for (size_t k = 1; k <= considered; ++k)
+      {
+        const double eval = std::exp(-distances[order[k]]);
+        if (labels[order[k]] == labels[i])
+          numerator += eval;
+        denominator += eval;
+      }
+
+      const double p = sef.Evaluate(coordinates, i);
+      BOOST_REQUIRE_CLOSE(p, -numerator / denominator, 1e-5);
+      objective += p;
+
+      arma::mat pointGradient;
+      sef.Gradient(coordinates, i, pointGradient);
+      gradient += pointGradient;
+    }
+
+    BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates), objective, 1e-5);
+
+    arma::mat fullGradient;
+    sef.Gradient(coordinates, fullGradient);
+    for (size_t i = 0; i < gradient.n_elem; ++i)
+    {
+      if (std::abs(gradient[i]) < 1e-8)
+        BOOST_REQUIRE_SMALL(fullGradient[i], 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(fullGradient[i], gradient[i], 1e-5);
+    }
+  }
+}
+
 //
 // Tests for the NCA algorithm.
 //
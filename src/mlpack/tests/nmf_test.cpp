@@ -64,6 +64,32 @@ BOOST_AUTO_TEST_CASE(NMFAcolDistTest)
       0.015);
 }
 
+/**
+ * Check that the factorization converges when the residue is estimated from a
+ * sample of the entries, and only every few iterations.
+ */
+BOOST_AUTO_TEST_CASE(NMFSampledResidueTest)
+{
+  mat w = randu<mat>(20, 12);
+  mat h = randu<mat>(12, 20);
+  mat v = w * h;
+  const size_t r = 12;
+
+  SampledResidueTermination srt(1e-7, 10000, 100, 5);
+  AMF<SampledResidueTermination, RandomAcolInitialization<> > nmf(srt);
+  nmf.Apply(v, r, w, h);
+
+  mat wh = w * h;
+
+  BOOST_REQUIRE_SMALL(arma::norm(v - wh, "fro") / arma::norm(v, "fro"),
+      0.015);
+  BOOST_REQUIRE_LT(nmf.TerminationPolicy().Iteration(), 10000);
+
+  // The policy is only evaluated on the first of every five iterations, so it
+  // can only converge right after one of those.
+  BOOST_REQUIRE_EQUAL((nmf.TerminationPolicy().Iteration() - 2) % 5, 0);
+}
+
 /**
  * Check the if the product of the calculated factorization is close to the
  * input matrix. Random initialization divergence minimization update.
@@ -211,4 +237,79 @@ BOOST_AUTO_TEST_CASE(SparseNMFALSTest)
       1e-5);
 }
 
+/**
+ * Make sure that the multiplicative update rules compute the same step as the
+ * whole-matrix formulas.
+ */
+BOOST_AUTO_TEST_CASE(NMFMultiplicativeUpdateRulesTest)
+{
+  mat v = randu<mat>(15, 12);
+  mat w = randu<mat>(15, 4);
+  mat h = randu<mat>(4, 12);
+
+  mat distW = w, distH = h;
+  NMFMultiplicativeDistanceUpdate dist;
+  dist.WUpdate(v, distW, distH);
+  dist.HUpdate(v, distW, distH);
+
+  mat refW = (w % (v * h.t())) / (w * h * h.t());
+  mat refH = (h % (refW.t() * v)) / (refW.t() * refW * h);
+
+  for (size_t i = 0; i < refW.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(distW[i], refW[i], 1e-8);
+  for (size_t i = 0; i < refH.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(distH[i], refH[i], 1e-8);
+
+  mat divW = w, divH = h;
+  NMFMultiplicativeDivergenceUpdate div;
+  div.WUpdate(v, divW, divH);
+  div.HUpdate(v, divW, divH);
+
+  refW = w % (((v / (w * h)) * h.t()) /
+      repmat(arma::sum(h, 1).t(), w.n_rows, 1));
+  refH = h % ((refW.t() * (v / (refW * h))) /
+      repmat(arma::sum(refW, 0).t(), 1, h.n_cols));
+
+  for (size_t i = 0; i < refW.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(divW[i], refW[i], 1e-8);
+  for (size_t i = 0; i < refH.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(divH[i], refH[i], 1e-8);
+}
+
+/**
+ * Make sure that the sparse multiplicative divergence update rules, which only
+ * evaluate W * H at the nonzero elements of V, take the same steps as the
+ * dense rules.
+ */
+BOOST_AUTO_TEST_CASE(SparseNMFDivergenceUpdateTest)
+{
+  sp_mat v;
+  v.sprandu(20, 15, 0.3);
+  mat dv(v);
+  mat w = randu<mat>(20, 4);
+  mat h = randu<mat>(4, 15);
+
+  mat sw = w, sh = h;
+  NMFMultiplicativeDivergenceUpdate sparseUpdate;
+  sparseUpdate.Initialize(v, 4);
+
+  mat dw = w, dh = h;
+  NMFMultiplicativeDivergenceUpdate denseUpdate;
+  denseUpdate.Initialize(dv, 4);
+
+  for (size_t iteration = 0; iteration < 3; ++iteration)
+  {
+    sparseUpdate.WUpdate(v, sw, sh);
+    sparseUpdate.HUpdate(v, sw, sh);
+
+    denseUpdate.WUpdate(dv, dw, dh);
+    denseUpdate.HUpdate(dv, dw, dh);
+  }
+
+  for (size_t i = 0; i < dw.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(sw[i], dw[i], 1e-6);
+  for (size_t i = 0; i < dh.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(sh[i], dh[i], 1e-6);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,156 @@
+/**
+ * @file nn_descent_test.cpp
+ * @author Ryan Curtin
+ *
+ * Tests for NN-descent k-nearest-neighbor graph construction.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/nn_descent/nn_descent.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <boost/test/unit_test.hpp>
+#include "old_boost_test_definitions.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+BOOST_AUTO_TEST_SUITE(NNDescentTest);
+
+/**
+ * Return the fraction of the true neighbors that were found.
+ */
+double Recall(const arma::Mat<size_t>& neighbors,
+              const arma::Mat<size_t>& trueNeighbors)
+{
+  size_t found = 0;
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+      for (size_t l = 0; l < trueNeighbors.n_rows; ++l)
+        if (neighbors(j, i) == trueNeighbors(l, i))
+          ++found;
+
+  return (double) found / trueNeighbors.n_elem;
+}
+
+/**
+ * Make sure the output has the same format as the output of NeighborSearch:
+ * every column is sorted, the distances are correct, and no point is its own
+ * neighbor or holds a neighbor twice.
+ */
+BOOST_AUTO_TEST_CASE(OutputFormatTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+
+  NNDescent<> nnDescent(dataset, 5);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnDescent.Build(8, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 8);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 500);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 8);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 500);
+  BOOST_REQUIRE_LE(nnDescent.Iterations(), 5);
+
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_LT(neighbors(j, i), 500);
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+      BOOST_REQUIRE_CLOSE(distances(j, i), metric::EuclideanDistance::Evaluate(
+          dataset.col(i), dataset.col(neighbors(j, i))), 1e-5);
+      if (j > 0)
+        BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+      for (size_t l = 0; l < j; ++l)
+        BOOST_REQUIRE_NE(neighbors(l, i), neighbors(j, i));
+    }
+  }
+}
+
+/**
+ * NN-descent should find nearly all of the true nearest neighbors on
+ * low-dimensional data.
+ */
+BOOST_AUTO_TEST_CASE(RecallTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 2000);
+
+  AllkNN naive(dataset, true);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(10, trueNeighbors, trueDistances);
+
+  NNDescent<> nnDescent(dataset);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnDescent.Build(10, neighbors, distances);
+
+  BOOST_REQUIRE_GT(Recall(neighbors, trueNeighbors), 0.95);
+
+  // With sampling, the graph is still good.
+  nnDescent.SampleRate() = 0.5;
+  nnDescent.Build(10, neighbors, distances);
+
+  BOOST_REQUIRE_GT(Recall(neighbors, trueNeighbors), 0.9);
+}
+
+/**
+ * Starting from the exact graph, nothing changes, and the algorithm stops
+ * after one iteration.  Invalid initial neighbors are ignored.
+ */
+BOOST_AUTO_TEST_CASE(InitialNeighborsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 1000);
+
+  AllkNN naive(dataset, true);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(6, trueNeighbors, trueDistances);
+
+  // Add a row of invalid neighbors, like the ones LSHSearch returns when not
+  // enough candidates are found.
+  arma::Mat<size_t> initialNeighbors(7, 1000);
+  initialNeighbors.rows(0, 5) = trueNeighbors;
+  initialNeighbors.row(6).fill(SIZE_MAX);
+
+  NNDescent<> nnDescent(dataset, 30, 1.0, 0.0);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnDescent.Build(initialNeighbors, 6, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(nnDescent.Iterations(), 1);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(distances[i], trueDistances[i], 1e-5);
+
+  // Partial initial neighbors give at least as good a graph as the true
+  // neighbors that were given.
+  nnDescent.MaxIterations() = 0;
+  nnDescent.Build(trueNeighbors.rows(0, 2), 6, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(nnDescent.Iterations(), 0);
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_REQUIRE_CLOSE(distances(j, i), trueDistances(j, i), 1e-5);
+}
+
+/**
+ * The graph only depends on the random seed, not on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(ReproducibleTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 3000);
+
+  NNDescent<> nnDescent(dataset, 3, 0.5);
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  math::RandomSeed(17);
+  nnDescent.Build(5, neighbors1, distances1);
+  math::RandomSeed(17);
+  nnDescent.Build(5, neighbors2, distances2);
+
+  BOOST_REQUIRE_EQUAL(arma::accu(neighbors1 != neighbors2), 0);
+  BOOST_REQUIRE_EQUAL(arma::accu(distances1 != distances2), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
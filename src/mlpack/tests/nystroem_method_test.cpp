@@ -13,7 +13,9 @@
 #include <mlpack/methods/nystroem_method/ordered_selection.hpp>
 #include <mlpack/methods/nystroem_method/random_selection.hpp>
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
+#include <mlpack/methods/nystroem_method/kmeans_plus_plus_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
+#include <mlpack/methods/nystroem_method/nystroem_features.hpp>
 
 using namespace mlpack;
 using namespace mlpack::kernel;
@@ -179,4 +181,99 @@ BOOST_AUTO_TEST_CASE(GermanTest)
   }
 }
 
+/**
+ * Make sure the k-means++ selection picks a point of every well-separated
+ * cluster, and that with full rank (all points selected) the Nystroem method
+ * reconstructs the kernel matrix of a kernel without batch evaluation.
+ */
+BOOST_AUTO_TEST_CASE(KMeansPlusPlusSelectionTest)
+{
+  // Three tight clusters of ten points each.
+  arma::mat data;
+  data.randu(3, 30);
+  data *= 0.01;
+  data.cols(10, 19) += 10.0;
+  data.cols(20, 29) -= 10.0;
+
+  arma::Col<size_t> selected = KMeansPlusPlusSelection::Select(data, 3);
+  BOOST_REQUIRE_EQUAL(selected.n_elem, 3);
+  bool clusters[3] = { false, false, false };
+  for (size_t i = 0; i < 3; ++i)
+    clusters[selected[i] / 10] = true;
+  BOOST_REQUIRE(clusters[0] && clusters[1] && clusters[2]);
+
+  // All the points are distinct, so they are all selected.
+  data.randu(3, 30);
+  LaplacianKernel lk(0.5);
+  NystroemMethod<LaplacianKernel, KMeansPlusPlusSelection> nm(data, lk, 30);
+  arma::mat g;
+  nm.Apply(g);
+
+  const arma::mat approximation = g * g.t();
+  for (size_t i = 0; i < data.n_cols; ++i)
+    for (size_t j = 0; j < data.n_cols; ++j)
+      BOOST_REQUIRE_CLOSE(approximation(i, j),
+          lk.Evaluate(data.col(i), data.col(j)), 1e-3);
+}
+
+/**
+ * With every point as a landmark, the dot products of the Nystroem features of
+ * the training points should be the kernel, and new points should be mapped
+ * consistently.
+ */
+BOOST_AUTO_TEST_CASE(NystroemFeaturesFullRankTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 40);
+  GaussianKernel gk(0.8);
+
+  NystroemFeatures<GaussianKernel, OrderedSelection> nystroem(gk, 40);
+  nystroem.Train(data);
+  BOOST_REQUIRE_EQUAL(nystroem.Landmarks().n_cols, 40);
+
+  arma::mat features;
+  nystroem.Transform(data, features);
+  BOOST_REQUIRE_EQUAL(features.n_rows, 40);
+  BOOST_REQUIRE_EQUAL(features.n_cols, 40);
+
+  const arma::mat approximation = features.t() * features;
+  for (size_t i = 0; i < data.n_cols; ++i)
+    for (size_t j = 0; j < data.n_cols; ++j)
+      BOOST_REQUIRE_SMALL(approximation(i, j) -
+          gk.Evaluate(data.col(i), data.col(j)), 1e-4);
+
+  // Points mapped in several blocks get the same features as on their own.
+  arma::mat test = arma::randu<arma::mat>(4, 600);
+  nystroem.Transform(test, features);
+  arma::mat single;
+  nystroem.Transform(test.col(550), single);
+  for (size_t i = 0; i < 40; ++i)
+    BOOST_REQUIRE_SMALL(single[i] - features(i, 550), 1e-10);
+}
+
+/**
+ * With fewer landmarks than points, the features should still give a good
+ * approximation of the kernel, and duplicate landmarks (from random selection)
+ * should not break the normalization.
+ */
+BOOST_AUTO_TEST_CASE(NystroemFeaturesLowRankTest)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 300);
+  GaussianKernel gk(1.0);
+
+  NystroemFeatures<GaussianKernel, RandomSelection> nystroem(gk, 60);
+  nystroem.Train(data);
+
+  arma::mat features;
+  nystroem.Transform(data, features);
+  BOOST_REQUIRE(features.is_finite());
+
+  double maxError = 0.0;
+  for (size_t i = 0; i < data.n_cols; i += 10)
+    for (size_t j = 0; j < data.n_cols; j += 10)
+      maxError = std::max(maxError, std::abs(arma::dot(features.col(i),
+          features.col(j)) - gk.Evaluate(data.col(i), data.col(j))));
+
+  BOOST_REQUIRE_LT(maxError, 0.01);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
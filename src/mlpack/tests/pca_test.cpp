@@ -6,6 +6,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/pca/pca.hpp>
+#include <mlpack/methods/pca/incremental_pca.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -197,5 +198,94 @@ BOOST_AUTO_TEST_CASE(PCAScalingTest)
   BOOST_REQUIRE_CLOSE(accu(eigval), 3.0, 0.1); // 10% tolerance.
 }
 
+/**
+ * Make sure that the randomized and incremental methods give the same
+ * dimensionality reduction as the exact method, on data that has (nearly) the
+ * kept number of dimensions of variance.
+ */
+BOOST_AUTO_TEST_CASE(PCARandomizedIncrementalTest)
+{
+  // Three dimensions of variance in 20 dimensions, plus a little noise.
+  mat data = randn<mat>(20, 3) * randn<mat>(3, 400);
+  data += 1e-3 * randn<mat>(20, 400);
+  data.each_col() += randu<vec>(20);
+
+  mat exactData(data);
+  PCA exact;
+  const double exactVarRetained = exact.Apply(exactData, 3);
+
+  mat randomizedData(data);
+  PCA randomized(false, true);
+  const double randomizedVarRetained = randomized.Apply(randomizedData, 3);
+
+  // Feed the incremental method chunks of 50 points.
+  IncrementalPCA incremental(3);
+  for (size_t i = 0; i < data.n_cols; i += 50)
+    incremental.Update(data.cols(i, i + 49));
+  mat incrementalData;
+  incremental.Transform(data, incrementalData);
+
+  BOOST_REQUIRE_EQUAL(randomizedData.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_cols, data.n_cols);
+  BOOST_REQUIRE_EQUAL(incrementalData.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(incrementalData.n_cols, data.n_cols);
+  BOOST_REQUIRE_EQUAL(incremental.Points(), data.n_cols);
+
+  BOOST_REQUIRE_CLOSE(randomizedVarRetained, exactVarRetained, 1e-3);
+  BOOST_REQUIRE_CLOSE(incremental.VarianceRetained(), exactVarRetained, 1e-3);
+
+  // The components are only defined up to their sign.
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      BOOST_REQUIRE_SMALL(fabs(randomizedData(i, j)) -
+          fabs(exactData(i, j)), 1e-2);
+      BOOST_REQUIRE_SMALL(fabs(incrementalData(i, j)) -
+          fabs(exactData(i, j)), 1e-2);
+    }
+  }
+}
+
+/**
+ * PCA on sparse data, centered implicitly, should give the same components as
+ * PCA on the same data stored densely.
+ */
+BOOST_AUTO_TEST_CASE(PCASparseTest)
+{
+  // Independent dimensions with well-separated variances and nonzero means.
+  mat denseData = randu<mat>(15, 400);
+  denseData %= conv_to<mat>::from(randu<mat>(15, 400) < 0.3);
+  denseData.each_col() %= linspace<vec>(1, 15, 15);
+  const sp_mat data(denseData);
+
+  mat exactData(denseData);
+  PCA exact;
+  const double exactVarRetained = exact.Apply(exactData, 3);
+
+  mat sparseData;
+  vec eigVal;
+  mat eigvec;
+  PCA sparse;
+  const double sparseVarRetained = sparse.Apply(data, sparseData, eigVal,
+      eigvec, 3);
+
+  BOOST_REQUIRE_EQUAL(sparseData.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(sparseData.n_cols, data.n_cols);
+  BOOST_REQUIRE_EQUAL(eigVal.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(eigvec.n_rows, 15);
+  BOOST_REQUIRE_EQUAL(eigvec.n_cols, 3);
+  BOOST_REQUIRE_CLOSE(sparseVarRetained, exactVarRetained, 1e-4);
+
+  // The eigenvalues are the variances of the components.
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(eigVal[i], var(sparseData.row(i)), 1e-4);
+
+  // The components are only defined up to their sign.
+  for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < data.n_cols; ++j)
+      BOOST_REQUIRE_SMALL(fabs(sparseData(i, j)) - fabs(exactData(i, j)),
+          1e-4);
+}
 
 BOOST_AUTO_TEST_SUITE_END();
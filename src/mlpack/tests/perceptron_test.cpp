@@ -166,4 +166,88 @@ BOOST_AUTO_TEST_CASE(SecondaryConstructor)
   Perceptron<> p2(p1);
 }
 
+/**
+ * The averaged perceptron should classify the non-linearly separable dataset
+ * like the perceptron does.
+ */
+BOOST_AUTO_TEST_CASE(AveragedNonLinearlySeparableDataset)
+{
+  mat trainData;
+  trainData << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8
+            << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << endr
+            << 1 << 1 << 1 << 1 << 1 << 1 << 1 << 1
+            << 2 << 2 << 2 << 2 << 2 << 2 << 2 << 2 << endr;
+
+  Mat<size_t> labels;
+  labels << 0 << 0 << 0 << 1 << 0 << 1 << 1 << 1
+         << 0 << 0 << 0 << 1 << 0 << 1 << 1 << 1;
+
+  Perceptron<> p(trainData, labels.row(0), 1000, true);
+  BOOST_REQUIRE(p.Average());
+
+  mat testData;
+  testData << 3 << 4   << 5   << 6   << endr
+           << 3 << 2.3 << 1.7 << 1.5 << endr;
+  Row<size_t> predictedLabels;
+  p.Classify(testData, predictedLabels);
+
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, 4);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 0), 0);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 1), 0);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 2), 1);
+  BOOST_CHECK_EQUAL(predictedLabels(0, 3), 1);
+}
+
+/**
+ * Training and classifying sparse data should give the same results as the
+ * same data stored densely.
+ */
+BOOST_AUTO_TEST_CASE(SparseMatchesDense)
+{
+  // Three classes, each with its own few nonzero dimensions.
+  const size_t dimensionality = 30;
+  const size_t points = 1500;
+  mat data(dimensionality, points);
+  data.zeros();
+  Row<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    labels[i] = i % 3;
+    for (size_t k = 0; k < 4; ++k)
+      data(10 * labels[i] + math::RandInt(10), i) = math::Random(0.5, 1.5);
+  }
+
+  const sp_mat sparseData(data);
+
+  Perceptron<> dense(data, labels, 100, true);
+  Perceptron<SimpleWeightUpdate, ZeroInitialization, sp_mat> sparse(sparseData,
+      labels, 100, true);
+
+  BOOST_REQUIRE_EQUAL(sparse.Weights().n_rows, dimensionality);
+  BOOST_REQUIRE_EQUAL(sparse.Weights().n_cols, 3);
+  for (size_t i = 0; i < dense.Weights().n_elem; ++i)
+  {
+    if (std::abs(dense.Weights()[i]) < 1e-10)
+      BOOST_REQUIRE_SMALL(sparse.Weights()[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(sparse.Weights()[i], dense.Weights()[i], 1e-8);
+  }
+  for (size_t i = 0; i < dense.Biases().n_elem; ++i)
+    BOOST_REQUIRE_SMALL(sparse.Biases()[i] - dense.Biases()[i], 1e-8);
+
+  Row<size_t> densePredictions, sparsePredictions;
+  dense.Classify(data, densePredictions);
+  sparse.Classify(sparseData, sparsePredictions);
+
+  BOOST_REQUIRE_EQUAL(sparsePredictions.n_elem, points);
+  size_t correct = 0;
+  for (size_t i = 0; i < points; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(sparsePredictions[i], densePredictions[i]);
+    if (sparsePredictions[i] == labels[i])
+      ++correct;
+  }
+  BOOST_REQUIRE_GE(correct, 0.95 * points);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
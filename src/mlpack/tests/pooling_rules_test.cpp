@@ -72,4 +72,82 @@ BOOST_AUTO_TEST_CASE(MeanPoolingTest)
   BOOST_REQUIRE_EQUAL(b, true);
 }
 
+/**
+ * Make sure the whole-map max pooling gives the same results as pooling every
+ * block separately, and that the error is passed back to the maxima.
+ */
+BOOST_AUTO_TEST_CASE(MaxPoolingFeatureMapTest)
+{
+  // The data was generated by magic(6) in MATLAB.
+  arma::mat input;
+  input << 35 << 1 << 6 << 26 << 19 << 24 << arma::endr
+        << 3 << 32 << 7 << 21 << 23 << 25 << arma::endr
+        << 31 << 9 << 2 << 22 << 27 << 20 << arma::endr
+        << 8 << 28 << 33 << 17 << 10 << 15 << arma::endr
+        << 30 << 5 << 34 << 12 << 14 << 16 << arma::endr
+        << 4 << 36 << 29 << 13 << 18 << 11;
+
+  MaxPooling poolingRule;
+  arma::mat output = arma::zeros<arma::mat>(3, 2);
+  arma::Mat<size_t> indices;
+  poolingRule.Pooling(input, 2, 3, output, indices);
+
+  for (size_t i = 0; i < 3; i++)
+  {
+    for (size_t j = 0; j < 2; j++)
+    {
+      const double blockMax = poolingRule.Pooling(input(
+          arma::span(2 * i, 2 * i + 1), arma::span(3 * j, 3 * j + 2)));
+      BOOST_REQUIRE_EQUAL(output(i, j), blockMax);
+      BOOST_REQUIRE_EQUAL(input[indices(i, j)], blockMax);
+    }
+  }
+
+  arma::mat error = arma::ones<arma::mat>(3, 2);
+  arma::mat unpooled = arma::zeros<arma::mat>(6, 6);
+  poolingRule.Unpooling(error, 2, 3, indices, unpooled);
+
+  BOOST_REQUIRE_EQUAL(arma::accu(unpooled), 6);
+  for (size_t i = 0; i < indices.n_elem; i++)
+    BOOST_REQUIRE_EQUAL(unpooled[indices[i]], 1);
+}
+
+/**
+ * Make sure the whole-map mean pooling gives the same results as pooling every
+ * block separately.
+ */
+BOOST_AUTO_TEST_CASE(MeanPoolingFeatureMapTest)
+{
+  // The data was generated by magic(6) in MATLAB.
+  arma::mat input;
+  input << 35 << 1 << 6 << 26 << 19 << 24 << arma::endr
+        << 3 << 32 << 7 << 21 << 23 << 25 << arma::endr
+        << 31 << 9 << 2 << 22 << 27 << 20 << arma::endr
+        << 8 << 28 << 33 << 17 << 10 << 15 << arma::endr
+        << 30 << 5 << 34 << 12 << 14 << 16 << arma::endr
+        << 4 << 36 << 29 << 13 << 18 << 11;
+
+  MeanPooling poolingRule;
+  arma::mat output = arma::zeros<arma::mat>(3, 2);
+  arma::Mat<size_t> indices;
+  poolingRule.Pooling(input, 2, 3, output, indices);
+
+  for (size_t i = 0; i < 3; i++)
+  {
+    for (size_t j = 0; j < 2; j++)
+    {
+      const double blockMean = poolingRule.Pooling(input(
+          arma::span(2 * i, 2 * i + 1), arma::span(3 * j, 3 * j + 2)));
+      BOOST_REQUIRE_CLOSE(output(i, j), blockMean, 1e-5);
+    }
+  }
+
+  arma::mat error = arma::ones<arma::mat>(3, 2);
+  arma::mat unpooled = arma::zeros<arma::mat>(6, 6);
+  poolingRule.Unpooling(error, 2, 3, indices, unpooled);
+
+  for (size_t i = 0; i < unpooled.n_elem; i++)
+    BOOST_REQUIRE_CLOSE(unpooled[i], 1.0 / 6.0, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -52,4 +52,25 @@ BOOST_AUTO_TEST_CASE(Radical_Test_Radical3D)
   BOOST_REQUIRE_CLOSE(valBest, valEst, 0.25);
 }
 
+/**
+ * The estimated independent components should be the unmixing matrix applied
+ * to the data.
+ */
+BOOST_AUTO_TEST_CASE(RadicalUnmixingMatrix)
+{
+  mat matX;
+  data::Load("data_3d_mixed.txt", matX);
+
+  Radical rad(0.175, 5, 100, matX.n_rows - 1);
+  mat matY;
+  mat matW;
+  rad.DoRadical(matX, matY, matW);
+
+  const mat product = matW * matX;
+  BOOST_REQUIRE_EQUAL(product.n_rows, matY.n_rows);
+  BOOST_REQUIRE_EQUAL(product.n_cols, matY.n_cols);
+  for (uword i = 0; i < matY.n_elem; i++)
+    BOOST_REQUIRE_SMALL(product[i] - matY[i], 1e-8);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -7,6 +7,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/vantage_point_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -664,6 +665,60 @@ BOOST_AUTO_TEST_CASE(CoverTreeTest)
   }
 }
 
+/**
+ * Ensure that single-tree and dual-tree range search with vantage point trees
+ * give the same results as the kd-tree implementation.
+ */
+BOOST_AUTO_TEST_CASE(VantagePointTreeTest)
+{
+  arma::mat data;
+  data.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef tree::VantagePointTree<metric::EuclideanDistance, RangeSearchStat>
+      VPTreeType;
+  VPTreeType tree(data);
+
+  RangeSearch<> kdsearch(data);
+
+  const Range ranges[] = { Range(0.0, 0.75), Range(0.5, 1.5),
+      Range(0.8, DBL_MAX) };
+  for (size_t r = 0; r < 3; ++r)
+  {
+    vector<vector<size_t>> kdNeighbors;
+    vector<vector<double>> kdDistances;
+    kdsearch.Search(ranges[r], kdNeighbors, kdDistances);
+
+    vector<vector<pair<double, size_t>>> kdSorted;
+    SortResults(kdNeighbors, kdDistances, kdSorted);
+
+    for (size_t mode = 0; mode < 2; ++mode)
+    {
+      RangeSearch<metric::EuclideanDistance, VPTreeType> vpsearch(&tree,
+          (mode == 1));
+
+      vector<vector<size_t>> vpNeighbors;
+      vector<vector<double>> vpDistances;
+
+      CleanTree(tree);
+      vpsearch.Search(ranges[r], vpNeighbors, vpDistances);
+
+      vector<vector<pair<double, size_t>>> vpSorted;
+      SortResults(vpNeighbors, vpDistances, vpSorted);
+
+      for (size_t i = 0; i < kdSorted.size(); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(kdSorted[i].size(), vpSorted[i].size());
+        for (size_t j = 0; j < kdSorted[i].size(); ++j)
+        {
+          BOOST_REQUIRE_EQUAL(kdSorted[i][j].second, vpSorted[i][j].second);
+          BOOST_REQUIRE_CLOSE(kdSorted[i][j].first, vpSorted[i][j].first,
+              1e-5);
+        }
+      }
+    }
+  }
+}
+
 /**
  * Ensure that dual tree range search with cover trees works when using
  * two datasets.
@@ -1061,4 +1116,261 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest2)
   }
 }
 
+/**
+ * Make sure that the compressed (CSR) results and the counts are the same as
+ * the std::vector results, in naive, single-tree and dual-tree mode, with and
+ * without a query set.
+ */
+BOOST_AUTO_TEST_CASE(FlatResultsAndCountTest)
+{
+  arma::mat data;
+  data.randu(3, 300);
+  arma::mat queries;
+  queries.randu(3, 200);
+
+  const Range range(0.1, 0.4);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(data, mode == 0, mode == 1);
+
+    for (size_t withQueries = 0; withQueries < 2; ++withQueries)
+    {
+      vector<vector<size_t>> neighbors;
+      vector<vector<double>> distances;
+      arma::Col<size_t> offsets, flatNeighbors, counts;
+      arma::vec flatDistances;
+      if (withQueries == 1)
+      {
+        rs.Search(queries, range, neighbors, distances);
+        rs.Search(queries, range, offsets, flatNeighbors, flatDistances);
+        rs.Count(queries, range, counts);
+      }
+      else
+      {
+        rs.Search(range, neighbors, distances);
+        rs.Search(range, offsets, flatNeighbors, flatDistances);
+        rs.Count(range, counts);
+      }
+
+      BOOST_REQUIRE_EQUAL(offsets.n_elem, neighbors.size() + 1);
+      BOOST_REQUIRE_EQUAL(counts.n_elem, neighbors.size());
+      BOOST_REQUIRE_EQUAL(offsets[neighbors.size()], flatNeighbors.n_elem);
+      BOOST_REQUIRE_EQUAL(flatDistances.n_elem, flatNeighbors.n_elem);
+
+      vector<vector<pair<double, size_t>>> sorted;
+      SortResults(neighbors, distances, sorted);
+
+      // Convert the flat results to the std::vector format.
+      vector<vector<size_t>> unpackedNeighbors(neighbors.size());
+      vector<vector<double>> unpackedDistances(neighbors.size());
+      for (size_t i = 0; i < neighbors.size(); ++i)
+      {
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+        {
+          unpackedNeighbors[i].push_back(flatNeighbors[j]);
+          unpackedDistances[i].push_back(flatDistances[j]);
+        }
+      }
+      vector<vector<pair<double, size_t>>> sortedFlat;
+      SortResults(unpackedNeighbors, unpackedDistances, sortedFlat);
+
+      for (size_t i = 0; i < sorted.size(); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(counts[i], sorted[i].size());
+        BOOST_REQUIRE_EQUAL(sortedFlat[i].size(), sorted[i].size());
+        for (size_t j = 0; j < sorted[i].size(); ++j)
+        {
+          BOOST_REQUIRE_EQUAL(sortedFlat[i][j].second, sorted[i][j].second);
+          BOOST_REQUIRE_CLOSE(sortedFlat[i][j].first, sorted[i][j].first,
+              1e-5);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Compute, by brute force, the number of reference points within each radius of
+ * every query point.
+ */
+void BruteForceCounts(const arma::mat& references,
+                      const arma::mat& queries,
+                      const arma::vec& radii,
+                      const bool sameSet,
+                      arma::Mat<size_t>& counts)
+{
+  counts.zeros(radii.n_elem, queries.n_cols);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    for (size_t j = 0; j < references.n_cols; ++j)
+    {
+      if (sameSet && i == j)
+        continue;
+
+      const double distance = metric::EuclideanDistance::Evaluate(
+          queries.col(i), references.col(j));
+      for (size_t r = 0; r < radii.n_elem; ++r)
+        if (distance <= radii[r])
+          ++counts(r, i);
+    }
+  }
+}
+
+/**
+ * Make sure that counting the points within several radii at once gives the
+ * exact counts, in naive, single-tree and dual-tree mode, with and without a
+ * query set, and with kd-trees and cover trees.
+ */
+BOOST_AUTO_TEST_CASE(MultiRadiusCountTest)
+{
+  arma::mat data;
+  data.randu(3, 400);
+  arma::mat queries;
+  queries.randu(3, 250);
+
+  arma::vec radii("0.05 0.1 0.2 0.3 0.5 2.0");
+
+  arma::Mat<size_t> trueCounts, trueQueryCounts;
+  BruteForceCounts(data, data, radii, true, trueCounts);
+  BruteForceCounts(data, queries, radii, false, trueQueryCounts);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(data, mode == 0, mode == 1);
+
+    arma::Mat<size_t> counts;
+    rs.Count(radii, counts);
+    BOOST_REQUIRE_EQUAL(counts.n_rows, radii.n_elem);
+    BOOST_REQUIRE_EQUAL(counts.n_cols, data.n_cols);
+    BOOST_REQUIRE_EQUAL(arma::accu(counts != trueCounts), 0);
+
+    rs.Count(queries, radii, counts);
+    BOOST_REQUIRE_EQUAL(counts.n_rows, radii.n_elem);
+    BOOST_REQUIRE_EQUAL(counts.n_cols, queries.n_cols);
+    BOOST_REQUIRE_EQUAL(arma::accu(counts != trueQueryCounts), 0);
+
+    // The largest radius holds every pair of distinct points.
+    arma::Col<size_t> pairs;
+    rs.PairCounts(radii, pairs);
+    BOOST_REQUIRE_EQUAL(pairs.n_elem, radii.n_elem);
+    BOOST_REQUIRE_EQUAL(pairs[radii.n_elem - 1], 400 * 399 / 2);
+    for (size_t r = 0; r < radii.n_elem; ++r)
+      BOOST_REQUIRE_EQUAL(2 * pairs[r], arma::accu(trueCounts.row(r)));
+  }
+
+  // Now with a cover tree.
+  typedef CoverTree<metric::EuclideanDistance, FirstPointIsRoot,
+      RangeSearchStat> CoverTreeType;
+  CoverTreeType tree(data);
+  RangeSearch<metric::EuclideanDistance, CoverTreeType> coverRS(&tree);
+
+  arma::Mat<size_t> counts;
+  coverRS.Count(radii, counts);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts != trueCounts), 0);
+
+  coverRS.Count(queries, radii, counts);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts != trueQueryCounts), 0);
+}
+
+/**
+ * Make sure that parallel search gives the same results as serial search, in
+ * single-tree and dual-tree mode, with and without a query set, for every kind
+ * of output, and with kd-trees and cover trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSearchTest)
+{
+  arma::mat data;
+  data.randu(3, 3000);
+  arma::mat queries;
+  queries.randu(3, 2000);
+
+  const Range range(0.05, 0.15);
+  arma::vec radii("0.05 0.1 0.2");
+
+  typedef CoverTree<metric::EuclideanDistance, FirstPointIsRoot,
+      RangeSearchStat> CoverTreeType;
+  CoverTreeType tree(data);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    RangeSearch<> rs(data, false, mode == 1);
+    RangeSearch<metric::EuclideanDistance, CoverTreeType> coverRS(&tree,
+        mode == 1);
+    RangeSearch<> parallelRS(data, false, mode == 1);
+    parallelRS.Parallel() = true;
+    RangeSearch<metric::EuclideanDistance, CoverTreeType> parallelCoverRS(
+        &tree, mode == 1);
+    parallelCoverRS.Parallel() = true;
+
+    for (size_t withQueries = 0; withQueries < 2; ++withQueries)
+    {
+      vector<vector<size_t>> neighbors[4];
+      vector<vector<double>> distances[4];
+      arma::Col<size_t> offsets, flatNeighbors, counts;
+      arma::vec flatDistances;
+      arma::Mat<size_t> radiusCounts, parallelRadiusCounts;
+      if (withQueries == 1)
+      {
+        rs.Search(queries, range, neighbors[0], distances[0]);
+        parallelRS.Search(queries, range, neighbors[1], distances[1]);
+        coverRS.Search(queries, range, neighbors[2], distances[2]);
+        parallelCoverRS.Search(queries, range, neighbors[3], distances[3]);
+        parallelRS.Search(queries, range, offsets, flatNeighbors,
+            flatDistances);
+        parallelRS.Count(queries, range, counts);
+        rs.Count(queries, radii, radiusCounts);
+        parallelRS.Count(queries, radii, parallelRadiusCounts);
+      }
+      else
+      {
+        rs.Search(range, neighbors[0], distances[0]);
+        parallelRS.Search(range, neighbors[1], distances[1]);
+        coverRS.Search(range, neighbors[2], distances[2]);
+        parallelCoverRS.Search(range, neighbors[3], distances[3]);
+        parallelRS.Search(range, offsets, flatNeighbors, flatDistances);
+        parallelRS.Count(range, counts);
+        rs.Count(radii, radiusCounts);
+        parallelRS.Count(radii, parallelRadiusCounts);
+      }
+
+      vector<vector<pair<double, size_t>>> sorted[4];
+      for (size_t k = 0; k < 4; ++k)
+        SortResults(neighbors[k], distances[k], sorted[k]);
+
+      BOOST_REQUIRE_EQUAL(offsets.n_elem, sorted[0].size() + 1);
+      BOOST_REQUIRE_EQUAL(counts.n_elem, sorted[0].size());
+      BOOST_REQUIRE_EQUAL(arma::accu(radiusCounts != parallelRadiusCounts), 0);
+      for (size_t k = 1; k < 4; ++k)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[k].size(), sorted[0].size());
+        for (size_t i = 0; i < sorted[0].size(); ++i)
+        {
+          BOOST_REQUIRE_EQUAL(sorted[k][i].size(), sorted[0][i].size());
+          for (size_t j = 0; j < sorted[0][i].size(); ++j)
+          {
+            BOOST_REQUIRE_EQUAL(sorted[k][i][j].second, sorted[0][i][j].second);
+            BOOST_REQUIRE_CLOSE(sorted[k][i][j].first, sorted[0][i][j].first,
+                1e-5);
+          }
+        }
+      }
+
+      for (size_t i = 0; i < sorted[0].size(); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(counts[i], sorted[0][i].size());
+        BOOST_REQUIRE_EQUAL(offsets[i + 1] - offsets[i], sorted[0][i].size());
+
+        vector<size_t> flat(flatNeighbors.memptr() + offsets[i],
+            flatNeighbors.memptr() + offsets[i + 1]);
+        sort(flat.begin(), flat.end());
+        vector<size_t> serial(neighbors[0][i]);
+        sort(serial.begin(), serial.end());
+        for (size_t j = 0; j < flat.size(); ++j)
+          BOOST_REQUIRE_EQUAL(flat[j], serial[j]);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,8 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
+#include <stack>
+
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
 
@@ -416,6 +418,137 @@ BOOST_AUTO_TEST_CASE(TreeBalance)
   BOOST_REQUIRE_EQUAL(tree.TreeDepth(), GetMinLevel(tree));
 }
 
+/**
+ * Build an R* tree with the given bulk load policy and make sure that it is a
+ * valid, balanced tree that gives the same neighbors as a naive search.
+ */
+template<typename BulkLoadType>
+void CheckBulkLoad()
+{
+  arma::mat dataset;
+  dataset.randu(8, 1003); // 1003 points in 8 dimensions.
+
+  typedef RectangleTree<
+      RStarTreeSplit<RStarTreeDescentHeuristic,
+                     NeighborSearchStat<NearestNeighborSort>,
+                     arma::mat>,
+      RStarTreeDescentHeuristic,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, BulkLoadType(), 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1003);
+  CheckSync(tree);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckFills(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), GetMinLevel(tree));
+
+  // Every point is in the tree exactly once.
+  std::vector<bool> found(dataset.n_cols, false);
+  std::stack<const TreeType*> nodeStack;
+  nodeStack.push(&tree);
+  while (!nodeStack.empty())
+  {
+    const TreeType* node = nodeStack.top();
+    nodeStack.pop();
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      nodeStack.push(&node->Child(i));
+    for (size_t i = 0; i < node->Count(); ++i)
+    {
+      BOOST_REQUIRE(!found[node->Point(i)]);
+      found[node->Point(i)] = true;
+    }
+  }
+
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType>
+      allknn1(&tree, true);
+  allknn1.Search(5, neighbors1, distances1);
+
+  AllkNN allknn2(dataset, true, true);
+  allknn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+// Test the Sort-Tile-Recursive and the Hilbert packing bulk loads.
+BOOST_AUTO_TEST_CASE(BulkLoadTest)
+{
+  CheckBulkLoad<STRBulkLoad>();
+  CheckBulkLoad<HilbertBulkLoad>();
+}
+
+// Make sure that a snapshot of a RectangleTreeSnapshots index does not change
+// while the writer inserts and deletes points, and that the published changes
+// are seen by new snapshots.
+BOOST_AUTO_TEST_CASE(RectangleTreeSnapshotsTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef RectangleTree<
+      RStarTreeSplit<RStarTreeDescentHeuristic,
+                     NeighborSearchStat<NearestNeighborSort>,
+                     arma::mat>,
+      RStarTreeDescentHeuristic,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  typedef RectangleTreeSnapshots<TreeType> SnapshotsType;
+
+  SnapshotsType snapshots(dataset, 20, 6, 5, 2);
+  boost::shared_ptr<SnapshotsType::SnapshotType> first = snapshots.Snapshot();
+
+  // Change the writer's tree without publishing it.
+  for (size_t i = 0; i < 200; ++i)
+    snapshots.InsertPoint(arma::randu<arma::vec>(8) + 1.0);
+  for (size_t i = 0; i < 50; ++i)
+    BOOST_REQUIRE(snapshots.DeletePoint(2 * i));
+
+  BOOST_REQUIRE_EQUAL(snapshots.Tree().NumDescendants(), 1150);
+  BOOST_REQUIRE_EQUAL(snapshots.Snapshot()->Tree().NumDescendants(), 1000);
+
+  // The first snapshot still gives the neighbors in the original dataset.
+  arma::mat queries = arma::randu<arma::mat>(8, 100);
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType>
+      allknn1(&first->Tree());
+  allknn1.Search(queries, 5, neighbors1, distances1);
+
+  AllkNN allknn2(dataset, true, true);
+  allknn2.Search(queries, 5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+
+  // After publishing, new snapshots see the changes, and the old one is kept.
+  snapshots.Publish();
+  boost::shared_ptr<SnapshotsType::SnapshotType> second = snapshots.Snapshot();
+
+  BOOST_REQUIRE_EQUAL(second->Tree().NumDescendants(), 1150);
+  BOOST_REQUIRE_EQUAL(second->Dataset().n_cols, 1200);
+  BOOST_REQUIRE_EQUAL(first->Tree().NumDescendants(), 1000);
+  BOOST_REQUIRE_EQUAL(&second->Tree().Dataset(), &second->Dataset());
+
+  CheckSync(second->Tree());
+  CheckContainment(second->Tree());
+  CheckHierarchy(second->Tree());
+}
+
 // A test to see if point deletion is working correctly.  We build a tree, then
 // delete numIter points and test that the query gives correct results.  It is
 // remotely possible that this test will give a false negative if it should
@@ -624,6 +757,40 @@ BOOST_AUTO_TEST_CASE(SingleTreeTraverserTest)
 }
 
 
+// Test the task-parallel dual-tree traverser against a naive search, with
+// enough points that the query tree is split into several tasks.
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraverserTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 4000);
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+
+  typedef RectangleTree<
+      RStarTreeSplit<RStarTreeDescentHeuristic,
+                     NeighborSearchStat<NearestNeighborSort>,
+                     arma::mat>,
+      RStarTreeDescentHeuristic,
+      NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType rTree(dataset, 20, 6, 5, 2, 0);
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, TreeType,
+      TreeType::ParallelDualTreeTraverser> allknn1(&rTree);
+  allknn1.Search(5, neighbors1, distances1);
+
+  AllkNN allknn2(dataset, true, true);
+  allknn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
 // A test to ensure that the SingleTreeTraverser is working correctly by
 // comparing its results to the results of a naive search.
 /** This is known to not work: see #368.
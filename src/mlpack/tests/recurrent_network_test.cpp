@@ -165,6 +165,116 @@ BOOST_AUTO_TEST_CASE(SequenceClassificationTest)
   }
 }
 
+/**
+ * Train the vanilla network of SequenceClassificationTest with the given
+ * truncation window on the given data, and store the predicted classes.
+ */
+void TrainTruncatedNetwork(const arma::mat& input,
+                           const arma::mat& labels,
+                           const size_t bpttWindow,
+                           arma::mat& predictions,
+                           double& error)
+{
+  NeuronLayer<LogisticFunction> inputLayer(1);
+  NeuronLayer<LogisticFunction> hiddenLayer0(4);
+  NeuronLayer<LogisticFunction> recurrentLayer0(hiddenLayer0.InputSize());
+  NeuronLayer<LogisticFunction> hiddenLayer1(2);
+  BinaryClassificationLayer outputLayer;
+
+  SteepestDescent< > conOptimizer0(inputLayer.InputSize(),
+      hiddenLayer0.InputSize(), 1, 0);
+  SteepestDescent< > conOptimizer2(hiddenLayer0.InputSize(),
+      hiddenLayer0.InputSize(), 1, 0);
+  SteepestDescent< > conOptimizer3(hiddenLayer0.InputSize(),
+      hiddenLayer1.OutputSize(), 1, 0);
+
+  RandomInitialization randInit(-0.5, 0.5);
+
+  FullConnection<
+      decltype(inputLayer),
+      decltype(hiddenLayer0),
+      decltype(conOptimizer0),
+      decltype(randInit)>
+      layerCon0(inputLayer, hiddenLayer0, conOptimizer0, randInit);
+
+  SelfConnection<
+    decltype(recurrentLayer0),
+    decltype(hiddenLayer0),
+    decltype(conOptimizer2),
+    decltype(randInit)>
+    layerCon2(recurrentLayer0, hiddenLayer0, conOptimizer2, randInit);
+
+  FullConnection<
+      decltype(hiddenLayer0),
+      decltype(hiddenLayer1),
+      decltype(conOptimizer3),
+      decltype(randInit)>
+      layerCon4(hiddenLayer0, hiddenLayer1, conOptimizer3, randInit);
+
+  auto module0 = std::tie(layerCon0, layerCon2);
+  auto module1 = std::tie(layerCon4);
+  auto modules = std::tie(module0, module1);
+
+  RNN<decltype(modules),
+      decltype(outputLayer),
+      MeanSquaredErrorFunction> net(modules, outputLayer, bpttWindow);
+  BOOST_REQUIRE_EQUAL(net.BPTTWindow(), bpttWindow);
+
+  Trainer<decltype(net)> trainer(net, 1000);
+  trainer.Train(input, labels, input, labels);
+  error = trainer.ValidationError();
+
+  predictions.set_size(labels.n_rows, labels.n_cols);
+  arma::colvec output;
+  for (size_t i = 0; i < input.n_cols; i++)
+  {
+    net.Predict(input.unsafe_col(i), output);
+    predictions.col(i) = output;
+  }
+}
+
+/**
+ * A truncation window at least as long as the sequence must give the same
+ * result as full backpropagation through time.
+ */
+BOOST_AUTO_TEST_CASE(FullWindowTruncatedBPTTTest)
+{
+  arma::mat input, labels;
+  GenerateNoisySines(input, labels, 10, 6);
+
+  arma::mat fullPredictions, windowPredictions;
+  double fullError, windowError;
+
+  math::RandomSeed(7);
+  TrainTruncatedNetwork(input, labels, 0, fullPredictions, fullError);
+  math::RandomSeed(7);
+  TrainTruncatedNetwork(input, labels, 10, windowPredictions, windowError);
+
+  BOOST_REQUIRE_CLOSE(fullError, windowError, 1e-5);
+  for (size_t i = 0; i < fullPredictions.n_elem; i++)
+    BOOST_REQUIRE_EQUAL(fullPredictions[i], windowPredictions[i]);
+}
+
+/**
+ * Train the vanilla network with a truncation window that is shorter than the
+ * sequence, and make sure it can still classify the sequences.
+ */
+BOOST_AUTO_TEST_CASE(TruncatedBPTTTest)
+{
+  arma::mat input, labels;
+  GenerateNoisySines(input, labels, 10, 6);
+
+  arma::mat predictions;
+  double error;
+  TrainTruncatedNetwork(input, labels, 5, predictions, error);
+
+  for (size_t i = 0; i < input.n_cols; i++)
+  {
+    bool b = arma::all((predictions.col(i) == labels.unsafe_col(i)) == 1);
+    BOOST_REQUIRE_EQUAL(b, 1);
+  }
+}
+
 /**
  * Train and evaluate a vanilla feed forward network and a recurrent network
  * with the specified structure and compare the two networks output and overall
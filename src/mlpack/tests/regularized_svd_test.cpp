@@ -6,6 +6,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -189,6 +190,72 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionGradient)
   }
 }
 
+/**
+ * Make sure that the batch Evaluate() and Gradient() overloads agree with the
+ * full objective and gradient when the batch spans the whole dataset, and that
+ * batches of the dataset sum to the full objective and gradient.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionBatchEvaluateGradient)
+{
+  // Define useful constants.
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t maxRating = 5;
+  const size_t rank = 10;
+
+  // Make a random rating dataset.
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data.row(2) = floor(data.row(2) * maxRating + 0.5);
+
+  // Manually set last row to maximum user and maximum item.
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  RegularizedSVDFunction rSVDFunc(data, rank, 0.5);
+
+  arma::mat gradient, batchGradient;
+  rSVDFunc.Gradient(parameters, gradient);
+  rSVDFunc.Gradient(parameters, 0, numRatings, batchGradient);
+
+  BOOST_REQUIRE_CLOSE(rSVDFunc.Evaluate(parameters, 0, numRatings),
+      rSVDFunc.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_EQUAL(batchGradient.n_rows, gradient.n_rows);
+  BOOST_REQUIRE_EQUAL(batchGradient.n_cols, gradient.n_cols);
+  for (size_t i = 0; i < gradient.n_elem; i++)
+  {
+    if (std::abs(gradient[i]) <= 1e-8)
+      BOOST_REQUIRE_SMALL(batchGradient[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(batchGradient[i], gradient[i], 1e-5);
+  }
+
+  // Now split the dataset into uneven batches.
+  double cost = 0.0;
+  arma::mat summedGradient(rank, numUsers + numItems);
+  summedGradient.zeros();
+  for (size_t begin = 0; begin < numRatings; begin += 30)
+  {
+    const size_t batchSize = std::min((size_t) 30, numRatings - begin);
+    cost += rSVDFunc.Evaluate(parameters, begin, batchSize);
+    rSVDFunc.Gradient(parameters, begin, batchSize, batchGradient);
+    summedGradient += batchGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(cost, rSVDFunc.Evaluate(parameters), 1e-5);
+  for (size_t i = 0; i < gradient.n_elem; i++)
+  {
+    if (std::abs(gradient[i]) <= 1e-8)
+      BOOST_REQUIRE_SMALL(summedGradient[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(summedGradient[i], gradient[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimize)
 {
   // Define useful constants.
@@ -244,4 +311,95 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimize)
   BOOST_REQUIRE_SMALL(relativeError, 1e-2);
 }
 
+/**
+ * Give L-BFGS only the full objective of a RegularizedSVDFunction and one way
+ * of computing its full gradient: the grouped Gradient(), which is parallel
+ * with OpenMP, or the serial batch Gradient() over all the ratings.
+ */
+class FullGradientFunction
+{
+ public:
+  FullGradientFunction(const RegularizedSVDFunction& function,
+                       const bool grouped) :
+      function(function), grouped(grouped) { }
+
+  double Evaluate(const arma::mat& parameters) const
+  { return function.Evaluate(parameters); }
+
+  void Gradient(const arma::mat& parameters, arma::mat& gradient) const
+  {
+    if (grouped)
+      function.Gradient(parameters, gradient);
+    else
+      function.Gradient(parameters, 0, function.NumFunctions(), gradient);
+  }
+
+  const arma::mat& GetInitialPoint() const
+  { return function.GetInitialPoint(); }
+
+ private:
+  const RegularizedSVDFunction& function;
+  bool grouped;
+};
+
+/**
+ * Optimizing with the grouped (parallel) gradient must reach the same RMSE as
+ * optimizing with the serial gradient, on the data of the test above.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionParallelGradientOptimize)
+{
+  // Define useful constants.
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t rank = 10;
+  const double lambda = 0.01;
+
+  // Initiate random parameters.
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  // Make a random rating dataset.
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+
+  // Manually set last row to maximum user and maximum item.
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  // Make rating entries based on the parameters.
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    data(2, i) = arma::dot(parameters.col(data(0, i)),
+                           parameters.col(numUsers + data(1, i)));
+  }
+
+  RegularizedSVDFunction rSVDFunc(data, rank, lambda);
+  const arma::mat initialPoint = arma::randu(rank, numUsers + numItems);
+
+  double rmse[2];
+  for (size_t grouped = 0; grouped < 2; grouped++)
+  {
+    FullGradientFunction function(rSVDFunc, (grouped == 1));
+    mlpack::optimization::L_BFGS<FullGradientFunction> lbfgs(function, 10,
+        1000);
+
+    arma::mat optParameters(initialPoint);
+    lbfgs.Optimize(optParameters);
+
+    double squaredError = 0.0;
+    for (size_t i = 0; i < numRatings; i++)
+    {
+      const double error = data(2, i) - arma::dot(
+          optParameters.col(data(0, i)),
+          optParameters.col(numUsers + data(1, i)));
+      squaredError += error * error;
+    }
+    rmse[grouped] = std::sqrt(squaredError / numRatings);
+  }
+
+  BOOST_REQUIRE_SMALL(rmse[1] - rmse[0], 1e-3);
+  BOOST_REQUIRE_SMALL(rmse[1], 0.25);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
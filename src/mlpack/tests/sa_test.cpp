@@ -124,4 +124,92 @@ BOOST_AUTO_TEST_CASE(RastrigrinFunctionTest)
   BOOST_REQUIRE_GE(successes, 1);
 }
 
+/**
+ * The Rastrigrin function, again, but with an incremental EvaluateMove() that
+ * updates the objective for a change of one coordinate in O(1).  It counts the
+ * calls to Evaluate() and EvaluateMove().
+ */
+class IncrementalRastrigrinFunction
+{
+ public:
+  IncrementalRastrigrinFunction() : evaluations(0), moves(0) { }
+
+  double Evaluate(const arma::mat& coordinates) const
+  {
+    ++evaluations;
+    return 20 + Term(coordinates[0]) + Term(coordinates[1]);
+  }
+
+  double EvaluateMove(const arma::mat& coordinates,
+                      const size_t index,
+                      const double oldValue,
+                      const double oldObjective) const
+  {
+    ++moves;
+    return oldObjective - Term(oldValue) + Term(coordinates[index]);
+  }
+
+  arma::mat GetInitialPoint() const
+  {
+    return arma::mat("-3 -3");
+  }
+
+  mutable size_t evaluations;
+  mutable size_t moves;
+
+ private:
+  static double Term(const double x)
+  {
+    return std::pow(x, 2.0) - 10 * std::cos(2 * M_PI * x);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(IncrementalEvaluationTest)
+{
+  IncrementalRastrigrinFunction f;
+  ExponentialSchedule schedule(1e-3);
+  SA<IncrementalRastrigrinFunction>
+      sa(f, schedule, 100000, 100, 50, 1000, 1e-12, 2, 0.2, 0.01, 0.1);
+  arma::mat coordinates = f.GetInitialPoint();
+
+  const double result = sa.Optimize(coordinates);
+
+  // Only the initial point is evaluated from scratch.
+  BOOST_REQUIRE_EQUAL(f.evaluations, 1);
+  BOOST_REQUIRE_GT(f.moves, 0);
+
+  // The incrementally updated objective must be the objective of the result.
+  BOOST_REQUIRE_SMALL(result - f.Evaluate(coordinates), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelTemperingRastrigrinTest)
+{
+  // With four chains, the hot ones escape the local minima and pass their
+  // states down to the cold ones, so this should work at least as often as
+  // plain simulated annealing.
+  size_t successes = 0;
+
+  for (size_t trial = 0; trial < 5; ++trial)
+  {
+    RastrigrinFunction f;
+    ExponentialSchedule schedule(3e-6);
+    SA<RastrigrinFunction>
+        sa(f, schedule, 20000000, 100, 50, 1000, 1e-12, 2, 0.2, 0.01, 0.1);
+    sa.Chains() = 4;
+    sa.ExchangeSweeps() = 10;
+    BOOST_REQUIRE_EQUAL(sa.Chains(), 4);
+    arma::mat coordinates = f.GetInitialPoint();
+
+    const double result = sa.Optimize(coordinates);
+
+    BOOST_REQUIRE_SMALL(result - f.Evaluate(coordinates), 1e-8);
+    if ((std::abs(result) < 1e-3) &&
+        (std::abs(coordinates[0]) < 1e-3) &&
+        (std::abs(coordinates[1]) < 1e-3))
+      ++successes;
+  }
+
+  BOOST_REQUIRE_GE(successes, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
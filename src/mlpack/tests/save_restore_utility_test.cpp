@@ -145,6 +145,66 @@ BOOST_AUTO_TEST_CASE(SaveArmaMat)
       BOOST_REQUIRE_CLOSE(matrix(row, column), matrix2(row, column), 1e-5);
 }
 
+/**
+ * Test the binary format: matrices are restored exactly, with or without
+ * mapping the file, and a model read from a binary file can be written as XML.
+ */
+BOOST_AUTO_TEST_CASE(SaveArmaMatBinary)
+{
+  arma::mat matrix = arma::randu<arma::mat>(30, 40);
+  arma::Mat<size_t> indices = arma::randi<arma::Mat<size_t> >(5, 7,
+      arma::distr_param(0, 1000));
+  double number = 1.0 / 3.0;
+
+  SaveRestoreUtility sr, child;
+  sr.SaveParameter(matrix, "matrix");
+  sr.SaveParameter(number, "number");
+  child.SaveParameter(indices, "indices");
+  sr.AddChild(child, "child");
+
+  BOOST_REQUIRE(sr.WriteFile("test_binary.bin"));
+
+  for (size_t mapped = 0; mapped < 2; ++mapped)
+  {
+    SaveRestoreUtility loader;
+    BOOST_REQUIRE(loader.ReadFile("test_binary.bin", (mapped == 1)));
+
+    arma::mat matrix2;
+    loader.LoadParameter(matrix2, "matrix");
+    BOOST_REQUIRE_EQUAL(matrix2.n_rows, matrix.n_rows);
+    BOOST_REQUIRE_EQUAL(matrix2.n_cols, matrix.n_cols);
+    for (size_t i = 0; i < matrix.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(matrix2[i], matrix[i]);
+
+    arma::Mat<size_t> indices2;
+    loader.Children()["child"].LoadParameter(indices2, "indices");
+    BOOST_REQUIRE_EQUAL(indices2.n_elem, indices.n_elem);
+    for (size_t i = 0; i < indices.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(indices2[i], indices[i]);
+
+    // A matrix of another element type is converted.
+    arma::fmat floatMatrix;
+    loader.LoadParameter(floatMatrix, "matrix");
+    for (size_t i = 0; i < matrix.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(floatMatrix[i], (float) matrix[i], 1e-5);
+
+    // Convert to XML.
+    BOOST_REQUIRE(loader.WriteFile("test_binary.xml"));
+  }
+
+  SaveRestoreUtility xmlLoader;
+  BOOST_REQUIRE(xmlLoader.ReadFile("test_binary.xml"));
+  arma::mat matrix3;
+  xmlLoader.LoadParameter(matrix3, "matrix");
+  for (size_t i = 0; i < matrix.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(matrix3[i], matrix[i], 1e-5);
+  BOOST_REQUIRE_CLOSE(xmlLoader.LoadParameter(number, "number"), 1.0 / 3.0,
+      1e-10);
+
+  remove("test_binary.bin");
+  remove("test_binary.xml");
+}
+
 /**
  * Test SaveRestoreModel proper usage in child classes and loading from
  *   separately defined objects
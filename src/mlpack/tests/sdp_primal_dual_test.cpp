@@ -269,6 +269,40 @@ BOOST_AUTO_TEST_CASE(SmallMaxCutSdp)
   SolveMaxCutPositiveSDP(sdp);
 }
 
+/**
+ * The Schur complement has sparse and dense blocks when the SDP has both kinds
+ * of constraints.  Give half of the diagonal constraints of a max-cut SDP as
+ * dense matrices, and make sure the optimum is the one found when they are all
+ * sparse.
+ */
+BOOST_AUTO_TEST_CASE(MixedConstraintsMaxCutSdp)
+{
+  UndirectedGraph g;
+  UndirectedGraph::ErdosRenyiRandomGraph(g, 20, 0.3, true);
+  const SDP<arma::sp_mat> sparseSdp = ConstructMaxCutSDPFromGraph(g);
+
+  const size_t n = g.NumVertices();
+  const size_t numDense = n / 2;
+  SDP<arma::sp_mat> mixedSdp(n, n - numDense, numDense);
+  mixedSdp.C() = sparseSdp.C();
+  for (size_t i = 0; i < n - numDense; i++)
+    mixedSdp.SparseA()[i] = sparseSdp.SparseA()[i];
+  for (size_t i = 0; i < numDense; i++)
+    mixedSdp.DenseA()[i] = arma::mat(sparseSdp.SparseA()[n - numDense + i]);
+  mixedSdp.SparseB().ones();
+  mixedSdp.DenseB().ones();
+
+  PrimalDualSolver<SDP<arma::sp_mat>> sparseSolver(sparseSdp);
+  PrimalDualSolver<SDP<arma::sp_mat>> mixedSolver(mixedSdp);
+
+  arma::mat X, Z;
+  arma::vec ysparse, ydense;
+  const double sparseObj = sparseSolver.Optimize(X);
+  const double mixedObj = mixedSolver.Optimize(X, ysparse, ydense, Z);
+  CheckKKT(mixedSdp, X, ysparse, ydense, Z);
+  BOOST_REQUIRE_CLOSE(mixedObj, sparseObj, 1e-4);
+}
+
 BOOST_AUTO_TEST_CASE(SmallLovaszThetaSdp)
 {
   UndirectedGraph g;
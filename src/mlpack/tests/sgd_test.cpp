@@ -58,4 +58,146 @@ BOOST_AUTO_TEST_CASE(GeneralizedRosenbrockTest)
   }
 }
 
+/**
+ * Make sure the batch Evaluate() and Gradient() overloads of the generalized
+ * Rosenbrock function sum the individual functions in the batch.
+ */
+BOOST_AUTO_TEST_CASE(GeneralizedRosenbrockBatchTest)
+{
+  GeneralizedRosenbrockFunction f(20);
+  arma::mat coordinates(20, 1);
+  coordinates.randu();
+
+  for (size_t begin = 0; begin < f.NumFunctions(); begin += 4)
+  {
+    const size_t batchSize = std::min((size_t) 7, f.NumFunctions() - begin);
+
+    double objective = 0.0;
+    arma::mat gradient(20, 1);
+    gradient.zeros();
+    arma::mat functionGradient;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+    {
+      objective += f.Evaluate(coordinates, i);
+      f.Gradient(coordinates, i, functionGradient);
+      gradient += functionGradient;
+    }
+
+    arma::mat batchGradient;
+    f.Gradient(coordinates, begin, batchSize, batchGradient);
+
+    BOOST_REQUIRE_CLOSE(f.Evaluate(coordinates, begin, batchSize), objective,
+        1e-5);
+    for (size_t j = 0; j < gradient.n_elem; ++j)
+    {
+      if (std::abs(gradient[j]) <= 1e-10)
+        BOOST_REQUIRE_SMALL(batchGradient[j], 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(batchGradient[j], gradient[j], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure SGD converges when contiguous blocks of functions are shuffled.
+ */
+BOOST_AUTO_TEST_CASE(BlockShuffleSGDTestFunction)
+{
+  SGDTestFunction f;
+  SGD<SGDTestFunction> s(f, 0.0003, 5000000, 1e-9, true, 2);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(result, -1.0, 0.05);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-3);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-7);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-7);
+}
+
+/**
+ * A least-squares function over a dataset that it can permute, to test the
+ * data shuffling of SGD.
+ */
+class ShuffledLeastSquaresFunction
+{
+ public:
+  ShuffledLeastSquaresFunction(const arma::mat& predictors,
+                               const arma::rowvec& responses) :
+      predictors(predictors),
+      responses(responses),
+      shuffles(0)
+  { }
+
+  size_t NumFunctions() const { return predictors.n_cols; }
+
+  double Evaluate(const arma::mat& coordinates, const size_t i) const
+  {
+    const double error = arma::dot(predictors.col(i), coordinates) -
+        responses[i];
+    return error * error;
+  }
+
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient) const
+  {
+    gradient = 2.0 * (arma::dot(predictors.col(i), coordinates) -
+        responses[i]) * predictors.col(i);
+  }
+
+  void PrepareShuffle()
+  {
+    const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+        predictors.n_cols - 1, predictors.n_cols));
+    nextPredictors = predictors.cols(order);
+    nextResponses = responses.cols(order);
+  }
+
+  void Shuffle()
+  {
+    predictors.swap(nextPredictors);
+    responses.swap(nextResponses);
+    ++shuffles;
+  }
+
+  const arma::mat& Predictors() const { return predictors; }
+  const arma::rowvec& Responses() const { return responses; }
+  size_t Shuffles() const { return shuffles; }
+
+ private:
+  arma::mat predictors;
+  arma::rowvec responses;
+  arma::mat nextPredictors;
+  arma::rowvec nextResponses;
+  size_t shuffles;
+};
+
+/**
+ * Make sure SGD converges when the data of the function is permuted every
+ * epoch, and that the data is only permuted, not changed.
+ */
+BOOST_AUTO_TEST_CASE(ShuffleDataSGDTest)
+{
+  const arma::mat predictors = arma::randu<arma::mat>(3, 500);
+  const arma::vec truth("1.0 2.0 3.0");
+  const arma::rowvec responses = truth.t() * predictors;
+
+  ShuffledLeastSquaresFunction f(predictors, responses);
+  SGD<ShuffledLeastSquaresFunction> s(f, 0.01, 0, 1e-12, true, 0, true);
+
+  arma::mat coordinates(3, 1, arma::fill::zeros);
+  const double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_SMALL(result, 1e-5);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_CLOSE(coordinates[i], truth[i], 1e-2);
+  BOOST_REQUIRE_GT(f.Shuffles(), 1);
+
+  // The responses are still the responses of their predictors.
+  BOOST_REQUIRE_SMALL(arma::abs(truth.t() * f.Predictors() -
+      f.Responses()).max(), 1e-10);
+  BOOST_REQUIRE_CLOSE(arma::accu(f.Responses()), arma::accu(responses), 1e-8);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
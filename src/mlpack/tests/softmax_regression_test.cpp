@@ -6,6 +6,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -13,6 +14,7 @@
 using namespace mlpack;
 using namespace mlpack::regression;
 using namespace mlpack::distribution;
+using namespace mlpack::optimization;
 
 BOOST_AUTO_TEST_SUITE(SoftmaxRegressionTest);
 
@@ -166,6 +168,70 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
   }
 }
 
+/**
+ * The objective of a dataset of several blocks (which may be evaluated by
+ * different threads) must be the sum over its points, and the single-function
+ * and fused forms must agree with Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionBlocksEvaluateGradient)
+{
+  const size_t points = 3000;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  // Initialize a random dataset.
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  // Create random class labels.
+  arma::vec labels(points);
+  for(size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  for (size_t intercept = 0; intercept < 2; intercept++)
+  {
+    SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 0.5,
+        (intercept == 1));
+
+    arma::mat parameters = srf.GetInitialPoint();
+    parameters.randu();
+
+    // Compute the objective point by point.
+    double logLikelihood = 0.0;
+    for (size_t i = 0; i < points; i++)
+    {
+      arma::vec scores;
+      if (intercept == 1)
+        scores = parameters.cols(1, inputSize) * data.col(i) +
+            parameters.col(0);
+      else
+        scores = parameters * data.col(i);
+
+      logLikelihood += scores((size_t) labels(i)) -
+          std::log(arma::accu(arma::exp(scores)));
+    }
+    const double cost = -logLikelihood / points +
+        0.25 * arma::accu(parameters % parameters);
+
+    BOOST_REQUIRE_EQUAL(srf.NumFunctions(), (size_t) 1);
+    BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters), cost, 1e-5);
+    BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters, 0), cost, 1e-5);
+
+    arma::mat gradient, functionGradient;
+    srf.Gradient(parameters, gradient);
+    srf.Gradient(parameters, 0, functionGradient);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(functionGradient[i], gradient[i], 1e-5);
+
+    // The fused form must agree with the separate ones.
+    arma::mat fusedGradient;
+    BOOST_REQUIRE_CLOSE(srf.EvaluateWithGradient(parameters, fusedGradient),
+        cost, 1e-5);
+    for (size_t i = 0; i < gradient.n_elem; i++)
+      BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTwoClasses)
 {
   const size_t points = 1000;
@@ -342,4 +408,87 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionMultipleClasses)
   BOOST_REQUIRE_CLOSE(testAcc, 100.0, 2.0);
 }
 
+/**
+ * Adding the same vector to the parameters of every class doesn't change the
+ * probabilities, so it shouldn't change the objective or the gradient either,
+ * even when the scores are far too large to exponentiate.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionLargeScores)
+{
+  const size_t points = 200;
+  const size_t inputSize = 10;
+  const size_t numClasses = 5;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 0);
+
+  arma::mat parameters;
+  parameters.randu(numClasses, inputSize);
+  // The scores of the shifted parameters are about 5000 for every class.
+  arma::mat shiftedParameters = parameters;
+  shiftedParameters.each_row() += 1000.0 * arma::ones<arma::rowvec>(inputSize);
+
+  const double objective = srf.Evaluate(parameters);
+  const double shiftedObjective = srf.Evaluate(shiftedParameters);
+  BOOST_REQUIRE(arma::is_finite(shiftedObjective));
+  BOOST_REQUIRE_CLOSE(shiftedObjective, objective, 1e-5);
+
+  arma::mat gradient, shiftedGradient;
+  srf.Gradient(parameters, gradient);
+  const double shiftedValue = srf.EvaluateWithGradient(shiftedParameters,
+      shiftedGradient);
+  BOOST_REQUIRE_CLOSE(shiftedValue, objective, 1e-5);
+  for (size_t i = 0; i < gradient.n_elem; i++)
+    BOOST_REQUIRE_SMALL(shiftedGradient[i] - gradient[i], 1e-8);
+
+  // The kernels themselves.
+  const double scores[3] = { 1000.0, 1001.0, -1000.0 };
+  BOOST_REQUIRE_CLOSE(SoftmaxRegressionFunction::LogSumExp(scores, 3),
+      1001.0 + std::log(1.0 + std::exp(-1.0)), 1e-10);
+
+  double probabilities[3] = { 1000.0, 1001.0, -1000.0 };
+  SoftmaxRegressionFunction::Softmax(probabilities, 3);
+  BOOST_REQUIRE_CLOSE(probabilities[0], 1.0 / (1.0 + std::exp(1.0)), 1e-10);
+  BOOST_REQUIRE_CLOSE(probabilities[1], 1.0 / (1.0 + std::exp(-1.0)), 1e-10);
+  BOOST_REQUIRE_SMALL(probabilities[2], 1e-300);
+}
+
+/**
+ * Train softmax regression with mini-batch SGD on three Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionMiniBatchSGD)
+{
+  const size_t points = 3000;
+  const size_t inputSize = 3;
+  const size_t numClasses = 3;
+
+  GaussianDistribution g1(arma::vec("1.0 9.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("4.0 3.0 4.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g3(arma::vec("8.0 1.0 8.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(inputSize, points);
+  arma::vec labels(points);
+  for (size_t i = 0; i < points; i++)
+  {
+    labels(i) = i % 3;
+    data.col(i) = (i % 3 == 0) ? g1.Random() : ((i % 3 == 1) ? g2.Random() :
+        g3.Random());
+  }
+
+  // The objective is a single function, so every step is a full gradient
+  // step.
+  SoftmaxRegressionFunction srf(data, labels, inputSize, numClasses, 0.0001,
+      true);
+  MiniBatchSGD<SoftmaxRegressionFunction> sgd(srf, 32, 0.02, 20000, 1e-10);
+  SoftmaxRegression<MiniBatchSGD> sr(sgd);
+
+  const double acc = sr.ComputeAccuracy(data, labels);
+  BOOST_REQUIRE_GT(acc, 97.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
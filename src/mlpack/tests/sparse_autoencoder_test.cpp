@@ -263,4 +263,111 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * EvaluateWithGradient() must agree with separate calls to Evaluate() and
+ * Gradient().
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionEvaluateWithGradient)
+{
+  const size_t points = 1000;
+  const size_t vSize = 20;
+  const size_t hSize = 10;
+
+  // Initialize a random dataset.
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 20, 20);
+  const arma::mat parameters = saf.GetInitialPoint();
+
+  arma::mat gradient, fusedGradient;
+  saf.Gradient(parameters, gradient);
+  const double objective = saf.EvaluateWithGradient(parameters, fusedGradient);
+
+  BOOST_REQUIRE_CLOSE(objective, saf.Evaluate(parameters), 1e-5);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_rows, gradient.n_rows);
+  BOOST_REQUIRE_EQUAL(fusedGradient.n_cols, gradient.n_cols);
+  for (size_t i = 0; i < gradient.n_elem; i++)
+  {
+    if (std::abs(gradient[i]) <= 1e-10)
+      BOOST_REQUIRE_SMALL(fusedGradient[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(fusedGradient[i], gradient[i], 1e-5);
+  }
+}
+
+/**
+ * The blocked, parallel objective must match the objective and gradient
+ * computed directly on the whole dataset, when the number of points isn't a
+ * multiple of the block size.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionBlockedObjective)
+{
+  const size_t points = 1037;
+  const size_t vSize = 12;
+  const size_t hSize = 7;
+  const size_t l1 = hSize;
+  const size_t l2 = vSize;
+  const size_t l3 = 2 * hSize;
+  const double lambda = 0.01;
+  const double beta = 3;
+  const double rho = 0.05;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, lambda, beta, rho);
+  const arma::mat parameters = saf.GetInitialPoint();
+
+  // Compute everything directly on the whole dataset.
+  const arma::mat w1 = parameters.submat(0, 0, l1 - 1, l2 - 1);
+  const arma::mat w2 = arma::trans(parameters.submat(l1, 0, l3 - 1, l2 - 1));
+  const arma::vec b1 = parameters.submat(0, l2, l1 - 1, l2);
+  const arma::vec b2 = arma::trans(parameters.submat(l3, 0, l3, l2 - 1));
+
+  arma::mat hidden = w1 * data;
+  hidden.each_col() += b1;
+  hidden = 1.0 / (1.0 + arma::exp(-hidden));
+  arma::mat output = w2 * hidden;
+  output.each_col() += b2;
+  output = 1.0 / (1.0 + arma::exp(-output));
+
+  const arma::mat diff = output - data;
+  const arma::vec rhoCap = arma::sum(hidden, 1) / points;
+  const double objective = 0.5 * arma::accu(diff % diff) / points +
+      0.5 * lambda * (arma::accu(w1 % w1) + arma::accu(w2 % w2)) +
+      beta * arma::accu(rho * arma::log(rho / rhoCap) + (1 - rho) *
+      arma::log((1 - rho) / (1 - rhoCap)));
+
+  const arma::vec klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) /
+      (1 - rhoCap));
+  const arma::mat delOut = diff % output % (1 - output);
+  arma::mat delHid = w2.t() * delOut;
+  delHid.each_col() += klDivGrad;
+  delHid %= hidden % (1 - hidden);
+
+  arma::mat expected(l3 + 1, l2 + 1);
+  expected.zeros();
+  expected.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.t() / points +
+      lambda * w1;
+  expected.submat(l1, 0, l3 - 1, l2 - 1) = hidden * delOut.t() / points +
+      lambda * w2.t();
+  expected.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / points;
+  expected.submat(l3, 0, l3, l2 - 1) = arma::sum(delOut, 1).t() / points;
+
+  arma::mat gradient;
+  BOOST_REQUIRE_CLOSE(saf.EvaluateWithGradient(parameters, gradient),
+      objective, 1e-8);
+  BOOST_REQUIRE_CLOSE(saf.Evaluate(parameters), objective, 1e-8);
+  BOOST_REQUIRE_EQUAL(gradient.n_rows, expected.n_rows);
+  BOOST_REQUIRE_EQUAL(gradient.n_cols, expected.n_cols);
+  for (size_t i = 0; i < expected.n_elem; i++)
+  {
+    if (std::abs(expected[i]) <= 1e-10)
+      BOOST_REQUIRE_SMALL(gradient[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(gradient[i], expected[i], 1e-6);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -128,5 +128,60 @@ BOOST_AUTO_TEST_CASE(SparseCodingTestDictionaryStep)
   BOOST_REQUIRE_SMALL(normGradient, tol);
 }
 
+BOOST_AUTO_TEST_CASE(SparseCodingTestBlockCoordinateDictionaryStep)
+{
+  double lambda1 = 0.1;
+  uword nAtoms = 25;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  uword nPoints = X.n_cols;
+
+  // Normalize each point since these are images.
+  for (uword i = 0; i < nPoints; ++i)
+    X.col(i) /= norm(X.col(i), 2);
+
+  SparseCoding<> sc(X, nAtoms, lambda1);
+  sc.OptimizeCode();
+
+  // Only check atoms that are used; the others are re-initialized.
+  const double objective = sc.Objective();
+  const bool allUsed = (accu(sum(sc.Codes() != 0, 1) == 0) == 0);
+  sc.OptimizeDictionaryBlockCoordinate(10);
+
+  // Each atom update minimizes the objective in that atom, so the objective
+  // can't go up, and every atom stays in the unit ball.
+  if (allUsed)
+    BOOST_REQUIRE_LE(sc.Objective(), objective + 1e-10);
+  for (uword j = 0; j < nAtoms; ++j)
+    BOOST_REQUIRE_LE(norm(sc.Dictionary().col(j), 2), 1.0 + 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(SparseCodingTestOnline)
+{
+  double lambda1 = 0.1;
+  uword nAtoms = 25;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  uword nPoints = X.n_cols;
+
+  // Normalize each point since these are images.
+  for (uword i = 0; i < nPoints; ++i)
+    X.col(i) /= norm(X.col(i), 2);
+
+  SparseCoding<> sc(X, nAtoms, lambda1);
+  sc.OptimizeCode();
+  const double initialObjective = sc.Objective();
+
+  // Learn from 20 mini-batches of 50 points (four passes over the data).
+  sc.EncodeOnline(50, 20);
+  sc.OptimizeCode();
+
+  BOOST_REQUIRE_LT(sc.Objective(), initialObjective);
+  for (uword j = 0; j < nAtoms; ++j)
+    BOOST_REQUIRE_LE(norm(sc.Dictionary().col(j), 2), 1.0 + 1e-10);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END();
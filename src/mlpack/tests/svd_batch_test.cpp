@@ -181,4 +181,36 @@ BOOST_AUTO_TEST_CASE(SVDBatchNegativeElementTest)
   BOOST_REQUIRE_CLOSE(arma::norm(test, "fro"), arma::norm(result, "fro"), 5.0);
 }
 
+/**
+ * Make sure the sparse and the dense update rules take the same steps.
+ */
+BOOST_AUTO_TEST_CASE(SVDBatchSparseDenseTest)
+{
+  sp_mat data;
+  data.sprandu(40, 30, 0.3);
+  mat denseData(data);
+
+  SpecificRandomInitialization sri(data.n_rows, 3, data.n_cols);
+
+  AMF<SimpleToleranceTermination<sp_mat>,
+      SpecificRandomInitialization,
+      SVDBatchLearning> sparseAMF(SimpleToleranceTermination<sp_mat>(1e-5, 20),
+                                  sri, SVDBatchLearning(0.01, 0.1, 0.1, 0.5));
+  AMF<SimpleToleranceTermination<mat>,
+      SpecificRandomInitialization,
+      SVDBatchLearning> denseAMF(SimpleToleranceTermination<mat>(1e-5, 20),
+                                 sri, SVDBatchLearning(0.01, 0.1, 0.1, 0.5));
+
+  mat sparseW, sparseH, denseW, denseH;
+  sparseAMF.Apply(data, 3, sparseW, sparseH);
+  denseAMF.Apply(denseData, 3, denseW, denseH);
+
+  BOOST_REQUIRE_EQUAL(sparseAMF.TerminationPolicy().Iteration(),
+                      denseAMF.TerminationPolicy().Iteration());
+  for (size_t i = 0; i < denseW.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(sparseW[i], denseW[i], 1e-5);
+  for (size_t i = 0; i < denseH.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(sparseH[i], denseH[i], 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
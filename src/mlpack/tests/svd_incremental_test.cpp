@@ -2,6 +2,7 @@
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/svd_incomplete_incremental_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_complete_incremental_learning.hpp>
+#include <mlpack/methods/amf/update_rules/svd_parallel_incremental_learning.hpp>
 #include <mlpack/methods/amf/init_rules/random_init.hpp>
 #include <mlpack/methods/amf/termination_policies/incomplete_incremental_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/complete_incremental_termination.hpp>
@@ -134,4 +135,41 @@ BOOST_AUTO_TEST_CASE(SVDIncompleteIncrementalRegularizationTest)
   BOOST_REQUIRE_LT(regularizedRMSE, regularRMSE + 0.075);
 }
 
+/**
+ * Test for convergence of parallel incremental learning, and make sure that
+ * the sparse and the dense matrix take the same steps.
+ */
+BOOST_AUTO_TEST_CASE(SVDParallelIncrementalConvergenceTest)
+{
+  sp_mat data;
+  data.sprandu(300, 200, 0.2);
+  mat denseData(data);
+
+  AMF<SimpleToleranceTermination<sp_mat>,
+      RandomInitialization,
+      SVDParallelIncrementalLearning> amf(SimpleToleranceTermination<sp_mat>(),
+                                          RandomInitialization(),
+                                          SVDParallelIncrementalLearning(0.01,
+                                          0, 0, 3));
+  AMF<SimpleToleranceTermination<mat>,
+      RandomInitialization,
+      SVDParallelIncrementalLearning> denseAMF(
+          SimpleToleranceTermination<mat>(), RandomInitialization(),
+          SVDParallelIncrementalLearning(0.01, 0, 0, 3));
+
+  mat m1, m2, d1, d2;
+  const size_t seed = mlpack::math::RandInt(1000000);
+  mlpack::math::RandomSeed(seed);
+  amf.Apply(data, 2, m1, m2);
+  mlpack::math::RandomSeed(seed);
+  denseAMF.Apply(denseData, 2, d1, d2);
+
+  BOOST_REQUIRE_NE(amf.TerminationPolicy().Iteration(),
+                   amf.TerminationPolicy().MaxIterations());
+
+  BOOST_REQUIRE_EQUAL(amf.TerminationPolicy().Iteration(),
+                      denseAMF.TerminationPolicy().Iteration());
+  BOOST_REQUIRE_SMALL(arma::norm(m1 * m2 - d1 * d2, "fro"), 1e-8);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -9,6 +9,8 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/core/tree/vantage_point_tree.hpp>
+#include <mlpack/core/tree/tree_io.hpp>
 
 #include <queue>
 #include <stack>
@@ -971,6 +973,57 @@ BOOST_AUTO_TEST_CASE(HRectBoundRootRangeDistancePoint)
   }
 }
 
+//! Compare the point-to-bound distances of an HRectBound with the distances
+//! to the closest and the furthest point of the bound.
+template<int Power>
+void CheckHRectBoundPointDistances()
+{
+  for (int i = 0; i < 20; i++)
+  {
+    const size_t dim = math::RandInt(1, 20);
+
+    HRectBound<Power, true> a(dim);
+    arma::vec lo(dim, arma::fill::randn);
+    arma::vec width(dim, arma::fill::randu);
+    for (size_t j = 0; j < dim; j++)
+      a[j] = Range(lo[j], lo[j] + width[j]);
+
+    for (int j = 0; j < 10; j++)
+    {
+      arma::vec point(dim, arma::fill::randn);
+      arma::vec closest(dim), furthest(dim);
+      for (size_t k = 0; k < dim; k++)
+      {
+        closest[k] = std::min(std::max(point[k], a[k].Lo()), a[k].Hi());
+        furthest[k] = (point[k] - a[k].Lo() > a[k].Hi() - point[k]) ?
+            a[k].Lo() : a[k].Hi();
+      }
+
+      const double minDistance = LMetric<Power, true>::Evaluate(point, closest);
+      const double maxDistance = LMetric<Power, true>::Evaluate(point,
+          furthest);
+
+      BOOST_REQUIRE_CLOSE(a.MinDistance(point) + 1.0, minDistance + 1.0, 1e-5);
+      BOOST_REQUIRE_CLOSE(a.MaxDistance(point), maxDistance, 1e-5);
+
+      const Range r = a.RangeDistance(point);
+      BOOST_REQUIRE_CLOSE(r.Lo() + 1.0, minDistance + 1.0, 1e-5);
+      BOOST_REQUIRE_CLOSE(r.Hi(), maxDistance, 1e-5);
+    }
+  }
+}
+
+/**
+ * Ensure that the point-to-bound distances are right for the L1, L2 and L3
+ * metrics.
+ */
+BOOST_AUTO_TEST_CASE(HRectBoundPowerDistancePoint)
+{
+  CheckHRectBoundPointDistances<1>();
+  CheckHRectBoundPointDistances<2>();
+  CheckHRectBoundPointDistances<3>();
+}
+
 /**
  * Ensure that HRectBound::Diameter() works properly.
  */
@@ -1734,6 +1787,46 @@ BOOST_AUTO_TEST_CASE(CoverTreeConstructionTest)
   CheckSeparation<CoverTree<>, LMetric<2, true> >(tree, tree);
 }
 
+//! Check the parent distances of a cover tree against the metric.
+template<typename TreeType>
+void CheckCoverTreeParentDistances(const TreeType& node)
+{
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    const double distance = LMetric<2, true>::Evaluate(
+        node.Dataset().col(node.Point()),
+        node.Dataset().col(node.Child(i).Point()));
+    BOOST_REQUIRE_CLOSE(node.Child(i).ParentDistance() + 1.0, distance + 1.0,
+        1e-10);
+    CheckCoverTreeParentDistances(node.Child(i));
+  }
+}
+
+/**
+ * Create a cover tree on high-dimensional data, whose distances are computed in
+ * blocks, with a number of points that isn't a multiple of the block size, and
+ * make sure it's accurate.
+ */
+BOOST_AUTO_TEST_CASE(BlockedDistanceCoverTreeConstructionTest)
+{
+  arma::mat dataset;
+  dataset.randu(101, 1003);
+
+  CoverTree<> tree(dataset);
+
+  arma::vec counts;
+  counts.zeros(1003);
+  RecurseTreeCountLeaves(tree, counts);
+
+  for (size_t i = 0; i < 1003; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  CheckSelfChild<CoverTree<> >(tree);
+  CheckCovering<CoverTree<>, LMetric<2, true> >(tree);
+  CheckSeparation<CoverTree<>, LMetric<2, true> >(tree, tree);
+  CheckCoverTreeParentDistances(tree);
+}
+
 /**
  * Create a cover tree on sparse data and make sure it's accurate.
  */
@@ -2029,4 +2122,471 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+//! Check the invariants of a vantage point tree node, and count how many times
+//! each point is held in a leaf.
+template<typename TreeType>
+void CheckVantagePointTree(TreeType& node,
+                           const size_t maxLeafSize,
+                           arma::Col<size_t>& leafCounts)
+{
+  const arma::mat& dataset = node.Dataset();
+  EuclideanDistance metric;
+
+  // Every descendant must be inside the ball around the vantage point.
+  BOOST_REQUIRE_EQUAL(node.Descendant(0), node.Point(0));
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+  {
+    const double distance = metric.Evaluate(dataset.col(node.Point(0)),
+        dataset.col(node.Descendant(i)));
+    BOOST_REQUIRE_LE(distance, node.FurthestDescendantDistance() * (1 + 1e-10));
+  }
+
+  if (node.Parent() != NULL)
+  {
+    const double distance = metric.Evaluate(dataset.col(node.Point(0)),
+        dataset.col(node.Parent()->Point(0)));
+    BOOST_REQUIRE_SMALL(std::abs(distance - node.ParentDistance()), 1e-10);
+  }
+
+  if (node.IsLeaf())
+  {
+    BOOST_REQUIRE_EQUAL(node.NumChildren(), 0);
+    BOOST_REQUIRE_LE(node.NumPoints(), maxLeafSize);
+    BOOST_REQUIRE_EQUAL(node.NumPoints(), node.NumDescendants());
+    BOOST_REQUIRE_CLOSE(node.FurthestPointDistance() + 1.0,
+        node.FurthestDescendantDistance() + 1.0, 1e-10);
+    for (size_t i = 0; i < node.NumPoints(); ++i)
+      ++leafCounts[node.Point(i)];
+
+    return;
+  }
+
+  // The inner child is a self-child, and the children split the descendants.
+  BOOST_REQUIRE_EQUAL(node.NumChildren(), 2);
+  BOOST_REQUIRE_EQUAL(node.NumPoints(), 1);
+  BOOST_REQUIRE_EQUAL(node.Child(0).Point(0), node.Point(0));
+  BOOST_REQUIRE_SMALL(node.Child(0).ParentDistance(), 1e-10);
+  BOOST_REQUIRE_EQUAL(node.Child(0).NumDescendants() +
+      node.Child(1).NumDescendants(), node.NumDescendants());
+  BOOST_REQUIRE_GE(node.Child(1).NumDescendants(),
+      node.Child(0).NumDescendants() - 1);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(node.Child(i).Parent(), &node);
+    CheckVantagePointTree(node.Child(i), maxLeafSize, leafCounts);
+  }
+}
+
+/**
+ * Make sure that the vantage point tree is built correctly, and that each point
+ * is held in exactly one leaf.
+ */
+BOOST_AUTO_TEST_CASE(VantagePointTreeConstructionTest)
+{
+  arma::mat dataset;
+  dataset.randu(4, 1000);
+
+  for (size_t maxLeafSize = 1; maxLeafSize <= 32; maxLeafSize *= 2)
+  {
+    VantagePointTree<> tree(dataset, maxLeafSize);
+
+    BOOST_REQUIRE_EQUAL(tree.NumDescendants(), dataset.n_cols);
+    BOOST_REQUIRE(tree.Parent() == NULL);
+
+    arma::Col<size_t> leafCounts(dataset.n_cols);
+    leafCounts.zeros();
+    CheckVantagePointTree(tree, maxLeafSize, leafCounts);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(leafCounts[i], 1);
+  }
+}
+
+/**
+ * Make sure the copy constructor works right for the vantage point tree.
+ */
+BOOST_AUTO_TEST_CASE(VantagePointTreeCopyConstructor)
+{
+  arma::mat dataset;
+  dataset.randu(3, 200);
+
+  VantagePointTree<>* tree = new VantagePointTree<>(dataset, 5);
+  VantagePointTree<> copy(*tree);
+
+  // The copy must be the same tree, without sharing any nodes.
+  std::stack<std::pair<VantagePointTree<>*, VantagePointTree<>*> > stack;
+  stack.push(std::make_pair(tree, &copy));
+  while (!stack.empty())
+  {
+    VantagePointTree<>* a = stack.top().first;
+    VantagePointTree<>* b = stack.top().second;
+    stack.pop();
+
+    BOOST_REQUIRE_NE(a, b);
+    BOOST_REQUIRE_EQUAL(a->NumDescendants(), b->NumDescendants());
+    for (size_t i = 0; i < a->NumDescendants(); ++i)
+      BOOST_REQUIRE_EQUAL(a->Descendant(i), b->Descendant(i));
+    BOOST_REQUIRE_EQUAL(a->ParentDistance(), b->ParentDistance());
+    BOOST_REQUIRE_EQUAL(a->FurthestDescendantDistance(),
+        b->FurthestDescendantDistance());
+    BOOST_REQUIRE_EQUAL(a->NumChildren(), b->NumChildren());
+
+    for (size_t i = 0; i < a->NumChildren(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(b->Child(i).Parent(), b);
+      stack.push(std::make_pair(&a->Child(i), &b->Child(i)));
+    }
+  }
+
+  // The copy must still be usable after the original is gone.
+  delete tree;
+  arma::Col<size_t> leafCounts(dataset.n_cols);
+  leafCounts.zeros();
+  CheckVantagePointTree(copy, 5, leafCounts);
+}
+
+//! Check that two binary space trees have the same structure and bounds.
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.IsLeaf(), b.IsLeaf());
+  BOOST_REQUIRE_CLOSE(a.ParentDistance() + 1.0, b.ParentDistance() + 1.0,
+      1e-10);
+  BOOST_REQUIRE_CLOSE(a.FurthestDescendantDistance() + 1.0,
+      b.FurthestDescendantDistance() + 1.0, 1e-10);
+  BOOST_REQUIRE_EQUAL(a.Bound().Dim(), b.Bound().Dim());
+  for (size_t i = 0; i < a.Bound().Dim(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(a.Bound()[i].Lo() + 1.0, b.Bound()[i].Lo() + 1.0,
+        1e-10);
+    BOOST_REQUIRE_CLOSE(a.Bound()[i].Hi() + 1.0, b.Bound()[i].Hi() + 1.0,
+        1e-10);
+  }
+
+  if (!a.IsLeaf())
+  {
+    BOOST_REQUIRE_EQUAL(b.Left()->Parent(), &b);
+    BOOST_REQUIRE_EQUAL(b.Right()->Parent(), &b);
+    CheckSameBinarySpaceTree(*a.Left(), *b.Left());
+    CheckSameBinarySpaceTree(*a.Right(), *b.Right());
+  }
+}
+
+/**
+ * Make sure a kd-tree saved with SaveTree() is loaded back identically, along
+ * with its dataset and mapping.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeSaveLoadTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 500);
+  std::vector<size_t> oldFromNew;
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  BOOST_REQUIRE(SaveTree("test_tree.bin", tree, oldFromNew));
+
+  arma::mat loadedDataset;
+  std::vector<size_t> loadedOldFromNew;
+  TreeType* loadedTree = LoadTree<TreeType>("test_tree.bin", loadedDataset,
+      loadedOldFromNew);
+  BOOST_REQUIRE(loadedTree != NULL);
+
+  BOOST_REQUIRE_EQUAL(loadedDataset.n_rows, dataset.n_rows);
+  BOOST_REQUIRE_EQUAL(loadedDataset.n_cols, dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(loadedDataset[i], dataset[i], 1e-10);
+
+  BOOST_REQUIRE_EQUAL(loadedOldFromNew.size(), oldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    BOOST_REQUIRE_EQUAL(loadedOldFromNew[i], oldFromNew[i]);
+
+  BOOST_REQUIRE_EQUAL(&loadedTree->Dataset(), &loadedDataset);
+  CheckSameBinarySpaceTree(tree, *loadedTree);
+
+  delete loadedTree;
+  remove("test_tree.bin");
+}
+
+/**
+ * Make sure a compacted kd-tree has the same structure as the original tree,
+ * with the nodes of every subtree stored consecutively in depth-first order.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeCompactTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+  TreeType tree(dataset, 5);
+  TreeType original(tree);
+
+  tree.Compact();
+  BOOST_REQUIRE(tree.Compacted());
+  BOOST_REQUIRE(!original.Compacted());
+  CheckSameBinarySpaceTree(original, tree);
+
+  // The left child follows its parent, and the right child follows the whole
+  // left subtree.
+  std::stack<TreeType*> nodeStack;
+  nodeStack.push(tree.Left());
+  nodeStack.push(tree.Right());
+  while (!nodeStack.empty())
+  {
+    TreeType* node = nodeStack.top();
+    nodeStack.pop();
+
+    if (!node->IsLeaf())
+    {
+      BOOST_REQUIRE_EQUAL(node->Left(), node + 1);
+      BOOST_REQUIRE_EQUAL(node->Right(), node + node->Left()->TreeSize() + 1);
+      nodeStack.push(node->Left());
+      nodeStack.push(node->Right());
+    }
+  }
+
+  // A copy of a compacted tree is a regular tree.
+  TreeType copy(tree);
+  BOOST_REQUIRE(!copy.Compacted());
+  CheckSameBinarySpaceTree(original, copy);
+}
+
+/**
+ * Make sure the memory usage of a kd-tree counts every node and its bound, and
+ * doesn't change when the tree is compacted.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeMemoryUsageTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+  TreeType tree(dataset, 5);
+
+  const size_t expected = tree.TreeSize() * (sizeof(TreeType) + 5 *
+      sizeof(math::Range));
+  BOOST_REQUIRE_EQUAL(tree.MemoryUsage(), expected);
+
+  tree.Compact();
+  BOOST_REQUIRE_EQUAL(tree.MemoryUsage(), expected);
+}
+
+/**
+ * Make sure that a kd-tree on enough points to build its top nodes with the
+ * parallel partition is still correct, and that the mappings are right.
+ */
+BOOST_AUTO_TEST_CASE(ParallelKdTreeConstructionTest)
+{
+  typedef BinarySpaceTree<HRectBound<2> > TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 4 * ParallelSplitSize + 17);
+  arma::mat datacopy(dataset);
+
+  std::vector<size_t> oldFromNew;
+  std::vector<size_t> newFromOld;
+  TreeType root(dataset, oldFromNew, newFromOld);
+
+  BOOST_REQUIRE_EQUAL(root.Count(), datacopy.n_cols);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), datacopy.n_cols);
+
+  for (size_t i = 0; i < datacopy.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(newFromOld[oldFromNew[i]], i);
+    for (size_t j = 0; j < datacopy.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(dataset(j, i), datacopy(j, oldFromNew[i]));
+  }
+
+  BOOST_REQUIRE(CheckPointBounds(root, dataset));
+
+  // The children of every node split its points without overlapping.
+  std::stack<TreeType*> nodeStack;
+  nodeStack.push(&root);
+  while (!nodeStack.empty())
+  {
+    TreeType* node = nodeStack.top();
+    nodeStack.pop();
+
+    if (!node->IsLeaf())
+    {
+      BOOST_REQUIRE_EQUAL(node->Left()->Begin(), node->Begin());
+      BOOST_REQUIRE_EQUAL(node->Right()->Begin(), node->Begin() +
+          node->Left()->Count());
+      BOOST_REQUIRE_EQUAL(node->Left()->Count() + node->Right()->Count(),
+          node->Count());
+      nodeStack.push(node->Left());
+      nodeStack.push(node->Right());
+    }
+  }
+}
+
+/**
+ * Make sure that the random projection split builds a balanced tree that holds
+ * every point, and that the tree only depends on the random seed.
+ */
+BOOST_AUTO_TEST_CASE(RPTreeConstructionTest)
+{
+  typedef BinarySpaceTree<HRectBound<2>, EmptyStatistic, arma::mat,
+      RPTreeSplit<HRectBound<2>, arma::mat> > TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(16, 1000);
+  arma::mat datacopy(dataset);
+  arma::mat datacopy2(dataset);
+
+  math::RandomSeed(42);
+  std::vector<size_t> oldFromNew;
+  TreeType root(dataset, oldFromNew, 10);
+
+  math::RandomSeed(42);
+  TreeType root2(datacopy2, 10);
+
+  BOOST_REQUIRE_EQUAL(root.Count(), datacopy.n_cols);
+  for (size_t i = 0; i < datacopy.n_cols; ++i)
+    for (size_t j = 0; j < datacopy.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(dataset(j, i), datacopy(j, oldFromNew[i]));
+
+  BOOST_REQUIRE(CheckPointBounds(root, dataset));
+
+  // The same seed gives the same tree.
+  BOOST_REQUIRE_EQUAL(arma::accu(dataset != datacopy2), 0);
+
+  // Each split is at the median of the projections.
+  std::stack<TreeType*> nodeStack;
+  nodeStack.push(&root);
+  while (!nodeStack.empty())
+  {
+    TreeType* node = nodeStack.top();
+    nodeStack.pop();
+
+    if (node->IsLeaf())
+    {
+      BOOST_REQUIRE_LE(node->Count(), 10);
+      continue;
+    }
+
+    BOOST_REQUIRE_EQUAL(node->Left()->Begin(), node->Begin());
+    BOOST_REQUIRE_EQUAL(node->Left()->Count(), node->Count() / 2);
+    BOOST_REQUIRE_EQUAL(node->Left()->Count() + node->Right()->Count(),
+        node->Count());
+    nodeStack.push(node->Left());
+    nodeStack.push(node->Right());
+  }
+}
+
+//! Check that two cover trees have the same structure.
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Point(), b.Point());
+  BOOST_REQUIRE_EQUAL(a.Scale(), b.Scale());
+  BOOST_REQUIRE_CLOSE(a.Base(), b.Base(), 1e-10);
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_CLOSE(a.ParentDistance() + 1.0, b.ParentDistance() + 1.0,
+      1e-10);
+  BOOST_REQUIRE_CLOSE(a.FurthestDescendantDistance() + 1.0,
+      b.FurthestDescendantDistance() + 1.0, 1e-10);
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Make sure a cover tree saved with SaveTree() is loaded back identically.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeSaveLoadTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 300);
+  CoverTree<> tree(dataset, 1.3);
+
+  BOOST_REQUIRE(SaveTree("test_tree.bin", tree));
+
+  arma::mat loadedDataset;
+  std::vector<size_t> oldFromNew;
+  CoverTree<>* loadedTree = LoadTree<CoverTree<> >("test_tree.bin",
+      loadedDataset, oldFromNew);
+  BOOST_REQUIRE(loadedTree != NULL);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), 0);
+
+  for (size_t i = 0; i < dataset.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(loadedDataset[i], dataset[i], 1e-10);
+
+  CheckSameCoverTree(tree, *loadedTree);
+
+  delete loadedTree;
+  remove("test_tree.bin");
+}
+
+/**
+ * Make sure a compacted cover tree has the same structure as the original tree,
+ * with the children of every node stored next to each other, and the children
+ * of every subtree stored after the children of its root.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeCompactTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  CoverTree<> tree(dataset, 1.3);
+  CoverTree<> original(tree);
+
+  tree.Compact();
+  BOOST_REQUIRE(tree.Compacted());
+  BOOST_REQUIRE(!original.Compacted());
+  BOOST_REQUIRE_EQUAL(tree.TreeSize(), original.TreeSize());
+  CheckSameCoverTree(original, tree);
+
+  // The children of a node form one block, which comes after the node, and
+  // the blocks of the subtrees of the children follow each other in order.
+  std::stack<CoverTree<>*> nodeStack;
+  nodeStack.push(&tree);
+  while (!nodeStack.empty())
+  {
+    CoverTree<>* node = nodeStack.top();
+    nodeStack.pop();
+
+    CoverTree<>* previousBlockEnd = NULL;
+    CoverTree<>* lastChild = (node->NumChildren() == 0) ? NULL :
+        &node->Child(node->NumChildren() - 1);
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+    {
+      CoverTree<>& child = node->Child(i);
+      BOOST_REQUIRE_EQUAL(&child, &node->Child(0) + i);
+      BOOST_REQUIRE_EQUAL(child.Parent(), node);
+      if (node != &tree)
+        BOOST_REQUIRE_GT(&child, node);
+
+      if (child.NumChildren() > 0)
+      {
+        BOOST_REQUIRE_GT(&child.Child(0), lastChild);
+        if (previousBlockEnd != NULL)
+          BOOST_REQUIRE_GE(&child.Child(0), previousBlockEnd);
+        previousBlockEnd = &child.Child(0) + child.TreeSize() - 1;
+      }
+
+      nodeStack.push(&child);
+    }
+  }
+
+  // A copy of a compacted tree is a regular tree.
+  CoverTree<> copy(tree);
+  BOOST_REQUIRE(!copy.Compacted());
+  CheckSameCoverTree(original, copy);
+}
+
+/**
+ * Loading something that isn't a tree file should fail gracefully.
+ */
+BOOST_AUTO_TEST_CASE(LoadInvalidTreeTest)
+{
+  std::fstream f("test_tree.bin", std::fstream::out);
+  f << "this is not a tree" << std::endl;
+  f.close();
+
+  arma::mat dataset;
+  std::vector<size_t> oldFromNew;
+  BOOST_REQUIRE(LoadTree<BinarySpaceTree<HRectBound<2> > >("test_tree.bin",
+      dataset, oldFromNew) == NULL);
+
+  remove("test_tree.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,7 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/core/tree/vantage_point_tree.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "old_boost_test_definitions.hpp"
@@ -42,6 +43,8 @@ BOOST_AUTO_TEST_CASE(DefaultsTraitsTest)
   BOOST_REQUIRE_EQUAL(b, false);
   b = TreeTraits<int>::BinaryTree;
   BOOST_REQUIRE_EQUAL(b, false);
+  b = TreeTraits<int>::HasContiguousLeaves;
+  BOOST_REQUIRE_EQUAL(b, false);
 }
 
 // Test the binary space tree traits.
@@ -68,6 +71,10 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeTraitsTest)
   // It is a binary tree.
   b = TreeTraits<TreeType>::BinaryTree;
   BOOST_REQUIRE_EQUAL(b, true);
+
+  // Points are only in leaves, which are contiguous ranges of the dataset.
+  b = TreeTraits<TreeType>::HasContiguousLeaves;
+  BOOST_REQUIRE_EQUAL(b, true);
 }
 
 // Test the cover tree traits.
@@ -90,6 +97,34 @@ BOOST_AUTO_TEST_CASE(CoverTreeTraitsTest)
 
   b = TreeTraits<CoverTree<>>::BinaryTree;
   BOOST_REQUIRE_EQUAL(b, false); // Not necessarily binary.
+
+  b = TreeTraits<CoverTree<>>::HasContiguousLeaves;
+  BOOST_REQUIRE_EQUAL(b, false);
+}
+
+// Test the vantage point tree traits.
+BOOST_AUTO_TEST_CASE(VantagePointTreeTraitsTest)
+{
+  // The balls of the children may overlap.
+  bool b = TreeTraits<VantagePointTree<>>::HasOverlappingChildren;
+  BOOST_REQUIRE_EQUAL(b, true);
+
+  // The inner child is a self-child.
+  b = TreeTraits<VantagePointTree<>>::HasSelfChildren;
+  BOOST_REQUIRE_EQUAL(b, true);
+
+  // The first point is the vantage point of the node.
+  b = TreeTraits<VantagePointTree<>>::FirstPointIsCentroid;
+  BOOST_REQUIRE_EQUAL(b, true);
+
+  b = TreeTraits<VantagePointTree<>>::RearrangesDataset;
+  BOOST_REQUIRE_EQUAL(b, false);
+
+  b = TreeTraits<VantagePointTree<>>::BinaryTree;
+  BOOST_REQUIRE_EQUAL(b, true);
+
+  b = TreeTraits<VantagePointTree<>>::HasContiguousLeaves;
+  BOOST_REQUIRE_EQUAL(b, false);
 }
 
 BOOST_AUTO_TEST_SUITE_END();
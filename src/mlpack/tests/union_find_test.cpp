@@ -46,4 +46,31 @@ BOOST_AUTO_TEST_CASE(TestUnion)
   BOOST_REQUIRE(testUnionFind_.Find(6) == testUnionFind_.Find(3));
 }
 
+/**
+ * Unite the elements of a chain from many threads at once and make sure that
+ * exactly one union per link succeeds.
+ */
+BOOST_AUTO_TEST_CASE(TestLockFreeUnion)
+{
+  const size_t size = 10000;
+  LockFreeUnionFind unionFind(size);
+
+  // Every link of the chain is united twice, in both directions.
+  size_t successes = 0;
+  #pragma omp parallel for reduction(+:successes)
+  for (size_t i = 0; i < 2 * (size - 1); ++i)
+  {
+    const size_t link = i / 2;
+    if ((i % 2 == 0) ? unionFind.Union(link, link + 1) :
+        unionFind.Union(link + 1, link))
+      ++successes;
+  }
+
+  BOOST_REQUIRE_EQUAL(successes, size - 1);
+
+  // The component index is the smallest element.
+  for (size_t i = 0; i < size; ++i)
+    BOOST_REQUIRE_EQUAL(unionFind.Find(i), (size_t) 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();